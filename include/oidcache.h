@@ -4,7 +4,8 @@
  *    Functions for building a cache of type and operator Oids.
  *
  * MobilityDB builds a cache of OIDs in global arrays in order to avoid (slow)
- * lookups. The global arrays are initialized at the loading of the extension.
+ * lookups. The type Oids are looked up at the first use of the cache, and the
+ * operator Oids are looked up one by one at their first use.
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  *    Universite Libre de Bruxelles
@@ -110,9 +111,21 @@ typedef enum
   OVERAFTER_OP,
 } CachedOp;
 
+/**
+ * Structure to represent the properties of a base type of the temporal
+ * types, which are resolved once when the cache is populated
+ */
+typedef struct
+{
+  Oid typid;        /**< Oid of the type */
+  int16 typlen;     /**< Length of the type, -1 for varlena types */
+  bool typbyval;    /**< True when the type is passed by value */
+  bool linear;      /**< True when the type allows linear interpolation */
+} BaseTypeInfo;
+
 extern Oid type_oid(CachedType t);
 extern Oid oper_oid(CachedOp op, CachedType lt, CachedType rt);
-extern Datum fill_opcache(PG_FUNCTION_ARGS);
+extern const BaseTypeInfo *base_type_info(Oid type);
 
 #endif /* OIDCACHE_H */
 
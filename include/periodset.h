@@ -58,6 +58,7 @@ extern PeriodSet *timestampset_to_periodset_internal(const TimestampSet *ts);
 /* Accessor functions */
 
 extern Datum periodset_mem_size(PG_FUNCTION_ARGS);
+extern Datum periodset_legacy_layout(PG_FUNCTION_ARGS);
 extern Datum periodset_timespan(PG_FUNCTION_ARGS);
 extern Datum periodset_num_periods(PG_FUNCTION_ARGS);
 extern Datum periodset_start_period(PG_FUNCTION_ARGS);
@@ -169,6 +169,12 @@ extern Datum tbox_ne(PG_FUNCTION_ARGS);
 extern int tbox_cmp_internal(const TBOX *box1, const TBOX *box2);
 extern bool tbox_eq_internal(const TBOX *box1, const TBOX *box2);
 
+/* Z-order functions */
+
+extern Datum tbox_zorder(PG_FUNCTION_ARGS);
+
+extern int64 tbox_zorder_internal(const TBOX *box, const TBOX *extent);
+
 /*****************************************************************************/
 
 #endif
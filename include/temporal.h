@@ -22,6 +22,8 @@
 #include "timetypes.h"
 #include "tbox.h"
 #include "stbox.h"
+#include "temporal_counters.h"
+#include "temporal_detoast.h"
 
 #if MOBDB_PGSQL_VERSION < 130000
 #ifndef USE_FLOAT4_BYVAL
@@ -131,7 +133,32 @@ typedef enum
   SEQUENCESET,
 } TDuration;
 
-#define TYPMOD_GET_DURATION(typmod) ((TDuration) ((typmod == -1) ? (0) : (typmod & 0x0000000F)))
+/**
+ * Enumeration for the storage of the values of a column, which is either
+ * the expanded form of the temporal types, the packed form, in which the
+ * timestamps and the base values are kept in raw arrays, or the compressed
+ * form, in which they are kept in delta and XOR encoded streams
+ */
+typedef enum
+{
+  STORAGE_EXPANDED,
+  STORAGE_PACKED,
+  STORAGE_COMPRESSED,
+} TStorage;
+
+/*
+ * The first 4 bits of the typmod are reserved for temporal types. They
+ * keep the duration and the storage of the values of the column as the
+ * number storage * 5 + duration, since the 5 durations and the 3 storages
+ * need 15 of the 16 values of the 4 bits.
+ */
+#define TYPMOD_GET_DURATION(typmod) ((TDuration) ((typmod == -1) ? (0) : ((typmod & 0x0000000F) % 5)))
+#define TYPMOD_GET_STORAGE(typmod) ((TStorage) ((typmod == -1) ? (0) : ((typmod & 0x0000000F) / 5)))
+#define TYPMOD_SET_STORAGE(typmod, storage) ((typmod) = ((typmod) & 0xFFFFFFF0) | \
+  (((typmod) & 0x0000000F) % 5 + 5 * (storage)))
+
+#define TSTORAGE_PACKED_NAME "Packed"
+#define TSTORAGE_COMPRESSED_NAME "Compressed"
 
 /**
  * Structure to represent the duration array
@@ -148,7 +175,7 @@ struct tduration_struct
 
 /*****************************************************************************
  * Macros for manipulating the 'flags' element
- * GTZXBL
+ * MSRPGTZXBL
  *****************************************************************************/
 
 #define MOBDB_FLAGS_GET_LINEAR(flags)     ((bool) ((flags) & 0x01))
@@ -158,20 +185,60 @@ struct tduration_struct
 #define MOBDB_FLAGS_GET_Z(flags)       ((bool) (((flags) & 0x08)>>3))
 #define MOBDB_FLAGS_GET_T(flags)       ((bool) (((flags) & 0x10)>>4))
 #define MOBDB_FLAGS_GET_GEODETIC(flags)   ((bool) (((flags) & 0x20)>>5))
+/* The following flag is only used for TemporalPacked */
+#define MOBDB_FLAGS_GET_PACKED(flags)   ((bool) (((flags) & 0x40)>>6))
+/* The following flag is only used for TSequence */
+#define MOBDB_FLAGS_GET_TRAJ(flags)     ((bool) (((flags) & 0x80)>>7))
+/* The following flag is only used for TSequence of temporal points */
+#define MOBDB_FLAGS_GET_BLOCKS(flags)   ((bool) (((flags) & 0x0100)>>8))
+/* The following flag is only used for TSequence of temporal numbers and
+ * temporal points */
+#define MOBDB_FLAGS_GET_METRICS(flags)  ((bool) (((flags) & 0x0200)>>9))
+/* The following flag is only used for TInstantSet and TSequenceSet */
+#define MOBDB_FLAGS_GET_TIMES(flags)    ((bool) (((flags) & 0x0400)>>10))
+/* The following flag is only used for TInstantSet, TSequence, and
+ * TSequenceSet, it is not set in the values of previous versions whose
+ * bounding box follows the composing values */
+#define MOBDB_FLAGS_GET_BBOXFIRST(flags) ((bool) (((flags) & 0x0800)>>11))
+/* The following flag is only used for TemporalPacked */
+#define MOBDB_FLAGS_GET_COMPRESSED(flags) ((bool) (((flags) & 0x1000)>>12))
 
 #define MOBDB_FLAGS_SET_LINEAR(flags, value) \
-  ((flags) = (value) ? ((flags) | 0x01) : ((flags) & 0xFE))
+  ((flags) = (value) ? ((flags) | 0x01) : ((flags) & 0xFFFE))
 /* The following flag is only used for TInstant */
 #define MOBDB_FLAGS_SET_BYVAL(flags, value) \
-  ((flags) = (value) ? ((flags) | 0x02) : ((flags) & 0xFD))
+  ((flags) = (value) ? ((flags) | 0x02) : ((flags) & 0xFFFD))
 #define MOBDB_FLAGS_SET_X(flags, value) \
-  ((flags) = (value) ? ((flags) | 0x04) : ((flags) & 0xFB))
+  ((flags) = (value) ? ((flags) | 0x04) : ((flags) & 0xFFFB))
 #define MOBDB_FLAGS_SET_Z(flags, value) \
-  ((flags) = (value) ? ((flags) | 0x08) : ((flags) & 0xF7))
+  ((flags) = (value) ? ((flags) | 0x08) : ((flags) & 0xFFF7))
 #define MOBDB_FLAGS_SET_T(flags, value) \
-  ((flags) = (value) ? ((flags) | 0x10) : ((flags) & 0xEF))
+  ((flags) = (value) ? ((flags) | 0x10) : ((flags) & 0xFFEF))
 #define MOBDB_FLAGS_SET_GEODETIC(flags, value) \
-  ((flags) = (value) ? ((flags) | 0x20) : ((flags) & 0xDF))
+  ((flags) = (value) ? ((flags) | 0x20) : ((flags) & 0xFFDF))
+/* The following flag is only used for TemporalPacked */
+#define MOBDB_FLAGS_SET_PACKED(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x40) : ((flags) & 0xFFBF))
+/* The following flag is only used for TSequence */
+#define MOBDB_FLAGS_SET_TRAJ(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x80) : ((flags) & 0xFF7F))
+/* The following flag is only used for TSequence of temporal points */
+#define MOBDB_FLAGS_SET_BLOCKS(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x0100) : ((flags) & 0xFEFF))
+/* The following flag is only used for TSequence of temporal numbers and
+ * temporal points */
+#define MOBDB_FLAGS_SET_METRICS(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x0200) : ((flags) & 0xFDFF))
+/* The following flag is only used for TInstantSet and TSequenceSet */
+#define MOBDB_FLAGS_SET_TIMES(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x0400) : ((flags) & 0xFBFF))
+/* The following flag is only used for TInstantSet, TSequence, and
+ * TSequenceSet */
+#define MOBDB_FLAGS_SET_BBOXFIRST(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x0800) : ((flags) & 0xF7FF))
+/* The following flag is only used for TemporalPacked */
+#define MOBDB_FLAGS_SET_COMPRESSED(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x1000) : ((flags) & 0xEFFF))
 
 /*****************************************************************************
  * Macros for GiST indexes
@@ -202,6 +269,7 @@ struct tduration_struct
 #define RTFrontStrategyNumber         33    /* for <</ */
 #define RTBackStrategyNumber          34    /* for />> */
 #define RTOverBackStrategyNumber      35    /* for /&> */
+#define RTOverlapSegmentsStrategyNumber 36  /* for &&& */
 
 /*****************************************************************************
  * Struct definitions for temporal types
@@ -260,6 +328,24 @@ typedef struct
   size_t    offsets[1];    /**< beginning of variable-length data */
 } TSequence;
 
+/**
+ * Structure to represent temporal values of instant set, sequence, or
+ * sequence set duration in packed form, that is, as an array of timestamps
+ * followed by an array of base values instead of an array of TInstant,
+ * where both arrays are replaced by compressed streams for the values
+ * having the COMPRESSED flag
+ */
+typedef struct
+{
+  int32    vl_len_;        /**< varlena header (do not touch directly!) */
+  TDuration   duration;    /**< duration */
+  int16    flags;          /**< flags */
+  Oid     valuetypid;      /**< base type's OID (4 bytes) */
+  int32     count;         /**< number of instants or sequences */
+  int32     totalcount;    /**< total number of instants */
+  /* variable-length data follows */
+} TemporalPacked;
+
 /**
  * Structure to represent temporal values of sequence set duration
  */
@@ -317,6 +403,29 @@ typedef struct
   double    d;
 } double4;
 
+/**
+ * Structure to represent an iterator over the distinct instants of a
+ * temporal value, which visits them in time order without copying them
+ */
+typedef struct
+{
+  const Temporal *temp;  /**< Temporal value being iterated */
+  int seqno;             /**< Number of the current sequence */
+  int instno;            /**< Number of the next instant in the sequence */
+  const TInstant *last;  /**< Last instant returned, NULL at the start */
+} TInstantIterator;
+
+/**
+ * Structure to represent the position of the last search of a timestamp in
+ * a temporal value, so that the next search at a later timestamp starts
+ * from it
+ */
+typedef struct
+{
+  int seqno;             /**< Number of the sequence, -1 when unknown */
+  int segno;             /**< Number of the segment in the sequence */
+} TimestampCursor;
+
 /*****************************************************************************
  * Miscellaneous
  *****************************************************************************/
@@ -367,15 +476,15 @@ typedef struct
 
 /* Temporal types */
 
-#define DatumGetTemporal(X)      ((Temporal *) PG_DETOAST_DATUM(X))
+#define DatumGetTemporal(X)      (temporal_unpack((Temporal *) temporal_detoast(X)))
 #define DatumGetTInstant(X)    ((TInstant *) PG_DETOAST_DATUM(X))
 #define DatumGetTInstantSet(X)    ((TInstantSet *) PG_DETOAST_DATUM(X))
 #define DatumGetTSequence(X)    ((TSequence *) PG_DETOAST_DATUM(X))
 #define DatumGetTSequenceSet(X)    ((TSequenceSet *) PG_DETOAST_DATUM(X))
 
-#define PG_GETARG_TEMPORAL(i)    ((Temporal *) PG_GETARG_VARLENA_P(i))
+#define PG_GETARG_TEMPORAL(i)    (temporal_unpack((Temporal *) temporal_detoast(PG_GETARG_DATUM(i))))
 
-#define PG_GETARG_ANYDATUM(i) (get_typlen(get_fn_expr_argtype(fcinfo->flinfo, i)) == -1 ? \
+#define PG_GETARG_ANYDATUM(i) (get_typlen_fast(get_fn_expr_argtype(fcinfo->flinfo, i)) == -1 ? \
   PointerGetDatum(PG_GETARG_VARLENA_P(i)) : PG_GETARG_DATUM(i))
 
 #define DATUM_FREE(value, valuetypid) \
@@ -419,6 +528,13 @@ extern bool linear_interpolation(Oid type);
 
 extern const char *tduration_name(TDuration duration);
 extern bool tduration_from_string(const char *str, TDuration *duration);
+extern const char *tstorage_name(TStorage storage);
+extern bool tstorage_from_string(const char *str, TStorage *storage);
+
+/* Packed storage functions (defined in temporal_packed.c) */
+
+extern Temporal *temporal_pack(Temporal *temp, TStorage storage);
+extern Temporal *temporal_unpack(Temporal *temp);
 
 /* Catalog functions */
 
@@ -432,6 +548,7 @@ extern Oid base_oid_from_temporal(Oid type);
 
 /* Trajectory functions */
 
+extern bool precompute_trajectory;
 extern bool type_has_precomputed_trajectory(Oid type);
 
 /* Parameter tests */
@@ -486,8 +603,20 @@ extern Datum tinstant_constructor(PG_FUNCTION_ARGS);
 extern Datum tinstantset_constructor(PG_FUNCTION_ARGS);
 extern Datum tlinearseq_constructor(PG_FUNCTION_ARGS);
 extern Datum tstepseq_constructor(PG_FUNCTION_ARGS);
+extern Datum tlinearseq_arrays_constructor(PG_FUNCTION_ARGS);
+extern Datum tstepseq_arrays_constructor(PG_FUNCTION_ARGS);
 extern Datum tsequenceset_constructor(PG_FUNCTION_ARGS);
 
+/* Transformation functions */
+
+extern Datum temporal_append_tinstant(PG_FUNCTION_ARGS);
+extern Datum temporal_append_tinstants(PG_FUNCTION_ARGS);
+
+extern Temporal *temporal_append_tinstant_internal(const Temporal *temp,
+  const TInstant *inst);
+extern Temporal *temporal_append_tinstants1(const Temporal *temp,
+  TInstant **instants, int count);
+
 /* Cast functions */
 
 extern Datum tint_to_tfloat(PG_FUNCTION_ARGS);
@@ -504,6 +633,7 @@ extern Datum temporal_get_values(PG_FUNCTION_ARGS);
 extern Datum temporal_get_time(PG_FUNCTION_ARGS);
 extern Datum tinstant_get_value(PG_FUNCTION_ARGS);
 extern Datum tnumber_to_tbox(PG_FUNCTION_ARGS);
+extern Datum tnumber_zorder(PG_FUNCTION_ARGS);
 extern Datum tnumber_value_range(PG_FUNCTION_ARGS);
 extern Datum temporal_start_value(PG_FUNCTION_ARGS);
 extern Datum temporal_end_value(PG_FUNCTION_ARGS);
@@ -514,13 +644,18 @@ extern Datum temporal_start_instant(PG_FUNCTION_ARGS);
 extern Datum temporal_end_instant(PG_FUNCTION_ARGS);
 extern Datum temporal_instant_n(PG_FUNCTION_ARGS);
 extern Datum temporal_instants(PG_FUNCTION_ARGS);
+extern Datum temporal_unnest_instants(PG_FUNCTION_ARGS);
 extern Datum temporal_num_timestamps(PG_FUNCTION_ARGS);
 extern Datum temporal_start_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_end_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_timestamp_n(PG_FUNCTION_ARGS);
+extern Datum temporal_timestamps(PG_FUNCTION_ARGS);
+extern Datum temporal_unnest_timestamps(PG_FUNCTION_ARGS);
+extern Datum temporal_unnest(PG_FUNCTION_ARGS);
 extern Datum temporal_shift(PG_FUNCTION_ARGS);
 
 extern PeriodSet *temporal_get_time_internal(const Temporal *temp);
+extern int temporal_num_instants_internal(const Temporal *temp);
 extern Datum tfloat_ranges(const Temporal *temp);
 extern TInstant *temporal_min_instant(const Temporal *temp);
 extern Datum temporal_min_value_internal(const Temporal *temp);
@@ -528,6 +663,12 @@ extern TInstant *temporal_end_instant_internal(const Temporal *temp);
 extern TimestampTz temporal_start_timestamp_internal(const Temporal *temp);
 extern RangeType *tnumber_value_range_internal(const Temporal *temp);
 
+extern void tinstant_iterator_init(TInstantIterator *iter,
+  const Temporal *temp);
+extern const TInstant *tinstant_iterator_next(TInstantIterator *iter);
+extern bool tinstant_iterator_next_timestamp(TInstantIterator *iter,
+  TimestampTz *t);
+
 /* Ever/always equal operators */
 
 extern Datum temporal_ever_eq(PG_FUNCTION_ARGS);
@@ -568,6 +709,7 @@ extern Datum temporal_minus_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_value_at_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_at_timestampset(PG_FUNCTION_ARGS);
 extern Datum temporal_minus_timestampset(PG_FUNCTION_ARGS);
+extern Datum temporal_sample(PG_FUNCTION_ARGS);
 extern Datum temporal_at_period(PG_FUNCTION_ARGS);
 extern Datum temporal_minus_period(PG_FUNCTION_ARGS);
 extern Datum temporal_at_periodset(PG_FUNCTION_ARGS);
@@ -579,6 +721,10 @@ extern Datum temporal_intersects_periodset(PG_FUNCTION_ARGS);
 
 extern bool temporal_value_at_timestamp_inc(const Temporal *temp,
   TimestampTz t, Datum *value);
+extern bool temporal_value_at_timestamp_slice(Datum tempdatum, TimestampTz t,
+  Datum *result);
+extern bool temporal_value_at_timestamp_cursor(const Temporal *temp,
+  TimestampTz t, TimestampCursor *cursor, Datum *result);
 
 extern bool temporal_bbox_restrict_value(const Temporal *temp, Datum value);
 extern Datum *temporal_bbox_restrict_values(const Temporal *temp,
@@ -594,6 +740,10 @@ extern Temporal *tnumber_restrict_range_internal(const Temporal *temp,
   RangeType *range, bool atfunc);
 extern Temporal *temporal_restrict_timestamp_internal(const Temporal *temp,
   TimestampTz t, bool atfunc);
+extern Temporal *temporal_restrict_timestampset_internal(const Temporal *temp,
+  const TimestampSet *ts, bool atfunc);
+extern Temporal *temporal_sample_internal(const Temporal *temp,
+  const Interval *duration);
 extern Temporal *temporal_at_period_internal(const Temporal *temp,
   const Period *ps);
 extern Temporal *temporal_minus_period_internal(const Temporal *temp,
@@ -606,6 +756,9 @@ extern char *temporal_to_string(const Temporal *temp,
   char *(*value_out)(Oid, Datum));
 extern void *temporal_bbox_ptr(const Temporal *temp);
 extern void temporal_bbox(void *box, const Temporal *temp);
+extern void temporal_bbox_slice(void *box, Datum tempdatum);
+extern void temporal_period_slice(Period *p, Datum tempdatum);
+extern void temporal_counts_slice(int *ninsts, int *nseqs, Datum tempdatum);
 
 /* Comparison functions */
 
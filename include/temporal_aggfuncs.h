@@ -15,6 +15,7 @@
 
 #include <postgres.h>
 #include <catalog/pg_type.h>
+#include <storage/buffile.h>
 #include "temporal.h"
 
 /*****************************************************************************/
@@ -24,35 +25,135 @@
 #define SKIPLIST_MAXLEVEL 32   // maximum possible is 47 with current RNG
 #define SKIPLIST_INITIAL_CAPACITY 1024
 #define SKIPLIST_GROW 2
-#define SKIPLIST_INITIAL_FREELIST 32
+#define SKIPLIST_ARENA_BLOCKSIZE (64 * 1024)
+#define SKIPLIST_SPILL_MINSIZE (256 * 1024)
 
 /**
- * Structure to represent elements in the skiplists
+ * Structure to represent elements in the skiplists. The next pointers of
+ * an element are stored in the array of towers of the skiplist, starting
+ * at position tower, so that each element only takes as many next pointers
+ * as its height.
  */
 typedef struct
 {
   Temporal *value;
   int height;
-  int next[SKIPLIST_MAXLEVEL];
+  int tower;
 } Elem;
 
 /**
- * Structure to represent skiplists that keep the current state of an aggregation
+ * Structure to represent skiplists that keep the current state of an aggregation.
+ * The temporal values are allocated in an arena and the elements and their
+ * towers are allocated by bumping a pointer. The elements that are removed
+ * by a splice are not recycled: the memory is reclaimed in bulk by rebuilding
+ * the skiplist when the removed elements exceed the live ones.
+ *
+ * When the memory used by all the skiplists of the backend exceeds
+ * work_mem, the values of a large skiplist except the last one are written
+ * as a sorted run in a temporary file and the skiplist restarts from the
+ * last value. The runs are merged back with the aggregation function of
+ * the skiplist when its values are read.
  */
 typedef struct
 {
   int capacity;
   int next;
   int length;
-  int *freed;
-  int freecount;
-  int freecap;
   int tail;
+  int *towers;
+  int towercap;
+  int towernext;
+  MemoryContext arena;
+  size_t livesize;
+  size_t deadsize;
+  size_t accounted;                /**< footprint counted in the total */
+  BufFile *runs;                   /**< runs spilled to disk, NULL if none */
+  int nruns;                       /**< number of runs */
+  bool merging;                    /**< true while the runs are merged */
+  Datum (*func)(Datum, Datum);     /**< aggregation function of the runs */
+  bool crossings;                  /**< turning points added when merging */
   void *extra;
   size_t extrasize;
   Elem *elems;
 } SkipList;
 
+/* Next pointer of the element of the skiplist at the level */
+#define SKIPLIST_NEXT(list, cur, level) \
+  ((list)->towers[(list)->elems[(cur)].tower + (level)])
+
+/* SweepState - Internal type for computing aggregates with a sweep line */
+
+#define SWEEPSTATE_INITIAL_CAPACITY 1024
+
+/**
+ * Structure to represent the events of a sweep-line aggregation, that is,
+ * the change of the count and of the value of the aggregate at and after
+ * a timestamp
+ */
+typedef struct
+{
+  TimestampTz t;
+  int32 count_at;
+  int32 count_after;
+  int64 value_at;
+  int64 value_after;
+} SweepEvent;
+
+/**
+ * Structure to represent the state of a sweep-line aggregation
+ */
+typedef struct
+{
+  TDuration duration;
+  int capacity;
+  int count;
+  SweepEvent *events;
+} SweepState;
+
+/* PeriodUnionState - Internal type for computing the union of periods */
+
+#define PERIODUNION_INITIAL_CAPACITY 1024
+
+/**
+ * Structure to represent the state of a union aggregation of periods, the
+ * first normalized periods of the array are sorted and disjoint
+ */
+typedef struct
+{
+  int capacity;
+  int count;
+  int normalized;
+  Period *periods;
+} PeriodUnionState;
+
+/* SeqAggState - Internal type for building sequences from instants */
+
+#define SEQAGG_INITIAL_CAPACITY 64
+
+/**
+ * Structure to represent a value and its timestamp in a sequence
+ * aggregation
+ */
+typedef struct
+{
+  TimestampTz t;
+  Datum value;
+} SeqAggPair;
+
+/**
+ * Structure to represent the state of a sequence aggregation, the pairs
+ * are kept in the order in which they are aggregated
+ */
+typedef struct
+{
+  Oid valuetypid;
+  bool linear;
+  int64 gap;          /**< maximum gap in microseconds, 0 for no gap */
+  int capacity;
+  int count;
+  SeqAggPair *pairs;
+} SeqAggState;
+
 /*****************************************************************************/
 
 extern Datum datum_min_int32(Datum l, Datum r);
@@ -67,8 +168,12 @@ extern Datum datum_sum_double2(Datum l, Datum r);
 extern Datum datum_sum_double3(Datum l, Datum r);
 extern Datum datum_sum_double4(Datum l, Datum r);
 
+extern MemoryContext set_aggregation_context(FunctionCallInfo fcinfo);
+extern void unset_aggregation_context(MemoryContext ctx);
+
 extern Temporal *skiplist_headval(SkipList *list);
 extern Temporal **skiplist_values(SkipList *list);
+extern void skiplist_merge_runs(FunctionCallInfo fcinfo, SkipList *list);
 extern SkipList *skiplist_make(FunctionCallInfo fcinfo, Temporal **values, 
   int count);
 extern void skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, 
@@ -78,6 +183,9 @@ extern void aggstate_set_extra(FunctionCallInfo fcinfo, SkipList *state,
 
 extern SkipList *tsequence_tagg_transfn(FunctionCallInfo fcinfo, SkipList *state, 
   TSequence *seq, Datum (*func)(Datum, Datum), bool interpoint);
+extern SkipList *tsequenceset_tagg_transfn(FunctionCallInfo fcinfo,
+  SkipList *state, const TSequenceSet *ts, Datum (*func)(Datum, Datum),
+  bool crossings);
 extern SkipList *temporal_tagg_combinefn1(FunctionCallInfo fcinfo, SkipList *state1,
   SkipList *state2, Datum (*func)(Datum, Datum), bool crossings);
 
@@ -101,13 +209,24 @@ extern Datum tint_tmax_combinefn(PG_FUNCTION_ARGS);
 extern Datum tfloat_tmax_transfn(PG_FUNCTION_ARGS);
 extern Datum tfloat_tmax_combinefn(PG_FUNCTION_ARGS);
 extern Datum tint_tsum_transfn(PG_FUNCTION_ARGS);
+extern Datum tint_tsum_invfn(PG_FUNCTION_ARGS);
 extern Datum tint_tsum_combinefn(PG_FUNCTION_ARGS);
 extern Datum tfloat_tsum_transfn(PG_FUNCTION_ARGS);
 extern Datum tfloat_tsum_combinefn(PG_FUNCTION_ARGS);
 extern Datum temporal_tcount_transfn(PG_FUNCTION_ARGS);
-extern Datum temporal_tcount_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_invfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tagg_sweep_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_tagg_sweep_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tagg_sweep_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_tagg_sweep_deserialize(PG_FUNCTION_ARGS);
+extern Datum temporal_tagg_sweep_merge_transfn(PG_FUNCTION_ARGS);
+
+extern SweepState *periodset_tcount_events(FunctionCallInfo fcinfo,
+  SweepState *state, const PeriodSet *ps, TDuration duration, bool inverse);
+
 extern Datum tnumber_tavg_transfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_combinefn(PG_FUNCTION_ARGS);
+extern Datum tnumber_tavg_merge_transfn(PG_FUNCTION_ARGS);
 extern Datum temporal_tagg_finalfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_finalfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmin_transfn(PG_FUNCTION_ARGS);
@@ -115,6 +234,19 @@ extern Datum ttext_tmin_combinefn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmax_transfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmax_combinefn(PG_FUNCTION_ARGS);
 
+extern Datum period_union_transfn(PG_FUNCTION_ARGS);
+extern Datum periodset_union_transfn(PG_FUNCTION_ARGS);
+extern Datum period_union_combinefn(PG_FUNCTION_ARGS);
+extern Datum period_union_finalfn(PG_FUNCTION_ARGS);
+extern Datum period_union_serialize(PG_FUNCTION_ARGS);
+extern Datum period_union_deserialize(PG_FUNCTION_ARGS);
+
+extern Datum tsequence_agg_transfn(PG_FUNCTION_ARGS);
+extern Datum tsequence_agg_combinefn(PG_FUNCTION_ARGS);
+extern Datum tsequence_agg_finalfn(PG_FUNCTION_ARGS);
+extern Datum tsequence_agg_serialize(PG_FUNCTION_ARGS);
+extern Datum tsequence_agg_deserialize(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
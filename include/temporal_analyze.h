@@ -19,6 +19,14 @@
 #include <parser/parse_oper.h>
 #include <statistics/extended_stats_internal.h>
 
+/*
+ * The kinds of statistics of the base values of temporal values that do
+ * not have a value dimension. They cannot be STATISTIC_KIND_MCV, which is
+ * used by eqsel for the values of the column itself.
+ */
+#define STATISTIC_KIND_EVER_VALUES    11
+#define STATISTIC_KIND_ALWAYS_VALUES  12
+
 /* 
  * Extra data for compute_stats function 
  * Structure based on the ArrayAnalyzeExtraData from file array_typanalyze.c
@@ -86,6 +94,8 @@ typedef struct
  *****************************************************************************/
 
 extern void temporal_extra_info(VacAttrStats *stats);
+extern void temporal_count_stats(VacAttrStats *stats, double ninsts,
+  double nseqs);
 
 extern void tinstant_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   int samplerows, double totalrows);
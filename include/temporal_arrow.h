@@ -0,0 +1,87 @@
+/*****************************************************************************
+ *
+ * temporal_arrow.h
+ *    Columnar export of temporal values in the memory layout of Apache Arrow
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_ARROW_H__
+#define __TEMPORAL_ARROW_H__
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/** Version of the columnar format */
+#define ARROW_VERSION         1
+
+/** Size of the header of the columnar format, a multiple of the alignment */
+#define ARROW_HEADER_SIZE     24
+
+/** Alignment of the buffers of the columnar format */
+#define ARROW_ALIGNMENT       8
+
+/** Difference in microseconds between the PostgreSQL and the Unix epochs */
+#define ARROW_EPOCH_OFFSET \
+  ((int64) (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY)
+
+/**
+ * Structure to represent the state of the columnar export of temporal
+ * values, where the value columns are arrays of int32 or float8 values
+ */
+typedef struct
+{
+  Oid valuetypid;      /**< Oid of the base type */
+  int32 srid;          /**< SRID of the temporal points */
+  int ncols;           /**< Number of value columns */
+  size_t valuesize;    /**< Size of the elements of the value columns */
+  int count;           /**< Number of temporal values */
+  int maxcount;        /**< Number of offsets allocated */
+  int32 *offsets;      /**< Offsets of the instants of each temporal value */
+  int ninsts;          /**< Number of instants */
+  int maxinsts;        /**< Number of instants allocated */
+  int64 *times;        /**< Timestamps of the instants */
+  char *values[3];     /**< Value columns */
+} ArrowState;
+
+/**
+ * Structure to represent the state of the import of temporal values from a
+ * buffer in the columnar format
+ */
+typedef struct
+{
+  Oid valuetypid;      /**< Oid of the base type */
+  int32 srid;          /**< SRID of the temporal points */
+  int ncols;           /**< Number of value columns */
+  size_t valuesize;    /**< Size of the elements of the value columns */
+  int count;           /**< Number of temporal values */
+  int ninsts;          /**< Number of instants */
+  int32 *offsets;      /**< Offsets of the instants of each temporal value */
+  int64 *times;        /**< Timestamps of the instants */
+  char *values[3];     /**< Value columns */
+  int64 gap;           /**< Maximum gap in microseconds, 0 for no gap */
+  int i;               /**< Number of the current temporal value */
+} ArrowReadState;
+
+/*****************************************************************************/
+
+extern Datum temporal_arrow_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_arrow_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_from_arrow(PG_FUNCTION_ARGS);
+
+extern ArrowState *arrowstate_add(ArrowState *state, const Temporal *temp);
+extern bytea *arrowstate_write(const ArrowState *state);
+extern void arrowread_init(ArrowReadState *state, const bytea *buffer,
+  Oid valuetypid);
+
+/*****************************************************************************/
+
+#endif
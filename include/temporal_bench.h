@@ -0,0 +1,62 @@
+/*****************************************************************************
+ *
+ * temporal_bench.h
+ *    Micro-benchmarks of the core functions on temporal values.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_BENCH_H__
+#define __TEMPORAL_BENCH_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Enumeration for the functions that can be benchmarked
+ */
+typedef enum
+{
+  BENCH_MAKE,
+  BENCH_VALUE_AT_TIMESTAMP,
+  BENCH_SYNC,
+  BENCH_AT_GEOMETRY,
+  BENCH_TDWITHIN,
+  BENCH_PARSE,
+  BENCH_OUTPUT,
+} BenchKernel;
+
+/**
+ * Structure to represent the input of a benchmark, which is prepared
+ * before the measures
+ */
+typedef struct
+{
+  BenchKernel kernel;  /**< Function benchmarked */
+  Temporal *temp1;     /**< First temporal value */
+  Temporal *temp2;     /**< Second temporal value, may be NULL */
+  Datum geom;          /**< Geometry, may be 0 */
+  TInstant **instants; /**< Instants of the first temporal value */
+  int count;           /**< Number of instants of the first value */
+  char *str;           /**< Text representation of the first value */
+} BenchInput;
+
+/** Distance used in the benchmark of tdwithin */
+#define BENCH_TDWITHIN_DIST 1.0
+
+/*****************************************************************************/
+
+extern Datum temporal_bench(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
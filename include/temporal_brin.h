@@ -0,0 +1,30 @@
+/*****************************************************************************
+ *
+ * temporal_brin.h
+ *    BRIN index for temporal types
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_BRIN_H__
+#define __TEMPORAL_BRIN_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+#include "temporal.h"
+
+/*****************************************************************************/
+
+extern Datum temporal_brin_opcinfo(PG_FUNCTION_ARGS);
+extern Datum tnumber_brin_add_value(PG_FUNCTION_ARGS);
+extern Datum tnumber_brin_consistent(PG_FUNCTION_ARGS);
+extern Datum tnumber_brin_union(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ *
+ * temporal_counters.h
+ *    Counters of the work done by the hot paths of the extension
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_COUNTERS_H__
+#define __TEMPORAL_COUNTERS_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the counters of a backend
+ */
+typedef struct
+{
+  uint64 detoast_count;       /**< temporal values detoasted */
+  uint64 detoast_bytes;       /**< bytes of the detoasted values */
+  uint64 detoast_slices;      /**< slices detoasted instead of full values */
+  uint64 detoast_hits;        /**< values found in the detoast cache */
+  uint64 packed_skips;        /**< chunks of packed values skipped */
+  uint64 cache_probes;        /**< probes of values cached across calls */
+  uint64 bbox_hits;           /**< bounding box tests that succeeded */
+  uint64 bbox_misses;         /**< bounding box tests that failed */
+  uint64 postgis_calls;       /**< calls to the PostGIS spatial relationships */
+  uint64 sync_calls;          /**< synchronizations of two temporal values */
+  uint64 sync_instants;       /**< instants of the synchronized results */
+  uint64 skiplist_splices;    /**< splices in the skiplists of aggregates */
+  uint64 skiplist_maxlength;  /**< maximum length of a skiplist */
+  uint64 skiplist_spills;     /**< runs of skiplists spilled to disk */
+} MobilityCounters;
+
+extern bool track_counters;
+extern MobilityCounters mobdb_counters;
+
+/* The counters are only maintained when mobilitydb.track_counters is on */
+
+#define COUNTER_ADD(field, n) \
+  do { \
+    if (track_counters) \
+      mobdb_counters.field += (uint64) (n); \
+  } while (0)
+
+#define COUNTER_INC(field) COUNTER_ADD(field, 1)
+
+#define COUNTER_MAX(field, n) \
+  do { \
+    if (track_counters && (uint64) (n) > mobdb_counters.field) \
+      mobdb_counters.field = (uint64) (n); \
+  } while (0)
+
+#define COUNTER_BBOX(result) \
+  do { \
+    if (result) \
+      COUNTER_INC(bbox_hits); \
+    else \
+      COUNTER_INC(bbox_misses); \
+  } while (0)
+
+/*****************************************************************************/
+
+extern Datum mobilitydb_stats(PG_FUNCTION_ARGS);
+extern Datum mobilitydb_stats_reset(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,34 @@
+/*****************************************************************************
+ *
+ * temporal_detoast.h
+ *    Detoasting of the temporal values with a cache of the backend
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_DETOAST_H__
+#define __TEMPORAL_DETOAST_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+/*****************************************************************************/
+
+/**
+ * Number of values kept in the detoast cache of the backend
+ */
+#define DETOAST_CACHE_ENTRIES   8
+
+extern int detoast_cache_size;
+
+/*****************************************************************************/
+
+extern struct varlena *temporal_detoast(Datum value);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ *
+ * temporal_expanded.h
+ *    Expanded representation of temporal instant sets and sequences.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_EXPANDED_H__
+#define __TEMPORAL_EXPANDED_H__
+
+#include <postgres.h>
+#include <utils/expandeddatum.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Magic number identifying the expanded temporal values
+ */
+#define EOT_MAGIC 0x4D4F4244
+
+/**
+ * Structure to represent an expanded temporal instant set or sequence
+ *
+ * The instants are kept in a growable array so that appending an instant
+ * does not copy the previous ones, and so that the lifted arithmetic
+ * operators may update their values in place. The flat value, including
+ * its bounding box, is only built when it is requested and is kept until
+ * the next modification.
+ */
+typedef struct
+{
+  ExpandedObjectHeader hdr;  /**< standard header of expanded objects */
+  int eot_magic;             /**< EOT_MAGIC */
+  int16 duration;            /**< INSTANTSET or SEQUENCE */
+  bool lower_inc;            /**< lower bound of a sequence */
+  bool upper_inc;            /**< upper bound of a sequence */
+  bool linear;               /**< interpolation of a sequence */
+  bool normalize;            /**< true if the flat sequence is normalized */
+  int count;                 /**< number of instants */
+  int maxcount;              /**< size of the array of instants */
+  TInstant **instants;       /**< instants of the value */
+  Temporal *flat;            /**< flat value, NULL if it must be built */
+} ExpandedTemporal;
+
+/*****************************************************************************/
+
+extern bool temporal_expandable(const Temporal *temp);
+extern Datum expand_temporal(const Temporal *temp,
+  MemoryContext parentcontext);
+extern ExpandedTemporal *expanded_temporal_new(int16 duration, int count,
+  MemoryContext parentcontext);
+extern ExpandedTemporal *DatumGetExpandedTemporalRW(Datum value);
+extern bool expanded_temporal_append(ExpandedTemporal *eot,
+  const TInstant *inst);
+extern void expanded_temporal_set_value(ExpandedTemporal *eot, int n,
+  Datum value, Oid valuetypid);
+
+/*****************************************************************************/
+
+#endif
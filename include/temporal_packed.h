@@ -0,0 +1,41 @@
+/*****************************************************************************
+ *
+ * temporal_packed.h
+ *    Packed (compressed columnar) storage of temporal values.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_PACKED_H__
+#define __TEMPORAL_PACKED_H__
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Number of instants of the chunks of packed values
+ */
+#define PACKED_CHUNK_INSTANTS   128
+
+/*****************************************************************************/
+
+extern bool temporal_packable(Oid valuetypid);
+extern void *temporalpacked_bbox_ptr(const TemporalPacked *temp);
+extern int temporalpacked_nchunks(const TemporalPacked *temp);
+
+extern Temporal *temporalpacked_decode_period(const TemporalPacked *temp,
+  const Period *p);
+extern Temporal *temporalpacked_decode_stbox(const TemporalPacked *temp,
+  const STBOX *box);
+
+/*****************************************************************************/
+
+#endif
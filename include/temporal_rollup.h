@@ -0,0 +1,30 @@
+/*****************************************************************************
+ *
+ * temporal_rollup.h
+ *    Background worker refreshing the rollups of temporal aggregates
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_ROLLUP_H__
+#define __TEMPORAL_ROLLUP_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+/*****************************************************************************/
+
+extern char *rollup_database;
+extern int rollup_naptime;
+
+extern void rollup_worker_init(void);
+
+extern PGDLLEXPORT void rollup_worker_main(Datum arg);
+
+/*****************************************************************************/
+
+#endif
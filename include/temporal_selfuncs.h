@@ -38,6 +38,8 @@ extern Selectivity scalarineqsel(PlannerInfo *root, Oid operator,
   Oid consttype);
 extern Selectivity temporal_sel_internal(PlannerInfo *root, VariableStatData *vardata,
   Period *period, CachedOp cachedOp);
+extern Selectivity temporal_ever_sel_internal(VariableStatData *vardata,
+  Datum value, Oid valuetypid, CachedOp cachedOp, bool ever);
 
 
 /*****************************************************************************
@@ -52,6 +54,7 @@ extern double var_eq_const(VariableStatData *vardata, Oid operator,
 /*****************************************************************************/
 
 extern Datum temporal_sel(PG_FUNCTION_ARGS);
+extern Datum temporal_ever_sel(PG_FUNCTION_ARGS);
 extern Datum temporal_joinsel(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
@@ -0,0 +1,43 @@
+/*****************************************************************************
+ *
+ * temporal_statscache.h
+ *    Cache of the decoded statistics used by the selectivity functions
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_STATSCACHE_H__
+#define __TEMPORAL_STATSCACHE_H__
+
+#include <postgres.h>
+#include <utils/selfuncs.h>
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent a copy of a statistics slot of a column
+ */
+typedef struct
+{
+  Oid         valuetype;   /**< type of the values */
+  Datum      *values;      /**< copy of the values of the slot */
+  int         nvalues;     /**< number of values */
+  float4     *numbers;     /**< copy of the numbers of the slot */
+  int         nnumbers;    /**< number of numbers */
+  void       *hist_lower;  /**< lower bounds decoded from the values */
+  void       *hist_upper;  /**< upper bounds decoded from the values */
+  MemoryContext mcxt;      /**< context where decoded data is allocated */
+} CachedStatsSlot;
+
+/*****************************************************************************/
+
+extern CachedStatsSlot *statscache_slot(VariableStatData *vardata, int kind,
+  int flags);
+
+/*****************************************************************************/
+
+#endif
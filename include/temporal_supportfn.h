@@ -0,0 +1,29 @@
+/*****************************************************************************
+ *
+ * temporal_supportfn.h
+ *    Planner support functions for temporal types
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_SUPPORTFN_H__
+#define __TEMPORAL_SUPPORTFN_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+#include "temporal.h"
+
+/*****************************************************************************/
+
+#if MOBDB_PGSQL_VERSION >= 120000
+extern Datum temporal_supportfn(PG_FUNCTION_ARGS);
+#endif
+
+/*****************************************************************************/
+
+#endif
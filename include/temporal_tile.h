@@ -0,0 +1,108 @@
+/*****************************************************************************
+ *
+ * temporal_tile.h
+ *    Splitting of temporal values into time buckets and value buckets
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_TILE_H__
+#define __TEMPORAL_TILE_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+#include <utils/timestamp.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the state of the splitting of a temporal value
+ * into time buckets
+ */
+typedef struct
+{
+  Temporal *temp;      /**< Temporal value to split */
+  int64 size;          /**< Size of the buckets in microseconds */
+  TimestampTz bucket;  /**< Start of the current bucket */
+  TimestampTz end;     /**< Start of the last bucket */
+  bool done;           /**< True when all the buckets have been visited */
+} TimeSplitState;
+
+/**
+ * Structure to represent the state of the splitting of a temporal number
+ * into value buckets
+ */
+typedef struct
+{
+  Temporal *temp;      /**< Temporal number to split */
+  double width;        /**< Width of the buckets */
+  double start;        /**< Start of the first bucket */
+  int64 i;             /**< Number of the current bucket */
+  int64 count;         /**< Number of buckets */
+} ValueSplitState;
+
+/**
+ * Structure to represent the time-weighted statistics of a temporal number
+ * in a time bucket
+ */
+typedef struct
+{
+  TimestampTz bucket;  /**< Start of the bucket */
+  int32 count;         /**< Number of instants in the bucket */
+  double min;          /**< Minimum value in the bucket */
+  double max;          /**< Maximum value in the bucket */
+  double integral;     /**< Integral of the value over the bucket */
+  double sum;          /**< Sum of the values of the instants */
+  int64 duration;      /**< Duration of the value in the bucket */
+} BucketStats;
+
+/**
+ * Structure to represent the state of the time-bucketed aggregation of
+ * temporal numbers
+ */
+typedef struct
+{
+  int64 size;          /**< Size of the buckets in microseconds */
+  TimestampTz origin;  /**< Origin of the buckets */
+  int capacity;        /**< Number of statistics that fit in the state */
+  int count;           /**< Number of statistics of the state */
+  BucketStats *stats;  /**< Statistics, not necessarily sorted or unique */
+} BucketAggState;
+
+#define BUCKETAGG_INITIAL_CAPACITY 1024
+
+/** Default origin of the time buckets, Monday 2000-01-03 at midnight UTC */
+#define BUCKET_DEFAULT_ORIGIN (2 * USECS_PER_DAY)
+
+/*****************************************************************************/
+
+extern int64 interval_units(const Interval *interval);
+extern TimestampTz timestamptz_bucket_internal(TimestampTz t, int64 size,
+  TimestampTz origin);
+extern TimeSplitState *timesplit_state_make(Temporal *temp, int64 size,
+  TimestampTz origin);
+extern Temporal *timesplit_state_next(TimeSplitState *state,
+  TimestampTz *bucket);
+
+extern BucketStats *tnumber_bucket_stats_internal(const Temporal *temp,
+  int64 size, TimestampTz origin, int *count);
+
+extern Datum temporal_time_split(PG_FUNCTION_ARGS);
+extern Datum tnumber_value_split(PG_FUNCTION_ARGS);
+extern Datum tnumber_bucket_stats(PG_FUNCTION_ARGS);
+extern Datum tnumber_bucket_avg_transfn(PG_FUNCTION_ARGS);
+extern Datum tnumber_bucket_avg_combinefn(PG_FUNCTION_ARGS);
+extern Datum tnumber_bucket_avg_finalfn(PG_FUNCTION_ARGS);
+extern Datum tnumber_bucket_avg_serialize(PG_FUNCTION_ARGS);
+extern Datum tnumber_bucket_avg_deserialize(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -26,6 +26,19 @@
 
 /*****************************************************************************/
 
+/** Minimum number of elements of an array that is sorted with radix sort */
+#define RADIX_SORT_MINCOUNT 64
+
+/** Number of elements summarized by each key of the time summary of
+ * temporal instant set and sequence set values */
+#define TIME_SUMMARY_BLOCK_SIZE 16
+
+/** Minimum number of elements of the temporal instant set and sequence set
+ * values that keep a time summary */
+#define TIME_SUMMARY_MINCOUNT 64
+
+/*****************************************************************************/
+
 /* Miscellaneous functions */
 
 extern void _PG_init(void);
@@ -35,6 +48,12 @@ extern int get_typlen_fast(Oid type);
 extern Datum datum_copy(Datum value, Oid type);
 extern double datum_double(Datum d, Oid valuetypid);
 
+/* Time summary functions */
+
+extern int time_summary_count(int count);
+extern int time_summary_find(const TimestampTz *keys, int count,
+  TimestampTz t);
+
 /* PostgreSQL call helpers */
 
 extern Datum call_input(Oid type, char *str);
@@ -92,6 +111,7 @@ extern int tinstantarr_remove_duplicates(TInstant **instants, int count);
 /* Text functions */
 
 extern int text_cmp(text *arg1, text *arg2, Oid collid);
+extern bool text_eq(text *arg1, text *arg2);
 
 /* Comparison functions on datums */
 
@@ -115,12 +135,24 @@ extern Datum datum2_lt2(Datum l, Datum r, Oid typel, Oid typer);
 extern Datum datum2_le2(Datum l, Datum r, Oid typel, Oid typer);
 extern Datum datum2_gt2(Datum l, Datum r, Oid typel, Oid typer);
 extern Datum datum2_ge2(Datum l, Datum r, Oid typel, Oid typer);
+extern Datum (*datum2_comp_func(Datum (*func)(Datum, Datum, Oid, Oid),
+  Oid typel, Oid typer))(Datum, Datum, Oid, Oid);
 
 /* Hypothenuse functions */
 
 extern double hypot3d(double x, double y, double z);
 extern double hypot4d(double x, double y, double z, double m);
 
+/* Float4 rounding functions */
+
+extern float4 float4_round_down(double d);
+extern float4 float4_round_up(double d);
+
+/* Z-order functions */
+
+extern uint32 zorder_cell(double value, double min, double max, int bits);
+extern uint64 zorder_encode(const uint32 *cells, int ndims, int bits);
+
 /*****************************************************************************/
 
 #endif
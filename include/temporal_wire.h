@@ -0,0 +1,49 @@
+/*****************************************************************************
+ *
+ * temporal_wire.h
+ *    Compact binary format of temporal values for send/receive.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_WIRE_H__
+#define __TEMPORAL_WIRE_H__
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <lib/stringinfo.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/** Bit set in the first byte of the compact format */
+#define WIRE_MARKER         0x80
+/** Version of the compact format */
+#define WIRE_VERSION        1
+
+/** Codes of the base types in the compact format */
+#define WIRE_TYPE_BOOL      1
+#define WIRE_TYPE_INT4      2
+#define WIRE_TYPE_FLOAT8    3
+#define WIRE_TYPE_TEXT      4
+#define WIRE_TYPE_GEOMETRY  5
+#define WIRE_TYPE_GEOGRAPHY 6
+
+/** Flags of the compact format */
+#define WIRE_FLAG_LINEAR    0x01
+#define WIRE_FLAG_Z         0x02
+
+/*****************************************************************************/
+
+extern bool temporal_wire_is_compact(StringInfo buf);
+extern void temporal_wire_write(const Temporal *temp, StringInfo buf);
+extern Temporal *temporal_wire_read(StringInfo buf, Oid valuetypid);
+
+/*****************************************************************************/
+
+#endif
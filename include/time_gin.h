@@ -0,0 +1,49 @@
+/*****************************************************************************
+ *
+ * time_gin.h
+ *    Inverted GIN index for period sets.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TIME_GIN_H__
+#define __TIME_GIN_H__
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include "timetypes.h"
+
+/*****************************************************************************/
+
+/**
+ * Maximum number of keys of a period set in a GIN index, the closest
+ * periods of a period set with more periods are merged
+ */
+#define GIN_PERIODSET_MAX_KEYS        32
+
+/* Strategy numbers of the GIN operator class, one per query type */
+
+#define GinOverlapsTimestampSetStrategy  1
+#define GinOverlapsPeriodStrategy        2
+#define GinOverlapsPeriodSetStrategy     3
+#define GinContainsTimestampStrategy     4
+#define GinContainsTimestampSetStrategy  5
+#define GinContainsPeriodStrategy        6
+#define GinContainsPeriodSetStrategy     7
+
+/*****************************************************************************/
+
+extern Datum periodset_gin_extract_value(PG_FUNCTION_ARGS);
+extern Datum periodset_gin_extract_query(PG_FUNCTION_ARGS);
+extern Datum periodset_gin_compare_partial(PG_FUNCTION_ARGS);
+extern Datum periodset_gin_consistent(PG_FUNCTION_ARGS);
+
+extern Datum *periodset_gin_keys(const PeriodSet *ps, int32 *nkeys);
+
+#endif
+
+/*****************************************************************************/
@@ -26,6 +26,7 @@ extern Datum periodset_gist_compress(PG_FUNCTION_ARGS);
 extern Datum period_gist_penalty(PG_FUNCTION_ARGS);
 extern Datum period_gist_picksplit(PG_FUNCTION_ARGS);
 extern Datum period_gist_same(PG_FUNCTION_ARGS);
+extern Datum period_gist_distance(PG_FUNCTION_ARGS);
 extern Datum period_gist_fetch(PG_FUNCTION_ARGS);
 
 extern int common_entry_cmp(const void *i1, const void *i2);
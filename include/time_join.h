@@ -0,0 +1,44 @@
+/*****************************************************************************
+ *
+ * time_join.h
+ *    Sort-based join of periods on their overlap
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TIME_JOIN_H__
+#define __TIME_JOIN_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+#include "timetypes.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the state of the join of two arrays of periods
+ */
+typedef struct
+{
+  int count;      /**< Number of pairs of overlapping periods */
+  int maxcount;   /**< Size of the arrays of pairs */
+  int *pos1;      /**< Positions of the periods of the first array */
+  int *pos2;      /**< Positions of the periods of the second array */
+  int i;          /**< Number of the current pair */
+} PeriodJoinState;
+
+/*****************************************************************************/
+
+extern PeriodJoinState *period_join_internal(Period **periods1, int count1,
+  Period **periods2, int count2);
+
+extern Datum period_join(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -36,6 +36,9 @@ extern double calc_period_hist_selectivity_adjacent(PeriodBound *lower,
   PeriodBound *upper, PeriodBound *hist_lower,
   PeriodBound *hist_upper, int hist_nvalues);
 
+extern double period_joinsel_overlaps(VariableStatData *vardata1,
+  VariableStatData *vardata2);
+
 extern int length_hist_bsearch(Datum *length_hist_values,
   int length_hist_nvalues, double value, bool equal);
 extern double get_len_position(double value, double hist1, double hist2);
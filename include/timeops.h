@@ -19,6 +19,13 @@
 
 /*****************************************************************************/
 
+/**
+ * Minimum ratio between the number of elements of two time values for
+ * which the operations search the elements of the smaller one in the larger
+ * one instead of merging them
+ */
+#define GALLOP_MIN_RATIO 16
+
 /* Miscellaneous */
 
 extern void ensure_time_type_oid(Oid timetypid);
@@ -325,6 +332,27 @@ extern PeriodSet *minus_periodset_timestampset_internal(const PeriodSet *ps, con
 extern PeriodSet *minus_periodset_period_internal(const PeriodSet *ps, const Period *p);
 extern PeriodSet *minus_periodset_periodset_internal(const PeriodSet *ps1, const PeriodSet *ps2);
 
+/* distance */
+
+extern Datum distance_timestamp_timestampset(PG_FUNCTION_ARGS);
+extern Datum distance_timestamp_period(PG_FUNCTION_ARGS);
+extern Datum distance_timestamp_periodset(PG_FUNCTION_ARGS);
+extern Datum distance_timestampset_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_timestampset_period(PG_FUNCTION_ARGS);
+extern Datum distance_period_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_period_timestampset(PG_FUNCTION_ARGS);
+extern Datum distance_period_period(PG_FUNCTION_ARGS);
+extern Datum distance_period_periodset(PG_FUNCTION_ARGS);
+extern Datum distance_periodset_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_periodset_period(PG_FUNCTION_ARGS);
+
+extern double distance_period_timestamp_internal(const Period *p, TimestampTz t);
+extern double distance_period_period_internal(const Period *p1, const Period *p2);
+extern double distance_timestampset_timestamp_internal(const TimestampSet *ts, TimestampTz t);
+extern double distance_timestampset_period_internal(const TimestampSet *ts, const Period *p);
+extern double distance_periodset_timestamp_internal(const PeriodSet *ps, TimestampTz t);
+extern double distance_periodset_period_internal(const PeriodSet *ps, const Period *p);
+
 #endif
 
 /*****************************************************************************/
\ No newline at end of file
@@ -49,6 +49,7 @@ extern Datum timestampset_to_period(PG_FUNCTION_ARGS);
 /* Accessor functions */
 
 extern Datum timestampset_mem_size(PG_FUNCTION_ARGS);
+extern Datum timestampset_legacy_layout(PG_FUNCTION_ARGS);
 extern Datum timestampset_num_timestamps(PG_FUNCTION_ARGS);
 extern Datum timestampset_start_timestamp(PG_FUNCTION_ARGS);
 extern Datum timestampset_end_timestamp(PG_FUNCTION_ARGS);
@@ -52,6 +52,7 @@ typedef struct
 {
   int32 vl_len_;       /**< varlena header (do not touch directly!) */
   int32 count;         /**< number of TimestampTz elements */
+  Period period;       /**< precomputed bounding box */
    /* variable-length data follows */
 } TimestampSet;
 
@@ -62,6 +63,7 @@ typedef struct
 {
   int32 vl_len_;        /**< varlena header (do not touch directly!) */
   int32 count;          /**< number of Period elements */
+  Period period;        /**< precomputed bounding box */
    /* variable-length data follows */
 } PeriodSet;
 
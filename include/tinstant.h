@@ -23,6 +23,9 @@
 
 /*****************************************************************************/
  
+extern size_t tinstant_make_size(Datum value, Oid valuetypid);
+extern void tinstant_init(TInstant *result, Datum value, TimestampTz t,
+  Oid valuetypid, size_t size);
 extern TInstant *tinstant_make(Datum value, TimestampTz t, Oid valuetypid);
 extern TInstant *tinstant_copy(const TInstant *inst);
 extern Datum* tinstant_value_ptr(const TInstant *inst);
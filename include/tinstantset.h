@@ -52,6 +52,8 @@ extern Datum tinstantset_from_base(PG_FUNCTION_ARGS);
 /* Append and merge functions */
 
 extern TInstantSet *tinstantset_append_tinstant(const TInstantSet *ti, const TInstant *inst);
+extern Temporal *tinstantset_append_tinstants(const TInstantSet *ti,
+  TInstant **instants, int count);
 extern Temporal *tinstantset_merge(const TInstantSet *ti1, const TInstantSet *ti2);
 extern Temporal *tinstantset_merge_array(TInstantSet **tis, int count);
 
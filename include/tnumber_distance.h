@@ -0,0 +1,37 @@
+/*****************************************************************************
+ *
+ * tnumber_distance.h
+ *    Distance functions for temporal numbers.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TNUMBER_DISTANCE_H__
+#define __TNUMBER_DISTANCE_H__
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <float.h>
+
+#include "temporal.h"
+#include "tbox.h"
+
+/*****************************************************************************/
+
+extern Datum NAD_number_tnumber(PG_FUNCTION_ARGS);
+extern Datum NAD_tnumber_number(PG_FUNCTION_ARGS);
+extern Datum NAD_tbox_tbox(PG_FUNCTION_ARGS);
+extern Datum NAD_tbox_tnumber(PG_FUNCTION_ARGS);
+extern Datum NAD_tnumber_tbox(PG_FUNCTION_ARGS);
+
+extern double NAD_tnumber_tbox_internal(const Temporal *temp,
+  const TBOX *box);
+extern double NAD_tbox_tbox_internal(const TBOX *box1, const TBOX *box2);
+
+/*****************************************************************************/
+
+#endif
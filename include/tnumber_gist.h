@@ -19,12 +19,39 @@
 
 /*****************************************************************************/
 
+/**
+ * Key of the compact GiST operator classes for temporal numbers, where the
+ * value bounds are float4 values rounded outward
+ */
+typedef struct
+{
+  TimestampTz  tmin;    /**< minimum timestamp */
+  TimestampTz  tmax;    /**< maximum timestamp */
+  float4    xmin;       /**< minimum number value rounded down */
+  float4    xmax;       /**< maximum number value rounded up */
+  int16     flags;      /**< flags */
+} TBOXF;
+
+/* Size of the compact key without the trailing padding */
+#define TBOXF_SIZE    (offsetof(TBOXF, flags) + sizeof(int16))
+
+/*****************************************************************************/
+
 extern Datum tbox_gist_union(PG_FUNCTION_ARGS);
 extern Datum tbox_gist_penalty(PG_FUNCTION_ARGS);
 extern Datum tbox_gist_picksplit(PG_FUNCTION_ARGS);
 extern Datum tnumber_gist_consistent(PG_FUNCTION_ARGS);
 extern Datum tnumber_gist_compress(PG_FUNCTION_ARGS);
 extern Datum tbox_gist_same(PG_FUNCTION_ARGS);
+extern Datum tbox_gist_distance(PG_FUNCTION_ARGS);
+#if MOBDB_PGSQL_VERSION < 110000
+extern Datum tbox_gist_compress(PG_FUNCTION_ARGS);
+extern Datum tbox_gist_fetch(PG_FUNCTION_ARGS);
+#endif
+
+extern Datum tnumber_gist_compact_consistent(PG_FUNCTION_ARGS);
+extern Datum tnumber_gist_compact_compress(PG_FUNCTION_ARGS);
+extern Datum tbox_gist_compact_decompress(PG_FUNCTION_ARGS);
 
 /* The following functions are also called by tpoint_gist.c */
 extern int interval_cmp_lower(const void *i1, const void *i2);
@@ -35,6 +62,11 @@ extern float non_negative(float val);
 extern bool tbox_index_consistent_leaf(const TBOX *key, const TBOX *query, 
   StrategyNumber strategy);
 
+/* The following functions are also called by temporal_brin.c */
+extern bool tbox_gist_consistent_internal(const TBOX *key, const TBOX *query,
+  StrategyNumber strategy);
+extern void tbox_adjust(TBOX *b, const TBOX *addon);
+
 /*****************************************************************************/
 
 #endif
@@ -15,13 +15,18 @@
 
 #include <postgres.h>
 #include <catalog/pg_operator.h>
+#include <utils/selfuncs.h>
 #include "temporal.h"
+#include "oidcache.h"
 
 /*****************************************************************************/
 
 extern Datum tnumber_sel(PG_FUNCTION_ARGS);
 extern Datum tnumber_joinsel(PG_FUNCTION_ARGS);
 
+extern double tnumber_ever_sel_internal(VariableStatData *vardata,
+  Datum value, Oid valuetypid, CachedOp cachedOp, bool ever);
+
 /*****************************************************************************/
 
 #endif
\ No newline at end of file
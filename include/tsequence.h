@@ -22,13 +22,43 @@
 
 /*****************************************************************************/
 
+/**
+ * Structure to represent the metrics precomputed for long temporal
+ * sequence numbers and points
+ */
+typedef struct
+{
+  double length;       /**< Length, for temporal points */
+  double minspeed;     /**< Minimum speed, for temporal points */
+  double maxspeed;     /**< Maximum speed, for temporal points */
+  double integral;     /**< Integral, for temporal numbers */
+  bool spheroid;       /**< True when the geodetic metrics of temporal
+                            points were computed on the spheroid */
+} TSequenceMetrics;
+
+/** Minimum number of instants of the sequences keeping precomputed metrics */
+#define TSEQUENCE_METRICS_MINCOUNT 64
+
+/*****************************************************************************/
+
 extern TInstant *tsequence_inst_n(const TSequence *seq, int index);
+extern TSequence *tsequence_make1(TInstant **instants, int count,
+  bool lower_inc, bool upper_inc, bool linear, bool normalize);
+extern TSequence *tsequence_make_traj(TInstant **instants, int count,
+  bool lower_inc, bool upper_inc, bool linear, bool normalize, bool withtraj);
 extern TSequence *tsequence_make(TInstant **instants, 
   int count, bool lower_inc, bool upper_inc, bool linear, bool normalize);
 extern TSequence *tsequence_make_free(TInstant **instants, 
   int count, bool lower_inc, bool upper_inc, bool linear, bool normalize);
+extern TSequence *tsequence_make_free1(TInstant **instants,
+  int count, bool lower_inc, bool upper_inc, bool linear, bool normalize);
+extern TSequence *tsequence_from_arrays(const TimestampTz *times,
+  const Datum *values, int count, Oid valuetypid, bool lower_inc,
+  bool upper_inc, bool linear, bool normalize);
 extern TSequence *tsequence_copy(const TSequence *seq);
 extern int tsequence_find_timestamp(const TSequence *seq, TimestampTz t);
+extern int tsequence_find_timestamp_cursor(const TSequence *seq,
+  TimestampTz t, int *cursor);
 extern Datum tsequence_value_at_timestamp1(const TInstant *inst1,
   const TInstant *inst2, bool linear, TimestampTz t);
 extern TSequence **tsequencearr_normalize(TSequence **sequences, int count, 
@@ -75,9 +105,14 @@ extern Datum tsequence_from_base(PG_FUNCTION_ARGS);
 /* Append and merge functions */
 
 extern TSequence *tsequence_join(const TSequence *seq1, const TSequence *seq2, bool last, bool first);
+extern bool tsequence_append_replaces_last(const TInstant *inst1,
+  const TInstant *inst2, const TInstant *inst, bool linear);
 extern Temporal *tsequence_append_tinstant(const TSequence *seq, const TInstant *inst);
+extern Temporal *tsequence_append_tinstants(const TSequence *seq,
+  TInstant **instants, int count);
 extern Temporal *tsequence_merge(const TSequence *seq1, const TSequence *seq2);
-extern TSequence **tsequence_merge_array1(TSequence **sequences, int count, int *totalcount);
+extern Temporal *tsequence_merge_sorted(TSequence **sequences, int count,
+  bool seqset);
 extern Temporal *tsequence_merge_array(TSequence **sequences, int count);
 
 /* Cast functions */
@@ -99,6 +134,7 @@ extern ArrayType *tsequence_values(const TSequence *seq);
 extern int tfloatseq_ranges1(RangeType **result, const TSequence *seq);
 extern PeriodSet *tsequence_get_time(const TSequence *seq);
 extern void *tsequence_bbox_ptr(const TSequence *seq);
+extern const TSequenceMetrics *tsequence_metrics_ptr(const TSequence *seq);
 extern void tsequence_bbox(void *box, const TSequence *seq);
 extern RangeType *tfloatseq_range(const TSequence *seq);
 extern ArrayType *tfloatseq_ranges(const TSequence *seq);
@@ -154,6 +190,8 @@ extern TInstant *tsequence_at_timestamp(const TSequence *seq, TimestampTz t);
 
 extern bool tsequence_value_at_timestamp(const TSequence *seq, TimestampTz t,
   Datum *result);
+extern bool tsequence_value_at_timestamp_cursor(const TSequence *seq,
+  TimestampTz t, int *cursor, Datum *result);
 extern bool tsequence_value_at_timestamp_inc(const TSequence *seq, TimestampTz t,
   Datum *result);
 
@@ -161,6 +199,8 @@ extern int tsequence_minus_timestamp1(TSequence **result, const TSequence *seq,
   TimestampTz t);
 extern TSequenceSet *tsequence_minus_timestamp(const TSequence *seq,
   TimestampTz t);
+extern int tsequence_at_timestampset1(TInstant **result, const TSequence *seq,
+  const TimestampSet *ts, int *loc);
 extern TInstantSet *tsequence_at_timestampset(const TSequence *seq,
   const TimestampSet *ts);
 extern int tsequence_minus_timestampset1(TSequence **result, const TSequence *seq,
@@ -25,10 +25,14 @@
 /* General functions */
 
 extern TSequence *tsequenceset_seq_n(const TSequenceSet *ts, int index);
+extern TSequenceSet *tsequenceset_make1(TSequence **sequences, int count,
+  bool normalize);
 extern TSequenceSet *tsequenceset_make(TSequence **sequences, int count,
   bool normalize);
 extern TSequenceSet * tsequenceset_make_free(TSequence **sequences, int count, 
   bool normalize);
+extern TSequenceSet *tsequenceset_make_free1(TSequence **sequences,
+  int count, bool normalize);
 extern TSequenceSet *tsequenceset_copy(const TSequenceSet *ts);
 extern bool tsequenceset_find_timestamp(const TSequenceSet *ts, TimestampTz t,
   int *loc);
@@ -140,6 +144,8 @@ extern TSequenceSet *tsequenceset_restrict_minmax(const TSequenceSet *ts,
   
 extern bool tsequenceset_value_at_timestamp(const TSequenceSet *ts, 
   TimestampTz t, Datum *result);
+extern bool tsequenceset_value_at_timestamp_cursor(const TSequenceSet *ts,
+  TimestampTz t, TimestampCursor *cursor, Datum *result);
 extern bool tsequenceset_value_at_timestamp_inc(const TSequenceSet *ts, 
   TimestampTz t, Datum *result);
 
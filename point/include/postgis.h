@@ -63,6 +63,8 @@ extern int edge_intersection(const GEOGRAPHIC_EDGE *e1, const GEOGRAPHIC_EDGE *e
   GEOGRAPHIC_POINT *g);
 extern double edge_distance_to_edge(const GEOGRAPHIC_EDGE *e1, const GEOGRAPHIC_EDGE *e2,
   GEOGRAPHIC_POINT *closest1, GEOGRAPHIC_POINT *closest2);
+extern float next_float_down(double d);
+extern float next_float_up(double d);
 
 /*****************************************************************************/
 
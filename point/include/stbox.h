@@ -211,6 +211,12 @@ extern Datum stbox_ge(PG_FUNCTION_ARGS);
 extern int stbox_cmp_internal(const STBOX *box1, const STBOX *box2);
 extern bool stbox_eq_internal(const STBOX *box1, const STBOX *box2);
 
+/* Z-order functions */
+
+extern Datum stbox_zorder(PG_FUNCTION_ARGS);
+
+extern int64 stbox_zorder_internal(const STBOX *box, const STBOX *extent);
+
 /*****************************************************************************/
 
 #endif
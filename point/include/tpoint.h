@@ -79,6 +79,23 @@
 #define WKB_LINEAR_INTERP    0x40
 #define WKB_BBOXFLAG         0x80 /* Currently not used */
 
+/*****************************************************************************
+ * Tiny Well-Known Binary (TWKB)
+ *****************************************************************************/
+
+/* Variation flags */
+#define TWKB_ZFLAG           0x01
+#define TWKB_LINEAR_INTERP   0x02
+#define TWKB_SRIDFLAG        0x04
+
+/* Maximum precisions, the time precision is the number of decimal digits
+ * of the seconds */
+#define TWKB_MAX_PRECISION   7
+#define TWKB_MAX_TIME_PRECISION 6
+
+/* Maximum size of a varint-encoded 64-bit integer */
+#define TWKB_MAX_VARINT_SIZE 10
+
 /*****************************************************************************
  * Miscellaneous functions defined in TemporalPoint.c
  *****************************************************************************/
@@ -100,6 +117,7 @@ extern Datum tpointinst_constructor(PG_FUNCTION_ARGS);
 /* Accessor functions */
 
 extern Datum tpoint_stbox(PG_FUNCTION_ARGS);
+extern Datum tpoint_zorder(PG_FUNCTION_ARGS);
 
 /* Ever/always comparison operators */
 
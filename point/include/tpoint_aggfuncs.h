@@ -17,6 +17,57 @@
 #include <fmgr.h>
 #include <catalog/pg_type.h>
 
+#include "temporal.h"
+
+/*****************************************************************************/
+
+#define CENTROIDSTATE_INITIAL_CAPACITY 1024
+
+/**
+ * Point accumulated by the temporal centroid aggregation. For the values of
+ * instant duration, the coordinates are the sums of the coordinates of the
+ * points at the timestamp and count is the number of these points.
+ */
+typedef struct
+{
+  TimestampTz t;            /**< timestamp */
+  double x;                 /**< sum of the x coordinates */
+  double y;                 /**< sum of the y coordinates */
+  double z;                 /**< sum of the z coordinates */
+  int32 count;              /**< number of points */
+} CentroidPoint;
+
+/**
+ * Sequence accumulated by the temporal centroid aggregation, whose points
+ * are kept in the array of points of the state
+ */
+typedef struct
+{
+  int start;                /**< position of the first point */
+  int count;                /**< number of points */
+  bool lower_inc;           /**< lower bound is inclusive */
+  bool upper_inc;           /**< upper bound is inclusive */
+} CentroidSeq;
+
+/**
+ * State of the temporal centroid aggregation. The coordinates of the points
+ * are accumulated directly, the points of the result are only constructed
+ * in the final function.
+ */
+typedef struct
+{
+  TDuration duration;       /**< duration of the result, INSTANT or SEQUENCE */
+  bool linear;              /**< interpolation of the sequences */
+  int32 srid;               /**< SRID of the points */
+  bool hasz;                /**< points have Z dimension */
+  int pointcap;             /**< capacity of the array of points */
+  int pointcount;           /**< number of points */
+  CentroidPoint *points;    /**< array of points */
+  int seqcap;               /**< capacity of the array of sequences */
+  int seqcount;             /**< number of sequences */
+  CentroidSeq *sequences;   /**< array of sequences */
+} CentroidState;
+
 /*****************************************************************************/
 
 extern Datum tpoint_extent_transfn(PG_FUNCTION_ARGS);
@@ -25,6 +76,11 @@ extern Datum tpoint_extent_combinefn(PG_FUNCTION_ARGS);
 extern Datum tpoint_tcentroid_transfn(PG_FUNCTION_ARGS);
 extern Datum tpoint_tcentroid_combinefn(PG_FUNCTION_ARGS);
 extern Datum tpoint_tcentroid_finalfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_tcentroid_serialize(PG_FUNCTION_ARGS);
+extern Datum tpoint_tcentroid_deserialize(PG_FUNCTION_ARGS);
+
+extern Datum tpoint_tcount_within_transfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_tcount_within_invfn(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
@@ -18,6 +18,15 @@
 
 /*****************************************************************************/
 
+/** Initial size of the array of kept instants of the online simplification */
+#define SIMPLIFYSTATE_INITIAL_CAPACITY 64
+
+/** Maximum number of instants dropped in a window of the online
+ * simplification before the last instant is kept anyway */
+#define SIMPLIFYSTATE_MAX_WINDOW 256
+
+/*****************************************************************************/
+
 /* Convert a temporal point into a PostGIS trajectory geometry/geography */
 
 extern Datum tpoint_to_geo(PG_FUNCTION_ARGS);
@@ -33,6 +42,25 @@ extern Datum point_to_geo_measure(PG_FUNCTION_ARGS);
 extern Datum tfloat_simplify(PG_FUNCTION_ARGS);
 extern Datum tpoint_simplify(PG_FUNCTION_ARGS);
 
+/* Multi-resolution pyramid of simplifications of temporal points */
+
+extern Datum tpoint_simplify_pyramid(PG_FUNCTION_ARGS);
+extern Datum tpoint_pyramid_trajectory(PG_FUNCTION_ARGS);
+
+/* Online simplification bounded by the synchronized Euclidean distance */
+
+extern Datum tpoint_simplify_transfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_simplify_finalfn(PG_FUNCTION_ARGS);
+
+/* Stops and trips of temporal points */
+
+extern Datum tpoint_stops(PG_FUNCTION_ARGS);
+extern Datum tpoint_trips(PG_FUNCTION_ARGS);
+
+/* Vector tile geometry of temporal points */
+
+extern Datum tpoint_as_mvtgeom(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
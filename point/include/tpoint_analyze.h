@@ -21,6 +21,9 @@
 #include <commands/vacuum.h>
 #include <liblwgeom.h>
 
+#include "stbox.h"
+#include "tbox.h"
+
 /*****************************************************************************/
 
 /**
@@ -30,6 +33,14 @@
 */
 #define ND_DIMS 4
 
+/**
+* Statistics kind and slot of the joint spatiotemporal histogram. The slot
+* is the last one, the first four being used for the spatial histograms and
+* the time statistics.
+*/
+#define STATISTIC_KIND_NDT 10
+#define STATISTIC_SLOT_NDT 4
+
 /**
 * N-dimensional box type for calculations, to avoid doing
 * explicit axis conversions from GBOX in all calculations
@@ -95,6 +106,8 @@ extern int nd_box_init(ND_BOX *a);
 extern int nd_box_init_bounds(ND_BOX *a);
 extern int nd_box_merge(const ND_BOX *source, ND_BOX *target);
 extern void nd_box_from_gbox(const GBOX *gbox, ND_BOX *nd_box);
+extern void nd_box_from_stbox_time(const STBOX *box, int tdim, ND_BOX *nd_box);
+extern void nd_box_from_tbox(const TBOX *box, ND_BOX *nd_box);
 extern int nd_increment(ND_IBOX *ibox, int ndims, int *counter);
 extern int nd_box_overlap(const ND_STATS *nd_stats, const ND_BOX *nd_box, ND_IBOX *nd_ibox);
 extern int nd_box_intersects(const ND_BOX *a, const ND_BOX *b, int ndims);
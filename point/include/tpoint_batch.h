@@ -0,0 +1,65 @@
+/*****************************************************************************
+ *
+ * tpoint_batch.h
+ *    Batch computation of tdwithin and of the nearest approach distance
+ *    for pairs of temporal points given in the columnar format
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_BATCH_H__
+#define __TPOINT_BATCH_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the synchronized segments of a batch of pairs of
+ * temporal points, where the kernels only need the difference between the
+ * positions of the two points at the bounds of each segment
+ */
+typedef struct
+{
+  int count;          /**< Number of segments */
+  int maxcount;       /**< Number of segments allocated */
+  int *pair;          /**< Pair of each segment */
+  int64 *lower;       /**< Start time of each segment */
+  int64 *upper;       /**< End time of each segment */
+  double *d0[3];      /**< Difference of the positions at the start */
+  double *d1[3];      /**< Difference of the positions at the end */
+} SegmentBatch;
+
+/**
+ * Structure to represent the state of the functions returning a result
+ * for each pair of a batch
+ */
+typedef struct
+{
+  int count;          /**< Number of pairs */
+  Datum *values;      /**< Result of each pair */
+  bool *found;        /**< True when the pair has a result */
+  int i;              /**< Number of the current pair */
+} BatchState;
+
+/*****************************************************************************/
+
+extern void segmentbatch_tdwithin(const SegmentBatch *batch, int ncols,
+  double dist, double *lower, double *upper);
+extern void segmentbatch_distance(const SegmentBatch *batch, int ncols,
+  double *result);
+
+extern Datum tdwithin_batch(PG_FUNCTION_ARGS);
+extern Datum distance_batch(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -31,6 +31,21 @@ extern void tpointinst_make_stbox(STBOX *box, const TInstant *inst);
 extern void tpointinstarr_to_stbox(STBOX *box, TInstant **inst, int count);
 extern void tpointseqarr_to_stbox(STBOX *box, TSequence **seq, int count);
 
+/* Block boxes of temporal sequence points */
+
+/* Number of segments summarized by a block box */
+#define TPOINTSEQ_BLOCK_SIZE      64
+/* Minimum number of instants of a sequence for keeping block boxes */
+#define TPOINTSEQ_BLOCK_MINCOUNT  (4 * TPOINTSEQ_BLOCK_SIZE)
+
+extern int tpointseq_block_count(int count);
+extern void tpointseq_make_blocks(STBOX *blocks, TInstant **instants,
+  int count);
+extern void tpointseq_append_blocks(STBOX *blocks, const TSequence *seq,
+  const TInstant *inst);
+extern const STBOX *tpointseq_blocks_ptr(const TSequence *seq);
+extern void tpointseq_blocks_set_srid(TSequence *seq, int32 srid);
+
 /* Boxes functions */
 
 extern Datum tpoint_stboxes(PG_FUNCTION_ARGS);
@@ -38,6 +53,19 @@ extern Datum tpoint_stboxes(PG_FUNCTION_ARGS);
 extern ArrayType *tpointseq_stboxes(const TSequence *seq);
 extern ArrayType *tpointseqset_stboxes(const TSequenceSet *ts);
 
+/* Segment boxes functions */
+
+extern int tpoint_segment_stboxes_maxcount(const Temporal *temp);
+extern int tpoint_segment_stboxes(STBOX *result, const Temporal *temp);
+extern int stboxarr_merge(STBOX *boxes, int count, int maxcount);
+extern bool overlaps_segments_tpoint_stbox_internal(const Temporal *temp,
+  const STBOX *box);
+
+extern Datum overlaps_segments_geo_tpoint(PG_FUNCTION_ARGS);
+extern Datum overlaps_segments_stbox_tpoint(PG_FUNCTION_ARGS);
+extern Datum overlaps_segments_tpoint_geo(PG_FUNCTION_ARGS);
+extern Datum overlaps_segments_tpoint_stbox(PG_FUNCTION_ARGS);
+
 /* Generic box functions */
 
 extern Datum boxop_geo_tpoint(FunctionCallInfo fcinfo,
@@ -19,6 +19,7 @@
 /*****************************************************************************/
 
 extern Datum create_trip(PG_FUNCTION_ARGS);
+extern Datum create_trips(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
@@ -0,0 +1,43 @@
+/*****************************************************************************
+ *
+ * tpoint_edgeindex.h
+ *    Index of the edges of a polygonal geometry for clipping segments.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_EDGEINDEX_H__
+#define __TPOINT_EDGEINDEX_H__
+
+#include <postgres.h>
+#include <liblwgeom.h>
+
+/*****************************************************************************/
+
+/** Minimum number of edges of the polygons for which an index is built */
+#define EDGEINDEX_MIN_EDGES    64
+
+/** Maximum number of children of the nodes of the index */
+#define EDGEINDEX_NODE_SIZE    16
+
+/** Maximum number of indexes kept in the shared cache */
+#define EDGEINDEX_CACHE_ENTRIES  1024
+
+typedef struct EdgeIndex EdgeIndex;
+
+extern int edgeindex_cache_size;
+
+extern void edgeindex_shmem_init(void);
+
+extern EdgeIndex *edgeindex_build(const GSERIALIZED *gs);
+extern const EdgeIndex *edgeindex_get(const GSERIALIZED *gs);
+extern double *edgeindex_clip_segment(const EdgeIndex *index,
+  const POINT2D *p1, const POINT2D *p2, int *count);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,51 @@
+/*****************************************************************************
+ *
+ * tpoint_geofence.h
+ *    Time during which a temporal point intersects each geometry of an
+ *    array of geofences.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_GEOFENCE_H__
+#define __TPOINT_GEOFENCE_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Maximum number of children of the nodes of the index of the geofences
+ */
+#define GEOFENCE_NODE_SIZE    16
+
+/**
+ * Structure to represent the state of the function returning the time
+ * during which a temporal point intersects each geofence
+ */
+typedef struct
+{
+  int count;             /**< Number of geofences intersected */
+  int *fences;           /**< Positions of the geofences intersected */
+  PeriodSet **times;     /**< Time during which they are intersected */
+  int i;                 /**< Number of the current geofence */
+} GeofenceState;
+
+/*****************************************************************************/
+
+extern GeofenceState *when_intersects_tpoint_geoarr_internal(
+  const Temporal *temp, Datum *geoms, int count);
+
+extern Datum when_intersects_tpoint_geoarr(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
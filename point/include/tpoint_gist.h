@@ -20,17 +20,103 @@
 
 /*****************************************************************************/
 
+/* Default and maximum number of segment boxes of the multi-box opclass */
+#define MULTIBOX_DEFAULT_BOXES   8
+#define MULTIBOX_MAX_BOXES       64
+
+#if MOBDB_PGSQL_VERSION >= 130000
+/**
+ * Parameters of the multi-box operator class
+ */
+typedef struct
+{
+  int32 vl_len_;        /**< varlena header (do not touch directly!) */
+  int maxboxes;         /**< maximum number of segment boxes */
+} MultiboxOptions;
+#endif
+
+#if MOBDB_PGSQL_VERSION >= 130000
+/**
+ * Picksplit strategies of the operator classes
+ */
+typedef enum
+{
+  STBOX_SPLIT_DOUBLESORT,  /**< double sorting split */
+  STBOX_SPLIT_RSTAR,       /**< R*-tree split */
+} STboxGistSplit;
+
+/**
+ * Parameters of the operator classes
+ */
+typedef struct
+{
+  int32 vl_len_;        /**< varlena header (do not touch directly!) */
+  int split;            /**< picksplit strategy */
+} STboxGistOptions;
+#endif
+
+/**
+ * Key of the compact GiST operator classes for temporal points, where the
+ * spatial bounds are float4 values rounded outward
+ */
+typedef struct
+{
+  TimestampTz  tmin;    /**< minimum timestamp */
+  TimestampTz  tmax;    /**< maximum timestamp */
+  float4    xmin;       /**< minimum x value rounded down */
+  float4    xmax;       /**< maximum x value rounded up */
+  float4    ymin;       /**< minimum y value rounded down */
+  float4    ymax;       /**< maximum y value rounded up */
+  float4    zmin;       /**< minimum z value rounded down */
+  float4    zmax;       /**< maximum z value rounded up */
+  int32     srid;       /**< SRID */
+  int16     flags;      /**< flags */
+} STBOXF;
+
+/* Size of the compact key without the trailing padding */
+#define STBOXF_SIZE    (offsetof(STBOXF, flags) + sizeof(int16))
+
+/*****************************************************************************/
+
 extern Datum stbox_gist_consistent(PG_FUNCTION_ARGS);
 extern Datum stbox_gist_union(PG_FUNCTION_ARGS);
 extern Datum stbox_gist_penalty(PG_FUNCTION_ARGS);
 extern Datum stbox_gist_picksplit(PG_FUNCTION_ARGS);
 extern Datum stbox_gist_same(PG_FUNCTION_ARGS);
 extern Datum tpoint_gist_compress(PG_FUNCTION_ARGS);
+#if MOBDB_PGSQL_VERSION < 110000
+extern Datum stbox_gist_compress(PG_FUNCTION_ARGS);
+extern Datum stbox_gist_fetch(PG_FUNCTION_ARGS);
+#endif
+#if MOBDB_PGSQL_VERSION >= 130000
+extern Datum stbox_gist_options(PG_FUNCTION_ARGS);
+#endif
+
+#if MOBDB_PGSQL_VERSION >= 130000
+extern Datum tpoint_gist_multibox_options(PG_FUNCTION_ARGS);
+#endif
+extern Datum tpoint_gist_multibox_compress(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_multibox_consistent(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_multibox_union(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_multibox_penalty(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_multibox_picksplit(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_multibox_same(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_multibox_distance(PG_FUNCTION_ARGS);
+
+extern Datum stbox_gist_compact_consistent(PG_FUNCTION_ARGS);
+extern Datum tpoint_gist_compact_compress(PG_FUNCTION_ARGS);
+extern Datum stbox_gist_compact_decompress(PG_FUNCTION_ARGS);
 
 /* The following functions are also called by IndexSpgistTPoint.c */
 extern bool tpoint_index_recheck(StrategyNumber strategy);
 extern bool stbox_index_consistent_leaf(const STBOX *key, const STBOX *query,
   StrategyNumber strategy);
+extern double stbox_index_distance(const STBOX *key, const STBOX *query);
+
+/* The following functions are also called by tpoint_brin.c */
+extern bool stbox_gist_consistent_internal(const STBOX *key, const STBOX *query,
+  StrategyNumber strategy);
+extern void stbox_adjust(STBOX *b, const STBOX *addon);
 
 /*****************************************************************************/
 
@@ -20,6 +20,7 @@
 
 extern Datum tpoint_from_mfjson(PG_FUNCTION_ARGS);
 extern Datum tpoint_from_ewkb(PG_FUNCTION_ARGS);
+extern Datum tpoint_from_twkb(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
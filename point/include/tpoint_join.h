@@ -0,0 +1,55 @@
+/*****************************************************************************
+ *
+ * tpoint_join.h
+ *    Partition-based spatial merge join of spatiotemporal boxes
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_JOIN_H__
+#define __TPOINT_JOIN_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "stbox.h"
+
+/*****************************************************************************/
+
+/**
+ * Average number of boxes per cell of the grid
+ */
+#define STBOX_JOIN_CELL_BOXES   64
+
+/**
+ * Maximum number of cells of the grid in each dimension
+ */
+#define STBOX_JOIN_MAX_CELLS    1024
+
+/**
+ * Structure to represent the state of the join of two arrays of boxes
+ */
+typedef struct
+{
+  int count;      /**< Number of pairs of overlapping boxes */
+  int maxcount;   /**< Size of the arrays of pairs */
+  int *pos1;      /**< Positions of the boxes of the first array */
+  int *pos2;      /**< Positions of the boxes of the second array */
+  int i;          /**< Number of the current pair */
+} STboxJoinState;
+
+/*****************************************************************************/
+
+extern STboxJoinState *stbox_join_internal(const STBOX *boxes1, int count1,
+  const STBOX *boxes2, int count2);
+
+extern Datum stbox_join(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
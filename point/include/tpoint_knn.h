@@ -0,0 +1,47 @@
+/*****************************************************************************
+ *
+ * tpoint_knn.h
+ *    Continuous k nearest neighbors of a temporal point among an array of
+ *    temporal points.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_KNN_H__
+#define __TPOINT_KNN_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the state of the function returning the time
+ * during which each temporal point of an array is among the k nearest
+ * neighbors of a temporal point
+ */
+typedef struct
+{
+  int count;             /**< Number of neighbors */
+  int *neighbors;        /**< Positions of the neighbors */
+  PeriodSet **times;     /**< Time during which they are neighbors */
+  int i;                 /**< Number of the current neighbor */
+} KnnState;
+
+/*****************************************************************************/
+
+extern KnnState *tknn_tpoint_tpointarr_internal(const Temporal *temp,
+  Temporal **temparr, int count, int k);
+
+extern Datum tknn_tpoint_tpointarr(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -16,6 +16,23 @@
 #include <postgres.h>
 #include <fmgr.h>
 #include <catalog/pg_type.h>
+#include <lib/stringinfo.h>
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the state of the aggregate output of temporal
+ * points in MF-JSON format
+ */
+typedef struct
+{
+  StringInfoData buf;  /**< Features written so far */
+  int precision;       /**< Maximum number of decimal digits */
+  int option;          /**< Output options */
+  int32_t srid;        /**< SRID of the last reference system */
+  char *srs;           /**< Last reference system, NULL if none */
+  int count;           /**< Number of features */
+} MFJSONState;
 
 /*****************************************************************************/
 
@@ -26,9 +43,12 @@ extern Datum geoarr_as_ewkt(PG_FUNCTION_ARGS);
 extern Datum tpointarr_as_text(PG_FUNCTION_ARGS);
 extern Datum tpointarr_as_ewkt(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_mfjson(PG_FUNCTION_ARGS);
+extern Datum tpoint_mfjson_transfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_mfjson_finalfn(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_binary(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_ewkb(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_hexewkb(PG_FUNCTION_ARGS);
+extern Datum tpoint_as_twkb(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
@@ -0,0 +1,55 @@
+/*****************************************************************************
+ *
+ * tpoint_parallel.h
+ *    Processing of very large temporal point sequences in parallel chunks
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_PARALLEL_H__
+#define __TPOINT_PARALLEL_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/** Magic number of the dynamic shared memory segments of the chunks */
+#define TPOINT_PARALLEL_MAGIC       0x4D444250
+
+/** Size of the message queue of the result of each worker */
+#define TPOINT_PARALLEL_QUEUE_SIZE  65536
+
+/** Minimum number of segments of a chunk */
+#define TPOINT_PARALLEL_MIN_SEGS    1024
+
+/**
+ * Enumeration of the functions computed in parallel on the chunks
+ */
+typedef enum
+{
+  PARALLEL_SPEED,
+  PARALLEL_AT_GEOMETRY,
+} ParallelFunc;
+
+/*****************************************************************************/
+
+extern int tpoint_parallel_workers;
+extern int tpoint_parallel_min_instants;
+
+extern bool tpointseq_parallel_eligible(const TSequence *seq);
+extern Temporal *tpointseq_parallel(FunctionCallInfo fcinfo,
+  const TSequence *seq, ParallelFunc func, Datum geo);
+
+extern PGDLLEXPORT void tpoint_parallel_main(Datum arg);
+
+/*****************************************************************************/
+
+#endif
@@ -65,6 +65,10 @@
 
 /*****************************************************************************/
 
+extern ND_STATS *nd_stats_from_vardata(VariableStatData *vardata, int kind);
+extern float8 nd_stats_selectivity(const ND_STATS *nd_stats,
+  const ND_BOX *nd_box);
+
 extern Datum tpoint_sel(PG_FUNCTION_ARGS);
 extern Datum tpoint_joinsel(PG_FUNCTION_ARGS);
 
@@ -0,0 +1,39 @@
+/*****************************************************************************
+ *
+ * tpoint_similarity.h
+ *    Similarity distances between temporal points.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_SIMILARITY_H__
+#define __TPOINT_SIMILARITY_H__
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+extern Datum frechet_distance(PG_FUNCTION_ARGS);
+extern Datum dyntimewarp_distance(PG_FUNCTION_ARGS);
+extern Datum hausdorff_distance(PG_FUNCTION_ARGS);
+extern Datum similarity_lower_bound(PG_FUNCTION_ARGS);
+
+extern double frechet_distance_internal(const Temporal *temp1,
+  const Temporal *temp2);
+extern double dyntimewarp_distance_internal(const Temporal *temp1,
+  const Temporal *temp2);
+extern double hausdorff_distance_internal(const Temporal *temp1,
+  const Temporal *temp2);
+extern double similarity_lower_bound_internal(const Temporal *temp1,
+  const Temporal *temp2);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,47 @@
+/*****************************************************************************
+ *
+ * tpoint_snapshot.h
+ *    Positions of an array of temporal points at one or more timestamps
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_SNAPSHOT_H__
+#define __TPOINT_SNAPSHOT_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the state of the function returning the positions
+ * of an array of temporal points at each timestamp of an array
+ */
+typedef struct
+{
+  int count;             /**< Number of timestamps */
+  TimestampTz *times;    /**< Timestamps */
+  Datum *ids;            /**< Positions in the array of the points found */
+  Datum *points;         /**< Multipoint of the points found */
+  int i;                 /**< Number of the current timestamp */
+} SnapshotState;
+
+/*****************************************************************************/
+
+extern Datum tpointarr_snapshot_internal(Temporal **temparr,
+  TimestampCursor *cursors, int count, TimestampTz t, int *ids, int *found);
+
+extern Datum tpointarr_snapshot(PG_FUNCTION_ARGS);
+extern Datum tpointarr_snapshots(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -22,13 +22,40 @@
 #include "temporal.h"
 #include <liblwgeom.h>
 #include "tpoint.h"
+#include "tpoint_edgeindex.h"
 
 /*****************************************************************************/
 
-/* Fetch from and store in the cache the fcinfo of the external function */
+/**
+ * Structure to accumulate the periods during which a temporal point
+ * intersects a geometry
+ */
+typedef struct
+{
+  int count;        /**< Number of periods */
+  int size;         /**< Number of periods allocated */
+  Period *periods;  /**< Array of periods */
+} PeriodArray;
+
+/** Minimum number of segments of a sequence for applying the filter step
+ * of the spatial predicates */
+#define TPOINTSEQ_FILTER_MIN_SEGS   16
+
+/** Classes of the segments given by the filter step */
+#define FILTER_REJECT   0
+#define FILTER_ACCEPT   1
+#define FILTER_REFINE   2
 
-extern FunctionCallInfo fetch_fcinfo();
-extern void store_fcinfo(FunctionCallInfo fcinfo);
+/*****************************************************************************/
+
+/* Configuration parameter for the geodetic computations */
+
+extern bool geodetic_use_spheroid;
+
+/* Function call information for the PostGIS functions keeping a cache */
+
+extern FmgrInfo *postgis_flinfo(FmgrInfo **flinfo, PGFunction func,
+  short nargs);
 
 /* Functions derived from PostGIS to increase floating-point precision */
 
@@ -79,7 +106,9 @@ extern const POINT2D *datum_get_point2d_p(Datum value);
 extern POINT3DZ datum_get_point3dz(Datum value);
 extern const POINT3DZ *datum_get_point3dz_p(Datum value);
 extern POINT4D datum_get_point4d(Datum value);
+extern Datum geopoint_with_coords(Datum point, double x, double y, double z);
 extern bool datum_point_eq(Datum geopoint1, Datum geopoint2);
+extern bool datum_point_pair(Datum geom1, Datum geom2);
 extern Datum datum2_point_eq(Datum geopoint1, Datum geopoint2);
 extern Datum datum2_point_ne(Datum geopoint1, Datum geopoint2);
 extern GSERIALIZED *geo_serialize(LWGEOM *geom);
@@ -126,6 +155,8 @@ extern Datum tpoint_trajectory(PG_FUNCTION_ARGS);
 
 extern Datum tpointinstset_trajectory(const TInstantSet *ti);
 extern Datum tpoint_trajectory_internal(const Temporal *temp);
+extern Datum tpoint_trajectory_cached(FmgrInfo *flinfo, const Temporal *temp,
+  bool *tofree);
 extern Datum tpointseq_make_trajectory(TInstant **instants, int count, bool linear);
 
 extern Datum geopoint_line(Datum value1, Datum value2);
@@ -133,6 +164,8 @@ extern LWLINE *geopoint_lwline(Datum value1, Datum value2);
 
 extern Datum tpointseq_trajectory(const TSequence *seq);
 extern Datum tpointseq_trajectory_copy(const TSequence *seq);
+extern Datum tpointseq_trajectory_append(const TSequence *seq,
+  const TInstant *inst);
 extern Datum tpointseqset_trajectory(const TSequenceSet *ts);
 
 /* Length, speed, time-weighted centroid, and temporal azimuth functions */
@@ -140,8 +173,18 @@ extern Datum tpointseqset_trajectory(const TSequenceSet *ts);
 extern Datum tpoint_length(PG_FUNCTION_ARGS);
 extern Datum tpoint_cumulative_length(PG_FUNCTION_ARGS);
 extern Datum tpoint_speed(PG_FUNCTION_ARGS);
+extern Datum tpoint_min_speed(PG_FUNCTION_ARGS);
+extern Datum tpoint_max_speed(PG_FUNCTION_ARGS);
 extern Datum tgeompoint_twcentroid(PG_FUNCTION_ARGS);
 extern Datum tpoint_azimuth(PG_FUNCTION_ARGS);
+extern Datum tpoint_trajectory_metrics(PG_FUNCTION_ARGS);
+
+extern double tpointseq_length(const TSequence *seq);
+extern TSequence *tpointseq_speed(const TSequence *seq);
+extern void tpointseq_speed_bounds(const TSequence *seq, double *min,
+  double *max);
+extern void tpointsegm_append_metrics(double *length, double *min,
+  double *max, const TInstant *inst1, const TInstant *inst2, bool linear);
 
 extern Datum tgeompointi_twcentroid(const TInstantSet *ti);
 extern Datum tgeompointseq_twcentroid(const TSequence *seq);
@@ -156,9 +199,21 @@ extern Datum tpoint_minus_geometry(PG_FUNCTION_ARGS);
 extern Datum tpoint_minus_stbox(PG_FUNCTION_ARGS);
 
 extern TSequence **tpointseq_at_geometry2(const TSequence *seq, Datum geo, int *count);
+extern char *tpointseq_geometry_filter(const TSequence *seq, Datum geo,
+  const EdgeIndex *index);
 
 extern Temporal *tpoint_at_geometry_internal(const Temporal *temp, Datum geo);
 extern Temporal *tpoint_minus_geometry_internal(const Temporal *temp, Datum geo);
+extern Temporal *tpoint_at_stbox_internal(const Temporal *temp, const STBOX *box);
+
+extern PeriodSet *tpoint_at_geometry_time_internal(const Temporal *temp,
+  Datum geo);
+extern void periodarr_add(PeriodArray *arr, TimestampTz lower,
+  TimestampTz upper, bool lower_inc, bool upper_inc);
+extern PeriodSet *periodarr_to_periodset(const PeriodArray *arr);
+extern void tpointseg_at_geometry_time(PeriodArray *arr,
+  const TInstant *inst1, const TInstant *inst2, bool linear, bool lower_inc,
+  bool upper_inc, Datum geo, const EdgeIndex *index);
 
 /*****************************************************************************/
 
@@ -25,6 +25,9 @@ extern Datum stbox_spgist_choose(PG_FUNCTION_ARGS);
 extern Datum stbox_spgist_picksplit(PG_FUNCTION_ARGS);
 extern Datum stbox_spgist_inner_consistent(PG_FUNCTION_ARGS);
 extern Datum stbox_spgist_leaf_consistent(PG_FUNCTION_ARGS);
+extern Datum stbox_kdtree_choose(PG_FUNCTION_ARGS);
+extern Datum stbox_kdtree_picksplit(PG_FUNCTION_ARGS);
+extern Datum stbox_kdtree_inner_consistent(PG_FUNCTION_ARGS);
 extern Datum sptpoint_gist_compress(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
@@ -51,6 +51,12 @@ extern Datum twithin_tpoint_geo(PG_FUNCTION_ARGS);
 extern Datum tdwithin_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum tdwithin_tpoint_geo(PG_FUNCTION_ARGS);
 extern Datum tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS);
+extern Datum tdwithin_pairs(PG_FUNCTION_ARGS);
+
+extern Datum when_intersects_geo_tpoint(PG_FUNCTION_ARGS);
+extern Datum when_intersects_tpoint_geo(PG_FUNCTION_ARGS);
+extern Datum when_dwithin_geo_tpoint(PG_FUNCTION_ARGS);
+extern Datum when_dwithin_tpoint_geo(PG_FUNCTION_ARGS);
 
 extern Datum trelate_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum trelate_tpoint_geo(PG_FUNCTION_ARGS);
@@ -60,6 +66,9 @@ extern Datum trelate_pattern_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum trelate_pattern_tpoint_geo(PG_FUNCTION_ARGS);
 extern Datum trelate_pattern_tpoint_tpoint(PG_FUNCTION_ARGS);
 
+extern Temporal *tdwithin_tpoint_tpoint_internal(const Temporal *temp1,
+  const Temporal *temp2, Datum dist);
+
 /*****************************************************************************/
 
 #endif
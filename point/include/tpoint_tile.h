@@ -0,0 +1,97 @@
+/*****************************************************************************
+ *
+ * tpoint_tile.h
+ *    Splitting of temporal points into spatial tiles and time buckets
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TPOINT_TILE_H__
+#define __TPOINT_TILE_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+#include "temporal_tile.h"
+#include "stbox.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the state of the splitting of a temporal point
+ * into spatial tiles and, optionally, time buckets
+ */
+typedef struct
+{
+  Temporal *temp;            /**< Temporal point to split */
+  TimeSplitState *timestate; /**< State of the time buckets, if any */
+  double xsize;              /**< Size of the tiles in the X dimension */
+  double ysize;              /**< Size of the tiles in the Y dimension */
+  double xorigin;            /**< Origin of the tiles in the X dimension */
+  double yorigin;            /**< Origin of the tiles in the Y dimension */
+  int32 srid;                /**< SRID of the temporal point */
+  bool hasz;                 /**< True when the point has Z dimension */
+  bool done;                 /**< True when all the fragments were visited */
+  Temporal *fragment;        /**< Fragment of the current time bucket */
+  TimestampTz bucket;        /**< Start of the current time bucket */
+  STBOX box;                 /**< Bounding box of the fragment */
+  double xstart;             /**< Start of the first tile of the fragment */
+  double ystart;             /**< Start of the first tile of the fragment */
+  int64 nx;                  /**< Number of tiles of the fragment in X */
+  int64 ny;                  /**< Number of tiles of the fragment in Y */
+  int64 i;                   /**< Number of the current tile */
+} SpaceSplitState;
+
+/**
+ * Structure to represent the time spent by the temporal points in a tile
+ * and, optionally, a time bucket
+ */
+typedef struct
+{
+  int64 x;                   /**< Number of the tile in the X dimension */
+  int64 y;                   /**< Number of the tile in the Y dimension */
+  TimestampTz bucket;        /**< Start of the time bucket, 0 if none */
+  int64 duration;            /**< Time spent in the tile in microseconds */
+  int64 visits;              /**< Number of visits of the tile */
+} DwellCell;
+
+/**
+ * Structure to represent the state of the aggregation of the time spent
+ * by temporal points in spatial tiles and, optionally, time buckets
+ */
+typedef struct
+{
+  double xsize;              /**< Size of the tiles in the X dimension */
+  double ysize;              /**< Size of the tiles in the Y dimension */
+  double xorigin;            /**< Origin of the tiles in the X dimension */
+  double yorigin;            /**< Origin of the tiles in the Y dimension */
+  int64 size;                /**< Size of the time buckets, 0 if none */
+  TimestampTz origin;        /**< Origin of the time buckets */
+  int32 srid;                /**< SRID of the temporal points */
+  int capacity;              /**< Number of cells that fit in the state */
+  int count;                 /**< Number of cells of the state */
+  DwellCell *cells;          /**< Cells, not necessarily sorted or unique */
+} DwellAggState;
+
+#define DWELLAGG_INITIAL_CAPACITY 1024
+
+/*****************************************************************************/
+
+extern Datum tpoint_space_split(PG_FUNCTION_ARGS);
+extern Datum tpoint_space_time_split(PG_FUNCTION_ARGS);
+
+extern Datum tpoint_dwell_transfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_dwell_combinefn(PG_FUNCTION_ARGS);
+extern Datum tpoint_dwell_finalfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_dwell_deserialize(PG_FUNCTION_ARGS);
+extern Datum tpoint_dwell_cells(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -7,6 +7,7 @@ set(SRCPOINT
 point/src/stbox.c
 point/src/tpoint_aggfuncs.c
 point/src/tpoint_boxops.c
+point/src/tpoint_brin.c
 point/src/tpoint_datagen.c
 point/src/tpoint_parser.c
 point/src/tpoint_posops.c
@@ -15,7 +16,9 @@ point/src/tpoint_spgist.c
 point/src/projection_gk.c
 point/src/geography_functions.c
 point/src/tpoint_spatialfuncs.c
+point/src/tpoint_edgeindex.c
 point/src/tpoint_distance.c
+point/src/tpoint_similarity.c
 point/src/tpoint_spatialrels.c
 point/src/tpoint.c
 point/src/tpoint_in.c
@@ -24,6 +27,13 @@ point/src/tpoint_analyze.c
 point/src/tpoint_selfuncs.c
 point/src/tpoint_tempspatialrels.c
 point/src/tpoint_analytics.c
+point/src/tpoint_tile.c
+point/src/tpoint_join.c
+point/src/tpoint_geofence.c
+point/src/tpoint_knn.c
+point/src/tpoint_parallel.c
+point/src/tpoint_batch.c
+point/src/tpoint_snapshot.c
 )
 
 set(SQLPOINT
@@ -37,6 +47,7 @@ point/src/sql/56_tpoint_spatialfuncs.in.sql
 point/src/sql/58_tpoint_boxops.in.sql
 point/src/sql/60_tpoint_posops.in.sql
 point/src/sql/62_tpoint_distance.in.sql
+point/src/sql/63_tpoint_similarity.in.sql
 point/src/sql/64_tpoint_aggfuncs.in.sql
 point/src/sql/66_tpoint_spatialrels.in.sql
 point/src/sql/68_tpoint_tempspatialrels.in.sql
@@ -44,6 +55,13 @@ point/src/sql/70_tpoint_gist.in.sql
 point/src/sql/72_tpoint_spgist.in.sql
 point/src/sql/74_tpoint_datagen.in.sql
 point/src/sql/76_tpoint_analytics.in.sql
+point/src/sql/77_tpoint_tile.in.sql
+point/src/sql/78_tpoint_brin.in.sql
+point/src/sql/79_tpoint_join.in.sql
+point/src/sql/80_tpoint_geofence.in.sql
+point/src/sql/81_tpoint_knn.in.sql
+point/src/sql/82_tpoint_batch.in.sql
+point/src/sql/83_tpoint_snapshot.in.sql
 )
 
 target_sources(${CMAKE_PROJECT_NAME} PRIVATE ${SRCPOINT})
@@ -18,6 +18,7 @@
 #include <float.h>
 #include <utils/array.h>
 #include <utils/builtins.h>
+#include <utils/memutils.h>
 #include <liblwgeom.h>
 
 #include "postgis.h"
@@ -275,28 +276,112 @@ circ_tree_distance_tree_internal(const CIRC_NODE* n1, const CIRC_NODE* n2, doubl
   }
 }
 
+/***********************************************************************
+ * Cache of the circle trees of the arguments
+ ***********************************************************************/
+
+/**
+ * Structure to represent the cache of the circle trees of the arguments of
+ * a function, kept in fn_extra as done by PostGIS for its geography
+ * functions. The tree of an argument is only built and kept when the
+ * argument is repeated between consecutive calls, e.g., for a constant
+ * geography compared with every row of a table.
+ */
+typedef struct
+{
+  GSERIALIZED *gs[2];      /**< copies of the last arguments */
+  LWGEOM *lwgeom[2];       /**< geographies built from the copies */
+  CIRC_NODE *tree[2];      /**< circle trees, NULL if not built */
+} GeogTreeCache;
+
+/**
+ * Returns the cache of the circle trees of the function
+ */
+static GeogTreeCache *
+geog_tree_cache(FunctionCallInfo fcinfo)
+{
+  if (fcinfo->flinfo == NULL)
+    return NULL;
+  if (fcinfo->flinfo->fn_extra == NULL)
+    fcinfo->flinfo->fn_extra = MemoryContextAllocZero(
+      fcinfo->flinfo->fn_mcxt, sizeof(GeogTreeCache));
+  return (GeogTreeCache *) fcinfo->flinfo->fn_extra;
+}
+
+/**
+ * Returns the circle tree of the argument, taken from the cache when the
+ * argument is the same as in the previous call
+ *
+ * @param[in] fcinfo Function call information
+ * @param[in] i Position of the argument
+ * @param[in] gs Geography
+ * @param[out] lwgeom Geography of the tree when the tree is not cached,
+ * the caller must then free the tree and the geography
+ */
+static CIRC_NODE *
+geog_tree_get(FunctionCallInfo fcinfo, int i, const GSERIALIZED *gs,
+  LWGEOM **lwgeom)
+{
+  GeogTreeCache *cache = geog_tree_cache(fcinfo);
+  *lwgeom = NULL;
+  if (cache != NULL)
+  {
+    MemoryContext mcxt = fcinfo->flinfo->fn_mcxt;
+    if (cache->gs[i] != NULL && VARSIZE(cache->gs[i]) == VARSIZE(gs) &&
+      memcmp(cache->gs[i], gs, VARSIZE(gs)) == 0)
+    {
+      if (cache->tree[i] == NULL)
+      {
+        MemoryContext oldcontext = MemoryContextSwitchTo(mcxt);
+        cache->lwgeom[i] = lwgeom_from_gserialized(cache->gs[i]);
+        cache->tree[i] = lwgeom_calculate_circ_tree(cache->lwgeom[i]);
+        MemoryContextSwitchTo(oldcontext);
+      }
+      return cache->tree[i];
+    }
+    /* Remember the argument for the next call */
+    if (cache->tree[i] != NULL)
+    {
+      circ_tree_free(cache->tree[i]);
+      lwgeom_free(cache->lwgeom[i]);
+      cache->tree[i] = NULL;
+      cache->lwgeom[i] = NULL;
+    }
+    if (cache->gs[i] != NULL)
+      pfree(cache->gs[i]);
+    cache->gs[i] = MemoryContextAlloc(mcxt, VARSIZE(gs));
+    memcpy(cache->gs[i], gs, VARSIZE(gs));
+  }
+  *lwgeom = lwgeom_from_gserialized(gs);
+  return lwgeom_calculate_circ_tree(*lwgeom);
+}
+
+/**
+ * Free the circle tree if it is not cached
+ */
+static void
+geog_tree_release(CIRC_NODE *tree, LWGEOM *lwgeom)
+{
+  if (lwgeom == NULL)
+    return;
+  circ_tree_free(tree);
+  lwgeom_free(lwgeom);
+  return;
+}
+
 /***********************************************************************
  * Closest point and closest line functions for geographies.
  ***********************************************************************/
 
 LWGEOM *
-geography_tree_closestpoint(const GSERIALIZED* g1, const GSERIALIZED* g2, double threshold)
+geography_tree_closestpoint(const CIRC_NODE *circ_tree1,
+  const CIRC_NODE *circ_tree2, int srid, double threshold)
 {
-  CIRC_NODE* circ_tree1 = NULL;
-  CIRC_NODE* circ_tree2 = NULL;
-  LWGEOM* lwgeom1 = NULL;
-  LWGEOM* lwgeom2 = NULL;
   double min_dist = FLT_MAX;
   double max_dist = FLT_MAX;
   GEOGRAPHIC_POINT closest1, closest2;
-  LWGEOM *result;
   POINT4D p;
 
-  lwgeom1 = lwgeom_from_gserialized(g1);
-  lwgeom2 = lwgeom_from_gserialized(g2);
-  circ_tree1 = lwgeom_calculate_circ_tree(lwgeom1);
-  circ_tree2 = lwgeom_calculate_circ_tree(lwgeom2);
-
   /* Quietly decrease the threshold just a little to avoid cases where */
   /* the actual spheroid distance is larger than the sphere distance */
   /* causing the return value to be larger than the threshold value */
@@ -308,13 +393,7 @@ geography_tree_closestpoint(const GSERIALIZED* g1, const GSERIALIZED* g2, double
 
   p.x = rad2deg(closest1.lon);
   p.y = rad2deg(closest1.lat);
-  result = (LWGEOM *)lwpoint_make2d(gserialized_get_srid(g1), p.x, p.y);
-
-  circ_tree_free(circ_tree1);
-  circ_tree_free(circ_tree2);
-  lwgeom_free(lwgeom1);
-  lwgeom_free(lwgeom2);
-  return result;
+  return (LWGEOM *)lwpoint_make2d(srid, p.x, p.y);
 }
 
 /**
@@ -326,6 +405,8 @@ Datum geography_closestpoint(PG_FUNCTION_ARGS)
 {
   GSERIALIZED* g1 = NULL;
   GSERIALIZED* g2 = NULL;
+  CIRC_NODE *circ_tree1, *circ_tree2;
+  LWGEOM *lwgeom1, *lwgeom2;
   LWGEOM *point;
   GSERIALIZED* result;
 
@@ -343,7 +424,12 @@ Datum geography_closestpoint(PG_FUNCTION_ARGS)
     PG_RETURN_NULL();
   }
 
-  point = geography_tree_closestpoint(g1, g2, FP_TOLERANCE);
+  circ_tree1 = geog_tree_get(fcinfo, 0, g1, &lwgeom1);
+  circ_tree2 = geog_tree_get(fcinfo, 1, g2, &lwgeom2);
+  point = geography_tree_closestpoint(circ_tree1, circ_tree2,
+    gserialized_get_srid(g1), FP_TOLERANCE);
+  geog_tree_release(circ_tree1, lwgeom1);
+  geog_tree_release(circ_tree2, lwgeom2);
 
   if (lwgeom_is_empty(point))
     PG_RETURN_NULL();
@@ -359,13 +445,10 @@ Datum geography_closestpoint(PG_FUNCTION_ARGS)
 /*****************************************************************************/
 
 LWGEOM *
-geography_tree_shortestline(const GSERIALIZED* g1, const GSERIALIZED* g2,
-  double threshold, const SPHEROID *spheroid)
+geography_tree_shortestline(const CIRC_NODE *circ_tree1,
+  const CIRC_NODE *circ_tree2, int srid, double threshold,
+  const SPHEROID *spheroid)
 {
-  CIRC_NODE* circ_tree1 = NULL;
-  CIRC_NODE* circ_tree2 = NULL;
-  LWGEOM* lwgeom1 = NULL;
-  LWGEOM* lwgeom2 = NULL;
   double min_dist = FLT_MAX;
   double max_dist = FLT_MAX;
   GEOGRAPHIC_POINT closest1, closest2;
@@ -373,11 +456,6 @@ geography_tree_shortestline(const GSERIALIZED* g1, const GSERIALIZED* g2,
   LWGEOM *result;
   POINT4D p1, p2;
 
-  lwgeom1 = lwgeom_from_gserialized(g1);
-  lwgeom2 = lwgeom_from_gserialized(g2);
-  circ_tree1 = lwgeom_calculate_circ_tree(lwgeom1);
-  circ_tree2 = lwgeom_calculate_circ_tree(lwgeom2);
-
   /* Quietly decrease the threshold just a little to avoid cases where */
   /* the actual spheroid distance is larger than the sphere distance */
   /* causing the return value to be larger than the threshold value */
@@ -392,16 +470,12 @@ geography_tree_shortestline(const GSERIALIZED* g1, const GSERIALIZED* g2,
   p2.x = rad2deg(closest2.lon);
   p2.y = rad2deg(closest2.lat);
 
-  geoms[0] = (LWGEOM *)lwpoint_make2d(gserialized_get_srid(g1), p1.x, p1.y);
-  geoms[1] = (LWGEOM *)lwpoint_make2d(gserialized_get_srid(g1), p2.x, p2.y);
+  geoms[0] = (LWGEOM *)lwpoint_make2d(srid, p1.x, p1.y);
+  geoms[1] = (LWGEOM *)lwpoint_make2d(srid, p2.x, p2.y);
   result = (LWGEOM *)lwline_from_lwgeom_array(geoms[0]->srid, 2, geoms);
 
   lwgeom_free(geoms[0]);
   lwgeom_free(geoms[1]);
-  circ_tree_free(circ_tree1);
-  circ_tree_free(circ_tree2);
-  lwgeom_free(lwgeom1);
-  lwgeom_free(lwgeom2);
   return result;
 }
 
@@ -414,6 +488,8 @@ Datum geography_shortestline(PG_FUNCTION_ARGS)
 {
   GSERIALIZED* g1 = NULL;
   GSERIALIZED* g2 = NULL;
+  CIRC_NODE *circ_tree1, *circ_tree2;
+  LWGEOM *lwgeom1, *lwgeom2;
   LWGEOM *line;
   GSERIALIZED* result;
   bool use_spheroid = true;
@@ -447,7 +523,12 @@ Datum geography_shortestline(PG_FUNCTION_ARGS)
   if ( ! use_spheroid )
     s.a = s.b = s.radius;
 
-  line = geography_tree_shortestline(g1, g2, FP_TOLERANCE, &s);
+  circ_tree1 = geog_tree_get(fcinfo, 0, g1, &lwgeom1);
+  circ_tree2 = geog_tree_get(fcinfo, 1, g2, &lwgeom2);
+  line = geography_tree_shortestline(circ_tree1, circ_tree2,
+    gserialized_get_srid(g1), FP_TOLERANCE, &s);
+  geog_tree_release(circ_tree1, lwgeom1);
+  geog_tree_release(circ_tree2, lwgeom2);
 
   if (lwgeom_is_empty(line))
     PG_RETURN_NULL();
@@ -20,7 +20,6 @@
 #include <liblwgeom.h>
 #include "temporaltypes.h"
 #include "oidcache.h"
-#include "lifting.h"
 #include "postgis.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
@@ -43,27 +42,57 @@ double eqwgs = 0;
 double eqbes = 0;
 double MDC = 2.0;    /* standard in Hagen, zone=2 */
 
+/**
+ * Terms of the projection that do not depend on the point, computed once
+ * for each array of points
+ */
+typedef struct
+{
+  double l0;      /**< Longitude of the central meridian in radians */
+  double ab2;     /**< Square of the Bessel semi-major axis */
+  double nk;      /**< Third flattening of the Bessel ellipsoid */
+  double gg1;     /**< Coefficient of sin(2b) of the meridian arc */
+  double gg2;     /**< Coefficient of sin(4b), before the division by 16 */
+  double gg3;     /**< Coefficient of sin(6b), before the division by 48 */
+} GKTerms;
+
+/**
+ * Compute the terms of the projection that do not depend on the point
+ */
+static void
+gk_terms(GKTerms *terms)
+{
+  eqwgs = (awgs * awgs - bwgs * bwgs) / (awgs * awgs);
+  eqbes = (abes * abes - bbes * bbes) / (abes * abes);
+  double l0 = 3.0 * MDC;
+  terms->l0 = Pi * l0 / 180.0;
+  terms->ab2 = abes * abes;
+  double nk = (abes - bbes) / (abes + bbes);
+  terms->nk = nk;
+  terms->gg1 = (-3.0 * nk / 2.0) + (9.0 * nk * nk * nk / 16.0);
+  terms->gg2 = 15 * nk * nk;
+  terms->gg3 = 35 * nk * nk * nk;
+  return;
+}
+
 /**
  *
  */
 static POINT2D
-BesselBLToGaussKrueger(double b, double ll)
+BesselBLToGaussKrueger(const GKTerms *terms, double b, double ll)
 {
   POINT2D result;
-  double l0 = 3.0 * MDC;
-  l0 = Pi * l0 / 180.0;
-  double l = ll - l0;
+  double l = ll - terms->l0;
   double k = cos(b);
   double t = sin(b) / k;
   double eq = eqbes;
   double Vq = 1.0 + eq * k * k;
   double v = sqrt(Vq);
-  double Ng = abes * abes / (bbes * v);
-  double nk =(abes - bbes) / (abes + bbes);
+  double Ng = terms->ab2 / (bbes * v);
   double X = ((Ng * t * k * k * l * l) / 2) + 
     ((Ng * t * (9 * Vq - t * t - 4) * k * k * k * k * l * l * l * l) / 24);
-  double gg = b + (((-3.0 * nk / 2.0) + (9.0 * nk * nk * nk / 16.0)) *
-    sin(2 * b) + 15 * nk * nk * sin(4 * b) / 16 - 35 * nk * nk * nk * sin(6 * b) / 48);
+  double gg = b + (terms->gg1 * sin(2 * b) + terms->gg2 * sin(4 * b) / 16 -
+    terms->gg3 * sin(6 * b) / 48);
   double SS = gg * 180.0 * cbes / Pi;
   double Ho = (SS + X);
   double Y = Ng * k * l + Ng * (Vq - t * t) * k * k * k * l * l * l / 6 + Ng *
@@ -97,7 +126,8 @@ newF(double f, double x, double y, double p)
 {
   double zw;
   double nnq;
-  zw = abes / sqrt(1 - eqbes * sin(f) * sin(f));
+  double sinf = sin(f);
+  zw = abes / sqrt(1 - eqbes * sinf * sinf);
   nnq = 1 - (eqbes * zw / (sqrt(x * x + y * y) / cos(f)));
   return (atan(p / nnq));
 }
@@ -121,32 +151,18 @@ BLRauenberg (double x, double y, double z)
 
   result.x = f;
   result.y = atan(y / x);
+  double sinf1 = sin(f1);
   result.z = sqrt(x * x + y * y) / cos(f1) - 
-    (abes / sqrt(1 - eqbes * sin(f1) * sin(f1)));
+    (abes / sqrt(1 - eqbes * sinf1 * sinf1));
   return result;
 }
 
-/**
- * Get Datum from 2D point
- */
-static Datum
-point2d_get_datum(const POINT2D *p2d)
-{
-  LWPOINT *lwpoint = lwpoint_make2d(4326, p2d->x, p2d->y);
-  GSERIALIZED *result = geo_serialize((LWGEOM *) lwpoint);
-  return PointerGetDatum(result);
-}
-
 /**
  * Transform a point into the Gauss-Kruger projection used in Secondo
  */
-static Datum
-gk(Datum point)
+static POINT2D
+gk_point2d(const GKTerms *terms, const POINT2D *p2d)
 {
-  eqwgs = (awgs * awgs - bwgs * bwgs) / (awgs * awgs);
-  eqbes = (abes * abes - bbes * bbes) / (abes * abes);
-  const POINT2D *p2d = datum_get_point2d_p(point);
-  POINT2D result;
   double x = p2d->x;
   double y = p2d->y;
   double a = (x / 180) * Pi;
@@ -157,10 +173,12 @@ gk(Datum point)
   a = awgs;
 
   double eq = eqwgs;
-  double N = a / sqrt(1 - eq * sin(b1) * sin(b1));
-  double Xq = (N + h1) * cos(b1) * cos(l1);
-  double Yq = (N + h1) * cos(b1) * sin(l1);
-  double Zq = ((1 - eq) * N + h1) * sin(b1);
+  double sinb1 = sin(b1);
+  double cosb1 = cos(b1);
+  double N = a / sqrt(1 - eq * sinb1 * sinb1);
+  double Xq = (N + h1) * cosb1 * cos(l1);
+  double Yq = (N + h1) * cosb1 * sin(l1);
+  double Zq = ((1 - eq) * N + h1) * sinb1;
 
   POINT3D p = HelmertTransformation(Xq, Yq, Zq);
   double X = p.x;
@@ -170,8 +188,24 @@ gk(Datum point)
   p = BLRauenberg(X, Y, Z);
   double b2 = p.x;
   double l2 = p.y;
-  result = BesselBLToGaussKrueger(b2, l2);
-  return point2d_get_datum(&result);
+  return BesselBLToGaussKrueger(terms, b2, l2);
+}
+
+/**
+ * Transform in place an array of points into the Gauss-Kruger projection
+ * used in Secondo
+ *
+ * @param[in,out] points Array of points
+ * @param[in] count Number of points
+ */
+static void
+gk_points(POINT2D *points, int count)
+{
+  GKTerms terms;
+  gk_terms(&terms);
+  for (int i = 0; i < count; i++)
+    points[i] = gk_point2d(&terms, &points[i]);
+  return;
 }
 
 /**
@@ -189,10 +223,9 @@ geometry_transform_gk_internal(GSERIALIZED *gs)
       lwpoint = lwpoint_construct_empty(0, false, false);
     else
     {
-      const POINT2D *p2d= gs_get_point2d_p(gs);
-      Datum geom = gk(point2d_get_datum(p2d));
-      p2d  = datum_get_point2d_p(geom);
-      lwpoint = lwpoint_make2d(4326, p2d->x, p2d->y);
+      POINT2D p2d = *gs_get_point2d_p(gs);
+      gk_points(&p2d, 1);
+      lwpoint = lwpoint_make2d(4326, p2d.x, p2d.y);
     }
     result = geo_serialize((LWGEOM *)lwpoint);
     lwpoint_free(lwpoint);
@@ -204,28 +237,27 @@ geometry_transform_gk_internal(GSERIALIZED *gs)
     {
       line = lwline_construct_empty(0, false, false);
       result = geo_serialize((LWGEOM *) line);
+      lwline_free(line);
     }
     else
     {
-      LWPOINT *lwpoint = NULL;
       line = lwgeom_as_lwline(lwgeom_from_gserialized(gs));
       uint32_t numPoints = line->points->npoints;
-      LWPOINT **points = palloc(sizeof(LWPOINT *) * numPoints);
+      /* The coordinates of a 2D point array are contiguous */
+      POINTARRAY *pa = ptarray_construct(false, false, numPoints);
+      POINT2D *points = (POINT2D *) pa->serialized_pointlist;
       for (uint32_t i = 0; i < numPoints; i++)
       {
-        lwpoint = lwline_get_lwpoint(line, i);
-        Datum point2d_datum = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
-        Datum geom = gk(point2d_datum);
-        const POINT2D *p2d  = datum_get_point2d_p(geom);
-        points[i] = lwpoint_make2d(4326, p2d->x, p2d->y);
+        POINT4D p;
+        getPoint4d_p(line->points, i, &p);
+        points[i].x = p.x;
+        points[i].y = p.y;
       }
-
-      line = lwline_from_ptarray(4326, numPoints, points);
+      lwline_free(line);
+      gk_points(points, (int) numPoints);
+      line = lwline_construct(4326, NULL, pa);
       result = geo_serialize((LWGEOM *) line);
-      lwline_free(line); lwpoint_free(lwpoint);
-      for (uint32_t i = 0; i < numPoints; i++)
-        lwpoint_free(points[i]);
-      pfree(points);
+      lwline_free(line);
     }
   }
   else
@@ -248,6 +280,58 @@ geometry_transform_gk(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************/
+
+/**
+ * Transform an array of instants into the Gauss-Krueger projection used in
+ * Secondo
+ *
+ * The coordinates of the instants are projected in a contiguous buffer and
+ * are then written into a single serialized point that is reused for
+ * constructing every instant of the result.
+ *
+ * @param[out] result Array of transformed instants
+ * @param[in] instants Array of instants
+ * @param[in] count Number of instants
+ */
+static void
+tpointinstarr_transform_gk(TInstant **result, TInstant **instants, int count)
+{
+  POINT2D *points = palloc(sizeof(POINT2D) * count);
+  for (int i = 0; i < count; i++)
+    points[i] = *datum_get_point2d_p(tinstant_value(instants[i]));
+  gk_points(points, count);
+  LWPOINT *lwpoint = lwpoint_make2d(4326, 0, 0);
+  GSERIALIZED *gs = geo_serialize((LWGEOM *) lwpoint);
+  lwpoint_free(lwpoint);
+  POINT2D *coords = (POINT2D *) gs_get_point2d_p(gs);
+  for (int i = 0; i < count; i++)
+  {
+    *coords = points[i];
+    result[i] = tinstant_make(PointerGetDatum(gs), instants[i]->t,
+      instants[i]->valuetypid);
+  }
+  pfree(gs); pfree(points);
+  return;
+}
+
+/**
+ * Transform a temporal sequence point into the Gauss-Krueger projection used
+ * in Secondo
+ */
+static TSequence *
+tpointseq_transform_gk(const TSequence *seq)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  for (int i = 0; i < seq->count; i++)
+    instants[i] = tsequence_inst_n(seq, i);
+  TInstant **newinstants = palloc(sizeof(TInstant *) * seq->count);
+  tpointinstarr_transform_gk(newinstants, instants, seq->count);
+  pfree(instants);
+  return tsequence_make_free(newinstants, seq->count, seq->period.lower_inc,
+    seq->period.upper_inc, MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
+}
+
 PG_FUNCTION_INFO_V1(tgeompoint_transform_gk);
 /**
  * Transform a temporal point into the Gauss-Krueger projection used in Secondo
@@ -257,16 +341,37 @@ tgeompoint_transform_gk(PG_FUNCTION_ARGS)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   ensure_valid_duration(temp->duration);
-  /* We only need to fill these parameters for tfunc_temporal */
-  LiftedFunctionInfo lfinfo;
-  lfinfo.func = (varfunc) &gk;
-  lfinfo.numparam = 1;
-  lfinfo.restypid = temp->valuetypid;
-  Temporal *result = tfunc_temporal(temp, (Datum) NULL, lfinfo);
+  Temporal *result;
+  if (temp->duration == INSTANT)
+  {
+    TInstant *inst = (TInstant *) temp, *newinst;
+    tpointinstarr_transform_gk(&newinst, &inst, 1);
+    result = (Temporal *) newinst;
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    TInstantSet *ti = (TInstantSet *) temp;
+    TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+    for (int i = 0; i < ti->count; i++)
+      instants[i] = tinstantset_inst_n(ti, i);
+    TInstant **newinstants = palloc(sizeof(TInstant *) * ti->count);
+    tpointinstarr_transform_gk(newinstants, instants, ti->count);
+    pfree(instants);
+    result = (Temporal *) tinstantset_make_free(newinstants, ti->count);
+  }
+  else if (temp->duration == SEQUENCE)
+    result = (Temporal *) tpointseq_transform_gk((TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    TSequence **sequences = palloc(sizeof(TSequence *) * ts->count);
+    for (int i = 0; i < ts->count; i++)
+      sequences[i] = tpointseq_transform_gk(tsequenceset_seq_n(ts, i));
+    result = (Temporal *) tsequenceset_make_free(sequences, ts->count,
+      NORMALIZE);
+  }
   PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_POINTER(result);
 }
 
 /*****************************************************************************/
-
-
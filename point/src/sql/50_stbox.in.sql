@@ -586,3 +586,14 @@ CREATE OPERATOR CLASS stbox_ops
   FUNCTION  1  stbox_cmp(stbox, stbox);
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Z-order
+ *****************************************************************************/
+
+CREATE FUNCTION zorder(stbox, stbox)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME', 'stbox_zorder'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
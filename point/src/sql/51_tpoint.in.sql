@@ -144,6 +144,18 @@ CREATE FUNCTION tgeogpointseq(tgeogpoint[], lower_inc boolean DEFAULT true,
   RETURNS tgeogpoint
   AS 'MODULE_PATHNAME', 'tlinearseq_constructor'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tgeompointseq(timestamptz[], geometry[],
+  lower_inc boolean DEFAULT true, upper_inc boolean DEFAULT true,
+  linear boolean DEFAULT true)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'tlinearseq_arrays_constructor'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tgeogpointseq(timestamptz[], geography[],
+  lower_inc boolean DEFAULT true, upper_inc boolean DEFAULT true,
+  linear boolean DEFAULT true)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'tlinearseq_arrays_constructor'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE FUNCTION tgeompoints(tgeompoint[])
   RETURNS tgeompoint
@@ -239,6 +251,27 @@ CREATE FUNCTION appendInstant(tgeogpoint, tgeogpoint)
   AS 'MODULE_PATHNAME', 'temporal_append_tinstant'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/* The aggregate appends the instants in place to its state */
+CREATE AGGREGATE appendInstant(tgeompoint) (
+  SFUNC = appendInstant,
+  STYPE = tgeompoint,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE appendInstant(tgeogpoint) (
+  SFUNC = appendInstant,
+  STYPE = tgeogpoint,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION appendInstants(tgeompoint, tgeompoint[])
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_append_tinstants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(tgeogpoint, tgeogpoint[])
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_append_tinstants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 -- Function is not strict
 CREATE FUNCTION merge(tgeompoint, tgeompoint)
   RETURNS tgeompoint
@@ -426,6 +459,15 @@ CREATE FUNCTION instants(tgeogpoint)
   AS 'MODULE_PATHNAME', 'temporal_instants'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION unnestInstants(tgeompoint)
+  RETURNS SETOF tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_unnest_instants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(tgeogpoint)
+  RETURNS SETOF tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_unnest_instants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION numTimestamps(tgeompoint)
   RETURNS integer
   AS 'MODULE_PATHNAME', 'temporal_num_timestamps'
@@ -471,6 +513,15 @@ CREATE FUNCTION timestamps(tgeogpoint)
   AS 'MODULE_PATHNAME', 'temporal_timestamps'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION unnestTimestamps(tgeompoint)
+  RETURNS SETOF timestamptz
+  AS 'MODULE_PATHNAME', 'temporal_unnest_timestamps'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestTimestamps(tgeogpoint)
+  RETURNS SETOF timestamptz
+  AS 'MODULE_PATHNAME', 'temporal_unnest_timestamps'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION numSequences(tgeompoint)
   RETURNS integer
   AS 'MODULE_PATHNAME', 'temporal_num_sequences'
@@ -564,6 +615,17 @@ CREATE OPERATOR %= (
   RESTRICT = tpoint_sel, JOIN = tpoint_joinsel
 );
 
+#if MOBDB_PGSQL_VERSION >= 120000
+ALTER FUNCTION ever_eq(tgeompoint, geometry(Point)) SUPPORT temporal_supportfn;
+ALTER FUNCTION ever_eq(tgeogpoint, geography(Point)) SUPPORT temporal_supportfn;
+ALTER FUNCTION always_eq(tgeompoint, geometry(Point)) SUPPORT temporal_supportfn;
+ALTER FUNCTION always_eq(tgeogpoint, geography(Point)) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestInstants(tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestInstants(tgeogpoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestTimestamps(tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestTimestamps(tgeogpoint) SUPPORT temporal_supportfn;
+#endif
+
 CREATE FUNCTION ever_ne(tgeompoint, geometry(Point))
   RETURNS boolean
   AS 'MODULE_PATHNAME', 'temporal_ever_ne'
@@ -675,6 +737,23 @@ CREATE FUNCTION valueAtTimestamp(tgeogpoint, timestamptz)
   AS 'MODULE_PATHNAME', 'temporal_value_at_timestamp'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/*
+ * Returns the positions at the timestamp of the temporal points of a column
+ * of a table. The candidate rows are obtained in a single index probe on the
+ * bounding boxes, and only the part of each value containing the timestamp
+ * is detoasted.
+ */
+CREATE FUNCTION snapshot(rel regclass, attr name, t timestamptz,
+    OUT ctid tid, OUT point geometry)
+  RETURNS SETOF record AS $$
+BEGIN
+  RETURN QUERY EXECUTE format(
+    'SELECT * FROM (SELECT ctid, valueAtTimestamp(%1$I, $1)::geometry AS '
+    'point FROM %2$s WHERE %1$I && stbox($1)) AS s WHERE point IS NOT NULL',
+    attr, rel) USING t;
+END;
+$$ LANGUAGE plpgsql STABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION atTimestampSet(tgeompoint, timestampset)
   RETURNS tgeompoint
   AS 'MODULE_PATHNAME', 'temporal_at_timestampset'
@@ -693,6 +772,15 @@ CREATE FUNCTION minusTimestampSet(tgeogpoint, timestampset)
   AS 'MODULE_PATHNAME', 'temporal_minus_timestampset'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tsample(tgeompoint, interval)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_sample'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(tgeogpoint, interval)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_sample'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION atPeriod(tgeompoint, period)
   RETURNS tgeompoint
   AS 'MODULE_PATHNAME', 'temporal_at_period'
@@ -52,6 +52,11 @@ CREATE FUNCTION fromEWKB(bytea)
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 */
 
+CREATE FUNCTION fromTWKB(bytea)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'tpoint_from_twkb'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*
 CREATE FUNCTION fromHexEWKB(bytea)
   RETURNS tgeompoint
@@ -73,6 +73,67 @@ CREATE FUNCTION asMFJSON(point tgeogpoint, maxdecimaldigits int4 DEFAULT 15, opt
   AS 'MODULE_PATHNAME', 'tpoint_as_mfjson'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+-- The option 8 outputs one feature per line instead of a FeatureCollection
+CREATE FUNCTION asMFJSONCollection_transfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asMFJSONCollection_transfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asMFJSONCollection_transfn(internal, tgeompoint, int4)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asMFJSONCollection_transfn(internal, tgeogpoint, int4)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asMFJSONCollection_transfn(internal, tgeompoint, int4, int4)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asMFJSONCollection_transfn(internal, tgeogpoint, int4, int4)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asMFJSONCollection_finalfn(internal)
+  RETURNS text
+  AS 'MODULE_PATHNAME', 'tpoint_mfjson_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE asMFJSONCollection(tgeompoint) (
+  SFUNC = asMFJSONCollection_transfn,
+  STYPE = internal,
+  FINALFUNC = asMFJSONCollection_finalfn
+);
+CREATE AGGREGATE asMFJSONCollection(tgeogpoint) (
+  SFUNC = asMFJSONCollection_transfn,
+  STYPE = internal,
+  FINALFUNC = asMFJSONCollection_finalfn
+);
+CREATE AGGREGATE asMFJSONCollection(tgeompoint, int4) (
+  SFUNC = asMFJSONCollection_transfn,
+  STYPE = internal,
+  FINALFUNC = asMFJSONCollection_finalfn
+);
+CREATE AGGREGATE asMFJSONCollection(tgeogpoint, int4) (
+  SFUNC = asMFJSONCollection_transfn,
+  STYPE = internal,
+  FINALFUNC = asMFJSONCollection_finalfn
+);
+CREATE AGGREGATE asMFJSONCollection(tgeompoint, int4, int4) (
+  SFUNC = asMFJSONCollection_transfn,
+  STYPE = internal,
+  FINALFUNC = asMFJSONCollection_finalfn
+);
+CREATE AGGREGATE asMFJSONCollection(tgeogpoint, int4, int4) (
+  SFUNC = asMFJSONCollection_transfn,
+  STYPE = internal,
+  FINALFUNC = asMFJSONCollection_finalfn
+);
+
 CREATE FUNCTION asBinary(tgeompoint)
   RETURNS bytea
   AS 'MODULE_PATHNAME', 'tpoint_as_binary'
@@ -124,4 +185,50 @@ CREATE FUNCTION asHexEWKB(tgeogpoint, endianenconding text)
   AS 'MODULE_PATHNAME', 'tpoint_as_hexewkb'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION asTWKB(tgeompoint, prec int4 DEFAULT 0,
+    prec_z int4 DEFAULT 0, prec_t int4 DEFAULT 0)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'tpoint_as_twkb'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION asTWKB(tgeogpoint, prec int4 DEFAULT 0,
+    prec_z int4 DEFAULT 0, prec_t int4 DEFAULT 0)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'tpoint_as_twkb'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
+
+-- Columnar export of batches of temporal points, see temporal_arrow.sql
+
+CREATE FUNCTION asArrow_transfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_arrow_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asArrow_transfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_arrow_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE asArrow(tgeompoint) (
+  SFUNC = asArrow_transfn,
+  STYPE = internal,
+  FINALFUNC = asArrow_finalfn
+);
+CREATE AGGREGATE asArrow(tgeogpoint) (
+  SFUNC = asArrow_transfn,
+  STYPE = internal,
+  FINALFUNC = asArrow_finalfn
+);
+
+CREATE FUNCTION tgeompointFromArrow(bytea, maxgap interval DEFAULT NULL,
+    OUT id integer, OUT temp tgeompoint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_from_arrow'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeogpointFromArrow(bytea, maxgap interval DEFAULT NULL,
+    OUT id integer, OUT temp tgeogpoint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_from_arrow'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
 /*****************************************************************************/
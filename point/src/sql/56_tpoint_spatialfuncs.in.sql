@@ -138,6 +138,23 @@ CREATE FUNCTION speed(tgeogpoint)
   AS 'MODULE_PATHNAME', 'tpoint_speed'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION minSpeed(tgeompoint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_min_speed'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION minSpeed(tgeogpoint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_min_speed'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION maxSpeed(tgeompoint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_max_speed'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION maxSpeed(tgeogpoint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_max_speed'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION twcentroid(tgeompoint)
   RETURNS geometry
   AS 'MODULE_PATHNAME', 'tgeompoint_twcentroid'
@@ -152,6 +169,15 @@ CREATE FUNCTION azimuth(tgeogpoint)
   AS 'MODULE_PATHNAME', 'tpoint_azimuth'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION trajectoryMetrics(tgeompoint, OUT cumulativeLength tfloat,
+    OUT speed tfloat, OUT azimuth tfloat, OUT acceleration tfloat)
+  AS 'MODULE_PATHNAME', 'tpoint_trajectory_metrics'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION trajectoryMetrics(tgeogpoint, OUT cumulativeLength tfloat,
+    OUT speed tfloat, OUT azimuth tfloat, OUT acceleration tfloat)
+  AS 'MODULE_PATHNAME', 'tpoint_trajectory_metrics'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
 
 CREATE FUNCTION atGeometry(tgeompoint, geometry)
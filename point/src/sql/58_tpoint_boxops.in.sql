@@ -26,6 +26,15 @@ CREATE FUNCTION stbox(tgeogpoint)
 CREATE CAST (tgeompoint AS stbox) WITH FUNCTION stbox(tgeompoint) AS IMPLICIT;
 CREATE CAST (tgeogpoint AS stbox) WITH FUNCTION stbox(tgeogpoint) AS IMPLICIT;
 
+CREATE FUNCTION zorder(tgeompoint, stbox)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME', 'tpoint_zorder'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION zorder(tgeogpoint, stbox)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME', 'tpoint_zorder'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
 
 CREATE FUNCTION stboxes(tgeompoint)
@@ -309,6 +318,52 @@ CREATE OPERATOR && (
   RESTRICT = tpoint_sel, JOIN = tpoint_joinsel
 );
 
+/*****************************************************************************
+ * Overlaps segments
+ *****************************************************************************/
+
+CREATE FUNCTION overlaps_segments(geometry, tgeompoint)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME', 'overlaps_segments_geo_tpoint'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION overlaps_segments(stbox, tgeompoint)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME', 'overlaps_segments_stbox_tpoint'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION overlaps_segments(tgeompoint, geometry)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME', 'overlaps_segments_tpoint_geo'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION overlaps_segments(tgeompoint, stbox)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME', 'overlaps_segments_tpoint_stbox'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR &&& (
+  PROCEDURE = overlaps_segments,
+  LEFTARG = geometry, RIGHTARG = tgeompoint,
+  COMMUTATOR = &&&,
+  RESTRICT = tpoint_sel, JOIN = tpoint_joinsel
+);
+CREATE OPERATOR &&& (
+  PROCEDURE = overlaps_segments,
+  LEFTARG = stbox, RIGHTARG = tgeompoint,
+  COMMUTATOR = &&&,
+  RESTRICT = tpoint_sel, JOIN = tpoint_joinsel
+);
+CREATE OPERATOR &&& (
+  PROCEDURE = overlaps_segments,
+  LEFTARG = tgeompoint, RIGHTARG = geometry,
+  COMMUTATOR = &&&,
+  RESTRICT = tpoint_sel, JOIN = tpoint_joinsel
+);
+CREATE OPERATOR &&& (
+  PROCEDURE = overlaps_segments,
+  LEFTARG = tgeompoint, RIGHTARG = stbox,
+  COMMUTATOR = &&&,
+  RESTRICT = tpoint_sel, JOIN = tpoint_joinsel
+);
+
 /*****************************************************************************/
 
 CREATE FUNCTION overlaps_bbox(geography, tgeogpoint)
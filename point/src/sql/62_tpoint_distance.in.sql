@@ -166,6 +166,17 @@ CREATE FUNCTION nearestApproachDistance(tgeogpoint, tgeogpoint)
   AS 'MODULE_PATHNAME', 'NAD_tpoint_tpoint'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/* The support function scales the cost by the width of the temporal points,
+ * see temporal_supportfn.c */
+#if MOBDB_PGSQL_VERSION >= 120000
+ALTER FUNCTION nearestApproachDistance(geometry, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION nearestApproachDistance(tgeompoint, geometry) SUPPORT temporal_supportfn;
+ALTER FUNCTION nearestApproachDistance(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION nearestApproachDistance(geography, tgeogpoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION nearestApproachDistance(tgeogpoint, geography) SUPPORT temporal_supportfn;
+ALTER FUNCTION nearestApproachDistance(tgeogpoint, tgeogpoint) SUPPORT temporal_supportfn;
+#endif
+
 CREATE OPERATOR |=| (
   LEFTARG = geometry, RIGHTARG = tgeompoint,
   PROCEDURE = nearestApproachDistance,
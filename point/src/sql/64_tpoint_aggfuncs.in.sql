@@ -42,30 +42,101 @@ CREATE FUNCTION tcount_transfn(internal, tgeompoint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tcount_transfn(internal, tgeogpoint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 
 CREATE AGGREGATE tcount(tgeompoint) (
   SFUNC = tcount_transfn,
   STYPE = internal,
-  COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tgeogpoint) (
   SFUNC = tcount_transfn,
   STYPE = internal,
-  COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
+  PARALLEL = SAFE
+);
+
+/* States of the aggregates for the rollups */
+
+CREATE AGGREGATE tcountState(tgeompoint) (
+  SFUNC = tcount_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountState(tgeogpoint) (
+  SFUNC = tcount_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
   PARALLEL = SAFE
 );
 
+/* Temporal count of the temporal points within a geometry, which is
+ * equivalent to tcount(atGeometry(temp, geom)) without restricting the
+ * temporal points */
+
+CREATE FUNCTION tcountWithin_transfn(internal, tgeompoint, geometry)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_tcount_within_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcountWithin_invfn(internal, tgeompoint, geometry)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_tcount_within_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE tcountWithin(tgeompoint, geometry) (
+  SFUNC = tcountWithin_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcountWithin_transfn,
+  MINVFUNC = tcountWithin_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE AGGREGATE extent(stbox) (
+  SFUNC = tpoint_extent_combinefn,
+  STYPE = stbox,
+  COMBINEFUNC = tpoint_extent_combinefn,
+  PARALLEL = safe
+);
+
 CREATE FUNCTION wcount_transfn(internal, tgeompoint, interval)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_wcount_transfn'
@@ -106,14 +177,88 @@ CREATE FUNCTION tcentroid_finalfn(internal)
   RETURNS tgeompoint
   AS 'MODULE_PATHNAME', 'tpoint_tcentroid_finalfn'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tcentroid_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'tpoint_tcentroid_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tcentroid_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_tcentroid_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE tcentroid(tgeompoint) (
   SFUNC = tcentroid_transfn,
   STYPE = internal,
   COMBINEFUNC = tcentroid_combinefn,
   FINALFUNC = tcentroid_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  SERIALFUNC = tcentroid_serialize,
+  DESERIALFUNC = tcentroid_deserialize,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************
+ * Sequence aggregation
+ *****************************************************************************/
+
+CREATE FUNCTION tsequence_agg_transfn(internal, geometry, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, geometry, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, geography, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, geography, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_tsequence_agg_finalfn(internal)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'tsequence_agg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_tsequence_agg_finalfn(internal)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'tsequence_agg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tsequenceAgg(geometry, timestamptz) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tgeompoint_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(geometry, timestamptz, interval) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tgeompoint_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(geography, timestamptz) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tgeogpoint_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(geography, timestamptz, interval) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tgeogpoint_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
   PARALLEL = SAFE
 );
 
@@ -473,4 +473,28 @@ CREATE FUNCTION relate(tgeompoint, tgeompoint, pattern text)
   AS 'MODULE_PATHNAME', 'relate_pattern_tpoint_tpoint'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/*****************************************************************************
+ * Index support for the relationships between two temporal points
+ *****************************************************************************/
+
+/* The support function adds a bounding box comparison, expanded by the
+ * distance for dwithin, as a lossy index condition and estimates the
+ * selectivity and the cost of the relationships, see temporal_supportfn.c */
+#if MOBDB_PGSQL_VERSION >= 120000
+ALTER FUNCTION contains(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION containsproperly(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION covers(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION covers(tgeogpoint, tgeogpoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION coveredby(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION coveredby(tgeogpoint, tgeogpoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION crosses(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION equals(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION intersects(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION intersects(tgeogpoint, tgeogpoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION overlaps(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION touches(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION within(tgeompoint, tgeompoint) SUPPORT temporal_supportfn;
+ALTER FUNCTION dwithin(tgeompoint, tgeompoint, float8) SUPPORT temporal_supportfn;
+#endif
+
 /*****************************************************************************/
@@ -186,6 +186,35 @@ CREATE FUNCTION tdwithin(tgeogpoint, tgeogpoint, dist float8)
   AS 'MODULE_PATHNAME', 'tdwithin_tpoint_tpoint'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tdwithinPairs(tgeompoint[], dist float8, OUT i integer,
+    OUT j integer, OUT result tbool)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tdwithin_pairs'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************
+ * Time during which the temporal point intersects the geometry or is within
+ * the given distance of it
+ *****************************************************************************/
+
+CREATE FUNCTION whenIntersects(geometry, tgeompoint)
+  RETURNS periodset
+  AS 'MODULE_PATHNAME', 'when_intersects_geo_tpoint'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenIntersects(tgeompoint, geometry)
+  RETURNS periodset
+  AS 'MODULE_PATHNAME', 'when_intersects_tpoint_geo'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenDWithin(geometry, tgeompoint, dist float8)
+  RETURNS periodset
+  AS 'MODULE_PATHNAME', 'when_dwithin_geo_tpoint'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenDWithin(tgeompoint, geometry, dist float8)
+  RETURNS periodset
+  AS 'MODULE_PATHNAME', 'when_dwithin_tpoint_geo'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************
  * trelate (2 arguments)
  *****************************************************************************/
@@ -36,10 +36,26 @@ CREATE FUNCTION stbox_gist_same(stbox, stbox, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'stbox_gist_same'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+#if MOBDB_PGSQL_VERSION >= 130000
+CREATE FUNCTION stbox_gist_options(internal)
+  RETURNS void
+  AS 'MODULE_PATHNAME', 'stbox_gist_options'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+#endif
 CREATE FUNCTION stbox_gist_distance(internal, stbox, smallint, oid, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'stbox_gist_distance'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+#if MOBDB_PGSQL_VERSION < 110000
+CREATE FUNCTION stbox_gist_compress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'stbox_gist_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION stbox_gist_fetch(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'stbox_gist_fetch'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+#endif
 
 CREATE OPERATOR CLASS stbox_gist_ops
   DEFAULT FOR TYPE stbox USING gist AS
@@ -113,10 +129,22 @@ CREATE OPERATOR CLASS stbox_gist_ops
   -- functions
   FUNCTION  1  stbox_gist_consistent(internal, stbox, smallint, oid, internal),
   FUNCTION  2  stbox_gist_union(internal, internal),
+#if MOBDB_PGSQL_VERSION < 110000
+  FUNCTION  3  stbox_gist_compress(internal),
+  FUNCTION  4  tpoint_gist_decompress(internal),
+#endif
   FUNCTION  5  stbox_gist_penalty(internal, internal, internal),
   FUNCTION  6  stbox_gist_picksplit(internal, internal),
   FUNCTION  7  stbox_gist_same(stbox, stbox, internal),
+#if MOBDB_PGSQL_VERSION >= 130000
+  FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal),
+  FUNCTION  10  stbox_gist_options(internal);
+#elif MOBDB_PGSQL_VERSION >= 110000
   FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal);
+#else
+  FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal),
+  FUNCTION  9  stbox_gist_fetch(internal);
+#endif
 
 /******************************************************************************/
 
@@ -133,6 +161,13 @@ CREATE FUNCTION tpoint_gist_compress(internal)
   AS 'MODULE_PATHNAME', 'tpoint_gist_compress'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/*
+ * The "split" parameter of the operator classes selects the node splitting
+ * algorithm, either the default double sorting split or the R*-tree split,
+ * e.g.,
+ *   CREATE INDEX ON trips USING gist(trip gist_tgeompoint_ops(split = rstar));
+ * The parameter is only available from PostgreSQL 13 on.
+ */
 CREATE OPERATOR CLASS gist_tgeompoint_ops
   DEFAULT FOR TYPE tgeompoint USING gist AS
   STORAGE stbox,
@@ -220,6 +255,9 @@ CREATE OPERATOR CLASS gist_tgeompoint_ops
   OPERATOR  35    /&> (tgeompoint, geometry),
   OPERATOR  35    /&> (tgeompoint, stbox),
   OPERATOR  35    /&> (tgeompoint, tgeompoint),
+  -- overlaps segments
+  OPERATOR  36    &&& (tgeompoint, geometry),
+  OPERATOR  36    &&& (tgeompoint, stbox),
   -- functions
   FUNCTION  1  gist_tgeompoint_consistent(internal, tgeompoint, smallint, oid, internal),
   FUNCTION  2  stbox_gist_union(internal, internal),
@@ -230,7 +268,160 @@ CREATE OPERATOR CLASS gist_tgeompoint_ops
   FUNCTION  5  stbox_gist_penalty(internal, internal, internal),
   FUNCTION  6  stbox_gist_picksplit(internal, internal),
   FUNCTION  7  stbox_gist_same(stbox, stbox, internal),
+#if MOBDB_PGSQL_VERSION >= 130000
+  FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal),
+  FUNCTION  10  stbox_gist_options(internal);
+#else
   FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal);
+#endif
+
+CREATE FUNCTION gist_tgeompoint_multibox_consistent(internal, tgeompoint, smallint, oid, internal)
+  RETURNS bool
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_consistent'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_multibox_union(internal, internal)
+  RETURNS stbox[]
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_union'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_multibox_compress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_multibox_penalty(internal, internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_penalty'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_multibox_picksplit(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_picksplit'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_multibox_same(stbox[], stbox[], internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_same'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_multibox_distance(internal, tgeompoint, smallint, oid, internal)
+  RETURNS float8
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_distance'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+#if MOBDB_PGSQL_VERSION >= 130000
+CREATE FUNCTION tpoint_gist_multibox_options(internal)
+  RETURNS void
+  AS 'MODULE_PATHNAME', 'tpoint_gist_multibox_options'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+#endif
+
+/*
+ * Multi-box operator class keeping in each key the boxes of at most
+ * "boxes" groups of consecutive segments of the temporal point, e.g.,
+ *   CREATE INDEX ON trips USING gist(trip gist_tgeompoint_multibox_ops(boxes = 16));
+ * The parameter is only available from PostgreSQL 13 on.
+ */
+CREATE OPERATOR CLASS gist_tgeompoint_multibox_ops
+  FOR TYPE tgeompoint USING gist AS
+  STORAGE stbox[],
+  -- strictly left
+  OPERATOR  1    << (tgeompoint, geometry),  
+  OPERATOR  1    << (tgeompoint, stbox),  
+  OPERATOR  1    << (tgeompoint, tgeompoint),  
+  -- overlaps or left
+  OPERATOR  2    &< (tgeompoint, geometry),  
+  OPERATOR  2    &< (tgeompoint, stbox),  
+  OPERATOR  2    &< (tgeompoint, tgeompoint),  
+  -- overlaps  
+  OPERATOR  3    && (tgeompoint, geometry),  
+  OPERATOR  3    && (tgeompoint, stbox),  
+  OPERATOR  3    && (tgeompoint, tgeompoint),  
+  -- overlaps or right
+  OPERATOR  4    &> (tgeompoint, geometry),  
+  OPERATOR  4    &> (tgeompoint, stbox),  
+  OPERATOR  4    &> (tgeompoint, tgeompoint),  
+    -- strictly right
+  OPERATOR  5    >> (tgeompoint, geometry),  
+  OPERATOR  5    >> (tgeompoint, stbox),  
+  OPERATOR  5    >> (tgeompoint, tgeompoint),  
+    -- same
+  OPERATOR  6    ~= (tgeompoint, geometry),  
+  OPERATOR  6    ~= (tgeompoint, stbox),  
+  OPERATOR  6    ~= (tgeompoint, tgeompoint),  
+  -- contains
+  OPERATOR  7    @> (tgeompoint, geometry),  
+  OPERATOR  7    @> (tgeompoint, stbox),  
+  OPERATOR  7    @> (tgeompoint, tgeompoint),  
+  -- contained by
+  OPERATOR  8    <@ (tgeompoint, geometry),  
+  OPERATOR  8    <@ (tgeompoint, stbox),  
+  OPERATOR  8    <@ (tgeompoint, tgeompoint),  
+  -- overlaps or below
+  OPERATOR  9    &<| (tgeompoint, geometry),  
+  OPERATOR  9    &<| (tgeompoint, stbox),  
+  OPERATOR  9    &<| (tgeompoint, tgeompoint),  
+  -- strictly below
+  OPERATOR  10    <<| (tgeompoint, geometry),  
+  OPERATOR  10    <<| (tgeompoint, stbox),  
+  OPERATOR  10    <<| (tgeompoint, tgeompoint),  
+  -- strictly above
+  OPERATOR  11    |>> (tgeompoint, geometry),  
+  OPERATOR  11    |>> (tgeompoint, stbox),  
+  OPERATOR  11    |>> (tgeompoint, tgeompoint),  
+  -- overlaps or above
+  OPERATOR  12    |&> (tgeompoint, geometry),  
+  OPERATOR  12    |&> (tgeompoint, stbox),  
+  OPERATOR  12    |&> (tgeompoint, tgeompoint),  
+  -- adjacent
+  OPERATOR  17    -|- (tgeompoint, geometry),
+  OPERATOR  17    -|- (tgeompoint, stbox),
+  OPERATOR  17    -|- (tgeompoint, tgeompoint),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tgeompoint, geometry) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tgeompoint, stbox) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tgeompoint, tgeompoint) FOR ORDER BY pg_catalog.float_ops,
+  -- overlaps or before
+  OPERATOR  28    &<# (tgeompoint, stbox),
+  OPERATOR  28    &<# (tgeompoint, tgeompoint),
+  -- strictly before
+  OPERATOR  29    <<# (tgeompoint, stbox),
+  OPERATOR  29    <<# (tgeompoint, tgeompoint),
+  -- strictly after
+  OPERATOR  30    #>> (tgeompoint, stbox),
+  OPERATOR  30    #>> (tgeompoint, tgeompoint),
+  -- overlaps or after
+  OPERATOR  31    #&> (tgeompoint, stbox),
+  OPERATOR  31    #&> (tgeompoint, tgeompoint),
+  -- overlaps or front
+  OPERATOR  32    &</ (tgeompoint, geometry),
+  OPERATOR  32    &</ (tgeompoint, stbox),
+  OPERATOR  32    &</ (tgeompoint, tgeompoint),
+  -- strictly front
+  OPERATOR  33    <</ (tgeompoint, geometry),
+  OPERATOR  33    <</ (tgeompoint, stbox),
+  OPERATOR  33    <</ (tgeompoint, tgeompoint),
+  -- strictly back
+  OPERATOR  34    />> (tgeompoint, geometry),
+  OPERATOR  34    />> (tgeompoint, stbox),
+  OPERATOR  34    />> (tgeompoint, tgeompoint),
+  -- overlaps or back
+  OPERATOR  35    /&> (tgeompoint, geometry),
+  OPERATOR  35    /&> (tgeompoint, stbox),
+  OPERATOR  35    /&> (tgeompoint, tgeompoint),
+  -- overlaps segments
+  OPERATOR  36    &&& (tgeompoint, geometry),
+  OPERATOR  36    &&& (tgeompoint, stbox),
+  -- functions
+  FUNCTION  1  gist_tgeompoint_multibox_consistent(internal, tgeompoint, smallint, oid, internal),
+  FUNCTION  2  tpoint_gist_multibox_union(internal, internal),
+  FUNCTION  3  tpoint_gist_multibox_compress(internal),
+#if MOBDB_PGSQL_VERSION < 110000
+  FUNCTION  4  tpoint_gist_decompress(internal),
+#endif
+  FUNCTION  5  tpoint_gist_multibox_penalty(internal, internal, internal),
+  FUNCTION  6  tpoint_gist_multibox_picksplit(internal, internal),
+  FUNCTION  7  tpoint_gist_multibox_same(stbox[], stbox[], internal),
+#if MOBDB_PGSQL_VERSION >= 130000
+  FUNCTION  8  tpoint_gist_multibox_distance(internal, tgeompoint, smallint, oid, internal),
+  FUNCTION  10  tpoint_gist_multibox_options(internal);
+#else
+  FUNCTION  8  tpoint_gist_multibox_distance(internal, tgeompoint, smallint, oid, internal);
+#endif
 
 CREATE OPERATOR CLASS gist_tgeogpoint_ops
   DEFAULT FOR TYPE tgeogpoint USING gist AS
@@ -281,6 +472,183 @@ CREATE OPERATOR CLASS gist_tgeogpoint_ops
   FUNCTION  5  stbox_gist_penalty(internal, internal, internal),
   FUNCTION  6  stbox_gist_picksplit(internal, internal),
   FUNCTION  7  stbox_gist_same(stbox, stbox, internal),
+#if MOBDB_PGSQL_VERSION >= 130000
+  FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal),
+  FUNCTION  10  stbox_gist_options(internal);
+#else
+  FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal);
+#endif
+
+/******************************************************************************
+ * Compact operator classes whose keys store the spatial bounds as float4
+ * values rounded outward, e.g.,
+ *   CREATE INDEX ON trips USING gist(trip gist_tgeompoint_compact_ops);
+ ******************************************************************************/
+
+CREATE FUNCTION gist_tgeompoint_compact_consistent(internal, tgeompoint, smallint, oid, internal)
+  RETURNS bool
+  AS 'MODULE_PATHNAME', 'stbox_gist_compact_consistent'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tgeogpoint_compact_consistent(internal, tgeogpoint, smallint, oid, internal)
+  RETURNS bool
+  AS 'MODULE_PATHNAME', 'stbox_gist_compact_consistent'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tpoint_gist_compact_compress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_gist_compact_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION stbox_gist_compact_decompress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'stbox_gist_compact_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS gist_tgeompoint_compact_ops
+  FOR TYPE tgeompoint USING gist AS
+  STORAGE bytea,
+  -- strictly left
+  OPERATOR  1    << (tgeompoint, geometry),  
+  OPERATOR  1    << (tgeompoint, stbox),  
+  OPERATOR  1    << (tgeompoint, tgeompoint),  
+  -- overlaps or left
+  OPERATOR  2    &< (tgeompoint, geometry),  
+  OPERATOR  2    &< (tgeompoint, stbox),  
+  OPERATOR  2    &< (tgeompoint, tgeompoint),  
+  -- overlaps  
+  OPERATOR  3    && (tgeompoint, geometry),  
+  OPERATOR  3    && (tgeompoint, stbox),  
+  OPERATOR  3    && (tgeompoint, tgeompoint),  
+  -- overlaps or right
+  OPERATOR  4    &> (tgeompoint, geometry),  
+  OPERATOR  4    &> (tgeompoint, stbox),  
+  OPERATOR  4    &> (tgeompoint, tgeompoint),  
+    -- strictly right
+  OPERATOR  5    >> (tgeompoint, geometry),  
+  OPERATOR  5    >> (tgeompoint, stbox),  
+  OPERATOR  5    >> (tgeompoint, tgeompoint),  
+    -- same
+  OPERATOR  6    ~= (tgeompoint, geometry),  
+  OPERATOR  6    ~= (tgeompoint, stbox),  
+  OPERATOR  6    ~= (tgeompoint, tgeompoint),  
+  -- contains
+  OPERATOR  7    @> (tgeompoint, geometry),  
+  OPERATOR  7    @> (tgeompoint, stbox),  
+  OPERATOR  7    @> (tgeompoint, tgeompoint),  
+  -- contained by
+  OPERATOR  8    <@ (tgeompoint, geometry),  
+  OPERATOR  8    <@ (tgeompoint, stbox),  
+  OPERATOR  8    <@ (tgeompoint, tgeompoint),  
+  -- overlaps or below
+  OPERATOR  9    &<| (tgeompoint, geometry),  
+  OPERATOR  9    &<| (tgeompoint, stbox),  
+  OPERATOR  9    &<| (tgeompoint, tgeompoint),  
+  -- strictly below
+  OPERATOR  10    <<| (tgeompoint, geometry),  
+  OPERATOR  10    <<| (tgeompoint, stbox),  
+  OPERATOR  10    <<| (tgeompoint, tgeompoint),  
+  -- strictly above
+  OPERATOR  11    |>> (tgeompoint, geometry),  
+  OPERATOR  11    |>> (tgeompoint, stbox),  
+  OPERATOR  11    |>> (tgeompoint, tgeompoint),  
+  -- overlaps or above
+  OPERATOR  12    |&> (tgeompoint, geometry),  
+  OPERATOR  12    |&> (tgeompoint, stbox),  
+  OPERATOR  12    |&> (tgeompoint, tgeompoint),  
+  -- adjacent
+  OPERATOR  17    -|- (tgeompoint, geometry),
+  OPERATOR  17    -|- (tgeompoint, stbox),
+  OPERATOR  17    -|- (tgeompoint, tgeompoint),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tgeompoint, geometry) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tgeompoint, stbox) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tgeompoint, tgeompoint) FOR ORDER BY pg_catalog.float_ops,
+  -- overlaps or before
+  OPERATOR  28    &<# (tgeompoint, stbox),
+  OPERATOR  28    &<# (tgeompoint, tgeompoint),
+  -- strictly before
+  OPERATOR  29    <<# (tgeompoint, stbox),
+  OPERATOR  29    <<# (tgeompoint, tgeompoint),
+  -- strictly after
+  OPERATOR  30    #>> (tgeompoint, stbox),
+  OPERATOR  30    #>> (tgeompoint, tgeompoint),
+  -- overlaps or after
+  OPERATOR  31    #&> (tgeompoint, stbox),
+  OPERATOR  31    #&> (tgeompoint, tgeompoint),
+  -- overlaps or front
+  OPERATOR  32    &</ (tgeompoint, geometry),
+  OPERATOR  32    &</ (tgeompoint, stbox),
+  OPERATOR  32    &</ (tgeompoint, tgeompoint),
+  -- strictly front
+  OPERATOR  33    <</ (tgeompoint, geometry),
+  OPERATOR  33    <</ (tgeompoint, stbox),
+  OPERATOR  33    <</ (tgeompoint, tgeompoint),
+  -- strictly back
+  OPERATOR  34    />> (tgeompoint, geometry),
+  OPERATOR  34    />> (tgeompoint, stbox),
+  OPERATOR  34    />> (tgeompoint, tgeompoint),
+  -- overlaps or back
+  OPERATOR  35    /&> (tgeompoint, geometry),
+  OPERATOR  35    /&> (tgeompoint, stbox),
+  OPERATOR  35    /&> (tgeompoint, tgeompoint),
+  -- overlaps segments
+  OPERATOR  36    &&& (tgeompoint, geometry),
+  OPERATOR  36    &&& (tgeompoint, stbox),
+  -- functions
+  FUNCTION  1  gist_tgeompoint_compact_consistent(internal, tgeompoint, smallint, oid, internal),
+  FUNCTION  2  stbox_gist_union(internal, internal),
+  FUNCTION  3  tpoint_gist_compact_compress(internal),
+  FUNCTION  4  stbox_gist_compact_decompress(internal),
+  FUNCTION  5  stbox_gist_penalty(internal, internal, internal),
+  FUNCTION  6  stbox_gist_picksplit(internal, internal),
+  FUNCTION  7  stbox_gist_same(stbox, stbox, internal),
+  FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal);
+
+CREATE OPERATOR CLASS gist_tgeogpoint_compact_ops
+  FOR TYPE tgeogpoint USING gist AS
+  STORAGE bytea,
+  -- overlaps
+  OPERATOR  3    && (tgeogpoint, geography),  
+  OPERATOR  3    && (tgeogpoint, stbox),  
+  OPERATOR  3    && (tgeogpoint, tgeogpoint),  
+    -- same
+  OPERATOR  6    ~= (tgeogpoint, geography),  
+  OPERATOR  6    ~= (tgeogpoint, stbox),  
+  OPERATOR  6    ~= (tgeogpoint, tgeogpoint),  
+  -- contains
+  OPERATOR  7    @> (tgeogpoint, geography),  
+  OPERATOR  7    @> (tgeogpoint, stbox),  
+  OPERATOR  7    @> (tgeogpoint, tgeogpoint),  
+  -- contained by
+  OPERATOR  8    <@ (tgeogpoint, geography),  
+  OPERATOR  8    <@ (tgeogpoint, stbox),  
+  OPERATOR  8    <@ (tgeogpoint, tgeogpoint),  
+  -- adjacent
+  OPERATOR  17    -|- (tgeogpoint, geography),
+  OPERATOR  17    -|- (tgeogpoint, stbox),
+  OPERATOR  17    -|- (tgeogpoint, tgeogpoint),
+  -- distance
+  OPERATOR  25    |=| (tgeogpoint, geography) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tgeogpoint, stbox) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tgeogpoint, tgeogpoint) FOR ORDER BY pg_catalog.float_ops,
+  -- overlaps or before
+  OPERATOR  28    &<# (tgeogpoint, stbox),
+  OPERATOR  28    &<# (tgeogpoint, tgeogpoint),
+  -- strictly before
+  OPERATOR  29    <<# (tgeogpoint, stbox),
+  OPERATOR  29    <<# (tgeogpoint, tgeogpoint),
+  -- strictly after
+  OPERATOR  30    #>> (tgeogpoint, stbox),
+  OPERATOR  30    #>> (tgeogpoint, tgeogpoint),
+  -- overlaps or after
+  OPERATOR  31    #&> (tgeogpoint, stbox),
+  OPERATOR  31    #&> (tgeogpoint, tgeogpoint),
+  -- functions
+  FUNCTION  1  gist_tgeogpoint_compact_consistent(internal, tgeogpoint, smallint, oid, internal),
+  FUNCTION  2  stbox_gist_union(internal, internal),
+  FUNCTION  3  tpoint_gist_compact_compress(internal),
+  FUNCTION  4  stbox_gist_compact_decompress(internal),
+  FUNCTION  5  stbox_gist_penalty(internal, internal, internal),
+  FUNCTION  6  stbox_gist_picksplit(internal, internal),
+  FUNCTION  7  stbox_gist_same(stbox, stbox, internal),
   FUNCTION  8  stbox_gist_distance(internal, stbox, smallint, oid, internal);
   
 /******************************************************************************/
@@ -15,4 +15,13 @@ CREATE FUNCTION create_trip(record[], timestamptz, boolean, text)
   AS 'MODULE_PATHNAME', 'create_trip'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+-- The paths of the trips are given by the array of edges and the number of
+-- edges of each path, the random numbers of each trip are derived from the
+-- seed and the position of the trip in the batch
+CREATE FUNCTION create_trips(record[], int[], timestamptz[], bigint, boolean,
+    text)
+  RETURNS SETOF tgeompoint
+  AS 'MODULE_PATHNAME', 'create_trips'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
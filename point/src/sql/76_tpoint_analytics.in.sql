@@ -75,3 +75,58 @@ AS 'MODULE_PATHNAME', 'tpoint_simplify'
 LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 /*****************************************************************************/
+-- Multi-resolution pyramid of simplifications for increasing tolerances
+
+CREATE FUNCTION simplifyPyramid(tgeompoint, float8[])
+RETURNS tgeompoint[]
+AS 'MODULE_PATHNAME', 'tpoint_simplify_pyramid'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION trajectory(tgeompoint[], float8[], float8)
+RETURNS geometry
+AS 'MODULE_PATHNAME', 'tpoint_pyramid_trajectory'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
+-- Online simplification bounded by the synchronized Euclidean distance.
+-- The values must be aggregated in increasing order of time
+
+CREATE FUNCTION simplifySeq_transfn(internal, tgeompoint, float8)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_simplify_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION simplifySeq_finalfn(internal)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'tpoint_simplify_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE simplifySeq(tgeompoint, float8) (
+  SFUNC = simplifySeq_transfn,
+  STYPE = internal,
+  FINALFUNC = simplifySeq_finalfn
+);
+
+/*****************************************************************************/
+-- Stops of at least a duration within a distance and trips between them
+
+CREATE FUNCTION stops(tgeompoint, maxdist float8, minduration interval)
+RETURNS tgeompoint
+AS 'MODULE_PATHNAME', 'tpoint_stops'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION trips(tgeompoint, maxdist float8, minduration interval)
+RETURNS tgeompoint
+AS 'MODULE_PATHNAME', 'tpoint_trips'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
+-- Geometry of a temporal point in the coordinate space of a vector tile,
+-- where the M coordinates encode the timestamps
+
+CREATE FUNCTION asMVTGeom(tgeompoint, bounds stbox, extent int4 DEFAULT 4096,
+  buffer int4 DEFAULT 256, clip_geom bool DEFAULT TRUE)
+RETURNS geometry
+AS 'MODULE_PATHNAME', 'tpoint_as_mvtgeom'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
@@ -0,0 +1,125 @@
+/*****************************************************************************
+ *
+ * tpoint_tile.sql
+ *    Splitting of temporal points into spatial tiles and time buckets
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION timeSplit(tgeompoint, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT temp tgeompoint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timeSplit(tgeogpoint, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT temp tgeogpoint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION spaceSplit(tgeompoint, xsize float, ysize float,
+    origin geometry DEFAULT 'Point(0 0)', OUT tile stbox,
+    OUT temp tgeompoint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tpoint_space_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION spaceTimeSplit(tgeompoint, xsize float, ysize float,
+    duration interval, sorigin geometry DEFAULT 'Point(0 0)',
+    torigin timestamptz DEFAULT '2000-01-03', OUT tile stbox,
+    OUT temp tgeompoint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tpoint_space_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Dwell time in spatial tiles
+ *****************************************************************************/
+
+CREATE FUNCTION dwellTimeGrid_transfn(internal, tgeompoint, float, float)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION dwellTimeGrid_transfn(internal, tgeompoint, float, float,
+    geometry)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION dwellTimeGrid_transfn(internal, tgeompoint, float, float,
+    interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION dwellTimeGrid_transfn(internal, tgeompoint, float, float,
+    interval, geometry, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION dwellTimeGrid_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION dwellTimeGrid_finalfn(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION dwellTimeGrid_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- The arguments are the sizes of the tiles, followed by the spatial origin,
+-- by the duration of the time buckets, or by the duration and both origins
+CREATE AGGREGATE dwellTimeGrid(tgeompoint, float, float) (
+  SFUNC = dwellTimeGrid_transfn,
+  STYPE = internal,
+  COMBINEFUNC = dwellTimeGrid_combinefn,
+  FINALFUNC = dwellTimeGrid_finalfn,
+  SERIALFUNC = dwellTimeGrid_finalfn,
+  DESERIALFUNC = dwellTimeGrid_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE dwellTimeGrid(tgeompoint, float, float, geometry) (
+  SFUNC = dwellTimeGrid_transfn,
+  STYPE = internal,
+  COMBINEFUNC = dwellTimeGrid_combinefn,
+  FINALFUNC = dwellTimeGrid_finalfn,
+  SERIALFUNC = dwellTimeGrid_finalfn,
+  DESERIALFUNC = dwellTimeGrid_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE dwellTimeGrid(tgeompoint, float, float, interval) (
+  SFUNC = dwellTimeGrid_transfn,
+  STYPE = internal,
+  COMBINEFUNC = dwellTimeGrid_combinefn,
+  FINALFUNC = dwellTimeGrid_finalfn,
+  SERIALFUNC = dwellTimeGrid_finalfn,
+  DESERIALFUNC = dwellTimeGrid_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE dwellTimeGrid(tgeompoint, float, float, interval, geometry,
+    timestamptz) (
+  SFUNC = dwellTimeGrid_transfn,
+  STYPE = internal,
+  COMBINEFUNC = dwellTimeGrid_combinefn,
+  FINALFUNC = dwellTimeGrid_finalfn,
+  SERIALFUNC = dwellTimeGrid_finalfn,
+  DESERIALFUNC = dwellTimeGrid_deserialize,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION dwellTimeCells(bytea, OUT tile stbox, OUT duration interval,
+    OUT visits bigint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tpoint_dwell_cells'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
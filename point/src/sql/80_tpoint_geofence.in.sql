@@ -0,0 +1,20 @@
+/*****************************************************************************
+ *
+ * tpoint_geofence.sql
+ *    Time during which a temporal point intersects each geometry of an
+ *    array of geofences.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION whenIntersectsFences(tgeompoint, fences geometry[],
+    OUT fence integer, OUT periods periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'when_intersects_tpoint_geoarr'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
@@ -0,0 +1,20 @@
+/*****************************************************************************
+ *
+ * tpoint_knn.sql
+ *    Continuous k nearest neighbors of a temporal point among an array of
+ *    temporal points.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION tkNN(tgeompoint, candidates tgeompoint[], k integer,
+    OUT neighbor integer, OUT periods periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tknn_tpoint_tpointarr'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
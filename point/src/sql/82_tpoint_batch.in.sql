@@ -0,0 +1,29 @@
+/*****************************************************************************
+ *
+ * tpoint_batch.sql
+ *    Batch computation of tdwithin and of the nearest approach distance
+ *    for pairs of temporal points given in the columnar format
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+-- The i-th temporal points of the two buffers produced by asArrow form the
+-- i-th pair, only the pairs with a result are returned
+
+CREATE FUNCTION tdwithinBatch(bytea, bytea, dist float8, OUT id integer,
+    OUT periods periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tdwithin_batch'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION nearestApproachDistanceBatch(bytea, bytea, OUT id integer,
+    OUT distance float8)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'distance_batch'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
@@ -0,0 +1,36 @@
+/*****************************************************************************
+ *
+ * tpoint_snapshot.sql
+ *    Positions of an array of temporal points at one or more timestamps
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+-- The points of the multipoints keep the order of the array, the temporal
+-- points that are not defined at a timestamp are skipped
+
+CREATE FUNCTION snapshot(tgeompoint[], timestamptz)
+  RETURNS geometry
+  AS 'MODULE_PATHNAME', 'tpointarr_snapshot'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION snapshot(tgeogpoint[], timestamptz)
+  RETURNS geography
+  AS 'MODULE_PATHNAME', 'tpointarr_snapshot'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION snapshots(tgeompoint[], timestamptz[], OUT t timestamptz,
+    OUT ids integer[], OUT points geometry)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tpointarr_snapshots'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION snapshots(tgeogpoint[], timestamptz[], OUT t timestamptz,
+    OUT ids integer[], OUT points geography)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tpointarr_snapshots'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
@@ -1944,5 +1944,52 @@ stbox_ne(PG_FUNCTION_ARGS)
   PG_RETURN_BOOL(! stbox_eq_internal(box1, box2));
 }
 
+/*****************************************************************************
+ * Z-order functions
+ * The Z-order key of a box is computed from the center of its x, y, and t
+ * dimensions, normalized with respect to an extent. Ordering a table by
+ * this key clusters the values that are close in both space and time.
+ *****************************************************************************/
+
+/* Number of bits per dimension of the Z-order key of a box */
+#define STBOX_ZORDER_BITS    21
+
+/**
+ * Returns the Z-order key of the spatiotemporal box with respect to the
+ * extent (internal function)
+ */
+int64
+stbox_zorder_internal(const STBOX *box, const STBOX *extent)
+{
+  uint32 cells[3];
+  TimestampTz t = box->tmin + (box->tmax - box->tmin) / 2;
+  cells[0] = zorder_cell(box->xmin + (box->xmax - box->xmin) / 2,
+    extent->xmin, extent->xmax, STBOX_ZORDER_BITS);
+  cells[1] = zorder_cell(box->ymin + (box->ymax - box->ymin) / 2,
+    extent->ymin, extent->ymax, STBOX_ZORDER_BITS);
+  cells[2] = zorder_cell((double) t, (double) extent->tmin,
+    (double) extent->tmax, STBOX_ZORDER_BITS);
+  return (int64) zorder_encode(cells, 3, STBOX_ZORDER_BITS);
+}
+
+PG_FUNCTION_INFO_V1(stbox_zorder);
+/**
+ * Returns the Z-order key of the spatiotemporal box with respect to the
+ * extent
+ */
+PGDLLEXPORT Datum
+stbox_zorder(PG_FUNCTION_ARGS)
+{
+  STBOX *box = PG_GETARG_STBOX_P(0);
+  STBOX *extent = PG_GETARG_STBOX_P(1);
+  ensure_has_X_stbox(box);
+  ensure_has_T_stbox(box);
+  ensure_has_X_stbox(extent);
+  ensure_has_T_stbox(extent);
+  ensure_same_geodetic_stbox(box, extent);
+  ensure_same_srid_stbox(box, extent);
+  PG_RETURN_INT64(stbox_zorder_internal(box, extent));
+}
+
 /*****************************************************************************/
 
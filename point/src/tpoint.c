@@ -79,6 +79,7 @@ tpoint_valid_typmod(Temporal *temp, int32_t typmod)
   int32 tpoint_srid = tpoint_srid_internal(temp);
   TDuration tpoint_duration = temp->duration;
   TDuration typmod_duration = TYPMOD_GET_DURATION(typmod);
+  TStorage typmod_storage = TYPMOD_GET_STORAGE(typmod);
   TYPMOD_DEL_DURATION(typmod);
   /* If there is no geometry type */
   if (typmod == 0)
@@ -89,7 +90,8 @@ tpoint_valid_typmod(Temporal *temp, int32_t typmod)
   int32 typmod_z = TYPMOD_GET_Z(typmod);
 
   /* No typmod (-1) */
-  if (typmod < 0 && typmod_duration == ANYDURATION)
+  if (typmod < 0 && typmod_duration == ANYDURATION &&
+    typmod_storage == STORAGE_EXPANDED)
     return temp;
   /* Typmod has a preference for SRID? Geometry SRID had better match */
   if (typmod_srid > 0 && typmod_srid != tpoint_srid)
@@ -109,6 +111,9 @@ tpoint_valid_typmod(Temporal *temp, int32_t typmod)
   if (typmod > 0 && tpoint_z && ! typmod_z)
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
       errmsg("Temporal point has Z dimension but column does not" )));
+  /* Typmod requires packed or compressed storage */
+  if (typmod_storage != STORAGE_EXPANDED)
+    temp = temporal_pack(temp, typmod_storage);
 
   return temp;
 }
@@ -177,6 +182,9 @@ tpoint_typmod_in(ArrayType *arr, int is_geography)
    *
    * For example, if the user did not set the duration type, we can use any 
    * duration type in the same column. Similarly for all generic modifiers.
+   * In addition, any of the above can be followed by a Packed or a
+   * Compressed modifier stating that the values of the column are stored
+   * in packed or compressed form.
    */
   deconstruct_array(arr, CSTRINGOID, -2, false, 'c', &elem_values, NULL, &n);
   TDuration duration = ANYDURATION;
@@ -184,6 +192,11 @@ tpoint_typmod_in(ArrayType *arr, int is_geography)
   int hasZ = 0, hasM = 0, srid;
   char *s;
 
+  TStorage storage = STORAGE_EXPANDED;
+  if (n > 0 && tstorage_from_string(DatumGetCString(elem_values[n - 1]),
+      &storage))
+    n--;
+
   bool has_geo = false, has_srid = false;
   if (n == 3)
   {
@@ -237,7 +250,7 @@ tpoint_typmod_in(ArrayType *arr, int is_geography)
       ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
         errmsg("Invalid temporal point type modifier:")));
   }
-  else
+  else if (n != 0 || storage == STORAGE_EXPANDED)
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
         errmsg("Invalid temporal point type modifier:")));
 
@@ -269,6 +282,7 @@ tpoint_typmod_in(ArrayType *arr, int is_geography)
 
   /* Shift to restore the 4 bits of the duration */
   TYPMOD_SET_DURATION(typmod, duration);
+  TYPMOD_SET_STORAGE(typmod, storage);
 
   pfree(elem_values);
   return typmod;
@@ -312,6 +326,7 @@ tpoint_typmod_out(PG_FUNCTION_ARGS)
   char *str = s;
   int32 typmod = PG_GETARG_INT32(0);
   TDuration duration = TYPMOD_GET_DURATION(typmod);
+  TStorage storage = TYPMOD_GET_STORAGE(typmod);
   TYPMOD_DEL_DURATION(typmod);
   int32 srid = TYPMOD_GET_SRID(typmod);
   uint8_t geometry_type = (uint8_t) TYPMOD_GET_TYPE(typmod);
@@ -319,7 +334,8 @@ tpoint_typmod_out(PG_FUNCTION_ARGS)
 
   /* No duration type or geometry type? Then no typmod at all. 
     Return empty string. */
-  if (typmod < 0 || (duration == ANYDURATION && !geometry_type))
+  if (typmod < 0 || (duration == ANYDURATION && !geometry_type &&
+    storage == STORAGE_EXPANDED))
   {
     *str = '\0';
     PG_RETURN_CSTRING(str);
@@ -338,6 +354,12 @@ tpoint_typmod_out(PG_FUNCTION_ARGS)
     /* Has SRID?  */
     if (srid) str += sprintf(str, ",%d", srid);
   }
+  /* Packed or compressed storage?  */
+  if (storage != STORAGE_EXPANDED)
+  {
+    if (duration != ANYDURATION || geometry_type) str += sprintf(str, ",");
+    str += sprintf(str, "%s", tstorage_name(storage));
+  }
   /* Closing bracket.  */
   sprintf(str, ")");
 
@@ -393,13 +415,29 @@ PG_FUNCTION_INFO_V1(tpoint_to_stbox);
 PGDLLEXPORT Datum
 tpoint_to_stbox(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   STBOX *result = palloc0(sizeof(STBOX));
-  temporal_bbox(result, temp);
-  PG_FREE_IF_COPY(temp, 0);
+  temporal_bbox_slice(result, PG_GETARG_DATUM(0));
   PG_RETURN_POINTER(result);
 }
 
+PG_FUNCTION_INFO_V1(tpoint_zorder);
+/**
+ * Returns the Z-order key of the bounding box of the temporal point with
+ * respect to the extent
+ */
+PGDLLEXPORT Datum
+tpoint_zorder(PG_FUNCTION_ARGS)
+{
+  STBOX box, *extent = PG_GETARG_STBOX_P(1);
+  memset(&box, 0, sizeof(STBOX));
+  temporal_bbox_slice(&box, PG_GETARG_DATUM(0));
+  ensure_has_X_stbox(extent);
+  ensure_has_T_stbox(extent);
+  ensure_same_geodetic_stbox(&box, extent);
+  ensure_same_srid_stbox(&box, extent);
+  PG_RETURN_INT64(stbox_zorder_internal(&box, extent));
+}
+
 /*****************************************************************************
  * Temporal comparisons
  *****************************************************************************/
@@ -3,7 +3,8 @@
  * tpoint_aggfuncs.c
  *  Aggregate functions for temporal points.
  *
- * The only functions currently provided are extent and temporal centroid.
+ * The functions currently provided are extent, temporal centroid, and
+ * temporal count within a geometry.
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  *    Universite Libre de Bruxelles
@@ -15,185 +16,16 @@
 #include "tpoint_aggfuncs.h"
 
 #include <assert.h>
+#include <libpq/pqformat.h>
 
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
-#include "doublen.h"
 #include "temporal_aggfuncs.h"
+#include "postgis.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
 
-/*****************************************************************************
- * Generic functions
- *****************************************************************************/
-
-/**
- * Structure storing the SRID and the dimensionality of the temporal point 
- * values for aggregation. Notice that for the moment we do not aggregate
- * temporal geographic points.
- */
-struct GeoAggregateState
-{
-  int32_t srid;
-  bool hasz;
-};
-
-/**
- * Check the validity of the temporal point values for aggregation
- */
-static void
-geoaggstate_check(const SkipList *state, int32_t srid, bool hasz)
-{
-  if(! state)
-    return;
-  struct GeoAggregateState *extra = state->extra;
-  if (extra && extra->srid != srid)
-    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-      errmsg("Geometries must have the same SRID for temporal aggregation")));
-  if (extra && extra->hasz != hasz)
-    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-      errmsg("Geometries must have the same dimensionality for temporal aggregation")));
-  return;
-}
-
-/**
- * Check the validity of the temporal point values for aggregation
- */
-static void 
-geoaggstate_check_as(const SkipList *state1, const SkipList *state2)
-{
-  if(! state2) 
-    return ;
-  struct GeoAggregateState *extra2 = state2->extra;
-  if (extra2)
-    geoaggstate_check(state1, extra2->srid, extra2->hasz);
-  return;
-}
-
-/**
- * Chech the validity of the temporal point values for aggregation
- */
-static void
-geoaggstate_check_t(const SkipList *state, const Temporal *t)
-{
-  geoaggstate_check(state, tpoint_srid_internal(t), MOBDB_FLAGS_GET_Z(t->flags) != 0);
-  return;
-}
-
-/*****************************************************************************/
-
-/**
- * Transform a temporal point value of instant duration into a temporal 
- * double3/double4 value for performing temporal centroid aggregation 
- */
-static TInstant *
-tpointinst_transform_tcentroid(const TInstant *inst)
-{
-  TInstant *result;
-  if (MOBDB_FLAGS_GET_Z(inst->flags))
-  {
-    const POINT3DZ *point = datum_get_point3dz_p(tinstant_value(inst));
-    double4 dvalue;
-    double4_set(&dvalue, point->x, point->y, point->z, 1);
-    result = tinstant_make(PointerGetDatum(&dvalue), inst->t,
-      type_oid(T_DOUBLE4));
-  }
-  else 
-  {
-    const POINT2D *point = datum_get_point2d_p(tinstant_value(inst));
-    double3 dvalue;
-    double3_set(&dvalue, point->x, point->y, 1);
-    result = tinstant_make(PointerGetDatum(&dvalue), inst->t,
-      type_oid(T_DOUBLE3));
-  }
-  return result;
-}
-
-/**
- * Transform a temporal point value of instant set duration into a temporal 
- * double3/double4 value for performing temporal centroid aggregation 
- */
-static TInstant **
-tpointinstset_transform_tcentroid(const TInstantSet *ti)
-{
-  TInstant **result = palloc(sizeof(TInstant *) * ti->count);
-  for (int i = 0; i < ti->count; i++)
-  {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    result[i] = tpointinst_transform_tcentroid(inst);
-  }
-  return result;
-}
-
-/**
- * Transform a temporal point value of sequence duration into a temporal 
- * double3/double4 value for performing temporal centroid aggregation 
- */
-static TSequence *
-tpointseq_transform_tcentroid(const TSequence *seq)
-{
-  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
-  for (int i = 0; i < seq->count; i++)
-  {
-    TInstant *inst = tsequence_inst_n(seq, i);
-    instants[i] = tpointinst_transform_tcentroid(inst);
-  }
-  return tsequence_make_free(instants, 
-    seq->count, seq->period.lower_inc, seq->period.upper_inc, 
-    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE_NO);
-}
-
-/**
- * Transform a temporal point value of sequence set duration into a temporal 
- * double3/double4 value for performing temporal centroid aggregation 
- */
-static TSequence **
-tpointseqset_transform_tcentroid(const TSequenceSet *ts)
-{
-  TSequence **result = palloc(sizeof(TSequence *) * ts->count);
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    result[i] = tpointseq_transform_tcentroid(seq);
-  }
-  return result;
-}
-
-/**
- * Transform a temporal point value for performing temporal centroid aggregation 
- * (dispatch function)
- */
-static Temporal **
-tpoint_transform_tcentroid(const Temporal *temp, int *count)
-{
-  Temporal **result;
-  if (temp->duration == INSTANT) 
-  {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tpointinst_transform_tcentroid((TInstant *)temp);
-    *count = 1;
-  }
-  else if (temp->duration == INSTANTSET)
-  {
-    result = (Temporal **)tpointinstset_transform_tcentroid((TInstantSet *) temp);
-    *count = ((TInstantSet *)temp)->count;
-  } 
-  else if (temp->duration == SEQUENCE)
-  {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tpointseq_transform_tcentroid((TSequence *) temp);
-    *count = 1;
-  }
-  else /* temp->duration == SEQUENCESET */
-  {
-    result = (Temporal **)tpointseqset_transform_tcentroid((TSequenceSet *) temp);
-    *count = ((TSequenceSet *)temp)->count;
-  }
-  assert(result != NULL);
-  return result;
-}
-
 /*****************************************************************************
  * Extent
  *****************************************************************************/
@@ -262,8 +94,187 @@ tpoint_extent_combinefn(PG_FUNCTION_ARGS)
 
 /*****************************************************************************
  * Centroid
+ * The coordinates of the points are accumulated in a typed state without
+ * constructing temporal values. For instant duration, the state keeps for
+ * each timestamp the sums of the coordinates and the number of points. For
+ * sequence duration, the state keeps the points of every sequence and the
+ * final function sweeps the timestamps of all the points. Notice that for
+ * the moment we do not aggregate temporal geographic points.
  *****************************************************************************/
 
+/**
+ * Create a new state for temporal centroid aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] duration Duration of the result, either INSTANT or SEQUENCE
+ * @param[in] linear True when the sequences have linear interpolation
+ * @param[in] srid,hasz SRID and dimensionality of the points
+ * @param[in] pointcap,seqcap Number of points and of sequences to reserve
+ */
+static CentroidState *
+centroidstate_make(FunctionCallInfo fcinfo, TDuration duration, bool linear,
+  int32 srid, bool hasz, int pointcap, int seqcap)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  CentroidState *result = palloc(sizeof(CentroidState));
+  result->duration = duration;
+  result->linear = linear;
+  result->srid = srid;
+  result->hasz = hasz;
+  result->pointcap = Max(pointcap, CENTROIDSTATE_INITIAL_CAPACITY);
+  result->pointcount = 0;
+  result->points = palloc(sizeof(CentroidPoint) * result->pointcap);
+  result->seqcap = Max(seqcap, CENTROIDSTATE_INITIAL_CAPACITY);
+  result->seqcount = 0;
+  result->sequences = palloc(sizeof(CentroidSeq) * result->seqcap);
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Check the validity of the temporal point values for aggregation
+ */
+static void
+centroidstate_check(const CentroidState *state, int32 srid, bool hasz,
+  TDuration duration, bool linear)
+{
+  if (state->srid != srid)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Geometries must have the same SRID for temporal aggregation")));
+  if (state->hasz != hasz)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Geometries must have the same dimensionality for temporal aggregation")));
+  if (state->duration != duration)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different duration")));
+  if (duration == SEQUENCE && state->linear != linear)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different interpolation")));
+  return;
+}
+
+/**
+ * Comparator function for centroid points
+ */
+static int
+centroid_point_cmp(const void *a, const void *b)
+{
+  TimestampTz t1 = ((const CentroidPoint *) a)->t;
+  TimestampTz t2 = ((const CentroidPoint *) b)->t;
+  return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
+}
+
+/**
+ * Sort the points of a state of instant duration and merge the points
+ * at the same timestamp
+ */
+static void
+centroidstate_compact(CentroidState *state)
+{
+  assert(state->duration == INSTANT);
+  if (state->pointcount <= 1)
+    return;
+  qsort(state->points, (size_t) state->pointcount, sizeof(CentroidPoint),
+    &centroid_point_cmp);
+  int k = 0;
+  for (int i = 1; i < state->pointcount; i++)
+  {
+    CentroidPoint *point = &state->points[i];
+    CentroidPoint *last = &state->points[k];
+    if (point->t == last->t)
+    {
+      last->x += point->x;
+      last->y += point->y;
+      last->z += point->z;
+      last->count += point->count;
+    }
+    else
+      state->points[++k] = *point;
+  }
+  state->pointcount = k + 1;
+  return;
+}
+
+/**
+ * Ensure that the state can hold the given number of additional points and
+ * sequences. The points of a state of instant duration are compacted before
+ * growing the arrays.
+ */
+static void
+centroidstate_reserve(FunctionCallInfo fcinfo, CentroidState *state,
+  int pointcount, int seqcount)
+{
+  if (state->pointcount + pointcount > state->pointcap &&
+    state->duration == INSTANT)
+    centroidstate_compact(state);
+  if (state->pointcount + pointcount <= state->pointcap &&
+    state->seqcount + seqcount <= state->seqcap)
+    return;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  if (state->pointcount + pointcount > state->pointcap)
+  {
+    while (state->pointcount + pointcount > state->pointcap)
+      state->pointcap <<= 1;
+    state->points = repalloc(state->points,
+      sizeof(CentroidPoint) * state->pointcap);
+  }
+  if (state->seqcount + seqcount > state->seqcap)
+  {
+    while (state->seqcount + seqcount > state->seqcap)
+      state->seqcap <<= 1;
+    state->sequences = repalloc(state->sequences,
+      sizeof(CentroidSeq) * state->seqcap);
+  }
+  unset_aggregation_context(ctx);
+  return;
+}
+
+/**
+ * Append the point of the temporal instant value to the state
+ *
+ * @pre The state has capacity for the point
+ */
+static void
+centroidstate_add_inst(CentroidState *state, const TInstant *inst)
+{
+  CentroidPoint *point = &state->points[state->pointcount++];
+  point->t = inst->t;
+  if (state->hasz)
+  {
+    const POINT3DZ *p = datum_get_point3dz_p(tinstant_value(inst));
+    point->x = p->x;
+    point->y = p->y;
+    point->z = p->z;
+  }
+  else
+  {
+    const POINT2D *p = datum_get_point2d_p(tinstant_value(inst));
+    point->x = p->x;
+    point->y = p->y;
+    point->z = 0;
+  }
+  point->count = 1;
+  return;
+}
+
+/**
+ * Append the points of the temporal sequence value to the state
+ *
+ * @pre The state has capacity for the sequence and its points
+ */
+static void
+centroidstate_add_seq(CentroidState *state, const TSequence *seq)
+{
+  CentroidSeq *cseq = &state->sequences[state->seqcount++];
+  cseq->start = state->pointcount;
+  cseq->count = seq->count;
+  cseq->lower_inc = seq->period.lower_inc;
+  cseq->upper_inc = seq->period.upper_inc;
+  for (int i = 0; i < seq->count; i++)
+    centroidstate_add_inst(state, tsequence_inst_n(seq, i));
+  return;
+}
+
 PG_FUNCTION_INFO_V1(tpoint_tcentroid_transfn);
 /**
  * Transition function for temporal centroid aggregation of temporal point values
@@ -271,8 +282,8 @@ PG_FUNCTION_INFO_V1(tpoint_tcentroid_transfn);
 PGDLLEXPORT Datum
 tpoint_tcentroid_transfn(PG_FUNCTION_ARGS)
 {
-  SkipList *state = PG_ARGISNULL(0) ? NULL : 
-    (SkipList *) PG_GETARG_POINTER(0);
+  CentroidState *state = PG_ARGISNULL(0) ? NULL : 
+    (CentroidState *) PG_GETARG_POINTER(0);
   Temporal *temp = PG_ARGISNULL(1) ? NULL : PG_GETARG_TEMPORAL(1);
   /* Can't do anything with null inputs */
   if (!state && !temp)
@@ -283,38 +294,58 @@ tpoint_tcentroid_transfn(PG_FUNCTION_ARGS)
     PG_RETURN_POINTER(state);
   }
 
-  geoaggstate_check_t(state, temp);
-  Datum (*func)(Datum, Datum) = MOBDB_FLAGS_GET_Z(temp->flags) ?
-    &datum_sum_double4 : &datum_sum_double3;
-
-  int count;
-  Temporal **temparr = tpoint_transform_tcentroid(temp, &count);
+  ensure_valid_duration(temp->duration);
+  int pointcount, seqcount;
+  if (temp->duration == INSTANT)
+  {
+    pointcount = 1;
+    seqcount = 0;
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    pointcount = ((TInstantSet *) temp)->count;
+    seqcount = 0;
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    pointcount = ((TSequence *) temp)->count;
+    seqcount = 1;
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    pointcount = ((TSequenceSet *) temp)->totalcount;
+    seqcount = ((TSequenceSet *) temp)->count;
+  }
+  TDuration duration = (temp->duration == INSTANT ||
+    temp->duration == INSTANTSET) ? INSTANT : SEQUENCE;
+  int32 srid = tpoint_srid_internal(temp);
+  bool hasz = MOBDB_FLAGS_GET_Z(temp->flags) != 0;
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
   if (state)
   {
-    if (skiplist_headval(state)->duration != temparr[0]->duration)
-      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-        errmsg("Cannot aggregate temporal values of different duration")));
-    if (MOBDB_FLAGS_GET_LINEAR(skiplist_headval(state)->flags) != 
-        MOBDB_FLAGS_GET_LINEAR(temparr[0]->flags))
-      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-        errmsg("Cannot aggregate temporal values of different interpolation")));
-
-    skiplist_splice(fcinfo, state, temparr, count, func, false);
+    centroidstate_check(state, srid, hasz, duration, linear);
+    centroidstate_reserve(fcinfo, state, pointcount, seqcount);
   }
   else
+    state = centroidstate_make(fcinfo, duration, linear, srid, hasz,
+      pointcount, seqcount);
+
+  if (temp->duration == INSTANT)
+    centroidstate_add_inst(state, (TInstant *) temp);
+  else if (temp->duration == INSTANTSET)
   {
-    state = skiplist_make(fcinfo, temparr, count);
-    struct GeoAggregateState extra =
-    {
-      .srid = tpoint_srid_internal(temp),
-      .hasz = MOBDB_FLAGS_GET_Z(temp->flags) != 0
-    };
-    aggstate_set_extra(fcinfo, state, &extra, sizeof(struct GeoAggregateState));
+    TInstantSet *ti = (TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+      centroidstate_add_inst(state, tinstantset_inst_n(ti, i));
+  }
+  else if (temp->duration == SEQUENCE)
+    centroidstate_add_seq(state, (TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      centroidstate_add_seq(state, tsequenceset_seq_n(ts, i));
   }
-
-  for (int i = 0; i< count; i++)
-    pfree(temparr[i]);
-  pfree(temparr);
   PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_POINTER(state);
 }
@@ -328,55 +359,70 @@ PG_FUNCTION_INFO_V1(tpoint_tcentroid_combinefn);
 PGDLLEXPORT Datum
 tpoint_tcentroid_combinefn(PG_FUNCTION_ARGS)
 {
-  SkipList *state1 = PG_ARGISNULL(0) ? NULL : 
-    (SkipList *) PG_GETARG_POINTER(0);
-  SkipList *state2 = PG_ARGISNULL(1) ? NULL :
-    (SkipList *) PG_GETARG_POINTER(1);
-
-  geoaggstate_check_as(state1, state2);
-  struct GeoAggregateState *extra = NULL;
-  if (state1 && state1->extra) 
-    extra = state1->extra;
-  if (state2 && state2->extra) 
-    extra = state2->extra;
-  assert(extra != NULL);
-  Datum (*func)(Datum, Datum) = extra->hasz ?
-    &datum_sum_double4 : &datum_sum_double3;
-  SkipList *result = temporal_tagg_combinefn1(fcinfo, state1, state2, 
-    func, false);
-
-  PG_RETURN_POINTER(result);
+  CentroidState *state1 = PG_ARGISNULL(0) ? NULL : 
+    (CentroidState *) PG_GETARG_POINTER(0);
+  CentroidState *state2 = PG_ARGISNULL(1) ? NULL :
+    (CentroidState *) PG_GETARG_POINTER(1);
+  if (!state1 && !state2)
+    PG_RETURN_NULL();
+  if (state1 && !state2)
+    PG_RETURN_POINTER(state1);
+  if (state2 && !state1)
+    PG_RETURN_POINTER(state2);
+
+  centroidstate_check(state1, state2->srid, state2->hasz, state2->duration,
+    state2->linear);
+  centroidstate_reserve(fcinfo, state1, state2->pointcount, state2->seqcount);
+  int offset = state1->pointcount;
+  memcpy(&state1->points[offset], state2->points,
+    sizeof(CentroidPoint) * state2->pointcount);
+  state1->pointcount += state2->pointcount;
+  for (int i = 0; i < state2->seqcount; i++)
+  {
+    CentroidSeq *seq = &state1->sequences[state1->seqcount++];
+    *seq = state2->sequences[i];
+    seq->start += offset;
+  }
+  PG_RETURN_POINTER(state1);
 }
 
 /*****************************************************************************/
 
 /**
- * Transforms a temporal doubleN instant into a point
+ * Add the coordinates to the sum
  */
-static Datum 
-doublen_to_point(TInstant *inst, int srid)
+static void
+centroid_sum_add(CentroidPoint *sum, double x, double y, double z)
 {
-  assert(inst->valuetypid == type_oid(T_DOUBLE4) ||
-    inst->valuetypid == type_oid(T_DOUBLE3));
-  LWPOINT *point;
-  if (inst->valuetypid == type_oid(T_DOUBLE4))
-  {
-    double4 *value4 = (double4 *)DatumGetPointer(tinstant_value_ptr(inst));
-    assert(value4->d != 0);
-    double valuea = value4->a / value4->d;
-    double valueb = value4->b / value4->d;
-    double valuec = value4->c / value4->d;
-    point = lwpoint_make3dz(srid, valuea, valueb, valuec);
-  }
-  else /* inst->valuetypid == type_oid(T_DOUBLE3) */
-  {
-    double3 *value3 = (double3 *)DatumGetPointer(tinstant_value_ptr(inst));
-    assert(value3->c != 0);
-    double valuea = value3->a / value3->c;
-    double valueb = value3->b / value3->c;
-    point = lwpoint_make2d(srid, valuea, valueb);
-  }
-  /* Notice that for the moment we do not aggregate temporal geographic points */
+  sum->x += x;
+  sum->y += y;
+  sum->z += z;
+  sum->count++;
+  return;
+}
+
+/**
+ * Returns true if the two sums have the same centroid
+ */
+static bool
+centroid_sum_eq(const CentroidPoint *sum1, const CentroidPoint *sum2)
+{
+  return sum1->x / sum1->count == sum2->x / sum2->count &&
+    sum1->y / sum1->count == sum2->y / sum2->count &&
+    sum1->z / sum1->count == sum2->z / sum2->count;
+}
+
+/**
+ * Construct the centroid of the sum
+ */
+static Datum
+centroid_sum_point(const CentroidPoint *sum, int32 srid, bool hasz)
+{
+  assert(sum->count != 0);
+  LWPOINT *point = hasz ?
+    lwpoint_make3dz(srid, sum->x / sum->count, sum->y / sum->count,
+      sum->z / sum->count) :
+    lwpoint_make2d(srid, sum->x / sum->count, sum->y / sum->count);
   Datum result = PointerGetDatum(geo_serialize((LWGEOM *) point));
   lwpoint_free(point);
   return result;
@@ -385,53 +431,189 @@ doublen_to_point(TInstant *inst, int srid)
 /**
  * Final function for temporal centroid aggregation of temporal point values
  * with instant duration
- *
- * @param[in] instants Temporal values
- * @param[in] count Number of elements in the array
- * @param[in] srid SRID of the values
  */
-TInstantSet *
-tpointinst_tcentroid_finalfn(TInstant **instants, int count, int srid)
+static TInstantSet *
+tpointinst_tcentroid_finalfn(CentroidState *state)
 {
-  TInstant **newinstants = palloc(sizeof(TInstant *) * count);
-  for (int i = 0; i < count; i++)
+  centroidstate_compact(state);
+  TInstant **instants = palloc(sizeof(TInstant *) * state->pointcount);
+  for (int i = 0; i < state->pointcount; i++)
   {
-    TInstant *inst = instants[i];
-    Datum value = doublen_to_point(inst, srid);
-    newinstants[i] = tinstant_make(value, inst->t, type_oid(T_GEOMETRY));
+    CentroidPoint *point = &state->points[i];
+    Datum value = centroid_sum_point(point, state->srid, state->hasz);
+    instants[i] = tinstant_make(value, point->t, type_oid(T_GEOMETRY));
     pfree(DatumGetPointer(value));
   }
-  return tinstantset_make_free(newinstants, count);
+  return tinstantset_make_free(instants, state->pointcount);
+}
+
+/**
+ * Comparator function for the sequences of a centroid state with respect
+ * to the timestamp of their first point
+ */
+static int
+centroid_seq_cmp(const void *a, const void *b, void *arg)
+{
+  const CentroidPoint *points = (const CentroidPoint *) arg;
+  TimestampTz t1 = points[((const CentroidSeq *) a)->start].t;
+  TimestampTz t2 = points[((const CentroidSeq *) b)->start].t;
+  return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
+}
+
+/**
+ * Construct a sequence from the points in the arrays and free the points
+ */
+static TSequence *
+centroid_sequence_make(TimestampTz *times, Datum *values, int count,
+  bool lower_inc, bool upper_inc, const CentroidState *state)
+{
+  TSequence *result = tsequence_from_arrays(times, values, count,
+    type_oid(T_GEOMETRY), lower_inc, upper_inc, state->linear, NORMALIZE);
+  for (int i = 0; i < count; i++)
+    pfree(DatumGetPointer(values[i]));
+  return result;
 }
 
 /**
  * Final function for temporal centroid aggregation of temporal point values
  * with sequence duration
  *
- * @param[in] sequences Temporal values
- * @param[in] count Number of elements in the array
- * @param[in] srid SRID of the values
+ * The timestamps of all the points are swept in order. At each of them
+ * the function computes the sums of the values of the sequences defined
+ * just before the timestamp, at the timestamp, and just after the timestamp,
+ * interpolating the sequences that do not have a point at the timestamp.
+ * A result sequence continues through the timestamp if these values allow
+ * it, otherwise it is ended and a new one is started.
  */
-TSequenceSet *
-tpointseq_tcentroid_finalfn(TSequence **sequences, int count, int srid)
+static TSequenceSet *
+tpointseq_tcentroid_finalfn(CentroidState *state)
 {
-  TSequence **newsequences = palloc(sizeof(TSequence *) * count);
+  CentroidPoint *points = state->points;
+  CentroidSeq *seqs = state->sequences;
+  qsort_arg(seqs, (size_t) state->seqcount, sizeof(CentroidSeq),
+    &centroid_seq_cmp, points);
+  TimestampTz *times = palloc(sizeof(TimestampTz) * state->pointcount);
+  for (int i = 0; i < state->pointcount; i++)
+    times[i] = points[i].t;
+  timestamparr_sort(times, state->pointcount);
+  int count = timestamparr_remove_duplicates(times, state->pointcount);
+
+  /* Sequences defined at the current timestamp and their current point */
+  int *active = palloc(sizeof(int) * state->seqcount);
+  int *cursor = palloc(sizeof(int) * state->seqcount);
+  int nactive = 0, nextseq = 0;
+  /* At each timestamp at most one sequence is ended and at most one
+   * instantaneous sequence is constructed */
+  TSequence **sequences = palloc(sizeof(TSequence *) * 2 * count);
+  int k = 0;
+  /* Points of the sequence under construction */
+  TimestampTz *seqtimes = palloc(sizeof(TimestampTz) * count);
+  Datum *seqvalues = palloc(sizeof(Datum) * count);
+  int seqcount = 0;
+  bool lower_inc = true;
+  /* Sum just after the previous timestamp */
+  CentroidPoint prevafter;
+  memset(&prevafter, 0, sizeof(CentroidPoint));
   for (int i = 0; i < count; i++)
   {
-    TSequence *seq = sequences[i];
-    TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
-    for (int j = 0; j < seq->count; j++)
+    TimestampTz t = times[i];
+    while (nextseq < state->seqcount && points[seqs[nextseq].start].t == t)
+    {
+      active[nactive] = nextseq;
+      cursor[nactive++] = seqs[nextseq++].start;
+    }
+    CentroidPoint before, at, after;
+    memset(&before, 0, sizeof(CentroidPoint));
+    memset(&at, 0, sizeof(CentroidPoint));
+    memset(&after, 0, sizeof(CentroidPoint));
+    int n = 0;
+    for (int j = 0; j < nactive; j++)
+    {
+      const CentroidSeq *seq = &seqs[active[j]];
+      int last = seq->start + seq->count - 1;
+      while (cursor[j] < last && points[cursor[j] + 1].t <= t)
+        cursor[j]++;
+      const CentroidPoint *p1 = &points[cursor[j]];
+      TimestampTz lower = points[seq->start].t, upper = points[last].t;
+      double x = p1->x, y = p1->y, z = p1->z;
+      if (p1->t != t && state->linear)
+      {
+        const CentroidPoint *p2 = p1 + 1;
+        double ratio = (double) (t - p1->t) / (double) (p2->t - p1->t);
+        x += (p2->x - p1->x) * ratio;
+        y += (p2->y - p1->y) * ratio;
+        z += (p2->z - p1->z) * ratio;
+      }
+      if ((t > lower || seq->lower_inc) && (t < upper || seq->upper_inc))
+        centroid_sum_add(&at, x, y, z);
+      if (t > lower)
+      {
+        /* With step interpolation the value just before a point is the
+         * one of the previous point */
+        if (p1->t == t && ! state->linear)
+          centroid_sum_add(&before, (p1 - 1)->x, (p1 - 1)->y, (p1 - 1)->z);
+        else
+          centroid_sum_add(&before, x, y, z);
+      }
+      if (t < upper)
+      {
+        centroid_sum_add(&after, x, y, z);
+        /* Keep the sequence active */
+        active[n] = active[j];
+        cursor[n++] = cursor[j];
+      }
+    }
+    nactive = n;
+
+    /* The sequence under construction continues through the timestamp */
+    if (seqcount > 0 && at.count > 0 && after.count > 0 &&
+      centroid_sum_eq(&at, &after) &&
+      (! state->linear || centroid_sum_eq(&before, &at)))
+    {
+      seqtimes[seqcount] = t;
+      seqvalues[seqcount++] = centroid_sum_point(&at, state->srid,
+        state->hasz);
+      prevafter = after;
+      continue;
+    }
+    /* Otherwise end the sequence under construction at the timestamp */
+    bool done = false;
+    if (seqcount > 0)
+    {
+      bool upper_inc = at.count > 0 &&
+        (! state->linear || centroid_sum_eq(&before, &at));
+      const CentroidPoint *sum = upper_inc ? &at :
+        (state->linear ? &before : &prevafter);
+      seqtimes[seqcount] = t;
+      seqvalues[seqcount++] = centroid_sum_point(sum, state->srid,
+        state->hasz);
+      sequences[k++] = centroid_sequence_make(seqtimes, seqvalues, seqcount,
+        lower_inc, upper_inc, state);
+      seqcount = 0;
+      done = upper_inc;
+    }
+    /* Start a new sequence at the timestamp */
+    if (after.count > 0)
     {
-      TInstant *inst = tsequence_inst_n(seq, j);
-      Datum value = doublen_to_point(inst, srid);
-      instants[j] = tinstant_make(value, inst->t, type_oid(T_GEOMETRY));
-      pfree(DatumGetPointer(value));
+      lower_inc = ! done && at.count > 0 && centroid_sum_eq(&at, &after);
+      seqtimes[0] = t;
+      seqvalues[0] = centroid_sum_point(&after, state->srid, state->hasz);
+      seqcount = 1;
+      done |= lower_inc;
     }
-    newsequences[i] = tsequence_make_free(instants, seq->count,
-      seq->period.lower_inc, seq->period.upper_inc, 
-      MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
+    /* Instantaneous sequence for the value at the timestamp */
+    if (! done && at.count > 0)
+    {
+      Datum value = centroid_sum_point(&at, state->srid, state->hasz);
+      sequences[k++] = centroid_sequence_make(&t, &value, 1, true, true,
+        state);
+    }
+    prevafter = after;
   }
-  return tsequenceset_make_free(newsequences, count, NORMALIZE);
+  assert(seqcount == 0);
+  pfree(times); pfree(active); pfree(cursor);
+  pfree(seqtimes); pfree(seqvalues);
+  return tsequenceset_make_free(sequences, k, NORMALIZE);
 }
 
 PG_FUNCTION_INFO_V1(tpoint_tcentroid_finalfn);
@@ -442,25 +624,191 @@ PGDLLEXPORT Datum
 tpoint_tcentroid_finalfn(PG_FUNCTION_ARGS)
 {
   /* The final function is strict, we do not need to test for null values */
-  SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
-  if (state->length == 0)
+  CentroidState *state = (CentroidState *) PG_GETARG_POINTER(0);
+  if (state->pointcount == 0)
     PG_RETURN_NULL();
 
-  Temporal **values = skiplist_values(state);
-  int32_t srid = ((struct GeoAggregateState *) state->extra)->srid;
   Temporal *result = NULL;
-  assert(values[0]->duration == INSTANT ||
-    values[0]->duration == SEQUENCE);
-  if (values[0]->duration == INSTANT)
-    result = (Temporal *)tpointinst_tcentroid_finalfn(
-      (TInstant **)values, state->length, srid);
-  else if (values[0]->duration == SEQUENCE)
-    result = (Temporal *)tpointseq_tcentroid_finalfn(
-      (TSequence **)values, state->length, srid);
+  assert(state->duration == INSTANT || state->duration == SEQUENCE);
+  if (state->duration == INSTANT)
+    result = (Temporal *) tpointinst_tcentroid_finalfn(state);
+  else if (state->duration == SEQUENCE)
+    result = (Temporal *) tpointseq_tcentroid_finalfn(state);
+  if (! result)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
 
-  pfree(values);
+/*****************************************************************************/
 
+PG_FUNCTION_INFO_V1(tpoint_tcentroid_serialize);
+/**
+ * Serialize the state value of temporal centroid aggregation
+ */
+PGDLLEXPORT Datum
+tpoint_tcentroid_serialize(PG_FUNCTION_ARGS)
+{
+  CentroidState *state = (CentroidState *) PG_GETARG_POINTER(0);
+  if (state->duration == INSTANT)
+    centroidstate_compact(state);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->duration, 4);
+  pq_sendint(&buf, (uint32) state->srid, 4);
+  pq_sendint(&buf, (uint32) state->pointcount, 4);
+  pq_sendint(&buf, (uint32) state->seqcount, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->duration);
+  pq_sendint32(&buf, (uint32) state->srid);
+  pq_sendint32(&buf, (uint32) state->pointcount);
+  pq_sendint32(&buf, (uint32) state->seqcount);
+#endif
+  pq_sendbyte(&buf, state->linear ? 1 : 0);
+  pq_sendbyte(&buf, state->hasz ? 1 : 0);
+  for (int i = 0; i < state->pointcount; i++)
+  {
+    CentroidPoint *point = &state->points[i];
+    pq_sendint64(&buf, point->t);
+    pq_sendfloat8(&buf, point->x);
+    pq_sendfloat8(&buf, point->y);
+    pq_sendfloat8(&buf, point->z);
+#if MOBDB_PGSQL_VERSION < 110000
+    pq_sendint(&buf, (uint32) point->count, 4);
+#else
+    pq_sendint32(&buf, (uint32) point->count);
+#endif
+  }
+  for (int i = 0; i < state->seqcount; i++)
+  {
+    CentroidSeq *seq = &state->sequences[i];
+#if MOBDB_PGSQL_VERSION < 110000
+    pq_sendint(&buf, (uint32) seq->start, 4);
+    pq_sendint(&buf, (uint32) seq->count, 4);
+#else
+    pq_sendint32(&buf, (uint32) seq->start);
+    pq_sendint32(&buf, (uint32) seq->count);
+#endif
+    pq_sendbyte(&buf, seq->lower_inc ? 1 : 0);
+    pq_sendbyte(&buf, seq->upper_inc ? 1 : 0);
+  }
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tcentroid_deserialize);
+/**
+ * Deserialize the state value of temporal centroid aggregation
+ */
+PGDLLEXPORT Datum
+tpoint_tcentroid_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data),
+    .maxlen = VARSIZE(data)
+  };
+  TDuration duration = (TDuration) pq_getmsgint(&buf, 4);
+  int32 srid = (int32) pq_getmsgint(&buf, 4);
+  int pointcount = (int) pq_getmsgint(&buf, 4);
+  int seqcount = (int) pq_getmsgint(&buf, 4);
+  bool linear = pq_getmsgbyte(&buf) != 0;
+  bool hasz = pq_getmsgbyte(&buf) != 0;
+  CentroidState *result = centroidstate_make(fcinfo, duration, linear, srid,
+    hasz, pointcount, seqcount);
+  for (int i = 0; i < pointcount; i++)
+  {
+    CentroidPoint *point = &result->points[i];
+    point->t = (TimestampTz) pq_getmsgint64(&buf);
+    point->x = pq_getmsgfloat8(&buf);
+    point->y = pq_getmsgfloat8(&buf);
+    point->z = pq_getmsgfloat8(&buf);
+    point->count = (int32) pq_getmsgint(&buf, 4);
+  }
+  result->pointcount = pointcount;
+  for (int i = 0; i < seqcount; i++)
+  {
+    CentroidSeq *seq = &result->sequences[i];
+    seq->start = (int) pq_getmsgint(&buf, 4);
+    seq->count = (int) pq_getmsgint(&buf, 4);
+    seq->lower_inc = pq_getmsgbyte(&buf) != 0;
+    seq->upper_inc = pq_getmsgbyte(&buf) != 0;
+  }
+  result->seqcount = seqcount;
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Temporal count within a geometry
+ *****************************************************************************/
+
+/**
+ * Generic transition function for the temporal count of the temporal points
+ * within a geometry. The time during which a temporal point intersects the
+ * geometry is added to the state of the temporal count without restricting
+ * the temporal point to the geometry.
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] inverse True for the inverse transition function of a moving
+ * aggregate, which removes the value from the state
+ */
+static Datum
+tpoint_tcount_within_transfn1(FunctionCallInfo fcinfo, bool inverse)
+{
+  SweepState *state = PG_ARGISNULL(0) ? NULL :
+    (SweepState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(2);
+  if (! gserialized_is_empty(gs))
+  {
+    ensure_same_srid_tpoint_gs(temp, gs);
+    ensure_same_dimensionality_tpoint_gs(temp, gs);
+    PeriodSet *ps = tpoint_at_geometry_time_internal(temp,
+      PointerGetDatum(gs));
+    if (ps != NULL)
+    {
+      state = periodset_tcount_events(fcinfo, state, ps, temp->duration,
+        inverse);
+      pfree(ps);
+    }
+  }
+  PG_FREE_IF_COPY(temp, 1);
+  PG_FREE_IF_COPY(gs, 2);
+  if (state == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tcount_within_transfn);
+/**
+ * Transition function for the temporal count of the temporal points within
+ * a geometry
+ */
+PGDLLEXPORT Datum
+tpoint_tcount_within_transfn(PG_FUNCTION_ARGS)
+{
+  return tpoint_tcount_within_transfn1(fcinfo, false);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tcount_within_invfn);
+/**
+ * Inverse transition function for the temporal count of the temporal points
+ * within a geometry used as a moving aggregate
+ */
+PGDLLEXPORT Datum
+tpoint_tcount_within_invfn(PG_FUNCTION_ARGS)
+{
+  return tpoint_tcount_within_transfn1(fcinfo, true);
+}
+
 /*****************************************************************************/
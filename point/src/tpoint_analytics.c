@@ -32,6 +32,8 @@
 #include "tnumber_mathfuncs.h"
 #include "postgis.h"
 #include "geography_funcs.h"
+#include "temporal_aggfuncs.h"
+#include "temporal_tile.h"
 #include "tpoint.h"
 #include "tpoint_boxops.h"
 #include "tpoint_spatialrels.h"
@@ -42,6 +44,20 @@
  * The M coordinates encode the timestamps in number of seconds since '1970-01-01'
  *****************************************************************************/
 
+/**
+ * Returns the M coordinate encoding the timestamp in number of seconds since
+ * '1970-01-01'
+ */
+static double
+traj_epoch(TimestampTz t)
+{
+  /* The internal representation of timestamps in PostgreSQL is in
+   * microseconds since '2000-01-01'. Therefore we need to compute
+   * select date_part('epoch', timestamp '2000-01-01' - timestamp '1970-01-01')
+   * which results in 946684800 */
+  return ((double) t / 1e6) + 946684800;
+}
+
 /**
  * Converts the point and the timestamp into a PostGIS geometry/geography
  * point where the M coordinate encodes the timestamp in number of seconds
@@ -52,11 +68,7 @@ point_to_trajpoint(Datum point, TimestampTz t)
 {
   GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(point);
   int32 srid = gserialized_get_srid(gs);
-  /* The internal representation of timestamps in PostgreSQL is in
-   * microseconds since '2000-01-01'. Therefore we need to compute
-   * select date_part('epoch', timestamp '2000-01-01' - timestamp '1970-01-01')
-   * which results in 946684800 */
-  double epoch = ((double) t / 1e6) + 946684800;
+  double epoch = traj_epoch(t);
   LWPOINT *result;
   if (FLAGS_GET_Z(gs->flags))
   {
@@ -72,6 +84,167 @@ point_to_trajpoint(Datum point, TimestampTz t)
   return result;
 }
 
+/**
+ * Sets the 4D point from the coordinates of the point and the M value,
+ * where the Z coordinate is set to 0 for 2D points
+ */
+static void
+point_set_point4d(POINT4D *result, Datum point, double m)
+{
+  GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(point);
+  if (FLAGS_GET_Z(gs->flags))
+  {
+    const POINT3DZ *p = gs_get_point3dz_p(gs);
+    result->x = p->x; result->y = p->y; result->z = p->z;
+  }
+  else
+  {
+    const POINT2D *p = gs_get_point2d_p(gs);
+    result->x = p->x; result->y = p->y; result->z = 0;
+  }
+  result->m = m;
+  return;
+}
+
+/**
+ * Returns the size of the bounding box of a serialized geometry/geography
+ * with the flags, which is a pair of floats for each dimension of
+ * geometries and for the three geocentric dimensions of geographies
+ */
+static size_t
+gs_box_size(uint8_t flags)
+{
+  if (! FLAGS_GET_BBOX(flags))
+    return 0;
+  if (FLAGS_GET_GEODETIC(flags))
+    return 6 * sizeof(float);
+  return 2 * (2 + FLAGS_GET_Z(flags) + FLAGS_GET_M(flags)) * sizeof(float);
+}
+
+/**
+ * Returns the serialized Linestring M of the temporal sequence point, where
+ * the M coordinates are either the timestamps in number of seconds since
+ * '1970-01-01' or the values of a temporal float. The point array is written
+ * directly from the instants in the layout of gserialized_from_lwgeom, that
+ * is, the header, the bounding box, the type, the number of points, and the
+ * coordinates, without constructing intermediate LWGEOM values. The geocentric
+ * bounding box of geographies is not written, PostGIS computes it on demand.
+ *
+ * Two consecutive equal points are written only once, which only happens for
+ * a measure since the timestamps are increasing.
+ *
+ * @param[in] seq Temporal point
+ * @param[in] measure Temporal float, NULL for the timestamps
+ * @return NULL if all the points are equal
+ * @pre The temporal point has linear interpolation and at least two instants,
+ * and the measure, if any, is synchronized with the temporal point
+ */
+static GSERIALIZED *
+tpointseq_to_line_gs(const TSequence *seq, const TSequence *measure)
+{
+  TInstant *inst = tsequence_inst_n(seq, 0);
+  int32 srid = gserialized_get_srid(
+    (GSERIALIZED *) DatumGetPointer(tinstant_value(inst)));
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  bool geodetic = MOBDB_FLAGS_GET_GEODETIC(seq->flags);
+  uint8_t flags = 0;
+  FLAGS_SET_Z(flags, hasz);
+  FLAGS_SET_M(flags, true);
+  FLAGS_SET_BBOX(flags, ! geodetic);
+  FLAGS_SET_GEODETIC(flags, geodetic);
+  int ndims = hasz ? 4 : 3;
+  size_t boxsize = gs_box_size(flags);
+  /* Header, bounding box, type and number of points, and coordinates */
+  size_t size = 8 + boxsize + 8 + sizeof(double) * ndims * seq->count;
+  GSERIALIZED *result = palloc0(size);
+  double *coords = (double *) ((uint8_t *) result->data + boxsize + 8);
+  double min[4], max[4];
+  int k = 0;
+  for (int i = 0; i < seq->count; i++)
+  {
+    inst = tsequence_inst_n(seq, i);
+    POINT4D p;
+    point_set_point4d(&p, tinstant_value(inst), measure ?
+      DatumGetFloat8(tinstant_value(tsequence_inst_n(measure, i))) :
+      traj_epoch(inst->t));
+    double *pt = &coords[k * ndims];
+    pt[0] = p.x; pt[1] = p.y;
+    if (hasz)
+    {
+      pt[2] = p.z; pt[3] = p.m;
+    }
+    else
+      pt[2] = p.m;
+    if (k == 0)
+    {
+      for (int j = 0; j < ndims; j++)
+        min[j] = max[j] = pt[j];
+      k++;
+      continue;
+    }
+    /* Add point only if previous point is different from the current one */
+    const double *prev = &coords[(k - 1) * ndims];
+    bool same = true;
+    for (int j = 0; j < ndims; j++)
+    {
+      if (pt[j] != prev[j])
+        same = false;
+      min[j] = Min(min[j], pt[j]);
+      max[j] = Max(max[j], pt[j]);
+    }
+    if (! same)
+      k++;
+  }
+  if (k == 1)
+  {
+    pfree(result);
+    return NULL;
+  }
+
+  gserialized_set_srid(result, srid);
+  result->flags = flags;
+  if (boxsize > 0)
+  {
+    float *box = (float *) result->data;
+    for (int j = 0; j < ndims; j++)
+    {
+      box[2 * j] = next_float_down(min[j]);
+      box[2 * j + 1] = next_float_up(max[j]);
+    }
+  }
+  uint32_t *header = (uint32_t *) ((uint8_t *) result->data + boxsize);
+  header[0] = LINETYPE;
+  header[1] = (uint32_t) k;
+  SET_VARSIZE(result, 8 + boxsize + 8 + sizeof(double) * ndims * k);
+  return result;
+}
+
+/**
+ * Returns the point array of the instants of the temporal sequence point,
+ * where the M coordinates are either the timestamps in number of seconds
+ * since '1970-01-01' or the values of a temporal float. Two consecutive
+ * equal points are added only once.
+ *
+ * @param[in] seq Temporal point
+ * @param[in] measure Temporal float, NULL for the timestamps
+ */
+static POINTARRAY *
+tpointseq_to_ptarray(const TSequence *seq, const TSequence *measure)
+{
+  POINTARRAY *result = ptarray_construct_empty(
+    (char) MOBDB_FLAGS_GET_Z(seq->flags), true, (uint32_t) seq->count);
+  for (int i = 0; i < seq->count; i++)
+  {
+    TInstant *inst = tsequence_inst_n(seq, i);
+    POINT4D p;
+    point_set_point4d(&p, tinstant_value(inst), measure ?
+      DatumGetFloat8(tinstant_value(tsequence_inst_n(measure, i))) :
+      traj_epoch(inst->t));
+    ptarray_append_point(result, &p, LW_FALSE);
+  }
+  return result;
+}
+
 /**
  * Converts the temporal instant point into a PostGIS trajectory
  * geometry/geography where the M coordinates encode the timestamps in
@@ -128,30 +301,34 @@ tpointinstset_to_geo(const TInstantSet *ti)
 static LWGEOM *
 tpointseq_to_geo1(const TSequence *seq)
 {
-  LWGEOM **points = palloc(sizeof(LWGEOM *) * seq->count);
-  for (int i = 0; i < seq->count; i++)
+  /* Instantaneous sequence */
+  if (seq->count == 1)
   {
-    TInstant *inst = tsequence_inst_n(seq, i);
-    points[i] = (LWGEOM *) point_to_trajpoint(tinstant_value(inst), inst->t);
+    TInstant *inst = tsequence_inst_n(seq, 0);
+    return (LWGEOM *) point_to_trajpoint(tinstant_value(inst), inst->t);
   }
+
+  TInstant *inst = tsequence_inst_n(seq, 0);
+  GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(tinstant_value(inst));
+  int32 srid = gserialized_get_srid(gs);
   LWGEOM *result;
-  /* Instantaneous sequence */
-  if (seq->count == 1)
+  if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
   {
-    result = points[0];
-    pfree(points);
+    /* The point array is filled directly from the instants */
+    result = (LWGEOM *) lwline_construct(srid, NULL,
+      tpointseq_to_ptarray(seq, NULL));
+    FLAGS_SET_GEODETIC(result->flags, FLAGS_GET_GEODETIC(gs->flags));
   }
   else
   {
-    if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
-      result = (LWGEOM *) lwline_from_lwgeom_array(points[0]->srid,
-        (uint32_t) seq->count, points);
-    else
-      result = (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE,
-        points[0]->srid, NULL, (uint32_t) seq->count, points);
+    LWGEOM **points = palloc(sizeof(LWGEOM *) * seq->count);
     for (int i = 0; i < seq->count; i++)
-      lwpoint_free((LWPOINT *) points[i]);
-    pfree(points);
+    {
+      inst = tsequence_inst_n(seq, i);
+      points[i] = (LWGEOM *) point_to_trajpoint(tinstant_value(inst), inst->t);
+    }
+    result = (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE, srid, NULL,
+      (uint32_t) seq->count, points);
   }
   return result;
 }
@@ -164,8 +341,12 @@ tpointseq_to_geo1(const TSequence *seq)
 static Datum
 tpointseq_to_geo(const TSequence *seq)
 {
+  /* Write the linestring directly from the instants */
+  if (seq->count > 1 && MOBDB_FLAGS_GET_LINEAR(seq->flags))
+    return PointerGetDatum(tpointseq_to_line_gs(seq, NULL));
   LWGEOM *lwgeom = tpointseq_to_geo1(seq);
   GSERIALIZED *result = geo_serialize(lwgeom);
+  lwgeom_free(lwgeom);
   return PointerGetDatum(result);
 }
 
@@ -226,7 +407,6 @@ static int
 tpointseq_to_geo_segmentize1(LWGEOM **result, const TSequence *seq)
 {
   TInstant *inst = tsequence_inst_n(seq, 0);
-  LWPOINT *points[2];
 
   /* Instantaneous sequence */
   if (seq->count == 1)
@@ -235,15 +415,21 @@ tpointseq_to_geo_segmentize1(LWGEOM **result, const TSequence *seq)
     return 1;
   }
 
-  /* General case */
+  /* General case, the end point of a segment is the start of the next one */
+  int32 srid = gserialized_get_srid(
+    (GSERIALIZED *) DatumGetPointer(tinstant_value(inst)));
+  char hasz = (char) MOBDB_FLAGS_GET_Z(seq->flags);
+  POINT4D p1, p2;
+  point_set_point4d(&p1, tinstant_value(inst), traj_epoch(inst->t));
   for (int i = 0; i < seq->count - 1; i++)
   {
-    points[0] = point_to_trajpoint(tinstant_value(inst), inst->t);
     inst = tsequence_inst_n(seq, i + 1);
-    points[1] = point_to_trajpoint(tinstant_value(inst), inst->t);
-    result[i] = (LWGEOM *) lwline_from_lwgeom_array(points[0]->srid, 2,
-      (LWGEOM **) points);
-    lwpoint_free(points[0]); lwpoint_free(points[1]);
+    point_set_point4d(&p2, tinstant_value(inst), traj_epoch(inst->t));
+    POINTARRAY *pa = ptarray_construct(hasz, true, 2);
+    ptarray_set_point4d(pa, 0, &p1);
+    ptarray_set_point4d(pa, 1, &p2);
+    result[i] = (LWGEOM *) lwline_construct(srid, NULL, pa);
+    p1 = p2;
   }
   return seq->count - 1;
 }
@@ -463,10 +649,15 @@ static TSequence *
 geo_to_tpointseq(GSERIALIZED *gs)
 {
   /* Geometry is a LINESTRING */
-  bool hasz =(bool)  FLAGS_GET_Z(gs->flags);
-  LWGEOM *lwgeom = lwgeom_from_gserialized(gs);
-  LWLINE *lwline = lwgeom_as_lwline(lwgeom);
-  int npoints = lwline->points->npoints;
+  bool hasz = (bool) FLAGS_GET_Z(gs->flags);
+  bool geodetic = (bool) FLAGS_GET_GEODETIC(gs->flags);
+  int ndims = hasz ? 4 : 3;
+  /* The type and the number of points follow the bounding box, if any,
+   * and they are followed by the coordinates */
+  const uint32_t *header = (const uint32_t *) ((uint8_t *) gs->data +
+    gs_box_size(gs->flags));
+  int npoints = (int) header[1];
+  const double *coords = (const double *) (header + 2);
   /*
    * Verify that the trajectory is valid.
    * Since calling lwgeom_is_trajectory causes discrepancies with regression
@@ -476,33 +667,40 @@ geo_to_tpointseq(GSERIALIZED *gs)
   double m1 = -1 * DBL_MAX, m2;
   for (int i = 0; i < npoints; i++)
   {
-    if (hasz)
-    {
-      POINT4D point = getPoint4d(lwline->points, (uint32_t) i);
-      m2 = point.m;
-    }
-    else
-    {
-      POINT3DM point = getPoint3dm(lwline->points, (uint32_t) i);
-      m2 = point.m;
-    }
+    m2 = coords[i * ndims + ndims - 1];
     if (m1 >= m2)
-    {
-      lwgeom_free(lwgeom);
       ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
         errmsg("Trajectory must be valid")));
-    }
     m1 = m2;
   }
+
+  /* Points have no bounding box and thus the coordinates of each instant
+   * are written into a copy of the same serialized point */
+  int32 srid = gserialized_get_srid(gs);
+  LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, 0, 0, 0) :
+    lwpoint_make2d(srid, 0, 0);
+  FLAGS_SET_GEODETIC(lwpoint->flags, geodetic);
+  GSERIALIZED *point = geo_serialize((LWGEOM *) lwpoint);
+  lwpoint_free(lwpoint);
+  Oid valuetypid = geodetic ? type_oid(T_GEOGRAPHY) : type_oid(T_GEOMETRY);
   TInstant **instants = palloc(sizeof(TInstant *) * npoints);
   for (int i = 0; i < npoints; i++)
   {
-    /* Returns freshly allocated LWPOINT */
-    LWPOINT *lwpoint = lwline_get_lwpoint(lwline, (uint32_t) i);
-    instants[i] = trajpoint_to_tpointinst(lwpoint);
-    lwpoint_free(lwpoint);
+    const double *p = &coords[i * ndims];
+    TimestampTz t = (long) ((p[ndims - 1] - 946684800) * 1e6);
+    if (hasz)
+    {
+      POINT3DZ *pt = (POINT3DZ *) gs_get_point3dz_p(point);
+      pt->x = p[0]; pt->y = p[1]; pt->z = p[2];
+    }
+    else
+    {
+      POINT2D *pt = (POINT2D *) gs_get_point2d_p(point);
+      pt->x = p[0]; pt->y = p[1];
+    }
+    instants[i] = tinstant_make(PointerGetDatum(point), t, valuetypid);
   }
-  lwgeom_free(lwgeom);
+  pfree(point);
   /* The resulting sequence assumes linear interpolation */
   return tsequence_make_free(instants, npoints, true, true,
     LINEAR, NORMALIZE);
@@ -673,10 +871,33 @@ tpointinstset_to_geo_measure(const TInstantSet *ti, const TInstantSet *measure)
 static LWGEOM *
 tpointseq_to_geo_measure1(const TSequence *seq, const TSequence *measure)
 {
-  LWPOINT **points = palloc(sizeof(LWPOINT *) * seq->count);
-  /* Remove two consecutive points if they are equal */
   TInstant *inst = tsequence_inst_n(seq, 0);
   TInstant *m = tsequence_inst_n(measure, 0);
+  /* Instantaneous sequence */
+  if (seq->count == 1)
+    return (LWGEOM *) point_measure_to_geo_measure(tinstant_value(inst),
+      tinstant_value(m));
+
+  GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(tinstant_value(inst));
+  int32 srid = gserialized_get_srid(gs);
+  LWGEOM *result;
+  if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
+  {
+    /* The point array is filled directly from the instants, removing two
+     * consecutive points if they are equal */
+    POINTARRAY *pa = tpointseq_to_ptarray(seq, measure);
+    if (pa->npoints == 1)
+    {
+      result = (LWGEOM *) lwpoint_construct(srid, NULL, pa);
+      FLAGS_SET_GEODETIC(result->flags, FLAGS_GET_GEODETIC(gs->flags));
+    }
+    else
+      result = (LWGEOM *) lwline_construct(srid, NULL, pa);
+    return result;
+  }
+
+  LWPOINT **points = palloc(sizeof(LWPOINT *) * seq->count);
+  /* Remove two consecutive points if they are equal */
   LWPOINT *value1 = point_measure_to_geo_measure(tinstant_value(inst),
     tinstant_value(m));
   points[0] = value1;
@@ -690,25 +911,18 @@ tpointseq_to_geo_measure1(const TSequence *seq, const TSequence *measure)
     /* Add point only if previous point is diffrent from the current one */
     if (lwpoint_same(value1, value2) != LW_TRUE)
       points[k++] = value2;
-    value1 = value2;
+    else
+      lwpoint_free(value2);
+    value1 = points[k - 1];
   }
-  LWGEOM *result;
   if (k == 1)
   {
     result = (LWGEOM *) points[0];
     pfree(points);
   }
   else
-  {
-    result = MOBDB_FLAGS_GET_LINEAR(seq->flags) ?
-      (LWGEOM *) lwline_from_lwgeom_array(points[0]->srid, (uint32_t) k,
-        (LWGEOM **) points) :
-      (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE,
-        points[0]->srid, NULL, (uint32_t) k, (LWGEOM **) points);
-    for (int i = 0; i < k; i++)
-      lwpoint_free(points[i]);
-    pfree(points);
-  }
+    result = (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE, srid, NULL,
+      (uint32_t) k, (LWGEOM **) points);
   return result;
 }
 
@@ -722,8 +936,16 @@ tpointseq_to_geo_measure1(const TSequence *seq, const TSequence *measure)
 static Datum
 tpointseq_to_geo_measure(const TSequence *seq, const TSequence *measure)
 {
+  /* Write the linestring directly from the instants */
+  if (seq->count > 1 && MOBDB_FLAGS_GET_LINEAR(seq->flags))
+  {
+    GSERIALIZED *gs = tpointseq_to_line_gs(seq, measure);
+    if (gs != NULL)
+      return PointerGetDatum(gs);
+  }
   LWGEOM *lwgeom = tpointseq_to_geo_measure1(seq, measure);
   GSERIALIZED *result = geo_serialize(lwgeom);
+  lwgeom_free(lwgeom);
   return PointerGetDatum(result);
 }
 
@@ -791,7 +1013,6 @@ tpointseq_to_geo_measure_segmentize1(LWGEOM **result, const TSequence *seq,
 {
   TInstant *inst = tsequence_inst_n(seq, 0);
   TInstant *m = tsequence_inst_n(measure, 0);
-  LWPOINT *points[2];
 
   /* Instantaneous sequence */
   if (seq->count == 1)
@@ -801,17 +1022,21 @@ tpointseq_to_geo_measure_segmentize1(LWGEOM **result, const TSequence *seq,
     return 1;
   }
 
-  /* General case */
+  /* General case, both points of a segment take the measure of its start */
+  int32 srid = gserialized_get_srid(
+    (GSERIALIZED *) DatumGetPointer(tinstant_value(inst)));
+  char hasz = (char) MOBDB_FLAGS_GET_Z(seq->flags);
+  POINT4D p1, p2;
   for (int i = 0; i < seq->count - 1; i++)
   {
-    points[0] = point_measure_to_geo_measure(tinstant_value(inst),
-      tinstant_value(m));
+    double d = DatumGetFloat8(tinstant_value(m));
+    point_set_point4d(&p1, tinstant_value(inst), d);
     inst = tsequence_inst_n(seq, i + 1);
-    points[1] = point_measure_to_geo_measure(tinstant_value(inst),
-      tinstant_value(m));
-    result[i] = (LWGEOM *) lwline_from_lwgeom_array(points[0]->srid, 2,
-      (LWGEOM **) points);
-    lwpoint_free(points[0]); lwpoint_free(points[1]);
+    point_set_point4d(&p2, tinstant_value(inst), d);
+    POINTARRAY *pa = ptarray_construct(hasz, true, 2);
+    ptarray_set_point4d(pa, 0, &p1);
+    ptarray_set_point4d(pa, 1, &p2);
+    result[i] = (LWGEOM *) lwline_construct(srid, NULL, pa);
     m = tsequence_inst_n(measure, i + 1);
   }
   return seq->count - 1;
@@ -1310,12 +1535,82 @@ dist4d_pt_seg(POINT4D *p, POINT4D *A, POINT4D *B)
   return dist4d_pt_pt(p, &c);
 }
 
+/**
+ * Structure to represent the coordinates and the speeds of the instants of
+ * a temporal sequence point, which are extracted once before the
+ * simplification instead of at each iteration of the algorithm
+ */
+typedef struct
+{
+  const TSequence *seq;  /**< Temporal sequence */
+  bool hasz;             /**< True when the points have Z coordinates */
+  POINT2D *points2d;     /**< Points if they do not have Z */
+  POINT3DZ *points3d;    /**< Points if they have Z */
+  double *speeds;        /**< Speed of the segments ending at each instant,
+                              NULL if the speed is not considered */
+} tpointseq_dp_state;
+
+/**
+ * Extracts the coordinates and, if needed, the speeds of the instants of
+ * the temporal sequence point
+ */
+static void
+tpointseq_dp_state_init(tpointseq_dp_state *state, const TSequence *seq,
+  bool withspeed)
+{
+  state->seq = seq;
+  state->hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  state->points2d = NULL;
+  state->points3d = NULL;
+  state->speeds = NULL;
+  if (state->hasz)
+  {
+    state->points3d = palloc(sizeof(POINT3DZ) * seq->count);
+    for (int i = 0; i < seq->count; i++)
+      state->points3d[i] = datum_get_point3dz(tinstant_value(
+        tsequence_inst_n(seq, i)));
+  }
+  else
+  {
+    state->points2d = palloc(sizeof(POINT2D) * seq->count);
+    for (int i = 0; i < seq->count; i++)
+      state->points2d[i] = datum_get_point2d(tinstant_value(
+        tsequence_inst_n(seq, i)));
+  }
+  if (withspeed)
+  {
+    Datum (*func)(Datum, Datum) = state->hasz ? &pt_distance3d :
+      &pt_distance2d;
+    state->speeds = palloc(sizeof(double) * seq->count);
+    state->speeds[0] = 0;
+    for (int i = 1; i < seq->count; i++)
+      state->speeds[i] = tpointinst_speed(tsequence_inst_n(seq, i - 1),
+        tsequence_inst_n(seq, i), func);
+  }
+  return;
+}
+
+/**
+ * Frees the coordinates and the speeds extracted for the simplification
+ */
+static void
+tpointseq_dp_state_free(tpointseq_dp_state *state)
+{
+  if (state->points2d)
+    pfree(state->points2d);
+  if (state->points3d)
+    pfree(state->points3d);
+  if (state->speeds)
+    pfree(state->speeds);
+  return;
+}
+
 /**
  * Finds a split when simplifying the temporal sequence point using a
  * spatio-temporal extension of the Douglas-Peucker line simplification
  * algorithm.
  *
- * @param[in] seq Temporal sequence
+ * @param[in] state Coordinates and speeds of the temporal sequence
  * @param[in] i1,i2 Indexes of the reference instants
  * @param[in] withspeed True when the delta in the speed must be considered
  * @param[out] split Location of the split
@@ -1323,30 +1618,29 @@ dist4d_pt_seg(POINT4D *p, POINT4D *A, POINT4D *B)
  * @param[out] delta_speed Delta speed at the split
  */
 static void
-tpointseq_dp_findsplit(const TSequence *seq, int i1, int i2, bool withspeed,
-  int *split, double *dist, double *delta_speed)
+tpointseq_dp_findsplit(const tpointseq_dp_state *state, int i1, int i2,
+  bool withspeed, int *split, double *dist, double *delta_speed)
 {
-  POINT2D p2k, p2k_tmp, p2a, p2b;
-  POINT3DZ p3k, p3k_tmp, p3a, p3b;
+  POINT2D p2k, p2a, p2b;
+  POINT3DZ p3k, p3a, p3b;
   POINT4D p4k, p4a, p4b;
   double d;
-  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  bool hasz = state->hasz;
   *split = i1;
   d = -1;
   if (i1 + 1 < i2)
   {
     double speed_seg;
-    Datum (*func)(Datum, Datum);
     if (withspeed)
-      func = hasz ? &pt_distance3d : &pt_distance2d;
-    TInstant *inst1 = tsequence_inst_n(seq, i1);
-    TInstant *inst2 = tsequence_inst_n(seq, i2);
-    if (withspeed)
-      speed_seg = tpointinst_speed(inst1, inst2, func);
+    {
+      Datum (*func)(Datum, Datum) = hasz ? &pt_distance3d : &pt_distance2d;
+      speed_seg = tpointinst_speed(tsequence_inst_n(state->seq, i1),
+        tsequence_inst_n(state->seq, i2), func);
+    }
     if (hasz)
     {
-      p3a = datum_get_point3dz(tinstant_value(inst1));
-      p3b = datum_get_point3dz(tinstant_value(inst2));
+      p3a = state->points3d[i1];
+      p3b = state->points3d[i2];
       if (withspeed)
       {
         p4a.x = p3a.x; p4a.y = p3a.y;
@@ -1357,8 +1651,8 @@ tpointseq_dp_findsplit(const TSequence *seq, int i1, int i2, bool withspeed,
     }
     else
     {
-      p2a = datum_get_point2d(tinstant_value(inst1));
-      p2b = datum_get_point2d(tinstant_value(inst2));
+      p2a = state->points2d[i1];
+      p2b = state->points2d[i2];
       if (withspeed)
       {
         p3a.x = p2a.x; p3a.y = p2a.y; p3a.z = speed_seg;
@@ -1368,48 +1662,51 @@ tpointseq_dp_findsplit(const TSequence *seq, int i1, int i2, bool withspeed,
     for (int k = i1 + 1; k < i2; k++)
     {
       double d_tmp, speed_pt;
-      inst2 = tsequence_inst_n(seq, k);
+      /* The speed of the segment ending at the instant k */
       if (withspeed)
-        speed_pt = tpointinst_speed(inst1, inst2, func);
+        speed_pt = state->speeds[k];
       if (hasz)
       {
-        p3k_tmp = datum_get_point3dz(tinstant_value(inst2));
+        POINT3DZ *p3k_tmp = &state->points3d[k];
         if (withspeed)
         {
-          p4k.x = p3k_tmp.x; p4k.y = p3k_tmp.y;
-          p4k.z = p3k_tmp.z; p4k.m = speed_pt;
+          p4k.x = p3k_tmp->x; p4k.y = p3k_tmp->y;
+          p4k.z = p3k_tmp->z; p4k.m = speed_pt;
           d_tmp = dist4d_pt_seg(&p4k, &p4a, &p4b);
         }
         else
-          d_tmp = dist3d_pt_seg(&p3k_tmp, &p3a, &p3b);
+          d_tmp = dist3d_pt_seg(p3k_tmp, &p3a, &p3b);
       }
       else
       {
-        p2k_tmp = datum_get_point2d(tinstant_value(inst2));
+        POINT2D *p2k_tmp = &state->points2d[k];
         if (withspeed)
         {
-          p3k.x = p2k_tmp.x; p3k.y = p2k_tmp.y; p3k.z = speed_pt;
+          p3k.x = p2k_tmp->x; p3k.y = p2k_tmp->y; p3k.z = speed_pt;
           d_tmp = dist3d_pt_seg(&p3k, &p3a, &p3b);
         }
         else
-          d_tmp = dist2d_pt_seg(&p2k_tmp, &p2a, &p2b);
+          d_tmp = dist2d_pt_seg(p2k_tmp, &p2a, &p2b);
       }
       if (d_tmp > d)
       {
         /* record the maximum */
         d = d_tmp;
-        if (hasz)
-          p3k = p3k_tmp;
-        else
-          p2k = p2k_tmp;
         if (withspeed)
           *delta_speed = fabs(speed_seg - speed_pt);
         *split = k;
       }
-      inst1 = inst2;
     }
-    *dist = hasz ? dist3d_pt_seg(&p3k, &p3a, &p3b) :
-      distance2d_pt_seg(&p2k, &p2a, &p2b);
+    if (hasz)
+    {
+      p3k = state->points3d[*split];
+      *dist = dist3d_pt_seg(&p3k, &p3a, &p3b);
+    }
+    else
+    {
+      p2k = state->points2d[*split];
+      *dist = distance2d_pt_seg(&p2k, &p2a, &p2b);
+    }
   }
   else
     *dist = -1;
@@ -1440,11 +1737,15 @@ tpointseq_simplify(const TSequence *seq, double eps_dist,
   uint32_t i;
   double dist, delta_speed;
   bool withspeed = eps_speed > 0;
+  tpointseq_dp_state state;
 
   /* Do not try to simplify really short things */
   if (seq->count < 3)
     return tsequence_copy(seq);
 
+  /* Extract the coordinates and the speeds once */
+  tpointseq_dp_state_init(&state, seq, withspeed);
+
   /* Only heap allocate book-keeping arrays if necessary */
   if ((unsigned int) seq->count > stack_size)
   {
@@ -1463,7 +1764,8 @@ tpointseq_simplify(const TSequence *seq, double eps_dist,
   outlist[outn++] = 0;
   do
   {
-    tpointseq_dp_findsplit(seq, p1, stack[sp], withspeed, &split, &dist, &delta_speed);
+    tpointseq_dp_findsplit(&state, p1, stack[sp], withspeed, &split, &dist,
+      &delta_speed);
     bool dosplit;
     if (withspeed)
       dosplit = (dist >= 0 &&
@@ -1497,6 +1799,7 @@ tpointseq_simplify(const TSequence *seq, double eps_dist,
     pfree(stack);
   if (outlist != outlist_static)
     pfree(outlist);
+  tpointseq_dp_state_free(&state);
 
   return result;
 }
@@ -1560,3 +1863,848 @@ tpoint_simplify(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Multi-resolution pyramid of simplifications of a temporal point
+ *****************************************************************************/
+
+/**
+ * Returns the significance of each instant of the temporal sequence point,
+ * that is, the largest tolerance for which the instant is kept by the
+ * Douglas-Peucker simplification. The algorithm is run once without
+ * tolerance and the significance of an instant is the distance at its
+ * split, bounded by the significance of the split that created its range,
+ * since the range is not split further when its parent is not split.
+ * The first and last instants are always kept.
+ */
+static double *
+tpointseq_dp_significance(const TSequence *seq)
+{
+  double *result = palloc(sizeof(double) * seq->count);
+  result[0] = result[seq->count - 1] = DBL_MAX;
+  if (seq->count < 3)
+    return result;
+
+  tpointseq_dp_state state;
+  tpointseq_dp_state_init(&state, seq, false);
+  /* Each range of the stack is stored as its two indexes */
+  int *stack = palloc(sizeof(int) * 2 * seq->count);
+  int sp = 0;
+  stack[sp++] = 0;
+  stack[sp++] = seq->count - 1;
+  while (sp > 0)
+  {
+    int i2 = stack[--sp];
+    int i1 = stack[--sp];
+    int split;
+    double dist, delta_speed;
+    tpointseq_dp_findsplit(&state, i1, i2, false, &split, &dist,
+      &delta_speed);
+    if (dist < 0)
+      continue;
+    /* The significance of the reference instants bounds the one of the
+     * split, the first one being DBL_MAX at the start of the sequence */
+    result[split] = Min(dist, Min(result[i1], result[i2]));
+    stack[sp++] = i1;
+    stack[sp++] = split;
+    stack[sp++] = split;
+    stack[sp++] = i2;
+  }
+  pfree(stack);
+  tpointseq_dp_state_free(&state);
+  return result;
+}
+
+/**
+ * Returns the simplification of the temporal sequence point that keeps
+ * the instants whose significance is greater than the tolerance
+ */
+static TSequence *
+tpointseq_simplify_level(const TSequence *seq, const double *significance,
+  double eps_dist)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  int count = 0;
+  for (int i = 0; i < seq->count; i++)
+  {
+    if (significance[i] > eps_dist)
+      instants[count++] = tsequence_inst_n(seq, i);
+  }
+  TSequence *result = tsequence_make(instants, count,
+    seq->period.lower_inc, seq->period.upper_inc,
+    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
+  pfree(instants);
+  return result;
+}
+
+/**
+ * Returns the simplifications of the temporal point for each of the
+ * tolerances. The Douglas-Peucker algorithm is run once for each sequence
+ * and the levels are extracted from the significance of its instants.
+ *
+ * @param[in] temp Temporal point
+ * @param[in] eps_dist Tolerances
+ * @param[in] count Number of tolerances
+ */
+static Temporal **
+tpoint_simplify_pyramid_internal(const Temporal *temp, const double *eps_dist,
+  int count)
+{
+  Temporal **result = palloc(sizeof(Temporal *) * count);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT || temp->duration == INSTANTSET ||
+    ! MOBDB_FLAGS_GET_LINEAR(temp->flags))
+  {
+    for (int i = 0; i < count; i++)
+      result[i] = temporal_copy(temp);
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    double *significance = tpointseq_dp_significance(seq);
+    for (int i = 0; i < count; i++)
+      result[i] = (Temporal *) tpointseq_simplify_level(seq, significance,
+        eps_dist[i]);
+    pfree(significance);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    TSequence ***sequences = palloc(sizeof(TSequence **) * count);
+    for (int i = 0; i < count; i++)
+      sequences[i] = palloc(sizeof(TSequence *) * ts->count);
+    for (int j = 0; j < ts->count; j++)
+    {
+      const TSequence *seq = tsequenceset_seq_n(ts, j);
+      double *significance = tpointseq_dp_significance(seq);
+      for (int i = 0; i < count; i++)
+        sequences[i][j] = tpointseq_simplify_level(seq, significance,
+          eps_dist[i]);
+      pfree(significance);
+    }
+    for (int i = 0; i < count; i++)
+      result[i] = (Temporal *) tsequenceset_make_free(sequences[i],
+        ts->count, NORMALIZE);
+    pfree(sequences);
+  }
+  return result;
+}
+
+/**
+ * Extracts the tolerances of a pyramid, which must be positive or zero and
+ * given in increasing order
+ */
+static double *
+pyramid_tolerances_extract(ArrayType *array, int *count)
+{
+  ensure_non_empty_array(array);
+  Datum *values = datumarr_extract(array, count);
+  double *result = palloc(sizeof(double) * *count);
+  for (int i = 0; i < *count; i++)
+  {
+    result[i] = DatumGetFloat8(values[i]);
+    if (result[i] < 0 || (i > 0 && result[i] <= result[i - 1]))
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The tolerances must be positive or zero and increasing")));
+  }
+  pfree(values);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_simplify_pyramid);
+/**
+ * Returns an array with the simplifications of the temporal point for each
+ * of the tolerances using a spatio-temporal extension of the
+ * Douglas-Peucker line simplification algorithm
+ */
+PGDLLEXPORT Datum
+tpoint_simplify_pyramid(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+  int count;
+  double *eps_dist = pyramid_tolerances_extract(array, &count);
+  Temporal **levels = tpoint_simplify_pyramid_internal(temp, eps_dist,
+    count);
+  ArrayType *result = temporalarr_to_array(levels, count);
+  for (int i = 0; i < count; i++)
+    pfree(levels[i]);
+  pfree(levels);
+  pfree(eps_dist);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_FREE_IF_COPY(array, 1);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_pyramid_trajectory);
+/**
+ * Returns the trajectory of the coarsest level of the pyramid whose
+ * tolerance is less than or equal to the resolution, or of the finest
+ * level if all the tolerances are greater than the resolution
+ */
+PGDLLEXPORT Datum
+tpoint_pyramid_trajectory(PG_FUNCTION_ARGS)
+{
+  ArrayType *pyramid = PG_GETARG_ARRAYTYPE_P(0);
+  ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+  double resolution = PG_GETARG_FLOAT8(2);
+  int count, count1;
+  double *eps_dist = pyramid_tolerances_extract(array, &count1);
+  ensure_non_empty_array(pyramid);
+  Temporal **levels = temporalarr_extract(pyramid, &count);
+  if (count != count1)
+  {
+    pfree(levels); pfree(eps_dist);
+    PG_FREE_IF_COPY(pyramid, 0);
+    PG_FREE_IF_COPY(array, 1);
+    ereport(ERROR, (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+      errmsg("The input arrays must have the same number of elements")));
+  }
+  int level = 0;
+  while (level < count - 1 && eps_dist[level + 1] <= resolution)
+    level++;
+  Datum result = tpoint_trajectory_internal(levels[level]);
+  pfree(levels); pfree(eps_dist);
+  PG_FREE_IF_COPY(pyramid, 0);
+  PG_FREE_IF_COPY(array, 1);
+  PG_RETURN_DATUM(result);
+}
+
+/*****************************************************************************
+ * Online simplification of a stream of temporal points using an opening
+ * window bounded by the synchronized Euclidean distance (SED).
+ * The instants are fed in increasing order of time and only the instants
+ * kept in the result are stored in the aggregate state, together with the
+ * instants dropped since the last kept one, which are needed to bound the
+ * error of the current window.
+ *****************************************************************************/
+
+/**
+ * Structure storing the state of the online simplification
+ */
+typedef struct
+{
+  double maxdist;        /**< Maximum synchronized distance */
+  bool hasz;             /**< True when the points have Z coordinates */
+  int count;             /**< Number of kept instants */
+  int size;              /**< Size of the array of kept instants */
+  TInstant **instants;   /**< Kept instants, the last one is the anchor */
+  TInstant *last;        /**< Last instant received, which is kept or
+                              dropped when the next one arrives */
+  int npoints;           /**< Number of instants dropped since the anchor */
+  POINT3DZ *points;      /**< Points of the dropped instants */
+  TimestampTz *times;    /**< Timestamps of the dropped instants */
+} SimplifyState;
+
+/**
+ * Returns the point of the temporal instant point, with a Z coordinate
+ * equal to 0 when the point is 2D
+ */
+static POINT3DZ
+tpointinst_point3dz(const TInstant *inst, bool hasz)
+{
+  POINT3DZ result;
+  if (hasz)
+    result = datum_get_point3dz(tinstant_value(inst));
+  else
+  {
+    POINT2D p = datum_get_point2d(tinstant_value(inst));
+    result.x = p.x;
+    result.y = p.y;
+    result.z = 0;
+  }
+  return result;
+}
+
+/**
+ * Returns the synchronized Euclidean distance between the point at the
+ * timestamp and the segment, that is, the distance to the position at the
+ * same timestamp of a point moving along the segment at constant speed
+ */
+static double
+sed_pt_seg(const POINT3DZ *p, TimestampTz t, const POINT3DZ *a,
+  TimestampTz ta, const POINT3DZ *b, TimestampTz tb)
+{
+  double ratio = (double) (t - ta) / (double) (tb - ta);
+  return hypot3d(p->x - (a->x + (b->x - a->x) * ratio),
+    p->y - (a->y + (b->y - a->y) * ratio),
+    p->z - (a->z + (b->z - a->z) * ratio));
+}
+
+/**
+ * Creates the state of the online simplification
+ *
+ * @note The function must be called in the memory context for aggregation
+ */
+static SimplifyState *
+simplifystate_make(const TInstant *inst, double maxdist)
+{
+  SimplifyState *result = palloc(sizeof(SimplifyState));
+  result->maxdist = maxdist;
+  result->hasz = MOBDB_FLAGS_GET_Z(inst->flags);
+  result->count = 1;
+  result->size = SIMPLIFYSTATE_INITIAL_CAPACITY;
+  result->instants = palloc(sizeof(TInstant *) * result->size);
+  result->instants[0] = tinstant_copy(inst);
+  result->last = NULL;
+  result->npoints = 0;
+  result->points = palloc(sizeof(POINT3DZ) * SIMPLIFYSTATE_MAX_WINDOW);
+  result->times = palloc(sizeof(TimestampTz) * SIMPLIFYSTATE_MAX_WINDOW);
+  return result;
+}
+
+/**
+ * Adds the temporal instant point to the state of the online simplification.
+ *
+ * The last instant received is dropped if the segment from the anchor to
+ * the new instant is within the maximum synchronized distance of all the
+ * instants dropped since the anchor, including the last one. Otherwise the
+ * last instant is kept and becomes the new anchor. The window is bounded so
+ * that the cost of adding an instant is bounded.
+ *
+ * @note The function must be called in the memory context for aggregation
+ */
+static void
+simplifystate_add(SimplifyState *state, const TInstant *inst)
+{
+  TInstant *anchor = state->instants[state->count - 1];
+  const TInstant *prev = state->last ? state->last : anchor;
+  ensure_spatial_validity((Temporal *) prev, (Temporal *) inst);
+  ensure_increasing_timestamps(prev, inst, true);
+  /* Instant shared by consecutive sequences */
+  ensure_same_overlapping_value(prev, inst);
+  if (prev->t == inst->t)
+    return;
+  if (! state->last)
+  {
+    state->last = tinstant_copy(inst);
+    return;
+  }
+
+  bool hasz = state->hasz;
+  POINT3DZ a = tpointinst_point3dz(anchor, hasz);
+  POINT3DZ b = tpointinst_point3dz(inst, hasz);
+  POINT3DZ p = tpointinst_point3dz(state->last, hasz);
+  bool drop = state->npoints < SIMPLIFYSTATE_MAX_WINDOW &&
+    sed_pt_seg(&p, state->last->t, &a, anchor->t, &b, inst->t) <=
+      state->maxdist;
+  for (int i = 0; drop && i < state->npoints; i++)
+    drop = sed_pt_seg(&state->points[i], state->times[i], &a, anchor->t,
+      &b, inst->t) <= state->maxdist;
+  if (drop)
+  {
+    state->points[state->npoints] = p;
+    state->times[state->npoints++] = state->last->t;
+    pfree(state->last);
+  }
+  else
+  {
+    if (state->count == state->size)
+    {
+      state->size *= 2;
+      state->instants = repalloc(state->instants,
+        sizeof(TInstant *) * state->size);
+    }
+    state->instants[state->count++] = state->last;
+    state->npoints = 0;
+  }
+  state->last = tinstant_copy(inst);
+  return;
+}
+
+/**
+ * Adds the instants of the temporal point to the state of the online
+ * simplification, creating the state if it is NULL
+ *
+ * @note The function must be called in the memory context for aggregation
+ */
+static SimplifyState *
+simplifystate_add_temp(SimplifyState *state, const Temporal *temp,
+  double maxdist)
+{
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+  {
+    const TInstant *inst = (const TInstant *) temp;
+    if (! state)
+      return simplifystate_make(inst, maxdist);
+    simplifystate_add(state, inst);
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+      state = simplifystate_add_temp(state,
+        (Temporal *) tinstantset_inst_n(ti, i), maxdist);
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    for (int i = 0; i < seq->count; i++)
+      state = simplifystate_add_temp(state,
+        (Temporal *) tsequence_inst_n(seq, i), maxdist);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      state = simplifystate_add_temp(state,
+        (Temporal *) tsequenceset_seq_n(ts, i), maxdist);
+  }
+  return state;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_simplify_transfn);
+/**
+ * Transition function for the online simplification of temporal points
+ */
+PGDLLEXPORT Datum
+tpoint_simplify_transfn(PG_FUNCTION_ARGS)
+{
+  SimplifyState *state = PG_ARGISNULL(0) ? NULL :
+    (SimplifyState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (! state)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(state);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  double maxdist = PG_ARGISNULL(2) ? 0 : PG_GETARG_FLOAT8(2);
+  if (maxdist < 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The maximum distance must be positive or zero")));
+
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state = simplifystate_add_temp(state, temp, maxdist);
+  unset_aggregation_context(ctx);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_simplify_finalfn);
+/**
+ * Final function for the online simplification of temporal points
+ */
+PGDLLEXPORT Datum
+tpoint_simplify_finalfn(PG_FUNCTION_ARGS)
+{
+  SimplifyState *state = (SimplifyState *) PG_GETARG_POINTER(0);
+  int count = state->count;
+  TInstant **instants = palloc(sizeof(TInstant *) * (count + 1));
+  memcpy(instants, state->instants, sizeof(TInstant *) * count);
+  if (state->last)
+    instants[count++] = state->last;
+  TSequence *result = tsequence_make(instants, count, true, true,
+    LINEAR, NORMALIZE);
+  pfree(instants);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Stops and trips of a temporal point
+ *
+ * A stop is a maximal run of consecutive instants whose positions are all
+ * within a given distance of the first one and which lasts at least a
+ * given duration, and the trips are the fragments of the temporal point
+ * between the stops. The stops are computed in a single pass over the
+ * coordinates of the instants with a window that starts at an instant and
+ * is extended while the positions remain within the distance. When the
+ * window lasts long enough it is a stop and the next window starts after
+ * it, otherwise the next window starts at the following instant.
+ *****************************************************************************/
+
+/**
+ * Returns the coordinates of the instants of the temporal sequence point,
+ * where the Z coordinate of 2D points is set to 0
+ */
+static POINT3DZ *
+tpointseq_coords(const TSequence *seq)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  POINT3DZ *result = palloc(sizeof(POINT3DZ) * seq->count);
+  for (int i = 0; i < seq->count; i++)
+  {
+    Datum value = tinstant_value(tsequence_inst_n(seq, i));
+    if (hasz)
+      result[i] = datum_get_point3dz(value);
+    else
+    {
+      const POINT2D *p = datum_get_point2d_p(value);
+      result[i].x = p->x;
+      result[i].y = p->y;
+      result[i].z = 0;
+    }
+  }
+  return result;
+}
+
+/**
+ * Computes the stops of the temporal sequence point and adds them to the
+ * array, returns the number of stops added
+ *
+ * @param[out] result Array on which the stops are stored
+ * @param[in] seq Temporal point
+ * @param[in] maxdist Maximum distance of the positions of a stop
+ * @param[in] mintunits Minimum duration of a stop in microseconds
+ */
+static int
+tpointseq_stops1(TSequence **result, const TSequence *seq, double maxdist,
+  int64 mintunits)
+{
+  if (seq->count == 1)
+    return 0;
+
+  POINT3DZ *coords = tpointseq_coords(seq);
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  for (int i = 0; i < seq->count; i++)
+    instants[i] = tsequence_inst_n(seq, i);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  double maxdist2 = maxdist * maxdist;
+  int nstops = 0, i = 0;
+  while (i < seq->count - 1)
+  {
+    /* The instants i to j - 1 are within the distance of the i-th one */
+    int j = i + 1;
+    while (j < seq->count)
+    {
+      double dx = coords[j].x - coords[i].x;
+      double dy = coords[j].y - coords[i].y;
+      double dz = coords[j].z - coords[i].z;
+      if (dx * dx + dy * dy + dz * dz > maxdist2)
+        break;
+      j++;
+    }
+    if (instants[j - 1]->t - instants[i]->t >= mintunits)
+    {
+      bool lower_inc = (i == 0) ? seq->period.lower_inc : true;
+      bool upper_inc = (j == seq->count) ? seq->period.upper_inc : true;
+      result[nstops++] = tsequence_make(&instants[i], j - i, lower_inc,
+        upper_inc, linear, NORMALIZE);
+      i = j;
+    }
+    /* The windows starting after the i-th instant cannot be longer */
+    else if (j == seq->count)
+      break;
+    else
+      i++;
+  }
+  pfree(coords); pfree(instants);
+  return nstops;
+}
+
+/**
+ * Returns the stops of the temporal point as a temporal sequence set, or
+ * NULL if there are no stops (internal function)
+ */
+static TSequenceSet *
+tpoint_stops_internal(const Temporal *temp, double maxdist, int64 mintunits)
+{
+  TSequenceSet *result;
+  if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    TSequence **sequences = palloc(sizeof(TSequence *) * seq->count);
+    int count = tpointseq_stops1(sequences, seq, maxdist, mintunits);
+    result = tsequenceset_make_free(sequences, count, NORMALIZE_NO);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    TSequence **sequences = palloc(sizeof(TSequence *) * ts->totalcount);
+    int count = 0;
+    for (int i = 0; i < ts->count; i++)
+      count += tpointseq_stops1(&sequences[count], tsequenceset_seq_n(ts, i),
+        maxdist, mintunits);
+    result = tsequenceset_make_free(sequences, count, NORMALIZE_NO);
+  }
+  return result;
+}
+
+/**
+ * Ensures that the parameters of the stops are valid and returns the
+ * minimum duration of a stop in microseconds
+ */
+static int64
+ensure_valid_stops_params(TDuration duration, double maxdist,
+  const Interval *minduration)
+{
+  ensure_sequences_duration(duration);
+  if (maxdist < 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The maximum distance must be positive or zero")));
+  return interval_units(minduration);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_stops);
+/**
+ * Returns the stops of the temporal point, that is, the fragments of at
+ * least the given duration in which the point stays within the given
+ * distance of its position at the start of the fragment
+ */
+PGDLLEXPORT Datum
+tpoint_stops(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  double maxdist = PG_GETARG_FLOAT8(1);
+  Interval *minduration = PG_GETARG_INTERVAL_P(2);
+  int64 mintunits = ensure_valid_stops_params(temp->duration, maxdist,
+    minduration);
+  TSequenceSet *result = tpoint_stops_internal(temp, maxdist, mintunits);
+  PG_FREE_IF_COPY(temp, 0);
+  if (! result)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_trips);
+/**
+ * Returns the trips of the temporal point, that is, the temporal point
+ * restricted to the complement of the time of its stops
+ */
+PGDLLEXPORT Datum
+tpoint_trips(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  double maxdist = PG_GETARG_FLOAT8(1);
+  Interval *minduration = PG_GETARG_INTERVAL_P(2);
+  int64 mintunits = ensure_valid_stops_params(temp->duration, maxdist,
+    minduration);
+  TSequenceSet *stops = tpoint_stops_internal(temp, maxdist, mintunits);
+  Temporal *result;
+  if (! stops)
+    result = temporal_copy(temp);
+  else
+  {
+    Period **periods = palloc(sizeof(Period *) * stops->count);
+    for (int i = 0; i < stops->count; i++)
+      periods[i] = period_copy(&tsequenceset_seq_n(stops, i)->period);
+    PeriodSet *ps = periodset_make_free(periods, stops->count, NORMALIZE_NO);
+    result = temporal_restrict_periodset_internal(temp, ps, REST_MINUS);
+    pfree(ps); pfree(stops);
+  }
+  PG_FREE_IF_COPY(temp, 0);
+  if (! result)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Vector tile geometry of a temporal point
+ *
+ * The temporal point is clipped to the bounds of the tile extended with
+ * the buffer and to their time span, if any, and its coordinates are
+ * transformed into the integer coordinates of the tile, whose Y axis
+ * points downwards. The consecutive instants of a sequence that fall on the
+ * same position of the tile are represented by the first one, except the
+ * last instant of the sequence that is always kept. The result is a
+ * trajectory geometry where the M coordinates encode the timestamps in
+ * number of seconds since '1970-01-01', which can be passed to ST_AsMVT.
+ *****************************************************************************/
+
+/**
+ * Structure to represent the transformation of the coordinates of a
+ * temporal point into the coordinates of a vector tile
+ */
+typedef struct
+{
+  double xmin;     /**< Lower X bound of the tile */
+  double ymax;     /**< Upper Y bound of the tile */
+  double xscale;   /**< Number of tile units per unit in the X dimension */
+  double yscale;   /**< Number of tile units per unit in the Y dimension */
+} MVTTransform;
+
+/**
+ * Sets the tile coordinates of the temporal instant point
+ */
+static void
+tpointinst_mvt_point(POINT2D *result, const TInstant *inst,
+  const MVTTransform *trans)
+{
+  const POINT2D *p = datum_get_point2d_p(tinstant_value(inst));
+  result->x = rint((p->x - trans->xmin) * trans->xscale);
+  result->y = rint((trans->ymax - p->y) * trans->yscale);
+  return;
+}
+
+/**
+ * Returns the trajectory point of the tile coordinates and the timestamp
+ */
+static LWGEOM *
+mvt_trajpoint(const POINT2D *p, TimestampTz t)
+{
+  /* See the function point_to_trajpoint */
+  double epoch = ((double) t / 1e6) + 946684800;
+  return (LWGEOM *) lwpoint_make3dm(0, p->x, p->y, epoch);
+}
+
+/**
+ * Returns the vector tile geometry of the temporal instant set point
+ */
+static LWGEOM *
+tpointinstset_mvt_geom(const TInstantSet *ti, const MVTTransform *trans)
+{
+  LWGEOM **points = palloc(sizeof(LWGEOM *) * ti->count);
+  POINT2D p;
+  for (int i = 0; i < ti->count; i++)
+  {
+    TInstant *inst = tinstantset_inst_n(ti, i);
+    tpointinst_mvt_point(&p, inst, trans);
+    points[i] = mvt_trajpoint(&p, inst->t);
+  }
+  if (ti->count == 1)
+  {
+    LWGEOM *result = points[0];
+    pfree(points);
+    return result;
+  }
+  return (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE, 0, NULL,
+    (uint32_t) ti->count, points);
+}
+
+/**
+ * Returns the vector tile geometry of the temporal sequence point
+ */
+static LWGEOM *
+tpointseq_mvt_geom(const TSequence *seq, const MVTTransform *trans)
+{
+  LWGEOM **points = palloc(sizeof(LWGEOM *) * seq->count);
+  POINT2D p, prev;
+  int k = 0;
+  for (int i = 0; i < seq->count; i++)
+  {
+    TInstant *inst = tsequence_inst_n(seq, i);
+    tpointinst_mvt_point(&p, inst, trans);
+    if (k > 0 && i < seq->count - 1 && p.x == prev.x && p.y == prev.y)
+      continue;
+    points[k++] = mvt_trajpoint(&p, inst->t);
+    prev = p;
+  }
+  LWGEOM *result;
+  if (k == 1)
+  {
+    result = points[0];
+    pfree(points);
+  }
+  else if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
+  {
+    result = (LWGEOM *) lwline_from_lwgeom_array(0, (uint32_t) k, points);
+    for (int i = 0; i < k; i++)
+      lwpoint_free((LWPOINT *) points[i]);
+    pfree(points);
+  }
+  else
+    result = (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE, 0, NULL,
+      (uint32_t) k, points);
+  return result;
+}
+
+/**
+ * Returns the vector tile geometry of the temporal sequence set point
+ */
+static LWGEOM *
+tpointseqset_mvt_geom(const TSequenceSet *ts, const MVTTransform *trans)
+{
+  if (ts->count == 1)
+    return tpointseq_mvt_geom(tsequenceset_seq_n(ts, 0), trans);
+  uint32_t colltype = 0;
+  LWGEOM **geoms = palloc(sizeof(LWGEOM *) * ts->count);
+  for (int i = 0; i < ts->count; i++)
+  {
+    geoms[i] = tpointseq_mvt_geom(tsequenceset_seq_n(ts, i), trans);
+    /* Make the output a collection when the types are not compatible */
+    if (! colltype)
+      colltype = lwtype_get_collectiontype(geoms[i]->type);
+    else if (colltype != COLLECTIONTYPE &&
+      lwtype_get_collectiontype(geoms[i]->type) != colltype)
+      colltype = COLLECTIONTYPE;
+  }
+  return (LWGEOM *) lwcollection_construct((uint8_t) colltype, 0, NULL,
+    (uint32_t) ts->count, geoms);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_as_mvtgeom);
+/**
+ * Returns the geometry of the temporal point in the coordinate space of a
+ * vector tile, or NULL if the temporal point does not intersect the tile
+ */
+PGDLLEXPORT Datum
+tpoint_as_mvtgeom(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  STBOX *bounds = PG_GETARG_STBOX_P(1);
+  int32 extent = PG_GETARG_INT32(2);
+  int32 buffer = PG_GETARG_INT32(3);
+  bool clip = PG_GETARG_BOOL(4);
+  ensure_has_X_stbox(bounds);
+  ensure_same_srid_tpoint_stbox(temp, bounds);
+  ensure_has_not_Z_tpoint(temp);
+  ensure_same_spatial_dimensionality_tpoint_stbox(temp, bounds);
+  if (bounds->xmax <= bounds->xmin || bounds->ymax <= bounds->ymin)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The bounds of the tile must have a positive width and height")));
+  if (extent <= 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The extent of the tile must be strictly positive")));
+  if (buffer < 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The buffer of the tile must be positive or zero")));
+
+  MVTTransform trans;
+  trans.xmin = bounds->xmin;
+  trans.ymax = bounds->ymax;
+  trans.xscale = extent / (bounds->xmax - bounds->xmin);
+  trans.yscale = extent / (bounds->ymax - bounds->ymin);
+
+  Temporal *temp1;
+  if (clip)
+  {
+    STBOX box;
+    memcpy(&box, bounds, sizeof(STBOX));
+    box.xmin -= buffer / trans.xscale;
+    box.xmax += buffer / trans.xscale;
+    box.ymin -= buffer / trans.yscale;
+    box.ymax += buffer / trans.yscale;
+    temp1 = tpoint_at_stbox_internal(temp, &box);
+  }
+  else if (MOBDB_FLAGS_GET_T(bounds->flags))
+  {
+    Period p;
+    period_set(&p, bounds->tmin, bounds->tmax, true, true);
+    temp1 = temporal_at_period_internal(temp, &p);
+  }
+  else
+    temp1 = temp;
+  if (temp1 == NULL)
+  {
+    PG_FREE_IF_COPY(temp, 0);
+    PG_RETURN_NULL();
+  }
+
+  LWGEOM *geom;
+  ensure_valid_duration(temp1->duration);
+  if (temp1->duration == INSTANT)
+  {
+    POINT2D p;
+    tpointinst_mvt_point(&p, (TInstant *) temp1, &trans);
+    geom = mvt_trajpoint(&p, ((TInstant *) temp1)->t);
+  }
+  else if (temp1->duration == INSTANTSET)
+    geom = tpointinstset_mvt_geom((TInstantSet *) temp1, &trans);
+  else if (temp1->duration == SEQUENCE)
+    geom = tpointseq_mvt_geom((TSequence *) temp1, &trans);
+  else /* temp1->duration == SEQUENCESET */
+    geom = tpointseqset_mvt_geom((TSequenceSet *) temp1, &trans);
+  GSERIALIZED *result = geo_serialize(geom);
+  lwgeom_free(geom);
+  if (temp1 != temp)
+    pfree(temp1);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
@@ -33,12 +33,28 @@
  *
  * For the time dimension, the statistics collected in Slots 3 and 4 depend on 
  * the duration. Please refer to file temporal_analyze.c for more information.
+ * As for the other temporal types, the average number of instants and of
+ * sequences is stored in the slot of the histogram of period lengths.
+ *
+ * Since the statistics of the spatial and the time dimensions are collected
+ * independently, they cannot capture the correlation between the two
+ * dimensions, such as traffic concentrated in downtown at rush hours.
+ * Therefore, a joint spatiotemporal histogram is also collected.
+ * - Slot 5
+ *     - `stakind` contains the type of statistics which is `STATISTIC_KIND_NDT`.
+ *     - `stanumbers` stores the ND histogram of occurrence of features, where
+ *       the last dimension is the time dimension expressed in seconds.
+ *
+ * All these statistics are computed from the bounding boxes of the sampled
+ * values, which are fetched from the beginning of toasted values without
+ * detoasting them. The trajectories of the values are never computed.
  */
 
 #include "tpoint_analyze.h"
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <access/htup_details.h>
 #include <executor/spi.h>
 #include <utils/lsyscache.h>
@@ -47,6 +63,7 @@
 #include "time_analyze.h"
 #include "temporal.h"
 #include "oidcache.h"
+#include "tbox.h"
 #include "temporal_util.h"
 #include "temporal_analyze.h"
 #include "postgis.h"
@@ -289,6 +306,54 @@ nd_box_from_gbox(const GBOX *gbox, ND_BOX *nd_box)
   }
 }
 
+/**
+ * Set the values of an #ND_BOX from an STBOX, the time dimension expressed
+ * in seconds being put in dimension tdim. The z dimension, if any, is set
+ * before the time dimension, which overwrites it when tdim is 2.
+ */
+void
+nd_box_from_stbox_time(const STBOX *box, int tdim, ND_BOX *nd_box)
+{
+  nd_box_init(nd_box);
+  nd_box->min[0] = (float4) box->xmin;
+  nd_box->max[0] = (float4) box->xmax;
+  nd_box->min[1] = (float4) box->ymin;
+  nd_box->max[1] = (float4) box->ymax;
+  if (MOBDB_FLAGS_GET_Z(box->flags) || MOBDB_FLAGS_GET_GEODETIC(box->flags))
+  {
+    nd_box->min[2] = (float4) box->zmin;
+    nd_box->max[2] = (float4) box->zmax;
+  }
+  nd_box->min[tdim] = (float4) ((double) box->tmin / USECS_PER_SEC);
+  nd_box->max[tdim] = (float4) ((double) box->tmax / USECS_PER_SEC);
+}
+
+/**
+ * Set the values of an #ND_BOX from a TBOX, the value dimension being put
+ * in dimension 0 and the time dimension expressed in seconds in dimension 1
+ */
+void
+nd_box_from_tbox(const TBOX *box, ND_BOX *nd_box)
+{
+  nd_box_init(nd_box);
+  nd_box->min[0] = (float4) box->xmin;
+  nd_box->max[0] = (float4) box->xmax;
+  nd_box->min[1] = (float4) ((double) box->tmin / USECS_PER_SEC);
+  nd_box->max[1] = (float4) ((double) box->tmax / USECS_PER_SEC);
+}
+
+/**
+ * Move the values of dimension from of an #ND_BOX into dimension to and
+ * zero out dimension from
+ */
+static void
+nd_box_move_dim(ND_BOX *nd_box, int from, int to)
+{
+  nd_box->min[to] = nd_box->min[from];
+  nd_box->max[to] = nd_box->max[from];
+  nd_box->min[from] = nd_box->max[from] = 0.0;
+}
+
 /**
  * The difference between the fourth and first quintile values,
  * the "inter-quintile range"
@@ -490,6 +555,12 @@ gbox_ndims(const GBOX* gbox)
  * We will populate an n-d histogram using the provided
  * sample rows. The selectivity estimators (sel and j_oinsel)
  * can then use the histogram
+ *
+ * The mode argument is 2 for a 2D histogram and 0 for an ND histogram of
+ * the trajectories, as in PostGIS. Mode 3 is specific to temporal points and
+ * computes a joint histogram of the bounding boxes of the values whose
+ * dimensions are x, y, z if any, and t. Mode 4 is the same for temporal
+ * numbers, the dimensions being the value and t.
  */
 void
 gserialized_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
@@ -522,6 +593,7 @@ gserialized_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   int  histo_cells_new = 1;      /* Temporary variable */
 
   int   ndims = 2;          /* Dimensionality of the sample */
+  bool  hasz = false;         /* Does the sample have a z dimension? (mode 3) */
   int   histo_ndims = 0;        /* Dimensionality of the histogram */
   double sample_distribution[ND_DIMS]; /* How homogeneous is distribution of sample in each axis? */
 
@@ -560,12 +632,10 @@ gserialized_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   for ( i = 0; i < sample_rows; i++ )
   {
     Datum datum;
-    Temporal *temp;
-    GSERIALIZED *geom;
+    STBOX box;
     GBOX gbox;
     ND_BOX *nd_box;
     bool is_null;
-    bool is_copy;
 
     datum = fetchfunc(stats, i, &is_null);
 
@@ -576,45 +646,85 @@ gserialized_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
       continue;
     }
 
-    /*
-     * This changes wrt the original PostGIS function. We get a temporal
-     * point while the original function gets a geometry.
-     */
-    temp = DatumGetTemporal(datum);
-
-    /* TO VERIFY */
-    is_copy = VARATT_IS_EXTENDED(temp);
-
-    /* Get trajectory from temporal point */
-    geom = (GSERIALIZED *) DatumGetPointer(tpoint_trajectory_internal(temp));
+    /* How many bytes does this sample use? */
+    total_width += VARSIZE_ANY(DatumGetPointer(datum));
 
-    /* Read the bounds from the gserialized. */
-    if ( LW_FAILURE == gserialized_get_gbox_p(geom, &gbox) )
+    if ( mode == 4 )
     {
-      /* Skip empties too. */
-      continue;
-    }
+      /*
+       * In value-time mode, read the bounding box of the temporal number,
+       * whose dimensions are the value and the time
+       */
+      TBOX tbox;
+      memset(&tbox, 0, sizeof(TBOX));
+      temporal_bbox_slice(&tbox, datum);
 
-    /* If we're in 2D mode, zero out the higher dimensions for "safety" */
-    if ( mode == 2 )
-      gbox.zmin = gbox.zmax = gbox.mmin = gbox.mmax = 0.0;
+      /* Check bounds for validity (finite and not NaN) */
+      if ( ! isfinite(tbox.xmin) || ! isfinite(tbox.xmax) )
+      {
+        continue;
+      }
+      ndims = 2;
 
-    /* Check bounds for validity (finite and not NaN) */
-    if ( ! gbox_is_valid(&gbox) )
+      /* Convert tbox to n-d box */
+      nd_box = palloc(sizeof(ND_BOX));
+      nd_box_from_tbox(&tbox, nd_box);
+    }
+    else if ( mode == 3 )
     {
-      continue;
+      /*
+       * In spatiotemporal mode, the time dimension is put in the last
+       * dimension, it is moved after the scan if no value in the sample has
+       * a z dimension.
+       */
+      memset(&box, 0, sizeof(STBOX));
+      temporal_bbox_slice(&box, datum);
+      if ( MOBDB_FLAGS_GET_Z(box.flags) || MOBDB_FLAGS_GET_GEODETIC(box.flags) )
+        hasz = true;
+      ndims = ND_DIMS;
+
+      /* Convert stbox to n-d box */
+      nd_box = palloc(sizeof(ND_BOX));
+      nd_box_from_stbox_time(&box, ND_DIMS - 1, nd_box);
     }
+    else
+    {
+      /*
+       * This changes wrt the original PostGIS function. We read the bounding
+       * box of a temporal point while the original function reads the one
+       * of a geometry. The spatial part of this box is the bounding box of
+       * the trajectory, and it is fetched without detoasting the whole value.
+       */
+      memset(&box, 0, sizeof(STBOX));
+      temporal_bbox_slice(&box, datum);
+      memset(&gbox, 0, sizeof(GBOX));
+      FLAGS_SET_Z(gbox.flags, MOBDB_FLAGS_GET_Z(box.flags));
+      FLAGS_SET_GEODETIC(gbox.flags, MOBDB_FLAGS_GET_GEODETIC(box.flags));
+      gbox.xmin = box.xmin; gbox.xmax = box.xmax;
+      gbox.ymin = box.ymin; gbox.ymax = box.ymax;
+      gbox.zmin = box.zmin; gbox.zmax = box.zmax;
+
+      /* If we're in 2D mode, zero out the higher dimensions for "safety" */
+      if ( mode == 2 )
+        gbox.zmin = gbox.zmax = gbox.mmin = gbox.mmax = 0.0;
+
+      /* Check bounds for validity (finite and not NaN) */
+      if ( ! gbox_is_valid(&gbox) )
+      {
+        continue;
+      }
 
-    /*
-     * In N-D mode, set the ndims to the maximum dimensionality found
-     * in the sample. Otherwise, leave at ndims == 2.
-     */
-    if ( mode != 2 )
-      ndims = Max(gbox_ndims(&gbox), ndims);
+      /*
+       * In N-D mode, set the ndims to the maximum dimensionality found
+       * in the sample. Otherwise, leave at ndims == 2.
+       */
+      if ( mode != 2 )
+        ndims = Max(gbox_ndims(&gbox), ndims);
 
-    /* Convert gbox to n-d box */
-    nd_box = palloc(sizeof(ND_BOX));
-    nd_box_from_gbox(&gbox, nd_box);
+      /* Convert gbox to n-d box */
+      nd_box = palloc(sizeof(ND_BOX));
+      nd_box_from_gbox(&gbox, nd_box);
+    }
 
     /* Cache n-d bounding box */
     sample_boxes[notnull_cnt] = nd_box;
@@ -636,14 +746,23 @@ gserialized_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
     /* Increment our "good feature" count */
     notnull_cnt++;
 
-    /* Free up memory if our sample geometry was copied */
-    if ( is_copy )
-      pfree(geom);
-
     /* Give backend a chance of interrupting us */
     vacuum_delay_point();
   }
 
+  /*
+   * In spatiotemporal mode without z dimension, the time dimension is
+   * moved just after the y dimension
+   */
+  if ( mode == 3 && ! hasz )
+  {
+    ndims = ND_DIMS - 1;
+    for ( i = 0; i < notnull_cnt; i++ )
+      nd_box_move_dim((ND_BOX *) sample_boxes[i], ND_DIMS - 1, ndims - 1);
+    nd_box_move_dim(&sample_extent, ND_DIMS - 1, ndims - 1);
+    nd_box_move_dim(&sum, ND_DIMS - 1, ndims - 1);
+  }
+
   /*
    * We'll build a histogram having stats->attr->attstattarget cells
    * on each side,  within reason... we'll use ndims*10000 as the
@@ -916,6 +1035,11 @@ gserialized_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
     stats_slot = STATISTIC_SLOT_2D;
     stats_kind = STATISTIC_KIND_2D;
   }
+  else if ( mode == 3 || mode == 4 )
+  {
+    stats_slot = STATISTIC_SLOT_NDT;
+    stats_kind = STATISTIC_KIND_NDT;
+  }
   else
   {
     stats_slot = STATISTIC_SLOT_ND;
@@ -947,6 +1071,8 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   int notnull_cnt = 0;      /* # not null rows in the sample */
   int null_cnt = 0;        /* # null rows in the sample */
   double total_width = 0;      /* # of bytes used by sample */
+  double total_insts = 0;      /* # of instants of the sample */
+  double total_seqs = 0;       /* # of sequences of the sample */
 
   int slot_idx = 2;        /* Starting slot for storing temporal statistics */
 
@@ -961,12 +1087,10 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   for (int i = 0; i < sample_rows; i++)
   {
     Datum value;
-    Temporal *temp;
     Period period;
     PeriodBound period_lower,
         period_upper;
     bool is_null;
-    bool is_copy;
 
     value = fetchfunc(stats, i, &is_null);
 
@@ -977,17 +1101,17 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
       continue;
     }
 
-    /* Get temporal point */
-    temp = DatumGetTemporal(value);
-
-    /* TO VERIFY */
-    is_copy = VARATT_IS_EXTENDED(temp);
-
     /* How many bytes does this sample use? */
-    total_width += VARSIZE(temp);
+    total_width += VARSIZE_ANY(DatumGetPointer(value));
 
-    /* Get period from temporal point */
-    temporal_period(&period, temp);
+    /* How many instants and sequences does this sample have? */
+    int ninsts, nseqs;
+    temporal_counts_slice(&ninsts, &nseqs, value);
+    total_insts += ninsts;
+    total_seqs += nseqs;
+
+    /* Get period from temporal point without detoasting it */
+    temporal_period_slice(&period, value);
 
     /* Remember time bounds and length for further usage in histograms */
     period_deserialize(&period, &period_lower, &period_upper);
@@ -999,10 +1123,6 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
     /* Increment our "good feature" count */
     notnull_cnt++;
 
-    /* Free up memory if our sample temporal point was copied */
-    if (is_copy)
-      pfree(temp);
-
     /* Give backend a chance of interrupting us */
     vacuum_delay_point();
   }
@@ -1023,10 +1143,14 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
     gserialized_compute_stats(stats, fetchfunc, sample_rows, total_rows, 2);
     /* ND Mode */
     gserialized_compute_stats(stats, fetchfunc, sample_rows, total_rows, 0);
+    /* Joint spatiotemporal mode */
+    gserialized_compute_stats(stats, fetchfunc, sample_rows, total_rows, 3);
 
     /* Compute statistics for time dimension */
     period_compute_stats1(stats, notnull_cnt, &slot_idx,
       time_lowers, time_uppers, time_lengths);
+    temporal_count_stats(stats, total_insts / notnull_cnt,
+      total_seqs / notnull_cnt);
   }
   else if (null_cnt > 0)
   {
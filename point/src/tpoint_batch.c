@@ -0,0 +1,478 @@
+/*****************************************************************************
+ *
+ * tpoint_batch.c
+ *    Batch computation of tdwithin and of the nearest approach distance
+ *    for pairs of temporal points given in the columnar format
+ *
+ * The candidate pairs of a join, for example those obtained with stboxJoin,
+ * are given as two buffers in the columnar format of asArrow whose i-th
+ * temporal points form the i-th pair. The pairs are synchronized into a
+ * single batch of segments which keeps, for each segment, the difference
+ * between the positions of the two points at its bounds in separate arrays
+ * for each coordinate. The per-segment computations, that is, solving the
+ * quadratic equation of tdwithin and minimizing the squared distance, are
+ * then done by kernels that are plain loops over these arrays without
+ * dependencies between the segments, so that they are vectorized by the
+ * compiler, and the results of the segments are finally gathered per pair.
+ * The temporal points of the buffers are considered as sequences with
+ * linear interpolation and inclusive bounds.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_batch.h"
+
+#include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/timestamp.h>
+
+#include "oidcache.h"
+#include "period.h"
+#include "periodset.h"
+#include "temporal_arrow.h"
+
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * Synchronization of the pairs
+ *****************************************************************************/
+
+/**
+ * Initializes the batch of segments
+ */
+static void
+segmentbatch_init(SegmentBatch *batch, int maxcount)
+{
+  batch->count = 0;
+  batch->maxcount = Max(maxcount, 1);
+  batch->pair = palloc(sizeof(int) * batch->maxcount);
+  batch->lower = palloc(sizeof(int64) * batch->maxcount);
+  batch->upper = palloc(sizeof(int64) * batch->maxcount);
+  for (int k = 0; k < 3; k++)
+  {
+    batch->d0[k] = palloc(sizeof(double) * batch->maxcount);
+    batch->d1[k] = palloc(sizeof(double) * batch->maxcount);
+  }
+  return;
+}
+
+/**
+ * Frees the batch of segments
+ */
+static void
+segmentbatch_free(SegmentBatch *batch)
+{
+  pfree(batch->pair); pfree(batch->lower); pfree(batch->upper);
+  for (int k = 0; k < 3; k++)
+  {
+    pfree(batch->d0[k]); pfree(batch->d1[k]);
+  }
+  return;
+}
+
+/**
+ * Returns the position of the point in a coordinate at the timestamp
+ *
+ * @param[in] state Columns of the buffer
+ * @param[in] i Instant such that its timestamp is the greatest one not after t
+ * @param[in] end Last instant of the temporal point
+ * @param[in] k Coordinate
+ * @param[in] t Timestamp
+ */
+static double
+batch_position(const ArrowReadState *state, int i, int end, int k, int64 t)
+{
+  const double *values = (const double *) state->values[k];
+  if (i == end || state->times[i] == t)
+    return values[i];
+  double ratio = (double) (t - state->times[i]) /
+    (double) (state->times[i + 1] - state->times[i]);
+  return values[i] + (values[i + 1] - values[i]) * ratio;
+}
+
+/**
+ * Ensure that the timestamps of the n-th temporal point of the buffer are
+ * increasing
+ */
+static void
+ensure_increasing_batch_times(const ArrowReadState *state, int n)
+{
+  for (int i = state->offsets[n] + 1; i < state->offsets[n + 1]; i++)
+  {
+    if (state->times[i] <= state->times[i - 1])
+      ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+        errmsg("Invalid buffer in the columnar format: the timestamps must be increasing")));
+  }
+  return;
+}
+
+/**
+ * Adds to the batch the synchronized segments of the n-th pair, that is,
+ * the segments between the successive timestamps of the two temporal
+ * points during their common time span
+ */
+static void
+segmentbatch_add_pair(SegmentBatch *batch, const ArrowReadState *state1,
+  const ArrowReadState *state2, int n)
+{
+  ensure_increasing_batch_times(state1, n);
+  ensure_increasing_batch_times(state2, n);
+  int i = state1->offsets[n], end1 = state1->offsets[n + 1] - 1;
+  int j = state2->offsets[n], end2 = state2->offsets[n + 1] - 1;
+  int64 lower = Max(state1->times[i], state2->times[j]);
+  int64 upper = Min(state1->times[end1], state2->times[end2]);
+  if (lower > upper)
+    return;
+
+  int ncols = state1->ncols;
+  double prev[3], cur[3];
+  int64 t = lower;
+  while (i < end1 && state1->times[i + 1] <= t)
+    i++;
+  while (j < end2 && state2->times[j + 1] <= t)
+    j++;
+  for (int k = 0; k < ncols; k++)
+    prev[k] = batch_position(state1, i, end1, k, t) -
+      batch_position(state2, j, end2, k, t);
+  do
+  {
+    /* Next timestamp of any of the two points, the pairs defined at a
+     * single instant give a single segment of duration 0 */
+    int64 next = upper;
+    if (i < end1)
+      next = Min(next, state1->times[i + 1]);
+    if (j < end2)
+      next = Min(next, state2->times[j + 1]);
+    while (i < end1 && state1->times[i + 1] <= next)
+      i++;
+    while (j < end2 && state2->times[j + 1] <= next)
+      j++;
+    for (int k = 0; k < ncols; k++)
+      cur[k] = batch_position(state1, i, end1, k, next) -
+        batch_position(state2, j, end2, k, next);
+    if (batch->count == batch->maxcount)
+    {
+      batch->maxcount *= 2;
+      batch->pair = repalloc(batch->pair, sizeof(int) * batch->maxcount);
+      batch->lower = repalloc(batch->lower, sizeof(int64) * batch->maxcount);
+      batch->upper = repalloc(batch->upper, sizeof(int64) * batch->maxcount);
+      for (int k = 0; k < 3; k++)
+      {
+        batch->d0[k] = repalloc(batch->d0[k], sizeof(double) * batch->maxcount);
+        batch->d1[k] = repalloc(batch->d1[k], sizeof(double) * batch->maxcount);
+      }
+    }
+    int s = batch->count++;
+    batch->pair[s] = n;
+    batch->lower[s] = t - ARROW_EPOCH_OFFSET;
+    batch->upper[s] = next - ARROW_EPOCH_OFFSET;
+    for (int k = 0; k < ncols; k++)
+    {
+      batch->d0[k][s] = prev[k];
+      batch->d1[k][s] = cur[k];
+      prev[k] = cur[k];
+    }
+    t = next;
+  } while (t < upper);
+  return;
+}
+
+/**
+ * Reads the two buffers and synchronizes their pairs into a batch
+ *
+ * @param[in] buffer1,buffer2 Buffers in the columnar format
+ * @param[out] batch Batch of segments
+ * @param[out] count Number of pairs
+ * @result Number of coordinates of the points
+ */
+static int
+segmentbatch_make(const bytea *buffer1, const bytea *buffer2,
+  SegmentBatch *batch, int *count)
+{
+  ArrowReadState state1, state2;
+  arrowread_init(&state1, buffer1, type_oid(T_GEOMETRY));
+  arrowread_init(&state2, buffer2, type_oid(T_GEOMETRY));
+  if (state1.count != state2.count)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The buffers must have the same number of temporal points")));
+  if (state1.srid != state2.srid)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("Operation on mixed SRID")));
+  if (state1.ncols != state2.ncols)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The temporal points must be of the same dimensionality")));
+
+  segmentbatch_init(batch, state1.ninsts + state2.ninsts);
+  for (int n = 0; n < state1.count; n++)
+    segmentbatch_add_pair(batch, &state1, &state2, n);
+  *count = state1.count;
+  pfree(state1.offsets); pfree(state1.times);
+  pfree(state2.offsets); pfree(state2.times);
+  for (int k = 0; k < state1.ncols; k++)
+  {
+    pfree(state1.values[k]); pfree(state2.values[k]);
+  }
+  return state1.ncols;
+}
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+
+/**
+ * Computes for each segment of the batch the fractions of its duration
+ * during which the distance between the points is at most the distance.
+ * The squared distance at fraction s of the segment is a s^2 + b s + c,
+ * the roots of the equation a s^2 + b s + c = dist^2 are computed with a
+ * mixture of the quadratic formula and the Viete formula to improve the
+ * precision as in tdwithin_tpointseq_tpointseq1.
+ *
+ * @param[in] batch Batch of segments
+ * @param[in] ncols Number of coordinates
+ * @param[in] dist Distance
+ * @param[out] lower,upper Fractions of the segments, the segment is never
+ * within the distance when lower > upper
+ */
+void
+segmentbatch_tdwithin(const SegmentBatch *batch, int ncols, double dist,
+  double *lower, double *upper)
+{
+  double dist2 = dist * dist;
+  for (int i = 0; i < batch->count; i++)
+  {
+    double a = 0, b = 0, c = - dist2;
+    for (int k = 0; k < ncols; k++)
+    {
+      double d0 = batch->d0[k][i];
+      double dd = batch->d1[k][i] - d0;
+      a += dd * dd;
+      b += 2 * dd * d0;
+      c += d0 * d0;
+    }
+    double s1, s2;
+    double discriminant = b * b - 4 * a * c;
+    if (a == 0)
+    {
+      /* Constant distance */
+      s1 = (c <= 0) ? 0 : 1;
+      s2 = (c <= 0) ? 1 : 0;
+    }
+    else if (discriminant < 0)
+    {
+      s1 = 1;
+      s2 = 0;
+    }
+    else if (discriminant == 0)
+      s1 = s2 = - b / (2 * a);
+    else if (b >= 0)
+    {
+      s1 = (- b - sqrt(discriminant)) / (2 * a);
+      s2 = (2 * c) / (- b - sqrt(discriminant));
+    }
+    else
+    {
+      s1 = (2 * c) / (- b + sqrt(discriminant));
+      s2 = (- b + sqrt(discriminant)) / (2 * a);
+    }
+    lower[i] = Max(s1, 0.0);
+    upper[i] = Min(s2, 1.0);
+  }
+  return;
+}
+
+/**
+ * Computes for each segment of the batch the minimum distance between the
+ * points, which is reached at the fraction -b / 2a of the segment clamped
+ * to [0, 1]
+ *
+ * @param[in] batch Batch of segments
+ * @param[in] ncols Number of coordinates
+ * @param[out] result Minimum distance of each segment
+ */
+void
+segmentbatch_distance(const SegmentBatch *batch, int ncols, double *result)
+{
+  for (int i = 0; i < batch->count; i++)
+  {
+    double a = 0, b = 0, c = 0;
+    for (int k = 0; k < ncols; k++)
+    {
+      double d0 = batch->d0[k][i];
+      double dd = batch->d1[k][i] - d0;
+      a += dd * dd;
+      b += 2 * dd * d0;
+      c += d0 * d0;
+    }
+    double s = (a == 0) ? 0 : - b / (2 * a);
+    s = Max(0.0, Min(s, 1.0));
+    result[i] = sqrt(Max(a * s * s + b * s + c, 0.0));
+  }
+  return;
+}
+
+/*****************************************************************************
+ * External functions
+ *****************************************************************************/
+
+/**
+ * Returns the next result of the batch
+ */
+static Datum
+batch_next(FunctionCallInfo fcinfo, FuncCallContext *funcctx)
+{
+  BatchState *state = (BatchState *) funcctx->user_fctx;
+  /* Skip the pairs without result */
+  while (state->i < state->count && ! state->found[state->i])
+    state->i++;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The positions in the buffers start at 1 */
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Int32GetDatum(state->i + 1);
+  values[1] = state->values[state->i];
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/**
+ * Initializes the set-returning function of the batch
+ */
+static void
+batch_init(FunctionCallInfo fcinfo, FuncCallContext *funcctx)
+{
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+      errmsg("function returning record called in context "
+        "that cannot accept type record")));
+  funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+  return;
+}
+
+PG_FUNCTION_INFO_V1(tdwithin_batch);
+/**
+ * Returns for each pair of temporal points of the two buffers the time
+ * during which they are within the given distance
+ */
+PGDLLEXPORT Datum
+tdwithin_batch(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    funcctx = SRF_FIRSTCALL_INIT();
+    MemoryContext oldcontext =
+      MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+    batch_init(fcinfo, funcctx);
+
+    bytea *buffer1 = PG_GETARG_BYTEA_P(0);
+    bytea *buffer2 = PG_GETARG_BYTEA_P(1);
+    double dist = PG_GETARG_FLOAT8(2);
+    if (dist < 0)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The distance cannot be negative")));
+    SegmentBatch batch;
+    int count;
+    int ncols = segmentbatch_make(buffer1, buffer2, &batch, &count);
+    double *lower = palloc(sizeof(double) * batch.maxcount);
+    double *upper = palloc(sizeof(double) * batch.maxcount);
+    segmentbatch_tdwithin(&batch, ncols, dist, lower, upper);
+
+    /* Gather the periods of the segments of each pair */
+    BatchState *state = palloc0(sizeof(BatchState));
+    state->count = count;
+    state->values = palloc(sizeof(Datum) * Max(count, 1));
+    state->found = palloc0(sizeof(bool) * Max(count, 1));
+    PeriodArray arr;
+    arr.size = 64;
+    arr.periods = palloc(sizeof(Period) * arr.size);
+    int s = 0;
+    while (s < batch.count)
+    {
+      int pair = batch.pair[s];
+      arr.count = 0;
+      for ( ; s < batch.count && batch.pair[s] == pair; s++)
+      {
+        if (lower[s] > upper[s])
+          continue;
+        double duration = (double) (batch.upper[s] - batch.lower[s]);
+        periodarr_add(&arr, batch.lower[s] + (int64) (lower[s] * duration),
+          batch.lower[s] + (int64) (upper[s] * duration), true, true);
+      }
+      if (arr.count > 0)
+      {
+        state->values[pair] = PointerGetDatum(periodarr_to_periodset(&arr));
+        state->found[pair] = true;
+      }
+    }
+    pfree(arr.periods); pfree(lower); pfree(upper);
+    segmentbatch_free(&batch);
+    funcctx->user_fctx = state;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  return batch_next(fcinfo, funcctx);
+}
+
+PG_FUNCTION_INFO_V1(distance_batch);
+/**
+ * Returns for each pair of temporal points of the two buffers their
+ * nearest approach distance
+ */
+PGDLLEXPORT Datum
+distance_batch(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    funcctx = SRF_FIRSTCALL_INIT();
+    MemoryContext oldcontext =
+      MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+    batch_init(fcinfo, funcctx);
+
+    bytea *buffer1 = PG_GETARG_BYTEA_P(0);
+    bytea *buffer2 = PG_GETARG_BYTEA_P(1);
+    SegmentBatch batch;
+    int count;
+    int ncols = segmentbatch_make(buffer1, buffer2, &batch, &count);
+    double *distances = palloc(sizeof(double) * batch.maxcount);
+    segmentbatch_distance(&batch, ncols, distances);
+
+    /* Minimum of the distances of the segments of each pair */
+    BatchState *state = palloc0(sizeof(BatchState));
+    state->count = count;
+    state->values = palloc(sizeof(Datum) * Max(count, 1));
+    state->found = palloc0(sizeof(bool) * Max(count, 1));
+    int s = 0;
+    while (s < batch.count)
+    {
+      int pair = batch.pair[s];
+      double result = DBL_MAX;
+      for ( ; s < batch.count && batch.pair[s] == pair; s++)
+        result = Min(result, distances[s]);
+      state->values[pair] = Float8GetDatum(result);
+      state->found[pair] = true;
+    }
+    pfree(distances);
+    segmentbatch_free(&batch);
+    funcctx->user_fctx = state;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  return batch_next(fcinfo, funcctx);
+}
+
+/*****************************************************************************/
@@ -90,6 +90,117 @@ tpointseqarr_to_stbox(STBOX *box, TSequence **sequences, int count)
   }
 }
 
+/*****************************************************************************
+ * Block boxes of temporal sequence points
+ *****************************************************************************/
+
+/**
+ * Returns the number of block boxes kept for a temporal sequence point
+ * with the given number of instants
+ *
+ * A block box is the spatiotemporal box of TPOINTSEQ_BLOCK_SIZE consecutive
+ * segments of the sequence, the last block possibly having less segments.
+ * Block boxes are only kept for sequences having at least
+ * TPOINTSEQ_BLOCK_MINCOUNT instants.
+ */
+int
+tpointseq_block_count(int count)
+{
+  if (count < TPOINTSEQ_BLOCK_MINCOUNT)
+    return 0;
+  return (count - 2) / TPOINTSEQ_BLOCK_SIZE + 1;
+}
+
+/**
+ * Set the block boxes from the array of temporal instant point values
+ *
+ * @param[out] blocks Array of tpointseq_block_count(count) boxes
+ * @param[in] instants Temporal instant values
+ * @param[in] count Number of elements in the array
+ */
+void
+tpointseq_make_blocks(STBOX *blocks, TInstant **instants, int count)
+{
+  int nblocks = tpointseq_block_count(count);
+  for (int i = 0; i < nblocks; i++)
+  {
+    int start = i * TPOINTSEQ_BLOCK_SIZE;
+    int end = Min(start + TPOINTSEQ_BLOCK_SIZE, count - 1);
+    memset(&blocks[i], 0, sizeof(STBOX));
+    tpointinstarr_to_stbox(&blocks[i], &instants[start], end - start + 1);
+  }
+}
+
+/**
+ * Set the block boxes of the temporal sequence point obtained by appending
+ * the instant to the sequence
+ *
+ * When the sequence already has block boxes only the last one is expanded
+ * or a new one is added, otherwise all the block boxes are computed.
+ *
+ * @param[out] blocks Array of tpointseq_block_count(seq->count + 1) boxes
+ * @param[in] seq Temporal sequence point
+ * @param[in] inst Temporal instant point appended to the sequence
+ */
+void
+tpointseq_append_blocks(STBOX *blocks, const TSequence *seq,
+  const TInstant *inst)
+{
+  const STBOX *oldblocks = tpointseq_blocks_ptr(seq);
+  if (oldblocks == NULL)
+  {
+    TInstant **instants = palloc(sizeof(TInstant *) * (seq->count + 1));
+    for (int i = 0; i < seq->count; i++)
+      instants[i] = tsequence_inst_n(seq, i);
+    instants[seq->count] = (TInstant *) inst;
+    tpointseq_make_blocks(blocks, instants, seq->count + 1);
+    pfree(instants);
+    return;
+  }
+  int nblocks = tpointseq_block_count(seq->count);
+  memcpy(blocks, oldblocks, sizeof(STBOX) * nblocks);
+  /* Block of the segment added by the instant */
+  int block = (seq->count - 1) / TPOINTSEQ_BLOCK_SIZE;
+  if (block == nblocks)
+  {
+    memset(&blocks[block], 0, sizeof(STBOX));
+    tpointinst_make_stbox(&blocks[block], tsequence_inst_n(seq, seq->count - 1));
+  }
+  STBOX box;
+  memset(&box, 0, sizeof(STBOX));
+  tpointinst_make_stbox(&box, inst);
+  stbox_expand(&blocks[block], &box);
+  return;
+}
+
+/**
+ * Returns a pointer to the block boxes of the temporal sequence point,
+ * which are located at the end of the value, or NULL if the sequence does
+ * not have block boxes
+ */
+const STBOX *
+tpointseq_blocks_ptr(const TSequence *seq)
+{
+  if (! MOBDB_FLAGS_GET_BLOCKS(seq->flags))
+    return NULL;
+  int nblocks = tpointseq_block_count(seq->count);
+  return (STBOX *) ((char *) seq + VARSIZE(seq) - sizeof(STBOX) * nblocks);
+}
+
+/**
+ * Set the SRID of the block boxes of the temporal sequence point, if any
+ */
+void
+tpointseq_blocks_set_srid(TSequence *seq, int32 srid)
+{
+  STBOX *blocks = (STBOX *) tpointseq_blocks_ptr(seq);
+  if (blocks == NULL)
+    return;
+  int nblocks = tpointseq_block_count(seq->count);
+  for (int i = 0; i < nblocks; i++)
+    blocks[i].srid = srid;
+}
+
 /*****************************************************************************
  * Boxes functions
  * These functions are currently not used but can be used for defining 
@@ -195,6 +306,302 @@ tpoint_stboxes(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Segment boxes functions
+ * The segment boxes of a temporal point are the spatiotemporal boxes of
+ * its instants and of the segments of its sequences. With stepwise
+ * interpolation the box of a segment is the box of its first instant
+ * extended until the timestamp of the next instant.
+ *****************************************************************************/
+
+/**
+ * Returns the maximum number of segment boxes of the temporal point value
+ */
+int
+tpoint_segment_stboxes_maxcount(const Temporal *temp)
+{
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    return 1;
+  else if (temp->duration == INSTANTSET)
+    return ((TInstantSet *) temp)->count;
+  else if (temp->duration == SEQUENCE)
+    return ((TSequence *) temp)->count;
+  else /* temp->duration == SEQUENCESET */
+    return ((TSequenceSet *) temp)->totalcount;
+}
+
+/**
+ * Set the box of the segment of the temporal sequence point starting at
+ * the n-th instant
+ */
+static void
+tpointseq_segment_stbox(STBOX *box, const TSequence *seq, int n)
+{
+  TInstant *inst1 = tsequence_inst_n(seq, n);
+  memset(box, 0, sizeof(STBOX));
+  tpointinst_make_stbox(box, inst1);
+  if (n == seq->count - 1)
+    return;
+  TInstant *inst2 = tsequence_inst_n(seq, n + 1);
+  if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
+  {
+    STBOX box2;
+    memset(&box2, 0, sizeof(STBOX));
+    tpointinst_make_stbox(&box2, inst2);
+    stbox_expand(box, &box2);
+  }
+  else
+    box->tmax = inst2->t;
+  return;
+}
+
+/**
+ * Returns the number of segment boxes of the temporal sequence point.
+ * Notice that with linear interpolation the box of the last instant is
+ * included in the box of the last segment.
+ */
+static int
+tpointseq_segment_count(const TSequence *seq)
+{
+  if (seq->count == 1 || ! MOBDB_FLAGS_GET_LINEAR(seq->flags))
+    return seq->count;
+  return seq->count - 1;
+}
+
+/**
+ * Set the segment boxes of the temporal point value
+ *
+ * @param[out] result Array of tpoint_segment_stboxes_maxcount(temp) boxes
+ * @param[in] temp Temporal point
+ * @return Number of boxes in the array
+ */
+int
+tpoint_segment_stboxes(STBOX *result, const Temporal *temp)
+{
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+  {
+    memset(&result[0], 0, sizeof(STBOX));
+    tpointinst_make_stbox(&result[0], (TInstant *) temp);
+    return 1;
+  }
+  if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+    {
+      memset(&result[i], 0, sizeof(STBOX));
+      tpointinst_make_stbox(&result[i], tinstantset_inst_n(ti, i));
+    }
+    return ti->count;
+  }
+  int nseqs = (temp->duration == SEQUENCE) ? 1 :
+    ((TSequenceSet *) temp)->count;
+  int k = 0;
+  for (int i = 0; i < nseqs; i++)
+  {
+    const TSequence *seq = (temp->duration == SEQUENCE) ?
+      (const TSequence *) temp : tsequenceset_seq_n((TSequenceSet *) temp, i);
+    int count = tpointseq_segment_count(seq);
+    for (int j = 0; j < count; j++)
+      tpointseq_segment_stbox(&result[k++], seq, j);
+  }
+  return k;
+}
+
+/**
+ * Merge consecutive boxes of the array so that it has at most the given
+ * number of boxes. The groups of merged boxes have the same size except
+ * possibly the last one.
+ *
+ * @param[in,out] boxes Array of boxes
+ * @param[in] count Number of elements in the array
+ * @param[in] maxcount Maximum number of boxes of the result
+ * @return Number of boxes in the array
+ */
+int
+stboxarr_merge(STBOX *boxes, int count, int maxcount)
+{
+  assert(maxcount > 0);
+  if (count <= maxcount)
+    return count;
+  int size = (count + maxcount - 1) / maxcount;
+  int k = 0;
+  for (int i = 0; i < count; i += size)
+  {
+    boxes[k] = boxes[i];
+    int end = Min(i + size, count);
+    for (int j = i + 1; j < end; j++)
+      stbox_expand(&boxes[k], &boxes[j]);
+    k++;
+  }
+  return k;
+}
+
+/**
+ * Returns true if the box of a segment of the temporal sequence point
+ * overlaps the box. The block boxes of the sequence, if any, are used for
+ * skipping the segments whose block does not overlap the box.
+ */
+static bool
+tpointseq_overlaps_segments_stbox(const TSequence *seq, const STBOX *box)
+{
+  STBOX segbox;
+  int count = tpointseq_segment_count(seq);
+  const STBOX *blocks = tpointseq_blocks_ptr(seq);
+  if (blocks == NULL)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      tpointseq_segment_stbox(&segbox, seq, i);
+      if (overlaps_stbox_stbox_internal(&segbox, box))
+        return true;
+    }
+    return false;
+  }
+  int nblocks = tpointseq_block_count(seq->count);
+  for (int i = 0; i < nblocks; i++)
+  {
+    if (! overlaps_stbox_stbox_internal(&blocks[i], box))
+      continue;
+    int start = i * TPOINTSEQ_BLOCK_SIZE;
+    int end = Min(start + TPOINTSEQ_BLOCK_SIZE, count);
+    for (int j = start; j < end; j++)
+    {
+      tpointseq_segment_stbox(&segbox, seq, j);
+      if (overlaps_stbox_stbox_internal(&segbox, box))
+        return true;
+    }
+  }
+  /* With stepwise interpolation the last instant is not in a segment */
+  if (count == seq->count)
+  {
+    tpointseq_segment_stbox(&segbox, seq, count - 1);
+    return overlaps_stbox_stbox_internal(&segbox, box);
+  }
+  return false;
+}
+
+/**
+ * Returns true if the box of a segment of the temporal point overlaps the
+ * box (internal function)
+ */
+bool
+overlaps_segments_tpoint_stbox_internal(const Temporal *temp,
+  const STBOX *box)
+{
+  STBOX bbox;
+  memset(&bbox, 0, sizeof(STBOX));
+  temporal_bbox(&bbox, temp);
+  if (! overlaps_stbox_stbox_internal(&bbox, box))
+    return false;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    return true;
+  if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+    {
+      memset(&bbox, 0, sizeof(STBOX));
+      tpointinst_make_stbox(&bbox, tinstantset_inst_n(ti, i));
+      if (overlaps_stbox_stbox_internal(&bbox, box))
+        return true;
+    }
+    return false;
+  }
+  if (temp->duration == SEQUENCE)
+    return tpointseq_overlaps_segments_stbox((TSequence *) temp, box);
+  /* temp->duration == SEQUENCESET */
+  const TSequenceSet *ts = (const TSequenceSet *) temp;
+  for (int i = 0; i < ts->count; i++)
+  {
+    TSequence *seq = tsequenceset_seq_n(ts, i);
+    memset(&bbox, 0, sizeof(STBOX));
+    temporal_bbox(&bbox, (Temporal *) seq);
+    if (overlaps_stbox_stbox_internal(&bbox, box) &&
+      tpointseq_overlaps_segments_stbox(seq, box))
+      return true;
+  }
+  return false;
+}
+
+PG_FUNCTION_INFO_V1(overlaps_segments_geo_tpoint);
+/**
+ * Returns true if the spatiotemporal box of the geometry overlaps the box
+ * of a segment of the temporal point
+ */
+PGDLLEXPORT Datum
+overlaps_segments_geo_tpoint(PG_FUNCTION_ARGS)
+{
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(0);
+  if (gserialized_is_empty(gs))
+    PG_RETURN_NULL();
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  STBOX box;
+  memset(&box, 0, sizeof(STBOX));
+  geo_to_stbox_internal(&box, gs);
+  bool result = overlaps_segments_tpoint_stbox_internal(temp, &box);
+  PG_FREE_IF_COPY(gs, 0);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(overlaps_segments_stbox_tpoint);
+/**
+ * Returns true if the spatiotemporal box overlaps the box of a segment of
+ * the temporal point
+ */
+PGDLLEXPORT Datum
+overlaps_segments_stbox_tpoint(PG_FUNCTION_ARGS)
+{
+  STBOX *box = PG_GETARG_STBOX_P(0);
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  bool result = overlaps_segments_tpoint_stbox_internal(temp, box);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(overlaps_segments_tpoint_geo);
+/**
+ * Returns true if the box of a segment of the temporal point overlaps the
+ * spatiotemporal box of the geometry
+ */
+PGDLLEXPORT Datum
+overlaps_segments_tpoint_geo(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+  if (gserialized_is_empty(gs))
+  {
+    PG_FREE_IF_COPY(temp, 0);
+    PG_RETURN_NULL();
+  }
+  STBOX box;
+  memset(&box, 0, sizeof(STBOX));
+  geo_to_stbox_internal(&box, gs);
+  bool result = overlaps_segments_tpoint_stbox_internal(temp, &box);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_FREE_IF_COPY(gs, 1);
+  PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(overlaps_segments_tpoint_stbox);
+/**
+ * Returns true if the box of a segment of the temporal point overlaps the
+ * spatiotemporal box
+ */
+PGDLLEXPORT Datum
+overlaps_segments_tpoint_stbox(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  STBOX *box = PG_GETARG_STBOX_P(1);
+  bool result = overlaps_segments_tpoint_stbox_internal(temp, box);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_BOOL(result);
+}
+
 /*****************************************************************************
  * Generic box functions 
  *****************************************************************************/
@@ -212,15 +619,14 @@ boxop_geo_tpoint(FunctionCallInfo fcinfo,
 	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(0);
 	if (gserialized_is_empty(gs))
 		PG_RETURN_NULL();
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	STBOX box1, box2;
 	memset(&box1, 0, sizeof(STBOX));
 	memset(&box2, 0, sizeof(STBOX));
 	geo_to_stbox_internal(&box1, gs);
-	temporal_bbox(&box2, temp);
+	temporal_bbox_slice(&box2, PG_GETARG_DATUM(1));
 	bool result = func(&box1, &box2);
+	COUNTER_BBOX(result);
 	PG_FREE_IF_COPY(gs, 0);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -237,14 +643,13 @@ boxop_tpoint_geo(FunctionCallInfo fcinfo,
 	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
 	if (gserialized_is_empty(gs))
 		PG_RETURN_NULL();
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	STBOX box1, box2;
 	memset(&box1, 0, sizeof(STBOX));
 	memset(&box2, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp);
+	temporal_bbox_slice(&box1, PG_GETARG_DATUM(0));
 	geo_to_stbox_internal(&box2, gs);
 	bool result = func(&box1, &box2);
-	PG_FREE_IF_COPY(temp, 0);
+	COUNTER_BBOX(result);
 	PG_FREE_IF_COPY(gs, 1);
 	PG_RETURN_BOOL(result);
 }
@@ -260,12 +665,11 @@ boxop_stbox_tpoint(FunctionCallInfo fcinfo,
 	bool (*func)(const STBOX *, const STBOX *))
 {
 	STBOX *box = PG_GETARG_STBOX_P(0);
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	STBOX box1;
 	memset(&box1, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp);
+	temporal_bbox_slice(&box1, PG_GETARG_DATUM(1));
 	bool result = func(box, &box1);
-	PG_FREE_IF_COPY(temp, 1);
+	COUNTER_BBOX(result);
 	PG_RETURN_BOOL(result);
 }
 
@@ -279,13 +683,12 @@ Datum
 boxop_tpoint_stbox(FunctionCallInfo fcinfo,
 	bool (*func)(const STBOX *, const STBOX *))
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	STBOX *box = PG_GETARG_STBOX_P(1);
 	STBOX box1;
 	memset(&box1, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp);
+	temporal_bbox_slice(&box1, PG_GETARG_DATUM(0));
 	bool result = func(&box1, box);
-	PG_FREE_IF_COPY(temp, 0);
+	COUNTER_BBOX(result);
 	PG_RETURN_BOOL(result);
 }
 
@@ -299,16 +702,13 @@ Datum
 boxop_tpoint_tpoint(FunctionCallInfo fcinfo,
 	bool (*func)(const STBOX *, const STBOX *))
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	STBOX box1, box2;
 	memset(&box1, 0, sizeof(STBOX));
 	memset(&box2, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp1);
-	temporal_bbox(&box2, temp2);
+	temporal_bbox_slice(&box1, PG_GETARG_DATUM(0));
+	temporal_bbox_slice(&box2, PG_GETARG_DATUM(1));
 	bool result = func(&box1, &box2);
-	PG_FREE_IF_COPY(temp1, 0);
-	PG_FREE_IF_COPY(temp2, 1);
+	COUNTER_BBOX(result);
 	PG_RETURN_BOOL(result);
 }
 
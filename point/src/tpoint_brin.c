@@ -0,0 +1,182 @@
+/*****************************************************************************
+ *
+ * tpoint_brin.c
+ *    BRIN index for temporal points
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file tpoint_brin.c
+ * BRIN support functions for temporal points, whose summary of a page range
+ * is the union of the spatiotemporal boxes of its values. The opcinfo
+ * function is shared with the temporal numbers, see temporal_brin.c.
+ */
+
+#include "tpoint_brin.h"
+
+#include <access/brin_internal.h>
+#include <access/brin_tuple.h>
+#include <access/skey.h>
+#include <utils/datum.h>
+
+#include "oidcache.h"
+#include "stbox.h"
+#include "tpoint.h"
+#include "tpoint_gist.h"
+
+/*****************************************************************************
+ * BRIN support functions for temporal points
+ *****************************************************************************/
+
+/**
+ * Transform the query of a scan key into a box
+ *
+ * @param[out] query Box
+ * @param[in] key Scan key
+ * @return False if the query is empty
+ */
+static bool
+tpoint_brin_query(STBOX *query, ScanKey key)
+{
+  Oid subtype = key->sk_subtype;
+  memset(query, 0, sizeof(STBOX));
+  if (tgeo_base_type(subtype))
+  {
+    /* The function returns false on empty geometries */
+    if (! geo_to_stbox_internal(query,
+        (GSERIALIZED *) PG_DETOAST_DATUM(key->sk_argument)))
+      return false;
+  }
+  else if (subtype == type_oid(T_STBOX))
+    memcpy(query, DatumGetSTboxP(key->sk_argument), sizeof(STBOX));
+  else if (tgeo_type(subtype))
+    temporal_bbox_slice(query, key->sk_argument);
+  else
+    elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+  return true;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_brin_add_value);
+/**
+ * BRIN add value function for temporal points
+ *
+ * Expand the union of the page range with the bounding box of the new value.
+ * Returns true if the summary has been modified.
+ */
+PGDLLEXPORT Datum
+tpoint_brin_add_value(PG_FUNCTION_ARGS)
+{
+  BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+  Datum newval = PG_GETARG_DATUM(2);
+  bool isnull = PG_GETARG_BOOL(3);
+  STBOX box, *unionbox;
+
+  /*
+   * If the new value is null, we record that we saw it if it's the first
+   * one; otherwise, there's nothing to do.
+   */
+  if (isnull)
+  {
+    if (column->bv_hasnulls)
+      PG_RETURN_BOOL(false);
+    column->bv_hasnulls = true;
+    PG_RETURN_BOOL(true);
+  }
+
+  memset(&box, 0, sizeof(STBOX));
+  temporal_bbox_slice(&box, newval);
+
+  /* If this is the first non-null value, we need to initialize */
+  if (column->bv_allnulls)
+  {
+    column->bv_values[0] = datumCopy(PointerGetDatum(&box), false,
+      sizeof(STBOX));
+    column->bv_allnulls = false;
+    PG_RETURN_BOOL(true);
+  }
+
+  unionbox = DatumGetSTboxP(column->bv_values[0]);
+  if (contains_stbox_stbox_internal(unionbox, &box))
+    PG_RETURN_BOOL(false);
+  stbox_adjust(unionbox, &box);
+  PG_RETURN_BOOL(true);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_brin_consistent);
+/**
+ * BRIN consistent function for temporal points
+ *
+ * Returns false if no value of the page range can satisfy the scan key.
+ * The union of the page range is tested as the internal nodes of a GiST
+ * index, i.e., with the same checks as stbox_gist_consistent_internal.
+ */
+PGDLLEXPORT Datum
+tpoint_brin_consistent(PG_FUNCTION_ARGS)
+{
+  BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+  ScanKey key = (ScanKey) PG_GETARG_POINTER(2);
+  STBOX query;
+
+  /* Handle IS NULL/IS NOT NULL tests */
+  if (key->sk_flags & SK_ISNULL)
+  {
+    if (key->sk_flags & SK_SEARCHNULL)
+      PG_RETURN_BOOL(column->bv_allnulls || column->bv_hasnulls);
+    if (key->sk_flags & SK_SEARCHNOTNULL)
+      PG_RETURN_BOOL(! column->bv_allnulls);
+    /* Neither IS NULL nor IS NOT NULL was used; assume all indexable
+     * operators are strict and return false */
+    PG_RETURN_BOOL(false);
+  }
+
+  /* If it is all nulls, it cannot possibly be consistent */
+  if (column->bv_allnulls)
+    PG_RETURN_BOOL(false);
+
+  if (! tpoint_brin_query(&query, key))
+    PG_RETURN_BOOL(false);
+
+  PG_RETURN_BOOL(stbox_gist_consistent_internal(
+    DatumGetSTboxP(column->bv_values[0]), &query, key->sk_strategy));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_brin_union);
+/**
+ * BRIN union function for temporal points
+ *
+ * Expand the first summary to include the second one
+ */
+PGDLLEXPORT Datum
+tpoint_brin_union(PG_FUNCTION_ARGS)
+{
+  BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+  BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+
+  /* Adjust "hasnulls" */
+  if (! col_a->bv_hasnulls && col_b->bv_hasnulls)
+    col_a->bv_hasnulls = true;
+
+  /* If there are no values in B, there's nothing left to do */
+  if (col_b->bv_allnulls)
+    PG_RETURN_VOID();
+
+  /* If A has no values, copy the summary of B */
+  if (col_a->bv_allnulls)
+  {
+    col_a->bv_allnulls = false;
+    col_a->bv_values[0] = datumCopy(col_b->bv_values[0], false,
+      sizeof(STBOX));
+    PG_RETURN_VOID();
+  }
+
+  stbox_adjust(DatumGetSTboxP(col_a->bv_values[0]),
+    DatumGetSTboxP(col_b->bv_values[0]));
+  PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
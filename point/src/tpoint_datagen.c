@@ -15,6 +15,7 @@
 #include <access/htup_details.h>
 #include <access/tupdesc.h>    /* for * () */
 #include <executor/executor.h>  /* for GetAttributeByName() */
+#include <funcapi.h>
 #include <utils/builtins.h>
 #include <utils/lsyscache.h>
 #include <utils/timestamp.h>
@@ -72,22 +73,33 @@ pt_angle(POINT2D p1, POINT2D p2, POINT2D p3)
   return result / RADIANS_PER_DEGREE;
 }
 
-  /* Helper macro to add an instant containing the current position */
+  /* Helper macro to add an instant containing the current position, which
+   * copies the template instant and overwrites its timestamp and point */
 #define ADD_CURRENT_POSITION                        \
   do {                                  \
-      lwpoint = lwpoint_make2d(srid, curPos.x, curPos.y);       \
-      point = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));    \
-      lwpoint_free(lwpoint);                      \
-      instants[l++] = tinstant_make(point, t, type_oid(T_GEOMETRY));  \
-      pfree(DatumGetPointer(point));                  \
+      instants[l] = (TInstant *) (block + instsize * l);        \
+      memcpy(instants[l], template, VARSIZE(template));           \
+      instants[l]->t = t;                          \
+      *((POINT2D *) datum_get_point2d_p(tinstant_value(instants[l]))) = \
+        curPos;                                \
+      l++;                                  \
   } while (0)
 
 /**
  * Create a trip using the BerlinMOD data generator (internal function)
+ *
+ * @param[in] rng Random number generator
+ * @param[in] lines, maxSpeeds, categories Edges of the path of the trip
+ * @param[in] noEdges Number of edges
+ * @param[in] startTime Start time of the trip
+ * @param[in] disturbData True when the positions are disturbed to simulate
+ * GPS errors
+ * @param[in] verbosity Level of the messages
  */
 TSequence *
-create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categories,
-  uint32_t noEdges, TimestampTz startTime, bool disturbData, int verbosity)
+create_trip_internal(gsl_rng *rng, LWLINE **lines, const double *maxSpeeds,
+  const int *categories, uint32_t noEdges, TimestampTz startTime,
+  bool disturbData, int verbosity)
 {
   /* CONSTANT PARAMETERS */
 
@@ -163,9 +175,11 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
   double segLength;
   /* Points */
   POINT2D p1, p2, p3, curPos;
-  /* Current position of the moving object */
-  LWPOINT *lwpoint;
-  Datum point;
+  /* Instant whose point is overwritten with the current position */
+  TInstant *template;
+  /* Block in which the instants are stored and size of an instant */
+  char *block;
+  size_t instsize;
   /* Current timestamp of the moving object */
   TimestampTz t;
   /* Instants of the result being constructed */
@@ -176,9 +190,6 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
   int noAccel = 0, noDecel = 0, noStop = 0;
   double twSumSpeed = 0.0, totalTravelTime = 0.0, totalWaitTime = 0.0;
 
-  if (!_gsl_initizalized)
-    initialize_gsl();
-
   /* First Pass: Compute the number of instants of the result */
 
   for (i = 0; i < noEdges; i++)
@@ -197,10 +208,19 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
       p1 = p2;
     }
   }
+  /* The initial position and the stops at the crossings */
+  noInstants += noEdges + 1;
   instants = palloc(sizeof(TInstant *) * noInstants);
 
   /* Second Pass: Compute the result */
   srid = lines[0]->srid;
+  LWPOINT *lwpoint = lwpoint_make2d(srid, 0, 0);
+  Datum point = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
+  lwpoint_free(lwpoint);
+  template = tinstant_make(point, startTime, type_oid(T_GEOMETRY));
+  pfree(DatumGetPointer(point));
+  instsize = double_pad(VARSIZE(template));
+  block = palloc(instsize * noInstants);
   p1 = getPoint2d(lines[0]->points, 0);
   curPos = p1;
   t = startTime;
@@ -270,9 +290,9 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
           /* If the current speed is not considered as a stop, with
            * a probability proportional to 1/maxSpeedEdge apply a
            * deceleration event (p=90%) or a stop event (p=10%) */
-          if (gsl_rng_uniform(_rng) <= P_EVENT_C / maxSpeedEdge)
+          if (gsl_rng_uniform(rng) <= P_EVENT_C / maxSpeedEdge)
           {
-            if (gsl_rng_uniform(_rng) <= P_EVENT_P)
+            if (gsl_rng_uniform(rng) <= P_EVENT_P)
             {
               /* Apply stop event */
               curSpeed = 0.0;
@@ -284,7 +304,7 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
             else
             {
               /* Apply deceleration event */
-              curSpeed = curSpeed * gsl_ran_binomial(_rng, 0.5, 20) / 20.0;
+              curSpeed = curSpeed * gsl_ran_binomial(rng, 0.5, 20) / 20.0;
               noDecel++;
               if (verbosity == 3)
                 ereport(INFO, (errcode(ERRCODE_SUCCESSFUL_COMPLETION),
@@ -330,7 +350,7 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
         /* If speed is zero add a wait time */
         if (curSpeed < P_EPSILON_SPEED)
         {
-          waitTime = gsl_ran_exponential(_rng, P_DEST_EXPMU);
+          waitTime = gsl_ran_exponential(rng, P_DEST_EXPMU);
           if (waitTime < P_EPSILON)
             waitTime = P_DEST_EXPMU;
           t = t + (int) (waitTime * 1e6) ; /* microseconds */
@@ -349,9 +369,9 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
             curPos.y = p1.y + ((p2.y - p1.y) * fraction * (k + 1));
             if (disturbData)
             {
-              dx = (2.0 * P_GPS_STEPMAXERR * gsl_rng_uniform(_rng)) -
+              dx = (2.0 * P_GPS_STEPMAXERR * gsl_rng_uniform(rng)) -
                 P_GPS_STEPMAXERR;
-              dy = (2.0 * P_GPS_STEPMAXERR * gsl_rng_uniform(_rng)) -
+              dy = (2.0 * P_GPS_STEPMAXERR * gsl_rng_uniform(rng)) -
                 P_GPS_STEPMAXERR;
               errx += dx;
               erry += dy;
@@ -391,10 +411,10 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
     if (curSpeed > P_EPSILON_SPEED && i < noEdges - 1)
     {
       int nextCategory = categories[i + 1];
-      if (gsl_rng_uniform(_rng) <= P_DEST_STOPPROB[category][nextCategory])
+      if (gsl_rng_uniform(rng) <= P_DEST_STOPPROB[category][nextCategory])
       {
         curSpeed = 0.0;
-        waitTime = gsl_ran_exponential(_rng, P_DEST_EXPMU);
+        waitTime = gsl_ran_exponential(rng, P_DEST_EXPMU);
         if (waitTime < P_EPSILON)
           waitTime = P_DEST_EXPMU;
         t = t + (int) (waitTime * 1e6); /* microseconds */
@@ -407,6 +427,9 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
   }
   TSequence *result = tsequence_make(instants, l, true, true,
     LINEAR, NORMALIZE);
+  pfree(instants);
+  pfree(block);
+  pfree(template);
 
   /* Display the statistics of the trip */
   if (verbosity >= 2)
@@ -434,30 +457,25 @@ create_trip_internal(LWLINE **lines, const double *maxSpeeds, const int *categor
         errmsg("    ------------------------------------------")));
   }
 
-  for (i = 0; i < noEdges; i++)
-    lwgeom_free(lwline_as_lwgeom(lines[i]));
-  pfree(lines);
   return result;
 }
 
-PG_FUNCTION_INFO_V1(create_trip);
 /**
- * Create a trip using the BerlinMOD data generator
+ * Extract the edges of the paths from an array of records composed of a
+ * linestring, a maximum speed, and a category
+ *
+ * @param[in] array Array of records
+ * @param[out] lines, maxSpeeds, categories Edges of the paths
+ * @result Number of edges
  */
-Datum
-create_trip(PG_FUNCTION_ARGS)
+static int
+edges_extract(ArrayType *array, LWLINE ***lines, double **maxSpeeds,
+  int **categories)
 {
-  ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
   ensure_non_empty_array(array);
   if (ARR_NDIM(array) > 1)
     ereport(ERROR, (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR), 
       errmsg("1-dimensional array needed")));
-  TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
-  bool disturbData = PG_GETARG_BOOL(2);
-  // int32 messages = PG_GETARG_INT32(3);
-  text *messages = PG_GETARG_TEXT_PP(3);
-  char* msgstr = text_to_cstring(messages);
-  int32 msg = 0; /* 'minimal' by default */
   Datum *datums;
   bool *nulls;
   int count;
@@ -481,89 +499,243 @@ create_trip(PG_FUNCTION_ARGS)
   /* Verify the type of the attributes */
   att = TupleDescAttr(tupdesc, 0);
   if (att->atttypid != type_oid(T_GEOMETRY))
-  {
-    PG_FREE_IF_COPY(array, 0);
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
       errmsg("First element of the record must be of type geometry")));
-  }
   att = TupleDescAttr(tupdesc, 1);
   if (att->atttypid != FLOAT8OID)
-  {
-    PG_FREE_IF_COPY(array, 0);
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
       errmsg("Second element of the record must be of type double precision")));
-  }
   att = TupleDescAttr(tupdesc, 2);
   if (att->atttypid != INT4OID)
-  {
-    PG_FREE_IF_COPY(array, 0);
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
       errmsg("Third element of the record must be of type integer")));
-  }
   ReleaseTupleDesc(tupdesc);
 
-  LWLINE **lines = palloc(sizeof(LWLINE *) * count);
-  double *maxSpeeds = palloc(sizeof(double) * count);
-  int *categories = palloc(sizeof(int) * count);
+  *lines = palloc(sizeof(LWLINE *) * count);
+  *maxSpeeds = palloc(sizeof(double) * count);
+  *categories = palloc(sizeof(int) * count);
   for (int i = 0; i < count; i++)
   {
     if (nulls[i])
-    {
-      PG_FREE_IF_COPY(array, 0);
       ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
         errmsg("Elements of the array cannot be NULL")));
-    }
-    else
-    {
-      td = DatumGetHeapTupleHeader(datums[i]);
-      /* First Attribute: Linestring */
-      GSERIALIZED *gs = (GSERIALIZED *)PG_DETOAST_DATUM(GetAttributeByNum(td, 1, &isNull));
-      if (isNull)
-      {
-        PG_FREE_IF_COPY(array, 0);
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-          errmsg("Elements of the record cannot be NULL")));
-      }
-      if (gserialized_get_type(gs) != LINETYPE)
-      {
-        PG_FREE_IF_COPY(array, 0);
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-          errmsg("Geometry must be a linestring")));
-      }
-      lines[i] = lwgeom_as_lwline(lwgeom_from_gserialized(gs));
-      /* Second Attribute: Maximum Speed */
-      maxSpeeds[i] = DatumGetFloat8(GetAttributeByNum(td, 2, &isNull));
-      if (isNull)
-      {
-        PG_FREE_IF_COPY(array, 0);
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-          errmsg("Elements of the record cannot be NULL")));
-      }
-      /* Third Attribute: Category */
-      categories[i] = DatumGetInt32(GetAttributeByNum(td, 3, &isNull));
-      if (isNull)
-      {
-        PG_FREE_IF_COPY(array, 0);
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-          errmsg("Elements of the record cannot be NULL")));
-      }
-    }
+    td = DatumGetHeapTupleHeader(datums[i]);
+    /* First Attribute: Linestring */
+    Datum value = GetAttributeByNum(td, 1, &isNull);
+    if (isNull)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("Elements of the record cannot be NULL")));
+    GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(value);
+    if (gserialized_get_type(gs) != LINETYPE)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("Geometry must be a linestring")));
+    (*lines)[i] = lwgeom_as_lwline(lwgeom_from_gserialized(gs));
+    /* Second Attribute: Maximum Speed */
+    (*maxSpeeds)[i] = DatumGetFloat8(GetAttributeByNum(td, 2, &isNull));
+    if (isNull)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("Elements of the record cannot be NULL")));
+    /* Third Attribute: Category */
+    (*categories)[i] = DatumGetInt32(GetAttributeByNum(td, 3, &isNull));
+    if (isNull)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("Elements of the record cannot be NULL")));
   }
+  pfree(datums);
+  pfree(nulls);
+  return count;
+}
 
-  if (strcmp(msgstr, "minimal") == 0)
-    msg = 0;
-  else if (strcmp(msgstr, "medium") == 0)
-    msg = 1;
+/**
+ * Free the edges of the paths
+ */
+static void
+edges_free(LWLINE **lines, double *maxSpeeds, int *categories, int count)
+{
+  for (int i = 0; i < count; i++)
+    lwgeom_free(lwline_as_lwgeom(lines[i]));
+  pfree(lines);
+  pfree(maxSpeeds);
+  pfree(categories);
+  return;
+}
+
+/**
+ * Returns the level of the messages from its name
+ */
+static int
+verbosity_from_text(text *messages)
+{
+  char *msgstr = text_to_cstring(messages);
+  int result = 0; /* 'minimal' by default */
+  if (strcmp(msgstr, "medium") == 0)
+    result = 1;
   else if (strcmp(msgstr, "verbose") == 0)
-    msg = 2;
+    result = 2;
   else if (strcmp(msgstr, "debug") == 0)
-    msg = 3;
+    result = 3;
+  pfree(msgstr);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(create_trip);
+/**
+ * Create a trip using the BerlinMOD data generator
+ */
+Datum
+create_trip(PG_FUNCTION_ARGS)
+{
+  ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+  bool disturbData = PG_GETARG_BOOL(2);
+  int msg = verbosity_from_text(PG_GETARG_TEXT_PP(3));
+  LWLINE **lines;
+  double *maxSpeeds;
+  int *categories;
+  int count = edges_extract(array, &lines, &maxSpeeds, &categories);
 
-  TSequence *result = create_trip_internal(lines, maxSpeeds, categories,
-    (uint32_t) count, t, disturbData, msg);
+  if (!_gsl_initizalized)
+    initialize_gsl();
+  TSequence *result = create_trip_internal(_rng, lines, maxSpeeds,
+    categories, (uint32_t) count, t, disturbData, msg);
 
+  edges_free(lines, maxSpeeds, categories, count);
   PG_FREE_IF_COPY(array, 0);
   PG_RETURN_POINTER(result);
 }
 
 /*****************************************************************************/
+
+/**
+ * Structure to represent the state of the batch generation of trips
+ */
+typedef struct
+{
+  gsl_rng *rng;           /**< Random number generator of the batch */
+  uint64 seed;            /**< Seed of the batch */
+  LWLINE **lines;         /**< Linestrings of the edges of all the paths */
+  double *maxSpeeds;      /**< Maximum speeds of the edges */
+  int *categories;        /**< Categories of the edges */
+  int *offsets;           /**< Position of the first edge of each path */
+  int *noEdges;           /**< Number of edges of each path */
+  TimestampTz *times;     /**< Start time of each trip */
+  bool disturbData;       /**< True when GPS errors are simulated */
+  int verbosity;          /**< Level of the messages */
+} CreateTripsState;
+
+/**
+ * Returns the seed of the random numbers of a trip computed from the seed
+ * of the batch and the number of the trip using the SplitMix64 finalizer,
+ * so that consecutive trips have unrelated streams
+ */
+static unsigned long
+trip_seed(uint64 seed, uint64 trip)
+{
+  uint64 z = seed + (trip + 1) * UINT64CONST(0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * UINT64CONST(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * UINT64CONST(0x94D049BB133111EB);
+  z ^= z >> 31;
+  /* The Mersenne twister only uses the lower 32 bits of the seed */
+  return (unsigned long) ((z ^ (z >> 32)) & 0xFFFFFFFF);
+}
+
+/**
+ * Callback freeing the random number generator of the batch generation
+ * of trips when the memory context of the function is reset
+ */
+static void
+create_trips_reset(void *arg)
+{
+  gsl_rng_free((gsl_rng *) arg);
+  return;
+}
+
+PG_FUNCTION_INFO_V1(create_trips);
+/**
+ * Create a batch of trips using the BerlinMOD data generator
+ *
+ * The edges of the paths of all the trips are given in a single array
+ * together with the number of edges of each path and the start time of each
+ * trip. The random numbers of the i-th trip of the batch only depend on the
+ * seed and on i, so that the result is the same regardless of the
+ * worker or the order in which the batches are generated.
+ */
+PGDLLEXPORT Datum
+create_trips(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  CreateTripsState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    funcctx = SRF_FIRSTCALL_INIT();
+    MemoryContext oldcontext =
+      MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    ArrayType *edges = PG_GETARG_ARRAYTYPE_P(0);
+    ArrayType *counts = PG_GETARG_ARRAYTYPE_P(1);
+    ArrayType *starts = PG_GETARG_ARRAYTYPE_P(2);
+    ensure_non_empty_array(counts);
+    ensure_non_empty_array(starts);
+    state = palloc0(sizeof(CreateTripsState));
+    int count = edges_extract(edges, &state->lines, &state->maxSpeeds,
+      &state->categories);
+    int notrips, count1;
+    Datum *values = datumarr_extract(counts, &notrips);
+    state->times = timestamparr_extract(starts, &count1);
+    if (notrips != count1)
+      ereport(ERROR, (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+        errmsg("The input arrays must have the same number of elements")));
+    state->noEdges = palloc(sizeof(int) * notrips);
+    state->offsets = palloc(sizeof(int) * notrips);
+    int offset = 0;
+    for (int i = 0; i < notrips; i++)
+    {
+      state->noEdges[i] = DatumGetInt32(values[i]);
+      state->offsets[i] = offset;
+      if (state->noEdges[i] <= 0 || offset + state->noEdges[i] > count)
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+          errmsg("The number of edges of the paths do not match the array of edges")));
+      offset += state->noEdges[i];
+    }
+    if (offset != count)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The number of edges of the paths do not match the array of edges")));
+    pfree(values);
+    state->seed = (uint64) PG_GETARG_INT64(3);
+    state->disturbData = PG_GETARG_BOOL(4);
+    state->verbosity = verbosity_from_text(PG_GETARG_TEXT_PP(5));
+    /* The generator does not depend on the GSL_RNG_TYPE environment
+     * variable so that the result is reproducible */
+    state->rng = gsl_rng_alloc(gsl_rng_mt19937);
+    MemoryContextCallback *callback =
+      palloc(sizeof(MemoryContextCallback));
+    callback->func = create_trips_reset;
+    callback->arg = state->rng;
+    MemoryContextRegisterResetCallback(funcctx->multi_call_memory_ctx,
+      callback);
+    funcctx->user_fctx = state;
+    funcctx->max_calls = notrips;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (CreateTripsState *) funcctx->user_fctx;
+  if (funcctx->call_cntr < funcctx->max_calls)
+  {
+    int i = (int) funcctx->call_cntr;
+    if (state->verbosity >= 1)
+      ereport(INFO, (errcode(ERRCODE_SUCCESSFUL_COMPLETION),
+        errmsg("    Trip %d", i + 1)));
+    gsl_rng_set(state->rng, trip_seed(state->seed, (uint64) i));
+    int offset = state->offsets[i];
+    TSequence *result = create_trip_internal(state->rng,
+      &state->lines[offset], &state->maxSpeeds[offset],
+      &state->categories[offset], (uint32_t) state->noEdges[i],
+      state->times[i], state->disturbData, state->verbosity);
+    SRF_RETURN_NEXT(funcctx, PointerGetDatum(result));
+  }
+  SRF_RETURN_DONE(funcctx);
+}
+
+/*****************************************************************************/
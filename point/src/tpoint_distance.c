@@ -129,6 +129,71 @@ lw_dist_sphere_point_dist(const LWGEOM *lw1, const LWGEOM *lw2, int mode,
  * Temporal distance
  *****************************************************************************/
 
+/*
+ * Kernels computing the temporal distance between a temporal geometric
+ * sequence point and a point directly from the coordinates of the instants,
+ * specialized at compile time for 2D and 3D. The coordinates of each instant
+ * are read once and its distance to the point is computed once. A constant
+ * segment needs no special case since its closest point is its start point.
+ */
+
+static inline double
+pt3dz_distance(const POINT3DZ *p1, const POINT3DZ *p2)
+{
+  return distance3d_pt_pt((POINT3D *) p1, (POINT3D *) p2);
+}
+
+static inline int
+pt3dz_same(const POINT3DZ *p1, const POINT3DZ *p2)
+{
+  return p3d_same((POINT3D *) p1, (POINT3D *) p2);
+}
+
+#define DISTANCE_TGEOMPOINTSEQ_POINT(name, POINTTYPE, get_point, \
+    closest_ratio, pt_dist, pt_same) \
+static TSequence * \
+name(const TSequence *seq, Datum point) \
+{ \
+  const POINTTYPE *p = get_point(point); \
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags); \
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count * 2); \
+  int k = 0; \
+  TInstant *inst1 = tsequence_inst_n(seq, 0); \
+  const POINTTYPE *p1 = get_point(tinstant_value(inst1)); \
+  for (int i = 1; i < seq->count; i++) \
+  { \
+    TInstant *inst2 = tsequence_inst_n(seq, i); \
+    const POINTTYPE *p2 = get_point(tinstant_value(inst2)); \
+    instants[k++] = tinstant_make(Float8GetDatum(pt_dist(p, p1)), \
+      inst1->t, FLOAT8OID); \
+    if (linear) \
+    { \
+      POINTTYPE proj; \
+      long double fraction = (long double) closest_ratio(p, p1, p2, &proj); \
+      if (fraction > 0.0 && fraction < 1.0 && ! pt_same(p1, &proj) && \
+        ! pt_same(p2, &proj)) \
+      { \
+        long double duration = (long double) (inst2->t - inst1->t); \
+        TimestampTz time = inst1->t + (long) (duration * fraction); \
+        instants[k++] = tinstant_make(Float8GetDatum(pt_dist(p, &proj)), \
+          time, FLOAT8OID); \
+      } \
+    } \
+    inst1 = inst2; p1 = p2; \
+  } \
+  instants[k++] = tinstant_make(Float8GetDatum(pt_dist(p, p1)), inst1->t, \
+    FLOAT8OID); \
+  return tsequence_make_free(instants, k, seq->period.lower_inc, \
+    seq->period.upper_inc, linear, NORMALIZE); \
+}
+
+DISTANCE_TGEOMPOINTSEQ_POINT(distance_tgeompointseq_point2d, POINT2D,
+  datum_get_point2d_p, closest_point2d_on_segment_ratio, distance2d_pt_pt,
+  p2d_same)
+DISTANCE_TGEOMPOINTSEQ_POINT(distance_tgeompointseq_point3d, POINT3DZ,
+  datum_get_point3dz_p, closest_point3dz_on_segment_ratio, pt3dz_distance,
+  pt3dz_same)
+
 /**
  * Returns the temporal distance between the temporal sequence point and
  * the geometry/geography point
@@ -142,6 +207,12 @@ distance_tpointseq_geo(const TSequence *seq, Datum point,
   Datum (*func)(Datum, Datum))
 {
   int k = 0;
+  /* Temporal geometric points use the kernels above */
+  if (! MOBDB_FLAGS_GET_GEODETIC(seq->flags))
+    return MOBDB_FLAGS_GET_Z(seq->flags) ?
+      distance_tgeompointseq_point3d(seq, point) :
+      distance_tgeompointseq_point2d(seq, point);
+
   TInstant **instants = palloc(sizeof(TInstant *) * seq->count * 2);
   TInstant *inst1 = tsequence_inst_n(seq, 0);
   Datum value1 = tinstant_value(inst1);
@@ -453,8 +524,6 @@ distance_geo_tpoint(PG_FUNCTION_ARGS)
   ensure_point_type(gs);
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *result = distance_tpoint_geo_internal(temp, PointerGetDatum(gs));
   PG_FREE_IF_COPY(gs, 0);
   PG_FREE_IF_COPY(temp, 1);
@@ -476,8 +545,6 @@ distance_tpoint_geo(PG_FUNCTION_ARGS)
   ensure_point_type(gs);
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *result = distance_tpoint_geo_internal(temp, PointerGetDatum(gs));
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(gs, 1);
@@ -520,8 +587,6 @@ distance_tpoint_tpoint(PG_FUNCTION_ARGS)
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   ensure_same_srid_tpoint(temp1, temp2);
   ensure_same_dimensionality_tpoint(temp1, temp2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *result = distance_tpoint_tpoint_internal(temp1, temp2);
   PG_FREE_IF_COPY(temp1, 0);
   PG_FREE_IF_COPY(temp2, 1);
@@ -822,8 +887,6 @@ NAI_tpoint_geo_internal(FunctionCallInfo fcinfo, const Temporal *temp,
 {
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Datum (*func)(Datum, Datum);
   if (MOBDB_FLAGS_GET_GEODETIC(temp->flags))
     func = &geog_distance;
@@ -894,8 +957,6 @@ NAI_tpoint_tpoint(PG_FUNCTION_ARGS)
   ensure_same_srid_tpoint(temp1, temp2);
   ensure_same_dimensionality_tpoint(temp1, temp2);
   TInstant *result = NULL;
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
   if (dist != NULL)
   {
@@ -934,17 +995,17 @@ NAD_tpoint_geo_internal(FunctionCallInfo fcinfo, Temporal *temp,
 {
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Datum (*func)(Datum, Datum);
   if (MOBDB_FLAGS_GET_GEODETIC(temp->flags))
     func = &geog_distance;
   else
     func = MOBDB_FLAGS_GET_Z(temp->flags) ? &geom_distance3d :
       &geom_distance2d;
-  Datum traj = tpoint_trajectory_internal(temp);
+  bool tofree;
+  Datum traj = tpoint_trajectory_cached(fcinfo->flinfo, temp, &tofree);
   Datum result = func(traj, PointerGetDatum(gs));
-  pfree(DatumGetPointer(traj));
+  if (tofree)
+    pfree(DatumGetPointer(traj));
   return result;
 }
 
@@ -994,8 +1055,6 @@ NAD_stbox_geo_internal(FunctionCallInfo fcinfo, STBOX *box,
 {
   ensure_same_srid_stbox_gs(box, gs);
   ensure_same_spatial_dimensionality_stbox_gs(box, gs);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   bool hasz = MOBDB_FLAGS_GET_Z(box->flags);
   Datum (*func)(Datum, Datum);
   if (MOBDB_FLAGS_GET_GEODETIC(box->flags))
@@ -1119,8 +1178,6 @@ NAD_stbox_stbox(PG_FUNCTION_ARGS)
 {
   STBOX *box1 = PG_GETARG_STBOX_P(0);
   STBOX *box2 = PG_GETARG_STBOX_P(1);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   double result = NAD_stbox_stbox_internal(box1, box2);
   if (result == DBL_MAX)
     PG_RETURN_NULL();
@@ -1191,8 +1248,6 @@ NAD_stbox_tpoint(PG_FUNCTION_ARGS)
 {
   STBOX *box = PG_GETARG_STBOX_P(0);
   Temporal *temp = PG_GETARG_TEMPORAL(1);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   double result = NAD_tpoint_stbox_internal(temp, box);
   PG_FREE_IF_COPY(temp, 1);
   if (result == DBL_MAX)
@@ -1210,8 +1265,6 @@ NAD_tpoint_stbox(PG_FUNCTION_ARGS)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   STBOX *box = PG_GETARG_STBOX_P(1);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   double result = NAD_tpoint_stbox_internal(temp, box);
   PG_FREE_IF_COPY(temp, 0);
   if (result == DBL_MAX)
@@ -1230,8 +1283,6 @@ NAD_tpoint_tpoint(PG_FUNCTION_ARGS)
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   ensure_same_srid_tpoint(temp1, temp2);
   ensure_same_dimensionality_tpoint(temp1, temp2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
   if (dist == NULL)
   {
@@ -1266,7 +1317,13 @@ shortestline_tpoint_geo_internal(Temporal *temp, GSERIALIZED *gs)
   Datum traj = tpoint_trajectory_internal(temp);
   Datum result;
   if (geodetic)
-    result = call_function2(geography_shortestline, traj, PointerGetDatum(gs));
+  {
+    /* The circle tree of the geography is kept across calls */
+    static FmgrInfo *flinfo = NULL;
+    result = CallerFInfoFunctionCall3(geography_shortestline,
+      postgis_flinfo(&flinfo, geography_shortestline, 3), InvalidOid, traj,
+      PointerGetDatum(gs), BoolGetDatum(geodetic_use_spheroid));
+  }
   else
     result = MOBDB_FLAGS_GET_Z(temp->flags) ?
       call_function2(LWGEOM_shortestline3d, traj, PointerGetDatum(gs)) :
@@ -1344,8 +1401,6 @@ shortestline_tpoint_tpoint(PG_FUNCTION_ARGS)
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   ensure_same_srid_tpoint(temp1, temp2);
   ensure_same_dimensionality_tpoint(temp1, temp2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Datum result;
   bool found = shortestline_tpoint_tpoint_internal(temp1, temp2, &result);
   PG_FREE_IF_COPY(temp1, 0);
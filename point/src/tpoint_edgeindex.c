@@ -0,0 +1,835 @@
+/*****************************************************************************
+ *
+ * tpoint_edgeindex.c
+ *    Index of the edges of a polygonal geometry for clipping segments.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file tpoint_edgeindex.c
+ * Restricting a temporal point to a polygon computes for each segment of
+ * the trajectory its intersection with the polygon, which costs a time
+ * linear in the number of vertices of the polygon. For polygons with many
+ * vertices, such as administrative regions, the edges of the polygon are
+ * kept in an R-tree packed with the Sort-Tile-Recursive algorithm. Each
+ * segment of the trajectory then only tests the edges whose box overlaps
+ * the box of the segment to find the fractions of the segment at which it
+ * enters or leaves the polygon, and the edges crossed by a horizontal ray
+ * to locate a point with respect to the polygon.
+ *
+ * The last index built is kept in a memory context of the backend together
+ * with a copy of its geometry. Therefore, the index of a constant geometry
+ * is built once and reused for all the rows of a query.
+ *
+ * When the extension is loaded with shared_preload_libraries and the
+ * parameter mobilitydb.edgeindex_cache_size is not 0, the indexes are also
+ * kept in shared memory in a flat representation, so that the queries of
+ * all backends on the same geometry, such as the zones of an application,
+ * only copy the index instead of building it. The least recently used
+ * indexes are evicted when the cache is full.
+ */
+
+#include "tpoint_edgeindex.h"
+
+#include <float.h>
+#include <math.h>
+#if MOBDB_PGSQL_VERSION < 130000
+#include <access/hash.h>
+#else
+#include <common/hashfn.h>
+#endif
+#include <miscadmin.h>
+#include <port/atomics.h>
+#include <storage/ipc.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/memutils.h>
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the boxes of the nodes of the index
+ */
+typedef struct
+{
+  double      xmin, ymin;
+  double      xmax, ymax;
+} EdgeBox;
+
+/**
+ * Structure to represent the index. The nodes of a level are the groups of
+ * consecutive nodes of the level below, level 0 being the edges.
+ */
+struct EdgeIndex
+{
+  int         nedges;      /**< number of edges */
+  POINT2D    *points;      /**< start and end points of the edges */
+  int         nlevels;     /**< number of levels of the tree */
+  int        *counts;      /**< number of nodes of each level */
+  EdgeBox   **boxes;       /**< boxes of the nodes of each level */
+};
+
+/**
+ * Structure to represent the fractions of a segment at which its location
+ * with respect to the polygon may change
+ */
+typedef struct
+{
+  double      fraction;    /**< fraction of the segment */
+  bool        boundary;    /**< true if the point is on the boundary */
+} EdgeFraction;
+
+/** Memory context of the cached index */
+static MemoryContext edgeindex_context = NULL;
+/** Copy of the geometry of the cached index, NULL if none */
+static GSERIALIZED *edgeindex_geom = NULL;
+/** Cached index, NULL if the geometry does not have an index */
+static EdgeIndex *edgeindex_cached = NULL;
+
+/**
+ * Global variable that states the size in kilobytes of the shared cache of
+ * the indexes. It is set by the configuration parameter
+ * mobilitydb.edgeindex_cache_size, 0 disables the cache.
+ */
+int edgeindex_cache_size = 0;
+
+/**
+ * Structure to represent an entry of the shared cache. The data of the entry
+ * is the geometry followed by the flat representation of its index.
+ */
+typedef struct
+{
+  uint32      hash;        /**< hash of the geometry */
+  Size        geomsize;    /**< size of the geometry */
+  Size        offset;      /**< offset of the data in the data area */
+  Size        size;        /**< size of the data */
+  pg_atomic_uint64 lastused; /**< clock value of the last use */
+} EdgeIndexEntry;
+
+/**
+ * Structure to represent the shared cache, followed by its data area
+ */
+typedef struct
+{
+  LWLock     *lock;        /**< lock protecting the cache */
+  Size        capacity;    /**< size of the data area */
+  Size        used;        /**< size of the data of the entries */
+  int         count;       /**< number of entries */
+  pg_atomic_uint64 clock;  /**< clock of the uses of the entries */
+  EdgeIndexEntry entries[EDGEINDEX_CACHE_ENTRIES]; /**< entries */
+} EdgeIndexCache;
+
+/** Shared cache, NULL if it is not enabled */
+static EdgeIndexCache *edgeindex_shared = NULL;
+/** Previous shared memory startup hook */
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+/*****************************************************************************
+ * Construction of the index
+ *****************************************************************************/
+
+/**
+ * Comparator of the edges on the X coordinate of their center
+ */
+static int
+edge_center_x_cmp(const void *a, const void *b)
+{
+  const POINT2D *e1 = (const POINT2D *) a;
+  const POINT2D *e2 = (const POINT2D *) b;
+  double x1 = e1[0].x + e1[1].x, x2 = e2[0].x + e2[1].x;
+  if (x1 == x2)
+    return 0;
+  return (x1 < x2) ? -1 : 1;
+}
+
+/**
+ * Comparator of the edges on the Y coordinate of their center
+ */
+static int
+edge_center_y_cmp(const void *a, const void *b)
+{
+  const POINT2D *e1 = (const POINT2D *) a;
+  const POINT2D *e2 = (const POINT2D *) b;
+  double y1 = e1[0].y + e1[1].y, y2 = e2[0].y + e2[1].y;
+  if (y1 == y2)
+    return 0;
+  return (y1 < y2) ? -1 : 1;
+}
+
+/**
+ * Returns the index of the edges of the polygonal geometry, or NULL if
+ * the geometry is not polygonal or has too few edges
+ *
+ * The index is allocated in the current memory context and is not cached.
+ */
+EdgeIndex *
+edgeindex_build(const GSERIALIZED *gs)
+{
+  int type = gserialized_get_type(gs);
+  if ((type != POLYGONTYPE && type != MULTIPOLYGONTYPE) ||
+    FLAGS_GET_Z(gs->flags))
+    return NULL;
+
+  LWGEOM *lwgeom = lwgeom_from_gserialized(gs);
+  LWPOLY *poly, **polys;
+  int npolys;
+  if (type == POLYGONTYPE)
+  {
+    poly = lwgeom_as_lwpoly(lwgeom);
+    polys = &poly;
+    npolys = 1;
+  }
+  else
+  {
+    LWMPOLY *mpoly = lwgeom_as_lwmpoly(lwgeom);
+    polys = mpoly->geoms;
+    npolys = (int) mpoly->ngeoms;
+  }
+  int nedges = 0;
+  for (int i = 0; i < npolys; i++)
+    for (uint32_t j = 0; j < polys[i]->nrings; j++)
+      if (polys[i]->rings[j]->npoints > 1)
+        nedges += polys[i]->rings[j]->npoints - 1;
+  if (nedges < EDGEINDEX_MIN_EDGES)
+  {
+    lwgeom_free(lwgeom);
+    return NULL;
+  }
+
+  EdgeIndex *result = palloc(sizeof(EdgeIndex));
+  result->nedges = nedges;
+  result->points = palloc(sizeof(POINT2D) * 2 * nedges);
+  int k = 0;
+  for (int i = 0; i < npolys; i++)
+  {
+    for (uint32_t j = 0; j < polys[i]->nrings; j++)
+    {
+      const POINTARRAY *pa = polys[i]->rings[j];
+      for (uint32_t l = 1; l < pa->npoints; l++)
+      {
+        result->points[k++] = *getPoint2d_cp(pa, l - 1);
+        result->points[k++] = *getPoint2d_cp(pa, l);
+      }
+    }
+  }
+  lwgeom_free(lwgeom);
+
+  /* Sort the edges into vertical slices and then each slice on Y */
+  int nleaves = (nedges + EDGEINDEX_NODE_SIZE - 1) / EDGEINDEX_NODE_SIZE;
+  int slicesize = (int) ceil(sqrt((double) nleaves)) * EDGEINDEX_NODE_SIZE;
+  qsort(result->points, nedges, sizeof(POINT2D) * 2, &edge_center_x_cmp);
+  for (int i = 0; i < nedges; i += slicesize)
+    qsort(&result->points[2 * i], Min(slicesize, nedges - i),
+      sizeof(POINT2D) * 2, &edge_center_y_cmp);
+
+  /* Build the levels of the tree bottom-up */
+  int nlevels = 1;
+  for (int n = nedges; n > 1; n = (n + EDGEINDEX_NODE_SIZE - 1) /
+      EDGEINDEX_NODE_SIZE)
+    nlevels++;
+  result->nlevels = nlevels;
+  result->counts = palloc(sizeof(int) * nlevels);
+  result->boxes = palloc(sizeof(EdgeBox *) * nlevels);
+  result->counts[0] = nedges;
+  result->boxes[0] = palloc(sizeof(EdgeBox) * nedges);
+  for (int i = 0; i < nedges; i++)
+  {
+    const POINT2D *a = &result->points[2 * i], *b = &result->points[2 * i + 1];
+    EdgeBox *box = &result->boxes[0][i];
+    box->xmin = Min(a->x, b->x); box->xmax = Max(a->x, b->x);
+    box->ymin = Min(a->y, b->y); box->ymax = Max(a->y, b->y);
+  }
+  for (int l = 1; l < nlevels; l++)
+  {
+    int count = (result->counts[l - 1] + EDGEINDEX_NODE_SIZE - 1) /
+      EDGEINDEX_NODE_SIZE;
+    result->counts[l] = count;
+    result->boxes[l] = palloc(sizeof(EdgeBox) * count);
+    for (int i = 0; i < count; i++)
+    {
+      EdgeBox *box = &result->boxes[l][i];
+      int last = Min((i + 1) * EDGEINDEX_NODE_SIZE, result->counts[l - 1]);
+      *box = result->boxes[l - 1][i * EDGEINDEX_NODE_SIZE];
+      for (int j = i * EDGEINDEX_NODE_SIZE + 1; j < last; j++)
+      {
+        const EdgeBox *child = &result->boxes[l - 1][j];
+        box->xmin = Min(box->xmin, child->xmin);
+        box->xmax = Max(box->xmax, child->xmax);
+        box->ymin = Min(box->ymin, child->ymin);
+        box->ymax = Max(box->ymax, child->ymax);
+      }
+    }
+  }
+  return result;
+}
+
+/*****************************************************************************
+ * Shared cache of the indexes
+ *****************************************************************************/
+
+/**
+ * Returns the size of the flat representation of the index
+ */
+static Size
+edgeindex_flat_size(const EdgeIndex *index)
+{
+  Size result = MAXALIGN(sizeof(int) * (2 + index->nlevels)) +
+    sizeof(POINT2D) * 2 * index->nedges;
+  for (int i = 0; i < index->nlevels; i++)
+    result += sizeof(EdgeBox) * index->counts[i];
+  return result;
+}
+
+/**
+ * Writes the flat representation of the index into the buffer
+ */
+static void
+edgeindex_flatten(const EdgeIndex *index, char *buf)
+{
+  int *header = (int *) buf;
+  header[0] = index->nedges;
+  header[1] = index->nlevels;
+  memcpy(&header[2], index->counts, sizeof(int) * index->nlevels);
+  char *ptr = buf + MAXALIGN(sizeof(int) * (2 + index->nlevels));
+  memcpy(ptr, index->points, sizeof(POINT2D) * 2 * index->nedges);
+  ptr += sizeof(POINT2D) * 2 * index->nedges;
+  for (int i = 0; i < index->nlevels; i++)
+  {
+    memcpy(ptr, index->boxes[i], sizeof(EdgeBox) * index->counts[i]);
+    ptr += sizeof(EdgeBox) * index->counts[i];
+  }
+}
+
+/**
+ * Returns the index from a copy of its flat representation allocated in
+ * the current memory context
+ */
+static EdgeIndex *
+edgeindex_unflatten(const char *buf, Size size)
+{
+  char *copy = palloc(size);
+  memcpy(copy, buf, size);
+  int *header = (int *) copy;
+  EdgeIndex *result = palloc(sizeof(EdgeIndex));
+  result->nedges = header[0];
+  result->nlevels = header[1];
+  result->counts = &header[2];
+  result->boxes = palloc(sizeof(EdgeBox *) * result->nlevels);
+  char *ptr = copy + MAXALIGN(sizeof(int) * (2 + result->nlevels));
+  result->points = (POINT2D *) ptr;
+  ptr += sizeof(POINT2D) * 2 * result->nedges;
+  for (int i = 0; i < result->nlevels; i++)
+  {
+    result->boxes[i] = (EdgeBox *) ptr;
+    ptr += sizeof(EdgeBox) * result->counts[i];
+  }
+  return result;
+}
+
+/**
+ * Returns the size of the shared memory of the cache
+ */
+static Size
+edgeindex_shmem_size(void)
+{
+  return add_size(MAXALIGN(sizeof(EdgeIndexCache)),
+    mul_size((Size) edgeindex_cache_size, 1024));
+}
+
+/**
+ * Returns a pointer to the data of the entry of the shared cache
+ */
+static char *
+edgeindex_entry_data(const EdgeIndexEntry *entry)
+{
+  return (char *) edgeindex_shared + MAXALIGN(sizeof(EdgeIndexCache)) +
+    entry->offset;
+}
+
+/**
+ * Returns the position of the entry of the shared cache for the geometry,
+ * or -1 if it is not found
+ *
+ * @pre The lock of the cache is held
+ */
+static int
+edgeindex_shared_find(uint32 hash, const GSERIALIZED *gs)
+{
+  for (int i = 0; i < edgeindex_shared->count; i++)
+  {
+    const EdgeIndexEntry *entry = &edgeindex_shared->entries[i];
+    if (entry->hash == hash && entry->geomsize == VARSIZE(gs) &&
+        memcmp(edgeindex_entry_data(entry), gs, VARSIZE(gs)) == 0)
+      return i;
+  }
+  return -1;
+}
+
+/**
+ * Comparator of the positions of the entries of the shared cache on the
+ * offset of their data
+ */
+static int
+edgeindex_entry_offset_cmp(const void *a, const void *b)
+{
+  Size offset1 = edgeindex_shared->entries[*(const int *) a].offset;
+  Size offset2 = edgeindex_shared->entries[*(const int *) b].offset;
+  if (offset1 == offset2)
+    return 0;
+  return (offset1 < offset2) ? -1 : 1;
+}
+
+/**
+ * Moves the entry of the shared cache to another position
+ */
+static void
+edgeindex_entry_move(EdgeIndexEntry *dest, EdgeIndexEntry *src)
+{
+  if (dest == src)
+    return;
+  dest->hash = src->hash;
+  dest->geomsize = src->geomsize;
+  dest->offset = src->offset;
+  dest->size = src->size;
+  pg_atomic_write_u64(&dest->lastused,
+    pg_atomic_read_u64(&src->lastused));
+}
+
+/**
+ * Returns the index of the geometry copied from the shared cache into the
+ * current memory context, or NULL if it is not in the cache
+ */
+static EdgeIndex *
+edgeindex_shared_get(uint32 hash, const GSERIALIZED *gs)
+{
+  EdgeIndex *result = NULL;
+  LWLockAcquire(edgeindex_shared->lock, LW_SHARED);
+  int i = edgeindex_shared_find(hash, gs);
+  if (i >= 0)
+  {
+    EdgeIndexEntry *entry = &edgeindex_shared->entries[i];
+    Size geomsize = MAXALIGN(entry->geomsize);
+    result = edgeindex_unflatten(edgeindex_entry_data(entry) + geomsize,
+      entry->size - geomsize);
+    pg_atomic_write_u64(&entry->lastused,
+      pg_atomic_fetch_add_u64(&edgeindex_shared->clock, 1));
+  }
+  LWLockRelease(edgeindex_shared->lock);
+  return result;
+}
+
+/**
+ * Adds the index of the geometry to the shared cache, evicting the least
+ * recently used entries if needed
+ */
+static void
+edgeindex_shared_add(uint32 hash, const GSERIALIZED *gs,
+  const EdgeIndex *index)
+{
+  Size geomsize = MAXALIGN(VARSIZE(gs));
+  Size size = geomsize + edgeindex_flat_size(index);
+  /* An entry may not take more than a quarter of the cache */
+  if (size > edgeindex_shared->capacity / 4)
+    return;
+
+  LWLockAcquire(edgeindex_shared->lock, LW_EXCLUSIVE);
+  /* The index may have been added by another backend */
+  if (edgeindex_shared_find(hash, gs) >= 0)
+  {
+    LWLockRelease(edgeindex_shared->lock);
+    return;
+  }
+  bool evicted = false;
+  while (edgeindex_shared->count == EDGEINDEX_CACHE_ENTRIES ||
+    edgeindex_shared->used + size > edgeindex_shared->capacity)
+  {
+    int lru = 0;
+    for (int i = 1; i < edgeindex_shared->count; i++)
+      if (pg_atomic_read_u64(&edgeindex_shared->entries[i].lastused) <
+          pg_atomic_read_u64(&edgeindex_shared->entries[lru].lastused))
+        lru = i;
+    edgeindex_shared->used -= edgeindex_shared->entries[lru].size;
+    edgeindex_entry_move(&edgeindex_shared->entries[lru],
+      &edgeindex_shared->entries[--edgeindex_shared->count]);
+    evicted = true;
+  }
+  /* Compact the data of the remaining entries in the order of their offset */
+  if (evicted && edgeindex_shared->count > 0)
+  {
+    int *order = palloc(sizeof(int) * edgeindex_shared->count);
+    for (int i = 0; i < edgeindex_shared->count; i++)
+      order[i] = i;
+    qsort(order, edgeindex_shared->count, sizeof(int),
+      &edgeindex_entry_offset_cmp);
+    Size offset = 0;
+    for (int i = 0; i < edgeindex_shared->count; i++)
+    {
+      EdgeIndexEntry *entry = &edgeindex_shared->entries[order[i]];
+      if (entry->offset != offset)
+      {
+        char *data = edgeindex_entry_data(entry);
+        entry->offset = offset;
+        memmove(edgeindex_entry_data(entry), data, entry->size);
+      }
+      offset += entry->size;
+    }
+    pfree(order);
+  }
+  EdgeIndexEntry *entry = &edgeindex_shared->entries[edgeindex_shared->count++];
+  entry->hash = hash;
+  entry->geomsize = VARSIZE(gs);
+  entry->offset = edgeindex_shared->used;
+  entry->size = size;
+  pg_atomic_write_u64(&entry->lastused,
+    pg_atomic_fetch_add_u64(&edgeindex_shared->clock, 1));
+  char *data = edgeindex_entry_data(entry);
+  memcpy(data, gs, VARSIZE(gs));
+  edgeindex_flatten(index, data + geomsize);
+  edgeindex_shared->used += size;
+  LWLockRelease(edgeindex_shared->lock);
+}
+
+/**
+ * Attaches to the shared cache, initializing it in the postmaster
+ */
+static void
+edgeindex_shmem_startup(void)
+{
+  if (prev_shmem_startup_hook)
+    prev_shmem_startup_hook();
+  LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+  bool found;
+  EdgeIndexCache *cache = ShmemInitStruct("MobilityDB edge index cache",
+    edgeindex_shmem_size(), &found);
+  if (! found)
+  {
+    cache->lock = &(GetNamedLWLockTranche("mobilitydb_edgeindex"))->lock;
+    cache->capacity = (Size) edgeindex_cache_size * 1024;
+    cache->used = 0;
+    cache->count = 0;
+    pg_atomic_init_u64(&cache->clock, 0);
+    for (int i = 0; i < EDGEINDEX_CACHE_ENTRIES; i++)
+      pg_atomic_init_u64(&cache->entries[i].lastused, 0);
+  }
+  LWLockRelease(AddinShmemInitLock);
+  edgeindex_shared = cache;
+}
+
+/**
+ * Requests the shared memory of the cache of the indexes
+ *
+ * The function is called when the library is loaded and only requests the
+ * memory when it is loaded with shared_preload_libraries.
+ */
+void
+edgeindex_shmem_init(void)
+{
+  if (! process_shared_preload_libraries_in_progress ||
+      edgeindex_cache_size == 0)
+    return;
+  RequestAddinShmemSpace(edgeindex_shmem_size());
+  RequestNamedLWLockTranche("mobilitydb_edgeindex", 1);
+  prev_shmem_startup_hook = shmem_startup_hook;
+  shmem_startup_hook = edgeindex_shmem_startup;
+}
+
+/*****************************************************************************/
+
+/**
+ * Returns the index of the edges of the geometry, or NULL if the geometry
+ * does not need an index
+ *
+ * The result is owned by the cache and remains valid until the next call.
+ *
+ * @param[in] gs Detoasted geometry
+ */
+const EdgeIndex *
+edgeindex_get(const GSERIALIZED *gs)
+{
+  if (edgeindex_geom != NULL && VARSIZE(edgeindex_geom) == VARSIZE(gs) &&
+    memcmp(edgeindex_geom, gs, VARSIZE(gs)) == 0)
+    return edgeindex_cached;
+
+  if (edgeindex_context == NULL)
+    edgeindex_context = AllocSetContextCreate(TopMemoryContext,
+      "MobilityDB edge index", ALLOCSET_DEFAULT_SIZES);
+  else
+    MemoryContextReset(edgeindex_context);
+  /* The cache is empty if an error occurs while building the index */
+  edgeindex_geom = NULL;
+  edgeindex_cached = NULL;
+
+  MemoryContext oldcontext = MemoryContextSwitchTo(edgeindex_context);
+  EdgeIndex *index = NULL;
+  uint32 hash = 0;
+  int type = gserialized_get_type(gs);
+  bool shared = edgeindex_shared != NULL &&
+    (type == POLYGONTYPE || type == MULTIPOLYGONTYPE);
+  if (shared)
+  {
+    hash = DatumGetUInt32(hash_any((unsigned char *) gs, VARSIZE(gs)));
+    index = edgeindex_shared_get(hash, gs);
+  }
+  if (index == NULL)
+  {
+    index = edgeindex_build(gs);
+    if (shared && index != NULL)
+      edgeindex_shared_add(hash, gs, index);
+  }
+  GSERIALIZED *copy = palloc(VARSIZE(gs));
+  memcpy(copy, gs, VARSIZE(gs));
+  MemoryContextSwitchTo(oldcontext);
+  edgeindex_cached = index;
+  edgeindex_geom = copy;
+  return index;
+}
+
+/*****************************************************************************
+ * Queries of the index
+ *****************************************************************************/
+
+/**
+ * Returns the number of edges whose box overlaps the given box
+ *
+ * @param[in] index Index
+ * @param[in] box Box
+ * @param[in,out] edges Array of the positions of the edges, enlarged if needed
+ * @param[in,out] size Allocated size of the array
+ */
+static int
+edgeindex_query(const EdgeIndex *index, const EdgeBox *box, int **edges,
+  int *size)
+{
+  /* Depth-first traversal, the stack keeps the level and the position of
+   * the nodes to visit */
+  int maxstack = index->nlevels * EDGEINDEX_NODE_SIZE;
+  int *levels = palloc(sizeof(int) * maxstack);
+  int *nodes = palloc(sizeof(int) * maxstack);
+  int top = 0, count = 0;
+  levels[top] = index->nlevels - 1;
+  nodes[top++] = 0;
+  while (top > 0)
+  {
+    int l = levels[--top], n = nodes[top];
+    const EdgeBox *nodebox = &index->boxes[l][n];
+    if (nodebox->xmin > box->xmax || box->xmin > nodebox->xmax ||
+      nodebox->ymin > box->ymax || box->ymin > nodebox->ymax)
+      continue;
+    if (l == 0)
+    {
+      if (count == *size)
+      {
+        *size *= 2;
+        *edges = repalloc(*edges, sizeof(int) * *size);
+      }
+      (*edges)[count++] = n;
+      continue;
+    }
+    int last = Min((n + 1) * EDGEINDEX_NODE_SIZE, index->counts[l - 1]);
+    for (int i = n * EDGEINDEX_NODE_SIZE; i < last; i++)
+    {
+      levels[top] = l - 1;
+      nodes[top++] = i;
+    }
+  }
+  pfree(levels); pfree(nodes);
+  return count;
+}
+
+/**
+ * Returns 1 if the point is in the interior of the polygon, 0 if it is on
+ * its boundary, and -1 if it is in its exterior
+ *
+ * The interior is determined by the parity of the number of edges crossed
+ * by a horizontal ray from the point to the right, which also accounts for
+ * the holes and the components of multipolygons.
+ */
+static int
+edgeindex_locate(const EdgeIndex *index, const POINT2D *p, int **edges,
+  int *size)
+{
+  EdgeBox box = {p->x, p->y, DBL_MAX, p->y};
+  int count = edgeindex_query(index, &box, edges, size);
+  bool inside = false;
+  for (int i = 0; i < count; i++)
+  {
+    const POINT2D *c = &index->points[2 * (*edges)[i]];
+    const POINT2D *d = &index->points[2 * (*edges)[i] + 1];
+    double cross = (d->x - c->x) * (p->y - c->y) -
+      (d->y - c->y) * (p->x - c->x);
+    if (cross == 0 && p->x >= Min(c->x, d->x) && p->x <= Max(c->x, d->x) &&
+      p->y >= Min(c->y, d->y) && p->y <= Max(c->y, d->y))
+      return 0;
+    if ((c->y > p->y) != (d->y > p->y))
+    {
+      double x = c->x + (p->y - c->y) * (d->x - c->x) / (d->y - c->y);
+      if (p->x < x)
+        inside = ! inside;
+    }
+  }
+  return inside ? 1 : -1;
+}
+
+/**
+ * Comparator of the fractions of the segment
+ */
+static int
+edgefraction_cmp(const void *a, const void *b)
+{
+  const EdgeFraction *f1 = (const EdgeFraction *) a;
+  const EdgeFraction *f2 = (const EdgeFraction *) b;
+  if (f1->fraction == f2->fraction)
+    return 0;
+  return (f1->fraction < f2->fraction) ? -1 : 1;
+}
+
+/**
+ * Returns the fractions of the segment that intersect the polygon
+ *
+ * The result is an array of pairs of fractions, each pair defining an
+ * interval of the segment, in increasing order. When both fractions of a
+ * pair are equal the intersection is a single point.
+ *
+ * @param[in] index Index of the polygon
+ * @param[in] p1,p2 Points defining the segment
+ * @param[out] count Number of pairs of the result
+ * @pre The points are not equal
+ */
+double *
+edgeindex_clip_segment(const EdgeIndex *index, const POINT2D *p1,
+  const POINT2D *p2, int *count)
+{
+  EdgeBox box = {Min(p1->x, p2->x), Min(p1->y, p2->y),
+    Max(p1->x, p2->x), Max(p1->y, p2->y)};
+  int size = 64;
+  int *edges = palloc(sizeof(int) * size);
+  int nedges = edgeindex_query(index, &box, &edges, &size);
+
+  /* Fractions at which the segment meets the edges and intervals of the
+   * segment that are collinear with an edge */
+  EdgeFraction *fractions = palloc(sizeof(EdgeFraction) * (2 * nedges + 2));
+  double *overlaps = palloc(sizeof(double) * 2 * Max(nedges, 1));
+  int nfractions = 0, noverlaps = 0;
+  fractions[nfractions].fraction = 0;
+  fractions[nfractions++].boundary = false;
+  fractions[nfractions].fraction = 1;
+  fractions[nfractions++].boundary = false;
+  double rx = p2->x - p1->x, ry = p2->y - p1->y;
+  double rr = rx * rx + ry * ry;
+  for (int i = 0; i < nedges; i++)
+  {
+    const POINT2D *c = &index->points[2 * edges[i]];
+    const POINT2D *d = &index->points[2 * edges[i] + 1];
+    double qx = d->x - c->x, qy = d->y - c->y;
+    double wx = c->x - p1->x, wy = c->y - p1->y;
+    double denom = rx * qy - ry * qx;
+    double num = wx * ry - wy * rx;
+    if (denom != 0)
+    {
+      double s = (wx * qy - wy * qx) / denom;
+      double u = num / denom;
+      if (s >= 0 && s <= 1 && u >= 0 && u <= 1)
+      {
+        fractions[nfractions].fraction = s;
+        fractions[nfractions++].boundary = true;
+      }
+    }
+    else if (num == 0)
+    {
+      /* The edge is collinear with the segment */
+      double s1 = (wx * rx + wy * ry) / rr;
+      double s2 = ((d->x - p1->x) * rx + (d->y - p1->y) * ry) / rr;
+      double lower = Max(Min(s1, s2), 0), upper = Min(Max(s1, s2), 1);
+      if (lower <= upper)
+      {
+        fractions[nfractions].fraction = lower;
+        fractions[nfractions++].boundary = true;
+        fractions[nfractions].fraction = upper;
+        fractions[nfractions++].boundary = true;
+        overlaps[noverlaps++] = lower;
+        overlaps[noverlaps++] = upper;
+      }
+    }
+  }
+
+  /* Sort the fractions and remove the duplicates */
+  qsort(fractions, nfractions, sizeof(EdgeFraction), &edgefraction_cmp);
+  int k = 0;
+  for (int i = 1; i < nfractions; i++)
+  {
+    if (fractions[i].fraction == fractions[k].fraction)
+      fractions[k].boundary |= fractions[i].boundary;
+    else
+      fractions[++k] = fractions[i];
+  }
+  nfractions = k + 1;
+
+  /* Locate the fractions and the middle of the intervals between them */
+  bool *closure = palloc(sizeof(bool) * nfractions);
+  bool *inside = palloc(sizeof(bool) * nfractions);
+  for (int i = 0; i < nfractions; i++)
+  {
+    POINT2D p;
+    double f = fractions[i].fraction;
+    p.x = p1->x + rx * f;
+    p.y = p1->y + ry * f;
+    closure[i] = fractions[i].boundary ||
+      edgeindex_locate(index, &p, &edges, &size) >= 0;
+    if (i == nfractions - 1)
+      break;
+    f = (fractions[i].fraction + fractions[i + 1].fraction) / 2;
+    inside[i] = false;
+    for (int j = 0; j < noverlaps; j += 2)
+    {
+      if (overlaps[j] <= f && f <= overlaps[j + 1])
+      {
+        inside[i] = true;
+        break;
+      }
+    }
+    if (! inside[i])
+    {
+      p.x = p1->x + rx * f;
+      p.y = p1->y + ry * f;
+      inside[i] = edgeindex_locate(index, &p, &edges, &size) >= 0;
+    }
+  }
+
+  /* Merge the consecutive intervals inside the polygon and keep the
+   * isolated points of the boundary */
+  double *result = palloc(sizeof(double) * 2 * nfractions);
+  k = 0;
+  for (int i = 0; i < nfractions; )
+  {
+    if (i < nfractions - 1 && inside[i])
+    {
+      int j = i;
+      while (j < nfractions - 1 && inside[j])
+        j++;
+      result[2 * k] = fractions[i].fraction;
+      result[2 * k + 1] = fractions[j].fraction;
+      k++;
+      i = j + 1;
+    }
+    else
+    {
+      if (closure[i] && (i == 0 || ! inside[i - 1]))
+      {
+        result[2 * k] = result[2 * k + 1] = fractions[i].fraction;
+        k++;
+      }
+      i++;
+    }
+  }
+  pfree(edges); pfree(fractions); pfree(overlaps);
+  pfree(closure); pfree(inside);
+  *count = k;
+  return result;
+}
+
+/*****************************************************************************/
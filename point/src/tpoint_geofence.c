@@ -0,0 +1,489 @@
+/*****************************************************************************
+ *
+ * tpoint_geofence.c
+ *    Time during which a temporal point intersects each geometry of an
+ *    array of geofences.
+ *
+ * Evaluating a set of geofences on a trip with one call of whenIntersects
+ * per geofence scans the trajectory and prepares the geometry of the
+ * geofence for every call. The function whenIntersectsFences instead
+ * computes in one pass the time during which the temporal point intersects
+ * each geofence of an array. The boxes of the geofences are kept in an
+ * R-tree packed with the Sort-Tile-Recursive algorithm, and the edges of
+ * the polygonal geofences with many edges are indexed once. The segments
+ * of the trajectory are then traversed once, and each segment is only
+ * clipped against the geofences whose box overlaps the box of the segment.
+ * When the sequences have block boxes, the index is queried once per block
+ * of segments, whose candidate geofences are then filtered for each
+ * segment.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_geofence.h"
+
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/array.h>
+
+#include "periodset.h"
+#include "stbox.h"
+#include "temporaltypes.h"
+#include "temporal_util.h"
+#include "tpoint_boxops.h"
+#include "tpoint_spatialfuncs.h"
+#include "tpoint_spatialrels.h"
+
+/*****************************************************************************
+ * Index of the geofences
+ *****************************************************************************/
+
+/**
+ * Structure to represent the boxes of the nodes of the index
+ */
+typedef struct
+{
+  double      xmin, ymin;
+  double      xmax, ymax;
+} FenceBox;
+
+/**
+ * Structure to represent the index. The nodes of a level are the groups of
+ * consecutive nodes of the level below, level 0 being the geofences.
+ */
+typedef struct
+{
+  int         nlevels;     /**< number of levels of the tree */
+  int        *counts;      /**< number of nodes of each level */
+  FenceBox  **boxes;       /**< boxes of the nodes of each level */
+  int        *fences;      /**< positions of the geofences of level 0 */
+  int        *stack;       /**< stack of the traversal of the tree */
+} FenceIndex;
+
+/**
+ * Returns true if the two boxes overlap
+ */
+static bool
+fencebox_overlaps(const FenceBox *box1, const FenceBox *box2)
+{
+  return (box1->xmin <= box2->xmax && box2->xmin <= box1->xmax &&
+    box1->ymin <= box2->ymax && box2->ymin <= box1->ymax);
+}
+
+/**
+ * Comparator of the geofences on the X coordinate of the center of their box
+ */
+static int
+fence_center_x_cmp(const void *a, const void *b, void *arg)
+{
+  const FenceBox *boxes = (const FenceBox *) arg;
+  const FenceBox *b1 = &boxes[*(const int *) a];
+  const FenceBox *b2 = &boxes[*(const int *) b];
+  double x1 = b1->xmin + b1->xmax, x2 = b2->xmin + b2->xmax;
+  if (x1 == x2)
+    return 0;
+  return (x1 < x2) ? -1 : 1;
+}
+
+/**
+ * Comparator of the geofences on the Y coordinate of the center of their box
+ */
+static int
+fence_center_y_cmp(const void *a, const void *b, void *arg)
+{
+  const FenceBox *boxes = (const FenceBox *) arg;
+  const FenceBox *b1 = &boxes[*(const int *) a];
+  const FenceBox *b2 = &boxes[*(const int *) b];
+  double y1 = b1->ymin + b1->ymax, y2 = b2->ymin + b2->ymax;
+  if (y1 == y2)
+    return 0;
+  return (y1 < y2) ? -1 : 1;
+}
+
+/**
+ * Build the index of the boxes of the geofences
+ *
+ * @param[out] index Index
+ * @param[in] boxes Boxes of the geofences
+ * @param[in] fences Positions of the geofences to index
+ * @param[in] count Number of geofences to index
+ * @pre The count is greater than 0
+ */
+static void
+fenceindex_build(FenceIndex *index, const FenceBox *boxes, int *fences,
+  int count)
+{
+  /* Sort the geofences into vertical slices and then each slice on Y */
+  int nleaves = (count + GEOFENCE_NODE_SIZE - 1) / GEOFENCE_NODE_SIZE;
+  int slicesize = (int) ceil(sqrt((double) nleaves)) * GEOFENCE_NODE_SIZE;
+  qsort_arg(fences, count, sizeof(int), &fence_center_x_cmp, (void *) boxes);
+  for (int i = 0; i < count; i += slicesize)
+    qsort_arg(&fences[i], Min(slicesize, count - i), sizeof(int),
+      &fence_center_y_cmp, (void *) boxes);
+  index->fences = fences;
+
+  /* Build the levels of the tree bottom-up */
+  int nlevels = 1;
+  for (int n = count; n > 1; n = (n + GEOFENCE_NODE_SIZE - 1) /
+      GEOFENCE_NODE_SIZE)
+    nlevels++;
+  index->nlevels = nlevels;
+  index->counts = palloc(sizeof(int) * nlevels);
+  index->boxes = palloc(sizeof(FenceBox *) * nlevels);
+  index->counts[0] = count;
+  index->boxes[0] = palloc(sizeof(FenceBox) * count);
+  for (int i = 0; i < count; i++)
+    index->boxes[0][i] = boxes[fences[i]];
+  for (int l = 1; l < nlevels; l++)
+  {
+    int n = (index->counts[l - 1] + GEOFENCE_NODE_SIZE - 1) /
+      GEOFENCE_NODE_SIZE;
+    index->counts[l] = n;
+    index->boxes[l] = palloc(sizeof(FenceBox) * n);
+    for (int i = 0; i < n; i++)
+    {
+      FenceBox *box = &index->boxes[l][i];
+      int last = Min((i + 1) * GEOFENCE_NODE_SIZE, index->counts[l - 1]);
+      *box = index->boxes[l - 1][i * GEOFENCE_NODE_SIZE];
+      for (int j = i * GEOFENCE_NODE_SIZE + 1; j < last; j++)
+      {
+        const FenceBox *child = &index->boxes[l - 1][j];
+        box->xmin = Min(box->xmin, child->xmin);
+        box->xmax = Max(box->xmax, child->xmax);
+        box->ymin = Min(box->ymin, child->ymin);
+        box->ymax = Max(box->ymax, child->ymax);
+      }
+    }
+  }
+  /* The stack keeps pairs of level and position of the nodes to visit */
+  index->stack = palloc(sizeof(int) * 2 * nlevels * GEOFENCE_NODE_SIZE);
+  return;
+}
+
+/**
+ * Returns the number of geofences whose box overlaps the given box
+ *
+ * @param[in] index Index
+ * @param[in] box Box
+ * @param[out] result Positions of the geofences, which has space for all
+ * the geofences of the index
+ */
+static int
+fenceindex_query(const FenceIndex *index, const FenceBox *box, int *result)
+{
+  int *stack = index->stack;
+  int top = 0, count = 0;
+  stack[top++] = index->nlevels - 1;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    int n = stack[--top], l = stack[--top];
+    if (! fencebox_overlaps(&index->boxes[l][n], box))
+      continue;
+    if (l == 0)
+    {
+      result[count++] = index->fences[n];
+      continue;
+    }
+    int last = Min((n + 1) * GEOFENCE_NODE_SIZE, index->counts[l - 1]);
+    for (int i = n * GEOFENCE_NODE_SIZE; i < last; i++)
+    {
+      stack[top++] = l - 1;
+      stack[top++] = i;
+    }
+  }
+  return count;
+}
+
+/*****************************************************************************
+ * Evaluation of the geofences
+ *****************************************************************************/
+
+/**
+ * Structure to represent the geofences during their evaluation
+ */
+typedef struct
+{
+  Datum *geoms;            /**< Geometries of the geofences */
+  const EdgeIndex **edges; /**< Indexes of the edges of the geofences */
+  FenceBox *boxes;         /**< Boxes of the geofences */
+  PeriodArray *arrs;       /**< Periods of the geofences, size 0 if none */
+  FenceIndex index;        /**< Index of the boxes of the geofences */
+  int *candidates;         /**< Geofences overlapping the current block */
+  int *overlaps;           /**< Geofences overlapping the current segment */
+} FenceEval;
+
+/**
+ * Returns the array of periods of the geofence, which is allocated when
+ * the first period is added
+ */
+static PeriodArray *
+fenceeval_arr(FenceEval *eval, int fence)
+{
+  PeriodArray *arr = &eval->arrs[fence];
+  if (arr->size == 0)
+  {
+    arr->size = 16;
+    arr->periods = palloc(sizeof(Period) * arr->size);
+  }
+  return arr;
+}
+
+/**
+ * Add the instant of the temporal point to the geofences it intersects
+ */
+static void
+fenceeval_instant(FenceEval *eval, const TInstant *inst)
+{
+  Datum value = tinstant_value(inst);
+  const POINT2D *p = datum_get_point2d_p(value);
+  FenceBox box = {p->x, p->y, p->x, p->y};
+  int count = fenceindex_query(&eval->index, &box, eval->overlaps);
+  for (int i = 0; i < count; i++)
+  {
+    int fence = eval->overlaps[i];
+    if (DatumGetBool(geom_intersects2d(value, eval->geoms[fence])))
+      periodarr_add(fenceeval_arr(eval, fence), inst->t, inst->t,
+        true, true);
+  }
+  return;
+}
+
+/**
+ * Add the periods of the temporal sequence point to the geofences it
+ * intersects
+ *
+ * @note This function follows the same logic as tpointseq_at_geometry_time
+ */
+static void
+fenceeval_sequence(FenceEval *eval, const TSequence *seq)
+{
+  /* Instantaneous sequence */
+  if (seq->count == 1)
+  {
+    fenceeval_instant(eval, tsequence_inst_n(seq, 0));
+    return;
+  }
+
+  /* Temporal sequence has at least 2 instants */
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  const STBOX *blocks = tpointseq_blocks_ptr(seq);
+  int ncandidates = 0;
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  bool lower_inc = seq->period.lower_inc;
+  for (int i = 0; i < seq->count - 1; i++)
+  {
+    if (blocks != NULL && i % TPOINTSEQ_BLOCK_SIZE == 0)
+    {
+      const STBOX *block = &blocks[i / TPOINTSEQ_BLOCK_SIZE];
+      FenceBox box = {block->xmin, block->ymin, block->xmax, block->ymax};
+      ncandidates = fenceindex_query(&eval->index, &box, eval->candidates);
+      if (ncandidates == 0)
+      {
+        /* Skip the segments of the block */
+        i = Min(i + TPOINTSEQ_BLOCK_SIZE, seq->count - 1) - 1;
+        inst1 = tsequence_inst_n(seq, i + 1);
+        lower_inc = true;
+        continue;
+      }
+    }
+    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
+    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
+    const POINT2D *p1 = datum_get_point2d_p(tinstant_value(inst1));
+    const POINT2D *p2 = datum_get_point2d_p(tinstant_value(inst2));
+    FenceBox box = {Min(p1->x, p2->x), Min(p1->y, p2->y),
+      Max(p1->x, p2->x), Max(p1->y, p2->y)};
+    int count = 0;
+    if (blocks != NULL)
+    {
+      /* Filter the candidate geofences of the block */
+      for (int j = 0; j < ncandidates; j++)
+      {
+        if (fencebox_overlaps(&eval->boxes[eval->candidates[j]], &box))
+          eval->overlaps[count++] = eval->candidates[j];
+      }
+    }
+    else
+      count = fenceindex_query(&eval->index, &box, eval->overlaps);
+    for (int j = 0; j < count; j++)
+    {
+      int fence = eval->overlaps[j];
+      tpointseg_at_geometry_time(fenceeval_arr(eval, fence), inst1, inst2,
+        linear, lower_inc, upper_inc, eval->geoms[fence],
+        eval->edges[fence]);
+    }
+    inst1 = inst2;
+    lower_inc = true;
+  }
+  return;
+}
+
+/**
+ * Returns the time during which the temporal point intersects each
+ * geofence of the array (internal function)
+ *
+ * @param[in] temp Temporal point
+ * @param[in] geoms Detoasted geometries of the geofences
+ * @param[in] count Number of geofences
+ * @pre The geometries have the same SRID and dimensionality as the
+ * temporal point
+ */
+GeofenceState *
+when_intersects_tpoint_geoarr_internal(const Temporal *temp, Datum *geoms,
+  int count)
+{
+  GeofenceState *result = palloc0(sizeof(GeofenceState));
+  result->fences = palloc(sizeof(int) * Max(count, 1));
+  result->times = palloc(sizeof(PeriodSet *) * Max(count, 1));
+
+  /* Keep the non-empty geofences whose box overlaps the temporal point */
+  STBOX box1;
+  memset(&box1, 0, sizeof(STBOX));
+  temporal_bbox(&box1, temp);
+  FenceEval eval;
+  eval.geoms = geoms;
+  eval.boxes = palloc(sizeof(FenceBox) * Max(count, 1));
+  int *fences = palloc(sizeof(int) * Max(count, 1));
+  int nfences = 0;
+  for (int i = 0; i < count; i++)
+  {
+    GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(geoms[i]);
+    if (gserialized_is_empty(gs))
+      continue;
+    STBOX box2;
+    memset(&box2, 0, sizeof(STBOX));
+    geo_to_stbox_internal(&box2, gs);
+    if (! overlaps_stbox_stbox_internal(&box1, &box2))
+      continue;
+    eval.boxes[i].xmin = box2.xmin;
+    eval.boxes[i].ymin = box2.ymin;
+    eval.boxes[i].xmax = box2.xmax;
+    eval.boxes[i].ymax = box2.ymax;
+    fences[nfences++] = i;
+  }
+  if (nfences == 0)
+  {
+    pfree(eval.boxes); pfree(fences);
+    return result;
+  }
+
+  /* The polygons with many edges are clipped with an index of their edges,
+   * which is built once for each geofence */
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  eval.edges = palloc0(sizeof(EdgeIndex *) * count);
+  if (linear)
+  {
+    for (int i = 0; i < nfences; i++)
+      eval.edges[fences[i]] = edgeindex_build(
+        (GSERIALIZED *) DatumGetPointer(geoms[fences[i]]));
+  }
+  eval.arrs = palloc0(sizeof(PeriodArray) * count);
+  fenceindex_build(&eval.index, eval.boxes, fences, nfences);
+  eval.candidates = palloc(sizeof(int) * nfences);
+  eval.overlaps = palloc(sizeof(int) * nfences);
+
+  /* Traverse the temporal point once */
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT || temp->duration == INSTANTSET)
+  {
+    TInstantIterator iter;
+    const TInstant *inst;
+    tinstant_iterator_init(&iter, temp);
+    while ((inst = tinstant_iterator_next(&iter)) != NULL)
+      fenceeval_instant(&eval, inst);
+  }
+  else if (temp->duration == SEQUENCE)
+    fenceeval_sequence(&eval, (const TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      fenceeval_sequence(&eval, tsequenceset_seq_n(ts, i));
+  }
+
+  /* Collect the geofences intersected in the order of the array */
+  for (int i = 0; i < count; i++)
+  {
+    if (eval.arrs[i].size == 0)
+      continue;
+    PeriodSet *ps = periodarr_to_periodset(&eval.arrs[i]);
+    pfree(eval.arrs[i].periods);
+    if (ps == NULL)
+      continue;
+    result->fences[result->count] = i;
+    result->times[result->count++] = ps;
+  }
+
+  for (int l = 0; l < eval.index.nlevels; l++)
+    pfree(eval.index.boxes[l]);
+  pfree(eval.index.counts); pfree(eval.index.boxes); pfree(eval.index.stack);
+  pfree(eval.boxes); pfree(eval.edges); pfree(eval.arrs);
+  pfree(eval.candidates); pfree(eval.overlaps); pfree(fences);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(when_intersects_tpoint_geoarr);
+/**
+ * Returns the position of each geofence of the array intersected by the
+ * temporal point together with the time during which they intersect
+ */
+PGDLLEXPORT Datum
+when_intersects_tpoint_geoarr(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  GeofenceState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+    int count;
+    Datum *geoms = datumarr_extract(array, &count);
+    for (int i = 0; i < count; i++)
+    {
+      GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(geoms[i]);
+      geoms[i] = PointerGetDatum(gs);
+      if (gserialized_is_empty(gs))
+        continue;
+      ensure_same_srid_tpoint_gs(temp, gs);
+      ensure_same_dimensionality_tpoint_gs(temp, gs);
+    }
+    funcctx->user_fctx = when_intersects_tpoint_geoarr_internal(temp, geoms,
+      count);
+    pfree(geoms);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (GeofenceState *) funcctx->user_fctx;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The positions in the array start at 1 */
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Int32GetDatum(state->fences[state->i] + 1);
+  values[1] = PointerGetDatum(state->times[state->i]);
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
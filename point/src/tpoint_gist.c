@@ -14,16 +14,22 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <utils/timestamp.h>
 #include <access/gist.h>
+#include <utils/array.h>
 
 #if MOBDB_PGSQL_VERSION >= 120000
 #include <utils/float.h>
 #endif
+#if MOBDB_PGSQL_VERSION >= 130000
+#include <access/reloptions.h>
+#endif
 
 #include "time_gist.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
+#include "temporal_util.h"
 #include "tpoint.h"
 #include "tnumber_gist.h"
 #include "tpoint_boxops.h"
@@ -58,6 +64,7 @@ stbox_index_consistent_leaf(const STBOX *key, const STBOX *query,
   switch (strategy)
   {
     case RTOverlapStrategyNumber:
+    case RTOverlapSegmentsStrategyNumber:
       retval = overlaps_stbox_stbox_internal(key, query);
       break;
     case RTContainsStrategyNumber:
@@ -141,7 +148,7 @@ stbox_index_consistent_leaf(const STBOX *key, const STBOX *query,
  * @param[in] query Value being looked up in the index
  * @param[in] strategy Operator of the operator class being applied
  */
-static bool
+bool
 stbox_gist_consistent_internal(const STBOX *key, const STBOX *query,
   StrategyNumber strategy)
 {
@@ -150,6 +157,7 @@ stbox_gist_consistent_internal(const STBOX *key, const STBOX *query,
   switch (strategy)
   {
     case RTOverlapStrategyNumber:
+    case RTOverlapSegmentsStrategyNumber:
     case RTContainedByStrategyNumber:
       retval = overlaps_stbox_stbox_internal(key, query);
       break;
@@ -247,54 +255,67 @@ tpoint_index_recheck(StrategyNumber strategy)
   }
 }
 
-PG_FUNCTION_INFO_V1(stbox_gist_consistent);
 /**
- * GiST consistent method for temporal points
+ * Transform the query of a GiST support function into a box initializing
+ * the dimensions that must not be taken into account by the operators to
+ * infinity
+ *
+ * @param[out] query Box
+ * @param[in] fcinfo Catalog information about the external function
+ * @return False if the query is NULL or empty
  */
-PGDLLEXPORT Datum
-stbox_gist_consistent(PG_FUNCTION_ARGS)
+static bool
+tpoint_gist_query(STBOX *query, FunctionCallInfo fcinfo)
 {
-  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
-  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
   Oid subtype = PG_GETARG_OID(3);
-  bool *recheck = (bool *) PG_GETARG_POINTER(4), result;
-  STBOX *key = (STBOX *)DatumGetPointer(entry->key), 
-    query;
-  
-  /* Determine whether the index is lossy depending on the strategy */
-  *recheck = tpoint_index_recheck(strategy);
-  
-  if (key == NULL)
-    PG_RETURN_BOOL(false);
-  
-  /*
-   * Transform the query into a box initializing the dimensions that must
-   * not be taken into account by the operators to infinity.
-   */
-  memset(&query, 0, sizeof(STBOX));
+  memset(query, 0, sizeof(STBOX));
   if (tgeo_base_type(subtype))
   {
-    /* Since function stbox_gist_consistent is strict, query is not NULL */
-    if (!geo_to_stbox_internal(&query, PG_GETARG_GSERIALIZED_P(1)))
-      PG_RETURN_BOOL(false);
+    /* Since the support functions are strict, query is not NULL */
+    if (!geo_to_stbox_internal(query, PG_GETARG_GSERIALIZED_P(1)))
+      return false;
   }
   else if (subtype == type_oid(T_STBOX))
   {
     STBOX *box = PG_GETARG_STBOX_P(1);
     if (box == NULL)
-      PG_RETURN_BOOL(false);
-    memcpy(&query, box, sizeof(STBOX));
+      return false;
+    memcpy(query, box, sizeof(STBOX));
   }
   else if (tgeo_type(subtype))
   {
     Temporal *temp = PG_GETARG_TEMPORAL(1);
     if (temp == NULL)
-      PG_RETURN_BOOL(false);
-    temporal_bbox(&query, temp);
+      return false;
+    temporal_bbox(query, temp);
     PG_FREE_IF_COPY(temp, 1);
   }
   else
     elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+  return true;
+}
+
+PG_FUNCTION_INFO_V1(stbox_gist_consistent);
+/**
+ * GiST consistent method for temporal points
+ */
+PGDLLEXPORT Datum
+stbox_gist_consistent(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4), result;
+  STBOX *key = (STBOX *)DatumGetPointer(entry->key), 
+    query;
+  
+  /* Determine whether the index is lossy depending on the strategy */
+  *recheck = tpoint_index_recheck(strategy);
+  
+  if (key == NULL)
+    PG_RETURN_BOOL(false);
+  
+  if (!tpoint_gist_query(&query, fcinfo))
+    PG_RETURN_BOOL(false);
   
   if (GIST_LEAF(entry))
     result = stbox_index_consistent_leaf(key, &query, strategy);
@@ -311,7 +332,7 @@ stbox_gist_consistent(PG_FUNCTION_ARGS)
 /**
  * Increase the first box to include the second one
  */
-static void
+void
 stbox_adjust(STBOX *b, const STBOX *addon)
 {
   if (FLOAT8_LT(b->xmax, addon->xmax))
@@ -401,6 +422,47 @@ tpoint_gist_decompress(PG_FUNCTION_ARGS)
 }
 #endif
 
+/*****************************************************************************
+ * GiST compress and fetch methods for spatiotemporal boxes
+ *
+ * Since PostgreSQL 11 the compress method is optional and an operator class
+ * without it supports index-only scans. In previous versions the identity
+ * functions below are needed so that expression indexes such as
+ *   CREATE INDEX ON trips USING gist(stbox(trip));
+ * can answer the queries on the bounding boxes with index-only scans.
+ *****************************************************************************/
+
+#if MOBDB_PGSQL_VERSION < 110000
+PG_FUNCTION_INFO_V1(stbox_gist_compress);
+/**
+ * GiST compress method for spatiotemporal boxes
+ */
+PGDLLEXPORT Datum
+stbox_gist_compress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  if (entry->leafkey)
+  {
+    GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+    gistentryinit(*retval, entry->key, entry->rel, entry->page,
+      entry->offset, false);
+    PG_RETURN_POINTER(retval);
+  }
+  PG_RETURN_POINTER(entry);
+}
+
+PG_FUNCTION_INFO_V1(stbox_gist_fetch);
+/**
+ * GiST fetch method for spatiotemporal boxes
+ */
+PGDLLEXPORT Datum
+stbox_gist_fetch(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  PG_RETURN_POINTER(entry);
+}
+#endif
+
 /*****************************************************************************
  * GiST penalty method
  *****************************************************************************/
@@ -682,6 +744,377 @@ stbox_gist_consider_split(ConsiderSplitContext *context, int dimNum,
   return;
 }
 
+/*****************************************************************************
+ * R*-tree split
+ *
+ * Alternative picksplit strategy selected with the "split" parameter of the
+ * operator classes, e.g.,
+ *   CREATE INDEX ON trips USING gist(trip gist_tgeompoint_ops(split = rstar));
+ * Following the R*-tree paper, the split axis is the one minimizing the sum
+ * of the margins of the candidate distributions, and the distribution along
+ * this axis is the one minimizing the overlap of the two groups, and then
+ * their volume. Since the dimensions of the boxes have different units, the
+ * coordinates are normalized with respect to the bounding box of all the
+ * entries. Dimensions of zero extent are not considered.
+ *****************************************************************************/
+
+#if MOBDB_PGSQL_VERSION >= 130000
+
+/** Minimum fill factor of the groups of the R*-tree split */
+#define RSTAR_MIN_FILL 0.4
+
+/**
+ * Box in normalized coordinates used by the R*-tree split
+ */
+typedef struct
+{
+  double lower[4];    /**< lower bound of each dimension */
+  double upper[4];    /**< upper bound of each dimension */
+} RStarBox;
+
+/**
+ * Projection of an entry on an axis used by the R*-tree split
+ */
+typedef struct
+{
+  double lower;       /**< lower bound of the entry on the axis */
+  double upper;       /**< upper bound of the entry on the axis */
+  int index;          /**< position of the entry */
+} RStarInterval;
+
+/**
+ * Comparator of intervals by lower and then by upper bound
+ */
+static int
+rstar_interval_cmp_lower(const void *i1, const void *i2)
+{
+  const RStarInterval *a = (const RStarInterval *) i1;
+  const RStarInterval *b = (const RStarInterval *) i2;
+  if (a->lower != b->lower)
+    return (a->lower < b->lower) ? -1 : 1;
+  if (a->upper != b->upper)
+    return (a->upper < b->upper) ? -1 : 1;
+  return 0;
+}
+
+/**
+ * Comparator of intervals by upper and then by lower bound
+ */
+static int
+rstar_interval_cmp_upper(const void *i1, const void *i2)
+{
+  const RStarInterval *a = (const RStarInterval *) i1;
+  const RStarInterval *b = (const RStarInterval *) i2;
+  if (a->upper != b->upper)
+    return (a->upper < b->upper) ? -1 : 1;
+  if (a->lower != b->lower)
+    return (a->lower < b->lower) ? -1 : 1;
+  return 0;
+}
+
+/**
+ * Returns the bounds of a spatiotemporal box on a dimension, where the
+ * dimensions are numbered as in stbox_gist_consider_split
+ */
+static void
+stbox_dim_bounds(const STBOX *box, int dim, double *lower, double *upper)
+{
+  if (dim == 0)
+  {
+    *lower = box->xmin;
+    *upper = box->xmax;
+  }
+  else if (dim == 1)
+  {
+    *lower = box->ymin;
+    *upper = box->ymax;
+  }
+  else if (dim == 2)
+  {
+    *lower = box->zmin;
+    *upper = box->zmax;
+  }
+  else
+  {
+    *lower = (double) box->tmin;
+    *upper = (double) box->tmax;
+  }
+  return;
+}
+
+/**
+ * Expand the first normalized box to include the second one
+ */
+static void
+rstarbox_adjust(RStarBox *box, const RStarBox *addon, int ndims)
+{
+  for (int d = 0; d < ndims; d++)
+  {
+    box->lower[d] = Min(box->lower[d], addon->lower[d]);
+    box->upper[d] = Max(box->upper[d], addon->upper[d]);
+  }
+  return;
+}
+
+/**
+ * Returns the margin of a normalized box, that is, the sum of its extents
+ */
+static double
+rstarbox_margin(const RStarBox *box, int ndims)
+{
+  double result = 0;
+  for (int d = 0; d < ndims; d++)
+    result += box->upper[d] - box->lower[d];
+  return result;
+}
+
+/**
+ * Returns the volume of a normalized box
+ */
+static double
+rstarbox_volume(const RStarBox *box, int ndims)
+{
+  double result = 1;
+  for (int d = 0; d < ndims; d++)
+    result *= box->upper[d] - box->lower[d];
+  return result;
+}
+
+/**
+ * Returns the volume of the intersection of two normalized boxes
+ */
+static double
+rstarbox_overlap(const RStarBox *box1, const RStarBox *box2, int ndims)
+{
+  double result = 1;
+  for (int d = 0; d < ndims; d++)
+  {
+    double extent = Min(box1->upper[d], box2->upper[d]) -
+      Max(box1->lower[d], box2->lower[d]);
+    if (extent <= 0)
+      return 0;
+    result *= extent;
+  }
+  return result;
+}
+
+/**
+ * Sorts the entries along an axis and computes the bounding boxes of the
+ * groups of the candidate distributions
+ *
+ * @param[in] boxes Normalized boxes of the entries
+ * @param[in] n,ndims Number of entries and of dimensions
+ * @param[in] dim Axis of the sort
+ * @param[in] byupper True when the entries are sorted by their upper bound
+ * @param[out] intervals Entries in sort order
+ * @param[out] prefix,suffix Bounding boxes of the first k + 1 entries and of
+ * the entries from k on in sort order
+ */
+static void
+rstar_distributions(const RStarBox *boxes, int n, int ndims, int dim,
+  bool byupper, RStarInterval *intervals, RStarBox *prefix, RStarBox *suffix)
+{
+  for (int i = 0; i < n; i++)
+  {
+    intervals[i].lower = boxes[i].lower[dim];
+    intervals[i].upper = boxes[i].upper[dim];
+    intervals[i].index = i;
+  }
+  qsort(intervals, (size_t) n, sizeof(RStarInterval),
+    byupper ? rstar_interval_cmp_upper : rstar_interval_cmp_lower);
+  prefix[0] = boxes[intervals[0].index];
+  for (int i = 1; i < n; i++)
+  {
+    prefix[i] = prefix[i - 1];
+    rstarbox_adjust(&prefix[i], &boxes[intervals[i].index], ndims);
+  }
+  suffix[n - 1] = boxes[intervals[n - 1].index];
+  for (int i = n - 2; i >= 0; i--)
+  {
+    suffix[i] = suffix[i + 1];
+    rstarbox_adjust(&suffix[i], &boxes[intervals[i].index], ndims);
+  }
+  return;
+}
+
+/**
+ * R*-tree split of the entries
+ *
+ * For details see:
+ * "The R*-tree: an efficient and robust access method for points and
+ * rectangles", N. Beckmann, H.-P. Kriegel, R. Schneider, B. Seeger, SIGMOD 1990
+ */
+static void
+stbox_gist_rstar_split(GistEntryVector *entryvec, GIST_SPLITVEC *v)
+{
+  OffsetNumber maxoff = (OffsetNumber) (entryvec->n - 1);
+  int n = maxoff - FirstOffsetNumber + 1;
+  int m = Max(1, (int) ceil(RSTAR_MIN_FILL * (double) n));
+  if (n - m < m)
+  {
+    stbox_gist_fallback_split(entryvec, v);
+    return;
+  }
+
+  /* Determine the dimensions with a nonzero extent */
+  STBOX bbox;
+  for (OffsetNumber i = FirstOffsetNumber; i <= maxoff; i = OffsetNumberNext(i))
+  {
+    STBOX *box = (STBOX *) DatumGetPointer(entryvec->vector[i].key);
+    if (i == FirstOffsetNumber)
+      bbox = *box;
+    else
+      stbox_adjust(&bbox, box);
+  }
+  bool hasz = MOBDB_FLAGS_GET_Z(bbox.flags);
+  int dims[4], ndims = 0;
+  double lower[4], range[4];
+  for (int dim = 0; dim < 4; dim++)
+  {
+    double upper;
+    /* Skip the process for Z dimension if it is missing */
+    if (dim == 2 && ! hasz)
+      continue;
+    stbox_dim_bounds(&bbox, dim, &lower[ndims], &upper);
+    range[ndims] = upper - lower[ndims];
+    if (range[ndims] > 0 && isfinite(range[ndims]))
+      dims[ndims++] = dim;
+  }
+  if (ndims == 0)
+  {
+    stbox_gist_fallback_split(entryvec, v);
+    return;
+  }
+
+  /* Normalize the boxes of the entries */
+  RStarBox *boxes = palloc(sizeof(RStarBox) * n);
+  for (int i = 0; i < n; i++)
+  {
+    STBOX *box = (STBOX *) DatumGetPointer(
+      entryvec->vector[i + FirstOffsetNumber].key);
+    for (int d = 0; d < ndims; d++)
+    {
+      double lo, hi;
+      stbox_dim_bounds(box, dims[d], &lo, &hi);
+      boxes[i].lower[d] = (lo - lower[d]) / range[d];
+      boxes[i].upper[d] = (hi - lower[d]) / range[d];
+    }
+  }
+
+  RStarInterval *intervals = palloc(sizeof(RStarInterval) * n);
+  RStarBox *prefix = palloc(sizeof(RStarBox) * n);
+  RStarBox *suffix = palloc(sizeof(RStarBox) * n);
+
+  /* Choose the axis minimizing the sum of the margins of the distributions */
+  int axis = 0;
+  double minmargin = 0;
+  for (int d = 0; d < ndims; d++)
+  {
+    double margin = 0;
+    for (int s = 0; s < 2; s++)
+    {
+      rstar_distributions(boxes, n, ndims, d, s == 1, intervals, prefix,
+        suffix);
+      /* The left group has the first k entries in sort order */
+      for (int k = m; k <= n - m; k++)
+        margin += rstarbox_margin(&prefix[k - 1], ndims) +
+          rstarbox_margin(&suffix[k], ndims);
+    }
+    if (d == 0 || margin < minmargin)
+    {
+      minmargin = margin;
+      axis = d;
+    }
+  }
+
+  /* Choose the distribution minimizing the overlap and then the volume */
+  bool bestupper = false;
+  int bestk = m;
+  double minoverlap = 0, minvolume = 0;
+  bool first = true;
+  for (int s = 0; s < 2; s++)
+  {
+    rstar_distributions(boxes, n, ndims, axis, s == 1, intervals, prefix,
+      suffix);
+    for (int k = m; k <= n - m; k++)
+    {
+      double overlap = rstarbox_overlap(&prefix[k - 1], &suffix[k], ndims);
+      double volume = rstarbox_volume(&prefix[k - 1], ndims) +
+        rstarbox_volume(&suffix[k], ndims);
+      if (first || overlap < minoverlap ||
+        (overlap == minoverlap && volume < minvolume))
+      {
+        first = false;
+        minoverlap = overlap;
+        minvolume = volume;
+        bestupper = (s == 1);
+        bestk = k;
+      }
+    }
+  }
+
+  /* Distribute the entries according to the selected distribution */
+  rstar_distributions(boxes, n, ndims, axis, bestupper, intervals, prefix,
+    suffix);
+  v->spl_left = (OffsetNumber *) palloc(n * sizeof(OffsetNumber));
+  v->spl_right = (OffsetNumber *) palloc(n * sizeof(OffsetNumber));
+  v->spl_nleft = v->spl_nright = 0;
+  STBOX *leftBox = palloc0(sizeof(STBOX));
+  STBOX *rightBox = palloc0(sizeof(STBOX));
+  for (int i = 0; i < n; i++)
+  {
+    OffsetNumber off = (OffsetNumber) (intervals[i].index + FirstOffsetNumber);
+    STBOX *box = (STBOX *) DatumGetPointer(entryvec->vector[off].key);
+    if (i < bestk)
+    {
+      if (v->spl_nleft > 0)
+        stbox_adjust(leftBox, box);
+      else
+        *leftBox = *box;
+      v->spl_left[v->spl_nleft++] = off;
+    }
+    else
+    {
+      if (v->spl_nright > 0)
+        stbox_adjust(rightBox, box);
+      else
+        *rightBox = *box;
+      v->spl_right[v->spl_nright++] = off;
+    }
+  }
+  v->spl_ldatum = PointerGetDatum(leftBox);
+  v->spl_rdatum = PointerGetDatum(rightBox);
+
+  pfree(boxes); pfree(intervals); pfree(prefix); pfree(suffix);
+  return;
+}
+
+/** Values of the split parameter of the operator classes */
+static relopt_enum_elt_def stbox_gist_split_values[] =
+{
+  {"doublesort", STBOX_SPLIT_DOUBLESORT},
+  {"rstar", STBOX_SPLIT_RSTAR},
+  {(const char *) NULL}
+};
+
+PG_FUNCTION_INFO_V1(stbox_gist_options);
+/**
+ * GiST options method for temporal points, which selects the picksplit
+ * strategy
+ */
+PGDLLEXPORT Datum
+stbox_gist_options(PG_FUNCTION_ARGS)
+{
+  local_relopts *relopts = (local_relopts *) PG_GETARG_POINTER(0);
+  init_local_reloptions(relopts, sizeof(STboxGistOptions));
+  add_local_enum_reloption(relopts, "split",
+    "node splitting algorithm of the index", stbox_gist_split_values,
+    STBOX_SPLIT_DOUBLESORT, "Valid values are \"doublesort\" and \"rstar\".",
+    offsetof(STboxGistOptions, split));
+  PG_RETURN_VOID();
+}
+#endif
+
 PG_FUNCTION_INFO_V1(stbox_gist_picksplit);
 /**
  * GiST picksplit method for temporal points.
@@ -725,6 +1158,16 @@ stbox_gist_picksplit(PG_FUNCTION_ARGS)
   SplitInterval *intervalsLower,
         *intervalsUpper;
   CommonEntry *commonEntries;
+
+#if MOBDB_PGSQL_VERSION >= 130000
+  if (PG_HAS_OPCLASS_OPTIONS() &&
+    ((STboxGistOptions *) PG_GET_OPCLASS_OPTIONS())->split ==
+      STBOX_SPLIT_RSTAR)
+  {
+    stbox_gist_rstar_split(entryvec, v);
+    PG_RETURN_POINTER(v);
+  }
+#endif
   
   memset(&context, 0, sizeof(ConsiderSplitContext));
   
@@ -1119,6 +1562,45 @@ stbox_gist_same(PG_FUNCTION_ARGS)
  * GiST distance method
  *****************************************************************************/
 
+/**
+ * Returns a lower bound of the nearest approach distance between the
+ * temporal points bounded by the key of an index and the query
+ *
+ * When both boxes have a temporal dimension, the distance is restricted to
+ * their common timespan, and a key whose timespan is disjoint from the one of
+ * the query is at an infinite distance, as for the nearest approach distance
+ * operator. This allows a query such as
+ * `ORDER BY temp |=| stbox(geometry 'Point(1 1)', period '[...]')` to prune
+ * the subtrees that do not overlap the period. For planar boxes the distance
+ * is computed directly from the coordinates instead of converting the boxes
+ * into PostGIS geometries.
+ *
+ * @param[in] key Element in the index
+ * @param[in] query Value being looked up in the index
+ * @note This function is used for both GiST and SP-GiST indexes
+ */
+double
+stbox_index_distance(const STBOX *key, const STBOX *query)
+{
+  if (MOBDB_FLAGS_GET_T(key->flags) && MOBDB_FLAGS_GET_T(query->flags) &&
+      (key->tmax < query->tmin || query->tmax < key->tmin))
+    return DBL_MAX;
+  if (! MOBDB_FLAGS_GET_X(key->flags) || ! MOBDB_FLAGS_GET_X(query->flags) ||
+      MOBDB_FLAGS_GET_GEODETIC(key->flags) ||
+      MOBDB_FLAGS_GET_GEODETIC(query->flags))
+    return NAD_stbox_stbox_internal(key, query);
+
+  double dx = Max(Max(query->xmin - key->xmax, key->xmin - query->xmax), 0.0);
+  double dy = Max(Max(query->ymin - key->ymax, key->ymin - query->ymax), 0.0);
+  if (MOBDB_FLAGS_GET_Z(key->flags) && MOBDB_FLAGS_GET_Z(query->flags))
+  {
+    double dz = Max(Max(query->zmin - key->zmax, key->zmin - query->zmax),
+      0.0);
+    return hypot3d(dx, dy, dz);
+  }
+  return hypot(dx, dy);
+}
+
 PG_FUNCTION_INFO_V1(stbox_gist_distance);
 /**
  * GiST support function. Take in a query and an entry and return the "distance"
@@ -1128,7 +1610,6 @@ Datum
 stbox_gist_distance(PG_FUNCTION_ARGS)
 {
   GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
-  Oid subtype = PG_GETARG_OID(3);
   bool *recheck = (bool *) PG_GETARG_POINTER(4);
   STBOX *key = (STBOX *) DatumGetPointer(entry->key);
   STBOX query;
@@ -1141,40 +1622,374 @@ stbox_gist_distance(PG_FUNCTION_ARGS)
   if (key == NULL)
     PG_RETURN_FLOAT8(DBL_MAX);
 
-  /*
-   * Transform the query into a box initializing the dimensions that must
-   * not be taken into account by the operators to infinity.
-   */
-  memset(&query, 0, sizeof(STBOX));
-  if (tgeo_base_type(subtype))
+  if (!tpoint_gist_query(&query, fcinfo))
+    PG_RETURN_FLOAT8(DBL_MAX);
+
+  /* Since we only have boxes we'll return the minimum possible distance,
+   * and let the recheck sort things out in the case of leaves */
+  distance = stbox_index_distance(key, &query);
+
+  PG_RETURN_FLOAT8(distance);
+}
+
+/*****************************************************************************
+ * Multi-box GiST index
+ *
+ * In the multi-box operator class the key of a temporal point is an array of
+ * boxes. The first box is the bounding box of the temporal point and the
+ * other ones, if any, are the boxes of groups of consecutive segments of it,
+ * whose number is bounded by a parameter of the operator class. The keys of
+ * the internal pages only have the bounding box. The segment boxes are only
+ * used by the leaf-level consistency for the &&& operator, all the other
+ * operators are evaluated on the bounding box as in the default operator
+ * class.
+ *****************************************************************************/
+
+/**
+ * Returns the boxes of a key of the multi-box operator class
+ *
+ * @param[in] key Key of the index
+ * @param[out] count Number of boxes
+ */
+static const STBOX *
+multibox_boxes(Datum key, int *count)
+{
+  ArrayType *array = DatumGetArrayTypeP(key);
+  *count = ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array));
+  return (const STBOX *) ARR_DATA_PTR(array);
+}
+
+#if MOBDB_PGSQL_VERSION >= 130000
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_options);
+/**
+ * GiST options method for the multi-box operator class
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_options(PG_FUNCTION_ARGS)
+{
+  local_relopts *relopts = (local_relopts *) PG_GETARG_POINTER(0);
+  init_local_reloptions(relopts, sizeof(MultiboxOptions));
+  add_local_int_reloption(relopts, "boxes",
+    "maximum number of segment boxes per temporal point",
+    MULTIBOX_DEFAULT_BOXES, 1, MULTIBOX_MAX_BOXES,
+    offsetof(MultiboxOptions, maxboxes));
+  PG_RETURN_VOID();
+}
+#endif
+
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_compress);
+/**
+ * GiST compress method for the multi-box operator class
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_compress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  if (entry->leafkey)
   {
-    /* Since function stbox_gist_consistent is strict, query is not NULL */
-    if (!geo_to_stbox_internal(&query, PG_GETARG_GSERIALIZED_P(1)))
-      PG_RETURN_FLOAT8(DBL_MAX);
+    int maxboxes = MULTIBOX_DEFAULT_BOXES;
+#if MOBDB_PGSQL_VERSION >= 130000
+    if (PG_HAS_OPCLASS_OPTIONS())
+      maxboxes = ((MultiboxOptions *) PG_GET_OPCLASS_OPTIONS())->maxboxes;
+#endif
+    GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+    Temporal *temp = DatumGetTemporal(entry->key);
+    STBOX *boxes = palloc(sizeof(STBOX) *
+      (tpoint_segment_stboxes_maxcount(temp) + 1));
+    memset(&boxes[0], 0, sizeof(STBOX));
+    temporal_bbox(&boxes[0], temp);
+    int count = tpoint_segment_stboxes(&boxes[1], temp);
+    count = stboxarr_merge(&boxes[1], count, maxboxes);
+    /* A single segment box is the bounding box */
+    if (count == 1)
+      count = 0;
+    ArrayType *array = stboxarr_to_array(boxes, count + 1);
+    pfree(boxes);
+    gistentryinit(*retval, PointerGetDatum(array), entry->rel, entry->page,
+      entry->offset, false);
+    PG_RETURN_POINTER(retval);
   }
-  else if (subtype == type_oid(T_STBOX))
+  PG_RETURN_POINTER(entry);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_consistent);
+/**
+ * GiST consistent method for the multi-box operator class
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_consistent(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4), result;
+  STBOX query;
+
+  /* Determine whether the index is lossy depending on the strategy */
+  *recheck = tpoint_index_recheck(strategy);
+
+  if (DatumGetPointer(entry->key) == NULL)
+    PG_RETURN_BOOL(false);
+
+  if (!tpoint_gist_query(&query, fcinfo))
+    PG_RETURN_BOOL(false);
+
+  int count;
+  const STBOX *boxes = multibox_boxes(entry->key, &count);
+  if (! GIST_LEAF(entry))
+    result = stbox_gist_consistent_internal(&boxes[0], &query, strategy);
+  else if (strategy == RTOverlapSegmentsStrategyNumber && count > 1)
   {
-    STBOX *box = PG_GETARG_STBOX_P(1);
-    if (box == NULL)
-      PG_RETURN_FLOAT8(DBL_MAX);
-    memcpy(&query, box, sizeof(STBOX));
+    result = false;
+    if (overlaps_stbox_stbox_internal(&boxes[0], &query))
+    {
+      for (int i = 1; i < count; i++)
+      {
+        if (overlaps_stbox_stbox_internal(&boxes[i], &query))
+        {
+          result = true;
+          break;
+        }
+      }
+    }
   }
-  else if (tgeo_type(subtype))
+  else
+    result = stbox_index_consistent_leaf(&boxes[0], &query, strategy);
+
+  PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_union);
+/**
+ * GiST union method for the multi-box operator class
+ *
+ * Returns a key with the minimal bounding box that encloses all the entries
+ * in entryvec
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_union(PG_FUNCTION_ARGS)
+{
+  GistEntryVector *entryvec = (GistEntryVector *) PG_GETARG_POINTER(0);
+  int *sizep = (int *) PG_GETARG_POINTER(1);
+  int count;
+  STBOX pageunion;
+  memcpy(&pageunion, multibox_boxes(entryvec->vector[0].key, &count),
+    sizeof(STBOX));
+  for (int i = 1; i < entryvec->n; i++)
+    stbox_adjust(&pageunion, multibox_boxes(entryvec->vector[i].key, &count));
+  ArrayType *result = stboxarr_to_array(&pageunion, 1);
+  *sizep = VARSIZE(result);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_penalty);
+/**
+ * GiST penalty method for the multi-box operator class, which uses the
+ * bounding boxes of the keys
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_penalty(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *origentry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  GISTENTRY *newentry = (GISTENTRY *) PG_GETARG_POINTER(1);
+  float *result = (float *) PG_GETARG_POINTER(2);
+  int count;
+  const STBOX *origbox = multibox_boxes(origentry->key, &count);
+  const STBOX *newbox = multibox_boxes(newentry->key, &count);
+  *result = (float) stbox_penalty(origbox, newbox);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_picksplit);
+/**
+ * GiST picksplit method for the multi-box operator class
+ *
+ * The entries are split as in the default operator class according to their
+ * bounding boxes
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_picksplit(PG_FUNCTION_ARGS)
+{
+  GistEntryVector *entryvec = (GistEntryVector *) PG_GETARG_POINTER(0);
+  GIST_SPLITVEC *v = (GIST_SPLITVEC *) PG_GETARG_POINTER(1);
+  GistEntryVector *boxvec = palloc(GEVHDRSZ +
+    sizeof(GISTENTRY) * entryvec->n);
+  STBOX *boxes = palloc(sizeof(STBOX) * entryvec->n);
+  boxvec->n = entryvec->n;
+  for (OffsetNumber i = FirstOffsetNumber; i < entryvec->n;
+    i = OffsetNumberNext(i))
   {
-    Temporal *temp = PG_GETARG_TEMPORAL(1);
-    if (temp == NULL)
-      PG_RETURN_FLOAT8(DBL_MAX);
-    temporal_bbox(&query, temp);
-    PG_FREE_IF_COPY(temp, 1);
+    int count;
+    memcpy(&boxes[i], multibox_boxes(entryvec->vector[i].key, &count),
+      sizeof(STBOX));
+    boxvec->vector[i] = entryvec->vector[i];
+    boxvec->vector[i].key = PointerGetDatum(&boxes[i]);
   }
-  else
-    elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+  DirectFunctionCall2(stbox_gist_picksplit, PointerGetDatum(boxvec),
+    PointerGetDatum(v));
+  v->spl_ldatum = PointerGetDatum(stboxarr_to_array(
+    (STBOX *) DatumGetPointer(v->spl_ldatum), 1));
+  v->spl_rdatum = PointerGetDatum(stboxarr_to_array(
+    (STBOX *) DatumGetPointer(v->spl_rdatum), 1));
+  PG_RETURN_POINTER(v);
+}
 
-  /* Since we only have boxes we'll return the minimum possible distance,
-   * and let the recheck sort things out in the case of leaves */
-  distance = NAD_stbox_stbox_internal(key, &query);
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_same);
+/**
+ * GiST same method for the multi-box operator class
+ *
+ * Returns true only when the keys have exactly the same boxes
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_same(PG_FUNCTION_ARGS)
+{
+  ArrayType *array1 = PG_GETARG_ARRAYTYPE_P(0);
+  ArrayType *array2 = PG_GETARG_ARRAYTYPE_P(1);
+  bool *result = (bool *) PG_GETARG_POINTER(2);
+  *result = VARSIZE(array1) == VARSIZE(array2) &&
+    memcmp(array1, array2, VARSIZE(array1)) == 0;
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_gist_multibox_distance);
+/**
+ * GiST distance method for the multi-box operator class
+ *
+ * The distance of a leaf is the minimum distance of its segment boxes, and
+ * when the query has a temporal dimension only the boxes of the segments
+ * overlapping its timespan are considered, which is tighter than the bound
+ * given by the box of the whole temporal point
+ */
+PGDLLEXPORT Datum
+tpoint_gist_multibox_distance(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4);
+  STBOX query;
+
+  /* The index is lossy for leaf levels */
+  if (GIST_LEAF(entry))
+    *recheck = true;
+
+  if (DatumGetPointer(entry->key) == NULL)
+    PG_RETURN_FLOAT8(DBL_MAX);
+
+  if (!tpoint_gist_query(&query, fcinfo))
+    PG_RETURN_FLOAT8(DBL_MAX);
 
+  int count;
+  const STBOX *boxes = multibox_boxes(entry->key, &count);
+  if (! GIST_LEAF(entry) || count == 1)
+    PG_RETURN_FLOAT8(stbox_index_distance(&boxes[0], &query));
+  double distance = DBL_MAX;
+  for (int i = 1; i < count; i++)
+    distance = Min(distance, stbox_index_distance(&boxes[i], &query));
   PG_RETURN_FLOAT8(distance);
 }
 
+/*****************************************************************************
+ * Compact GiST index
+ *
+ * In the compact operator classes the spatial bounds of the keys are stored
+ * as float4 values rounded outward, so that the key of a temporal point
+ * always contains its bounding box. Since a leaf key may be larger than the
+ * bounding box, the tests for the leaves are those for the internal nodes
+ * and the index is always lossy. The keys are decompressed into
+ * spatiotemporal boxes so that the other support functions are those of the
+ * default operator classes.
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(stbox_gist_compact_consistent);
+/**
+ * GiST consistent method for the compact operator classes
+ */
+PGDLLEXPORT Datum
+stbox_gist_compact_consistent(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4);
+  STBOX *key = (STBOX *) DatumGetPointer(entry->key), query;
+
+  /* The keys are larger than the bounding boxes */
+  *recheck = true;
+
+  if (key == NULL)
+    PG_RETURN_BOOL(false);
+
+  if (!tpoint_gist_query(&query, fcinfo))
+    PG_RETURN_BOOL(false);
+
+  PG_RETURN_BOOL(stbox_gist_consistent_internal(key, &query, strategy));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_gist_compact_compress);
+/**
+ * GiST compress method for the compact operator classes
+ *
+ * Both the leaf keys, which are temporal points, and the keys of the
+ * internal nodes, which are spatiotemporal boxes, are compressed.
+ */
+PGDLLEXPORT Datum
+tpoint_gist_compact_compress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+  STBOX box;
+  STBOXF boxf;
+  if (entry->leafkey)
+  {
+    memset(&box, 0, sizeof(STBOX));
+    temporal_bbox(&box, DatumGetTemporal(entry->key));
+  }
+  else
+    memcpy(&box, DatumGetSTboxP(entry->key), sizeof(STBOX));
+  memset(&boxf, 0, sizeof(STBOXF));
+  boxf.xmin = float4_round_down(box.xmin);
+  boxf.xmax = float4_round_up(box.xmax);
+  boxf.ymin = float4_round_down(box.ymin);
+  boxf.ymax = float4_round_up(box.ymax);
+  boxf.zmin = float4_round_down(box.zmin);
+  boxf.zmax = float4_round_up(box.zmax);
+  boxf.tmin = box.tmin;
+  boxf.tmax = box.tmax;
+  boxf.srid = box.srid;
+  boxf.flags = box.flags;
+  bytea *key = palloc(VARHDRSZ + STBOXF_SIZE);
+  SET_VARSIZE(key, VARHDRSZ + STBOXF_SIZE);
+  memcpy(VARDATA(key), &boxf, STBOXF_SIZE);
+  gistentryinit(*retval, PointerGetDatum(key), entry->rel, entry->page,
+    entry->offset, false);
+  PG_RETURN_POINTER(retval);
+}
+
+PG_FUNCTION_INFO_V1(stbox_gist_compact_decompress);
+/**
+ * GiST decompress method for the compact operator classes (result in an
+ * stbox)
+ */
+PGDLLEXPORT Datum
+stbox_gist_compact_decompress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+  bytea *key = (bytea *) PG_DETOAST_DATUM_PACKED(entry->key);
+  STBOX *box = palloc0(sizeof(STBOX));
+  STBOXF boxf;
+  memset(&boxf, 0, sizeof(STBOXF));
+  memcpy(&boxf, VARDATA_ANY(key), STBOXF_SIZE);
+  box->xmin = boxf.xmin;
+  box->xmax = boxf.xmax;
+  box->ymin = boxf.ymin;
+  box->ymax = boxf.ymax;
+  box->zmin = boxf.zmin;
+  box->zmax = boxf.zmax;
+  box->tmin = boxf.tmin;
+  box->tmax = boxf.tmax;
+  box->srid = boxf.srid;
+  box->flags = boxf.flags;
+  gistentryinit(*retval, PointerGetDatum(box), entry->rel, entry->page,
+    entry->offset, entry->leafkey);
+  PG_RETURN_POINTER(retval);
+}
+
 /*****************************************************************************/
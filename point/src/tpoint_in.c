@@ -14,11 +14,13 @@
 
 #include <assert.h>
 #include <float.h>
-#include <json-c/json.h>
+#include <math.h>
+#include <utils/builtins.h>
 
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_parser.h"
 #include "postgis.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
@@ -27,217 +29,847 @@
  * Input in MFJSON format 
  *****************************************************************************/
 
+/*
+ * The MF-JSON string is read in a single pass by a recursive-descent parser
+ * that does not build a document tree. The members that are not needed for
+ * constructing the temporal point are skipped, while the coordinates and the
+ * timestamps are accumulated in packed arrays that grow with the input. The
+ * parser only records what it has found, the validation is done afterwards
+ * in the same order as when the members are looked up by name, so that the
+ * error messages do not depend on the order of the members in the object.
+ * Strings are unescaped in place in the input buffer, which is a copy of
+ * the argument, and therefore they do not need to be copied.
+ */
+
+/**
+ * Kinds of the values of the members of an MF-JSON object
+ */
+typedef enum
+{
+  MFJSON_MISSING,
+  MFJSON_STRING,
+  MFJSON_ARRAY,
+  MFJSON_OTHER,
+} mfjson_kind;
+
+/**
+ * Members of an MF-JSON object defining a temporal instant or a sequence
+ */
+typedef struct
+{
+  bool isobject;         /**< The value is an object */
+  bool empty;            /**< The object has no members */
+  mfjson_kind coordkind; /**< Kind of the 'coordinates' member */
+  int coordnum;          /**< Number of elements of the 'coordinates' array */
+  bool coordnested;      /**< The elements of 'coordinates' are arrays */
+  const char *coorderr;  /**< First error found in the 'coordinates' array */
+  int coordstart;        /**< Position of the points in the packed array */
+  mfjson_kind timekind;  /**< Kind of the 'datetimes' member */
+  char *timestr;         /**< Value of the 'datetimes' member if string */
+  int timenum;           /**< Number of elements of the 'datetimes' array */
+  bool timeerr;          /**< Some element of 'datetimes' is not a string */
+  int timestart;         /**< Position of the timestamps in the packed array */
+  bool haslower;         /**< The 'lower_inc' member was found */
+  bool lower_inc;        /**< Value of the 'lower_inc' member */
+  bool hasupper;         /**< The 'upper_inc' member was found */
+  bool upper_inc;        /**< Value of the 'upper_inc' member */
+} mfjson_seq;
+
+/**
+ * Structure used for passing the parse state between the parsing functions
+ */
+typedef struct
+{
+  char *pos;             /**< Current parse position */
+  double *coords;        /**< Packed coordinates, three per point */
+  int npoints;           /**< Number of points in the packed array */
+  int maxpoints;         /**< Capacity of the packed array of points */
+  TimestampTz *times;    /**< Packed timestamps */
+  int ntimes;            /**< Number of timestamps in the packed array */
+  int maxtimes;          /**< Capacity of the packed array of timestamps */
+} mfjson_state;
+
+/**
+ * Members of an MF-JSON object defining a temporal point
+ */
+typedef struct
+{
+  mfjson_seq seq;         /**< Members of the temporal instant or sequence */
+  mfjson_kind typekind;   /**< Kind of the 'type' member */
+  char *type;             /**< Value of the 'type' member if string */
+  mfjson_kind interpkind; /**< Kind of the 'interpolations' member */
+  int interpnum;          /**< Number of elements of 'interpolations' */
+  char *interp;           /**< First element of 'interpolations' if string */
+  bool crserror;          /**< An empty object was found in 'crs' */
+  char *srs;              /**< Name of the spatial reference system */
+  mfjson_kind seqskind;   /**< Kind of the 'sequences' member */
+  int seqsnum;            /**< Number of elements of 'sequences' */
+  int maxseqs;            /**< Capacity of the array of sequences */
+  mfjson_seq *seqs;       /**< Elements of 'sequences' */
+} mfjson_doc;
+
+#define MFJSON_INITIAL_SIZE 64
+
+#define MFJSON_ERR_COORD_VALUE \
+  "Invalid value of the 'coordinates' array in MFJSON string"
+#define MFJSON_ERR_COORD_FEW \
+  "Too few elements in 'coordinates' values in MFJSON string"
+#define MFJSON_ERR_COORD_MANY \
+  "Too many elements in 'coordinates' values in MFJSON string"
+
+/**
+ * Raise the error for a string that is not valid JSON
+ */
+static void
+mfjson_syntax_error(void)
+{
+  ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+    errmsg("Error while processing MFJSON string")));
+}
+
+/**
+ * Raise an error with the message given as argument
+ */
+static void
+mfjson_error(const char *msg)
+{
+  ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+    errmsg("%s", msg)));
+}
+
+/**
+ * Skip the whitespace characters
+ */
+static void
+mfjson_whitespace(mfjson_state *state)
+{
+  while (*state->pos == ' ' || *state->pos == '\t' || *state->pos == '\n' ||
+      *state->pos == '\r')
+    state->pos++;
+}
+
+/**
+ * Consume the character given as argument, which must be the next one
+ */
+static void
+mfjson_expect(mfjson_state *state, char c)
+{
+  mfjson_whitespace(state);
+  if (*state->pos != c)
+    mfjson_syntax_error();
+  state->pos++;
+}
+
+/**
+ * Returns true if there is a next element in the array or the object whose
+ * opening character has been consumed. In that case the parse position is
+ * set at the start of the element.
+ */
+static bool
+mfjson_next(mfjson_state *state, char close, bool *first)
+{
+  mfjson_whitespace(state);
+  if (*state->pos == close)
+  {
+    state->pos++;
+    return false;
+  }
+  if (! *first)
+  {
+    if (*state->pos != ',')
+      mfjson_syntax_error();
+    state->pos++;
+    mfjson_whitespace(state);
+  }
+  *first = false;
+  return true;
+}
+
 /**
- * Convert a text value into a C string
+ * Returns a string whose opening quote is at the parse position
  *
- * @note We don't include <utils/builtins.h> to avoid collisions with json-c/json.h 
- * @note Function taken from PostGIS file lwgeom_in_geojson.c
+ * @note The string is unescaped in place and terminated by replacing the
+ * closing quote by a null character
+ */
+static char *
+mfjson_string(mfjson_state *state, int *len)
+{
+  mfjson_expect(state, '"');
+  char *result = state->pos, *out = state->pos, *in = state->pos;
+  while (*in != '"')
+  {
+    if (*in == '\0' || (unsigned char) *in < 0x20)
+      mfjson_syntax_error();
+    if (*in != '\\')
+    {
+      *out++ = *in++;
+      continue;
+    }
+    in++;
+    switch (*in++)
+    {
+      case '"': *out++ = '"'; break;
+      case '\\': *out++ = '\\'; break;
+      case '/': *out++ = '/'; break;
+      case 'b': *out++ = '\b'; break;
+      case 'f': *out++ = '\f'; break;
+      case 'n': *out++ = '\n'; break;
+      case 'r': *out++ = '\r'; break;
+      case 't': *out++ = '\t'; break;
+      case 'u':
+      {
+        unsigned int code = 0;
+        for (int i = 0; i < 4; i++, in++)
+        {
+          char c = *in;
+          code <<= 4;
+          if (c >= '0' && c <= '9')
+            code |= (unsigned int) (c - '0');
+          else if (c >= 'a' && c <= 'f')
+            code |= (unsigned int) (c - 'a' + 10);
+          else if (c >= 'A' && c <= 'F')
+            code |= (unsigned int) (c - 'A' + 10);
+          else
+            mfjson_syntax_error();
+        }
+        /* The UTF-8 encoding is never longer than the escape sequence */
+        if (code < 0x80)
+          *out++ = (char) code;
+        else if (code < 0x800)
+        {
+          *out++ = (char) (0xC0 | (code >> 6));
+          *out++ = (char) (0x80 | (code & 0x3F));
+        }
+        else
+        {
+          *out++ = (char) (0xE0 | (code >> 12));
+          *out++ = (char) (0x80 | ((code >> 6) & 0x3F));
+          *out++ = (char) (0x80 | (code & 0x3F));
+        }
+        break;
+      }
+      default:
+        mfjson_syntax_error();
+    }
+  }
+  *out = '\0';
+  state->pos = in + 1;
+  if (len)
+    *len = (int) (out - result);
+  return result;
+}
+
+/**
+ * Returns true if a number starts at the parse position
  */
-static char*
-text2cstring(const text *textptr)
+static bool
+mfjson_is_number(const mfjson_state *state)
 {
-  size_t size = VARSIZE_ANY_EXHDR(textptr);
-  char *str = palloc(size + 1);
-  memcpy(str, VARDATA(textptr), size);
-  str[size]='\0';
-  return str;
+  return *state->pos == '-' || (*state->pos >= '0' && *state->pos <= '9');
 }
 
 /**
- * Returns the JSON member corresponding to the name
+ * Returns the number at the parse position
  *
- * @note Function taken from PostGIS file lwin_geojson.c
+ * @note The syntax of the number is verified before calling strtod, which
+ * would otherwise accept other forms such as hexadecimal numbers
+ */
+static double
+mfjson_number(mfjson_state *state)
+{
+  char *end = state->pos;
+  if (*end == '-')
+    end++;
+  if (*end < '0' || *end > '9')
+    mfjson_syntax_error();
+  while (*end >= '0' && *end <= '9')
+    end++;
+  if (*end == '.')
+  {
+    end++;
+    if (*end < '0' || *end > '9')
+      mfjson_syntax_error();
+    while (*end >= '0' && *end <= '9')
+      end++;
+  }
+  if (*end == 'e' || *end == 'E')
+  {
+    end++;
+    if (*end == '+' || *end == '-')
+      end++;
+    if (*end < '0' || *end > '9')
+      mfjson_syntax_error();
+    while (*end >= '0' && *end <= '9')
+      end++;
+  }
+  double result = strtod(state->pos, NULL);
+  state->pos = end;
+  return result;
+}
+
+/**
+ * Consume the literal given as argument if it is at the parse position
  */
-static json_object *
-findMemberByName(json_object *poObj, const char *pszName )
+static bool
+mfjson_literal(mfjson_state *state, const char *literal)
 {
-  json_object *poTmp = poObj;
-  json_object_iter it;
+  size_t len = strlen(literal);
+  if (strncmp(state->pos, literal, len) != 0)
+    return false;
+  state->pos += len;
+  return true;
+}
 
-  if (pszName == NULL || poObj == NULL)
-    return NULL;
+/**
+ * Consume a null value if it is at the parse position. Members with a null
+ * value are considered as missing.
+ */
+static bool
+mfjson_null(mfjson_state *state)
+{
+  return mfjson_literal(state, "null");
+}
 
-  it.key = NULL;
-  it.val = NULL;
-  it.entry = NULL;
+/**
+ * Returns true if there is a next member in the object whose opening brace
+ * has been consumed. In that case the key of the member is returned and the
+ * parse position is set at the start of its value.
+ */
+static bool
+mfjson_member_next(mfjson_state *state, bool *first, char **key)
+{
+  if (! mfjson_next(state, '}', first))
+    return false;
+  *key = mfjson_string(state, NULL);
+  mfjson_expect(state, ':');
+  mfjson_whitespace(state);
+  return true;
+}
 
-  if (json_object_get_object(poTmp) != NULL)
+/**
+ * Skip the value at the parse position
+ */
+static void
+mfjson_skip(mfjson_state *state)
+{
+  bool first = true;
+  char *key;
+  mfjson_whitespace(state);
+  switch (*state->pos)
   {
-    if (json_object_get_object(poTmp)->head == NULL)
+    case '"':
+      mfjson_string(state, NULL);
+      break;
+    case '[':
+      state->pos++;
+      while (mfjson_next(state, ']', &first))
+        mfjson_skip(state);
+      break;
+    case '{':
+      state->pos++;
+      while (mfjson_member_next(state, &first, &key))
+        mfjson_skip(state);
+      break;
+    default:
+      if (mfjson_is_number(state))
+        mfjson_number(state);
+      else if (! mfjson_literal(state, "true") &&
+          ! mfjson_literal(state, "false") && ! mfjson_null(state))
+        mfjson_syntax_error();
+  }
+}
+
+/**
+ * Returns the kind of a value that is not an array and skip it
+ */
+static mfjson_kind
+mfjson_skip_kind(mfjson_state *state)
+{
+  mfjson_kind result = (*state->pos == '"') ? MFJSON_STRING : MFJSON_OTHER;
+  mfjson_skip(state);
+  return result;
+}
+
+/*****************************************************************************/
+
+/**
+ * Append a point to the packed array of points. The Z coordinate of the
+ * points without Z is set to NaN, which is not a valid JSON number.
+ */
+static void
+mfjson_add_point(mfjson_state *state, const double *coord, int numcoord)
+{
+  if (state->npoints == state->maxpoints)
+  {
+    state->maxpoints *= 2;
+    state->coords = repalloc(state->coords,
+      sizeof(double) * 3 * state->maxpoints);
+  }
+  double *point = state->coords + 3 * state->npoints++;
+  point[0] = coord[0];
+  point[1] = coord[1];
+  point[2] = (numcoord == 3) ? coord[2] : NAN;
+  return;
+}
+
+/**
+ * Returns the timestamp from its MF-JSON string
+ */
+static TimestampTz
+mfjson_timestamp(char *str, int len)
+{
+  /* Replace 'T' by ' ' before converting to timestamptz */
+  if (len > 10 && str[10] == 'T')
+    str[10] = ' ';
+  return timestamp_parse(&str);
+}
+
+/**
+ * Append a timestamp to the packed array of timestamps
+ */
+static void
+mfjson_add_timestamp(mfjson_state *state, TimestampTz t)
+{
+  if (state->ntimes == state->maxtimes)
+  {
+    state->maxtimes *= 2;
+    state->times = repalloc(state->times,
+      sizeof(TimestampTz) * state->maxtimes);
+  }
+  state->times[state->ntimes++] = t;
+  return;
+}
+
+/**
+ * Parse the array of coordinates of a point whose opening bracket is at the
+ * parse position, such as [1,1], and append the point to the packed array.
+ * Returns the error message if the array is not valid.
+ */
+static const char *
+mfjson_parse_point(mfjson_state *state)
+{
+  double coord[3];
+  int numcoord = 0;
+  bool first = true, valid = true;
+  state->pos++;
+  while (mfjson_next(state, ']', &first))
+  {
+    if (mfjson_is_number(state))
     {
-      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-        errmsg("Invalid MFJSON string")));
-      return NULL;
+      double d = mfjson_number(state);
+      if (numcoord < 3)
+        coord[numcoord] = d;
     }
-    for (it.entry = json_object_get_object(poTmp)->head;
-        ( it.entry ?
-          ( it.key = (char*)it.entry->k,
-          it.val = (json_object*)it.entry->v, it.entry) : 0);
-        it.entry = it.entry->next)
+    else
     {
-      if (strcasecmp(it.key, pszName) == 0)
-        return it.val;
+      mfjson_skip(state);
+      valid = false;
     }
+    numcoord++;
   }
+  if (numcoord < 2)
+    return MFJSON_ERR_COORD_FEW;
+  if (numcoord > 3)
+    return MFJSON_ERR_COORD_MANY;
+  if (! valid)
+    return MFJSON_ERR_COORD_VALUE;
+  mfjson_add_point(state, coord, numcoord);
   return NULL;
 }
 
 /**
- * Returns a single point from its MF-JSON coordinates. In this case the
- * coordinate array is a single array of cordinations such as 
- * "coordinates":[1,1]
+ * Parse the value of the 'coordinates' member, which is either the array of
+ * coordinates of a single point, such as [1,1], or an array of arrays of
+ * coordinates, such as [[1,1],[2,2]]. Which of them is expected is only
+ * known after the 'interpolations' member is read, and thus both forms are
+ * accepted here while the errors are recorded for the validation.
  */
-static Datum
-parse_mfjson_coord(json_object *poObj, int srid)
+static void
+mfjson_parse_coordinates(mfjson_state *state, mfjson_seq *seq)
 {
-  if (json_type_array != json_object_get_type(poObj))
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid value of the 'coordinates' array in MFJSON string")));
-
-  const int numcoord = json_object_array_length(poObj);
-  if (numcoord < 2)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Too few elements in 'coordinates' values in MFJSON string")));
-  else if (numcoord > 3)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Too many elements in 'coordinates' values in MFJSON string")));
+  seq->coordnum = 0;
+  seq->coordnested = false;
+  seq->coorderr = NULL;
+  seq->coordstart = state->npoints;
+  if (*state->pos != '[')
+  {
+    seq->coordkind = mfjson_skip_kind(state);
+    return;
+  }
+  seq->coordkind = MFJSON_ARRAY;
+  state->pos++;
+
+  double coord[3];
+  const char *err = NULL;
+  int numbers = 0, erridx = -1, numidx = -1;
+  bool first = true, valid = true;
+  while (mfjson_next(state, ']', &first))
+  {
+    if (*state->pos == '[')
+    {
+      seq->coordnested = true;
+      const char *pointerr = mfjson_parse_point(state);
+      if (pointerr && ! err)
+      {
+        err = pointerr;
+        erridx = seq->coordnum;
+      }
+    }
+    else
+    {
+      if (numidx < 0)
+        numidx = seq->coordnum;
+      if (mfjson_is_number(state))
+      {
+        double d = mfjson_number(state);
+        if (numbers < 3)
+          coord[numbers] = d;
+        numbers++;
+      }
+      else
+      {
+        mfjson_skip(state);
+        valid = false;
+      }
+    }
+    seq->coordnum++;
+  }
 
-  double x, y;
-  json_object *poObjCoord = NULL;
+  if (seq->coordnested)
+  {
+    /* The elements that are not arrays are invalid points */
+    if (numidx >= 0 && (! err || numidx < erridx))
+      err = MFJSON_ERR_COORD_VALUE;
+    seq->coorderr = err;
+  }
+  else if (! valid)
+    seq->coorderr = MFJSON_ERR_COORD_VALUE;
+  else if (numbers >= 2 && numbers <= 3)
+    mfjson_add_point(state, coord, numbers);
+  return;
+}
 
-  /* Read X coordinate */
-  poObjCoord = json_object_array_get_idx(poObj, 0);
-  x = json_object_get_double(poObjCoord);
+/**
+ * Parse the value of the 'datetimes' member, which is either a single
+ * string or an array of strings
+ */
+static void
+mfjson_parse_datetimes(mfjson_state *state, mfjson_seq *seq)
+{
+  seq->timestr = NULL;
+  seq->timenum = 0;
+  seq->timeerr = false;
+  seq->timestart = state->ntimes;
+  if (*state->pos == '"')
+  {
+    seq->timekind = MFJSON_STRING;
+    seq->timestr = mfjson_string(state, NULL);
+    return;
+  }
+  if (*state->pos != '[')
+  {
+    seq->timekind = mfjson_skip_kind(state);
+    return;
+  }
+  seq->timekind = MFJSON_ARRAY;
+  state->pos++;
+  bool first = true;
+  while (mfjson_next(state, ']', &first))
+  {
+    if (*state->pos == '"')
+    {
+      int len;
+      char *str = mfjson_string(state, &len);
+      mfjson_add_timestamp(state, mfjson_timestamp(str, len));
+    }
+    else
+    {
+      mfjson_skip(state);
+      seq->timeerr = true;
+    }
+    seq->timenum++;
+  }
+  return;
+}
 
-  /* Read Y coordinate */
-  poObjCoord = json_object_array_get_idx(poObj, 1);
-  y = json_object_get_double(poObjCoord);
+/**
+ * Returns the value of a Boolean member at the parse position. As for the
+ * other JSON libraries, values that are not Boolean are converted.
+ */
+static bool
+mfjson_parse_bool(mfjson_state *state)
+{
+  if (mfjson_literal(state, "true"))
+    return true;
+  if (mfjson_literal(state, "false"))
+    return false;
+  if (mfjson_is_number(state))
+    return mfjson_number(state) != 0;
+  if (*state->pos == '"')
+  {
+    int len;
+    mfjson_string(state, &len);
+    return len > 0;
+  }
+  mfjson_skip(state);
+  return false;
+}
 
-  LWPOINT *point;
-  if (numcoord == 3)
+/**
+ * Parse the value of a member of a temporal instant or sequence.
+ * Returns false if the key does not correspond to any of these members.
+ */
+static bool
+mfjson_parse_seq_member(mfjson_state *state, mfjson_seq *seq,
+  const char *key)
+{
+  if (strcasecmp(key, "coordinates") == 0)
+    mfjson_parse_coordinates(state, seq);
+  else if (strcasecmp(key, "datetimes") == 0)
+    mfjson_parse_datetimes(state, seq);
+  else if (strcasecmp(key, "lower_inc") == 0)
+  {
+    seq->haslower = true;
+    seq->lower_inc = mfjson_parse_bool(state);
+  }
+  else if (strcasecmp(key, "upper_inc") == 0)
   {
-    /* Read Z coordinate */
-    poObjCoord = json_object_array_get_idx(poObj, 2);
-    double z = json_object_get_double(poObjCoord);
-    point = lwpoint_make3dz(srid, x, y, z);
+    seq->hasupper = true;
+    seq->upper_inc = mfjson_parse_bool(state);
   }
   else
-    point = lwpoint_make2d(srid, x, y);
+    return false;
+  return true;
+}
 
-  Datum result = PointerGetDatum(geo_serialize((LWGEOM *) point));
-  lwpoint_free(point);
-  return result;
+/**
+ * Parse an element of the 'sequences' array
+ */
+static void
+mfjson_parse_seq(mfjson_state *state, mfjson_seq *seq)
+{
+  memset(seq, 0, sizeof(mfjson_seq));
+  if (*state->pos != '{')
+  {
+    mfjson_skip(state);
+    return;
+  }
+  seq->isobject = true;
+  seq->empty = true;
+  state->pos++;
+  bool first = true;
+  char *key;
+  while (mfjson_member_next(state, &first, &key))
+  {
+    seq->empty = false;
+    if (! mfjson_null(state) && ! mfjson_parse_seq_member(state, seq, key))
+      mfjson_skip(state);
+  }
+  return;
 }
 
-/* TODO MAKE POSSIBLE TO CALL THIS FUNCTION */
 /**
- * Returns an array of points from its MF-JSON coordinates. In this case the
- * coordinate array is an array of arrays of cordinates such as 
- * "coordinates":[[1,1],[2,2]]
+ * Parse the value of the 'sequences' member
  */
-static Datum *
-parse_mfjson_points(json_object *mfjson, int srid, int *count)
+static void
+mfjson_parse_sequences(mfjson_state *state, mfjson_doc *doc)
 {
-  json_object *mfjsonTmp = mfjson;
-  json_object *coordinates = NULL;
-  coordinates = findMemberByName(mfjsonTmp, "coordinates");
-  if (coordinates == NULL)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Unable to find 'coordinates' in MFJSON string")));
-  if (json_object_get_type(coordinates) != json_type_array)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid 'coordinates' array in MFJSON string")));
+  doc->seqsnum = 0;
+  if (*state->pos != '[')
+  {
+    doc->seqskind = mfjson_skip_kind(state);
+    return;
+  }
+  doc->seqskind = MFJSON_ARRAY;
+  state->pos++;
+  bool first = true;
+  while (mfjson_next(state, ']', &first))
+  {
+    if (doc->seqsnum == doc->maxseqs)
+    {
+      doc->maxseqs = doc->maxseqs ? doc->maxseqs * 2 : MFJSON_INITIAL_SIZE;
+      doc->seqs = doc->seqs ?
+        repalloc(doc->seqs, sizeof(mfjson_seq) * doc->maxseqs) :
+        palloc(sizeof(mfjson_seq) * doc->maxseqs);
+    }
+    mfjson_parse_seq(state, &doc->seqs[doc->seqsnum++]);
+  }
+  return;
+}
 
-  int numpoints = json_object_array_length(coordinates);
-  if (numpoints < 1)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid value of 'coordinates' array in MFJSON string")));
-  
-  Datum *values = palloc(sizeof(Datum) * numpoints);
-  for (int i = 0; i < numpoints; ++i)
+/**
+ * Parse the value of the 'interpolations' member
+ */
+static void
+mfjson_parse_interpolations(mfjson_state *state, mfjson_doc *doc)
+{
+  doc->interpnum = 0;
+  doc->interp = NULL;
+  if (*state->pos != '[')
   {
-    json_object *coords = NULL;
-    coords = json_object_array_get_idx(coordinates, i);
-    values[i] = parse_mfjson_coord(coords, srid);
+    doc->interpkind = mfjson_skip_kind(state);
+    return;
   }
-  *count = numpoints;
-  return values;
+  doc->interpkind = MFJSON_ARRAY;
+  state->pos++;
+  bool first = true;
+  while (mfjson_next(state, ']', &first))
+  {
+    if (doc->interpnum == 0 && *state->pos == '"')
+      doc->interp = mfjson_string(state, NULL);
+    else
+      mfjson_skip(state);
+    doc->interpnum++;
+  }
+  return;
 }
 
 /**
- * Returns an array of timestamps from its MF-JSON datetimes values
+ * Parse the value of the 'crs' member, such as
+ * {"type":"Name","properties":{"name":"EPSG:4326"}}
  */
-static TimestampTz *
-parse_mfjson_datetimes(json_object *mfjson, int *count)
+static void
+mfjson_parse_crs(mfjson_state *state, mfjson_doc *doc)
 {
-  json_object *datetimes = NULL;
-  datetimes = findMemberByName(mfjson, "datetimes");
-  if (datetimes == NULL)
-      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-        errmsg("Unable to find 'datetimes' in MFJSON string")));
-  if (json_object_get_type(datetimes) != json_type_array)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid 'datetimes' array in MFJSON string")));
+  bool hastype = false, empty = true, propsempty = false, first = true;
+  char *key, *srs = NULL;
+  doc->crserror = false;
+  doc->srs = NULL;
+  if (*state->pos != '{')
+  {
+    mfjson_skip(state);
+    return;
+  }
+  state->pos++;
+  while (mfjson_member_next(state, &first, &key))
+  {
+    empty = false;
+    if (mfjson_null(state))
+      continue;
+    if (strcasecmp(key, "type") == 0)
+    {
+      hastype = true;
+      mfjson_skip(state);
+    }
+    else if (strcasecmp(key, "properties") == 0 && *state->pos == '{')
+    {
+      bool propsfirst = true;
+      char *propkey;
+      propsempty = true;
+      srs = NULL;
+      state->pos++;
+      while (mfjson_member_next(state, &propsfirst, &propkey))
+      {
+        propsempty = false;
+        if (mfjson_null(state))
+          continue;
+        if (strcasecmp(propkey, "name") == 0 && *state->pos == '"')
+          srs = mfjson_string(state, NULL);
+        else
+          mfjson_skip(state);
+      }
+    }
+    else
+      mfjson_skip(state);
+  }
+  /* The members of empty objects cannot be looked up */
+  doc->crserror = empty || (hastype && propsempty);
+  if (hastype)
+    doc->srs = srs;
+  return;
+}
 
-  int numdates = json_object_array_length(datetimes);
-  if (numdates < 1)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid value of 'datetimes' array in MFJSON string")));
-  
-  TimestampTz *times = palloc(sizeof(TimestampTz) * numdates);
-  for (int i = 0; i < numdates; i++)
-  {
-    json_object* datevalue = NULL;
-    datevalue = json_object_array_get_idx(datetimes, i);
-    const char *strdatevalue = json_object_get_string(datevalue);
-    if (strdatevalue)
+/**
+ * Parse an MF-JSON string
+ */
+static void
+mfjson_parse_doc(mfjson_state *state, mfjson_doc *doc)
+{
+  memset(doc, 0, sizeof(mfjson_doc));
+  mfjson_whitespace(state);
+  if (*state->pos == '{')
+  {
+    doc->seq.isobject = true;
+    doc->seq.empty = true;
+    state->pos++;
+    bool first = true;
+    char *key;
+    while (mfjson_member_next(state, &first, &key))
     {
-      char datetime[33];
-      strcpy(datetime, strdatevalue);
-      /* Replace 'T' by ' ' before converting to timestamptz */
-      datetime[10] = ' ';
-      times[i] = call_input(TIMESTAMPTZOID, datetime);
+      doc->seq.empty = false;
+      if (mfjson_null(state))
+        continue;
+      if (strcasecmp(key, "type") == 0)
+      {
+        doc->type = NULL;
+        if (*state->pos == '"')
+        {
+          doc->typekind = MFJSON_STRING;
+          doc->type = mfjson_string(state, NULL);
+        }
+        else
+          doc->typekind = mfjson_skip_kind(state);
+      }
+      else if (strcasecmp(key, "interpolations") == 0)
+        mfjson_parse_interpolations(state, doc);
+      else if (strcasecmp(key, "crs") == 0)
+        mfjson_parse_crs(state, doc);
+      else if (strcasecmp(key, "sequences") == 0)
+        mfjson_parse_sequences(state, doc);
+      else if (! mfjson_parse_seq_member(state, &doc->seq, key))
+        mfjson_skip(state);
     }
   }
-  *count = numdates;
-  return times;
+  else
+    mfjson_skip(state);
+  mfjson_whitespace(state);
+  if (*state->pos != '\0')
+    mfjson_syntax_error();
+  return;
 }
 
 /*****************************************************************************/
 
+/**
+ * Returns the point at the position given as argument of the packed array
+ */
+static Datum
+mfjson_point(const mfjson_state *state, int n, int srid)
+{
+  const double *coord = state->coords + 3 * n;
+  LWPOINT *point = isnan(coord[2]) ?
+    lwpoint_make2d(srid, coord[0], coord[1]) :
+    lwpoint_make3dz(srid, coord[0], coord[1], coord[2]);
+  Datum result = PointerGetDatum(geo_serialize((LWGEOM *) point));
+  lwpoint_free(point);
+  return result;
+}
+
 /**
  * Returns a temporal instant point from its MF-JSON representation
  */
 static TInstant *
-tpointinst_from_mfjson(json_object *mfjson, int srid)
+tpointinst_from_mfjson(const mfjson_state *state, const mfjson_seq *seq,
+  int srid)
 {
   /* Get coordinates */
-  json_object *coordinates = findMemberByName(mfjson, "coordinates");
-  if (coordinates == NULL)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Unable to find 'coordinates' in MFJSON string")));
-  Datum value = parse_mfjson_coord(coordinates, srid);
-
-  /* Get datetimes 
-   * The maximum length of a datetime is 32 characters, e.g.,
-   *  "2019-08-06T18:35:48.021455+02:30" 
-   */
-  char str[33];
-  json_object *datetimes = findMemberByName(mfjson, "datetimes");
-  /* We don't need to test that datetimes is NULL since to differentiate 
-   * between an instant and a instant set we look for the "datetimes" 
-   * member and then call this function */
-  const char *strdatetimes = json_object_get_string(datetimes);
-  if (strdatetimes == NULL)
-  {
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid 'datetimes' value in MFJSON string")));
-    return NULL; /* make Codacy quiet */
-  }
-  strcpy(str, strdatetimes);
-  /* Replace 'T' by ' ' before converting to timestamptz */
-  str[10] = ' ';
-  TimestampTz t = call_input(TIMESTAMPTZOID, str);
+  if (seq->coordkind == MFJSON_MISSING)
+    mfjson_error("Unable to find 'coordinates' in MFJSON string");
+  if (seq->coordkind != MFJSON_ARRAY)
+    mfjson_error(MFJSON_ERR_COORD_VALUE);
+  if (seq->coordnum < 2)
+    mfjson_error(MFJSON_ERR_COORD_FEW);
+  if (seq->coordnum > 3)
+    mfjson_error(MFJSON_ERR_COORD_MANY);
+  if (seq->coordnested || seq->coorderr)
+    mfjson_error(MFJSON_ERR_COORD_VALUE);
+
+  /* Get datetimes */
+  if (seq->timekind != MFJSON_STRING)
+    mfjson_error("Invalid 'datetimes' value in MFJSON string");
+
+  Datum value = mfjson_point(state, seq->coordstart, srid);
+  TimestampTz t = mfjson_timestamp(seq->timestr, (int) strlen(seq->timestr));
   TInstant *result = tinstant_make(value, t, type_oid(T_GEOMETRY));
   pfree(DatumGetPointer(value));
   return result;
@@ -247,25 +879,48 @@ tpointinst_from_mfjson(json_object *mfjson, int srid)
  * Returns array of temporal instant points from its MF-JSON representation
  */
 static TInstant **
-tpointinstarr_from_mfjson(json_object *mfjson, int srid, int *count)
+tpointinstarr_from_mfjson(const mfjson_state *state, const mfjson_seq *seq,
+  int srid, int *count)
 {
-  /* Get coordinates and datetimes */
-  int numpoints, numdates;
-  Datum *values = parse_mfjson_points(mfjson, srid, &numpoints);
-  TimestampTz *times = parse_mfjson_datetimes(mfjson, &numdates);
-  if (numpoints != numdates)
+  if (! seq->isobject)
+    mfjson_error("Unable to find 'coordinates' in MFJSON string");
+  if (seq->empty)
+    mfjson_error("Invalid MFJSON string");
+
+  /* Get coordinates */
+  if (seq->coordkind == MFJSON_MISSING)
+    mfjson_error("Unable to find 'coordinates' in MFJSON string");
+  if (seq->coordkind != MFJSON_ARRAY)
+    mfjson_error("Invalid 'coordinates' array in MFJSON string");
+  if (seq->coordnum < 1)
+    mfjson_error("Invalid value of 'coordinates' array in MFJSON string");
+  if (! seq->coordnested)
+    mfjson_error(MFJSON_ERR_COORD_VALUE);
+  if (seq->coorderr)
+    mfjson_error(seq->coorderr);
+
+  /* Get datetimes */
+  if (seq->timekind == MFJSON_MISSING)
+    mfjson_error("Unable to find 'datetimes' in MFJSON string");
+  if (seq->timekind != MFJSON_ARRAY)
+    mfjson_error("Invalid 'datetimes' array in MFJSON string");
+  if (seq->timenum < 1 || seq->timeerr)
+    mfjson_error("Invalid value of 'datetimes' array in MFJSON string");
+
+  if (seq->coordnum != seq->timenum)
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
       errmsg("Distinct number of elements in 'coordinates' and 'datetimes' arrays")));
 
   /* Construct the array of temporal instant points */
-  TInstant **result = palloc(sizeof(TInstant *) * numpoints);
-  for (int i = 0; i < numpoints; i++)
-    result[i] = tinstant_make(values[i], times[i], type_oid(T_GEOMETRY));
-
-  for (int i = 0; i < numpoints; i++)
-    pfree(DatumGetPointer(values[i]));
-  pfree(values); pfree(times);
-  *count = numpoints;
+  TInstant **result = palloc(sizeof(TInstant *) * seq->coordnum);
+  for (int i = 0; i < seq->coordnum; i++)
+  {
+    Datum value = mfjson_point(state, seq->coordstart + i, srid);
+    result[i] = tinstant_make(value, state->times[seq->timestart + i],
+      type_oid(T_GEOMETRY));
+    pfree(DatumGetPointer(value));
+  }
+  *count = seq->coordnum;
   return result;
 }
 
@@ -273,10 +928,11 @@ tpointinstarr_from_mfjson(json_object *mfjson, int srid, int *count)
  * Returns a temporal instant set point from its MF-JSON representation
  */
 static TInstantSet *
-tpointinstset_from_mfjson(json_object *mfjson, int srid)
+tpointinstset_from_mfjson(const mfjson_state *state, const mfjson_seq *seq,
+  int srid)
 {
   int count;
-  TInstant **instants = tpointinstarr_from_mfjson(mfjson, srid, &count);
+  TInstant **instants = tpointinstarr_from_mfjson(state, seq, srid, &count);
   return tinstantset_make_free(instants, count);
 }
 
@@ -284,30 +940,21 @@ tpointinstset_from_mfjson(json_object *mfjson, int srid)
  * Returns a temporal sequence point from its MF-JSON representation
  */
 static TSequence *
-tpointseq_from_mfjson(json_object *mfjson, int srid, bool linear)
+tpointseq_from_mfjson(const mfjson_state *state, const mfjson_seq *seq,
+  int srid, bool linear)
 {
   /* Get the array of temporal instant points */
   int count;
-  TInstant **instants = tpointinstarr_from_mfjson(mfjson, srid, &count);
+  TInstant **instants = tpointinstarr_from_mfjson(state, seq, srid, &count);
 
-  /* Get lower bound flag */
-  json_object *lowerinc = NULL;
-  lowerinc = findMemberByName(mfjson, "lower_inc");
-  if (lowerinc == NULL)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Unable to find 'lower_inc' in MFJSON string")));
-  bool lower_inc = (bool) json_object_get_boolean(lowerinc);
-
-  /* Get upper bound flag */
-  json_object *upperinc = NULL;
-  upperinc = findMemberByName(mfjson, "upper_inc");
-  if (upperinc == NULL)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Unable to find 'upper_inc' in MFJSON string")));
-  bool upper_inc = (bool) json_object_get_boolean(upperinc);
+  /* Get lower and upper bound flags */
+  if (! seq->haslower)
+    mfjson_error("Unable to find 'lower_inc' in MFJSON string");
+  if (! seq->hasupper)
+    mfjson_error("Unable to find 'upper_inc' in MFJSON string");
 
   /* Construct the temporal point */
-  return tsequence_make_free(instants, count, lower_inc, upper_inc, 
+  return tsequence_make_free(instants, count, seq->lower_inc, seq->upper_inc,
     linear, NORMALIZE);
 }
 
@@ -315,30 +962,19 @@ tpointseq_from_mfjson(json_object *mfjson, int srid, bool linear)
  * Returns a temporal sequence set point from its MF-JSON representation
  */
 static TSequenceSet *
-tpointseqset_from_mfjson(json_object *mfjson, int srid, bool linear)
-{
-  json_object *seqs = NULL;
-  seqs = findMemberByName(mfjson, "sequences");
-  /* We don't need to test that seqs is NULL since to differentiate between
-   * a sequence and a sequence set we look for the "sequences" member and
-   * then call this function */
-  if (json_object_get_type(seqs) != json_type_array)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid 'sequences' array in MFJSON string")));
-  int numseqs = json_object_array_length(seqs);
-  if (numseqs < 1)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid value of 'sequences' array in MFJSON string")));
+tpointseqset_from_mfjson(const mfjson_state *state, const mfjson_doc *doc,
+  int srid, bool linear)
+{
+  if (doc->seqskind != MFJSON_ARRAY)
+    mfjson_error("Invalid 'sequences' array in MFJSON string");
+  if (doc->seqsnum < 1)
+    mfjson_error("Invalid value of 'sequences' array in MFJSON string");
 
   /* Construct the temporal point */
-  TSequence **sequences = palloc(sizeof(TSequence *) * numseqs);
-  for (int i = 0; i < numseqs; i++)
-  {
-    json_object* seqvalue = NULL;
-    seqvalue = json_object_array_get_idx(seqs, i);
-    sequences[i] = tpointseq_from_mfjson(seqvalue, srid, linear);
-  }
-  return tsequenceset_make_free(sequences, numseqs, NORMALIZE);
+  TSequence **sequences = palloc(sizeof(TSequence *) * doc->seqsnum);
+  for (int i = 0; i < doc->seqsnum; i++)
+    sequences[i] = tpointseq_from_mfjson(state, &doc->seqs[i], srid, linear);
+  return tsequenceset_make_free(sequences, doc->seqsnum, NORMALIZE);
 }
 
 PG_FUNCTION_INFO_V1(tpoint_from_mfjson);
@@ -348,134 +984,76 @@ PG_FUNCTION_INFO_V1(tpoint_from_mfjson);
 PGDLLEXPORT Datum
 tpoint_from_mfjson(PG_FUNCTION_ARGS)
 {
-  text *mfjson_input;
-  char *mfjson;
-  char *srs = NULL;
+  text *mfjson_input = PG_GETARG_TEXT_P(0);
+  char *mfjson = text_to_cstring(mfjson_input);
+  mfjson_state state;
+  mfjson_doc doc;
   int srid = 0;
-  Temporal *result;
+  Temporal *result = NULL;
+
+  /* Parse the mfjson stream */
+  state.pos = mfjson;
+  state.npoints = state.ntimes = 0;
+  state.maxpoints = state.maxtimes = MFJSON_INITIAL_SIZE;
+  state.coords = palloc(sizeof(double) * 3 * state.maxpoints);
+  state.times = palloc(sizeof(TimestampTz) * state.maxtimes);
+  mfjson_parse_doc(&state, &doc);
 
-  /* Get the mfjson stream */
-  mfjson_input = PG_GETARG_TEXT_P(0);
-  mfjson = text2cstring(mfjson_input);
-
-  json_tokener *jstok = NULL;
-  json_object *poObj = NULL;
-  json_object *poObjType = NULL;
-  json_object *poObjInterp = NULL;
-  json_object *poObjInterp1 = NULL;
-  json_object *poObjDates = NULL;
-  json_object *poObjSrs = NULL;
-
-  /* Begin to parse json */
-  jstok = json_tokener_new();
-  poObj = json_tokener_parse_ex(jstok, mfjson, -1);
-  if (jstok->err != json_tokener_success)
-  {
-    char err[256];
-    snprintf(err, 256, "%s (at offset %d)", json_tokener_error_desc(jstok->err), jstok->char_offset);
-    json_tokener_free(jstok);
-    json_object_put(poObj);
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Error while processing MFJSON string")));
-  }
-  json_tokener_free(jstok);
-  
   /*
    * Ensure that it is a moving point
    */
-  poObjType = findMemberByName(poObj, "type");
-  if (poObjType == NULL)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Unable to find 'type' in MFJSON string")));
-
-  const char *pszType = json_object_get_string(poObjType);
-  if (strcmp(pszType, "MovingPoint") != 0)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid 'type' value in MFJSON string")));
+  if (! doc.seq.isobject)
+    mfjson_error("Unable to find 'type' in MFJSON string");
+  if (doc.seq.empty)
+    mfjson_error("Invalid MFJSON string");
+  if (doc.typekind == MFJSON_MISSING)
+    mfjson_error("Unable to find 'type' in MFJSON string");
+  if (doc.typekind != MFJSON_STRING || strcmp(doc.type, "MovingPoint") != 0)
+    mfjson_error("Invalid 'type' value in MFJSON string");
 
   /*
    * Determine duration of temporal point and dispatch to the 
    *  corresponding parse function 
    */
-  poObjInterp = findMemberByName(poObj, "interpolations");
-  if (poObjInterp == NULL)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Unable to find 'interpolations' in MFJSON string")));
+  if (doc.interpkind == MFJSON_MISSING)
+    mfjson_error("Unable to find 'interpolations' in MFJSON string");
+  if (doc.interpkind != MFJSON_ARRAY)
+    mfjson_error("Invalid 'interpolations' value in MFJSON string");
+  if (doc.interpnum != 1)
+    mfjson_error("Multiple 'interpolations' values in MFJSON string");
+
+  /* Set SRID of temporal point */
+  if (doc.crserror)
+    mfjson_error("Invalid MFJSON string");
+  if (doc.srs)
+    srid = getSRIDbySRS(doc.srs);
 
-  if (json_object_get_type(poObjInterp) != json_type_array)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Invalid 'interpolations' value in MFJSON string")));
-
-  const int nSize = json_object_array_length(poObjInterp);
-  if (nSize != 1)
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-      errmsg("Multiple 'interpolations' values in MFJSON string")));
-
-  /* Parse crs and set SRID of temporal point */
-  poObjSrs = findMemberByName(poObj, "crs");
-  if (poObjSrs != NULL)
-  {
-    json_object *poObjSrsType = findMemberByName(poObjSrs, "type");
-    if (poObjSrsType != NULL)
-    {
-      json_object *poObjSrsProps = findMemberByName(poObjSrs, "properties");
-      if (poObjSrsProps)
-      {
-        json_object *poNameURL = findMemberByName(poObjSrsProps, "name");
-        if (poNameURL)
-        {
-          const char *pszName = json_object_get_string(poNameURL);
-          if (pszName)
-          {
-            srs = palloc(strlen(pszName) + 1);
-            strcpy(srs, pszName);
-          }
-        }
-      }
-    }
-  }
-
-  if (srs)
+  /* Read interpolation value */
+  if (doc.interp && strcmp(doc.interp, "Discrete") == 0)
   {
-    srid = getSRIDbySRS(srs);
-    pfree(srs);
+    if (doc.seq.timekind == MFJSON_ARRAY)
+      result = (Temporal *) tpointinstset_from_mfjson(&state, &doc.seq, srid);
+    else
+      result = (Temporal *) tpointinst_from_mfjson(&state, &doc.seq, srid);
   }
-
-  /* Read interpolation value */
-  poObjInterp1 = json_object_array_get_idx(poObjInterp, 0);
-  const char *pszInterp = json_object_get_string(poObjInterp1);
-  if (pszInterp)
+  else if (doc.interp && (strcmp(doc.interp, "Stepwise") == 0 ||
+    strcmp(doc.interp, "Linear") == 0))
   {
-    if (strcmp(pszInterp, "Discrete") == 0)
-    {
-      poObjDates = findMemberByName(poObj, "datetimes");
-      if (poObjDates != NULL &&
-        json_object_get_type(poObjDates) == json_type_array)
-        result = (Temporal *)tpointinstset_from_mfjson(poObj, srid);
-      else
-        result = (Temporal *)tpointinst_from_mfjson(poObj, srid);
-    }
-    else if (strcmp(pszInterp, "Stepwise") == 0)
-    {
-      json_object *poObjSeqs = findMemberByName(poObj, "sequences");
-      if (poObjSeqs != NULL)
-        result = (Temporal *)tpointseqset_from_mfjson(poObj, srid, false);
-      else
-        result = (Temporal *)tpointseq_from_mfjson(poObj, srid, false);
-    }
-    else if (strcmp(pszInterp, "Linear") == 0)
-    {
-      json_object *poObjSeqs = findMemberByName(poObj, "sequences");
-      if (poObjSeqs != NULL)
-        result = (Temporal *)tpointseqset_from_mfjson(poObj, srid, true);
-      else
-        result = (Temporal *)tpointseq_from_mfjson(poObj, srid, true);
-    }
+    bool linear = (doc.interp[0] == 'L');
+    if (doc.seqskind != MFJSON_MISSING)
+      result = (Temporal *) tpointseqset_from_mfjson(&state, &doc, srid,
+        linear);
     else
-      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-        errmsg("Invalid 'interpolations' value in MFJSON string")));
+      result = (Temporal *) tpointseq_from_mfjson(&state, &doc.seq, srid,
+        linear);
   }
+  else
+    mfjson_error("Invalid 'interpolations' value in MFJSON string");
 
+  pfree(state.coords); pfree(state.times);
+  if (doc.seqs)
+    pfree(doc.seqs);
+  pfree(mfjson);
   PG_RETURN_POINTER(result);
 }
 
@@ -678,22 +1256,69 @@ tpointinst_from_wkb_state(wkb_parse_state *s)
 
 /**
  * Returns a temporal instant array from its WKB representation
+ *
+ * All points of the array have the same size and thus the instants are
+ * obtained by copying a template instant into a single block of memory and
+ * overwriting in place its coordinates and its timestamp. These are copied
+ * directly from the WKB when its byte order is the one of the machine.
+ * The array must be freed with the function tpointinstarr_free.
+ *
+ * @pre The caller verified that the WKB contains the instants
  */
 static TInstant **
 tpointinstarr_from_wkb_state(wkb_parse_state *s, int count)
 {
+  if (count <= 0)
+    elog(ERROR, "Invalid number of instants in WKB (%d)!", count);
+  LWPOINT *lwpoint = s->has_z ? lwpoint_make3dz(s->srid, 0, 0, 0) :
+    lwpoint_make2d(s->srid, 0, 0);
+  Datum value = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
+  lwpoint_free(lwpoint);
+  TInstant *inst = tinstant_make(value, 0, type_oid(T_GEOMETRY));
+  pfree(DatumGetPointer(value));
+
+  size_t size = VARSIZE(inst);
+  size_t coordsize = (s->has_z ? 3 : 2) * WKB_DOUBLE_SIZE;
+  char *block = palloc(double_pad(size) * count);
   TInstant **result = palloc(sizeof(TInstant *) * count);
   for (int i = 0; i < count; i++)
   {
-    /* Parse the point and the timestamp to create the instant point */
-    Datum value = point_from_wkb_state(s);
-    TimestampTz t = timestamp_from_wkb_state(s);
-    result[i] = tinstant_make(value, t, type_oid(T_GEOMETRY));
-    pfree(DatumGetPointer(value));
+    result[i] = (TInstant *) (block + double_pad(size) * i);
+    memcpy(result[i], inst, size);
+    /* The layout of POINT2D and POINT3DZ is the one of the WKB coordinates */
+    POINT3DZ *point = (POINT3DZ *) datum_get_point3dz_p(
+      tinstant_value(result[i]));
+    if (! s->swap_bytes)
+    {
+      memcpy(point, s->pos, coordsize);
+      s->pos += coordsize;
+      memcpy(&result[i]->t, s->pos, WKB_TIMESTAMP_SIZE);
+      s->pos += WKB_TIMESTAMP_SIZE;
+    }
+    else
+    {
+      point->x = double_from_wkb_state(s);
+      point->y = double_from_wkb_state(s);
+      if (s->has_z)
+        point->z = double_from_wkb_state(s);
+      result[i]->t = timestamp_from_wkb_state(s);
+    }
   }
+  pfree(inst);
   return result;
 }
 
+/**
+ * Free a temporal instant array obtained from its WKB representation
+ */
+static void
+tpointinstarr_free(TInstant **instants)
+{
+  pfree(instants[0]);
+  pfree(instants);
+  return;
+}
+
 /**
  * Returns a temporal instant set point from its WKB representation
  */
@@ -710,7 +1335,9 @@ tpointinstset_from_wkb_state(wkb_parse_state *s)
   wkb_parse_state_check(s, size);
   /* Parse the instants */
   TInstant **instants = tpointinstarr_from_wkb_state(s, count);
-  return tinstantset_make_free(instants, count);
+  TInstantSet *result = tinstantset_make(instants, count);
+  tpointinstarr_free(instants);
+  return result;
 }
 
 /**
@@ -750,8 +1377,10 @@ tpointseq_from_wkb_state(wkb_parse_state *s)
   wkb_parse_state_check(s, size);
   /* Parse the instants */
   TInstant **instants = tpointinstarr_from_wkb_state(s, count);
-  return tsequence_make_free(instants, count, lower_inc, upper_inc,
-    s->linear, NORMALIZE); 
+  TSequence *result = tsequence_make(instants, count, lower_inc, upper_inc,
+    s->linear, NORMALIZE);
+  tpointinstarr_free(instants);
+  return result;
 }
 
 /**
@@ -779,17 +1408,10 @@ tpointseqset_from_wkb_state(wkb_parse_state *s)
     size_t size = countinst * ((ndims * WKB_DOUBLE_SIZE) + WKB_TIMESTAMP_SIZE);
     wkb_parse_state_check(s, size);
     /* Parse the instants */
-    TInstant **instants = palloc(sizeof(TInstant *) * countinst);
-    for (int j = 0; j < countinst; j++)
-    {
-      /* Parse the point and the timestamp to create the instant point */
-      Datum value = point_from_wkb_state(s);
-      TimestampTz t = timestamp_from_wkb_state(s);
-      instants[j] = tinstant_make(value, t, type_oid(T_GEOMETRY));
-      pfree(DatumGetPointer(value));
-    }
-    sequences[i] = tsequence_make_free(instants, countinst, lower_inc,
-      upper_inc, s->linear, NORMALIZE); 
+    TInstant **instants = tpointinstarr_from_wkb_state(s, countinst);
+    sequences[i] = tsequence_make(instants, countinst, lower_inc,
+      upper_inc, s->linear, NORMALIZE);
+    tpointinstarr_free(instants);
   }
   return tsequenceset_make_free(sequences, count, NORMALIZE);
 }
@@ -866,3 +1488,193 @@ tpoint_from_ewkb(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Input in TWKB format
+ *****************************************************************************/
+
+/**
+ * Structure used for passing the parse state between the TWKB parsing
+ * functions, see the function tpoint_as_twkb for the description of the
+ * format
+ */
+typedef struct
+{
+  const uint8_t *twkb; /**< Points to start of TWKB */
+  size_t twkb_size;    /**< Expected size of TWKB */
+  const uint8_t *pos;  /**< Current parse position */
+  int32_t srid;        /**< SRID of the temporal point */
+  bool has_z;          /**< Z? */
+  bool linear;         /**< Linear interpolation? */
+  double factor;       /**< Scale factor of the X and Y coordinates */
+  double factor_z;     /**< Scale factor of the Z coordinate */
+  int64 unit;          /**< Time unit in microseconds */
+  int64 last[4];       /**< Previous values for the delta decoding */
+} twkb_parse_state;
+
+/**
+ * Read a byte and advance the parse state forward
+ */
+static uint8_t
+byte_from_twkb_state(twkb_parse_state *s)
+{
+  if (s->pos + 1 > s->twkb + s->twkb_size)
+    elog(ERROR, "TWKB structure does not match expected size!");
+  return *s->pos++;
+}
+
+/**
+ * Read an unsigned varint and advance the parse state forward
+ */
+static uint64
+varint_u64_from_twkb_state(twkb_parse_state *s)
+{
+  uint64 result = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    uint8_t byte = byte_from_twkb_state(s);
+    result |= (uint64) (byte & 0x7F) << shift;
+    if (! (byte & 0x80))
+      return result;
+  }
+  elog(ERROR, "Invalid varint in TWKB");
+  return 0; /* make compiler quiet */
+}
+
+/**
+ * Read a zig-zag varint and advance the parse state forward
+ */
+static int64
+varint_s64_from_twkb_state(twkb_parse_state *s)
+{
+  uint64 value = varint_u64_from_twkb_state(s);
+  return (int64) (value >> 1) ^ - (int64) (value & 1);
+}
+
+/**
+ * Returns a zig-zag encoded precision
+ */
+static int
+precision_from_twkb(uint8_t value)
+{
+  return (int) (value >> 1) ^ - (int) (value & 1);
+}
+
+/**
+ * Read a number of instants or sequences and advance the parse state
+ * forward. Since every instant takes at least one byte per dimension, the
+ * number is bounded by the size of the rest of the TWKB.
+ */
+static int
+count_from_twkb_state(twkb_parse_state *s)
+{
+  uint64 count = varint_u64_from_twkb_state(s);
+  if (count == 0 || count > (uint64) (s->twkb + s->twkb_size - s->pos))
+    elog(ERROR, "Invalid number of elements in TWKB (" UINT64_FORMAT ")!",
+      count);
+  return (int) count;
+}
+
+/**
+ * Returns a temporal instant point from its delta-encoded TWKB
+ * representation and advance the parse state forward
+ */
+static TInstant *
+tpointinst_from_twkb_state(twkb_parse_state *s)
+{
+  int ndims = s->has_z ? 3 : 2;
+  for (int i = 0; i <= ndims; i++)
+    s->last[i] += varint_s64_from_twkb_state(s);
+  LWPOINT *point = s->has_z ?
+    lwpoint_make3dz(s->srid, s->last[0] / s->factor, s->last[1] / s->factor,
+      s->last[2] / s->factor_z) :
+    lwpoint_make2d(s->srid, s->last[0] / s->factor, s->last[1] / s->factor);
+  Datum value = PointerGetDatum(geo_serialize((LWGEOM *) point));
+  lwpoint_free(point);
+  TInstant *result = tinstant_make(value, (TimestampTz) (s->last[ndims] * 
+    s->unit), type_oid(T_GEOMETRY));
+  pfree(DatumGetPointer(value));
+  return result;
+}
+
+/**
+ * Returns a temporal sequence point from its TWKB representation and
+ * advance the parse state forward
+ */
+static TSequence *
+tpointseq_from_twkb_state(twkb_parse_state *s)
+{
+  int count = count_from_twkb_state(s);
+  bool lower_inc, upper_inc;
+  tpoint_bounds_from_wkb_state(byte_from_twkb_state(s), &lower_inc,
+    &upper_inc);
+  TInstant **instants = palloc(sizeof(TInstant *) * count);
+  for (int i = 0; i < count; i++)
+    instants[i] = tpointinst_from_twkb_state(s);
+  return tsequence_make_free(instants, count, lower_inc, upper_inc,
+    s->linear, NORMALIZE);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_from_twkb);
+/**
+ * Returns a temporal point from its TWKB representation
+ */
+PGDLLEXPORT Datum
+tpoint_from_twkb(PG_FUNCTION_ARGS)
+{
+  bytea *bytea_twkb = PG_GETARG_BYTEA_P(0);
+  twkb_parse_state s;
+  s.twkb = (uint8_t *) VARDATA(bytea_twkb);
+  s.twkb_size = VARSIZE(bytea_twkb) - VARHDRSZ;
+  s.pos = s.twkb;
+  memset(s.last, 0, sizeof(s.last));
+
+  /* Read the header */
+  uint8_t type = byte_from_twkb_state(&s);
+  uint8_t duration = type & 0x0F;
+  if (duration < INSTANT || duration > SEQUENCESET)
+    elog(ERROR, "Unknown TWKB duration (%d)!", duration);
+  s.factor = pow(10.0, precision_from_twkb(type >> 4));
+  uint8_t flags = byte_from_twkb_state(&s);
+  s.has_z = (flags & TWKB_ZFLAG) != 0;
+  s.linear = (flags & TWKB_LINEAR_INTERP) != 0;
+  s.factor_z = s.has_z ?
+    pow(10.0, precision_from_twkb(byte_from_twkb_state(&s))) : 1.0;
+  int precision_t = byte_from_twkb_state(&s);
+  if (precision_t > TWKB_MAX_TIME_PRECISION)
+    elog(ERROR, "Invalid time precision in TWKB (%d)!", precision_t);
+  s.unit = 1;
+  for (int i = precision_t; i < TWKB_MAX_TIME_PRECISION; i++)
+    s.unit *= 10;
+  s.srid = (flags & TWKB_SRIDFLAG) ?
+    (int32_t) varint_s64_from_twkb_state(&s) : SRID_UNKNOWN;
+
+  /* Read the instants */
+  Temporal *result;
+  if (duration == INSTANT)
+    result = (Temporal *) tpointinst_from_twkb_state(&s);
+  else if (duration == INSTANTSET)
+  {
+    int count = count_from_twkb_state(&s);
+    TInstant **instants = palloc(sizeof(TInstant *) * count);
+    for (int i = 0; i < count; i++)
+      instants[i] = tpointinst_from_twkb_state(&s);
+    result = (Temporal *) tinstantset_make_free(instants, count);
+  }
+  else if (duration == SEQUENCE)
+    result = (Temporal *) tpointseq_from_twkb_state(&s);
+  else /* duration == SEQUENCESET */
+  {
+    int count = count_from_twkb_state(&s);
+    TSequence **sequences = palloc(sizeof(TSequence *) * count);
+    for (int i = 0; i < count; i++)
+      sequences[i] = tpointseq_from_twkb_state(&s);
+    result = (Temporal *) tsequenceset_make_free(sequences, count, NORMALIZE);
+  }
+  if (s.pos != s.twkb + s.twkb_size)
+    elog(ERROR, "TWKB structure does not match expected size!");
+  PG_FREE_IF_COPY(bytea_twkb, 0);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
@@ -0,0 +1,332 @@
+/*****************************************************************************
+ *
+ * tpoint_join.c
+ *    Partition-based spatial merge join of spatiotemporal boxes
+ *
+ * A join of two tables on the overlap of the bounding boxes of their
+ * temporal points or geometries is executed by PostgreSQL as a nested
+ * loop that probes an index for each row of the outer table. The function
+ * stboxJoin instead computes in one pass all the pairs of overlapping boxes
+ * of two arrays. The extent of the boxes is divided into a grid of cells
+ * whose number depends on the number of boxes, each box is assigned to the
+ * cells it overlaps, and the boxes of the two arrays assigned to a cell are
+ * joined with a plane sweep on their lower X bound. A pair of boxes
+ * assigned to several common cells is only reported in the cell containing
+ * the lower corner of their intersection so that there are no duplicates.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_join.h"
+
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/array.h>
+
+#include "temporal_util.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * Grid
+ *****************************************************************************/
+
+/**
+ * Structure to represent the grid partitioning the extent of the boxes
+ */
+typedef struct
+{
+  double xmin;     /**< Lower X bound of the grid */
+  double ymin;     /**< Lower Y bound of the grid */
+  double xsize;    /**< Size of the cells in the X dimension */
+  double ysize;    /**< Size of the cells in the Y dimension */
+  int n;           /**< Number of cells in each dimension */
+} STboxGrid;
+
+/**
+ * Returns the number of the cell of the grid containing the value in one
+ * dimension, where the values outside the grid belong to the border cells
+ */
+static int
+grid_cell(double value, double origin, double size, int n)
+{
+  if (size <= 0)
+    return 0;
+  int result = (int) floor((value - origin) / size);
+  return Max(0, Min(result, n - 1));
+}
+
+/**
+ * Structure to represent the boxes of one array assigned to each cell of
+ * the grid, the positions of the boxes of the i-th cell are in the range
+ * [start[i], start[i + 1]) of the array of items
+ */
+typedef struct
+{
+  int *start;      /**< Start of the items of each cell */
+  int *items;      /**< Positions of the boxes */
+} STboxCells;
+
+/**
+ * Assign the boxes to the cells of the grid they overlap
+ */
+static void
+stbox_cells_make(STboxCells *cells, const STboxGrid *grid,
+  const STBOX *boxes, int count)
+{
+  int ncells = grid->n * grid->n;
+  cells->start = palloc0(sizeof(int) * (ncells + 1));
+  /* Count the boxes of each cell and compute the start of the cells */
+  for (int k = 0; k < 2; k++)
+  {
+    int nitems = 0;
+    for (int i = 0; i < count; i++)
+    {
+      int x1 = grid_cell(boxes[i].xmin, grid->xmin, grid->xsize, grid->n);
+      int x2 = grid_cell(boxes[i].xmax, grid->xmin, grid->xsize, grid->n);
+      int y1 = grid_cell(boxes[i].ymin, grid->ymin, grid->ysize, grid->n);
+      int y2 = grid_cell(boxes[i].ymax, grid->ymin, grid->ysize, grid->n);
+      for (int y = y1; y <= y2; y++)
+      {
+        for (int x = x1; x <= x2; x++)
+        {
+          int cell = y * grid->n + x;
+          if (k == 0)
+            cells->start[cell + 1]++;
+          else
+            cells->items[cells->start[cell + 1]++] = i;
+          nitems++;
+        }
+      }
+    }
+    if (k == 0)
+    {
+      for (int i = 0; i < ncells; i++)
+        cells->start[i + 1] += cells->start[i];
+      cells->items = palloc(sizeof(int) * Max(nitems, 1));
+      /* The start of each cell is shifted while the items are filled */
+      for (int i = ncells; i > 0; i--)
+        cells->start[i] = cells->start[i - 1];
+    }
+  }
+  return;
+}
+
+/*****************************************************************************
+ * Join
+ *****************************************************************************/
+
+/**
+ * Comparator of the positions of boxes on the lower X bound of the boxes
+ */
+static int
+stbox_xmin_cmp(const void *a, const void *b, void *arg)
+{
+  const STBOX *boxes = (const STBOX *) arg;
+  double x1 = boxes[*(const int *) a].xmin;
+  double x2 = boxes[*(const int *) b].xmin;
+  if (x1 == x2)
+    return 0;
+  return (x1 < x2) ? -1 : 1;
+}
+
+/**
+ * Add the pair of boxes to the result if they overlap and if the lower
+ * corner of their intersection is in the cell
+ */
+static void
+stbox_join_pair(STboxJoinState *state, const STboxGrid *grid, int cellx,
+  int celly, const STBOX *box1, int pos1, const STBOX *box2, int pos2)
+{
+  if (! overlaps_stbox_stbox_internal(box1, box2))
+    return;
+  if (grid_cell(Max(box1->xmin, box2->xmin), grid->xmin, grid->xsize,
+      grid->n) != cellx ||
+    grid_cell(Max(box1->ymin, box2->ymin), grid->ymin, grid->ysize,
+      grid->n) != celly)
+    return;
+  if (state->count == state->maxcount)
+  {
+    state->maxcount *= 2;
+    state->pos1 = repalloc(state->pos1, sizeof(int) * state->maxcount);
+    state->pos2 = repalloc(state->pos2, sizeof(int) * state->maxcount);
+  }
+  state->pos1[state->count] = pos1;
+  state->pos2[state->count++] = pos2;
+  return;
+}
+
+/**
+ * Returns the pairs of overlapping boxes of the two arrays (internal
+ * function)
+ *
+ * @pre The boxes have X dimension and the same SRID
+ */
+STboxJoinState *
+stbox_join_internal(const STBOX *boxes1, int count1, const STBOX *boxes2,
+  int count2)
+{
+  STboxJoinState *result = palloc0(sizeof(STboxJoinState));
+  result->maxcount = 64;
+  result->pos1 = palloc(sizeof(int) * result->maxcount);
+  result->pos2 = palloc(sizeof(int) * result->maxcount);
+  if (count1 == 0 || count2 == 0)
+    return result;
+
+  /* Grid covering the extent of the boxes */
+  STboxGrid grid;
+  double xmax = boxes1[0].xmax, ymax = boxes1[0].ymax;
+  grid.xmin = boxes1[0].xmin;
+  grid.ymin = boxes1[0].ymin;
+  for (int k = 0; k < 2; k++)
+  {
+    const STBOX *boxes = (k == 0) ? boxes1 : boxes2;
+    int count = (k == 0) ? count1 : count2;
+    for (int i = 0; i < count; i++)
+    {
+      grid.xmin = Min(grid.xmin, boxes[i].xmin);
+      grid.ymin = Min(grid.ymin, boxes[i].ymin);
+      xmax = Max(xmax, boxes[i].xmax);
+      ymax = Max(ymax, boxes[i].ymax);
+    }
+  }
+  grid.n = (int) ceil(sqrt((double) (count1 + count2) /
+    STBOX_JOIN_CELL_BOXES));
+  grid.n = Max(1, Min(grid.n, STBOX_JOIN_MAX_CELLS));
+  grid.xsize = (xmax - grid.xmin) / grid.n;
+  grid.ysize = (ymax - grid.ymin) / grid.n;
+
+  STboxCells cells1, cells2;
+  stbox_cells_make(&cells1, &grid, boxes1, count1);
+  stbox_cells_make(&cells2, &grid, boxes2, count2);
+
+  /* Plane sweep of the boxes of each cell */
+  for (int celly = 0; celly < grid.n; celly++)
+  {
+    for (int cellx = 0; cellx < grid.n; cellx++)
+    {
+      int cell = celly * grid.n + cellx;
+      int *items1 = &cells1.items[cells1.start[cell]];
+      int n1 = cells1.start[cell + 1] - cells1.start[cell];
+      int *items2 = &cells2.items[cells2.start[cell]];
+      int n2 = cells2.start[cell + 1] - cells2.start[cell];
+      if (n1 == 0 || n2 == 0)
+        continue;
+      qsort_arg(items1, n1, sizeof(int), &stbox_xmin_cmp, (void *) boxes1);
+      qsort_arg(items2, n2, sizeof(int), &stbox_xmin_cmp, (void *) boxes2);
+      int i = 0, j = 0;
+      while (i < n1 && j < n2)
+      {
+        const STBOX *box1 = &boxes1[items1[i]];
+        const STBOX *box2 = &boxes2[items2[j]];
+        if (box1->xmin <= box2->xmin)
+        {
+          for (int k = j; k < n2 && boxes2[items2[k]].xmin <= box1->xmax; k++)
+            stbox_join_pair(result, &grid, cellx, celly, box1, items1[i],
+              &boxes2[items2[k]], items2[k]);
+          i++;
+        }
+        else
+        {
+          for (int k = i; k < n1 && boxes1[items1[k]].xmin <= box2->xmax; k++)
+            stbox_join_pair(result, &grid, cellx, celly, &boxes1[items1[k]],
+              items1[k], box2, items2[j]);
+          j++;
+        }
+      }
+    }
+  }
+  pfree(cells1.start); pfree(cells1.items);
+  pfree(cells2.start); pfree(cells2.items);
+  return result;
+}
+
+/**
+ * Returns the boxes of the array in a C array
+ */
+static STBOX *
+stboxarr_extract(ArrayType *array, int *count)
+{
+  Datum *values = datumarr_extract(array, count);
+  STBOX *result = palloc(sizeof(STBOX) * Max(*count, 1));
+  for (int i = 0; i < *count; i++)
+    memcpy(&result[i], DatumGetSTboxP(values[i]), sizeof(STBOX));
+  pfree(values);
+  return result;
+}
+
+/**
+ * Ensure that the boxes can be joined with the reference box
+ */
+static void
+ensure_valid_stboxarr_join(const STBOX *boxes, int count, const STBOX *box)
+{
+  for (int i = 0; i < count; i++)
+  {
+    ensure_has_X_stbox(&boxes[i]);
+    ensure_same_geodetic_stbox(&boxes[i], box);
+    ensure_same_srid_stbox(&boxes[i], box);
+  }
+  return;
+}
+
+PG_FUNCTION_INFO_V1(stbox_join);
+/**
+ * Returns the positions of the pairs of overlapping boxes of the two
+ * arrays
+ */
+PGDLLEXPORT Datum
+stbox_join(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  STboxJoinState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    ArrayType *array1 = PG_GETARG_ARRAYTYPE_P(0);
+    ArrayType *array2 = PG_GETARG_ARRAYTYPE_P(1);
+    int count1, count2;
+    STBOX *boxes1 = stboxarr_extract(array1, &count1);
+    STBOX *boxes2 = stboxarr_extract(array2, &count2);
+    if (count1 > 0 && count2 > 0)
+    {
+      ensure_valid_stboxarr_join(boxes1, count1, &boxes1[0]);
+      ensure_valid_stboxarr_join(boxes2, count2, &boxes1[0]);
+    }
+    funcctx->user_fctx = stbox_join_internal(boxes1, count1, boxes2, count2);
+    pfree(boxes1); pfree(boxes2);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (STboxJoinState *) funcctx->user_fctx;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The positions in the arrays start at 1 */
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Int32GetDatum(state->pos1[state->i] + 1);
+  values[1] = Int32GetDatum(state->pos2[state->i] + 1);
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
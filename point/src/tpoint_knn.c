@@ -0,0 +1,555 @@
+/*****************************************************************************
+ *
+ * tpoint_knn.c
+ *    Continuous k nearest neighbors of a temporal point among an array of
+ *    temporal points.
+ *
+ * The function tkNN returns for each temporal point of an array the time
+ * during which it is among the k nearest neighbors of a reference temporal
+ * point. The candidates whose box is farther from the box of the reference
+ * point than the k-th smallest maximum distance between the boxes of the
+ * candidates defined during the whole reference point are pruned, since
+ * they are never closer than those k candidates. The temporal distance to
+ * the remaining candidates is computed with distance_tpoint_tpoint, and the
+ * distances are swept jointly over the elementary intervals delimited by
+ * their instants. In each interval the distances are linear, the k nearest
+ * candidates are obtained by sorting the distances at the start of the
+ * interval, and the set of nearest candidates is then maintained as a
+ * kinetic top-k whose events are the times at which the distance to a
+ * neighbor crosses the distance to a candidate that is not a neighbor.
+ * For discrete temporal points the candidates are ranked at each instant.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_knn.h"
+
+#include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/array.h>
+
+#include "period.h"
+#include "periodset.h"
+#include "timeops.h"
+#include "temporaltypes.h"
+#include "temporal_util.h"
+#include "stbox.h"
+#include "tpoint_spatialfuncs.h"
+#include "tpoint_distance.h"
+
+/*****************************************************************************
+ * Bounding box pruning
+ *****************************************************************************/
+
+/**
+ * Returns the minimum or the maximum distance between the spatial
+ * dimensions of the boxes
+ */
+static double
+knn_stbox_distance(const STBOX *box1, const STBOX *box2, bool hasz,
+  bool maxdist)
+{
+  double min1[3] = {box1->xmin, box1->ymin, box1->zmin};
+  double max1[3] = {box1->xmax, box1->ymax, box1->zmax};
+  double min2[3] = {box2->xmin, box2->ymin, box2->zmin};
+  double max2[3] = {box2->xmax, box2->ymax, box2->zmax};
+  double result = 0.0;
+  for (int i = 0; i < (hasz ? 3 : 2); i++)
+  {
+    double d;
+    if (maxdist)
+      d = Max(max1[i], max2[i]) - Min(min1[i], min2[i]);
+    else if (max1[i] < min2[i])
+      d = min2[i] - max1[i];
+    else if (max2[i] < min1[i])
+      d = min1[i] - max2[i];
+    else
+      d = 0.0;
+    result += d * d;
+  }
+  return sqrt(result);
+}
+
+/**
+ * Comparator of double values
+ */
+static int
+knn_double_cmp(const void *a, const void *b)
+{
+  double d1 = *(const double *) a;
+  double d2 = *(const double *) b;
+  if (d1 == d2)
+    return 0;
+  return (d1 < d2) ? -1 : 1;
+}
+
+/**
+ * Returns the bound on the distance of the k nearest neighbors given by
+ * the boxes of the candidates, or DBL_MAX when there is no such bound.
+ * The bound is the k-th smallest maximum distance between the box of the
+ * reference point and the box of a candidate that is a single sequence
+ * defined during the whole reference point.
+ */
+static double
+knn_stbox_bound(const Temporal *temp, const STBOX *box, Temporal **temparr,
+  const STBOX *boxes, int count, int k)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(temp->flags);
+  Period p, p1;
+  temporal_period(&p, temp);
+  double *upper = palloc(sizeof(double) * Max(count, 1));
+  int nupper = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (temparr[i]->duration != SEQUENCE)
+      continue;
+    temporal_period(&p1, temparr[i]);
+    if (contains_period_period_internal(&p1, &p))
+      upper[nupper++] = knn_stbox_distance(box, &boxes[i], hasz, true);
+  }
+  double result = DBL_MAX;
+  if (nupper >= k)
+  {
+    qsort(upper, nupper, sizeof(double), &knn_double_cmp);
+    result = upper[k - 1];
+  }
+  pfree(upper);
+  return result;
+}
+
+/*****************************************************************************
+ * Sweep of the temporal distances
+ *****************************************************************************/
+
+/**
+ * Structure to represent a candidate during the sweep of the distances
+ */
+typedef struct
+{
+  int pos;               /**< Position of the candidate in the array */
+  Temporal *dist;        /**< Temporal distance to the reference point */
+  int count;             /**< Number of sequences or instants of the distance */
+  int cur;               /**< Number of the current sequence or instant */
+  int inst;              /**< Number of the current instant of the sequence */
+  double value;          /**< Distance at the start of the interval */
+  double slope;          /**< Variation of the distance per microsecond */
+  bool top;              /**< True when it is a neighbor at the start of the interval */
+  bool member;           /**< True when it is currently a neighbor */
+  TimestampTz since;     /**< Start of the time it is currently a neighbor */
+  Period **periods;      /**< Time during which it is a neighbor */
+  int nperiods;          /**< Number of periods */
+  int maxperiods;        /**< Number of periods allocated */
+} KnnCandidate;
+
+/**
+ * Comparator of the candidates on their distance and on the variation of
+ * their distance at the start of the interval
+ */
+static int
+knn_candidate_cmp(const void *a, const void *b)
+{
+  const KnnCandidate *c1 = *(const KnnCandidate **) a;
+  const KnnCandidate *c2 = *(const KnnCandidate **) b;
+  if (c1->value != c2->value)
+    return (c1->value < c2->value) ? -1 : 1;
+  if (c1->slope != c2->slope)
+    return (c1->slope < c2->slope) ? -1 : 1;
+  return (c1->pos < c2->pos) ? -1 : 1;
+}
+
+/**
+ * Add the period to the time during which the candidate is a neighbor
+ */
+static void
+knn_add_period(KnnCandidate *c, TimestampTz lower, TimestampTz upper)
+{
+  if (c->nperiods == c->maxperiods)
+  {
+    c->maxperiods = (c->maxperiods == 0) ? 8 : c->maxperiods * 2;
+    c->periods = (c->periods == NULL) ?
+      palloc(sizeof(Period *) * c->maxperiods) :
+      repalloc(c->periods, sizeof(Period *) * c->maxperiods);
+  }
+  c->periods[c->nperiods++] = period_make(lower, upper, true, true);
+  return;
+}
+
+/**
+ * The candidate becomes a neighbor at the timestamp
+ */
+static void
+knn_open(KnnCandidate *c, TimestampTz t)
+{
+  if (! c->member)
+  {
+    c->member = true;
+    c->since = t;
+  }
+  return;
+}
+
+/**
+ * The candidate stops being a neighbor at the timestamp, where the
+ * instantaneous memberships due to ties are not kept
+ */
+static void
+knn_close(KnnCandidate *c, TimestampTz t)
+{
+  if (c->member)
+  {
+    c->member = false;
+    if (c->since < t)
+      knn_add_period(c, c->since, t);
+  }
+  return;
+}
+
+/**
+ * Returns the n-th sequence of the distance to the candidate
+ */
+static TSequence *
+knn_seq_n(const KnnCandidate *c, int n)
+{
+  if (c->dist->duration == SEQUENCE)
+    return (TSequence *) c->dist;
+  return tsequenceset_seq_n((TSequenceSet *) c->dist, n);
+}
+
+/**
+ * Returns the n-th instant of the distance to the candidate
+ */
+static TInstant *
+knn_inst_n(const KnnCandidate *c, int n)
+{
+  if (c->dist->duration == INSTANT)
+    return (TInstant *) c->dist;
+  return tinstantset_inst_n((TInstantSet *) c->dist, n);
+}
+
+/**
+ * Set the distance to the candidate at the timestamp and its variation
+ * until the next timestamp of the sweep.
+ * Returns false when the distance is not defined after the timestamp.
+ *
+ * @pre The timestamps are visited in increasing order and the next
+ * timestamp of the sweep is not after the next instant of the distance
+ */
+static bool
+knn_segment(KnnCandidate *c, TimestampTz t)
+{
+  while (c->cur < c->count && knn_seq_n(c, c->cur)->period.upper <= t)
+  {
+    c->cur++;
+    c->inst = 0;
+  }
+  if (c->cur == c->count)
+    return false;
+  TSequence *seq = knn_seq_n(c, c->cur);
+  if (seq->period.lower > t || seq->count < 2)
+    return false;
+  while (c->inst < seq->count - 2 &&
+    tsequence_inst_n(seq, c->inst + 1)->t <= t)
+    c->inst++;
+  TInstant *inst1 = tsequence_inst_n(seq, c->inst);
+  double value1 = DatumGetFloat8(tinstant_value(inst1));
+  if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, c->inst + 1);
+    double value2 = DatumGetFloat8(tinstant_value(inst2));
+    c->slope = (value2 - value1) / (double) (inst2->t - inst1->t);
+    c->value = value1 + c->slope * (double) (t - inst1->t);
+  }
+  else
+  {
+    c->slope = 0.0;
+    c->value = value1;
+  }
+  return true;
+}
+
+/**
+ * Sweep the distances to the candidates over the instants of discrete
+ * temporal points
+ */
+static void
+knn_sweep_discrete(KnnCandidate *cands, int ncands, const TimestampTz *times,
+  int ntimes, int k)
+{
+  KnnCandidate **active = palloc(sizeof(KnnCandidate *) * ncands);
+  for (int i = 0; i < ntimes; i++)
+  {
+    int n = 0;
+    for (int j = 0; j < ncands; j++)
+    {
+      KnnCandidate *c = &cands[j];
+      while (c->cur < c->count && knn_inst_n(c, c->cur)->t < times[i])
+        c->cur++;
+      if (c->cur < c->count && knn_inst_n(c, c->cur)->t == times[i])
+      {
+        c->value = DatumGetFloat8(tinstant_value(knn_inst_n(c, c->cur)));
+        c->slope = 0.0;
+        active[n++] = c;
+      }
+    }
+    if (n > k)
+      qsort(active, n, sizeof(KnnCandidate *), &knn_candidate_cmp);
+    for (int j = 0; j < Min(n, k); j++)
+      knn_add_period(active[j], times[i], times[i]);
+  }
+  pfree(active);
+  return;
+}
+
+/**
+ * Sweep the distances to the candidates over the elementary intervals
+ * of continuous temporal points
+ */
+static void
+knn_sweep_continuous(KnnCandidate *cands, int ncands, const TimestampTz *times,
+  int ntimes, int k)
+{
+  KnnCandidate **active = palloc(sizeof(KnnCandidate *) * ncands);
+  for (int i = 0; i < ntimes - 1; i++)
+  {
+    /* Neighbors at the start of the interval */
+    int n = 0;
+    for (int j = 0; j < ncands; j++)
+    {
+      cands[j].top = false;
+      if (knn_segment(&cands[j], times[i]))
+        active[n++] = &cands[j];
+    }
+    if (n > k)
+      qsort(active, n, sizeof(KnnCandidate *), &knn_candidate_cmp);
+    for (int j = 0; j < Min(n, k); j++)
+      active[j]->top = true;
+    for (int j = 0; j < ncands; j++)
+    {
+      if (! cands[j].top)
+        knn_close(&cands[j], times[i]);
+    }
+    for (int j = 0; j < Min(n, k); j++)
+      knn_open(active[j], times[i]);
+    if (n <= k)
+      continue;
+
+    /* Kinetic top-k: swap a neighbor and a candidate at their crossings.
+     * Each swap strictly decreases the sum of the variations of the
+     * distances of the neighbors, which ensures termination in the
+     * presence of ties. */
+    double span = (double) (times[i + 1] - times[i]);
+    double tc = 0.0;
+    while (true)
+    {
+      int ni = -1, nj = -1;
+      double tx = span;
+      for (int j = 0; j < k; j++)
+      {
+        for (int l = k; l < n; l++)
+        {
+          if (active[j]->slope <= active[l]->slope)
+            continue;
+          double tcross = (active[l]->value - active[j]->value) /
+            (active[j]->slope - active[l]->slope);
+          tcross = Max(tcross, tc);
+          if (tcross < tx)
+          {
+            tx = tcross;
+            ni = j;
+            nj = l;
+          }
+        }
+      }
+      if (ni < 0)
+        break;
+      TimestampTz t = times[i] + (TimestampTz) tx;
+      knn_close(active[ni], t);
+      knn_open(active[nj], t);
+      KnnCandidate *c = active[ni];
+      active[ni] = active[nj];
+      active[nj] = c;
+      tc = tx;
+    }
+  }
+  if (ntimes > 0)
+  {
+    for (int j = 0; j < ncands; j++)
+      knn_close(&cands[j], times[ntimes - 1]);
+  }
+  pfree(active);
+  return;
+}
+
+/*****************************************************************************
+ * Continuous k nearest neighbors
+ *****************************************************************************/
+
+/**
+ * Returns the time during which each temporal point of the array is
+ * among the k nearest neighbors of the temporal point (internal function)
+ *
+ * @pre The temporal points have the same SRID and dimensionality and k
+ * is positive
+ */
+KnnState *
+tknn_tpoint_tpointarr_internal(const Temporal *temp, Temporal **temparr,
+  int count, int k)
+{
+  KnnState *result = palloc0(sizeof(KnnState));
+  result->neighbors = palloc(sizeof(int) * Max(count, 1));
+  result->times = palloc(sizeof(PeriodSet *) * Max(count, 1));
+  if (count == 0)
+    return result;
+
+  bool hasz = MOBDB_FLAGS_GET_Z(temp->flags);
+  bool discrete = (temp->duration == INSTANT ||
+    temp->duration == INSTANTSET);
+  STBOX box;
+  temporal_bbox(&box, temp);
+  STBOX *boxes = palloc(sizeof(STBOX) * count);
+  for (int i = 0; i < count; i++)
+    temporal_bbox(&boxes[i], temparr[i]);
+  double bound = knn_stbox_bound(temp, &box, temparr, boxes, count, k);
+
+  /* Temporal distance to the candidates that are not pruned */
+  KnnCandidate *cands = palloc0(sizeof(KnnCandidate) * count);
+  int ncands = 0, ntimes = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (boxes[i].tmax < box.tmin || boxes[i].tmin > box.tmax ||
+      knn_stbox_distance(&box, &boxes[i], hasz, false) > bound)
+      continue;
+    Temporal *dist = distance_tpoint_tpoint_internal(temp, temparr[i]);
+    if (dist == NULL)
+      continue;
+    if (discrete != (dist->duration == INSTANT ||
+        dist->duration == INSTANTSET))
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The temporal points of the array must be continuous when the temporal point is continuous")));
+    KnnCandidate *c = &cands[ncands++];
+    c->pos = i;
+    c->dist = dist;
+    if (dist->duration == INSTANT || dist->duration == SEQUENCE)
+      c->count = 1;
+    else if (dist->duration == INSTANTSET)
+      c->count = ((TInstantSet *) dist)->count;
+    else
+      c->count = ((TSequenceSet *) dist)->count;
+    if (discrete)
+      ntimes += c->count;
+    else
+    {
+      for (int j = 0; j < c->count; j++)
+        ntimes += knn_seq_n(c, j)->count;
+    }
+  }
+  pfree(boxes);
+
+  /* Timestamps delimiting the elementary intervals of the sweep */
+  if (ntimes > 0)
+  {
+    TimestampTz *times = palloc(sizeof(TimestampTz) * ntimes);
+    int n = 0;
+    for (int i = 0; i < ncands; i++)
+    {
+      for (int j = 0; j < cands[i].count; j++)
+      {
+        if (discrete)
+          times[n++] = knn_inst_n(&cands[i], j)->t;
+        else
+        {
+          TSequence *seq = knn_seq_n(&cands[i], j);
+          for (int l = 0; l < seq->count; l++)
+            times[n++] = tsequence_inst_n(seq, l)->t;
+        }
+      }
+    }
+    timestamparr_sort(times, n);
+    n = timestamparr_remove_duplicates(times, n);
+    if (discrete)
+      knn_sweep_discrete(cands, ncands, times, n, k);
+    else
+      knn_sweep_continuous(cands, ncands, times, n, k);
+    pfree(times);
+  }
+
+  for (int i = 0; i < ncands; i++)
+  {
+    if (cands[i].nperiods > 0)
+    {
+      result->neighbors[result->count] = cands[i].pos;
+      result->times[result->count++] = periodset_make_free(cands[i].periods,
+        cands[i].nperiods, NORMALIZE);
+    }
+    pfree(cands[i].dist);
+  }
+  pfree(cands);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(tknn_tpoint_tpointarr);
+/**
+ * Returns the time during which each temporal point of the array is
+ * among the k nearest neighbors of the temporal point
+ */
+PGDLLEXPORT Datum
+tknn_tpoint_tpointarr(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  KnnState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+    int k = PG_GETARG_INT32(2);
+    if (k <= 0)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The number of neighbors must be positive")));
+    int count;
+    Temporal **temparr = temporalarr_extract(array, &count);
+    for (int i = 0; i < count; i++)
+    {
+      ensure_same_srid_tpoint(temp, temparr[i]);
+      ensure_same_dimensionality_tpoint(temp, temparr[i]);
+    }
+    funcctx->user_fctx = tknn_tpoint_tpointarr_internal(temp, temparr,
+      count, k);
+    pfree(temparr);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (KnnState *) funcctx->user_fctx;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The positions in the array start at 1 */
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Int32GetDatum(state->neighbors[state->i] + 1);
+  values[1] = PointerGetDatum(state->times[state->i]);
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
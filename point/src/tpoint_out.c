@@ -14,11 +14,16 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
+#include <miscadmin.h>
 #include <utils/builtins.h>
+#include <utils/datetime.h>
+#include <utils/timestamp.h>
 
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_aggfuncs.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
 
@@ -287,29 +292,35 @@ coordinates_mfjson_size(int npoints, bool hasz, int precision)
 static size_t
 coordinates_mfjson_buf(char *output, const TInstant *inst, int precision)
 {
-  char *ptr;
-  char x[OUT_DOUBLE_BUFFER_SIZE];
-  char y[OUT_DOUBLE_BUFFER_SIZE];
-
+  char *ptr = output;
   assert (precision <= OUT_MAX_DOUBLE_PRECISION);
-  ptr = output;
 
+  /* The coordinates are written in place, lwprint_double may return the
+   * length before the trailing zeros are removed */
+  *ptr++ = '[';
   if (MOBDB_FLAGS_GET_Z(inst->flags))
   {
-    char z[OUT_DOUBLE_BUFFER_SIZE];
     const POINT3DZ *pt = datum_get_point3dz_p(tinstant_value(inst));
-    lwprint_double(pt->x, precision, x, OUT_DOUBLE_BUFFER_SIZE);
-    lwprint_double(pt->y, precision, y, OUT_DOUBLE_BUFFER_SIZE);
-    lwprint_double(pt->z, precision, z, OUT_DOUBLE_BUFFER_SIZE);
-    ptr += sprintf(ptr, "[%s,%s,%s]", x, y, z);
+    lwprint_double(pt->x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+    ptr += strlen(ptr);
+    *ptr++ = ',';
+    lwprint_double(pt->y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+    ptr += strlen(ptr);
+    *ptr++ = ',';
+    lwprint_double(pt->z, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+    ptr += strlen(ptr);
   }
   else
   {
     const POINT2D *pt = datum_get_point2d_p(tinstant_value(inst));
-    lwprint_double(pt->x, precision, x, OUT_DOUBLE_BUFFER_SIZE);
-    lwprint_double(pt->y, precision, y, OUT_DOUBLE_BUFFER_SIZE);
-    ptr += sprintf(ptr, "[%s,%s]", x, y);
+    lwprint_double(pt->x, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+    ptr += strlen(ptr);
+    *ptr++ = ',';
+    lwprint_double(pt->y, precision, ptr, OUT_DOUBLE_BUFFER_SIZE);
+    ptr += strlen(ptr);
   }
+  *ptr++ = ']';
+  *ptr = '\0';
   return (ptr - output);
 }
 
@@ -319,26 +330,47 @@ coordinates_mfjson_buf(char *output, const TInstant *inst, int precision)
  *
  * For example `"datetimes":["2019-08-06T18:35:48.021455+02:30","2019-08-06T18:45:18.476983+02:30"]`
  * will return  2 enclosing brackets + 1 comma + 
- * for each timestamptz 32 characters + 2 double quotes + 1 comma
+ * for each timestamptz at most MAXDATELEN characters + 2 double quotes +
+ * 1 comma
  */
 static size_t
 datetimes_mfjson_size(int npoints)
 {
-  return sizeof("\"2019-08-06T18:35:48.021455+02:30\",") * npoints + sizeof("[],");
+  return (MAXDATELEN + sizeof("\"\",")) * npoints + sizeof("[],");
 }
 
 /**
  * Writes into the buffer the datetimes array represented in MF-JSON format
+ *
+ * @note The timestamp is encoded directly in ISO 8601 format instead of
+ * calling the output function of timestamptz, which depends on DateStyle
  */
 static size_t
 datetimes_mfjson_buf(char *output, const TInstant *inst)
 {
   char *ptr = output;
-  char *t = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(inst->t));
-  /* Replace ' ' by 'T' as separator between date and time parts */
-  t[10] = 'T';
-  ptr += sprintf(ptr, "\"%s\"", t);
-  pfree(t);
+  struct pg_tm tt, *tm = &tt;
+  fsec_t fsec;
+  int tz;
+  const char *tzn;
+
+  *ptr++ = '"';
+  if (! TIMESTAMP_NOT_FINITE(inst->t) &&
+      timestamp2tm(inst->t, &tz, tm, &fsec, &tzn, NULL) == 0)
+  {
+    EncodeDateTime(tm, fsec, true, tz, tzn, USE_ISO_DATES, ptr);
+    /* Replace ' ' by 'T' as separator between date and time parts */
+    ptr[10] = 'T';
+  }
+  else
+  {
+    char *t = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(inst->t));
+    strcpy(ptr, t);
+    pfree(t);
+  }
+  ptr += strlen(ptr);
+  *ptr++ = '"';
+  *ptr = '\0';
   return (ptr - output);
 }
 
@@ -659,6 +691,105 @@ tpointseqset_as_mfjson(const TSequenceSet *ts, int precision, const STBOX *bbox,
 
 /*****************************************************************************/
 
+/**
+ * Returns the maximum size in bytes of a temporal point represented in
+ * MF-JSON format (dispatch function)
+ */
+static size_t
+tpoint_as_mfjson_size(const Temporal *temp, int precision, const STBOX *bbox,
+  char *srs)
+{
+  size_t result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result = tpointinst_as_mfjson_size((TInstant *)temp, precision, bbox, srs);
+  else if (temp->duration == INSTANTSET)
+    result = tpointinstset_as_mfjson_size((TInstantSet *)temp, precision, bbox, srs);
+  else if (temp->duration == SEQUENCE)
+    result = tpointseq_as_mfjson_size((TSequence *)temp, precision, bbox, srs);
+  else /* temp->duration == SEQUENCESET */
+    result = tpointseqset_as_mfjson_size((TSequenceSet *)temp, precision, bbox, srs);
+  return result;
+}
+
+/**
+ * Writes into the buffer the temporal point represented in MF-JSON format
+ * (dispatch function)
+ */
+static size_t
+tpoint_as_mfjson_buf(const Temporal *temp, int precision, const STBOX *bbox,
+  char *srs, char *output)
+{
+  size_t result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result = tpointinst_as_mfjson_buf((TInstant *)temp, precision, bbox, srs, output);
+  else if (temp->duration == INSTANTSET)
+    result = tpointinstset_as_mfjson_buf((TInstantSet *)temp, precision, bbox, srs, output);
+  else if (temp->duration == SEQUENCE)
+    result = tpointseq_as_mfjson_buf((TSequence *)temp, precision, bbox, srs, output);
+  else /* temp->duration == SEQUENCESET */
+    result = tpointseqset_as_mfjson_buf((TSequenceSet *)temp, precision, bbox, srs, output);
+  return result;
+}
+
+/**
+ * Returns the maximum number of decimal digits given in the argument, if any
+ * (default is max)
+ */
+static int
+mfjson_precision(FunctionCallInfo fcinfo, int argno)
+{
+  int result = DBL_DIG;
+  if (PG_NARGS() > argno && !PG_ARGISNULL(argno))
+  {
+    result = PG_GETARG_INT32(argno);
+    if (result > DBL_DIG)
+      result = DBL_DIG;
+    else if (result < 0)
+      result = 0;
+  }
+  return result;
+}
+
+/**
+ * Returns the output option given in the argument, if any
+ * 0 = without option (default)
+ * 1 = bbox
+ * 2 = short crs
+ * 4 = long crs
+ * 8 = newline-delimited features, only for the MF-JSON aggregate
+ */
+static int
+mfjson_option(FunctionCallInfo fcinfo, int argno)
+{
+  if (PG_NARGS() > argno && !PG_ARGISNULL(argno))
+    return PG_GETARG_INT32(argno);
+  return 0;
+}
+
+/**
+ * Returns the reference system of the SRID requested by the output option,
+ * or NULL if the option does not request it or the SRID is unknown
+ */
+static char *
+mfjson_srs(FunctionCallInfo fcinfo, int32_t srid, int option)
+{
+  char *result = NULL;
+  if ((option & 2 || option & 4) && srid != SRID_UNKNOWN)
+  {
+    if (option & 2)
+      result = getSRSbySRID(fcinfo, srid, true);
+      // result = getSRSbySRID(srid, true);
+    if (option & 4)
+      result = getSRSbySRID(fcinfo, srid, false);
+      // result = getSRSbySRID(srid, false);
+    if (!result)
+      elog(ERROR, "SRID %i unknown in spatial_ref_sys table", srid);
+  }
+  return result;
+}
+
 PG_FUNCTION_INFO_V1(tpoint_as_mfjson);
 /**
  * Returns the temporal point represented in MF-JSON format
@@ -666,77 +797,128 @@ PG_FUNCTION_INFO_V1(tpoint_as_mfjson);
 PGDLLEXPORT Datum
 tpoint_as_mfjson(PG_FUNCTION_ARGS)
 {
-  int has_bbox = 0;
-  int precision = DBL_DIG;
-  char *srs = NULL;
-
   /* Get the temporal point */
   Temporal *temp = PG_GETARG_TEMPORAL(0);
+  int precision = mfjson_precision(fcinfo, 1);
+  int option = mfjson_option(fcinfo, 2);
+  char *srs = mfjson_srs(fcinfo, tpoint_srid_internal(temp), option);
 
-  /* Retrieve precision if any (default is max) */
-  if (PG_NARGS() > 1 && !PG_ARGISNULL(1))
+  /* Get bounding box if needed */
+  STBOX *bbox = NULL, tmp;
+  memset(&tmp, 0, sizeof(STBOX));
+  if (option & 1)
   {
-    precision = PG_GETARG_INT32(1);
-    if (precision > DBL_DIG)
-      precision = DBL_DIG;
-    else if (precision < 0)
-      precision = 0;
+    temporal_bbox(&tmp, temp);
+    bbox = &tmp;
   }
 
-  /* Retrieve output option
-   * 0 = without option (default)
-   * 1 = bbox
-   * 2 = short crs
-   * 4 = long crs
-   */
-  if (PG_NARGS() > 2 && !PG_ARGISNULL(2))
-  {
-    int option = PG_GETARG_INT32(2);
+  size_t size = tpoint_as_mfjson_size(temp, precision, bbox, srs);
+  char *mfjson = palloc(size);
+  tpoint_as_mfjson_buf(temp, precision, bbox, srs, mfjson);
+  text *result = cstring_to_text(mfjson);
+  pfree(mfjson);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_TEXT_P(result);
+}
 
-    if (option & 2 || option & 4)
-    {
-      int32_t srid = tpoint_srid_internal(temp);
-      if (srid != SRID_UNKNOWN)
-      {
-        if (option & 2)
-          srs = getSRSbySRID(fcinfo, srid, true);
-          // srs = getSRSbySRID(srid, true);
-        if (option & 4)
-          srs = getSRSbySRID(fcinfo, srid, false);
-          // srs = getSRSbySRID(srid, false);
-        if (!srs)
-        {
-          elog(ERROR, "SRID %i unknown in spatial_ref_sys table",
-              srid);
-          PG_RETURN_NULL();
-        }
-      }
-    }
-    if (option & 1)
-      has_bbox = 1;
-  }
+/*****************************************************************************
+ * Aggregate output in MF-JSON format
+ *****************************************************************************/
 
-  /* Get bounding box if needed */
+/**
+ * Appends the feature of the temporal point represented in MF-JSON format to
+ * the state. The size of the representation is reserved in the buffer, into
+ * which the representation is written directly.
+ */
+static void
+mfjsonstate_add(MFJSONState *state, FunctionCallInfo fcinfo,
+  const Temporal *temp)
+{
+  int32_t srid = tpoint_srid_internal(temp);
+  if (state->srs == NULL || srid != state->srid)
+  {
+    if (state->srs != NULL)
+      pfree(state->srs);
+    state->srs = mfjson_srs(fcinfo, srid, state->option);
+    state->srid = srid;
+  }
   STBOX *bbox = NULL, tmp;
   memset(&tmp, 0, sizeof(STBOX));
-  if (has_bbox)
+  if (state->option & 1)
   {
     temporal_bbox(&tmp, temp);
     bbox = &tmp;
   }
 
-  char *mfjson;
-  ensure_valid_duration(temp->duration);
-  if (temp->duration == INSTANT)
-    mfjson = tpointinst_as_mfjson((TInstant *)temp, precision, bbox, srs);
-  else if (temp->duration == INSTANTSET)
-    mfjson = tpointinstset_as_mfjson((TInstantSet *)temp, precision, bbox, srs);
-  else if (temp->duration == SEQUENCE)
-    mfjson = tpointseq_as_mfjson((TSequence *)temp, precision, bbox, srs);
-  else /* temp->duration == SEQUENCESET */
-    mfjson = tpointseqset_as_mfjson((TSequenceSet *)temp, precision, bbox, srs);
-  text *result = cstring_to_text(mfjson);
-  PG_FREE_IF_COPY(temp, 0);
+  bool ndjson = (state->option & 8) != 0;
+  if (! ndjson && state->count > 0)
+    appendStringInfoChar(&state->buf, ',');
+  appendStringInfoString(&state->buf, "{\"type\":\"Feature\",\"temporalGeometry\":");
+  size_t size = tpoint_as_mfjson_size(temp, state->precision, bbox,
+    state->srs);
+  enlargeStringInfo(&state->buf, (int) size);
+  state->buf.len += (int) tpoint_as_mfjson_buf(temp, state->precision, bbox,
+    state->srs, state->buf.data + state->buf.len);
+  appendStringInfoString(&state->buf, ",\"properties\":null}");
+  if (ndjson)
+    appendStringInfoChar(&state->buf, '\n');
+  state->count++;
+  return;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_mfjson_transfn);
+/**
+ * Transition function for the aggregate output of temporal points in MF-JSON
+ * format
+ */
+PGDLLEXPORT Datum
+tpoint_mfjson_transfn(PG_FUNCTION_ARGS)
+{
+  MFJSONState *state = PG_ARGISNULL(0) ? NULL :
+    (MFJSONState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (! state)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(state);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  if (! state)
+  {
+    state = palloc0(sizeof(MFJSONState));
+    initStringInfo(&state->buf);
+    state->precision = mfjson_precision(fcinfo, 2);
+    state->option = mfjson_option(fcinfo, 3);
+    if (! (state->option & 8))
+      appendStringInfoString(&state->buf,
+        "{\"type\":\"FeatureCollection\",\"features\":[");
+  }
+  mfjsonstate_add(state, fcinfo, temp);
+  unset_aggregation_context(ctx);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_mfjson_finalfn);
+/**
+ * Final function for the aggregate output of temporal points in MF-JSON
+ * format, which returns a FeatureCollection or, with option 8, one feature
+ * per line
+ */
+PGDLLEXPORT Datum
+tpoint_mfjson_finalfn(PG_FUNCTION_ARGS)
+{
+  MFJSONState *state = (MFJSONState *) PG_GETARG_POINTER(0);
+  text *result = palloc(state->buf.len + 2 + VARHDRSZ);
+  memcpy(VARDATA(result), state->buf.data, state->buf.len);
+  size_t len = state->buf.len;
+  if (! (state->option & 8))
+  {
+    memcpy(VARDATA(result) + len, "]}", 2);
+    len += 2;
+  }
+  SET_VARSIZE(result, len + VARHDRSZ);
   PG_RETURN_TEXT_P(result);
 }
 
@@ -1441,3 +1623,281 @@ tpoint_as_hexewkb(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Output in TWKB format
+ *****************************************************************************/
+
+/*
+ * The Tiny Well-Known Binary (TWKB) representation of a temporal point
+ * follows the one of PostGIS for geometries. The coordinates are scaled by
+ * a power of ten given by the precision, rounded to integers, and written as
+ * zig-zag varints containing the difference with the previous instant. The
+ * timestamps are handled in the same way, the time precision being the
+ * number of decimal digits of the seconds.
+ *
+ * The format is as follows
+ * - 1 byte containing the duration in the lower 4 bits and the zig-zag
+ *   encoded precision of the X and Y coordinates in the upper 4 bits
+ * - 1 byte of flags: TWKB_ZFLAG, TWKB_LINEAR_INTERP, TWKB_SRIDFLAG
+ * - 1 byte containing the zig-zag encoded precision of the Z coordinate,
+ *   if there is a Z coordinate
+ * - 1 byte containing the time precision
+ * - the SRID as a zig-zag varint if the flag TWKB_SRIDFLAG is set
+ * - for instant sets and sequences the number of instants as a varint, for
+ *   sequences followed by 1 byte containing the bounds as in WKB
+ * - for sequence sets the number of sequences as a varint followed by the
+ *   number of instants and the bounds of each sequence
+ * - the instants as varints X, Y, [Z,] T
+ */
+
+/**
+ * Structure used for passing the state between the TWKB output functions
+ */
+typedef struct
+{
+  double factor;     /**< Scale factor of the X and Y coordinates */
+  double factor_z;   /**< Scale factor of the Z coordinate */
+  int64 unit;        /**< Time unit in microseconds */
+  int64 last[4];     /**< Previous values for the delta encoding */
+} twkb_out_state;
+
+/**
+ * Writes into the buffer an unsigned integer as a varint
+ */
+static uint8_t *
+varint_u64_to_twkb_buf(uint64 value, uint8_t *buf)
+{
+  while (value >= 0x80)
+  {
+    *buf++ = (uint8_t) ((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  *buf++ = (uint8_t) value;
+  return buf;
+}
+
+/**
+ * Writes into the buffer a signed integer as a zig-zag varint, which maps
+ * integers of small magnitude into small unsigned integers
+ */
+static uint8_t *
+varint_s64_to_twkb_buf(int64 value, uint8_t *buf)
+{
+  return varint_u64_to_twkb_buf(((uint64) value << 1) ^ (uint64) (value >> 63),
+    buf);
+}
+
+/**
+ * Returns the zig-zag encoding of a precision
+ */
+static uint8_t
+precision_to_twkb(int precision)
+{
+  return (uint8_t) (((uint32) precision << 1) ^ (uint32) (precision >> 31));
+}
+
+/**
+ * Returns the timestamp rounded to the time unit
+ */
+static int64
+timestamp_to_twkb(TimestampTz t, int64 unit)
+{
+  int64 result = t / unit, rem = t % unit;
+  if (rem < 0)
+  {
+    result--;
+    rem += unit;
+  }
+  if (2 * rem >= unit)
+    result++;
+  return result;
+}
+
+/**
+ * Writes into the buffer the delta-encoded coordinates and timestamp of a
+ * temporal instant point represented in TWKB format
+ */
+static uint8_t *
+coordinates_to_twkb_buf(const TInstant *inst, twkb_out_state *state,
+  uint8_t *buf)
+{
+  int64 values[4];
+  int ndims;
+  if (MOBDB_FLAGS_GET_Z(inst->flags))
+  {
+    const POINT3DZ *point = datum_get_point3dz_p(tinstant_value(inst));
+    values[0] = llround(point->x * state->factor);
+    values[1] = llround(point->y * state->factor);
+    values[2] = llround(point->z * state->factor_z);
+    ndims = 3;
+  }
+  else
+  {
+    const POINT2D *point = datum_get_point2d_p(tinstant_value(inst));
+    values[0] = llround(point->x * state->factor);
+    values[1] = llround(point->y * state->factor);
+    ndims = 2;
+  }
+  values[ndims] = timestamp_to_twkb(inst->t, state->unit);
+  for (int i = 0; i <= ndims; i++)
+  {
+    buf = varint_s64_to_twkb_buf(values[i] - state->last[i], buf);
+    state->last[i] = values[i];
+  }
+  return buf;
+}
+
+/**
+ * Returns the maximum size in bytes of the temporal point represented in
+ * TWKB format
+ */
+static size_t
+tpoint_to_twkb_size(const Temporal *temp)
+{
+  int ndims = MOBDB_FLAGS_GET_Z(temp->flags) ? 3 : 2;
+  int count, nseqs = 0;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    count = 1;
+  else if (temp->duration == INSTANTSET)
+    count = ((TInstantSet *) temp)->count;
+  else if (temp->duration == SEQUENCE)
+  {
+    count = ((TSequence *) temp)->count;
+    nseqs = 1;
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    count = ((TSequenceSet *) temp)->totalcount;
+    nseqs = ((TSequenceSet *) temp)->count;
+  }
+  /* Header, precisions, SRID, and number of sequences */
+  size_t size = WKB_BYTE_SIZE * 4 + TWKB_MAX_VARINT_SIZE * 2;
+  /* Number of instants and bounds of the sequences */
+  size += (TWKB_MAX_VARINT_SIZE + WKB_BYTE_SIZE) * nseqs;
+  /* Instants */
+  size += TWKB_MAX_VARINT_SIZE * (ndims + 1) * count;
+  return size;
+}
+
+/**
+ * Writes into the buffer the bounds of a temporal sequence point
+ * represented in TWKB format
+ */
+static uint8_t *
+tpointseq_twkb_bounds(const TSequence *seq, uint8_t *buf)
+{
+  uint8_t wkb_flags = 0;
+  if (seq->period.lower_inc)
+    wkb_flags |= WKB_LOWER_INC;
+  if (seq->period.upper_inc)
+    wkb_flags |= WKB_UPPER_INC;
+  *buf++ = wkb_flags;
+  return buf;
+}
+
+/**
+ * Writes into the buffer the instants of a temporal sequence point
+ * represented in TWKB format
+ */
+static uint8_t *
+tpointseq_to_twkb_buf(const TSequence *seq, twkb_out_state *state,
+  uint8_t *buf)
+{
+  buf = varint_u64_to_twkb_buf((uint64) seq->count, buf);
+  buf = tpointseq_twkb_bounds(seq, buf);
+  for (int i = 0; i < seq->count; i++)
+    buf = coordinates_to_twkb_buf(tsequence_inst_n(seq, i), state, buf);
+  return buf;
+}
+
+/**
+ * Writes into the buffer the temporal point represented in TWKB format
+ */
+static uint8_t *
+tpoint_to_twkb_buf(const Temporal *temp, int precision, int precision_z,
+  int precision_t, uint8_t *buf)
+{
+  twkb_out_state state;
+  state.factor = pow(10.0, precision);
+  state.factor_z = pow(10.0, precision_z);
+  state.unit = 1;
+  for (int i = precision_t; i < TWKB_MAX_TIME_PRECISION; i++)
+    state.unit *= 10;
+  memset(state.last, 0, sizeof(state.last));
+
+  /* Set the duration and the precision */
+  bool hasz = MOBDB_FLAGS_GET_Z(temp->flags);
+  int srid = tpoint_srid_internal(temp);
+  *buf++ = (uint8_t) (temp->duration | (precision_to_twkb(precision) << 4));
+  /* Set the flags */
+  uint8_t flags = 0;
+  if (hasz)
+    flags |= TWKB_ZFLAG;
+  if (MOBDB_FLAGS_GET_LINEAR(temp->flags))
+    flags |= TWKB_LINEAR_INTERP;
+  if (srid != SRID_UNKNOWN)
+    flags |= TWKB_SRIDFLAG;
+  *buf++ = flags;
+  if (hasz)
+    *buf++ = precision_to_twkb(precision_z);
+  *buf++ = (uint8_t) precision_t;
+  if (srid != SRID_UNKNOWN)
+    buf = varint_s64_to_twkb_buf(srid, buf);
+
+  /* Set the instants */
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    buf = coordinates_to_twkb_buf((TInstant *) temp, &state, buf);
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (TInstantSet *) temp;
+    buf = varint_u64_to_twkb_buf((uint64) ti->count, buf);
+    for (int i = 0; i < ti->count; i++)
+      buf = coordinates_to_twkb_buf(tinstantset_inst_n(ti, i), &state, buf);
+  }
+  else if (temp->duration == SEQUENCE)
+    buf = tpointseq_to_twkb_buf((TSequence *) temp, &state, buf);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (TSequenceSet *) temp;
+    buf = varint_u64_to_twkb_buf((uint64) ts->count, buf);
+    for (int i = 0; i < ts->count; i++)
+      buf = tpointseq_to_twkb_buf(tsequenceset_seq_n(ts, i), &state, buf);
+  }
+  return buf;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_as_twkb);
+/**
+ * Output the temporal point in TWKB format with the precisions of the 
+ * coordinates and of the timestamps given in the arguments
+ */
+PGDLLEXPORT Datum
+tpoint_as_twkb(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  int precision = PG_GETARG_INT32(1);
+  int precision_z = PG_GETARG_INT32(2);
+  int precision_t = PG_GETARG_INT32(3);
+  if (precision < - TWKB_MAX_PRECISION || precision > TWKB_MAX_PRECISION ||
+      precision_z < - TWKB_MAX_PRECISION || precision_z > TWKB_MAX_PRECISION)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The precision of the coordinates must be between -%d and %d",
+        TWKB_MAX_PRECISION, TWKB_MAX_PRECISION)));
+  if (precision_t < 0 || precision_t > TWKB_MAX_TIME_PRECISION)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The precision of the timestamps must be between 0 and %d",
+        TWKB_MAX_TIME_PRECISION)));
+
+  /* Write the TWKB directly into the result */
+  bytea *result = palloc(tpoint_to_twkb_size(temp) + VARHDRSZ);
+  uint8_t *buf = tpoint_to_twkb_buf(temp, precision, precision_z, 
+    precision_t, (uint8_t *) VARDATA(result));
+  SET_VARSIZE(result, buf - (uint8_t *) result);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_BYTEA_P(result);
+}
+
+/*****************************************************************************/
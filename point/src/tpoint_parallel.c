@@ -0,0 +1,410 @@
+/*****************************************************************************
+ *
+ * tpoint_parallel.c
+ *    Processing of very large temporal point sequences in parallel chunks
+ *
+ * A temporal sequence point with at least mobilitydb.parallel_min_instants
+ * instants is split into chunks of consecutive segments. Two consecutive
+ * chunks share their boundary instant, which is exclusive in the first one
+ * and inclusive in the second one. The chunks are copied into a dynamic
+ * shared memory segment and each of them except the first one is processed
+ * by a dynamic background worker, while the backend processes the first
+ * chunk. The workers send back their result through a message queue and
+ * the results are stitched together with the normalization of arrays of
+ * sequences, which joins the sequences at the boundaries of the chunks with
+ * tsequence_join. When a worker cannot be started, its chunk is processed
+ * by the backend.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_parallel.h"
+
+#include <miscadmin.h>
+#include <access/htup_details.h>
+#include <access/parallel.h>
+#include <access/xact.h>
+#include <catalog/pg_proc.h>
+#include <postmaster/bgworker.h>
+#include <storage/dsm.h>
+#include <storage/proc.h>
+#include <storage/shm_mq.h>
+#include <storage/shm_toc.h>
+#include <tcop/tcopprot.h>
+#include <utils/builtins.h>
+#include <utils/resowner.h>
+#include <utils/syscache.h>
+
+#include "tsequence.h"
+#include "tsequenceset.h"
+#include "stbox.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************/
+
+/**
+ * Global variable that states the maximum number of background workers
+ * processing the chunks of a sequence. It is set by the configuration
+ * parameter mobilitydb.parallel_workers, 0 disables the parallel processing.
+ */
+int tpoint_parallel_workers = 0;
+
+/**
+ * Global variable that states the minimum number of instants of a sequence
+ * processed in parallel. It is set by the configuration parameter
+ * mobilitydb.parallel_min_instants.
+ */
+int tpoint_parallel_min_instants = 1000000;
+
+/** Keys of the table of contents of the shared memory segment */
+#define PARALLEL_KEY_HEADER      1
+#define PARALLEL_KEY_GEO         2
+#define PARALLEL_KEY_CHUNK(i)    (1000 + (i))
+#define PARALLEL_KEY_QUEUE(i)    (2000 + (i))
+
+/**
+ * Structure to represent the fixed part of the shared memory segment
+ */
+typedef struct
+{
+  Oid database;              /**< Database of the backend */
+  Oid user;                  /**< User of the backend */
+  ParallelFunc func;         /**< Function computed on the chunks */
+  int nchunks;               /**< Number of chunks */
+  bool spheroid;             /**< Value of mobilitydb.use_spheroid */
+} ParallelHeader;
+
+/*****************************************************************************/
+
+/**
+ * Returns true if the temporal sequence point is processed in parallel
+ */
+bool
+tpointseq_parallel_eligible(const TSequence *seq)
+{
+  return tpoint_parallel_workers > 0 &&
+    seq->count >= tpoint_parallel_min_instants &&
+    seq->count - 1 >= 2 * TPOINT_PARALLEL_MIN_SEGS &&
+    ! IsParallelWorker();
+}
+
+/**
+ * Computes the function on a chunk
+ *
+ * @param[in] seq Chunk
+ * @param[in] func Function computed
+ * @param[in] geo Geometry, if any
+ * @result Temporal sequence for the speed, temporal sequence set or NULL
+ * for the restriction to the geometry
+ */
+static Temporal *
+tpoint_parallel_chunk(const TSequence *seq, ParallelFunc func, Datum geo)
+{
+  if (func == PARALLEL_SPEED)
+    return (Temporal *) tpointseq_speed(seq);
+  /* func == PARALLEL_AT_GEOMETRY */
+  int count;
+  TSequence **sequences = tpointseq_at_geometry2(seq, geo, &count);
+  if (sequences == NULL)
+    return NULL;
+  return (Temporal *) tsequenceset_make_free(sequences, count, NORMALIZE_NO);
+}
+
+/**
+ * Stitches together the results of the chunks
+ *
+ * @param[in] results Results of the chunks in time order, may be NULL
+ * @param[in] count Number of chunks
+ * @param[in] func Function computed
+ */
+static Temporal *
+tpoint_parallel_stitch(Temporal **results, int count, ParallelFunc func)
+{
+  int totalseqs = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (results[i] != NULL)
+      totalseqs += (results[i]->duration == SEQUENCE) ? 1 :
+        ((TSequenceSet *) results[i])->count;
+  }
+  if (totalseqs == 0)
+    return NULL;
+
+  TSequence **sequences = palloc(sizeof(TSequence *) * totalseqs);
+  int k = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (results[i] == NULL)
+      continue;
+    if (results[i]->duration == SEQUENCE)
+      sequences[k++] = (TSequence *) results[i];
+    else
+    {
+      TSequenceSet *ts = (TSequenceSet *) results[i];
+      for (int j = 0; j < ts->count; j++)
+        sequences[k++] = tsequenceset_seq_n(ts, j);
+    }
+  }
+
+  Temporal *result;
+  if (func == PARALLEL_SPEED)
+  {
+    /* The step sequences of the chunks are joined into a single one */
+    int newcount;
+    TSequence **normseqs = tsequencearr_normalize(sequences, k, &newcount);
+    if (newcount == 1)
+    {
+      result = (Temporal *) normseqs[0];
+      pfree(normseqs);
+    }
+    else
+      result = (Temporal *) tsequenceset_make_free(normseqs, newcount,
+        NORMALIZE_NO);
+  }
+  else
+    result = (Temporal *) tsequenceset_make(sequences, k, NORMALIZE);
+  pfree(sequences);
+  return result;
+}
+
+/**
+ * Returns the name of the library of the function being called, which is
+ * loaded by the workers
+ */
+static void
+tpoint_parallel_library(FunctionCallInfo fcinfo, char *libname)
+{
+  snprintf(libname, BGW_MAXLEN, "%s", MOBDB_LIBRARY_NAME);
+  if (fcinfo == NULL || fcinfo->flinfo == NULL ||
+      ! OidIsValid(fcinfo->flinfo->fn_oid))
+    return;
+  HeapTuple tuple = SearchSysCache1(PROCOID,
+    ObjectIdGetDatum(fcinfo->flinfo->fn_oid));
+  if (! HeapTupleIsValid(tuple))
+    return;
+  bool isnull;
+  Datum probin = SysCacheGetAttr(PROCOID, tuple, Anum_pg_proc_probin,
+    &isnull);
+  if (! isnull)
+  {
+    char *path = TextDatumGetCString(probin);
+    if (strlen(path) < BGW_MAXLEN)
+      strcpy(libname, path);
+    pfree(path);
+  }
+  ReleaseSysCache(tuple);
+}
+
+/**
+ * Computes the function on the temporal sequence point in parallel chunks
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] seq Temporal point
+ * @param[in] func Function computed
+ * @param[in] geo Geometry for the restriction functions
+ * @pre The sequence satisfies tpointseq_parallel_eligible
+ */
+Temporal *
+tpointseq_parallel(FunctionCallInfo fcinfo, const TSequence *seq,
+  ParallelFunc func, Datum geo)
+{
+  /* Bounding box test */
+  if (func == PARALLEL_AT_GEOMETRY)
+  {
+    STBOX box;
+    memset(&box, 0, sizeof(STBOX));
+    geo_to_stbox_internal(&box, (GSERIALIZED *) DatumGetPointer(geo));
+    if (! overlaps_stbox_stbox_internal(tsequence_bbox_ptr(seq), &box))
+      return NULL;
+  }
+
+  int nworkers = Min(tpoint_parallel_workers,
+    (seq->count - 1) / TPOINT_PARALLEL_MIN_SEGS - 1);
+  int nchunks = nworkers + 1;
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+
+  /* Split the sequence into chunks sharing their boundary instants */
+  TSequence **chunks = palloc(sizeof(TSequence *) * nchunks);
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  for (int i = 0; i < seq->count; i++)
+    instants[i] = tsequence_inst_n(seq, i);
+  for (int i = 0; i < nchunks; i++)
+  {
+    int start = (int) ((int64) i * (seq->count - 1) / nchunks);
+    int end = (int) ((int64) (i + 1) * (seq->count - 1) / nchunks);
+    chunks[i] = tsequence_make(&instants[start], end - start + 1,
+      (i == 0) ? seq->period.lower_inc : true,
+      (i == nchunks - 1) ? seq->period.upper_inc : false, linear,
+      NORMALIZE_NO);
+  }
+  pfree(instants);
+
+  /* Lay out the shared memory segment */
+  GSERIALIZED *gs = (func == PARALLEL_AT_GEOMETRY) ?
+    (GSERIALIZED *) DatumGetPointer(geo) : NULL;
+  shm_toc_estimator e;
+  shm_toc_initialize_estimator(&e);
+  shm_toc_estimate_chunk(&e, sizeof(ParallelHeader));
+  if (gs != NULL)
+    shm_toc_estimate_chunk(&e, VARSIZE(gs));
+  for (int i = 1; i < nchunks; i++)
+  {
+    shm_toc_estimate_chunk(&e, VARSIZE(chunks[i]));
+    shm_toc_estimate_chunk(&e, TPOINT_PARALLEL_QUEUE_SIZE);
+  }
+  shm_toc_estimate_keys(&e, 2 + 2 * nworkers);
+  Size size = shm_toc_estimate(&e);
+
+  dsm_segment *seg = dsm_create(size, 0);
+  shm_toc *toc = shm_toc_create(TPOINT_PARALLEL_MAGIC,
+    dsm_segment_address(seg), size);
+  ParallelHeader *header = shm_toc_allocate(toc, sizeof(ParallelHeader));
+  header->database = MyDatabaseId;
+  header->user = GetUserId();
+  header->func = func;
+  header->nchunks = nchunks;
+  header->spheroid = geodetic_use_spheroid;
+  shm_toc_insert(toc, PARALLEL_KEY_HEADER, header);
+  if (gs != NULL)
+  {
+    void *geocopy = shm_toc_allocate(toc, VARSIZE(gs));
+    memcpy(geocopy, gs, VARSIZE(gs));
+    shm_toc_insert(toc, PARALLEL_KEY_GEO, geocopy);
+  }
+  shm_mq **queues = palloc(sizeof(shm_mq *) * nchunks);
+  for (int i = 1; i < nchunks; i++)
+  {
+    void *chunk = shm_toc_allocate(toc, VARSIZE(chunks[i]));
+    memcpy(chunk, chunks[i], VARSIZE(chunks[i]));
+    shm_toc_insert(toc, PARALLEL_KEY_CHUNK(i), chunk);
+    pfree(chunks[i]);
+    chunks[i] = (TSequence *) chunk;
+    queues[i] = shm_mq_create(shm_toc_allocate(toc,
+      TPOINT_PARALLEL_QUEUE_SIZE), TPOINT_PARALLEL_QUEUE_SIZE);
+    shm_mq_set_receiver(queues[i], MyProc);
+    shm_toc_insert(toc, PARALLEL_KEY_QUEUE(i), queues[i]);
+  }
+
+  /* Launch the workers */
+  BackgroundWorker worker;
+  memset(&worker, 0, sizeof(BackgroundWorker));
+  worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+    BGWORKER_BACKEND_DATABASE_CONNECTION;
+  worker.bgw_start_time = BgWorkerStart_ConsistentState;
+  worker.bgw_restart_time = BGW_NEVER_RESTART;
+  tpoint_parallel_library(fcinfo, worker.bgw_library_name);
+  snprintf(worker.bgw_function_name, BGW_MAXLEN, "tpoint_parallel_main");
+  snprintf(worker.bgw_name, BGW_MAXLEN,
+    "MobilityDB parallel worker for PID %d", MyProcPid);
+#if MOBDB_PGSQL_VERSION >= 110000
+  snprintf(worker.bgw_type, BGW_MAXLEN, "MobilityDB parallel worker");
+#endif
+  worker.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(seg));
+  worker.bgw_notify_pid = MyProcPid;
+  shm_mq_handle **handles = palloc0(sizeof(shm_mq_handle *) * nchunks);
+  for (int i = 1; i < nchunks; i++)
+  {
+    BackgroundWorkerHandle *bgwhandle;
+    memcpy(worker.bgw_extra, &i, sizeof(int));
+    /* The chunks of the workers that cannot be started are processed by
+     * the backend */
+    if (RegisterDynamicBackgroundWorker(&worker, &bgwhandle))
+      handles[i] = shm_mq_attach(queues[i], seg, bgwhandle);
+  }
+
+  /* Process the first chunk and collect the results of the workers */
+  Temporal **results = palloc(sizeof(Temporal *) * nchunks);
+  results[0] = tpoint_parallel_chunk(chunks[0], func, geo);
+  pfree(chunks[0]);
+  for (int i = 1; i < nchunks; i++)
+  {
+    if (handles[i] == NULL)
+    {
+      results[i] = tpoint_parallel_chunk(chunks[i], func, geo);
+      continue;
+    }
+    Size nbytes;
+    void *data;
+    shm_mq_result res = shm_mq_receive(handles[i], &nbytes, &data, false);
+    if (res != SHM_MQ_SUCCESS)
+      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+        errmsg("A parallel worker of MobilityDB failed")));
+    if (nbytes == 0)
+      results[i] = NULL;
+    else
+    {
+      results[i] = palloc(nbytes);
+      memcpy(results[i], data, nbytes);
+    }
+    shm_mq_detach(handles[i]);
+  }
+  dsm_detach(seg);
+
+  Temporal *result = tpoint_parallel_stitch(results, nchunks, func);
+  for (int i = 0; i < nchunks; i++)
+  {
+    if (results[i] != NULL)
+      pfree(results[i]);
+  }
+  pfree(results); pfree(chunks); pfree(queues); pfree(handles);
+  return result;
+}
+
+/**
+ * Main function of the background workers processing a chunk
+ */
+void
+tpoint_parallel_main(Datum arg)
+{
+  int chunk;
+  memcpy(&chunk, MyBgworkerEntry->bgw_extra, sizeof(int));
+  pqsignal(SIGTERM, die);
+  BackgroundWorkerUnblockSignals();
+
+  CurrentResourceOwner = ResourceOwnerCreate(NULL,
+    "MobilityDB parallel worker");
+  dsm_segment *seg = dsm_attach(DatumGetUInt32(arg));
+  if (seg == NULL)
+    ereport(ERROR, (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+      errmsg("Unable to map the shared memory segment of the chunks")));
+  /* Keep the mapping across the transactions of the worker */
+  dsm_pin_mapping(seg);
+  shm_toc *toc = shm_toc_attach(TPOINT_PARALLEL_MAGIC,
+    dsm_segment_address(seg));
+  if (toc == NULL)
+    ereport(ERROR, (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+      errmsg("Invalid magic number in the shared memory segment of the chunks")));
+  ParallelHeader *header = shm_toc_lookup(toc, PARALLEL_KEY_HEADER, false);
+  shm_mq *mq = shm_toc_lookup(toc, PARALLEL_KEY_QUEUE(chunk), false);
+  shm_mq_set_sender(mq, MyProc);
+  shm_mq_handle *mqh = shm_mq_attach(mq, seg, NULL);
+
+#if MOBDB_PGSQL_VERSION < 110000
+  BackgroundWorkerInitializeConnectionByOid(header->database, header->user);
+#else
+  BackgroundWorkerInitializeConnectionByOid(header->database, header->user,
+    0);
+#endif
+  geodetic_use_spheroid = header->spheroid;
+
+  StartTransactionCommand();
+  TSequence *seq = shm_toc_lookup(toc, PARALLEL_KEY_CHUNK(chunk), false);
+  Datum geo = (header->func == PARALLEL_AT_GEOMETRY) ?
+    PointerGetDatum(shm_toc_lookup(toc, PARALLEL_KEY_GEO, false)) : 0;
+  Temporal *result = tpoint_parallel_chunk(seq, header->func, geo);
+  /* An empty message states an empty result */
+  if (result == NULL)
+    shm_mq_send(mqh, 0, "", false);
+  else
+    shm_mq_send(mqh, VARSIZE(result), result, false);
+  CommitTransactionCommand();
+
+  dsm_detach(seg);
+  proc_exit(0);
+}
+
+/*****************************************************************************/
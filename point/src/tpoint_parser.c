@@ -189,6 +189,99 @@ stbox_parse(char **str)
 
 /*****************************************************************************/
 
+/**
+ * Parse a coordinate of a point in WKT without calling the input function
+ * of the type
+ *
+ * Only the characters of the numbers accepted by the WKT parser of PostGIS
+ * are consumed, and thus special values such as NaN are rejected.
+ */
+static bool
+coord_parse_fast(char **str, double *result)
+{
+  p_whitespace(str);
+  int len = 0;
+  while (((*str)[len] >= '0' && (*str)[len] <= '9') || (*str)[len] == '.' ||
+      (*str)[len] == '-' || (*str)[len] == '+' || (*str)[len] == 'e' ||
+      (*str)[len] == 'E')
+    len++;
+  if (len == 0)
+    return false;
+  char *end;
+  *result = strtod(*str, &end);
+  if (end != *str + len)
+    return false;
+  *str = end;
+  return true;
+}
+
+/**
+ * Parse a geometry point value of the form `[SRID=n;]POINT[ Z](x y[ z])`
+ * followed by the @ sign from the buffer without calling the input function
+ * of the type
+ *
+ * The function returns false and leaves the buffer unchanged for any other
+ * input, e.g., hexadecimal WKB, empty points, or points with M, in which case
+ * the input function must be called for obtaining its value or the error
+ * message.
+ */
+static bool
+geompoint_parse_fast(char **str, Datum *result)
+{
+  char *cur = *str;
+  int srid = SRID_UNKNOWN;
+  bool hasz = false;
+  double x, y, z = 0;
+
+  p_whitespace(&cur);
+  if (strncasecmp(cur, "SRID=", 5) == 0)
+  {
+    cur += 5;
+    int len = 0;
+    srid = 0;
+    while (cur[len] >= '0' && cur[len] <= '9' && len < 7)
+      srid = srid * 10 + cur[len++] - '0';
+    if (len == 0 || cur[len] != ';' || srid > SRID_USER_MAXIMUM)
+      return false;
+    cur += len + 1;
+  }
+  if (strncasecmp(cur, "POINT", 5) != 0)
+    return false;
+  cur += 5;
+  p_whitespace(&cur);
+  if ((*cur == 'Z' || *cur == 'z') && (cur[-1] == ' ' || cur[-1] == '\t'))
+  {
+    hasz = true;
+    cur++;
+  }
+  if (! p_oparen(&cur) || ! coord_parse_fast(&cur, &x) ||
+      ! coord_parse_fast(&cur, &y))
+    return false;
+  p_whitespace(&cur);
+  if (*cur != ')')
+  {
+    /* A third coordinate without the Z tag also denotes a 3D point */
+    if (! coord_parse_fast(&cur, &z))
+      return false;
+    hasz = true;
+  }
+  else if (hasz)
+    return false;
+  if (! p_cparen(&cur))
+    return false;
+  p_whitespace(&cur);
+  if (*cur != '@')
+    return false;
+
+  LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, x, y, z) :
+    lwpoint_make2d(srid, x, y);
+  *result = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
+  lwpoint_free(lwpoint);
+  /* Consume the @ sign as done by basetype_parse */
+  *str = cur + 1;
+  return true;
+}
+
 /**
  * Parse a temporal point value of instant duration from the buffer
  *
@@ -204,7 +297,9 @@ tpointinst_parse(char **str, Oid basetype, bool end, bool make, int *tpoint_srid
 {
   p_whitespace(str);
   /* The next instruction will throw an exception if it fails */
-  Datum geo = basetype_parse(str, basetype); 
+  Datum geo;
+  if (basetype != type_oid(T_GEOMETRY) || ! geompoint_parse_fast(str, &geo))
+    geo = basetype_parse(str, basetype);
   GSERIALIZED *gs = (GSERIALIZED *)PG_DETOAST_DATUM(geo);
   int geo_srid = gserialized_get_srid(gs);
   ensure_point_type(gs);
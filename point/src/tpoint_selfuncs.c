@@ -14,9 +14,13 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
+#include <utils/lsyscache.h>
 
 #include "period.h"
 #include "temporal_selfuncs.h"
+#include "time_selfuncs.h"
+#include "temporal_statscache.h"
 #include "stbox.h"
 #include "tpoint.h"
 #include "tpoint_analyze.h"
@@ -588,7 +592,6 @@ static float8
 calc_geo_selectivity(VariableStatData *vardata, const STBOX *box, CachedOp op)
 {
   ND_STATS *nd_stats;
-  AttStatsSlot sslot;  
   int d; /* counter */
   float8 selectivity;
   ND_BOX nd_box;
@@ -607,19 +610,11 @@ calc_geo_selectivity(VariableStatData *vardata, const STBOX *box, CachedOp op)
   bool bboxop = (op == OVERLAPS_OP || op == CONTAINS_OP ||
     op == CONTAINED_OP || op == SAME_OP);
 
-  /* Get statistics 
-   * Currently PostGIS does not set the associated staopN so we
-   * can pass InvalidOid */
-  if (!(HeapTupleIsValid(vardata->statsTuple) &&
-      get_attstatsslot(&sslot, vardata->statsTuple, STATISTIC_KIND_ND, 
-      InvalidOid, ATTSTATSSLOT_NUMBERS)))
+  /* Get statistics */
+  nd_stats = nd_stats_from_vardata(vardata, STATISTIC_KIND_ND);
+  if (nd_stats == NULL)
     return -1;
 
-  /* Clone the stats here so we can release the attstatsslot immediately */
-  nd_stats = palloc(sizeof(float4) * sslot.nnumbers);
-  memcpy(nd_stats, sslot.numbers, sizeof(float4) * sslot.nnumbers);
-
-  free_attstatsslot(&sslot);
   /* Calculate the number of common coordinate dimensions  on the histogram */
   ndims_max = (int) Max(nd_stats->ndims, MOBDB_FLAGS_GET_Z(box->flags) ? 3 : 2);
 
@@ -777,6 +772,272 @@ calc_geo_selectivity(VariableStatData *vardata, const STBOX *box, CachedOp op)
   return selectivity;
 }
 
+/**
+ * Returns a copy of the ND histogram of the given kind of the variable, or
+ * NULL if it is not available
+ *
+ * The histogram is read from the statistics cache, the copy allows the
+ * callers to modify it, e.g., for expanding its extent.
+ */
+ND_STATS *
+nd_stats_from_vardata(VariableStatData *vardata, int kind)
+{
+  ND_STATS *nd_stats;
+  CachedStatsSlot *sslot;
+
+  /* Currently PostGIS does not set the associated staopN */
+  sslot = statscache_slot(vardata, kind, ATTSTATSSLOT_NUMBERS);
+  if (sslot == NULL)
+    return NULL;
+
+  nd_stats = palloc(sizeof(float4) * sslot->nnumbers);
+  memcpy(nd_stats, sslot->numbers, sizeof(float4) * sslot->nnumbers);
+  return nd_stats;
+}
+
+/**
+ * Returns an estimate of the fraction of the features of an ND histogram
+ * whose boxes overlap the search box, whose dimensions are those of the
+ * histogram
+ *
+ * This function adapts PostGIS function estimate_selectivity in file
+ * gserialized_estimate.c
+ */
+float8
+nd_stats_selectivity(const ND_STATS *nd_stats, const ND_BOX *nd_box)
+{
+  int d, ndims = (int) nd_stats->ndims; /* counter */
+  float8 selectivity;
+  ND_IBOX nd_ibox;
+  int at[ND_DIMS];
+  double cell_size[ND_DIMS];
+  double min[ND_DIMS];
+  double total_count = 0.0;
+
+  /* Full histogram extent does not overlap the box? */
+  if (! nd_box_intersects(&(nd_stats->extent), nd_box, ndims))
+    return 0.0;
+
+  /* Full histogram extent is contained in the box? */
+  if (nd_box_contains(nd_box, &(nd_stats->extent), ndims))
+    return 1.0;
+
+  /* Calculate the overlap of the box on the histogram */
+  nd_box_overlap(nd_stats, nd_box, &nd_ibox);
+
+  /* Work out some measurements of the histogram and initialize the counter */
+  memset(at, 0, sizeof(int) * ND_DIMS);
+  for (d = 0; d < ndims; d++)
+  {
+    min[d] = nd_stats->extent.min[d];
+    cell_size[d] = (nd_stats->extent.max[d] - min[d]) / nd_stats->size[d];
+    at[d] = nd_ibox.min[d];
+  }
+
+  /* Move through all the overlap values and sum them */
+  do
+  {
+    float cell_count, ratio;
+    ND_BOX nd_cell;
+    memset(&nd_cell, 0, sizeof(ND_BOX));
+
+    /* We have to pro-rate partially overlapped cells. */
+    for (d = 0; d < ndims; d++)
+    {
+      nd_cell.min[d] = (float4) (min[d] + (at[d]+0) * cell_size[d]);
+      nd_cell.max[d] = (float4) (min[d] + (at[d]+1) * cell_size[d]);
+    }
+    ratio = (float4) (nd_box_ratio_overlaps(nd_box, &nd_cell, ndims));
+    cell_count = nd_stats->value[nd_stats_value_index(nd_stats, at)];
+
+    /* Add the pro-rated count for this cell to the overall total */
+    total_count += cell_count * ratio;
+  }
+  while (nd_increment(&nd_ibox, ndims, at));
+
+  /* Scale by the number of features in our histogram to get the proportion */
+  selectivity = total_count / nd_stats->histogram_features;
+
+  /* Prevent rounding overflows */
+  if (selectivity > 1.0) selectivity = 1.0;
+  else if (selectivity < 0.0) selectivity = 0.0;
+
+  return selectivity;
+}
+
+/**
+ * Returns an estimate of the selectivity of a spatiotemporal search box for
+ * the bounding box operators by looking at the joint spatiotemporal histogram
+ * in the ND_STATS structure, or -1 if the histogram is not available.
+ *
+ * Contrary to the product of the selectivities of the spatial and the time
+ * dimensions, the estimate takes into account the correlation between the
+ * two dimensions. The search box must have both dimensions.
+ */
+static float8
+calc_geo_time_selectivity(VariableStatData *vardata, const STBOX *box)
+{
+  ND_STATS *nd_stats;
+  int ndims;
+  float8 selectivity;
+  ND_BOX nd_box;
+
+  nd_stats = nd_stats_from_vardata(vardata, STATISTIC_KIND_NDT);
+  if (nd_stats == NULL)
+    return -1;
+  ndims = (int) nd_stats->ndims;
+
+  /* Initialize nd_box, the time dimension is the last one of the histogram */
+  nd_box_from_stbox_time(box, ndims - 1, &nd_box);
+  /* A search box without z dimension does not restrict the z dimension */
+  if (ndims == ND_DIMS && ! MOBDB_FLAGS_GET_Z(box->flags) &&
+    ! MOBDB_FLAGS_GET_GEODETIC(box->flags))
+  {
+    nd_box.min[Z_DIM] = nd_stats->extent.min[Z_DIM];
+    nd_box.max[Z_DIM] = nd_stats->extent.max[Z_DIM];
+  }
+
+  selectivity = nd_stats_selectivity(nd_stats, &nd_box);
+  pfree(nd_stats);
+  return selectivity;
+}
+
+/**
+ * Expand the extent of the spatial dimensions of an ND histogram with the
+ * distance. This approximates the histogram of the values of a column whose
+ * bounding boxes are expanded with the expandSpatial function.
+ */
+static void
+nd_stats_expand_space(ND_STATS *nd_stats, double dist, int nspacedims)
+{
+  for (int d = 0; d < nspacedims; d++)
+  {
+    nd_stats->extent.min[d] -= (float4) dist;
+    nd_stats->extent.max[d] += (float4) dist;
+  }
+}
+
+/**
+ * Returns an estimate of the join selectivity of the bounding box operators
+ * from the ND histograms of the two columns, which are either the joint
+ * spatiotemporal histograms or the spatial histograms.
+ *
+ * This function adapts PostGIS function estimate_join_selectivity in file
+ * gserialized_estimate.c
+ */
+static float8
+calc_geo_joinsel(const ND_STATS *s1, const ND_STATS *s2)
+{
+  int ndims;
+  double ntuples_max;
+  ND_IBOX ibox1, ibox2;
+  int at1[ND_DIMS];
+  int at2[ND_DIMS];
+  double min1[ND_DIMS];
+  double cellsize1[ND_DIMS];
+  double min2[ND_DIMS];
+  double cellsize2[ND_DIMS];
+  int d;
+  double val = 0;
+  float8 selectivity;
+
+  /* Both histograms must have the same dimensions */
+  if (s1->ndims != s2->ndims)
+    return FALLBACK_ND_JOINSEL;
+  ndims = (int) s1->ndims;
+
+  /* Drive the summation loop with the smaller histogram */
+  if (s1->histogram_cells > s2->histogram_cells)
+  {
+    const ND_STATS *stats_tmp = s1;
+    s1 = s2;
+    s2 = stats_tmp;
+  }
+
+  /* The largest possible join size is the product of the non-null rows */
+  ntuples_max = s1->table_features * (s1->not_null_features / s1->sample_features) *
+    s2->table_features * (s2->not_null_features / s2->sample_features);
+
+  /* If relation stats do not intersect, join is very very selective. */
+  if (! nd_box_intersects(&(s1->extent), &(s2->extent), ndims))
+    return 0.0;
+
+  /*
+   * First find the index range of the part of the smaller
+   * histogram that overlaps the larger one.
+   */
+  nd_box_overlap(s1, &(s2->extent), &ibox1);
+
+  /* Initialize counters / constants */
+  memset(at1, 0, sizeof(int) * ND_DIMS);
+  memset(at2, 0, sizeof(int) * ND_DIMS);
+  for (d = 0; d < ndims; d++)
+  {
+    at1[d] = ibox1.min[d];
+    min1[d] = s1->extent.min[d];
+    cellsize1[d] = (s1->extent.max[d] - min1[d]) / s1->size[d];
+    min2[d] = s2->extent.min[d];
+    cellsize2[d] = (s2->extent.max[d] - min2[d]) / s2->size[d];
+  }
+
+  /* For each affected cell of s1... */
+  do
+  {
+    double val1;
+    ND_BOX nd_cell1;
+    nd_box_init(&nd_cell1);
+    for (d = 0; d < ndims; d++)
+    {
+      nd_cell1.min[d] = (float4) (min1[d] + (at1[d]+0) * cellsize1[d]);
+      nd_cell1.max[d] = (float4) (min1[d] + (at1[d]+1) * cellsize1[d]);
+    }
+
+    /* Find the cells of s2 that cell1 overlaps.. */
+    nd_box_overlap(s2, &nd_cell1, &ibox2);
+    for (d = 0; d < ndims; d++)
+      at2[d] = ibox2.min[d];
+
+    /* Get the value at this cell */
+    val1 = s1->value[nd_stats_value_index(s1, at1)];
+
+    /* For each overlapped cell of s2... */
+    do
+    {
+      double ratio2, val2;
+      ND_BOX nd_cell2;
+      nd_box_init(&nd_cell2);
+      for (d = 0; d < ndims; d++)
+      {
+        nd_cell2.min[d] = (float4) (min2[d] + (at2[d]+0) * cellsize2[d]);
+        nd_cell2.max[d] = (float4) (min2[d] + (at2[d]+1) * cellsize2[d]);
+      }
+
+      /* Multiply the cell counts, scaled by overlap ratio */
+      ratio2 = nd_box_ratio_overlaps(&nd_cell1, &nd_cell2, ndims);
+      val2 = s2->value[nd_stats_value_index(s2, at2)];
+      val += val1 * (val2 * ratio2);
+    }
+    while (nd_increment(&ibox2, ndims, at2));
+  }
+  while (nd_increment(&ibox1, ndims, at1));
+
+  /*
+   * Scale the cell count up to reflect a full table estimate and divide it
+   * by the maximum possible number of rows
+   */
+  val *= (s1->table_features / s1->sample_features);
+  val *= (s2->table_features / s2->sample_features);
+  selectivity = val / ntuples_max;
+
+  /* Guard against over-estimates and crazy numbers :) */
+  if (isnan(selectivity) || ! isfinite(selectivity) || selectivity < 0.0)
+    selectivity = FALLBACK_ND_JOINSEL;
+  else if (selectivity > 1.0)
+    selectivity = 1.0;
+
+  return selectivity;
+}
+
 /*****************************************************************************/
 
 PG_FUNCTION_INFO_V1(tpoint_sel);
@@ -859,6 +1120,24 @@ tpoint_sel(PG_FUNCTION_ARGS)
     PG_RETURN_FLOAT8(default_tpoint_selectivity(cachedOp));
 
   assert(MOBDB_FLAGS_GET_X(constBox.flags) || MOBDB_FLAGS_GET_T(constBox.flags));
+
+  /*
+   * The spatial and time dimensions are not independent. Therefore, use the
+   * joint spatiotemporal histogram, if available, for the bounding box
+   * operators when the constant has both dimensions.
+   */
+  if (MOBDB_FLAGS_GET_X(constBox.flags) && MOBDB_FLAGS_GET_T(constBox.flags) &&
+    (cachedOp == OVERLAPS_OP || cachedOp == CONTAINS_OP ||
+     cachedOp == CONTAINED_OP || cachedOp == SAME_OP))
+  {
+    selec = calc_geo_time_selectivity(&vardata, &constBox);
+    if (selec >= 0.0)
+    {
+      ReleaseVariableStats(vardata);
+      CLAMP_PROBABILITY(selec);
+      PG_RETURN_FLOAT8(selec);
+    }
+  }
   
   /* Enable the multiplication of the selectivity of the spatial and time 
    * dimensions since either may be missing */
@@ -896,14 +1175,119 @@ tpoint_sel(PG_FUNCTION_ARGS)
   PG_RETURN_FLOAT8(selec);
 }
 
+/**
+ * Returns the argument of a join clause looking through a call to the
+ * expandSpatial function and through casts, so that the statistics of the
+ * underlying column can be used. The distance of the expansion, if any, is
+ * returned in the last argument.
+ */
+static Node *
+tpoint_joinsel_arg(Node *node, double *dist)
+{
+  *dist = 0.0;
+  if (IsA(node, FuncExpr))
+  {
+    FuncExpr *func = (FuncExpr *) node;
+    char *name = get_func_name(func->funcid);
+    if (name != NULL && strcmp(name, "expandspatial") == 0 &&
+      list_length(func->args) == 2 && IsA(lsecond(func->args), Const) &&
+      ! ((Const *) lsecond(func->args))->constisnull)
+    {
+      *dist = DatumGetFloat8(((Const *) lsecond(func->args))->constvalue);
+      node = (Node *) linitial(func->args);
+    }
+  }
+  /* Look through the cast of a temporal point into an stbox */
+  if (IsA(node, FuncExpr) && list_length(((FuncExpr *) node)->args) == 1 &&
+    (((FuncExpr *) node)->funcformat == COERCE_IMPLICIT_CAST ||
+     ((FuncExpr *) node)->funcformat == COERCE_EXPLICIT_CAST))
+    node = (Node *) linitial(((FuncExpr *) node)->args);
+  return node;
+}
+
 PG_FUNCTION_INFO_V1(tpoint_joinsel);
 /**
  * Estimate the join selectivity value of the operators for temporal points
+ *
+ * The bounding box operators of an inner join are estimated with the joint
+ * spatiotemporal histograms of the columns if both are available. Otherwise,
+ * the selectivities of the spatial and time dimensions computed with the
+ * spatial histograms and the period histograms are multiplied. As in PostGIS,
+ * the selectivity of the overlaps operator is used for all bounding box
+ * operators. The other cases give a default selectivity value.
  */
 PGDLLEXPORT Datum
 tpoint_joinsel(PG_FUNCTION_ARGS)
 {
-  PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+  PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+  Oid operator = PG_GETARG_OID(1);
+  List *args = (List *) PG_GETARG_POINTER(2);
+  JoinType jointype = (JoinType) PG_GETARG_INT16(3);
+  Node *arg1, *arg2;
+  double dist1, dist2;
+  VariableStatData vardata1, vardata2;
+  ND_STATS *stats1, *stats2;
+  CachedOp cachedOp;
+  float8 selec = -1.0;
+
+  if (!tpoint_cachedop(operator, &cachedOp) ||
+    (cachedOp != OVERLAPS_OP && cachedOp != CONTAINS_OP &&
+     cachedOp != CONTAINED_OP && cachedOp != SAME_OP))
+    PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+  /* Only respond to an inner join */
+  if (jointype != JOIN_INNER || list_length(args) != 2)
+    PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+  arg1 = tpoint_joinsel_arg((Node *) linitial(args), &dist1);
+  arg2 = tpoint_joinsel_arg((Node *) lsecond(args), &dist2);
+  examine_variable(root, arg1, 0, &vardata1);
+  examine_variable(root, arg2, 0, &vardata2);
+
+  /* Get the joint spatiotemporal histograms of both columns */
+  stats1 = nd_stats_from_vardata(&vardata1, STATISTIC_KIND_NDT);
+  stats2 = nd_stats_from_vardata(&vardata2, STATISTIC_KIND_NDT);
+  if (stats1 != NULL && stats2 != NULL)
+  {
+    /* The time dimension is the last one of the histograms */
+    nd_stats_expand_space(stats1, dist1, (int) stats1->ndims - 1);
+    nd_stats_expand_space(stats2, dist2, (int) stats2->ndims - 1);
+    selec = calc_geo_joinsel(stats1, stats2);
+  }
+  else
+  {
+    double time_selec;
+    if (stats1 != NULL)
+      pfree(stats1);
+    if (stats2 != NULL)
+      pfree(stats2);
+
+    /* Selectivity for the spatial dimension */
+    stats1 = nd_stats_from_vardata(&vardata1, STATISTIC_KIND_ND);
+    stats2 = nd_stats_from_vardata(&vardata2, STATISTIC_KIND_ND);
+    if (stats1 != NULL && stats2 != NULL)
+    {
+      nd_stats_expand_space(stats1, dist1, Min((int) stats1->ndims, 3));
+      nd_stats_expand_space(stats2, dist2, Min((int) stats2->ndims, 3));
+      selec = calc_geo_joinsel(stats1, stats2);
+    }
+    /* Selectivity for the time dimension */
+    time_selec = period_joinsel_overlaps(&vardata1, &vardata2);
+    if (time_selec >= 0.0)
+      selec = (selec >= 0.0) ? selec * time_selec : time_selec;
+  }
+
+  if (stats1 != NULL)
+    pfree(stats1);
+  if (stats2 != NULL)
+    pfree(stats2);
+  ReleaseVariableStats(vardata1);
+  ReleaseVariableStats(vardata2);
+
+  if (selec < 0.0)
+    selec = DEFAULT_TEMP_SELECTIVITY;
+  CLAMP_PROBABILITY(selec);
+  PG_RETURN_FLOAT8(selec);
 }
 
 /*****************************************************************************/
@@ -0,0 +1,316 @@
+/*****************************************************************************
+ *
+ * tpoint_similarity.c
+ *    Similarity distances between temporal points.
+ *
+ * The discrete Frechet, dynamic time warping, and Hausdorff distances
+ * compare the sequences of positions of two temporal geometric points
+ * regardless of the times at which they were reached. They are computed on
+ * the distinct instants of the temporal points in O(n*m) time and O(m)
+ * memory, where n and m are their number of instants.
+ *
+ * Since these computations are expensive, a similarity search should first
+ * discard the candidates whose lower bound given by similarity_lower_bound
+ * is greater than the distance of the current k-th result. The nearest
+ * approach distance between a temporal point and the trajectory of the
+ * query is another lower bound of the three distances that can be computed
+ * with an index using the operator |=|.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_similarity.h"
+
+#include <float.h>
+#include <math.h>
+
+#include "temporal_util.h"
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * Coordinates of the instants
+ *****************************************************************************/
+
+/**
+ * Structure to represent the coordinates of the distinct instants of a
+ * temporal point, which are stored in separate arrays so that the distances
+ * from a point to all of them are computed in a loop that can be vectorized
+ */
+typedef struct
+{
+  int count;   /**< number of points */
+  double *x;   /**< x coordinates */
+  double *y;   /**< y coordinates */
+  double *z;   /**< z coordinates, zero for 2D points */
+} PointArray;
+
+/**
+ * Set the coordinates of the n-th point of the array to the value of the
+ * temporal instant point
+ */
+static void
+pointarr_set(PointArray *arr, int n, const TInstant *inst)
+{
+  if (MOBDB_FLAGS_GET_Z(inst->flags))
+  {
+    const POINT3DZ *p = datum_get_point3dz_p(tinstant_value(inst));
+    arr->x[n] = p->x; arr->y[n] = p->y; arr->z[n] = p->z;
+  }
+  else
+  {
+    const POINT2D *p = datum_get_point2d_p(tinstant_value(inst));
+    arr->x[n] = p->x; arr->y[n] = p->y; arr->z[n] = 0.0;
+  }
+}
+
+/**
+ * Fill the coordinates of the distinct instants of the temporal point
+ */
+static void
+pointarr_init(PointArray *arr, const Temporal *temp)
+{
+  int count = temporal_num_instants_internal(temp);
+  arr->x = palloc(sizeof(double) * count * 3);
+  arr->y = arr->x + count;
+  arr->z = arr->y + count;
+  TInstantIterator iter;
+  const TInstant *inst;
+  int k = 0;
+  tinstant_iterator_init(&iter, temp);
+  while ((inst = tinstant_iterator_next(&iter)) != NULL)
+    pointarr_set(arr, k++, inst);
+  arr->count = k;
+}
+
+/**
+ * Compute in dist the distances between the i-th point of arr1 and all the
+ * points of arr2
+ */
+static void
+pointarr_distances(const PointArray *arr1, int i, const PointArray *arr2,
+  double *dist)
+{
+  const double x = arr1->x[i], y = arr1->y[i], z = arr1->z[i];
+  const double *x2 = arr2->x, *y2 = arr2->y, *z2 = arr2->z;
+  for (int j = 0; j < arr2->count; j++)
+  {
+    double dx = x - x2[j], dy = y - y2[j], dz = z - z2[j];
+    dist[j] = sqrt(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+/**
+ * Returns the distance between the values of the temporal instant points
+ */
+static double
+tpointinst_distance(const TInstant *inst1, const TInstant *inst2)
+{
+  PointArray arr1, arr2;
+  double x1, y1, z1, x2, y2, z2;
+  arr1.count = arr2.count = 1;
+  arr1.x = &x1; arr1.y = &y1; arr1.z = &z1;
+  arr2.x = &x2; arr2.y = &y2; arr2.z = &z2;
+  pointarr_set(&arr1, 0, inst1);
+  pointarr_set(&arr2, 0, inst2);
+  double result;
+  pointarr_distances(&arr1, 0, &arr2, &result);
+  return result;
+}
+
+/*****************************************************************************
+ * Distances
+ *****************************************************************************/
+
+/**
+ * Returns the discrete Frechet distance or the dynamic time warping
+ * distance between the temporal points, which only differ in the way the
+ * cost of a warping path is aggregated
+ */
+static double
+warping_distance(const Temporal *temp1, const Temporal *temp2, bool frechet)
+{
+  PointArray arr1, arr2;
+  pointarr_init(&arr1, temp1);
+  pointarr_init(&arr2, temp2);
+  int m = arr2.count;
+  double *dist = palloc(sizeof(double) * m);
+  double *prev = palloc(sizeof(double) * m);
+  double *curr = palloc(sizeof(double) * m);
+  for (int i = 0; i < arr1.count; i++)
+  {
+    pointarr_distances(&arr1, i, &arr2, dist);
+    for (int j = 0; j < m; j++)
+    {
+      double cost;
+      if (i == 0 && j == 0)
+        cost = 0.0;
+      else if (i == 0)
+        cost = curr[j - 1];
+      else if (j == 0)
+        cost = prev[j];
+      else
+        cost = Min(Min(prev[j], prev[j - 1]), curr[j - 1]);
+      curr[j] = frechet ? Max(cost, dist[j]) : cost + dist[j];
+    }
+    double *swap = prev; prev = curr; curr = swap;
+  }
+  double result = prev[m - 1];
+  pfree(arr1.x); pfree(arr2.x);
+  pfree(dist); pfree(prev); pfree(curr);
+  return result;
+}
+
+/**
+ * Returns the discrete Frechet distance between the temporal points
+ * (internal function)
+ */
+double
+frechet_distance_internal(const Temporal *temp1, const Temporal *temp2)
+{
+  return warping_distance(temp1, temp2, true);
+}
+
+/**
+ * Returns the dynamic time warping distance between the temporal points
+ * (internal function)
+ */
+double
+dyntimewarp_distance_internal(const Temporal *temp1, const Temporal *temp2)
+{
+  return warping_distance(temp1, temp2, false);
+}
+
+/**
+ * Returns the discrete Hausdorff distance between the temporal points
+ * (internal function)
+ */
+double
+hausdorff_distance_internal(const Temporal *temp1, const Temporal *temp2)
+{
+  PointArray arr1, arr2;
+  pointarr_init(&arr1, temp1);
+  pointarr_init(&arr2, temp2);
+  int m = arr2.count;
+  double *dist = palloc(sizeof(double) * m);
+  /* Distance from each point of temp2 to the closest point of temp1 */
+  double *mindist2 = palloc(sizeof(double) * m);
+  for (int j = 0; j < m; j++)
+    mindist2[j] = DBL_MAX;
+  double result = 0.0;
+  for (int i = 0; i < arr1.count; i++)
+  {
+    pointarr_distances(&arr1, i, &arr2, dist);
+    double mindist1 = DBL_MAX;
+    for (int j = 0; j < m; j++)
+    {
+      mindist1 = Min(mindist1, dist[j]);
+      mindist2[j] = Min(mindist2[j], dist[j]);
+    }
+    result = Max(result, mindist1);
+  }
+  for (int j = 0; j < m; j++)
+    result = Max(result, mindist2[j]);
+  pfree(arr1.x); pfree(arr2.x);
+  pfree(dist); pfree(mindist2);
+  return result;
+}
+
+/**
+ * Returns a lower bound of the discrete Frechet and dynamic time warping
+ * distances between the temporal points (internal function)
+ *
+ * Any warping path matches the first instants and the last instants of the
+ * temporal points, and the distance of any pair of instants is at least the
+ * distance between the spatial extents of the temporal points.
+ */
+double
+similarity_lower_bound_internal(const Temporal *temp1, const Temporal *temp2)
+{
+  STBOX box1, box2;
+  memset(&box1, 0, sizeof(STBOX));
+  memset(&box2, 0, sizeof(STBOX));
+  temporal_bbox(&box1, temp1);
+  temporal_bbox(&box2, temp2);
+  double dx = Max(Max(box1.xmin - box2.xmax, box2.xmin - box1.xmax), 0.0);
+  double dy = Max(Max(box1.ymin - box2.ymax, box2.ymin - box1.ymax), 0.0);
+  double dz = MOBDB_FLAGS_GET_Z(temp1->flags) ?
+    Max(Max(box1.zmin - box2.zmax, box2.zmin - box1.zmax), 0.0) : 0.0;
+  double result = sqrt(dx * dx + dy * dy + dz * dz);
+
+  TInstantIterator iter1, iter2;
+  tinstant_iterator_init(&iter1, temp1);
+  tinstant_iterator_init(&iter2, temp2);
+  result = Max(result, tpointinst_distance(tinstant_iterator_next(&iter1),
+    tinstant_iterator_next(&iter2)));
+  result = Max(result, tpointinst_distance(
+    temporal_end_instant_internal(temp1),
+    temporal_end_instant_internal(temp2)));
+  return result;
+}
+
+/*****************************************************************************/
+
+/**
+ * Generic similarity distance between the temporal points
+ */
+static Datum
+similarity_distance(FunctionCallInfo fcinfo,
+  double (*func)(const Temporal *, const Temporal *))
+{
+  Temporal *temp1 = PG_GETARG_TEMPORAL(0);
+  Temporal *temp2 = PG_GETARG_TEMPORAL(1);
+  ensure_same_srid_tpoint(temp1, temp2);
+  ensure_same_dimensionality_tpoint(temp1, temp2);
+  double result = func(temp1, temp2);
+  PG_FREE_IF_COPY(temp1, 0);
+  PG_FREE_IF_COPY(temp2, 1);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(frechet_distance);
+/**
+ * Returns the discrete Frechet distance between the temporal points
+ */
+PGDLLEXPORT Datum
+frechet_distance(PG_FUNCTION_ARGS)
+{
+  return similarity_distance(fcinfo, &frechet_distance_internal);
+}
+
+PG_FUNCTION_INFO_V1(dyntimewarp_distance);
+/**
+ * Returns the dynamic time warping distance between the temporal points
+ */
+PGDLLEXPORT Datum
+dyntimewarp_distance(PG_FUNCTION_ARGS)
+{
+  return similarity_distance(fcinfo, &dyntimewarp_distance_internal);
+}
+
+PG_FUNCTION_INFO_V1(hausdorff_distance);
+/**
+ * Returns the discrete Hausdorff distance between the temporal points
+ */
+PGDLLEXPORT Datum
+hausdorff_distance(PG_FUNCTION_ARGS)
+{
+  return similarity_distance(fcinfo, &hausdorff_distance_internal);
+}
+
+PG_FUNCTION_INFO_V1(similarity_lower_bound);
+/**
+ * Returns a lower bound of the discrete Frechet and dynamic time warping
+ * distances between the temporal points
+ */
+PGDLLEXPORT Datum
+similarity_lower_bound(PG_FUNCTION_ARGS)
+{
+  return similarity_distance(fcinfo, &similarity_lower_bound_internal);
+}
+
+/*****************************************************************************/
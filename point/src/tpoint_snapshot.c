@@ -0,0 +1,226 @@
+/*****************************************************************************
+ *
+ * tpoint_snapshot.c
+ *    Positions of an array of temporal points at one or more timestamps
+ *
+ * The positions of a fleet of temporal points at a timestamp are computed
+ * in a single call instead of calling valueAtTimestamp once per row, so that
+ * the array is detoasted, its elements are checked, and the resulting
+ * multipoint is serialized only once. When several timestamps are given,
+ * each temporal point keeps a cursor with the position of the previous
+ * search, so that the search of a later timestamp starts from it as for
+ * the probes of a nested loop join in valueAtTimestamp.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_snapshot.h"
+
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/array.h>
+#include <utils/timestamp.h>
+
+#include "temporaltypes.h"
+#include "temporal_util.h"
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************/
+
+/**
+ * Returns the multipoint composed of the positions of the temporal points
+ * at the timestamp, which keep the order of the array
+ *
+ * @param[in] temparr Array of temporal points
+ * @param[in,out] cursors Positions of the previous search of each
+ * temporal point
+ * @param[in] count Number of temporal points
+ * @param[in] t Timestamp
+ * @param[out] ids Positions in the array of the points defined at the
+ * timestamp, starting at 1, NULL if they are not needed
+ * @param[out] found Number of points defined at the timestamp
+ * @result Multipoint, or 0 if no temporal point is defined at the timestamp
+ */
+Datum
+tpointarr_snapshot_internal(Temporal **temparr, TimestampCursor *cursors,
+  int count, TimestampTz t, int *ids, int *found)
+{
+  int srid = tpoint_srid_internal(temparr[0]);
+  bool hasz = MOBDB_FLAGS_GET_Z(temparr[0]->flags);
+  LWGEOM **points = palloc(sizeof(LWGEOM *) * count);
+  int k = 0;
+  for (int i = 0; i < count; i++)
+  {
+    Datum value;
+    if (! temporal_value_at_timestamp_cursor(temparr[i], t, &cursors[i],
+        &value))
+      continue;
+    POINT4D p = datum_get_point4d(value);
+    points[k] = (LWGEOM *) lwpoint_make(srid, hasz, false, &p);
+    pfree(DatumGetPointer(value));
+    if (ids != NULL)
+      ids[k] = i + 1;
+    k++;
+  }
+  *found = k;
+  if (k == 0)
+  {
+    pfree(points);
+    return (Datum) 0;
+  }
+  LWGEOM *mpoint = (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE, srid,
+    NULL, (uint32_t) k, points);
+  FLAGS_SET_Z(mpoint->flags, hasz);
+  FLAGS_SET_GEODETIC(mpoint->flags,
+    MOBDB_FLAGS_GET_GEODETIC(temparr[0]->flags));
+  Datum result = PointerGetDatum(geo_serialize(mpoint));
+  lwgeom_free(mpoint);
+  return result;
+}
+
+/**
+ * Extracts the temporal points of the array and ensures that they have
+ * the same SRID and dimensionality
+ */
+static Temporal **
+tpointarr_extract(ArrayType *array, int *count)
+{
+  Temporal **result = temporalarr_extract(array, count);
+  for (int i = 1; i < *count; i++)
+  {
+    ensure_same_srid_tpoint(result[0], result[i]);
+    ensure_same_dimensionality_tpoint(result[0], result[i]);
+  }
+  return result;
+}
+
+/**
+ * Returns the cursors of the temporal points before the first search
+ */
+static TimestampCursor *
+tpointarr_cursors(int count)
+{
+  TimestampCursor *result = palloc(sizeof(TimestampCursor) * count);
+  for (int i = 0; i < count; i++)
+  {
+    result[i].seqno = -1;
+    result[i].segno = -1;
+  }
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(tpointarr_snapshot);
+/**
+ * Returns the multipoint composed of the positions of the temporal points
+ * of the array at the timestamp
+ */
+PGDLLEXPORT Datum
+tpointarr_snapshot(PG_FUNCTION_ARGS)
+{
+  ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+  int count;
+  Temporal **temparr = tpointarr_extract(array, &count);
+  if (count == 0)
+  {
+    pfree(temparr);
+    PG_FREE_IF_COPY(array, 0);
+    PG_RETURN_NULL();
+  }
+  TimestampCursor *cursors = tpointarr_cursors(count);
+  int found;
+  Datum result = tpointarr_snapshot_internal(temparr, cursors, count, t,
+    NULL, &found);
+  pfree(temparr); pfree(cursors);
+  PG_FREE_IF_COPY(array, 0);
+  if (found == 0)
+    PG_RETURN_NULL();
+  PG_RETURN_DATUM(result);
+}
+
+PG_FUNCTION_INFO_V1(tpointarr_snapshots);
+/**
+ * Returns for each timestamp of the array the positions in the array of
+ * the temporal points defined at the timestamp and the multipoint
+ * composed of their positions
+ *
+ * @note The timestamps are returned in the order of the array, the
+ * searches are faster when the timestamps are increasing
+ */
+PGDLLEXPORT Datum
+tpointarr_snapshots(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  SnapshotState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+    ArrayType *timesarr = PG_GETARG_ARRAYTYPE_P(1);
+    int count, ntimes;
+    Temporal **temparr = tpointarr_extract(array, &count);
+    TimestampTz *times = timestamparr_extract(timesarr, &ntimes);
+    state = palloc0(sizeof(SnapshotState));
+    state->count = ntimes;
+    state->times = times;
+    state->ids = palloc0(sizeof(Datum) * Max(ntimes, 1));
+    state->points = palloc0(sizeof(Datum) * Max(ntimes, 1));
+    if (count > 0)
+    {
+      TimestampCursor *cursors = tpointarr_cursors(count);
+      int *ids = palloc(sizeof(int) * count);
+      Datum *values = palloc(sizeof(Datum) * count);
+      for (int i = 0; i < ntimes; i++)
+      {
+        int found;
+        state->points[i] = tpointarr_snapshot_internal(temparr, cursors,
+          count, times[i], ids, &found);
+        if (found == 0)
+          continue;
+        for (int j = 0; j < found; j++)
+          values[j] = Int32GetDatum(ids[j]);
+        state->ids[i] = PointerGetDatum(datumarr_to_array(values, found,
+          INT4OID));
+      }
+      pfree(cursors); pfree(ids); pfree(values);
+    }
+    pfree(temparr);
+    funcctx->user_fctx = state;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (SnapshotState *) funcctx->user_fctx;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The timestamps at which no temporal point is defined have no points */
+  Datum values[3];
+  bool isnull[3] = {false, false, false};
+  values[0] = TimestampTzGetDatum(state->times[state->i]);
+  values[1] = state->ids[state->i];
+  values[2] = state->points[state->i];
+  isnull[1] = isnull[2] = (state->points[state->i] == (Datum) 0);
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
@@ -15,7 +15,10 @@
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
 #include <utils/builtins.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
@@ -24,41 +27,65 @@
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_packed.h"
 #include "lifting.h"
 #include "tnumber_mathfuncs.h"
 #include "postgis.h"
 #include "geography_funcs.h"
 #include "tpoint.h"
 #include "tpoint_boxops.h"
+#include "tpoint_edgeindex.h"
+#include "tpoint_parallel.h"
 #include "tpoint_spatialrels.h"
 
 /*****************************************************************************/
 
 /**
- * Global variable to save the fcinfo when PostGIS functions need to access
- * the cache such as transform, geography_distance, or geography_azimuth
+ * Global variable that states whether the geodetic computations use the
+ * WGS84 spheroid or a sphere of the mean radius of the spheroid. It is set
+ * by the configuration parameter mobilitydb.use_spheroid. The computations
+ * on the sphere are several times faster and their relative error for
+ * distances and lengths is below 0.5%, typically around 0.3%.
  */
-FunctionCallInfo _FCINFO;
+bool geodetic_use_spheroid = true;
 
 /**
- * Fetch from the cache the fcinfo of the external function
+ * Memory context of the function call information used for calling the
+ * PostGIS functions that keep a cache in fn_extra
  */
-FunctionCallInfo
-fetch_fcinfo()
-{
-  assert(_FCINFO);
-  return _FCINFO;
-}
-
+static MemoryContext _postgis_call_context = NULL;
 
 /**
- * Store in the cache the fcinfo of the external function
+ * Returns the function call information used for calling a PostGIS function
+ * that keeps a cache, such as transform, geography_distance, or
+ * geography_azimuth
+ *
+ * The information is private to the caller of the PostGIS function and lives
+ * in a memory context of the backend. Therefore, the caches of PostGIS are
+ * kept across calls without depending on the external function currently
+ * executed, and the helpers can be called from any context, e.g., from
+ * nested calls or from background workers.
+ *
+ * @param[in,out] flinfo Function call information, allocated on first use
+ * @param[in] func PostGIS function
+ * @param[in] nargs Number of arguments of the function
  */
-void
-store_fcinfo(FunctionCallInfo fcinfo)
+FmgrInfo *
+postgis_flinfo(FmgrInfo **flinfo, PGFunction func, short nargs)
 {
-  _FCINFO = fcinfo;
-  return;
+  if (*flinfo == NULL)
+  {
+    if (_postgis_call_context == NULL)
+      _postgis_call_context = AllocSetContextCreate(TopMemoryContext,
+        "MobilityDB PostGIS calls", ALLOCSET_SMALL_SIZES);
+    *flinfo = MemoryContextAllocZero(_postgis_call_context, sizeof(FmgrInfo));
+    (*flinfo)->fn_addr = func;
+    (*flinfo)->fn_oid = InvalidOid;
+    (*flinfo)->fn_nargs = nargs;
+    (*flinfo)->fn_strict = true;
+    (*flinfo)->fn_mcxt = _postgis_call_context;
+  }
+  return *flinfo;
 }
 
 /*****************************************************************************
@@ -232,13 +259,12 @@ Datum
 geoseg_interpolate_point(Datum start, Datum end, double ratio)
 {
   GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(start);
-  int srid = gserialized_get_srid(gs);
-  POINT4D p1 = datum_get_point4d(start);
-  POINT4D p2 = datum_get_point4d(end);
-  POINT4D p;
-  bool geodetic = FLAGS_GET_GEODETIC(gs->flags);
-  if (geodetic)
+  bool hasz = FLAGS_GET_Z(gs->flags);
+  if (FLAGS_GET_GEODETIC(gs->flags))
   {
+    POINT4D p1 = datum_get_point4d(start);
+    POINT4D p2 = datum_get_point4d(end);
+    POINT4D p;
     POINT3D q1, q2;
     GEOGRAPHIC_POINT g1, g2;
     geographic_point_init(p1.x, p1.y, &g1);
@@ -246,18 +272,19 @@ geoseg_interpolate_point(Datum start, Datum end, double ratio)
     geog2cart(&g1, &q1);
     geog2cart(&g2, &q2);
     interpolate_point4d_sphere(&q1, &q2, &p1, &p2, ratio, &p);
+    return geopoint_with_coords(start, p.x, p.y, p.z);
   }
-  else
-    interpolate_point4d(&p1, &p2, &p, ratio);
-
-  LWPOINT *lwpoint = FLAGS_GET_Z(gs->flags) ?
-    lwpoint_make3dz(srid, p.x, p.y, p.z) :
-    lwpoint_make2d(srid, p.x, p.y);
-  FLAGS_SET_GEODETIC(lwpoint->flags, geodetic);
-  Datum result = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
-  lwpoint_free(lwpoint);
-  POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(start));
-  return result;
+  if (hasz)
+  {
+    const POINT3DZ *p1 = datum_get_point3dz_p(start);
+    const POINT3DZ *p2 = datum_get_point3dz_p(end);
+    return geopoint_with_coords(start, p1->x + (p2->x - p1->x) * ratio,
+      p1->y + (p2->y - p1->y) * ratio, p1->z + (p2->z - p1->z) * ratio);
+  }
+  const POINT2D *p1 = datum_get_point2d_p(start);
+  const POINT2D *p2 = datum_get_point2d_p(end);
+  return geopoint_with_coords(start, p1->x + (p2->x - p1->x) * ratio,
+    p1->y + (p2->y - p1->y) * ratio, 0.0);
 }
 
 /**
@@ -738,8 +765,41 @@ POINT4D
 datum_get_point4d(Datum geom)
 {
   GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(geom);
-  POINT4D *point = (POINT4D *)((uint8_t*)gs->data + 8);
-  return *point;
+  const double *coords = (const double *)((uint8_t*)gs->data + 8);
+  POINT4D result;
+  result.x = coords[0];
+  result.y = coords[1];
+  /* Only read the coordinates that are present in the serialized point */
+  result.z = FLAGS_GET_Z(gs->flags) ? coords[2] : 0.0;
+  result.m = 0.0;
+  return result;
+}
+
+/**
+ * Returns a new point with the SRID and the flags of the point and the
+ * given coordinates
+ *
+ * The serialized representation of the point is copied and its coordinates
+ * are overwritten, avoiding the construction and serialization of an
+ * LWPOINT for each point computed from the instants of a temporal point.
+ *
+ * @param[in] point Reference point
+ * @param[in] x,y,z Coordinates, z is ignored for 2D points
+ * @pre The temporal points have no M coordinate and their serialized
+ * points have no bounding box
+ */
+Datum
+geopoint_with_coords(Datum point, double x, double y, double z)
+{
+  GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(point);
+  GSERIALIZED *result = palloc(VARSIZE(gs));
+  memcpy(result, gs, VARSIZE(gs));
+  double *coords = (double *)((uint8_t*)result->data + 8);
+  coords[0] = x;
+  coords[1] = y;
+  if (FLAGS_GET_Z(gs->flags))
+    coords[2] = z;
+  return PointerGetDatum(result);
 }
 
 /**
@@ -750,23 +810,60 @@ datum_point_eq(Datum geopoint1, Datum geopoint2)
 {
   GSERIALIZED *gs1 = (GSERIALIZED *) DatumGetPointer(geopoint1);
   GSERIALIZED *gs2 = (GSERIALIZED *) DatumGetPointer(geopoint2);
-  if (gserialized_get_srid(gs1) != gserialized_get_srid(gs2) ||
-    FLAGS_GET_Z(gs1->flags) != FLAGS_GET_Z(gs2->flags) ||
+  if (FLAGS_GET_Z(gs1->flags) != FLAGS_GET_Z(gs2->flags) ||
     FLAGS_GET_GEODETIC(gs1->flags) != FLAGS_GET_GEODETIC(gs2->flags))
     return false;
+  /* The coordinates are compared before the SRID, which is stored in
+   * three bytes of the header that are compared without decoding it */
   if (FLAGS_GET_Z(gs1->flags))
   {
     const POINT3DZ *point1 = gs_get_point3dz_p(gs1);
     const POINT3DZ *point2 = gs_get_point3dz_p(gs2);
-    return point1->x == point2->x && point1->y == point2->y &&
-      point1->z == point2->z;
+    if (point1->x != point2->x || point1->y != point2->y ||
+      point1->z != point2->z)
+      return false;
   }
   else
   {
     const POINT2D *point1 = gs_get_point2d_p(gs1);
     const POINT2D *point2 = gs_get_point2d_p(gs2);
-    return point1->x == point2->x && point1->y == point2->y;
+    if (point1->x != point2->x || point1->y != point2->y)
+      return false;
   }
+  return memcmp(gs1->srid, gs2->srid, sizeof(gs1->srid)) == 0;
+}
+
+/**
+ * Returns true if the serialized geometry is a non-empty point without
+ * bounding box, whose coordinates can be read directly
+ */
+static bool
+gserialized_is_point(const GSERIALIZED *gs)
+{
+  if (VARATT_IS_EXTENDED(gs) || FLAGS_GET_BBOX(gs->flags))
+    return false;
+  const uint32_t *data = (const uint32_t *) gs->data;
+  return data[0] == POINTTYPE && data[1] == 1;
+}
+
+/**
+ * Returns true if the two geometries are non-empty points of the same SRID
+ * and dimensionality
+ *
+ * The functions computing a relationship or a distance between two
+ * geometries use this test to compute the result directly on the
+ * coordinates of the points instead of calling PostGIS. Other geometries,
+ * as well as points of different SRID for which PostGIS raises an error,
+ * are passed to PostGIS.
+ */
+bool
+datum_point_pair(Datum geom1, Datum geom2)
+{
+  const GSERIALIZED *gs1 = (const GSERIALIZED *) DatumGetPointer(geom1);
+  const GSERIALIZED *gs2 = (const GSERIALIZED *) DatumGetPointer(geom2);
+  return gserialized_is_point(gs1) && gserialized_is_point(gs2) &&
+    FLAGS_GET_Z(gs1->flags) == FLAGS_GET_Z(gs2->flags) &&
+    memcmp(gs1->srid, gs2->srid, sizeof(gs1->srid)) == 0;
 }
 
 /**
@@ -803,14 +900,15 @@ geo_serialize(LWGEOM *geom)
 }
 
 /**
- * Call the PostGIS transform function. We need to use the fcinfo cached
- * in the external functions stbox_transform and tpoint_transform
+ * Call the PostGIS transform function, which keeps the projections in
+ * its cache
  */
 Datum
 datum_transform(Datum value, Datum srid)
 {
-  return CallerFInfoFunctionCall2(transform, (fetch_fcinfo())->flinfo,
-    InvalidOid, value, srid);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(transform,
+    postgis_flinfo(&flinfo, transform, 2), InvalidOid, value, srid);
 }
 
 /**
@@ -841,6 +939,8 @@ geom_to_geog(Datum value)
 Datum
 geom_distance2d(Datum geom1, Datum geom2)
 {
+  if (datum_point_pair(geom1, geom2))
+    return pt_distance2d(geom1, geom2);
   return call_function2(distance, geom1, geom2);
 }
 
@@ -850,6 +950,12 @@ geom_distance2d(Datum geom1, Datum geom2)
 Datum
 geom_distance3d(Datum geom1, Datum geom2)
 {
+  if (datum_point_pair(geom1, geom2))
+  {
+    const GSERIALIZED *gs = (const GSERIALIZED *) DatumGetPointer(geom1);
+    return FLAGS_GET_Z(gs->flags) ? pt_distance3d(geom1, geom2) :
+      pt_distance2d(geom1, geom2);
+  }
   return call_function2(distance3d, geom1, geom2);
 }
 
@@ -859,8 +965,10 @@ geom_distance3d(Datum geom1, Datum geom2)
 Datum
 geog_distance(Datum geog1, Datum geog2)
 {
-  return CallerFInfoFunctionCall2(geography_distance, (fetch_fcinfo())->flinfo,
-    InvalidOid, geog1, geog2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall3(geography_distance,
+    postgis_flinfo(&flinfo, geography_distance, 3), InvalidOid, geog1, geog2,
+    BoolGetDatum(geodetic_use_spheroid));
 }
 
 /**
@@ -1098,23 +1206,77 @@ tpointseq_make_trajectory(TInstant **instants, int count, bool linear)
   return result;
 }
 
+/**
+ * Build the trajectory of a temporal sequence point that does not have
+ * its trajectory precomputed
+ */
+static Datum
+tpointseq_build_trajectory(const TSequence *seq)
+{
+  TInstant **instants = tsequence_instants(seq);
+  Datum result = tpointseq_make_trajectory(instants, seq->count,
+    MOBDB_FLAGS_GET_LINEAR(seq->flags));
+  pfree(instants);
+  return result;
+}
+
 /**
  * Returns the precomputed trajectory of a temporal sequence point
+ *
+ * @note If the trajectory is not precomputed, it is built in the current
+ * memory context, which is reset by the executor after each tuple
  */
 Datum
 tpointseq_trajectory(const TSequence *seq)
 {
+  if (! MOBDB_FLAGS_GET_TRAJ(seq->flags))
+    return tpointseq_build_trajectory(seq);
   void *traj = (char *)(&seq->offsets[seq->count + 2]) +   /* start of data */
     seq->offsets[seq->count + 1];            /* offset */
   return PointerGetDatum(traj);
 }
 
+/**
+ * Returns the precomputed trajectory of a temporal sequence point extended
+ * with the point of an instant appended to the sequence, or 0 if the
+ * trajectory cannot be extended and must be built from scratch
+ *
+ * @note Only linear sequences whose trajectory is a linestring are
+ * extended since the trajectory of step sequences removes all duplicate
+ * points
+ */
+Datum
+tpointseq_trajectory_append(const TSequence *seq, const TInstant *inst)
+{
+  if (! MOBDB_FLAGS_GET_LINEAR(seq->flags) ||
+    ! MOBDB_FLAGS_GET_TRAJ(seq->flags))
+    return (Datum) 0;
+  GSERIALIZED *traj = (GSERIALIZED *) DatumGetPointer(tpointseq_trajectory(seq));
+  if (gserialized_get_type(traj) != LINETYPE)
+    return (Datum) 0;
+  /* Two consecutive equal points are not repeated in the trajectory */
+  Datum value = tinstant_value(inst);
+  if (datum_point_eq(tinstant_value(tsequence_inst_n(seq, seq->count - 1)),
+      value))
+    return PointerGetDatum(gserialized_copy(traj));
+  LWGEOM *lwtraj = lwgeom_from_gserialized(traj);
+  LWLINE *line = lwgeom_as_lwline(lwgeom_clone_deep(lwtraj));
+  LWPOINT *point = lwgeom_as_lwpoint(lwgeom_from_gserialized(
+    (GSERIALIZED *) DatumGetPointer(value)));
+  lwline_add_lwpoint(line, point, line->points->npoints);
+  Datum result = PointerGetDatum(geo_serialize((LWGEOM *) line));
+  lwgeom_free(lwtraj); lwline_free(line); lwpoint_free(point);
+  return result;
+}
+
 /**
  * Copy the precomputed trajectory of a temporal sequence point
  */
 Datum
 tpointseq_trajectory_copy(const TSequence *seq)
 {
+  if (! MOBDB_FLAGS_GET_TRAJ(seq->flags))
+    return tpointseq_build_trajectory(seq);
   void *traj = (char *)(&seq->offsets[seq->count + 2]) +   /* start of data */
       seq->offsets[seq->count + 1];          /* offset */
   return PointerGetDatum(gserialized_copy(traj));
@@ -1278,15 +1440,99 @@ tpoint_trajectory_internal(const Temporal *temp)
   return result;
 }
 
+/**
+ * Structure to cache the last trajectory built on demand by a function
+ * during a query
+ */
+typedef struct
+{
+  Temporal *temp;     /**< Temporal point value */
+  Datum traj;         /**< Trajectory of the value */
+} TrajectoryCache;
+
+/**
+ * Returns true if the trajectory of a temporal point is built on demand,
+ * that is, for instant sets, for sequences without precomputed trajectory,
+ * and for sequence sets, whose trajectory is the union of the trajectories
+ * of their composing sequences
+ */
+static bool
+tpoint_trajectory_on_demand(const Temporal *temp)
+{
+  if (temp->duration == INSTANT)
+    return false;
+  if (temp->duration == SEQUENCE)
+    return ! MOBDB_FLAGS_GET_TRAJ(temp->flags);
+  return true;
+}
+
+/**
+ * Returns the trajectory of a temporal point, where the last value and its
+ * trajectory when it is built on demand are cached for the duration of the
+ * query in the function call information. Therefore, repeated calls with
+ * the same value, as in joins or when several predicates are evaluated on
+ * a sequence set with many gaps, do not build it again.
+ *
+ * @param[in] flinfo Function call information whose fn_extra is not used
+ * otherwise, NULL if the trajectory is not cached
+ * @param[in] temp Temporal point
+ * @param[out] tofree True if the result must be freed by the calling
+ * function, false if it belongs to the cache or to the temporal point
+ */
+Datum
+tpoint_trajectory_cached(FmgrInfo *flinfo, const Temporal *temp, bool *tofree)
+{
+  *tofree = false;
+  if (temp->duration == INSTANT)
+    return tinstant_value((TInstant *) temp);
+  if (! tpoint_trajectory_on_demand(temp))
+    return tpointseq_trajectory((TSequence *) temp);
+  if (flinfo == NULL)
+  {
+    *tofree = true;
+    return tpoint_trajectory_internal(temp);
+  }
+
+  TrajectoryCache *cache = (TrajectoryCache *) flinfo->fn_extra;
+  if (cache == NULL)
+  {
+    cache = MemoryContextAllocZero(flinfo->fn_mcxt, sizeof(TrajectoryCache));
+    flinfo->fn_extra = cache;
+  }
+  if (cache->temp == NULL || VARSIZE(cache->temp) != VARSIZE(temp) ||
+    memcmp(cache->temp, temp, VARSIZE(temp)) != 0)
+  {
+    Datum traj = tpoint_trajectory_internal(temp);
+    MemoryContext oldcontext = MemoryContextSwitchTo(flinfo->fn_mcxt);
+    if (cache->temp != NULL)
+    {
+      pfree(cache->temp);
+      pfree(DatumGetPointer(cache->traj));
+    }
+    cache->temp = temporal_copy(temp);
+    cache->traj = PointerGetDatum(gserialized_copy(
+      (GSERIALIZED *) DatumGetPointer(traj)));
+    MemoryContextSwitchTo(oldcontext);
+    pfree(DatumGetPointer(traj));
+  }
+  return cache->traj;
+}
+
 PG_FUNCTION_INFO_V1(tpoint_trajectory);
 /**
  * Returns the trajectory of a temporal point
+ *
+ * @note When the trajectory is built on demand, it is cached in the function
+ * call information, see tpoint_trajectory_cached
  */
 PGDLLEXPORT Datum
 tpoint_trajectory(PG_FUNCTION_ARGS)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
-  Datum result = tpoint_trajectory_internal(temp);
+  bool tofree;
+  Datum traj = tpoint_trajectory_cached(fcinfo->flinfo, temp, &tofree);
+  Datum result = tofree ? traj : PointerGetDatum(gserialized_copy(
+    (GSERIALIZED *) DatumGetPointer(traj)));
   PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_DATUM(result);
 }
@@ -1369,6 +1615,9 @@ int
 tpoint_srid_internal(const Temporal *temp)
 {
   int result;
+  /* The SRID of packed values is kept in their bounding box */
+  if (MOBDB_FLAGS_GET_PACKED(temp->flags))
+    return ((STBOX *) temporalpacked_bbox_ptr((TemporalPacked *) temp))->srid;
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT)
     result = tpointinst_srid((TInstant *)temp);
@@ -1441,6 +1690,7 @@ tpointseq_set_srid(TSequence *seq, int32 srid)
   }
   STBOX *box = tsequence_bbox_ptr(result);
   box->srid = srid;
+  tpointseq_blocks_set_srid(result, srid);
   return result;
 }
 
@@ -1460,6 +1710,7 @@ tpointseqset_set_srid(TSequenceSet *ts, int32 srid)
       GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(tinstant_value_ptr(inst));
       gserialized_set_srid(gs, srid);
     }
+    tpointseq_blocks_set_srid(seq, srid);
   }
   STBOX *box = tsequenceset_bbox_ptr(result);
   box->srid = srid;
@@ -1531,8 +1782,6 @@ stbox_transform(PG_FUNCTION_ARGS)
   lwgeom_set_geodetic((LWGEOM *)ptmax, geodetic);
   Datum min = PointerGetDatum(geo_serialize((LWGEOM *)ptmin));
   Datum max = PointerGetDatum(geo_serialize((LWGEOM *)ptmax));
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Datum min1 = datum_transform(min, srid);
   Datum max1 = datum_transform(max, srid);
   if (hasz)
@@ -1575,6 +1824,80 @@ tpointinst_transform(const TInstant *inst, Datum srid)
   return result;
 }
 
+/**
+ * Transform the points of an array of instants into another spatial
+ * reference system with a single call of the PostGIS transform function
+ *
+ * The coordinates of the points are packed into the point array of a line
+ * that is transformed at once. The transformed coordinates are then written
+ * into a copy of the serialized point of each instant, which avoids
+ * deserializing and serializing every point.
+ *
+ * @param[out] result Array of transformed instants
+ * @param[in] instants Array of instants
+ * @param[in] count Number of instants, at least 2
+ * @param[in] srid SRID of the result
+ */
+static void
+tpointinstarr_transform(TInstant **result, TInstant **instants, int count,
+  Datum srid)
+{
+  GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(tinstant_value(instants[0]));
+  bool hasz = MOBDB_FLAGS_GET_Z(instants[0]->flags);
+  POINTARRAY *pa = ptarray_construct(hasz, false, (uint32_t) count);
+  POINT4D p;
+  p.m = 0;
+  for (int i = 0; i < count; i++)
+  {
+    GSERIALIZED *gsvalue = (GSERIALIZED *) DatumGetPointer(
+      tinstant_value(instants[i]));
+    if (hasz)
+    {
+      const POINT3DZ *point = gs_get_point3dz_p(gsvalue);
+      p.x = point->x; p.y = point->y; p.z = point->z;
+    }
+    else
+    {
+      const POINT2D *point = gs_get_point2d_p(gsvalue);
+      p.x = point->x; p.y = point->y; p.z = 0;
+    }
+    ptarray_set_point4d(pa, (uint32_t) i, &p);
+  }
+  LWLINE *line = lwline_construct(gserialized_get_srid(gs), NULL, pa);
+  Datum geom = PointerGetDatum(geo_serialize((LWGEOM *) line));
+  lwline_free(line);
+  Datum transf = datum_transform(geom, srid);
+  GSERIALIZED *gstransf = (GSERIALIZED *) PG_DETOAST_DATUM(transf);
+  LWLINE *linetransf = lwgeom_as_lwline(lwgeom_from_gserialized(gstransf));
+
+  /* Points have no bounding box and thus all of them have the same size */
+  size_t size = VARSIZE(gs);
+  GSERIALIZED *point = palloc(size);
+  memcpy(point, gs, size);
+  gserialized_set_srid(point, DatumGetInt32(srid));
+  for (int i = 0; i < count; i++)
+  {
+    getPoint4d_p(linetransf->points, (uint32_t) i, &p);
+    if (hasz)
+    {
+      POINT3DZ *coords = (POINT3DZ *) gs_get_point3dz_p(point);
+      coords->x = p.x; coords->y = p.y; coords->z = p.z;
+    }
+    else
+    {
+      POINT2D *coords = (POINT2D *) gs_get_point2d_p(point);
+      coords->x = p.x; coords->y = p.y;
+    }
+    result[i] = tinstant_make(PointerGetDatum(point), instants[i]->t,
+      instants[i]->valuetypid);
+  }
+  pfree(point);
+  lwline_free(linetransf);
+  POSTGIS_FREE_IF_COPY_P(gstransf, DatumGetPointer(transf));
+  pfree(DatumGetPointer(geom)); pfree(DatumGetPointer(transf));
+  return;
+}
+
 /**
  * Transform a temporal instant set point into another spatial reference system
  */
@@ -1593,33 +1916,13 @@ tpointinstset_transform(const TInstantSet *ti, Datum srid)
   }
 
   /* General case */
-  LWGEOM **points = palloc(sizeof(LWGEOM *) * ti->count);
-  for (int i = 0; i < ti->count; i++)
-  {
-    Datum value = tinstant_value(tinstantset_inst_n(ti, i));
-    GSERIALIZED *gsvalue = (GSERIALIZED *) DatumGetPointer(value);
-    points[i] = lwgeom_from_gserialized(gsvalue);
-  }
-  Datum multipoint = lwpointarr_make_trajectory(points, ti->count, false);
-  Datum transf = datum_transform(multipoint, srid);
-  GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(transf);
-  LWMPOINT *lwmpoint = lwgeom_as_lwmpoint(lwgeom_from_gserialized(gs));
   TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
   for (int i = 0; i < ti->count; i++)
-  {
-    Datum point = PointerGetDatum(geo_serialize((LWGEOM *) (lwmpoint->geoms[i])));
-    inst = tinstantset_inst_n(ti, i);
-    instants[i] = tinstant_make(point, inst->t, inst->valuetypid);
-    pfree(DatumGetPointer(point));
-  }
-  for (int i = 0; i < ti->count; i++)
-    lwpoint_free((LWPOINT *) points[i]);
-  pfree(points);
-  pfree(DatumGetPointer(multipoint)); pfree(DatumGetPointer(transf));
-  POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(gs));
-  lwmpoint_free(lwmpoint);
-
-  return tinstantset_make_free(instants, ti->count);
+    instants[i] = tinstantset_inst_n(ti, i);
+  TInstant **newinstants = palloc(sizeof(TInstant *) * ti->count);
+  tpointinstarr_transform(newinstants, instants, ti->count, srid);
+  pfree(instants);
+  return tinstantset_make_free(newinstants, ti->count);
 }
 
 /**
@@ -1640,34 +1943,13 @@ tpointseq_transform(const TSequence *seq, Datum srid)
   }
 
   /* General case */
-  LWGEOM **points = palloc(sizeof(LWGEOM *) * seq->count);
-  for (int i = 0; i < seq->count; i++)
-  {
-    Datum value = tinstant_value(tsequence_inst_n(seq, i));
-    GSERIALIZED *gsvalue = (GSERIALIZED *)DatumGetPointer(value);
-    points[i] = lwgeom_from_gserialized(gsvalue);
-  }
-  Datum multipoint = lwpointarr_make_trajectory(points, seq->count, false);
-  Datum transf = datum_transform(multipoint, srid);
-  GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(transf);
-  LWMPOINT *lwmpoint = lwgeom_as_lwmpoint(lwgeom_from_gserialized(gs));
   TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
   for (int i = 0; i < seq->count; i++)
-  {
-    Datum point = PointerGetDatum(geo_serialize((LWGEOM *) (lwmpoint->geoms[i])));
-    TInstant *inst = tsequence_inst_n(seq, i);
-    instants[i] = tinstant_make(point, inst->t, inst->valuetypid);
-    pfree(DatumGetPointer(point));
-  }
-
-  for (int i = 0; i < seq->count; i++)
-    lwpoint_free((LWPOINT *) points[i]);
-  pfree(points);
-  pfree(DatumGetPointer(multipoint)); pfree(DatumGetPointer(transf));
-  POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(gs));
-  lwmpoint_free(lwmpoint);
-
-  return tsequence_make_free(instants, seq->count,
+    instants[i] = tsequence_inst_n(seq, i);
+  TInstant **newinstants = palloc(sizeof(TInstant *) * seq->count);
+  tpointinstarr_transform(newinstants, instants, seq->count, srid);
+  pfree(instants);
+  return tsequence_make_free(newinstants, seq->count,
     seq->period.lower_inc, seq->period.upper_inc, linear, NORMALIZE_NO);
 }
 
@@ -1691,49 +1973,29 @@ tpointseqset_transform(const TSequenceSet *ts, Datum srid)
 
   /* General case */
   int k = 0;
-  LWGEOM **points = palloc(sizeof(LWGEOM *) * ts->totalcount);
-  int maxcount = -1; /* number of instants of the longest sequence */
+  TInstant **instants = palloc(sizeof(TInstant *) * ts->totalcount);
   for (int i = 0; i < ts->count; i++)
   {
     TSequence *seq = tsequenceset_seq_n(ts, i);
-    maxcount = Max(maxcount, seq->count);
     for (int j = 0; j < seq->count; j++)
-    {
-      Datum value = tinstant_value(tsequence_inst_n(seq, j));
-      GSERIALIZED *gsvalue = (GSERIALIZED *)DatumGetPointer(value);
-      points[k++] = lwgeom_from_gserialized(gsvalue);
-    }
+      instants[k++] = tsequence_inst_n(seq, j);
   }
-  Datum multipoint = lwpointarr_make_trajectory(points, ts->totalcount, false);
-  Datum transf = datum_transform(multipoint, srid);
-  GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(transf);
-  LWMPOINT *lwmpoint = lwgeom_as_lwmpoint(lwgeom_from_gserialized(gs));
+  TInstant **newinstants = palloc(sizeof(TInstant *) * ts->totalcount);
+  tpointinstarr_transform(newinstants, instants, ts->totalcount, srid);
   TSequence **sequences = palloc(sizeof(TSequence *) * ts->count);
-  TInstant **instants = palloc(sizeof(TInstant *) * maxcount);
   bool linear = MOBDB_FLAGS_GET_LINEAR(ts->flags);
   k = 0;
   for (int i = 0; i < ts->count; i++)
   {
     TSequence *seq = tsequenceset_seq_n(ts, i);
-    for (int j = 0; j < seq->count; j++)
-    {
-      Datum point = PointerGetDatum(geo_serialize((LWGEOM *) (lwmpoint->geoms[k++])));
-      TInstant *inst = tsequence_inst_n(seq, j);
-      instants[j] = tinstant_make(point, inst->t, inst->valuetypid);
-      pfree(DatumGetPointer(point));
-    }
-    sequences[i] = tsequence_make(instants, seq->count,
+    sequences[i] = tsequence_make(&newinstants[k], seq->count,
       seq->period.lower_inc, seq->period.upper_inc, linear, NORMALIZE_NO);
-    for (int j = 0; j < seq->count; j++)
-      pfree(instants[j]);
+    k += seq->count;
   }
   TSequenceSet *result = tsequenceset_make_free(sequences, ts->count, NORMALIZE_NO);
   for (int i = 0; i < ts->totalcount; i++)
-    lwpoint_free((LWPOINT *) points[i]);
-  pfree(points); pfree(instants);
-  pfree(DatumGetPointer(multipoint)); pfree(DatumGetPointer(transf));
-  POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(gs));
-  lwmpoint_free(lwmpoint);
+    pfree(newinstants[i]);
+  pfree(instants); pfree(newinstants);
   return result;
 }
 
@@ -1746,8 +2008,6 @@ tpoint_transform(PG_FUNCTION_ARGS)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   Datum srid = PG_GETARG_DATUM(1);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
 
   Temporal *result;
   ensure_valid_duration(temp->duration);
@@ -2033,13 +2293,28 @@ tpoint_set_precision(PG_FUNCTION_ARGS)
  * Length functions
  *****************************************************************************/
 
+/**
+ * Returns true if the precomputed metrics of the temporal sequence point
+ * can be used, that is, if the point is planar or if they were computed
+ * with the current setting of the spheroid
+ */
+static bool
+tpointseq_metrics_valid(const TSequence *seq, const TSequenceMetrics *metrics)
+{
+  return metrics != NULL && (! MOBDB_FLAGS_GET_GEODETIC(seq->flags) ||
+    metrics->spheroid == geodetic_use_spheroid);
+}
+
 /**
  * Returns the length traversed by the temporal sequence point
  */
-static double
+double
 tpointseq_length(const TSequence *seq)
 {
   assert(MOBDB_FLAGS_GET_LINEAR(seq->flags));
+  const TSequenceMetrics *metrics = tsequence_metrics_ptr(seq);
+  if (tpointseq_metrics_valid(seq, metrics))
+    return metrics->length;
   Datum traj = tpointseq_trajectory(seq);
   GSERIALIZED *gstraj = (GSERIALIZED *)DatumGetPointer(traj);
   if (gserialized_get_type(gstraj) == POINTTYPE)
@@ -2048,7 +2323,7 @@ tpointseq_length(const TSequence *seq)
   /* We are sure that the trajectory is a line */
   double result = MOBDB_FLAGS_GET_GEODETIC(seq->flags) ?
     DatumGetFloat8(call_function2(geography_length, traj,
-      BoolGetDatum(true))) :
+      BoolGetDatum(geodetic_use_spheroid))) :
     /* The next function call works for 2D and 3D */
     DatumGetFloat8(call_function1(LWGEOM_length_linestring, traj));
   return result;
@@ -2217,8 +2492,6 @@ tpoint_cumulative_length(PG_FUNCTION_ARGS)
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   Temporal *result;
   ensure_valid_duration(temp->duration);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   if (temp->duration == INSTANT)
     result = (Temporal *)tpointinst_cumulative_length((TInstant *)temp);
   else if (temp->duration == INSTANTSET)
@@ -2235,10 +2508,92 @@ tpoint_cumulative_length(PG_FUNCTION_ARGS)
  * Speed functions
  *****************************************************************************/
 
+/**
+ * Returns the distance between the points of the two temporal instant points
+ */
+static double
+tpointinst_distance(const TInstant *inst1, const TInstant *inst2)
+{
+  Datum (*func)(Datum, Datum);
+  if (MOBDB_FLAGS_GET_GEODETIC(inst1->flags))
+    func = &geog_distance;
+  else
+    func = MOBDB_FLAGS_GET_Z(inst1->flags) ? &pt_distance3d :
+      &pt_distance2d;
+  return DatumGetFloat8(func(tinstant_value(inst1), tinstant_value(inst2)));
+}
+
+/**
+ * Returns the speed of the temporal point in the segment with linear
+ * interpolation defined by the two instants
+ */
+static double
+tpointsegm_speed(const TInstant *inst1, const TInstant *inst2)
+{
+  if (datum_point_eq(tinstant_value(inst1), tinstant_value(inst2)))
+    return 0;
+  return tpointinst_distance(inst1, inst2) /
+    ((double)(inst2->t - inst1->t) / 1000000);
+}
+
+/**
+ * Set the minimum and the maximum speed of the temporal sequence point
+ *
+ * @pre The sequence has at least two instants
+ */
+void
+tpointseq_speed_bounds(const TSequence *seq, double *min, double *max)
+{
+  const TSequenceMetrics *metrics = tsequence_metrics_ptr(seq);
+  if (tpointseq_metrics_valid(seq, metrics))
+  {
+    *min = metrics->minspeed;
+    *max = metrics->maxspeed;
+    return;
+  }
+  *min = *max = 0;
+  /* The speed of sequences with stepwise interpolation is zero */
+  if (! MOBDB_FLAGS_GET_LINEAR(seq->flags))
+    return;
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  for (int i = 1; i < seq->count; i++)
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, i);
+    double speed = tpointsegm_speed(inst1, inst2);
+    if (i == 1 || speed < *min)
+      *min = speed;
+    if (i == 1 || speed > *max)
+      *max = speed;
+    inst1 = inst2;
+  }
+  return;
+}
+
+/**
+ * Update the length and the speed bounds of a planar temporal sequence
+ * point with the segment defined by the two instants
+ *
+ * @param[in,out] length,min,max Metrics of the sequence before the segment
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] linear True when the segment has linear interpolation
+ */
+void
+tpointsegm_append_metrics(double *length, double *min, double *max,
+  const TInstant *inst1, const TInstant *inst2, bool linear)
+{
+  if (! linear)
+    return;
+  *length += tpointinst_distance(inst1, inst2);
+  double speed = tpointsegm_speed(inst1, inst2);
+  *min = Min(*min, speed);
+  *max = Max(*max, speed);
+  return;
+}
+
 /**
  * Returns the speed of the temporal point in the temporal sequence point
  */
-static TSequence *
+TSequence *
 tpointseq_speed(const TSequence *seq)
 {
   /* Instantaneous sequence */
@@ -2320,13 +2675,18 @@ tpoint_speed(PG_FUNCTION_ARGS)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   Temporal *result = NULL;
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT || temp->duration == INSTANTSET)
     ;
   else if (temp->duration == SEQUENCE)
-    result = (Temporal *)tpointseq_speed((TSequence *)temp);
+  {
+    /* The speed of very large sequences is computed in parallel chunks */
+    if (tpointseq_parallel_eligible((TSequence *)temp))
+      result = tpointseq_parallel(fcinfo, (TSequence *)temp, PARALLEL_SPEED,
+        (Datum) 0);
+    else
+      result = (Temporal *)tpointseq_speed((TSequence *)temp);
+  }
   else /* temp->duration == SEQUENCESET */
     result = (Temporal *)tpointseqset_speed((TSequenceSet *)temp);
   PG_FREE_IF_COPY(temp, 0);
@@ -2335,116 +2695,186 @@ tpoint_speed(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
-/*****************************************************************************
- * Time-weighed centroid for temporal geometry points
- *****************************************************************************/
-
 /**
- * Returns the time-weighed centroid of the temporal geometry point of
- * instant set duration
+ * Returns the minimum or the maximum speed of the temporal point
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] max True when the maximum speed is computed
  */
-Datum
-tgeompointi_twcentroid(const TInstantSet *ti)
+static Datum
+tpoint_speed_bound(FunctionCallInfo fcinfo, bool max)
 {
-  int srid = tpointinstset_srid(ti);
-  TInstant **instantsx = palloc(sizeof(TInstant *) * ti->count);
-  TInstant **instantsy = palloc(sizeof(TInstant *) * ti->count);
-  TInstant **instantsz = NULL; /* keep compiler quiet */
-  bool hasz = MOBDB_FLAGS_GET_Z(ti->flags);
-  if (hasz)
-    instantsz = palloc(sizeof(TInstant *) * ti->count);
-
-  for (int i = 0; i < ti->count; i++)
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  bool found = false;
+  double result = 0;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == SEQUENCE || temp->duration == SEQUENCESET)
   {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    POINT4D point = datum_get_point4d(tinstant_value(inst));
-    instantsx[i] = tinstant_make(Float8GetDatum(point.x), inst->t,
-      FLOAT8OID);
-    instantsy[i] = tinstant_make(Float8GetDatum(point.y), inst->t,
-      FLOAT8OID);
-    if (hasz)
-      instantsz[i] = tinstant_make(Float8GetDatum(point.z), inst->t,
-        FLOAT8OID);
+    int count = (temp->duration == SEQUENCE) ? 1 :
+      ((TSequenceSet *) temp)->count;
+    for (int i = 0; i < count; i++)
+    {
+      TSequence *seq = (temp->duration == SEQUENCE) ? (TSequence *) temp :
+        tsequenceset_seq_n((TSequenceSet *) temp, i);
+      /* The speed of instantaneous sequences is undefined */
+      if (seq->count == 1)
+        continue;
+      double minspeed, maxspeed;
+      tpointseq_speed_bounds(seq, &minspeed, &maxspeed);
+      double speed = max ? maxspeed : minspeed;
+      if (! found || (max && speed > result) || (! max && speed < result))
+        result = speed;
+      found = true;
+    }
   }
-  TInstantSet *tix = tinstantset_make_free(instantsx, ti->count);
-  TInstantSet *tiy = tinstantset_make_free(instantsy, ti->count);
-  TInstantSet *tiz = NULL; /* keep compiler quiet */
-  if (hasz)
-    tiz = tinstantset_make_free(instantsz, ti->count);
-  double avgx = tnumberinstset_twavg(tix);
-  double avgy = tnumberinstset_twavg(tiy);
-  double avgz;
-  if (hasz)
-    avgz = tnumberinstset_twavg(tiz);
-  LWPOINT *lwpoint;
-  if (hasz)
-    lwpoint = lwpoint_make3dz(srid, avgx, avgy, avgz);
-  else
-    lwpoint = lwpoint_make2d(srid, avgx, avgy);
-  Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
-
-  pfree(lwpoint);
-  pfree(tix); pfree(tiy);
-  if (hasz)
-    pfree(tiz);
-
-  return result;
+  PG_FREE_IF_COPY(temp, 0);
+  if (! found)
+    PG_RETURN_NULL();
+  PG_RETURN_FLOAT8(result);
 }
 
+PG_FUNCTION_INFO_V1(tpoint_min_speed);
 /**
- * Returns the time-weighed centroid of the temporal geometry point of
- * sequence duration
+ * Returns the minimum speed of the temporal point, which is equal to
+ * minValue(speed(temp)) but is obtained from the precomputed metrics of
+ * long sequences
  */
-Datum
-tgeompointseq_twcentroid(const TSequence *seq)
+PGDLLEXPORT Datum
+tpoint_min_speed(PG_FUNCTION_ARGS)
 {
-  int srid = tpointseq_srid(seq);
-  TInstant **instantsx = palloc(sizeof(TInstant *) * seq->count);
-  TInstant **instantsy = palloc(sizeof(TInstant *) * seq->count);
-  TInstant **instantsz;
-  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
-  if (hasz)
-    instantsz = palloc(sizeof(TInstant *) * seq->count);
+  return tpoint_speed_bound(fcinfo, false);
+}
 
-  for (int i = 0; i < seq->count; i++)
-  {
-    TInstant *inst = tsequence_inst_n(seq, i);
-    POINT4D point = datum_get_point4d(tinstant_value(inst));
-    instantsx[i] = tinstant_make(Float8GetDatum(point.x), inst->t,
-      FLOAT8OID);
-    instantsy[i] = tinstant_make(Float8GetDatum(point.y), inst->t,
-      FLOAT8OID);
-    if (hasz)
-      instantsz[i] = tinstant_make(Float8GetDatum(point.z), inst->t,
-        FLOAT8OID);
-  }
-  TSequence *seqx = tsequence_make_free(instantsx, seq->count,
-    seq->period.lower_inc, seq->period.upper_inc,
-    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-  TSequence *seqy = tsequence_make_free(instantsy, seq->count,
-    seq->period.lower_inc, seq->period.upper_inc,
-    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-  TSequence *seqz;
-  if (hasz)
-    seqz = tsequence_make_free(instantsz, seq->count, seq->period.lower_inc,
-      seq->period.upper_inc, MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-  double twavgx = tnumberseq_twavg(seqx);
-  double twavgy = tnumberseq_twavg(seqy);
-  LWPOINT *lwpoint;
+PG_FUNCTION_INFO_V1(tpoint_max_speed);
+/**
+ * Returns the maximum speed of the temporal point, which is equal to
+ * maxValue(speed(temp)) but is obtained from the precomputed metrics of
+ * long sequences
+ */
+PGDLLEXPORT Datum
+tpoint_max_speed(PG_FUNCTION_ARGS)
+{
+  return tpoint_speed_bound(fcinfo, true);
+}
+
+/*****************************************************************************
+ * Time-weighed centroid for temporal geometry points
+ *****************************************************************************/
+
+/**
+ * Returns the coordinates of the temporal geometry point instant, where
+ * the Z coordinate of 2D points is set to 0
+ */
+static POINT3DZ
+tgeompointinst_coords(const TInstant *inst, bool hasz)
+{
+  POINT3DZ result;
+  Datum value = tinstant_value(inst);
   if (hasz)
+    result = datum_get_point3dz(value);
+  else
+  {
+    const POINT2D *p = datum_get_point2d_p(value);
+    result.x = p->x;
+    result.y = p->y;
+    result.z = 0;
+  }
+  return result;
+}
+
+/**
+ * Adds to the sums the integrals of the coordinates of the temporal
+ * geometry point of sequence duration, computed over its segments in the
+ * same way as the integral of a temporal float
+ */
+static void
+tgeompointseq_integral(const TSequence *seq, bool hasz, POINT3DZ *sum)
+{
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  POINT3DZ p1 = tgeompointinst_coords(inst1, hasz);
+  for (int i = 1; i < seq->count; i++)
   {
-    double twavgz = tnumberseq_twavg(seqz);
-    lwpoint = lwpoint_make3dz(srid, twavgx, twavgy, twavgz);
+    TInstant *inst2 = tsequence_inst_n(seq, i);
+    POINT3DZ p2 = tgeompointinst_coords(inst2, hasz);
+    double duration = (double) (inst2->t - inst1->t);
+    if (linear)
+    {
+      sum->x += (p1.x + p2.x) * duration / 2.0;
+      sum->y += (p1.y + p2.y) * duration / 2.0;
+      sum->z += (p1.z + p2.z) * duration / 2.0;
+    }
+    else
+    {
+      sum->x += p1.x * duration;
+      sum->y += p1.y * duration;
+      sum->z += p1.z * duration;
+    }
+    inst1 = inst2;
+    p1 = p2;
   }
+  return;
+}
+
+/**
+ * Returns the point with the coordinates divided by the value
+ */
+static Datum
+twcentroid_make(int srid, bool hasz, const POINT3DZ *sum, double value)
+{
+  LWPOINT *lwpoint;
+  if (hasz)
+    lwpoint = lwpoint_make3dz(srid, sum->x / value, sum->y / value,
+      sum->z / value);
   else
-    lwpoint = lwpoint_make2d(srid, twavgx, twavgy);
+    lwpoint = lwpoint_make2d(srid, sum->x / value, sum->y / value);
   Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
+  pfree(lwpoint);
+  return result;
+}
 
-  pfree(lwpoint);  pfree(seqx); pfree(seqy);
-  if (hasz)
-    pfree(seqz);
+/**
+ * Returns the time-weighed centroid of the temporal geometry point of
+ * instant set duration
+ */
+Datum
+tgeompointi_twcentroid(const TInstantSet *ti)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(ti->flags);
+  POINT3DZ sum = {0, 0, 0};
+  for (int i = 0; i < ti->count; i++)
+  {
+    POINT3DZ p = tgeompointinst_coords(tinstantset_inst_n(ti, i), hasz);
+    sum.x += p.x;
+    sum.y += p.y;
+    sum.z += p.z;
+  }
+  return twcentroid_make(tpointinstset_srid(ti), hasz, &sum, ti->count);
+}
 
-  return result;
+/**
+ * Returns the time-weighed centroid of the temporal geometry point of
+ * sequence duration
+ *
+ * @note The coordinates are integrated directly over the segments instead
+ * of computing the time-weighted average of one temporal float per
+ * coordinate
+ */
+Datum
+tgeompointseq_twcentroid(const TSequence *seq)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  double duration = (double) (seq->period.upper - seq->period.lower);
+  POINT3DZ sum = {0, 0, 0};
+  if (duration == 0.0)
+  {
+    /* Instantaneous sequence */
+    sum = tgeompointinst_coords(tsequence_inst_n(seq, 0), hasz);
+    duration = 1.0;
+  }
+  else
+    tgeompointseq_integral(seq, hasz, &sum);
+  return twcentroid_make(tpointseq_srid(seq), hasz, &sum, duration);
 }
 
 /**
@@ -2454,68 +2884,28 @@ tgeompointseq_twcentroid(const TSequence *seq)
 Datum
 tgeompoints_twcentroid(const TSequenceSet *ts)
 {
-  int srid = tpointseqset_srid(ts);
-  TSequence **sequencesx = palloc(sizeof(TSequence *) * ts->count);
-  TSequence **sequencesy = palloc(sizeof(TSequence *) * ts->count);
-  TSequence **sequencesz = NULL; /* keep compiler quiet */
   bool hasz = MOBDB_FLAGS_GET_Z(ts->flags);
-  if (hasz)
-    sequencesz = palloc(sizeof(TSequence *) * ts->count);
-  for (int i = 0; i < ts->count; i++)
+  double duration = tsequenceset_interval_double(ts);
+  POINT3DZ sum = {0, 0, 0};
+  if (duration == 0.0)
   {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    TInstant **instantsx = palloc(sizeof(TInstant *) * seq->count);
-    TInstant **instantsy = palloc(sizeof(TInstant *) * seq->count);
-    TInstant **instantsz;
-    if (hasz)
-      instantsz = palloc(sizeof(TInstant *) * seq->count);
-    for (int j = 0; j < seq->count; j++)
+    /* Average of the instantaneous sequences */
+    for (int i = 0; i < ts->count; i++)
     {
-      TInstant *inst = tsequence_inst_n(seq, j);
-      POINT4D point = datum_get_point4d(tinstant_value(inst));
-      instantsx[j] = tinstant_make(Float8GetDatum(point.x),
-        inst->t, FLOAT8OID);
-      instantsy[j] = tinstant_make(Float8GetDatum(point.y),
-        inst->t, FLOAT8OID);
-      if (hasz)
-        instantsz[j] = tinstant_make(Float8GetDatum(point.z),
-          inst->t, FLOAT8OID);
+      POINT3DZ p = tgeompointinst_coords(
+        tsequence_inst_n(tsequenceset_seq_n(ts, i), 0), hasz);
+      sum.x += p.x;
+      sum.y += p.y;
+      sum.z += p.z;
     }
-    sequencesx[i] = tsequence_make_free(instantsx, seq->count,
-      seq->period.lower_inc, seq->period.upper_inc,
-      MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-    sequencesy[i] = tsequence_make_free(instantsy,
-      seq->count, seq->period.lower_inc, seq->period.upper_inc,
-      MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-    if (hasz)
-      sequencesz[i] = tsequence_make_free(instantsz, seq->count,
-        seq->period.lower_inc, seq->period.upper_inc,
-        MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
+    duration = ts->count;
   }
-  TSequenceSet *tsx = tsequenceset_make_free(sequencesx, ts->count, NORMALIZE);
-  TSequenceSet *tsy = tsequenceset_make_free(sequencesy, ts->count, NORMALIZE);
-  TSequenceSet *tsz = NULL; /* keep compiler quiet */
-  if (hasz)
-    tsz = tsequenceset_make_free(sequencesz, ts->count, NORMALIZE);
-
-  double twavgx = tnumberseqset_twavg(tsx);
-  double twavgy = tnumberseqset_twavg(tsy);
-  LWPOINT *lwpoint;
-  if (hasz)
+  else
   {
-    double twavgz = tnumberseqset_twavg(tsz);
-    lwpoint = lwpoint_make3dz(srid, twavgx, twavgy, twavgz);
+    for (int i = 0; i < ts->count; i++)
+      tgeompointseq_integral(tsequenceset_seq_n(ts, i), hasz, &sum);
   }
-  else
-    lwpoint = lwpoint_make2d(srid, twavgx, twavgy);
-  Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
-
-  pfree(lwpoint);
-  pfree(tsx); pfree(tsy);
-  if (hasz)
-    pfree(tsz);
-
-  return result;
+  return twcentroid_make(tpointseqset_srid(ts), hasz, &sum, duration);
 }
 
 /**
@@ -2574,8 +2964,9 @@ geom_azimuth(Datum geom1, Datum geom2)
 static Datum
 geog_azimuth(Datum geom1, Datum geom2)
 {
-  return CallerFInfoFunctionCall2(geography_azimuth, (fetch_fcinfo())->flinfo,
-    InvalidOid, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(geography_azimuth,
+    postgis_flinfo(&flinfo, geography_azimuth, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -2687,8 +3078,6 @@ PGDLLEXPORT Datum
 tpoint_azimuth(PG_FUNCTION_ARGS)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *result = NULL;
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT || temp->duration == INSTANTSET ||
@@ -2705,6 +3094,268 @@ tpoint_azimuth(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Trajectory metrics functions
+ *****************************************************************************/
+
+/**
+ * Computes in a single pass over the segments of the temporal sequence point
+ * its cumulative length, its speed, its azimuth, and its acceleration
+ *
+ * The distance and the time delta of each segment are computed once and
+ * shared by all the metrics. The acceleration in a segment is the difference
+ * between its speed and the speed of the previous segment divided by the
+ * time elapsed between the midpoints of the two segments.
+ *
+ * @param[in] seq Temporal value
+ * @param[in,out] length Length traversed before the sequence, updated with
+ * the length of the sequence
+ * @param[out] lengthseq,speedseq,accelseq Resulting sequences, the last two
+ * are NULL when they are undefined
+ * @param[out] azimuths Array on which the pointers of the newly constructed
+ * azimuth sequences are stored
+ * @return Number of azimuth sequences
+ */
+static int
+tpointseq_trajectory_metrics1(const TSequence *seq, double *length,
+  TSequence **lengthseq, TSequence **speedseq, TSequence **accelseq,
+  TSequence **azimuths)
+{
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  *speedseq = *accelseq = NULL;
+
+  /* Instantaneous sequence */
+  if (seq->count == 1)
+  {
+    TInstant *inst = tsequence_inst_n(seq, 0);
+    TInstant *inst1 = tinstant_make(Float8GetDatum(*length), inst->t,
+      FLOAT8OID);
+    *lengthseq = tinstant_to_tsequence(inst1, linear);
+    pfree(inst1);
+    return 0;
+  }
+
+  TInstant **lengths = palloc(sizeof(TInstant *) * seq->count);
+  TInstant **speeds = palloc(sizeof(TInstant *) * seq->count);
+  /* Stepwise interpolation */
+  if (! linear)
+  {
+    for (int i = 0; i < seq->count; i++)
+    {
+      TInstant *inst = tsequence_inst_n(seq, i);
+      lengths[i] = tinstant_make(Float8GetDatum(*length), inst->t,
+        FLOAT8OID);
+      speeds[i] = tinstant_make(Float8GetDatum(0.0), inst->t, FLOAT8OID);
+    }
+    *lengthseq = tsequence_make(lengths, seq->count, seq->period.lower_inc,
+      seq->period.upper_inc, STEP, NORMALIZE);
+    /* The speed and the acceleration are zero */
+    *speedseq = tsequence_make(speeds, seq->count, seq->period.lower_inc,
+      seq->period.upper_inc, STEP, NORMALIZE);
+    *accelseq = tsequence_make(speeds, seq->count, seq->period.lower_inc,
+      seq->period.upper_inc, STEP, NORMALIZE);
+    for (int i = 0; i < seq->count; i++)
+    {
+      pfree(lengths[i]);
+      pfree(speeds[i]);
+    }
+    pfree(lengths); pfree(speeds);
+    return 0;
+  }
+
+  /* Linear interpolation */
+  Datum (*distfunc)(Datum, Datum);
+  Datum (*azfunc)(Datum, Datum);
+  if (MOBDB_FLAGS_GET_GEODETIC(seq->flags))
+  {
+    distfunc = &geog_distance;
+    azfunc = &geog_azimuth;
+  }
+  else
+  {
+    distfunc = MOBDB_FLAGS_GET_Z(seq->flags) ? &pt_distance3d :
+      &pt_distance2d;
+    azfunc = &geom_azimuth;
+  }
+
+  TInstant **accels = palloc(sizeof(TInstant *) * seq->count);
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  Datum value1 = tinstant_value(inst1);
+  lengths[0] = tinstant_make(Float8GetDatum(*length), inst1->t, FLOAT8OID);
+  double speed = 0, prevspeed = 0, accel = 0, prevdelta = 0;
+  Datum azimuth = 0; /* Make the compiler quiet */
+  int k = 0, l = 0;
+  bool lower_inc = seq->period.lower_inc, upper_inc;
+  for (int i = 1; i < seq->count; i++)
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, i);
+    Datum value2 = tinstant_value(inst2);
+    bool equal = datum_point_eq(value1, value2);
+    double dist = equal ? 0 : DatumGetFloat8(distfunc(value1, value2));
+    double delta = (double)(inst2->t - inst1->t) / 1000000;
+    speed = equal ? 0 : dist / delta;
+    *length += dist;
+    lengths[i] = tinstant_make(Float8GetDatum(*length), inst2->t, FLOAT8OID);
+    speeds[i - 1] = tinstant_make(Float8GetDatum(speed), inst1->t,
+      FLOAT8OID);
+    if (i > 1)
+    {
+      accel = (speed - prevspeed) / ((prevdelta + delta) / 2);
+      accels[i - 2] = tinstant_make(Float8GetDatum(accel), inst1->t,
+        FLOAT8OID);
+    }
+    /* The azimuth is undefined in the segments with equal points */
+    upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
+    if (! equal)
+    {
+      azimuth = azfunc(value1, value2);
+      instants[k++] = tinstant_make(azimuth, inst1->t, FLOAT8OID);
+    }
+    else
+    {
+      if (k != 0)
+      {
+        instants[k++] = tinstant_make(azimuth, inst1->t, FLOAT8OID);
+        azimuths[l++] = tsequence_make(instants, k, lower_inc, true,
+          STEP, NORMALIZE);
+        for (int j = 0; j < k; j++)
+          pfree(instants[j]);
+        k = 0;
+      }
+      lower_inc = true;
+    }
+    prevspeed = speed;
+    prevdelta = delta;
+    inst1 = inst2;
+    value1 = value2;
+  }
+  if (k != 0)
+  {
+    instants[k++] = tinstant_make(azimuth, inst1->t, FLOAT8OID);
+    azimuths[l++] = tsequence_make(instants, k, lower_inc, upper_inc,
+      STEP, NORMALIZE);
+    for (int j = 0; j < k; j++)
+      pfree(instants[j]);
+  }
+  speeds[seq->count - 1] = tinstant_make(Float8GetDatum(speed),
+    seq->period.upper, FLOAT8OID);
+
+  /* The speed, the acceleration, and the azimuth have step interpolation */
+  *lengthseq = tsequence_make(lengths, seq->count, seq->period.lower_inc,
+    seq->period.upper_inc, LINEAR, NORMALIZE);
+  *speedseq = tsequence_make(speeds, seq->count, seq->period.lower_inc,
+    seq->period.upper_inc, STEP, NORMALIZE);
+  /* The acceleration starts at the end of the first segment */
+  if (seq->count > 2)
+  {
+    accels[seq->count - 2] = tinstant_make(Float8GetDatum(accel),
+      seq->period.upper, FLOAT8OID);
+    *accelseq = tsequence_make(accels, seq->count - 1, true,
+      seq->period.upper_inc, STEP, NORMALIZE);
+    for (int i = 0; i < seq->count - 1; i++)
+      pfree(accels[i]);
+  }
+  for (int i = 0; i < seq->count; i++)
+  {
+    pfree(lengths[i]);
+    pfree(speeds[i]);
+  }
+  pfree(lengths); pfree(speeds); pfree(accels); pfree(instants);
+  return l;
+}
+
+/**
+ * Computes in a single pass over the segments of the temporal sequence set
+ * point its cumulative length, its speed, its azimuth, and its acceleration
+ *
+ * @param[in] ts Temporal value
+ * @param[out] result Array on which the resulting temporal values are stored,
+ * NULL when they are undefined
+ */
+static void
+tpointseqset_trajectory_metrics(const TSequenceSet *ts, Temporal **result)
+{
+  TSequence **lengths = palloc(sizeof(TSequence *) * ts->count);
+  TSequence **speeds = palloc(sizeof(TSequence *) * ts->count);
+  TSequence **accels = palloc(sizeof(TSequence *) * ts->count);
+  TSequence **azimuths = palloc(sizeof(TSequence *) * ts->totalcount);
+  double length = 0;
+  int nspeeds = 0, naccels = 0, nazimuths = 0;
+  for (int i = 0; i < ts->count; i++)
+  {
+    TSequence *seq = tsequenceset_seq_n(ts, i);
+    TSequence *speed, *accel;
+    nazimuths += tpointseq_trajectory_metrics1(seq, &length, &lengths[i],
+      &speed, &accel, &azimuths[nazimuths]);
+    if (speed != NULL)
+      speeds[nspeeds++] = speed;
+    if (accel != NULL)
+      accels[naccels++] = accel;
+  }
+  result[0] = (Temporal *) tsequenceset_make_free(lengths, ts->count,
+    NORMALIZE_NO);
+  result[1] = (Temporal *) tsequenceset_make_free(speeds, nspeeds,
+    NORMALIZE);
+  result[2] = (Temporal *) tsequenceset_make_free(azimuths, nazimuths,
+    NORMALIZE);
+  result[3] = (Temporal *) tsequenceset_make_free(accels, naccels,
+    NORMALIZE);
+  return;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_trajectory_metrics);
+/**
+ * Returns the cumulative length, the speed, the azimuth, and the
+ * acceleration of the temporal point computed in a single pass
+ */
+PGDLLEXPORT Datum
+tpoint_trajectory_metrics(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+      errmsg("function returning record called in context "
+        "that cannot accept type record")));
+  tupdesc = BlessTupleDesc(tupdesc);
+
+  Temporal *result[4] = {NULL, NULL, NULL, NULL};
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result[0] = (Temporal *)tpointinst_cumulative_length((TInstant *)temp);
+  else if (temp->duration == INSTANTSET)
+    result[0] = (Temporal *)tpointinstset_cumulative_length(
+      (TInstantSet *)temp);
+  else if (temp->duration == SEQUENCE)
+  {
+    TSequence *seq = (TSequence *)temp;
+    TSequence *lengthseq, *speedseq, *accelseq;
+    TSequence **azimuths = palloc(sizeof(TSequence *) * seq->count);
+    double length = 0;
+    int count = tpointseq_trajectory_metrics1(seq, &length, &lengthseq,
+      &speedseq, &accelseq, azimuths);
+    result[0] = (Temporal *)lengthseq;
+    result[1] = (Temporal *)speedseq;
+    result[2] = (Temporal *)tsequenceset_make_free(azimuths, count,
+      NORMALIZE);
+    result[3] = (Temporal *)accelseq;
+  }
+  else /* temp->duration == SEQUENCESET */
+    tpointseqset_trajectory_metrics((TSequenceSet *)temp, result);
+
+  Datum values[4];
+  bool isnull[4];
+  for (int i = 0; i < 4; i++)
+  {
+    values[i] = PointerGetDatum(result[i]);
+    isnull[i] = (result[i] == NULL);
+  }
+  HeapTuple tuple = heap_form_tuple(tupdesc, values, isnull);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
 /*****************************************************************************
  * Restriction functions
  * N.B. In the PostGIS version currently used by MobilityDB (2.5) there is no
@@ -2747,57 +3398,98 @@ tpointinstset_restrict_geometry(const TInstantSet *ti, Datum geom, bool atfunc)
 }
 
 /**
- * Restricts the segment of a temporal sequence point to the geometry
+ * Add to the array the piece of the linear segment of a temporal sequence
+ * point between the two fractions of the segment
  *
+ * @param[out] result Array of sequences
+ * @param[in] k Number of sequences of the array
  * @param[in] inst1,inst2 Instants defining the segment
- * @param[in] linear True when the segment has linear interpolation
  * @param[in] lower_inc,upper_inc State whether the bounds are inclusive
- * @param[in] geom Geometry
- * @param[out] count Number of elements in the resulting array
- * @pre The instants have the same SRID and the points and the geometry
- * are in 2D
+ * @param[in] fraction1,fraction2 Fractions of the segment
+ * @param[in] ispoint True when the piece is a single point
+ * @return Number of sequences of the array
  */
-static TSequence **
-tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
-  bool linear, bool lower_inc, bool upper_inc, Datum geom, int *count)
+static int
+tpointseq_at_fractions(TSequence **result, int k, const TInstant *inst1,
+  const TInstant *inst2, bool lower_inc, bool upper_inc, double fraction1,
+  double fraction2, bool ispoint)
 {
-  Datum value1 = tinstant_value(inst1);
-  Datum value2 = tinstant_value(inst2);
+  double duration = (inst2->t - inst1->t);
+  TimestampTz t1 = inst1->t + (long) (duration * fraction1);
+  TimestampTz t2 = inst1->t + (long) (duration * fraction2);
   TInstant *instants[2];
-
-  /* Constant segment or step interpolation */
-  bool equal = datum_point_eq(value1, value2);
-  if (equal || ! linear)
+  if (ispoint || t1 == t2)
   {
-    if (!DatumGetBool(call_function2(intersects, value1, geom)))
+    /* If the intersection is not at an exclusive bound */
+    if ((lower_inc || t1 > inst1->t) && (upper_inc || t1 < inst2->t))
     {
-      *count = 0;
-      return NULL;
+      Datum point1 = tsequence_value_at_timestamp1(inst1, inst2, true, t1);
+      instants[0] = tinstant_make(point1, t1, inst1->valuetypid);
+      result[k++] = tinstant_to_tsequence(instants[0], true);
+      pfree(DatumGetPointer(point1));
+      pfree(instants[0]);
     }
-
-    instants[0] = (TInstant *) inst1;
-    instants[1] = linear ? (TInstant *) inst2 :
-      tinstant_make(value1, inst2->t, inst1->valuetypid);
-    /* Stepwise segment with inclusive upper bound must return 2 sequences */
-    bool upper_inc1 = (linear) ? upper_inc : false;
-    TSequence **result = palloc(sizeof(TSequence *) * 2);
-    result[0] = tsequence_make(instants, 2, lower_inc, upper_inc1,
-      linear, NORMALIZE_NO);
-    int k = 1;
-    if (upper_inc != upper_inc1 &&
-      DatumGetBool(call_function2(intersects, value2, geom)))
+    return k;
+  }
+  TimestampTz lower1 = Min(t1, t2);
+  TimestampTz upper1 = Max(t1, t2);
+  Datum point1 = tsequence_value_at_timestamp1(inst1, inst2, true, lower1);
+  Datum point2 = tsequence_value_at_timestamp1(inst1, inst2, true, upper1);
+  instants[0] = tinstant_make(point1, lower1, inst1->valuetypid);
+  instants[1] = tinstant_make(point2, upper1, inst1->valuetypid);
+  bool lower_inc1 = (lower1 == inst1->t) ? lower_inc : true;
+  bool upper_inc1 = (upper1 == inst2->t) ? upper_inc : true;
+  result[k++] = tsequence_make(instants, 2, lower_inc1, upper_inc1,
+    true, NORMALIZE_NO);
+  pfree(DatumGetPointer(point1)); pfree(DatumGetPointer(point2));
+  pfree(instants[0]); pfree(instants[1]);
+  return k;
+}
+
+/**
+ * Returns the fractions of the linear segment of a temporal sequence point
+ * that intersect the geometry
+ *
+ * The result is an array of pairs of fractions, each pair defining an
+ * interval of the segment. When both fractions of a pair are equal the
+ * intersection is a single point. The segment is clipped with the index of
+ * the edges of the geometry if any, otherwise the intersection is computed
+ * with PostGIS.
+ *
+ * @param[in] value1,value2 Points defining the segment
+ * @param[in] start,end Coordinates of the points defining the segment
+ * @param[in] geom Geometry
+ * @param[in] index Index of the edges of the geometry, NULL if none
+ * @param[out] count Number of pairs of the result
+ * @pre The points are not equal
+ */
+static double *
+tpointseg_geometry_fractions(Datum value1, Datum value2,
+  const POINT2D *start, const POINT2D *end, Datum geom,
+  const EdgeIndex *index, int *count)
+{
+  /* Clip the segment with the index of the edges of the polygon */
+  if (index != NULL)
+  {
+    double *result = edgeindex_clip_segment(index, start, end, count);
+    if (*count == 0)
     {
-      result[1] = tinstant_to_tsequence(inst2, linear);
-      k = 2;
+      pfree(result);
+      return NULL;
     }
-    if (! linear)
-      pfree(instants[1]);
-    *count = k;
     return result;
   }
 
-  /* Look for intersections in linear segment */
+  /* Look for intersections in linear segment. The intersects test uses the
+   * geometry prepared by PostGIS and avoids computing the intersection of
+   * the segments that do not intersect the geometry */
   Datum line = geopoint_line(value1, value2);
+  if (! DatumGetBool(geom_intersects2d(line, geom)))
+  {
+    pfree(DatumGetPointer(line));
+    *count = 0;
+    return NULL;
+  }
   Datum inter = call_function2(intersection, line, geom);
   GSERIALIZED *gsinter = (GSERIALIZED *) PG_DETOAST_DATUM(inter);
   if (gserialized_is_empty(gsinter))
@@ -2809,8 +3501,6 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
     return NULL;
   }
 
-  const POINT2D *start = datum_get_point2d_p(value1);
-  const POINT2D *end = datum_get_point2d_p(value2);
   LWGEOM *lwgeom_inter = lwgeom_from_gserialized(gsinter);
   int type = lwgeom_inter->type;
   int countinter;
@@ -2821,7 +3511,6 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
   {
     countinter = 1;
     lwpoint_inter = lwgeom_as_lwpoint(lwgeom_inter);
-
   }
   else if (type == LINETYPE)
   {
@@ -2833,9 +3522,7 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
     coll = lwgeom_as_lwcollection(lwgeom_inter);
     countinter = coll->ngeoms;
   }
-  TSequence **result = palloc(sizeof(TSequence *) * countinter);
-  double duration = (inst2->t - inst1->t);
-  int k = 0;
+  double *result = palloc(sizeof(double) * 2 * countinter);
   for (int i = 0; i < countinter; i++)
   {
     if (countinter > 1)
@@ -2846,27 +3533,15 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
         lwpoint_inter = lwgeom_as_lwpoint(subgeom);
       else /* type == LINETYPE */
         lwline_inter = lwgeom_as_lwline(subgeom);
-      type =   subgeom->type;
+      type = subgeom->type;
     }
     POINT2D p1, p2, closest;
-    double fraction1;
-    TimestampTz t1;
-    Datum point1;
     /* Each intersection is either a point or a linestring with two points */
     if (type == POINTTYPE)
     {
       lwpoint_getPoint2d_p(lwpoint_inter, &p1);
-      fraction1 = closest_point2d_on_segment_ratio(&p1, start, end, &closest);
-      t1 = inst1->t + (long) (duration * fraction1);
-      /* If the intersection is not at an exclusive bound */
-      if ((lower_inc || t1 > inst1->t) && (upper_inc || t1 < inst2->t))
-      {
-        point1 = tsequence_value_at_timestamp1(inst1, inst2, true, t1);
-        instants[0] = tinstant_make(point1, t1, inst1->valuetypid);
-        result[k++] = tinstant_to_tsequence(instants[0], linear);
-        pfree(DatumGetPointer(point1));
-        pfree(instants[0]);
-      }
+      result[2 * i] = result[2 * i + 1] =
+        closest_point2d_on_segment_ratio(&p1, start, end, &closest);
     }
     else
     {
@@ -2874,22 +3549,10 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
       LWPOINT *lwpoint2 = lwline_get_lwpoint(lwline_inter, 1);
       lwpoint_getPoint2d_p(lwpoint1, &p1);
       lwpoint_getPoint2d_p(lwpoint2, &p2);
-      fraction1 = closest_point2d_on_segment_ratio(&p1, start, end, &closest);
-      double fraction2 = closest_point2d_on_segment_ratio(&p2, start, end, &closest);
-      t1 = inst1->t + (long) (duration * fraction1);
-      TimestampTz t2 = inst1->t + (long) (duration * fraction2);
-      TimestampTz lower1 = Min(t1, t2);
-      TimestampTz upper1 = Max(t1, t2);
-      point1 = tsequence_value_at_timestamp1(inst1, inst2, true, lower1);
-      Datum point2 = tsequence_value_at_timestamp1(inst1, inst2, true, upper1);
-      instants[0] = tinstant_make(point1, lower1, inst1->valuetypid);
-      instants[1] = tinstant_make(point2, upper1, inst1->valuetypid);
-      bool lower_inc1 = (lower1 == inst1->t) ? lower_inc : true;
-      bool upper_inc1 = (upper1 == inst2->t) ? upper_inc : true;
-      result[k++] = tsequence_make(instants, 2, lower_inc1, upper_inc1,
-        linear, NORMALIZE_NO);
-      pfree(DatumGetPointer(point1)); pfree(DatumGetPointer(point2));
-      pfree(instants[0]); pfree(instants[1]);
+      result[2 * i] = closest_point2d_on_segment_ratio(&p1, start, end,
+        &closest);
+      result[2 * i + 1] = closest_point2d_on_segment_ratio(&p2, start, end,
+        &closest);
     }
   }
 
@@ -2897,7 +3560,79 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
   pfree(DatumGetPointer(inter));
   POSTGIS_FREE_IF_COPY_P(gsinter, DatumGetPointer(gsinter));
   lwgeom_free(lwgeom_inter);
+  *count = countinter;
+  return result;
+}
+
+/**
+ * Restricts the segment of a temporal sequence point to the geometry
+ *
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] linear True when the segment has linear interpolation
+ * @param[in] lower_inc,upper_inc State whether the bounds are inclusive
+ * @param[in] geom Geometry
+ * @param[in] index Index of the edges of the geometry, NULL if none
+ * @param[out] count Number of elements in the resulting array
+ * @pre The instants have the same SRID and the points and the geometry
+ * are in 2D
+ */
+static TSequence **
+tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
+  bool linear, bool lower_inc, bool upper_inc, Datum geom,
+  const EdgeIndex *index, int *count)
+{
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  TInstant *instants[2];
+
+  /* Constant segment or step interpolation */
+  bool equal = datum_point_eq(value1, value2);
+  if (equal || ! linear)
+  {
+    if (!DatumGetBool(geom_intersects2d(value1, geom)))
+    {
+      *count = 0;
+      return NULL;
+    }
+
+    instants[0] = (TInstant *) inst1;
+    instants[1] = linear ? (TInstant *) inst2 :
+      tinstant_make(value1, inst2->t, inst1->valuetypid);
+    /* Stepwise segment with inclusive upper bound must return 2 sequences */
+    bool upper_inc1 = (linear) ? upper_inc : false;
+    TSequence **result = palloc(sizeof(TSequence *) * 2);
+    result[0] = tsequence_make(instants, 2, lower_inc, upper_inc1,
+      linear, NORMALIZE_NO);
+    int k = 1;
+    if (upper_inc != upper_inc1 &&
+      DatumGetBool(geom_intersects2d(value2, geom)))
+    {
+      result[1] = tinstant_to_tsequence(inst2, linear);
+      k = 2;
+    }
+    if (! linear)
+      pfree(instants[1]);
+    *count = k;
+    return result;
+  }
 
+  const POINT2D *start = datum_get_point2d_p(value1);
+  const POINT2D *end = datum_get_point2d_p(value2);
+  int countinter;
+  double *fractions = tpointseg_geometry_fractions(value1, value2, start,
+    end, geom, index, &countinter);
+  if (countinter == 0)
+  {
+    *count = 0;
+    return NULL;
+  }
+  TSequence **result = palloc(sizeof(TSequence *) * countinter);
+  int k = 0;
+  for (int i = 0; i < countinter; i++)
+    k = tpointseq_at_fractions(result, k, inst1, inst2, lower_inc,
+      upper_inc, fractions[2 * i], fractions[2 * i + 1],
+      fractions[2 * i] == fractions[2 * i + 1]);
+  pfree(fractions);
   if (k == 0)
   {
     pfree(result);
@@ -2910,6 +3645,164 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
   return result;
 }
 
+/**
+ * Returns true if the two spatiotemporal boxes overlap on the X and Y
+ * dimensions. The SRID and the dimensionality of the boxes are not
+ * verified since the function is only used for filtering purposes.
+ */
+static bool
+overlaps_stbox_stbox_2d(const STBOX *box1, const STBOX *box2)
+{
+  return (box1->xmin <= box2->xmax && box2->xmin <= box1->xmax &&
+    box1->ymin <= box2->ymax && box2->ymin <= box1->ymax);
+}
+
+/*****************************************************************************
+ * Filter step of the spatial predicates
+ *
+ * Before computing the intersection of the segments of a long sequence with
+ * the geometry, the segments are classified using the Douglas-Peucker
+ * simplification of the sequence. A range of instants is approximated by the
+ * segment joining its first and last instants, and the maximum distance of
+ * the intermediate instants to this segment is kept as the error bound, so
+ * that the trajectory of the range lies within the segment buffered by the
+ * bound. Therefore, the segments of the range do not intersect the geometry
+ * when the simplified segment is farther than the bound from the geometry,
+ * and they lie in the interior of a polygonal geometry when the simplified
+ * segment intersects it and is farther than the bound from its boundary.
+ * Otherwise the range is split at the instant of maximum distance and the
+ * subranges are classified in turn, the single segments that are not
+ * classified being refined with the exact computation.
+ *****************************************************************************/
+
+/**
+ * Returns the rings of the polygonal geometry as a multilinestring, or NULL
+ * if the geometry is not polygonal
+ */
+static LWGEOM *
+lwgeom_polygon_rings(const LWGEOM *geom)
+{
+  if (geom->type != POLYGONTYPE && geom->type != MULTIPOLYGONTYPE)
+    return NULL;
+  LWCOLLECTION *result = lwcollection_construct_empty(MULTILINETYPE,
+    geom->srid, lwgeom_has_z(geom), lwgeom_has_m(geom));
+  int npolys = (geom->type == POLYGONTYPE) ? 1 :
+    ((LWMPOLY *) geom)->ngeoms;
+  for (int i = 0; i < npolys; i++)
+  {
+    LWPOLY *poly = (geom->type == POLYGONTYPE) ? (LWPOLY *) geom :
+      ((LWMPOLY *) geom)->geoms[i];
+    for (uint32_t j = 0; j < poly->nrings; j++)
+    {
+      LWLINE *ring = lwline_construct(geom->srid, NULL,
+        ptarray_clone_deep(poly->rings[j]));
+      lwcollection_add_lwgeom(result, lwline_as_lwgeom(ring));
+    }
+  }
+  return lwcollection_as_lwgeom(result);
+}
+
+/**
+ * Returns the 2D distance between the segment and the geometry
+ */
+static double
+segment_geometry_distance(const POINT2D *p1, const POINT2D *p2,
+  const LWGEOM *geom)
+{
+  POINTARRAY *pa = ptarray_construct(false, false, 2);
+  POINT4D pt;
+  pt.x = p1->x; pt.y = p1->y; pt.z = 0; pt.m = 0;
+  ptarray_set_point4d(pa, 0, &pt);
+  pt.x = p2->x; pt.y = p2->y;
+  ptarray_set_point4d(pa, 1, &pt);
+  LWLINE *line = lwline_construct(geom->srid, NULL, pa);
+  double result = lwgeom_mindistance2d(lwline_as_lwgeom(line), geom);
+  lwline_free(line);
+  return result;
+}
+
+/**
+ * Returns the classes of the segments of the temporal sequence point with
+ * respect to the geometry, or NULL if the filter step is not applied
+ *
+ * The filter step is only applied to the linear sequences with at least
+ * TPOINTSEQ_FILTER_MIN_SEGS segments and to the geometries that do not have
+ * an index of their edges, whose segments are already clipped efficiently.
+ *
+ * @param[in] seq Temporal point
+ * @param[in] geom Geometry
+ * @param[in] index Index of the edges of the geometry, NULL if none
+ * @result Array of FILTER_REJECT, FILTER_ACCEPT, or FILTER_REFINE values,
+ * one for each segment of the sequence
+ */
+char *
+tpointseq_geometry_filter(const TSequence *seq, Datum geom,
+  const EdgeIndex *index)
+{
+  if (! MOBDB_FLAGS_GET_LINEAR(seq->flags) || index != NULL ||
+    seq->count - 1 < TPOINTSEQ_FILTER_MIN_SEGS)
+    return NULL;
+
+  LWGEOM *lwgeom = lwgeom_from_gserialized(
+    (GSERIALIZED *) DatumGetPointer(geom));
+  LWGEOM *rings = lwgeom_polygon_rings(lwgeom);
+  char *result = palloc(seq->count - 1);
+  memset(result, FILTER_REFINE, seq->count - 1);
+  /* Stack of the ranges to classify, which avoids a recursion whose depth
+   * is linear in the number of instants for unbalanced splits */
+  int *stack = palloc(sizeof(int) * 2 * seq->count);
+  int top = 0;
+  stack[top++] = 0;
+  stack[top++] = seq->count - 1;
+  while (top > 0)
+  {
+    int i2 = stack[--top];
+    int i1 = stack[--top];
+    const POINT2D *p1 = datum_get_point2d_p(tinstant_value(
+      tsequence_inst_n(seq, i1)));
+    const POINT2D *p2 = datum_get_point2d_p(tinstant_value(
+      tsequence_inst_n(seq, i2)));
+    /* Error bound of the simplified segment and position of the split */
+    double bound = 0;
+    int split = (i1 + i2) / 2;
+    for (int k = i1 + 1; k < i2; k++)
+    {
+      const POINT2D *p = datum_get_point2d_p(tinstant_value(
+        tsequence_inst_n(seq, k)));
+      POINT2D closest;
+      closest_point2d_on_segment_ratio(p, p1, p2, &closest);
+      double dist = hypot(p->x - closest.x, p->y - closest.y);
+      if (dist > bound)
+      {
+        bound = dist;
+        split = k;
+      }
+    }
+    /* The tolerance absorbs the rounding errors of the distances */
+    double dist = segment_geometry_distance(p1, p2, lwgeom);
+    char segclass = FILTER_REFINE;
+    if (dist > bound + EPSILON)
+      segclass = FILTER_REJECT;
+    else if (rings != NULL && dist == 0 &&
+      segment_geometry_distance(p1, p2, rings) > bound + EPSILON)
+      segclass = FILTER_ACCEPT;
+    if (segclass != FILTER_REFINE)
+      memset(&result[i1], segclass, i2 - i1);
+    else if (split > i1)
+    {
+      stack[top++] = i1;
+      stack[top++] = split;
+      stack[top++] = split;
+      stack[top++] = i2;
+    }
+  }
+  pfree(stack);
+  if (rings != NULL)
+    lwgeom_free(rings);
+  lwgeom_free(lwgeom);
+  return result;
+}
+
 /**
  * Restricts the temporal sequence point to the geometry
  *
@@ -2936,18 +3829,58 @@ tpointseq_at_geometry2(const TSequence *seq, Datum geom, int *count)
   TSequence ***sequences = palloc(sizeof(TSequence *) * (seq->count - 1));
   int *countseqs = palloc0(sizeof(int) * (seq->count - 1));
   int totalseqs = 0;
+  /* The block boxes of the sequence, if any, are used to skip the blocks
+   * of segments that do not intersect the geometry */
+  const STBOX *blocks = tpointseq_blocks_ptr(seq);
+  STBOX box;
+  if (blocks != NULL)
+  {
+    memset(&box, 0, sizeof(STBOX));
+    geo_to_stbox_internal(&box, (GSERIALIZED *) DatumGetPointer(geom));
+  }
+  /* The polygons with many edges are clipped with an index of their edges */
+  const EdgeIndex *index = linear ?
+    edgeindex_get((GSERIALIZED *) DatumGetPointer(geom)) : NULL;
+  /* The segments classified by the filter step are not refined */
+  char *classes = tpointseq_geometry_filter(seq, geom, index);
   TInstant *inst1 = tsequence_inst_n(seq, 0);
   bool lower_inc = seq->period.lower_inc;
   for (int i = 0; i < seq->count - 1; i++)
   {
+    if (blocks != NULL && i % TPOINTSEQ_BLOCK_SIZE == 0 &&
+      ! overlaps_stbox_stbox_2d(&blocks[i / TPOINTSEQ_BLOCK_SIZE], &box))
+    {
+      /* Skip the segments of the block, countseqs[i] remains 0 */
+      i = Min(i + TPOINTSEQ_BLOCK_SIZE, seq->count - 1) - 1;
+      inst1 = tsequence_inst_n(seq, i + 1);
+      lower_inc = true;
+      continue;
+    }
     TInstant *inst2 = tsequence_inst_n(seq, i + 1);
     bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
-    sequences[i] = tpointseq_at_geometry1(inst1, inst2, linear,
-      lower_inc, upper_inc, geom, &countseqs[i]);
-    totalseqs += countseqs[i];
+    if (classes == NULL || classes[i] == FILTER_REFINE)
+    {
+      sequences[i] = tpointseq_at_geometry1(inst1, inst2, linear,
+        lower_inc, upper_inc, geom, index, &countseqs[i]);
+      totalseqs += countseqs[i];
+    }
+    else if (classes[i] == FILTER_ACCEPT)
+    {
+      TInstant *instants[2];
+      instants[0] = inst1;
+      instants[1] = inst2;
+      sequences[i] = palloc(sizeof(TSequence *));
+      sequences[i][0] = tsequence_make(instants, 2, lower_inc, upper_inc,
+        linear, NORMALIZE_NO);
+      countseqs[i] = 1;
+      totalseqs++;
+    }
+    /* Otherwise the segment is rejected and countseqs[i] remains 0 */
     inst1 = inst2;
     lower_inc = true;
   }
+  if (classes != NULL)
+    pfree(classes);
   /* Set the output parameter */
   *count = totalseqs;
   if (totalseqs == 0)
@@ -3118,6 +4051,218 @@ tpoint_restrict_geometry_internal(const Temporal *temp, Datum geom, bool atfunc)
   return result;
 }
 
+/*****************************************************************************
+ * Time during which a temporal point intersects a geometry
+ * These functions compute the same result as getTime(atGeometry(temp, geom))
+ * without constructing the restriction of the temporal point, that is,
+ * without interpolating the points at the bounds of the resulting sequences
+ *****************************************************************************/
+
+/**
+ * Add the period defined by the arguments to the array
+ */
+void
+periodarr_add(PeriodArray *arr, TimestampTz lower, TimestampTz upper,
+  bool lower_inc, bool upper_inc)
+{
+  if (arr->count == arr->size)
+  {
+    arr->size *= 2;
+    arr->periods = repalloc(arr->periods, sizeof(Period) * arr->size);
+  }
+  period_set(&arr->periods[arr->count++], lower, upper, lower_inc, upper_inc);
+}
+
+/**
+ * Returns the period set of the periods of the array, or NULL if the array
+ * is empty
+ */
+PeriodSet *
+periodarr_to_periodset(const PeriodArray *arr)
+{
+  if (arr->count == 0)
+    return NULL;
+  Period **periods = palloc(sizeof(Period *) * arr->count);
+  for (int i = 0; i < arr->count; i++)
+    periods[i] = &arr->periods[i];
+  periodarr_sort(periods, arr->count);
+  PeriodSet *result = periodset_make(periods, arr->count, NORMALIZE);
+  pfree(periods);
+  return result;
+}
+
+/**
+ * Add to the array the periods during which the segment of a temporal
+ * sequence point intersects the geometry
+ *
+ * @param[out] arr Array of periods
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] linear True when the segment has linear interpolation
+ * @param[in] lower_inc,upper_inc State whether the bounds are inclusive
+ * @param[in] geom Geometry
+ * @param[in] index Index of the edges of the geometry, NULL if none
+ * @note This function follows the same logic as tpointseq_at_geometry1
+ */
+void
+tpointseg_at_geometry_time(PeriodArray *arr, const TInstant *inst1,
+  const TInstant *inst2, bool linear, bool lower_inc, bool upper_inc,
+  Datum geom, const EdgeIndex *index)
+{
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+
+  /* Constant segment or step interpolation */
+  if (datum_point_eq(value1, value2) || ! linear)
+  {
+    if (! DatumGetBool(geom_intersects2d(value1, geom)))
+      return;
+    bool upper_inc1 = (linear) ? upper_inc : false;
+    periodarr_add(arr, inst1->t, inst2->t, lower_inc, upper_inc1);
+    if (upper_inc != upper_inc1 &&
+      DatumGetBool(geom_intersects2d(value2, geom)))
+      periodarr_add(arr, inst2->t, inst2->t, true, true);
+    return;
+  }
+
+  int countinter;
+  double *fractions = tpointseg_geometry_fractions(value1, value2,
+    datum_get_point2d_p(value1), datum_get_point2d_p(value2), geom, index,
+    &countinter);
+  double duration = (inst2->t - inst1->t);
+  for (int i = 0; i < countinter; i++)
+  {
+    TimestampTz t1 = inst1->t + (long) (duration * fractions[2 * i]);
+    TimestampTz t2 = inst1->t + (long) (duration * fractions[2 * i + 1]);
+    if (t1 == t2)
+    {
+      /* If the intersection is not at an exclusive bound */
+      if ((lower_inc || t1 > inst1->t) && (upper_inc || t1 < inst2->t))
+        periodarr_add(arr, t1, t1, true, true);
+      continue;
+    }
+    TimestampTz lower = Min(t1, t2);
+    TimestampTz upper = Max(t1, t2);
+    periodarr_add(arr, lower, upper,
+      (lower == inst1->t) ? lower_inc : true,
+      (upper == inst2->t) ? upper_inc : true);
+  }
+  if (countinter > 0)
+    pfree(fractions);
+}
+
+/**
+ * Add to the array the periods during which the temporal sequence point
+ * intersects the geometry
+ *
+ * @note This function follows the same logic as tpointseq_at_geometry2
+ */
+static void
+tpointseq_at_geometry_time(PeriodArray *arr, const TSequence *seq,
+  Datum geom)
+{
+  /* Instantaneous sequence */
+  if (seq->count == 1)
+  {
+    if (DatumGetBool(geom_intersects2d(tinstant_value(tsequence_inst_n(seq, 0)),
+        geom)))
+      periodarr_add(arr, seq->period.lower, seq->period.lower, true, true);
+    return;
+  }
+
+  /* Temporal sequence has at least 2 instants */
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  const STBOX *blocks = tpointseq_blocks_ptr(seq);
+  STBOX box;
+  if (blocks != NULL)
+  {
+    memset(&box, 0, sizeof(STBOX));
+    geo_to_stbox_internal(&box, (GSERIALIZED *) DatumGetPointer(geom));
+  }
+  const EdgeIndex *index = linear ?
+    edgeindex_get((GSERIALIZED *) DatumGetPointer(geom)) : NULL;
+  char *classes = tpointseq_geometry_filter(seq, geom, index);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  bool lower_inc = seq->period.lower_inc;
+  for (int i = 0; i < seq->count - 1; i++)
+  {
+    if (blocks != NULL && i % TPOINTSEQ_BLOCK_SIZE == 0 &&
+      ! overlaps_stbox_stbox_2d(&blocks[i / TPOINTSEQ_BLOCK_SIZE], &box))
+    {
+      /* Skip the segments of the block */
+      i = Min(i + TPOINTSEQ_BLOCK_SIZE, seq->count - 1) - 1;
+      inst1 = tsequence_inst_n(seq, i + 1);
+      lower_inc = true;
+      continue;
+    }
+    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
+    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
+    if (classes == NULL || classes[i] == FILTER_REFINE)
+      tpointseg_at_geometry_time(arr, inst1, inst2, linear, lower_inc,
+        upper_inc, geom, index);
+    else if (classes[i] == FILTER_ACCEPT)
+      periodarr_add(arr, inst1->t, inst2->t, lower_inc, upper_inc);
+    inst1 = inst2;
+    lower_inc = true;
+  }
+  if (classes != NULL)
+    pfree(classes);
+}
+
+/**
+ * Returns the time during which the temporal point intersects the geometry,
+ * or NULL if it never intersects it (internal function)
+ *
+ * @pre The arguments are of the same dimensionality, have the same SRID,
+ * and the geometry is not empty
+ */
+PeriodSet *
+tpoint_at_geometry_time_internal(const Temporal *temp, Datum geom)
+{
+  /* Bounding box test */
+  STBOX box1, box2;
+  memset(&box1, 0, sizeof(STBOX));
+  memset(&box2, 0, sizeof(STBOX));
+  temporal_bbox(&box1, temp);
+  /* Non-empty geometries have a bounding box */
+  geo_to_stbox_internal(&box2, (GSERIALIZED *) DatumGetPointer(geom));
+  if (!overlaps_stbox_stbox_internal(&box1, &box2))
+    return NULL;
+
+  PeriodArray arr;
+  arr.count = 0;
+  arr.size = 64;
+  arr.periods = palloc(sizeof(Period) * arr.size);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT || temp->duration == INSTANTSET)
+  {
+    TInstantIterator iter;
+    const TInstant *inst;
+    tinstant_iterator_init(&iter, temp);
+    while ((inst = tinstant_iterator_next(&iter)) != NULL)
+    {
+      if (DatumGetBool(call_function2(intersects, tinstant_value(inst), geom)))
+        periodarr_add(&arr, inst->t, inst->t, true, true);
+    }
+  }
+  else if (temp->duration == SEQUENCE)
+    tpointseq_at_geometry_time(&arr, (TSequence *) temp, geom);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+    {
+      TSequence *seq = tsequenceset_seq_n(ts, i);
+      /* Bounding box test */
+      if (overlaps_stbox_stbox_internal(tsequence_bbox_ptr(seq), &box2))
+        tpointseq_at_geometry_time(&arr, seq, geom);
+    }
+  }
+
+  PeriodSet *result = periodarr_to_periodset(&arr);
+  pfree(arr.periods);
+  return result;
+}
+
 /**
  * Restricts the temporal point to the (complement of the) geometry
  */
@@ -3143,8 +4288,15 @@ tpoint_restrict_geometry(FunctionCallInfo fcinfo, bool atfunc)
   }
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
-  Temporal *result = tpoint_restrict_geometry_internal(temp,
-    PointerGetDatum(gs), atfunc);
+  Temporal *result;
+  /* The restriction of very large sequences is computed in parallel chunks */
+  if (atfunc && temp->duration == SEQUENCE &&
+    tpointseq_parallel_eligible((TSequence *) temp))
+    result = tpointseq_parallel(fcinfo, (TSequence *) temp,
+      PARALLEL_AT_GEOMETRY, PointerGetDatum(gs));
+  else
+    result = tpoint_restrict_geometry_internal(temp, PointerGetDatum(gs),
+      atfunc);
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(gs, 1);
   if (result == NULL)
@@ -3175,6 +4327,345 @@ tpoint_minus_geometry(PG_FUNCTION_ARGS)
 
 /*****************************************************************************/
 
+/*****************************************************************************
+ * Restriction to a spatiotemporal box
+ * The planar temporal points are clipped against the box with the
+ * Liang-Barsky algorithm, that is, the fractions of a linear segment at which
+ * it enters and leaves the slab defined by the bounds of each dimension are
+ * computed in closed form, and the intersection of these intervals is then
+ * intersected with the period of the box. This avoids the construction of a
+ * polygon from the box and the computation of intersections with GEOS.
+ *****************************************************************************/
+
+/**
+ * Returns true if the point is inside the spatiotemporal box, bounds
+ * included, considering only the spatial dimensions
+ *
+ * @param[in] value Point
+ * @param[in] box Box
+ * @param[in] hasz True when the Z dimension is considered
+ */
+static bool
+point_in_stbox(Datum value, const STBOX *box, bool hasz)
+{
+  if (hasz)
+  {
+    const POINT3DZ *p = datum_get_point3dz_p(value);
+    return (box->xmin <= p->x && p->x <= box->xmax &&
+      box->ymin <= p->y && p->y <= box->ymax &&
+      box->zmin <= p->z && p->z <= box->zmax);
+  }
+  const POINT2D *p = datum_get_point2d_p(value);
+  return (box->xmin <= p->x && p->x <= box->xmax &&
+    box->ymin <= p->y && p->y <= box->ymax);
+}
+
+/**
+ * Restricts the fractions of a segment to those of the slab defined by
+ * the bounds of a dimension (Liang-Barsky)
+ *
+ * @param[in] p Difference between the coordinates of the end and the start
+ * of the segment, negated for the lower bound
+ * @param[in] q Distance from the start of the segment to the bound, on the
+ * side of the slab
+ * @param[in,out] fraction1,fraction2 Fractions of the segment
+ * @return False if the restricted fractions are empty
+ */
+static bool
+liang_barsky_clip(double p, double q, double *fraction1, double *fraction2)
+{
+  if (p == 0)
+    /* Parallel to the bound, inside if and only if the start is inside */
+    return q >= 0;
+  double r = q / p;
+  if (p < 0)
+  {
+    /* Entering the slab */
+    if (r > *fraction2)
+      return false;
+    if (r > *fraction1)
+      *fraction1 = r;
+  }
+  else
+  {
+    /* Leaving the slab */
+    if (r < *fraction1)
+      return false;
+    if (r < *fraction2)
+      *fraction2 = r;
+  }
+  return true;
+}
+
+/**
+ * Computes the fractions of the linear segment that are inside the spatial
+ * dimensions of the box
+ *
+ * @param[in] value1,value2 Points defining the segment
+ * @param[in] box Box
+ * @param[in] hasz True when the Z dimension is considered
+ * @param[out] fraction1,fraction2 Fractions of the segment
+ * @return False if the segment does not intersect the box
+ */
+static bool
+segment_clip_stbox(Datum value1, Datum value2, const STBOX *box, bool hasz,
+  double *fraction1, double *fraction2)
+{
+  double x1, y1, z1 = 0, x2, y2, z2 = 0;
+  if (hasz)
+  {
+    const POINT3DZ *p1 = datum_get_point3dz_p(value1);
+    const POINT3DZ *p2 = datum_get_point3dz_p(value2);
+    x1 = p1->x; y1 = p1->y; z1 = p1->z;
+    x2 = p2->x; y2 = p2->y; z2 = p2->z;
+  }
+  else
+  {
+    const POINT2D *p1 = datum_get_point2d_p(value1);
+    const POINT2D *p2 = datum_get_point2d_p(value2);
+    x1 = p1->x; y1 = p1->y;
+    x2 = p2->x; y2 = p2->y;
+  }
+  *fraction1 = 0.0;
+  *fraction2 = 1.0;
+  if (! liang_barsky_clip(x1 - x2, x1 - box->xmin, fraction1, fraction2) ||
+      ! liang_barsky_clip(x2 - x1, box->xmax - x1, fraction1, fraction2) ||
+      ! liang_barsky_clip(y1 - y2, y1 - box->ymin, fraction1, fraction2) ||
+      ! liang_barsky_clip(y2 - y1, box->ymax - y1, fraction1, fraction2))
+    return false;
+  if (hasz &&
+     (! liang_barsky_clip(z1 - z2, z1 - box->zmin, fraction1, fraction2) ||
+      ! liang_barsky_clip(z2 - z1, box->zmax - z1, fraction1, fraction2)))
+    return false;
+  return true;
+}
+
+/**
+ * Add to the array the piece of the segment of a temporal sequence point
+ * between the two timestamps
+ *
+ * @param[out] result Array of sequences
+ * @param[in] k Number of sequences of the array
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] linear True when the segment has linear interpolation
+ * @param[in] lower_inc,upper_inc State whether the bounds are inclusive
+ * @param[in] lower,upper Timestamps of the piece, included in the segment
+ * @return Number of sequences of the array
+ */
+static int
+tpointseq_at_timestamps(TSequence **result, int k, const TInstant *inst1,
+  const TInstant *inst2, bool linear, bool lower_inc, bool upper_inc,
+  TimestampTz lower, TimestampTz upper)
+{
+  bool lower_inc1 = (lower == inst1->t) ? lower_inc : true;
+  bool upper_inc1 = (upper == inst2->t) ? upper_inc : true;
+  if (lower == upper)
+  {
+    if (lower_inc1 && upper_inc1)
+    {
+      Datum point = tsequence_value_at_timestamp1(inst1, inst2, linear, lower);
+      TInstant *inst = tinstant_make(point, lower, inst1->valuetypid);
+      result[k++] = tinstant_to_tsequence(inst, linear);
+      pfree(DatumGetPointer(point)); pfree(inst);
+    }
+    return k;
+  }
+  /* A stepwise segment keeps the value of its start until its upper bound,
+   * which is then exclusive */
+  TInstant *instants[2];
+  Datum point1 = linear ?
+    tsequence_value_at_timestamp1(inst1, inst2, linear, lower) :
+    tinstant_value(inst1);
+  Datum point2 = linear ?
+    tsequence_value_at_timestamp1(inst1, inst2, linear, upper) :
+    tinstant_value(inst1);
+  instants[0] = tinstant_make(point1, lower, inst1->valuetypid);
+  instants[1] = tinstant_make(point2, upper, inst1->valuetypid);
+  result[k++] = tsequence_make(instants, 2, lower_inc1, upper_inc1,
+    linear, NORMALIZE_NO);
+  if (linear)
+  {
+    pfree(DatumGetPointer(point1)); pfree(DatumGetPointer(point2));
+  }
+  pfree(instants[0]); pfree(instants[1]);
+  return k;
+}
+
+/**
+ * Restricts the segment of a temporal sequence point to the spatiotemporal
+ * box
+ *
+ * @param[out] result Array of sequences, with space for 2 sequences
+ * @param[in] k Number of sequences of the array
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] linear True when the segment has linear interpolation
+ * @param[in] lower_inc,upper_inc State whether the bounds are inclusive
+ * @param[in] box Box, which has a spatial dimension
+ * @param[in] hasz True when the Z dimension is considered
+ * @param[in] hast True when the time dimension is considered
+ * @return Number of sequences of the array
+ */
+static int
+tpointseq_at_stbox1(TSequence **result, int k, const TInstant *inst1,
+  const TInstant *inst2, bool linear, bool lower_inc, bool upper_inc,
+  const STBOX *box, bool hasz, bool hast)
+{
+  TimestampTz tmin = hast ? Max(box->tmin, inst1->t) : inst1->t;
+  TimestampTz tmax = hast ? Min(box->tmax, inst2->t) : inst2->t;
+  if (tmin > tmax)
+    return k;
+
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  /* Constant segment or step interpolation */
+  if (! linear || datum_point_eq(value1, value2))
+  {
+    if (point_in_stbox(value1, box, hasz))
+    {
+      /* The value of a stepwise segment changes at its upper bound */
+      bool upper_inc1 = linear ? upper_inc : false;
+      k = tpointseq_at_timestamps(result, k, inst1, inst2, linear, lower_inc,
+        upper_inc1, tmin, tmax);
+    }
+    if (! linear && upper_inc && tmax == inst2->t &&
+        point_in_stbox(value2, box, hasz))
+      result[k++] = tinstant_to_tsequence(inst2, linear);
+    return k;
+  }
+
+  double fraction1, fraction2;
+  if (! segment_clip_stbox(value1, value2, box, hasz, &fraction1, &fraction2))
+    return k;
+  double duration = (inst2->t - inst1->t);
+  TimestampTz t1 = inst1->t + (long) (duration * fraction1);
+  TimestampTz t2 = inst1->t + (long) (duration * fraction2);
+  t1 = Max(t1, tmin);
+  t2 = Min(t2, tmax);
+  if (t1 > t2)
+    return k;
+  return tpointseq_at_timestamps(result, k, inst1, inst2, linear, lower_inc,
+    upper_inc, t1, t2);
+}
+
+/**
+ * Restricts the temporal sequence point to the spatiotemporal box
+ *
+ * @param[out] result Array of sequences, with space for 2 sequences per
+ * segment of the sequence
+ * @param[in] k Number of sequences of the array
+ * @param[in] seq Temporal point
+ * @param[in] box Box, which has a spatial dimension
+ * @return Number of sequences of the array
+ */
+static int
+tpointseq_at_stbox(TSequence **result, int k, const TSequence *seq,
+  const STBOX *box)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(box->flags);
+  bool hast = MOBDB_FLAGS_GET_T(box->flags);
+  /* Instantaneous sequence */
+  if (seq->count == 1)
+  {
+    TInstant *inst = tsequence_inst_n(seq, 0);
+    if (point_in_stbox(tinstant_value(inst), box, hasz) &&
+        (! hast || (box->tmin <= inst->t && inst->t <= box->tmax)))
+      result[k++] = tsequence_copy(seq);
+    return k;
+  }
+
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  /* The block boxes of the sequence, if any, are used to skip the blocks
+   * of segments that do not intersect the box */
+  const STBOX *blocks = tpointseq_blocks_ptr(seq);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  bool lower_inc = seq->period.lower_inc;
+  for (int i = 0; i < seq->count - 1; i++)
+  {
+    if (blocks != NULL && i % TPOINTSEQ_BLOCK_SIZE == 0 &&
+      ! overlaps_stbox_stbox_2d(&blocks[i / TPOINTSEQ_BLOCK_SIZE], box))
+    {
+      i = Min(i + TPOINTSEQ_BLOCK_SIZE, seq->count - 1) - 1;
+      inst1 = tsequence_inst_n(seq, i + 1);
+      lower_inc = true;
+      continue;
+    }
+    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
+    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
+    k = tpointseq_at_stbox1(result, k, inst1, inst2, linear, lower_inc,
+      upper_inc, box, hasz, hast);
+    inst1 = inst2;
+    lower_inc = true;
+  }
+  return k;
+}
+
+/**
+ * Restricts the temporal point to the spatiotemporal box with a spatial
+ * dimension
+ *
+ * @pre The temporal point is planar, the arguments are of the same
+ * dimensionality and have the same SRID
+ */
+static Temporal *
+tpoint_at_stbox_clip(const Temporal *temp, const STBOX *box)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(box->flags);
+  bool hast = MOBDB_FLAGS_GET_T(box->flags);
+  Temporal *result = NULL;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+  {
+    const TInstant *inst = (const TInstant *) temp;
+    if (point_in_stbox(tinstant_value(inst), box, hasz) &&
+        (! hast || (box->tmin <= inst->t && inst->t <= box->tmax)))
+      result = (Temporal *) tinstant_copy(inst);
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+    int k = 0;
+    for (int i = 0; i < ti->count; i++)
+    {
+      TInstant *inst = tinstantset_inst_n(ti, i);
+      if (point_in_stbox(tinstant_value(inst), box, hasz) &&
+          (! hast || (box->tmin <= inst->t && inst->t <= box->tmax)))
+        instants[k++] = inst;
+    }
+    if (k != 0)
+      result = (Temporal *) tinstantset_make(instants, k);
+    /* We cannot pfree the instants in the array */
+    pfree(instants);
+  }
+  else
+  {
+    int k = 0;
+    TSequence **sequences;
+    if (temp->duration == SEQUENCE)
+    {
+      const TSequence *seq = (const TSequence *) temp;
+      sequences = palloc(sizeof(TSequence *) * 2 * seq->count);
+      k = tpointseq_at_stbox(sequences, k, seq, box);
+    }
+    else /* temp->duration == SEQUENCESET */
+    {
+      const TSequenceSet *ts = (const TSequenceSet *) temp;
+      sequences = palloc(sizeof(TSequence *) * 2 * ts->totalcount);
+      for (int i = 0; i < ts->count; i++)
+      {
+        TSequence *seq = tsequenceset_seq_n(ts, i);
+        if (overlaps_stbox_stbox_internal(tsequence_bbox_ptr(seq), box))
+          k = tpointseq_at_stbox(sequences, k, seq, box);
+      }
+    }
+    if (k == 0)
+      pfree(sequences);
+    else
+      result = (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE);
+  }
+  return result;
+}
+
 /**
  * Restrict the temporal point to the spatiotemporal box
  *
@@ -3191,6 +4682,11 @@ tpoint_at_stbox_internal(const Temporal *temp, const STBOX *box)
   if (!overlaps_stbox_stbox_internal(box, &box1))
     return NULL;
 
+  /* The planar points are clipped directly against the box */
+  if (MOBDB_FLAGS_GET_X(box->flags) &&
+    ! MOBDB_FLAGS_GET_GEODETIC(temp->flags))
+    return tpoint_at_stbox_clip(temp, box);
+
   /* At least one of MOBDB_FLAGS_GET_T and MOBDB_FLAGS_GET_X is true */
   Temporal *temp1;
   if (MOBDB_FLAGS_GET_T(box->flags))
@@ -3263,14 +4759,35 @@ tpoint_minus_stbox_internal(const Temporal *temp, const STBOX *box)
 Datum
 tpoint_restrict_stbox(FunctionCallInfo fcinfo, bool atfunc)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Temporal *temp = (Temporal *) temporal_detoast(PG_GETARG_DATUM(0));
   STBOX *box = PG_GETARG_STBOX_P(1);
   ensure_same_geodetic_tpoint_stbox(temp, box);
   ensure_same_srid_tpoint_stbox(temp, box);
   if (MOBDB_FLAGS_GET_X(box->flags))
     ensure_same_spatial_dimensionality_tpoint_stbox(temp, box);
-  Temporal *result = atfunc ? tpoint_at_stbox_internal(temp, box) :
-    tpoint_minus_stbox_internal(temp, box);
+  Temporal *result;
+  if (atfunc && MOBDB_FLAGS_GET_PACKED(temp->flags) &&
+    ! MOBDB_FLAGS_GET_GEODETIC(temp->flags) &&
+    temporalpacked_nchunks((TemporalPacked *) temp) > 1)
+  {
+    /* Only the chunks of the packed value overlapping the box are decoded */
+    Temporal *temp1 = temporalpacked_decode_stbox((TemporalPacked *) temp,
+      box);
+    result = NULL;
+    if (temp1 != NULL)
+    {
+      result = tpoint_at_stbox_internal(temp1, box);
+      pfree(temp1);
+    }
+  }
+  else
+  {
+    Temporal *temp1 = temporal_unpack(temp);
+    result = atfunc ? tpoint_at_stbox_internal(temp1, box) :
+      tpoint_minus_stbox_internal(temp1, box);
+    if (temp1 != temp)
+      pfree(temp1);
+  }
   PG_FREE_IF_COPY(temp, 0);
   if (result == NULL)
     PG_RETURN_NULL();
@@ -37,15 +37,36 @@
  * Spatial relationship functions
  * contains and within are inverse to each other
  * covers and coveredby are inverse to each other
+ *
+ * The PostGIS functions are called with a function call information that is
+ * kept across calls. PostGIS stores in its fn_extra a cache of the argument
+ * that is repeated between consecutive calls, e.g., a prepared GEOS geometry
+ * for contains, covers, or intersects, or a tree of circles for geographies.
+ * Therefore, a constant geometry compared with every instant of a temporal
+ * point or with every row of a table is prepared only once instead of at
+ * every call.
  *****************************************************************************/
 
+/**
+ * Returns the function call information of the PostGIS function, counting
+ * the call when the counters are tracked
+ */
+static FmgrInfo *
+spatialrel_flinfo(FmgrInfo **flinfo, PGFunction func, short nargs)
+{
+  COUNTER_INC(postgis_calls);
+  return postgis_flinfo(flinfo, func, nargs);
+}
+
 /**
  * Calls the PostGIS function ST_Contains with the 2 arguments
  */
 Datum
 geom_contains(Datum geom1, Datum geom2)
 {
-  return call_function2(contains, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(contains,
+    spatialrel_flinfo(&flinfo, contains, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -54,7 +75,9 @@ geom_contains(Datum geom1, Datum geom2)
 Datum
 geom_containsproperly(Datum geom1, Datum geom2)
 {
-  return call_function2(containsproperly, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(containsproperly,
+    spatialrel_flinfo(&flinfo, containsproperly, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -63,7 +86,9 @@ geom_containsproperly(Datum geom1, Datum geom2)
 Datum
 geom_covers(Datum geom1, Datum geom2)
 {
-  return call_function2(covers, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(covers,
+    spatialrel_flinfo(&flinfo, covers, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -72,7 +97,9 @@ geom_covers(Datum geom1, Datum geom2)
 Datum
 geom_coveredby(Datum geom1, Datum geom2)
 {
-  return call_function2(coveredby, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(coveredby,
+    spatialrel_flinfo(&flinfo, coveredby, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -81,7 +108,9 @@ geom_coveredby(Datum geom1, Datum geom2)
 Datum
 geom_crosses(Datum geom1, Datum geom2)
 {
-  return call_function2(crosses, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(crosses,
+    spatialrel_flinfo(&flinfo, crosses, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -90,7 +119,9 @@ geom_crosses(Datum geom1, Datum geom2)
 Datum
 geom_disjoint(Datum geom1, Datum geom2)
 {
-  return call_function2(disjoint, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(disjoint,
+    spatialrel_flinfo(&flinfo, disjoint, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -99,7 +130,9 @@ geom_disjoint(Datum geom1, Datum geom2)
 Datum
 geom_equals(Datum geom1, Datum geom2)
 {
-  return call_function2(ST_Equals, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(ST_Equals,
+    spatialrel_flinfo(&flinfo, ST_Equals, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -108,7 +141,15 @@ geom_equals(Datum geom1, Datum geom2)
 Datum
 geom_intersects2d(Datum geom1, Datum geom2)
 {
-  return call_function2(intersects, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  if (datum_point_pair(geom1, geom2))
+  {
+    const POINT2D *p1 = datum_get_point2d_p(geom1);
+    const POINT2D *p2 = datum_get_point2d_p(geom2);
+    return BoolGetDatum(p1->x == p2->x && p1->y == p2->y);
+  }
+  return CallerFInfoFunctionCall2(intersects,
+    spatialrel_flinfo(&flinfo, intersects, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -117,7 +158,16 @@ geom_intersects2d(Datum geom1, Datum geom2)
 Datum
 geom_intersects3d(Datum geom1, Datum geom2)
 {
-  return call_function2(intersects3d, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  if (datum_point_pair(geom1, geom2) &&
+    FLAGS_GET_Z(((GSERIALIZED *) DatumGetPointer(geom1))->flags))
+  {
+    const POINT3DZ *p1 = datum_get_point3dz_p(geom1);
+    const POINT3DZ *p2 = datum_get_point3dz_p(geom2);
+    return BoolGetDatum(p1->x == p2->x && p1->y == p2->y && p1->z == p2->z);
+  }
+  return CallerFInfoFunctionCall2(intersects3d,
+    spatialrel_flinfo(&flinfo, intersects3d, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -126,7 +176,9 @@ geom_intersects3d(Datum geom1, Datum geom2)
 Datum
 geom_overlaps(Datum geom1, Datum geom2)
 {
-  return call_function2(overlaps, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(overlaps,
+    spatialrel_flinfo(&flinfo, overlaps, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -135,7 +187,9 @@ geom_overlaps(Datum geom1, Datum geom2)
 Datum
 geom_touches(Datum geom1, Datum geom2)
 {
-  return call_function2(touches, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(touches,
+    spatialrel_flinfo(&flinfo, touches, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -144,7 +198,9 @@ geom_touches(Datum geom1, Datum geom2)
 Datum
 geom_within(Datum geom1, Datum geom2)
 {
-  return call_function2(contains, geom2, geom1);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(contains,
+    spatialrel_flinfo(&flinfo, contains, 2), InvalidOid, geom2, geom1);
 }
 
 /**
@@ -153,7 +209,14 @@ geom_within(Datum geom1, Datum geom2)
 Datum
 geom_dwithin2d(Datum geom1, Datum geom2, Datum dist)
 {
-  return call_function3(LWGEOM_dwithin, geom1, geom2, dist);
+  static FmgrInfo *flinfo = NULL;
+  /* A negative distance is passed to PostGIS, which raises an error */
+  if (DatumGetFloat8(dist) >= 0.0 && datum_point_pair(geom1, geom2))
+    return BoolGetDatum(DatumGetFloat8(pt_distance2d(geom1, geom2)) <=
+      DatumGetFloat8(dist));
+  return CallerFInfoFunctionCall3(LWGEOM_dwithin,
+    spatialrel_flinfo(&flinfo, LWGEOM_dwithin, 3), InvalidOid, geom1, geom2,
+    dist);
 }
 
 /**
@@ -162,7 +225,15 @@ geom_dwithin2d(Datum geom1, Datum geom2, Datum dist)
 Datum
 geom_dwithin3d(Datum geom1, Datum geom2, Datum dist)
 {
-  return call_function3(LWGEOM_dwithin3d, geom1, geom2, dist);
+  static FmgrInfo *flinfo = NULL;
+  /* A negative distance is passed to PostGIS, which raises an error */
+  if (DatumGetFloat8(dist) >= 0.0 && datum_point_pair(geom1, geom2) &&
+    FLAGS_GET_Z(((GSERIALIZED *) DatumGetPointer(geom1))->flags))
+    return BoolGetDatum(DatumGetFloat8(pt_distance3d(geom1, geom2)) <=
+      DatumGetFloat8(dist));
+  return CallerFInfoFunctionCall3(LWGEOM_dwithin3d,
+    spatialrel_flinfo(&flinfo, LWGEOM_dwithin3d, 3), InvalidOid, geom1, geom2,
+    dist);
 }
 
 /**
@@ -171,7 +242,9 @@ geom_dwithin3d(Datum geom1, Datum geom2, Datum dist)
 Datum
 geom_relate(Datum geom1, Datum geom2)
 {
-  return call_function2(relate_full, geom1, geom2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(relate_full,
+    spatialrel_flinfo(&flinfo, relate_full, 2), InvalidOid, geom1, geom2);
 }
 
 /**
@@ -180,7 +253,10 @@ geom_relate(Datum geom1, Datum geom2)
 Datum
 geom_relate_pattern(Datum geom1, Datum geom2, Datum pattern)
 {
-  return call_function3(relate_pattern, geom1, geom2, pattern);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall3(relate_pattern,
+    spatialrel_flinfo(&flinfo, relate_pattern, 3), InvalidOid, geom1, geom2,
+    pattern);
 }
 
 /*****************************************************************************/
@@ -191,7 +267,9 @@ geom_relate_pattern(Datum geom1, Datum geom2, Datum pattern)
 Datum
 geog_covers(Datum geog1, Datum geog2)
 {
-  return call_function2(geography_covers, geog1, geog2);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(geography_covers,
+    spatialrel_flinfo(&flinfo, geography_covers, 2), InvalidOid, geog1, geog2);
 }
 
 /**
@@ -200,7 +278,9 @@ geog_covers(Datum geog1, Datum geog2)
 Datum
 geog_coveredby(Datum geog1, Datum geog2)
 {
-  return call_function2(geography_covers, geog2, geog1);
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall2(geography_covers,
+    spatialrel_flinfo(&flinfo, geography_covers, 2), InvalidOid, geog2, geog1);
 }
 
 /**
@@ -211,6 +291,7 @@ geog_intersects(Datum geog1, Datum geog2)
 {
   /* We apply the same threshold as PostGIS in the definition of the
    * function ST_Intersects(geography, geography) */
+  COUNTER_INC(postgis_calls);
   double dist = DatumGetFloat8(geog_distance(geog1, geog2));
   return BoolGetDatum(dist < DIST_EPSILON);
 }
@@ -221,8 +302,10 @@ geog_intersects(Datum geog1, Datum geog2)
 Datum
 geog_dwithin(Datum geog1, Datum geog2, Datum dist)
 {
-  return CallerFInfoFunctionCall4(geography_dwithin, (fetch_fcinfo())->flinfo,
-    InvalidOid, geog1, geog2, dist, BoolGetDatum(true));
+  static FmgrInfo *flinfo = NULL;
+  return CallerFInfoFunctionCall4(geography_dwithin,
+    spatialrel_flinfo(&flinfo, geography_dwithin, 4), InvalidOid, geog1, geog2,
+    dist, BoolGetDatum(geodetic_use_spheroid));
 }
 
 /*****************************************************************************
@@ -356,6 +439,9 @@ spatialrel(Datum value1, Datum value2, Datum param, LiftedFunctionInfo lfinfo)
 /**
  * Generic spatial relationships for a temporal point and a geometry
  *
+ * @param[in] fcinfo Catalog information about the external function, in
+ * which the trajectory of the temporal point is cached when it is built
+ * on demand
  * @param[in] temp Temporal point
  * @param[in] gs Geometry
  * @param[in] param Parameter
@@ -365,9 +451,9 @@ spatialrel(Datum value1, Datum value2, Datum param, LiftedFunctionInfo lfinfo)
  * @param[in] invert True if the arguments should be inverted
  */
 Datum
-spatialrel_tpoint_geo1(Temporal *temp, GSERIALIZED *gs, Datum param,
-  Datum (*geomfunc)(Datum, ...), Datum (*geogfunc)(Datum, ...),
-  int numparam, bool invert)
+spatialrel_tpoint_geo1(FunctionCallInfo fcinfo, Temporal *temp,
+  GSERIALIZED *gs, Datum param, Datum (*geomfunc)(Datum, ...),
+  Datum (*geogfunc)(Datum, ...), int numparam, bool invert)
 {
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
@@ -376,7 +462,8 @@ spatialrel_tpoint_geo1(Temporal *temp, GSERIALIZED *gs, Datum param,
      assert (geogfunc != NULL);
   else
      assert (geomfunc != NULL);
-  Datum traj = tpoint_trajectory_internal(temp);
+  bool tofree;
+  Datum traj = tpoint_trajectory_cached(fcinfo->flinfo, temp, &tofree);
   /* We only need to fill these parameters for function spatialrel */
   LiftedFunctionInfo lfinfo;
   lfinfo.func = isgeod ? geogfunc : geomfunc;
@@ -384,7 +471,8 @@ spatialrel_tpoint_geo1(Temporal *temp, GSERIALIZED *gs, Datum param,
   lfinfo.invert = invert;
   lfinfo.discont = DISCONTINUOUS;
   Datum result = spatialrel(traj, PointerGetDatum(gs), param, lfinfo);
-  pfree(DatumGetPointer(traj));
+  if (tofree)
+    pfree(DatumGetPointer(traj));
   return result;
 }
 
@@ -405,10 +493,8 @@ spatialrel_geo_tpoint(FunctionCallInfo fcinfo, Datum (*geomfunc)(Datum, ...),
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(1);
   Datum param = (numparam == 2) ? (Datum) NULL : PG_GETARG_DATUM(2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
-  Datum result = spatialrel_tpoint_geo1(temp, gs, param, geomfunc, geogfunc,
-    numparam, INVERT);
+  Datum result = spatialrel_tpoint_geo1(fcinfo, temp, gs, param, geomfunc,
+    geogfunc, numparam, INVERT);
   PG_FREE_IF_COPY(gs, 0);
   PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_DATUM(result);
@@ -431,10 +517,8 @@ spatialrel_tpoint_geo(FunctionCallInfo fcinfo, Datum (*geomfunc)(Datum, ...),
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   Datum param = (numparam == 2) ? (Datum) NULL : PG_GETARG_DATUM(2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
-  Datum result = spatialrel_tpoint_geo1(temp, gs, param, geomfunc, geogfunc,
-    numparam, INVERT_NO);
+  Datum result = spatialrel_tpoint_geo1(fcinfo, temp, gs, param, geomfunc,
+    geogfunc, numparam, INVERT_NO);
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(gs, 1);
   PG_RETURN_DATUM(result);
@@ -468,8 +552,6 @@ spatialrel_tpoint_tpoint(FunctionCallInfo fcinfo, Datum (*geomfunc)(Datum, ...),
   }
   Datum traj1 = tpoint_trajectory_internal(inter1);
   Datum traj2 = tpoint_trajectory_internal(inter2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
 
   bool isgeod = MOBDB_FLAGS_GET_GEODETIC(temp1->flags);
   if (isgeod)
@@ -949,8 +1031,6 @@ dwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
   else
     func = MOBDB_FLAGS_GET_Z(temp1->flags) ? &geom_dwithin3d :
       &geom_dwithin2d;
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
 
   bool result;
   ensure_valid_duration(sync1->duration);
@@ -93,13 +93,6 @@
 #include "tpoint_boxops.h"
 #include "tpoint_gist.h"
 
-#if MOBDB_PGSQL_VERSION >= 120000
-/* To avoid including "access/spgist_private.h" since it conflicts with the
- * EPSILON constant defined there and also in MobilityDB */
-extern double *spg_key_orderbys_distances(Datum key, bool isLeaf, ScanKey orderbys,
-  int norderbys);
-#endif
-
 /*****************************************************************************/
 
 /**
@@ -435,9 +428,11 @@ overAfter8D(const CubeSTbox *cube_box, const STBOX *query)
 #if MOBDB_PGSQL_VERSION >= 110000
 /**
  * Lower bound for the distance between query and cube_box.
- * @note The temporal dimension is not taken into the account since it is not
- * possible to mix different units in the computation. As a consequence, the
- * filtering is not very restrictive.
+ * @note The temporal dimension is not mixed with the spatial ones since they
+ * have different units. Instead, as for the nearest approach distance, when
+ * the query has a temporal dimension and no box of the cube can overlap its
+ * timespan the distance is infinite, so that these nodes are never visited
+ * before the ones overlapping the timespan.
  */
 static double
 distanceBoxCubeBox(const STBOX *query, const CubeSTbox *cube_box)
@@ -445,6 +440,10 @@ distanceBoxCubeBox(const STBOX *query, const CubeSTbox *cube_box)
   double dx, dy, dz;
   bool hasz = MOBDB_FLAGS_GET_Z(cube_box->left.flags);
 
+  if (MOBDB_FLAGS_GET_T(query->flags) &&
+      (cube_box->left.tmin > query->tmax || cube_box->right.tmax < query->tmin))
+    return DBL_MAX;
+
   if (query->xmax < cube_box->left.xmin)
     dx = cube_box->left.xmin - query->xmax;
   else if (query->xmin > cube_box->right.xmax)
@@ -640,6 +639,307 @@ stbox_spgist_picksplit(PG_FUNCTION_ARGS)
  * SP-GiST inner consistent functions
  *****************************************************************************/
 
+/**
+ * Transform the queries into bounding boxes initializing the dimensions
+ * that must not be taken into account for the operators to infinity.
+ * This transformation is done once per inner tuple to avoid doing it for
+ * all its nodes. It is applied to both the scan keys and the ordering keys.
+ */
+static STBOX *
+stbox_spgist_queries(const ScanKey scankeys, int nkeys)
+{
+  STBOX *queries = (STBOX *) palloc0(sizeof(STBOX) * Max(nkeys, 1));
+  for (int i = 0; i < nkeys; i++)
+  {
+    Oid subtype = scankeys[i].sk_subtype;
+    if (tgeo_base_type(subtype))
+      /* We do not test the return value of the next function since
+         if the result is false all dimensions of the box have been
+         initialized to +-infinity */
+      geo_to_stbox_internal(&queries[i],
+        (GSERIALIZED*)PG_DETOAST_DATUM(scankeys[i].sk_argument));
+    else if (subtype == type_oid(T_STBOX))
+      memcpy(&queries[i], DatumGetSTboxP(scankeys[i].sk_argument), sizeof(STBOX));
+    else if (tgeo_type(subtype))
+      temporal_bbox(&queries[i],
+        DatumGetTemporal(scankeys[i].sk_argument));
+    else
+      elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+  }
+  return queries;
+}
+
+/**
+ * Can any box bounded by cube_box satisfy all the scan keys?
+ */
+static bool
+cubestbox_consistent(const CubeSTbox *cube_box, const STBOX *queries,
+  const ScanKey scankeys, int nkeys)
+{
+  bool flag = true;
+  for (int i = 0; i < nkeys; i++)
+  {
+    StrategyNumber strategy = scankeys[i].sk_strategy;
+    switch (strategy)
+    {
+      case RTOverlapStrategyNumber:
+      case RTContainedByStrategyNumber:
+      case RTAdjacentStrategyNumber:
+        flag = overlap8D(cube_box, &queries[i]);
+        break;
+      case RTContainsStrategyNumber:
+      case RTSameStrategyNumber:
+        flag = contain8D(cube_box, &queries[i]);
+        break;
+      case RTLeftStrategyNumber:
+        flag = !overRight8D(cube_box, &queries[i]);
+        break;
+      case RTOverLeftStrategyNumber:
+        flag = !right8D(cube_box, &queries[i]);
+        break;
+      case RTRightStrategyNumber:
+        flag = !overLeft8D(cube_box, &queries[i]);
+        break;
+      case RTOverRightStrategyNumber:
+        flag = !left8D(cube_box, &queries[i]);
+        break;
+      case RTFrontStrategyNumber:
+        flag = !overBack8D(cube_box, &queries[i]);
+        break;
+      case RTOverFrontStrategyNumber:
+        flag = !back8D(cube_box, &queries[i]);
+        break;
+      case RTBackStrategyNumber:
+        flag = !overFront8D(cube_box, &queries[i]);
+        break;
+      case RTOverBackStrategyNumber:
+        flag = !front8D(cube_box, &queries[i]);
+        break;
+      case RTAboveStrategyNumber:
+        flag = !overBelow8D(cube_box, &queries[i]);
+        break;
+      case RTOverAboveStrategyNumber:
+        flag = !below8D(cube_box, &queries[i]);
+        break;
+      case RTBelowStrategyNumber:
+        flag = !overAbove8D(cube_box, &queries[i]);
+        break;
+      case RTOverBelowStrategyNumber:
+        flag = !above8D(cube_box, &queries[i]);
+        break;
+      case RTAfterStrategyNumber:
+        flag = !overBefore8D(cube_box, &queries[i]);
+        break;
+      case RTOverAfterStrategyNumber:
+        flag = !before8D(cube_box, &queries[i]);
+        break;
+      case RTBeforeStrategyNumber:
+        flag = !overAfter8D(cube_box, &queries[i]);
+        break;
+      case RTOverBeforeStrategyNumber:
+        flag = !after8D(cube_box, &queries[i]);
+        break;
+      default:
+        elog(ERROR, "unrecognized strategy: %d", strategy);
+    }
+
+    /* If any check is failed, we have found our answer. */
+    if (!flag)
+      break;
+  }
+  return flag;
+}
+
+/**
+ * Report that all nodes of an inner tuple whose nodes are all the same
+ * should be visited
+ */
+static void
+stbox_spgist_all_nodes(const spgInnerConsistentIn *in,
+  spgInnerConsistentOut *out, const CubeSTbox *cube_box)
+{
+  out->nNodes = in->nNodes;
+  out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
+  for (int i = 0; i < in->nNodes; i++)
+    out->nodeNumbers[i] = i;
+
+#if MOBDB_PGSQL_VERSION >= 120000
+  if (in->norderbys > 0 && in->nNodes > 0)
+  {
+    STBOX *orderbys = stbox_spgist_queries(in->orderbys, in->norderbys);
+    double *distances = palloc(sizeof(double) * in->norderbys);
+    for (int j = 0; j < in->norderbys; j++)
+      distances[j] = distanceBoxCubeBox(&orderbys[j], cube_box);
+    pfree(orderbys);
+
+    out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+    out->distances[0] = distances;
+
+    for (int i = 1; i < in->nNodes; i++)
+    {
+      out->distances[i] = palloc(sizeof(double) * in->norderbys);
+      memcpy(out->distances[i], distances,
+        sizeof(double) * in->norderbys);
+    }
+  }
+#endif
+
+  return;
+}
+
+/**
+ * Structure to represent the bounds of the children of an inner node that
+ * are tested by the scan keys. Since every bit of the octant of a child
+ * splits the range of one coordinate of the 8D points at the centroid, the
+ * bounds only depend on the value of that bit, given in the index of the
+ * arrays.
+ */
+typedef struct
+{
+  STBOX lo[2];   /**< Lower bounds of the xmin, ymin, zmin, tmin ranges */
+  STBOX hi[2];   /**< Upper bounds of the xmax, ymax, zmax, tmax ranges */
+} OctantBounds;
+
+/**
+ * Compute the bounds of the children of the inner node from its traversal
+ * value and its centroid
+ */
+static void
+octant_bounds(OctantBounds *bounds, const CubeSTbox *cube_box,
+  const STBOX *centroid)
+{
+  bounds->lo[0] = bounds->lo[1] = cube_box->left;
+  bounds->hi[0] = bounds->hi[1] = cube_box->right;
+  bounds->lo[1].xmin = centroid->xmin;
+  bounds->lo[1].ymin = centroid->ymin;
+  bounds->lo[1].tmin = centroid->tmin;
+  bounds->hi[0].xmax = centroid->xmax;
+  bounds->hi[0].ymax = centroid->ymax;
+  bounds->hi[0].tmax = centroid->tmax;
+  if (MOBDB_FLAGS_GET_Z(centroid->flags))
+  {
+    bounds->lo[1].zmin = centroid->zmin;
+    bounds->hi[0].zmax = centroid->zmax;
+  }
+  return;
+}
+
+/**
+ * Returns the bits of the octants for which the children whose bit has
+ * the given value can satisfy the scan key
+ *
+ * The predicates are those of the functions overlap8D, contain8D, etc.
+ * decomposed into the tests on the range of a single coordinate, which
+ * are computed once per inner node instead of once per child.
+ *
+ * @param[in] bounds Bounds of the children
+ * @param[in] b Value of the bits, 0 or 1
+ * @param[in] query Box of the scan key
+ * @param[in] strategy Strategy of the scan key
+ */
+static uint8
+octant_mask(const OctantBounds *bounds, int b, const STBOX *query,
+  StrategyNumber strategy)
+{
+  const STBOX *lo = &bounds->lo[b], *hi = &bounds->hi[b];
+  uint8 fail = 0;
+  switch (strategy)
+  {
+    case RTOverlapStrategyNumber:
+    case RTContainedByStrategyNumber:
+    case RTAdjacentStrategyNumber:
+      if (MOBDB_FLAGS_GET_X(query->flags))
+      {
+        if (lo->xmin > query->xmax) fail |= 0x08;
+        if (hi->xmax < query->xmin) fail |= 0x04;
+        if (lo->ymin > query->ymax) fail |= 0x20;
+        if (hi->ymax < query->ymin) fail |= 0x10;
+      }
+      if (MOBDB_FLAGS_GET_Z(query->flags))
+      {
+        if (lo->zmin > query->zmax) fail |= 0x80;
+        if (hi->zmax < query->zmin) fail |= 0x40;
+      }
+      if (MOBDB_FLAGS_GET_T(query->flags))
+      {
+        if (lo->tmin > query->tmax) fail |= 0x02;
+        if (hi->tmax < query->tmin) fail |= 0x01;
+      }
+      break;
+    case RTContainsStrategyNumber:
+    case RTSameStrategyNumber:
+      if (MOBDB_FLAGS_GET_X(query->flags))
+      {
+        if (hi->xmax < query->xmax) fail |= 0x04;
+        if (lo->xmin > query->xmin) fail |= 0x08;
+        if (hi->ymax < query->ymax) fail |= 0x10;
+        if (lo->ymin > query->ymin) fail |= 0x20;
+      }
+      if (MOBDB_FLAGS_GET_Z(query->flags))
+      {
+        if (hi->zmax < query->zmax) fail |= 0x40;
+        if (lo->zmin > query->zmin) fail |= 0x80;
+      }
+      if (MOBDB_FLAGS_GET_T(query->flags))
+      {
+        if (hi->tmax < query->tmax) fail |= 0x01;
+        if (lo->tmin > query->tmin) fail |= 0x02;
+      }
+      break;
+    case RTLeftStrategyNumber:
+      if (lo->xmin >= query->xmin) fail |= 0x08;
+      break;
+    case RTOverLeftStrategyNumber:
+      if (lo->xmin > query->xmax) fail |= 0x08;
+      break;
+    case RTRightStrategyNumber:
+      if (hi->xmax <= query->xmax) fail |= 0x04;
+      break;
+    case RTOverRightStrategyNumber:
+      if (hi->xmax < query->xmin) fail |= 0x04;
+      break;
+    case RTFrontStrategyNumber:
+      if (lo->zmin >= query->zmin) fail |= 0x80;
+      break;
+    case RTOverFrontStrategyNumber:
+      if (lo->zmin > query->zmax) fail |= 0x80;
+      break;
+    case RTBackStrategyNumber:
+      if (hi->zmax <= query->zmax) fail |= 0x40;
+      break;
+    case RTOverBackStrategyNumber:
+      if (hi->zmax < query->zmin) fail |= 0x40;
+      break;
+    case RTAboveStrategyNumber:
+      if (hi->ymax <= query->ymax) fail |= 0x10;
+      break;
+    case RTOverAboveStrategyNumber:
+      if (hi->ymax < query->ymin) fail |= 0x10;
+      break;
+    case RTBelowStrategyNumber:
+      if (lo->ymin >= query->ymin) fail |= 0x20;
+      break;
+    case RTOverBelowStrategyNumber:
+      if (lo->ymin > query->ymax) fail |= 0x20;
+      break;
+    case RTAfterStrategyNumber:
+      if (hi->tmax <= query->tmax) fail |= 0x01;
+      break;
+    case RTOverAfterStrategyNumber:
+      if (hi->tmax < query->tmin) fail |= 0x01;
+      break;
+    case RTBeforeStrategyNumber:
+      if (lo->tmin >= query->tmin) fail |= 0x02;
+      break;
+    case RTOverBeforeStrategyNumber:
+      if (lo->tmin > query->tmax) fail |= 0x02;
+      break;
+    default:
+      elog(ERROR, "unrecognized strategy: %d", strategy);
+  }
+  return (uint8) ~fail;
+}
+
 PG_FUNCTION_INFO_V1(stbox_spgist_inner_consistent);
 /**
  * SP-GiST inner consistent functions for temporal points
@@ -649,7 +949,6 @@ stbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
 {
   spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
   spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
-  int  i;
   MemoryContext old_ctx;
   CubeSTbox *cube_box;
   uint16 octant;
@@ -666,69 +965,386 @@ stbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
 
   if (in->allTheSame)
   {
-    /* Report that all nodes should be visited */
-    out->nNodes = in->nNodes;
-    out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
-    for (i = 0; i < in->nNodes; i++)
-      out->nodeNumbers[i] = i;
+    stbox_spgist_all_nodes(in, out, cube_box);
+    PG_RETURN_VOID();
+  }
 
+  queries = stbox_spgist_queries(in->scankeys, in->nkeys);
+
+  /* Allocate enough memory for nodes */
+  out->nNodes = 0;
+  out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
+  out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
 #if MOBDB_PGSQL_VERSION >= 120000
-    if (in->norderbys > 0 && in->nNodes > 0)
+  STBOX *orderbys = NULL;
+  if (in->norderbys > 0)
+  {
+    out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+    orderbys = stbox_spgist_queries(in->orderbys, in->norderbys);
+  }
+#endif
+  /*
+   * We switch memory context, because we want to allocate memory for new
+   * traversal values (next_cube_box) and pass these pieces of memory to
+   * further call of this function.
+   */
+  old_ctx = MemoryContextSwitchTo(in->traversalMemoryContext);
+
+  /*
+   * Combine the tests of the scan keys into the bits that the octants of
+   * the selected nodes may have set (allow1) or unset (allow0), so that
+   * the traversal values are only computed for the selected nodes.
+   */
+  OctantBounds bounds;
+  octant_bounds(&bounds, cube_box, centroid);
+  uint8 allow0 = 0xFF, allow1 = 0xFF;
+  for (int i = 0; i < in->nkeys; i++)
+  {
+    StrategyNumber strategy = in->scankeys[i].sk_strategy;
+    allow0 &= octant_mask(&bounds, 0, &queries[i], strategy);
+    allow1 &= octant_mask(&bounds, 1, &queries[i], strategy);
+  }
+
+  for (octant = 0; octant < in->nNodes; octant++)
+  {
+    if ((~octant & ~allow0 & 0xFF) != 0 || (octant & ~allow1 & 0xFF) != 0)
+      continue;
+    CubeSTbox *next_cube_box = nextCubeSTbox(cube_box, centroid, (uint8) octant);
+    out->traversalValues[out->nNodes] = next_cube_box;
+    out->nodeNumbers[out->nNodes] = octant;
+#if MOBDB_PGSQL_VERSION >= 120000
+    if (in->norderbys > 0)
     {
       double *distances = palloc(sizeof(double) * in->norderbys);
+      out->distances[out->nNodes] = distances;
       for (int j = 0; j < in->norderbys; j++)
-      {
-        STBOX *box = DatumGetSTboxP(in->orderbys[j].sk_argument);
-        distances[j] = distanceBoxCubeBox(box, cube_box);
-      }
+        distances[j] = distanceBoxCubeBox(&orderbys[j], next_cube_box);
+    }
+#endif
+    out->nNodes++;
+  }
 
-      out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
-      out->distances[0] = distances;
+  /* Switch after */
+  MemoryContextSwitchTo(old_ctx);
 
-      for (i = 1; i < in->nNodes; i++)
-      {
-        out->distances[i] = palloc(sizeof(double) * in->norderbys);
-        memcpy(out->distances[i], distances,
-          sizeof(double) * in->norderbys);
-      }
-    }
+  pfree(queries);
+#if MOBDB_PGSQL_VERSION >= 120000
+  if (orderbys != NULL)
+    pfree(orderbys);
 #endif
 
-    PG_RETURN_VOID();
+  PG_RETURN_VOID();
+}
+
+/*****************************************************************************
+ * Kd-tree SP-GiST functions
+ *
+ * Alternative strategy where the 8D points representing the boxes are
+ * split one coordinate at a time, cycling over the lower corner and then
+ * the upper corner coordinates in the order x/y/z/t depending on the level
+ * of the tree.  Every inner node has only two children, those with a value
+ * up to the median of the split coordinate and those with a value from the
+ * median, which yields shallower fan-outs and smaller inner tuples than the
+ * oct-tree above.  The config, leaf consistent, and compress functions are
+ * shared with the oct-tree.
+ *****************************************************************************/
+
+/**
+ * Coordinate of the 8D point representing a box
+ */
+typedef enum
+{
+  KD_XMIN,
+  KD_YMIN,
+  KD_ZMIN,
+  KD_TMIN,
+  KD_XMAX,
+  KD_YMAX,
+  KD_ZMAX,
+  KD_TMAX
+} KdCoord;
+
+/**
+ * Structure to sort the boxes on a coordinate while keeping track of their
+ * position in the input array
+ */
+typedef struct
+{
+  STBOX *box;
+  int i;
+} SortedSTbox;
+
+/**
+ * Returns the coordinate split at the level of the tree
+ */
+static KdCoord
+kdtree_coord(int level, bool hasz)
+{
+  static const KdCoord coords2D[] =
+    {KD_XMIN, KD_YMIN, KD_TMIN, KD_XMAX, KD_YMAX, KD_TMAX};
+  static const KdCoord coords3D[] =
+    {KD_XMIN, KD_YMIN, KD_ZMIN, KD_TMIN, KD_XMAX, KD_YMAX, KD_ZMAX, KD_TMAX};
+  return hasz ? coords3D[level % 8] : coords2D[level % 6];
+}
+
+/**
+ * Compare the two boxes on the coordinate
+ */
+static int
+kdtree_cmp(const STBOX *box1, const STBOX *box2, KdCoord coord)
+{
+  double d1, d2;
+  switch (coord)
+  {
+    case KD_TMIN:
+      return timestamp_cmp_internal(box1->tmin, box2->tmin);
+    case KD_TMAX:
+      return timestamp_cmp_internal(box1->tmax, box2->tmax);
+    case KD_XMIN:
+      d1 = box1->xmin; d2 = box2->xmin;
+      break;
+    case KD_YMIN:
+      d1 = box1->ymin; d2 = box2->ymin;
+      break;
+    case KD_ZMIN:
+      d1 = box1->zmin; d2 = box2->zmin;
+      break;
+    case KD_XMAX:
+      d1 = box1->xmax; d2 = box2->xmax;
+      break;
+    case KD_YMAX:
+      d1 = box1->ymax; d2 = box2->ymax;
+      break;
+    default: /* KD_ZMAX */
+      d1 = box1->zmax; d2 = box2->zmax;
+      break;
+  }
+  return compareDoubles(&d1, &d2);
+}
+
+/**
+ * Comparator of the boxes on the coordinate passed as argument
+ */
+static int
+kdtree_sorted_cmp(const void *a, const void *b, void *arg)
+{
+  const SortedSTbox *sa = (const SortedSTbox *) a;
+  const SortedSTbox *sb = (const SortedSTbox *) b;
+  return kdtree_cmp(sa->box, sb->box, *(KdCoord *) arg);
+}
+
+/**
+ * Copy the coordinate of the box into the centroid
+ */
+static void
+kdtree_set_coord(STBOX *centroid, const STBOX *box, KdCoord coord)
+{
+  switch (coord)
+  {
+    case KD_XMIN: centroid->xmin = box->xmin; break;
+    case KD_YMIN: centroid->ymin = box->ymin; break;
+    case KD_ZMIN: centroid->zmin = box->zmin; break;
+    case KD_TMIN: centroid->tmin = box->tmin; break;
+    case KD_XMAX: centroid->xmax = box->xmax; break;
+    case KD_YMAX: centroid->ymax = box->ymax; break;
+    case KD_ZMAX: centroid->zmax = box->zmax; break;
+    case KD_TMAX: centroid->tmax = box->tmax; break;
+  }
+  return;
+}
+
+/**
+ * Calculate the next traversal value of the kd-tree
+ *
+ * The children of node 0 have a coordinate up to the one of the centroid
+ * and the children of node 1 have a coordinate from the one of the centroid.
+ */
+static CubeSTbox *
+nextKdCubeSTbox(const CubeSTbox *cube_box, const STBOX *centroid,
+  KdCoord coord, int node)
+{
+  CubeSTbox *next_cube_box = (CubeSTbox *) palloc0(sizeof(CubeSTbox));
+
+  memcpy(next_cube_box, cube_box, sizeof(CubeSTbox));
+
+  switch (coord)
+  {
+    case KD_XMIN:
+      if (node)
+        next_cube_box->left.xmin = centroid->xmin;
+      else
+        next_cube_box->left.xmax = centroid->xmin;
+      break;
+    case KD_YMIN:
+      if (node)
+        next_cube_box->left.ymin = centroid->ymin;
+      else
+        next_cube_box->left.ymax = centroid->ymin;
+      break;
+    case KD_ZMIN:
+      if (node)
+        next_cube_box->left.zmin = centroid->zmin;
+      else
+        next_cube_box->left.zmax = centroid->zmin;
+      break;
+    case KD_TMIN:
+      if (node)
+        next_cube_box->left.tmin = centroid->tmin;
+      else
+        next_cube_box->left.tmax = centroid->tmin;
+      break;
+    case KD_XMAX:
+      if (node)
+        next_cube_box->right.xmin = centroid->xmax;
+      else
+        next_cube_box->right.xmax = centroid->xmax;
+      break;
+    case KD_YMAX:
+      if (node)
+        next_cube_box->right.ymin = centroid->ymax;
+      else
+        next_cube_box->right.ymax = centroid->ymax;
+      break;
+    case KD_ZMAX:
+      if (node)
+        next_cube_box->right.zmin = centroid->zmax;
+      else
+        next_cube_box->right.zmax = centroid->zmax;
+      break;
+    case KD_TMAX:
+      if (node)
+        next_cube_box->right.tmin = centroid->tmax;
+      else
+        next_cube_box->right.tmax = centroid->tmax;
+      break;
   }
 
+  return next_cube_box;
+}
+
+PG_FUNCTION_INFO_V1(stbox_kdtree_choose);
+/**
+ * Kd-tree SP-GiST choose function for temporal points
+ */
+PGDLLEXPORT Datum
+stbox_kdtree_choose(PG_FUNCTION_ARGS)
+{
+  spgChooseIn *in = (spgChooseIn *) PG_GETARG_POINTER(0);
+  spgChooseOut *out = (spgChooseOut *) PG_GETARG_POINTER(1);
+  STBOX *centroid = DatumGetSTboxP(in->prefixDatum),
+    *box = DatumGetSTboxP(in->leafDatum);
+  KdCoord coord = kdtree_coord(in->level, MOBDB_FLAGS_GET_Z(centroid->flags));
+
+  out->resultType = spgMatchNode;
+  out->result.matchNode.restDatum = PointerGetDatum(box);
+
+  /* nodeN will be set by core, when allTheSame. */
+  if (!in->allTheSame)
+    out->result.matchNode.nodeN =
+      (kdtree_cmp(box, centroid, coord) > 0) ? 1 : 0;
+
+  PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(stbox_kdtree_picksplit);
+/**
+ * Kd-tree SP-GiST pick-split function for temporal points
+ *
+ * It sorts the boxes on the coordinate of the level and splits them in
+ * two halves at the median.  Boxes are assigned to the nodes according to
+ * their position in the sorted array rather than their value so that both
+ * nodes are never empty, even in the presence of duplicate values.
+ */
+PGDLLEXPORT Datum
+stbox_kdtree_picksplit(PG_FUNCTION_ARGS)
+{
+  spgPickSplitIn *in = (spgPickSplitIn *) PG_GETARG_POINTER(0);
+  spgPickSplitOut *out = (spgPickSplitOut *) PG_GETARG_POINTER(1);
+  STBOX *box = DatumGetSTboxP(in->datums[0]);
+  KdCoord coord = kdtree_coord(in->level, MOBDB_FLAGS_GET_Z(box->flags));
+  STBOX *centroid = palloc0(sizeof(STBOX));
+  SortedSTbox *sorted = palloc(sizeof(SortedSTbox) * in->nTuples);
+  int median, i;
+
+  for (i = 0; i < in->nTuples; i++)
+  {
+    sorted[i].box = DatumGetSTboxP(in->datums[i]);
+    sorted[i].i = i;
+  }
+  qsort_arg(sorted, (size_t) in->nTuples, sizeof(SortedSTbox),
+    kdtree_sorted_cmp, &coord);
+  median = in->nTuples / 2;
+
+  centroid->srid = box->srid;
+  centroid->flags = box->flags;
+  kdtree_set_coord(centroid, sorted[median].box, coord);
+
+  /* Fill the output */
+  out->hasPrefix = true;
+  out->prefixDatum = STboxPGetDatum(centroid);
+
+  out->nNodes = 2;
+  out->nodeLabels = NULL;    /* We don't need node labels. */
+
+  out->mapTuplesToNodes = palloc(sizeof(int) * in->nTuples);
+  out->leafTupleDatums = palloc(sizeof(Datum) * in->nTuples);
+
+  for (i = 0; i < in->nTuples; i++)
+  {
+    int n = sorted[i].i;
+    out->mapTuplesToNodes[n] = (i < median) ? 0 : 1;
+    out->leafTupleDatums[n] = STboxPGetDatum(sorted[i].box);
+  }
+
+  pfree(sorted);
+
+  PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(stbox_kdtree_inner_consistent);
+/**
+ * Kd-tree SP-GiST inner consistent functions for temporal points
+ */
+PGDLLEXPORT Datum
+stbox_kdtree_inner_consistent(PG_FUNCTION_ARGS)
+{
+  spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
+  spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
+  MemoryContext old_ctx;
+  CubeSTbox *cube_box;
+  KdCoord coord;
+  STBOX *centroid = DatumGetSTboxP(in->prefixDatum), *queries;
+
   /*
-   * Transform the queries into bounding boxes initializing the dimensions
-   * that must not be taken into account for the operators to infinity.
-   * This transformation is done here to avoid doing it for all octants
-   * in the loop below.
+   * We are saving the traversal value or initialize it an unbounded one, if
+   * we have just begun to walk the tree.
    */
-  queries = (STBOX *) palloc0(sizeof(STBOX) * in->nkeys);
-  for (i = 0; i < in->nkeys; i++)
+  if (in->traversalValue)
+    cube_box = in->traversalValue;
+  else
+    cube_box = initCubeSTbox(centroid);
+
+  if (in->allTheSame)
   {
-    Oid subtype = in->scankeys[i].sk_subtype;
-    if (tgeo_base_type(subtype))
-      /* We do not test the return value of the next function since
-         if the result is false all dimensions of the box have been
-         initialized to +-infinity */
-      geo_to_stbox_internal(&queries[i],
-        (GSERIALIZED*)PG_DETOAST_DATUM(in->scankeys[i].sk_argument));
-    else if (subtype == type_oid(T_STBOX))
-      memcpy(&queries[i], DatumGetSTboxP(in->scankeys[i].sk_argument), sizeof(STBOX));
-    else if (tgeo_type(subtype))
-      temporal_bbox(&queries[i],
-        DatumGetTemporal(in->scankeys[i].sk_argument));
-    else
-      elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+    stbox_spgist_all_nodes(in, out, cube_box);
+    PG_RETURN_VOID();
   }
 
+  Assert(in->nNodes == 2);
+  coord = kdtree_coord(in->level, MOBDB_FLAGS_GET_Z(centroid->flags));
+  queries = stbox_spgist_queries(in->scankeys, in->nkeys);
+
   /* Allocate enough memory for nodes */
   out->nNodes = 0;
   out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
   out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
 #if MOBDB_PGSQL_VERSION >= 120000
+  STBOX *orderbys = NULL;
   if (in->norderbys > 0)
+  {
     out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+    orderbys = stbox_spgist_queries(in->orderbys, in->norderbys);
+  }
 #endif
   /*
    * We switch memory context, because we want to allocate memory for new
@@ -737,113 +1353,36 @@ stbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
    */
   old_ctx = MemoryContextSwitchTo(in->traversalMemoryContext);
 
-  for (octant = 0; octant < in->nNodes; octant++)
+  for (int node = 0; node < in->nNodes; node++)
   {
-    CubeSTbox *next_cube_box = nextCubeSTbox(cube_box, centroid, (uint8) octant);
-    bool flag = true;
-    for (i = 0; i < in->nkeys; i++)
-    {
-      StrategyNumber strategy = in->scankeys[i].sk_strategy;
-      switch (strategy)
-      {
-        case RTOverlapStrategyNumber:
-        case RTContainedByStrategyNumber:
-        case RTAdjacentStrategyNumber:
-          flag = overlap8D(next_cube_box, &queries[i]);
-          break;
-        case RTContainsStrategyNumber:
-        case RTSameStrategyNumber:
-          flag = contain8D(next_cube_box, &queries[i]);
-          break;
-        case RTLeftStrategyNumber:
-          flag = !overRight8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverLeftStrategyNumber:
-          flag = !right8D(next_cube_box, &queries[i]);
-          break;
-        case RTRightStrategyNumber:
-          flag = !overLeft8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverRightStrategyNumber:
-          flag = !left8D(next_cube_box, &queries[i]);
-          break;
-        case RTFrontStrategyNumber:
-          flag = !overBack8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverFrontStrategyNumber:
-          flag = !back8D(next_cube_box, &queries[i]);
-          break;
-        case RTBackStrategyNumber:
-          flag = !overFront8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverBackStrategyNumber:
-          flag = !front8D(next_cube_box, &queries[i]);
-          break;
-        case RTAboveStrategyNumber:
-          flag = !overBelow8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverAboveStrategyNumber:
-          flag = !below8D(next_cube_box, &queries[i]);
-          break;
-        case RTBelowStrategyNumber:
-          flag = !overAbove8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverBelowStrategyNumber:
-          flag = !above8D(next_cube_box, &queries[i]);
-          break;
-        case RTAfterStrategyNumber:
-          flag = !overBefore8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverAfterStrategyNumber:
-          flag = !before8D(next_cube_box, &queries[i]);
-          break;
-        case RTBeforeStrategyNumber:
-          flag = !overAfter8D(next_cube_box, &queries[i]);
-          break;
-        case RTOverBeforeStrategyNumber:
-          flag = !after8D(next_cube_box, &queries[i]);
-          break;
-        default:
-          elog(ERROR, "unrecognized strategy: %d", strategy);
-      }
-
-      /* If any check is failed, we have found our answer. */
-      if (!flag)
-        break;
-    }
-
-    if (flag)
+    CubeSTbox *next_cube_box = nextKdCubeSTbox(cube_box, centroid, coord, node);
+    if (cubestbox_consistent(next_cube_box, queries, in->scankeys, in->nkeys))
     {
       out->traversalValues[out->nNodes] = next_cube_box;
-      out->nodeNumbers[out->nNodes] = octant;
+      out->nodeNumbers[out->nNodes] = node;
 #if MOBDB_PGSQL_VERSION >= 120000
       if (in->norderbys > 0)
       {
         double *distances = palloc(sizeof(double) * in->norderbys);
         out->distances[out->nNodes] = distances;
         for (int j = 0; j < in->norderbys; j++)
-        {
-          STBOX *box = DatumGetSTboxP(in->orderbys[j].sk_argument);
-          distances[j] = distanceBoxCubeBox(box, cube_box);
-        }
+          distances[j] = distanceBoxCubeBox(&orderbys[j], next_cube_box);
       }
 #endif
       out->nNodes++;
     }
     else
-    {
-      /*
-       * If this node is not selected, we don't need to keep the next
-       * traversal value in the memory context.
-       */
       pfree(next_cube_box);
-    }
   }
 
   /* Switch after */
   MemoryContextSwitchTo(old_ctx);
 
   pfree(queries);
+#if MOBDB_PGSQL_VERSION >= 120000
+  if (orderbys != NULL)
+    pfree(orderbys);
+#endif
 
   PG_RETURN_VOID();
 }
@@ -861,9 +1400,6 @@ stbox_spgist_leaf_consistent(PG_FUNCTION_ARGS)
 {
   spgLeafConsistentIn *in = (spgLeafConsistentIn *) PG_GETARG_POINTER(0);
   spgLeafConsistentOut *out = (spgLeafConsistentOut *) PG_GETARG_POINTER(1);
-#if MOBDB_PGSQL_VERSION >= 120000
-  Datum leaf = in->leafDatum;
-#endif
   STBOX *key = DatumGetSTboxP(in->leafDatum);
   bool res = true;
   int i;
@@ -915,8 +1451,11 @@ stbox_spgist_leaf_consistent(PG_FUNCTION_ARGS)
 #if MOBDB_PGSQL_VERSION >= 120000
   if (res && in->norderbys > 0)
   {
-    out->distances = spg_key_orderbys_distances(leaf, false, in->orderbys,
-      in->norderbys);
+    STBOX *orderbys = stbox_spgist_queries(in->orderbys, in->norderbys);
+    out->distances = palloc(sizeof(double) * in->norderbys);
+    for (i = 0; i < in->norderbys; i++)
+      out->distances[i] = stbox_index_distance(key, &orderbys[i]);
+    pfree(orderbys);
     /* Recheck is necessary when computing distance with bounding boxes */
     out->recheckDistances = true;
   }
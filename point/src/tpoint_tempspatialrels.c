@@ -27,6 +27,12 @@
 
 #include "tpoint_tempspatialrels.h"
 
+#include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
@@ -367,17 +373,38 @@ tspatialrel_tpointseq_geo2(TSequence *seq, Datum geo, Datum param,
   int totalseqs = 0;
   inst1 = tsequence_inst_n(seq, 0);
   bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  /* The value of the intersects relationship is constant on the segments
+   * classified by the filter step */
+  char *classes = (lfinfo.func == (varfunc) &geom_intersects2d && linear &&
+    seq->count - 1 >= TPOINTSEQ_FILTER_MIN_SEGS) ?
+    tpointseq_geometry_filter(seq, geo,
+      edgeindex_get((GSERIALIZED *) DatumGetPointer(geo))) : NULL;
   bool lower_inc = seq->period.lower_inc;
   for (int i = 0; i < seq->count - 1; i++)
   {
     inst2 = tsequence_inst_n(seq, i + 1);
     bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
-    sequences[i] = tspatialrel_tpointseq_geo1(inst1, inst2, linear, geo,
-      param, lower_inc, upper_inc, lfinfo, &countseqs[i]);
+    if (classes == NULL || classes[i] == FILTER_REFINE)
+      sequences[i] = tspatialrel_tpointseq_geo1(inst1, inst2, linear, geo,
+        param, lower_inc, upper_inc, lfinfo, &countseqs[i]);
+    else
+    {
+      TInstant *instants[2];
+      Datum value = BoolGetDatum(classes[i] == FILTER_ACCEPT);
+      instants[0] = tinstant_make(value, inst1->t, BOOLOID);
+      instants[1] = tinstant_make(value, inst2->t, BOOLOID);
+      sequences[i] = palloc(sizeof(TSequence *));
+      sequences[i][0] = tsequence_make(instants, 2, lower_inc, upper_inc,
+        STEP, NORMALIZE_NO);
+      pfree(instants[0]); pfree(instants[1]);
+      countseqs[i] = 1;
+    }
     totalseqs += countseqs[i];
     inst1 = inst2;
     lower_inc = true;
   }
+  if (classes != NULL)
+    pfree(classes);
   *count = totalseqs;
   return tsequencearr2_to_tsequencearr(sequences, countseqs, seq->count,
     totalseqs);
@@ -500,10 +527,11 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
     return result;
   }
 
-  /* Restrict to the buffered geometry */
+  /* Get the periods during which the value is true */
   Datum geo_buffer = call_function2(buffer, geo, dist);
-  int count1;
-  TSequence **atbuffer = tpointseq_at_geometry2(seq, geo_buffer, &count1);
+  PeriodSet *ps = tpoint_at_geometry_time_internal((Temporal *) seq,
+    geo_buffer);
+  pfree(DatumGetPointer(geo_buffer));
   Datum datum_true = BoolGetDatum(true);
   Datum datum_false = BoolGetDatum(false);
   /* We create two temporal instants with arbitrary values that are set in
@@ -512,7 +540,7 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
   TInstant *instants[2];
   instants[0] = tinstant_make(datum_false, seq->period.lower, BOOLOID);
   instants[1] = tinstant_make(datum_false, seq->period.upper, BOOLOID);
-  if (atbuffer == NULL)
+  if (ps == NULL)
   {
     result = palloc(sizeof(TSequence *));
     /*  The two instant values created above are the ones needed here */
@@ -523,15 +551,6 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
     return result;
   }
 
-  /* Get the periods during which the value is true */
-  Period **periods = palloc(sizeof(Period *) * count1);
-  for (int i = 0; i < count1; i++)
-    periods[i] = &atbuffer[i]->period;
-  /* The period set must be normalized */
-  PeriodSet *ps = periodset_make(periods, count1, NORMALIZE);
-  for (int i = 0; i < count1; i++)
-    pfree(atbuffer[i]);
-  pfree(periods);
   /* Get the periods during which the value is false */
   PeriodSet *minus = minus_period_periodset_internal(&seq->period, ps);
   if (minus == NULL)
@@ -1421,8 +1440,6 @@ tintersects_tpoint_tpoint(PG_FUNCTION_ARGS)
   ensure_same_srid_tpoint(temp1, temp2);
   ensure_same_dimensionality_tpoint(temp1, temp2);
 
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   LiftedFunctionInfo lfinfo;
   if (MOBDB_FLAGS_GET_GEODETIC(temp1->flags))
     lfinfo.func = (varfunc) &geog_intersects;
@@ -1578,7 +1595,7 @@ tdwithin_tpoint_geo(PG_FUNCTION_ARGS)
  * Returns a temporal Boolean that states whether the temporal points
  * are within the given distance (internal function)
  */
-static Temporal *
+Temporal *
 tdwithin_tpoint_tpoint_internal(const Temporal *temp1, const Temporal *temp2,
   Datum dist)
 {
@@ -1631,8 +1648,6 @@ tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
   Datum dist = PG_GETARG_DATUM(2);
   ensure_same_srid_tpoint(temp1, temp2);
   ensure_same_dimensionality_tpoint(temp1, temp2);
-  /* Store fcinfo into a global variable */
-  store_fcinfo(fcinfo);
   Temporal *result = tdwithin_tpoint_tpoint_internal(temp1, temp2, dist);
   PG_FREE_IF_COPY(temp1, 0);
   PG_FREE_IF_COPY(temp2, 1);
@@ -1641,6 +1656,653 @@ tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Time during which a temporal point intersects a geometry or is within a
+ * given distance of it
+ * These functions compute the same result as
+ * getTime(atValue(tintersects(temp, geo), true)) and
+ * getTime(atValue(tdwithin(temp, geo, dist), true)) without constructing
+ * the intermediate temporal Boolean
+ *****************************************************************************/
+
+/**
+ * Returns the time during which the temporal point intersects the geometry
+ * (dispatch function)
+ */
+static PeriodSet *
+when_intersects_tpoint_geo_internal(const Temporal *temp, GSERIALIZED *gs)
+{
+  ensure_same_srid_tpoint_gs(temp, gs);
+  ensure_same_dimensionality_tpoint_gs(temp, gs);
+  return tpoint_at_geometry_time_internal(temp, PointerGetDatum(gs));
+}
+
+PG_FUNCTION_INFO_V1(when_intersects_geo_tpoint);
+/**
+ * Returns the time during which the geometry and the temporal point
+ * intersect
+ */
+PGDLLEXPORT Datum
+when_intersects_geo_tpoint(PG_FUNCTION_ARGS)
+{
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(0);
+  if (gserialized_is_empty(gs))
+    PG_RETURN_NULL();
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  PeriodSet *result = when_intersects_tpoint_geo_internal(temp, gs);
+  PG_FREE_IF_COPY(gs, 0);
+  PG_FREE_IF_COPY(temp, 1);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(when_intersects_tpoint_geo);
+/**
+ * Returns the time during which the temporal point and the geometry
+ * intersect
+ */
+PGDLLEXPORT Datum
+when_intersects_tpoint_geo(PG_FUNCTION_ARGS)
+{
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+  if (gserialized_is_empty(gs))
+    PG_RETURN_NULL();
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  PeriodSet *result = when_intersects_tpoint_geo_internal(temp, gs);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_FREE_IF_COPY(gs, 1);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+/**
+ * Returns the time during which the temporal point and the geometry are
+ * within the given distance (dispatch function)
+ *
+ * As for tdwithin, the instants of a temporal point with instant or instant
+ * set duration are tested with the dwithin function while temporal points
+ * with sequence or sequence set duration are restricted to the buffered
+ * geometry.
+ */
+static PeriodSet *
+when_dwithin_tpoint_geo_internal(const Temporal *temp, GSERIALIZED *gs,
+  Datum dist)
+{
+  ensure_same_srid_tpoint_gs(temp, gs);
+  ensure_same_dimensionality_tpoint_gs(temp, gs);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == SEQUENCE || temp->duration == SEQUENCESET)
+  {
+    Datum geo_buffer = call_function2(buffer, PointerGetDatum(gs), dist);
+    PeriodSet *result = tpoint_at_geometry_time_internal(temp, geo_buffer);
+    pfree(DatumGetPointer(geo_buffer));
+    return result;
+  }
+
+  Datum (*func)(Datum, Datum, Datum) = MOBDB_FLAGS_GET_Z(temp->flags) ?
+    &geom_dwithin3d : &geom_dwithin2d;
+  int count = temporal_num_instants_internal(temp);
+  Period *periods = palloc(sizeof(Period) * count);
+  Period **pptrs = palloc(sizeof(Period *) * count);
+  int k = 0;
+  TInstantIterator iter;
+  const TInstant *inst;
+  tinstant_iterator_init(&iter, temp);
+  while ((inst = tinstant_iterator_next(&iter)) != NULL)
+  {
+    if (DatumGetBool(func(tinstant_value(inst), PointerGetDatum(gs), dist)))
+    {
+      period_set(&periods[k], inst->t, inst->t, true, true);
+      pptrs[k] = &periods[k];
+      k++;
+    }
+  }
+  PeriodSet *result = (k == 0) ? NULL :
+    periodset_make(pptrs, k, NORMALIZE_NO);
+  pfree(periods); pfree(pptrs);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(when_dwithin_geo_tpoint);
+/**
+ * Returns the time during which the geometry and the temporal point are
+ * within the given distance
+ */
+PGDLLEXPORT Datum
+when_dwithin_geo_tpoint(PG_FUNCTION_ARGS)
+{
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(0);
+  if (gserialized_is_empty(gs))
+    PG_RETURN_NULL();
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  Datum dist = PG_GETARG_DATUM(2);
+  PeriodSet *result = when_dwithin_tpoint_geo_internal(temp, gs, dist);
+  PG_FREE_IF_COPY(gs, 0);
+  PG_FREE_IF_COPY(temp, 1);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(when_dwithin_tpoint_geo);
+/**
+ * Returns the time during which the temporal point and the geometry are
+ * within the given distance
+ */
+PGDLLEXPORT Datum
+when_dwithin_tpoint_geo(PG_FUNCTION_ARGS)
+{
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+  if (gserialized_is_empty(gs))
+    PG_RETURN_NULL();
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Datum dist = PG_GETARG_DATUM(2);
+  PeriodSet *result = when_dwithin_tpoint_geo_internal(temp, gs, dist);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_FREE_IF_COPY(gs, 1);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Temporal dwithin for sets of temporal points
+ *
+ * The candidate pairs of trajectories are found by a plane sweep over time
+ * of chunks of consecutive instants of the trajectories. The chunks are
+ * sorted by their start time and the chunks that are still active at the
+ * start time of the current chunk are kept in a uniform grid over the
+ * spatial dimensions. The spatial boxes of the chunks are expanded by half
+ * the distance, and thus two chunks can only be within the distance when
+ * their expanded boxes overlap. The exact relationship is then computed
+ * for each candidate pair with tdwithin_tpoint_tpoint_internal.
+ *****************************************************************************/
+
+/** Maximum number of instants of the chunks of the plane sweep */
+#define TDWITHIN_PAIRS_CHUNK    32
+/** Maximum number of grid cells covered by a chunk, larger chunks are kept
+ *  apart from the grid */
+#define TDWITHIN_PAIRS_MAXCELLS 1024
+
+/**
+ * Structure to represent the chunks of the plane sweep
+ */
+typedef struct
+{
+  int         id;          /**< position of the trajectory in the array */
+  TimestampTz tmin;        /**< time of the first instant */
+  TimestampTz tmax;        /**< time of the last instant */
+  double      xmin, xmax;  /**< expanded spatial box */
+  double      ymin, ymax;
+  double      zmin, zmax;
+} PairsChunk;
+
+/**
+ * Structure to represent the key of the cells of the grid
+ */
+typedef struct
+{
+  int64       cx;
+  int64       cy;
+} PairsCellKey;
+
+/**
+ * Structure to represent the cells of the grid
+ */
+typedef struct
+{
+  PairsCellKey key;        /**< hash key, must be first */
+  int         count;       /**< number of chunks in the cell */
+  int         size;        /**< allocated size of the array */
+  int        *chunks;      /**< positions of the chunks */
+} PairsCell;
+
+/**
+ * Structure to represent the candidate pairs, i < j
+ */
+typedef struct
+{
+  int         i;
+  int         j;
+} PairsKey;
+
+/**
+ * Structure to represent the state of the set-returning function
+ */
+typedef struct
+{
+  Temporal  **temps;       /**< trajectories */
+  PairsKey   *pairs;       /**< candidate pairs, sorted */
+  Datum       dist;        /**< distance */
+} TdwithinPairsState;
+
+/**
+ * Comparator of the chunks on their start time
+ */
+static int
+pairschunk_cmp(const void *a, const void *b)
+{
+  const PairsChunk *c1 = (const PairsChunk *) a;
+  const PairsChunk *c2 = (const PairsChunk *) b;
+  if (c1->tmin == c2->tmin)
+    return 0;
+  return (c1->tmin < c2->tmin) ? -1 : 1;
+}
+
+/**
+ * Comparator of the candidate pairs
+ */
+static int
+pairskey_cmp(const void *a, const void *b)
+{
+  const PairsKey *p1 = (const PairsKey *) a;
+  const PairsKey *p2 = (const PairsKey *) b;
+  if (p1->i != p2->i)
+    return (p1->i < p2->i) ? -1 : 1;
+  if (p1->j != p2->j)
+    return (p1->j < p2->j) ? -1 : 1;
+  return 0;
+}
+
+/**
+ * Returns true if the expanded spatial boxes of the chunks overlap
+ */
+static bool
+pairschunk_overlap(const PairsChunk *c1, const PairsChunk *c2, bool hasz)
+{
+  if (c1->xmin > c2->xmax || c2->xmin > c1->xmax ||
+    c1->ymin > c2->ymax || c2->ymin > c1->ymax)
+    return false;
+  if (hasz && (c1->zmin > c2->zmax || c2->zmin > c1->zmax))
+    return false;
+  return true;
+}
+
+/**
+ * Append to the array the chunks of consecutive instants
+ *
+ * When the instants are those of a sequence, consecutive chunks share their
+ * boundary instant so that every segment belongs to a chunk.
+ *
+ * @param[out] chunks Array of chunks
+ * @param[in] k Number of chunks of the array
+ * @param[in] instants Instants
+ * @param[in] count Number of instants
+ * @param[in] segments True if the instants are those of a sequence
+ * @param[in] id Position of the trajectory
+ * @param[in] hasz True if the points have Z dimension
+ * @param[in] half Half the distance
+ * @return Number of chunks of the array
+ */
+static int
+tdwithin_pairs_chunks(PairsChunk *chunks, int k, TInstant **instants,
+  int count, bool segments, int id, bool hasz, double half)
+{
+  int step = segments ? TDWITHIN_PAIRS_CHUNK - 1 : TDWITHIN_PAIRS_CHUNK;
+  int i = 0;
+  do
+  {
+    int last = Min(i + TDWITHIN_PAIRS_CHUNK, count) - 1;
+    PairsChunk *chunk = &chunks[k++];
+    chunk->id = id;
+    chunk->tmin = instants[i]->t;
+    chunk->tmax = instants[last]->t;
+    chunk->xmin = chunk->ymin = chunk->zmin = DBL_MAX;
+    chunk->xmax = chunk->ymax = chunk->zmax = -DBL_MAX;
+    for (int j = i; j <= last; j++)
+    {
+      Datum value = tinstant_value(instants[j]);
+      double x, y, z = 0;
+      if (hasz)
+      {
+        const POINT3DZ *p = datum_get_point3dz_p(value);
+        x = p->x; y = p->y; z = p->z;
+      }
+      else
+      {
+        const POINT2D *p = datum_get_point2d_p(value);
+        x = p->x; y = p->y;
+      }
+      chunk->xmin = Min(chunk->xmin, x); chunk->xmax = Max(chunk->xmax, x);
+      chunk->ymin = Min(chunk->ymin, y); chunk->ymax = Max(chunk->ymax, y);
+      chunk->zmin = Min(chunk->zmin, z); chunk->zmax = Max(chunk->zmax, z);
+    }
+    chunk->xmin -= half; chunk->xmax += half;
+    chunk->ymin -= half; chunk->ymax += half;
+    chunk->zmin -= half; chunk->zmax += half;
+    if (last == count - 1)
+      break;
+    i += step;
+  } while (true);
+  return k;
+}
+
+/**
+ * Returns the chunks of a trajectory
+ */
+static int
+tdwithin_pairs_temporal_chunks(PairsChunk **chunks, int *size, int k,
+  const Temporal *temp, int id, bool hasz, double half)
+{
+  /* Upper bound of the number of chunks of the trajectory */
+  int maxcount;
+  if (temp->duration == INSTANT)
+    maxcount = 1;
+  else if (temp->duration == INSTANTSET)
+    maxcount = ((TInstantSet *) temp)->count / TDWITHIN_PAIRS_CHUNK + 1;
+  else if (temp->duration == SEQUENCE)
+    maxcount = ((TSequence *) temp)->count / (TDWITHIN_PAIRS_CHUNK - 1) + 1;
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (TSequenceSet *) temp;
+    maxcount = ts->totalcount / (TDWITHIN_PAIRS_CHUNK - 1) + ts->count;
+  }
+  if (k + maxcount > *size)
+  {
+    *size = Max(*size * 2, k + maxcount);
+    *chunks = repalloc(*chunks, sizeof(PairsChunk) * *size);
+  }
+
+  if (temp->duration == INSTANT)
+  {
+    TInstant *inst = (TInstant *) temp;
+    return tdwithin_pairs_chunks(*chunks, k, &inst, 1, false, id, hasz, half);
+  }
+  if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (TInstantSet *) temp;
+    TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+    for (int i = 0; i < ti->count; i++)
+      instants[i] = tinstantset_inst_n(ti, i);
+    k = tdwithin_pairs_chunks(*chunks, k, instants, ti->count, false, id,
+      hasz, half);
+    pfree(instants);
+    return k;
+  }
+  if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (TSequence *) temp;
+    TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+    for (int i = 0; i < seq->count; i++)
+      instants[i] = tsequence_inst_n(seq, i);
+    k = tdwithin_pairs_chunks(*chunks, k, instants, seq->count, true, id,
+      hasz, half);
+    pfree(instants);
+    return k;
+  }
+  /* temp->duration == SEQUENCESET */
+  const TSequenceSet *ts = (TSequenceSet *) temp;
+  for (int i = 0; i < ts->count; i++)
+    k = tdwithin_pairs_temporal_chunks(chunks, size, k,
+      (Temporal *) tsequenceset_seq_n(ts, i), id, hasz, half);
+  return k;
+}
+
+/**
+ * Add the pair of trajectories of the chunks to the candidates
+ */
+static void
+tdwithin_pairs_add(HTAB *pairs, const PairsChunk *c1, const PairsChunk *c2,
+  bool hasz)
+{
+  PairsKey key;
+  bool found;
+  if (c1->id == c2->id || ! pairschunk_overlap(c1, c2, hasz))
+    return;
+  key.i = Min(c1->id, c2->id);
+  key.j = Max(c1->id, c2->id);
+  hash_search(pairs, &key, HASH_ENTER, &found);
+  return;
+}
+
+/**
+ * Remove from the array the chunks that end before the instant, and compare
+ * the remaining ones with the chunk
+ *
+ * @param[in,out] array Positions of the active chunks
+ * @param[in,out] count Number of active chunks
+ * @param[in] chunks Chunks
+ * @param[in] c Position of the current chunk
+ * @param[in] pairs Candidate pairs
+ * @param[in] hasz True if the points have Z dimension
+ */
+static void
+tdwithin_pairs_sweep(int *array, int *count, const PairsChunk *chunks, int c,
+  HTAB *pairs, bool hasz)
+{
+  int k = 0;
+  for (int i = 0; i < *count; i++)
+  {
+    const PairsChunk *other = &chunks[array[i]];
+    if (other->tmax < chunks[c].tmin)
+      continue;
+    array[k++] = array[i];
+    tdwithin_pairs_add(pairs, &chunks[c], other, hasz);
+  }
+  *count = k;
+  return;
+}
+
+/**
+ * Append the chunk position to the dynamic array
+ */
+static void
+tdwithin_pairs_append(int **array, int *count, int *size, int c)
+{
+  if (*count == *size)
+  {
+    *size = (*size == 0) ? 8 : *size * 2;
+    *array = (*array == NULL) ? palloc(sizeof(int) * *size) :
+      repalloc(*array, sizeof(int) * *size);
+  }
+  (*array)[(*count)++] = c;
+  return;
+}
+
+/**
+ * Returns the candidate pairs of trajectories that may be within the
+ * distance, sorted by the positions of the trajectories
+ *
+ * @param[in] temps Trajectories
+ * @param[in] count Number of trajectories
+ * @param[in] dist Distance
+ * @param[out] npairs Number of candidate pairs
+ */
+static PairsKey *
+tdwithin_pairs_candidates(Temporal **temps, int count, double dist,
+  int *npairs)
+{
+  MemoryContext sweepcontext, oldcontext;
+  bool hasz = MOBDB_FLAGS_GET_Z(temps[0]->flags);
+  PairsChunk *chunks;
+  PairsKey *result;
+  HTAB *grid, *pairs;
+  HASHCTL ctl;
+  HASH_SEQ_STATUS status;
+  PairsKey *pair;
+  int nchunks = 0, size = count, nlarge = 0, sizelarge = 0, nall = 0,
+    sizeall = 0, *large = NULL, *all = NULL;
+  double cellsize = 0;
+
+  sweepcontext = AllocSetContextCreate(CurrentMemoryContext,
+    "tdwithinPairs sweep", ALLOCSET_DEFAULT_SIZES);
+  oldcontext = MemoryContextSwitchTo(sweepcontext);
+
+  chunks = palloc(sizeof(PairsChunk) * size);
+  for (int i = 0; i < count; i++)
+    nchunks = tdwithin_pairs_temporal_chunks(&chunks, &size, nchunks,
+      temps[i], i, hasz, dist / 2);
+  qsort(chunks, nchunks, sizeof(PairsChunk), &pairschunk_cmp);
+
+  /* The size of the cells is the average extent of the chunks */
+  for (int i = 0; i < nchunks; i++)
+    cellsize += Max(chunks[i].xmax - chunks[i].xmin,
+      chunks[i].ymax - chunks[i].ymin);
+  cellsize /= nchunks;
+  if (cellsize <= 0 || ! isfinite(cellsize))
+    cellsize = 1.0;
+
+  memset(&ctl, 0, sizeof(ctl));
+  ctl.keysize = sizeof(PairsCellKey);
+  ctl.entrysize = sizeof(PairsCell);
+  ctl.hcxt = sweepcontext;
+  grid = hash_create("tdwithinPairs grid", 1024, &ctl,
+    HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+  memset(&ctl, 0, sizeof(ctl));
+  ctl.keysize = sizeof(PairsKey);
+  ctl.entrysize = sizeof(PairsKey);
+  ctl.hcxt = sweepcontext;
+  pairs = hash_create("tdwithinPairs pairs", 1024, &ctl,
+    HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+  for (int c = 0; c < nchunks; c++)
+  {
+    const PairsChunk *chunk = &chunks[c];
+    int64 cx1 = (int64) floor(chunk->xmin / cellsize),
+      cx2 = (int64) floor(chunk->xmax / cellsize),
+      cy1 = (int64) floor(chunk->ymin / cellsize),
+      cy2 = (int64) floor(chunk->ymax / cellsize);
+
+    /* The chunks that are too large for the grid are compared with all
+     * active chunks */
+    tdwithin_pairs_sweep(large, &nlarge, chunks, c, pairs, hasz);
+    if ((double) (cx2 - cx1 + 1) * (double) (cy2 - cy1 + 1) >
+      TDWITHIN_PAIRS_MAXCELLS)
+    {
+      tdwithin_pairs_sweep(all, &nall, chunks, c, pairs, hasz);
+      tdwithin_pairs_append(&large, &nlarge, &sizelarge, c);
+      continue;
+    }
+    for (int64 cx = cx1; cx <= cx2; cx++)
+    {
+      for (int64 cy = cy1; cy <= cy2; cy++)
+      {
+        PairsCellKey key;
+        PairsCell *cell;
+        bool found;
+        memset(&key, 0, sizeof(PairsCellKey));
+        key.cx = cx;
+        key.cy = cy;
+        cell = (PairsCell *) hash_search(grid, &key, HASH_ENTER, &found);
+        if (! found)
+        {
+          cell->count = cell->size = 0;
+          cell->chunks = NULL;
+        }
+        tdwithin_pairs_sweep(cell->chunks, &cell->count, chunks, c, pairs,
+          hasz);
+        tdwithin_pairs_append(&cell->chunks, &cell->count, &cell->size, c);
+      }
+    }
+    /* Keep the list of all active chunks for the large ones, removing
+     * the expired chunks before growing the list */
+    if (nall == sizeall)
+    {
+      int k = 0;
+      for (int i = 0; i < nall; i++)
+        if (chunks[all[i]].tmax >= chunk->tmin)
+          all[k++] = all[i];
+      nall = k;
+    }
+    tdwithin_pairs_append(&all, &nall, &sizeall, c);
+  }
+
+  /* Copy the candidate pairs into the context of the caller */
+  *npairs = (int) hash_get_num_entries(pairs);
+  MemoryContextSwitchTo(oldcontext);
+  result = palloc(sizeof(PairsKey) * Max(*npairs, 1));
+  int k = 0;
+  hash_seq_init(&status, pairs);
+  while ((pair = (PairsKey *) hash_seq_search(&status)) != NULL)
+    result[k++] = *pair;
+  qsort(result, k, sizeof(PairsKey), &pairskey_cmp);
+  MemoryContextDelete(sweepcontext);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(tdwithin_pairs);
+/**
+ * Returns the pairs of temporal points of the array that are ever within
+ * the given distance, together with the temporal Boolean that states when
+ * they are within the distance
+ *
+ * The pairs are given by the positions of the temporal points in the array,
+ * starting at one, where the first position is smaller than the second one.
+ */
+PGDLLEXPORT Datum
+tdwithin_pairs(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  TdwithinPairsState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+    ArrayType *array;
+    Temporal **temps;
+    int count, npairs = 0;
+    double dist;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    array = PG_GETARG_ARRAYTYPE_P(0);
+    dist = PG_GETARG_FLOAT8(1);
+    if (dist < 0)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The distance cannot be negative")));
+    temps = temporalarr_extract(array, &count);
+    for (int i = 1; i < count; i++)
+    {
+      ensure_same_srid_tpoint(temps[0], temps[i]);
+      ensure_same_dimensionality_tpoint(temps[0], temps[i]);
+    }
+
+    state = palloc(sizeof(TdwithinPairsState));
+    state->temps = temps;
+    state->dist = Float8GetDatum(dist);
+    state->pairs = (count > 1) ?
+      tdwithin_pairs_candidates(temps, count, dist, &npairs) : NULL;
+    funcctx->user_fctx = state;
+    funcctx->max_calls = npairs;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (TdwithinPairsState *) funcctx->user_fctx;
+  while (funcctx->call_cntr < funcctx->max_calls)
+  {
+    PairsKey *pair = &state->pairs[funcctx->call_cntr];
+    Temporal *result = tdwithin_tpoint_tpoint_internal(state->temps[pair->i],
+      state->temps[pair->j], state->dist);
+    if (result != NULL &&
+      temporal_ever_eq_internal(result, BoolGetDatum(true)))
+    {
+      Datum values[3];
+      bool isnull[3] = {false, false, false};
+      HeapTuple tuple;
+      values[0] = Int32GetDatum(pair->i + 1);
+      values[1] = Int32GetDatum(pair->j + 1);
+      values[2] = PointerGetDatum(result);
+      tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+      SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+    }
+    if (result != NULL)
+      pfree(result);
+    funcctx->call_cntr++;
+  }
+  SRF_RETURN_DONE(funcctx);
+}
+
 /*****************************************************************************
  * Temporal relate
  *****************************************************************************/
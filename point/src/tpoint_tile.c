@@ -0,0 +1,823 @@
+/*****************************************************************************
+ *
+ * tpoint_tile.c
+ *    Splitting of temporal points into spatial tiles and time buckets
+ *
+ * The tiles are aligned with respect to a spatial origin and the buckets
+ * with respect to a time origin. The time buckets are half-open while the
+ * spatial tiles are closed as the spatiotemporal boxes, so that the parts
+ * of a temporal point located on the common border of two tiles belong to
+ * both tiles.
+ *
+ * The time spent by a set of temporal points in each tile is aggregated
+ * without clipping the temporal points against the tiles. The segments
+ * of the sequences are instead walked through the tiles they traverse,
+ * visiting the tiles in the order in which the segment crosses their
+ * borders, and the time between two consecutive crossings of the border
+ * of a tile or of a time bucket is added to the current tile. The tiles
+ * are half-open in this case, so that the time spent in each tile sums
+ * up to the duration of the temporal points.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_tile.h"
+
+#include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <libpq/pqformat.h>
+#include <utils/timestamp.h>
+
+#include "temporaltypes.h"
+#include "temporal_util.h"
+#include "temporal_aggfuncs.h"
+#include "postgis.h"
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************/
+
+/**
+ * Create the state for splitting the temporal point into spatial tiles
+ *
+ * @param[in] temp Temporal point
+ * @param[in] xsize,ysize Size of the tiles
+ * @param[in] origin Origin of the tiles
+ * @param[in] timestate State of the time buckets, may be NULL
+ */
+static SpaceSplitState *
+spacesplit_state_make(Temporal *temp, double xsize, double ysize,
+  GSERIALIZED *origin, TimeSplitState *timestate)
+{
+  if (xsize <= 0 || ysize <= 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The tile sizes must be strictly positive")));
+  ensure_point_type(origin);
+  ensure_non_empty(origin);
+  if (gserialized_get_srid(origin) != SRID_UNKNOWN)
+    ensure_same_srid_tpoint_gs(temp, origin);
+  const POINT2D *p = datum_get_point2d_p(PointerGetDatum(origin));
+
+  SpaceSplitState *result = palloc0(sizeof(SpaceSplitState));
+  result->temp = temp;
+  result->timestate = timestate;
+  result->xsize = xsize;
+  result->ysize = ysize;
+  result->xorigin = p->x;
+  result->yorigin = p->y;
+  result->srid = tpoint_srid_internal(temp);
+  result->hasz = MOBDB_FLAGS_GET_Z(temp->flags);
+  result->done = false;
+  result->fragment = NULL;
+  return result;
+}
+
+/**
+ * Move the state to the next fragment of the temporal point and compute
+ * the tiles covered by its bounding box
+ *
+ * @result False when all the fragments have been visited
+ */
+static bool
+spacesplit_state_next_fragment(SpaceSplitState *state)
+{
+  if (state->fragment != NULL && state->fragment != state->temp)
+    pfree(state->fragment);
+  state->fragment = NULL;
+  if (state->timestate != NULL)
+    state->fragment = timesplit_state_next(state->timestate, &state->bucket);
+  else if (! state->done)
+    state->fragment = state->temp;
+  if (state->fragment == NULL)
+  {
+    state->done = true;
+    return false;
+  }
+  if (state->timestate == NULL)
+    state->done = true;
+
+  memset(&state->box, 0, sizeof(STBOX));
+  temporal_bbox(&state->box, state->fragment);
+  state->xstart = state->xorigin +
+    floor((state->box.xmin - state->xorigin) / state->xsize) * state->xsize;
+  state->ystart = state->yorigin +
+    floor((state->box.ymin - state->yorigin) / state->ysize) * state->ysize;
+  state->nx = (int64) floor((state->box.xmax - state->xstart) /
+    state->xsize) + 1;
+  state->ny = (int64) floor((state->box.ymax - state->ystart) /
+    state->ysize) + 1;
+  state->i = 0;
+  return true;
+}
+
+/**
+ * Returns the fragment of the temporal point in the next non-empty tile,
+ * or NULL when all the tiles have been visited
+ *
+ * Only the tiles covered by the bounding box of the current fragment are
+ * visited, and the fragment is clipped against each of them.
+ *
+ * @param[in,out] state State
+ * @param[in] mcxt Memory context in which the fragments are kept across
+ * calls
+ * @param[out] tile Box of the tile of the fragment
+ */
+static Temporal *
+spacesplit_state_next(SpaceSplitState *state, MemoryContext mcxt,
+  STBOX **tile)
+{
+  while (true)
+  {
+    if (state->fragment == NULL || state->i >= state->nx * state->ny)
+    {
+      MemoryContext oldcontext = MemoryContextSwitchTo(mcxt);
+      bool found = spacesplit_state_next_fragment(state);
+      MemoryContextSwitchTo(oldcontext);
+      if (! found)
+        return NULL;
+    }
+    int64 ix = state->i % state->nx;
+    int64 iy = state->i / state->nx;
+    state->i++;
+    double xmin = state->xstart + ix * state->xsize;
+    double xmax = state->xstart + (ix + 1) * state->xsize;
+    double ymin = state->ystart + iy * state->ysize;
+    double ymax = state->ystart + (iy + 1) * state->ysize;
+    STBOX box;
+    memset(&box, 0, sizeof(STBOX));
+    box.xmin = xmin; box.xmax = xmax;
+    box.ymin = ymin; box.ymax = ymax;
+    box.zmin = state->box.zmin; box.zmax = state->box.zmax;
+    box.srid = state->srid;
+    MOBDB_FLAGS_SET_X(box.flags, true);
+    MOBDB_FLAGS_SET_Z(box.flags, state->hasz);
+    Temporal *result = tpoint_at_stbox_internal(state->fragment, &box);
+    if (result != NULL)
+    {
+      bool hast = (state->timestate != NULL);
+      TimestampTz tmin = hast ? state->bucket : 0;
+      TimestampTz tmax = hast ? state->bucket + state->timestate->size : 0;
+      *tile = stbox_make(true, false, hast, false, state->srid,
+        xmin, xmax, ymin, ymax, 0, 0, tmin, tmax);
+      return result;
+    }
+  }
+}
+
+/**
+ * Split the temporal point into fragments with respect to spatial tiles
+ * and, optionally, time buckets
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] hast True when the temporal point is also split in time
+ */
+static Datum
+tpoint_split(FunctionCallInfo fcinfo, bool hast)
+{
+  FuncCallContext *funcctx;
+  SpaceSplitState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    double xsize = PG_GETARG_FLOAT8(1);
+    double ysize = PG_GETARG_FLOAT8(2);
+    TimeSplitState *timestate = NULL;
+    GSERIALIZED *origin;
+    if (hast)
+    {
+      Interval *duration = PG_GETARG_INTERVAL_P(3);
+      origin = PG_GETARG_GSERIALIZED_P(4);
+      TimestampTz torigin = PG_GETARG_TIMESTAMPTZ(5);
+      int64 size = interval_units(duration);
+      timestate = timesplit_state_make(temp, size, torigin);
+    }
+    else
+      origin = PG_GETARG_GSERIALIZED_P(3);
+    funcctx->user_fctx = spacesplit_state_make(temp, xsize, ysize, origin,
+      timestate);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (SpaceSplitState *) funcctx->user_fctx;
+  STBOX *tile;
+  Temporal *fragment = spacesplit_state_next(state,
+    funcctx->multi_call_memory_ctx, &tile);
+  if (fragment == NULL)
+    SRF_RETURN_DONE(funcctx);
+
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = PointerGetDatum(tile);
+  values[1] = PointerGetDatum(fragment);
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_space_split);
+/**
+ * Split the temporal point into fragments with respect to spatial tiles
+ */
+PGDLLEXPORT Datum
+tpoint_space_split(PG_FUNCTION_ARGS)
+{
+  return tpoint_split(fcinfo, false);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_space_time_split);
+/**
+ * Split the temporal point into fragments with respect to spatial tiles
+ * and time buckets
+ */
+PGDLLEXPORT Datum
+tpoint_space_time_split(PG_FUNCTION_ARGS)
+{
+  return tpoint_split(fcinfo, true);
+}
+
+/*****************************************************************************
+ * Dwell time aggregation
+ *****************************************************************************/
+
+/**
+ * Comparator function for the cells of the dwell time aggregation
+ */
+static int
+dwellcell_cmp(const void *a, const void *b)
+{
+  const DwellCell *c1 = (const DwellCell *) a;
+  const DwellCell *c2 = (const DwellCell *) b;
+  if (c1->bucket != c2->bucket)
+    return (c1->bucket < c2->bucket) ? -1 : 1;
+  if (c1->y != c2->y)
+    return (c1->y < c2->y) ? -1 : 1;
+  if (c1->x != c2->x)
+    return (c1->x < c2->x) ? -1 : 1;
+  return 0;
+}
+
+/**
+ * Sort the cells of the state and merge the cells of the same tile
+ */
+static void
+dwellagg_compact(DwellAggState *state)
+{
+  if (state->count <= 1)
+    return;
+  qsort(state->cells, (size_t) state->count, sizeof(DwellCell),
+    &dwellcell_cmp);
+  int k = 0;
+  for (int i = 1; i < state->count; i++)
+  {
+    DwellCell *cell = &state->cells[i];
+    DwellCell *last = &state->cells[k];
+    if (dwellcell_cmp(cell, last) == 0)
+    {
+      last->duration += cell->duration;
+      last->visits += cell->visits;
+    }
+    else
+      state->cells[++k] = *cell;
+  }
+  state->count = k + 1;
+  return;
+}
+
+/**
+ * Create a new state for dwell time aggregation in the current memory
+ * context
+ */
+static DwellAggState *
+dwellagg_make(double xsize, double ysize, double xorigin, double yorigin,
+  int64 size, TimestampTz origin, int32 srid, int capacity)
+{
+  DwellAggState *result = palloc(sizeof(DwellAggState));
+  result->xsize = xsize;
+  result->ysize = ysize;
+  result->xorigin = xorigin;
+  result->yorigin = yorigin;
+  result->size = size;
+  result->origin = origin;
+  result->srid = srid;
+  result->capacity = Max(capacity, DWELLAGG_INITIAL_CAPACITY);
+  result->count = 0;
+  result->cells = palloc(sizeof(DwellCell) * result->capacity);
+  return result;
+}
+
+/**
+ * Ensure that the state can hold the given number of additional cells.
+ * The cells of the state are compacted before growing the state, which
+ * keeps its size proportional to the number of distinct tiles.
+ */
+static void
+dwellagg_reserve(DwellAggState *state, int count)
+{
+  if (state->count + count <= state->capacity)
+    return;
+  dwellagg_compact(state);
+  if (state->count + count <= state->capacity / 2)
+    return;
+  while (state->count + count > state->capacity / 2)
+    state->capacity <<= 1;
+  /* The cells stay in the memory context of the aggregation */
+  state->cells = repalloc(state->cells, sizeof(DwellCell) * state->capacity);
+  return;
+}
+
+/**
+ * Ensure that the two states have the same tiles and time buckets
+ */
+static void
+dwellagg_check(const DwellAggState *state, double xsize, double ysize,
+  double xorigin, double yorigin, int64 size, TimestampTz origin)
+{
+  if (state->xsize != xsize || state->ysize != ysize ||
+    state->xorigin != xorigin || state->yorigin != yorigin ||
+    state->size != size || state->origin != origin)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The tiles must be the same for all the aggregated values")));
+  return;
+}
+
+/**
+ * Set the tile and the time bucket of the cell containing the point at
+ * the timestamp
+ */
+static void
+dwellagg_cell(const DwellAggState *state, const POINT2D *p, TimestampTz t,
+  DwellCell *cell)
+{
+  cell->x = (int64) floor((p->x - state->xorigin) / state->xsize);
+  cell->y = (int64) floor((p->y - state->yorigin) / state->ysize);
+  cell->bucket = (state->size > 0) ?
+    timestamptz_bucket_internal(t, state->size, state->origin) : 0;
+  cell->duration = 0;
+  cell->visits = 0;
+  return;
+}
+
+/**
+ * Add the time spent in the cell to the state. A visit is counted when
+ * the cell differs from the previous cell of the sequence, whose number
+ * of visits is 0 at the start of a sequence.
+ */
+static void
+dwellagg_add(DwellAggState *state, const DwellCell *cell, DwellCell *prev)
+{
+  bool visit = (prev->visits == 0 || dwellcell_cmp(cell, prev) != 0);
+  /* Consecutive pieces usually fall in the same cell */
+  DwellCell *last = (state->count > 0) ?
+    &state->cells[state->count - 1] : NULL;
+  if (last == NULL || dwellcell_cmp(cell, last) != 0)
+  {
+    dwellagg_reserve(state, 1);
+    last = &state->cells[state->count++];
+    *last = *cell;
+    last->duration = 0;
+    last->visits = 0;
+  }
+  last->duration += cell->duration;
+  if (visit)
+    last->visits++;
+  *prev = *cell;
+  prev->visits = 1;
+  return;
+}
+
+/**
+ * Add the time spent by the segment in the tiles it traverses to the state
+ *
+ * The tiles are visited as in a digital differential analyzer: the
+ * fractions of the segment at which it crosses the next vertical and
+ * horizontal borders are advanced by the fraction needed to traverse a
+ * tile, and the segment moves to the tile whose border it crosses first.
+ * The timestamps of the crossings are rounded to microseconds, so that
+ * the time spent in the tiles sums up to the duration of the segment.
+ */
+static void
+dwellagg_segment(DwellAggState *state, const POINT2D *p1, const POINT2D *p2,
+  TimestampTz t1, TimestampTz t2, DwellCell *prev)
+{
+  DwellCell cell;
+  dwellagg_cell(state, p1, t1, &cell);
+  double dx = p2->x - p1->x, dy = p2->y - p1->y;
+  double sx = DBL_MAX, sy = DBL_MAX, dsx = 0.0, dsy = 0.0;
+  int64 stepx = 0, stepy = 0;
+  if (dx != 0)
+  {
+    stepx = (dx > 0) ? 1 : -1;
+    double border = state->xorigin +
+      (cell.x + (dx > 0 ? 1 : 0)) * state->xsize;
+    sx = (border - p1->x) / dx;
+    dsx = state->xsize / fabs(dx);
+  }
+  if (dy != 0)
+  {
+    stepy = (dy > 0) ? 1 : -1;
+    double border = state->yorigin +
+      (cell.y + (dy > 0 ? 1 : 0)) * state->ysize;
+    sy = (border - p1->y) / dy;
+    dsy = state->ysize / fabs(dy);
+  }
+  TimestampTz tbucket = (state->size > 0) ?
+    cell.bucket + state->size : DT_NOEND;
+  double span = (double) (t2 - t1);
+  TimestampTz t = t1;
+  while (t < t2)
+  {
+    double s = Min(sx, sy);
+    TimestampTz tcell = (s < 1.0) ? t1 + (TimestampTz) (s * span) : t2;
+    TimestampTz tend = Min(tcell, tbucket);
+    if (tend > t)
+    {
+      cell.duration = tend - t;
+      dwellagg_add(state, &cell, prev);
+      t = tend;
+    }
+    if (t >= t2)
+      break;
+    if (tend == tbucket)
+    {
+      cell.bucket = tbucket;
+      tbucket += state->size;
+    }
+    if (tend == tcell)
+    {
+      if (sx <= s)
+      {
+        cell.x += stepx;
+        sx += dsx;
+      }
+      if (sy <= s)
+      {
+        cell.y += stepy;
+        sy += dsy;
+      }
+    }
+  }
+  return;
+}
+
+/**
+ * Add the instant to the state, which is a visit of its tile without
+ * duration
+ */
+static void
+dwellagg_instant(DwellAggState *state, const TInstant *inst, DwellCell *prev)
+{
+  DwellCell cell;
+  dwellagg_cell(state, datum_get_point2d_p(tinstant_value(inst)), inst->t,
+    &cell);
+  dwellagg_add(state, &cell, prev);
+  return;
+}
+
+/**
+ * Add the time spent by the sequence in each tile to the state
+ */
+static void
+dwellagg_sequence(DwellAggState *state, const TSequence *seq)
+{
+  DwellCell prev;
+  prev.visits = 0;
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  if (seq->count == 1)
+  {
+    dwellagg_instant(state, inst1, &prev);
+    return;
+  }
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  const POINT2D *p1 = datum_get_point2d_p(tinstant_value(inst1));
+  for (int i = 1; i < seq->count; i++)
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, i);
+    const POINT2D *p2 = datum_get_point2d_p(tinstant_value(inst2));
+    /* With stepwise interpolation the point stays at the start */
+    dwellagg_segment(state, p1, linear ? p2 : p1, inst1->t, inst2->t,
+      &prev);
+    inst1 = inst2;
+    p1 = p2;
+  }
+  return;
+}
+
+/**
+ * Add the time spent by the temporal point in each tile to the state
+ */
+static void
+dwellagg_temporal(DwellAggState *state, const Temporal *temp)
+{
+  DwellCell prev;
+  prev.visits = 0;
+  if (temp->duration == INSTANT)
+    dwellagg_instant(state, (TInstant *) temp, &prev);
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+      dwellagg_instant(state, tinstantset_inst_n(ti, i), &prev);
+  }
+  else if (temp->duration == SEQUENCE)
+    dwellagg_sequence(state, (TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      dwellagg_sequence(state, tsequenceset_seq_n(ts, i));
+  }
+  return;
+}
+
+/**
+ * Returns the dwell time aggregation state in the binary format shared by
+ * the serialization of the state and the result of the aggregation
+ */
+static bytea *
+dwellagg_write(DwellAggState *state)
+{
+  dwellagg_compact(state);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+  pq_sendfloat8(&buf, state->xsize);
+  pq_sendfloat8(&buf, state->ysize);
+  pq_sendfloat8(&buf, state->xorigin);
+  pq_sendfloat8(&buf, state->yorigin);
+  pq_sendint64(&buf, state->size);
+  pq_sendint64(&buf, state->origin);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->srid, 4);
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->srid);
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  for (int i = 0; i < state->count; i++)
+  {
+    DwellCell *cell = &state->cells[i];
+    pq_sendint64(&buf, cell->x);
+    pq_sendint64(&buf, cell->y);
+    pq_sendint64(&buf, cell->bucket);
+    pq_sendint64(&buf, cell->duration);
+    pq_sendint64(&buf, cell->visits);
+  }
+  return pq_endtypsend(&buf);
+}
+
+/**
+ * Returns the dwell time aggregation state from its binary format in the
+ * current memory context
+ */
+static DwellAggState *
+dwellagg_read(const bytea *data)
+{
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data) - VARHDRSZ,
+    .maxlen = VARSIZE(data) - VARHDRSZ
+  };
+  double xsize = pq_getmsgfloat8(&buf);
+  double ysize = pq_getmsgfloat8(&buf);
+  double xorigin = pq_getmsgfloat8(&buf);
+  double yorigin = pq_getmsgfloat8(&buf);
+  int64 size = pq_getmsgint64(&buf);
+  TimestampTz origin = (TimestampTz) pq_getmsgint64(&buf);
+  int32 srid = (int32) pq_getmsgint(&buf, 4);
+  int count = (int) pq_getmsgint(&buf, 4);
+  if (xsize <= 0 || ysize <= 0 || size < 0 || count < 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Invalid dwell time aggregation buffer")));
+  DwellAggState *result = dwellagg_make(xsize, ysize, xorigin, yorigin,
+    size, origin, srid, count);
+  for (int i = 0; i < count; i++)
+  {
+    DwellCell *cell = &result->cells[i];
+    cell->x = pq_getmsgint64(&buf);
+    cell->y = pq_getmsgint64(&buf);
+    cell->bucket = (TimestampTz) pq_getmsgint64(&buf);
+    cell->duration = pq_getmsgint64(&buf);
+    cell->visits = pq_getmsgint64(&buf);
+  }
+  result->count = count;
+  pq_getmsgend(&buf);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_dwell_transfn);
+/**
+ * Transition function for the aggregation of the time spent by temporal
+ * points in spatial tiles and, optionally, time buckets
+ */
+PGDLLEXPORT Datum
+tpoint_dwell_transfn(PG_FUNCTION_ARGS)
+{
+  DwellAggState *state = PG_ARGISNULL(0) ? NULL :
+    (DwellAggState *) PG_GETARG_POINTER(0);
+  for (int i = 1; i < PG_NARGS(); i++)
+  {
+    if (PG_ARGISNULL(i))
+    {
+      if (state)
+        PG_RETURN_POINTER(state);
+      else
+        PG_RETURN_NULL();
+    }
+  }
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  double xsize = PG_GETARG_FLOAT8(2);
+  double ysize = PG_GETARG_FLOAT8(3);
+  /* The optional arguments are the duration of the time buckets, the
+   * spatial origin, or the duration and both origins */
+  int64 size = 0;
+  TimestampTz torigin = 0;
+  GSERIALIZED *sorigin = NULL;
+  if (PG_NARGS() > 4)
+  {
+    if (get_fn_expr_argtype(fcinfo->flinfo, 4) == INTERVALOID)
+    {
+      size = interval_units(PG_GETARG_INTERVAL_P(4));
+      torigin = BUCKET_DEFAULT_ORIGIN;
+      if (PG_NARGS() > 6)
+      {
+        sorigin = PG_GETARG_GSERIALIZED_P(5);
+        torigin = PG_GETARG_TIMESTAMPTZ(6);
+      }
+    }
+    else
+      sorigin = PG_GETARG_GSERIALIZED_P(4);
+  }
+  if (xsize <= 0 || ysize <= 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The tile sizes must be strictly positive")));
+  double xorigin = 0.0, yorigin = 0.0;
+  if (sorigin != NULL)
+  {
+    ensure_point_type(sorigin);
+    ensure_non_empty(sorigin);
+    if (gserialized_get_srid(sorigin) != SRID_UNKNOWN)
+      ensure_same_srid_tpoint_gs(temp, sorigin);
+    const POINT2D *p = datum_get_point2d_p(PointerGetDatum(sorigin));
+    xorigin = p->x;
+    yorigin = p->y;
+  }
+
+  int32 srid = tpoint_srid_internal(temp);
+  if (! state)
+  {
+    MemoryContext ctx = set_aggregation_context(fcinfo);
+    state = dwellagg_make(xsize, ysize, xorigin, yorigin, size, torigin,
+      srid, 0);
+    unset_aggregation_context(ctx);
+  }
+  else
+  {
+    dwellagg_check(state, xsize, ysize, xorigin, yorigin, size, torigin);
+    if (state->srid != srid)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The temporal points must be in the same SRID")));
+  }
+  dwellagg_temporal(state, temp);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_dwell_combinefn);
+/**
+ * Combine function for the aggregation of the time spent by temporal
+ * points in spatial tiles
+ */
+PGDLLEXPORT Datum
+tpoint_dwell_combinefn(PG_FUNCTION_ARGS)
+{
+  DwellAggState *state1 = PG_ARGISNULL(0) ? NULL :
+    (DwellAggState *) PG_GETARG_POINTER(0);
+  DwellAggState *state2 = PG_ARGISNULL(1) ? NULL :
+    (DwellAggState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (state1 == NULL)
+    PG_RETURN_POINTER(state2);
+  if (state2 == NULL)
+    PG_RETURN_POINTER(state1);
+
+  dwellagg_check(state1, state2->xsize, state2->ysize, state2->xorigin,
+    state2->yorigin, state2->size, state2->origin);
+  if (state1->srid != state2->srid)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The temporal points must be in the same SRID")));
+  dwellagg_reserve(state1, state2->count);
+  memcpy(&state1->cells[state1->count], state2->cells,
+    sizeof(DwellCell) * state2->count);
+  state1->count += state2->count;
+  PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_dwell_finalfn);
+/**
+ * Final and serialization function for the aggregation of the time spent
+ * by temporal points in spatial tiles, which are read with dwellTimeCells
+ */
+PGDLLEXPORT Datum
+tpoint_dwell_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  DwellAggState *state = (DwellAggState *) PG_GETARG_POINTER(0);
+  PG_RETURN_BYTEA_P(dwellagg_write(state));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_dwell_deserialize);
+/**
+ * Deserialize the state value of the aggregation of the time spent by
+ * temporal points in spatial tiles
+ */
+PGDLLEXPORT Datum
+tpoint_dwell_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  DwellAggState *result = dwellagg_read(data);
+  unset_aggregation_context(ctx);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_dwell_cells);
+/**
+ * Returns the tiles of the result of the aggregation of the time spent by
+ * temporal points in spatial tiles with their dwell time and number of
+ * visits
+ */
+PGDLLEXPORT Datum
+tpoint_dwell_cells(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  DwellAggState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    bytea *data = PG_GETARG_BYTEA_P(0);
+    state = dwellagg_read(data);
+    funcctx->user_fctx = state;
+    funcctx->max_calls = (uint64) state->count;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (DwellAggState *) funcctx->user_fctx;
+  if (funcctx->call_cntr >= funcctx->max_calls)
+    SRF_RETURN_DONE(funcctx);
+
+  DwellCell *cell = &state->cells[funcctx->call_cntr];
+  double xmin = state->xorigin + cell->x * state->xsize;
+  double ymin = state->yorigin + cell->y * state->ysize;
+  bool hast = (state->size > 0);
+  TimestampTz tmax = hast ? cell->bucket + state->size : 0;
+  STBOX *tile = stbox_make(true, false, hast, false, state->srid, xmin,
+    xmin + state->xsize, ymin, ymin + state->ysize, 0, 0, cell->bucket, tmax);
+  Interval *duration = (Interval *) palloc(sizeof(Interval));
+  duration->month = duration->day = 0;
+  duration->time = (TimeOffset) cell->duration;
+
+  Datum values[3];
+  bool isnull[3] = {false, false, false};
+  values[0] = PointerGetDatum(tile);
+  values[1] = PointerGetDatum(duration);
+  values[2] = Int64GetDatum(cell->visits);
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
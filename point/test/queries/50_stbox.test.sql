@@ -415,3 +415,13 @@ SELECT count(*) FROM tbl_stbox t1, tbl_stbox t2 WHERE t1.b > t2.b;
 SELECT count(*) FROM tbl_stbox t1, tbl_stbox t2 WHERE t1.b >= t2.b;
 
 -------------------------------------------------------------------------------
+
+SELECT zorder(stbox 'STBOX T((0, 0, 2001-01-01), (0, 0, 2001-01-01))', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(stbox 'STBOX T((100, 100, 2001-01-11), (100, 100, 2001-01-11))', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(stbox 'STBOX T((40, 10, 2001-01-02), (60, 40, 2001-01-04))', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(stbox 'STBOX T((80, 90, 2001-01-08), (80, 90, 2001-01-08))', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(stbox 'STBOX T((200, -10, 2000-01-01), (200, -10, 2000-01-01))', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(stbox 'STBOX((1, 1), (2, 2))', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(stbox 'STBOX T((1, 1, 2001-01-02), (2, 2, 2001-01-02))', stbox 'STBOX((0, 0), (100, 100))');
+
+-------------------------------------------------------------------------------
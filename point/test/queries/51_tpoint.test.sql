@@ -8,6 +8,8 @@ SELECT asText(tgeompoint 'Point(1 1)@2012-01-01 08:00:00');
 SELECT asText(tgeompoint '  Point(2 2)@2012-01-01 08:00:00  ');
 SELECT asText(tgeogpoint 'Point(1 1)@2012-01-01 08:00:00');
 SELECT asText(tgeogpoint '  Point(2 2) @ 2012-01-01 08:00:00  ');
+SELECT asText(tgeompoint 'Point(1 1 1)@2012-01-01 08:00:00');
+SELECT asEWKT(tgeompoint 'SRID=5676;Point Z(1 1 1)@2012-01-01 08:00:00');
 /* Errors */
 SELECT tgeompoint 'TRUE@2012-01-01 08:00:00';
 SELECT tgeogpoint 'ABC@2012-01-01 08:00:00';
@@ -44,6 +46,8 @@ SELECT asText(tgeompoint '[Point(1 1)@2001-01-01 08:00:00,Point(2 2)@2001-01-01
 SELECT asText(tgeogpoint ' [ Point(1 1)@2001-01-01 08:00:00 , Point(2 2)@2001-01-01 08:05:00 , Point(3 3)@2001-01-01 08:06:00 ] ');
 SELECT asText(tgeogpoint '[Point(1 1)@2001-01-01 08:00:00,Point(2 2)@2001-01-01 08:05:00,Point(3 3)@2001-01-01 08:06:00]');
 SELECT asText(tgeompoint '[Point(1 1 1)@2001-01-01, Point(2 2 2)@2001-01-02, Point(3 3 3)@2001-01-03]');
+SELECT asText(tgeogpoint '[Point(0 0)@2001-01-01, Point(0 1)@2001-01-02, Point(0 2)@2001-01-03]');
+SELECT asewkt(tgeompoint 'Interp=Stepwise;[Point(1 1)@2001-01-01, Point(1 1)@2001-01-02, Point(2 2)@2001-01-03]');
 /* Errors */
 SELECT tgeompoint '[Point(1 1)@2001-01-01 08:00:00,Point empty@2001-01-01 08:05:00,Point(3 3)@2001-01-01 08:06:00]';
 SELECT tgeogpoint '[Point(1 1)@2001-01-01 08:00:00,Point empty@2001-01-01 08:05:00,Point(3 3)@2001-01-01 08:06:00]';
@@ -433,6 +437,10 @@ tgeogpointinst(ST_Point(1,1), '2012-01-01 08:20:00')
 /* Errors */
 SELECT tgeompointseq(ARRAY[tgeompoint 'SRID=5676;Point(1 1)@2001-01-01', 'SRID=4326;Point(2 2)@2001-01-02']);
 SELECT tgeompointseq(ARRAY[tgeompoint 'Point(1 1)@2001-01-01', 'Point(2 2 2)@2001-01-02']);
+SELECT asText(tgeompointseq(ARRAY[timestamptz '2000-01-01', '2000-01-02', '2000-01-03'], ARRAY[geometry 'Point(1 1)', 'Point(2 2)', 'Point(2 3)']));
+SELECT asText(tgeogpointseq(ARRAY[timestamptz '2000-01-01', '2000-01-02'], ARRAY[geography 'Point(1 1)', 'Point(2 2)']));
+SELECT tgeompointseq(ARRAY[timestamptz '2000-01-01', '2000-01-02'], ARRAY[geometry 'Point(1 1)', 'Linestring(1 1,2 2)']);
+SELECT tgeompointseq(ARRAY[timestamptz '2000-01-01', '2000-01-02'], ARRAY[geometry 'SRID=5676;Point(1 1)', 'SRID=4326;Point(2 2)']);
 
 -------------------------------------------------------------------------------
 
@@ -542,6 +550,10 @@ SELECT asText(appendInstant(tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2
 
 SELECT asText(appendInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', tgeompoint 'Point(3 3)@2000-01-03'));
 SELECT asText(appendInstant(tgeompoint 'Interp=Stepwise;[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', 'Point(3 3)@2000-01-04'));
+SELECT ST_AsText(trajectory(appendInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', 'Point(1 3)@2000-01-03')));
+SELECT stbox(appendInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', 'Point(1 3)@2000-01-03'));
+SELECT asText(appendInstants(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', ARRAY[tgeompoint 'Point(3 3)@2000-01-03', 'Point(4 3)@2000-01-04']));
+SELECT asText(appendInstant(inst ORDER BY i)) FROM (VALUES (1, tgeompoint '[Point(1 1)@2000-01-01]'), (2, tgeompoint 'Point(2 2)@2000-01-02'), (3, tgeompoint 'Point(2 3)@2000-01-03')) t(i, inst);
 /* Errors */
 SELECT asText(appendInstant(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02}', tgeompoint 'Point(3 3)@2000-01-02'));
 SELECT asText(appendInstant(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02}', tgeompoint 'Point(3 3 3)@2000-01-03'));
@@ -447,4 +447,16 @@ WHERE t1.temp > t2.temp;
 SELECT COUNT(*) FROM tbl_tgeogpoint3D t1, tbl_tgeogpoint3D t2
 WHERE t1.temp >= t2.temp;
 
+CREATE TABLE tbl_snapshot(k integer, trip tgeompoint);
+ALTER TABLE tbl_snapshot ALTER COLUMN trip SET STORAGE EXTERNAL;
+INSERT INTO tbl_snapshot SELECT k, tgeompointseq(array_agg(tgeompointinst(ST_Point(i, k), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) FROM generate_series(1, 3) k, generate_series(1, 1000) i GROUP BY k;
+SELECT k, ST_AsText(valueAtTimestamp(trip, '2000-01-01 00:01')) FROM tbl_snapshot ORDER BY k;
+SELECT k, ST_AsText(valueAtTimestamp(trip, '2000-01-01 01:05:30')) FROM tbl_snapshot ORDER BY k;
+SELECT k, ST_AsText(valueAtTimestamp(trip, '2000-01-01 08:20:30')) FROM tbl_snapshot ORDER BY k;
+SELECT k, ST_AsText(valueAtTimestamp(trip, '2000-01-01 16:40')) FROM tbl_snapshot ORDER BY k;
+SELECT COUNT(*) FROM tbl_snapshot WHERE valueAtTimestamp(trip, '2000-01-02') IS NOT NULL;
+SELECT ST_AsText(point) FROM snapshot('tbl_snapshot', 'trip', '2000-01-01 01:00') ORDER BY 1;
+SELECT COUNT(*) FROM snapshot('tbl_snapshot', 'trip', '2000-01-02');
+DROP TABLE tbl_snapshot;
+
 ------------------------------------------------------------------------------
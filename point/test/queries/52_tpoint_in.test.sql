@@ -63,4 +63,19 @@ select asEWKT(fromEWKB(asEWKB(tgeompoint 'SRID=5676;Point(1 1 1)@2000-01-01', 'X
 /* Errors */
 select asEWKT(fromEWKB(asEWKB(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', 'ABC')));
 
+-------------------------------------------------------------------------------
+
+SELECT asTWKB(tgeompoint 'Point(1 2)@2000-01-01');
+SELECT asTWKB(tgeompoint 'SRID=5676;Point(1 2)@2000-01-01');
+SELECT asEWKT(fromTWKB(asTWKB(tgeompoint 'Point(1 2)@2000-01-01')));
+SELECT asEWKT(fromTWKB(asTWKB(tgeompoint '{Point(1 2)@2000-01-01, Point(3 4)@2000-01-02}')));
+SELECT asEWKT(fromTWKB(asTWKB(tgeompoint '[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02)')));
+SELECT asEWKT(fromTWKB(asTWKB(tgeompoint 'Interp=Stepwise;[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02]')));
+SELECT asEWKT(fromTWKB(asTWKB(tgeompoint '{[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02],[Point(1 2)@2000-01-03, Point(3 4)@2000-01-04]}')));
+SELECT asEWKT(fromTWKB(asTWKB(tgeompoint 'SRID=4326;[Point(1.123 2.456 3.789)@2000-01-01 00:00:00.5, Point(4 5 6)@2000-01-02]', 2, 1, 1)));
+/* Errors */
+SELECT asTWKB(tgeompoint 'Point(1 2)@2000-01-01', 8);
+SELECT asTWKB(tgeompoint 'Point(1 2)@2000-01-01', 0, 0, 7);
+SELECT fromTWKB('\x0100000204');
+
 ----------------------------------------------------------------------
\ No newline at end of file
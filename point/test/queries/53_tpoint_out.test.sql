@@ -65,6 +65,11 @@ SELECT asMFJSON(tgeompoint 'Point(1 1)@2000-01-01',-1);
 SELECT asMFJSON(tgeompoint 'SRID=4326;Point(50.813810 4.384260)@2019-01-01 18:00:00.15+02', 2, 3);
 SELECT asMFJSON(tgeompoint 'SRID=4326;Point(50.813810 4.384260)@2019-01-01 18:00:00.15+02', 2, 4);
 SELECT asMFJSON(tgeompoint '[Point(1 2 3)@2019-01-01, Point(4 5 6)@2019-01-02]', 2, 1);
+SELECT asMFJSONCollection(temp) FROM (VALUES (tgeompoint 'Point(1 1)@2000-01-01'), (tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]')) t(temp);
+SELECT asMFJSONCollection(temp, 2, 3) FROM (VALUES (tgeompoint 'SRID=4326;Point(50.813810 4.384260)@2019-01-01 18:00:00.15+02'), (tgeompoint 'SRID=4326;Point(50.813810 4.384260)@2019-01-01 18:00:00.15+02')) t(temp);
+SELECT split_part(asMFJSONCollection(temp, 15, 8), E'\n', 2) FROM (VALUES (tgeompoint 'Point(1 1)@2000-01-01'), (tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]')) t(temp);
+SELECT array_length(string_to_array(asMFJSONCollection(temp, 15, 8), E'\n'), 1) FROM (VALUES (tgeompoint 'Point(1 1)@2000-01-01'), (tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]')) t(temp);
+SELECT asMFJSONCollection(temp) FROM (VALUES (NULL::tgeompoint)) t(temp);
 
 /* Errors */
 SELECT asMFJSON(tgeompoint 'SRID=123456;Point(50.813810 4.384260)@2019-01-01 18:00:00.15+02', 2, 4);
@@ -84,6 +89,14 @@ select asHexEWKB(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', 'NDR');
 select asHexEWKB(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', 'XDR');
 /* Errors */
 select asEWKB(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', 'ABCD');
+SELECT asArrow(temp) FROM (VALUES (tgeompoint 'SRID=4326;[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02]'), (tgeompoint 'SRID=4326;Point(5 6)@2000-01-03')) t(temp);
+SELECT asArrow(temp) FROM (VALUES (tgeompoint '{Point(1 2 3)@2000-01-01, Point(4 5 6)@2000-01-02}')) t(temp);
+SELECT asArrow(temp) FROM (VALUES (tgeogpoint 'Point(1 2)@2000-01-01')) t(temp);
+/* Errors */
+SELECT asArrow(temp) FROM (VALUES (tgeompoint 'SRID=4326;Point(1 1)@2000-01-01'), (tgeompoint 'SRID=5676;Point(1 1)@2000-01-02')) t(temp);
+SELECT asArrow(temp) FROM (VALUES (tgeompoint 'Point(1 1)@2000-01-01'), (tgeompoint 'Point(1 1 1)@2000-01-02')) t(temp);
+SELECT id, asEWKT(temp) FROM tgeompointFromArrow((SELECT asArrow(temp) FROM (VALUES (tgeompoint 'SRID=4326;[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02]'), (tgeompoint 'SRID=4326;Point(5 6)@2000-01-03')) t(temp)));
+SELECT id, asEWKT(temp) FROM tgeogpointFromArrow((SELECT asArrow(tgeogpoint '[Point(1 2 3)@2000-01-01, Point(4 5 6)@2000-01-03]')), '1 day');
 
 -------------------------------------------------------------------------------
 
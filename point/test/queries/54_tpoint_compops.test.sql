@@ -328,4 +328,14 @@ SELECT tgeogpoint '{Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02
 SELECT tgeogpoint '[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03]' #<> tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}';
 SELECT tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}' #<> tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}';
 
+
+CREATE TABLE tbl_compops_traj(k int, temp tgeompoint);
+ALTER TABLE tbl_compops_traj ALTER COLUMN temp SET STORAGE EXTERNAL;
+SET mobilitydb.precompute_trajectory = off;
+INSERT INTO tbl_compops_traj SELECT 1, tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) FROM generate_series(0, 999) i;
+RESET mobilitydb.precompute_trajectory;
+INSERT INTO tbl_compops_traj SELECT 2, tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) FROM generate_series(0, 999) i;
+SELECT t1.temp = t2.temp, t1.temp <> t2.temp FROM tbl_compops_traj t1, tbl_compops_traj t2 WHERE t1.k = 1 AND t2.k = 2;
+DROP TABLE tbl_compops_traj;
+
 -------------------------------------------------------------------------------
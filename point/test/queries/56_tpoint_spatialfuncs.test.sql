@@ -129,6 +129,15 @@ SELECT ST_AsText(trajectory(tgeompoint '{[Point(1 1)@2001-01-01], [Point(1 1)@20
 SELECT ST_AsText(trajectory(tgeogpoint '{[Point(1 1)@2001-01-01], [Point(1 1)@2001-02-01], [Point(1 1)@2001-03-01]}'));
 SELECT ST_AsText(trajectory(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02],[Point(1 1)@2000-01-03, Point(2 2)@2000-01-04]}'));
 
+SET mobilitydb.precompute_trajectory = off;
+SELECT ST_AsText(trajectory(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]'));
+SELECT ST_AsText(trajectory(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}'));
+SELECT ST_AsText(trajectory(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02],[Point(1 1)@2000-01-03, Point(2 2)@2000-01-04]}'));
+RESET mobilitydb.precompute_trajectory;
+SELECT COUNT(*) FROM generate_series(1, 3) i, (VALUES (tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'), (tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(5 5)@2000-01-04, Point(5 5)@2000-01-05]}')) t(temp) WHERE dwithin(temp, geometry 'Point(3 3)', 0.5);
+SELECT DISTINCT ST_AsText(trajectory(temp)) FROM generate_series(1, 3) i, (VALUES (tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'), (tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(5 5)@2000-01-04, Point(5 5)@2000-01-05]}')) t(temp) ORDER BY 1;
+SELECT DISTINCT round(nearestApproachDistance(temp, geometry 'Point(3 3)')::numeric, 6) FROM generate_series(1, 3) i, (VALUES (tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'), (tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(5 5)@2000-01-04, Point(5 5)@2000-01-05]}')) t(temp) ORDER BY 1;
+
 --------------------------------------------------------
 
 -- 2D
@@ -144,6 +153,10 @@ SELECT round(length(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-
 SELECT round(length(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}')::numeric, 6);
 SELECT round(length(tgeogpoint 'Interp=Stepwise;[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]')::numeric, 6);
 SELECT round(length(tgeogpoint 'Interp=Stepwise;{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}')::numeric, 6);
+SET mobilitydb.use_spheroid = off;
+SELECT round(length(tgeogpoint '[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02]')::numeric, 0);
+RESET mobilitydb.use_spheroid;
+SELECT round(length(tgeogpoint '[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02]')::numeric, 0);
 -- 3D
 SELECT round(length(tgeompoint 'Point(1 1 1)@2000-01-01')::numeric, 6);
 SELECT round(length(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}')::numeric, 6);
@@ -211,6 +224,14 @@ SELECT round(speed(tgeogpoint '[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5
 SELECT round(speed(tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}'), 6);
 SELECT round(speed(tgeogpoint 'Interp=Stepwise;[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03]'), 6);
 SELECT round(speed(tgeogpoint 'Interp=Stepwise;{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}'), 6);
+SELECT minSpeed(tgeompoint 'Point(1 1)@2000-01-01');
+SELECT minSpeed(temp), maxSpeed(temp) FROM (SELECT tgeompoint '[Point(0 0)@2000-01-01 00:00:00, Point(10 0)@2000-01-01 00:00:10, Point(10 30)@2000-01-01 00:00:20]' AS temp) t;
+SELECT minSpeed(temp), maxSpeed(temp) FROM (SELECT tgeompoint 'Interp=Stepwise;[Point(0 0)@2000-01-01 00:00:00, Point(10 0)@2000-01-01 00:00:10, Point(10 30)@2000-01-01 00:00:20]' AS temp) t;
+SELECT maxSpeed(tgeompoint '{[Point(0 0)@2000-01-01 00:00:00, Point(10 0)@2000-01-01 00:00:10], [Point(10 30)@2000-01-01 00:00:20]}');
+SELECT length(temp), minSpeed(temp), maxSpeed(temp) FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_Point(i * i, 0), timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t;
+SELECT length(temp), minSpeed(temp), maxSpeed(temp) FROM (SELECT appendInstant(temp, tgeompointinst(ST_Point(4225, 0), '2000-01-01 00:01:05')) AS temp FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_Point(i * i, 0), timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t1) t2;
+SELECT length(temp), minSpeed(temp), maxSpeed(temp) FROM (SELECT tscale(temp, '128 seconds') AS temp FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_Point(i * i, 0), timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t1) t2;
+SELECT maxSpeed(temp) = maxValue(speed(temp)) FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_Point(i * i, 0), timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t;
 
 -- 2D
 SELECT st_astext(twcentroid(tgeompoint 'Point(1 1)@2000-01-01'));
@@ -219,6 +240,7 @@ SELECT st_astext(twcentroid(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-
 SELECT st_astext(twcentroid(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'));
 SELECT st_astext(twcentroid(tgeompoint 'Interp=Stepwise;[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]'));
 SELECT st_astext(twcentroid(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'));
+SELECT st_astext(twcentroid(tgeompoint '{[Point(1 1)@2000-01-01], [Point(3 3)@2000-01-02]}'));
 -- 3D
 SELECT st_astext(twcentroid(tgeompoint 'Point(1 1 1)@2000-01-01'));
 SELECT st_astext(twcentroid(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}'));
@@ -226,6 +248,7 @@ SELECT st_astext(twcentroid(tgeompoint '[Point(1 1 1)@2000-01-01, Point(2 2 2)@2
 SELECT st_astext(twcentroid(tgeompoint '{[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03],[Point(3 3 3)@2000-01-04, Point(3 3 3)@2000-01-05]}'));
 SELECT st_astext(twcentroid(tgeompoint 'Interp=Stepwise;[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03]'));
 SELECT st_astext(twcentroid(tgeompoint 'Interp=Stepwise;{[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03],[Point(3 3 3)@2000-01-04, Point(3 3 3)@2000-01-05]}'));
+SELECT st_astext(twcentroid(tgeompoint '{[Point(1 1 1)@2000-01-01], [Point(3 3 3)@2000-01-02]}'));
 
 -- 2D
 SELECT round(degrees(azimuth(tgeompoint 'Point(1 1)@2000-01-01')), 6);
@@ -279,6 +302,14 @@ SELECT round(degrees(azimuth(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000
 SELECT round(degrees(azimuth(tgeompoint '(Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(1 1)@2000-01-03, Point(0 0)@2000-01-04]')), 6);
 SELECT round(degrees(azimuth(tgeompoint '(Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(1 1)@2000-01-03, Point(0 0)@2000-01-04)')), 6);
 
+SELECT (m).cumulativeLength = cumulativeLength(temp) AND (m).speed = speed(temp) AND (m).azimuth = azimuth(temp)
+FROM (SELECT temp, trajectoryMetrics(temp) AS m FROM (SELECT tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(2 2)@2000-01-03, Point(1 1)@2000-01-04]') t1(temp)) t2;
+SELECT (m).cumulativeLength = cumulativeLength(temp) AND (m).speed = speed(temp) AND (m).azimuth = azimuth(temp)
+FROM (SELECT temp, trajectoryMetrics(temp) AS m FROM (SELECT tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}') t1(temp)) t2;
+SELECT (trajectoryMetrics(tgeompoint '[Point(0 0)@2000-01-01 00:00:00, Point(1 0)@2000-01-01 00:00:01, Point(4 0)@2000-01-01 00:00:02]')).acceleration;
+SELECT (trajectoryMetrics(tgeompoint 'Interp=Stepwise;[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]')).acceleration;
+SELECT (trajectoryMetrics(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02}')).speed IS NULL;
+
 --------------------------------------------------------
 
 -- 2D
@@ -288,6 +319,18 @@ SELECT asText(atGeometry(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-
 SELECT asText(atGeometry(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', geometry 'Linestring(0 0,3 3)'));
 SELECT asText(atGeometry(tgeompoint 'Interp=Stepwise;[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]', geometry 'Linestring(0 0,3 3)'));
 SELECT asText(atGeometry(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', geometry 'Linestring(0 0,3 3)'));
+SELECT asText(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((100 -1,101 -1,101 2,100 2,100 -1))')) FROM generate_series(1, 300) i;
+SELECT numInstants(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((120 -1,140 -1,140 2,120 2,120 -1))')) FROM generate_series(1, 300) i;
+SELECT asText(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((100 5,101 5,101 6,100 6,100 5))')) FROM generate_series(1, 300) i;
+SELECT numInstants(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((0 -1,301 -1,301 2,0 2,0 -1))')) FROM generate_series(1, 300) i;
+SELECT getTime(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((0 -1,150.5 -1,150.5 2,0 2,0 -1))')) FROM generate_series(1, 300) i;
+CREATE TABLE tbl_parallel AS SELECT temp, speed(temp) AS speed, atGeometry(temp, geometry 'Polygon((1000 -1,3500 -1,3500 2,1000 2,1000 -1))') AS atgeo FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 7), timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(1, 5000) i) t;
+SET mobilitydb.parallel_workers = 2;
+SET mobilitydb.parallel_min_instants = 2;
+SELECT speed(temp) = speed, atGeometry(temp, geometry 'Polygon((1000 -1,3500 -1,3500 2,1000 2,1000 -1))') = atgeo FROM tbl_parallel;
+RESET mobilitydb.parallel_workers;
+RESET mobilitydb.parallel_min_instants;
+DROP TABLE tbl_parallel;
 
 SELECT asText(atGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Linestring empty'));
 SELECT asText(atGeometry(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}', geometry 'Linestring empty'));
@@ -354,6 +397,9 @@ SELECT asText(minusGeometry(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-
 SELECT asText(minusGeometry(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02)}', geometry 'Linestring(0 1,2 1)'));
 SELECT asText(minusGeometry(tgeompoint '[Point(1 1)@2000-01-01, Point(3 3)@2000-01-02]','Point(2 2)'));
 SELECT asText(minusGeometry(tgeompoint '{[Point(1 1)@2000-01-01, Point(3 3)@2000-01-02],[Point(3 3)@2000-01-03]}','Point(2 2)'));
+-- Polygon with an index of its edges
+SELECT asText(atGeometry(tgeompoint '[Point(-2 1)@2000-01-01, Point(6 1)@2000-01-09]', ST_Segmentize(geometry 'Polygon((0 0,0 4,4 4,4 0,0 0))', 0.25)));
+SELECT asText(minusGeometry(tgeompoint '[Point(-2 1)@2000-01-01, Point(6 1)@2000-01-09]', ST_Segmentize(geometry 'Polygon((0 0,0 4,4 4,4 0,0 0))', 0.25)));
 /* Errors */
 SELECT minusGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Linestring(1 1,2 2)');
 SELECT minusGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Linestring(1 1 1,2 2 2)');
@@ -369,6 +415,17 @@ SELECT asText(atStbox(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point
 
 SELECT asText(atStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX((1,1),(2,2))'));
 SELECT asText(atStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX T((,2000-01-01),(,2000-01-02))'));
+SELECT asText(atStbox(tgeompoint '[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05]', 'STBOX((1,1),(2,3))'));
+SELECT asText(atStbox(tgeompoint '[Point(0 0 0)@2000-01-01, Point(4 4 4)@2000-01-05]', 'STBOX ZT((0,0,1,2000-01-01),(4,4,2,2000-01-05))'));
+SELECT atStbox(temp::tgeompoint(Packed), 'STBOX((10,0),(20,1))') = atStbox(temp, 'STBOX((10,0),(20,1))')
+FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i % 200, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT numSequences(atStbox(temp::tgeompoint(Packed), 'STBOX((10,0),(20,1))'))
+FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i % 200, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT atStbox(temp::tgeompoint(Compressed), 'STBOX((10,0),(20,1))') = atStbox(temp, 'STBOX((10,0),(20,1))')
+FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i % 200, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
 
 SELECT asText(minusStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
 SELECT asText(minusStbox(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
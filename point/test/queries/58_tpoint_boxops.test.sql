@@ -105,6 +105,15 @@ SELECT geography 'Point Z empty' && tgeogpoint '{Point(1.5 1.5 1.5)@2000-01-01,
 SELECT geography 'Point Z empty' && tgeogpoint '[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03]';
 SELECT geography 'Point Z empty' && tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}';
 
+SELECT tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-02, Point(10 10)@2000-01-03]' && geometry 'Point(2 8)';
+SELECT tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-02, Point(10 10)@2000-01-03]' &&& geometry 'Point(2 8)';
+SELECT tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-02, Point(10 10)@2000-01-03]' &&& geometry 'Point(5 0)';
+SELECT geometry 'Point(2 8)' &&& tgeompoint '{Point(0 0)@2000-01-01, Point(10 10)@2000-01-02}';
+SELECT tgeompoint 'Interp=Stepwise;[Point(0 0)@2000-01-01, Point(10 10)@2000-01-03]' &&& stbox 'STBOX T((9,9,2000-01-02),(11,11,2000-01-02))';
+SELECT tgeompoint 'Interp=Stepwise;[Point(0 0)@2000-01-01, Point(10 10)@2000-01-03]' &&& stbox 'STBOX T((9,9,2000-01-03),(11,11,2000-01-03))';
+SELECT stbox 'STBOX((4,4),(6,6))' &&& tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02], [Point(9 9)@2000-01-03, Point(10 10)@2000-01-04]}';
+SELECT geometry 'Point empty' &&& tgeompoint 'Point(1 1)@2000-01-01';
+
 SELECT timestamptz '2000-01-01' && tgeompoint 'Point(1 1)@2000-01-01';
 SELECT timestamptz '2000-01-01' && tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}';
 SELECT timestamptz '2000-01-01' && tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]';
@@ -1589,3 +1598,9 @@ SELECT tgeompoint 'SRID=5676;Point(1 1)@2000-01-01' ~= tgeompoint 'Point(1 1)@20
 SELECT tgeompoint 'Point(1 1 1)@2000-01-01' ~= tgeompoint 'Point(1 1)@2000-01-01';
 
 -------------------------------------------------------------------------------
+
+SELECT zorder(tgeompoint '[Point(40 10)@2001-01-02, Point(60 40)@2001-01-04]', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(tgeompoint '{Point(80 90)@2001-01-08}', stbox 'STBOX T((0, 0, 2001-01-01), (100, 100, 2001-01-11))');
+SELECT zorder(tgeompoint 'Point(1 1)@2001-01-02', stbox 'STBOX((0, 0), (100, 100))');
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,29 @@
+-------------------------------------------------------------------------------
+-- Similarity distances
+-------------------------------------------------------------------------------
+
+SELECT round(frechetDistance(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02, Point(2 0)@2000-01-03]', tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-03]')::numeric, 6);
+SELECT round(dynTimeWarpDistance(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02, Point(2 0)@2000-01-03]', tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-03]')::numeric, 6);
+SELECT round(hausdorffDistance(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02, Point(2 0)@2000-01-03]', tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-03]')::numeric, 6);
+SELECT round(similarityLowerBound(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02, Point(2 0)@2000-01-03]', tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-03]')::numeric, 6);
+
+SELECT round(frechetDistance(tgeompoint 'Point(0 0)@2000-01-01', tgeompoint '{Point(3 4)@2000-01-01, Point(6 8)@2000-01-02}')::numeric, 6);
+SELECT round(dynTimeWarpDistance(tgeompoint 'Point(0 0)@2000-01-01', tgeompoint '{Point(3 4)@2000-01-01, Point(6 8)@2000-01-02}')::numeric, 6);
+SELECT round(hausdorffDistance(tgeompoint 'Point(0 0)@2000-01-01', tgeompoint '{Point(3 4)@2000-01-01, Point(6 8)@2000-01-02}')::numeric, 6);
+SELECT round(similarityLowerBound(tgeompoint 'Point(0 0)@2000-01-01', tgeompoint '{Point(3 4)@2000-01-01, Point(6 8)@2000-01-02}')::numeric, 6);
+
+SELECT round(frechetDistance(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02], [Point(1 1)@2000-01-03, Point(2 2)@2000-01-04]}', tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]')::numeric, 6);
+SELECT round(dynTimeWarpDistance(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02], [Point(1 1)@2000-01-03, Point(2 2)@2000-01-04]}', tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]')::numeric, 6);
+SELECT round(hausdorffDistance(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02], [Point(1 1)@2000-01-03, Point(2 2)@2000-01-04]}', tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]')::numeric, 6);
+SELECT round(similarityLowerBound(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02], [Point(1 1)@2000-01-03, Point(2 2)@2000-01-04]}', tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]')::numeric, 6);
+
+SELECT round(frechetDistance(tgeompoint '[Point(0 0 0)@2000-01-01, Point(0 0 2)@2000-01-02]', tgeompoint '[Point(0 0 1)@2000-01-01, Point(0 0 3)@2000-01-02]')::numeric, 6);
+SELECT round(dynTimeWarpDistance(tgeompoint '[Point(0 0 0)@2000-01-01, Point(0 0 2)@2000-01-02]', tgeompoint '[Point(0 0 1)@2000-01-01, Point(0 0 3)@2000-01-02]')::numeric, 6);
+SELECT round(hausdorffDistance(tgeompoint '[Point(0 0 0)@2000-01-01, Point(0 0 2)@2000-01-02]', tgeompoint '[Point(0 0 1)@2000-01-01, Point(0 0 3)@2000-01-02]')::numeric, 6);
+SELECT round(similarityLowerBound(tgeompoint '[Point(0 0 0)@2000-01-01, Point(0 0 2)@2000-01-02]', tgeompoint '[Point(0 0 1)@2000-01-01, Point(0 0 3)@2000-01-02]')::numeric, 6);
+
+/* Errors */
+SELECT frechetDistance(tgeompoint 'SRID=5676;[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02]', tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]');
+SELECT frechetDistance(tgeompoint '[Point(0 0 0)@2000-01-01, Point(0 0 2)@2000-01-02]', tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]');
+
+-------------------------------------------------------------------------------
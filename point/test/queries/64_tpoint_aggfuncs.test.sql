@@ -12,6 +12,13 @@ SELECT asText(tcentroid(temp)) FROM (VALUES
   (tgeompoint '[Point(3 3 3)@2000-01-03, Point(4 4 4)@2000-01-04)'),
   (tgeompoint '[Point(2 2 2)@2000-01-02, Point(3 3 3)@2000-01-03)')) t(temp);
 
+SELECT asText(tcentroid(temp)) FROM (VALUES 
+  (tgeompoint 'Point(1 1)@2000-01-01'),
+  (tgeompoint '{Point(3 3)@2000-01-01, Point(2 2)@2000-01-02}')) t(temp);
+SELECT asText(tcentroid(temp)) FROM (VALUES 
+  (tgeompoint '[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05]'),
+  (tgeompoint '[Point(2 0)@2000-01-03, Point(2 2)@2000-01-05]')) t(temp);
+
 /* Errors */
 SELECT asText(tcentroid(temp)) FROM (VALUES 
   (tgeompoint 'Point(0 0)@2000-01-01'),
@@ -52,5 +59,21 @@ SELECT setprecision(extent(temp), 13) FROM (VALUES
 SELECT extent(temp) FROM (VALUES
   (tgeompoint 'Point(1 1 1)@2000-01-01'),
   (tgeompoint 'Point(1 1)@2000-01-01')) t(temp);
+SELECT tcountWithin(temp, geometry 'SRID=5676;Polygon((0 0,0 2,2 2,2 0,0 0))') FROM (VALUES
+  (tgeompoint '[Point(1 1)@2000-01-01, Point(3 1)@2000-01-03]')) t(temp);
+
+-------------------------------------------------------------------------------
+
+SELECT asText(tsequenceAgg(g, t)) FROM (VALUES (geometry 'Point(2 2)', timestamptz '2000-01-02'), ('Point(1 1)', '2000-01-01'), ('Point(3 3)', '2000-01-03')) t(g, t);
+
+SELECT tcountWithin(temp, geometry 'Polygon((0 0,0 2,2 2,2 0,0 0))') = tcount(atGeometry(temp, geometry 'Polygon((0 0,0 2,2 2,2 0,0 0))')) FROM (VALUES
+  (tgeompoint '[Point(1 1)@2000-01-01, Point(3 1)@2000-01-03]'),
+  (tgeompoint '[Point(3 0)@2000-01-01, Point(1 0)@2000-01-03]'),
+  (tgeompoint '{[Point(5 5)@2000-01-01, Point(1 1)@2000-01-02], [Point(1 1)@2000-01-03, Point(1 1)@2000-01-04]}')) t(temp);
+SELECT numInstants(tcountWithin(temp, geometry 'Polygon((0 0,0 2,2 2,2 0,0 0))')) FROM (VALUES
+  (tgeompoint '{Point(1 1)@2000-01-01, Point(3 3)@2000-01-02}'),
+  (tgeompoint 'Point(1 1)@2000-01-02')) t(temp);
+SELECT tcountWithin(temp, geometry 'Polygon((0 0,0 2,2 2,2 0,0 0))') FROM (VALUES
+  (tgeompoint '[Point(5 5)@2000-01-01, Point(6 6)@2000-01-02]')) t(temp);
 
 -------------------------------------------------------------------------------
@@ -51,6 +51,9 @@ SELECT numSequences(tcount(ts)) FROM tbl_tgeompoints;
 SELECT k%10, numSequences(tcentroid(ts)) FROM tbl_tgeompoints GROUP BY k%10 ORDER BY k%10;
 SELECT k%10, numSequences(tcount(ts)) FROM tbl_tgeompoints GROUP BY k%10 ORDER BY k%10;
 
+SELECT tcountWithin(seq, geometry 'Polygon((0 0,0 50,50 50,50 0,0 0))') = tcount(atGeometry(seq, geometry 'Polygon((0 0,0 50,50 50,50 0,0 0))')) FROM tbl_tgeompointseq;
+SELECT tcountWithin(ts, geometry 'Polygon((0 0,0 50,50 50,50 0,0 0))') = tcount(atGeometry(ts, geometry 'Polygon((0 0,0 50,50 50,50 0,0 0))')) FROM tbl_tgeompoints;
+
 SELECT numInstants(tcentroid(inst)) FROM tbl_tgeompoint3Dinst;
 SELECT numInstants(tcount(inst)) FROM tbl_tgeompoint3Dinst;
 SELECT k%10, numInstants(tcentroid(inst)) FROM tbl_tgeompoint3Dinst GROUP BY k%10 ORDER BY k%10;
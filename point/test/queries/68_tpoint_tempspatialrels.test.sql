@@ -336,6 +336,8 @@ SELECT tintersects(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, P
 SELECT tintersects(tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-04]', geometry 'Linestring(1 0,1 1,2 1,2 0)');
 SELECT tintersects(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-04)', geometry 'Linestring(1 1,2 1)');
 SELECT tintersects(tgeompoint '[Point(1 1)@2000-01-01, Point(0 0)@2000-01-04)', geometry 'Linestring(0 0,1 1)');
+SELECT tintersects(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((0 -1,150.5 -1,150.5 2,0 2,0 -1))') FROM generate_series(1, 300) i;
+SELECT tintersects(tgeompointseq(array_agg(tgeompointinst(ST_Point(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((100 5,101 5,101 6,100 6,100 5))') FROM generate_series(1, 300) i;
 
 SELECT tintersects(tgeompoint 'Point(1 1)@2000-01-01',  geometry 'Point empty');
 SELECT tintersects(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}',  geometry 'Point empty');
@@ -649,6 +651,25 @@ SELECT tdwithin(tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint 'Point(1 1)@200
 SELECT tdwithin(tgeogpoint 'SRID=4283;Point(1 1)@2000-01-01', tgeogpoint 'Point(1.5 1.5)@2000-01-01', 2);
 SELECT tdwithin(tgeogpoint 'Point(1.5 1.5 1.5)@2000-01-01', tgeogpoint 'Point(1.5 1.5)@2000-01-01', 2);
 
+SELECT i, j, result FROM tdwithinPairs(ARRAY[tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-02]', tgeompoint '[Point(0 1)@2000-01-01, Point(10 1)@2000-01-02]', tgeompoint '[Point(100 100)@2000-01-01, Point(110 100)@2000-01-02]'], 2);
+SELECT i, j, result FROM tdwithinPairs(ARRAY[tgeompoint 'Point(1 1)@2000-01-01', tgeompoint 'SRID=5676;Point(1 1)@2000-01-01'], 2);
+
+-------------------------------------------------------------------------------
+-- whenIntersects, whenDWithin
+-------------------------------------------------------------------------------
+
+SELECT whenIntersects(geometry 'Point(1 1)', tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}');
+SELECT whenIntersects(geometry 'Point(1 1)', tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}');
+SELECT whenIntersects(tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-04]', geometry 'Linestring(1 0,1 1,2 1,2 0)');
+SELECT whenIntersects(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Point(2 2)');
+SELECT whenIntersects(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Point empty');
+SELECT whenIntersects(tgeompoint '{[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05], [Point(4 0)@2000-01-06, Point(0 4)@2000-01-10]}', geometry 'Polygon((1 0,3 0,3 4,1 4,1 0))') = getTime(atGeometry(tgeompoint '{[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05], [Point(4 0)@2000-01-06, Point(0 4)@2000-01-10]}', geometry 'Polygon((1 0,3 0,3 4,1 4,1 0))'));
+SELECT whenDWithin(geometry 'Point(1 1)', tgeompoint '{Point(1 1)@2000-01-01, Point(4 4)@2000-01-02}', 2);
+SELECT whenDWithin(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]', geometry 'Point(1 1)', 2);
+SELECT whenDWithin(tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-11]', geometry 'Point(5 1)', 2) = getTime(atValue(tdwithin(tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-11]', geometry 'Point(5 1)', 2), true));
+SELECT whenIntersects(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Point(1 1)');
+SELECT whenDWithin(tgeompoint 'Point(1 1 1)@2000-01-01', geometry 'Point(1 1)', 2);
+
 -------------------------------------------------------------------------------
 -- trelate (2 arguments returns text)
 -------------------------------------------------------------------------------
@@ -98,6 +98,19 @@ SELECT count(*) FROM tbl_tgeompoint t1, tbl_tgeompoint t2
 SELECT count(*) FROM tbl_tgeogpoint t1, tbl_tgeogpoint t2
   WHERE tdwithin(t1.temp, t2.temp, 10) IS NOT NULL;
 
+WITH temps AS (
+  SELECT (row_number() OVER (ORDER BY k))::int AS n, temp
+  FROM tbl_tgeompoint WHERE temp IS NOT NULL ),
+pairs AS (
+  SELECT p.i, p.j
+  FROM (SELECT array_agg(temp ORDER BY n) AS arr FROM temps) t,
+    tdwithinPairs(t.arr, 10) p ),
+brute AS (
+  SELECT t1.n AS i, t2.n AS j FROM temps t1, temps t2
+  WHERE t1.n < t2.n AND tdwithin(t1.temp, t2.temp, 10) ?= true )
+SELECT count(*) FROM pairs FULL JOIN brute ON pairs.i = brute.i AND pairs.j = brute.j
+  WHERE pairs.i IS NULL OR brute.i IS NULL;
+
 -------------------------------------------------------------------------------
 -- trelate (2 arguments returns text)
 -------------------------------------------------------------------------------
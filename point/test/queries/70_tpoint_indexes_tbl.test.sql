@@ -95,7 +95,75 @@ SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp #&> tgeogpoint '[Point(1 1
 SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]' <<# temp;
 SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]' &<# temp;
 
+-- kNN restricted to the timespan of the query
+SELECT (SELECT array_agg(round((temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]'))::numeric, 6)) FROM (SELECT temp FROM tbl_tgeompoint3D_big ORDER BY temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]') LIMIT 5) t) = (SELECT array_agg(round((temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]'))::numeric, 6)) FROM (SELECT temp FROM tbl_tgeompoint3D_big ORDER BY (temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]')) + 0 LIMIT 5) t);
+
 DROP INDEX IF EXISTS tbl_tgeompoint3D_big_gist_idx;
 DROP INDEX IF EXISTS tbl_tgeogpoint3D_big_gist_idx;
 
 -------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tgeompoint3D_big_brin_idx ON tbl_tgeompoint3D_big USING BRIN(temp);
+CREATE INDEX tbl_tgeogpoint3D_big_brin_idx ON tbl_tgeogpoint3D_big USING BRIN(temp);
+
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp && geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp @> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp << geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp />> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp && tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp @> tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp << tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp />> tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp <<# tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp #&> tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp && geography 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp @> geography 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp && tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp @> tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp <<# tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp #&> tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+
+DROP INDEX IF EXISTS tbl_tgeompoint3D_big_brin_idx;
+DROP INDEX IF EXISTS tbl_tgeogpoint3D_big_brin_idx;
+
+-------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tgeompoint3D_big_compact_idx ON tbl_tgeompoint3D_big USING GIST(temp gist_tgeompoint_compact_ops);
+CREATE INDEX tbl_tgeogpoint3D_big_compact_idx ON tbl_tgeogpoint3D_big USING GIST(temp gist_tgeogpoint_compact_ops);
+
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp && geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp @> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp << geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp />> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp && tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp @> tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp << tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp />> tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp <<# tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp #&> tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp && geography 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp @> geography 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp && tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp @> tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp <<# tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp #&> tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+
+DROP INDEX IF EXISTS tbl_tgeompoint3D_big_compact_idx;
+DROP INDEX IF EXISTS tbl_tgeogpoint3D_big_compact_idx;
+
+-------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tgeompoint3D_big_stbox_idx ON tbl_tgeompoint3D_big USING GIST(stbox(temp));
+
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE stbox(temp) && stbox(tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]');
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE stbox(temp) @> stbox(tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]');
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE stbox(temp) << stbox(tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]');
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE stbox(temp) />> stbox(tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]');
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE stbox(temp) <<# stbox(tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]');
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE stbox(temp) #&> stbox(tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]');
+
+DROP INDEX IF EXISTS tbl_tgeompoint3D_big_stbox_idx;
+
+-------------------------------------------------------------------------------
@@ -81,7 +81,36 @@ SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp &<# tgeogpoint '[Point(1 1
 SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp #>> tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
 SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp #&> tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
 
+-- kNN restricted to the timespan of the query
+SELECT (SELECT array_agg(round((temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]'))::numeric, 6)) FROM (SELECT temp FROM tbl_tgeompoint3D_big ORDER BY temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]') LIMIT 5) t) = (SELECT array_agg(round((temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]'))::numeric, 6)) FROM (SELECT temp FROM tbl_tgeompoint3D_big ORDER BY (temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]')) + 0 LIMIT 5) t);
+
 DROP INDEX IF EXISTS tbl_tgeompoint3D_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_tgeogpoint3D_big_spgist_idx;
 
 -------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tgeompoint3D_big_kdtree_idx ON tbl_tgeompoint3D_big USING SPGIST(temp kdtree_tgeompoint_ops);
+CREATE INDEX tbl_tgeogpoint3D_big_kdtree_idx ON tbl_tgeogpoint3D_big USING SPGIST(temp kdtree_tgeogpoint_ops);
+
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp && geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp @> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp <@ geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp && tgeompoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp << geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp |&> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp />> geometry 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp <<# period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tgeompoint3D_big WHERE temp #&> period '[2001-01-01, 2001-02-01]';
+
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp && geography 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp @> geography 'Linestring(1 1 1,10 10 10)';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp <<# period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tgeogpoint3D_big WHERE temp && tgeogpoint '[Point(1 1 1)@2000-01-01, Point(10 10 10)@2000-01-02]';
+
+-- kNN restricted to the timespan of the query
+SELECT (SELECT array_agg(round((temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]'))::numeric, 6)) FROM (SELECT temp FROM tbl_tgeompoint3D_big ORDER BY temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]') LIMIT 5) t) = (SELECT array_agg(round((temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]'))::numeric, 6)) FROM (SELECT temp FROM tbl_tgeompoint3D_big ORDER BY (temp |=| stbox(geometry 'Point(50 50 50)', period '[2001-06-01, 2001-07-01]')) + 0 LIMIT 5) t);
+
+DROP INDEX IF EXISTS tbl_tgeompoint3D_big_kdtree_idx;
+DROP INDEX IF EXISTS tbl_tgeogpoint3D_big_kdtree_idx;
+
+-------------------------------------------------------------------------------
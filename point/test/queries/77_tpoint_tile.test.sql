@@ -0,0 +1,17 @@
+-------------------------------------------------------------------------------
+
+SELECT * FROM spaceSplit(tgeompoint '[Point(1 1)@2000-01-01, Point(3 1)@2000-01-03]', 2, 2);
+SELECT * FROM spaceTimeSplit(tgeompoint '[Point(1 1)@2000-01-01, Point(3 1)@2000-01-03]', 2, 2, '1 day');
+SELECT * FROM timeSplit(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02}', '1 day');
+SELECT * FROM spaceSplit(tgeompoint 'Point(1 1)@2000-01-01', 0, 2);
+SELECT * FROM spaceSplit(tgeompoint 'Point(1 1)@2000-01-01', 1, 1, geometry 'Linestring(0 0,1 1)');
+
+SELECT c.* FROM (SELECT dwellTimeGrid(trip, 1, 1) AS grid FROM (VALUES (tgeompoint '[Point(0.5 0.5)@2000-01-01 00:00, Point(2.5 0.5)@2000-01-01 02:00]'), ('[Point(1.5 0.5)@2000-01-01 00:00, Point(1.5 0.5)@2000-01-01 01:00]')) t(trip)) g, dwellTimeCells(grid) c;
+SELECT c.* FROM (SELECT dwellTimeGrid(trip, 1, 1, '1 hour') AS grid FROM (VALUES (tgeompoint '[Point(0.5 0.5)@2000-01-01 00:00, Point(2.5 0.5)@2000-01-01 02:00]'), ('[Point(1.5 0.5)@2000-01-01 00:00, Point(1.5 0.5)@2000-01-01 01:00]')) t(trip)) g, dwellTimeCells(grid) c;
+SELECT c.* FROM (SELECT dwellTimeGrid(trip, 2, 2, geometry 'Point(1 0)') AS grid FROM (VALUES (tgeompoint '[Point(0.5 0.5)@2000-01-01 00:00, Point(2.5 0.5)@2000-01-01 02:00]'), ('[Point(1.5 0.5)@2000-01-01 00:00, Point(1.5 0.5)@2000-01-01 01:00]')) t(trip)) g, dwellTimeCells(grid) c;
+WITH t AS (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i * 0.1, sin(i * 0.05) * 5), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS trip FROM generate_series(0, 999) i) SELECT bool_and(abs(extract(epoch FROM c.duration - timespan(atStbox(trip, c.tile)))) < 0.001), sum(c.duration) = (SELECT timespan(trip) FROM t) FROM t, (SELECT dwellTimeGrid(trip, 1, 1) AS grid FROM t) g, dwellTimeCells(grid) c;
+
+SELECT dwellTimeGrid(trip, 0, 1) FROM (VALUES (tgeompoint '[Point(0.5 0.5)@2000-01-01 00:00, Point(2.5 0.5)@2000-01-01 02:00]'), ('[Point(1.5 0.5)@2000-01-01 00:00, Point(1.5 0.5)@2000-01-01 01:00]')) t(trip);
+SELECT dwellTimeGrid(trip, 1, 1) FROM (VALUES (tgeompoint 'SRID=5676;Point(1 1)@2000-01-01'), ('Point(1 1)@2000-01-01')) t(trip);
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,14 @@
+-------------------------------------------------------------------------------
+-- Partition-based spatial merge join
+-------------------------------------------------------------------------------
+
+SELECT * FROM stboxJoin(ARRAY[stbox 'STBOX((1.0, 1.0), (2.0, 2.0))', stbox 'STBOX((5.0, 5.0), (6.0, 6.0))'], ARRAY[stbox 'STBOX((1.5, 1.5), (5.5, 5.5))', stbox 'STBOX((10.0, 10.0), (11.0, 11.0))']) ORDER BY 1, 2;
+SELECT * FROM stboxJoin(ARRAY[stbox 'STBOX T((1.0, 1.0, 2000-01-01), (2.0, 2.0, 2000-01-02))'], ARRAY[stbox 'STBOX T((1.0, 1.0, 2000-01-03), (2.0, 2.0, 2000-01-04))', stbox 'STBOX T((1.5, 1.5, 2000-01-02), (3.0, 3.0, 2000-01-03))']) ORDER BY 1, 2;
+SELECT * FROM stboxJoin(ARRAY[stbox 'STBOX((1.0, 1.0), (2.0, 2.0))'], '{}');
+
+SELECT COUNT(*), COUNT(DISTINCT (pos1, pos2)) FROM (SELECT (stboxJoin(a1, a2)).* FROM (SELECT array_agg(stbox(i % 20, i / 20, i % 20 + 1.5, i / 20 + 1.5) ORDER BY i) AS a1, array_agg(stbox(i % 25 * 0.8, i / 25 * 0.8, i % 25 * 0.8 + 0.3, i / 25 * 0.8 + 0.3) ORDER BY i) AS a2 FROM generate_series(0, 399) i) t) t1;
+SELECT (SELECT array_agg((pos1, pos2) ORDER BY pos1, pos2) FROM stboxJoin(a1, a2)) = (SELECT array_agg((i1::integer, i2::integer) ORDER BY i1, i2) FROM unnest(a1) WITH ORDINALITY u1(b1, i1), unnest(a2) WITH ORDINALITY u2(b2, i2) WHERE b1 && b2) FROM (SELECT array_agg(stbox(i % 20, i / 20, i % 20 + 1.5, i / 20 + 1.5) ORDER BY i) AS a1, array_agg(stbox(i % 25 * 0.8, i / 25 * 0.8, i % 25 * 0.8 + 0.3, i / 25 * 0.8 + 0.3) ORDER BY i) AS a2 FROM generate_series(0, 399) i) t;
+
+SELECT * FROM stboxJoin(ARRAY[stbox 'STBOX T(( , , 2001-01-01), ( , , 2001-01-02))'], ARRAY[stbox 'STBOX((1.0, 1.0), (2.0, 2.0))']);
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,16 @@
+-------------------------------------------------------------------------------
+-- Time during which a temporal point intersects each geofence of an array
+-------------------------------------------------------------------------------
+
+SELECT * FROM whenIntersectsFences(tgeompoint '[Point(0 0)@2000-01-01, Point(10 0)@2000-01-11]', ARRAY[geometry 'Polygon((1 -1,3 -1,3 1,1 1,1 -1))', 'Polygon((20 20,21 20,21 21,20 21,20 20))', 'Polygon((5 -1,6 -1,6 1,5 1,5 -1))', 'Polygon empty']);
+SELECT * FROM whenIntersectsFences(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}', ARRAY[geometry 'Point(1 1)', 'Point(2 2)', 'Linestring(0 0,3 3)']);
+SELECT * FROM whenIntersectsFences(tgeompoint '{[Point(0 1)@2000-01-01, Point(2 1)@2000-01-03], [Point(2 3)@2000-01-04, Point(0 3)@2000-01-06]}', ARRAY[geometry 'Polygon((1 0,3 0,3 4,1 4,1 0))']);
+SELECT * FROM whenIntersectsFences(tgeompoint 'Point(1 1)@2000-01-01', '{}');
+
+SELECT COUNT(*), bool_and(periods = whenIntersects(trip, fences[fence])) FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i * 0.1, sin(i * 0.05) * 5), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS trip FROM generate_series(0, 999) i) t, (SELECT array_agg(ST_Buffer(ST_MakePoint(i % 10 * 10 + 3, (i / 10 - 5) * 1.2), 0.7, 'quad_segs=32') ORDER BY i) AS fences FROM generate_series(0, 99) i) g, whenIntersectsFences(trip, fences);
+SELECT COUNT(*) FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i * 0.1, sin(i * 0.05) * 5), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS trip FROM generate_series(0, 999) i) t, (SELECT ST_Buffer(ST_MakePoint(i % 10 * 10 + 3, (i / 10 - 5) * 1.2), 0.7, 'quad_segs=32') AS fence FROM generate_series(0, 99) i) g WHERE whenIntersects(trip, fence) IS NOT NULL;
+
+SELECT * FROM whenIntersectsFences(tgeompoint 'Point(1 1)@2000-01-01', ARRAY[geometry 'SRID=5676;Point(1 1)']);
+SELECT * FROM whenIntersectsFences(tgeompoint 'Point(1 1)@2000-01-01', ARRAY[geometry 'Point(1 1 1)']);
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,17 @@
+-------------------------------------------------------------------------------
+-- Continuous k nearest neighbors of a temporal point among an array
+-------------------------------------------------------------------------------
+
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint '[Point(1 0)@2000-01-01, Point(5 0)@2000-01-05]', '[Point(5 0)@2000-01-01, Point(1 0)@2000-01-05]', '[Point(0 2.5)@2000-01-01, Point(0 2.5)@2000-01-05]', '[Point(100 100)@2000-01-01, Point(100 100)@2000-01-05]'], 1);
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint '[Point(1 0)@2000-01-01, Point(5 0)@2000-01-05]', '[Point(5 0)@2000-01-01, Point(1 0)@2000-01-05]', '[Point(0 2.5)@2000-01-01, Point(0 2.5)@2000-01-05]', '[Point(100 100)@2000-01-01, Point(100 100)@2000-01-05]'], 2);
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint '[Point(1 0)@2000-01-01, Point(5 0)@2000-01-05]', '[Point(1 1)@2000-01-03, Point(1 1)@2000-01-07]'], 5);
+SELECT * FROM tkNN(tgeompoint '{Point(0 0)@2000-01-01, Point(0 0)@2000-01-02}', ARRAY[tgeompoint '{Point(1 0)@2000-01-01, Point(3 0)@2000-01-02}', '{Point(2 0)@2000-01-01, Point(1 0)@2000-01-02}'], 1);
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', '{}', 1);
+SELECT COUNT(*) FROM (SELECT tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i * 0.1, 0), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS trip FROM generate_series(0, 99) i) t, (SELECT array_agg(tgeompointseq(ARRAY[tgeompointinst(ST_MakePoint(j, 1), '2000-01-01'), tgeompointinst(ST_MakePoint(j, 1), '2000-01-01 01:39')]) ORDER BY j) AS cands FROM generate_series(0, 9) j) c, tkNN(trip, cands, 1);
+
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint 'Point(1 1)@2000-01-02'], 1);
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint 'SRID=5676;Point(1 1)@2000-01-02'], 1);
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint 'Point(1 1 1)@2000-01-02'], 1);
+SELECT * FROM tkNN(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]', ARRAY[tgeompoint '[Point(1 0)@2000-01-01, Point(5 0)@2000-01-05]', '[Point(5 0)@2000-01-01, Point(1 0)@2000-01-05]', '[Point(0 2.5)@2000-01-01, Point(0 2.5)@2000-01-05]', '[Point(100 100)@2000-01-01, Point(100 100)@2000-01-05]'], 0);
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,18 @@
+-------------------------------------------------------------------------------
+-- Batch computation for pairs of temporal points
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS tbl_batch;
+CREATE TABLE tbl_batch(id int, temp1 tgeompoint, temp2 tgeompoint);
+INSERT INTO tbl_batch VALUES (1, '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05]', '[Point(2 1)@2000-01-01, Point(2 1)@2000-01-03, Point(2 2)@2000-01-05]'), (2, '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-02]', '[Point(1 0)@2000-01-01, Point(1 0)@2000-01-02]'), (3, '[Point(10 10)@2000-01-10, Point(10 10)@2000-01-11]', '[Point(10 10)@2000-01-01, Point(10 10)@2000-01-02]');
+
+SELECT * FROM tdwithinBatch((SELECT asArrow(temp1 ORDER BY id) FROM tbl_batch), (SELECT asArrow(temp2 ORDER BY id) FROM tbl_batch), 1.5);
+SELECT * FROM nearestApproachDistanceBatch((SELECT asArrow(temp1 ORDER BY id) FROM tbl_batch), (SELECT asArrow(temp2 ORDER BY id) FROM tbl_batch));
+SELECT * FROM tdwithinBatch((SELECT asArrow(temp1 ORDER BY id) FROM tbl_batch), (SELECT asArrow(temp2 ORDER BY id) FROM tbl_batch), 0.5);
+/* Errors */
+SELECT * FROM tdwithinBatch((SELECT asArrow(temp1 ORDER BY id) FROM tbl_batch), (SELECT asArrow(temp2) FROM tbl_batch WHERE id = 1), 1.5);
+SELECT * FROM tdwithinBatch((SELECT asArrow(temp1 ORDER BY id) FROM tbl_batch), (SELECT asArrow(temp2 ORDER BY id) FROM tbl_batch), -1);
+
+DROP TABLE tbl_batch;
+
+-------------------------------------------------------------------------------
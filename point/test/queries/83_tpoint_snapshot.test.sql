@@ -0,0 +1,16 @@
+-------------------------------------------------------------------------------
+-- Positions of an array of temporal points at one or more timestamps
+-------------------------------------------------------------------------------
+
+SELECT ST_AsText(snapshot(ARRAY[tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05]', tgeompoint '{Point(1 1)@2000-01-02, Point(2 2)@2000-01-03}', tgeompoint 'Point(5 5)@2000-01-10'], '2000-01-02'));
+SELECT ST_AsText(snapshot(ARRAY[tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint '[Point(0 0 0)@2000-01-01, Point(2 2 2)@2000-01-03]'], '2000-01-01'));
+SELECT ST_AsText(snapshot(ARRAY[tgeogpoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]'], '2000-01-02'));
+SELECT snapshot(ARRAY[tgeompoint 'Point(5 5)@2000-01-10'], '2000-01-02');
+
+SELECT t, ids, ST_AsText(points) FROM snapshots(ARRAY[tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05]', tgeompoint '{Point(1 1)@2000-01-02, Point(2 2)@2000-01-03}', tgeompoint 'Point(5 5)@2000-01-10'], ARRAY[timestamptz '2000-01-01', '2000-01-03', '2000-01-07', '2000-01-10']);
+SELECT count(*) FROM snapshots(ARRAY[tgeogpoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-05]'], ARRAY[timestamptz '2000-01-01', '2000-01-02']);
+/* Errors */
+SELECT snapshot(ARRAY[tgeompoint 'Point(1 1)@2000-01-01', tgeompoint 'SRID=5676;Point(1 1)@2000-01-01'], '2000-01-01');
+SELECT snapshot(ARRAY[tgeompoint 'Point(1 1)@2000-01-01', tgeompoint 'Point(1 1 1)@2000-01-01'], '2000-01-01');
+
+-------------------------------------------------------------------------------
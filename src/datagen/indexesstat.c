@@ -1,7 +1,8 @@
 /*****************************************************************************
  *
- * spgiststat.c
- *    Function belonging to the initial implementation of SP-GiST taken from
+ * indexesstat.c
+ *    Statistics of the pages of GiST and SP-GiST indexes. The SP-GiST
+ *    function belongs to the initial implementation of SP-GiST taken from
  *    https://www.postgresql.org/message-id/29780.1324160816@sss.pgh.pa.us
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse, 
@@ -12,13 +13,23 @@
  *****************************************************************************/
 
 #include <postgres.h>
+#include <access/gist.h>
 #include <access/hash.h>
 #include <access/heapam.h>
+#include <access/itup.h>
 #include <catalog/namespace.h>
+#include <lib/stringinfo.h>
 #include <utils/builtins.h>
 #include <utils/rel.h>
+#include <utils/timestamp.h>
 #include <utils/varlena.h>
 
+#include "temporal.h"
+#include "period.h"
+#include "tbox.h"
+#include "oidcache.h"
+#include "stbox.h"
+
 /* These definitions are taken from <catalog/pg_am.h> */
 #define GIST_AM_OID 783
 #define SPGIST_AM_OID 4000
@@ -201,4 +212,291 @@ spgiststat(PG_FUNCTION_ARGS)
        nLeafRedirect, nInnerRedirect);
 
   PG_RETURN_TEXT_P(CStringGetTextDatum(res));
-}
\ No newline at end of file
+}
+
+/*****************************************************************************
+ * Statistics of GiST indexes whose keys are periods, temporal boxes, or
+ * spatiotemporal boxes
+ *****************************************************************************/
+
+/** Maximum number of levels of a GiST index that are reported */
+#define GISTSTAT_MAXLEVELS 32
+
+/**
+ * Structure to represent a key of a GiST index as a box with up to four
+ * dimensions, the time being expressed in seconds
+ */
+typedef struct
+{
+  int ndims;
+  double lower[4];
+  double upper[4];
+} GistStatBox;
+
+/**
+ * Structure to represent the statistics of a level of a GiST index
+ */
+typedef struct
+{
+  uint32 pages;          /**< visited pages */
+  int64 tuples;          /**< keys of the visited pages */
+  double used;           /**< bytes used in the visited pages */
+  double volume;         /**< sum of the volumes of the keys */
+  double overlap;        /**< sum of the overlaps of the keys of a page */
+  double weight;         /**< inverse of the probability to visit a page */
+  double estpages;       /**< estimated number of pages of the level */
+} GistStatLevel;
+
+/**
+ * Convert the key of a GiST index into a box with up to four dimensions
+ */
+static void
+giststat_key_box(GistStatBox *box, Datum key, Oid keytype)
+{
+  box->ndims = 0;
+  if (keytype == type_oid(T_PERIOD))
+  {
+    Period *p = DatumGetPeriod(key);
+    box->lower[0] = (double) p->lower / USECS_PER_SEC;
+    box->upper[0] = (double) p->upper / USECS_PER_SEC;
+    box->ndims = 1;
+  }
+  else if (keytype == type_oid(T_TBOX))
+  {
+    TBOX *b = DatumGetTboxP(key);
+    if (MOBDB_FLAGS_GET_X(b->flags))
+    {
+      box->lower[box->ndims] = b->xmin;
+      box->upper[box->ndims++] = b->xmax;
+    }
+    if (MOBDB_FLAGS_GET_T(b->flags))
+    {
+      box->lower[box->ndims] = (double) b->tmin / USECS_PER_SEC;
+      box->upper[box->ndims++] = (double) b->tmax / USECS_PER_SEC;
+    }
+  }
+  else /* keytype == type_oid(T_STBOX) */
+  {
+    STBOX *b = DatumGetSTboxP(key);
+    if (MOBDB_FLAGS_GET_X(b->flags))
+    {
+      box->lower[0] = b->xmin;
+      box->upper[0] = b->xmax;
+      box->lower[1] = b->ymin;
+      box->upper[1] = b->ymax;
+      box->ndims = 2;
+      if (MOBDB_FLAGS_GET_Z(b->flags) || MOBDB_FLAGS_GET_GEODETIC(b->flags))
+      {
+        box->lower[2] = b->zmin;
+        box->upper[2] = b->zmax;
+        box->ndims = 3;
+      }
+    }
+    if (MOBDB_FLAGS_GET_T(b->flags))
+    {
+      box->lower[box->ndims] = (double) b->tmin / USECS_PER_SEC;
+      box->upper[box->ndims++] = (double) b->tmax / USECS_PER_SEC;
+    }
+  }
+  return;
+}
+
+/**
+ * Returns the volume of the box
+ */
+static double
+giststat_box_volume(const GistStatBox *box)
+{
+  double result = 1.0;
+  for (int i = 0; i < box->ndims; i++)
+    result *= box->upper[i] - box->lower[i];
+  return result;
+}
+
+/**
+ * Returns the volume of the intersection of the two boxes
+ */
+static double
+giststat_box_overlap(const GistStatBox *box1, const GistStatBox *box2)
+{
+  double result = 1.0;
+  for (int i = 0; i < box1->ndims; i++)
+  {
+    double lower = Max(box1->lower[i], box2->lower[i]);
+    double upper = Min(box1->upper[i], box2->upper[i]);
+    if (upper <= lower)
+      return 0.0;
+    result *= upper - lower;
+  }
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(giststat);
+/**
+ * Returns the statistics of a GiST index whose keys are periods, temporal
+ * boxes, or spatiotemporal boxes
+ *
+ * The index is traversed level by level from the root. For each level, the
+ * function reports the number of pages, the fanout, the fill ratio, and the
+ * total volume of the keys and of the overlap between the keys of a same
+ * page, the time being expressed in seconds. The overlap is the sum of the
+ * volumes of the intersections of every pair of keys of a page, which is
+ * the quantity that a picksplit method tries to minimize. When the second
+ * argument is less than 1, the children of the inner pages are visited with
+ * this probability, while at least one child of each page is visited, and
+ * the totals of the levels are estimated from the visited pages.
+ */
+PGDLLEXPORT Datum
+giststat(PG_FUNCTION_ARGS)
+{
+  text *name = PG_GETARG_TEXT_P(0);
+  double sample = PG_NARGS() > 1 ? PG_GETARG_FLOAT8(1) : 1.0;
+  if (sample <= 0.0 || sample > 1.0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The sample fraction must be in (0, 1]")));
+
+  RangeVar *relvar = makeRangeVarFromNameList(textToQualifiedNameList(name));
+  Relation index = relation_openrv(relvar, AccessShareLock);
+  if (! IS_INDEX(index) || ! IS_GIST(index))
+    elog(ERROR, "relation \"%s\" is not a GiST index",
+      RelationGetRelationName(index));
+  TupleDesc tupdesc = RelationGetDescr(index);
+  Oid keytype = TupleDescAttr(tupdesc, 0)->atttypid;
+  if (keytype != type_oid(T_PERIOD) && keytype != type_oid(T_TBOX) &&
+      keytype != type_oid(T_STBOX))
+    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+      errmsg("The keys of the GiST index \"%s\" must be periods, tbox, or stbox",
+        RelationGetRelationName(index))));
+
+  /* The pages of the current level and their weights */
+  BlockNumber totalPages = RelationGetNumberOfBlocks(index);
+  BlockNumber *blocks = palloc(sizeof(BlockNumber) * totalPages);
+  double *weights = palloc(sizeof(double) * totalPages);
+  BlockNumber *nextblocks = palloc(sizeof(BlockNumber) * totalPages);
+  double *nextweights = palloc(sizeof(double) * totalPages);
+  GistStatBox *boxes = NULL;
+  int maxboxes = 0;
+  GistStatLevel levels[GISTSTAT_MAXLEVELS];
+  memset(levels, 0, sizeof(levels));
+  int depth = 0, count = 1, deletedPages = 0, pageSize = -1;
+  blocks[0] = GIST_ROOT_BLKNO;
+  weights[0] = 1.0;
+  while (count > 0 && depth < GISTSTAT_MAXLEVELS)
+  {
+    GistStatLevel *level = &levels[depth];
+    int nextcount = 0;
+    for (int i = 0; i < count; i++)
+    {
+      Buffer buffer = ReadBuffer(index, blocks[i]);
+      LockBuffer(buffer, BUFFER_LOCK_SHARE);
+      Page page = BufferGetPage(buffer);
+      if (PageIsNew(page) || GistPageIsDeleted(page))
+      {
+        deletedPages++;
+        UnlockReleaseBuffer(buffer);
+        continue;
+      }
+      if (pageSize < 0)
+        pageSize = BufferGetPageSize(buffer) -
+          MAXALIGN(sizeof(GISTPageOpaqueData)) - SizeOfPageHeaderData;
+      bool leaf = GistPageIsLeaf(page);
+      OffsetNumber max = PageGetMaxOffsetNumber(page);
+      if (max > maxboxes)
+      {
+        maxboxes = max;
+        boxes = boxes == NULL ? palloc(sizeof(GistStatBox) * maxboxes) :
+          repalloc(boxes, sizeof(GistStatBox) * maxboxes);
+      }
+      int nboxes = 0;
+      bool descended = false;
+      for (OffsetNumber off = FirstOffsetNumber; off <= max; off++)
+      {
+        ItemId iid = PageGetItemId(page, off);
+        if (ItemIdIsDead(iid))
+          continue;
+        IndexTuple itup = (IndexTuple) PageGetItem(page, iid);
+        bool isnull;
+        Datum key = index_getattr(itup, 1, tupdesc, &isnull);
+        if (! isnull)
+        {
+          giststat_key_box(&boxes[nboxes], key, keytype);
+          level->volume += giststat_box_volume(&boxes[nboxes]) * weights[i];
+          nboxes++;
+        }
+        /* Visit the children with the probability given by the sample,
+         * and the last child if none was visited */
+        if (! leaf && nextcount < (int) totalPages && (sample >= 1.0 ||
+            (double) random() / ((double) MAX_RANDOM_VALUE + 1) < sample ||
+            (off == max && ! descended)))
+        {
+          nextblocks[nextcount] = ItemPointerGetBlockNumber(&(itup->t_tid));
+          nextweights[nextcount++] = weights[i] / sample;
+          descended = true;
+        }
+      }
+      for (int j = 0; j < nboxes; j++)
+        for (int k = j + 1; k < nboxes; k++)
+          level->overlap += giststat_box_overlap(&boxes[j], &boxes[k]) *
+            weights[i];
+      level->pages++;
+      level->tuples += max;
+      level->used += pageSize - PageGetExactFreeSpace(page);
+      level->estpages += weights[i];
+      UnlockReleaseBuffer(buffer);
+    }
+    depth++;
+    /* The next level becomes the current one */
+    BlockNumber *tmpblocks = blocks;
+    blocks = nextblocks;
+    nextblocks = tmpblocks;
+    double *tmpweights = weights;
+    weights = nextweights;
+    nextweights = tmpweights;
+    count = nextcount;
+  }
+  index_close(index, AccessShareLock);
+
+  StringInfoData res;
+  initStringInfo(&res);
+  int64 leafTuples = 0, innerTuples = 0;
+  uint32 leafPages = 0, innerPages = 0;
+  for (int i = 0; i < depth; i++)
+  {
+    if (i == depth - 1)
+    {
+      leafPages += levels[i].pages;
+      leafTuples += levels[i].tuples;
+    }
+    else
+    {
+      innerPages += levels[i].pages;
+      innerTuples += levels[i].tuples;
+    }
+  }
+  appendStringInfo(&res,
+    "totalPages:        %u\n"
+    "deletedPages:      %u\n"
+    "depth:             %d\n"
+    "innerPages:        %u\n"
+    "leafPages:         %u\n"
+    "innerTuples:       " INT64_FORMAT "\n"
+    "leafTuples:        " INT64_FORMAT "\n"
+    "sample:            %.2f%%",
+    totalPages, deletedPages, depth, innerPages, leafPages,
+    innerTuples, leafTuples, 100.0 * sample);
+  for (int i = 0; i < depth; i++)
+  {
+    GistStatLevel *level = &levels[i];
+    if (level->pages == 0)
+      continue;
+    appendStringInfo(&res,
+      "\nlevel %d: estPages: %.0f, fanout: %.2f, fillRatio: %.2f%%, "
+      "volume: %g, overlap: %g",
+      i, level->estpages, (double) level->tuples / level->pages,
+      100.0 * level->used / ((double) pageSize * level->pages),
+      level->volume, level->overlap);
+  }
+  PG_RETURN_TEXT_P(cstring_to_text(res.data));
+}
+
+/*****************************************************************************/
@@ -148,6 +148,7 @@
 
 #include "lifting.h"
 
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
@@ -1019,7 +1020,7 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
     {
       instants[0] = tinstant_make(startresult, start1->t, lfinfo.restypid);
       instants[1] = tinstant_make(startresult, end1->t, lfinfo.restypid);
-      result[k++] = tsequence_make(instants, 2, lower_inc, upper_inc,
+      result[k++] = tsequence_make1(instants, 2, lower_inc, upper_inc,
         STEP, NORMALIZE_NO);
       pfree(instants[0]); pfree(instants[1]);
     }
@@ -1046,7 +1047,7 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
       }
       instants[0] = tinstant_make(intresult, start1->t, lfinfo.restypid);
       instants[1] = tinstant_make(intresult, end1->t, lfinfo.restypid);
-      result[k++] = tsequence_make(instants, 2, lower_eq, upper_eq,
+      result[k++] = tsequence_make1(instants, 2, lower_eq, upper_eq,
         STEP, NORMALIZE_NO);
       pfree(instants[0]); pfree(instants[1]);
       if (upper_inc && ! upper_eq)
@@ -1078,7 +1079,7 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
       {
         instants[0] = tinstant_make(startresult, start1->t, lfinfo.restypid);
         instants[1] = tinstant_make(startresult, end1->t, lfinfo.restypid);
-        result[k++] = tsequence_make(instants, 2, lower_inc,
+        result[k++] = tsequence_make1(instants, 2, lower_inc,
           hascross ? upper_eq : false, STEP, NORMALIZE_NO);
         pfree(instants[0]); pfree(instants[1]);
         if (! hascross && upper_inc)
@@ -1093,7 +1094,7 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
         /* First sequence */
         instants[0] = tinstant_make(startresult, start1->t, lfinfo.restypid);
         instants[1] = tinstant_make(startresult, inttime, lfinfo.restypid);
-        result[k++] = tsequence_make(instants, 2, lower_inc, lower_eq,
+        result[k++] = tsequence_make1(instants, 2, lower_inc, lower_eq,
           STEP, NORMALIZE_NO);
         pfree(instants[0]); pfree(instants[1]);
         /* Second sequence if any */
@@ -1106,7 +1107,7 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
         /* Third sequence */
         instants[0] = tinstant_make(endresult, inttime, lfinfo.restypid);
         instants[1] = tinstant_make(endresult, end1->t, lfinfo.restypid);
-        result[k++] = tsequence_make(instants, 2, upper_eq, upper_inc,
+        result[k++] = tsequence_make1(instants, 2, upper_eq, upper_inc,
           STEP, NORMALIZE_NO);
         pfree(instants[0]); pfree(instants[1]);
         DATUM_FREE(intvalue1, start1->valuetypid);
@@ -1151,27 +1152,29 @@ sync_tfunc_tsequence_tsequence3(TSequence **result, const TSequence *seq1,
    * where X, I, and * are values computed, respectively at synchronization points,
    * intermediate points, and common points
    */
+  /*
+   * The instants added for the synchronization and the instants of the result
+   * are allocated in a scratch memory context that is deleted at once after
+   * the result is built, instead of freeing them one by one
+   */
+  MemoryContext scratch = AllocSetContextCreate(CurrentMemoryContext,
+    "Lifting synchronization", ALLOCSET_DEFAULT_SIZES);
+  MemoryContext oldcontext = MemoryContextSwitchTo(scratch);
   TInstant *inst1 = tsequence_inst_n(seq1, 0);
   TInstant *inst2 = tsequence_inst_n(seq2, 0);
-  TInstant *tofreeinst = NULL;
-  int i = 0, j = 0, k = 0, l = 0;
+  int i = 0, j = 0, k = 0;
   if (inst1->t < inter->lower)
   {
     inst1 = tsequence_at_timestamp(seq1, inter->lower);
-    tofreeinst = inst1;
     i = tsequence_find_timestamp(seq1, inter->lower);
   }
   else if (inst2->t < inter->lower)
   {
     inst2 = tsequence_at_timestamp(seq2, inter->lower);
-    tofreeinst = inst2;
     j = tsequence_find_timestamp(seq2, inter->lower);
   }
   int count = (seq1->count - i + seq2->count - j) * 2;
   TInstant **instants = palloc(sizeof(TInstant *) * count);
-  TInstant **tofree = palloc(sizeof(TInstant *) * count);
-  if (tofreeinst != NULL)
-    tofree[l++] = tofreeinst;
   TInstant *prev1, *prev2;
   Datum value;
   TimestampTz intertime;
@@ -1189,13 +1192,11 @@ sync_tfunc_tsequence_tsequence3(TSequence **result, const TSequence *seq1,
     {
       i++;
       inst2 = tsequence_at_timestamp(seq2, inst1->t);
-      tofree[l++] = inst2;
     }
     else
     {
       j++;
       inst1 = tsequence_at_timestamp(seq1, inst2->t);
-      tofree[l++] = inst1;
     }
     /* If not the first instant compute the function on the potential
        intermediate point before adding the new instants */
@@ -1230,17 +1231,15 @@ sync_tfunc_tsequence_tsequence3(TSequence **result, const TSequence *seq1,
      exclusive upper bound must be equal */
   if (!lfinfo.reslinear && !inter->upper_inc && k > 1)
   {
-    tofree[l++] = instants[k - 1];
     value = tinstant_value(instants[k - 2]);
     instants[k - 1] = tinstant_make(value, instants[k - 1]->t, lfinfo.restypid);
   }
 
-  for (i = 0; i < l; i++)
-    pfree(tofree[i]);
-  pfree(tofree); pfree(inter);
-
-  result[0] = tsequence_make_free(instants, k, inter->lower_inc,
+  MemoryContextSwitchTo(oldcontext);
+  result[0] = tsequence_make1(instants, k, inter->lower_inc,
     inter->upper_inc, lfinfo.reslinear, NORMALIZE);
+  MemoryContextDelete(scratch);
+  pfree(inter);
   return 1;
 }
 
@@ -1319,7 +1318,7 @@ sync_tfunc_tsequence_tsequence4(TSequence **result, const TSequence *seq1,
       seq2->valuetypid, param, lfinfo);
     instants[0] = tinstant_make(startresult, start1->t, lfinfo.restypid);
     instants[1] = tinstant_make(endresult, end1->t, lfinfo.restypid);
-    result[k++] = tsequence_make(instants, 2, lower_inc, false,
+    result[k++] = tsequence_make1(instants, 2, lower_inc, false,
       lfinfo.reslinear, NORMALIZE_NO);
     pfree(instants[0]); pfree(instants[1]);
     DATUM_FREE(startresult, lfinfo.restypid);
@@ -1414,7 +1413,7 @@ sync_tfunc_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
   if (count == 1)
     return (Temporal *) sequences[0];
   else
-    return (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE);
+    return (Temporal *) tsequenceset_make_free1(sequences, k, NORMALIZE);
 }
 
 /*****************************************************************************/
@@ -1458,7 +1457,7 @@ sync_tfunc_tsequenceset_tsequence(const TSequenceSet *ts, const TSequence *seq,
       break;
   }
   /* We need to normalize when discont is true */
-  return tsequenceset_make_free(sequences, k, NORMALIZE);
+  return tsequenceset_make_free1(sequences, k, NORMALIZE);
 }
 
 /**
@@ -1522,7 +1521,7 @@ sync_tfunc_tsequenceset_tsequenceset(const TSequenceSet *ts1,
       j++;
   }
   /* We need to normalize if the function has instantaneous discontinuities */
-  return tsequenceset_make_free(sequences, k, NORMALIZE);
+  return tsequenceset_make_free1(sequences, k, NORMALIZE);
 }
 
 /*****************************************************************************/
@@ -1543,10 +1542,13 @@ sync_tfunc_temporal_temporal(const Temporal *temp1, const Temporal *temp2,
   Period p1, p2;
   temporal_period(&p1, temp1);
   temporal_period(&p2, temp2);
-  if (! overlaps_period_period_internal(&p1, &p2))
+  bool overlaps = overlaps_period_period_internal(&p1, &p2);
+  COUNTER_BBOX(overlaps);
+  if (! overlaps)
     return NULL;
 
   Temporal *result = NULL;
+  COUNTER_INC(sync_calls);
   ensure_valid_duration(temp1->duration);
   ensure_valid_duration(temp2->duration);
   if (temp1->duration == INSTANT)
@@ -1609,6 +1611,8 @@ sync_tfunc_temporal_temporal(const Temporal *temp1, const Temporal *temp2,
       result = (Temporal *)sync_tfunc_tsequenceset_tsequenceset(
           (TSequenceSet *)temp1, (TSequenceSet *)temp2, param, lfinfo);
   }
+  if (track_counters && result != NULL)
+    COUNTER_ADD(sync_instants, temporal_num_instants_internal(result));
   return result;
 }
 
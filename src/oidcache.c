@@ -12,13 +12,9 @@
 
 #include "oidcache.h"
 
-#if MOBDB_PGSQL_VERSION >= 120000
-#include <access/tableam.h>
-#endif
-#include <access/heapam.h>
-#include <access/htup_details.h>
 #include <catalog/namespace.h>
-#include <utils/rel.h>
+#include <nodes/value.h>
+#include <utils/lsyscache.h>
 
 #include "temporaltypes.h"
 
@@ -104,8 +100,7 @@ const char *_op_names[] =
  *****************************************************************************/
 
 /**
- * Global variable that states whether the type and operator cache
- * has been initialized.
+ * Global variable that states whether the type cache has been initialized.
  */
 bool _ready = false;
 
@@ -114,6 +109,37 @@ bool _ready = false;
  */
 Oid _type_oids[sizeof(_type_names) / sizeof(char *)];
 
+/**
+ * Base types of the temporal types, including the internal ones and
+ * TimestampTz. The built-in types come first since their Oids are known at
+ * compile time and are resolved without scanning the array.
+ */
+static const struct
+{
+  CachedType type;
+  bool linear;
+} _base_types[] =
+{
+  {T_BOOL, false},
+  {T_INT4, false},
+  {T_FLOAT8, true},
+  {T_TEXT, false},
+  {T_TIMESTAMPTZ, false},
+  {T_DOUBLE2, true},
+  {T_DOUBLE3, true},
+  {T_DOUBLE4, true},
+  {T_GEOMETRY, true},
+  {T_GEOGRAPHY, true}
+};
+
+#define NUM_BASE_TYPES (sizeof(_base_types) / sizeof(_base_types[0]))
+
+/**
+ * Global array that keeps the properties of the base types, in the order
+ * of the array _base_types.
+ */
+BaseTypeInfo _base_type_info[NUM_BASE_TYPES];
+
 /**
  * Global 3-dimensional array that keeps the Oids of the operators
  * used in MobilityDB. The first dimension corresponds to the operator
@@ -126,6 +152,29 @@ Oid _op_oids[sizeof(_op_names) / sizeof(char *)]
   [sizeof(_type_names) / sizeof(char *)]
   [sizeof(_type_names) / sizeof(char *)];
 
+/**
+ * Global 3-dimensional array that states whether the corresponding cell of
+ * the operator cache has been looked up. The cells are looked up on first
+ * use so that a backend only pays for the operators it actually uses.
+ */
+bool _op_ready[sizeof(_op_names) / sizeof(char *)]
+  [sizeof(_type_names) / sizeof(char *)]
+  [sizeof(_type_names) / sizeof(char *)];
+
+/**
+ * Returns the search path used for the lookups, that is, the current one
+ * preceded by the schema of the extension
+ */
+static OverrideSearchPath *
+oidcache_search_path(void)
+{
+  Oid namespaceId = LookupNamespaceNoError("public");
+  OverrideSearchPath *overridePath =
+    GetOverrideSearchPath(CurrentMemoryContext);
+  overridePath->schemas = lcons_oid(namespaceId, overridePath->schemas);
+  return overridePath;
+}
+
 /**
  * Populate the Oid cache for types
  */
@@ -133,76 +182,59 @@ static void
 populate_types()
 {
   int n = sizeof(_type_names) / sizeof(char *);
-  for (int i = 0; i < n; i++)
+  PushOverrideSearchPath(oidcache_search_path());
+  PG_TRY();
   {
-    _type_oids[i] = TypenameGetTypid(_type_names[i]);
-    if (!_type_oids[i])
-      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-          errmsg("No Oid for type %s", _type_names[i])));
+    for (int i = 0; i < n; i++)
+    {
+      _type_oids[i] = TypenameGetTypid(_type_names[i]);
+      if (!_type_oids[i])
+        ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+            errmsg("No Oid for type %s", _type_names[i])));
+    }
+    PopOverrideSearchPath();
   }
+  PG_CATCH();
+  {
+    PopOverrideSearchPath();
+    PG_RE_THROW();
+  }
+  PG_END_TRY();
+  for (int i = 0; i < (int) NUM_BASE_TYPES; i++)
+  {
+    BaseTypeInfo *info = &_base_type_info[i];
+    info->typid = _type_oids[_base_types[i].type];
+    get_typlenbyval(info->typid, &info->typlen, &info->typbyval);
+    info->linear = _base_types[i].linear;
+  }
+  bzero(_op_ready, sizeof(_op_ready));
+  _ready = true;
   return;
 }
 
 /**
- * Populate the Oid cache for operators
+ * Look up the Oid of an operator and store it in the cache
  */
 static void
-populate_operators()
+populate_operator(CachedOp op, CachedType lt, CachedType rt)
 {
-  Oid namespaceId = LookupNamespaceNoError("public") ;
-  OverrideSearchPath* overridePath = GetOverrideSearchPath(CurrentMemoryContext);
-  overridePath->schemas = lcons_oid(namespaceId, overridePath->schemas);
-  PushOverrideSearchPath(overridePath);
-
+  List *lst = list_make1(makeString((char *) _op_names[op]));
+  PushOverrideSearchPath(oidcache_search_path());
   PG_TRY();
   {
-
-    populate_types();
-    bzero(_op_oids, sizeof(_op_oids));
-
-    /*
-     * This fetches the pre-computed operator cache from the catalog where
-     * it is stored in a table. See the fill_opcache function below.
-     */
-    Oid catalog = RelnameGetRelid("pg_temporal_opcache");
-#if MOBDB_PGSQL_VERSION < 130000
-    Relation rel = heap_open(catalog, AccessShareLock);
-#else
-    Relation rel = table_open(catalog, AccessShareLock);
-#endif
-    TupleDesc tupDesc = rel->rd_att;
-    ScanKeyData scandata;
-#if MOBDB_PGSQL_VERSION >= 120000
-    TableScanDesc scan = table_beginscan_catalog(rel, 0, &scandata);
-#else
-    HeapScanDesc scan = heap_beginscan_catalog(rel, 0, &scandata);
-#endif
-    HeapTuple tuple = heap_getnext(scan, ForwardScanDirection);
-    while (HeapTupleIsValid(tuple))
-    {
-      bool isnull = false;
-      int32 i = DatumGetInt32(heap_getattr(tuple, 1, tupDesc, &isnull));
-      int32 j = DatumGetInt32(heap_getattr(tuple, 2, tupDesc, &isnull));
-      int32 k = DatumGetInt32(heap_getattr(tuple, 3, tupDesc, &isnull));
-      _op_oids[i][j][k] = DatumGetObjectId(heap_getattr(tuple, 4, tupDesc, &isnull));
-      tuple = heap_getnext(scan, ForwardScanDirection);
-    }
-    heap_endscan(scan);
-#if MOBDB_PGSQL_VERSION < 130000
-    heap_close(rel, AccessShareLock);
-#else
-    table_close(rel, AccessShareLock);
-#endif
-    _ready = true;
-
+    _op_oids[op][lt][rt] = OpernameGetOprid(lst, _type_oids[lt],
+      _type_oids[rt]);
     PopOverrideSearchPath();
   }
   PG_CATCH();
   {
-    PopOverrideSearchPath() ;
+    PopOverrideSearchPath();
     PG_RE_THROW();
   }
   PG_END_TRY();
+  list_free_deep(lst);
+  _op_ready[op][lt][rt] = true;
+  return;
 }
 
 /**
@@ -214,10 +246,49 @@ Oid
 type_oid(CachedType type)
 {
   if (!_ready)
-    populate_operators();
+    populate_types();
   return _type_oids[type];
 }
 
+/**
+ * Fetch from the cache the properties of a base type
+ *
+ * The properties are resolved once when the cache is populated, so that
+ * the functions that copy, free, or construct the values of the temporal
+ * types do not need a catalog lookup or a chain of comparisons of Oids for
+ * each value.
+ *
+ * @arg[in] type Oid of the base type
+ */
+const BaseTypeInfo *
+base_type_info(Oid type)
+{
+  if (!_ready)
+    populate_types();
+  switch (type)
+  {
+    case BOOLOID:
+      return &_base_type_info[0];
+    case INT4OID:
+      return &_base_type_info[1];
+    case FLOAT8OID:
+      return &_base_type_info[2];
+    case TEXTOID:
+      return &_base_type_info[3];
+    case TIMESTAMPTZOID:
+      return &_base_type_info[4];
+    default:
+      break;
+  }
+  for (int i = 5; i < (int) NUM_BASE_TYPES; i++)
+  {
+    if (_base_type_info[i].typid == type)
+      return &_base_type_info[i];
+  }
+  elog(ERROR, "unknown base type: %d", type);
+  return NULL; /* make compiler quiet */
+}
+
 /**
  * Fetch from the cache the Oid of an operator
  *
@@ -229,57 +300,10 @@ Oid
 oper_oid(CachedOp op, CachedType lt, CachedType rt)
 {
   if (!_ready)
-    populate_operators();
+    populate_types();
+  if (!_op_ready[op][lt][rt])
+    populate_operator(op, lt, rt);
   return _op_oids[op][lt][rt];
 }
 
-
-PG_FUNCTION_INFO_V1(fill_opcache);
-/**
- * Function executed during the `CREATE EXTENSION` to precompute the
- * operator cache and store it as a table in the catalog
- */
-PGDLLEXPORT Datum
-fill_opcache(PG_FUNCTION_ARGS)
-{
-  Oid catalog = RelnameGetRelid("pg_temporal_opcache");
-#if MOBDB_PGSQL_VERSION < 130000
-  Relation rel = heap_open(catalog, AccessExclusiveLock);
-#else
-  Relation rel = table_open(catalog, AccessExclusiveLock);
-#endif
-  TupleDesc tupDesc = rel->rd_att;
-
-  bool isnull[] = {false, false, false, false};
-  Datum data[] = {0, 0, 0, 0};
-
-  populate_types();
-  int32 m = sizeof(_op_names) / sizeof(char *);
-  int32 n = sizeof(_type_names) / sizeof(char *);
-  for (int32 i = 0; i < m; i++)
-  {
-    List* lst = list_make1(makeString((char *) _op_names[i]));
-    for (int32 j = 0; j < n; j++)
-      for (int32 k = 0; k < n; k++)
-      {
-        data[3] = ObjectIdGetDatum(OpernameGetOprid(lst, _type_oids[j], _type_oids[k]));
-        if (data[3] != InvalidOid)
-        {
-          data[0] = Int32GetDatum(i);
-          data[1] = Int32GetDatum(j);
-          data[2] = Int32GetDatum(k);
-          HeapTuple t = heap_form_tuple(tupDesc, data, isnull);
-          simple_heap_insert(rel, t);
-        }
-      }
-    pfree(lst);
-  }
-#if MOBDB_PGSQL_VERSION < 130000
-  heap_close(rel, AccessExclusiveLock);
-#else
-  table_close(rel, AccessExclusiveLock);
-#endif
-  PG_RETURN_VOID();
-}
-
 /*****************************************************************************/
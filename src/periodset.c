@@ -28,22 +28,50 @@
  *****************************************************************************/
  
 /**
- * Returns a pointer to the array of offsets of the period set value
+ * Returns the size of a period set value with the given number of
+ * periods in the layout of previous versions, in which the count is
+ * followed by an array of offsets, the periods, and the bounding box
  */
- static size_t *
-periodset_offsets_ptr(const PeriodSet *ps)
+static size_t
+periodset_legacy_size(int count)
 {
-  return (size_t *) (((char *)ps) + sizeof(PeriodSet));
+  return double_pad(2 * sizeof(int32) + (count + 1) * sizeof(size_t)) +
+    double_pad(sizeof(Period)) * (count + 1);
 }
 
 /**
- * Returns a pointer to the first period of the period set value
+ * Returns true if the period set value has the layout of previous versions
+ *
+ * The layout is given by the size of the value, which is 40 + 32 * count
+ * bytes in the previous layout and 32 + 24 * count bytes in the current
+ * one, two sizes that are never equal.
+ */
+static bool
+periodset_legacy(const PeriodSet *ps)
+{
+  return VARSIZE(ps) == periodset_legacy_size(ps->count);
+}
+
+/**
+ * Returns a pointer to the n-th element of a period set value having the
+ * layout of previous versions, where the element after the last one is
+ * the bounding box
  */
-static char * 
+static Period *
+periodset_legacy_ptr(const PeriodSet *ps, int index)
+{
+  size_t *offsets = (size_t *) ((char *) ps + 2 * sizeof(int32));
+  return (Period *) ((char *) ps + double_pad(2 * sizeof(int32) +
+    (ps->count + 1) * sizeof(size_t)) + offsets[index]);
+}
+
+/**
+ * Returns a pointer to the array of periods of the period set value
+ */
+static Period *
 periodset_data_ptr(const PeriodSet *ps)
 {
-  return (char *)ps + double_pad(sizeof(PeriodSet) + 
-    sizeof(size_t) * (ps->count + 1));
+  return (Period *) (((char *) ps) + double_pad(sizeof(PeriodSet)));
 }
 
 /**
@@ -52,8 +80,9 @@ periodset_data_ptr(const PeriodSet *ps)
 Period *
 periodset_per_n(const PeriodSet *ps, int index)
 {
-  size_t *offsets = periodset_offsets_ptr(ps);
-  return (Period *) (periodset_data_ptr(ps) + offsets[index]);
+  if (periodset_legacy(ps))
+    return periodset_legacy_ptr(ps, index);
+  return &periodset_data_ptr(ps)[index];
 }
 
 /**
@@ -62,9 +91,9 @@ periodset_per_n(const PeriodSet *ps, int index)
 Period *
 periodset_bbox(const PeriodSet *ps)
 {
-  size_t *offsets = periodset_offsets_ptr(ps);
-  assert(offsets[ps->count] != 0);
-  return (Period *)(periodset_data_ptr(ps) + offsets[ps->count]);
+  if (periodset_legacy(ps))
+    return periodset_legacy_ptr(ps, ps->count);
+  return (Period *) &ps->period;
 }
 
 /**
@@ -73,17 +102,13 @@ periodset_bbox(const PeriodSet *ps)
  * For example, the memory structure of a PeriodSet with 3 periods 
  * is as follows
  * @code
- * --------------------------------------------------------------------
- * ( PeriodSet | offset_0 | offset_1 | offset_2 | offset_3 | )_X | ...
- * --------------------------------------------------------------------
- * --------------------------------------------------------------------
- * (( Period_0 )_Y | ( Period_1 )_Y | ( Period_2 )_Y | ( bbox )_Y )_X |
- * --------------------------------------------------------------------
+ * ----------------------------------------------------------------
+ * ( PeriodSet | bbox )_X | Period_0 | Period_1 | Period_2 |
+ * ----------------------------------------------------------------
  * @endcode
- * where the `X` are unused bytes added for double padding, the `Y`
- * are unused bytes added for int4 padding, `offset_0` to `offset_2` 
- * are offsets for the corresponding periods, and `offset_3` is the offset 
- * for the bounding box which is a period.
+ * where the `X` are unused bytes added for double padding. Since the
+ * periods have a fixed size, they are stored as a flat array after the
+ * header, which contains the precomputed bounding box.
  *
  * @param[in] periods Array of periods
  * @param[in] count Number of elements in the array
@@ -92,7 +117,6 @@ periodset_bbox(const PeriodSet *ps)
 PeriodSet *
 periodset_make(Period **periods, int count, bool normalize)
 {
-  Period bbox;
   /* Test the validity of the periods */
   for (int i = 0; i < count - 1; i++)
   {
@@ -107,27 +131,18 @@ periodset_make(Period **periods, int count, bool normalize)
   int newcount = count;
   if (normalize && count > 1)
     newperiods = periodarr_normalize(periods, count, &newcount);
-  size_t memsize = double_pad(sizeof(Period)) * (newcount + 1);
-  /* Array of pointers containing the pointers to the component Period,
-     and a pointer to the bbox */
-  size_t pdata = double_pad(sizeof(PeriodSet) + (newcount + 1) * sizeof(size_t));
-  PeriodSet *result = palloc0(pdata + memsize);
-  SET_VARSIZE(result, pdata + memsize);
+  size_t memsize = double_pad(sizeof(PeriodSet)) + sizeof(Period) * newcount;
+  PeriodSet *result = palloc0(memsize);
+  SET_VARSIZE(result, memsize);
   result->count = newcount;
 
-  size_t *offsets = periodset_offsets_ptr(result);
-  size_t pos = 0;  
+  Period *data = periodset_data_ptr(result);
   for (int i = 0; i < newcount; i++)
-  {
-    memcpy(((char *) result) + pdata + pos, newperiods[i], sizeof(Period));
-    offsets[i] = pos;
-    pos += double_pad(sizeof(Period));
-  }
+    memcpy(&data[i], newperiods[i], sizeof(Period));
   /* Precompute the bounding box */
-  period_set(&bbox, newperiods[0]->lower, newperiods[newcount - 1]->upper,
-    newperiods[0]->lower_inc, newperiods[newcount - 1]->upper_inc);
-  offsets[newcount] = pos;
-  memcpy(((char *) result) + pdata + pos, &bbox, sizeof(Period));
+  period_set(&result->period, newperiods[0]->lower,
+    newperiods[newcount - 1]->upper, newperiods[0]->lower_inc,
+    newperiods[newcount - 1]->upper_inc);
   /* Normalize */
   if (normalize && count > 1)
   {
@@ -167,23 +182,14 @@ periodset_make_free(Period **periods, int count, bool normalize)
 PeriodSet *
 period_to_periodset_internal(const Period *period)
 {
-  size_t memsize = double_pad(sizeof(Period)) * 2;
-  /* Array of pointers containing the pointers to the component Period,
-     and a pointer to the bbox */
-  size_t pdata = double_pad(sizeof(PeriodSet) + 2 * sizeof(size_t));
+  size_t memsize = double_pad(sizeof(PeriodSet)) + sizeof(Period);
   /* Create the PeriodSet */
-  PeriodSet *result = palloc0(pdata + memsize);
-  SET_VARSIZE(result, pdata + memsize);
+  PeriodSet *result = palloc0(memsize);
+  SET_VARSIZE(result, memsize);
   result->count = 1;
-  /* Initialization of the variable-length part */
-  size_t *offsets = periodset_offsets_ptr(result);
-  size_t pos = 0;
-  memcpy(((char *) result) + pdata + pos, period, sizeof(Period));
-  offsets[0] = pos;
-  pos += double_pad(sizeof(Period));
+  memcpy(periodset_data_ptr(result), period, sizeof(Period));
   /* Precompute the bounding box */
-  memcpy(((char *) result) + pdata + pos, period, sizeof(Period));
-  offsets[1] = pos;
+  memcpy(&result->period, period, sizeof(Period));
   return result;
 }
 
@@ -469,6 +475,33 @@ periodset_mem_size(PG_FUNCTION_ARGS)
   PG_RETURN_DATUM(result);
 }
 
+PG_FUNCTION_INFO_V1(periodset_legacy_layout);
+/**
+ * Returns the period set value in the layout of previous versions
+ *
+ * @note Used by the regression tests for reading the values stored by
+ * previous versions
+ */
+PGDLLEXPORT Datum
+periodset_legacy_layout(PG_FUNCTION_ARGS)
+{
+  PeriodSet *ps = PG_GETARG_PERIODSET(0);
+  size_t memsize = periodset_legacy_size(ps->count);
+  PeriodSet *result = palloc0(memsize);
+  SET_VARSIZE(result, memsize);
+  result->count = ps->count;
+  size_t *offsets = (size_t *) ((char *) result + 2 * sizeof(int32));
+  for (int i = 0; i <= ps->count; i++)
+    offsets[i] = double_pad(sizeof(Period)) * i;
+  for (int i = 0; i < ps->count; i++)
+    memcpy(periodset_legacy_ptr(result, i), periodset_per_n(ps, i),
+      sizeof(Period));
+  memcpy(periodset_legacy_ptr(result, ps->count), periodset_bbox(ps),
+    sizeof(Period));
+  PG_FREE_IF_COPY(ps, 0);
+  PG_RETURN_POINTER(result);
+}
+
 PG_FUNCTION_INFO_V1(periodset_timespan);
 /**
  * Returns the timespan of the period set value
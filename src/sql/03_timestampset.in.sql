@@ -83,6 +83,10 @@ CREATE FUNCTION memSize(timestampset)
   RETURNS int
   AS 'MODULE_PATHNAME', 'timestampset_mem_size'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION legacyLayout(timestampset)
+  RETURNS timestampset
+  AS 'MODULE_PATHNAME', 'timestampset_legacy_layout'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE FUNCTION timespan(timestampset)
   RETURNS interval
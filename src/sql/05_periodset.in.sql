@@ -96,6 +96,10 @@ CREATE FUNCTION memSize(periodset)
   RETURNS int
   AS 'MODULE_PATHNAME', 'periodset_mem_size'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION legacyLayout(periodset)
+  RETURNS periodset
+  AS 'MODULE_PATHNAME', 'periodset_legacy_layout'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE FUNCTION timespan(periodset)
   RETURNS interval
@@ -1461,3 +1461,110 @@ CREATE OPERATOR * (
 );
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Distance in seconds
+ *****************************************************************************/
+
+CREATE FUNCTION temporal_distance(timestamptz, timestampset)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_timestamp_timestampset'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestamptz, period)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_timestamp_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestamptz, periodset)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_timestamp_periodset'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestampset, timestamptz)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_timestampset_timestamp'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestampset, period)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_timestampset_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, timestamptz)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_period_timestamp'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, timestampset)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_period_timestampset'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, period)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_period_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, periodset)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_period_periodset'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(periodset, timestamptz)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_periodset_timestamp'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(periodset, period)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'distance_periodset_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = timestamptz, RIGHTARG = timestampset,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = timestamptz, RIGHTARG = period,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = timestamptz, RIGHTARG = periodset,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = timestampset, RIGHTARG = timestamptz,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = timestampset, RIGHTARG = period,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = period, RIGHTARG = timestamptz,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = period, RIGHTARG = timestampset,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = period, RIGHTARG = period,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = period, RIGHTARG = periodset,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = periodset, RIGHTARG = timestamptz,
+  COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+  PROCEDURE = temporal_distance,
+  LEFTARG = periodset, RIGHTARG = period,
+  COMMUTATOR = <->
+);
+
+/*****************************************************************************/
@@ -40,6 +40,10 @@ CREATE FUNCTION period_gist_same(period, period, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION period_gist_distance(internal, period, smallint, oid, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'period_gist_distance'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 CREATE FUNCTION period_gist_fetch(internal)
   RETURNS internal
   AS 'MODULE_PATHNAME'
@@ -64,6 +68,9 @@ CREATE OPERATOR CLASS gist_timestampset_ops
   OPERATOR  17    -|- (timestampset, periodset),
   -- equals
   OPERATOR  18    = (timestampset, timestampset),
+  -- distance
+  OPERATOR  25    <-> (timestampset, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    <-> (timestampset, period) FOR ORDER BY pg_catalog.float_ops,
   -- overlaps or before
   OPERATOR  28    &<# (timestampset, timestamptz),
   OPERATOR  28    &<# (timestampset, timestampset),
@@ -93,7 +100,8 @@ CREATE OPERATOR CLASS gist_timestampset_ops
 #endif
   FUNCTION  5  period_gist_penalty(internal, internal, internal),
   FUNCTION  6  period_gist_picksplit(internal, internal),
-  FUNCTION  7  period_gist_same(period, period, internal);
+  FUNCTION  7  period_gist_same(period, period, internal),
+  FUNCTION  8  period_gist_distance(internal, period, smallint, oid, internal);
   
 /******************************************************************************/
 
@@ -126,6 +134,9 @@ CREATE OPERATOR CLASS period_gist_ops
   OPERATOR  17    -|- (period, periodset),
   -- equals
   OPERATOR  18    = (period, period),
+  -- distance
+  OPERATOR  25    <-> (period, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    <-> (period, period) FOR ORDER BY pg_catalog.float_ops,
   -- overlaps or before
   OPERATOR  28    &<# (period, timestamptz),
   OPERATOR  28    &<# (period, timestampset),
@@ -156,6 +167,7 @@ CREATE OPERATOR CLASS period_gist_ops
   FUNCTION  5  period_gist_penalty(internal, internal, internal),
   FUNCTION  6  period_gist_picksplit(internal, internal),
   FUNCTION  7  period_gist_same(period, period, internal),
+  FUNCTION  8  period_gist_distance(internal, period, smallint, oid, internal),
   FUNCTION  9  period_gist_fetch(internal);
   
 /******************************************************************************/
@@ -189,6 +201,9 @@ CREATE OPERATOR CLASS gist_periodset_ops
   OPERATOR  17    -|- (periodset, periodset),
   -- equals
   OPERATOR  18    = (periodset, periodset),
+  -- distance
+  OPERATOR  25    <-> (periodset, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    <-> (periodset, period) FOR ORDER BY pg_catalog.float_ops,
   -- overlaps or before
   OPERATOR  28    &<# (periodset, timestamptz),
   OPERATOR  28    &<# (periodset, timestampset),
@@ -218,6 +233,7 @@ CREATE OPERATOR CLASS gist_periodset_ops
 #endif
   FUNCTION  5  period_gist_penalty(internal, internal, internal),
   FUNCTION  6  period_gist_picksplit(internal, internal),
-  FUNCTION  7  period_gist_same(period, period, internal);
+  FUNCTION  7  period_gist_same(period, period, internal),
+  FUNCTION  8  period_gist_distance(internal, period, smallint, oid, internal);
 
 /******************************************************************************/
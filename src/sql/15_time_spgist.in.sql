@@ -62,6 +62,11 @@ CREATE OPERATOR CLASS spgist_timestampset_ops
   OPERATOR  17    -|- (timestampset, periodset),
   -- equals
   OPERATOR  18    = (timestampset, timestampset),
+#if MOBDB_PGSQL_VERSION >= 120000
+  -- distance
+  OPERATOR  25    <-> (timestampset, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    <-> (timestampset, period) FOR ORDER BY pg_catalog.float_ops,
+#endif
   -- overlaps or before
   OPERATOR  28    &<# (timestampset, timestamptz),
   OPERATOR  28    &<# (timestampset, timestampset),
@@ -111,6 +116,11 @@ CREATE OPERATOR CLASS spperiod_gist_ops
   OPERATOR  17    -|- (period, periodset),
   -- equals
   OPERATOR  18    = (period, period),
+#if MOBDB_PGSQL_VERSION >= 120000
+  -- distance
+  OPERATOR  25    <-> (period, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    <-> (period, period) FOR ORDER BY pg_catalog.float_ops,
+#endif
   -- overlaps or before
   OPERATOR  28    &<# (period, timestamptz),
   OPERATOR  28    &<# (period, timestampset),
@@ -160,6 +170,11 @@ CREATE OPERATOR CLASS spgist_periodset_ops
   OPERATOR  17    -|- (periodset, periodset),
 -- equals
   OPERATOR  18    = (periodset, periodset),
+#if MOBDB_PGSQL_VERSION >= 120000
+  -- distance
+  OPERATOR  25    <-> (periodset, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    <-> (periodset, period) FOR ORDER BY pg_catalog.float_ops,
+#endif
   -- overlaps or before
   OPERATOR  28    &<# (periodset, timestamptz),
   OPERATOR  28    &<# (periodset, timestampset),
@@ -0,0 +1,57 @@
+/*****************************************************************************
+ *
+ * time_gin.sql
+ *    Inverted GIN index for period sets
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION periodset_gin_extract_value(periodset, internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION periodset_gin_extract_query(periodset, internal, smallint,
+    internal, internal, internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION periodset_gin_compare_partial(period, period, smallint,
+    internal)
+  RETURNS integer
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION periodset_gin_consistent(internal, smallint, periodset,
+    integer, internal, internal, internal, internal)
+  RETURNS bool
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/******************************************************************************/
+
+CREATE OPERATOR CLASS gin_periodset_ops
+  FOR TYPE periodset USING gin AS
+  STORAGE period,
+  -- overlaps
+  OPERATOR  1    && (periodset, timestampset),
+  OPERATOR  2    && (periodset, period),
+  OPERATOR  3    && (periodset, periodset),
+  -- contains
+  OPERATOR  4    @> (periodset, timestamptz),
+  OPERATOR  5    @> (periodset, timestampset),
+  OPERATOR  6    @> (periodset, period),
+  OPERATOR  7    @> (periodset, periodset),
+  -- functions
+  FUNCTION  1    period_cmp(period, period),
+  FUNCTION  2    periodset_gin_extract_value(periodset, internal, internal),
+  FUNCTION  3    periodset_gin_extract_query(periodset, internal, smallint,
+    internal, internal, internal, internal),
+  FUNCTION  4    periodset_gin_consistent(internal, smallint, periodset,
+    integer, internal, internal, internal, internal),
+  FUNCTION  5    periodset_gin_compare_partial(period, period, smallint,
+    internal);
+
+/******************************************************************************/
@@ -0,0 +1,19 @@
+/*****************************************************************************
+ *
+ * time_join.sql
+ *    Sort-based join of periods on their overlap
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION periodJoin(periods1 period[], periods2 period[],
+    OUT pos1 integer, OUT pos2 integer)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'period_join'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
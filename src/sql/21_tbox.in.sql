@@ -468,3 +468,14 @@ CREATE OPERATOR CLASS tbox_ops
   FUNCTION  1  tbox_cmp(tbox, tbox);
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Z-order
+ *****************************************************************************/
+
+CREATE FUNCTION zorder(tbox, tbox)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME', 'tbox_zorder'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
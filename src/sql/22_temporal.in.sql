@@ -260,6 +260,28 @@ CREATE FUNCTION ttextseq(ttext[], lower_inc boolean DEFAULT true,
   AS 'MODULE_PATHNAME', 'tstepseq_constructor'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tboolseq(timestamptz[], boolean[],
+  lower_inc boolean DEFAULT true, upper_inc boolean DEFAULT true)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'tstepseq_arrays_constructor'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tintseq(timestamptz[], integer[],
+  lower_inc boolean DEFAULT true, upper_inc boolean DEFAULT true)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'tstepseq_arrays_constructor'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tfloatseq(timestamptz[], float[],
+  lower_inc boolean DEFAULT true, upper_inc boolean DEFAULT true,
+  linear boolean DEFAULT true)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tlinearseq_arrays_constructor'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ttextseq(timestamptz[], text[],
+  lower_inc boolean DEFAULT true, upper_inc boolean DEFAULT true)
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'tstepseq_arrays_constructor'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /* Temporal sequence set */
   
 CREATE FUNCTION tbools(tbool[])
@@ -465,6 +487,45 @@ CREATE FUNCTION appendInstant(ttext, ttext)
   AS 'MODULE_PATHNAME', 'temporal_append_tinstant'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/* The aggregate appends the instants in place to its state */
+CREATE AGGREGATE appendInstant(tbool) (
+  SFUNC = appendInstant,
+  STYPE = tbool,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE appendInstant(tint) (
+  SFUNC = appendInstant,
+  STYPE = tint,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE appendInstant(tfloat) (
+  SFUNC = appendInstant,
+  STYPE = tfloat,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE appendInstant(ttext) (
+  SFUNC = appendInstant,
+  STYPE = ttext,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION appendInstants(tbool, tbool[])
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'temporal_append_tinstants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(tint, tint[])
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_append_tinstants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(tfloat, tfloat[])
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'temporal_append_tinstants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(ttext, ttext[])
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'temporal_append_tinstants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /******************************************************************************/
 
 -- Function is not strict
@@ -885,6 +946,23 @@ CREATE FUNCTION instants(ttext)
   AS 'MODULE_PATHNAME', 'temporal_instants'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION unnestInstants(tbool)
+  RETURNS SETOF tbool
+  AS 'MODULE_PATHNAME', 'temporal_unnest_instants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(tint)
+  RETURNS SETOF tint
+  AS 'MODULE_PATHNAME', 'temporal_unnest_instants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(tfloat)
+  RETURNS SETOF tfloat
+  AS 'MODULE_PATHNAME', 'temporal_unnest_instants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(ttext)
+  RETURNS SETOF ttext
+  AS 'MODULE_PATHNAME', 'temporal_unnest_instants'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION numTimestamps(tbool)
   RETURNS integer
   AS 'MODULE_PATHNAME', 'temporal_num_timestamps'
@@ -970,6 +1048,40 @@ CREATE FUNCTION timestamps(ttext)
   AS 'MODULE_PATHNAME', 'temporal_timestamps'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION unnestTimestamps(tbool)
+  RETURNS SETOF timestamptz
+  AS 'MODULE_PATHNAME', 'temporal_unnest_timestamps'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestTimestamps(tint)
+  RETURNS SETOF timestamptz
+  AS 'MODULE_PATHNAME', 'temporal_unnest_timestamps'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestTimestamps(tfloat)
+  RETURNS SETOF timestamptz
+  AS 'MODULE_PATHNAME', 'temporal_unnest_timestamps'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestTimestamps(ttext)
+  RETURNS SETOF timestamptz
+  AS 'MODULE_PATHNAME', 'temporal_unnest_timestamps'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION unnest(tbool, OUT value boolean, OUT time periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_unnest'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnest(tint, OUT value integer, OUT time periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_unnest'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnest(tfloat, OUT value float, OUT time periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_unnest'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnest(ttext, OUT value text, OUT time periodset)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_unnest'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION shift(tbool, interval)
   RETURNS tbool
   AS 'MODULE_PATHNAME', 'temporal_shift'
@@ -1203,6 +1315,13 @@ CREATE FUNCTION minusTbox(tfloat, tbox)
  * Ever/Always Comparison Functions 
  *****************************************************************************/
 
+/* The selectivity of the ever/always comparisons is estimated from the base
+ * values of tbool and ttext and from the value ranges of temporal numbers */
+CREATE FUNCTION temporal_ever_sel(internal, oid, internal, integer)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'temporal_ever_sel'
+  LANGUAGE C IMMUTABLE STRICT;
+
 CREATE FUNCTION ever_eq(tbool, boolean)
   RETURNS boolean
   AS 'MODULE_PATHNAME', 'temporal_ever_eq'
@@ -1224,25 +1343,25 @@ CREATE OPERATOR ?= (
   LEFTARG = tbool, RIGHTARG = boolean,
   PROCEDURE = ever_eq,
   NEGATOR = %<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?= (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = ever_eq,
   NEGATOR = %<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?= (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = ever_eq,
   NEGATOR = %<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?= (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = ever_eq,
   NEGATOR = %<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_eq(tbool, boolean)
@@ -1266,26 +1385,55 @@ CREATE OPERATOR %= (
   LEFTARG = tbool, RIGHTARG = boolean,
   PROCEDURE = always_eq,
   NEGATOR = ?<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %= (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = always_eq,
   NEGATOR = ?<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %= (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = always_eq,
   NEGATOR = ?<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %= (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = always_eq,
   NEGATOR = ?<>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
-);
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
+);
+
+/* The support function transforms ever_eq and always_eq into index
+ * conditions and estimates their selectivity, see temporal_supportfn.c */
+#if MOBDB_PGSQL_VERSION >= 120000
+CREATE FUNCTION temporal_supportfn(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_supportfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+ALTER FUNCTION ever_eq(tint, integer) SUPPORT temporal_supportfn;
+ALTER FUNCTION ever_eq(tfloat, float) SUPPORT temporal_supportfn;
+ALTER FUNCTION always_eq(tint, integer) SUPPORT temporal_supportfn;
+ALTER FUNCTION always_eq(tfloat, float) SUPPORT temporal_supportfn;
+
+/* The number of rows of the set-returning functions is estimated from the
+ * number of instants of the temporal values */
+ALTER FUNCTION unnestInstants(tbool) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestInstants(tint) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestInstants(tfloat) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestInstants(ttext) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestTimestamps(tbool) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestTimestamps(tint) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestTimestamps(tfloat) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnestTimestamps(ttext) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnest(tbool) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnest(tint) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnest(tfloat) SUPPORT temporal_supportfn;
+ALTER FUNCTION unnest(ttext) SUPPORT temporal_supportfn;
+#endif
 
 CREATE FUNCTION ever_ne(tbool, boolean)
   RETURNS boolean
@@ -1308,25 +1456,25 @@ CREATE OPERATOR ?<> (
   LEFTARG = tbool, RIGHTARG = boolean,
   PROCEDURE = ever_ne,
   NEGATOR = %=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<> (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = ever_ne,
   NEGATOR = %=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<> (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = ever_ne,
   NEGATOR = %=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<> (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = ever_ne,
   NEGATOR = %=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_ne(tbool, boolean)
@@ -1350,25 +1498,25 @@ CREATE OPERATOR %<> (
   LEFTARG = tbool, RIGHTARG = boolean,
   PROCEDURE = always_ne,
   NEGATOR = ?=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<> (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = always_ne,
   NEGATOR = ?=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<> (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = always_ne,
   NEGATOR = ?=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<> (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = always_ne,
   NEGATOR = ?=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 /*****************************************************************************
@@ -1392,19 +1540,19 @@ CREATE OPERATOR ?< (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = ever_lt,
   NEGATOR = %>=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?< (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = ever_lt,
   NEGATOR = %>=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?< (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = ever_lt,
   NEGATOR = %>=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION ever_le(tint, integer)
@@ -1424,19 +1572,19 @@ CREATE OPERATOR ?<= (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = ever_le,
   NEGATOR = %>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<= (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = ever_le,
   NEGATOR = %>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<= (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = ever_le,
   NEGATOR = %>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_lt(tint, integer)
@@ -1456,19 +1604,19 @@ CREATE OPERATOR %< (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = always_lt,
   NEGATOR = ?>=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %< (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = always_lt,
   NEGATOR = ?>=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %< (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = always_lt,
   NEGATOR = ?>=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_le(tint, integer)
@@ -1488,19 +1636,19 @@ CREATE OPERATOR %<= (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = always_le,
   NEGATOR = ?>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<= (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = always_le,
   NEGATOR = ?>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<= (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = always_le,
   NEGATOR = ?>,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION ever_gt(tint, integer)
@@ -1520,19 +1668,19 @@ CREATE OPERATOR ?> (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = ever_gt,
   NEGATOR = %<=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?> (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = ever_gt,
   NEGATOR = %<=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?> (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = ever_gt,
   NEGATOR = %<=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION ever_ge(tint, integer)
@@ -1552,19 +1700,19 @@ CREATE OPERATOR ?>= (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = ever_ge,
   NEGATOR = %<,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?>= (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = ever_ge,
   NEGATOR = %<,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?>= (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = ever_ge,
   NEGATOR = %<,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_gt(tint, integer)
@@ -1584,19 +1732,19 @@ CREATE OPERATOR %> (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = always_gt,
   NEGATOR = ?<=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %> (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = always_gt,
   NEGATOR = ?<=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %> (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = always_gt,
   NEGATOR = ?<=,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_ge(tint, integer)
@@ -1616,19 +1764,19 @@ CREATE OPERATOR %>= (
   LEFTARG = tint, RIGHTARG = integer,
   PROCEDURE = always_ge,
   NEGATOR = ?<,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %>= (
   LEFTARG = tfloat, RIGHTARG = float,
   PROCEDURE = always_ge,
   NEGATOR = ?<,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %>= (
   LEFTARG = ttext, RIGHTARG = text,
   PROCEDURE = always_ge,
   NEGATOR = ?<,
-  RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+  RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 /*****************************************************************************
@@ -1720,6 +1868,23 @@ CREATE FUNCTION minusTimestampSet(ttext, timestampset)
   AS 'MODULE_PATHNAME', 'temporal_minus_timestampset'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tsample(tbool, interval)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'temporal_sample'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(tint, interval)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_sample'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(tfloat, interval)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'temporal_sample'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(ttext, interval)
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'temporal_sample'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION atPeriod(tbool, period)
   RETURNS tbool
   AS 'MODULE_PATHNAME', 'temporal_at_period'
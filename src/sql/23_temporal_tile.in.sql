@@ -0,0 +1,148 @@
+/*****************************************************************************
+ *
+ * temporal_tile.sql
+ *    Splitting of temporal values into time buckets and value buckets
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Time buckets
+ *****************************************************************************/
+
+CREATE FUNCTION timeSplit(tbool, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT temp tbool)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timeSplit(tint, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT temp tint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timeSplit(tfloat, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT temp tfloat)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timeSplit(ttext, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT temp ttext)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_time_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************
+ * Value buckets
+ *****************************************************************************/
+
+CREATE FUNCTION valueSplit(tint, width integer, origin integer DEFAULT 0,
+    OUT bucket integer, OUT temp tint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tnumber_value_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION valueSplit(tfloat, width float, origin float DEFAULT 0.0,
+    OUT bucket float, OUT temp tfloat)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tnumber_value_split'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************
+ * Time-bucketed statistics
+ *****************************************************************************/
+
+CREATE FUNCTION timeBucketStats(tint, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT count integer, OUT min float, OUT max float, OUT integral float,
+    OUT twavg float)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_stats'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timeBucketStats(tfloat, duration interval,
+    origin timestamptz DEFAULT '2000-01-03', OUT bucket timestamptz,
+    OUT count integer, OUT min float, OUT max float, OUT integral float,
+    OUT twavg float)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_stats'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tnumber_bucket_avg_transfn(internal, tint, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_transfn(internal, tint, interval,
+    timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_transfn(internal, tfloat, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_transfn(internal, tfloat, interval,
+    timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_finalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tnumber_bucket_avg_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_bucket_avg_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE timeBucketAvg(tint, interval) (
+  SFUNC = tnumber_bucket_avg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tnumber_bucket_avg_combinefn,
+  FINALFUNC = tnumber_bucket_avg_finalfn,
+  SERIALFUNC = tnumber_bucket_avg_serialize,
+  DESERIALFUNC = tnumber_bucket_avg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE timeBucketAvg(tint, interval, timestamptz) (
+  SFUNC = tnumber_bucket_avg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tnumber_bucket_avg_combinefn,
+  FINALFUNC = tnumber_bucket_avg_finalfn,
+  SERIALFUNC = tnumber_bucket_avg_serialize,
+  DESERIALFUNC = tnumber_bucket_avg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE timeBucketAvg(tfloat, interval) (
+  SFUNC = tnumber_bucket_avg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tnumber_bucket_avg_combinefn,
+  FINALFUNC = tnumber_bucket_avg_finalfn,
+  SERIALFUNC = tnumber_bucket_avg_serialize,
+  DESERIALFUNC = tnumber_bucket_avg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE timeBucketAvg(tfloat, interval, timestamptz) (
+  SFUNC = tnumber_bucket_avg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tnumber_bucket_avg_combinefn,
+  FINALFUNC = tnumber_bucket_avg_finalfn,
+  SERIALFUNC = tnumber_bucket_avg_serialize,
+  DESERIALFUNC = tnumber_bucket_avg_deserialize,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
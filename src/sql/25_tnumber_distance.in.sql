@@ -0,0 +1,136 @@
+/*****************************************************************************
+ *
+ * tnumber_distance.sql
+ *    Distance functions for temporal numbers.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Nearest approach distance
+ *****************************************************************************/
+
+CREATE FUNCTION nearestApproachDistance(integer, tint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_number_tnumber'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(float, tint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_number_tnumber'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(integer, tfloat)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_number_tnumber'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(float, tfloat)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_number_tnumber'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tint, integer)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tnumber_number'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tint, float)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tnumber_number'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tfloat, integer)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tnumber_number'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tfloat, float)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tnumber_number'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tbox, tbox)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tbox_tbox'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tbox, tint)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tbox_tnumber'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tbox, tfloat)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tbox_tnumber'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tint, tbox)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tnumber_tbox'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION nearestApproachDistance(tfloat, tbox)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'NAD_tnumber_tbox'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR |=| (
+  LEFTARG = integer, RIGHTARG = tint,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = float, RIGHTARG = tint,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = integer, RIGHTARG = tfloat,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = float, RIGHTARG = tfloat,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tint, RIGHTARG = integer,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tint, RIGHTARG = float,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tfloat, RIGHTARG = integer,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tfloat, RIGHTARG = float,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tbox, RIGHTARG = tbox,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tbox, RIGHTARG = tint,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tbox, RIGHTARG = tfloat,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tint, RIGHTARG = tbox,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+CREATE OPERATOR |=| (
+  LEFTARG = tfloat, RIGHTARG = tbox,
+  PROCEDURE = nearestApproachDistance,
+  COMMUTATOR = '|=|'
+);
+
+/*****************************************************************************/
@@ -26,6 +26,15 @@ CREATE FUNCTION tbox(tfloat)
 CREATE CAST (tint AS tbox) WITH FUNCTION tbox(tint) AS IMPLICIT;
 CREATE CAST (tfloat AS tbox) WITH FUNCTION tbox(tfloat) AS IMPLICIT;
 
+CREATE FUNCTION zorder(tint, tbox)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME', 'tnumber_zorder'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION zorder(tfloat, tbox)
+  RETURNS bigint
+  AS 'MODULE_PATHNAME', 'tnumber_zorder'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************
  * Temporal boolean
  *****************************************************************************/
@@ -74,13 +74,30 @@ CREATE FUNCTION tagg_deserialize(bytea, internal)
   AS 'MODULE_PATHNAME', 'temporal_tagg_deserialize'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tagg_sweep_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_tagg_sweep_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tagg_sweep_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tagg_sweep_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tagg_sweep_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tagg_sweep_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_tagg_sweep_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_tagg_sweep_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION tcount_transfn(internal, tbool)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
-CREATE FUNCTION tcount_combinefn(internal, internal)
+CREATE FUNCTION tcount_invfn(internal, tbool)
   RETURNS internal
-  AS 'MODULE_PATHNAME', 'temporal_tcount_combinefn'
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tbool_tand_transfn(internal, tbool)
   RETURNS internal
@@ -110,10 +127,14 @@ CREATE FUNCTION tint_tagg_finalfn(internal)
 CREATE AGGREGATE tcount(tbool) (
   SFUNC = tcount_transfn,
   STYPE = internal,
-  COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tand(tbool) (
@@ -157,6 +178,10 @@ CREATE FUNCTION tint_tsum_transfn(internal, tint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tint_tsum_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_tsum_invfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tint_tsum_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tint_tsum_combinefn(internal, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tint_tsum_combinefn'
@@ -165,6 +190,10 @@ CREATE FUNCTION tcount_transfn(internal, tint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tavg_transfn(internal, tint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tnumber_tavg_transfn'
@@ -199,19 +228,27 @@ CREATE AGGREGATE tmax(tint) (
 CREATE AGGREGATE tsum(tint) (
   SFUNC = tint_tsum_transfn,
   STYPE = internal,
-  COMBINEFUNC = tint_tsum_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tint_tsum_transfn,
+  MINVFUNC = tint_tsum_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tint) (
   SFUNC = tcount_transfn,
   STYPE = internal,
-  COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tavg(tint) (
@@ -252,6 +289,10 @@ CREATE FUNCTION tcount_transfn(internal, tfloat)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tfloat_tagg_finalfn(internal)
   RETURNS tfloat
   AS 'MODULE_PATHNAME', 'temporal_tagg_finalfn'
@@ -291,10 +332,14 @@ CREATE AGGREGATE tsum(tfloat) (
 CREATE AGGREGATE tcount(tfloat) (
   SFUNC = tcount_transfn,
   STYPE = internal,
-  COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tavg(tfloat) (
@@ -329,6 +374,10 @@ CREATE FUNCTION tcount_transfn(internal, ttext)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, ttext)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION ttext_tagg_finalfn(internal)
   RETURNS ttext
   AS 'MODULE_PATHNAME', 'temporal_tagg_finalfn'
@@ -355,10 +404,198 @@ CREATE AGGREGATE tmax(ttext) (
 CREATE AGGREGATE tcount(ttext) (
   SFUNC = tcount_transfn,
   STYPE = internal,
-  COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tagg_sweep_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+CREATE FUNCTION period_union_transfn(internal, period)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'period_union_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION period_union_transfn(internal, periodset)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'periodset_union_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION period_union_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'period_union_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION period_union_finalfn(internal)
+  RETURNS periodset
+  AS 'MODULE_PATHNAME', 'period_union_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION period_union_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'period_union_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION period_union_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'period_union_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE periodUnion(period) (
+  SFUNC = period_union_transfn,
+  STYPE = internal,
+  COMBINEFUNC = period_union_combinefn,
+  FINALFUNC = period_union_finalfn,
+  SERIALFUNC = period_union_serialize,
+  DESERIALFUNC = period_union_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE periodUnion(periodset) (
+  SFUNC = period_union_transfn,
+  STYPE = internal,
+  COMBINEFUNC = period_union_combinefn,
+  FINALFUNC = period_union_finalfn,
+  SERIALFUNC = period_union_serialize,
+  DESERIALFUNC = period_union_deserialize,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************
+ * Sequence aggregation
+ *****************************************************************************/
+
+CREATE FUNCTION tsequence_agg_transfn(internal, bool, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, bool, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, integer, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, integer, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, float, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, float, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, text, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_transfn(internal, text, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tbool_tsequence_agg_finalfn(internal)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'tsequence_agg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tint_tsequence_agg_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'tsequence_agg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tfloat_tsequence_agg_finalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tsequence_agg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ttext_tsequence_agg_finalfn(internal)
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'tsequence_agg_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'tsequence_agg_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsequence_agg_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tsequence_agg_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tsequenceAgg(bool, timestamptz) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tbool_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(bool, timestamptz, interval) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tbool_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(integer, timestamptz) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tint_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(integer, timestamptz, interval) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tint_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(float, timestamptz) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tfloat_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(float, timestamptz, interval) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = tfloat_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(text, timestamptz) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = ttext_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tsequenceAgg(text, timestamptz, interval) (
+  SFUNC = tsequence_agg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tsequence_agg_combinefn,
+  FINALFUNC = ttext_tsequence_agg_finalfn,
+  SERIALFUNC = tsequence_agg_serialize,
+  DESERIALFUNC = tsequence_agg_deserialize,
   PARALLEL = SAFE
 );
 
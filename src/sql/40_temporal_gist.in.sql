@@ -34,6 +34,10 @@ CREATE FUNCTION tbox_gist_same(tbox, tbox, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION tbox_gist_distance(internal, tbox, smallint, oid, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tbox_gist_distance'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 
 CREATE OPERATOR CLASS gist_tbool_ops
@@ -83,6 +87,20 @@ CREATE FUNCTION tbox_gist_consistent(internal, tbox, smallint, oid, internal)
   RETURNS bool
   AS 'MODULE_PATHNAME', 'tnumber_gist_consistent'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+#if MOBDB_PGSQL_VERSION < 110000
+CREATE FUNCTION tbox_gist_compress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tbox_gist_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbox_gist_decompress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_gist_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbox_gist_fetch(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tbox_gist_fetch'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+#endif
 
 CREATE OPERATOR CLASS tbox_gist_ops
   DEFAULT FOR TYPE tbox USING gist AS
@@ -123,6 +141,10 @@ CREATE OPERATOR CLASS tbox_gist_ops
   OPERATOR  17    -|- (tbox, tbox),
   OPERATOR  17    -|- (tbox, tint),
   OPERATOR  17    -|- (tbox, tfloat),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tbox, tbox) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tbox, tint) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tbox, tfloat) FOR ORDER BY pg_catalog.float_ops,
   -- overlaps or before
   OPERATOR  28    &<# (tbox, tbox),
   OPERATOR  28    &<# (tbox, tint),
@@ -142,9 +164,20 @@ CREATE OPERATOR CLASS tbox_gist_ops
   -- functions
   FUNCTION  1  tbox_gist_consistent(internal, tbox, smallint, oid, internal),
   FUNCTION  2  tbox_gist_union(internal, internal),
+#if MOBDB_PGSQL_VERSION < 110000
+  FUNCTION  3  tbox_gist_compress(internal),
+  FUNCTION  4  tbox_gist_decompress(internal),
+#endif
   FUNCTION  5  tbox_gist_penalty(internal, internal, internal),
   FUNCTION  6  tbox_gist_picksplit(internal, internal),
-  FUNCTION  7  tbox_gist_same(tbox, tbox, internal);
+#if MOBDB_PGSQL_VERSION >= 110000
+  FUNCTION  7  tbox_gist_same(tbox, tbox, internal),
+  FUNCTION  8  tbox_gist_distance(internal, tbox, smallint, oid, internal);
+#else
+  FUNCTION  7  tbox_gist_same(tbox, tbox, internal),
+  FUNCTION  8  tbox_gist_distance(internal, tbox, smallint, oid, internal),
+  FUNCTION  9  tbox_gist_fetch(internal);
+#endif
 
 /******************************************************************************/
 
@@ -211,6 +244,10 @@ CREATE OPERATOR CLASS gist_tint_ops
   OPERATOR  17    -|- (tint, tbox),
   OPERATOR  17    -|- (tint, tint),
   OPERATOR  17    -|- (tint, tfloat),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tint, integer) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tint, float) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tint, tbox) FOR ORDER BY pg_catalog.float_ops,
   -- overlaps or before
   OPERATOR  28    &<# (tint, tbox),
   OPERATOR  28    &<# (tint, tint),
@@ -236,7 +273,8 @@ CREATE OPERATOR CLASS gist_tint_ops
 #endif
   FUNCTION  5  tbox_gist_penalty(internal, internal, internal),
   FUNCTION  6  tbox_gist_picksplit(internal, internal),
-  FUNCTION  7  tbox_gist_same(tbox, tbox, internal);
+  FUNCTION  7  tbox_gist_same(tbox, tbox, internal),
+  FUNCTION  8  tbox_gist_distance(internal, tbox, smallint, oid, internal);
 
 /******************************************************************************/
 
@@ -297,6 +335,10 @@ CREATE OPERATOR CLASS gist_tfloat_ops
   OPERATOR  17    -|- (tfloat, tbox),
   OPERATOR  17    -|- (tfloat, tint),
   OPERATOR  17    -|- (tfloat, tfloat),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tfloat, integer) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tfloat, float) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tfloat, tbox) FOR ORDER BY pg_catalog.float_ops,
   -- overlaps or before
   OPERATOR  28    &<# (tfloat, tbox),
   OPERATOR  28    &<# (tfloat, tint),
@@ -322,7 +364,187 @@ CREATE OPERATOR CLASS gist_tfloat_ops
 #endif
   FUNCTION  5  tbox_gist_penalty(internal, internal, internal),
   FUNCTION  6  tbox_gist_picksplit(internal, internal),
-  FUNCTION  7  tbox_gist_same(tbox, tbox, internal);
+  FUNCTION  7  tbox_gist_same(tbox, tbox, internal),
+  FUNCTION  8  tbox_gist_distance(internal, tbox, smallint, oid, internal);
+
+/******************************************************************************
+ * Compact operator classes whose keys store the value bounds as float4
+ * values rounded outward, e.g.,
+ *   CREATE INDEX ON department USING gist(noemps gist_tint_compact_ops);
+ ******************************************************************************/
+
+CREATE FUNCTION gist_tint_compact_consistent(internal, tint, smallint, oid, internal)
+  RETURNS bool
+  AS 'MODULE_PATHNAME', 'tnumber_gist_compact_consistent'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tfloat_compact_consistent(internal, tfloat, smallint, oid, internal)
+  RETURNS bool
+  AS 'MODULE_PATHNAME', 'tnumber_gist_compact_consistent'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tnumber_gist_compact_compress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_gist_compact_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbox_gist_compact_decompress(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tbox_gist_compact_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS gist_tint_compact_ops
+  FOR TYPE tint USING gist AS
+  STORAGE bytea,
+  -- strictly left
+  OPERATOR  1    << (tint, intrange),
+  OPERATOR  1    << (tint, tbox),
+  OPERATOR  1    << (tint, tint),
+  OPERATOR  1    << (tint, tfloat),
+   -- overlaps or left
+  OPERATOR  2    &< (tint, intrange),
+  OPERATOR  2    &< (tint, tbox),
+  OPERATOR  2    &< (tint, tint),
+  OPERATOR  2    &< (tint, tfloat),
+  -- overlaps
+  OPERATOR  3    && (tint, intrange),
+  OPERATOR  3    && (tint, tbox),
+  OPERATOR  3    && (tint, tint),
+  OPERATOR  3    && (tint, tfloat),
+  -- overlaps or right
+  OPERATOR  4    &> (tint, intrange),
+  OPERATOR  4    &> (tint, tbox),
+  OPERATOR  4    &> (tint, tint),
+  OPERATOR  4    &> (tint, tfloat),
+  -- strictly right
+  OPERATOR  5    >> (tint, intrange),
+  OPERATOR  5    >> (tint, tbox),
+  OPERATOR  5    >> (tint, tint),
+  OPERATOR  5    >> (tint, tfloat),
+    -- same
+  OPERATOR  6    ~= (tint, intrange),
+  OPERATOR  6    ~= (tint, tbox),
+  OPERATOR  6    ~= (tint, tint),
+  OPERATOR  6    ~= (tint, tfloat),
+  -- contains
+  OPERATOR  7    @> (tint, intrange),
+  OPERATOR  7    @> (tint, tbox),
+  OPERATOR  7    @> (tint, tint),
+  OPERATOR  7    @> (tint, tfloat),
+  -- contained by
+  OPERATOR  8    <@ (tint, intrange),
+  OPERATOR  8    <@ (tint, tbox),
+  OPERATOR  8    <@ (tint, tint),
+  OPERATOR  8    <@ (tint, tfloat),
+  -- adjacent
+  OPERATOR  17    -|- (tint, intrange),
+  OPERATOR  17    -|- (tint, tbox),
+  OPERATOR  17    -|- (tint, tint),
+  OPERATOR  17    -|- (tint, tfloat),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tint, integer) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tint, float) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tint, tbox) FOR ORDER BY pg_catalog.float_ops,
+  -- overlaps or before
+  OPERATOR  28    &<# (tint, tbox),
+  OPERATOR  28    &<# (tint, tint),
+  OPERATOR  28    &<# (tint, tfloat),
+  -- strictly before
+  OPERATOR  29    <<# (tint, tbox),
+  OPERATOR  29    <<# (tint, tint),
+  OPERATOR  29    <<# (tint, tfloat),
+  -- strictly after
+  OPERATOR  30    #>> (tint, tbox),
+  OPERATOR  30    #>> (tint, tint),
+  OPERATOR  30    #>> (tint, tfloat),
+  -- overlaps or after
+  OPERATOR  31    #&> (tint, tbox),
+  OPERATOR  31    #&> (tint, tint),
+  OPERATOR  31    #&> (tint, tfloat),
+  -- functions
+  FUNCTION  1  gist_tint_compact_consistent(internal, tint, smallint, oid, internal),
+  FUNCTION  2  tbox_gist_union(internal, internal),
+  FUNCTION  3  tnumber_gist_compact_compress(internal),
+  FUNCTION  4  tbox_gist_compact_decompress(internal),
+  FUNCTION  5  tbox_gist_penalty(internal, internal, internal),
+  FUNCTION  6  tbox_gist_picksplit(internal, internal),
+  FUNCTION  7  tbox_gist_same(tbox, tbox, internal),
+  FUNCTION  8  tbox_gist_distance(internal, tbox, smallint, oid, internal);
+
+CREATE OPERATOR CLASS gist_tfloat_compact_ops
+  FOR TYPE tfloat USING gist AS
+  STORAGE bytea,
+  -- strictly left
+  OPERATOR  1    << (tfloat, floatrange),
+  OPERATOR  1    << (tfloat, tbox),
+  OPERATOR  1    << (tfloat, tint),
+  OPERATOR  1    << (tfloat, tfloat),
+   -- overlaps or left
+  OPERATOR  2    &< (tfloat, floatrange),
+  OPERATOR  2    &< (tfloat, tbox),
+  OPERATOR  2    &< (tfloat, tint),
+  OPERATOR  2    &< (tfloat, tfloat),
+  -- overlaps
+  OPERATOR  3    && (tfloat, floatrange),
+  OPERATOR  3    && (tfloat, tbox),
+  OPERATOR  3    && (tfloat, tint),
+  OPERATOR  3    && (tfloat, tfloat),
+  -- overlaps or right
+  OPERATOR  4    &> (tfloat, floatrange),
+  OPERATOR  4    &> (tfloat, tbox),
+  OPERATOR  4    &> (tfloat, tint),
+  OPERATOR  4    &> (tfloat, tfloat),
+  -- strictly right
+  OPERATOR  5    >> (tfloat, floatrange),
+  OPERATOR  5    >> (tfloat, tbox),
+  OPERATOR  5    >> (tfloat, tint),
+  OPERATOR  5    >> (tfloat, tfloat),
+    -- same
+  OPERATOR  6    ~= (tfloat, floatrange),
+  OPERATOR  6    ~= (tfloat, tbox),
+  OPERATOR  6    ~= (tfloat, tint),
+  OPERATOR  6    ~= (tfloat, tfloat),
+  -- contains
+  OPERATOR  7    @> (tfloat, floatrange),
+  OPERATOR  7    @> (tfloat, tbox),
+  OPERATOR  7    @> (tfloat, tint),
+  OPERATOR  7    @> (tfloat, tfloat),
+  -- contained by
+  OPERATOR  8    <@ (tfloat, floatrange),
+  OPERATOR  8    <@ (tfloat, tbox),
+  OPERATOR  8    <@ (tfloat, tint),
+  OPERATOR  8    <@ (tfloat, tfloat),
+  -- adjacent
+  OPERATOR  17    -|- (tfloat, floatrange),
+  OPERATOR  17    -|- (tfloat, tbox),
+  OPERATOR  17    -|- (tfloat, tint),
+  OPERATOR  17    -|- (tfloat, tfloat),
+  -- nearest approach distance
+  OPERATOR  25    |=| (tfloat, integer) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tfloat, float) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tfloat, tbox) FOR ORDER BY pg_catalog.float_ops,
+  -- overlaps or before
+  OPERATOR  28    &<# (tfloat, tbox),
+  OPERATOR  28    &<# (tfloat, tint),
+  OPERATOR  28    &<# (tfloat, tfloat),
+  -- strictly before
+  OPERATOR  29    <<# (tfloat, tbox),
+  OPERATOR  29    <<# (tfloat, tint),
+  OPERATOR  29    <<# (tfloat, tfloat),
+  -- strictly after
+  OPERATOR  30    #>> (tfloat, tbox),
+  OPERATOR  30    #>> (tfloat, tint),
+  OPERATOR  30    #>> (tfloat, tfloat),
+  -- overlaps or after
+  OPERATOR  31    #&> (tfloat, tbox),
+  OPERATOR  31    #&> (tfloat, tint),
+  OPERATOR  31    #&> (tfloat, tfloat),
+  -- functions
+  FUNCTION  1  gist_tfloat_compact_consistent(internal, tfloat, smallint, oid, internal),
+  FUNCTION  2  tbox_gist_union(internal, internal),
+  FUNCTION  3  tnumber_gist_compact_compress(internal),
+  FUNCTION  4  tbox_gist_compact_decompress(internal),
+  FUNCTION  5  tbox_gist_penalty(internal, internal, internal),
+  FUNCTION  6  tbox_gist_picksplit(internal, internal),
+  FUNCTION  7  tbox_gist_same(tbox, tbox, internal),
+  FUNCTION  8  tbox_gist_distance(internal, tbox, smallint, oid, internal);
 
 /******************************************************************************/
 
@@ -377,3 +599,14 @@ CREATE OPERATOR CLASS gist_ttext_ops
   FUNCTION  7  period_gist_same(period, period, internal);
 
 /******************************************************************************/
+
+/******************************************************************************
+ * Statistics of the GiST indexes whose keys are period, tbox, or stbox
+ ******************************************************************************/
+
+CREATE FUNCTION giststat(index text, sample float DEFAULT 1.0)
+  RETURNS text
+  AS 'MODULE_PATHNAME', 'giststat'
+  LANGUAGE C VOLATILE STRICT;
+
+/******************************************************************************/
@@ -123,6 +123,12 @@ CREATE OPERATOR CLASS tbox_spgist_ops
   OPERATOR  17    -|- (tbox, tbox),
   OPERATOR  17    -|- (tbox, tint),
   OPERATOR  17    -|- (tbox, tfloat),
+#if MOBDB_PGSQL_VERSION >= 120000
+  -- nearest approach distance
+  OPERATOR  25    |=| (tbox, tbox) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tbox, tint) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tbox, tfloat) FOR ORDER BY pg_catalog.float_ops,
+#endif
   -- overlaps or before
   OPERATOR  28    &<# (tbox, tbox),
   OPERATOR  28    &<# (tbox, tint),
@@ -195,6 +201,12 @@ CREATE OPERATOR CLASS spgist_tint_ops
   OPERATOR  17    -|- (tint, tbox),
   OPERATOR  17    -|- (tint, tint),
   OPERATOR  17    -|- (tint, tfloat),
+#if MOBDB_PGSQL_VERSION >= 120000
+  -- nearest approach distance
+  OPERATOR  25    |=| (tint, integer) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tint, float) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tint, tbox) FOR ORDER BY pg_catalog.float_ops,
+#endif
   -- overlaps or before
   OPERATOR  28    &<# (tint, tbox),
   OPERATOR  28    &<# (tint, tint),
@@ -268,6 +280,12 @@ CREATE OPERATOR CLASS spgist_tfloat_ops
   OPERATOR  17    -|- (tfloat, tbox),
   OPERATOR  17    -|- (tfloat, tint),
   OPERATOR  17    -|- (tfloat, tfloat),
+#if MOBDB_PGSQL_VERSION >= 120000
+  -- nearest approach distance
+  OPERATOR  25    |=| (tfloat, integer) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tfloat, float) FOR ORDER BY pg_catalog.float_ops,
+  OPERATOR  25    |=| (tfloat, tbox) FOR ORDER BY pg_catalog.float_ops,
+#endif
   -- overlaps or before
   OPERATOR  28    &<# (tfloat, tbox),
   OPERATOR  28    &<# (tfloat, tint),
@@ -0,0 +1,174 @@
+/*****************************************************************************
+ *
+ * temporal_brin.sql
+ *    BRIN index for temporal numbers
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION temporal_brin_opcinfo(internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tnumber_brin_add_value(internal, internal, internal, internal)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tnumber_brin_consistent(internal, internal, internal)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tnumber_brin_union(internal, internal, internal)
+  RETURNS boolean
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/******************************************************************************/
+
+CREATE OPERATOR CLASS brin_tint_ops
+  DEFAULT FOR TYPE tint USING brin AS
+  STORAGE tbox,
+  -- strictly left
+  OPERATOR  1    << (tint, intrange),
+  OPERATOR  1    << (tint, tbox),
+  OPERATOR  1    << (tint, tint),
+  OPERATOR  1    << (tint, tfloat),
+   -- overlaps or left
+  OPERATOR  2    &< (tint, intrange),
+  OPERATOR  2    &< (tint, tbox),
+  OPERATOR  2    &< (tint, tint),
+  OPERATOR  2    &< (tint, tfloat),
+  -- overlaps
+  OPERATOR  3    && (tint, intrange),
+  OPERATOR  3    && (tint, tbox),
+  OPERATOR  3    && (tint, tint),
+  OPERATOR  3    && (tint, tfloat),
+  -- overlaps or right
+  OPERATOR  4    &> (tint, intrange),
+  OPERATOR  4    &> (tint, tbox),
+  OPERATOR  4    &> (tint, tint),
+  OPERATOR  4    &> (tint, tfloat),
+  -- strictly right
+  OPERATOR  5    >> (tint, intrange),
+  OPERATOR  5    >> (tint, tbox),
+  OPERATOR  5    >> (tint, tint),
+  OPERATOR  5    >> (tint, tfloat),
+    -- same
+  OPERATOR  6    ~= (tint, intrange),
+  OPERATOR  6    ~= (tint, tbox),
+  OPERATOR  6    ~= (tint, tint),
+  OPERATOR  6    ~= (tint, tfloat),
+  -- contains
+  OPERATOR  7    @> (tint, intrange),
+  OPERATOR  7    @> (tint, tbox),
+  OPERATOR  7    @> (tint, tint),
+  OPERATOR  7    @> (tint, tfloat),
+  -- contained by
+  OPERATOR  8    <@ (tint, intrange),
+  OPERATOR  8    <@ (tint, tbox),
+  OPERATOR  8    <@ (tint, tint),
+  OPERATOR  8    <@ (tint, tfloat),
+  -- adjacent
+  OPERATOR  17    -|- (tint, intrange),
+  OPERATOR  17    -|- (tint, tbox),
+  OPERATOR  17    -|- (tint, tint),
+  OPERATOR  17    -|- (tint, tfloat),
+  -- overlaps or before
+  OPERATOR  28    &<# (tint, tbox),
+  OPERATOR  28    &<# (tint, tint),
+  OPERATOR  28    &<# (tint, tfloat),
+  -- strictly before
+  OPERATOR  29    <<# (tint, tbox),
+  OPERATOR  29    <<# (tint, tint),
+  OPERATOR  29    <<# (tint, tfloat),
+  -- strictly after
+  OPERATOR  30    #>> (tint, tbox),
+  OPERATOR  30    #>> (tint, tint),
+  OPERATOR  30    #>> (tint, tfloat),
+  -- overlaps or after
+  OPERATOR  31    #&> (tint, tbox),
+  OPERATOR  31    #&> (tint, tint),
+  OPERATOR  31    #&> (tint, tfloat),
+  -- functions
+  FUNCTION  1  temporal_brin_opcinfo(internal),
+  FUNCTION  2  tnumber_brin_add_value(internal, internal, internal, internal),
+  FUNCTION  3  tnumber_brin_consistent(internal, internal, internal),
+  FUNCTION  4  tnumber_brin_union(internal, internal, internal);
+
+/******************************************************************************/
+
+CREATE OPERATOR CLASS brin_tfloat_ops
+  DEFAULT FOR TYPE tfloat USING brin AS
+  STORAGE tbox,
+  -- strictly left
+  OPERATOR  1    << (tfloat, floatrange),
+  OPERATOR  1    << (tfloat, tbox),
+  OPERATOR  1    << (tfloat, tint),
+  OPERATOR  1    << (tfloat, tfloat),
+   -- overlaps or left
+  OPERATOR  2    &< (tfloat, floatrange),
+  OPERATOR  2    &< (tfloat, tbox),
+  OPERATOR  2    &< (tfloat, tint),
+  OPERATOR  2    &< (tfloat, tfloat),
+  -- overlaps
+  OPERATOR  3    && (tfloat, floatrange),
+  OPERATOR  3    && (tfloat, tbox),
+  OPERATOR  3    && (tfloat, tint),
+  OPERATOR  3    && (tfloat, tfloat),
+  -- overlaps or right
+  OPERATOR  4    &> (tfloat, floatrange),
+  OPERATOR  4    &> (tfloat, tbox),
+  OPERATOR  4    &> (tfloat, tint),
+  OPERATOR  4    &> (tfloat, tfloat),
+  -- strictly right
+  OPERATOR  5    >> (tfloat, floatrange),
+  OPERATOR  5    >> (tfloat, tbox),
+  OPERATOR  5    >> (tfloat, tint),
+  OPERATOR  5    >> (tfloat, tfloat),
+    -- same
+  OPERATOR  6    ~= (tfloat, floatrange),
+  OPERATOR  6    ~= (tfloat, tbox),
+  OPERATOR  6    ~= (tfloat, tint),
+  OPERATOR  6    ~= (tfloat, tfloat),
+  -- contains
+  OPERATOR  7    @> (tfloat, floatrange),
+  OPERATOR  7    @> (tfloat, tbox),
+  OPERATOR  7    @> (tfloat, tint),
+  OPERATOR  7    @> (tfloat, tfloat),
+  -- contained by
+  OPERATOR  8    <@ (tfloat, floatrange),
+  OPERATOR  8    <@ (tfloat, tbox),
+  OPERATOR  8    <@ (tfloat, tint),
+  OPERATOR  8    <@ (tfloat, tfloat),
+  -- adjacent
+  OPERATOR  17    -|- (tfloat, floatrange),
+  OPERATOR  17    -|- (tfloat, tbox),
+  OPERATOR  17    -|- (tfloat, tint),
+  OPERATOR  17    -|- (tfloat, tfloat),
+  -- overlaps or before
+  OPERATOR  28    &<# (tfloat, tbox),
+  OPERATOR  28    &<# (tfloat, tint),
+  OPERATOR  28    &<# (tfloat, tfloat),
+  -- strictly before
+  OPERATOR  29    <<# (tfloat, tbox),
+  OPERATOR  29    <<# (tfloat, tint),
+  OPERATOR  29    <<# (tfloat, tfloat),
+  -- strictly after
+  OPERATOR  30    #>> (tfloat, tbox),
+  OPERATOR  30    #>> (tfloat, tint),
+  OPERATOR  30    #>> (tfloat, tfloat),
+  -- overlaps or after
+  OPERATOR  31    #&> (tfloat, tbox),
+  OPERATOR  31    #&> (tfloat, tint),
+  OPERATOR  31    #&> (tfloat, tfloat),
+  -- functions
+  FUNCTION  1  temporal_brin_opcinfo(internal),
+  FUNCTION  2  tnumber_brin_add_value(internal, internal, internal, internal),
+  FUNCTION  3  tnumber_brin_consistent(internal, internal, internal),
+  FUNCTION  4  tnumber_brin_union(internal, internal, internal);
+
+/******************************************************************************/
@@ -0,0 +1,27 @@
+/*****************************************************************************
+ *
+ * temporal_counters.sql
+ *    Counters of the work done by the hot paths of the extension
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/* The counters are per backend, they are thus not parallel safe */
+
+CREATE FUNCTION mobilitydb_stats(OUT counter text, OUT value bigint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'mobilitydb_stats'
+  LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION mobilitydb_stats_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME', 'mobilitydb_stats_reset'
+  LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+CREATE VIEW mobilitydb_stats AS
+  SELECT counter, value FROM mobilitydb_stats();
+
+/******************************************************************************/
@@ -0,0 +1,53 @@
+/*****************************************************************************
+ *
+ * temporal_arrow.sql
+ *    Columnar export of temporal values in the memory layout of Apache Arrow
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION asArrow_transfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_arrow_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asArrow_transfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_arrow_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION asArrow_finalfn(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_arrow_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE asArrow(tint) (
+  SFUNC = asArrow_transfn,
+  STYPE = internal,
+  FINALFUNC = asArrow_finalfn
+);
+CREATE AGGREGATE asArrow(tfloat) (
+  SFUNC = asArrow_transfn,
+  STYPE = internal,
+  FINALFUNC = asArrow_finalfn
+);
+
+/*****************************************************************************/
+
+-- Import of the buffers produced by asArrow, where the temporal values are
+-- split into sequence sets at the gaps larger than the maximum gap, if any
+
+CREATE FUNCTION tintFromArrow(bytea, maxgap interval DEFAULT NULL,
+    OUT id integer, OUT temp tint)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_from_arrow'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloatFromArrow(bytea, maxgap interval DEFAULT NULL,
+    OUT id integer, OUT temp tfloat)
+  RETURNS SETOF record
+  AS 'MODULE_PATHNAME', 'temporal_from_arrow'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+/*****************************************************************************/
@@ -0,0 +1,249 @@
+/*****************************************************************************
+ *
+ * temporal_rollup.sql
+ *    Rollups of temporal aggregates maintained incrementally
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/*
+ * The state aggregates return the serialized partial state of an aggregate,
+ * the merge aggregates combine serialized states and return either the
+ * merged state or the final value of the aggregate.
+ */
+
+CREATE FUNCTION tagg_sweep_merge_transfn(internal, bytea)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tagg_sweep_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_merge_transfn(internal, bytea)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_tavg_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE tcountState(tbool) (
+  SFUNC = tcount_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountState(tint) (
+  SFUNC = tcount_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountState(tfloat) (
+  SFUNC = tcount_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountState(ttext) (
+  SFUNC = tcount_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountMergeState(bytea) (
+  SFUNC = tagg_sweep_merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tagg_sweep_serialize,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountMerge(bytea) (
+  SFUNC = tagg_sweep_merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tagg_sweep_combinefn,
+  FINALFUNC = tint_tagg_sweep_finalfn,
+  SERIALFUNC = tagg_sweep_serialize,
+  DESERIALFUNC = tagg_sweep_deserialize,
+  PARALLEL = SAFE
+);
+
+CREATE AGGREGATE tavgState(tint) (
+  SFUNC = tavg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tavg_combinefn,
+  FINALFUNC = tagg_serialize,
+  SERIALFUNC = tagg_serialize,
+  DESERIALFUNC = tagg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tavgState(tfloat) (
+  SFUNC = tavg_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tavg_combinefn,
+  FINALFUNC = tagg_serialize,
+  SERIALFUNC = tagg_serialize,
+  DESERIALFUNC = tagg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tavgMergeState(bytea) (
+  SFUNC = tavg_merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tavg_combinefn,
+  FINALFUNC = tagg_serialize,
+  SERIALFUNC = tagg_serialize,
+  DESERIALFUNC = tagg_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tavgMerge(bytea) (
+  SFUNC = tavg_merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = tavg_combinefn,
+  FINALFUNC = tavg_finalfn,
+  SERIALFUNC = tagg_serialize,
+  DESERIALFUNC = tagg_deserialize,
+  PARALLEL = SAFE
+);
+
+/* The states of the extent are the boxes, which are merged by their extent */
+
+CREATE AGGREGATE extent(period) (
+  SFUNC = temporal_extent_combinefn,
+  STYPE = period,
+  COMBINEFUNC = temporal_extent_combinefn,
+  PARALLEL = safe
+);
+CREATE AGGREGATE extent(tbox) (
+  SFUNC = tnumber_extent_combinefn,
+  STYPE = tbox,
+  COMBINEFUNC = tnumber_extent_combinefn,
+  PARALLEL = safe
+);
+
+/*****************************************************************************
+ * Registry of the rollups
+ *****************************************************************************/
+
+/*
+ * Each rollup stores in the table of the same name the state of the
+ * aggregate for each value of the grouping expression, and the view
+ * <name>_view returns the final values. The rows of the source whose
+ * watermark is greater than the last one merged are merged by refreshRollup.
+ * Therefore, the watermark must increase with the rows appended to the
+ * source, such as a serial column or the time of insertion.
+ */
+CREATE TABLE mobilitydb_rollups (
+  name text PRIMARY KEY,
+  source regclass NOT NULL,
+  argument text NOT NULL,
+  groupby text NOT NULL,
+  watermark name NOT NULL,
+  marktype text NOT NULL,
+  lastmark text,
+  statefn text NOT NULL,
+  mergefn text NOT NULL,
+  finalfn text NOT NULL
+);
+
+CREATE FUNCTION createRollup(rollup text, source regclass, aggregate text,
+  argument text, groupby text, watermark name)
+RETURNS void AS $$
+DECLARE
+  fns text[];
+  marktype text;
+BEGIN
+  fns := CASE lower(aggregate)
+    WHEN 'tcount' THEN ARRAY['tcountState', 'tcountMergeState', 'tcountMerge']
+    WHEN 'tavg' THEN ARRAY['tavgState', 'tavgMergeState', 'tavgMerge']
+    WHEN 'extent' THEN ARRAY['extent', 'extent', 'extent']
+    END;
+  IF fns IS NULL THEN
+    RAISE EXCEPTION 'Unsupported aggregate for a rollup: %', aggregate;
+  END IF;
+  SELECT format_type(atttypid, atttypmod) INTO marktype
+  FROM pg_attribute
+  WHERE attrelid = source AND attname = watermark AND NOT attisdropped;
+  IF marktype IS NULL THEN
+    RAISE EXCEPTION 'The watermark column % does not exist in %',
+      watermark, source;
+  END IF;
+  EXECUTE format('CREATE TABLE %I AS SELECT %s AS grp, %s(%s) AS state '
+    'FROM %s WHERE false GROUP BY 1', rollup, groupby, fns[1], argument,
+    source);
+  EXECUTE format('ALTER TABLE %I ADD PRIMARY KEY (grp)', rollup);
+  EXECUTE format('CREATE VIEW %I AS SELECT grp, %s(state) AS value '
+    'FROM %I GROUP BY grp', rollup || '_view', fns[3], rollup);
+  INSERT INTO mobilitydb_rollups VALUES (rollup, source, argument, groupby,
+    watermark, marktype, NULL, fns[1], fns[2], fns[3]);
+END;
+$$ LANGUAGE plpgsql STRICT;
+
+/*
+ * Merges the rows of the source appended since the last refresh into the
+ * states of the rollup and returns the number of rows merged
+ */
+CREATE FUNCTION refreshRollup(rollup text)
+RETURNS bigint AS $$
+DECLARE
+  r mobilitydb_rollups;
+  cond text;
+  newmark text;
+  result bigint;
+BEGIN
+  SELECT * INTO r FROM mobilitydb_rollups WHERE name = rollup FOR UPDATE;
+  IF NOT FOUND THEN
+    RAISE EXCEPTION 'The rollup % does not exist', rollup;
+  END IF;
+  cond := CASE WHEN r.lastmark IS NULL THEN 'true'
+    ELSE format('%I > %L::%s', r.watermark, r.lastmark, r.marktype) END;
+  EXECUTE format('SELECT max(%I)::text, count(*) FROM %s WHERE %s',
+    r.watermark, r.source, cond) INTO newmark, result;
+  IF newmark IS NULL THEN
+    RETURN 0;
+  END IF;
+  EXECUTE format('INSERT INTO %1$I AS r (grp, state) '
+    'SELECT %2$s, %3$s(%4$s) FROM %5$s WHERE %6$s AND %7$I <= %8$L::%9$s '
+    'GROUP BY 1 ON CONFLICT (grp) DO UPDATE SET state = '
+    '(SELECT %10$s(s) FROM (VALUES (r.state), (EXCLUDED.state)) t(s))',
+    r.name, r.groupby, r.statefn, r.argument, r.source, cond, r.watermark,
+    newmark, r.marktype, r.mergefn);
+  UPDATE mobilitydb_rollups SET lastmark = newmark WHERE name = rollup;
+  RETURN result;
+END;
+$$ LANGUAGE plpgsql STRICT;
+
+/*
+ * Refreshes all the rollups, this function is called by the background
+ * worker
+ */
+CREATE FUNCTION refreshRollups()
+RETURNS bigint AS $$
+  SELECT coalesce(sum(refreshRollup(name)), 0)::bigint
+  FROM (SELECT name FROM mobilitydb_rollups ORDER BY name) t;
+$$ LANGUAGE sql;
+
+CREATE FUNCTION dropRollup(rollup text)
+RETURNS void AS $$
+BEGIN
+  IF NOT EXISTS (SELECT 1 FROM mobilitydb_rollups WHERE name = rollup) THEN
+    RAISE EXCEPTION 'The rollup % does not exist', rollup;
+  END IF;
+  EXECUTE format('DROP VIEW %I', rollup || '_view');
+  EXECUTE format('DROP TABLE %I', rollup);
+  DELETE FROM mobilitydb_rollups WHERE name = rollup;
+END;
+$$ LANGUAGE plpgsql STRICT;
+
+/*****************************************************************************/
@@ -12,6 +12,9 @@
 
 #include "tbool_boolops.h"
 
+#include <utils/timestamp.h>
+
+#include "timeops.h"
 #include "temporaltypes.h"
 #include "lifting.h"
 
@@ -56,10 +59,195 @@ boolop_tbool_bool(Temporal *temp, Datum b, Datum (*func)(Datum, Datum),
   return tfunc_temporal_base(temp, b, BOOLOID, (Datum) NULL, lfinfo);
 }
 
+/*****************************************************************************
+ * Merge of temporal Boolean sequences
+ *****************************************************************************/
+
+/*
+ * Since temporal Booleans have step interpolation, the value of a sequence
+ * only changes at its instants. The and/or of two sequences is computed by
+ * merging their instants in time order and keeping only the instants where
+ * the result changes, instead of synchronizing the two sequences as done by
+ * the generic lifting functions.
+ */
+
+/**
+ * Returns the index of the last instant of the temporal Boolean sequence
+ * whose timestamp is less than or equal to the timestamp
+ */
+static int
+tboolseq_find_timestamp(const TSequence *seq, TimestampTz t)
+{
+  int first = 0, last = seq->count - 1;
+  while (first < last)
+  {
+    int middle = (first + last + 1) / 2;
+    if (tsequence_inst_n(seq, middle)->t <= t)
+      first = middle;
+    else
+      last = middle - 1;
+  }
+  return first;
+}
+
+/**
+ * Returns the value of the n-th instant of the temporal Boolean sequence
+ */
+static inline bool
+tboolseq_value_n(const TSequence *seq, int n)
+{
+  return DatumGetBool(tinstant_value(tsequence_inst_n(seq, n)));
+}
+
+/**
+ * Returns the Boolean and/or of the two values
+ */
+static inline bool
+bool_op(bool b1, bool b2, bool and)
+{
+  return and ? (b1 && b2) : (b1 || b2);
+}
+
+/**
+ * Returns the temporal Boolean and/or of the temporal Boolean sequences,
+ * or NULL if their periods do not overlap
+ */
+static TSequence *
+boolop_tboolseq_tboolseq(const TSequence *seq1, const TSequence *seq2,
+  bool and)
+{
+  Period *inter = intersection_period_period_internal(&seq1->period,
+    &seq2->period);
+  if (inter == NULL)
+    return NULL;
+
+  int i = tboolseq_find_timestamp(seq1, inter->lower);
+  int j = tboolseq_find_timestamp(seq2, inter->lower);
+  bool value1 = tboolseq_value_n(seq1, i);
+  bool value2 = tboolseq_value_n(seq2, j);
+  bool value = bool_op(value1, value2, and);
+  TSequence *result;
+  if (inter->lower == inter->upper)
+  {
+    TInstant *inst = tinstant_make(BoolGetDatum(value), inter->lower,
+      BOOLOID);
+    result = tinstant_to_tsequence(inst, STEP);
+    pfree(inst); pfree(inter);
+    return result;
+  }
+
+  TInstant **instants = palloc(sizeof(TInstant *) *
+    (seq1->count - i + seq2->count - j));
+  int k = 0;
+  instants[k++] = tinstant_make(BoolGetDatum(value), inter->lower, BOOLOID);
+  /* Merge the instants strictly inside the intersection */
+  i++; j++;
+  while (true)
+  {
+    TimestampTz t1 = (i < seq1->count) ?
+      tsequence_inst_n(seq1, i)->t : DT_NOEND;
+    TimestampTz t2 = (j < seq2->count) ?
+      tsequence_inst_n(seq2, j)->t : DT_NOEND;
+    TimestampTz t = Min(t1, t2);
+    if (t >= inter->upper)
+      break;
+    if (t1 == t)
+      value1 = tboolseq_value_n(seq1, i++);
+    if (t2 == t)
+      value2 = tboolseq_value_n(seq2, j++);
+    bool newvalue = bool_op(value1, value2, and);
+    if (newvalue != value)
+    {
+      value = newvalue;
+      instants[k++] = tinstant_make(BoolGetDatum(value), t, BOOLOID);
+    }
+  }
+  /* The last two values of sequences with step interpolation and
+   * exclusive upper bound must be equal, otherwise the value at the upper
+   * bound is computed */
+  if (inter->upper_inc)
+  {
+    if (i < seq1->count && tsequence_inst_n(seq1, i)->t == inter->upper)
+      value1 = tboolseq_value_n(seq1, i);
+    if (j < seq2->count && tsequence_inst_n(seq2, j)->t == inter->upper)
+      value2 = tboolseq_value_n(seq2, j);
+    value = bool_op(value1, value2, and);
+  }
+  instants[k++] = tinstant_make(BoolGetDatum(value), inter->upper, BOOLOID);
+  result = tsequence_make_free(instants, k, inter->lower_inc,
+    inter->upper_inc, STEP, NORMALIZE);
+  pfree(inter);
+  return result;
+}
+
+/**
+ * Returns the n-th sequence of the temporal Boolean sequence or sequence set
+ */
+static const TSequence *
+tbool_seq_n(const Temporal *temp, int n)
+{
+  if (temp->duration == SEQUENCE)
+    return (const TSequence *) temp;
+  return tsequenceset_seq_n((const TSequenceSet *) temp, n);
+}
+
+/**
+ * Returns the temporal Boolean and/or of the temporal Boolean sequences or
+ * sequence sets, or NULL if they do not overlap in time
+ */
+static Temporal *
+boolop_tboolseqset_tboolseqset(const Temporal *temp1, const Temporal *temp2,
+  bool and)
+{
+  if (temp1->duration == SEQUENCE && temp2->duration == SEQUENCE)
+    return (Temporal *) boolop_tboolseq_tboolseq((const TSequence *) temp1,
+      (const TSequence *) temp2, and);
+
+  int count1 = (temp1->duration == SEQUENCE) ? 1 :
+    ((const TSequenceSet *) temp1)->count;
+  int count2 = (temp2->duration == SEQUENCE) ? 1 :
+    ((const TSequenceSet *) temp2)->count;
+  TSequence **sequences = palloc(sizeof(TSequence *) * (count1 + count2));
+  int i = 0, j = 0, k = 0;
+  while (i < count1 && j < count2)
+  {
+    const TSequence *seq1 = tbool_seq_n(temp1, i);
+    const TSequence *seq2 = tbool_seq_n(temp2, j);
+    TSequence *seq = boolop_tboolseq_tboolseq(seq1, seq2, and);
+    if (seq != NULL)
+      sequences[k++] = seq;
+    int cmp = timestamp_cmp_internal(seq1->period.upper, seq2->period.upper);
+    if (cmp == 0)
+    {
+      if (!seq1->period.upper_inc && seq2->period.upper_inc)
+        cmp = -1;
+      else if (seq1->period.upper_inc && !seq2->period.upper_inc)
+        cmp = 1;
+    }
+    if (cmp == 0)
+    {
+      i++; j++;
+    }
+    else if (cmp < 0)
+      i++;
+    else
+      j++;
+  }
+  return (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE);
+}
+
+/*****************************************************************************/
+
 Temporal *
 boolop_tbool_tbool(Temporal *temp1, Temporal *temp2,
   Datum (*func)(Datum, Datum))
 {
+  /* Temporal Boolean sequences are merged without synchronizing them */
+  if ((func == &datum_and || func == &datum_or) &&
+      (temp1->duration == SEQUENCE || temp1->duration == SEQUENCESET) &&
+      (temp2->duration == SEQUENCE || temp2->duration == SEQUENCESET))
+    return boolop_tboolseqset_tboolseqset(temp1, temp2, func == &datum_and);
+
   LiftedFunctionInfo lfinfo;
   lfinfo.func = (varfunc) func;
   lfinfo.numparam = 2;
@@ -1431,5 +1431,47 @@ tbox_ne(PG_FUNCTION_ARGS)
   PG_RETURN_BOOL(! tbox_eq_internal(box1, box2));
 }
 
+/*****************************************************************************
+ * Z-order functions
+ * The Z-order key of a box is computed from the center of its value and
+ * time dimensions, normalized with respect to an extent. Ordering a table
+ * by this key clusters the values that are close in both dimensions.
+ *****************************************************************************/
+
+/* Number of bits per dimension of the Z-order key of a box */
+#define TBOX_ZORDER_BITS    31
+
+/**
+ * Returns the Z-order key of the temporal box with respect to the extent
+ * (internal function)
+ */
+int64
+tbox_zorder_internal(const TBOX *box, const TBOX *extent)
+{
+  uint32 cells[2];
+  TimestampTz t = box->tmin + (box->tmax - box->tmin) / 2;
+  cells[0] = zorder_cell(box->xmin + (box->xmax - box->xmin) / 2,
+    extent->xmin, extent->xmax, TBOX_ZORDER_BITS);
+  cells[1] = zorder_cell((double) t, (double) extent->tmin,
+    (double) extent->tmax, TBOX_ZORDER_BITS);
+  return (int64) zorder_encode(cells, 2, TBOX_ZORDER_BITS);
+}
+
+PG_FUNCTION_INFO_V1(tbox_zorder);
+/**
+ * Returns the Z-order key of the temporal box with respect to the extent
+ */
+PGDLLEXPORT Datum
+tbox_zorder(PG_FUNCTION_ARGS)
+{
+  TBOX *box = PG_GETARG_TBOX_P(0);
+  TBOX *extent = PG_GETARG_TBOX_P(1);
+  ensure_has_X_tbox(box);
+  ensure_has_T_tbox(box);
+  ensure_has_X_tbox(extent);
+  ensure_has_T_tbox(extent);
+  PG_RETURN_INT64(tbox_zorder_internal(box, extent));
+}
+
 /*****************************************************************************/
 
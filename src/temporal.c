@@ -20,28 +20,37 @@
 #include <access/heapam.h>
 #include <access/htup_details.h>
 #if MOBDB_PGSQL_VERSION < 130000
+#include <access/hash.h>
 #include <access/tuptoaster.h>
 #else
 #include <access/heaptoast.h>
 #include <access/detoast.h>
+#include <common/hashfn.h>
 #endif
 #include <catalog/namespace.h>
+#include <funcapi.h>
 #include <libpq/pqformat.h>
 #include <utils/builtins.h>
 #include <utils/fmgroids.h>
+#include <utils/hsearch.h>
 #include <utils/lsyscache.h>
 #include <utils/rel.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
+#include "periodset.h"
 #include "timeops.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
 #include "temporal_boxops.h"
 #include "temporal_parser.h"
+#include "temporal_packed.h"
+#include "temporal_expanded.h"
+#include "temporal_wire.h"
 #include "rangetypes_ext.h"
 #include "temporal.h"
+#include "tpoint_boxops.h"
 #include "tpoint_spatialfuncs.h"
 
 /*****************************************************************************
@@ -137,8 +146,40 @@ tduration_from_string(const char *str, TDuration *duration)
   return false;
 }
 
+/**
+ * Returns the string representation of the storage of the values of a
+ * column, which is empty for the expanded storage
+ */
+const char *
+tstorage_name(TStorage storage)
+{
+  if (storage == STORAGE_PACKED)
+    return TSTORAGE_PACKED_NAME;
+  if (storage == STORAGE_COMPRESSED)
+    return TSTORAGE_COMPRESSED_NAME;
+  return "";
+}
+
+/**
+ * Returns the enum value corresponding to the string representation
+ * of the storage of the values of a column
+ */
+bool
+tstorage_from_string(const char *str, TStorage *storage)
+{
+  *storage = STORAGE_EXPANDED;
+  if (pg_strcasecmp(str, TSTORAGE_PACKED_NAME) == 0)
+    *storage = STORAGE_PACKED;
+  else if (pg_strcasecmp(str, TSTORAGE_COMPRESSED_NAME) == 0)
+    *storage = STORAGE_COMPRESSED;
+  else
+    return false;
+  return true;
+}
+
 /**
  * Ensures that the duration of the temporal value corresponds to the typmod
+ * and returns the value in packed or compressed form if the typmod states it
  */
 static Temporal *
 temporal_valid_typmod(Temporal *temp, int32_t typmod)
@@ -152,6 +193,8 @@ temporal_valid_typmod(Temporal *temp, int32_t typmod)
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
       errmsg("Temporal type (%s) does not match column type (%s)",
       tduration_name(temp->duration), tduration_name(typmod_duration))));
+  if (TYPMOD_GET_STORAGE(typmod) != STORAGE_EXPANDED)
+    temp = temporal_pack(temp, TYPMOD_GET_STORAGE(typmod));
   return temp;
 }
 
@@ -444,6 +487,14 @@ base_oid_from_temporal(Oid temptypid)
  * Trajectory functions
  *****************************************************************************/
 
+/**
+ * Global variable that states whether the trajectory of temporal point
+ * sequences is precomputed when they are constructed. It is set by the
+ * configuration parameter mobilitydb.precompute_trajectory. When it is
+ * false, the trajectory is built on demand by the functions that need it.
+ */
+bool precompute_trajectory = true;
+
 /**
  * Returns true if the temporal type corresponding to the Oid of the
  * base type has its trajectory precomputed
@@ -452,7 +503,7 @@ bool
 type_has_precomputed_trajectory(Oid valuetypid)
 {
   if (tgeo_base_type(valuetypid))
-    return true;
+    return precompute_trajectory;
   return false;
 }
 
@@ -969,7 +1020,8 @@ temporal_write(Temporal *temp, StringInfo buf)
 
 PG_FUNCTION_INFO_V1(temporal_send);
 /*
- * Generic send function for temporal types
+ * Generic send function for temporal types, which uses the compact binary
+ * format of temporal_wire.c
  */
 PGDLLEXPORT Datum
 temporal_send(PG_FUNCTION_ARGS)
@@ -977,7 +1029,7 @@ temporal_send(PG_FUNCTION_ARGS)
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   StringInfoData buf;
   pq_begintypsend(&buf);
-  temporal_write(temp, &buf) ;
+  temporal_wire_write(temp, &buf) ;
   PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
@@ -1008,7 +1060,8 @@ temporal_read(StringInfo buf, Oid valuetypid)
 
 PG_FUNCTION_INFO_V1(temporal_recv);
 /**
- * Generic receive function for temporal types
+ * Generic receive function for temporal types, which accepts both the
+ * compact binary format and the format of temporal_write
  */
 PGDLLEXPORT Datum
 temporal_recv(PG_FUNCTION_ARGS)
@@ -1016,7 +1069,8 @@ temporal_recv(PG_FUNCTION_ARGS)
   StringInfo buf = (StringInfo)PG_GETARG_POINTER(0);
   Oid temptypid = PG_GETARG_OID(1);
   Oid valuetypid = temporal_valuetypid(temptypid);
-  Temporal *result = temporal_read(buf, valuetypid) ;
+  Temporal *result = temporal_wire_is_compact(buf) ?
+    temporal_wire_read(buf, valuetypid) : temporal_read(buf, valuetypid) ;
   PG_RETURN_POINTER(result);
 }
 
@@ -1042,19 +1096,33 @@ temporal_typmod_in(PG_FUNCTION_ARGS)
         errmsg("typmod array must not contain nulls")));
 
   deconstruct_array(array, CSTRINGOID, -2, false, 'c', &elem_values, NULL, &n);
-  if (n != 1)
+  if (n != 1 && n != 2)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("Invalid temporal type modifier")));
+
+  /* Storage */
+  TStorage storage;
+  char *s = DatumGetCString(elem_values[n - 1]);
+  if (tstorage_from_string(s, &storage))
+    n--;
+  else if (n == 2)
     ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
         errmsg("Invalid temporal type modifier")));
 
   /* Temporal Type */
-  char *s = DatumGetCString(elem_values[0]);
   TDuration duration = ANYDURATION;
-  if (!tduration_from_string(s, &duration))
-    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-        errmsg("Invalid temporal type modifier: %s", s)));
+  if (n == 1)
+  {
+    s = DatumGetCString(elem_values[0]);
+    if (!tduration_from_string(s, &duration))
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+          errmsg("Invalid temporal type modifier: %s", s)));
+  }
 
   pfree(elem_values);
-  PG_RETURN_INT32((int32)duration);
+  int32 typmod = (int32) duration;
+  TYPMOD_SET_STORAGE(typmod, storage);
+  PG_RETURN_INT32(typmod);
 }
 
 PG_FUNCTION_INFO_V1(temporal_typmod_out);
@@ -1068,13 +1136,19 @@ temporal_typmod_out(PG_FUNCTION_ARGS)
   char *str = s;
   int32 typmod = PG_GETARG_INT32(0);
   TDuration duration = TYPMOD_GET_DURATION(typmod);
+  TStorage storage = TYPMOD_GET_STORAGE(typmod);
   /* No type? Then no typmod at all. Return empty string.  */
-  if (typmod < 0 || !duration)
+  if (typmod < 0 || (!duration && storage == STORAGE_EXPANDED))
   {
     *str = '\0';
     PG_RETURN_CSTRING(str);
   }
-  sprintf(str, "(%s)", tduration_name(duration));
+  if (duration && storage != STORAGE_EXPANDED)
+    sprintf(str, "(%s,%s)", tduration_name(duration), tstorage_name(storage));
+  else if (duration)
+    sprintf(str, "(%s)", tduration_name(duration));
+  else
+    sprintf(str, "(%s)", tstorage_name(storage));
   PG_RETURN_CSTRING(s);
 }
 
@@ -1172,6 +1246,72 @@ tlinearseq_constructor(PG_FUNCTION_ARGS)
   return tsequence_constructor(fcinfo, true);
 }
 
+/**
+ * Construct a temporal sequence value from the arrays of timestamps and
+ * base values (dispatch function)
+ */
+static Datum
+tsequence_arrays_constructor(FunctionCallInfo fcinfo, bool linear)
+{
+  ArrayType *timearr = PG_GETARG_ARRAYTYPE_P(0);
+  ArrayType *valuearr = PG_GETARG_ARRAYTYPE_P(1);
+  bool lower_inc = PG_GETARG_BOOL(2);
+  bool upper_inc = PG_GETARG_BOOL(3);
+  if (PG_NARGS() > 4)
+    linear = PG_GETARG_BOOL(4);
+  ensure_non_empty_array(timearr);
+  int count, count1;
+  TimestampTz *times = timestamparr_extract(timearr, &count);
+  Datum *values = datumarr_extract(valuearr, &count1);
+  if (count != count1)
+  {
+    pfree(times); pfree(values);
+    PG_FREE_IF_COPY(timearr, 0);
+    PG_FREE_IF_COPY(valuearr, 1);
+    ereport(ERROR, (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+      errmsg("The input arrays must have the same number of elements")));
+  }
+  Oid valuetypid = ARR_ELEMTYPE(valuearr);
+  if (tgeo_base_type(valuetypid))
+  {
+    for (int i = 0; i < count; i++)
+    {
+      GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(values[i]);
+      ensure_point_type(gs);
+      ensure_non_empty(gs);
+      ensure_has_not_M_gs(gs);
+    }
+  }
+  Temporal *result = (Temporal *) tsequence_from_arrays(times, values, count,
+    valuetypid, lower_inc, upper_inc, linear, NORMALIZE);
+  pfree(times); pfree(values);
+  PG_FREE_IF_COPY(timearr, 0);
+  PG_FREE_IF_COPY(valuearr, 1);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tstepseq_arrays_constructor);
+/**
+ * Construct a temporal sequence value with stepwise interpolation from
+ * the arrays of timestamps and base values
+ */
+PGDLLEXPORT Datum
+tstepseq_arrays_constructor(PG_FUNCTION_ARGS)
+{
+  return tsequence_arrays_constructor(fcinfo, false);
+}
+
+PG_FUNCTION_INFO_V1(tlinearseq_arrays_constructor);
+/**
+ * Construct a temporal sequence value with linear or stepwise
+ * interpolation from the arrays of timestamps and base values
+ */
+PGDLLEXPORT Datum
+tlinearseq_arrays_constructor(PG_FUNCTION_ARGS)
+{
+  return tsequence_arrays_constructor(fcinfo, true);
+}
+
 PG_FUNCTION_INFO_V1(tsequenceset_constructor);
 /**
  * Construct a temporal sequence set value from the array of temporal
@@ -1211,45 +1351,152 @@ tsequenceset_constructor(PG_FUNCTION_ARGS)
  * Tranformation functions
  ****************************************************************************/
 
-PG_FUNCTION_INFO_V1(temporal_append_tinstant);
 /**
- * Append an instant to the end of a temporal value
+ * Ensures that the temporal value can be appended to the other one
  */
-PGDLLEXPORT Datum
-temporal_append_tinstant(PG_FUNCTION_ARGS)
+static void
+ensure_appendable_tinstant(const Temporal *temp, const Temporal *inst)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
-  Temporal *inst = PG_GETARG_TEMPORAL(1);
-  /* Validity tests */
   if (inst->duration != INSTANT)
     ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
       errmsg("The second argument must be of instant duration")));
-  ensure_same_base_type(temp, (Temporal *)inst);
+  ensure_same_base_type(temp, inst);
   /* The test to ensure the increasing timestamps must be done in the
    * specific function since the inclusive/exclusive bounds must be
    * taken into account for temporal sequences and sequence sets */
   ensure_spatial_validity(temp, inst);
+  return;
+}
 
+/**
+ * Append an instant to the end of a temporal value (dispatch function)
+ */
+Temporal *
+temporal_append_tinstant_internal(const Temporal *temp, const TInstant *inst)
+{
   Temporal *result;
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT)
-    result = (Temporal *)tinstant_append_tinstant((TInstant *)temp,
-      (TInstant *)inst);
+    result = (Temporal *)tinstant_append_tinstant((TInstant *)temp, inst);
   else if (temp->duration == INSTANTSET)
     result = (Temporal *)tinstantset_append_tinstant((TInstantSet *)temp,
-      (TInstant *)inst);
+      inst);
   else if (temp->duration == SEQUENCE)
-    result = (Temporal *)tsequence_append_tinstant((TSequence *)temp,
-      (TInstant *)inst);
+    result = (Temporal *)tsequence_append_tinstant((TSequence *)temp, inst);
   else /* temp->duration == SEQUENCESET */
     result = (Temporal *)tsequenceset_append_tinstant((TSequenceSet *)temp,
-      (TInstant *)inst);
+      inst);
+  return result;
+}
+
+/**
+ * Append an array of instants to the end of a temporal value by appending
+ * the instants one by one
+ *
+ * @param[in] temp Temporal value
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ */
+Temporal *
+temporal_append_tinstants1(const Temporal *temp, TInstant **instants,
+  int count)
+{
+  Temporal *result = (Temporal *) temp;
+  for (int i = 0; i < count; i++)
+  {
+    Temporal *next = temporal_append_tinstant_internal(result, instants[i]);
+    if (result != temp)
+      pfree(result);
+    result = next;
+  }
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_append_tinstant);
+/**
+ * Append an instant to the end of a temporal value
+ *
+ * @note When the function is the transition function of an aggregate, the
+ * state is kept as an expanded value to which the instants are appended
+ * in place
+ */
+PGDLLEXPORT Datum
+temporal_append_tinstant(PG_FUNCTION_ARGS)
+{
+  Temporal *inst = PG_GETARG_TEMPORAL(1);
+  ExpandedTemporal *eot = DatumGetExpandedTemporalRW(PG_GETARG_DATUM(0));
+  if (eot != NULL)
+  {
+    ensure_appendable_tinstant((Temporal *) eot->instants[0], inst);
+    if (expanded_temporal_append(eot, (TInstant *) inst))
+    {
+      PG_FREE_IF_COPY(inst, 1);
+      PG_RETURN_DATUM(PG_GETARG_DATUM(0));
+    }
+  }
 
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  ensure_appendable_tinstant(temp, inst);
+  Temporal *result = temporal_append_tinstant_internal(temp,
+    (TInstant *)inst);
+  MemoryContext aggcontext;
+  if (AggCheckCallContext(fcinfo, &aggcontext) &&
+    temporal_expandable(result))
+  {
+    Datum expanded = expand_temporal(result, aggcontext);
+    if (result != temp && result != inst)
+      pfree(result);
+    PG_FREE_IF_COPY(temp, 0);
+    PG_FREE_IF_COPY(inst, 1);
+    PG_RETURN_DATUM(expanded);
+  }
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(inst, 1);
   PG_RETURN_POINTER(result);
 }
 
+PG_FUNCTION_INFO_V1(temporal_append_tinstants);
+/**
+ * Append an array of instants to the end of a temporal value
+ *
+ * @note Temporal instant sets and sequences are built only once from all
+ * the instants instead of once for every appended instant
+ */
+PGDLLEXPORT Datum
+temporal_append_tinstants(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+  int count = ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array));
+  if (count == 0)
+  {
+    Temporal *result = temporal_copy(temp);
+    PG_FREE_IF_COPY(temp, 0);
+    PG_FREE_IF_COPY(array, 1);
+    PG_RETURN_POINTER(result);
+  }
+  Temporal **instants = temporalarr_extract(array, &count);
+  for (int i = 0; i < count; i++)
+    ensure_appendable_tinstant(temp, instants[i]);
+
+  Temporal *result;
+  if (temp->duration == INSTANTSET)
+    result = tinstantset_append_tinstants((TInstantSet *)temp,
+      (TInstant **)instants, count);
+  else if (temp->duration == SEQUENCE)
+    result = tsequence_append_tinstants((TSequence *)temp,
+      (TInstant **)instants, count);
+  else
+    result = temporal_append_tinstants1(temp, (TInstant **)instants, count);
+  if (result == temp)
+    result = temporal_copy(temp);
+
+  pfree(instants);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_FREE_IF_COPY(array, 1);
+  PG_RETURN_POINTER(result);
+}
+
 /**
  * Convert two temporal values into a common duration
  *
@@ -1590,10 +1837,8 @@ PG_FUNCTION_INFO_V1(temporal_to_period);
 PGDLLEXPORT Datum
 temporal_to_period(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   Period *result = (Period *) palloc(sizeof(Period));
-  temporal_period(result, temp);
-  PG_FREE_IF_COPY(temp, 0);
+  temporal_period_slice(result, PG_GETARG_DATUM(0));
   PG_RETURN_PERIOD(result);
 }
 
@@ -1962,6 +2207,258 @@ temporal_bbox(void *box, const Temporal *temp)
   return;
 }
 
+/**
+ * Structure large enough to hold the fixed-size header of a temporal value
+ * of any duration
+ */
+typedef union
+{
+  Temporal temp;
+  TInstant inst;
+  TInstantSet ti;
+  TSequence seq;
+  TSequenceSet ts;
+  TemporalPacked packed;
+} TemporalHeader;
+
+/**
+ * Returns true if the temporal value is compressed or stored out of line,
+ * in which case reading its bounding box only requires to detoast a slice
+ * of it
+ */
+static bool
+temporal_toasted(Datum tempdatum)
+{
+  struct varlena *attr = (struct varlena *) DatumGetPointer(tempdatum);
+  return VARATT_IS_EXTERNAL(attr) || VARATT_IS_COMPRESSED(attr);
+}
+
+/**
+ * Copy in the first argument the bytes of the temporal value in the given
+ * range, detoasting only the slice of the value containing them
+ *
+ * @param[out] result Buffer of at least size bytes
+ * @param[in] tempdatum Temporal value
+ * @param[in] offset Offset of the range from the beginning of the value,
+ * including the varlena header
+ * @param[in] size Size of the range
+ */
+static void
+temporal_slice_copy(void *result, Datum tempdatum, size_t offset, size_t size)
+{
+  struct varlena *slice = PG_DETOAST_DATUM_SLICE(tempdatum,
+    (int32) (offset - VARHDRSZ), (int32) size);
+  COUNTER_INC(detoast_slices);
+  size_t slicesize = VARSIZE(slice) - VARHDRSZ;
+  memset(result, 0, size);
+  memcpy(result, VARDATA(slice), Min(size, slicesize));
+  pfree(slice);
+  return;
+}
+
+/**
+ * Returns the offset of the precomputed bounding box of the temporal value
+ * from the beginning of the value
+ *
+ * The bounding box of the values having the BBOXFIRST flag is stored at
+ * the beginning of the variable-length part, thus its offset only depends
+ * on the fixed-size header. In the values stored by previous versions the
+ * bounding box follows the composing values, in which case its offset is
+ * read from a slice of the offsets array.
+ *
+ * @return Returns 0 for temporal instant values since they do not have
+ * precomputed bounding box.
+ */
+static size_t
+temporal_bbox_offset(const TemporalHeader *hdr, Datum tempdatum)
+{
+  if (MOBDB_FLAGS_GET_PACKED(hdr->temp.flags))
+    return double_pad(sizeof(TemporalPacked));
+  size_t offsets, data;
+  int count;
+  if (hdr->temp.duration == INSTANTSET)
+  {
+    offsets = offsetof(TInstantSet, offsets);
+    count = hdr->ti.count;
+    data = offsets + (count + 1) * sizeof(size_t);
+  }
+  else if (hdr->temp.duration == SEQUENCE)
+  {
+    offsets = offsetof(TSequence, offsets);
+    count = hdr->seq.count;
+    data = offsets + (count + 2) * sizeof(size_t);
+  }
+  else if (hdr->temp.duration == SEQUENCESET)
+  {
+    offsets = offsetof(TSequenceSet, offsets);
+    count = hdr->ts.count;
+    data = offsets + (count + 1) * sizeof(size_t);
+  }
+  else
+    return 0;
+  if (MOBDB_FLAGS_GET_BBOXFIRST(hdr->temp.flags))
+    return data;
+  size_t offset;
+  temporal_slice_copy(&offset, tempdatum, offsets + count * sizeof(size_t),
+    sizeof(size_t));
+  return data + offset;
+}
+
+/**
+ * Set the first argument to the bounding box of the temporal value given
+ * as a datum
+ *
+ * Contrary to the function temporal_bbox, the value is not fully
+ * detoasted: only its header and its bounding box are fetched. This makes
+ * the cost of bounding box operators independent of the size of the value.
+ */
+void
+temporal_bbox_slice(void *box, Datum tempdatum)
+{
+  if (temporal_toasted(tempdatum))
+  {
+    TemporalHeader hdr;
+    temporal_slice_copy((char *) &hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+      sizeof(TemporalHeader) - VARHDRSZ);
+    size_t offset = temporal_bbox_offset(&hdr, tempdatum);
+    if (offset != 0)
+    {
+      temporal_slice_copy(box, tempdatum, offset,
+        temporal_bbox_size(hdr.temp.valuetypid));
+      return;
+    }
+  }
+  Temporal *temp = (Temporal *) temporal_detoast(tempdatum);
+  if (MOBDB_FLAGS_GET_PACKED(temp->flags))
+    memcpy(box, temporalpacked_bbox_ptr((TemporalPacked *) temp),
+      temporal_bbox_size(temp->valuetypid));
+  else
+    temporal_bbox(box, temp);
+  if ((Pointer) temp != DatumGetPointer(tempdatum))
+    pfree(temp);
+  return;
+}
+
+/**
+ * Set the first argument to the period on which the temporal value given
+ * as a datum is defined, without detoasting the whole value
+ */
+void
+temporal_period_slice(Period *p, Datum tempdatum)
+{
+  if (temporal_toasted(tempdatum))
+  {
+    TemporalHeader hdr;
+    temporal_slice_copy((char *) &hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+      sizeof(TemporalHeader) - VARHDRSZ);
+    if (! MOBDB_FLAGS_GET_PACKED(hdr.temp.flags))
+    {
+      /* The period of instants and sequences is kept in the header */
+      if (hdr.temp.duration == INSTANT)
+      {
+        tinstant_period(p, &hdr.inst);
+        return;
+      }
+      if (hdr.temp.duration == SEQUENCE)
+      {
+        tsequence_period(p, &hdr.seq);
+        return;
+      }
+      /* The bounding box of instant sets has inclusive bounds */
+      if (hdr.temp.duration == INSTANTSET)
+      {
+        bboxunion box;
+        temporal_slice_copy(&box, tempdatum,
+          temporal_bbox_offset(&hdr, tempdatum),
+          temporal_bbox_size(hdr.temp.valuetypid));
+        if (talpha_base_type(hdr.temp.valuetypid))
+          period_set(p, box.p.lower, box.p.upper, true, true);
+        else if (tnumber_base_type(hdr.temp.valuetypid))
+          period_set(p, box.b.tmin, box.b.tmax, true, true);
+        else /* tgeo_base_type(hdr.temp.valuetypid) */
+          period_set(p, box.g.tmin, box.g.tmax, true, true);
+        return;
+      }
+      /* The bounds of sequence sets are those of the first and last
+       * sequences, whose headers are fetched using the offsets */
+      if (hdr.temp.duration == SEQUENCESET)
+      {
+        TSequence first, last;
+        size_t offsets[2];
+        size_t data = offsetof(TSequenceSet, offsets) +
+          (hdr.ts.count + 1) * sizeof(size_t);
+        temporal_slice_copy(&offsets[0], tempdatum,
+          offsetof(TSequenceSet, offsets), sizeof(size_t));
+        temporal_slice_copy(&offsets[1], tempdatum,
+          offsetof(TSequenceSet, offsets) + (hdr.ts.count - 1) * sizeof(size_t),
+          sizeof(size_t));
+        temporal_slice_copy(&first, tempdatum, data + offsets[0],
+          offsetof(TSequence, offsets));
+        temporal_slice_copy(&last, tempdatum, data + offsets[1],
+          offsetof(TSequence, offsets));
+        period_set(p, first.period.lower, last.period.upper,
+          first.period.lower_inc, last.period.upper_inc);
+        return;
+      }
+    }
+  }
+  /* The bounds of packed values require the full value */
+  Temporal *temp = DatumGetTemporal(tempdatum);
+  temporal_period(p, temp);
+  if ((Pointer) temp != DatumGetPointer(tempdatum))
+    pfree(temp);
+  return;
+}
+
+/**
+ * Set the arguments to the number of instants and of sequences of the
+ * temporal value given as a datum, reading only its header
+ */
+void
+temporal_counts_slice(int *ninsts, int *nseqs, Datum tempdatum)
+{
+  TemporalHeader hdr;
+  if (temporal_toasted(tempdatum))
+    temporal_slice_copy((char *) &hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+      sizeof(TemporalHeader) - VARHDRSZ);
+  else
+  {
+    /* Values with a short header are copied with a 4-byte header */
+    Temporal *temp = (Temporal *) temporal_detoast(tempdatum);
+    memset(&hdr, 0, sizeof(TemporalHeader));
+    memcpy(&hdr, temp, Min(VARSIZE(temp), sizeof(TemporalHeader)));
+    if ((Pointer) temp != DatumGetPointer(tempdatum))
+      pfree(temp);
+  }
+  if (MOBDB_FLAGS_GET_PACKED(hdr.temp.flags))
+  {
+    *ninsts = hdr.packed.totalcount;
+    *nseqs = (hdr.temp.duration == SEQUENCESET) ? hdr.packed.count :
+      ((hdr.temp.duration == SEQUENCE) ? 1 : 0);
+  }
+  else if (hdr.temp.duration == INSTANT)
+  {
+    *ninsts = 1;
+    *nseqs = 0;
+  }
+  else if (hdr.temp.duration == INSTANTSET)
+  {
+    *ninsts = hdr.ti.count;
+    *nseqs = 0;
+  }
+  else if (hdr.temp.duration == SEQUENCE)
+  {
+    *ninsts = hdr.seq.count;
+    *nseqs = 1;
+  }
+  else /* hdr.temp.duration == SEQUENCESET */
+  {
+    *ninsts = hdr.ts.totalcount;
+    *nseqs = hdr.ts.count;
+  }
+  return;
+}
+
 PG_FUNCTION_INFO_V1(tnumber_to_tbox);
 /**
  * Returns the bounding box of the temporal value
@@ -1969,13 +2466,27 @@ PG_FUNCTION_INFO_V1(tnumber_to_tbox);
 PGDLLEXPORT Datum
 tnumber_to_tbox(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   TBOX *result = palloc0(sizeof(TBOX));
-  temporal_bbox(result, temp);
-  PG_FREE_IF_COPY(temp, 0);
+  temporal_bbox_slice(result, PG_GETARG_DATUM(0));
   PG_RETURN_POINTER(result);
 }
 
+PG_FUNCTION_INFO_V1(tnumber_zorder);
+/**
+ * Returns the Z-order key of the bounding box of the temporal number with
+ * respect to the extent
+ */
+PGDLLEXPORT Datum
+tnumber_zorder(PG_FUNCTION_ARGS)
+{
+  TBOX box, *extent = PG_GETARG_TBOX_P(1);
+  memset(&box, 0, sizeof(TBOX));
+  temporal_bbox_slice(&box, PG_GETARG_DATUM(0));
+  ensure_has_X_tbox(extent);
+  ensure_has_T_tbox(extent);
+  PG_RETURN_INT64(tbox_zorder_internal(&box, extent));
+}
+
 /**
  * Returns the value range of the temporal integer value
  * (internal function)
@@ -2294,14 +2805,13 @@ temporal_sequences(PG_FUNCTION_ARGS)
   PG_RETURN_ARRAYTYPE_P(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_num_instants);
 /**
  * Returns the number of distinct instants of the temporal value
+ * (internal function)
  */
-PGDLLEXPORT Datum
-temporal_num_instants(PG_FUNCTION_ARGS)
+int
+temporal_num_instants_internal(const Temporal *temp)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   int result;
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT)
@@ -2312,6 +2822,18 @@ temporal_num_instants(PG_FUNCTION_ARGS)
     result = ((TSequence *)temp)->count;
   else /* temp->duration == SEQUENCESET */
     result = tsequenceset_num_instants((TSequenceSet *)temp);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_num_instants);
+/**
+ * Returns the number of distinct instants of the temporal value
+ */
+PGDLLEXPORT Datum
+temporal_num_instants(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  int result = temporal_num_instants_internal(temp);
   PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_INT32(result);
 }
@@ -2422,20 +2944,117 @@ temporal_instant_n(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_instants);
+/*****************************************************************************
+ * Iterator over the instants
+ *****************************************************************************/
+
 /**
- * Returns the distinct instants of the temporal value as an array
+ * Initialize the iterator over the distinct instants of the temporal value
+ *
+ * @note The iterator keeps pointers into the temporal value, which must
+ * therefore remain valid while the iterator is used
  */
-PGDLLEXPORT Datum
-temporal_instants(PG_FUNCTION_ARGS)
+void
+tinstant_iterator_init(TInstantIterator *iter, const Temporal *temp)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
-  ArrayType *result;
   ensure_valid_duration(temp->duration);
-  if (temp->duration == INSTANT)
-    result = tinstant_instants_array((TInstant *)temp);
-  else if (temp->duration == INSTANTSET)
-    result = tinstantset_instants_array((TInstantSet *)temp);
+  iter->temp = temp;
+  iter->seqno = 0;
+  iter->instno = 0;
+  iter->last = NULL;
+}
+
+/**
+ * Returns the next distinct instant of the temporal value, or NULL when all
+ * the instants have been visited
+ *
+ * The instants are returned in time order and are not copied. For sequence
+ * sets, the start instant of a sequence equal to the end instant of the
+ * previous one is only returned once.
+ */
+const TInstant *
+tinstant_iterator_next(TInstantIterator *iter)
+{
+  const Temporal *temp = iter->temp;
+  const TInstant *result = NULL;
+  if (temp->duration == INSTANT)
+  {
+    if (iter->instno == 0)
+      result = (const TInstant *) temp;
+    iter->instno++;
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    if (iter->instno < ti->count)
+      result = tinstantset_inst_n(ti, iter->instno++);
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    if (iter->instno < seq->count)
+      result = tsequence_inst_n(seq, iter->instno++);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    while (result == NULL && iter->seqno < ts->count)
+    {
+      const TSequence *seq = tsequenceset_seq_n(ts, iter->seqno);
+      if (iter->instno >= seq->count)
+      {
+        iter->seqno++;
+        iter->instno = 0;
+        continue;
+      }
+      const TInstant *inst = tsequence_inst_n(seq, iter->instno++);
+      if (iter->instno == 1 && iter->last != NULL &&
+          tinstant_eq(iter->last, inst))
+        continue;
+      result = inst;
+    }
+  }
+  if (result != NULL)
+    iter->last = result;
+  return result;
+}
+
+/**
+ * Set the next distinct timestamp of the temporal value
+ *
+ * @result False when all the timestamps have been visited
+ */
+bool
+tinstant_iterator_next_timestamp(TInstantIterator *iter, TimestampTz *t)
+{
+  TimestampTz lasttime = (iter->last != NULL) ? iter->last->t : 0;
+  bool first = (iter->last == NULL);
+  const TInstant *inst;
+  while ((inst = tinstant_iterator_next(iter)) != NULL)
+  {
+    if (first || inst->t != lasttime)
+    {
+      *t = inst->t;
+      return true;
+    }
+  }
+  return false;
+}
+
+PG_FUNCTION_INFO_V1(temporal_instants);
+/**
+ * Returns the distinct instants of the temporal value as an array
+ */
+PGDLLEXPORT Datum
+temporal_instants(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  ArrayType *result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result = tinstant_instants_array((TInstant *)temp);
+  else if (temp->duration == INSTANTSET)
+    result = tinstantset_instants_array((TInstantSet *)temp);
   else if (temp->duration == SEQUENCE)
     result = tsequence_instants_array((TSequence *)temp);
   else /* temp->duration == SEQUENCESET */
@@ -2444,6 +3063,44 @@ temporal_instants(PG_FUNCTION_ARGS)
   PG_RETURN_ARRAYTYPE_P(result);
 }
 
+/**
+ * Initialize the iterator of a set-returning function over the instants
+ * of the temporal value in the multi-call memory context
+ */
+static TInstantIterator *
+temporal_unnest_init(FunctionCallInfo fcinfo, FuncCallContext *funcctx)
+{
+  MemoryContext oldcontext =
+    MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  TInstantIterator *result = palloc(sizeof(TInstantIterator));
+  tinstant_iterator_init(result, temp);
+  MemoryContextSwitchTo(oldcontext);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_unnest_instants);
+/**
+ * Returns the distinct instants of the temporal value as a set of rows,
+ * one instant per call
+ */
+PGDLLEXPORT Datum
+temporal_unnest_instants(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  if (SRF_IS_FIRSTCALL())
+  {
+    funcctx = SRF_FIRSTCALL_INIT();
+    funcctx->user_fctx = temporal_unnest_init(fcinfo, funcctx);
+  }
+  funcctx = SRF_PERCALL_SETUP();
+  TInstantIterator *iter = (TInstantIterator *) funcctx->user_fctx;
+  const TInstant *inst = tinstant_iterator_next(iter);
+  if (inst == NULL)
+    SRF_RETURN_DONE(funcctx);
+  SRF_RETURN_NEXT(funcctx, PointerGetDatum(tinstant_copy(inst)));
+}
+
 /**
  * Returns the start timestamp of the temporal value
  * (dispatch function)
@@ -2587,6 +3244,279 @@ temporal_timestamps(PG_FUNCTION_ARGS)
   PG_RETURN_ARRAYTYPE_P(result);
 }
 
+PG_FUNCTION_INFO_V1(temporal_unnest_timestamps);
+/**
+ * Returns the distinct timestamps of the temporal value as a set of rows,
+ * one timestamp per call
+ */
+PGDLLEXPORT Datum
+temporal_unnest_timestamps(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  if (SRF_IS_FIRSTCALL())
+  {
+    funcctx = SRF_FIRSTCALL_INIT();
+    funcctx->user_fctx = temporal_unnest_init(fcinfo, funcctx);
+  }
+  funcctx = SRF_PERCALL_SETUP();
+  TInstantIterator *iter = (TInstantIterator *) funcctx->user_fctx;
+  TimestampTz t;
+  if (! tinstant_iterator_next_timestamp(iter, &t))
+    SRF_RETURN_DONE(funcctx);
+  SRF_RETURN_NEXT(funcctx, TimestampTzGetDatum(t));
+}
+
+/*****************************************************************************
+ * Unnest function
+ *****************************************************************************/
+
+/**
+ * Structure to represent the periods during which a temporal value takes
+ * one of its base values
+ */
+typedef struct
+{
+  Datum value;         /**< Base value, not copied */
+  int count;           /**< Number of periods */
+  int size;            /**< Number of periods that fit in the array */
+  Period *periods;     /**< Periods in time order */
+  int next;            /**< Next group with the same key, -1 if none */
+} UnnestGroup;
+
+/**
+ * Structure to represent an entry of the hash table of the unnest state
+ */
+typedef struct
+{
+  Datum key;           /**< Hash key, must be the first field */
+  int group;           /**< First group with this key */
+} UnnestEntry;
+
+/**
+ * Structure to represent the state of the unnest function
+ */
+typedef struct
+{
+  Oid valuetypid;      /**< Oid of the base type */
+  HTAB *groups;        /**< Hash table of the groups keyed by value */
+  int count;           /**< Number of groups */
+  int size;            /**< Number of groups that fit in the array */
+  UnnestGroup *values; /**< Groups in the order of their first occurrence */
+  int i;               /**< Next group to output */
+} UnnestState;
+
+/**
+ * Returns the key of the value in the hash table of the unnest state, which
+ * is the value itself for types passed by value and a hash of its bytes
+ * for text values
+ */
+static Datum
+unnest_state_key(const UnnestState *state, Datum value)
+{
+  if (state->valuetypid != TEXTOID)
+    return value;
+  text *txt = DatumGetTextPP(value);
+  return hash_any((unsigned char *) VARDATA_ANY(txt),
+    VARSIZE_ANY_EXHDR(txt));
+}
+
+/**
+ * Returns the group of the value in the unnest state, creating it if needed
+ */
+static UnnestGroup *
+unnest_state_group(UnnestState *state, Datum value)
+{
+  Datum key = unnest_state_key(state, value);
+  bool found;
+  UnnestEntry *entry = (UnnestEntry *) hash_search(state->groups, &key,
+    HASH_ENTER, &found);
+  int last = -1;
+  if (found)
+  {
+    /* Values of different groups may have the same key */
+    for (int i = entry->group; i >= 0; i = state->values[i].next)
+    {
+      if (datum_eq(state->values[i].value, value, state->valuetypid))
+        return &state->values[i];
+      last = i;
+    }
+  }
+  if (state->count == state->size)
+  {
+    state->size *= 2;
+    state->values = repalloc(state->values,
+      sizeof(UnnestGroup) * state->size);
+  }
+  UnnestGroup *result = &state->values[state->count];
+  result->value = value;
+  result->count = 0;
+  result->size = 8;
+  result->periods = palloc(sizeof(Period) * result->size);
+  result->next = -1;
+  if (last >= 0)
+    state->values[last].next = state->count;
+  else
+    entry->group = state->count;
+  state->count++;
+  return result;
+}
+
+/**
+ * Add the period to the group of the value in the unnest state
+ *
+ * @note The periods of a value arrive in time order, so that a period that
+ * is adjacent to the last one of the group simply extends it
+ */
+static void
+unnest_state_add(UnnestState *state, Datum value, TimestampTz lower,
+  TimestampTz upper, bool lower_inc, bool upper_inc)
+{
+  UnnestGroup *group = unnest_state_group(state, value);
+  if (group->count > 0)
+  {
+    Period *p = &group->periods[group->count - 1];
+    if (p->upper == lower && (p->upper_inc || lower_inc))
+    {
+      p->upper = upper;
+      p->upper_inc = upper_inc;
+      return;
+    }
+  }
+  if (group->count == group->size)
+  {
+    group->size *= 2;
+    group->periods = repalloc(group->periods, sizeof(Period) * group->size);
+  }
+  period_set(&group->periods[group->count++], lower, upper, lower_inc,
+    upper_inc);
+  return;
+}
+
+/**
+ * Add the constant segments of the sequence with stepwise interpolation
+ * to the unnest state
+ */
+static void
+unnest_state_add_seq(UnnestState *state, const TSequence *seq)
+{
+  const TInstant *inst1 = tsequence_inst_n(seq, 0);
+  for (int i = 1; i < seq->count; i++)
+  {
+    const TInstant *inst2 = tsequence_inst_n(seq, i);
+    unnest_state_add(state, tinstant_value(inst1), inst1->t, inst2->t,
+      (i == 1) ? seq->period.lower_inc : true, false);
+    inst1 = inst2;
+  }
+  if (seq->period.upper_inc)
+    unnest_state_add(state, tinstant_value(inst1), inst1->t, inst1->t,
+      true, true);
+  return;
+}
+
+/**
+ * Create the state grouping the time of the temporal value by the distinct
+ * base values in a single pass
+ *
+ * @pre The temporal value has stepwise interpolation
+ */
+static UnnestState *
+unnest_state_make(const Temporal *temp)
+{
+  HASHCTL ctl;
+  UnnestState *result = palloc0(sizeof(UnnestState));
+  result->valuetypid = temp->valuetypid;
+  result->size = 64;
+  result->values = palloc(sizeof(UnnestGroup) * result->size);
+  memset(&ctl, 0, sizeof(ctl));
+  ctl.keysize = sizeof(Datum);
+  ctl.entrysize = sizeof(UnnestEntry);
+  ctl.hcxt = CurrentMemoryContext;
+  result->groups = hash_create("Temporal unnest", 64, &ctl,
+    HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+  if (temp->duration == INSTANT)
+  {
+    const TInstant *inst = (const TInstant *) temp;
+    unnest_state_add(result, tinstant_value(inst), inst->t, inst->t,
+      true, true);
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+    {
+      const TInstant *inst = tinstantset_inst_n(ti, i);
+      unnest_state_add(result, tinstant_value(inst), inst->t, inst->t,
+        true, true);
+    }
+  }
+  else if (temp->duration == SEQUENCE)
+    unnest_state_add_seq(result, (const TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      unnest_state_add_seq(result, tsequenceset_seq_n(ts, i));
+  }
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_unnest);
+/**
+ * Returns the distinct base values of the temporal value with stepwise
+ * interpolation together with the period set during which the temporal
+ * value takes each of them, in the order of their first occurrence
+ */
+PGDLLEXPORT Datum
+temporal_unnest(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  UnnestState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    ensure_valid_duration(temp->duration);
+    if ((temp->duration == SEQUENCE || temp->duration == SEQUENCESET) &&
+        MOBDB_FLAGS_GET_LINEAR(temp->flags))
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The temporal value must have stepwise interpolation")));
+    funcctx->user_fctx = unnest_state_make(temp);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (UnnestState *) funcctx->user_fctx;
+  if (state->i >= state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  UnnestGroup *group = &state->values[state->i++];
+  Period **periods = palloc(sizeof(Period *) * group->count);
+  for (int i = 0; i < group->count; i++)
+    periods[i] = &group->periods[i];
+  PeriodSet *ps = periodset_make(periods, group->count, NORMALIZE_NO);
+  pfree(periods);
+
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = group->value;
+  values[1] = PointerGetDatum(ps);
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
 /**
  * Shift and/or scale the time span of the temporal value by the two intervals
  * (internal function)
@@ -3623,6 +4553,350 @@ temporal_minus_max(PG_FUNCTION_ARGS)
   return temporal_restrict_minmax(fcinfo, MAX, REST_MINUS);
 }
 
+/*****************************************************************************
+ * Restriction of uncompressed toasted sequences by slices
+ *****************************************************************************/
+
+/**
+ * Returns true if the temporal value is stored out of line without
+ * compression, in which case any slice of it is fetched by reading only
+ * the TOAST chunks that contain it
+ *
+ * @note The slices of a compressed value are obtained by decompressing
+ * the value up to the end of the slice, so that fetching several slices
+ * of a compressed value is more expensive than detoasting it once.
+ */
+static bool
+temporal_sliceable(Datum tempdatum)
+{
+  struct varlena *attr = (struct varlena *) DatumGetPointer(tempdatum);
+  if (! VARATT_IS_EXTERNAL_ONDISK(attr))
+    return false;
+  struct varatt_external toast_pointer;
+  VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+  return ! VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer);
+}
+
+/**
+ * Structure to represent a temporal sequence that is read by slices from a
+ * toasted temporal sequence or sequence set
+ *
+ * The offsets array of the sequence is the directory mapping each instant
+ * to its position in the value. The instant containing a timestamp is
+ * located with a binary search that fetches one offset and one instant
+ * header per step.
+ */
+typedef struct
+{
+  Datum tempdatum;    /**< toasted value */
+  size_t base;        /**< offset of the sequence in the value */
+  TSequence hdr;      /**< fixed-size header of the sequence */
+} TSequenceSlice;
+
+/**
+ * Initialize the sequence slice located at the offset of the value
+ */
+static void
+tsequence_slice_init(TSequenceSlice *ss, Datum tempdatum, size_t base)
+{
+  ss->tempdatum = tempdatum;
+  ss->base = base;
+  memset(&ss->hdr, 0, sizeof(TSequence));
+  temporal_slice_copy((char *) &ss->hdr + VARHDRSZ, tempdatum,
+    base + VARHDRSZ, sizeof(TSequence) - VARHDRSZ);
+}
+
+/**
+ * Initialize the sequence slice to the n-th sequence of the toasted
+ * sequence set
+ */
+static void
+tsequenceset_slice_seq_n(TSequenceSlice *ss, Datum tempdatum,
+  const TSequenceSet *hdr, int n)
+{
+  size_t offset;
+  temporal_slice_copy(&offset, tempdatum,
+    offsetof(TSequenceSet, offsets) + n * sizeof(size_t), sizeof(size_t));
+  tsequence_slice_init(ss, tempdatum, offsetof(TSequenceSet, offsets) +
+    (hdr->count + 1) * sizeof(size_t) + offset);
+}
+
+/**
+ * Returns the position of the variable-length data of the sequence slice
+ */
+static size_t
+tsequence_slice_data(const TSequenceSlice *ss)
+{
+  return ss->base + offsetof(TSequence, offsets) +
+    (ss->hdr.count + 2) * sizeof(size_t);
+}
+
+/**
+ * Returns the timestamp of the n-th instant of the sequence slice
+ */
+static TimestampTz
+tsequence_slice_time_n(const TSequenceSlice *ss, int n)
+{
+  size_t offset;
+  temporal_slice_copy(&offset, ss->tempdatum, ss->base +
+    offsetof(TSequence, offsets) + n * sizeof(size_t), sizeof(size_t));
+  TimestampTz result;
+  temporal_slice_copy(&result, ss->tempdatum, tsequence_slice_data(ss) +
+    offset + offsetof(TInstant, t), sizeof(TimestampTz));
+  return result;
+}
+
+/**
+ * Returns the number of the first instant of the sequence slice, starting
+ * from the given one, whose timestamp is after the timestamp, or at it if
+ * the search is not strict. Returns the number of instants if there is no
+ * such instant.
+ */
+static int
+tsequence_slice_search(const TSequenceSlice *ss, int first, TimestampTz t,
+  bool strict)
+{
+  int last = ss->hdr.count;
+  while (first < last)
+  {
+    int middle = (first + last) / 2;
+    TimestampTz t1 = tsequence_slice_time_n(ss, middle);
+    if (t1 < t || (strict && t1 == t))
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  return first;
+}
+
+/**
+ * Returns the smallest subsequence of the sequence slice whose period
+ * contains the intersection of the sequence and the period, NULL if they do
+ * not overlap
+ *
+ * Only the offsets and the instants of the subsequence are fetched. The
+ * subsequence has the values of the sequence on the intersection, so that
+ * the restriction of the sequence to the period is the one of the
+ * subsequence.
+ */
+static TSequence *
+tsequence_slice_cover(const TSequenceSlice *ss, const Period *p)
+{
+  if (! overlaps_period_period_internal(&ss->hdr.period, p))
+    return NULL;
+
+  /* The last instant at or before the lower bound of the period and the
+   * first instant at or after its upper bound */
+  int count = ss->hdr.count;
+  int from = Max(tsequence_slice_search(ss, 0, p->lower, true) - 1, 0);
+  int to = Min(tsequence_slice_search(ss, from, p->upper, false), count - 1);
+  /* A subsequence with a single instant would have inclusive bounds */
+  if (from == to && count > 1)
+  {
+    if (from > 0)
+      from--;
+    else
+      to++;
+  }
+
+  int n = to - from + 1;
+  size_t *offsets = palloc(sizeof(size_t) * n);
+  temporal_slice_copy(offsets, ss->tempdatum, ss->base +
+    offsetof(TSequence, offsets) + from * sizeof(size_t), sizeof(size_t) * n);
+  size_t data = tsequence_slice_data(ss);
+  TInstant last;
+  temporal_slice_copy(&last, ss->tempdatum, data + offsets[n - 1],
+    sizeof(TInstant));
+  size_t size = offsets[n - 1] + VARSIZE(&last) - offsets[0];
+  char *buffer = palloc(size);
+  temporal_slice_copy(buffer, ss->tempdatum, data + offsets[0], size);
+  TInstant **instants = palloc(sizeof(TInstant *) * n);
+  for (int i = 0; i < n; i++)
+    instants[i] = (TInstant *) (buffer + offsets[i] - offsets[0]);
+  TSequence *result = tsequence_make(instants, n,
+    (from == 0) ? ss->hdr.period.lower_inc : true,
+    (to == count - 1) ? ss->hdr.period.upper_inc : true,
+    MOBDB_FLAGS_GET_LINEAR(ss->hdr.flags), NORMALIZE_NO);
+  pfree(offsets); pfree(buffer); pfree(instants);
+  return result;
+}
+
+/**
+ * Returns the number of the first sequence of the toasted sequence set,
+ * starting from the given one, that is not before the period if the
+ * search is on the lower bound, or that is after the period otherwise
+ */
+static int
+tsequenceset_slice_search(Datum tempdatum, const TSequenceSet *hdr,
+  int first, const Period *p, bool lower)
+{
+  int last = hdr->count;
+  while (first < last)
+  {
+    int middle = (first + last) / 2;
+    TSequenceSlice ss;
+    tsequenceset_slice_seq_n(&ss, tempdatum, hdr, middle);
+    bool found = lower ?
+      ! before_period_period_internal(&ss.hdr.period, p) :
+      after_period_period_internal(&ss.hdr.period, p);
+    if (! found)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  return first;
+}
+
+/**
+ * Returns the header of the temporal value given as a datum if it is an
+ * uncompressed toasted sequence or sequence set that can be restricted by
+ * slices
+ */
+static bool
+temporal_slice_header(TemporalHeader *hdr, Datum tempdatum)
+{
+  if (! temporal_sliceable(tempdatum))
+    return false;
+  temporal_slice_copy((char *) hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+    sizeof(TemporalHeader) - VARHDRSZ);
+  return ! MOBDB_FLAGS_GET_PACKED(hdr->temp.flags) &&
+    (hdr->temp.duration == SEQUENCE || hdr->temp.duration == SEQUENCESET);
+}
+
+/**
+ * Restricts the temporal value given as a datum to the period, fetching
+ * only the instants of the value that are needed
+ *
+ * @param[in] tempdatum Temporal value
+ * @param[in] p Period
+ * @param[out] result Restriction of the value to the period, NULL if
+ * it is empty
+ * @result Returns false if the value is not an uncompressed toasted
+ * sequence or sequence set, in which case it must be detoasted
+ */
+static bool
+temporal_at_period_slice(Datum tempdatum, const Period *p, Temporal **result)
+{
+  TemporalHeader hdr;
+  if (! temporal_slice_header(&hdr, tempdatum))
+    return false;
+  COUNTER_INC(detoast_slices);
+  if (hdr.temp.duration == SEQUENCE)
+  {
+    TSequenceSlice ss;
+    tsequence_slice_init(&ss, tempdatum, 0);
+    TSequence *seq = tsequence_slice_cover(&ss, p);
+    *result = NULL;
+    if (seq != NULL)
+    {
+      *result = (Temporal *) tsequence_at_period(seq, p);
+      pfree(seq);
+    }
+    return true;
+  }
+
+  /* hdr.temp.duration == SEQUENCESET */
+  int first = tsequenceset_slice_search(tempdatum, &hdr.ts, 0, p, true);
+  int last = tsequenceset_slice_search(tempdatum, &hdr.ts, first, p, false);
+  TSequence **sequences = palloc(sizeof(TSequence *) * Max(last - first, 1));
+  int k = 0;
+  for (int i = first; i < last; i++)
+  {
+    TSequenceSlice ss;
+    tsequenceset_slice_seq_n(&ss, tempdatum, &hdr.ts, i);
+    TSequence *seq = tsequence_slice_cover(&ss, p);
+    if (seq == NULL)
+      continue;
+    TSequence *seq1 = tsequence_at_period(seq, p);
+    pfree(seq);
+    if (seq1 != NULL)
+      sequences[k++] = seq1;
+  }
+  *result = (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE_NO);
+  return true;
+}
+
+/**
+ * Returns the smallest subsequence of the temporal value given as a datum
+ * containing the timestamp, fetching only its instants
+ *
+ * @param[in] tempdatum Temporal value
+ * @param[in] t Timestamp
+ * @param[out] result Subsequence, NULL if the value is not defined at the
+ * timestamp
+ * @result Returns false if the value is not an uncompressed toasted
+ * sequence or sequence set, in which case it must be detoasted
+ */
+static bool
+temporal_timestamp_slice(Datum tempdatum, TimestampTz t, TSequence **result)
+{
+  TemporalHeader hdr;
+  if (! temporal_slice_header(&hdr, tempdatum))
+    return false;
+  COUNTER_INC(detoast_slices);
+  Period p;
+  period_set(&p, t, t, true, true);
+  TSequenceSlice ss;
+  if (hdr.temp.duration == SEQUENCE)
+    tsequence_slice_init(&ss, tempdatum, 0);
+  else /* hdr.temp.duration == SEQUENCESET */
+  {
+    int n = tsequenceset_slice_search(tempdatum, &hdr.ts, 0, &p, true);
+    if (n == hdr.ts.count)
+    {
+      *result = NULL;
+      return true;
+    }
+    tsequenceset_slice_seq_n(&ss, tempdatum, &hdr.ts, n);
+  }
+  *result = contains_period_timestamp_internal(&ss.hdr.period, t) ?
+    tsequence_slice_cover(&ss, &p) : NULL;
+  return true;
+}
+
+/**
+ * Returns true if the temporal value given as a datum is a packed value
+ * with more than one chunk, whose header is fetched without detoasting the
+ * whole value
+ */
+static bool
+temporal_packed_chunked(Datum tempdatum)
+{
+  TemporalHeader hdr;
+  const Temporal *temp = (Temporal *) DatumGetPointer(tempdatum);
+  if (VARATT_IS_EXTENDED(temp))
+  {
+    temporal_slice_copy((char *) &hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+      sizeof(TemporalHeader) - VARHDRSZ);
+    temp = &hdr.temp;
+  }
+  return MOBDB_FLAGS_GET_PACKED(temp->flags) &&
+    temporalpacked_nchunks((const TemporalPacked *) temp) > 1;
+}
+
+/**
+ * Returns the smallest subvalue of the temporal value given as a datum
+ * whose restriction to the period is the one of the value, decoding only
+ * the chunks of the value that overlap the period
+ *
+ * @param[in] tempdatum Temporal value
+ * @param[in] p Period
+ * @param[out] result Subvalue, NULL if the value does not overlap the period
+ * @result Returns false if the value is not a packed value with more than
+ * one chunk, in which case it must be fully decoded
+ */
+static bool
+temporal_packed_cover(Datum tempdatum, const Period *p, Temporal **result)
+{
+  if (! temporal_packed_chunked(tempdatum))
+    return false;
+  TemporalPacked *temp = (TemporalPacked *) temporal_detoast(tempdatum);
+  *result = temporalpacked_decode_period(temp, p);
+  if ((Pointer) temp != DatumGetPointer(tempdatum))
+    pfree(temp);
+  return true;
+}
+
 /*****************************************************************************/
 
 /**
@@ -3656,8 +4930,33 @@ temporal_restrict_timestamp_internal(const Temporal *temp, TimestampTz t,
 Datum
 temporal_restrict_timestamp(FunctionCallInfo fcinfo, bool atfunc)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+  TSequence *seq;
+  if (atfunc && temporal_timestamp_slice(PG_GETARG_DATUM(0), t, &seq))
+  {
+    TInstant *inst = (seq == NULL) ? NULL : tsequence_at_timestamp(seq, t);
+    if (seq != NULL)
+      pfree(seq);
+    if (inst == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(inst);
+  }
+  Period p;
+  period_set(&p, t, t, true, true);
+  Temporal *temp1;
+  if (atfunc && temporal_packed_cover(PG_GETARG_DATUM(0), &p, &temp1))
+  {
+    Temporal *result = NULL;
+    if (temp1 != NULL)
+    {
+      result = temporal_restrict_timestamp_internal(temp1, t, REST_AT);
+      pfree(temp1);
+    }
+    if (result == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(result);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
   Temporal *result = temporal_restrict_timestamp_internal(temp, t, atfunc);
   PG_FREE_IF_COPY(temp, 0);
   if (result == NULL)
@@ -3707,29 +5006,261 @@ temporal_value_at_timestamp_inc(const Temporal *temp, TimestampTz t, Datum *valu
   return result;
 }
 
+/**
+ * Returns the base value at the timestamp of the temporal sequence point
+ * given as a datum, detoasting only the block of instants containing the
+ * timestamp
+ *
+ * The block is located with a binary search on the block boxes kept at the
+ * end of long sequences. Besides the header, three slices of the value are
+ * fetched: the block boxes, the offsets of the instants of the block, and
+ * the instants of the block.
+ *
+ * @param[in] tempdatum Temporal value
+ * @param[in] hdr Header of the temporal value
+ * @param[in] t Timestamp
+ * @pre The value is toasted, it has block boxes, and the timestamp is
+ * contained in its period
+ */
+static Datum
+tpointseq_value_at_timestamp_slice(Datum tempdatum, const TSequence *hdr,
+  TimestampTz t)
+{
+  int count = hdr->count;
+  int nblocks = tpointseq_block_count(count);
+  size_t size = toast_raw_datum_size(tempdatum);
+  size_t blockspos = size - sizeof(STBOX) * nblocks;
+  STBOX *blocks = palloc(sizeof(STBOX) * nblocks);
+  temporal_slice_copy(blocks, tempdatum, blockspos, sizeof(STBOX) * nblocks);
+  int first = 0, last = nblocks - 1;
+  while (first < last)
+  {
+    int middle = (first + last) / 2;
+    if (blocks[middle].tmax < t)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  pfree(blocks);
+  int start = first * TPOINTSEQ_BLOCK_SIZE;
+  int end = Min(start + TPOINTSEQ_BLOCK_SIZE, count - 1);
+
+  /* The offsets of the instants of the block and of the next element,
+   * which is the trajectory or the block boxes for the last block */
+  int noffsets = (end < count - 1) ? end - start + 2 : count + 2 - start;
+  size_t *offsets = palloc(sizeof(size_t) * noffsets);
+  temporal_slice_copy(offsets, tempdatum,
+    offsetof(TSequence, offsets) + start * sizeof(size_t),
+    sizeof(size_t) * noffsets);
+  size_t data = offsetof(TSequence, offsets) + (count + 2) * sizeof(size_t);
+  size_t upper;
+  if (end < count - 1)
+    upper = offsets[end + 1 - start];
+  else if (MOBDB_FLAGS_GET_TRAJ(hdr->flags))
+    upper = offsets[count + 1 - start];
+  else
+    upper = blockspos - data;
+  char *instants = palloc(upper - offsets[0]);
+  temporal_slice_copy(instants, tempdatum, data + offsets[0],
+    upper - offsets[0]);
+
+  /* Binary search of the segment of the block containing the timestamp */
+#define BLOCK_INST(i) ((TInstant *) (instants + offsets[i] - offsets[0]))
+  first = 0;
+  last = end - start - 1;
+  while (first < last)
+  {
+    int middle = (first + last) / 2;
+    if (BLOCK_INST(middle + 1)->t < t)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  Datum result = tsequence_value_at_timestamp1(BLOCK_INST(first),
+    BLOCK_INST(first + 1), MOBDB_FLAGS_GET_LINEAR(hdr->flags), t);
+#undef BLOCK_INST
+  pfree(offsets);
+  pfree(instants);
+  return result;
+}
+
+/**
+ * Returns the base value of the temporal value given as a datum at the
+ * timestamp
+ *
+ * Contrary to the function temporal_value_at_timestamp_inc, long temporal
+ * sequence points that are compressed or stored out of line are not fully
+ * detoasted: only the block of instants containing the timestamp is
+ * fetched. This makes snapshot queries over long trajectories independent
+ * of their size. Other sequences and sequence sets that are stored out of
+ * line without compression are searched by slices of their instants.
+ */
+bool
+temporal_value_at_timestamp_slice(Datum tempdatum, TimestampTz t,
+  Datum *result)
+{
+  if (temporal_toasted(tempdatum))
+  {
+    TemporalHeader hdr;
+    temporal_slice_copy((char *) &hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+      sizeof(TemporalHeader) - VARHDRSZ);
+    if (! MOBDB_FLAGS_GET_PACKED(hdr.temp.flags) &&
+      hdr.temp.duration == SEQUENCE && MOBDB_FLAGS_GET_BLOCKS(hdr.temp.flags))
+    {
+      if (! contains_period_timestamp_internal(&hdr.seq.period, t))
+        return false;
+      *result = tpointseq_value_at_timestamp_slice(tempdatum, &hdr.seq, t);
+      return true;
+    }
+  }
+  TSequence *seq;
+  if (temporal_timestamp_slice(tempdatum, t, &seq))
+  {
+    if (seq == NULL)
+      return false;
+    bool found = tsequence_value_at_timestamp(seq, t, result);
+    pfree(seq);
+    return found;
+  }
+  Period p;
+  period_set(&p, t, t, true, true);
+  Temporal *temp;
+  if (temporal_packed_cover(tempdatum, &p, &temp))
+  {
+    if (temp == NULL)
+      return false;
+  }
+  else
+    temp = DatumGetTemporal(tempdatum);
+  bool found;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    found = tinstant_value_at_timestamp((TInstant *)temp, t, result);
+  else if (temp->duration == INSTANTSET)
+    found = tinstantset_value_at_timestamp((TInstantSet *)temp, t, result);
+  else if (temp->duration == SEQUENCE)
+    found = tsequence_value_at_timestamp((TSequence *)temp, t, result);
+  else /* temp->duration == SEQUENCESET */
+    found = tsequenceset_value_at_timestamp((TSequenceSet *)temp, t, result);
+  if ((Pointer) temp != DatumGetPointer(tempdatum))
+    pfree(temp);
+  return found;
+}
+
 /*****************************************************************************/
 
+/**
+ * Structure to represent the cache of a call site of the function
+ * valueAtTimestamp, which keeps the detoasted copy of the last temporal value
+ * stored out of line and the position of the last timestamp searched in it
+ */
+typedef struct
+{
+  Oid toastrelid;          /**< Oid of the TOAST table of the value */
+  Oid valueid;             /**< Oid of the value in the TOAST table */
+  int32 extsize;           /**< External size of the value */
+  Temporal *temp;          /**< Copy of the value, NULL if not yet probed twice */
+  TimestampCursor cursor;  /**< Position of the last search in the value */
+} TimestampCache;
+
+/**
+ * Returns the cache of the call site of the function when the temporal value
+ * given as a datum is stored out of line and is the one kept in the cache,
+ * and NULL otherwise
+ *
+ * The value is identified by its TOAST pointer. It is only detoasted and
+ * copied into the cache the second time it is probed, so that the values
+ * probed once are still read by slices.
+ */
+static TimestampCache *
+temporal_timestamp_cache(FunctionCallInfo fcinfo, Datum tempdatum)
+{
+  struct varlena *attr = (struct varlena *) DatumGetPointer(tempdatum);
+  if (! VARATT_IS_EXTERNAL_ONDISK(attr))
+    return NULL;
+  struct varatt_external toast_pointer;
+  VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+
+  TimestampCache *cache = (TimestampCache *) fcinfo->flinfo->fn_extra;
+  if (cache == NULL)
+  {
+    cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+      sizeof(TimestampCache));
+    fcinfo->flinfo->fn_extra = cache;
+  }
+  if (cache->toastrelid != toast_pointer.va_toastrelid ||
+    cache->valueid != toast_pointer.va_valueid ||
+    cache->extsize != toast_pointer.va_extsize)
+  {
+    if (cache->temp != NULL)
+    {
+      pfree(cache->temp);
+      cache->temp = NULL;
+    }
+    cache->toastrelid = toast_pointer.va_toastrelid;
+    cache->valueid = toast_pointer.va_valueid;
+    cache->extsize = toast_pointer.va_extsize;
+    return NULL;
+  }
+  if (cache->temp == NULL)
+  {
+    Temporal *temp = DatumGetTemporal(tempdatum);
+    cache->temp = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, VARSIZE(temp));
+    memcpy(cache->temp, temp, VARSIZE(temp));
+    pfree(temp);
+    cache->cursor.seqno = -1;
+    cache->cursor.segno = -1;
+  }
+  COUNTER_INC(cache_probes);
+  return cache;
+}
+
+/**
+ * Returns the base value of the temporal value at the timestamp starting
+ * the search of the timestamp from the cursor (dispatch function)
+ */
+bool
+temporal_value_at_timestamp_cursor(const Temporal *temp, TimestampTz t,
+  TimestampCursor *cursor, Datum *result)
+{
+  bool found;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    found = tinstant_value_at_timestamp((TInstant *)temp, t, result);
+  else if (temp->duration == INSTANTSET)
+    found = tinstantset_value_at_timestamp((TInstantSet *)temp, t, result);
+  else if (temp->duration == SEQUENCE)
+    found = tsequence_value_at_timestamp_cursor((TSequence *)temp, t,
+      &cursor->segno, result);
+  else /* temp->duration == SEQUENCESET */
+    found = tsequenceset_value_at_timestamp_cursor((TSequenceSet *)temp, t,
+      cursor, result);
+  return found;
+}
+
 PG_FUNCTION_INFO_V1(temporal_value_at_timestamp);
 /**
  * Returns the base value of the temporal value at the timestamp
+ *
+ * Nested loop joins usually probe the same temporal value at increasing
+ * timestamps. When the value is stored out of line, its detoasted copy and
+ * the position of the last timestamp found are kept across calls in the
+ * cache of the call site, so that a probe close to the previous one does not
+ * detoast the value nor search all its instants again.
  */
 PGDLLEXPORT Datum
 temporal_value_at_timestamp(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Datum tempdatum = PG_GETARG_DATUM(0);
   TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
-  bool found = false;
   Datum result;
-  ensure_valid_duration(temp->duration);
-  if (temp->duration == INSTANT)
-    found = tinstant_value_at_timestamp((TInstant *)temp, t, &result);
-  else if (temp->duration == INSTANTSET)
-    found = tinstantset_value_at_timestamp((TInstantSet *)temp, t, &result);
-  else if (temp->duration == SEQUENCE)
-    found = tsequence_value_at_timestamp((TSequence *)temp, t, &result);
-  else /* temp->duration == SEQUENCESET */
-    found = tsequenceset_value_at_timestamp((TSequenceSet *)temp, t, &result);
-  PG_FREE_IF_COPY(temp, 0);
+  bool found;
+  TimestampCache *cache = temporal_timestamp_cache(fcinfo, tempdatum);
+  if (cache != NULL)
+    found = temporal_value_at_timestamp_cursor(cache->temp, t,
+      &cache->cursor, &result);
+  else
+    found = temporal_value_at_timestamp_slice(tempdatum, t, &result);
   if (!found)
     PG_RETURN_NULL();
   PG_RETURN_DATUM(result);
@@ -3739,12 +5270,12 @@ temporal_value_at_timestamp(PG_FUNCTION_ARGS)
 
 /**
  * Restricts the temporal value to the (complement of the) timestamp set
+ * (dispatch function)
  */
-Datum
-temporal_restrict_timestampset(FunctionCallInfo fcinfo, bool atfunc)
+Temporal *
+temporal_restrict_timestampset_internal(const Temporal *temp,
+  const TimestampSet *ts, bool atfunc)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
-  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
   Temporal *result;
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT)
@@ -3760,12 +5291,25 @@ temporal_restrict_timestampset(FunctionCallInfo fcinfo, bool atfunc)
   else /* temp->duration == SEQUENCESET */
     result = (Temporal *)tsequenceset_restrict_timestampset(
       (TSequenceSet *)temp, ts, atfunc);
+  return result;
+}
+
+/**
+ * Restricts the temporal value to the (complement of the) timestamp set
+ */
+Datum
+temporal_restrict_timestampset(FunctionCallInfo fcinfo, bool atfunc)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+  Temporal *result = temporal_restrict_timestampset_internal(temp, ts, atfunc);
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(ts, 1);
   if (result == NULL)
     PG_RETURN_NULL();
   PG_RETURN_POINTER(result);
 }
+
 PG_FUNCTION_INFO_V1(temporal_at_timestampset);
 /**
  * Restricts the temporal value to the timestamp set
@@ -3786,6 +5330,61 @@ temporal_minus_timestampset(PG_FUNCTION_ARGS)
   return temporal_restrict_timestampset(fcinfo, REST_MINUS);
 }
 
+/**
+ * Returns the temporal value sampled at regular time intervals starting
+ * from its start timestamp (internal function)
+ *
+ * @param[in] temp Temporal value
+ * @param[in] duration Sampling interval
+ * @pre The duration is greater than 0
+ */
+Temporal *
+temporal_sample_internal(const Temporal *temp, const Interval *duration)
+{
+  Period p;
+  temporal_period(&p, temp);
+  /* Intervals without month and day components have a fixed length */
+  bool fixed = (duration->month == 0 && duration->day == 0);
+  int maxcount = fixed ? (int) ((p.upper - p.lower) / duration->time) + 1 : 64;
+  TimestampTz *times = palloc(sizeof(TimestampTz) * maxcount);
+  int count = 0;
+  TimestampTz t = p.lower;
+  while (t <= p.upper)
+  {
+    if (count == maxcount)
+    {
+      maxcount *= 2;
+      times = repalloc(times, sizeof(TimestampTz) * maxcount);
+    }
+    times[count++] = t;
+    t = fixed ? t + duration->time :
+      DatumGetTimestampTz(DirectFunctionCall2(timestamptz_pl_interval,
+        TimestampTzGetDatum(t), PointerGetDatum(duration)));
+  }
+  TimestampSet *ts = timestampset_make_free(times, count);
+  Temporal *result = temporal_restrict_timestampset_internal(temp, ts, REST_AT);
+  pfree(ts);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_sample);
+/**
+ * Returns the temporal value sampled at regular time intervals starting
+ * from its start timestamp
+ */
+PGDLLEXPORT Datum
+temporal_sample(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Interval *duration = PG_GETARG_INTERVAL_P(1);
+  ensure_positive_interval(duration);
+  Temporal *result = temporal_sample_internal(temp, duration);
+  PG_FREE_IF_COPY(temp, 0);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************/
 
 /**
@@ -3823,9 +5422,29 @@ temporal_at_period_internal(const Temporal *temp, const Period *p)
 Datum
 temporal_restrict_period(FunctionCallInfo fcinfo, bool atfunc)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   Period *p = PG_GETARG_PERIOD(1);
-  Temporal *result = temporal_restrict_period_internal(temp, p, atfunc);
+  Temporal *result;
+  if (atfunc && temporal_at_period_slice(PG_GETARG_DATUM(0), p, &result))
+  {
+    if (result == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(result);
+  }
+  Temporal *temp1;
+  if (atfunc && temporal_packed_cover(PG_GETARG_DATUM(0), p, &temp1))
+  {
+    result = NULL;
+    if (temp1 != NULL)
+    {
+      result = temporal_restrict_period_internal(temp1, p, REST_AT);
+      pfree(temp1);
+    }
+    if (result == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(result);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  result = temporal_restrict_period_internal(temp, p, atfunc);
   PG_FREE_IF_COPY(temp, 0);
   if (result == NULL)
     PG_RETURN_NULL();
@@ -3886,8 +5505,24 @@ temporal_restrict_periodset_internal(const Temporal *temp,
 Datum
 temporal_restrict_periodset(FunctionCallInfo fcinfo, bool atfunc)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   PeriodSet *ps = PG_GETARG_PERIODSET(1);
+  Temporal *temp1;
+  /* Fetch only the part of the value on the bounding period */
+  if (atfunc && temporal_at_period_slice(PG_GETARG_DATUM(0), periodset_bbox(ps),
+    &temp1))
+  {
+    Temporal *result = NULL;
+    if (temp1 != NULL)
+    {
+      result = temporal_restrict_periodset_internal(temp1, ps, REST_AT);
+      pfree(temp1);
+    }
+    PG_FREE_IF_COPY(ps, 1);
+    if (result == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(result);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
   Temporal *result = temporal_restrict_periodset_internal(temp, ps, atfunc);
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(ps, 1);
@@ -4187,6 +5822,17 @@ tnumber_twavg(PG_FUNCTION_ARGS)
  * Functions for defining B-tree index
  *****************************************************************************/
 
+/**
+ * Returns true if the two temporal values have the same bytes, in which
+ * case they are equal without comparing their composing instants
+ */
+static bool
+temporal_same_bytes(const Temporal *temp1, const Temporal *temp2)
+{
+  return VARSIZE(temp1) == VARSIZE(temp2) &&
+    memcmp(temp1, temp2, VARSIZE(temp1)) == 0;
+}
+
 /**
  * Returns -1, 0, or 1 depending on whether the first temporal value
  * is less than, equal, or greater than the second one
@@ -4198,6 +5844,8 @@ static int
 temporal_cmp_internal(const Temporal *temp1, const Temporal *temp2)
 {
   assert(temp1->valuetypid == temp2->valuetypid);
+  if (temporal_same_bytes(temp1, temp2))
+    return 0;
 
   /* If both are of the same duration use the specific comparison */
   if (temp1->duration == temp2->duration)
@@ -4294,6 +5942,8 @@ temporal_eq_internal(const Temporal *temp1, const Temporal *temp2)
   assert(temp1->valuetypid == temp2->valuetypid);
   ensure_valid_duration(temp1->duration);
   ensure_valid_duration(temp2->duration);
+  if (temporal_same_bytes(temp1, temp2))
+    return true;
 
   /* If both are of the same duration use the specific equality */
   if (temp1->duration == temp2->duration)
@@ -4390,6 +6040,101 @@ temporal_eq_internal(const Temporal *temp1, const Temporal *temp2)
   return false; /* make compiler quiet */
 }
 
+/**
+ * Copy in the first argument the fixed-size header of the temporal value
+ * given as a datum, fetching only a slice of the value when it is stored
+ * out of line
+ *
+ * @result Returns false if the value is compressed, in which case reading
+ * its header requires to decompress it
+ */
+static bool
+temporal_header_slice(TemporalHeader *hdr, Datum tempdatum)
+{
+  struct varlena *attr = (struct varlena *) DatumGetPointer(tempdatum);
+  if (temporal_sliceable(tempdatum))
+    temporal_slice_copy((char *) hdr + VARHDRSZ, tempdatum, VARHDRSZ,
+      sizeof(TemporalHeader) - VARHDRSZ);
+  else if (! VARATT_IS_EXTENDED(attr))
+    memcpy(hdr, attr, Min(VARSIZE(attr), sizeof(TemporalHeader)));
+  else
+    return false;
+  return true;
+}
+
+/**
+ * Returns true if the flags of the two temporal values differ in a flag
+ * that is part of the value, that is, the interpolation, the Z dimension,
+ * or the geodetic flag. The other flags, such as those of the precomputed
+ * trajectory, blocks, metrics, time summary, or of the packed format,
+ * only state how the value is stored.
+ */
+static bool
+temporal_value_flags_ne(int16 flags1, int16 flags2)
+{
+  return MOBDB_FLAGS_GET_LINEAR(flags1) != MOBDB_FLAGS_GET_LINEAR(flags2) ||
+    MOBDB_FLAGS_GET_Z(flags1) != MOBDB_FLAGS_GET_Z(flags2) ||
+    MOBDB_FLAGS_GET_GEODETIC(flags1) != MOBDB_FLAGS_GET_GEODETIC(flags2);
+}
+
+/**
+ * Returns true if the two temporal values given as datums are known to be
+ * different from their header and their bounding box
+ *
+ * When one of the values is stored out of line, deciding the inequality
+ * of values of the same duration that differ in their number of
+ * composing values, their interpolation or dimensionality, their period,
+ * or their bounding box only fetches slices of the values instead of
+ * detoasting them. The bounding boxes are only compared when they are
+ * periods or TBOX values, whose bounds are values of the composing
+ * instants. The STBOX values of equal temporal points may differ due to
+ * floating point precision and are not compared.
+ */
+static bool
+temporal_ne_slice(Datum tempdatum1, Datum tempdatum2)
+{
+  if (! temporal_sliceable(tempdatum1) && ! temporal_sliceable(tempdatum2))
+    return false;
+  TemporalHeader hdr1, hdr2;
+  if (! temporal_header_slice(&hdr1, tempdatum1) ||
+    ! temporal_header_slice(&hdr2, tempdatum2))
+    return false;
+  /* Values of different duration and packed values are compared after
+   * detoasting them */
+  if (hdr1.temp.duration != hdr2.temp.duration ||
+    hdr1.temp.duration == INSTANT ||
+    MOBDB_FLAGS_GET_PACKED(hdr1.temp.flags) ||
+    MOBDB_FLAGS_GET_PACKED(hdr2.temp.flags))
+    return false;
+  int count1, count2;
+  if (hdr1.temp.duration == INSTANTSET)
+  {
+    count1 = hdr1.ti.count; count2 = hdr2.ti.count;
+  }
+  else if (hdr1.temp.duration == SEQUENCE)
+  {
+    count1 = hdr1.seq.count; count2 = hdr2.seq.count;
+  }
+  else /* hdr1.temp.duration == SEQUENCESET */
+  {
+    count1 = hdr1.ts.count; count2 = hdr2.ts.count;
+  }
+  if (count1 != count2 ||
+    temporal_value_flags_ne(hdr1.temp.flags, hdr2.temp.flags))
+    return true;
+  if (hdr1.temp.duration == SEQUENCE &&
+    ! period_eq_internal(&hdr1.seq.period, &hdr2.seq.period))
+    return true;
+  if (tgeo_base_type(hdr1.temp.valuetypid))
+    return false;
+  bboxunion box1, box2;
+  memset(&box1, 0, sizeof(bboxunion));
+  memset(&box2, 0, sizeof(bboxunion));
+  temporal_bbox_slice(&box1, tempdatum1);
+  temporal_bbox_slice(&box2, tempdatum2);
+  return ! temporal_bbox_eq(&box1, &box2, hdr1.temp.valuetypid);
+}
+
 PG_FUNCTION_INFO_V1(temporal_eq);
 /**
  * Returns true if the two temporal values are equal
@@ -4397,6 +6142,8 @@ PG_FUNCTION_INFO_V1(temporal_eq);
 PGDLLEXPORT Datum
 temporal_eq(PG_FUNCTION_ARGS)
 {
+  if (temporal_ne_slice(PG_GETARG_DATUM(0), PG_GETARG_DATUM(1)))
+    PG_RETURN_BOOL(false);
   Temporal *temp1 = PG_GETARG_TEMPORAL(0);
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   bool result = temporal_eq_internal(temp1, temp2);
@@ -4422,6 +6169,8 @@ PG_FUNCTION_INFO_V1(temporal_ne);
 PGDLLEXPORT Datum
 temporal_ne(PG_FUNCTION_ARGS)
 {
+  if (temporal_ne_slice(PG_GETARG_DATUM(0), PG_GETARG_DATUM(1)))
+    PG_RETURN_BOOL(true);
   Temporal *temp1 = PG_GETARG_TEMPORAL(0);
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   bool result = temporal_ne_internal(temp1, temp2);
@@ -17,11 +17,13 @@
 #include <string.h>
 #include <catalog/pg_collation.h>
 #include <libpq/pqformat.h>
+#include <miscadmin.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
-#include <executor/spi.h>
 #include <gsl/gsl_rng.h>
 
 #include "period.h"
+#include "periodset.h"
 #include "timeops.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
@@ -29,6 +31,8 @@
 #include "tbool_boolops.h"
 #include "temporal_boxops.h"
 #include "doublen.h"
+#include "temporal_tile.h"
+#include "tpoint_spatialfuncs.h"
 
 static TInstant **
 tinstant_tagg(TInstant **instants1, int count1, TInstant **instants2, 
@@ -44,7 +48,7 @@ tsequence_tagg(TSequence **sequences1, int count1, TSequence **sequences2,
 /**
  * Switch to the memory context for aggregation  
  */
-static MemoryContext
+MemoryContext
 set_aggregation_context(FunctionCallInfo fcinfo)
 {
   MemoryContext ctx;
@@ -57,7 +61,7 @@ set_aggregation_context(FunctionCallInfo fcinfo)
 /**
  * Switch to the given memory context
  */
-static void
+void
 unset_aggregation_context(MemoryContext ctx)
 {
   MemoryContextSwitchTo(ctx);
@@ -65,55 +69,194 @@ unset_aggregation_context(MemoryContext ctx)
 }
 
 /**
- * Allocate memory for the skiplist
+ * Create the arena in which the temporal values of a skiplist are allocated
+ *
+ * @note The function must be called in the memory context for aggregation
+ */
+static MemoryContext
+skiplist_arena_make(void)
+{
+#if MOBDB_PGSQL_VERSION < 110000
+  return AllocSetContextCreate(CurrentMemoryContext, "SkipList values",
+    ALLOCSET_DEFAULT_SIZES);
+#else
+  return GenerationContextCreate(CurrentMemoryContext, "SkipList values",
+    SKIPLIST_ARENA_BLOCKSIZE);
+#endif
+}
+
+/**
+ * Copy the temporal value into the arena of the skiplist
+ */
+static Temporal *
+skiplist_value_copy(SkipList *list, const Temporal *temp)
+{
+  size_t size = VARSIZE(temp);
+  Temporal *result = MemoryContextAlloc(list->arena, size);
+  memcpy(result, temp, size);
+  list->livesize += size;
+  return result;
+}
+
+/**
+ * Allocate memory for an element of the skiplist and its tower
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] list Skiplist
+ * @param[in] height Height of the element
  */
 static int
-skiplist_alloc(FunctionCallInfo fcinfo, SkipList *list)
+skiplist_alloc(FunctionCallInfo fcinfo, SkipList *list, int height)
 {
-  list->length ++;
-  if (! list->freecount)
+  if (list->next >= list->capacity ||
+    list->towernext + height > list->towercap)
   {
-    /* No free list, give first available entry */
+    /* No more capacity, let's grow */
+    MemoryContext ctx = set_aggregation_context(fcinfo);
     if (list->next >= list->capacity)
     {
-      /* No more capacity, let's grow */
       list->capacity <<= SKIPLIST_GROW;
-      MemoryContext ctx = set_aggregation_context(fcinfo);
       list->elems = repalloc(list->elems, sizeof(Elem) * list->capacity);
-      unset_aggregation_context(ctx);
     }
-    list->next ++;
-    return list->next - 1;
-  }
-  else 
-  {
-    list->freecount --;
-    return list->freed[list->freecount];
+    if (list->towernext + height > list->towercap)
+    {
+      list->towercap <<= SKIPLIST_GROW;
+      list->towers = repalloc(list->towers, sizeof(int) * list->towercap);
+    }
+    unset_aggregation_context(ctx);
   }
+  int result = list->next++;
+  list->elems[result].height = height;
+  list->elems[result].tower = list->towernext;
+  list->towernext += height;
+  list->length ++;
+  return result;
+}
+
+/**
+ * Free an element of the skiplist. The memory of the element, of its tower,
+ * and of its value is only reclaimed when the skiplist is compacted.
+ */
+static void
+skiplist_free(SkipList *list, int cur)
+{
+  size_t size = VARSIZE(list->elems[cur].value);
+  list->livesize -= size;
+  list->deadsize += size;
+  list->length --;
+  return;
+}
+
+/**
+ * Returns true if the memory used by the elements removed from the skiplist
+ * justifies compacting it
+ */
+static bool
+skiplist_compact_needed(const SkipList *list)
+{
+  int dead = list->next - list->length - 2;
+  return (dead > list->length && dead >= SKIPLIST_INITIAL_CAPACITY) ||
+    (list->deadsize > list->livesize &&
+     list->deadsize >= SKIPLIST_ARENA_BLOCKSIZE);
 }
 
 /**
- * Free memory for the skiplist
+ * Compact the skiplist by copying its live elements, their towers, and their
+ * values in new memory and freeing the old memory in bulk. The elements are
+ * renumbered in the order of the list.
  */
 static void
-skiplist_free(FunctionCallInfo fcinfo, SkipList *list, int cur)
+skiplist_compact(FunctionCallInfo fcinfo, SkipList *list)
 {
-  if (! list->freed)
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  /* Compute the new position of the elements and the size of the towers */
+  int *map = palloc(sizeof(int) * list->next);
+  int count = 0, towersize = 0;
+  int cur = 0;
+  while (cur != -1)
   {
-    list->freecap = SKIPLIST_INITIAL_FREELIST;
-    MemoryContext ctx = set_aggregation_context(fcinfo);
-    list->freed = palloc(sizeof(int) * list->freecap);
-    unset_aggregation_context(ctx);
+    map[cur] = count++;
+    towersize += (cur == 0 || cur == list->tail) ?
+      SKIPLIST_MAXLEVEL : list->elems[cur].height;
+    cur = SKIPLIST_NEXT(list, cur, 0);
   }
-  else if (list->freecount == list->freecap)
+  int capacity = SKIPLIST_INITIAL_CAPACITY;
+  while (capacity <= count)
+    capacity <<= 1;
+  int towercap = SKIPLIST_INITIAL_CAPACITY;
+  while (towercap <= towersize)
+    towercap <<= 1;
+  Elem *elems = palloc(sizeof(Elem) * capacity);
+  int *towers = palloc(sizeof(int) * towercap);
+  MemoryContext oldarena = list->arena;
+  list->arena = skiplist_arena_make();
+  list->livesize = list->deadsize = 0;
+
+  /* Copy the live elements */
+  int pos = 0;
+  cur = 0;
+  while (cur != -1)
   {
-    list->freecap <<= 1;
-    MemoryContext ctx = set_aggregation_context(fcinfo);
-    list->freed = repalloc(list->freed, sizeof(int) * list->freecap);
-    unset_aggregation_context(ctx);
+    Elem *e = &list->elems[cur];
+    Elem *newe = &elems[map[cur]];
+    int size = (cur == 0 || cur == list->tail) ? SKIPLIST_MAXLEVEL : e->height;
+    /* The next pointers above the height of the head and the tail are
+     * not used */
+    for (int level = 0; level < size; level ++)
+    {
+      int next = (level < e->height) ? list->towers[e->tower + level] : -1;
+      towers[pos + level] = (next == -1) ? -1 : map[next];
+    }
+    newe->height = e->height;
+    newe->tower = pos;
+    newe->value = e->value ? skiplist_value_copy(list, e->value) : NULL;
+    pos += size;
+    cur = list->towers[e->tower];
   }
-  list->freed[list->freecount ++] = cur;
-  list->length --;
+  list->tail = map[list->tail];
+  pfree(list->elems);
+  pfree(list->towers);
+  pfree(map);
+  MemoryContextDelete(oldarena);
+  list->elems = elems;
+  list->capacity = capacity;
+  list->next = count;
+  list->towers = towers;
+  list->towercap = towercap;
+  list->towernext = pos;
+  unset_aggregation_context(ctx);
+  return;
+}
+
+/**
+ * Total memory used by the skiplists of the backend
+ */
+static size_t skiplist_total = 0;
+
+/**
+ * Update the total memory used by the skiplists of the backend with the
+ * current footprint of the skiplist
+ */
+static void
+skiplist_account(SkipList *list)
+{
+  size_t footprint = list->livesize + list->deadsize +
+    sizeof(Elem) * list->capacity + sizeof(int) * list->towercap;
+  skiplist_total = skiplist_total - list->accounted + footprint;
+  list->accounted = footprint;
+  return;
+}
+
+/**
+ * Remove the footprint of the skiplist from the total memory used by the
+ * skiplists of the backend (memory context callback)
+ */
+static void
+skiplist_release(void *arg)
+{
+  SkipList *list = (SkipList *) arg;
+  skiplist_total -= list->accounted;
+  list->accounted = 0;
   return;
 }
 
@@ -204,11 +347,11 @@ skiplist_print(const SkipList *list)
     else
       len += sprintf(buf+len, "<p0>%f\"];\n", 
         DatumGetFloat8(temporal_min_value_internal(e->value)));
-    if (e->next[0] != -1)
+    if (SKIPLIST_NEXT(list, cur, 0) != -1)
     {
       for (int l = 0; l < e->height; l ++)
       {
-        int next = e->next[l];
+        int next = SKIPLIST_NEXT(list, cur, l);
         len += sprintf(buf+len, "\telm%d:p%d -> elm%d:p%d ", cur, l, next, l);
         if (l == 0)
           len += sprintf(buf+len, "[weight=100];\n");
@@ -216,7 +359,7 @@ skiplist_print(const SkipList *list)
           len += sprintf(buf+len, ";\n");
       }
     }
-    cur = e->next[0];
+    cur = SKIPLIST_NEXT(list, cur, 0);
   }
   sprintf(buf+len, "}\n");
   ereport(WARNING, (errcode(ERRCODE_WARNING), errmsg("SKIPLIST: %s", buf)));
@@ -255,58 +398,99 @@ random_level()
 }
 
 /**
- * Constructs a skiplist from the array of temporal values
+ * Initialize the elements, the towers, and the arena of the skiplist with
+ * the array of temporal values
  *
- * @param[in] fcinfo Catalog information about the external function
- * @param[in] values Temporal values
- * @param[in] count Number of elements in the array
+ * @note The function must be called in the memory context for aggregation
  */
-SkipList *
-skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
+static void
+skiplist_init(SkipList *list, Temporal **values, int count)
 {
-  assert(count > 0);
   //FIXME: tail should be a constant (e.g. 1) but is not, for ease of construction
-
-  MemoryContext oldctx = set_aggregation_context(fcinfo);
   int capacity = SKIPLIST_INITIAL_CAPACITY;
   count += 2; /* Account for head and tail */
   while (capacity <= count)
     capacity <<= 1;
-  SkipList *result = palloc0(sizeof(SkipList));
-  result->elems = palloc0(sizeof(Elem) * capacity);
+  list->elems = palloc0(sizeof(Elem) * capacity);
   int height = (int) ceil(log2(count - 1));
-  result->capacity = capacity;
-  result->next = count;
-  result->length = count - 2;
-  result->extra = NULL;
-  result->extrasize = 0;
+  list->capacity = capacity;
+  list->next = count;
+  list->length = count - 2;
+  list->arena = skiplist_arena_make();
+  list->livesize = list->deadsize = 0;
+
+  /* Compute the height of the elements and allocate their towers. The head
+   * and the tail have towers of maximum height since they grow with the list */
+  int towersize = 2 * SKIPLIST_MAXLEVEL;
+  for (int i = 1; i < count - 1; i ++)
+  {
+    int h = 1;
+    while (h < height && i % (1 << h) == 0)
+      h ++;
+    list->elems[i].height = h;
+    towersize += h;
+  }
+  list->elems[0].height = list->elems[count - 1].height = height;
+  int towercap = SKIPLIST_INITIAL_CAPACITY;
+  while (towercap <= towersize)
+    towercap <<= 1;
+  list->towers = palloc(sizeof(int) * towercap);
+  list->towercap = towercap;
+  int pos = 0;
+  for (int i = 0; i < count; i ++)
+  {
+    int size = (i == 0 || i == count - 1) ?
+      SKIPLIST_MAXLEVEL : list->elems[i].height;
+    list->elems[i].tower = pos;
+    for (int level = 0; level < size; level ++)
+      list->towers[pos + level] = -1;
+    pos += size;
+  }
+  list->towernext = pos;
 
   /* Fill values first */
-  result->elems[0].value = NULL;
+  list->elems[0].value = NULL;
   for (int i = 0; i < count - 2; i ++)
-    result->elems[i + 1].value = temporal_copy(values[i]);
-  result->elems[count - 1].value = NULL;
-  result->tail = count - 1;
+    list->elems[i + 1].value = skiplist_value_copy(list, values[i]);
+  list->elems[count - 1].value = NULL;
+  list->tail = count - 1;
 
   /* Link the list in a balanced fashion */
   for (int level = 0; level < height; level ++)
   {
     int step = 1 << level;
-    for (int i = 0; i < count; i += step)
+    for (int i = 0; i < count - 1; i += step)
     {
       int next = i + step < count ? i + step : count - 1;
-      if (i != count - 1)
-      {
-        result->elems[i].next[level] = next;
-        result->elems[i].height = level + 1;
-      }
-      else
-      {
-        result->elems[i].next[level] = - 1;
-        result->elems[i].height = height;
-      }
+      SKIPLIST_NEXT(list, i, level) = next;
     }
   }
+  return;
+}
+
+/**
+ * Constructs a skiplist from the array of temporal values
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] values Temporal values
+ * @param[in] count Number of elements in the array
+ */
+SkipList *
+skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
+{
+  assert(count > 0);
+  MemoryContext oldctx = set_aggregation_context(fcinfo);
+  SkipList *result = palloc0(sizeof(SkipList));
+  skiplist_init(result, values, count);
+  result->extra = NULL;
+  result->extrasize = 0;
+  /* The footprint of the skiplist is removed from the total of the backend
+   * when the aggregation context is reset or deleted */
+  MemoryContextCallback *callback = palloc(sizeof(MemoryContextCallback));
+  callback->func = skiplist_release;
+  callback->arg = (void *) result;
+  MemoryContextRegisterResetCallback(CurrentMemoryContext, callback);
+  skiplist_account(result);
   unset_aggregation_context(oldctx);
   return result;
 }
@@ -317,7 +501,7 @@ skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
 Temporal *
 skiplist_headval(SkipList *list)
 {
-  return list->elems[list->elems[0].next[0]].value;
+  return list->elems[SKIPLIST_NEXT(list, 0, 0)].value;
 }
 
 /*  Function not currently used
@@ -326,11 +510,10 @@ skiplist_tailval(SkipList *list)
 {
   // Despite the look, this is pretty much O(1)
   int cur = 0;
-  Elem *e = &list->elems[cur];
-  int height = e->height;
-  while (e->next[height - 1] != list->tail)
-    e = &list->elems[e->next[height - 1]];
-  return e->value;
+  int height = list->elems[cur].height;
+  while (SKIPLIST_NEXT(list, cur, height - 1) != list->tail)
+    cur = SKIPLIST_NEXT(list, cur, height - 1);
+  return list->elems[cur].value;
 }
 */
 
@@ -341,16 +524,137 @@ Temporal **
 skiplist_values(SkipList *list)
 {
   Temporal **result = palloc(sizeof(Temporal *) * list->length);
-  int cur = list->elems[0].next[0];
+  int cur = SKIPLIST_NEXT(list, 0, 0);
   int count = 0;
   while (cur != list->tail)
   {
     result[count++] = list->elems[cur].value;
-    cur = list->elems[cur].next[0];
+    cur = SKIPLIST_NEXT(list, cur, 0);
   }
   return result;
 }
 
+/**
+ * Write the buffer to the file of the runs of a skiplist
+ */
+static void
+skiplist_run_write(BufFile *file, void *ptr, size_t size)
+{
+#if MOBDB_PGSQL_VERSION < 130000
+  if (BufFileWrite(file, ptr, size) != size)
+    ereport(ERROR, (errcode_for_file_access(),
+      errmsg("could not write to temporary file: %m")));
+#else
+  BufFileWrite(file, ptr, size);
+#endif
+  return;
+}
+
+/**
+ * Read the buffer from the file of the runs of a skiplist
+ */
+static void
+skiplist_run_read(BufFile *file, void *ptr, size_t size)
+{
+  if (BufFileRead(file, ptr, size) != size)
+    ereport(ERROR, (errcode_for_file_access(),
+      errmsg("could not read from temporary file: %m")));
+  return;
+}
+
+/**
+ * Returns true if the skiplist must be spilled to disk, that is, if the
+ * skiplists of the backend use more than work_mem and the skiplist is
+ * large enough for the spill to reclaim a significant part of it
+ */
+static bool
+skiplist_spill_needed(const SkipList *list)
+{
+  return ! list->merging && list->length > 1 &&
+    list->accounted >= SKIPLIST_SPILL_MINSIZE &&
+    skiplist_total > (size_t) work_mem * 1024L;
+}
+
+/**
+ * Write the values of the skiplist except the last one as a run in the
+ * temporary file of the skiplist, and restart the skiplist from the last
+ * value. The last value is kept so that the skiplist is never empty.
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[inout] list Skiplist
+ */
+static void
+skiplist_spill(FunctionCallInfo fcinfo, SkipList *list)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  if (list->runs == NULL)
+    list->runs = BufFileCreateTemp(false);
+  Temporal **values = skiplist_values(list);
+  int32 count = list->length - 1;
+  skiplist_run_write(list->runs, &count, sizeof(int32));
+  for (int i = 0; i < count; i++)
+    skiplist_run_write(list->runs, values[i], VARSIZE(values[i]));
+  list->nruns++;
+  COUNTER_INC(skiplist_spills);
+
+  /* The last value is copied in the new arena before the old one is freed */
+  Elem *elems = list->elems;
+  int *towers = list->towers;
+  MemoryContext arena = list->arena;
+  skiplist_init(list, &values[count], 1);
+  pfree(elems);
+  pfree(towers);
+  pfree(values);
+  MemoryContextDelete(arena);
+  unset_aggregation_context(ctx);
+  skiplist_account(list);
+  return;
+}
+
+/**
+ * Merge back into the skiplist the runs spilled to disk
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[inout] list Skiplist
+ * @note The function must be called before reading the values of a
+ * skiplist that may have been spilled
+ */
+void
+skiplist_merge_runs(FunctionCallInfo fcinfo, SkipList *list)
+{
+  if (list->runs == NULL)
+    return;
+  if (BufFileSeek(list->runs, 0, 0, SEEK_SET) != 0)
+    ereport(ERROR, (errcode_for_file_access(),
+      errmsg("could not rewind temporary file: %m")));
+  list->merging = true;
+  for (int i = 0; i < list->nruns; i++)
+  {
+    int32 count;
+    skiplist_run_read(list->runs, &count, sizeof(int32));
+    Temporal **values = palloc(sizeof(Temporal *) * count);
+    for (int j = 0; j < count; j++)
+    {
+      int32 header;
+      skiplist_run_read(list->runs, &header, sizeof(int32));
+      size_t size = VARSIZE(&header);
+      values[j] = palloc(size);
+      memcpy(values[j], &header, sizeof(int32));
+      skiplist_run_read(list->runs, (char *) values[j] + sizeof(int32),
+        size - sizeof(int32));
+    }
+    skiplist_splice(fcinfo, list, values, count, list->func, list->crossings);
+    for (int j = 0; j < count; j++)
+      pfree(values[j]);
+    pfree(values);
+  }
+  BufFileClose(list->runs);
+  list->runs = NULL;
+  list->nruns = 0;
+  list->merging = false;
+  return;
+}
+
 /**
  * Splice the skiplist with the array of temporal values using the aggregation 
  * function
@@ -372,6 +676,7 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
    * everything has to be deleted) 
    */
   assert(list->length > 0);
+  COUNTER_INC(skiplist_splices);
   int16 duration = skiplist_headval(list)->duration;
   Period period;
   if (duration == INSTANT)
@@ -387,33 +692,27 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
   memset(update, 0, sizeof(update));
   int cur = 0;
   int height = list->elems[cur].height;
-  Elem *e = &list->elems[cur];
   for (int level = height - 1; level >= 0; level --)
   {
-    while (e->next[level] != -1 && 
-      skiplist_elmpos(list, e->next[level], period.lower) == AFTER)
-    {
-      cur = e->next[level];
-      e = &list->elems[cur];
-    }
+    while (SKIPLIST_NEXT(list, cur, level) != -1 &&
+      skiplist_elmpos(list, SKIPLIST_NEXT(list, cur, level), period.lower) == AFTER)
+      cur = SKIPLIST_NEXT(list, cur, level);
     update[level] = cur;
   }
 
-  int lower = e->next[0];
+  int lower = SKIPLIST_NEXT(list, cur, 0);
   cur = lower;
-  e = &list->elems[cur];
 
   int spliced_count = 0;
   while (skiplist_elmpos(list, cur, period.upper) == AFTER)
   {
-    cur = e->next[0];
-    e = &list->elems[cur];
+    cur = SKIPLIST_NEXT(list, cur, 0);
     spliced_count ++;
   }
   int upper = cur;
   if (upper >= 0 && skiplist_elmpos(list, upper, period.upper) == DURING)
   {
-    upper = e->next[0]; /* if found upper, one more to remove */
+    upper = SKIPLIST_NEXT(list, cur, 0); /* if found upper, one more to remove */
     spliced_count ++;
   }
 
@@ -425,23 +724,21 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
   {
     for (int level = 0; level < height; level ++)
     {
-      Elem *prev = &list->elems[update[level]];
-      if (prev->next[level] != cur)
+      if (SKIPLIST_NEXT(list, update[level], level) != cur)
         break;
-      prev->next[level] = list->elems[cur].next[level];
+      SKIPLIST_NEXT(list, update[level], level) = SKIPLIST_NEXT(list, cur, level);
     }
     spliced[spliced_count++] = list->elems[cur].value;
-    skiplist_free(fcinfo, list, cur);
-    cur = list->elems[cur].next[0];
+    skiplist_free(list, cur);
+    cur = SKIPLIST_NEXT(list, cur, 0);
   }
 
   /* Level down head & tail if necessary */
-  Elem *head = &list->elems[0];
-  Elem *tail = &list->elems[list->tail];
-  while (head->height > 1 && head->next[head->height - 1] == list->tail)
+  while (list->elems[0].height > 1 &&
+    SKIPLIST_NEXT(list, 0, list->elems[0].height - 1) == list->tail)
   {
-    head->height--;
-    tail->height--;
+    list->elems[0].height--;
+    list->elems[list->tail].height--;
     height--;
   }
 
@@ -456,9 +753,7 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
          (TSequence **)values, count, func, crossings, &newcount);
     values = newtemps;
     count = newcount;
-    /* We need to delete the spliced-out temporal values */
-    for (int i = 0; i < spliced_count; i ++)
-      pfree(spliced[i]);
+    /* The spliced-out temporal values are reclaimed when compacting */
     pfree(spliced);
   }
 
@@ -471,24 +766,19 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
       for (int l = height; l < rheight; l ++)
         update[l] = 0;
       /* Grow head and tail as appropriate */
-      head->height = rheight;
-      tail->height = rheight;
+      list->elems[0].height = rheight;
+      list->elems[list->tail].height = rheight;
     }
-    int new = skiplist_alloc(fcinfo, list);
-    Elem *newelm = &list->elems[new];
-    MemoryContext ctx = set_aggregation_context(fcinfo);
-    newelm->value = temporal_copy(values[i]);
-    unset_aggregation_context(ctx);
-    newelm->height = rheight;
+    /* The allocation may move the elements and the towers */
+    int new = skiplist_alloc(fcinfo, list, rheight);
+    list->elems[new].value = skiplist_value_copy(list, values[i]);
 
     for (int level = 0; level < rheight; level ++)
     {
-      newelm->next[level] = list->elems[update[level]].next[level];
-      list->elems[update[level]].next[level] = new;
+      SKIPLIST_NEXT(list, new, level) = SKIPLIST_NEXT(list, update[level], level);
+      SKIPLIST_NEXT(list, update[level], level) = new;
       if (level >= height && update[0] != list->tail)
-      {
-        newelm->next[level] = list->tail;
-      }
+        SKIPLIST_NEXT(list, new, level) = list->tail;
     }
     if (rheight > height)
       height = rheight;
@@ -501,6 +791,22 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
       pfree(values[i]);
     pfree(values);
   }
+
+  COUNTER_MAX(skiplist_maxlength, list->length);
+
+  /* Reclaim in bulk the memory of the spliced-out elements */
+  if (skiplist_compact_needed(list))
+    skiplist_compact(fcinfo, list);
+
+  /* Bound the memory used by the skiplists of the backend */
+  skiplist_account(list);
+  if (skiplist_spill_needed(list))
+  {
+    list->func = func;
+    list->crossings = crossings;
+    skiplist_spill(fcinfo, list);
+  }
+  return;
 }
 
 /*****************************************************************************
@@ -549,7 +855,11 @@ datum_max_float8(Datum l, Datum r)
  Datum
 datum_min_text(Datum l, Datum r)
 {
-  return text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) < 0 ? l : r;
+  text *txt1 = DatumGetTextPP(l), *txt2 = DatumGetTextPP(r);
+  /* Equal values do not need a collation-aware comparison */
+  if (text_eq(txt1, txt2))
+    return l;
+  return text_cmp(txt1, txt2, DEFAULT_COLLATION_OID) < 0 ? l : r;
 }
 
 /**
@@ -558,7 +868,11 @@ datum_min_text(Datum l, Datum r)
 Datum
 datum_max_text(Datum l, Datum r)
 {
-  return text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) > 0 ? l : r;
+  text *txt1 = DatumGetTextPP(l), *txt2 = DatumGetTextPP(r);
+  /* Equal values do not need a collation-aware comparison */
+  if (text_eq(txt1, txt2))
+    return l;
+  return text_cmp(txt1, txt2, DEFAULT_COLLATION_OID) > 0 ? l : r;
 }
 
 /**
@@ -613,38 +927,49 @@ datum_sum_double4(Datum l, Datum r)
  * Generic binary aggregate functions needed for parallelization
  *****************************************************************************/
 
+/**
+ * Size of the header of a serialized state value: the number of values,
+ * a padding, and the size of the extra data
+ */
+#define AGGSTATE_HEADER_SIZE 16
+
 /**
  * Writes the state value into the buffer
  *
+ * @param[in] fcinfo Catalog information about the external function
  * @param[in] state State
  * @param[in] buf Buffer
+ * @note The temporal values are flat and are thus written as they are in
+ * memory, each one starting at a maximally aligned offset from the
+ * beginning of the data, so that they can be read without copying. The
+ * extra data follows the values. The format is only meant to transfer
+ * state values between the processes of a parallel plan.
  */
 static void 
-aggstate_write(SkipList *state, StringInfo buf)
+aggstate_write(FunctionCallInfo fcinfo, SkipList *state, StringInfo buf)
 {
+  skiplist_merge_runs(fcinfo, state);
   Temporal **values = skiplist_values(state);
-#if MOBDB_PGSQL_VERSION < 110000
-  pq_sendint(buf, (uint32) state->length, 4);
-#else
-  pq_sendint32(buf, (uint32) state->length);
-#endif
-  Oid valuetypid = InvalidOid;
-  if (state->length > 0)
-    valuetypid = values[0]->valuetypid;
-#if MOBDB_PGSQL_VERSION < 110000
-  pq_sendint(buf, valuetypid, 4);
-#else
-  pq_sendint32(buf, valuetypid);
-#endif
+  /* The data starts after the varlena header reserved by pq_begintypsend */
+  int start = buf->len;
+  int32 length = state->length, pad = 0;
+  uint64 extrasize = (uint64) state->extrasize;
+  appendBinaryStringInfo(buf, (char *) &length, sizeof(int32));
+  appendBinaryStringInfo(buf, (char *) &pad, sizeof(int32));
+  appendBinaryStringInfo(buf, (char *) &extrasize, sizeof(uint64));
   for (int i = 0; i < state->length; i ++)
   {
-    SPI_connect();
-    temporal_write(values[i], buf);
-    SPI_finish();
+    int offset = buf->len - start;
+    /* Pad the buffer with zeroes up to the next aligned offset */
+    while (offset < MAXALIGN(offset))
+    {
+      appendStringInfoCharMacro(buf, '\0');
+      offset ++;
+    }
+    appendBinaryStringInfo(buf, (char *) values[i], VARSIZE(values[i]));
   }
-  pq_sendint64(buf, state->extrasize);
   if (state->extra)
-    pq_sendbytes(buf, state->extra, (int) state->extrasize);
+    appendBinaryStringInfo(buf, (char *) state->extra, (int) state->extrasize);
   pfree(values);
   return;
 }
@@ -653,26 +978,49 @@ aggstate_write(SkipList *state, StringInfo buf)
  * Reads the state value from the buffer
  *
  * @param[in] fcinfo Catalog information about the external function
- * @param[in] buf Buffer
+ * @param[in] data Serialized state value
+ * @param[in] size Size of the serialized state value
  */
 static SkipList *
-aggstate_read(FunctionCallInfo fcinfo, StringInfo buf)
-{
-  int size = pq_getmsgint(buf, 4);
-  Oid valuetypid = pq_getmsgint(buf, 4);
-  Temporal **values = palloc0(sizeof(Temporal *) * size);
-  for (int i = 0; i < size; i ++)
-    values[i] = temporal_read(buf, valuetypid);
-  SkipList *result = skiplist_make(fcinfo, values, size);
-  size_t extrasize = (size_t) pq_getmsgint64(buf);
-  if (extrasize)
+aggstate_read(FunctionCallInfo fcinfo, const char *data, size_t size)
+{
+  /* The values are read in place unless the data is not aligned */
+  if (size < AGGSTATE_HEADER_SIZE)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Invalid aggregate state value")));
+  char *copy = NULL;
+  if ((uintptr_t) data != MAXALIGN((uintptr_t) data))
+  {
+    copy = palloc(size);
+    memcpy(copy, data, size);
+    data = copy;
+  }
+  int32 length;
+  uint64 extrasize;
+  memcpy(&length, data, sizeof(int32));
+  memcpy(&extrasize, data + 2 * sizeof(int32), sizeof(uint64));
+  Temporal **values = palloc(sizeof(Temporal *) * length);
+  size_t offset = AGGSTATE_HEADER_SIZE;
+  for (int i = 0; i < length; i ++)
   {
-    const char *extra = pq_getmsgbytes(buf, (int) extrasize);
-    aggstate_set_extra(fcinfo, result, (void *)extra, extrasize);
+    offset = MAXALIGN(offset);
+    if (offset + VARHDRSZ > size ||
+      offset + VARSIZE(data + offset) > size)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+        errmsg("Invalid aggregate state value")));
+    values[i] = (Temporal *) (data + offset);
+    offset += VARSIZE(values[i]);
   }
-  for (int i = 0; i < size; i ++)
-    pfree(values[i]);
+  if (offset + extrasize != size)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Invalid aggregate state value")));
+  SkipList *result = skiplist_make(fcinfo, values, length);
+  if (extrasize)
+    aggstate_set_extra(fcinfo, result, (void *)(data + offset),
+      (size_t) extrasize);
   pfree(values);
+  if (copy)
+    pfree(copy);
   return result;
 }
 
@@ -707,7 +1055,7 @@ temporal_tagg_serialize(PG_FUNCTION_ARGS)
   SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
   StringInfoData buf;
   pq_begintypsend(&buf);
-  aggstate_write(state, &buf);
+  aggstate_write(fcinfo, state, &buf);
   PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
 
@@ -719,14 +1067,8 @@ PGDLLEXPORT Datum
 temporal_tagg_deserialize(PG_FUNCTION_ARGS)
 {
   bytea *data = PG_GETARG_BYTEA_P(0);
-  StringInfoData buf =
-  {
-    .cursor = 0,
-    .data = VARDATA(data),
-    .len = VARSIZE(data),
-    .maxlen = VARSIZE(data)
-  };
-  SkipList *result = aggstate_read(fcinfo, &buf);
+  SkipList *result = aggstate_read(fcinfo, VARDATA(data),
+    VARSIZE(data) - VARHDRSZ);
   PG_RETURN_POINTER(result);
 }
 
@@ -1108,7 +1450,7 @@ tsequence_tagg_transfn(FunctionCallInfo fcinfo, SkipList *state,
  * @param[in] func Function
  * @param[in] crossings State whether turning points are added in the segments
  */
-static SkipList *
+SkipList *
 tsequenceset_tagg_transfn(FunctionCallInfo fcinfo, SkipList *state, 
   const TSequenceSet *ts, Datum (*func)(Datum, Datum), bool crossings)
 {
@@ -1203,6 +1545,16 @@ temporal_tagg_combinefn1(FunctionCallInfo fcinfo, SkipList *state1,
     ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
       errmsg("Cannot aggregate temporal values of different interpolation")));
 
+  /* The values of both states are sorted, so that splicing the values of
+   * the smaller state into the larger one merges both of them in a single
+   * pass over the overlapping part */
+  if (state2->length > state1->length)
+  {
+    SkipList *temp = state1;
+    state1 = state2;
+    state2 = temp;
+  }
+  skiplist_merge_runs(fcinfo, state2);
   int count2 = state2->length;
   Temporal **values2 = skiplist_values(state2);
   skiplist_splice(fcinfo, state1, values2, count2, func, crossings);
@@ -1245,6 +1597,7 @@ temporal_tagg_finalfn(PG_FUNCTION_ARGS)
   if (state->length == 0)
     PG_RETURN_NULL();
 
+  skiplist_merge_runs(fcinfo, state);
   Temporal **values = skiplist_values(state);
   Temporal *result = NULL;
   assert(values[0]->duration == INSTANT ||
@@ -1400,121 +1753,340 @@ temporal_tagg_transform_transfn(FunctionCallInfo fcinfo,
 }
 
 /*****************************************************************************
- * Temporal count
+ * Sweep-line aggregation
+ * The temporal count and the temporal sum of temporal integers are computed
+ * by accumulating for each input value the events at which the count or the
+ * value of the aggregate changes. The events are sorted and swept once in the
+ * final function to construct the result. Each event keeps the change of the
+ * count and of the value at the timestamp and after the timestamp, which
+ * allows to take into account the inclusive and exclusive bounds.
  *****************************************************************************/
 
 /**
- * Transform a temporal instant value into a temporal integer value for
- * performing temporal count aggregation 
+ * Comparator function for sweep-line events
  */
-static TInstant *
-tinstant_transform_tcount(const TInstant *inst)
+static int
+sweep_event_cmp(const void *a, const void *b)
 {
-  return tinstant_make(Int32GetDatum(1), inst->t, INT4OID);
+  TimestampTz t1 = ((const SweepEvent *) a)->t;
+  TimestampTz t2 = ((const SweepEvent *) b)->t;
+  return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
 }
 
 /**
- * Transform a temporal instant set value into a temporal integer value for
- * performing temporal count aggregation 
+ * Returns true if the event does not change the count nor the value of the
+ * aggregate, which happens when the events of a value removed from a
+ * moving aggregate cancel the ones of the value
  */
-static TInstant **
-tinstantset_transform_tcount(const TInstantSet *ti)
+static bool
+sweep_event_null(const SweepEvent *event)
 {
-  TInstant **result = palloc(sizeof(TInstant *) * ti->count);
-  Datum datum_one = Int32GetDatum(1);
-  for (int i = 0; i < ti->count; i++)
-  {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    result[i] = tinstant_make(datum_one, inst->t, INT4OID);
-  }
-  return result;
+  return event->count_at == 0 && event->count_after == 0 &&
+    event->value_at == 0 && event->value_after == 0;
 }
 
 /**
- * Transform a temporal sequence value into a temporal integer value for
- * performing temporal count aggregation 
+ * Sort the events of the state, merge the events at the same timestamp, and
+ * remove the events that do not change the aggregate
  */
-static TSequence *
-tsequence_transform_tcount(const TSequence *seq)
+static void
+sweepstate_compact(SweepState *state)
 {
-  TSequence *result;
-  Datum datum_one = Int32GetDatum(1);
-  if (seq->count == 1)
+  if (state->count == 0)
+    return;
+  qsort(state->events, (size_t) state->count, sizeof(SweepEvent),
+    &sweep_event_cmp);
+  int k = 0;
+  for (int i = 1; i < state->count; i++)
   {
-    TInstant *inst = tinstant_make(datum_one, seq->period.lower, INT4OID);
-    result = tinstant_to_tsequence(inst, STEP);
-    pfree(inst);
-    return result;
+    SweepEvent *event = &state->events[i];
+    SweepEvent *last = &state->events[k];
+    if (event->t == last->t)
+    {
+      last->count_at += event->count_at;
+      last->count_after += event->count_after;
+      last->value_at += event->value_at;
+      last->value_after += event->value_after;
+    }
+    else
+    {
+      if (! sweep_event_null(last))
+        k++;
+      state->events[k] = *event;
+    }
   }
+  state->count = sweep_event_null(&state->events[k]) ? k : k + 1;
+  return;
+}
 
-  TInstant *instants[2];
-  instants[0] = tinstant_make(datum_one, seq->period.lower, INT4OID);
-  instants[1] = tinstant_make(datum_one, seq->period.upper, INT4OID);
-  result = tsequence_make(instants, 2, seq->period.lower_inc,
-    seq->period.upper_inc, STEP, NORMALIZE_NO);
-  pfree(instants[0]); pfree(instants[1]); 
+/**
+ * Create a new state for sweep-line aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] duration Duration of the aggregated values
+ * @param[in] capacity Initial number of events of the state
+ */
+static SweepState *
+sweepstate_make(FunctionCallInfo fcinfo, TDuration duration, int capacity)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  SweepState *result = palloc(sizeof(SweepState));
+  result->duration = duration;
+  result->capacity = Max(capacity, SWEEPSTATE_INITIAL_CAPACITY);
+  result->count = 0;
+  result->events = palloc(sizeof(SweepEvent) * result->capacity);
+  unset_aggregation_context(ctx);
   return result;
 }
 
 /**
- * Transform a temporal sequence set value into a temporal integer value for
- * performing temporal count aggregation 
+ * Ensure that the state can hold the given number of additional events.
+ * The events of the state are compacted before growing the state, which
+ * keeps its size proportional to the number of distinct timestamps.
  */
-static TSequence **
-tsequenceset_transform_tcount(const TSequenceSet *ts)
+static void
+sweepstate_reserve(FunctionCallInfo fcinfo, SweepState *state, int count)
+{
+  if (state->count + count <= state->capacity)
+    return;
+  sweepstate_compact(state);
+  if (state->count + count <= state->capacity / 2)
+    return;
+  while (state->count + count > state->capacity / 2)
+    state->capacity <<= 1;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->events = repalloc(state->events, sizeof(SweepEvent) * state->capacity);
+  unset_aggregation_context(ctx);
+  return;
+}
+
+/**
+ * Add an event to the state
+ *
+ * @pre There is enough capacity in the state for the event
+ */
+static void
+sweepstate_add(SweepState *state, TimestampTz t, int32 count_at,
+  int32 count_after, int64 value_at, int64 value_after)
+{
+  SweepEvent *event = &state->events[state->count++];
+  event->t = t;
+  event->count_at = count_at;
+  event->count_after = count_after;
+  event->value_at = value_at;
+  event->value_after = value_after;
+  return;
+}
+
+/**
+ * Create the state or ensure that it can hold the given number of additional
+ * events
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] state State, may be NULL
+ * @param[in] duration Duration of the aggregated values
+ * @param[in] count Number of additional events
+ */
+static SweepState *
+sweepstate_prepare(FunctionCallInfo fcinfo, SweepState *state,
+  TDuration duration, int count)
 {
-  TSequence **result = palloc(sizeof(TSequence *) * ts->count);
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    result[i] = tsequence_transform_tcount(seq);
-  }
-  return result;
+  if (state == NULL)
+    return sweepstate_make(fcinfo, duration, count);
+  if (state->duration != duration)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different duration")));
+  sweepstate_reserve(fcinfo, state, count);
+  return state;
 }
 
 /**
- * Transform a temporal value into a temporal integer value for
- * performing temporal count aggregation (dispatch function)
+ * Negate the events of the state from the given one on. Since the events are
+ * additive, the events of a value removed from the state are the opposite of
+ * the ones of the value.
  */
-static Temporal **
-temporal_transform_tcount(const Temporal *temp, int *count)
+static void
+sweepstate_negate(SweepState *state, int first)
 {
-  Temporal **result;
-  if (temp->duration == INSTANT) 
+  for (int i = first; i < state->count; i++)
   {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tinstant_transform_tcount((TInstant *)temp);
-    *count = 1;
+    SweepEvent *event = &state->events[i];
+    event->count_at = - event->count_at;
+    event->count_after = - event->count_after;
+    event->value_at = - event->value_at;
+    event->value_after = - event->value_after;
   }
-  else if (temp->duration == INSTANTSET)
-  {
-    result = (Temporal **)tinstantset_transform_tcount((TInstantSet *) temp);
-    *count = ((TInstantSet *)temp)->count;
-  } 
+  return;
+}
+
+/**
+ * Returns the value of the instant that is aggregated, that is, 1 for the
+ * temporal count and the value of the instant for the temporal sum
+ */
+static int64
+sweep_inst_value(const TInstant *inst, bool count)
+{
+  return count ? 1 : (int64) DatumGetInt32(tinstant_value(inst));
+}
+
+/**
+ * Add to the state the events of a temporal sequence value
+ *
+ * @param[in] state State
+ * @param[in] seq Temporal value
+ * @param[in] count True for the temporal count, false for the temporal sum
+ * @pre There is enough capacity in the state for the events
+ */
+static void
+tsequence_sweep_events(SweepState *state, const TSequence *seq, bool count)
+{
+  TInstant *inst = tsequence_inst_n(seq, 0);
+  int64 value = sweep_inst_value(inst, count);
+  if (seq->count == 1)
+  {
+    sweepstate_add(state, inst->t, 1, 0, value, 0);
+    return;
+  }
+  if (seq->period.lower_inc)
+    sweepstate_add(state, inst->t, 1, 1, value, value);
+  else
+    sweepstate_add(state, inst->t, 0, 1, 0, value);
+  /* The count only changes at the bounds of the sequence */
+  for (int i = 1; i < seq->count - 1 && ! count; i++)
+  {
+    inst = tsequence_inst_n(seq, i);
+    int64 value1 = sweep_inst_value(inst, count);
+    if (value1 != value)
+      sweepstate_add(state, inst->t, 0, 0, value1 - value, value1 - value);
+    value = value1;
+  }
+  inst = tsequence_inst_n(seq, seq->count - 1);
+  if (seq->period.upper_inc)
+    sweepstate_add(state, inst->t, 0, -1,
+      sweep_inst_value(inst, count) - value, - value);
+  else
+    sweepstate_add(state, inst->t, -1, -1, - value, - value);
+  return;
+}
+
+/**
+ * Add to the state the events of a temporal value (dispatch function)
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] state State, may be NULL
+ * @param[in] temp Temporal value
+ * @param[in] count True for the temporal count, false for the temporal sum
+ * @param[in] inverse True when the value is removed from the state
+ */
+static SweepState *
+temporal_sweep_events(FunctionCallInfo fcinfo, SweepState *state,
+  const Temporal *temp, bool count, bool inverse)
+{
+  ensure_valid_duration(temp->duration);
+  /* Instants and instant sets are aggregated into instant sets, sequences
+   * and sequence sets are aggregated into sequence sets */
+  TDuration duration = (temp->duration == INSTANT ||
+    temp->duration == INSTANTSET) ? INSTANT : SEQUENCE;
+  int maxcount;
+  if (temp->duration == INSTANT)
+    maxcount = 1;
+  else if (temp->duration == INSTANTSET)
+    maxcount = ((TInstantSet *) temp)->count;
   else if (temp->duration == SEQUENCE)
+    maxcount = count ? 2 : ((TSequence *) temp)->count;
+  else /* temp->duration == SEQUENCESET */
+    maxcount = count ? 2 * ((TSequenceSet *) temp)->count :
+      ((TSequenceSet *) temp)->totalcount;
+  state = sweepstate_prepare(fcinfo, state, duration, maxcount);
+  /* The reservation may compact the events of the state */
+  int first = state->count;
+
+  if (temp->duration == INSTANT)
   {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tsequence_transform_tcount((TSequence *) temp);
-    *count = 1;
+    const TInstant *inst = (const TInstant *) temp;
+    int64 value = sweep_inst_value(inst, count);
+    sweepstate_add(state, inst->t, 1, 0, value, 0);
   }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+    {
+      TInstant *inst = tinstantset_inst_n(ti, i);
+      int64 value = sweep_inst_value(inst, count);
+      sweepstate_add(state, inst->t, 1, 0, value, 0);
+    }
+  }
+  else if (temp->duration == SEQUENCE)
+    tsequence_sweep_events(state, (TSequence *) temp, count);
   else /* temp->duration == SEQUENCESET */
   {
-    result = (Temporal **)tsequenceset_transform_tcount((TSequenceSet *) temp);
-    *count = ((TSequenceSet *)temp)->count;
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      tsequence_sweep_events(state, tsequenceset_seq_n(ts, i), count);
   }
-  assert(result != NULL);
-  return result;
+  if (inverse)
+    sweepstate_negate(state, first);
+  return state;
+}
+
+/**
+ * Add to the state the events of the temporal count of the time during
+ * which a temporal value satisfies a condition, which avoids restricting
+ * the temporal value to the condition before counting it
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] state State, may be NULL
+ * @param[in] ps Time during which the temporal value satisfies the condition
+ * @param[in] duration Duration of the temporal value
+ * @param[in] inverse True when the value is removed from the state
+ */
+SweepState *
+periodset_tcount_events(FunctionCallInfo fcinfo, SweepState *state,
+  const PeriodSet *ps, TDuration duration, bool inverse)
+{
+  ensure_valid_duration(duration);
+  duration = (duration == INSTANT || duration == INSTANTSET) ?
+    INSTANT : SEQUENCE;
+  state = sweepstate_prepare(fcinfo, state, duration, 2 * ps->count);
+  /* The reservation may compact the events of the state */
+  int first = state->count;
+  for (int i = 0; i < ps->count; i++)
+  {
+    Period *p = periodset_per_n(ps, i);
+    if (p->lower == p->upper)
+    {
+      sweepstate_add(state, p->lower, 1, 0, 1, 0);
+      continue;
+    }
+    if (p->lower_inc)
+      sweepstate_add(state, p->lower, 1, 1, 1, 1);
+    else
+      sweepstate_add(state, p->lower, 0, 1, 0, 1);
+    if (p->upper_inc)
+      sweepstate_add(state, p->upper, 0, -1, 0, -1);
+    else
+      sweepstate_add(state, p->upper, -1, -1, -1, -1);
+  }
+  if (inverse)
+    sweepstate_negate(state, first);
+  return state;
 }
 
-PG_FUNCTION_INFO_V1(temporal_tcount_transfn);
 /**
- * Generic transition function for temporal aggregation
+ * Generic transition function for sweep-line aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] count True for the temporal count, false for the temporal sum
+ * @param[in] inverse True for the inverse transition function of a moving
+ * aggregate, which removes the value from the state
  */
-PGDLLEXPORT Datum 
-temporal_tcount_transfn(PG_FUNCTION_ARGS)
+static Datum
+temporal_tagg_sweep_transfn(FunctionCallInfo fcinfo, bool count,
+  bool inverse)
 {
-  SkipList *state = PG_ARGISNULL(0) ? NULL : 
-    (SkipList *) PG_GETARG_POINTER(0);
+  SweepState *state = PG_ARGISNULL(0) ? NULL :
+    (SweepState *) PG_GETARG_POINTER(0);
   if (PG_ARGISNULL(1))
   {
     if (state)
@@ -1524,33 +2096,289 @@ temporal_tcount_transfn(PG_FUNCTION_ARGS)
   }
 
   Temporal *temp = PG_GETARG_TEMPORAL(1);
-  int count;
-  Temporal **tsequenceset = temporal_transform_tcount(temp, &count);
-  if (state)
+  state = temporal_sweep_events(fcinfo, state, temp, count, inverse);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+/**
+ * Combine the two states of sweep-line aggregation into the first one
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] state1, state2 State values, may be NULL
+ */
+static SweepState *
+sweepstate_combine(FunctionCallInfo fcinfo, SweepState *state1,
+  const SweepState *state2)
+{
+  if (state1 == NULL)
+    return (SweepState *) state2;
+  if (state2 == NULL)
+    return state1;
+
+  if (state1->duration != state2->duration)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different duration")));
+  sweepstate_reserve(fcinfo, state1, state2->count);
+  memcpy(&state1->events[state1->count], state2->events,
+    sizeof(SweepEvent) * state2->count);
+  state1->count += state2->count;
+  return state1;
+}
+
+PG_FUNCTION_INFO_V1(temporal_tagg_sweep_combinefn);
+/**
+ * Combine function for sweep-line aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tagg_sweep_combinefn(PG_FUNCTION_ARGS)
+{
+  SweepState *state1 = PG_ARGISNULL(0) ? NULL :
+    (SweepState *) PG_GETARG_POINTER(0);
+  SweepState *state2 = PG_ARGISNULL(1) ? NULL :
+    (SweepState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(sweepstate_combine(fcinfo, state1, state2));
+}
+
+/**
+ * Construct the temporal integer instant set resulting from the sweep of
+ * the events
+ *
+ * @param[in] events Array of events sorted by timestamp without duplicates
+ * @param[in] count Number of elements in the array
+ */
+static TInstantSet *
+tinstant_sweep_finalfn(const SweepEvent *events, int count)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * count);
+  int k = 0;
+  for (int i = 0; i < count; i++)
   {
-    if (skiplist_headval(state)->duration != tsequenceset[0]->duration)
-      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-        errmsg("Cannot aggregate temporal values of different duration")));
-    skiplist_splice(fcinfo, state, tsequenceset, count, &datum_sum_int32, false);
+    if (events[i].count_at > 0)
+      instants[k++] = tinstant_make(Int32GetDatum((int32) events[i].value_at),
+        events[i].t, INT4OID);
   }
-  else
-    state = skiplist_make(fcinfo, tsequenceset, count);
+  return tinstantset_make_free(instants, k);
+}
 
-  for (int i = 0; i< count; i++)
-    pfree(tsequenceset[i]);
-  pfree(tsequenceset);
-  PG_FREE_IF_COPY(temp, 1);
+/**
+ * Construct the temporal integer sequence set resulting from the sweep of
+ * the events
+ *
+ * @param[in] events Array of events sorted by timestamp without duplicates
+ * @param[in] count Number of elements in the array
+ */
+static TSequenceSet *
+tsequence_sweep_finalfn(const SweepEvent *events, int count)
+{
+  /* Each event ends at most one sequence and constructs at most one
+   * instantaneous sequence */
+  TSequence **sequences = palloc(sizeof(TSequence *) * 2 * count);
+  TInstant **instants = palloc(sizeof(TInstant *) * (count + 1));
+  int k = 0, n = 0;
+  bool lower_inc = true;
+  /* Count and value of the aggregate before the current event */
+  int32 cnt = 0;
+  int64 value = 0;
+  for (int i = 0; i < count; i++)
+  {
+    TimestampTz t = events[i].t;
+    int32 cnt_at = cnt + events[i].count_at;
+    int32 cnt_after = cnt + events[i].count_after;
+    int64 value_at = value + events[i].value_at;
+    int64 value_after = value + events[i].value_after;
+    if (cnt > 0 && cnt_at > 0 && cnt_after > 0 && value_at == value_after)
+    {
+      /* The current sequence continues */
+      if (value_at != value)
+        instants[n++] = tinstant_make(Int32GetDatum((int32) value_at), t,
+          INT4OID);
+    }
+    else
+    {
+      /* The current sequence, if any, ends at the timestamp */
+      bool upper_inc = (cnt > 0 && cnt_at > 0);
+      if (cnt > 0)
+      {
+        instants[n++] = tinstant_make(Int32GetDatum((int32)
+          (upper_inc ? value_at : value)), t, INT4OID);
+        sequences[k++] = tsequence_make_free(instants, n, lower_inc,
+          upper_inc, STEP, NORMALIZE);
+        instants = palloc(sizeof(TInstant *) * (count + 1));
+        n = 0;
+      }
+      /* Instantaneous sequence at the timestamp */
+      if (! upper_inc && cnt_at > 0 &&
+        (cnt_after == 0 || value_at != value_after))
+      {
+        TInstant *inst = tinstant_make(Int32GetDatum((int32) value_at), t,
+          INT4OID);
+        sequences[k++] = tinstant_to_tsequence(inst, STEP);
+        pfree(inst);
+      }
+      /* A new sequence starts at the timestamp */
+      if (cnt_after > 0)
+      {
+        lower_inc = ! upper_inc && cnt_at > 0 && value_at == value_after;
+        instants[n++] = tinstant_make(Int32GetDatum((int32) value_after), t,
+          INT4OID);
+      }
+    }
+    cnt = cnt_after;
+    value = value_after;
+  }
+  pfree(instants);
+  return tsequenceset_make_free(sequences, k, NORMALIZE);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tagg_sweep_finalfn);
+/**
+ * Final function for sweep-line aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tagg_sweep_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  SweepState *state = (SweepState *) PG_GETARG_POINTER(0);
+  sweepstate_compact(state);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+
+  Temporal *result = (state->duration == INSTANT) ?
+    (Temporal *) tinstant_sweep_finalfn(state->events, state->count) :
+    (Temporal *) tsequence_sweep_finalfn(state->events, state->count);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tagg_sweep_serialize);
+/**
+ * Serialize the state value of sweep-line aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tagg_sweep_serialize(PG_FUNCTION_ARGS)
+{
+  SweepState *state = (SweepState *) PG_GETARG_POINTER(0);
+  sweepstate_compact(state);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->duration, 4);
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->duration);
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  for (int i = 0; i < state->count; i++)
+  {
+    SweepEvent *event = &state->events[i];
+    pq_sendint64(&buf, event->t);
+#if MOBDB_PGSQL_VERSION < 110000
+    pq_sendint(&buf, (uint32) event->count_at, 4);
+    pq_sendint(&buf, (uint32) event->count_after, 4);
+#else
+    pq_sendint32(&buf, (uint32) event->count_at);
+    pq_sendint32(&buf, (uint32) event->count_after);
+#endif
+    pq_sendint64(&buf, event->value_at);
+    pq_sendint64(&buf, event->value_after);
+  }
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/**
+ * Reads the state value of sweep-line aggregation from its serialization
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] data Serialized state value
+ */
+static SweepState *
+sweepstate_read(FunctionCallInfo fcinfo, bytea *data)
+{
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data),
+    .maxlen = VARSIZE(data)
+  };
+  TDuration duration = (TDuration) pq_getmsgint(&buf, 4);
+  int count = (int) pq_getmsgint(&buf, 4);
+  SweepState *result = sweepstate_make(fcinfo, duration, count);
+  for (int i = 0; i < count; i++)
+  {
+    TimestampTz t = (TimestampTz) pq_getmsgint64(&buf);
+    int32 count_at = (int32) pq_getmsgint(&buf, 4);
+    int32 count_after = (int32) pq_getmsgint(&buf, 4);
+    int64 value_at = pq_getmsgint64(&buf);
+    int64 value_after = pq_getmsgint64(&buf);
+    sweepstate_add(result, t, count_at, count_after, value_at, value_after);
+  }
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_tagg_sweep_deserialize);
+/**
+ * Deserialize the state value of sweep-line aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tagg_sweep_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  PG_RETURN_POINTER(sweepstate_read(fcinfo, data));
+}
+
+PG_FUNCTION_INFO_V1(temporal_tagg_sweep_merge_transfn);
+/**
+ * Transition function merging serialized state values of sweep-line
+ * aggregation, which are stored by the rollups between their refreshes
+ */
+PGDLLEXPORT Datum
+temporal_tagg_sweep_merge_transfn(PG_FUNCTION_ARGS)
+{
+  SweepState *state = PG_ARGISNULL(0) ? NULL :
+    (SweepState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  bytea *data = PG_GETARG_BYTEA_P(1);
+  SweepState *state2 = sweepstate_read(fcinfo, data);
+  state = sweepstate_combine(fcinfo, state, state2);
+  PG_FREE_IF_COPY(data, 1);
   PG_RETURN_POINTER(state);
 }
 
-PG_FUNCTION_INFO_V1(temporal_tcount_combinefn);
+/*****************************************************************************
+ * Temporal count
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(temporal_tcount_transfn);
 /**
- * Generic combine function for temporal aggregation
+ * Transition function for temporal count aggregation
  */
 PGDLLEXPORT Datum 
-temporal_tcount_combinefn(PG_FUNCTION_ARGS)
+temporal_tcount_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_tagg_combinefn(fcinfo, &datum_sum_int32, false);
+  return temporal_tagg_sweep_transfn(fcinfo, true, false);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_invfn);
+/**
+ * Inverse transition function for temporal count aggregation used as a
+ * moving aggregate
+ */
+PGDLLEXPORT Datum
+temporal_tcount_invfn(PG_FUNCTION_ARGS)
+{
+  return temporal_tagg_sweep_transfn(fcinfo, true, true);
 }
 
 /*****************************************************************************
@@ -1808,12 +2636,27 @@ PG_FUNCTION_INFO_V1(tint_tsum_transfn);
 PGDLLEXPORT Datum
 tint_tsum_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_tagg_transfn(fcinfo, &datum_sum_int32, CROSSINGS_NO);
+  return temporal_tagg_sweep_transfn(fcinfo, false, false);
+}
+
+PG_FUNCTION_INFO_V1(tint_tsum_invfn);
+/**
+ * Inverse transition function for temporal sum aggregation of temporal
+ * integer values used as a moving aggregate
+ */
+PGDLLEXPORT Datum
+tint_tsum_invfn(PG_FUNCTION_ARGS)
+{
+  return temporal_tagg_sweep_transfn(fcinfo, false, true);
 }
 
 PG_FUNCTION_INFO_V1(tint_tsum_combinefn);
 /**
  * Combine function for temporal sum aggregation of temporal integer values
+ *
+ * @note This function is used by the window sum and count aggregates, the
+ * temporal sum aggregate of temporal integer values uses sweep-line
+ * aggregation
  */
 PGDLLEXPORT Datum
 tint_tsum_combinefn(PG_FUNCTION_ARGS)
@@ -1923,6 +2766,32 @@ tnumber_tavg_combinefn(PG_FUNCTION_ARGS)
   return temporal_tagg_combinefn(fcinfo, &datum_sum_double2, false);
 }
 
+PG_FUNCTION_INFO_V1(tnumber_tavg_merge_transfn);
+/**
+ * Transition function merging serialized state values of temporal average
+ * aggregation, which are stored by the rollups between their refreshes
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_merge_transfn(PG_FUNCTION_ARGS)
+{
+  SkipList *state = PG_ARGISNULL(0) ? NULL :
+    (SkipList *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  bytea *data = PG_GETARG_BYTEA_P(1);
+  SkipList *state2 = aggstate_read(fcinfo, VARDATA(data),
+    VARSIZE(data) - VARHDRSZ);
+  SkipList *result = temporal_tagg_combinefn1(fcinfo, state, state2,
+    &datum_sum_double2, false);
+  PG_RETURN_POINTER(result);
+}
+
 /* Final function for tavg */
 
 /**
@@ -1981,6 +2850,7 @@ tnumber_tavg_finalfn(PG_FUNCTION_ARGS)
   if (state->length == 0)
     PG_RETURN_NULL();
 
+  skiplist_merge_runs(fcinfo, state);
   Temporal **values = skiplist_values(state);
   assert(values[0]->duration == INSTANT || values[0]->duration == SEQUENCE);
   Temporal *result = (values[0]->duration == INSTANT) ?
@@ -1990,4 +2860,540 @@ tnumber_tavg_finalfn(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Period union
+ *
+ * The state keeps a flat array of periods whose first periods are sorted
+ * and normalized. The periods that arrive in order are merged directly
+ * into the normalized part, the other ones are appended after it and are
+ * sorted and merged with the normalized part when the state is full or
+ * when the aggregation ends.
+ *****************************************************************************/
+
+/**
+ * Comparator function for the periods of the state
+ */
+static int
+periodunion_cmp(const void *a, const void *b)
+{
+  return period_cmp_internal((const Period *) a, (const Period *) b);
+}
+
+/**
+ * Append a period to an array of normalized periods, merging it with the
+ * last period of the array if they overlap or are adjacent
+ *
+ * @param[in,out] periods Array of normalized periods
+ * @param[in,out] count Number of elements in the array
+ * @param[in] p Period to append
+ * @pre The lower bound of the period is not before the lower bound of the
+ * last period of the array
+ */
+static void
+periodarr_append_norm(Period *periods, int *count, const Period *p)
+{
+  if (*count > 0)
+  {
+    Period *last = &periods[*count - 1];
+    int cmp = timestamp_cmp_internal(last->upper, p->lower);
+    if (cmp > 0 || (cmp == 0 && (last->upper_inc || p->lower_inc)))
+    {
+      period_expand(last, p);
+      return;
+    }
+  }
+  periods[(*count)++] = *p;
+  return;
+}
+
+/**
+ * Sort the periods of the state that are not normalized and merge them
+ * with the normalized ones
+ */
+static void
+periodunion_compact(PeriodUnionState *state)
+{
+  if (state->normalized == state->count)
+    return;
+  int count1 = state->normalized;
+  int count2 = state->count - count1;
+  Period *tail = &state->periods[count1];
+  qsort(tail, (size_t) count2, sizeof(Period), &periodunion_cmp);
+  Period *merged = palloc(sizeof(Period) * state->count);
+  int i = 0, j = 0, k = 0;
+  while (i < count1 || j < count2)
+  {
+    if (j == count2 || (i < count1 &&
+      period_cmp_internal(&state->periods[i], &tail[j]) <= 0))
+      periodarr_append_norm(merged, &k, &state->periods[i++]);
+    else
+      periodarr_append_norm(merged, &k, &tail[j++]);
+  }
+  memcpy(state->periods, merged, sizeof(Period) * k);
+  pfree(merged);
+  state->count = state->normalized = k;
+  return;
+}
+
+/**
+ * Create a new state for period union aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] capacity Initial number of periods of the state
+ */
+static PeriodUnionState *
+periodunion_make(FunctionCallInfo fcinfo, int capacity)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  PeriodUnionState *result = palloc(sizeof(PeriodUnionState));
+  result->capacity = Max(capacity, PERIODUNION_INITIAL_CAPACITY);
+  result->count = 0;
+  result->normalized = 0;
+  result->periods = palloc(sizeof(Period) * result->capacity);
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Ensure that the state can hold the given number of additional periods.
+ * The periods of the state are compacted before growing the state, which
+ * keeps its size proportional to the number of periods of the result.
+ */
+static void
+periodunion_reserve(FunctionCallInfo fcinfo, PeriodUnionState *state,
+  int count)
+{
+  if (state->count + count <= state->capacity)
+    return;
+  periodunion_compact(state);
+  if (state->count + count <= state->capacity / 2)
+    return;
+  while (state->count + count > state->capacity / 2)
+    state->capacity <<= 1;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->periods = repalloc(state->periods, sizeof(Period) * state->capacity);
+  unset_aggregation_context(ctx);
+  return;
+}
+
+/**
+ * Add a period to the state
+ *
+ * @pre There is enough capacity in the state for the period
+ */
+static void
+periodunion_add(PeriodUnionState *state, const Period *p)
+{
+  bool inorder = (state->normalized == state->count);
+  if (inorder && state->count > 0)
+  {
+    Period *last = &state->periods[state->count - 1];
+    int cmp = timestamp_cmp_internal(last->lower, p->lower);
+    inorder = cmp < 0 || (cmp == 0 && (last->lower_inc || ! p->lower_inc));
+  }
+  if (inorder)
+  {
+    periodarr_append_norm(state->periods, &state->count, p);
+    state->normalized = state->count;
+  }
+  else
+    state->periods[state->count++] = *p;
+  return;
+}
+
+PG_FUNCTION_INFO_V1(period_union_transfn);
+/**
+ * Transition function for union aggregation of periods
+ */
+PGDLLEXPORT Datum
+period_union_transfn(PG_FUNCTION_ARGS)
+{
+  PeriodUnionState *state = PG_ARGISNULL(0) ? NULL :
+    (PeriodUnionState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  Period *p = PG_GETARG_PERIOD(1);
+  if (! state)
+    state = periodunion_make(fcinfo, 0);
+  periodunion_reserve(fcinfo, state, 1);
+  periodunion_add(state, p);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(periodset_union_transfn);
+/**
+ * Transition function for union aggregation of period sets
+ */
+PGDLLEXPORT Datum
+periodset_union_transfn(PG_FUNCTION_ARGS)
+{
+  PeriodUnionState *state = PG_ARGISNULL(0) ? NULL :
+    (PeriodUnionState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  PeriodSet *ps = PG_GETARG_PERIODSET(1);
+  if (! state)
+    state = periodunion_make(fcinfo, ps->count);
+  periodunion_reserve(fcinfo, state, ps->count);
+  for (int i = 0; i < ps->count; i++)
+    periodunion_add(state, periodset_per_n(ps, i));
+  PG_FREE_IF_COPY(ps, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(period_union_combinefn);
+/**
+ * Combine function for union aggregation of periods
+ */
+PGDLLEXPORT Datum
+period_union_combinefn(PG_FUNCTION_ARGS)
+{
+  PeriodUnionState *state1 = PG_ARGISNULL(0) ? NULL :
+    (PeriodUnionState *) PG_GETARG_POINTER(0);
+  PeriodUnionState *state2 = PG_ARGISNULL(1) ? NULL :
+    (PeriodUnionState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (state1 == NULL)
+    PG_RETURN_POINTER(state2);
+  if (state2 == NULL)
+    PG_RETURN_POINTER(state1);
+
+  periodunion_reserve(fcinfo, state1, state2->count);
+  memcpy(&state1->periods[state1->count], state2->periods,
+    sizeof(Period) * state2->count);
+  state1->count += state2->count;
+  PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(period_union_finalfn);
+/**
+ * Final function for union aggregation of periods
+ */
+PGDLLEXPORT Datum
+period_union_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  PeriodUnionState *state = (PeriodUnionState *) PG_GETARG_POINTER(0);
+  periodunion_compact(state);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+
+  Period **periods = palloc(sizeof(Period *) * state->count);
+  for (int i = 0; i < state->count; i++)
+    periods[i] = &state->periods[i];
+  PeriodSet *result = periodset_make(periods, state->count, NORMALIZE_NO);
+  pfree(periods);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(period_union_serialize);
+/**
+ * Serialize the state value of union aggregation of periods
+ */
+PGDLLEXPORT Datum
+period_union_serialize(PG_FUNCTION_ARGS)
+{
+  PeriodUnionState *state = (PeriodUnionState *) PG_GETARG_POINTER(0);
+  periodunion_compact(state);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  for (int i = 0; i < state->count; i++)
+  {
+    Period *p = &state->periods[i];
+    pq_sendint64(&buf, p->lower);
+    pq_sendint64(&buf, p->upper);
+    pq_sendbyte(&buf, p->lower_inc ? (uint8) 1 : (uint8) 0);
+    pq_sendbyte(&buf, p->upper_inc ? (uint8) 1 : (uint8) 0);
+  }
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(period_union_deserialize);
+/**
+ * Deserialize the state value of union aggregation of periods
+ */
+PGDLLEXPORT Datum
+period_union_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data),
+    .maxlen = VARSIZE(data)
+  };
+  int count = (int) pq_getmsgint(&buf, 4);
+  PeriodUnionState *result = periodunion_make(fcinfo, count);
+  for (int i = 0; i < count; i++)
+  {
+    Period *p = &result->periods[i];
+    p->lower = (TimestampTz) pq_getmsgint64(&buf);
+    p->upper = (TimestampTz) pq_getmsgint64(&buf);
+    p->lower_inc = (bool) pq_getmsgbyte(&buf);
+    p->upper_inc = (bool) pq_getmsgbyte(&buf);
+  }
+  result->count = result->normalized = count;
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Sequence aggregation
+ *
+ * The aggregation builds a temporal sequence from the rows of values and
+ * timestamps, which avoids to construct an array of instants as in
+ * tintseq(array_agg(tintinst(value, t) ORDER BY t)). The pairs of values and
+ * timestamps are accumulated in the order of the rows and are sorted by
+ * timestamp in the final function. If a gap is given, the sequence is split
+ * into a sequence set where two consecutive instants are separated by more
+ * than the gap.
+ *****************************************************************************/
+
+/**
+ * Create a new state for sequence aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] gap Maximum gap between the instants of a sequence in
+ * microseconds, 0 for no gap
+ * @param[in] capacity Initial number of pairs of the state
+ */
+static SeqAggState *
+seqagg_make(FunctionCallInfo fcinfo, Oid valuetypid, int64 gap, int capacity)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  SeqAggState *result = palloc(sizeof(SeqAggState));
+  result->valuetypid = valuetypid;
+  result->linear = base_type_info(valuetypid)->linear;
+  result->gap = gap;
+  result->capacity = Max(capacity, SEQAGG_INITIAL_CAPACITY);
+  result->count = 0;
+  result->pairs = palloc(sizeof(SeqAggPair) * result->capacity);
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Ensure that the state can hold the given number of additional pairs
+ */
+static void
+seqagg_reserve(FunctionCallInfo fcinfo, SeqAggState *state, int count)
+{
+  if (state->count + count <= state->capacity)
+    return;
+  while (state->count + count > state->capacity)
+    state->capacity <<= 1;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->pairs = repalloc(state->pairs, sizeof(SeqAggPair) * state->capacity);
+  unset_aggregation_context(ctx);
+  return;
+}
+
+PG_FUNCTION_INFO_V1(tsequence_agg_transfn);
+/**
+ * Transition function for sequence aggregation
+ */
+PGDLLEXPORT Datum
+tsequence_agg_transfn(PG_FUNCTION_ARGS)
+{
+  SeqAggState *state = PG_ARGISNULL(0) ? NULL :
+    (SeqAggState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+  Datum value = PG_GETARG_ANYDATUM(1);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(2);
+  if (tgeo_base_type(valuetypid))
+  {
+    GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(value);
+    ensure_point_type(gs);
+    ensure_non_empty(gs);
+    ensure_has_not_M_gs(gs);
+  }
+  if (! state)
+  {
+    int64 gap = (PG_NARGS() > 3 && ! PG_ARGISNULL(3)) ?
+      interval_units(PG_GETARG_INTERVAL_P(3)) : 0;
+    state = seqagg_make(fcinfo, valuetypid, gap, 0);
+  }
+  seqagg_reserve(fcinfo, state, 1);
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  SeqAggPair *pair = &state->pairs[state->count++];
+  pair->t = t;
+  pair->value = datum_copy(value, valuetypid);
+  unset_aggregation_context(ctx);
+  DATUM_FREE_IF_COPY(value, valuetypid, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tsequence_agg_combinefn);
+/**
+ * Combine function for sequence aggregation
+ */
+PGDLLEXPORT Datum
+tsequence_agg_combinefn(PG_FUNCTION_ARGS)
+{
+  SeqAggState *state1 = PG_ARGISNULL(0) ? NULL :
+    (SeqAggState *) PG_GETARG_POINTER(0);
+  SeqAggState *state2 = PG_ARGISNULL(1) ? NULL :
+    (SeqAggState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (state1 == NULL)
+    PG_RETURN_POINTER(state2);
+  if (state2 == NULL)
+    PG_RETURN_POINTER(state1);
+
+  seqagg_reserve(fcinfo, state1, state2->count);
+  memcpy(&state1->pairs[state1->count], state2->pairs,
+    sizeof(SeqAggPair) * state2->count);
+  state1->count += state2->count;
+  PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(tsequence_agg_finalfn);
+/**
+ * Final function for sequence aggregation
+ */
+PGDLLEXPORT Datum
+tsequence_agg_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  SeqAggState *state = (SeqAggState *) PG_GETARG_POINTER(0);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+
+  TInstant **instants = palloc(sizeof(TInstant *) * state->count);
+  for (int i = 0; i < state->count; i++)
+    instants[i] = tinstant_make(state->pairs[i].value, state->pairs[i].t,
+      state->valuetypid);
+  tinstantarr_sort(instants, state->count);
+  int count = tinstantarr_remove_duplicates(instants, state->count);
+  Temporal *result;
+  if (state->gap == 0)
+    result = (Temporal *) tsequence_make(instants, count, true, true,
+      state->linear, NORMALIZE);
+  else
+  {
+    TSequence **sequences = palloc(sizeof(TSequence *) * count);
+    int k = 0, start = 0;
+    for (int i = 1; i <= count; i++)
+    {
+      if (i == count || instants[i]->t - instants[i - 1]->t > state->gap)
+      {
+        sequences[k++] = tsequence_make(&instants[start], i - start, true,
+          true, state->linear, NORMALIZE);
+        start = i;
+      }
+    }
+    result = (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE_NO);
+  }
+  pfree(instants);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tsequence_agg_serialize);
+/**
+ * Serialize the state value of sequence aggregation
+ */
+PGDLLEXPORT Datum
+tsequence_agg_serialize(PG_FUNCTION_ARGS)
+{
+  SeqAggState *state = (SeqAggState *) PG_GETARG_POINTER(0);
+  bool byval = get_typbyval_fast(state->valuetypid);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->valuetypid, 4);
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->valuetypid);
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  pq_sendint64(&buf, state->gap);
+  for (int i = 0; i < state->count; i++)
+  {
+    SeqAggPair *pair = &state->pairs[i];
+    pq_sendint64(&buf, pair->t);
+    if (byval)
+      pq_sendint64(&buf, (int64) pair->value);
+    else
+    {
+      /* The values passed by reference are varlenas */
+      int size = (int) VARSIZE(DatumGetPointer(pair->value));
+#if MOBDB_PGSQL_VERSION < 110000
+      pq_sendint(&buf, (uint32) size, 4);
+#else
+      pq_sendint32(&buf, (uint32) size);
+#endif
+      pq_sendbytes(&buf, DatumGetPointer(pair->value), size);
+    }
+  }
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(tsequence_agg_deserialize);
+/**
+ * Deserialize the state value of sequence aggregation
+ */
+PGDLLEXPORT Datum
+tsequence_agg_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data),
+    .maxlen = VARSIZE(data)
+  };
+  Oid valuetypid = (Oid) pq_getmsgint(&buf, 4);
+  int count = (int) pq_getmsgint(&buf, 4);
+  int64 gap = pq_getmsgint64(&buf);
+  bool byval = get_typbyval_fast(valuetypid);
+  SeqAggState *result = seqagg_make(fcinfo, valuetypid, gap, count);
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  for (int i = 0; i < count; i++)
+  {
+    SeqAggPair *pair = &result->pairs[i];
+    pair->t = (TimestampTz) pq_getmsgint64(&buf);
+    if (byval)
+      pair->value = (Datum) pq_getmsgint64(&buf);
+    else
+    {
+      int size = (int) pq_getmsgint(&buf, 4);
+      void *value = palloc(size);
+      memcpy(value, pq_getmsgbytes(&buf, size), size);
+      pair->value = PointerGetDatum(value);
+    }
+  }
+  unset_aggregation_context(ctx);
+  result->count = count;
+  PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************/
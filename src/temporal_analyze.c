@@ -38,10 +38,45 @@
  *     - `staop` contains the "<" operator of the time dimension.
  *     - `stavalues` stores the length of the histogram of periods for the time dimension.
  *     - `numvalues` contains the number of buckets in the histogram.
+ *     - `stanumbers` stores the average number of instants and of sequences
+ *       of the temporal values, which are used for estimating the number of
+ *       rows returned by the set-returning functions such as unnestInstants.
  *
  * In the case of temporal types having a Period as bounding box, that is,
  * tbool and ttext, no statistics are collected for the value dimension and
- * the statistics for the temporal part are stored in slots 1 and 2.
+ * the statistics for the temporal part are stored in slots 1 and 2. The
+ * base values taken by the temporal values are collected instead for the
+ * selectivity of the ever/always comparisons.
+ * - Slot 3
+ *     - `stakind` contains the type of statistics which is `STATISTIC_KIND_EVER_VALUES`.
+ *     - `staop` contains the "=" operator of the base type.
+ *     - `stavalues` stores the most common base values, where the values
+ *       taken several times by a temporal value are counted once.
+ *     - `stanumbers` stores the fraction of non-null rows taking each value,
+ *       followed by the fraction assumed for the values not in the list.
+ * - Slot 4
+ *     - `stakind` contains the type of statistics which is `STATISTIC_KIND_ALWAYS_VALUES`.
+ *     - `staop` contains the "=" operator of the base type.
+ *     - `stavalues` stores the most common values of the temporal values
+ *       that take a single base value.
+ *     - `stanumbers` stores the fraction of non-null rows that always take
+ *       each value, followed by the fraction assumed for the other values.
+ *
+ * For temporal numbers, the ever/always comparisons are estimated with the
+ * histogram of the value ranges, whose bounds are the minimum and the
+ * maximum value of each temporal value.
+ *
+ * Since the histograms of the value and the time dimensions are independent,
+ * a joint histogram is also collected for temporal numbers.
+ * - Slot 5
+ *     - `stakind` contains the type of statistics which is `STATISTIC_KIND_NDT`.
+ *     - `stanumbers` stores the 2D histogram of occurrence of the bounding
+ *       boxes, where the first dimension is the value dimension and the
+ *       second one is the time dimension expressed in seconds.
+ *
+ * The statistics are computed from the bounding box and the period of the
+ * sampled values, which are read from the beginning of toasted values
+ * without detoasting them.
  */
 
 #include "temporal_analyze.h"
@@ -71,9 +106,11 @@
 #include "time_analyze.h"
 #include "rangetypes_ext.h"
 #include "temporaltypes.h"
+#include "tbox.h"
 #include "oidcache.h"
 #include "temporal_util.h"
 #include "temporal_analyze.h"
+#include "tpoint_analyze.h"
 
 /*
  * To avoid consuming too much memory, IO and CPU load during analysis, and/or
@@ -275,6 +312,33 @@ range_compute_stats(VacAttrStats *stats, int non_null_cnt, int *slot_idx,
   MemoryContextSwitchTo(old_cxt);
 }
 
+/**
+ * Store the average number of instants and of sequences of the temporal
+ * values in the slot of the histogram of period lengths
+ *
+ * @param[in,out] stats Structure storing statistics information
+ * @param[in] ninsts Average number of instants
+ * @param[in] nseqs Average number of sequences
+ */
+void
+temporal_count_stats(VacAttrStats *stats, double ninsts, double nseqs)
+{
+  for (int i = 0; i < STATISTIC_NUM_SLOTS; i++)
+  {
+    if (stats->stakind[i] != STATISTIC_KIND_PERIOD_LENGTH_HISTOGRAM)
+      continue;
+    MemoryContext old_cxt = MemoryContextSwitchTo(stats->anl_context);
+    float4 *numbers = palloc(sizeof(float4) * 2);
+    MemoryContextSwitchTo(old_cxt);
+    numbers[0] = (float4) ninsts;
+    numbers[1] = (float4) nseqs;
+    stats->stanumbers[i] = numbers;
+    stats->numnumbers[i] = 2;
+    return;
+  }
+  return;
+}
+
 /**
  * Compute statistics for temporal columns
  *
@@ -300,7 +364,9 @@ temp_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
        *value_uppers;
   PeriodBound *time_lowers,
        *time_uppers;
-  double total_width = 0;
+  double total_width = 0,
+       total_insts = 0,
+       total_seqs = 0;
   Oid   rangetypid = 0; /* make compiler quiet */
   TypeCacheEntry *typcache;
 
@@ -333,7 +399,6 @@ temp_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
     Period period;
     PeriodBound period_lower,
         period_upper;
-    Temporal *temp;
 
     /* Give backend a chance of interrupting us */
     vacuum_delay_point();
@@ -346,15 +411,29 @@ temp_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
       continue;
     }
 
-    total_width += VARSIZE(value);
-
-    /* Get Temporal value */
-    temp = DatumGetTemporal(value);
+    total_width += VARSIZE_ANY(DatumGetPointer(value));
+    int ninsts, nseqs;
+    temporal_counts_slice(&ninsts, &nseqs, value);
+    total_insts += ninsts;
+    total_seqs += nseqs;
 
-    /* Remember bounds and length for further usage in histograms */
+    /*
+     * Remember bounds and length for further usage in histograms. They are
+     * obtained from the bounding box and the period of the temporal value,
+     * which are fetched without detoasting the whole value.
+     */
     if (valuestats)
     {
-      RangeType *range = tnumber_value_range_internal(temp);
+      TBOX box;
+      RangeType *range;
+      memset(&box, 0, sizeof(TBOX));
+      temporal_bbox_slice(&box, value);
+      if (temporal_extra_data->value_type_id == INT4OID)
+        range = range_make(Int32GetDatum((int) box.xmin),
+          Int32GetDatum((int) box.xmax), true, true, INT4OID);
+      else /* temporal_extra_data->value_type_id == FLOAT8OID */
+        range = range_make(Float8GetDatum(box.xmin),
+          Float8GetDatum(box.xmax), true, true, FLOAT8OID);
       range_deserialize(typcache, range, &range_lower, &range_upper, &isempty);
       value_lowers[non_null_cnt] = range_lower;
       value_uppers[non_null_cnt] = range_upper;
@@ -366,7 +445,7 @@ temp_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
         value_lengths[non_null_cnt] = DatumGetFloat8(range_upper.val) -
           DatumGetFloat8(range_lower.val);
     }
-    temporal_period(&period, temp);
+    temporal_period_slice(&period, value);
     period_deserialize(&period, &period_lower, &period_upper);
     time_lowers[non_null_cnt] = period_lower;
     time_uppers[non_null_cnt] = period_upper;
@@ -395,6 +474,8 @@ temp_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 
     period_compute_stats1(stats, non_null_cnt, &slot_idx,
       time_lowers, time_uppers, time_lengths);
+    temporal_count_stats(stats, total_insts / non_null_cnt,
+      total_seqs / non_null_cnt);
   }
   else if (null_cnt > 0)
   {
@@ -413,6 +494,179 @@ temp_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   return;
 }
 
+/*****************************************************************************
+ * Statistics of the base values
+ *****************************************************************************/
+
+/**
+ * Structure to represent a base value and the number of rows taking it
+ */
+typedef struct
+{
+  Datum value;  /**< base value */
+  int count;    /**< number of rows */
+} ValueCount;
+
+/**
+ * Comparator function for sorting the base values by decreasing count
+ */
+static int
+value_count_cmp(const void *a, const void *b)
+{
+  int count1 = ((const ValueCount *) a)->count;
+  int count2 = ((const ValueCount *) b)->count;
+  return (count1 > count2) ? -1 : ((count1 < count2) ? 1 : 0);
+}
+
+/**
+ * Store in a slot the most common base values and their frequencies
+ *
+ * @param[in] stats Structure storing statistics information
+ * @param[in,out] slot_idx Index of the slot where the statistics are stored
+ * @param[in] kind Kind of the statistics
+ * @param[in] values Base values, where each row contributes each of its
+ * values at most once. The array is sorted by the function.
+ * @param[in] count Number of elements in the array
+ * @param[in] nrows Number of rows from which the values are collected
+ */
+static void
+value_mcv_stats(VacAttrStats *stats, int *slot_idx, int kind, Datum *values,
+  int count, int nrows)
+{
+  Oid valuetypid = temporal_extra_data->value_type_id;
+  int num_mcv = stats->attr->attstattarget;
+  ValueCount *counts = palloc(sizeof(ValueCount) * Max(count, 1));
+  int ndistinct = 0;
+
+  /* Count the rows taking each distinct value */
+  datumarr_sort(values, count, valuetypid);
+  for (int i = 0; i < count; i++)
+  {
+    if (ndistinct > 0 &&
+      datum_eq(counts[ndistinct - 1].value, values[i], valuetypid))
+      counts[ndistinct - 1].count++;
+    else
+    {
+      counts[ndistinct].value = values[i];
+      counts[ndistinct++].count = 1;
+    }
+  }
+  qsort(counts, (size_t) ndistinct, sizeof(ValueCount), &value_count_cmp);
+  if (num_mcv > ndistinct)
+    num_mcv = ndistinct;
+
+  /* Must copy the target values into anl_context */
+  MemoryContext old_cxt = MemoryContextSwitchTo(stats->anl_context);
+  Datum *mcv_values = palloc(sizeof(Datum) * Max(num_mcv, 1));
+  float4 *mcv_freqs = palloc(sizeof(float4) * (num_mcv + 1));
+  for (int i = 0; i < num_mcv; i++)
+  {
+    mcv_values[i] = datumCopy(counts[i].value,
+      temporal_extra_data->value_typbyval, temporal_extra_data->value_typlen);
+    mcv_freqs[i] = (float4) counts[i].count / (float4) nrows;
+  }
+  /*
+   * The values that are not in the list are assumed to be less frequent
+   * than the least frequent of the values that were left out, or than a
+   * value found in one row when all the values are in the list
+   */
+  mcv_freqs[num_mcv] = (float4) (0.5 *
+    ((num_mcv < ndistinct) ? counts[num_mcv].count : 1) / nrows);
+  MemoryContextSwitchTo(old_cxt);
+
+  stats->stakind[*slot_idx] = (int16) kind;
+  stats->staop[*slot_idx] = temporal_extra_data->value_eq_opr;
+  stats->stavalues[*slot_idx] = mcv_values;
+  stats->numvalues[*slot_idx] = num_mcv;
+  stats->stanumbers[*slot_idx] = mcv_freqs;
+  stats->numnumbers[*slot_idx] = num_mcv + 1;
+  stats->statypid[*slot_idx] = valuetypid;
+  stats->statyplen[*slot_idx] = temporal_extra_data->value_typlen;
+  stats->statypbyval[*slot_idx] = temporal_extra_data->value_typbyval;
+  stats->statypalign[*slot_idx] = temporal_extra_data->value_typalign;
+  (*slot_idx)++;
+  pfree(counts);
+  return;
+}
+
+/**
+ * Compute the statistics of the base values taken by the temporal values,
+ * which are used for estimating the selectivity of the ever/always
+ * comparisons
+ *
+ * Contrary to the other statistics, the temporal values must be detoasted
+ * to read their instants, the values wider than TEMPORAL_WIDTH_THRESHOLD
+ * are thus ignored.
+ *
+ * @param[in] stats Structure storing statistics information
+ * @param[in] fetchfunc Fetch function
+ * @param[in] samplerows Number of sample rows
+ * @param[in,out] slot_idx Index of the first slot where the statistics are
+ * stored
+ */
+static void
+value_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
+  int samplerows, int *slot_idx)
+{
+  Oid valuetypid = temporal_extra_data->value_type_id;
+  int capacity = samplerows, nrows = 0, never = 0, nalways = 0;
+  Datum *ever = palloc(sizeof(Datum) * capacity);
+  Datum *always = palloc(sizeof(Datum) * samplerows);
+
+  for (int i = 0; i < samplerows; i++)
+  {
+    bool isnull;
+
+    /* Give backend a chance of interrupting us */
+    vacuum_delay_point();
+
+    Datum value = fetchfunc(stats, i, &isnull);
+    if (isnull || VARSIZE_ANY(DatumGetPointer(value)) > TEMPORAL_WIDTH_THRESHOLD)
+      continue;
+
+    /* Distinct base values of the temporal value */
+    Temporal *temp = DatumGetTemporal(value);
+    Datum *values = palloc(sizeof(Datum) *
+      temporal_num_instants_internal(temp));
+    TInstantIterator iter;
+    const TInstant *inst;
+    int count = 0;
+    tinstant_iterator_init(&iter, temp);
+    while ((inst = tinstant_iterator_next(&iter)) != NULL)
+      values[count++] = tinstant_value(inst);
+    datumarr_sort(values, count, valuetypid);
+    count = datumarr_remove_duplicates(values, count, valuetypid);
+
+    if (never + count > capacity)
+    {
+      while (never + count > capacity)
+        capacity <<= 1;
+      ever = repalloc(ever, sizeof(Datum) * capacity);
+    }
+    for (int j = 0; j < count; j++)
+      ever[never++] = datumCopy(values[j], temporal_extra_data->value_typbyval,
+        temporal_extra_data->value_typlen);
+    if (count == 1)
+      always[nalways++] = ever[never - 1];
+    nrows++;
+
+    pfree(values);
+    if ((Pointer) temp != DatumGetPointer(value))
+      pfree(temp);
+  }
+
+  /* As for the ranges, the frequencies are fractions of the non-null rows */
+  if (nrows > 0)
+  {
+    value_mcv_stats(stats, slot_idx, STATISTIC_KIND_EVER_VALUES, ever, never,
+      nrows);
+    value_mcv_stats(stats, slot_idx, STATISTIC_KIND_ALWAYS_VALUES, always,
+      nalways, nrows);
+  }
+  pfree(ever); pfree(always);
+  return;
+}
+
 /*****************************************************************************
  * Statistics functions for temporal types
  *****************************************************************************/
@@ -491,8 +745,8 @@ temporal_extra_info(VacAttrStats *stats)
 /*****************************************************************************/
 
 /**
- * Compute the statistics for temporal columns where only the time dimension
- * is considered
+ * Compute the statistics for temporal columns where the time dimension and
+ * the base values are considered
  *
  * @param[in] stats Structure storing statistics information
  * @param[in] fetchfunc Fetch function
@@ -503,7 +757,17 @@ void
 temporal_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   int samplerows, double totalrows)
 {
-  return temp_compute_stats(stats, fetchfunc, samplerows, false);
+  temp_compute_stats(stats, fetchfunc, samplerows, false);
+  if (! stats->stats_valid || stats->stanullfrac >= 1.0)
+    return;
+
+  /* The base values are stored in the slots after the ones of the time */
+  int slot_idx = 0;
+  while (slot_idx < STATISTIC_NUM_SLOTS && stats->stakind[slot_idx] != 0)
+    slot_idx++;
+  if (slot_idx + 2 <= STATISTIC_NUM_SLOTS)
+    value_compute_stats(stats, fetchfunc, samplerows, &slot_idx);
+  return;
 }
 
 /**
@@ -513,7 +777,21 @@ void
 tnumber_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
   int samplerows, double totalrows)
 {
-  return temp_compute_stats(stats, fetchfunc, samplerows, true);
+  float4 stadistinct;
+  temp_compute_stats(stats, fetchfunc, samplerows, true);
+  if (! stats->stats_valid || stats->stanullfrac >= 1.0)
+    return;
+
+  /*
+   * Joint histogram of the value and time dimensions. The function sets
+   * again the simple stats, the estimate of distinct values is kept, as
+   * well as the other slots if no histogram can be built.
+   */
+  stadistinct = stats->stadistinct;
+  gserialized_compute_stats(stats, fetchfunc, samplerows, totalrows, 4);
+  stats->stadistinct = stadistinct;
+  stats->stats_valid = true;
+  return;
 }
 
 /**
@@ -552,8 +830,8 @@ generic_analyze(FunctionCallInfo fcinfo,
 
 PG_FUNCTION_INFO_V1(temporal_analyze);
 /**
- * Compute the statistics for temporal columns where only the time dimension
- * is considered
+ * Compute the statistics for temporal columns where the time dimension and
+ * the base values are considered
  */
 PGDLLEXPORT Datum
 temporal_analyze(PG_FUNCTION_ARGS)
@@ -0,0 +1,506 @@
+/*****************************************************************************
+ *
+ * temporal_arrow.c
+ *    Columnar export of temporal values in the memory layout of Apache Arrow
+ *
+ * The aggregate function asArrow writes the instants of a batch of temporal
+ * values into a single buffer whose columns have the memory layout of an
+ * Apache Arrow array of type list<struct<t: timestamp[us, UTC], value>>
+ * for temporal numbers and list<struct<t: timestamp[us, UTC], x, y[, z]>>
+ * for temporal points, so that a reader can wrap the columns in Arrow
+ * arrays without copying nor parsing them. The buffer is made of a header
+ * followed by the buffers of the arrays, each one starting at a multiple
+ * of ARROW_ALIGNMENT bytes from the start of the data. All numbers are in
+ * the byte order of the server.
+ * @code
+ * int32   version (currently 1)
+ * int32   base type (2 = int4, 3 = float8, 5 = geometry, 6 = geography)
+ * int32   number of value columns (1 for numbers, 2 or 3 for points)
+ * int32   SRID, 0 for temporal numbers
+ * int32   number of temporal values
+ * int32   number of instants
+ * int32   offsets of the list array, that is, for each temporal value the
+ *         position of its first instant, followed by the number of instants
+ * int64   timestamps of the instants, in microseconds since '1970-01-01'
+ * ...     one column per coordinate, or a single column of int32 or float8
+ *         values for temporal numbers
+ * @endcode
+ * The interpolation and the bounds of the sequences are not exported. The
+ * functions tintFromArrow, tfloatFromArrow, tgeompointFromArrow, and
+ * tgeogpointFromArrow read a buffer in this format and return for each
+ * element of the list array its position and a temporal sequence, or a
+ * temporal sequence set when a maximum gap between the instants is given,
+ * with the default interpolation of the base type.
+ * The Arrow IPC format would additionally require the schema and the
+ * record batch metadata encoded with FlatBuffers, which the reader can
+ * build from the header.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_arrow.h"
+
+#include <assert.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/timestamp.h>
+
+#include "oidcache.h"
+#include "temporal_aggfuncs.h"
+#include "temporal_tile.h"
+#include "temporal_util.h"
+#include "temporal_wire.h"
+#include "tinstant.h"
+#include "tinstantset.h"
+#include "tsequence.h"
+#include "tsequenceset.h"
+
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * State of the export
+ *****************************************************************************/
+
+/**
+ * Returns the code of the base type in the columnar format
+ */
+static int32
+arrow_type_code(Oid valuetypid)
+{
+  if (valuetypid == INT4OID)
+    return WIRE_TYPE_INT4;
+  if (valuetypid == FLOAT8OID)
+    return WIRE_TYPE_FLOAT8;
+  if (valuetypid == type_oid(T_GEOGRAPHY))
+    return WIRE_TYPE_GEOGRAPHY;
+  return WIRE_TYPE_GEOMETRY;
+}
+
+/**
+ * Returns a new state for the export of temporal values of the base type
+ */
+static ArrowState *
+arrowstate_make(const Temporal *temp)
+{
+  ArrowState *result = palloc0(sizeof(ArrowState));
+  result->valuetypid = temp->valuetypid;
+  if (tgeo_base_type(temp->valuetypid))
+  {
+    result->srid = tpoint_srid_internal(temp);
+    result->ncols = MOBDB_FLAGS_GET_Z(temp->flags) ? 3 : 2;
+    result->valuesize = sizeof(double);
+  }
+  else
+  {
+    ensure_tnumber_base_type(temp->valuetypid);
+    result->ncols = 1;
+    result->valuesize = (temp->valuetypid == INT4OID) ?
+      sizeof(int32) : sizeof(double);
+  }
+  result->maxcount = 64;
+  result->offsets = palloc(sizeof(int32) * (result->maxcount + 1));
+  result->offsets[0] = 0;
+  result->maxinsts = 64;
+  result->times = palloc(sizeof(int64) * result->maxinsts);
+  for (int i = 0; i < result->ncols; i++)
+    result->values[i] = palloc(result->valuesize * result->maxinsts);
+  return result;
+}
+
+/**
+ * Ensures that the temporal value can be exported with the previous ones
+ */
+static void
+arrowstate_ensure_valid(const ArrowState *state, const Temporal *temp)
+{
+  if (! tgeo_base_type(state->valuetypid))
+    return;
+  if (state->srid != tpoint_srid_internal(temp))
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The temporal points must be in the same SRID")));
+  if (state->ncols != (MOBDB_FLAGS_GET_Z(temp->flags) ? 3 : 2))
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The temporal points must be of the same dimensionality")));
+  return;
+}
+
+/**
+ * Appends the instant to the columns of the state
+ *
+ * @pre There is space for the instant in the columns
+ */
+static void
+arrowstate_add_inst(ArrowState *state, const TInstant *inst)
+{
+  int n = state->ninsts++;
+  state->times[n] = inst->t + ARROW_EPOCH_OFFSET;
+  Datum value = tinstant_value(inst);
+  if (state->valuetypid == INT4OID)
+    ((int32 *) state->values[0])[n] = DatumGetInt32(value);
+  else if (state->valuetypid == FLOAT8OID)
+    ((double *) state->values[0])[n] = DatumGetFloat8(value);
+  else if (state->ncols == 3)
+  {
+    const POINT3DZ *point = datum_get_point3dz_p(value);
+    ((double *) state->values[0])[n] = point->x;
+    ((double *) state->values[1])[n] = point->y;
+    ((double *) state->values[2])[n] = point->z;
+  }
+  else
+  {
+    const POINT2D *point = datum_get_point2d_p(value);
+    ((double *) state->values[0])[n] = point->x;
+    ((double *) state->values[1])[n] = point->y;
+  }
+  return;
+}
+
+/**
+ * Appends the instants of the temporal value to the columns of the state
+ * as a new element of the list array, the state is created if it is NULL
+ */
+ArrowState *
+arrowstate_add(ArrowState *state, const Temporal *temp)
+{
+  if (! state)
+    state = arrowstate_make(temp);
+  else
+    arrowstate_ensure_valid(state, temp);
+
+  /* Enlarge the arrays if needed */
+  int ninsts = temporal_num_instants_internal(temp);
+  if (state->count == state->maxcount)
+  {
+    state->maxcount *= 2;
+    state->offsets = repalloc(state->offsets,
+      sizeof(int32) * (state->maxcount + 1));
+  }
+  if (state->ninsts + ninsts > state->maxinsts)
+  {
+    while (state->ninsts + ninsts > state->maxinsts)
+      state->maxinsts *= 2;
+    state->times = repalloc(state->times, sizeof(int64) * state->maxinsts);
+    for (int i = 0; i < state->ncols; i++)
+      state->values[i] = repalloc(state->values[i],
+        state->valuesize * state->maxinsts);
+  }
+
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    arrowstate_add_inst(state, (const TInstant *) temp);
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+      arrowstate_add_inst(state, tinstantset_inst_n(ti, i));
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    for (int i = 0; i < seq->count; i++)
+      arrowstate_add_inst(state, tsequence_inst_n(seq, i));
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+    {
+      const TSequence *seq = tsequenceset_seq_n(ts, i);
+      for (int j = 0; j < seq->count; j++)
+        arrowstate_add_inst(state, tsequence_inst_n(seq, j));
+    }
+  }
+  state->offsets[++state->count] = state->ninsts;
+  return state;
+}
+
+/*****************************************************************************
+ * Output of the columns
+ *****************************************************************************/
+
+/**
+ * Copies the buffer at the position of the data and returns the position
+ * following it, aligned on ARROW_ALIGNMENT bytes
+ */
+static size_t
+arrow_write_buffer(char *data, size_t pos, const void *buffer, size_t size)
+{
+  memcpy(data + pos, buffer, size);
+  return pos + (size_t) TYPEALIGN(ARROW_ALIGNMENT, size);
+}
+
+/**
+ * Returns the buffer with the header and the columns of the state
+ */
+bytea *
+arrowstate_write(const ArrowState *state)
+{
+  size_t offsetsize = sizeof(int32) * (state->count + 1);
+  size_t timesize = sizeof(int64) * state->ninsts;
+  size_t colsize = state->valuesize * state->ninsts;
+  size_t size = ARROW_HEADER_SIZE + TYPEALIGN(ARROW_ALIGNMENT, offsetsize) +
+    TYPEALIGN(ARROW_ALIGNMENT, timesize) +
+    state->ncols * TYPEALIGN(ARROW_ALIGNMENT, colsize);
+  bytea *result = palloc0(VARHDRSZ + size);
+  SET_VARSIZE(result, VARHDRSZ + size);
+
+  char *data = VARDATA(result);
+  int32 header[ARROW_HEADER_SIZE / sizeof(int32)];
+  header[0] = ARROW_VERSION;
+  header[1] = arrow_type_code(state->valuetypid);
+  header[2] = state->ncols;
+  header[3] = state->srid;
+  header[4] = state->count;
+  header[5] = state->ninsts;
+  size_t pos = arrow_write_buffer(data, 0, header, ARROW_HEADER_SIZE);
+  pos = arrow_write_buffer(data, pos, state->offsets, offsetsize);
+  pos = arrow_write_buffer(data, pos, state->times, timesize);
+  for (int i = 0; i < state->ncols; i++)
+    pos = arrow_write_buffer(data, pos, state->values[i], colsize);
+  assert(pos == size);
+  return result;
+}
+
+/*****************************************************************************
+ * Aggregate functions
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(temporal_arrow_transfn);
+/**
+ * Transition function for the columnar export of temporal values
+ */
+PGDLLEXPORT Datum
+temporal_arrow_transfn(PG_FUNCTION_ARGS)
+{
+  ArrowState *state = PG_ARGISNULL(0) ? NULL :
+    (ArrowState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (! state)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(state);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state = arrowstate_add(state, temp);
+  unset_aggregation_context(ctx);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_arrow_finalfn);
+/**
+ * Final function for the columnar export of temporal values
+ */
+PGDLLEXPORT Datum
+temporal_arrow_finalfn(PG_FUNCTION_ARGS)
+{
+  ArrowState *state = (ArrowState *) PG_GETARG_POINTER(0);
+  PG_RETURN_BYTEA_P(arrowstate_write(state));
+}
+
+/*****************************************************************************
+ * Input of the columns
+ *****************************************************************************/
+
+/**
+ * Raise an error for an invalid buffer in the columnar format
+ */
+static void
+arrow_invalid(const char *msg)
+{
+  ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+    errmsg("Invalid buffer in the columnar format: %s", msg)));
+}
+
+/**
+ * Reads the header of the buffer in the columnar format into the state and
+ * ensures that the buffer is valid
+ */
+void
+arrowread_init(ArrowReadState *state, const bytea *buffer, Oid valuetypid)
+{
+  size_t size = VARSIZE(buffer) - VARHDRSZ;
+  const char *data = VARDATA(buffer);
+  int32 header[ARROW_HEADER_SIZE / sizeof(int32)];
+  if (size < ARROW_HEADER_SIZE)
+    arrow_invalid("the buffer is too short");
+  memcpy(header, data, ARROW_HEADER_SIZE);
+  if (header[0] != ARROW_VERSION)
+    arrow_invalid("unknown version");
+  if (header[1] != arrow_type_code(valuetypid))
+    arrow_invalid("the base type does not match the temporal type");
+  int ncols = header[2];
+  if ((tgeo_base_type(valuetypid) && ncols != 2 && ncols != 3) ||
+    (! tgeo_base_type(valuetypid) && ncols != 1))
+    arrow_invalid("wrong number of value columns");
+  int count = header[4], ninsts = header[5];
+  if (count < 0 || ninsts < 0)
+    arrow_invalid("negative number of elements");
+
+  state->valuetypid = valuetypid;
+  state->srid = header[3];
+  state->ncols = ncols;
+  state->valuesize = (valuetypid == INT4OID) ? sizeof(int32) : sizeof(double);
+  state->count = count;
+  state->ninsts = ninsts;
+  size_t offsetsize = sizeof(int32) * ((size_t) count + 1);
+  size_t timesize = sizeof(int64) * (size_t) ninsts;
+  size_t colsize = state->valuesize * (size_t) ninsts;
+  if (size != ARROW_HEADER_SIZE + TYPEALIGN(ARROW_ALIGNMENT, offsetsize) +
+      TYPEALIGN(ARROW_ALIGNMENT, timesize) +
+      ncols * TYPEALIGN(ARROW_ALIGNMENT, colsize))
+    arrow_invalid("the size does not match the number of elements");
+
+  /* The buffers may not be aligned in memory and are thus copied */
+  const char *pos = data + ARROW_HEADER_SIZE;
+  state->offsets = palloc(offsetsize);
+  memcpy(state->offsets, pos, offsetsize);
+  pos += TYPEALIGN(ARROW_ALIGNMENT, offsetsize);
+  state->times = palloc(Max(timesize, 1));
+  memcpy(state->times, pos, timesize);
+  pos += TYPEALIGN(ARROW_ALIGNMENT, timesize);
+  for (int i = 0; i < ncols; i++)
+  {
+    state->values[i] = palloc(Max(colsize, 1));
+    memcpy(state->values[i], pos, colsize);
+    pos += TYPEALIGN(ARROW_ALIGNMENT, colsize);
+  }
+  if (state->offsets[0] != 0 || state->offsets[count] != ninsts)
+    arrow_invalid("wrong offsets");
+  for (int i = 0; i < count; i++)
+  {
+    if (state->offsets[i + 1] <= state->offsets[i])
+      arrow_invalid("the offsets must be increasing");
+  }
+  state->i = 0;
+  return;
+}
+
+/**
+ * Returns the base value of the n-th instant of the columns
+ */
+static Datum
+arrowread_value(const ArrowReadState *state, int n)
+{
+  if (state->valuetypid == INT4OID)
+    return Int32GetDatum(((int32 *) state->values[0])[n]);
+  if (state->valuetypid == FLOAT8OID)
+    return Float8GetDatum(((double *) state->values[0])[n]);
+  double x = ((double *) state->values[0])[n];
+  double y = ((double *) state->values[1])[n];
+  LWPOINT *lwpoint = (state->ncols == 3) ?
+    lwpoint_make3dz(state->srid, x, y, ((double *) state->values[2])[n]) :
+    lwpoint_make2d(state->srid, x, y);
+  FLAGS_SET_GEODETIC(lwpoint->flags,
+    state->valuetypid == type_oid(T_GEOGRAPHY));
+  Datum result = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
+  lwpoint_free(lwpoint);
+  return result;
+}
+
+/**
+ * Returns the temporal value of the n-th element of the list array, which
+ * is split into a sequence set when two consecutive instants are separated
+ * by more than the gap, if any
+ */
+static Temporal *
+arrowread_temporal(const ArrowReadState *state, int n, int64 gap)
+{
+  int start = state->offsets[n], count = state->offsets[n + 1] - start;
+  TimestampTz *times = palloc(sizeof(TimestampTz) * count);
+  Datum *values = palloc(sizeof(Datum) * count);
+  for (int i = 0; i < count; i++)
+  {
+    times[i] = state->times[start + i] - ARROW_EPOCH_OFFSET;
+    values[i] = arrowread_value(state, start + i);
+  }
+  bool linear = base_type_info(state->valuetypid)->linear;
+  Temporal *result;
+  if (gap == 0)
+    result = (Temporal *) tsequence_from_arrays(times, values, count,
+      state->valuetypid, true, true, linear, NORMALIZE);
+  else
+  {
+    TSequence **sequences = palloc(sizeof(TSequence *) * count);
+    int k = 0, first = 0;
+    for (int i = 1; i <= count; i++)
+    {
+      if (i == count || times[i] - times[i - 1] > gap)
+      {
+        sequences[k++] = tsequence_from_arrays(&times[first], &values[first],
+          i - first, state->valuetypid, true, true, linear, NORMALIZE);
+        first = i;
+      }
+    }
+    result = (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE_NO);
+  }
+  if (tgeo_base_type(state->valuetypid))
+  {
+    for (int i = 0; i < count; i++)
+      pfree(DatumGetPointer(values[i]));
+  }
+  pfree(times); pfree(values);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_from_arrow);
+/**
+ * Returns the position and the temporal value of each element of the list
+ * array of the buffer in the columnar format
+ */
+PGDLLEXPORT Datum
+temporal_from_arrow(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  ArrowReadState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    if (PG_ARGISNULL(0))
+      SRF_RETURN_DONE(funcctx);
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    bytea *buffer = PG_GETARG_BYTEA_P(0);
+    Oid valuetypid = base_oid_from_temporal(
+      TupleDescAttr(funcctx->tuple_desc, 1)->atttypid);
+    state = palloc0(sizeof(ArrowReadState));
+    arrowread_init(state, buffer, valuetypid);
+    state->gap = (PG_NARGS() > 1 && ! PG_ARGISNULL(1)) ?
+      interval_units(PG_GETARG_INTERVAL_P(1)) : 0;
+    funcctx->user_fctx = state;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (ArrowReadState *) funcctx->user_fctx;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The positions in the list array start at 1 */
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Int32GetDatum(state->i + 1);
+  values[1] = PointerGetDatum(arrowread_temporal(state, state->i,
+    state->gap));
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
@@ -0,0 +1,264 @@
+/*****************************************************************************
+ *
+ * temporal_bench.c
+ *    Micro-benchmarks of the core functions on temporal values.
+ *
+ * The benchmarks call the internal functions directly on temporal values
+ * generated in SQL, so that the cost of the function manager, of the
+ * detoasting, and of the output of the results is not measured. Each
+ * iteration runs in its own memory context, which provides the memory
+ * allocated by the function. The benchmarks are run by the bench target
+ * of the build with the script test/bench/bench.sql.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_bench.h"
+
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <portability/instr_time.h>
+#include <utils/builtins.h>
+#include <utils/memutils.h>
+
+#include "temporaltypes.h"
+#include "temporal_aggfuncs.h"
+#include "temporal_parser.h"
+#include "temporal_util.h"
+#include "lifting.h"
+#include "tpoint.h"
+#include "tpoint_parser.h"
+#include "tpoint_spatialfuncs.h"
+#include "tpoint_tempspatialrels.h"
+
+/*****************************************************************************/
+
+/**
+ * Returns the function to benchmark from its name
+ */
+static BenchKernel
+bench_kernel_from_name(const char *name)
+{
+  if (strcmp(name, "make") == 0)
+    return BENCH_MAKE;
+  if (strcmp(name, "valueAtTimestamp") == 0)
+    return BENCH_VALUE_AT_TIMESTAMP;
+  if (strcmp(name, "sync") == 0)
+    return BENCH_SYNC;
+  if (strcmp(name, "atGeometry") == 0)
+    return BENCH_AT_GEOMETRY;
+  if (strcmp(name, "tdwithin") == 0)
+    return BENCH_TDWITHIN;
+  if (strcmp(name, "parse") == 0)
+    return BENCH_PARSE;
+  if (strcmp(name, "output") == 0)
+    return BENCH_OUTPUT;
+  ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+    errmsg("Unknown benchmark function: %s", name)));
+  return BENCH_MAKE; /* keep compiler quiet */
+}
+
+/**
+ * Ensure that the input of the benchmark is valid for the function
+ */
+static void
+bench_input_validate(const BenchInput *input)
+{
+  BenchKernel kernel = input->kernel;
+  if ((kernel == BENCH_MAKE || kernel == BENCH_VALUE_AT_TIMESTAMP ||
+      kernel == BENCH_AT_GEOMETRY) && input->temp1->duration != SEQUENCE)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The benchmarked function requires a temporal sequence")));
+  if ((kernel == BENCH_SYNC || kernel == BENCH_TDWITHIN) &&
+      input->temp2 == NULL)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The benchmarked function requires two temporal values")));
+  if ((kernel == BENCH_AT_GEOMETRY || kernel == BENCH_TDWITHIN) &&
+      ! tgeo_base_type(input->temp1->valuetypid))
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The benchmarked function requires temporal points")));
+  if (kernel == BENCH_AT_GEOMETRY && input->geom == (Datum) 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The benchmarked function requires a geometry")));
+  if (kernel == BENCH_SYNC &&
+      (input->temp1->valuetypid != FLOAT8OID ||
+       input->temp2->valuetypid != FLOAT8OID))
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The benchmarked function requires temporal floats")));
+  return;
+}
+
+/**
+ * Returns the number of distinct instants of the temporal value
+ */
+static int
+bench_num_instants(const Temporal *temp)
+{
+  TInstantIterator iter;
+  int result = 0;
+  tinstant_iterator_init(&iter, temp);
+  while (tinstant_iterator_next(&iter) != NULL)
+    result++;
+  return result;
+}
+
+/**
+ * Run once the function of the benchmark
+ */
+static void
+bench_kernel_run(const BenchInput *input)
+{
+  BenchKernel kernel = input->kernel;
+  if (kernel == BENCH_MAKE)
+    tsequence_make(input->instants, input->count, true, true,
+      MOBDB_FLAGS_GET_LINEAR(input->temp1->flags), NORMALIZE);
+  else if (kernel == BENCH_VALUE_AT_TIMESTAMP)
+  {
+    /* Look up the middle of each segment of the sequence */
+    const TSequence *seq = (const TSequence *) input->temp1;
+    Datum value;
+    for (int i = 0; i < input->count - 1; i++)
+    {
+      TimestampTz t = input->instants[i]->t +
+        (input->instants[i + 1]->t - input->instants[i]->t) / 2;
+      tsequence_value_at_timestamp(seq, t, &value);
+    }
+  }
+  else if (kernel == BENCH_SYNC)
+  {
+    LiftedFunctionInfo lfinfo;
+    memset(&lfinfo, 0, sizeof(LiftedFunctionInfo));
+    lfinfo.func = (varfunc) &datum_sum_float8;
+    lfinfo.numparam = 2;
+    lfinfo.restypid = FLOAT8OID;
+    lfinfo.reslinear = MOBDB_FLAGS_GET_LINEAR(input->temp1->flags) ||
+      MOBDB_FLAGS_GET_LINEAR(input->temp2->flags);
+    lfinfo.invert = INVERT_NO;
+    lfinfo.discont = CONTINUOUS;
+    lfinfo.tpfunc = NULL;
+    sync_tfunc_temporal_temporal(input->temp1, input->temp2, (Datum) NULL,
+      lfinfo);
+  }
+  else if (kernel == BENCH_AT_GEOMETRY)
+  {
+    int count;
+    tpointseq_at_geometry2((const TSequence *) input->temp1, input->geom,
+      &count);
+  }
+  else if (kernel == BENCH_TDWITHIN)
+    tdwithin_tpoint_tpoint_internal(input->temp1, input->temp2,
+      Float8GetDatum(BENCH_TDWITHIN_DIST));
+  else if (kernel == BENCH_PARSE)
+  {
+    char *str = input->str;
+    if (tgeo_base_type(input->temp1->valuetypid))
+      tpoint_parse(&str, input->temp1->valuetypid);
+    else
+      temporal_parse(&str, input->temp1->valuetypid);
+  }
+  else /* kernel == BENCH_OUTPUT */
+    temporal_to_string(input->temp1, &call_output);
+  return;
+}
+
+/**
+ * Returns the memory allocated in the memory context and its children
+ */
+static Size
+bench_memory_allocated(MemoryContext context)
+{
+#if MOBDB_PGSQL_VERSION >= 130000
+  return MemoryContextMemAllocated(context, true);
+#else
+  MemoryContextCounters totals;
+  memset(&totals, 0, sizeof(MemoryContextCounters));
+#if MOBDB_PGSQL_VERSION >= 110000
+  context->methods->stats(context, NULL, NULL, &totals);
+#else
+  context->methods->stats(context, 0, false, &totals);
+#endif
+  return totals.totalspace;
+#endif
+}
+
+PG_FUNCTION_INFO_V1(temporal_bench);
+/**
+ * Returns the average time in nanoseconds and the average memory in bytes
+ * per input instant of the function applied to the temporal values
+ *
+ * The arguments are the name of the function, the number of iterations,
+ * one or two temporal values and, for temporal points, a geometry.
+ */
+PGDLLEXPORT Datum
+temporal_bench(PG_FUNCTION_ARGS)
+{
+  if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2))
+    PG_RETURN_NULL();
+  char *name = text_to_cstring(PG_GETARG_TEXT_PP(0));
+  int iterations = PG_GETARG_INT32(1);
+  if (iterations <= 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The number of iterations must be strictly positive")));
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+      errmsg("function returning record called in context "
+        "that cannot accept type record")));
+  tupdesc = BlessTupleDesc(tupdesc);
+
+  /* Prepare the input outside of the measures */
+  BenchInput input;
+  memset(&input, 0, sizeof(BenchInput));
+  input.kernel = bench_kernel_from_name(name);
+  input.temp1 = PG_GETARG_TEMPORAL(2);
+  if (PG_NARGS() > 3 && ! PG_ARGISNULL(3))
+    input.temp2 = PG_GETARG_TEMPORAL(3);
+  if (PG_NARGS() > 4 && ! PG_ARGISNULL(4))
+    input.geom = PointerGetDatum(PG_GETARG_GSERIALIZED_P(4));
+  bench_input_validate(&input);
+  if (input.temp1->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) input.temp1;
+    input.count = seq->count;
+    input.instants = palloc(sizeof(TInstant *) * seq->count);
+    for (int i = 0; i < seq->count; i++)
+      input.instants[i] = tsequence_inst_n(seq, i);
+  }
+  if (input.kernel == BENCH_PARSE)
+    input.str = temporal_to_string(input.temp1, &call_output);
+  int numinst = bench_num_instants(input.temp1);
+  if (input.temp2 != NULL)
+    numinst += bench_num_instants(input.temp2);
+
+  /* Run the function in a memory context that is reset after each run */
+  MemoryContext benchcontext = AllocSetContextCreate(CurrentMemoryContext,
+    "MobilityDB benchmark", ALLOCSET_DEFAULT_SIZES);
+  double seconds = 0, bytes = 0;
+  for (int i = 0; i < iterations; i++)
+  {
+    instr_time start, duration;
+    MemoryContext oldcontext = MemoryContextSwitchTo(benchcontext);
+    INSTR_TIME_SET_CURRENT(start);
+    bench_kernel_run(&input);
+    INSTR_TIME_SET_CURRENT(duration);
+    INSTR_TIME_SUBTRACT(duration, start);
+    MemoryContextSwitchTo(oldcontext);
+    seconds += INSTR_TIME_GET_DOUBLE(duration);
+    bytes += (double) bench_memory_allocated(benchcontext);
+    MemoryContextReset(benchcontext);
+  }
+  MemoryContextDelete(benchcontext);
+
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Float8GetDatum(seconds * 1e9 / iterations / numinst);
+  values[1] = Float8GetDatum(bytes / iterations / numinst);
+  HeapTuple tuple = heap_form_tuple(tupdesc, values, isnull);
+  PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
@@ -0,0 +1,212 @@
+/*****************************************************************************
+ *
+ * temporal_brin.c
+ *    BRIN index for temporal integers and temporal floats
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file temporal_brin.c
+ * BRIN indexes summarize a range of consecutive pages of a table with the
+ * union of the bounding boxes of the temporal values stored in these pages.
+ * This is well suited for append-only tables of temporal values that are
+ * naturally clustered by time, since the resulting indexes are very small
+ * and cheap to maintain. The union is kept as a single box, so the support
+ * functions are much simpler than those of the inclusion operator classes
+ * of PostgreSQL, whose summaries also keep track of unmergeable values.
+ */
+
+#include "temporal_brin.h"
+
+#include <access/brin_internal.h>
+#include <access/brin_tuple.h>
+#include <access/skey.h>
+#include <utils/datum.h>
+#include <utils/typcache.h>
+
+#include "oidcache.h"
+#include "tbox.h"
+#include "tnumber_gist.h"
+
+/*****************************************************************************
+ * BRIN opcinfo function
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(temporal_brin_opcinfo);
+/**
+ * BRIN opcinfo function for temporal types
+ *
+ * The summary of a page range is a single bounding box whose type is the
+ * storage type of the operator class, given as argument.
+ */
+PGDLLEXPORT Datum
+temporal_brin_opcinfo(PG_FUNCTION_ARGS)
+{
+  Oid typoid = PG_GETARG_OID(0);
+  BrinOpcInfo *result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)));
+  result->oi_nstored = 1;
+  result->oi_opaque = NULL;
+  result->oi_typcache[0] = lookup_type_cache(typoid, 0);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * BRIN support functions for temporal numbers
+ *****************************************************************************/
+
+/**
+ * Transform the query of a scan key into a box
+ *
+ * @param[out] query Box
+ * @param[in] key Scan key
+ * @return False if the query is empty
+ */
+static bool
+tnumber_brin_query(TBOX *query, ScanKey key)
+{
+  Oid subtype = key->sk_subtype;
+  memset(query, 0, sizeof(TBOX));
+  if (tnumber_range_type(subtype))
+  {
+#if MOBDB_PGSQL_VERSION < 110000
+    RangeType *range = DatumGetRangeType(key->sk_argument);
+#else
+    RangeType *range = DatumGetRangeTypeP(key->sk_argument);
+#endif
+    if (range_get_flags(range) & RANGE_EMPTY)
+      return false;
+    range_to_tbox_internal(query, range);
+  }
+  else if (subtype == type_oid(T_TBOX))
+    memcpy(query, DatumGetTboxP(key->sk_argument), sizeof(TBOX));
+  else if (tnumber_type(subtype))
+    temporal_bbox_slice(query, key->sk_argument);
+  else
+    elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+  return true;
+}
+
+PG_FUNCTION_INFO_V1(tnumber_brin_add_value);
+/**
+ * BRIN add value function for temporal numbers
+ *
+ * Expand the union of the page range with the bounding box of the new value.
+ * Returns true if the summary has been modified.
+ */
+PGDLLEXPORT Datum
+tnumber_brin_add_value(PG_FUNCTION_ARGS)
+{
+  BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+  Datum newval = PG_GETARG_DATUM(2);
+  bool isnull = PG_GETARG_BOOL(3);
+  TBOX box, *unionbox;
+
+  /*
+   * If the new value is null, we record that we saw it if it's the first
+   * one; otherwise, there's nothing to do.
+   */
+  if (isnull)
+  {
+    if (column->bv_hasnulls)
+      PG_RETURN_BOOL(false);
+    column->bv_hasnulls = true;
+    PG_RETURN_BOOL(true);
+  }
+
+  memset(&box, 0, sizeof(TBOX));
+  temporal_bbox_slice(&box, newval);
+
+  /* If this is the first non-null value, we need to initialize */
+  if (column->bv_allnulls)
+  {
+    column->bv_values[0] = datumCopy(PointerGetDatum(&box), false,
+      sizeof(TBOX));
+    column->bv_allnulls = false;
+    PG_RETURN_BOOL(true);
+  }
+
+  unionbox = DatumGetTboxP(column->bv_values[0]);
+  if (contains_tbox_tbox_internal(unionbox, &box))
+    PG_RETURN_BOOL(false);
+  tbox_adjust(unionbox, &box);
+  PG_RETURN_BOOL(true);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_brin_consistent);
+/**
+ * BRIN consistent function for temporal numbers
+ *
+ * Returns false if no value of the page range can satisfy the scan key.
+ * The union of the page range is tested as the internal nodes of a GiST
+ * index, i.e., with the same checks as tbox_gist_consistent_internal.
+ */
+PGDLLEXPORT Datum
+tnumber_brin_consistent(PG_FUNCTION_ARGS)
+{
+  BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+  ScanKey key = (ScanKey) PG_GETARG_POINTER(2);
+  TBOX query;
+
+  /* Handle IS NULL/IS NOT NULL tests */
+  if (key->sk_flags & SK_ISNULL)
+  {
+    if (key->sk_flags & SK_SEARCHNULL)
+      PG_RETURN_BOOL(column->bv_allnulls || column->bv_hasnulls);
+    if (key->sk_flags & SK_SEARCHNOTNULL)
+      PG_RETURN_BOOL(! column->bv_allnulls);
+    /* Neither IS NULL nor IS NOT NULL was used; assume all indexable
+     * operators are strict and return false */
+    PG_RETURN_BOOL(false);
+  }
+
+  /* If it is all nulls, it cannot possibly be consistent */
+  if (column->bv_allnulls)
+    PG_RETURN_BOOL(false);
+
+  if (! tnumber_brin_query(&query, key))
+    PG_RETURN_BOOL(false);
+
+  PG_RETURN_BOOL(tbox_gist_consistent_internal(
+    DatumGetTboxP(column->bv_values[0]), &query, key->sk_strategy));
+}
+
+PG_FUNCTION_INFO_V1(tnumber_brin_union);
+/**
+ * BRIN union function for temporal numbers
+ *
+ * Expand the first summary to include the second one
+ */
+PGDLLEXPORT Datum
+tnumber_brin_union(PG_FUNCTION_ARGS)
+{
+  BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+  BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+
+  /* Adjust "hasnulls" */
+  if (! col_a->bv_hasnulls && col_b->bv_hasnulls)
+    col_a->bv_hasnulls = true;
+
+  /* If there are no values in B, there's nothing left to do */
+  if (col_b->bv_allnulls)
+    PG_RETURN_VOID();
+
+  /* If A has no values, copy the summary of B */
+  if (col_a->bv_allnulls)
+  {
+    col_a->bv_allnulls = false;
+    col_a->bv_values[0] = datumCopy(col_b->bv_values[0], false,
+      sizeof(TBOX));
+    PG_RETURN_VOID();
+  }
+
+  tbox_adjust(DatumGetTboxP(col_a->bv_values[0]),
+    DatumGetTboxP(col_b->bv_values[0]));
+  PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
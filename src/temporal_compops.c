@@ -29,7 +29,8 @@ tcomp_temporal_base1(const Temporal *temp, Datum value, Oid valuetypid,
   Datum (*func)(Datum, Datum, Oid, Oid), bool invert)
 {
   LiftedFunctionInfo lfinfo;
-  lfinfo.func = (varfunc) func;
+  lfinfo.func = (varfunc) datum2_comp_func(func, temp->valuetypid,
+    valuetypid);
   lfinfo.numparam = 4;
   lfinfo.restypid = BOOLOID;
   lfinfo.reslinear = STEP;
@@ -78,7 +79,8 @@ tcomp_temporal_temporal(FunctionCallInfo fcinfo,
     ensure_same_dimensionality_tpoint(temp1, temp2);
   }
   LiftedFunctionInfo lfinfo;
-  lfinfo.func = (varfunc) func;
+  lfinfo.func = (varfunc) datum2_comp_func(func, temp1->valuetypid,
+    temp2->valuetypid);
   lfinfo.numparam = 4;
   lfinfo.restypid = BOOLOID;
   lfinfo.reslinear = STEP;
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ *
+ * temporal_counters.c
+ *    Counters of the work done by the hot paths of the extension
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file temporal_counters.c
+ * When a query is slow, these counters tell whether the time goes to the
+ * detoasting of the values, to the bounding box tests, to the calls of
+ * PostGIS, to the synchronization of temporal values, or to the skiplists
+ * of the temporal aggregates. The counters are kept per backend and are
+ * only incremented when the configuration parameter
+ * mobilitydb.track_counters is on, so that the cost when it is off is a
+ * test of a boolean. Queries run in parallel workers increment the counters
+ * of the workers, not the ones of the leader.
+ */
+
+#include "temporal_counters.h"
+
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/builtins.h>
+
+/*****************************************************************************/
+
+/**
+ * Global variable that states whether the counters are maintained. It is
+ * set by the configuration parameter mobilitydb.track_counters.
+ */
+bool track_counters = false;
+
+/**
+ * Counters of the backend
+ */
+MobilityCounters mobdb_counters;
+
+/**
+ * Names of the counters in the order of the structure
+ */
+static const struct
+{
+  const char *name;
+  size_t offset;
+} counter_names[] =
+{
+  {"detoast_count", offsetof(MobilityCounters, detoast_count)},
+  {"detoast_bytes", offsetof(MobilityCounters, detoast_bytes)},
+  {"detoast_slices", offsetof(MobilityCounters, detoast_slices)},
+  {"detoast_hits", offsetof(MobilityCounters, detoast_hits)},
+  {"packed_skips", offsetof(MobilityCounters, packed_skips)},
+  {"cache_probes", offsetof(MobilityCounters, cache_probes)},
+  {"bbox_hits", offsetof(MobilityCounters, bbox_hits)},
+  {"bbox_misses", offsetof(MobilityCounters, bbox_misses)},
+  {"postgis_calls", offsetof(MobilityCounters, postgis_calls)},
+  {"sync_calls", offsetof(MobilityCounters, sync_calls)},
+  {"sync_instants", offsetof(MobilityCounters, sync_instants)},
+  {"skiplist_splices", offsetof(MobilityCounters, skiplist_splices)},
+  {"skiplist_maxlength", offsetof(MobilityCounters, skiplist_maxlength)},
+  {"skiplist_spills", offsetof(MobilityCounters, skiplist_spills)}
+};
+
+#define NUM_COUNTERS (sizeof(counter_names) / sizeof(counter_names[0]))
+
+/*****************************************************************************/
+
+PG_FUNCTION_INFO_V1(mobilitydb_stats);
+/**
+ * Returns the name and the value of the counters of the backend
+ */
+PGDLLEXPORT Datum
+mobilitydb_stats(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  if (SRF_IS_FIRSTCALL())
+  {
+    funcctx = SRF_FIRSTCALL_INIT();
+    MemoryContext oldcontext =
+      MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+    TupleDesc tupdesc;
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+    /* Take a snapshot so that the counters are consistent across calls */
+    MobilityCounters *counters = palloc(sizeof(MobilityCounters));
+    memcpy(counters, &mobdb_counters, sizeof(MobilityCounters));
+    funcctx->user_fctx = counters;
+    funcctx->max_calls = NUM_COUNTERS;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  if (funcctx->call_cntr >= funcctx->max_calls)
+    SRF_RETURN_DONE(funcctx);
+
+  int i = (int) funcctx->call_cntr;
+  uint64 value = *(uint64 *) ((char *) funcctx->user_fctx +
+    counter_names[i].offset);
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = PointerGetDatum(cstring_to_text(counter_names[i].name));
+  values[1] = Int64GetDatum((int64) value);
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+PG_FUNCTION_INFO_V1(mobilitydb_stats_reset);
+/**
+ * Set to zero the counters of the backend
+ */
+PGDLLEXPORT Datum
+mobilitydb_stats_reset(PG_FUNCTION_ARGS)
+{
+  memset(&mobdb_counters, 0, sizeof(MobilityCounters));
+  PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
@@ -0,0 +1,215 @@
+/*****************************************************************************
+ *
+ * temporal_detoast.c
+ *    Detoasting of the temporal values with a cache of the backend
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file temporal_detoast.c
+ * Function that detoasts the temporal values for all the functions of the
+ * extension. The values stored out of line that were detoasted recently are
+ * kept in a small cache of the backend, so that the functions of a target
+ * list that read the same value of a row do not fetch and decompress it
+ * again. The cache is emptied at the end of the transaction and when the
+ * relation cache entry of a TOAST table is invalidated.
+ */
+
+#include "temporal_detoast.h"
+
+#include <access/xact.h>
+#if MOBDB_PGSQL_VERSION < 130000
+#include <access/tuptoaster.h>
+#else
+#include <access/detoast.h>
+#endif
+#include <utils/inval.h>
+#include <utils/memutils.h>
+
+#include "temporal_counters.h"
+
+/*****************************************************************************/
+
+/**
+ * Global variable that states the maximum size in kilobytes of the values
+ * kept in the detoast cache. It is set by the configuration parameter
+ * mobilitydb.detoast_cache_size, 0 disables the cache.
+ */
+int detoast_cache_size = 16384;
+
+/**
+ * Structure to represent a value in the detoast cache
+ */
+typedef struct
+{
+  Oid toastrelid;          /**< Oid of the TOAST table of the value */
+  Oid valueid;             /**< Oid of the value in the TOAST table */
+  int32 extsize;           /**< External size of the value */
+  uint64 lastuse;          /**< Number of the last access to the value */
+  struct varlena *value;   /**< Detoasted value, NULL for a free entry */
+} DetoastCacheEntry;
+
+static DetoastCacheEntry detoast_cache[DETOAST_CACHE_ENTRIES];
+static uint64 detoast_cache_clock = 0;
+static Size detoast_cache_bytes = 0;
+static MemoryContext detoast_cache_context = NULL;
+
+/**
+ * Remove the value of the entry from the detoast cache
+ */
+static void
+detoast_cache_evict(DetoastCacheEntry *entry)
+{
+  detoast_cache_bytes -= VARSIZE(entry->value);
+  pfree(entry->value);
+  memset(entry, 0, sizeof(DetoastCacheEntry));
+  return;
+}
+
+/**
+ * Empty the detoast cache
+ */
+static void
+detoast_cache_reset(void)
+{
+  if (detoast_cache_bytes == 0)
+    return;
+  MemoryContextReset(detoast_cache_context);
+  memset(detoast_cache, 0, sizeof(detoast_cache));
+  detoast_cache_bytes = 0;
+  return;
+}
+
+/**
+ * Empty the detoast cache at the end of the transaction, after which the
+ * values identified by the TOAST pointers may have been removed
+ */
+static void
+detoast_cache_xact_callback(XactEvent event, void *arg)
+{
+  detoast_cache_reset();
+  return;
+}
+
+/**
+ * Remove from the detoast cache the values of the TOAST table whose
+ * relation cache entry is invalidated, or all the values when all the
+ * entries are invalidated
+ *
+ * A TRUNCATE or a rewrite of a table in the current transaction
+ * invalidates its TOAST table, whose value identifiers may then be reused
+ * by the values inserted afterwards.
+ */
+static void
+detoast_cache_relcache_callback(Datum arg, Oid relid)
+{
+  if (detoast_cache_bytes == 0)
+    return;
+  if (! OidIsValid(relid))
+  {
+    detoast_cache_reset();
+    return;
+  }
+  for (int i = 0; i < DETOAST_CACHE_ENTRIES; i++)
+  {
+    if (detoast_cache[i].value != NULL && detoast_cache[i].toastrelid == relid)
+      detoast_cache_evict(&detoast_cache[i]);
+  }
+  return;
+}
+
+/**
+ * Detoast the temporal value stored out of line using the detoast cache
+ *
+ * The values are identified by their TOAST pointer and the least recently
+ * used ones are evicted when the cache is full. The result is a copy of
+ * the cached value since the calling functions free the detoasted values.
+ */
+static struct varlena *
+temporal_detoast_cached(struct varlena *ptr)
+{
+  struct varatt_external toast_pointer;
+  VARATT_EXTERNAL_GET_POINTER(toast_pointer, ptr);
+  struct varlena *result;
+  int victim = 0;
+  for (int i = 0; i < DETOAST_CACHE_ENTRIES; i++)
+  {
+    DetoastCacheEntry *entry = &detoast_cache[i];
+    if (entry->value != NULL &&
+      entry->toastrelid == toast_pointer.va_toastrelid &&
+      entry->valueid == toast_pointer.va_valueid &&
+      entry->extsize == toast_pointer.va_extsize)
+    {
+      entry->lastuse = ++detoast_cache_clock;
+      result = palloc(VARSIZE(entry->value));
+      memcpy(result, entry->value, VARSIZE(entry->value));
+      COUNTER_INC(detoast_hits);
+      return result;
+    }
+    if (entry->lastuse < detoast_cache[victim].lastuse)
+      victim = i;
+  }
+
+  result = pg_detoast_datum(ptr);
+  COUNTER_INC(detoast_count);
+  COUNTER_ADD(detoast_bytes, VARSIZE(result));
+  Size maxbytes = (Size) detoast_cache_size * 1024;
+  if (VARSIZE(result) > maxbytes)
+    return result;
+
+  if (detoast_cache_context == NULL)
+  {
+    detoast_cache_context = AllocSetContextCreate(TopMemoryContext,
+      "MobilityDB detoast cache", ALLOCSET_DEFAULT_SIZES);
+    RegisterXactCallback(detoast_cache_xact_callback, NULL);
+    CacheRegisterRelcacheCallback(detoast_cache_relcache_callback, (Datum) 0);
+  }
+  if (detoast_cache[victim].value != NULL)
+    detoast_cache_evict(&detoast_cache[victim]);
+  /* Evict the least recently used values until the new one fits */
+  while (detoast_cache_bytes + VARSIZE(result) > maxbytes)
+  {
+    int lru = -1;
+    for (int i = 0; i < DETOAST_CACHE_ENTRIES; i++)
+    {
+      if (detoast_cache[i].value != NULL &&
+        (lru < 0 || detoast_cache[i].lastuse < detoast_cache[lru].lastuse))
+        lru = i;
+    }
+    detoast_cache_evict(&detoast_cache[lru]);
+  }
+  DetoastCacheEntry *entry = &detoast_cache[victim];
+  entry->toastrelid = toast_pointer.va_toastrelid;
+  entry->valueid = toast_pointer.va_valueid;
+  entry->extsize = toast_pointer.va_extsize;
+  entry->lastuse = ++detoast_cache_clock;
+  entry->value = MemoryContextAlloc(detoast_cache_context, VARSIZE(result));
+  memcpy(entry->value, result, VARSIZE(result));
+  detoast_cache_bytes += VARSIZE(result);
+  return result;
+}
+
+/**
+ * Detoast the temporal value given as a datum, counting the values whose
+ * detoasting decompresses, fetches, or copies them
+ */
+struct varlena *
+temporal_detoast(Datum value)
+{
+  struct varlena *ptr = (struct varlena *) DatumGetPointer(value);
+  if (! VARATT_IS_EXTENDED(ptr))
+    return ptr;
+  if (VARATT_IS_EXTERNAL_ONDISK(ptr) && detoast_cache_size > 0)
+    return temporal_detoast_cached(ptr);
+  struct varlena *result = pg_detoast_datum(ptr);
+  COUNTER_INC(detoast_count);
+  COUNTER_ADD(detoast_bytes, VARSIZE(result));
+  return result;
+}
+
+/*****************************************************************************/
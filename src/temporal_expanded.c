@@ -0,0 +1,268 @@
+/*****************************************************************************
+ *
+ * temporal_expanded.c
+ *    Expanded representation of temporal instant sets and sequences.
+ *
+ * Temporal values are flat varlenas, so that appending an instant builds a
+ * new value with all the instants of the previous one. An aggregate whose
+ * transition function is appendInstant would then take a time quadratic in
+ * the number of instants. After the first append in an aggregate, the state
+ * is instead kept as an expanded object, to which the following instants
+ * are appended in place. The flat value is only built when the aggregate
+ * returns its result or when the state is passed to another function.
+ *
+ * The lifted arithmetic operators on temporal numbers with instant set or
+ * sequence duration also return their result as an expanded object. When
+ * such a result is directly the argument of another arithmetic operator,
+ * as in (speed * 3.6 - limit) / limit, the executor passes it as a
+ * read-write pointer and the operator computes its result in place on
+ * the instants of its argument, so that the intermediate results of the
+ * expression are neither flattened nor copied.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_expanded.h"
+
+#include <assert.h>
+#include <utils/memutils.h>
+
+#include "temporaltypes.h"
+
+/*****************************************************************************
+ * Methods of the expanded object
+ *****************************************************************************/
+
+/**
+ * Build the flat value of the expanded temporal value if it is not
+ * already built
+ */
+static Temporal *
+expanded_temporal_flat(ExpandedTemporal *eot)
+{
+  if (eot->flat == NULL)
+  {
+    MemoryContext oldcontext = MemoryContextSwitchTo(eot->hdr.eoh_context);
+    if (eot->duration == INSTANTSET)
+      eot->flat = (Temporal *) tinstantset_make(eot->instants, eot->count);
+    else /* eot->duration == SEQUENCE */
+      eot->flat = (Temporal *) tsequence_make1(eot->instants, eot->count,
+        eot->lower_inc, eot->upper_inc, eot->linear, eot->normalize);
+    MemoryContextSwitchTo(oldcontext);
+  }
+  return eot->flat;
+}
+
+/**
+ * Returns the size of the flat value of the expanded temporal value
+ */
+static Size
+expanded_temporal_get_flat_size(ExpandedObjectHeader *eohptr)
+{
+  ExpandedTemporal *eot = (ExpandedTemporal *) eohptr;
+  assert(eot->eot_magic == EOT_MAGIC);
+  return VARSIZE(expanded_temporal_flat(eot));
+}
+
+/**
+ * Copy the flat value of the expanded temporal value into the result
+ */
+static void
+expanded_temporal_flatten_into(ExpandedObjectHeader *eohptr, void *result,
+  Size allocated_size)
+{
+  ExpandedTemporal *eot = (ExpandedTemporal *) eohptr;
+  assert(eot->eot_magic == EOT_MAGIC);
+  Temporal *flat = expanded_temporal_flat(eot);
+  assert(allocated_size == VARSIZE(flat));
+  memcpy(result, flat, allocated_size);
+}
+
+static const ExpandedObjectMethods expanded_temporal_methods =
+{
+  expanded_temporal_get_flat_size,
+  expanded_temporal_flatten_into
+};
+
+/*****************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/**
+ * Returns true if the temporal value can be expanded
+ */
+bool
+temporal_expandable(const Temporal *temp)
+{
+  return temp->duration == INSTANTSET || temp->duration == SEQUENCE;
+}
+
+/**
+ * Returns an empty expanded temporal value of the duration, which is
+ * created in a child of the memory context
+ *
+ * The caller adds the instants, which must be allocated in the memory
+ * context of the object, and sets the bounds and the interpolation of
+ * a sequence.
+ *
+ * @param[in] duration Duration, either INSTANTSET or SEQUENCE
+ * @param[in] count Number of instants allocated
+ * @param[in] parentcontext Parent memory context
+ */
+ExpandedTemporal *
+expanded_temporal_new(int16 duration, int count, MemoryContext parentcontext)
+{
+  MemoryContext objcontext = AllocSetContextCreate(parentcontext,
+    "expanded temporal", ALLOCSET_START_SMALL_SIZES);
+  ExpandedTemporal *eot = MemoryContextAlloc(objcontext,
+    sizeof(ExpandedTemporal));
+  EOH_init_header(&eot->hdr, &expanded_temporal_methods, objcontext);
+  eot->eot_magic = EOT_MAGIC;
+  eot->duration = duration;
+  eot->lower_inc = eot->upper_inc = true;
+  eot->linear = false;
+  eot->normalize = false;
+  eot->count = 0;
+  eot->maxcount = Max(count, 1);
+  eot->instants = MemoryContextAlloc(objcontext,
+    sizeof(TInstant *) * eot->maxcount);
+  eot->flat = NULL;
+  return eot;
+}
+
+/**
+ * Returns a read-write pointer to an expanded copy of the temporal instant
+ * set or sequence, which is created in a child of the memory context
+ */
+Datum
+expand_temporal(const Temporal *temp, MemoryContext parentcontext)
+{
+  assert(temporal_expandable(temp));
+  MemoryContext objcontext = AllocSetContextCreate(parentcontext,
+    "expanded temporal", ALLOCSET_START_SMALL_SIZES);
+  ExpandedTemporal *eot = MemoryContextAlloc(objcontext,
+    sizeof(ExpandedTemporal));
+  EOH_init_header(&eot->hdr, &expanded_temporal_methods, objcontext);
+  eot->eot_magic = EOT_MAGIC;
+  eot->duration = temp->duration;
+  eot->normalize = false;
+
+  MemoryContext oldcontext = MemoryContextSwitchTo(objcontext);
+  /* The flat value is the copy of the value until an instant is appended */
+  eot->flat = temporal_copy(temp);
+  if (temp->duration == INSTANTSET)
+  {
+    TInstantSet *ti = (TInstantSet *) eot->flat;
+    eot->count = ti->count;
+    eot->lower_inc = eot->upper_inc = true;
+    eot->linear = false;
+    eot->maxcount = ti->count * 2;
+    eot->instants = palloc(sizeof(TInstant *) * eot->maxcount);
+    for (int i = 0; i < ti->count; i++)
+      eot->instants[i] = tinstant_copy(tinstantset_inst_n(ti, i));
+  }
+  else /* temp->duration == SEQUENCE */
+  {
+    TSequence *seq = (TSequence *) eot->flat;
+    eot->count = seq->count;
+    eot->lower_inc = seq->period.lower_inc;
+    eot->upper_inc = seq->period.upper_inc;
+    eot->linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+    eot->maxcount = seq->count * 2;
+    eot->instants = palloc(sizeof(TInstant *) * eot->maxcount);
+    for (int i = 0; i < seq->count; i++)
+      eot->instants[i] = tinstant_copy(tsequence_inst_n(seq, i));
+  }
+  MemoryContextSwitchTo(oldcontext);
+  return EOHPGetRWDatum(&eot->hdr);
+}
+
+/**
+ * Returns the expanded temporal value if the datum is a read-write pointer
+ * to it, NULL otherwise
+ */
+ExpandedTemporal *
+DatumGetExpandedTemporalRW(Datum value)
+{
+  if (! VARATT_IS_EXTERNAL_EXPANDED_RW(DatumGetPointer(value)))
+    return NULL;
+  ExpandedTemporal *eot = (ExpandedTemporal *) DatumGetEOHP(value);
+  assert(eot->eot_magic == EOT_MAGIC);
+  return eot;
+}
+
+/**
+ * Append in place the instant to the expanded temporal value
+ *
+ * @result False if the instant is not after the last instant of the value,
+ * in which case the append is left to the functions on flat values, which
+ * either raise an error or return a temporal value of another duration
+ * @pre The instant has the same base type and is spatially compatible with
+ * the value
+ */
+bool
+expanded_temporal_append(ExpandedTemporal *eot, const TInstant *inst)
+{
+  assert(eot->count > 0);
+  if (inst->t <= eot->instants[eot->count - 1]->t)
+    return false;
+
+  MemoryContext oldcontext = MemoryContextSwitchTo(eot->hdr.eoh_context);
+  /* Normalize the result */
+  if (eot->duration == SEQUENCE && eot->count > 1 &&
+    tsequence_append_replaces_last(eot->instants[eot->count - 2],
+      eot->instants[eot->count - 1], inst, eot->linear))
+    pfree(eot->instants[--eot->count]);
+  if (eot->count == eot->maxcount)
+  {
+    eot->maxcount *= 2;
+    eot->instants = repalloc(eot->instants,
+      sizeof(TInstant *) * eot->maxcount);
+  }
+  eot->instants[eot->count++] = tinstant_copy(inst);
+  eot->upper_inc = true;
+  if (eot->flat != NULL)
+  {
+    pfree(eot->flat);
+    eot->flat = NULL;
+  }
+  MemoryContextSwitchTo(oldcontext);
+  return true;
+}
+
+/**
+ * Set in place the value of the n-th instant of the expanded temporal value
+ *
+ * The instant is replaced when the value is passed by reference or when
+ * its type changes, as in the addition of a temporal integer and a float.
+ * Since the new values may make some instants of a sequence redundant, the
+ * flat value is normalized.
+ */
+void
+expanded_temporal_set_value(ExpandedTemporal *eot, int n, Datum value,
+  Oid valuetypid)
+{
+  TInstant *inst = eot->instants[n];
+  if (MOBDB_FLAGS_GET_BYVAL(inst->flags) && inst->valuetypid == valuetypid)
+    *tinstant_value_ptr(inst) = value;
+  else
+  {
+    MemoryContext oldcontext = MemoryContextSwitchTo(eot->hdr.eoh_context);
+    eot->instants[n] = tinstant_make(value, inst->t, valuetypid);
+    pfree(inst);
+    MemoryContextSwitchTo(oldcontext);
+  }
+  eot->normalize = true;
+  if (eot->flat != NULL)
+  {
+    pfree(eot->flat);
+    eot->flat = NULL;
+  }
+  return;
+}
+
+/*****************************************************************************/
@@ -0,0 +1,931 @@
+/*****************************************************************************
+ *
+ * temporal_packed.c
+ *    Packed (columnar) and compressed storage of temporal values.
+ *
+ * A temporal value of instant set, sequence, or sequence set duration is
+ * normally composed of an array of offsets pointing to full TInstant values,
+ * each of which repeats the varlena header, the duration, the flags, the Oid
+ * of the base type, and, for temporal points, a complete GSERIALIZED. In
+ * packed form the value keeps its header and its bounding box but stores
+ * its instants as an array of timestamps followed by an array of raw base
+ * values, that is, booleans, integers, floats, or the 2D or 3D coordinates
+ * of the points. In compressed form, which also sets the COMPRESSED flag,
+ * the two arrays are replaced by two compressed streams:
+ * - the timestamps, encoded as delta-of-delta zigzag varints, which take
+ *   a single byte per instant for data sampled at a constant rate,
+ * - the base values, encoded as zigzag varints of the difference with the
+ *   previous value for integers and as the XOR with the previous value for
+ *   floats and point coordinates, where only the non-zero bytes of the XOR
+ *   are kept.
+ *
+ * The instants are split into chunks of PACKED_CHUNK_INSTANTS instants whose
+ * streams are encoded independently. When a value has more than one chunk,
+ * a directory with the offset and the bounding box of each chunk precedes
+ * the encoded data. The bounding boxes act as zone maps: the restriction of
+ * a packed value to a period or to a spatiotemporal box only decodes the
+ * chunks whose bounding box overlaps it, the other ones are skipped.
+ *
+ * Packed values are a pure storage format. They are created when a value is
+ * stored in a column whose typmod requires packing or compression, e.g.,
+ * `tfloat(Sequence, Packed)` or `tfloat(Sequence, Compressed)`, and they
+ * are fully decoded by
+ * PG_GETARG_TEMPORAL on every call of a function taking them as argument,
+ * so that the functions operating on temporal types never see them. Apart
+ * from the bounding box operators, which read the box kept in the header,
+ * and the restrictions to a period or a box, which only decode the
+ * selected chunks, packed values thus trade CPU for storage and I/O. Since
+ * they are standard varlena values, they are further compressed and moved
+ * out of line by TOAST as any other value.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_packed.h"
+
+#include <assert.h>
+#include <lib/stringinfo.h>
+
+#include "oidcache.h"
+#include "temporal_util.h"
+#include "temporal_boxops.h"
+#include "tinstant.h"
+#include "tinstantset.h"
+#include "tsequence.h"
+#include "tsequenceset.h"
+
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * Encoding functions
+ *****************************************************************************/
+
+/**
+ * Map a signed integer to an unsigned one so that values with a small
+ * absolute value have a short varint encoding
+ */
+static inline uint64
+zigzag_encode(uint64 value)
+{
+  return (value << 1) ^ (uint64) ((int64) value >> 63);
+}
+
+/**
+ * Inverse of the zigzag_encode function
+ */
+static inline uint64
+zigzag_decode(uint64 value)
+{
+  return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+/**
+ * Write an unsigned integer in base 128 using the high bit of each byte
+ * as continuation bit
+ */
+static void
+packed_write_varint(StringInfo buf, uint64 value)
+{
+  while (value >= 0x80)
+  {
+    appendStringInfoCharMacro(buf, (char) ((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  appendStringInfoCharMacro(buf, (char) value);
+}
+
+/**
+ * Read an unsigned integer written by packed_write_varint and advance
+ * the pointer
+ */
+static uint64
+packed_read_varint(const uint8 **ptr)
+{
+  uint64 result = 0;
+  int shift = 0;
+  uint8 byte;
+  do
+  {
+    byte = *(*ptr)++;
+    result |= (uint64) (byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return result;
+}
+
+/**
+ * Write a double as the XOR with the previous one
+ *
+ * A header byte keeps in its high and low nibbles the number of leading
+ * and trailing zero bytes of the XOR, which are not written. Identical
+ * consecutive values thus take a single byte.
+ *
+ * @param[in,out] buf Buffer
+ * @param[in] value Value
+ * @param[in,out] prev Bit representation of the previous value
+ */
+static void
+packed_write_double(StringInfo buf, double value, uint64 *prev)
+{
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(uint64));
+  uint64 xor = bits ^ *prev;
+  *prev = bits;
+  if (xor == 0)
+  {
+    appendStringInfoCharMacro(buf, (char) 0x80);
+    return;
+  }
+  int lead = 0, trail = 0;
+  while (((xor >> (56 - 8 * lead)) & 0xFF) == 0)
+    lead++;
+  while (((xor >> (8 * trail)) & 0xFF) == 0)
+    trail++;
+  appendStringInfoCharMacro(buf, (char) ((lead << 4) | trail));
+  for (int i = 7 - lead; i >= trail; i--)
+    appendStringInfoCharMacro(buf, (char) ((xor >> (8 * i)) & 0xFF));
+}
+
+/**
+ * Read a double written by packed_write_double and advance the pointer
+ */
+static double
+packed_read_double(const uint8 **ptr, uint64 *prev)
+{
+  uint8 header = *(*ptr)++;
+  int lead = header >> 4, trail = header & 0x0F;
+  uint64 xor = 0;
+  for (int i = 7 - lead; i >= trail; i--)
+    xor |= (uint64) *(*ptr)++ << (8 * i);
+  *prev ^= xor;
+  double result;
+  memcpy(&result, prev, sizeof(double));
+  return result;
+}
+
+/**
+ * Write a double either in raw form or, for compressed values, as the XOR
+ * with the previous one
+ */
+static void
+packed_write_value(StringInfo buf, double value, uint64 *prev,
+  bool compressed)
+{
+  if (compressed)
+    packed_write_double(buf, value, prev);
+  else
+    appendBinaryStringInfo(buf, (char *) &value, sizeof(double));
+}
+
+/**
+ * Read a double written by packed_write_value and advance the pointer
+ */
+static double
+packed_read_value(const uint8 **ptr, uint64 *prev, bool compressed)
+{
+  if (compressed)
+    return packed_read_double(ptr, prev);
+  double result;
+  memcpy(&result, *ptr, sizeof(double));
+  *ptr += sizeof(double);
+  return result;
+}
+
+/*****************************************************************************
+ * General functions
+ *****************************************************************************/
+
+/**
+ * Returns true if the temporal values of the base type can be packed,
+ * that is, if the base values have a fixed-size raw representation
+ */
+bool
+temporal_packable(Oid valuetypid)
+{
+  return (valuetypid == BOOLOID || valuetypid == INT4OID ||
+    valuetypid == FLOAT8OID || valuetypid == type_oid(T_GEOMETRY) ||
+    valuetypid == type_oid(T_GEOGRAPHY));
+}
+
+/**
+ * Returns a pointer to the precomputed bounding box of the packed value
+ */
+void *
+temporalpacked_bbox_ptr(const TemporalPacked *temp)
+{
+  return (char *) temp + double_pad(sizeof(TemporalPacked));
+}
+
+/**
+ * Returns the number of chunks of the packed value
+ */
+int
+temporalpacked_nchunks(const TemporalPacked *temp)
+{
+  return (temp->totalcount + PACKED_CHUNK_INSTANTS - 1) /
+    PACKED_CHUNK_INSTANTS;
+}
+
+/**
+ * Returns the size of the directory of the chunks of a packed value, which
+ * is empty when the value has a single chunk
+ */
+static size_t
+temporalpacked_dir_size(Oid valuetypid, int nchunks)
+{
+  if (nchunks <= 1)
+    return 0;
+  return double_pad(sizeof(int32) * nchunks) +
+    double_pad(temporal_bbox_size(valuetypid)) * nchunks;
+}
+
+/**
+ * Returns a pointer to the offsets of the chunks of the packed value
+ *
+ * @pre The value has more than one chunk
+ */
+static const int32 *
+temporalpacked_chunk_offsets(const TemporalPacked *temp)
+{
+  return (int32 *) ((char *) temp + double_pad(sizeof(TemporalPacked)) +
+    double_pad(temporal_bbox_size(temp->valuetypid)));
+}
+
+/**
+ * Returns a pointer to the bounding box of the n-th chunk of the packed
+ * value, which is the bounding box of the value when it has a single chunk
+ */
+static void *
+temporalpacked_chunk_bbox(const TemporalPacked *temp, int n)
+{
+  int nchunks = temporalpacked_nchunks(temp);
+  if (nchunks == 1)
+    return temporalpacked_bbox_ptr(temp);
+  return (char *) temporalpacked_chunk_offsets(temp) +
+    double_pad(sizeof(int32) * nchunks) +
+    double_pad(temporal_bbox_size(temp->valuetypid)) * n;
+}
+
+/**
+ * Returns a pointer to the encoded data of the packed value
+ */
+static const uint8 *
+temporalpacked_data_ptr(const TemporalPacked *temp)
+{
+  return (uint8 *) temp + double_pad(sizeof(TemporalPacked)) +
+    double_pad(temporal_bbox_size(temp->valuetypid)) +
+    temporalpacked_dir_size(temp->valuetypid, temporalpacked_nchunks(temp));
+}
+
+/**
+ * Construct a point from its coordinates
+ *
+ * @param[in] x,y,z Coordinates
+ * @param[in] srid SRID
+ * @param[in] hasz True when the point has Z coordinates
+ * @param[in] geodetic True for geography, false for geometry
+ */
+static Datum
+temporalpacked_point_make(double x, double y, double z, int32 srid,
+  bool hasz, bool geodetic)
+{
+  LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, x, y, z) :
+    lwpoint_make2d(srid, x, y);
+  FLAGS_SET_GEODETIC(lwpoint->flags, geodetic);
+  Datum result = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
+  lwpoint_free(lwpoint);
+  return result;
+}
+
+/*****************************************************************************
+ * Pack and unpack functions
+ *****************************************************************************/
+
+/**
+ * Write the timestamps and the values of the instants into the buffer
+ *
+ * @param[in,out] buf Buffer
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ * @param[in] compressed True when the timestamps and the values are
+ * compressed, false when they are written in raw form
+ */
+static void
+tinstantarr_pack(StringInfo buf, TInstant **instants, int count,
+  bool compressed)
+{
+  Oid valuetypid = instants[0]->valuetypid;
+  bool hasz = MOBDB_FLAGS_GET_Z(instants[0]->flags);
+  /* Timestamps */
+  uint64 prevt = 0, prevdelta = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (! compressed)
+    {
+      appendBinaryStringInfo(buf, (char *) &instants[i]->t,
+        sizeof(TimestampTz));
+      continue;
+    }
+    uint64 t = (uint64) instants[i]->t;
+    uint64 delta = t - prevt;
+    packed_write_varint(buf, zigzag_encode(delta - prevdelta));
+    prevt = t;
+    prevdelta = delta;
+  }
+  /* Values */
+  uint64 prev[3] = {0, 0, 0};
+  int32 previnteger = 0;
+  for (int i = 0; i < count; i++)
+  {
+    Datum value = tinstant_value(instants[i]);
+    if (valuetypid == BOOLOID)
+      appendStringInfoCharMacro(buf, (char) DatumGetBool(value));
+    else if (valuetypid == INT4OID)
+    {
+      int32 integer = DatumGetInt32(value);
+      if (compressed)
+        packed_write_varint(buf,
+          zigzag_encode((uint64) ((int64) integer - previnteger)));
+      else
+        appendBinaryStringInfo(buf, (char *) &integer, sizeof(int32));
+      previnteger = integer;
+    }
+    else if (valuetypid == FLOAT8OID)
+      packed_write_value(buf, DatumGetFloat8(value), &prev[0], compressed);
+    else if (hasz)
+    {
+      POINT3DZ point = datum_get_point3dz(value);
+      packed_write_value(buf, point.x, &prev[0], compressed);
+      packed_write_value(buf, point.y, &prev[1], compressed);
+      packed_write_value(buf, point.z, &prev[2], compressed);
+    }
+    else
+    {
+      POINT2D point = datum_get_point2d(value);
+      packed_write_value(buf, point.x, &prev[0], compressed);
+      packed_write_value(buf, point.y, &prev[1], compressed);
+    }
+  }
+  return;
+}
+
+/**
+ * Write the instants into the buffer split into chunks whose streams are
+ * encoded independently
+ *
+ * @param[in,out] buf Buffer
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ * @param[in] compressed True when the chunks are compressed
+ * @param[out] offsets Offsets of the chunks in the buffer
+ */
+static void
+tinstantarr_pack_chunks(StringInfo buf, TInstant **instants, int count,
+  bool compressed, int32 *offsets)
+{
+  for (int i = 0, k = 0; i < count; i += PACKED_CHUNK_INSTANTS, k++)
+  {
+    offsets[k] = buf->len;
+    tinstantarr_pack(buf, &instants[i], Min(PACKED_CHUNK_INSTANTS, count - i),
+      compressed);
+  }
+  return;
+}
+
+/**
+ * Read the instants of a chunk written by tinstantarr_pack
+ *
+ * @param[in] temp Packed value
+ * @param[in] ptr Pointer to the encoded chunk
+ * @param[in] count Number of instants of the chunk
+ * @param[in] nvalues Number of instants to decode, the others are skipped
+ * @param[out] result Array of temporal instants
+ */
+static void
+tinstantarr_unpack(const TemporalPacked *temp, const uint8 *ptr, int count,
+  int nvalues, TInstant **result)
+{
+  Oid valuetypid = temp->valuetypid;
+  bool isgeo = tgeo_base_type(valuetypid);
+  bool hasz = MOBDB_FLAGS_GET_Z(temp->flags);
+  bool geodetic = MOBDB_FLAGS_GET_GEODETIC(temp->flags);
+  bool compressed = MOBDB_FLAGS_GET_COMPRESSED(temp->flags);
+  int32 srid = isgeo ?
+    ((STBOX *) temporalpacked_bbox_ptr(temp))->srid : 0;
+  /* Timestamps */
+  TimestampTz *times = palloc(sizeof(TimestampTz) * count);
+  uint64 prevt = 0, prevdelta = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (! compressed)
+    {
+      memcpy(&times[i], ptr, sizeof(TimestampTz));
+      ptr += sizeof(TimestampTz);
+      continue;
+    }
+    prevdelta += zigzag_decode(packed_read_varint(&ptr));
+    prevt += prevdelta;
+    times[i] = (TimestampTz) prevt;
+  }
+  /* Values */
+  uint64 prev[3] = {0, 0, 0};
+  int32 previnteger = 0;
+  for (int i = 0; i < nvalues; i++)
+  {
+    Datum value;
+    if (valuetypid == BOOLOID)
+      value = BoolGetDatum(*ptr++ != 0);
+    else if (valuetypid == INT4OID)
+    {
+      if (compressed)
+        previnteger = (int32) ((int64) previnteger +
+          (int64) zigzag_decode(packed_read_varint(&ptr)));
+      else
+      {
+        memcpy(&previnteger, ptr, sizeof(int32));
+        ptr += sizeof(int32);
+      }
+      value = Int32GetDatum(previnteger);
+    }
+    else if (valuetypid == FLOAT8OID)
+      value = Float8GetDatum(packed_read_value(&ptr, &prev[0], compressed));
+    else
+    {
+      double x = packed_read_value(&ptr, &prev[0], compressed);
+      double y = packed_read_value(&ptr, &prev[1], compressed);
+      double z = hasz ? packed_read_value(&ptr, &prev[2], compressed) : 0;
+      value = temporalpacked_point_make(x, y, z, srid, hasz, geodetic);
+    }
+    result[i] = tinstant_make(value, times[i], valuetypid);
+    if (isgeo)
+      pfree(DatumGetPointer(value));
+  }
+  pfree(times);
+  return;
+}
+
+/**
+ * Construct a packed value from the header of the temporal value and the
+ * encoded data
+ *
+ * The memory structure of a packed value is as follows
+ * @code
+ * ------------------------------------------------------------------------
+ * ( TemporalPacked )_X | ( bbox )_X | ( directory )_X | encoded data ...
+ * ------------------------------------------------------------------------
+ * @endcode
+ * where the `X` are unused bytes added for double padding. The directory,
+ * which is only present when there is more than one chunk, contains the
+ * offsets of the chunks in the encoded data followed by their bounding
+ * boxes, the bounding box of a chunk also covers the first instant of the
+ * next chunk so that the segment between two chunks belongs to the first
+ * one. For sequence sets the encoded data starts with the number of
+ * instants and the bounds of each sequence, for sequences it starts with
+ * the bounds, and it continues with the timestamps and the values of the
+ * instants of each chunk, either in raw or in compressed form.
+ *
+ * @param[in] temp Temporal value
+ * @param[in] count Number of instants or sequences
+ * @param[in] instants Array of all the instants of the value
+ * @param[in] totalcount Number of elements in the array
+ * @param[in] offsets Offsets of the chunks in the encoded data
+ * @param[in] buf Encoded data
+ * @param[in] compressed True when the data is compressed
+ */
+static TemporalPacked *
+temporalpacked_make(const Temporal *temp, int count, TInstant **instants,
+  int totalcount, const int32 *offsets, StringInfo buf, bool compressed)
+{
+  size_t bboxsize = temporal_bbox_size(temp->valuetypid);
+  int nchunks = (totalcount + PACKED_CHUNK_INSTANTS - 1) /
+    PACKED_CHUNK_INSTANTS;
+  size_t pdata = double_pad(sizeof(TemporalPacked)) + double_pad(bboxsize) +
+    temporalpacked_dir_size(temp->valuetypid, nchunks);
+  TemporalPacked *result = palloc0(pdata + buf->len);
+  SET_VARSIZE(result, pdata + buf->len);
+  result->duration = temp->duration;
+  result->flags = temp->flags;
+  MOBDB_FLAGS_SET_PACKED(result->flags, true);
+  MOBDB_FLAGS_SET_COMPRESSED(result->flags, compressed);
+  result->valuetypid = temp->valuetypid;
+  result->count = count;
+  result->totalcount = totalcount;
+  memcpy(temporalpacked_bbox_ptr(result), temporal_bbox_ptr(temp), bboxsize);
+  if (nchunks > 1)
+  {
+    memcpy((void *) temporalpacked_chunk_offsets(result), offsets,
+      sizeof(int32) * nchunks);
+    for (int i = 0; i < nchunks; i++)
+    {
+      int first = i * PACKED_CHUNK_INSTANTS;
+      tinstantset_make_bbox(temporalpacked_chunk_bbox(result, i),
+        &instants[first], Min(PACKED_CHUNK_INSTANTS + 1, totalcount - first));
+    }
+  }
+  memcpy((char *) result + pdata, buf->data, buf->len);
+  return result;
+}
+
+/**
+ * Returns the bounds of the period encoded in a single byte
+ */
+static inline char
+period_bounds_pack(const Period *p)
+{
+  return (char) (p->lower_inc | (p->upper_inc << 1));
+}
+
+/**
+ * Construct a packed value from the instants of a temporal value
+ */
+static TemporalPacked *
+tinstantarr_pack_temporal(const Temporal *temp, int count,
+  TInstant **instants, int totalcount, StringInfo buf, bool compressed)
+{
+  int32 *offsets = palloc(sizeof(int32) *
+    ((totalcount + PACKED_CHUNK_INSTANTS - 1) / PACKED_CHUNK_INSTANTS));
+  tinstantarr_pack_chunks(buf, instants, totalcount, compressed, offsets);
+  TemporalPacked *result = temporalpacked_make(temp, count, instants,
+    totalcount, offsets, buf, compressed);
+  pfree(offsets);
+  return result;
+}
+
+/**
+ * Construct a packed value from a temporal instant set value
+ */
+static TemporalPacked *
+tinstantset_pack(const TInstantSet *ti, bool compressed)
+{
+  StringInfoData buf;
+  initStringInfo(&buf);
+  TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+  for (int i = 0; i < ti->count; i++)
+    instants[i] = tinstantset_inst_n(ti, i);
+  TemporalPacked *result = tinstantarr_pack_temporal((Temporal *) ti,
+    ti->count, instants, ti->count, &buf, compressed);
+  pfree(instants); pfree(buf.data);
+  return result;
+}
+
+/**
+ * Construct a packed value from a temporal sequence value
+ */
+static TemporalPacked *
+tsequence_pack(const TSequence *seq, bool compressed)
+{
+  StringInfoData buf;
+  initStringInfo(&buf);
+  appendStringInfoCharMacro(&buf, period_bounds_pack(&seq->period));
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  for (int i = 0; i < seq->count; i++)
+    instants[i] = tsequence_inst_n(seq, i);
+  TemporalPacked *result = tinstantarr_pack_temporal((Temporal *) seq, 1,
+    instants, seq->count, &buf, compressed);
+  pfree(instants); pfree(buf.data);
+  return result;
+}
+
+/**
+ * Construct a packed value from a temporal sequence set value
+ */
+static TemporalPacked *
+tsequenceset_pack(const TSequenceSet *ts, bool compressed)
+{
+  StringInfoData buf;
+  initStringInfo(&buf);
+  TInstant **instants = palloc(sizeof(TInstant *) * ts->totalcount);
+  int k = 0;
+  for (int i = 0; i < ts->count; i++)
+  {
+    TSequence *seq = tsequenceset_seq_n(ts, i);
+    packed_write_varint(&buf, (uint64) seq->count);
+    appendStringInfoCharMacro(&buf, period_bounds_pack(&seq->period));
+    for (int j = 0; j < seq->count; j++)
+      instants[k++] = tsequence_inst_n(seq, j);
+  }
+  TemporalPacked *result = tinstantarr_pack_temporal((Temporal *) ts,
+    ts->count, instants, ts->totalcount, &buf, compressed);
+  pfree(instants); pfree(buf.data);
+  return result;
+}
+
+/**
+ * Read the number of instants and the bounds of the sequences of the packed
+ * value, which is a single sequence for values of sequence duration, and
+ * returns a pointer to the encoded data that follows them
+ */
+static const uint8 *
+temporalpacked_seqs_unpack(const TemporalPacked *temp, int *counts,
+  uint8 *bounds)
+{
+  const uint8 *ptr = temporalpacked_data_ptr(temp);
+  if (temp->duration == SEQUENCE)
+  {
+    counts[0] = temp->totalcount;
+    bounds[0] = *ptr++;
+  }
+  else if (temp->duration == SEQUENCESET)
+  {
+    for (int i = 0; i < temp->count; i++)
+    {
+      counts[i] = (int) packed_read_varint(&ptr);
+      bounds[i] = *ptr++;
+    }
+  }
+  return ptr;
+}
+
+/**
+ * Returns a pointer to the encoded data of the n-th chunk of the packed
+ * value
+ *
+ * @param[in] temp Packed value
+ * @param[in] first Pointer to the first chunk
+ * @param[in] n Number of the chunk
+ */
+static const uint8 *
+temporalpacked_chunk_ptr(const TemporalPacked *temp, const uint8 *first,
+  int n)
+{
+  if (n == 0)
+    return first;
+  return temporalpacked_data_ptr(temp) + temporalpacked_chunk_offsets(temp)[n];
+}
+
+/**
+ * Construct a temporal value from the instants decoded from a packed value
+ *
+ * The instants are consecutive in the value when their positions are
+ * consecutive. Each maximal run of consecutive instants of a sequence
+ * yields a subsequence, whose bounds are those of the sequence if the run
+ * starts or ends at the first or the last instant of the sequence, and are
+ * inclusive otherwise.
+ *
+ * @param[in] temp Packed value
+ * @param[in] instants Decoded instants, freed by the function
+ * @param[in] index Positions of the instants in the value
+ * @param[in] count Number of elements in the arrays
+ * @param[in] counts,bounds Number of instants and bounds of the sequences
+ * @result Returns NULL if the instants do not define a value
+ */
+static Temporal *
+temporalpacked_make_subvalue(const TemporalPacked *temp, TInstant **instants,
+  const int *index, int count, const int *counts, const uint8 *bounds)
+{
+  if (temp->duration == INSTANTSET)
+    return (Temporal *) tinstantset_make_free(instants, count);
+
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  TSequence **sequences = palloc(sizeof(TSequence *) * Max(count, 1));
+  int nseqs = 0, seq = 0, seqstart = 0;
+  int i = 0;
+  while (i < count)
+  {
+    while (index[i] >= seqstart + counts[seq])
+      seqstart += counts[seq++];
+    int seqend = seqstart + counts[seq];
+    int j = i + 1;
+    while (j < count && index[j] == index[j - 1] + 1 && index[j] < seqend)
+      j++;
+    bool lower_inc = (index[i] == seqstart) ? (bounds[seq] & 1) : true;
+    bool upper_inc = (index[j - 1] == seqend - 1) ?
+      (bounds[seq] & 2) != 0 : true;
+    /* A single instant at an exclusive bound is not part of the value */
+    if (j - i > 1 || (lower_inc && upper_inc))
+      sequences[nseqs++] = tsequence_make_traj(&instants[i], j - i,
+        lower_inc, upper_inc, linear, NORMALIZE_NO, false);
+    i = j;
+  }
+  for (i = 0; i < count; i++)
+    pfree(instants[i]);
+  pfree(instants);
+  if (temp->duration == SEQUENCE && nseqs == 1)
+  {
+    TSequence *result = sequences[0];
+    pfree(sequences);
+    return (Temporal *) result;
+  }
+  return (Temporal *) tsequenceset_make_free(sequences, nseqs, NORMALIZE_NO);
+}
+
+/**
+ * Construct a temporal value from a packed value
+ *
+ * The decoded value only lives for the duration of the function call,
+ * thus the trajectory of temporal points is not precomputed, it is built
+ * by the functions requiring it.
+ *
+ * @note The packed value was obtained from a valid and normalized
+ * temporal value and thus the sequences need not be normalized again.
+ */
+static Temporal *
+temporalpacked_unpack(const TemporalPacked *temp)
+{
+  int *counts = palloc(sizeof(int) * Max(temp->count, 1));
+  uint8 *bounds = palloc(sizeof(uint8) * Max(temp->count, 1));
+  const uint8 *ptr = temporalpacked_seqs_unpack(temp, counts, bounds);
+  int nchunks = temporalpacked_nchunks(temp);
+  TInstant **instants = palloc(sizeof(TInstant *) * temp->totalcount);
+  for (int i = 0; i < nchunks; i++)
+  {
+    int first = i * PACKED_CHUNK_INSTANTS;
+    int n = Min(PACKED_CHUNK_INSTANTS, temp->totalcount - first);
+    tinstantarr_unpack(temp, temporalpacked_chunk_ptr(temp, ptr, i), n, n,
+      &instants[first]);
+  }
+
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  Temporal *result;
+  if (temp->duration == INSTANTSET)
+    result = (Temporal *) tinstantset_make_free(instants, temp->totalcount);
+  else if (temp->duration == SEQUENCE)
+  {
+    result = (Temporal *) tsequence_make_traj(instants, temp->totalcount,
+      bounds[0] & 1, (bounds[0] & 2) != 0, linear, NORMALIZE_NO, false);
+    for (int i = 0; i < temp->totalcount; i++)
+      pfree(instants[i]);
+    pfree(instants);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequence **sequences = palloc(sizeof(TSequence *) * temp->count);
+    int k = 0;
+    for (int i = 0; i < temp->count; i++)
+    {
+      sequences[i] = tsequence_make_traj(&instants[k], counts[i],
+        bounds[i] & 1, (bounds[i] & 2) != 0, linear, NORMALIZE_NO, false);
+      k += counts[i];
+    }
+    result = (Temporal *) tsequenceset_make_free(sequences, temp->count,
+      NORMALIZE_NO);
+    for (int i = 0; i < temp->totalcount; i++)
+      pfree(instants[i]);
+    pfree(instants);
+  }
+  pfree(counts); pfree(bounds);
+  return result;
+}
+
+/**
+ * Returns the temporal value in packed or compressed form if its duration
+ * and base type allow it, returns the value unchanged otherwise (dispatch
+ * function)
+ *
+ * @param[in] temp Temporal value
+ * @param[in] storage Storage, either packed or compressed
+ */
+Temporal *
+temporal_pack(Temporal *temp, TStorage storage)
+{
+  if (temp->duration == INSTANT || MOBDB_FLAGS_GET_PACKED(temp->flags) ||
+    ! temporal_packable(temp->valuetypid))
+    return temp;
+  TemporalPacked *result;
+  bool compressed = (storage == STORAGE_COMPRESSED);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANTSET)
+    result = tinstantset_pack((TInstantSet *) temp, compressed);
+  else if (temp->duration == SEQUENCE)
+    result = tsequence_pack((TSequence *) temp, compressed);
+  else /* temp->duration == SEQUENCESET */
+    result = tsequenceset_pack((TSequenceSet *) temp, compressed);
+  return (Temporal *) result;
+}
+
+/**
+ * Returns the temporal value in unpacked form
+ *
+ * @note This function is called by PG_GETARG_TEMPORAL for every temporal
+ * argument and thus the test for values that are not packed must be cheap
+ */
+Temporal *
+temporal_unpack(Temporal *temp)
+{
+  if (! MOBDB_FLAGS_GET_PACKED(temp->flags))
+    return temp;
+  return temporalpacked_unpack((TemporalPacked *) temp);
+}
+
+/*****************************************************************************
+ * Lazy decoding
+ *****************************************************************************/
+
+/**
+ * Returns the subvalue of the packed value composed of the instants of the
+ * selected chunks, NULL if no chunk is selected
+ *
+ * Each maximal run of selected chunks is extended with the first instant of
+ * the next chunk, since the bounding box of a chunk covers the segment
+ * ending at this instant. Only the timestamps of the next chunk and its
+ * first value are decoded.
+ */
+static Temporal *
+temporalpacked_decode_chunks(const TemporalPacked *temp, const bool *selected)
+{
+  int nchunks = temporalpacked_nchunks(temp);
+  int *counts = palloc(sizeof(int) * Max(temp->count, 1));
+  uint8 *bounds = palloc(sizeof(uint8) * Max(temp->count, 1));
+  const uint8 *ptr = temporalpacked_seqs_unpack(temp, counts, bounds);
+  TInstant **instants = palloc(sizeof(TInstant *) * temp->totalcount);
+  int *index = palloc(sizeof(int) * temp->totalcount);
+  int k = 0;
+  for (int i = 0; i < nchunks; i++)
+  {
+    bool next = (i > 0 && selected[i - 1]);
+    if (! selected[i] && ! next)
+    {
+      COUNTER_INC(packed_skips);
+      continue;
+    }
+    int first = i * PACKED_CHUNK_INSTANTS;
+    int n = Min(PACKED_CHUNK_INSTANTS, temp->totalcount - first);
+    int nvalues = selected[i] ? n : 1;
+    tinstantarr_unpack(temp, temporalpacked_chunk_ptr(temp, ptr, i), n,
+      nvalues, &instants[k]);
+    for (int j = 0; j < nvalues; j++)
+      index[k++] = first + j;
+  }
+  Temporal *result = NULL;
+  if (k > 0)
+    result = temporalpacked_make_subvalue(temp, instants, index, k, counts,
+      bounds);
+  else
+    pfree(instants);
+  pfree(index); pfree(counts); pfree(bounds);
+  return result;
+}
+
+/**
+ * Returns the smallest subvalue of the packed value whose restriction to
+ * the period is the restriction of the value, decoding only the chunks
+ * whose bounding box overlaps the period
+ *
+ * @result Returns NULL if the value does not overlap the period
+ */
+Temporal *
+temporalpacked_decode_period(const TemporalPacked *temp, const Period *p)
+{
+  int nchunks = temporalpacked_nchunks(temp);
+  bool *selected = palloc(sizeof(bool) * nchunks);
+  bool found = false;
+  for (int i = 0; i < nchunks; i++)
+  {
+    const bboxunion *box = temporalpacked_chunk_bbox(temp, i);
+    TimestampTz tmin, tmax;
+    if (talpha_base_type(temp->valuetypid))
+    {
+      tmin = box->p.lower;
+      tmax = box->p.upper;
+    }
+    else if (tnumber_base_type(temp->valuetypid))
+    {
+      tmin = box->b.tmin;
+      tmax = box->b.tmax;
+    }
+    else /* tgeo_base_type(temp->valuetypid) */
+    {
+      tmin = box->g.tmin;
+      tmax = box->g.tmax;
+    }
+    selected[i] = (tmin <= p->upper && p->lower <= tmax);
+    found |= selected[i];
+  }
+  Temporal *result = found ?
+    temporalpacked_decode_chunks(temp, selected) : NULL;
+  pfree(selected);
+  return result;
+}
+
+/**
+ * Returns the smallest subvalue of the packed temporal point whose
+ * restriction to the spatiotemporal box is the restriction of the value,
+ * decoding only the chunks whose bounding box overlaps the box
+ *
+ * @pre The temporal point is planar
+ * @result Returns NULL if the value does not overlap the box
+ */
+Temporal *
+temporalpacked_decode_stbox(const TemporalPacked *temp, const STBOX *box)
+{
+  int nchunks = temporalpacked_nchunks(temp);
+  bool *selected = palloc(sizeof(bool) * nchunks);
+  bool found = false;
+  for (int i = 0; i < nchunks; i++)
+  {
+    selected[i] = overlaps_stbox_stbox_internal(
+      temporalpacked_chunk_bbox(temp, i), box);
+    found |= selected[i];
+  }
+  Temporal *result = found ?
+    temporalpacked_decode_chunks(temp, selected) : NULL;
+  pfree(selected);
+  return result;
+}
+
+/*****************************************************************************/
@@ -17,6 +17,12 @@
 
 #include "temporal_parser.h"
 
+#include <errno.h>
+#include <math.h>
+#include <pgtime.h>
+#include <utils/datetime.h>
+#include <utils/timestamp.h>
+
 #include "periodset.h"
 #include "period.h"
 #include "timestampset.h"
@@ -173,6 +179,24 @@ double_parse(char **str)
   return result;
 }
 
+/**
+ * Parse a float from a null-terminated string without calling the input
+ * function of the type, returns false if the string is not a finite number
+ * that can be represented, in which case the input function must be called
+ * for obtaining its value or the error message
+ */
+static bool
+float8_parse_fast(char *str, double *result)
+{
+  char *end;
+  errno = 0;
+  *result = strtod(str, &end);
+  if (end == str || errno != 0 || ! isfinite(*result))
+    return false;
+  p_whitespace(&end);
+  return *end == '\0';
+}
+
 /**
  * Parse a base value from the buffer
  */
@@ -201,7 +225,12 @@ basetype_parse(char **str, Oid basetype)
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse element value")));
   (*str)[delim] = '\0';
-  Datum result = call_input(basetype, *str);
+  Datum result;
+  double d;
+  if (basetype == FLOAT8OID && float8_parse_fast(*str, &d))
+    result = Float8GetDatum(d);
+  else
+    result = call_input(basetype, *str);
   if (isttext)
     /* Replace the double quote */
     (*str)[delim++] = '"';
@@ -294,6 +323,108 @@ tbox_parse(char **str)
 /*****************************************************************************/
 /* Time Types */
 
+/**
+ * Parse a number of exactly the given number of digits
+ */
+static bool
+digits_parse(char **str, int count, int *result)
+{
+  int value = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if ((*str)[i] < '0' || (*str)[i] > '9')
+      return false;
+    value = value * 10 + (*str)[i] - '0';
+  }
+  *str += count;
+  *result = value;
+  return true;
+}
+
+/**
+ * Parse a timestamp in ISO 8601 format from a null-terminated string
+ * without calling the input function of the type
+ *
+ * Only the format `YYYY-MM-DD[( |T)HH:MM[:SS[.ffffff]][(+|-)HH[[:]MM]]]`
+ * is accepted, with the time zone of the session when no offset is given.
+ * The function returns false for any other input, e.g., special values,
+ * out of range fields, or leap seconds, in which case the input function
+ * must be called for obtaining its value or the error message.
+ */
+static bool
+timestamp_parse_fast(char *str, TimestampTz *result)
+{
+  struct pg_tm tm;
+  fsec_t fsec = 0;
+  int tz = 0, value;
+  bool hastz = false;
+
+  memset(&tm, 0, sizeof(struct pg_tm));
+  if (! digits_parse(&str, 4, &tm.tm_year) || *str++ != '-' ||
+      ! digits_parse(&str, 2, &tm.tm_mon) || *str++ != '-' ||
+      ! digits_parse(&str, 2, &tm.tm_mday))
+    return false;
+  if (tm.tm_year == 0 || tm.tm_mon < 1 || tm.tm_mon > MONTHS_PER_YEAR ||
+      tm.tm_mday < 1 || tm.tm_mday > day_tab[isleap(tm.tm_year)][tm.tm_mon - 1])
+    return false;
+  if ((*str == ' ' || *str == 'T') && str[1] >= '0' && str[1] <= '9')
+  {
+    str++;
+    if (! digits_parse(&str, 2, &tm.tm_hour) || *str++ != ':' ||
+        ! digits_parse(&str, 2, &tm.tm_min))
+      return false;
+    if (*str == ':')
+    {
+      str++;
+      if (! digits_parse(&str, 2, &tm.tm_sec))
+        return false;
+      if (*str == '.')
+      {
+        int ndigits = 0, scale = USECS_PER_SEC;
+        str++;
+        while (*str >= '0' && *str <= '9')
+        {
+          /* Fractions of microseconds are rounded by the input function */
+          if (++ndigits > 6)
+            return false;
+          scale /= 10;
+          fsec += (*str++ - '0') * scale;
+        }
+        if (ndigits == 0)
+          return false;
+      }
+    }
+    if (tm.tm_hour >= HOURS_PER_DAY || tm.tm_min >= MINS_PER_HOUR ||
+        tm.tm_sec >= SECS_PER_MINUTE)
+      return false;
+    if (*str == '+' || *str == '-')
+    {
+      int sign = (*str++ == '+') ? 1 : -1;
+      if (! digits_parse(&str, 2, &value) || value > MAX_TZDISP_HOUR)
+        return false;
+      tz = value * SECS_PER_HOUR;
+      if (*str == ':')
+        str++;
+      if (*str >= '0' && *str <= '9')
+      {
+        if (! digits_parse(&str, 2, &value) || value >= MINS_PER_HOUR)
+          return false;
+        tz += value * SECS_PER_MINUTE;
+      }
+      /* PostgreSQL stores the offsets as seconds west of UTC */
+      tz = - sign * tz;
+      hastz = true;
+    }
+  }
+  p_whitespace(&str);
+  if (*str != '\0')
+    return false;
+  if (! hastz)
+    tz = DetermineTimeZoneOffset(&tm, session_timezone);
+  return (tm2timestamp(&tm, fsec, &tz, result) == 0 &&
+    IS_VALID_TIMESTAMP(*result));
+}
+
 /**
  * Parse a timestamp value from the buffer
  */
@@ -307,7 +438,9 @@ timestamp_parse(char **str)
     delim++;
   char bak = (*str)[delim];
   (*str)[delim] = '\0';
-  Datum result = call_input(TIMESTAMPTZOID, *str);
+  TimestampTz result;
+  if (! timestamp_parse_fast(*str, &result))
+    result = DatumGetTimestampTz(call_input(TIMESTAMPTZOID, *str));
   (*str)[delim] = bak;
   *str += delim;
   return result;
@@ -0,0 +1,181 @@
+/*****************************************************************************
+ *
+ * temporal_rollup.c
+ *    Background worker refreshing the rollups of temporal aggregates
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file temporal_rollup.c
+ * A rollup keeps in a table the partial states of a temporal aggregate,
+ * such as tcount, tavg, or extent, over the rows of a source table grouped
+ * by an expression. The rows appended to the source table are tracked with
+ * a watermark column, and the function refreshRollup merges the states of
+ * the rows above the last watermark into the stored states with the merge
+ * aggregates of the states. The rollups are registered in the table
+ * mobilitydb_rollups by the function createRollup, they are defined in SQL.
+ *
+ * When the extension is loaded with shared_preload_libraries and the
+ * parameter mobilitydb.rollup_database is set, a background worker connects
+ * to this database and calls refreshRollups every mobilitydb.rollup_naptime
+ * seconds.
+ */
+
+#include "temporal_rollup.h"
+
+#include <miscadmin.h>
+#include <pgstat.h>
+#include <access/xact.h>
+#include <executor/spi.h>
+#include <postmaster/bgworker.h>
+#include <storage/ipc.h>
+#include <storage/latch.h>
+#include <storage/proc.h>
+#include <utils/guc.h>
+#include <utils/snapmgr.h>
+
+/*****************************************************************************/
+
+/**
+ * Global variable that states the database of the rollups refreshed by the
+ * background worker. It is set by the configuration parameter
+ * mobilitydb.rollup_database, NULL or empty disables the worker.
+ */
+char *rollup_database = NULL;
+
+/**
+ * Global variable that states the number of seconds between two refreshes
+ * of the rollups. It is set by the configuration parameter
+ * mobilitydb.rollup_naptime.
+ */
+int rollup_naptime = 60;
+
+/** Flags set by the signal handlers of the worker */
+static volatile sig_atomic_t rollup_got_sigterm = false;
+static volatile sig_atomic_t rollup_got_sighup = false;
+
+/**
+ * Signal handler for SIGTERM, which ends the worker
+ */
+static void
+rollup_sigterm(SIGNAL_ARGS)
+{
+  int save_errno = errno;
+  rollup_got_sigterm = true;
+  SetLatch(MyLatch);
+  errno = save_errno;
+}
+
+/**
+ * Signal handler for SIGHUP, which reloads the configuration
+ */
+static void
+rollup_sighup(SIGNAL_ARGS)
+{
+  int save_errno = errno;
+  rollup_got_sighup = true;
+  SetLatch(MyLatch);
+  errno = save_errno;
+}
+
+/**
+ * Refreshes the rollups of the database in a transaction, if the extension
+ * is installed in it
+ */
+static void
+rollup_refresh(void)
+{
+  SetCurrentStatementStartTimestamp();
+  StartTransactionCommand();
+  SPI_connect();
+  PushActiveSnapshot(GetTransactionSnapshot());
+  pgstat_report_activity(STATE_RUNNING, "refreshing the rollups");
+
+  int ret = SPI_execute("SELECT 1 FROM pg_catalog.pg_class "
+    "WHERE relname = 'mobilitydb_rollups' AND relkind = 'r'", true, 1);
+  if (ret != SPI_OK_SELECT)
+    elog(FATAL, "Cannot look for the table of the rollups");
+  if (SPI_processed > 0)
+  {
+    ret = SPI_execute("SELECT refreshRollups()", false, 0);
+    if (ret != SPI_OK_SELECT)
+      elog(FATAL, "Cannot refresh the rollups");
+  }
+
+  SPI_finish();
+  PopActiveSnapshot();
+  CommitTransactionCommand();
+  pgstat_report_stat(false);
+  pgstat_report_activity(STATE_IDLE, NULL);
+}
+
+/**
+ * Main function of the background worker
+ */
+void
+rollup_worker_main(Datum arg)
+{
+  pqsignal(SIGHUP, rollup_sighup);
+  pqsignal(SIGTERM, rollup_sigterm);
+  BackgroundWorkerUnblockSignals();
+#if MOBDB_PGSQL_VERSION < 110000
+  BackgroundWorkerInitializeConnection(rollup_database, NULL);
+#else
+  BackgroundWorkerInitializeConnection(rollup_database, NULL, 0);
+#endif
+
+  while (! rollup_got_sigterm)
+  {
+    int rc = WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT |
+      WL_POSTMASTER_DEATH, rollup_naptime * 1000L, PG_WAIT_EXTENSION);
+    ResetLatch(MyLatch);
+    if (rc & WL_POSTMASTER_DEATH)
+      proc_exit(1);
+    CHECK_FOR_INTERRUPTS();
+    if (rollup_got_sighup)
+    {
+      rollup_got_sighup = false;
+      ProcessConfigFile(PGC_SIGHUP);
+    }
+    if (rollup_got_sigterm)
+      break;
+    rollup_refresh();
+  }
+  proc_exit(0);
+}
+
+/**
+ * Registers the background worker when the library is loaded with
+ * shared_preload_libraries and the database of the rollups is set
+ */
+void
+rollup_worker_init(void)
+{
+  if (! process_shared_preload_libraries_in_progress ||
+      rollup_database == NULL || rollup_database[0] == '\0')
+    return;
+
+  BackgroundWorker worker;
+  memset(&worker, 0, sizeof(BackgroundWorker));
+  worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+    BGWORKER_BACKEND_DATABASE_CONNECTION;
+  worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+  /* The worker is restarted after an error in a refresh */
+  worker.bgw_restart_time = rollup_naptime;
+  snprintf(worker.bgw_library_name, BGW_MAXLEN, "%s", MOBDB_LIBRARY_NAME);
+  snprintf(worker.bgw_function_name, BGW_MAXLEN, "rollup_worker_main");
+  snprintf(worker.bgw_name, BGW_MAXLEN, "MobilityDB rollup worker");
+#if MOBDB_PGSQL_VERSION >= 110000
+  snprintf(worker.bgw_type, BGW_MAXLEN, "MobilityDB rollup worker");
+#endif
+  worker.bgw_main_arg = (Datum) 0;
+  worker.bgw_notify_pid = 0;
+  RegisterBackgroundWorker(&worker);
+}
+
+/*****************************************************************************/
@@ -9,7 +9,12 @@
  * - B-tree comparison operators: <, <=, >, >=
  * - Bounding box operators: &&, @>, <@, ~=
  * - Relative position operators: <<#, &<#, #>>, #>>
- * - Ever/always comparison operators: ?=, %=, ?<>, %<>, ?<, %<, ...// TODO
+ * - Ever/always comparison operators: ?=, %=, ?<>, %<>, ?<, %<, ...
+ *
+ * The ever/always comparison operators of all temporal alphanumeric types
+ * are estimated by temporal_ever_sel. For tbool and ttext, it uses the most
+ * common base values collected by ANALYZE, for temporal numbers, it uses
+ * the histogram of the value ranges.
  *
  * Due to implicit casting, a condition such as tbool <<# timestamptz will be
  * transformed into tbool <<# period. This allows to reduce the number of
@@ -55,6 +60,9 @@
 #include "time_selfuncs.h"
 #include "rangetypes_ext.h"
 #include "temporal_analyze.h"
+#include "temporal_statscache.h"
+#include "temporal_util.h"
+#include "tnumber_selfuncs.h"
 #include "tpoint.h"
 
 /*****************************************************************************
@@ -445,6 +453,240 @@ temporal_sel(PG_FUNCTION_ARGS)
   PG_RETURN_FLOAT8(selec);
 }
 
+/*****************************************************************************
+ * Ever/always comparisons
+ *****************************************************************************/
+
+/**
+ * Get the comparison of the ever/always comparison operator, whose name is
+ * ? for ever or % for always followed by the name of the comparison
+ */
+static bool
+temporal_ever_cachedop(Oid operator, CachedOp *cachedOp, bool *ever)
+{
+  char *opname = get_opname(operator);
+  bool result = true;
+  if (opname == NULL)
+    return false;
+  if (opname[0] != '?' && opname[0] != '%')
+    result = false;
+  else if (strcmp(opname + 1, "=") == 0)
+    *cachedOp = EQ_OP;
+  else if (strcmp(opname + 1, "<>") == 0)
+    *cachedOp = NE_OP;
+  else if (strcmp(opname + 1, "<") == 0)
+    *cachedOp = LT_OP;
+  else if (strcmp(opname + 1, "<=") == 0)
+    *cachedOp = LE_OP;
+  else if (strcmp(opname + 1, ">") == 0)
+    *cachedOp = GT_OP;
+  else if (strcmp(opname + 1, ">=") == 0)
+    *cachedOp = GE_OP;
+  else
+    result = false;
+  *ever = (opname[0] == '?');
+  pfree(opname);
+  return result;
+}
+
+/**
+ * Returns a default selectivity estimate for the ever/always comparison,
+ * which is the one of scalar comparisons
+ */
+static double
+default_temporal_ever_selectivity(CachedOp cachedOp)
+{
+  if (cachedOp == EQ_OP)
+    return DEFAULT_EQ_SEL;
+  if (cachedOp == NE_OP)
+    return 1.0 - DEFAULT_EQ_SEL;
+  return DEFAULT_INEQ_SEL;
+}
+
+/**
+ * Returns true if the comparison of the two values is satisfied
+ */
+static bool
+datum_cachedop(Datum l, Datum r, Oid type, CachedOp cachedOp)
+{
+  if (cachedOp == LT_OP)
+    return datum_lt(l, r, type);
+  if (cachedOp == LE_OP)
+    return datum_le(l, r, type);
+  if (cachedOp == GT_OP)
+    return datum_gt(l, r, type);
+  /* cachedOp == GE_OP */
+  return datum_ge(l, r, type);
+}
+
+/**
+ * Estimate the selectivity of the ever/always comparison of a tbool or
+ * ttext column and a value, as a fraction of the non-null rows, from the
+ * most common base values. Returns -1 if the statistics are not available.
+ *
+ * A temporal value is ever less than a value iff it takes a base value less
+ * than it. This is estimated from the common base values satisfying the
+ * comparison, assuming that they are taken independently of each other.
+ *
+ * @param[in] vardata Information about the temporal column
+ * @param[in] value Value
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] cachedOp Comparison, which is EQ_OP, LT_OP, LE_OP, GT_OP,
+ * or GE_OP
+ * @param[in] ever True for an ever comparison, false for an always one,
+ * which is only possible for EQ_OP
+ */
+static double
+temporal_ever_sel_values(VariableStatData *vardata, Datum value,
+  Oid valuetypid, CachedOp cachedOp, bool ever)
+{
+  CachedStatsSlot *slot = statscache_slot(vardata, ever ?
+    STATISTIC_KIND_EVER_VALUES : STATISTIC_KIND_ALWAYS_VALUES,
+    ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS);
+  double none = 1.0;
+  bool found = false;
+
+  if (slot == NULL || slot->nnumbers != slot->nvalues + 1)
+    return -1.0;
+  for (int i = 0; i < slot->nvalues; i++)
+  {
+    if (cachedOp == EQ_OP)
+    {
+      if (datum_eq(slot->values[i], value, valuetypid))
+        return slot->numbers[i];
+    }
+    else if (datum_cachedop(slot->values[i], value, valuetypid, cachedOp))
+    {
+      none *= 1.0 - slot->numbers[i];
+      found = true;
+    }
+  }
+  /* The last number is the frequency of the values that are not common */
+  return found ? 1.0 - none : slot->numbers[slot->nvalues];
+}
+
+/**
+ * Estimate the selectivity of the ever/always comparison of a temporal
+ * column and a value (internal function)
+ *
+ * The always comparisons other than equality are the negation of an ever
+ * comparison, e.g., a temporal value is always less than a value iff it is
+ * not ever greater than or equal to it. Similarly, the ever and always not
+ * equal comparisons are the negation of the always and ever equal ones.
+ */
+Selectivity
+temporal_ever_sel_internal(VariableStatData *vardata, Datum value,
+  Oid valuetypid, CachedOp cachedOp, bool ever)
+{
+  CachedOp op = cachedOp;
+  bool opever = ever, negate = false;
+  double nullfrac = 0.0, selec;
+
+  if (cachedOp == NE_OP)
+  {
+    op = EQ_OP;
+    opever = ! ever;
+    negate = true;
+  }
+  else if (! ever && cachedOp != EQ_OP)
+  {
+    op = (cachedOp == LT_OP) ? GE_OP : (cachedOp == LE_OP) ? GT_OP :
+      (cachedOp == GT_OP) ? LE_OP : LT_OP;
+    opever = true;
+    negate = true;
+  }
+
+  if (tnumber_base_type(valuetypid))
+    selec = tnumber_ever_sel_internal(vardata, value, valuetypid, op, opever);
+  else
+    selec = temporal_ever_sel_values(vardata, value, valuetypid, op, opever);
+  if (selec < 0)
+    return default_temporal_ever_selectivity(cachedOp);
+  if (negate)
+    selec = 1.0 - selec;
+
+  /* The estimates are fractions of the non-null rows */
+  if (HeapTupleIsValid(vardata->statsTuple))
+    nullfrac = ((Form_pg_statistic)
+      GETSTRUCT(vardata->statsTuple))->stanullfrac;
+  return selec * (1.0 - nullfrac);
+}
+
+PG_FUNCTION_INFO_V1(temporal_ever_sel);
+/**
+ * Estimate the selectivity value of the ever/always comparison operators
+ * for temporal alphanumeric types
+ */
+PGDLLEXPORT Datum
+temporal_ever_sel(PG_FUNCTION_ARGS)
+{
+  PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+  Oid operator = PG_GETARG_OID(1);
+  List *args = (List *) PG_GETARG_POINTER(2);
+  int varRelid = PG_GETARG_INT32(3);
+  VariableStatData vardata;
+  Node *other;
+  bool varonleft, ever;
+  Selectivity selec;
+  CachedOp cachedOp;
+  Oid valuetypid;
+
+  /*
+   * Get enumeration value associated to the operator
+   */
+  bool found = temporal_ever_cachedop(operator, &cachedOp, &ever);
+  /* In the case of unknown operator */
+  if (!found)
+    PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+  /*
+   * If expression is not (variable op something) or (something op
+   * variable), then punt and return a default estimate.
+   */
+  if (!get_restriction_variable(root, args, varRelid,
+    &vardata, &other, &varonleft))
+    PG_RETURN_FLOAT8(default_temporal_ever_selectivity(cachedOp));
+
+  /*
+   * Can't do anything useful if the something is not a constant, either.
+   * The operators have no commutator and thus the variable must be on the
+   * left.
+   */
+  if (!IsA(other, Const) || !varonleft)
+  {
+    ReleaseVariableStats(vardata);
+    PG_RETURN_FLOAT8(default_temporal_ever_selectivity(cachedOp));
+  }
+
+  /*
+   * All the ever/always operators are strict, so we can cope with a NULL
+   * constant right away.
+   */
+  if (((Const *) other)->constisnull)
+  {
+    ReleaseVariableStats(vardata);
+    PG_RETURN_FLOAT8(0.0);
+  }
+
+  /* The constant must be of the base type of the temporal column */
+  valuetypid = ((Const *) other)->consttype;
+  if (! temporal_type(vardata.atttype) ||
+    base_oid_from_temporal(vardata.atttype) != valuetypid)
+  {
+    ReleaseVariableStats(vardata);
+    PG_RETURN_FLOAT8(default_temporal_ever_selectivity(cachedOp));
+  }
+
+  selec = temporal_ever_sel_internal(&vardata, ((Const *) other)->constvalue,
+    valuetypid, cachedOp, ever);
+
+  ReleaseVariableStats(vardata);
+  CLAMP_PROBABILITY(selec);
+  PG_RETURN_FLOAT8(selec);
+}
+
+/*****************************************************************************/
+
 PG_FUNCTION_INFO_V1(temporal_joinsel);
 /*
  * Estimate the join selectivity value of the operators for temporal types
@@ -0,0 +1,236 @@
+/*****************************************************************************
+ *
+ * temporal_statscache.c
+ *    Cache of the decoded statistics used by the selectivity functions
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file temporal_statscache.c
+ * The selectivity functions are called for every restriction clause of a
+ * query, e.g., once per constant of a query with hundreds of OR'ed periods.
+ * Reading a statistics slot with get_attstatsslot detoasts and copies the
+ * arrays of the slot, and the histograms of bounds are decoded from these
+ * arrays at each call. This file keeps a copy of the slots, together with
+ * the bounds decoded by the selectivity functions, in a hash table whose key
+ * is the relation, the attribute, and the kind of statistics.
+ *
+ * The table is allocated in the memory context that is current when it is
+ * created, which is the one of the planning of the query, and it vanishes
+ * with that context. In addition, an update of the statistics marks the
+ * table as stale, and a new table is built at the next lookup. The stale
+ * table is not freed at that moment since selectivity functions can still
+ * hold pointers into it, its memory is released with the context.
+ */
+
+#include "temporal_statscache.h"
+
+#include <access/htup_details.h>
+#include <catalog/pg_statistic.h>
+#include <utils/datum.h>
+#include <utils/hsearch.h>
+#include <utils/inval.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/syscache.h>
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the key of the statistics cache
+ */
+typedef struct
+{
+  Oid         relid;       /**< relation of the statistics */
+  int16       attnum;      /**< attribute of the statistics */
+  bool        inherit;     /**< true if the statistics include children */
+  int16       kind;        /**< kind of the statistics slot */
+  int         flags;       /**< parts of the slot that are copied */
+} StatsCacheKey;
+
+/**
+ * Structure to represent the entries of the statistics cache
+ */
+typedef struct
+{
+  StatsCacheKey key;       /**< hash key, must be first */
+  bool        found;       /**< false if the slot is not in the statistics */
+  CachedStatsSlot slot;    /**< copy of the slot */
+} StatsCacheEntry;
+
+/** Hash table of statistics slots, NULL if not yet created */
+static HTAB *statscache = NULL;
+/** Memory context of the hash table */
+static MemoryContext statscache_context = NULL;
+/** True when the statistics have changed since the table was created */
+static bool statscache_stale = false;
+/** True when the invalidation callback has been registered */
+static bool statscache_registered = false;
+
+/**
+ * Forget the hash table when its memory context is reset or deleted
+ */
+static void
+statscache_reset_callback(void *arg)
+{
+  statscache = NULL;
+  statscache_context = NULL;
+  statscache_stale = false;
+}
+
+/**
+ * Mark the hash table as stale when the statistics of any column change
+ */
+static void
+statscache_inval_callback(Datum arg, int cacheid, uint32 hashvalue)
+{
+  statscache_stale = true;
+}
+
+/**
+ * Create the hash table if it does not exist or if it is stale
+ */
+static void
+statscache_init(void)
+{
+  HASHCTL ctl;
+
+  if (! statscache_registered)
+  {
+    CacheRegisterSyscacheCallback(STATRELATTINH, statscache_inval_callback,
+      (Datum) 0);
+    statscache_registered = true;
+  }
+  if (statscache != NULL && ! statscache_stale)
+    return;
+
+  if (statscache == NULL)
+  {
+    MemoryContextCallback *callback;
+    statscache_context = CurrentMemoryContext;
+    callback = MemoryContextAllocZero(statscache_context,
+      sizeof(MemoryContextCallback));
+    callback->func = statscache_reset_callback;
+    MemoryContextRegisterResetCallback(statscache_context, callback);
+  }
+  /* A stale table is left to be freed with its context */
+  memset(&ctl, 0, sizeof(ctl));
+  ctl.keysize = sizeof(StatsCacheKey);
+  ctl.entrysize = sizeof(StatsCacheEntry);
+  ctl.hcxt = statscache_context;
+  statscache = hash_create("MobilityDB statistics cache", 64, &ctl,
+    HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+  statscache_stale = false;
+  return;
+}
+
+/**
+ * Copy a statistics slot into the given memory context
+ *
+ * @param[out] result Copy of the slot
+ * @param[in] statsTuple Statistics tuple
+ * @param[in] kind Kind of the statistics slot
+ * @param[in] flags Parts of the slot to copy, as for get_attstatsslot
+ * @param[in] mcxt Memory context of the copy
+ * @return False if the slot is not in the statistics
+ */
+static bool
+statscache_fetch(CachedStatsSlot *result, HeapTuple statsTuple, int kind,
+  int flags, MemoryContext mcxt)
+{
+  AttStatsSlot sslot;
+  MemoryContext oldcontext;
+  int16 typlen = 0;
+  bool typbyval = false;
+
+  if (! get_attstatsslot(&sslot, statsTuple, kind, InvalidOid, flags))
+    return false;
+  if (flags & ATTSTATSSLOT_VALUES)
+    get_typlenbyval(sslot.valuetype, &typlen, &typbyval);
+
+  oldcontext = MemoryContextSwitchTo(mcxt);
+  memset(result, 0, sizeof(CachedStatsSlot));
+  result->mcxt = mcxt;
+  if (flags & ATTSTATSSLOT_VALUES)
+  {
+    result->valuetype = sslot.valuetype;
+    result->nvalues = sslot.nvalues;
+    result->values = palloc(sizeof(Datum) * Max(sslot.nvalues, 1));
+    for (int i = 0; i < sslot.nvalues; i++)
+      result->values[i] = datumCopy(sslot.values[i], typbyval, typlen);
+  }
+  if (flags & ATTSTATSSLOT_NUMBERS)
+  {
+    result->nnumbers = sslot.nnumbers;
+    result->numbers = palloc(sizeof(float4) * Max(sslot.nnumbers, 1));
+    memcpy(result->numbers, sslot.numbers, sizeof(float4) * sslot.nnumbers);
+  }
+  MemoryContextSwitchTo(oldcontext);
+  free_attstatsslot(&sslot);
+  return true;
+}
+
+/**
+ * Returns the copy of a statistics slot of the variable, or NULL if the
+ * slot is not available
+ *
+ * The result must not be freed nor modified by the caller, excepted the
+ * decoded bounds that the caller may set on first use by allocating them
+ * in the memory context of the slot.
+ *
+ * @param[in] vardata Information about the variable
+ * @param[in] kind Kind of the statistics slot
+ * @param[in] flags Parts of the slot to copy, as for get_attstatsslot
+ */
+CachedStatsSlot *
+statscache_slot(VariableStatData *vardata, int kind, int flags)
+{
+  Form_pg_statistic stats;
+  StatsCacheKey key;
+  StatsCacheEntry *entry;
+  bool found;
+
+  if (! HeapTupleIsValid(vardata->statsTuple))
+    return NULL;
+
+  /*
+   * Statistics given by the hooks of extensions are not in the syscache,
+   * and thus their changes are not notified. They are copied at each call.
+   */
+  if (vardata->freefunc != ReleaseSysCache)
+  {
+    CachedStatsSlot *result = palloc(sizeof(CachedStatsSlot));
+    if (! statscache_fetch(result, vardata->statsTuple, kind, flags,
+        CurrentMemoryContext))
+    {
+      pfree(result);
+      return NULL;
+    }
+    return result;
+  }
+
+  statscache_init();
+  stats = (Form_pg_statistic) GETSTRUCT(vardata->statsTuple);
+  memset(&key, 0, sizeof(StatsCacheKey));
+  key.relid = stats->starelid;
+  key.attnum = stats->staattnum;
+  key.inherit = stats->stainherit;
+  key.kind = (int16) kind;
+  key.flags = flags;
+  entry = (StatsCacheEntry *) hash_search(statscache, &key, HASH_ENTER,
+    &found);
+  if (! found)
+  {
+    entry->found = false;
+    entry->found = statscache_fetch(&entry->slot, vardata->statsTuple, kind,
+      flags, statscache_context);
+  }
+  return entry->found ? &entry->slot : NULL;
+}
+
+/*****************************************************************************/
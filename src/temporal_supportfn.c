@@ -0,0 +1,492 @@
+/*****************************************************************************
+ *
+ * temporal_supportfn.c
+ *    Planner support functions for temporal types
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/**
+ * @file temporal_supportfn.c
+ * Since PostgreSQL 12, a function may have a support function that the
+ * planner calls to obtain information about the calls of the function. The
+ * support function below is attached to the spatial relationships between
+ * temporal points and to the ever/always equal comparisons. It answers two
+ * requests of the planner:
+ * - SupportRequestIndexCondition: the function call is transformed into a
+ *   lossy index condition that compares with the && operator the bounding
+ *   box of the indexed temporal value with the bounding box of the other
+ *   argument, expanded by the distance for dwithin. This enables GiST,
+ *   SP-GiST, and BRIN indexes for function calls such as
+ *   intersects(t1.temp, t2.temp) or ever_eq(temp, 3).
+ * - SupportRequestSelectivity: the selectivity of the function call is
+ *   estimated as the one of the same bounding box comparison.
+ * - SupportRequestRows: the number of rows returned by the set-returning
+ *   functions unnestInstants, unnestTimestamps, and unnest is the number of
+ *   instants of the constant argument, or the average number of instants
+ *   of the column computed by ANALYZE.
+ * - SupportRequestCost: the cost declared for the function, which holds for
+ *   values of a few instants, is scaled by the width of the temporal
+ *   arguments, taken from the constant itself or from the average width of
+ *   the column computed by ANALYZE. This request is also answered for the
+ *   functions that are not in the table below.
+ * The relationships between temporal points first restrict both values to
+ * their common time span and then compare their trajectories. Therefore,
+ * the bounding boxes of the two values overlap in space and time whenever
+ * the relationship is satisfied. This is not the case for disjoint and
+ * relate, to which the support function is not attached.
+ */
+
+#include "temporal_supportfn.h"
+
+#if MOBDB_PGSQL_VERSION >= 120000
+
+#include <access/stratnum.h>
+#if MOBDB_PGSQL_VERSION < 130000
+#include <access/tuptoaster.h>
+#else
+#include <access/detoast.h>
+#endif
+#include <catalog/namespace.h>
+#include <catalog/pg_am_d.h>
+#include <catalog/pg_statistic.h>
+#include <nodes/makefuncs.h>
+#include <nodes/nodeFuncs.h>
+#include <nodes/supportnodes.h>
+#include <optimizer/cost.h>
+#include <optimizer/optimizer.h>
+#include <parser/parse_func.h>
+#include <utils/lsyscache.h>
+#include <utils/selfuncs.h>
+#include <utils/syscache.h>
+
+#include "oidcache.h"
+#include "time_analyze.h"
+
+/*****************************************************************************/
+
+/**
+ * Width in bytes of the temporal values for which the cost declared for the
+ * functions holds
+ */
+#define SUPPORTFN_COST_WIDTH   256
+
+/**
+ * Structure describing a function to which the support function applies
+ */
+typedef struct
+{
+  const char *fn_name;   /**< Name of the function */
+  bool symmetric;        /**< True if the index may be on either argument */
+  int dist_arg;          /**< Position of the distance argument, -1 if none */
+} TemporalSupportFn;
+
+static const TemporalSupportFn TEMPORAL_SUPPORT_FNS[] =
+{
+  {"contains", true, -1},
+  {"containsproperly", true, -1},
+  {"covers", true, -1},
+  {"coveredby", true, -1},
+  {"crosses", true, -1},
+  {"equals", true, -1},
+  {"intersects", true, -1},
+  {"overlaps", true, -1},
+  {"touches", true, -1},
+  {"within", true, -1},
+  {"dwithin", true, 2},
+  {"ever_eq", false, -1},
+  {"always_eq", false, -1}
+};
+
+#define NUM_TEMPORAL_SUPPORT_FNS \
+  (sizeof(TEMPORAL_SUPPORT_FNS) / sizeof(TemporalSupportFn))
+
+/**
+ * Returns the description of the function, or NULL if the function is
+ * not supported
+ */
+static const TemporalSupportFn *
+supportfn_lookup(Oid funcid)
+{
+  char *fn_name = get_func_name(funcid);
+  if (fn_name == NULL)
+    return NULL;
+  for (int i = 0; i < (int) NUM_TEMPORAL_SUPPORT_FNS; i++)
+  {
+    if (strcmp(fn_name, TEMPORAL_SUPPORT_FNS[i].fn_name) == 0)
+      return &TEMPORAL_SUPPORT_FNS[i];
+  }
+  return NULL;
+}
+
+/**
+ * Returns the qualified name of an object in the schema of the function,
+ * that is, the schema of the extension
+ */
+static List *
+supportfn_qualified_name(Oid funcid, const char *name)
+{
+  char *nspname = get_namespace_name(get_func_namespace(funcid));
+  return list_make2(makeString(nspname), makeString(pstrdup(name)));
+}
+
+/**
+ * Returns the call of the function of the extension with the given name
+ * and arguments, or NULL if there is no such function
+ */
+static Node *
+supportfn_func_expr(Oid funcid, const char *name, List *args)
+{
+  Oid argtypes[2];
+  int nargs = list_length(args);
+  ListCell *lc;
+  int i = 0;
+  Oid fnoid;
+
+  Assert(nargs <= 2);
+  foreach(lc, args)
+    argtypes[i++] = exprType((Node *) lfirst(lc));
+  fnoid = LookupFuncName(supportfn_qualified_name(funcid, name), nargs,
+    argtypes, true);
+  if (! OidIsValid(fnoid))
+    return NULL;
+  return (Node *) makeFuncExpr(fnoid, get_func_rettype(fnoid), args,
+    InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+}
+
+/**
+ * Returns the expression compared with the temporal value by the &&
+ * operator, or NULL if there is none
+ *
+ * The base value of the ever/always comparisons of temporal numbers is
+ * converted into a box with function tbox. The second argument of dwithin
+ * is converted into a box with function stbox, which is then expanded by
+ * the distance with function expandSpatial. The latter is not done for
+ * temporal geography points since the spatial dimensions of their boxes
+ * are geocentric coordinates and not meters.
+ *
+ * @param[in] funcid Oid of the function
+ * @param[in] fn Description of the function
+ * @param[in] temptypid Oid of the type of the temporal argument
+ * @param[in] arg Other argument
+ * @param[in] dist Distance argument, NULL if none
+ */
+static Node *
+supportfn_bbox_expr(Oid funcid, const TemporalSupportFn *fn, Oid temptypid,
+  Node *arg, Node *dist)
+{
+  Oid argtypid = exprType(arg);
+  if (fn->dist_arg >= 0)
+  {
+    Node *box;
+    if (dist == NULL || temptypid == type_oid(T_TGEOGPOINT) ||
+      ! tgeo_type(argtypid))
+      return NULL;
+    box = supportfn_func_expr(funcid, "stbox", list_make1(arg));
+    if (box == NULL)
+      return NULL;
+    return supportfn_func_expr(funcid, "expandspatial",
+      list_make2(box, dist));
+  }
+  if (tnumber_base_type(argtypid))
+    return supportfn_func_expr(funcid, "tbox", list_make1(arg));
+  return arg;
+}
+
+/**
+ * Returns the arguments of the function call
+ */
+static List *
+supportfn_args(Node *node)
+{
+  if (IsA(node, FuncExpr))
+    return ((FuncExpr *) node)->args;
+  if (IsA(node, OpExpr))
+    return ((OpExpr *) node)->args;
+  return NIL;
+}
+
+/*****************************************************************************/
+
+/**
+ * Returns the lossy index condition for the function call, or NIL if the
+ * index cannot be used (SupportRequestIndexCondition)
+ */
+static List *
+temporal_supportfn_index(SupportRequestIndexCondition *req,
+  const TemporalSupportFn *fn)
+{
+  List *args = supportfn_args(req->node);
+  Node *leftarg, *rightarg, *dist = NULL, *bbox;
+  Oid lefttype, oproid;
+  Expr *expr;
+
+  /* Only the access methods whose operator classes use && for boxes */
+  if (req->index->relam != GIST_AM_OID &&
+    req->index->relam != SPGIST_AM_OID &&
+    req->index->relam != BRIN_AM_OID)
+    return NIL;
+
+  if (list_length(args) < 2 || req->indexarg > 1 ||
+    (req->indexarg == 1 && ! fn->symmetric))
+    return NIL;
+  if (fn->dist_arg >= 0 && list_length(args) > fn->dist_arg)
+    dist = (Node *) list_nth(args, fn->dist_arg);
+
+  leftarg = (Node *) list_nth(args, req->indexarg);
+  rightarg = (Node *) list_nth(args, 1 - req->indexarg);
+  lefttype = exprType(leftarg);
+  bbox = supportfn_bbox_expr(req->funcid, fn, lefttype, rightarg, dist);
+  if (bbox == NULL)
+    return NIL;
+
+  oproid = get_opfamily_member(req->opfamily, lefttype, exprType(bbox),
+    RTOverlapStrategyNumber);
+  if (! OidIsValid(oproid))
+    return NIL;
+
+  /* The other side of the index condition must be constant for the scan */
+#if MOBDB_PGSQL_VERSION >= 140000
+  if (! is_pseudo_constant_for_index(req->root, bbox, req->index))
+#else
+  if (! is_pseudo_constant_for_index(bbox, req->index))
+#endif
+    return NIL;
+
+  expr = make_opclause(oproid, BOOLOID, false, (Expr *) leftarg,
+    (Expr *) bbox, InvalidOid, InvalidOid);
+  /* The original function call must still be evaluated on the rows */
+  req->lossy = true;
+  return list_make1(expr);
+}
+
+/**
+ * Returns the selectivity of the function call, or -1 if it cannot be
+ * estimated (SupportRequestSelectivity)
+ */
+static Selectivity
+temporal_supportfn_sel(SupportRequestSelectivity *req,
+  const TemporalSupportFn *fn)
+{
+  Node *leftarg, *rightarg, *dist = NULL, *bbox;
+  Oid oproid;
+  List *args;
+
+  if (list_length(req->args) < 2)
+    return -1;
+  if (fn->dist_arg >= 0 && list_length(req->args) > fn->dist_arg)
+    dist = (Node *) list_nth(req->args, fn->dist_arg);
+  leftarg = (Node *) linitial(req->args);
+  rightarg = (Node *) lsecond(req->args);
+  bbox = supportfn_bbox_expr(req->funcid, fn, exprType(leftarg), rightarg,
+    dist);
+  if (bbox == NULL)
+    return -1;
+
+  oproid = OpernameGetOprid(supportfn_qualified_name(req->funcid, "&&"),
+    exprType(leftarg), exprType(bbox));
+  if (! OidIsValid(oproid))
+    return -1;
+
+  /* The restriction estimators fold constant expressions such as tbox(3) */
+  args = list_make2(leftarg, bbox);
+  if (req->is_join)
+    return join_selectivity(req->root, oproid, args, req->inputcollid,
+      req->jointype, req->sjinfo);
+  return restriction_selectivity(req->root, oproid, args, req->inputcollid,
+    req->varRelid);
+}
+
+/**
+ * Returns the estimated width in bytes of the temporal argument, or -1 if
+ * it cannot be estimated
+ *
+ * The width of a column is the one stored by ANALYZE, that is, the width of
+ * the TOAST pointer for the values stored out of line, which are therefore
+ * underestimated.
+ */
+static int32
+supportfn_arg_width(PlannerInfo *root, Node *arg)
+{
+  VariableStatData vardata;
+  int32 result = -1;
+
+  if (IsA(arg, Const))
+  {
+    Const *cons = (Const *) arg;
+    if (cons->constisnull)
+      return -1;
+    return (int32) toast_raw_datum_size(cons->constvalue);
+  }
+  if (root == NULL)
+    return -1;
+  examine_variable(root, arg, 0, &vardata);
+  if (HeapTupleIsValid(vardata.statsTuple))
+    result = ((Form_pg_statistic) GETSTRUCT(vardata.statsTuple))->stawidth;
+  ReleaseVariableStats(vardata);
+  return result;
+}
+
+/**
+ * Returns the estimated number of instants of the temporal argument, or -1
+ * if it cannot be estimated
+ *
+ * The average number of instants of a column is stored by ANALYZE in the
+ * slot of the histogram of period lengths, see temporal_analyze.c
+ */
+static double
+supportfn_arg_instants(PlannerInfo *root, Node *arg)
+{
+  VariableStatData vardata;
+  AttStatsSlot sslot;
+  double result = -1;
+
+  if (IsA(arg, Const))
+  {
+    Const *cons = (Const *) arg;
+    int ninsts, nseqs;
+    if (cons->constisnull)
+      return -1;
+    temporal_counts_slice(&ninsts, &nseqs, cons->constvalue);
+    return (double) ninsts;
+  }
+  if (root == NULL)
+    return -1;
+  examine_variable(root, arg, 0, &vardata);
+  if (HeapTupleIsValid(vardata.statsTuple) &&
+    get_attstatsslot(&sslot, vardata.statsTuple,
+      STATISTIC_KIND_PERIOD_LENGTH_HISTOGRAM, InvalidOid,
+      ATTSTATSSLOT_NUMBERS))
+  {
+    if (sslot.nnumbers >= 2)
+      result = sslot.numbers[0];
+    free_attstatsslot(&sslot);
+  }
+  ReleaseVariableStats(vardata);
+  return result;
+}
+
+/**
+ * Returns the number of rows returned by the set-returning function call,
+ * or -1 if it cannot be estimated (SupportRequestRows)
+ */
+static double
+temporal_supportfn_rows(SupportRequestRows *req)
+{
+  char *fn_name = get_func_name(req->funcid);
+  List *args;
+
+  if (req->node == NULL || fn_name == NULL ||
+    (strcmp(fn_name, "unnestinstants") != 0 &&
+     strcmp(fn_name, "unnesttimestamps") != 0 &&
+     strcmp(fn_name, "unnest") != 0))
+    return -1;
+  args = supportfn_args(req->node);
+  if (list_length(args) < 1 ||
+    ! temporal_type(exprType((Node *) linitial(args))))
+    return -1;
+  /* The number of distinct timestamps or values is at most the one of
+   * instants */
+  return supportfn_arg_instants(req->root, (Node *) linitial(args));
+}
+
+/**
+ * Sets the cost of the function call from the width of its temporal
+ * arguments, returns false if no argument width can be estimated
+ * (SupportRequestCost)
+ */
+static bool
+temporal_supportfn_cost(SupportRequestCost *req)
+{
+  List *args;
+  ListCell *lc;
+  int32 width = 0;
+  bool found = false;
+
+  if (req->node == NULL)
+    return false;
+  args = supportfn_args(req->node);
+  foreach(lc, args)
+  {
+    Node *arg = (Node *) lfirst(lc);
+    if (! temporal_type(exprType(arg)))
+      continue;
+    int32 argwidth = supportfn_arg_width(req->root, arg);
+    if (argwidth >= 0)
+    {
+      width += argwidth;
+      found = true;
+    }
+  }
+  if (! found)
+    return false;
+
+  /* The declared cost holds up to SUPPORTFN_COST_WIDTH bytes */
+  req->startup = 0;
+  req->per_tuple = get_func_cost(req->funcid) * cpu_operator_cost *
+    Max(1.0, (double) width / SUPPORTFN_COST_WIDTH);
+  return true;
+}
+
+PG_FUNCTION_INFO_V1(temporal_supportfn);
+/**
+ * Planner support function for the spatial relationships of temporal points,
+ * the ever/always equal comparisons, and the size-dependent and
+ * set-returning functions of temporal values
+ */
+PGDLLEXPORT Datum
+temporal_supportfn(PG_FUNCTION_ARGS)
+{
+  Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+  Node *ret = NULL;
+  const TemporalSupportFn *fn;
+
+  if (IsA(rawreq, SupportRequestSelectivity))
+  {
+    SupportRequestSelectivity *req = (SupportRequestSelectivity *) rawreq;
+    fn = supportfn_lookup(req->funcid);
+    if (fn != NULL)
+    {
+      Selectivity sel = temporal_supportfn_sel(req, fn);
+      if (sel >= 0)
+      {
+        CLAMP_PROBABILITY(sel);
+        req->selectivity = sel;
+        ret = (Node *) req;
+      }
+    }
+  }
+  else if (IsA(rawreq, SupportRequestIndexCondition))
+  {
+    SupportRequestIndexCondition *req =
+      (SupportRequestIndexCondition *) rawreq;
+    fn = supportfn_lookup(req->funcid);
+    if (fn != NULL)
+      ret = (Node *) temporal_supportfn_index(req, fn);
+  }
+  else if (IsA(rawreq, SupportRequestRows))
+  {
+    SupportRequestRows *req = (SupportRequestRows *) rawreq;
+    double rows = temporal_supportfn_rows(req);
+    if (rows >= 0)
+    {
+      req->rows = Max(rows, 1.0);
+      ret = (Node *) req;
+    }
+  }
+  else if (IsA(rawreq, SupportRequestCost))
+  {
+    SupportRequestCost *req = (SupportRequestCost *) rawreq;
+    if (temporal_supportfn_cost(req))
+      ret = (Node *) req;
+  }
+  PG_RETURN_POINTER(ret);
+}
+
+#endif /* MOBDB_PGSQL_VERSION >= 120000 */
+
+/*****************************************************************************/
@@ -0,0 +1,813 @@
+/*****************************************************************************
+ *
+ * temporal_tile.c
+ *    Splitting of temporal values into time buckets and value buckets
+ *
+ * The buckets are aligned with respect to an origin, so that the fragments
+ * obtained from different temporal values that belong to the same bucket
+ * can be processed together. The buckets are half-open, that is, they
+ * include their lower bound but not their upper bound.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_tile.h"
+
+#include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <libpq/pqformat.h>
+#include <utils/rangetypes.h>
+
+#include "period.h"
+#include "tbox.h"
+#include "temporaltypes.h"
+#include "temporal_util.h"
+#include "rangetypes_ext.h"
+#include "temporal_aggfuncs.h"
+
+/*****************************************************************************
+ * Time buckets
+ *****************************************************************************/
+
+/**
+ * Returns the size in microseconds of the interval
+ *
+ * @note Intervals with a month component are not allowed since their size
+ * is not fixed
+ */
+int64
+interval_units(const Interval *interval)
+{
+  if (interval->month != 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The interval cannot have a month component")));
+  int64 result = interval->time + ((int64) interval->day) * USECS_PER_DAY;
+  if (result <= 0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The interval must be strictly positive")));
+  return result;
+}
+
+/**
+ * Returns the start of the bucket of the given size that contains the
+ * timestamp, where the buckets are aligned with the origin
+ *
+ * @param[in] t Timestamp
+ * @param[in] size Size of the buckets in microseconds
+ * @param[in] origin Origin of the buckets
+ */
+TimestampTz
+timestamptz_bucket_internal(TimestampTz t, int64 size, TimestampTz origin)
+{
+  int64 delta = t - origin;
+  int64 k = delta / size;
+  /* The division truncates towards zero, the buckets are floored */
+  if (delta % size < 0)
+    k--;
+  return origin + k * size;
+}
+
+/**
+ * Create the state for splitting the temporal value into time buckets
+ *
+ * @param[in] temp Temporal value
+ * @param[in] size Size of the buckets in microseconds
+ * @param[in] origin Origin of the buckets
+ */
+TimeSplitState *
+timesplit_state_make(Temporal *temp, int64 size, TimestampTz origin)
+{
+  Period p;
+  temporal_period(&p, temp);
+  TimeSplitState *result = palloc0(sizeof(TimeSplitState));
+  result->temp = temp;
+  result->size = size;
+  result->bucket = timestamptz_bucket_internal(p.lower, size, origin);
+  result->end = timestamptz_bucket_internal(p.upper, size, origin);
+  result->done = false;
+  return result;
+}
+
+/**
+ * Returns the fragment of the temporal value in the next non-empty time
+ * bucket, or NULL when all the buckets have been visited
+ *
+ * Each fragment is obtained by restricting the temporal value to the
+ * period of the bucket, which locates the bucket in the value with a binary
+ * search and only copies the instants of the bucket. Therefore, splitting
+ * a value visits each of its instants once.
+ *
+ * @param[in,out] state State
+ * @param[out] bucket Start of the bucket of the fragment
+ */
+Temporal *
+timesplit_state_next(TimeSplitState *state, TimestampTz *bucket)
+{
+  while (! state->done)
+  {
+    Period p;
+    TimestampTz lower = state->bucket;
+    period_set(&p, lower, lower + state->size, true, false);
+    if (lower >= state->end)
+      state->done = true;
+    else
+      state->bucket += state->size;
+    Temporal *result = temporal_at_period_internal(state->temp, &p);
+    if (result != NULL)
+    {
+      *bucket = lower;
+      return result;
+    }
+  }
+  return NULL;
+}
+
+PG_FUNCTION_INFO_V1(temporal_time_split);
+/**
+ * Split the temporal value into fragments with respect to time buckets
+ */
+PGDLLEXPORT Datum
+temporal_time_split(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  TimeSplitState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    Interval *duration = PG_GETARG_INTERVAL_P(1);
+    TimestampTz origin = PG_GETARG_TIMESTAMPTZ(2);
+    int64 size = interval_units(duration);
+    funcctx->user_fctx = timesplit_state_make(temp, size, origin);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (TimeSplitState *) funcctx->user_fctx;
+  TimestampTz bucket;
+  Temporal *fragment = timesplit_state_next(state, &bucket);
+  if (fragment == NULL)
+    SRF_RETURN_DONE(funcctx);
+
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = TimestampTzGetDatum(bucket);
+  values[1] = PointerGetDatum(fragment);
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************
+ * Value buckets
+ *****************************************************************************/
+
+/**
+ * Create the state for splitting the temporal number into value buckets
+ *
+ * @param[in] temp Temporal number
+ * @param[in] width Width of the buckets
+ * @param[in] origin Origin of the buckets
+ */
+static ValueSplitState *
+valuesplit_state_make(Temporal *temp, double width, double origin)
+{
+  TBOX box;
+  memset(&box, 0, sizeof(TBOX));
+  temporal_bbox(&box, temp);
+  ValueSplitState *result = palloc0(sizeof(ValueSplitState));
+  result->temp = temp;
+  result->width = width;
+  result->start = origin + floor((box.xmin - origin) / width) * width;
+  result->i = 0;
+  result->count = (int64) floor((box.xmax - result->start) / width) + 1;
+  return result;
+}
+
+/**
+ * Returns the fragment of the temporal number in the next non-empty value
+ * bucket, or NULL when all the buckets have been visited
+ *
+ * @param[in,out] state State
+ * @param[out] bucket Start of the bucket of the fragment
+ */
+static Temporal *
+valuesplit_state_next(ValueSplitState *state, Datum *bucket)
+{
+  Oid valuetypid = state->temp->valuetypid;
+  while (state->i < state->count)
+  {
+    /* The bounds are computed from the start to avoid accumulating
+     * rounding errors for float buckets */
+    double lower = state->start + state->i * state->width;
+    double upper = state->start + (state->i + 1) * state->width;
+    state->i++;
+    Datum lowerdatum, upperdatum;
+    if (valuetypid == INT4OID)
+    {
+      lowerdatum = Int32GetDatum((int32) lower);
+      upperdatum = Int32GetDatum((int32) upper);
+    }
+    else
+    {
+      lowerdatum = Float8GetDatum(lower);
+      upperdatum = Float8GetDatum(upper);
+    }
+    RangeType *range = range_make(lowerdatum, upperdatum, true, false,
+      valuetypid);
+    Temporal *result = tnumber_restrict_range_internal(state->temp, range,
+      REST_AT);
+    pfree(range);
+    if (result != NULL)
+    {
+      *bucket = lowerdatum;
+      return result;
+    }
+  }
+  return NULL;
+}
+
+PG_FUNCTION_INFO_V1(tnumber_value_split);
+/**
+ * Split the temporal number into fragments with respect to value buckets
+ */
+PGDLLEXPORT Datum
+tnumber_value_split(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  ValueSplitState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    double width, origin;
+    if (temp->valuetypid == INT4OID)
+    {
+      width = (double) PG_GETARG_INT32(1);
+      origin = (double) PG_GETARG_INT32(2);
+    }
+    else
+    {
+      width = PG_GETARG_FLOAT8(1);
+      origin = PG_GETARG_FLOAT8(2);
+    }
+    if (width <= 0)
+      ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+        errmsg("The width must be strictly positive")));
+    funcctx->user_fctx = valuesplit_state_make(temp, width, origin);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (ValueSplitState *) funcctx->user_fctx;
+  Datum bucket;
+  Temporal *fragment = valuesplit_state_next(state, &bucket);
+  if (fragment == NULL)
+    SRF_RETURN_DONE(funcctx);
+
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = bucket;
+  values[1] = PointerGetDatum(fragment);
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************
+ * Time-bucketed statistics
+ *
+ * The statistics of the buckets are computed in a single pass over the
+ * segments of the temporal number, splitting each segment at the bounds
+ * of the buckets that it crosses.
+ *****************************************************************************/
+
+/**
+ * Structure to represent the array of statistics being computed
+ */
+typedef struct
+{
+  int64 size;
+  TimestampTz origin;
+  int capacity;
+  int count;
+  BucketStats *stats;
+} BucketStatsArray;
+
+/**
+ * Returns the statistics of the bucket containing the timestamp,
+ * appending a new bucket to the array if needed
+ *
+ * @pre The timestamps are given in increasing order
+ */
+static BucketStats *
+bucketstats_get(BucketStatsArray *array, TimestampTz t)
+{
+  TimestampTz bucket = timestamptz_bucket_internal(t, array->size,
+    array->origin);
+  if (array->count > 0 && array->stats[array->count - 1].bucket == bucket)
+    return &array->stats[array->count - 1];
+  if (array->count == array->capacity)
+  {
+    array->capacity <<= 1;
+    array->stats = repalloc(array->stats,
+      sizeof(BucketStats) * array->capacity);
+  }
+  BucketStats *result = &array->stats[array->count++];
+  result->bucket = bucket;
+  result->count = 0;
+  result->min = DBL_MAX;
+  result->max = -DBL_MAX;
+  result->integral = 0.0;
+  result->sum = 0.0;
+  result->duration = 0;
+  return result;
+}
+
+/**
+ * Add the value to the minimum and the maximum of the statistics
+ */
+static void
+bucketstats_minmax(BucketStats *stats, double value)
+{
+  stats->min = Min(stats->min, value);
+  stats->max = Max(stats->max, value);
+  return;
+}
+
+/**
+ * Add the instant to the statistics of its bucket
+ */
+static void
+bucketstats_add_inst(BucketStatsArray *array, const TInstant *inst)
+{
+  double value = datum_double(tinstant_value(inst), inst->valuetypid);
+  BucketStats *stats = bucketstats_get(array, inst->t);
+  stats->count++;
+  stats->sum += value;
+  bucketstats_minmax(stats, value);
+  return;
+}
+
+/**
+ * Add the segment to the statistics of the buckets it crosses
+ */
+static void
+bucketstats_add_segment(BucketStatsArray *array, const TInstant *inst1,
+  const TInstant *inst2, bool linear)
+{
+  double value1 = datum_double(tinstant_value(inst1), inst1->valuetypid);
+  double value2 = datum_double(tinstant_value(inst2), inst2->valuetypid);
+  double duration = (double) (inst2->t - inst1->t);
+  TimestampTz lower = inst1->t;
+  double lowervalue = value1;
+  while (lower < inst2->t)
+  {
+    BucketStats *stats = bucketstats_get(array, lower);
+    TimestampTz upper = Min(stats->bucket + array->size, inst2->t);
+    double uppervalue = ! linear ? value1 : (upper == inst2->t) ? value2 :
+      value1 + (value2 - value1) * (double) (upper - inst1->t) / duration;
+    stats->integral += linear ?
+      (lowervalue + uppervalue) * (double) (upper - lower) / 2.0 :
+      value1 * (double) (upper - lower);
+    stats->duration += upper - lower;
+    bucketstats_minmax(stats, lowervalue);
+    bucketstats_minmax(stats, uppervalue);
+    lower = upper;
+    lowervalue = uppervalue;
+  }
+  return;
+}
+
+/**
+ * Add the temporal sequence number to the statistics
+ */
+static void
+bucketstats_add_seq(BucketStatsArray *array, const TSequence *seq)
+{
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  if (seq->period.lower_inc)
+    bucketstats_add_inst(array, inst1);
+  for (int i = 1; i < seq->count; i++)
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, i);
+    bucketstats_add_segment(array, inst1, inst2, linear);
+    if (i < seq->count - 1 || seq->period.upper_inc)
+      bucketstats_add_inst(array, inst2);
+    inst1 = inst2;
+  }
+  return;
+}
+
+/**
+ * Returns the time-weighted statistics of the temporal number in the time
+ * buckets of the given size aligned with the origin
+ *
+ * @param[in] temp Temporal number
+ * @param[in] size Size of the buckets in microseconds
+ * @param[in] origin Origin of the buckets
+ * @param[out] count Number of elements of the resulting array
+ * @result Array of statistics sorted by bucket, omitting the empty buckets
+ */
+BucketStats *
+tnumber_bucket_stats_internal(const Temporal *temp, int64 size,
+  TimestampTz origin, int *count)
+{
+  BucketStatsArray array;
+  array.size = size;
+  array.origin = origin;
+  array.capacity = 64;
+  array.count = 0;
+  array.stats = palloc(sizeof(BucketStats) * array.capacity);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    bucketstats_add_inst(&array, (TInstant *) temp);
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+      bucketstats_add_inst(&array, tinstantset_inst_n(ti, i));
+  }
+  else if (temp->duration == SEQUENCE)
+    bucketstats_add_seq(&array, (TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      bucketstats_add_seq(&array, tsequenceset_seq_n(ts, i));
+  }
+  *count = array.count;
+  return array.stats;
+}
+
+/**
+ * Returns the time-weighted average of the statistics
+ */
+static double
+bucketstats_twavg(const BucketStats *stats)
+{
+  return (stats->duration > 0) ?
+    stats->integral / (double) stats->duration : stats->sum / stats->count;
+}
+
+PG_FUNCTION_INFO_V1(tnumber_bucket_stats);
+/**
+ * Returns the time-weighted statistics of the temporal number in the time
+ * buckets
+ */
+PGDLLEXPORT Datum
+tnumber_bucket_stats(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    Temporal *temp = PG_GETARG_TEMPORAL(0);
+    Interval *duration = PG_GETARG_INTERVAL_P(1);
+    TimestampTz origin = PG_GETARG_TIMESTAMPTZ(2);
+    int64 size = interval_units(duration);
+    int count;
+    funcctx->user_fctx = tnumber_bucket_stats_internal(temp, size, origin,
+      &count);
+    funcctx->max_calls = count;
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  if (funcctx->call_cntr >= funcctx->max_calls)
+    SRF_RETURN_DONE(funcctx);
+
+  BucketStats *stats = (BucketStats *) funcctx->user_fctx;
+  stats += funcctx->call_cntr;
+  Datum values[6];
+  bool isnull[6] = {false, false, false, false, false, false};
+  values[0] = TimestampTzGetDatum(stats->bucket);
+  values[1] = Int32GetDatum(stats->count);
+  values[2] = Float8GetDatum(stats->min);
+  values[3] = Float8GetDatum(stats->max);
+  values[4] = Float8GetDatum(stats->integral);
+  values[5] = Float8GetDatum(bucketstats_twavg(stats));
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************
+ * Time-bucketed average aggregation
+ *
+ * The state keeps the statistics of the buckets of the aggregated values,
+ * which are sorted and merged by bucket when the state is full or when the
+ * aggregation ends. The result is a stepwise temporal float whose value in
+ * each bucket is the time-weighted average of the values in the bucket.
+ *****************************************************************************/
+
+/**
+ * Comparator function for the statistics of the buckets
+ */
+static int
+bucketstats_cmp(const void *a, const void *b)
+{
+  TimestampTz t1 = ((const BucketStats *) a)->bucket;
+  TimestampTz t2 = ((const BucketStats *) b)->bucket;
+  return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
+}
+
+/**
+ * Sort the statistics of the state and merge the statistics of the same
+ * bucket
+ */
+static void
+bucketagg_compact(BucketAggState *state)
+{
+  if (state->count <= 1)
+    return;
+  qsort(state->stats, (size_t) state->count, sizeof(BucketStats),
+    &bucketstats_cmp);
+  int k = 0;
+  for (int i = 1; i < state->count; i++)
+  {
+    BucketStats *stats = &state->stats[i];
+    BucketStats *last = &state->stats[k];
+    if (stats->bucket == last->bucket)
+    {
+      last->count += stats->count;
+      last->min = Min(last->min, stats->min);
+      last->max = Max(last->max, stats->max);
+      last->integral += stats->integral;
+      last->sum += stats->sum;
+      last->duration += stats->duration;
+    }
+    else
+      state->stats[++k] = *stats;
+  }
+  state->count = k + 1;
+  return;
+}
+
+/**
+ * Create a new state for time-bucketed aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] size Size of the buckets in microseconds
+ * @param[in] origin Origin of the buckets
+ * @param[in] capacity Initial number of statistics of the state
+ */
+static BucketAggState *
+bucketagg_make(FunctionCallInfo fcinfo, int64 size, TimestampTz origin,
+  int capacity)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  BucketAggState *result = palloc(sizeof(BucketAggState));
+  result->size = size;
+  result->origin = origin;
+  result->capacity = Max(capacity, BUCKETAGG_INITIAL_CAPACITY);
+  result->count = 0;
+  result->stats = palloc(sizeof(BucketStats) * result->capacity);
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Ensure that the state can hold the given number of additional statistics.
+ * The statistics of the state are compacted before growing the state, which
+ * keeps its size proportional to the number of distinct buckets.
+ */
+static void
+bucketagg_reserve(FunctionCallInfo fcinfo, BucketAggState *state, int count)
+{
+  if (state->count + count <= state->capacity)
+    return;
+  bucketagg_compact(state);
+  if (state->count + count <= state->capacity / 2)
+    return;
+  while (state->count + count > state->capacity / 2)
+    state->capacity <<= 1;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->stats = repalloc(state->stats, sizeof(BucketStats) * state->capacity);
+  unset_aggregation_context(ctx);
+  return;
+}
+
+/**
+ * Add the statistics to the state
+ */
+static void
+bucketagg_add(FunctionCallInfo fcinfo, BucketAggState *state,
+  const BucketStats *stats, int count)
+{
+  bucketagg_reserve(fcinfo, state, count);
+  memcpy(&state->stats[state->count], stats, sizeof(BucketStats) * count);
+  state->count += count;
+  return;
+}
+
+PG_FUNCTION_INFO_V1(tnumber_bucket_avg_transfn);
+/**
+ * Transition function for time-bucketed average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_bucket_avg_transfn(PG_FUNCTION_ARGS)
+{
+  BucketAggState *state = PG_ARGISNULL(0) ? NULL :
+    (BucketAggState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  Interval *duration = PG_GETARG_INTERVAL_P(2);
+  TimestampTz origin = (PG_NARGS() > 3 && ! PG_ARGISNULL(3)) ?
+    PG_GETARG_TIMESTAMPTZ(3) : BUCKET_DEFAULT_ORIGIN;
+  int64 size = interval_units(duration);
+  if (! state)
+    state = bucketagg_make(fcinfo, size, origin, 0);
+  else if (state->size != size || state->origin != origin)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The buckets must be the same for all the aggregated values")));
+  int count;
+  BucketStats *stats = tnumber_bucket_stats_internal(temp, size, origin,
+    &count);
+  bucketagg_add(fcinfo, state, stats, count);
+  pfree(stats);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_bucket_avg_combinefn);
+/**
+ * Combine function for time-bucketed average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_bucket_avg_combinefn(PG_FUNCTION_ARGS)
+{
+  BucketAggState *state1 = PG_ARGISNULL(0) ? NULL :
+    (BucketAggState *) PG_GETARG_POINTER(0);
+  BucketAggState *state2 = PG_ARGISNULL(1) ? NULL :
+    (BucketAggState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (state1 == NULL)
+    PG_RETURN_POINTER(state2);
+  if (state2 == NULL)
+    PG_RETURN_POINTER(state1);
+
+  if (state1->size != state2->size || state1->origin != state2->origin)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The buckets must be the same for all the aggregated values")));
+  bucketagg_add(fcinfo, state1, state2->stats, state2->count);
+  PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_bucket_avg_finalfn);
+/**
+ * Final function for time-bucketed average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_bucket_avg_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  BucketAggState *state = (BucketAggState *) PG_GETARG_POINTER(0);
+  bucketagg_compact(state);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+
+  /* Consecutive buckets are put in the same sequence */
+  TSequence **sequences = palloc(sizeof(TSequence *) * state->count);
+  TInstant **instants = palloc(sizeof(TInstant *) * (state->count + 1));
+  int k = 0, l = 0;
+  for (int i = 0; i < state->count; i++)
+  {
+    BucketStats *stats = &state->stats[i];
+    Datum value = Float8GetDatum(bucketstats_twavg(stats));
+    instants[l++] = tinstant_make(value, stats->bucket, FLOAT8OID);
+    if (i == state->count - 1 ||
+      state->stats[i + 1].bucket != stats->bucket + state->size)
+    {
+      instants[l++] = tinstant_make(value, stats->bucket + state->size,
+        FLOAT8OID);
+      sequences[k++] = tsequence_make_free(instants, l, true, false,
+        STEP, NORMALIZE);
+      instants = palloc(sizeof(TInstant *) * (state->count + 1));
+      l = 0;
+    }
+  }
+  pfree(instants);
+  TSequenceSet *result = tsequenceset_make_free(sequences, k, NORMALIZE);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_bucket_avg_serialize);
+/**
+ * Serialize the state value of time-bucketed average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_bucket_avg_serialize(PG_FUNCTION_ARGS)
+{
+  BucketAggState *state = (BucketAggState *) PG_GETARG_POINTER(0);
+  bucketagg_compact(state);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+  pq_sendint64(&buf, state->size);
+  pq_sendint64(&buf, state->origin);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  for (int i = 0; i < state->count; i++)
+  {
+    BucketStats *stats = &state->stats[i];
+    pq_sendint64(&buf, stats->bucket);
+#if MOBDB_PGSQL_VERSION < 110000
+    pq_sendint(&buf, (uint32) stats->count, 4);
+#else
+    pq_sendint32(&buf, (uint32) stats->count);
+#endif
+    pq_sendfloat8(&buf, stats->min);
+    pq_sendfloat8(&buf, stats->max);
+    pq_sendfloat8(&buf, stats->integral);
+    pq_sendfloat8(&buf, stats->sum);
+    pq_sendint64(&buf, stats->duration);
+  }
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(tnumber_bucket_avg_deserialize);
+/**
+ * Deserialize the state value of time-bucketed average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_bucket_avg_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data),
+    .maxlen = VARSIZE(data)
+  };
+  int64 size = pq_getmsgint64(&buf);
+  TimestampTz origin = (TimestampTz) pq_getmsgint64(&buf);
+  int count = (int) pq_getmsgint(&buf, 4);
+  BucketAggState *result = bucketagg_make(fcinfo, size, origin, count);
+  for (int i = 0; i < count; i++)
+  {
+    BucketStats *stats = &result->stats[i];
+    stats->bucket = (TimestampTz) pq_getmsgint64(&buf);
+    stats->count = (int32) pq_getmsgint(&buf, 4);
+    stats->min = pq_getmsgfloat8(&buf);
+    stats->max = pq_getmsgfloat8(&buf);
+    stats->integral = pq_getmsgfloat8(&buf);
+    stats->sum = pq_getmsgfloat8(&buf);
+    stats->duration = pq_getmsgint64(&buf);
+  }
+  result->count = count;
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
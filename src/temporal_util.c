@@ -13,10 +13,15 @@
 #include "temporal_util.h"
 
 #include <assert.h>
+#include <float.h>
+#include <math.h>
 #include <catalog/pg_collation.h>
 #include <fmgr.h>
+#include <postmaster/bgworker.h>
 #include <utils/builtins.h>
+#include <utils/guc.h>
 #include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 #include <utils/varlena.h>
 
@@ -24,9 +29,11 @@
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "doublen.h"
+#include "temporal_rollup.h"
 
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
+#include "tpoint_parallel.h"
 
 /*
  * This is required for builds against pgsql
@@ -45,6 +52,61 @@ _PG_init(void)
 {
   /* elog(WARNING, "This is MobilityDB."); */
   temporalgeom_init();
+  DefineCustomBoolVariable("mobilitydb.precompute_trajectory",
+    "Precompute the trajectory of temporal point sequences.",
+    "When off, the trajectory is not stored in the sequences but built "
+    "on demand by the functions that need it.",
+    &precompute_trajectory, true, PGC_USERSET, 0, NULL, NULL, NULL);
+  DefineCustomBoolVariable("mobilitydb.use_spheroid",
+    "Use the WGS84 spheroid for the computations on temporal geography points.",
+    "When off, distances, lengths, speeds, and dwithin are computed on a "
+    "sphere, which is faster and has a relative error below 0.5%.",
+    &geodetic_use_spheroid, true, PGC_USERSET, 0, NULL, NULL, NULL);
+  DefineCustomBoolVariable("mobilitydb.track_counters",
+    "Collect counters of the work done by the functions of the extension.",
+    "When on, the detoasted values, the bounding box tests, the calls to "
+    "PostGIS, the synchronizations, and the skiplist splices are counted "
+    "per backend and reported by mobilitydb_stats().",
+    &track_counters, false, PGC_USERSET, 0, NULL, NULL, NULL);
+  DefineCustomIntVariable("mobilitydb.detoast_cache_size",
+    "Maximum size of the temporal values kept in the detoast cache.",
+    "The temporal values stored out of line that were recently detoasted "
+    "are kept in a cache of the backend until the end of the transaction, "
+    "so that the functions reading the same value do not detoast it again. "
+    "A value of 0 disables the cache.",
+    &detoast_cache_size, 16384, 0, MAX_KILOBYTES, PGC_USERSET, GUC_UNIT_KB,
+    NULL, NULL, NULL);
+  DefineCustomIntVariable("mobilitydb.edgeindex_cache_size",
+    "Size of the shared cache of the indexes of the edges of polygons.",
+    "The indexes built for the polygons with many edges are kept in shared "
+    "memory and reused by all backends. The cache is only created when the "
+    "library is loaded with shared_preload_libraries. A value of 0 disables "
+    "the cache.",
+    &edgeindex_cache_size, 0, 0, MAX_KILOBYTES, PGC_POSTMASTER, GUC_UNIT_KB,
+    NULL, NULL, NULL);
+  DefineCustomStringVariable("mobilitydb.rollup_database",
+    "Database of the rollups refreshed by the background worker.",
+    "When set and the library is loaded with shared_preload_libraries, a "
+    "background worker connected to this database periodically merges the "
+    "rows appended to the sources of the rollups into their states.",
+    &rollup_database, NULL, PGC_POSTMASTER, 0, NULL, NULL, NULL);
+  DefineCustomIntVariable("mobilitydb.rollup_naptime",
+    "Time between two refreshes of the rollups by the background worker.",
+    NULL, &rollup_naptime, 60, 1, INT_MAX / 1000, PGC_SIGHUP, GUC_UNIT_S,
+    NULL, NULL, NULL);
+  DefineCustomIntVariable("mobilitydb.parallel_workers",
+    "Maximum number of workers processing the chunks of a large sequence.",
+    "The speed and the restriction to a geometry of the temporal point "
+    "sequences with many instants are computed in chunks by dynamic "
+    "background workers. A value of 0 disables the parallel processing.",
+    &tpoint_parallel_workers, 0, 0, MAX_PARALLEL_WORKER_LIMIT, PGC_USERSET,
+    0, NULL, NULL, NULL);
+  DefineCustomIntVariable("mobilitydb.parallel_min_instants",
+    "Minimum number of instants of the sequences processed in parallel.",
+    NULL, &tpoint_parallel_min_instants, 1000000, 2, INT_MAX, PGC_USERSET,
+    0, NULL, NULL, NULL);
+  edgeindex_shmem_init();
+  rollup_worker_init();
 }
 
 /**
@@ -63,22 +125,13 @@ double_pad(size_t size)
  *
  * This function is called only for the base types of the temporal types
  * and for TimestampTz. To avoid a call of the slow function get_typbyval
- * (which makes a lookup call), the known base types are explicitly enumerated.
+ * (which makes a lookup call), the value is taken from the cache of the
+ * base types.
  */
 bool
 get_typbyval_fast(Oid type)
 {
-  ensure_temporal_base_type_all(type);
-  bool result = false;
-  if (type == BOOLOID || type == INT4OID || type == FLOAT8OID ||
-    type == TIMESTAMPTZOID)
-    result = true;
-  else if (type == type_oid(T_DOUBLE2) || type == TEXTOID)
-    result = false;
-  else if (type == type_oid(T_GEOMETRY) || type == type_oid(T_GEOGRAPHY) ||
-       type == type_oid(T_DOUBLE3) || type == type_oid(T_DOUBLE4))
-    result = false;
-  return result;
+  return base_type_info(type)->typbyval;
 }
 
 /**
@@ -86,30 +139,13 @@ get_typbyval_fast(Oid type)
  *
  * This function is called only for the base types of the temporal types
  * and for TimestampTz. To avoid a call of the slow function get_typlen
- * (which makes a lookup call), the known base types are explicitly enumerated.
+ * (which makes a lookup call), the value is taken from the cache of the
+ * base types.
  */
 int
 get_typlen_fast(Oid type)
 {
-  ensure_temporal_base_type_all(type);
-  int result = 0;
-  if (type == BOOLOID)
-    result = 1;
-  else if (type == INT4OID)
-    result = 4;
-  else if (type == FLOAT8OID || type == TIMESTAMPTZOID)
-    result = 8;
-  else if (type == type_oid(T_DOUBLE2))
-    result = 16;
-  else if (type == TEXTOID)
-    result = -1;
-  else if (type == type_oid(T_GEOMETRY) || type == type_oid(T_GEOGRAPHY))
-    result = -1;
-  else if (type == type_oid(T_DOUBLE3))
-    result = 24;
-  else if (type == type_oid(T_DOUBLE4))
-    result = 32;
-  return result;
+  return base_type_info(type)->typlen;
 }
 
 /**
@@ -118,11 +154,12 @@ get_typlen_fast(Oid type)
 Datum
 datum_copy(Datum value, Oid type)
 {
+  const BaseTypeInfo *info = base_type_info(type);
   /* For types passed by value */
-  if (get_typbyval_fast(type))
+  if (info->typbyval)
     return value;
   /* For types passed by reference */
-  int typlen = get_typlen_fast(type);
+  int typlen = info->typlen;
   size_t value_size = typlen != -1 ? (unsigned int) typlen : VARSIZE(value);
   void *result = palloc0(value_size);
   memcpy(result, DatumGetPointer(value), value_size);
@@ -144,36 +181,146 @@ datum_double(Datum d, Oid valuetypid)
   return result;
 }
 
+/*****************************************************************************
+ * Time summary functions
+ *****************************************************************************/
+
+/**
+ * Returns the number of keys of the time summary of a temporal instant set
+ * or sequence set value with the given number of elements
+ */
+int
+time_summary_count(int count)
+{
+  return (count + TIME_SUMMARY_BLOCK_SIZE - 1) / TIME_SUMMARY_BLOCK_SIZE;
+}
+
+/**
+ * Returns the number of the last block of the time summary whose key is
+ * less than or equal to the timestamp, or -1 if the timestamp is before
+ * the first key
+ *
+ * The keys of the time summary are stored contiguously so that the binary
+ * search only touches a few cache lines, instead of dereferencing the
+ * offsets of the elements of the temporal value on every probe.
+ *
+ * @param[in] keys Keys of the time summary
+ * @param[in] count Number of keys
+ * @param[in] t Timestamp
+ */
+int
+time_summary_find(const TimestampTz *keys, int count, TimestampTz t)
+{
+  int first = 0, last = count - 1;
+  while (first <= last)
+  {
+    int middle = (first + last) / 2;
+    if (keys[middle] <= t)
+      first = middle + 1;
+    else
+      last = middle - 1;
+  }
+  return last;
+}
+
 /*****************************************************************************
  * Call PostgreSQL functions
  *****************************************************************************/
 
+/** Number of input functions kept by call_input */
+#define CALL_INPUT_CACHE_SIZE  4
+
+/**
+ * Structure to represent the input functions kept by call_input
+ */
+typedef struct
+{
+  Oid type;          /**< Oid of the type, InvalidOid if the entry is free */
+  Oid typioparam;    /**< Oid of the type passed to the input function */
+  FmgrInfo infunc;   /**< Input function */
+} CallInputEntry;
+
+static CallInputEntry call_input_cache[CALL_INPUT_CACHE_SIZE];
+/** Next entry of the cache to be replaced */
+static int call_input_next = 0;
+
 /**
  * Call input function of the base type
+ *
+ * The input functions of the last types are kept since the parsing of a
+ * temporal value calls them for each of its instants.
  */
 Datum
 call_input(Oid type, char *str)
 {
-  Oid infunc;
-  Oid basetype;
-  FmgrInfo infuncinfo;
-  getTypeInputInfo(type, &infunc, &basetype);
-  fmgr_info(infunc, &infuncinfo);
-  return InputFunctionCall(&infuncinfo, str, basetype, -1);
+  CallInputEntry *entry = NULL;
+  for (int i = 0; i < CALL_INPUT_CACHE_SIZE; i++)
+  {
+    if (call_input_cache[i].type == type && OidIsValid(type))
+    {
+      entry = &call_input_cache[i];
+      break;
+    }
+  }
+  if (entry == NULL)
+  {
+    Oid infunc;
+    entry = &call_input_cache[call_input_next];
+    call_input_next = (call_input_next + 1) % CALL_INPUT_CACHE_SIZE;
+    entry->type = InvalidOid;
+    getTypeInputInfo(type, &infunc, &entry->typioparam);
+    fmgr_info_cxt(infunc, &entry->infunc, TopMemoryContext);
+    entry->type = type;
+  }
+  return InputFunctionCall(&entry->infunc, str, entry->typioparam, -1);
 }
 
+/** Number of output functions kept by call_output */
+#define CALL_OUTPUT_CACHE_SIZE  4
+
+/**
+ * Structure to represent the output functions kept by call_output
+ */
+typedef struct
+{
+  Oid type;          /**< Oid of the type, InvalidOid if the entry is free */
+  FmgrInfo outfunc;  /**< Output function */
+} CallOutputEntry;
+
+static CallOutputEntry call_output_cache[CALL_OUTPUT_CACHE_SIZE];
+/** Next entry of the cache to be replaced */
+static int call_output_next = 0;
+
 /**
  * Call output function of the base type
+ *
+ * As for call_input, the output functions of the last types are kept since
+ * the output of a temporal value calls them for each of its instants.
  */
 char *
 call_output(Oid type, Datum value)
 {
-  Oid outfunc;
-  bool isvarlena;
-  FmgrInfo outfuncinfo;
-  getTypeOutputInfo(type, &outfunc, &isvarlena);
-  fmgr_info(outfunc, &outfuncinfo);
-  return OutputFunctionCall(&outfuncinfo, value);
+  CallOutputEntry *entry = NULL;
+  for (int i = 0; i < CALL_OUTPUT_CACHE_SIZE; i++)
+  {
+    if (call_output_cache[i].type == type && OidIsValid(type))
+    {
+      entry = &call_output_cache[i];
+      break;
+    }
+  }
+  if (entry == NULL)
+  {
+    Oid outfunc;
+    bool isvarlena;
+    entry = &call_output_cache[call_output_next];
+    call_output_next = (call_output_next + 1) % CALL_OUTPUT_CACHE_SIZE;
+    entry->type = InvalidOid;
+    getTypeOutputInfo(type, &outfunc, &isvarlena);
+    fmgr_info_cxt(outfunc, &entry->outfunc, TopMemoryContext);
+    entry->type = type;
+  }
+  return OutputFunctionCall(&entry->outfunc, value);
 }
 
 /**
@@ -477,6 +624,9 @@ rangearr_extract(ArrayType *array, int *count)
 
 /**
  * Extract a C array from a PostgreSQL array containing temporal values
+ *
+ * @note The elements are unpacked since they may come from a column
+ * with packed storage
  */
 Temporal **
 temporalarr_extract(ArrayType *array, int *count)
@@ -484,6 +634,8 @@ temporalarr_extract(ArrayType *array, int *count)
   Temporal **result;
   deconstruct_array(array, array->elemtype, -1, false, 'd',
     (Datum **) &result, NULL, count);
+  for (int i = 0; i < *count; i++)
+    result[i] = temporal_unpack(result[i]);
   return result;
 }
 
@@ -666,6 +818,98 @@ tsequencearr_sort_cmp(TSequence **l, TSequence **r)
 
 /*****************************************************************************/
 
+/**
+ * Returns the key of the timestamp for the radix sort, in which the order of
+ * the unsigned keys is the order of the timestamps
+ */
+static inline uint64
+timestamp_radix_key(TimestampTz t)
+{
+  return ((uint64) t) ^ UINT64CONST(0x8000000000000000);
+}
+
+/**
+ * Stable LSD radix sort of the keys, moving along with them the items if
+ * they are not NULL
+ *
+ * The keys are processed one byte at a time starting from the least
+ * significant one, and the bytes that are equal in all the keys are
+ * skipped. This is typically the case of the most significant bytes of
+ * timestamps that are close in time.
+ */
+static void
+radix_sort(uint64 *keys, void **items, int count)
+{
+  uint64 diff = 0;
+  for (int i = 1; i < count; i++)
+    diff |= keys[i] ^ keys[0];
+  if (diff == 0)
+    return;
+
+  uint64 *srckeys = keys, *dstkeys = palloc(sizeof(uint64) * count);
+  void **srcitems = items, **dstitems = (items == NULL) ? NULL :
+    palloc(sizeof(void *) * count);
+  int offsets[256];
+  for (int shift = 0; shift < 64; shift += 8)
+  {
+    if (((diff >> shift) & 0xFF) == 0)
+      continue;
+    memset(offsets, 0, sizeof(offsets));
+    for (int i = 0; i < count; i++)
+      offsets[(srckeys[i] >> shift) & 0xFF]++;
+    int sum = 0;
+    for (int i = 0; i < 256; i++)
+    {
+      int n = offsets[i];
+      offsets[i] = sum;
+      sum += n;
+    }
+    for (int i = 0; i < count; i++)
+    {
+      int pos = offsets[(srckeys[i] >> shift) & 0xFF]++;
+      dstkeys[pos] = srckeys[i];
+      if (items != NULL)
+        dstitems[pos] = srcitems[i];
+    }
+    uint64 *tmpkeys = srckeys; srckeys = dstkeys; dstkeys = tmpkeys;
+    void **tmpitems = srcitems; srcitems = dstitems; dstitems = tmpitems;
+  }
+  /* Copy back the result if it ended in the temporary arrays */
+  if (srckeys != keys)
+  {
+    memcpy(keys, srckeys, sizeof(uint64) * count);
+    if (items != NULL)
+      memcpy(items, srcitems, sizeof(void *) * count);
+  }
+  pfree(srckeys == keys ? dstkeys : srckeys);
+  if (items != NULL)
+    pfree(srcitems == items ? dstitems : srcitems);
+  return;
+}
+
+/**
+ * Sort the pointers by the timestamps given in the keys, and then the runs
+ * of pointers with equal timestamps with the comparator function
+ */
+static void
+radix_sort_ptrs(void **items, uint64 *keys, int count, qsort_comparator cmp)
+{
+  radix_sort(keys, items, count);
+  if (cmp == NULL)
+    return;
+  int start = 0;
+  for (int i = 1; i <= count; i++)
+  {
+    if (i == count || keys[i] != keys[start])
+    {
+      if (i - start > 1)
+        qsort(&items[start], (size_t) (i - start), sizeof(void *), cmp);
+      start = i;
+    }
+  }
+  return;
+}
+
 /**
  * Sort function for datums
  */
@@ -678,12 +922,32 @@ datumarr_sort(Datum *values, int count, Oid type)
 
 /**
  * Sort function for timestamps
+ *
+ * @note Arrays that are already sorted, which is the common case, are
+ * detected in a single pass and small arrays are sorted with qsort
  */
 void
 timestamparr_sort(TimestampTz *times, int count)
 {
-  qsort(times, (size_t) count, sizeof(TimestampTz),
-    (qsort_comparator) &timestamp_sort_cmp);
+  int i = 1;
+  while (i < count && times[i - 1] <= times[i])
+    i++;
+  if (i >= count)
+    return;
+  if (count < RADIX_SORT_MINCOUNT)
+  {
+    qsort(times, (size_t) count, sizeof(TimestampTz),
+      (qsort_comparator) &timestamp_sort_cmp);
+    return;
+  }
+  /* The timestamps are transformed into keys in place and back */
+  uint64 *keys = (uint64 *) times;
+  for (i = 0; i < count; i++)
+    keys[i] = timestamp_radix_key(times[i]);
+  radix_sort(keys, NULL, count);
+  for (i = 0; i < count; i++)
+    times[i] = (TimestampTz) timestamp_radix_key((TimestampTz) keys[i]);
+  return;
 }
 
 /**
@@ -692,8 +956,24 @@ timestamparr_sort(TimestampTz *times, int count)
 void
 periodarr_sort(Period **periods, int count)
 {
-  qsort(periods, (size_t) count, sizeof(Period *),
+  int i = 1;
+  while (i < count && period_cmp_internal(periods[i - 1], periods[i]) <= 0)
+    i++;
+  if (i >= count)
+    return;
+  if (count < RADIX_SORT_MINCOUNT)
+  {
+    qsort(periods, (size_t) count, sizeof(Period *),
+      (qsort_comparator) &period_sort_cmp);
+    return;
+  }
+  uint64 *keys = palloc(sizeof(uint64) * count);
+  for (i = 0; i < count; i++)
+    keys[i] = timestamp_radix_key(periods[i]->lower);
+  radix_sort_ptrs((void **) periods, keys, count,
     (qsort_comparator) &period_sort_cmp);
+  pfree(keys);
+  return;
 }
 
 /**
@@ -712,8 +992,23 @@ rangearr_sort(RangeType **ranges, int count)
 void
 tinstantarr_sort(TInstant **instants, int count)
 {
-  qsort(instants, (size_t) count, sizeof(TInstant *),
-    (qsort_comparator) &tinstantarr_sort_cmp);
+  int i = 1;
+  while (i < count && instants[i - 1]->t <= instants[i]->t)
+    i++;
+  if (i >= count)
+    return;
+  if (count < RADIX_SORT_MINCOUNT)
+  {
+    qsort(instants, (size_t) count, sizeof(TInstant *),
+      (qsort_comparator) &tinstantarr_sort_cmp);
+    return;
+  }
+  uint64 *keys = palloc(sizeof(uint64) * count);
+  for (i = 0; i < count; i++)
+    keys[i] = timestamp_radix_key(instants[i]->t);
+  radix_sort_ptrs((void **) instants, keys, count, NULL);
+  pfree(keys);
+  return;
 }
 
 /**
@@ -722,8 +1017,25 @@ tinstantarr_sort(TInstant **instants, int count)
 void
 tsequencearr_sort(TSequence **sequences, int count)
 {
-  qsort(sequences, (size_t) count, sizeof(TSequence *),
+  int i = 1;
+  while (i < count && tsequencearr_sort_cmp(&sequences[i - 1],
+      &sequences[i]) <= 0)
+    i++;
+  if (i >= count)
+    return;
+  if (count < RADIX_SORT_MINCOUNT)
+  {
+    qsort(sequences, (size_t) count, sizeof(TSequence *),
+      (qsort_comparator) &tsequencearr_sort_cmp);
+    return;
+  }
+  uint64 *keys = palloc(sizeof(uint64) * count);
+  for (i = 0; i < count; i++)
+    keys[i] = timestamp_radix_key(sequences[i]->period.lower);
+  radix_sort_ptrs((void **) sequences, keys, count,
     (qsort_comparator) &tsequencearr_sort_cmp);
+  pfree(keys);
+  return;
 }
 
 /*****************************************************************************
@@ -799,6 +1111,23 @@ text_cmp(text *arg1, text *arg2, Oid collid)
   return varstr_cmp(a1p, len1, a2p, len2, collid);
 }
 
+/**
+ * Returns true if the two text values are equal
+ *
+ * @note Since the default collation is deterministic, two text values are
+ * equal if and only if they have the same bytes, which avoids the cost of a
+ * collation-aware comparison for the text values of temporal types, which
+ * are usually repeated across the instants.
+ */
+bool
+text_eq(text *arg1, text *arg2)
+{
+  int len1 = (int) VARSIZE_ANY_EXHDR(arg1);
+  int len2 = (int) VARSIZE_ANY_EXHDR(arg2);
+  return len1 == len2 &&
+    memcmp(VARDATA_ANY(arg1), VARDATA_ANY(arg2), len1) == 0;
+}
+
 /*****************************************************************************
  * Comparison functions on datums
  *****************************************************************************/
@@ -816,7 +1145,7 @@ datum_eq(Datum l, Datum r, Oid type)
   if (type == BOOLOID || type == INT4OID || type == FLOAT8OID)
     result = l == r;
   else if (type == TEXTOID)
-    result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) == 0;
+    result = text_eq(DatumGetTextPP(l), DatumGetTextPP(r));
   else if (type == type_oid(T_DOUBLE2))
     result = double2_eq((double2 *)DatumGetPointer(l), (double2 *)DatumGetPointer(r));
   else if (type == type_oid(T_DOUBLE3))
@@ -856,7 +1185,8 @@ datum_lt(Datum l, Datum r, Oid type)
   else if (type == FLOAT8OID)
     result = DatumGetFloat8(l) < DatumGetFloat8(r);
   else if (type == TEXTOID)
-    result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) < 0;
+    result = ! text_eq(DatumGetTextPP(l), DatumGetTextPP(r)) &&
+      text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) < 0;
   else if (type == type_oid(T_GEOMETRY))
     result = DatumGetBool(call_function2(lwgeom_lt, l, r));
   else if (type == type_oid(T_GEOGRAPHY))
@@ -916,7 +1246,7 @@ datum_eq2(Datum l, Datum r, Oid typel, Oid typer)
   else if (typel == FLOAT8OID && typer == INT4OID)
     result = DatumGetFloat8(l) == DatumGetInt32(r);
   else if (typel == TEXTOID && typer == TEXTOID)
-    result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) == 0;
+    result = text_eq(DatumGetTextPP(l), DatumGetTextPP(r));
     /* This function is never called with doubleN */
   else if (typel == type_oid(T_GEOMETRY) && typer == type_oid(T_GEOMETRY))
     //  result = DatumGetBool(call_function2(lwgeom_eq, l, r));
@@ -954,7 +1284,8 @@ datum_lt2(Datum l, Datum r, Oid typel, Oid typer)
   else if (typel == FLOAT8OID && typer == FLOAT8OID)
     result = DatumGetFloat8(l) < DatumGetFloat8(r);
   else if (typel == TEXTOID && typer == TEXTOID)
-    result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) < 0;
+    result = ! text_eq(DatumGetTextPP(l), DatumGetTextPP(r)) &&
+      text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) < 0;
   return result;
 }
 
@@ -1041,6 +1372,57 @@ datum2_ge2(Datum l, Datum r, Oid typel, Oid typer)
   return BoolGetDatum(datum_ge2(l, r, typel, typer));
 }
 
+/*
+ * Versions of the functions above for two float8 values. As in datum_eq2,
+ * the equality of two float8 values compares their representation.
+ */
+
+#define DATUM2_COMP_FLOAT8(name, expr) \
+static Datum \
+name(Datum l, Datum r, Oid typel, Oid typer) \
+{ \
+  return BoolGetDatum(expr); \
+}
+
+DATUM2_COMP_FLOAT8(datum2_eq2_float8, l == r)
+DATUM2_COMP_FLOAT8(datum2_ne2_float8, l != r)
+DATUM2_COMP_FLOAT8(datum2_lt2_float8, DatumGetFloat8(l) < DatumGetFloat8(r))
+DATUM2_COMP_FLOAT8(datum2_le2_float8,
+  l == r || DatumGetFloat8(l) < DatumGetFloat8(r))
+DATUM2_COMP_FLOAT8(datum2_gt2_float8, DatumGetFloat8(r) < DatumGetFloat8(l))
+DATUM2_COMP_FLOAT8(datum2_ge2_float8,
+  l == r || DatumGetFloat8(r) < DatumGetFloat8(l))
+
+/**
+ * Returns the comparison function applied to the values of the given types
+ *
+ * The generic functions above dispatch on, and verify, the types of their
+ * arguments for every pair of values. The lifted comparisons select once
+ * per call the version specialized for two float8 values when there is one.
+ *
+ * @param[in] func Generic comparison function
+ * @param[in] typel, typer Oids of the types of the arguments
+ */
+Datum (*datum2_comp_func(Datum (*func)(Datum, Datum, Oid, Oid),
+  Oid typel, Oid typer))(Datum, Datum, Oid, Oid)
+{
+  if (typel != FLOAT8OID || typer != FLOAT8OID)
+    return func;
+  if (func == &datum2_eq2)
+    return &datum2_eq2_float8;
+  if (func == &datum2_ne2)
+    return &datum2_ne2_float8;
+  if (func == &datum2_lt2)
+    return &datum2_lt2_float8;
+  if (func == &datum2_le2)
+    return &datum2_le2_float8;
+  if (func == &datum2_gt2)
+    return &datum2_gt2_float8;
+  if (func == &datum2_ge2)
+    return &datum2_ge2_float8;
+  return func;
+}
+
 /*****************************************************************************/
 
 /**
@@ -1164,5 +1546,93 @@ hypot4d(double x, double y, double z, double m)
   return x * sqrt(1.0 + (yx * yx) + (zx * zx) + (mx * mx));
 }
 
+/*****************************************************************************
+ * Float4 rounding functions
+ * These functions convert a double into the closest float4 that is below
+ * or above it, so that a box with float4 bounds obtained by rounding outward
+ * always contains the original box.
+ *****************************************************************************/
+
+/**
+ * Returns the greatest float4 that is less than or equal to the double
+ */
+float4
+float4_round_down(double d)
+{
+  float4 result;
+  if (isnan(d) || isinf(d))
+    return (float4) d;
+  if (d > FLT_MAX)
+    return FLT_MAX;
+  if (d < -FLT_MAX)
+    return -get_float4_infinity();
+  result = (float4) d;
+  if ((double) result > d)
+    result = nextafterf(result, -get_float4_infinity());
+  return result;
+}
+
+/**
+ * Returns the least float4 that is greater than or equal to the double
+ */
+float4
+float4_round_up(double d)
+{
+  float4 result;
+  if (isnan(d) || isinf(d))
+    return (float4) d;
+  if (d > FLT_MAX)
+    return get_float4_infinity();
+  if (d < -FLT_MAX)
+    return -FLT_MAX;
+  result = (float4) d;
+  if ((double) result < d)
+    result = nextafterf(result, get_float4_infinity());
+  return result;
+}
+
+/*****************************************************************************
+ * Z-order functions
+ *****************************************************************************/
+
+/**
+ * Returns the cell of a value in a grid of 2^bits cells that splits the
+ * extent [min, max] into equal parts. Values outside of the extent are
+ * assigned to the first or the last cell.
+ */
+uint32
+zorder_cell(double value, double min, double max, int bits)
+{
+  double maxcell = (double) ((UINT64CONST(1) << bits) - 1);
+  double frac;
+  if (max <= min || value <= min)
+    return 0;
+  if (value >= max)
+    return (uint32) maxcell;
+  frac = (value - min) / (max - min);
+  return (uint32) (frac * maxcell);
+}
+
+/**
+ * Returns the Z-order key of a cell, i.e., the integer obtained by
+ * interleaving the bits of its coordinates, starting with the most
+ * significant bit of the first dimension.
+ *
+ * @param[in] cells Coordinates of the cell
+ * @param[in] ndims Number of dimensions
+ * @param[in] bits Number of bits per dimension, at most 64 / ndims
+ */
+uint64
+zorder_encode(const uint32 *cells, int ndims, int bits)
+{
+  uint64 result = 0;
+  for (int i = bits - 1; i >= 0; i--)
+  {
+    for (int j = 0; j < ndims; j++)
+      result = (result << 1) | ((cells[j] >> i) & 1);
+  }
+  return result;
+}
+
 /*****************************************************************************/
 
@@ -536,6 +536,462 @@ tnumber_transform_wavg(Temporal *temp, Interval *interval, int *count)
   return result;
 }
 
+/*****************************************************************************
+ * Sliding-window aggregation
+ * The moving window aggregate of a temporal value is computed in a single
+ * pass. Each instant or segment of the value is converted into a constant
+ * piece extended by the time interval, as done by the functions above. Since
+ * both the start and the end of the pieces are increasing, the pieces enter
+ * and leave the window in the same order. The window is kept in a monotonic
+ * deque for the minimum and the maximum and in two stacks of partial
+ * aggregates for the other functions, so that the value of the window is
+ * obtained in amortized constant time at each start or end of a piece.
+ * The resulting sequence set is then spliced at once into the skiplist.
+ *****************************************************************************/
+
+/**
+ * Enumeration for the value of the instants that is aggregated by the
+ * moving window aggregate functions
+ */
+typedef enum
+{
+  WINDOW_VALUE,
+  WINDOW_COUNT,
+  WINDOW_AVG
+} WindowValue;
+
+/**
+ * Constant piece of a temporal value extended by the time interval
+ */
+typedef struct
+{
+  Datum value;              /**< value of the piece */
+  TimestampTz lower;        /**< start of the piece */
+  TimestampTz upper;        /**< end of the piece extended by the interval */
+  bool lower_inc;           /**< lower bound is inclusive */
+  bool upper_inc;           /**< upper bound is inclusive */
+} WindowPiece;
+
+/**
+ * Pieces that are currently in the window, that is, the pieces whose index
+ * is in [head, tail)
+ */
+typedef struct
+{
+  const WindowPiece *pieces;        /**< pieces of the temporal value */
+  Datum (*func)(Datum, Datum);      /**< aggregate function */
+  Oid valuetypid;                   /**< type of the values */
+  bool minmax;                      /**< minimum or maximum function */
+  int head;                         /**< first piece in the window */
+  int tail;                         /**< next piece to enter the window */
+  /* Monotonic deque for the minimum and the maximum */
+  int *deque;                       /**< indexes of the candidate pieces */
+  int dqhead;                       /**< first candidate in the deque */
+  int dqtail;                       /**< next position in the deque */
+  /* Two stacks for the other functions */
+  Datum *suffix;                    /**< aggregates of [i, mid) for i < mid */
+  int mid;                          /**< first piece in the back stack */
+  Datum backagg;                    /**< aggregate of [mid, tail) */
+} WindowQueue;
+
+/**
+ * Returns the value of the instant that is aggregated
+ *
+ * @param[in] inst Temporal value
+ * @param[in] wvalue Value that is aggregated
+ */
+static Datum
+window_inst_value(const TInstant *inst, WindowValue wvalue)
+{
+  if (wvalue == WINDOW_COUNT)
+    return Int32GetDatum(1);
+  Datum value = tinstant_value(inst);
+  if (wvalue == WINDOW_VALUE)
+    return value;
+  /* wvalue == WINDOW_AVG */
+  double2 *dvalue = palloc(sizeof(double2));
+  double2_set(dvalue, datum_double(value, inst->valuetypid), 1);
+  return PointerGetDatum(dvalue);
+}
+
+/**
+ * Set a piece from its arguments
+ */
+static void
+window_piece_set(WindowPiece *piece, Datum value, TimestampTz lower,
+  TimestampTz upper, bool lower_inc, bool upper_inc)
+{
+  piece->value = value;
+  piece->lower = lower;
+  piece->upper = upper;
+  piece->lower_inc = lower_inc;
+  piece->upper_inc = upper_inc;
+  return;
+}
+
+/**
+ * Returns the timestamp extended by the time interval
+ */
+static TimestampTz
+window_extend(TimestampTz t, const Interval *interval)
+{
+  return DatumGetTimestampTz(DirectFunctionCall2(timestamptz_pl_interval,
+    TimestampTzGetDatum(t), PointerGetDatum(interval)));
+}
+
+/**
+ * Compute the pieces of the temporal instant value
+ *
+ * @param[out] result Array on which the pieces are stored
+ * @param[in] inst Temporal value
+ * @param[in] interval Interval
+ * @param[in] wvalue Value that is aggregated
+ */
+static int
+tinstant_window_pieces(WindowPiece *result, const TInstant *inst,
+  const Interval *interval, WindowValue wvalue)
+{
+  window_piece_set(&result[0], window_inst_value(inst, wvalue), inst->t,
+    window_extend(inst->t, interval), true, true);
+  return 1;
+}
+
+/**
+ * Compute the pieces of the temporal sequence value
+ *
+ * @param[out] result Array on which the pieces are stored
+ * @param[in] seq Temporal value
+ * @param[in] interval Interval
+ * @param[in] wvalue Value that is aggregated
+ */
+static int
+tsequence_window_pieces(WindowPiece *result, const TSequence *seq,
+  const Interval *interval, WindowValue wvalue)
+{
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  if (seq->count == 1)
+    return tinstant_window_pieces(result, inst1, interval, wvalue);
+
+  bool lower_inc = seq->period.lower_inc;
+  for (int i = 0; i < seq->count - 1; i++)
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
+    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
+    window_piece_set(&result[i], window_inst_value(inst1, wvalue), inst1->t,
+      window_extend(inst2->t, interval), lower_inc, upper_inc);
+    inst1 = inst2;
+    lower_inc = true;
+  }
+  return seq->count - 1;
+}
+
+/**
+ * Compute the pieces of the temporal value (dispatch function)
+ *
+ * @param[in] temp Temporal value
+ * @param[in] interval Interval
+ * @param[in] wvalue Value that is aggregated
+ * @param[out] count Number of elements in the output array
+ */
+static WindowPiece *
+temporal_window_pieces(const Temporal *temp, const Interval *interval,
+  WindowValue wvalue, int *count)
+{
+  WindowPiece *result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+  {
+    result = palloc(sizeof(WindowPiece));
+    *count = tinstant_window_pieces(result, (TInstant *) temp, interval,
+      wvalue);
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    result = palloc(sizeof(WindowPiece) * ti->count);
+    for (int i = 0; i < ti->count; i++)
+      tinstant_window_pieces(&result[i], tinstantset_inst_n(ti, i), interval,
+        wvalue);
+    *count = ti->count;
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    result = palloc(sizeof(WindowPiece) * seq->count);
+    *count = tsequence_window_pieces(result, seq, interval, wvalue);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    result = palloc(sizeof(WindowPiece) * ts->totalcount);
+    int k = 0;
+    for (int i = 0; i < ts->count; i++)
+      k += tsequence_window_pieces(&result[k], tsequenceset_seq_n(ts, i),
+        interval, wvalue);
+    *count = k;
+  }
+  return result;
+}
+
+/**
+ * Add the next piece to the window
+ */
+static void
+windowqueue_push(WindowQueue *queue)
+{
+  Datum value = queue->pieces[queue->tail].value;
+  if (queue->minmax)
+  {
+    /* Remove the candidates that are dominated by the new piece, which
+     * leaves the window after them */
+    while (queue->dqhead < queue->dqtail &&
+      datum_eq(queue->func(queue->pieces[queue->deque[queue->dqtail - 1]].value,
+        value), value, queue->valuetypid))
+      queue->dqtail--;
+    queue->deque[queue->dqtail++] = queue->tail;
+  }
+  else
+    queue->backagg = (queue->mid == queue->tail) ? value :
+      queue->func(queue->backagg, value);
+  queue->tail++;
+  return;
+}
+
+/**
+ * Remove the first piece from the window
+ */
+static void
+windowqueue_pop(WindowQueue *queue)
+{
+  if (queue->minmax)
+  {
+    if (queue->deque[queue->dqhead] == queue->head)
+      queue->dqhead++;
+  }
+  else if (queue->head == queue->mid)
+  {
+    /* Move the pieces of the back stack into the front stack */
+    for (int i = queue->tail - 1; i >= queue->head; i--)
+      queue->suffix[i] = (i == queue->tail - 1) ? queue->pieces[i].value :
+        queue->func(queue->pieces[i].value, queue->suffix[i + 1]);
+    queue->mid = queue->tail;
+  }
+  queue->head++;
+  return;
+}
+
+/**
+ * Get the aggregate value of the pieces in the window
+ *
+ * @param[in] queue Window
+ * @param[out] result Aggregate value
+ * @result False if the window is empty
+ */
+static bool
+windowqueue_value(const WindowQueue *queue, Datum *result)
+{
+  if (queue->head == queue->tail)
+    return false;
+  if (queue->minmax)
+    *result = queue->pieces[queue->deque[queue->dqhead]].value;
+  else if (queue->head == queue->mid)
+    *result = queue->backagg;
+  else if (queue->mid == queue->tail)
+    *result = queue->suffix[queue->head];
+  else
+    *result = queue->func(queue->suffix[queue->head], queue->backagg);
+  return true;
+}
+
+/**
+ * Construct a constant sequence from its arguments
+ */
+static TSequence *
+window_sequence(Datum value, TimestampTz lower, TimestampTz upper,
+  bool lower_inc, bool upper_inc, Oid valuetypid, bool linear)
+{
+  TInstant *instants[2];
+  instants[0] = tinstant_make(value, lower, valuetypid);
+  if (lower == upper)
+  {
+    TSequence *result = tsequence_make(instants, 1, true, true, linear,
+      NORMALIZE_NO);
+    pfree(instants[0]);
+    return result;
+  }
+  instants[1] = tinstant_make(value, upper, valuetypid);
+  TSequence *result = tsequence_make(instants, 2, lower_inc, upper_inc,
+    linear, NORMALIZE_NO);
+  pfree(instants[0]); pfree(instants[1]);
+  return result;
+}
+
+/**
+ * Compute the moving window aggregate of the pieces in a single pass
+ *
+ * @param[in] pieces Pieces ordered by their start and by their end
+ * @param[in] count Number of elements in the array
+ * @param[in] func Aggregate function
+ * @param[in] minmax True when the function is the minimum or the maximum
+ * @param[in] valuetypid Type of the values
+ * @param[in] linear True when the result has linear interpolation
+ */
+static TSequenceSet *
+window_sweep(const WindowPiece *pieces, int count, Datum (*func)(Datum, Datum),
+  bool minmax, Oid valuetypid, bool linear)
+{
+  WindowQueue queue;
+  memset(&queue, 0, sizeof(WindowQueue));
+  queue.pieces = pieces;
+  queue.func = func;
+  queue.valuetypid = valuetypid;
+  queue.minmax = minmax;
+  if (minmax)
+    queue.deque = palloc(sizeof(int) * count);
+  else
+    queue.suffix = palloc(sizeof(Datum) * count);
+
+  /* Each start and each end of a piece constructs at most two sequences */
+  TSequence **sequences = palloc(sizeof(TSequence *) * 4 * count);
+  int k = 0;
+  while (queue.head < count)
+  {
+    /* Pieces that start or end at the next timestamp */
+    bool enter = queue.tail < count &&
+      pieces[queue.tail].lower <= pieces[queue.head].upper;
+    TimestampTz t = enter ? pieces[queue.tail].lower :
+      pieces[queue.head].upper;
+    bool leave = pieces[queue.head].upper == t;
+    /* Value at the timestamp */
+    if (leave && ! pieces[queue.head].upper_inc)
+    {
+      windowqueue_pop(&queue);
+      leave = false;
+    }
+    if (enter && pieces[queue.tail].lower_inc)
+    {
+      windowqueue_push(&queue);
+      enter = false;
+    }
+    Datum value_at, value_after;
+    bool at = windowqueue_value(&queue, &value_at);
+    /* Value after the timestamp */
+    if (leave)
+      windowqueue_pop(&queue);
+    if (enter)
+      windowqueue_push(&queue);
+    bool after = windowqueue_value(&queue, &value_after);
+    if (after)
+    {
+      TimestampTz next = (queue.tail < count &&
+        pieces[queue.tail].lower < pieces[queue.head].upper) ?
+        pieces[queue.tail].lower : pieces[queue.head].upper;
+      bool lower_inc = at && datum_eq(value_at, value_after, valuetypid);
+      if (at && ! lower_inc)
+        sequences[k++] = window_sequence(value_at, t, t, true, true,
+          valuetypid, linear);
+      sequences[k++] = window_sequence(value_after, t, next, lower_inc, false,
+        valuetypid, linear);
+    }
+    else if (at)
+      sequences[k++] = window_sequence(value_at, t, t, true, true,
+        valuetypid, linear);
+  }
+  if (minmax)
+    pfree(queue.deque);
+  else
+    pfree(queue.suffix);
+  return tsequenceset_make_free(sequences, k, NORMALIZE);
+}
+
+/**
+ * Returns true if the moving window aggregate of the temporal value can be
+ * computed in a single pass, that is, if the pieces of the value are constant
+ */
+static bool
+temporal_window_sweep_supported(const Temporal *temp, WindowValue wvalue)
+{
+  return wvalue == WINDOW_COUNT || temp->duration == INSTANT ||
+    temp->duration == INSTANTSET || ! MOBDB_FLAGS_GET_LINEAR(temp->flags);
+}
+
+/**
+ * Returns true if the starts and the ends of the pieces are strictly
+ * increasing and every piece has a positive duration. This may not be the
+ * case when the interval is not positive or has a month component.
+ */
+static bool
+window_pieces_valid(const WindowPiece *pieces, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (pieces[i].lower >= pieces[i].upper ||
+      (i > 0 && (pieces[i - 1].lower >= pieces[i].lower ||
+        pieces[i - 1].upper >= pieces[i].upper)))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Aggregate the moving window aggregate of the temporal value into the state
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[inout] state Skiplist containing the state
+ * @param[in] temp Temporal value
+ * @param[in] interval Interval
+ * @param[in] func Function
+ * @param[in] minmax True when the function is the minimum or the maximum
+ * @param[in] wvalue Value that is aggregated
+ * @param[in] crossings State whether turning points are added in the segments
+ * @result False if the aggregate cannot be computed in a single pass
+ */
+static bool
+temporal_wagg_sweep(FunctionCallInfo fcinfo, SkipList **state,
+  const Temporal *temp, const Interval *interval,
+  Datum (*func)(Datum, Datum), bool minmax, WindowValue wvalue,
+  bool crossings)
+{
+  if (! temporal_window_sweep_supported(temp, wvalue))
+    return false;
+  int count;
+  WindowPiece *pieces = temporal_window_pieces(temp, interval, wvalue, &count);
+  bool result = window_pieces_valid(pieces, count);
+  if (result)
+  {
+    Oid valuetypid;
+    bool linear;
+    if (wvalue == WINDOW_COUNT)
+    {
+      valuetypid = INT4OID;
+      linear = STEP;
+    }
+    else if (wvalue == WINDOW_AVG)
+    {
+      valuetypid = type_oid(T_DOUBLE2);
+      linear = true;
+    }
+    else
+    {
+      valuetypid = temp->valuetypid;
+      linear = (temp->duration == INSTANT || temp->duration == INSTANTSET) ?
+        linear_interpolation(temp->valuetypid) :
+        MOBDB_FLAGS_GET_LINEAR(temp->flags);
+    }
+    TSequenceSet *ts = window_sweep(pieces, count, func, minmax, valuetypid,
+      linear);
+    *state = tsequenceset_tagg_transfn(fcinfo, *state, ts, func, crossings);
+    pfree(ts);
+  }
+  if (wvalue == WINDOW_AVG)
+  {
+    for (int i = 0; i < count; i++)
+      pfree(DatumGetPointer(pieces[i].value));
+  }
+  pfree(pieces);
+  return result;
+}
+
 /*****************************************************************************
  * Generic moving window transition functions 
  *****************************************************************************/
@@ -599,8 +1055,15 @@ temporal_wagg_transfn(FunctionCallInfo fcinfo,
     ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
       errmsg("Operation not supported for temporal float sequences")));
       
-  SkipList *result = temporal_wagg_transfn1(fcinfo, state, temp, interval,
-    func, min, crossings);
+  /* The minimum and the maximum are the only functions that select one
+   * of their arguments */
+  bool minmax = (func == &datum_min_int32 || func == &datum_max_int32 ||
+    func == &datum_min_float8 || func == &datum_max_float8);
+  SkipList *result = state;
+  if (! temporal_wagg_sweep(fcinfo, &result, temp, interval, func, minmax,
+      WINDOW_VALUE, crossings))
+    result = temporal_wagg_transfn1(fcinfo, state, temp, interval,
+      func, min, crossings);
   
   PG_FREE_IF_COPY(temp, 1);
   PG_FREE_IF_COPY(interval, 2);
@@ -626,16 +1089,23 @@ temporal_wagg_transform_transfn(FunctionCallInfo fcinfo,
   }
   Temporal *temp = PG_GETARG_TEMPORAL(1);
   Interval *interval = PG_GETARG_INTERVAL_P(2);
-  int count;
-  TSequence **sequences = transform(temp, interval, &count);
-  SkipList *result = tsequence_tagg_transfn(fcinfo, state, sequences[0], 
-    func, false);
-  for (int i = 1; i < count; i++)
-    result = tsequence_tagg_transfn(fcinfo, result, sequences[i], 
+  SkipList *result = state;
+  WindowValue wvalue = (transform == &temporal_transform_wcount) ?
+    WINDOW_COUNT : WINDOW_AVG;
+  if (! temporal_wagg_sweep(fcinfo, &result, temp, interval, func, false,
+      wvalue, false))
+  {
+    int count;
+    TSequence **sequences = transform(temp, interval, &count);
+    result = tsequence_tagg_transfn(fcinfo, state, sequences[0], 
       func, false);
-  for (int i = 0; i < count; i++)
-    pfree(sequences[i]);
-  pfree(sequences);
+    for (int i = 1; i < count; i++)
+      result = tsequence_tagg_transfn(fcinfo, result, sequences[i], 
+        func, false);
+    for (int i = 0; i < count; i++)
+      pfree(sequences[i]);
+    pfree(sequences);
+  }
   PG_FREE_IF_COPY(temp, 1);
   PG_FREE_IF_COPY(interval, 2);
   PG_RETURN_POINTER(result);
@@ -0,0 +1,409 @@
+/*****************************************************************************
+ *
+ * temporal_wire.c
+ *    Compact binary format of temporal values for send/receive.
+ *
+ * The binary format written by temporal_write sends each instant with the
+ * send function of its base type, and thus repeats for temporal points the
+ * complete EWKB header of every point. The compact format written by the
+ * send function of the temporal types writes instead a header once, followed
+ * by the bounds of the sequences, the array of timestamps, and the array of
+ * values. All numbers are in network byte order as usual in PostgreSQL.
+ * @code
+ * uint8   0x80 | version (currently 1)
+ * uint8   duration (1 = instant, 2 = instant set, 3 = sequence,
+ *         4 = sequence set)
+ * uint8   base type (1 = bool, 2 = int4, 3 = float8, 4 = text,
+ *         5 = geometry, 6 = geography)
+ * uint8   flags (0x01 = linear interpolation, 0x02 = Z coordinates)
+ * int32   SRID, only for temporal points
+ * -- instant set: int32 number of instants
+ * -- sequence: int32 number of instants, uint8 lower_inc, uint8 upper_inc
+ * -- sequence set: int32 number of sequences, then for each sequence
+ *    int32 number of instants, uint8 lower_inc, uint8 upper_inc
+ * int64   timestamps of all the instants, in microseconds since 2000-01-01
+ * ...     values of all the instants: uint8 for bool, int32 for int4,
+ *         float8 for float8, int32 length and characters in the client
+ *         encoding for text, float8 x, y, and, if any, z for points
+ * @endcode
+ * Since the first byte of the previous format is the duration of the value,
+ * the receive function accepts both formats.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_wire.h"
+
+#include <libpq/pqformat.h>
+#include <utils/builtins.h>
+
+#include "oidcache.h"
+#include "temporal_util.h"
+#include "tinstant.h"
+#include "tinstantset.h"
+#include "tsequence.h"
+#include "tsequenceset.h"
+
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * Utility functions
+ *****************************************************************************/
+
+/**
+ * Write a 32-bit integer into the buffer
+ */
+static void
+wire_send_int32(StringInfo buf, int32 value)
+{
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(buf, (uint32) value, 4);
+#else
+  pq_sendint32(buf, (uint32) value);
+#endif
+}
+
+/**
+ * Returns the code of the base type in the compact format
+ */
+static uint8
+wire_type_code(Oid valuetypid)
+{
+  if (valuetypid == BOOLOID)
+    return WIRE_TYPE_BOOL;
+  if (valuetypid == INT4OID)
+    return WIRE_TYPE_INT4;
+  if (valuetypid == FLOAT8OID)
+    return WIRE_TYPE_FLOAT8;
+  if (valuetypid == TEXTOID)
+    return WIRE_TYPE_TEXT;
+  if (valuetypid == type_oid(T_GEOMETRY))
+    return WIRE_TYPE_GEOMETRY;
+  if (valuetypid == type_oid(T_GEOGRAPHY))
+    return WIRE_TYPE_GEOGRAPHY;
+  elog(ERROR, "unknown base type for the binary format: %d", valuetypid);
+  return 0; /* make compiler quiet */
+}
+
+/**
+ * Read a count from the buffer and ensure that the remaining data may
+ * contain that number of elements of the given minimum size
+ */
+static int
+wire_getmsgcount(StringInfo buf, int minsize)
+{
+  int count = (int) pq_getmsgint(buf, 4);
+  if (count <= 0 || count > (buf->len - buf->cursor) / minsize)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Invalid number of elements in the binary temporal value")));
+  return count;
+}
+
+/**
+ * Returns true if the buffer contains a temporal value in the compact format
+ */
+bool
+temporal_wire_is_compact(StringInfo buf)
+{
+  return buf->cursor < buf->len &&
+    (((uint8) buf->data[buf->cursor]) & WIRE_MARKER) != 0;
+}
+
+/*****************************************************************************
+ * Send function
+ *****************************************************************************/
+
+/**
+ * Write the timestamps and the values of the instants into the buffer
+ *
+ * @param[in] buf Buffer
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ * @param[in] hasz True when the points have Z coordinates
+ */
+static void
+tinstantarr_wire_write(StringInfo buf, TInstant **instants, int count,
+  bool hasz)
+{
+  Oid valuetypid = instants[0]->valuetypid;
+  for (int i = 0; i < count; i++)
+    pq_sendint64(buf, instants[i]->t);
+  for (int i = 0; i < count; i++)
+  {
+    Datum value = tinstant_value(instants[i]);
+    if (valuetypid == BOOLOID)
+      pq_sendbyte(buf, DatumGetBool(value) ? (uint8) 1 : (uint8) 0);
+    else if (valuetypid == INT4OID)
+      wire_send_int32(buf, DatumGetInt32(value));
+    else if (valuetypid == FLOAT8OID)
+      pq_sendfloat8(buf, DatumGetFloat8(value));
+    else if (valuetypid == TEXTOID)
+    {
+      text *txt = DatumGetTextPP(value);
+      pq_sendcountedtext(buf, VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt),
+        false);
+    }
+    else if (hasz)
+    {
+      POINT3DZ point = datum_get_point3dz(value);
+      pq_sendfloat8(buf, point.x);
+      pq_sendfloat8(buf, point.y);
+      pq_sendfloat8(buf, point.z);
+    }
+    else
+    {
+      POINT2D point = datum_get_point2d(value);
+      pq_sendfloat8(buf, point.x);
+      pq_sendfloat8(buf, point.y);
+    }
+  }
+  return;
+}
+
+/**
+ * Write the compact binary representation of the temporal value into the
+ * buffer
+ *
+ * @param[in] temp Temporal value
+ * @param[in] buf Buffer
+ */
+void
+temporal_wire_write(const Temporal *temp, StringInfo buf)
+{
+  ensure_valid_duration(temp->duration);
+  bool isgeo = tgeo_base_type(temp->valuetypid);
+  bool hasz = isgeo && MOBDB_FLAGS_GET_Z(temp->flags);
+  uint8 flags = 0;
+  if (MOBDB_FLAGS_GET_LINEAR(temp->flags))
+    flags |= WIRE_FLAG_LINEAR;
+  if (hasz)
+    flags |= WIRE_FLAG_Z;
+  pq_sendbyte(buf, WIRE_MARKER | WIRE_VERSION);
+  pq_sendbyte(buf, (uint8) temp->duration);
+  pq_sendbyte(buf, wire_type_code(temp->valuetypid));
+  pq_sendbyte(buf, flags);
+
+  int count;
+  TInstant **instants;
+  if (temp->duration == INSTANT)
+  {
+    count = 1;
+    instants = palloc(sizeof(TInstant *));
+    instants[0] = (TInstant *) temp;
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    count = ti->count;
+    instants = palloc(sizeof(TInstant *) * count);
+    for (int i = 0; i < count; i++)
+      instants[i] = tinstantset_inst_n(ti, i);
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    count = seq->count;
+    instants = palloc(sizeof(TInstant *) * count);
+    for (int i = 0; i < count; i++)
+      instants[i] = tsequence_inst_n(seq, i);
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    count = ts->totalcount;
+    instants = palloc(sizeof(TInstant *) * count);
+    int k = 0;
+    for (int i = 0; i < ts->count; i++)
+    {
+      TSequence *seq = tsequenceset_seq_n(ts, i);
+      for (int j = 0; j < seq->count; j++)
+        instants[k++] = tsequence_inst_n(seq, j);
+    }
+  }
+  if (isgeo)
+    wire_send_int32(buf, gserialized_get_srid(
+      (GSERIALIZED *) DatumGetPointer(tinstant_value(instants[0]))));
+
+  /* Bounds of the sequences */
+  if (temp->duration == INSTANTSET)
+    wire_send_int32(buf, count);
+  else if (temp->duration == SEQUENCE)
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    wire_send_int32(buf, seq->count);
+    pq_sendbyte(buf, seq->period.lower_inc ? (uint8) 1 : (uint8) 0);
+    pq_sendbyte(buf, seq->period.upper_inc ? (uint8) 1 : (uint8) 0);
+  }
+  else if (temp->duration == SEQUENCESET)
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    wire_send_int32(buf, ts->count);
+    for (int i = 0; i < ts->count; i++)
+    {
+      TSequence *seq = tsequenceset_seq_n(ts, i);
+      wire_send_int32(buf, seq->count);
+      pq_sendbyte(buf, seq->period.lower_inc ? (uint8) 1 : (uint8) 0);
+      pq_sendbyte(buf, seq->period.upper_inc ? (uint8) 1 : (uint8) 0);
+    }
+  }
+  tinstantarr_wire_write(buf, instants, count, hasz);
+  pfree(instants);
+  return;
+}
+
+/*****************************************************************************
+ * Receive function
+ *****************************************************************************/
+
+/**
+ * Read the timestamps and the values of the instants from the buffer
+ *
+ * @param[in] buf Buffer
+ * @param[in] count Number of instants
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] srid SRID of the points
+ * @param[in] hasz True when the points have Z coordinates
+ */
+static TInstant **
+tinstantarr_wire_read(StringInfo buf, int count, Oid valuetypid, int32 srid,
+  bool hasz)
+{
+  bool isgeo = tgeo_base_type(valuetypid);
+  bool geodetic = (valuetypid == type_oid(T_GEOGRAPHY));
+  TimestampTz *times = palloc(sizeof(TimestampTz) * count);
+  for (int i = 0; i < count; i++)
+    times[i] = (TimestampTz) pq_getmsgint64(buf);
+  TInstant **result = palloc(sizeof(TInstant *) * count);
+  for (int i = 0; i < count; i++)
+  {
+    Datum value;
+    if (valuetypid == BOOLOID)
+      value = BoolGetDatum(pq_getmsgbyte(buf) != 0);
+    else if (valuetypid == INT4OID)
+      value = Int32GetDatum((int32) pq_getmsgint(buf, 4));
+    else if (valuetypid == FLOAT8OID)
+      value = Float8GetDatum(pq_getmsgfloat8(buf));
+    else if (valuetypid == TEXTOID)
+    {
+      int len = (int) pq_getmsgint(buf, 4);
+      int nbytes;
+      char *str = pq_getmsgtext(buf, len, &nbytes);
+      value = PointerGetDatum(cstring_to_text_with_len(str, nbytes));
+      pfree(str);
+    }
+    else
+    {
+      double x = pq_getmsgfloat8(buf);
+      double y = pq_getmsgfloat8(buf);
+      double z = hasz ? pq_getmsgfloat8(buf) : 0;
+      LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, x, y, z) :
+        lwpoint_make2d(srid, x, y);
+      FLAGS_SET_GEODETIC(lwpoint->flags, geodetic);
+      value = PointerGetDatum(geo_serialize((LWGEOM *) lwpoint));
+      lwpoint_free(lwpoint);
+    }
+    result[i] = tinstant_make(value, times[i], valuetypid);
+    if (isgeo || valuetypid == TEXTOID)
+      pfree(DatumGetPointer(value));
+  }
+  pfree(times);
+  return result;
+}
+
+/**
+ * Returns a new temporal value from its compact binary representation
+ * read from the buffer
+ *
+ * @param[in] buf Buffer
+ * @param[in] valuetypid Oid of the base type
+ */
+Temporal *
+temporal_wire_read(StringInfo buf, Oid valuetypid)
+{
+  uint8 version = (uint8) pq_getmsgbyte(buf) & ~WIRE_MARKER;
+  if (version != WIRE_VERSION)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Unsupported version of the binary temporal value: %d",
+        version)));
+  int16 duration = (int16) pq_getmsgbyte(buf);
+  ensure_valid_duration(duration);
+  if (pq_getmsgbyte(buf) != wire_type_code(valuetypid))
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("The binary temporal value has a different base type")));
+  uint8 flags = (uint8) pq_getmsgbyte(buf);
+  bool linear = (flags & WIRE_FLAG_LINEAR) != 0;
+  bool hasz = (flags & WIRE_FLAG_Z) != 0;
+  int32 srid = 0;
+  if (tgeo_base_type(valuetypid))
+    srid = (int32) pq_getmsgint(buf, 4);
+  /* Every instant takes at least the 8 bytes of its timestamp */
+  int minsize = sizeof(int64);
+
+  Temporal *result;
+  if (duration == INSTANT)
+  {
+    TInstant **instants = tinstantarr_wire_read(buf, 1, valuetypid, srid,
+      hasz);
+    result = (Temporal *) instants[0];
+    pfree(instants);
+  }
+  else if (duration == INSTANTSET)
+  {
+    int count = wire_getmsgcount(buf, minsize);
+    TInstant **instants = tinstantarr_wire_read(buf, count, valuetypid,
+      srid, hasz);
+    result = (Temporal *) tinstantset_make_free(instants, count);
+  }
+  else if (duration == SEQUENCE)
+  {
+    int count = wire_getmsgcount(buf, minsize);
+    bool lower_inc = pq_getmsgbyte(buf) != 0;
+    bool upper_inc = pq_getmsgbyte(buf) != 0;
+    TInstant **instants = tinstantarr_wire_read(buf, count, valuetypid,
+      srid, hasz);
+    result = (Temporal *) tsequence_make_free(instants, count, lower_inc,
+      upper_inc, linear, NORMALIZE);
+  }
+  else /* duration == SEQUENCESET */
+  {
+    /* Every sequence takes at least its count, its bounds, and one instant */
+    int count = wire_getmsgcount(buf, 6 + minsize);
+    int *counts = palloc(sizeof(int) * count);
+    bool *lower_inc = palloc(sizeof(bool) * count);
+    bool *upper_inc = palloc(sizeof(bool) * count);
+    int totalcount = 0;
+    for (int i = 0; i < count; i++)
+    {
+      counts[i] = wire_getmsgcount(buf, minsize);
+      lower_inc[i] = pq_getmsgbyte(buf) != 0;
+      upper_inc[i] = pq_getmsgbyte(buf) != 0;
+      totalcount += counts[i];
+      if (totalcount > (buf->len - buf->cursor) / minsize)
+        ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+          errmsg("Invalid number of elements in the binary temporal value")));
+    }
+    TInstant **instants = tinstantarr_wire_read(buf, totalcount, valuetypid,
+      srid, hasz);
+    TSequence **sequences = palloc(sizeof(TSequence *) * count);
+    int k = 0;
+    for (int i = 0; i < count; i++)
+    {
+      sequences[i] = tsequence_make(&instants[k], counts[i], lower_inc[i],
+        upper_inc[i], linear, NORMALIZE);
+      k += counts[i];
+    }
+    for (int i = 0; i < totalcount; i++)
+      pfree(instants[i]);
+    pfree(instants); pfree(counts); pfree(lower_inc); pfree(upper_inc);
+    result = (Temporal *) tsequenceset_make_free(sequences, count,
+      NORMALIZE_NO);
+  }
+  return result;
+}
+
+/*****************************************************************************/
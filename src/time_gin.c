@@ -0,0 +1,279 @@
+/*****************************************************************************
+ *
+ * time_gin.c
+ *    Inverted GIN index for period sets.
+ *
+ * The GiST and SP-GiST indexes reduce a period set to its bounding period,
+ * so that a period set with two short periods at the start and at the end
+ * of a year is a candidate for any query in the year. The GIN index
+ * instead stores each period of a period set as a separate key. When a
+ * period set has more than GIN_PERIODSET_MAX_KEYS periods, the periods
+ * separated by the smallest gaps are merged so that the size of the index
+ * remains bounded. The keys are ordered by period_cmp, that is, by their
+ * lower bound, and a query period is looked up with a partial match that
+ * scans the keys from the beginning of the index until their lower bound
+ * is after the query. GIN merges the item pointers found for the
+ * periods of the query so that each row is returned once.
+ *
+ * Since the keys may be merged periods, the results are always rechecked.
+ * The overlaps and contains operators of temporal types are defined on the
+ * bounding period of the values. A temporal value is indexed on its
+ * periods with an index on the expression getTime(temp), which is used by
+ * the queries on getTime(temp).
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "time_gin.h"
+
+#include <assert.h>
+#include <access/gin.h>
+#include <utils/timestamp.h>
+
+#include "timetypes.h"
+#include "timestampset.h"
+#include "period.h"
+#include "periodset.h"
+#include "timeops.h"
+
+/*****************************************************************************
+ * Keys of a period set
+ *****************************************************************************/
+
+/**
+ * Structure to represent the gap between two consecutive periods of a
+ * period set
+ */
+typedef struct
+{
+  int n;              /**< number of the period before the gap */
+  TimestampTz size;   /**< size of the gap */
+} PeriodGap;
+
+/**
+ * Comparator function for gaps
+ */
+static int
+period_gap_cmp(const void *a, const void *b)
+{
+  const PeriodGap *g1 = (const PeriodGap *) a;
+  const PeriodGap *g2 = (const PeriodGap *) b;
+  if (g1->size != g2->size)
+    return (g1->size < g2->size) ? -1 : 1;
+  return g1->n - g2->n;
+}
+
+/**
+ * Returns the keys of the period set in a GIN index, which are its periods
+ * where the periods separated by the smallest gaps are merged when there
+ * are more than GIN_PERIODSET_MAX_KEYS of them
+ */
+Datum *
+periodset_gin_keys(const PeriodSet *ps, int32 *nkeys)
+{
+  int count = ps->count;
+  /* merge[i] is true when the i-th and (i+1)-th periods are merged */
+  bool *merge = palloc0(sizeof(bool) * count);
+  if (count > GIN_PERIODSET_MAX_KEYS)
+  {
+    PeriodGap *gaps = palloc(sizeof(PeriodGap) * (count - 1));
+    for (int i = 0; i < count - 1; i++)
+    {
+      gaps[i].n = i;
+      gaps[i].size = periodset_per_n(ps, i + 1)->lower -
+        periodset_per_n(ps, i)->upper;
+    }
+    qsort(gaps, count - 1, sizeof(PeriodGap), &period_gap_cmp);
+    for (int i = 0; i < count - GIN_PERIODSET_MAX_KEYS; i++)
+      merge[gaps[i].n] = true;
+    pfree(gaps);
+  }
+
+  Datum *keys = palloc(sizeof(Datum) * Min(count, GIN_PERIODSET_MAX_KEYS));
+  int k = 0, i = 0;
+  while (i < count)
+  {
+    const Period *p1 = periodset_per_n(ps, i);
+    while (merge[i])
+      i++;
+    const Period *p2 = periodset_per_n(ps, i++);
+    keys[k++] = PointerGetDatum(period_make(p1->lower, p2->upper,
+      p1->lower_inc, p2->upper_inc));
+  }
+  pfree(merge);
+  *nkeys = k;
+  return keys;
+}
+
+/**
+ * Returns the periods of the query, where a timestamp is represented by an
+ * instantaneous period
+ */
+static Period **
+time_gin_query_periods(Datum query, StrategyNumber strategy, int32 *count)
+{
+  Period **result;
+  if (strategy == GinContainsTimestampStrategy)
+  {
+    TimestampTz t = DatumGetTimestampTz(query);
+    result = palloc(sizeof(Period *));
+    result[0] = period_make(t, t, true, true);
+    *count = 1;
+  }
+  else if (strategy == GinOverlapsTimestampSetStrategy ||
+    strategy == GinContainsTimestampSetStrategy)
+  {
+    TimestampSet *ts = DatumGetTimestampSet(query);
+    result = palloc(sizeof(Period *) * ts->count);
+    for (int i = 0; i < ts->count; i++)
+    {
+      TimestampTz t = timestampset_time_n(ts, i);
+      result[i] = period_make(t, t, true, true);
+    }
+    *count = ts->count;
+  }
+  else if (strategy == GinOverlapsPeriodStrategy ||
+    strategy == GinContainsPeriodStrategy)
+  {
+    result = palloc(sizeof(Period *));
+    result[0] = period_copy(DatumGetPeriod(query));
+    *count = 1;
+  }
+  else if (strategy == GinOverlapsPeriodSetStrategy ||
+    strategy == GinContainsPeriodSetStrategy)
+  {
+    PeriodSet *ps = DatumGetPeriodSet(query);
+    result = periodset_periods_internal(ps);
+    *count = ps->count;
+  }
+  else
+  {
+    elog(ERROR, "unrecognized strategy number: %d", strategy);
+    result = NULL;  /* keep compiler quiet */
+  }
+  return result;
+}
+
+/**
+ * Returns true if the strategy is one of the overlaps operator
+ */
+static bool
+time_gin_overlaps_strategy(StrategyNumber strategy)
+{
+  return strategy == GinOverlapsTimestampSetStrategy ||
+    strategy == GinOverlapsPeriodStrategy ||
+    strategy == GinOverlapsPeriodSetStrategy;
+}
+
+/*****************************************************************************
+ * GIN methods
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(periodset_gin_extract_value);
+/**
+ * GIN extractValue method for period sets
+ */
+PGDLLEXPORT Datum
+periodset_gin_extract_value(PG_FUNCTION_ARGS)
+{
+  PeriodSet *ps = PG_GETARG_PERIODSET(0);
+  int32 *nkeys = (int32 *) PG_GETARG_POINTER(1);
+  bool **nullFlags = (bool **) PG_GETARG_POINTER(2);
+  Datum *keys = periodset_gin_keys(ps, nkeys);
+  *nullFlags = NULL;
+  PG_RETURN_POINTER(keys);
+}
+
+PG_FUNCTION_INFO_V1(periodset_gin_extract_query);
+/**
+ * GIN extractQuery method for period sets
+ *
+ * Each period of the query is looked up with a partial match starting at
+ * the first key of the index, the period itself is passed to the
+ * comparePartial method as extra data of the entry.
+ */
+PGDLLEXPORT Datum
+periodset_gin_extract_query(PG_FUNCTION_ARGS)
+{
+  Datum query = PG_GETARG_DATUM(0);
+  int32 *nentries = (int32 *) PG_GETARG_POINTER(1);
+  StrategyNumber strategy = PG_GETARG_UINT16(2);
+  bool **pmatch = (bool **) PG_GETARG_POINTER(3);
+  Pointer **extra_data = (Pointer **) PG_GETARG_POINTER(4);
+  bool **nullFlags = (bool **) PG_GETARG_POINTER(5);
+
+  int32 count;
+  Period **periods = time_gin_query_periods(query, strategy, &count);
+  Datum *entries = palloc(sizeof(Datum) * count);
+  *pmatch = palloc(sizeof(bool) * count);
+  *extra_data = palloc(sizeof(Pointer) * count);
+  for (int i = 0; i < count; i++)
+  {
+    entries[i] = PointerGetDatum(period_make(DT_NOBEGIN, DT_NOBEGIN,
+      true, true));
+    (*pmatch)[i] = true;
+    (*extra_data)[i] = (Pointer) periods[i];
+  }
+  pfree(periods);
+  *nullFlags = NULL;
+  *nentries = count;
+  PG_RETURN_POINTER(entries);
+}
+
+PG_FUNCTION_INFO_V1(periodset_gin_compare_partial);
+/**
+ * GIN comparePartial method for period sets
+ *
+ * Returns 0 if the key matches the query period, a negative value if it
+ * does not match, and a positive value to stop the scan when the key, and
+ * thus all the following keys, is after the query period.
+ */
+PGDLLEXPORT Datum
+periodset_gin_compare_partial(PG_FUNCTION_ARGS)
+{
+  Period *key = PG_GETARG_PERIOD(1);
+  StrategyNumber strategy = PG_GETARG_UINT16(2);
+  Period *query = (Period *) PG_GETARG_POINTER(3);
+  int32 result;
+  if (after_period_period_internal(key, query))
+    result = 1;
+  else if (time_gin_overlaps_strategy(strategy))
+    result = overlaps_period_period_internal(key, query) ? 0 : -1;
+  else
+    result = contains_period_period_internal(key, query) ? 0 : -1;
+  PG_RETURN_INT32(result);
+}
+
+PG_FUNCTION_INFO_V1(periodset_gin_consistent);
+/**
+ * GIN consistent method for period sets
+ *
+ * A period set overlaps the query if one of the periods of the query
+ * matches a key, and contains the query if all of them match a key.
+ */
+PGDLLEXPORT Datum
+periodset_gin_consistent(PG_FUNCTION_ARGS)
+{
+  bool *check = (bool *) PG_GETARG_POINTER(0);
+  StrategyNumber strategy = PG_GETARG_UINT16(1);
+  int32 nkeys = PG_GETARG_INT32(3);
+  bool *recheck = (bool *) PG_GETARG_POINTER(5);
+
+  /* The keys may be merged periods */
+  *recheck = true;
+  bool overlaps = time_gin_overlaps_strategy(strategy);
+  for (int i = 0; i < nkeys; i++)
+  {
+    if (overlaps && check[i])
+      PG_RETURN_BOOL(true);
+    if (! overlaps && ! check[i])
+      PG_RETURN_BOOL(false);
+  }
+  PG_RETURN_BOOL(! overlaps);
+}
+
+/*****************************************************************************/
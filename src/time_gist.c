@@ -873,6 +873,42 @@ period_gist_same(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * GiST distance method
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(period_gist_distance);
+/**
+ * GiST distance method for time types
+ *
+ * The query is a timestamp or a period. The distance is computed with the
+ * bounding period of the key, it is exact for periods and a lower bound for
+ * timestamp sets and period sets, which are thus rechecked at the leaves.
+ */
+PGDLLEXPORT Datum
+period_gist_distance(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  Oid subtype = PG_GETARG_OID(3);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4);
+  Period *key = DatumGetPeriod(entry->key);
+  double distance;
+
+  /* The index is lossy for leaf levels */
+  if (GIST_LEAF(entry))
+    *recheck = true;
+
+  if (subtype == TIMESTAMPTZOID)
+    distance = distance_period_timestamp_internal(key,
+      PG_GETARG_TIMESTAMPTZ(1));
+  else if (subtype == type_oid(T_PERIOD))
+    distance = distance_period_period_internal(key, PG_GETARG_PERIOD(1));
+  else
+    elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
+
+  PG_RETURN_FLOAT8(distance);
+}
+
 /*****************************************************************************
  * GiST fetch method
  *****************************************************************************/
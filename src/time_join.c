@@ -0,0 +1,170 @@
+/*****************************************************************************
+ *
+ * time_join.c
+ *    Sort-based join of periods on their overlap
+ *
+ * PostgreSQL cannot use a merge join for a join condition such as
+ * period(a.temp) && period(b.temp) since the overlap of periods is not an
+ * equality, so that such joins are executed as nested loops. The function
+ * periodJoin computes instead all the pairs of overlapping periods of two
+ * arrays by sorting both arrays on the lower bound of the periods and
+ * sweeping them: each period is compared with the periods of the other
+ * array starting at the same or a later time until the first one that
+ * starts after it, which all overlap the period. The cost is that of the
+ * sort plus the number of pairs of the result.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "time_join.h"
+
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/array.h>
+
+#include "period.h"
+#include "timeops.h"
+#include "temporal_util.h"
+
+/*****************************************************************************/
+
+/**
+ * Comparator of the positions of periods on the order of the periods
+ */
+static int
+period_pos_cmp(const void *a, const void *b, void *arg)
+{
+  Period **periods = (Period **) arg;
+  return period_cmp_internal(periods[*(const int *) a],
+    periods[*(const int *) b]);
+}
+
+/**
+ * Returns the positions of the periods of the array sorted on the order
+ * of the periods
+ */
+static int *
+period_pos_sort(Period **periods, int count)
+{
+  int *result = palloc(sizeof(int) * count);
+  for (int i = 0; i < count; i++)
+    result[i] = i;
+  qsort_arg(result, count, sizeof(int), &period_pos_cmp, (void *) periods);
+  return result;
+}
+
+/**
+ * Add the pair of periods to the result
+ */
+static void
+period_join_add(PeriodJoinState *state, int pos1, int pos2)
+{
+  if (state->count == state->maxcount)
+  {
+    state->maxcount *= 2;
+    state->pos1 = repalloc(state->pos1, sizeof(int) * state->maxcount);
+    state->pos2 = repalloc(state->pos2, sizeof(int) * state->maxcount);
+  }
+  state->pos1[state->count] = pos1;
+  state->pos2[state->count++] = pos2;
+  return;
+}
+
+/**
+ * Returns the pairs of overlapping periods of the two arrays (internal
+ * function)
+ */
+PeriodJoinState *
+period_join_internal(Period **periods1, int count1, Period **periods2,
+  int count2)
+{
+  PeriodJoinState *result = palloc0(sizeof(PeriodJoinState));
+  result->maxcount = 64;
+  result->pos1 = palloc(sizeof(int) * result->maxcount);
+  result->pos2 = palloc(sizeof(int) * result->maxcount);
+  if (count1 == 0 || count2 == 0)
+    return result;
+
+  int *sorted1 = period_pos_sort(periods1, count1);
+  int *sorted2 = period_pos_sort(periods2, count2);
+  int i = 0, j = 0;
+  while (i < count1 && j < count2)
+  {
+    const Period *p1 = periods1[sorted1[i]];
+    const Period *p2 = periods2[sorted2[j]];
+    if (period_cmp_internal(p1, p2) <= 0)
+    {
+      /* The following periods of the second array do not start before p1 */
+      for (int k = j; k < count2 &&
+          ! after_period_period_internal(periods2[sorted2[k]], p1); k++)
+        period_join_add(result, sorted1[i], sorted2[k]);
+      i++;
+    }
+    else
+    {
+      for (int k = i; k < count1 &&
+          ! after_period_period_internal(periods1[sorted1[k]], p2); k++)
+        period_join_add(result, sorted1[k], sorted2[j]);
+      j++;
+    }
+  }
+  pfree(sorted1); pfree(sorted2);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(period_join);
+/**
+ * Returns the positions of the pairs of overlapping periods of the two
+ * arrays
+ */
+PGDLLEXPORT Datum
+period_join(PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  PeriodJoinState *state;
+
+  if (SRF_IS_FIRSTCALL())
+  {
+    MemoryContext oldcontext;
+    TupleDesc tupdesc;
+
+    funcctx = SRF_FIRSTCALL_INIT();
+    oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+        errmsg("function returning record called in context "
+          "that cannot accept type record")));
+    funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+    ArrayType *array1 = PG_GETARG_ARRAYTYPE_P(0);
+    ArrayType *array2 = PG_GETARG_ARRAYTYPE_P(1);
+    int count1, count2;
+    Period **periods1 = (Period **) datumarr_extract(array1, &count1);
+    Period **periods2 = (Period **) datumarr_extract(array2, &count2);
+    funcctx->user_fctx = period_join_internal(periods1, count1, periods2,
+      count2);
+    pfree(periods1); pfree(periods2);
+    MemoryContextSwitchTo(oldcontext);
+  }
+
+  funcctx = SRF_PERCALL_SETUP();
+  state = (PeriodJoinState *) funcctx->user_fctx;
+  if (state->i == state->count)
+    SRF_RETURN_DONE(funcctx);
+
+  /* The positions in the arrays start at 1 */
+  Datum values[2];
+  bool isnull[2] = {false, false};
+  values[0] = Int32GetDatum(state->pos1[state->i] + 1);
+  values[1] = Int32GetDatum(state->pos2[state->i] + 1);
+  state->i++;
+  HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, isnull);
+  SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
@@ -30,6 +30,7 @@
 #include "timeops.h"
 #include "time_analyze.h"
 #include "oidcache.h"
+#include "temporal_statscache.h"
 
 /*****************************************************************************/
 
@@ -130,6 +131,41 @@ calc_periodsel(VariableStatData *vardata, Period *constval, Oid operator)
   return selec;
 }
 
+/*
+ * Get the histograms of the lower and upper bounds of the periods of a
+ * column. The bounds are decoded once and kept in the statistics cache,
+ * so they must not be freed. Returns the number of bounds, or -1 if the
+ * histogram is not available.
+ */
+static int
+period_hist_bounds(VariableStatData *vardata, PeriodBound **hist_lower,
+  PeriodBound **hist_upper)
+{
+  CachedStatsSlot *hslot = statscache_slot(vardata,
+    STATISTIC_KIND_PERIOD_BOUNDS_HISTOGRAM, ATTSTATSSLOT_VALUES);
+  if (hslot == NULL)
+    return -1;
+  if (hslot->hist_lower == NULL)
+  {
+    /*
+     * Convert histogram of periods into histograms of its lower and upper
+     * bounds.
+     */
+    PeriodBound *lower = MemoryContextAlloc(hslot->mcxt,
+      sizeof(PeriodBound) * Max(hslot->nvalues, 1));
+    PeriodBound *upper = MemoryContextAlloc(hslot->mcxt,
+      sizeof(PeriodBound) * Max(hslot->nvalues, 1));
+    for (int i = 0; i < hslot->nvalues; i++)
+      period_deserialize(DatumGetPeriod(hslot->values[i]),
+                 &lower[i], &upper[i]);
+    hslot->hist_lower = lower;
+    hslot->hist_upper = upper;
+  }
+  *hist_lower = (PeriodBound *) hslot->hist_lower;
+  *hist_upper = (PeriodBound *) hslot->hist_upper;
+  return hslot->nvalues;
+}
+
 /*
  * Calculate period operator selectivity using histograms of period bounds.
  *
@@ -139,50 +175,29 @@ double
 calc_period_hist_selectivity(VariableStatData *vardata, Period *constval,
   CachedOp cachedOp)
 {
-  AttStatsSlot hslot, lslot;
+  CachedStatsSlot *lslot = NULL;
   PeriodBound *hist_lower, *hist_upper;
   PeriodBound  const_lower, const_upper;
+  Datum     *length_hist_values = NULL;
+  int      length_hist_nvalues = 0;
   double    hist_selec;
-  int      nhist, i;
+  int      nhist;
 
-  if (!(HeapTupleIsValid(vardata->statsTuple) &&
-      get_attstatsslot(&hslot, vardata->statsTuple,
-               STATISTIC_KIND_PERIOD_BOUNDS_HISTOGRAM, 
-               InvalidOid, ATTSTATSSLOT_VALUES)))
+  nhist = period_hist_bounds(vardata, &hist_lower, &hist_upper);
+  if (nhist < 0)
     return -1.0;
-  /*
-   * Convert histogram of periods into histograms of its lower and upper
-   * bounds.
-   */
-  nhist = hslot.nvalues;
-  hist_lower = (PeriodBound *) palloc(sizeof(PeriodBound) * nhist);
-  hist_upper = (PeriodBound *) palloc(sizeof(PeriodBound) * nhist);
-  for (i = 0; i < nhist; i++)
-    period_deserialize(DatumGetPeriod(hslot.values[i]),
-               &hist_lower[i], &hist_upper[i]);
 
   /* @> and @< also need a histogram of period lengths */
   if (cachedOp == CONTAINS_OP || cachedOp == CONTAINED_OP)
   {
-    if (!(HeapTupleIsValid(vardata->statsTuple) &&
-        get_attstatsslot(&lslot, vardata->statsTuple,
-                 STATISTIC_KIND_PERIOD_LENGTH_HISTOGRAM, 
-                 InvalidOid, ATTSTATSSLOT_VALUES)))
-    {
-      free_attstatsslot(&hslot);
-      return -1.0;
-    }
-
+    lslot = statscache_slot(vardata, STATISTIC_KIND_PERIOD_LENGTH_HISTOGRAM,
+      ATTSTATSSLOT_VALUES);
     /* check that it's a histogram, not just a dummy entry */
-    if (lslot.nvalues < 2)
-    {
-      free_attstatsslot(&lslot);
-      free_attstatsslot(&hslot);
+    if (lslot == NULL || lslot->nvalues < 2)
       return -1.0;
-    }
+    length_hist_values = lslot->values;
+    length_hist_nvalues = lslot->nvalues;
   }
-  else
-    memset(&lslot, 0, sizeof(lslot));
 
   /* Extract the bounds of the constant value. */
   period_deserialize(constval, &const_lower, &const_upper);
@@ -251,10 +266,12 @@ calc_period_hist_selectivity(VariableStatData *vardata, Period *constval,
   }
   else if (cachedOp == CONTAINS_OP)
     hist_selec = calc_period_hist_selectivity_contains(&const_lower,
-      &const_upper, hist_lower, nhist, lslot.values, lslot.nvalues);
+      &const_upper, hist_lower, nhist, length_hist_values,
+      length_hist_nvalues);
   else if (cachedOp == CONTAINED_OP)
     hist_selec = calc_period_hist_selectivity_contained(&const_lower,
-      &const_upper, hist_lower, nhist, lslot.values, lslot.nvalues);
+      &const_upper, hist_lower, nhist, length_hist_values,
+      length_hist_nvalues);
   else if (cachedOp == ADJACENT_OP)
     hist_selec = calc_period_hist_selectivity_adjacent(&const_lower,
       &const_upper, hist_lower, hist_upper,nhist);
@@ -264,9 +281,6 @@ calc_period_hist_selectivity(VariableStatData *vardata, Period *constval,
     hist_selec = -1.0;  /* keep compiler quiet */
   }
 
-  free_attstatsslot(&lslot);
-  free_attstatsslot(&hslot);
-
   return hist_selec;
 }
 
@@ -817,6 +831,65 @@ double calc_period_hist_selectivity_adjacent(PeriodBound *lower, PeriodBound *up
   return selec1 + selec2;
 }
 
+/*****************************************************************************
+ * Join selectivity
+ *****************************************************************************/
+
+/*
+ * Estimate the fraction of pairs of values of two columns such that the upper
+ * bound of the first one is less than the lower bound of the second one,
+ * given the histogram of upper bounds of the first column and the histogram
+ * of lower bounds of the second column. The fraction of upper bounds that are
+ * less than a lower bound is averaged over the bins of the equi-depth
+ * histogram of lower bounds.
+ */
+static double
+period_joinsel_before(PeriodBound *hist_upper1, int nhist1,
+  PeriodBound *hist_lower2, int nhist2)
+{
+  double sum_frac = 0.0, prev_frac, frac;
+  int i;
+
+  prev_frac = calc_period_hist_selectivity_scalar(&hist_lower2[0],
+    hist_upper1, nhist1, false);
+  for (i = 1; i < nhist2; i++)
+  {
+    frac = calc_period_hist_selectivity_scalar(&hist_lower2[i],
+      hist_upper1, nhist1, false);
+    sum_frac += (prev_frac + frac) / 2.0;
+    prev_frac = frac;
+  }
+  return sum_frac / (double) (nhist2 - 1);
+}
+
+/*
+ * Estimate the join selectivity of the overlaps operator between two columns
+ * using their histograms of period bounds. Returns -1 if the histograms are
+ * not available.
+ */
+double
+period_joinsel_overlaps(VariableStatData *vardata1, VariableStatData *vardata2)
+{
+  PeriodBound *hist_lower1, *hist_upper1, *hist_lower2, *hist_upper2;
+  double selec;
+  int nhist1, nhist2;
+
+  nhist1 = period_hist_bounds(vardata1, &hist_lower1, &hist_upper1);
+  nhist2 = period_hist_bounds(vardata2, &hist_lower2, &hist_upper2);
+  if (nhist1 < 2 || nhist2 < 2)
+    return -1.0;
+
+  /*
+   * A && B <=> NOT (A <<# B OR A #>> B), where the two events are mutually
+   * exclusive, as for the restriction selectivity.
+   */
+  selec = 1.0 - period_joinsel_before(hist_upper1, nhist1, hist_lower2, nhist2)
+    - period_joinsel_before(hist_upper2, nhist2, hist_lower1, nhist1);
+
+  CLAMP_PROBABILITY(selec);
+  return selec;
+}
+
 /*
  * periodsel -- restriction selectivity for period operators
  */
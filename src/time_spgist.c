@@ -27,6 +27,21 @@
 #include "time_gist.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
+#include "timeops.h"
+
+/*****************************************************************************/
+
+/**
+ * Structure to represent the traversal value of a node of the quad tree.
+ * It keeps the centroid of the parent node, which is needed for the adjacent
+ * strategy, and a period that contains all the periods of the node, which is
+ * needed for ordering.
+ */
+typedef struct
+{
+  Period centroid;  /**< centroid of the parent node */
+  Period bounds;    /**< period containing the periods of the node */
+} PeriodNode;
 
 /*****************************************************************************
  * SP-GiST config function
@@ -345,6 +360,69 @@ adjacent_inner_consistent(PeriodBound *arg, PeriodBound *centroid,
   return adjacent_cmp_bounds(arg, centroid);
 }
 
+/**
+ * Returns the traversal value of the node in the quadrant of the centroid.
+ * The lower bounds of the periods in quadrants 1 and 2 are greater than or
+ * equal to the lower bound of the centroid, the upper bounds of the periods
+ * in quadrants 2 and 3 are less than the upper bound of the centroid.
+ */
+static PeriodNode *
+periodnode_quadrant(const PeriodNode *node, const Period *centroid,
+  int16 quadrant)
+{
+  PeriodNode *result = palloc(sizeof(PeriodNode));
+  memcpy(&result->centroid, centroid, sizeof(Period));
+  if (node)
+    memcpy(&result->bounds, &node->bounds, sizeof(Period));
+  else
+    period_set(&result->bounds, DT_NOBEGIN, DT_NOEND, true, true);
+  if ((quadrant == 1 || quadrant == 2) &&
+      centroid->lower > result->bounds.lower)
+    result->bounds.lower = centroid->lower;
+  if ((quadrant == 2 || quadrant == 3) &&
+      centroid->upper < result->bounds.upper)
+    result->bounds.upper = centroid->upper;
+  return result;
+}
+
+#if MOBDB_PGSQL_VERSION >= 120000
+/**
+ * Transform the ordering key into a period
+ */
+static void
+period_spgist_orderby(const ScanKey orderby, Period *result)
+{
+  if (orderby->sk_subtype == TIMESTAMPTZOID)
+  {
+    TimestampTz t = DatumGetTimestampTz(orderby->sk_argument);
+    period_set(result, t, t, true, true);
+  }
+  else if (orderby->sk_subtype == type_oid(T_PERIOD))
+    memcpy(result, DatumGetPeriod(orderby->sk_argument), sizeof(Period));
+  else
+    elog(ERROR, "Unrecognized subtype: %d", orderby->sk_subtype);
+}
+
+/**
+ * Returns the distances between the ordering keys and the periods of a node,
+ * which are not bounded for the root node
+ */
+static double *
+periodnode_distances(const PeriodNode *node, const ScanKey orderbys,
+  int norderbys)
+{
+  double *result = palloc(sizeof(double) * norderbys);
+  for (int i = 0; i < norderbys; i++)
+  {
+    Period query;
+    period_spgist_orderby(&orderbys[i], &query);
+    result[i] = node ?
+      distance_period_period_internal(&node->bounds, &query) : 0.0;
+  }
+  return result;
+}
+#endif
+
 PG_FUNCTION_INFO_V1(spperiod_gist_inner_consistent);
 /**
  * SP-GiST inner consistent function function for time types
@@ -365,6 +443,7 @@ spperiod_gist_inner_consistent(PG_FUNCTION_ARGS)
    * is set and centroid is passed into traversalValue.
    */
   bool needPrevious = false;
+  PeriodNode *node = (PeriodNode *) in->traversalValue;
 
   if (in->allTheSame)
   {
@@ -373,6 +452,28 @@ spperiod_gist_inner_consistent(PG_FUNCTION_ARGS)
     out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
     for (i = 0; i < in->nNodes; i++)
       out->nodeNumbers[i] = i;
+#if MOBDB_PGSQL_VERSION >= 120000
+    if (in->norderbys > 0 && in->nNodes > 0)
+    {
+      /* All the nodes cover the periods of the current one */
+      out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+      out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
+      oldCtx = MemoryContextSwitchTo(in->traversalMemoryContext);
+      for (i = 0; i < in->nNodes; i++)
+      {
+        out->distances[i] = periodnode_distances(node, in->orderbys,
+          in->norderbys);
+        if (node)
+        {
+          out->traversalValues[i] = palloc(sizeof(PeriodNode));
+          memcpy(out->traversalValues[i], node, sizeof(PeriodNode));
+        }
+        else
+          out->traversalValues[i] = NULL;
+      }
+      MemoryContextSwitchTo(oldCtx);
+    }
+#endif
     PG_RETURN_VOID();
   }
 
@@ -476,9 +577,9 @@ spperiod_gist_inner_consistent(PG_FUNCTION_ARGS)
          * for lower or upper bounds to be adjacent. Deserialize
          * previous centroid range if present for checking this.
          */
-        if (in->traversalValue)
+        if (node)
         {
-          prevCentroid = DatumGetPeriod(in->traversalValue);
+          prevCentroid = &node->centroid;
           period_deserialize(prevCentroid, &prevLower,
             &prevUpper);
         }
@@ -636,6 +737,14 @@ spperiod_gist_inner_consistent(PG_FUNCTION_ARGS)
 
   /* We must descend into the quadrant(s) identified by 'which' */
   out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
+#if MOBDB_PGSQL_VERSION >= 120000
+  /* Ordering needs the periods covered by the nodes */
+  if (in->norderbys > 0)
+  {
+    needPrevious = true;
+    out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+  }
+#endif
   if (needPrevious)
     out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
   out->nNodes = 0;
@@ -650,13 +759,16 @@ spperiod_gist_inner_consistent(PG_FUNCTION_ARGS)
   {
     if (which & (1 << i))
     {
-      /* Save previous prefix if needed */
+      /* Save previous prefix and the periods of the node if needed */
       if (needPrevious)
       {
-        /* We know that in->prefixDatum in this place is a period */
-        Datum previousCentroid = PointerGetDatum(period_copy(
-          (Period *) DatumGetPointer(in->prefixDatum)));
-        out->traversalValues[out->nNodes] = (void *) previousCentroid;
+        PeriodNode *next = periodnode_quadrant(node, centroid, (int16) i);
+        out->traversalValues[out->nNodes] = (void *) next;
+#if MOBDB_PGSQL_VERSION >= 120000
+        if (in->norderbys > 0)
+          out->distances[out->nNodes] = periodnode_distances(next,
+            in->orderbys, in->norderbys);
+#endif
       }
       out->nodeNumbers[out->nNodes] = i - 1;
       out->nNodes++;
@@ -734,6 +846,21 @@ spperiod_gist_leaf_consistent(PG_FUNCTION_ARGS)
       break;
   }
 
+#if MOBDB_PGSQL_VERSION >= 120000
+  if (res && in->norderbys > 0)
+  {
+    /* The distances are exact for periods and a lower bound for the sets */
+    out->distances = palloc(sizeof(double) * in->norderbys);
+    for (i = 0; i < in->norderbys; i++)
+    {
+      Period query;
+      period_spgist_orderby(&in->orderbys[i], &query);
+      out->distances[i] = distance_period_period_internal(key, &query);
+    }
+    out->recheckDistances = true;
+  }
+#endif
+
   PG_RETURN_BOOL(res);
 }
 
@@ -13,6 +13,7 @@
 #include "timeops.h"
 
 #include <assert.h>
+#include <float.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
@@ -42,10 +43,147 @@ ensure_time_type_oid(Oid timetypid)
     elog(ERROR, "unknown time type: %d", timetypid);
 }
 
+/*****************************************************************************
+ * Galloping search
+ * When one of the time values has many more elements than the other, the
+ * operations iterate over the elements of the smaller value and search the
+ * position of each one in the larger value, instead of merging them in
+ * lockstep. The search doubles its step from the position of the previous
+ * element until it overshoots and then performs a binary search, so that its
+ * cost is logarithmic in the number of elements skipped.
+ *****************************************************************************/
+
+/**
+ * Returns true if the number of elements of one value is at least
+ * GALLOP_MIN_RATIO times the one of the other value
+ */
+static bool
+gallop_skewed(int count1, int count2)
+{
+  return (int64) count1 >= (int64) GALLOP_MIN_RATIO * count2 ||
+    (int64) count2 >= (int64) GALLOP_MIN_RATIO * count1;
+}
+
+/**
+ * Returns the position of the first timestamp of the set, starting at the
+ * position from, that is greater than or equal to the timestamp, or the
+ * number of timestamps of the set if there is none
+ */
+static int
+timestampset_gallop(const TimestampSet *ts, int from, TimestampTz t)
+{
+  if (from >= ts->count || timestampset_time_n(ts, from) >= t)
+    return from;
+  /* The timestamp at lo is smaller than t */
+  int lo = from, hi = from + 1, step = 1;
+  while (hi < ts->count && timestampset_time_n(ts, hi) < t)
+  {
+    lo = hi;
+    step *= 2;
+    hi = (ts->count - lo > step) ? lo + step : ts->count;
+  }
+  /* The timestamp at hi is greater than or equal to t or hi is the count */
+  while (hi - lo > 1)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (timestampset_time_n(ts, mid) < t)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return hi;
+}
+
+/**
+ * Returns the position of the first period of the period set, starting at
+ * the position from, whose upper bound is greater than or equal to the
+ * timestamp, or the number of periods of the set if there is none. All the
+ * periods before this position are before the timestamp.
+ */
+static int
+periodset_gallop(const PeriodSet *ps, int from, TimestampTz t)
+{
+  if (from >= ps->count || periodset_per_n(ps, from)->upper >= t)
+    return from;
+  /* The upper bound of the period at lo is smaller than t */
+  int lo = from, hi = from + 1, step = 1;
+  while (hi < ps->count && periodset_per_n(ps, hi)->upper < t)
+  {
+    lo = hi;
+    step *= 2;
+    hi = (ps->count - lo > step) ? lo + step : ps->count;
+  }
+  /* The upper bound at hi is greater than or equal to t or hi is the count */
+  while (hi - lo > 1)
+  {
+    int mid = lo + (hi - lo) / 2;
+    if (periodset_per_n(ps, mid)->upper < t)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return hi;
+}
+
 /*****************************************************************************
  * Generic operations
  *****************************************************************************/
 
+/**
+ * Returns the intersection or the difference of the two time values using
+ * a galloping search in the larger one
+ */
+static TimestampSet *
+setop_timestampset_timestampset_gallop(const TimestampSet *ts1,
+  const TimestampSet *ts2, SetOper setop)
+{
+  assert(setop == INTER || setop == MINUS);
+  int count = (setop == INTER) ? Min(ts1->count, ts2->count) : ts1->count;
+  TimestampTz *times = palloc(sizeof(TimestampTz) * count);
+  int k = 0;
+  if (ts1->count <= ts2->count)
+  {
+    /* Search each timestamp of the first set in the second one */
+    int j = 0;
+    for (int i = 0; i < ts1->count; i++)
+    {
+      TimestampTz t = timestampset_time_n(ts1, i);
+      j = timestampset_gallop(ts2, j, t);
+      bool found = (j < ts2->count && timestampset_time_n(ts2, j) == t);
+      if (found == (setop == INTER))
+        times[k++] = t;
+    }
+  }
+  else
+  {
+    /* Search each timestamp of the second set in the first one */
+    int i = 0;
+    for (int j = 0; j < ts2->count && i < ts1->count; j++)
+    {
+      TimestampTz t = timestampset_time_n(ts2, j);
+      int pos = timestampset_gallop(ts1, i, t);
+      if (setop == MINUS)
+      {
+        while (i < pos)
+          times[k++] = timestampset_time_n(ts1, i++);
+      }
+      i = pos;
+      if (i < ts1->count && timestampset_time_n(ts1, i) == t)
+      {
+        if (setop == INTER)
+          times[k++] = t;
+        i++;
+      }
+    }
+    if (setop == MINUS)
+    {
+      while (i < ts1->count)
+        times[k++] = timestampset_time_n(ts1, i++);
+    }
+  }
+  return timestampset_make_free(times, k);
+}
+
 /**
  * Returns the union, intersection or difference of the two time values
  */
@@ -62,6 +200,9 @@ setop_timestampset_timestampset(const TimestampSet *ts1,
       return setop == INTER ? NULL : timestampset_copy(ts1);
   }
 
+  if (setop != UNION && gallop_skewed(ts1->count, ts2->count))
+    return setop_timestampset_timestampset_gallop(ts1, ts2, setop);
+
   int count;
   if (setop == UNION)
     count = ts1->count + ts2->count;
@@ -142,7 +283,64 @@ setop_timestampset_period(const TimestampSet *ts, const Period *p,
   return timestampset_make_free(times, k);
 }
 
-/*
+/**
+ * Returns the intersection or the difference of the two time values using
+ * a galloping search in the larger one
+ */
+static TimestampSet *
+setop_timestampset_periodset_gallop(const TimestampSet *ts,
+  const PeriodSet *ps, SetOper setop)
+{
+  TimestampTz *times = palloc(sizeof(TimestampTz) * ts->count);
+  int k = 0;
+  if (ts->count <= ps->count)
+  {
+    /* Search the period that may contain each timestamp */
+    int j = 0;
+    for (int i = 0; i < ts->count; i++)
+    {
+      TimestampTz t = timestampset_time_n(ts, i);
+      j = periodset_gallop(ps, j, t);
+      bool found = (j < ps->count &&
+        contains_period_timestamp_internal(periodset_per_n(ps, j), t));
+      if (found == (setop == INTER))
+        times[k++] = t;
+    }
+  }
+  else
+  {
+    /* Search the first timestamp of each period */
+    int i = 0;
+    for (int j = 0; j < ps->count && i < ts->count; j++)
+    {
+      Period *p = periodset_per_n(ps, j);
+      int pos = timestampset_gallop(ts, i, p->lower);
+      if (setop == MINUS)
+      {
+        while (i < pos)
+          times[k++] = timestampset_time_n(ts, i++);
+      }
+      i = pos;
+      while (i < ts->count)
+      {
+        TimestampTz t = timestampset_time_n(ts, i);
+        if (t > p->upper)
+          break;
+        if ((setop == INTER) == contains_period_timestamp_internal(p, t))
+          times[k++] = t;
+        i++;
+      }
+    }
+    if (setop == MINUS)
+    {
+      while (i < ts->count)
+        times[k++] = timestampset_time_n(ts, i++);
+    }
+  }
+  return timestampset_make_free(times, k);
+}
+
+/**
  * Returns the intersection or the difference of the two time values
  */
 TimestampSet *
@@ -156,6 +354,9 @@ setop_timestampset_periodset(const TimestampSet *ts, const PeriodSet *ps,
   if (!overlaps_period_period_internal(p1, p2))
     return (setop == INTER) ? NULL : timestampset_copy(ts);
 
+  if (gallop_skewed(ts->count, ps->count))
+    return setop_timestampset_periodset_gallop(ts, ps, setop);
+
   TimestampTz *times = palloc(sizeof(TimestampTz) * ts->count);
   TimestampTz t = timestampset_time_n(ts, 0);
   Period *p = periodset_per_n(ps, 0);
@@ -245,6 +446,19 @@ contains_timestampset_timestampset_internal(const TimestampSet *ts1, const Times
     return false;
 
   int i = 0, j = 0;
+  if (gallop_skewed(ts1->count, ts2->count))
+  {
+    /* Search each timestamp of the second set in the first one */
+    for (j = 0; j < ts2->count; j++)
+    {
+      TimestampTz t = timestampset_time_n(ts2, j);
+      i = timestampset_gallop(ts1, i, t);
+      if (i == ts1->count || timestampset_time_n(ts1, i) != t)
+        return false;
+      i++;
+    }
+    return true;
+  }
   while (j < ts2->count)
   {
     TimestampTz t1 = timestampset_time_n(ts1, i);
@@ -405,6 +619,19 @@ contains_periodset_timestampset_internal(const PeriodSet *ps, const TimestampSet
     return false;
 
   int i = 0, j = 0;
+  if (gallop_skewed(ps->count, ts->count))
+  {
+    /* Search the period that may contain each timestamp */
+    for (j = 0; j < ts->count; j++)
+    {
+      TimestampTz t = timestampset_time_n(ts, j);
+      i = periodset_gallop(ps, i, t);
+      if (i == ps->count ||
+        ! contains_period_timestamp_internal(periodset_per_n(ps, i), t))
+        return false;
+    }
+    return true;
+  }
   while (j < ts->count)
   {
     Period *p = periodset_per_n(ps, i);
@@ -506,6 +733,23 @@ contains_periodset_periodset_internal(const PeriodSet *ps1,
     return false;
 
   int i = 0, j = 0;
+  if (ps1->count > ps2->count && gallop_skewed(ps1->count, ps2->count))
+  {
+    /* Search the period that may contain each period of the second set */
+    for (j = 0; j < ps2->count; j++)
+    {
+      p2 = periodset_per_n(ps2, j);
+      i = periodset_gallop(ps1, i, p2->lower);
+      /* The period found may end at the exclusive lower bound of p2 */
+      if (i < ps1->count &&
+        before_period_period_internal(periodset_per_n(ps1, i), p2))
+        i++;
+      if (i == ps1->count ||
+        ! contains_period_period_internal(periodset_per_n(ps1, i), p2))
+        return false;
+    }
+    return true;
+  }
   while (i < ps1->count && j < ps2->count)
   {
     p1 = periodset_per_n(ps1, i);
@@ -717,6 +961,24 @@ overlaps_timestampset_timestampset_internal(const TimestampSet *ts1, const Times
   if (!overlaps_period_period_internal(p1, p2))
     return false;
 
+  if (gallop_skewed(ts1->count, ts2->count))
+  {
+    /* Search each timestamp of the smaller set in the larger one */
+    const TimestampSet *small = (ts1->count < ts2->count) ? ts1 : ts2;
+    const TimestampSet *large = (ts1->count < ts2->count) ? ts2 : ts1;
+    int pos = 0;
+    for (int i = 0; i < small->count; i++)
+    {
+      TimestampTz t = timestampset_time_n(small, i);
+      pos = timestampset_gallop(large, pos, t);
+      if (pos == large->count)
+        return false;
+      if (timestampset_time_n(large, pos) == t)
+        return true;
+    }
+    return false;
+  }
+
   int i = 0, j = 0;
   while (i < ts1->count && j < ts2->count)
   {
@@ -795,6 +1057,42 @@ overlaps_timestampset_periodset_internal(const TimestampSet *ts, const PeriodSet
     return false;
 
   int i = 0, j = 0;
+  if (gallop_skewed(ts->count, ps->count))
+  {
+    if (ts->count < ps->count)
+    {
+      /* Search the period that may contain each timestamp */
+      for (i = 0; i < ts->count; i++)
+      {
+        TimestampTz t = timestampset_time_n(ts, i);
+        j = periodset_gallop(ps, j, t);
+        if (j == ps->count)
+          return false;
+        if (contains_period_timestamp_internal(periodset_per_n(ps, j), t))
+          return true;
+      }
+    }
+    else
+    {
+      /* Search the first timestamp of each period */
+      for (j = 0; j < ps->count; j++)
+      {
+        Period *p = periodset_per_n(ps, j);
+        i = timestampset_gallop(ts, i, p->lower);
+        for (; i < ts->count; i++)
+        {
+          TimestampTz t = timestampset_time_n(ts, i);
+          if (t > p->upper)
+            break;
+          if (contains_period_timestamp_internal(p, t))
+            return true;
+        }
+        if (i == ts->count)
+          return false;
+      }
+    }
+    return false;
+  }
   while (i < ts->count && j < ps->count)
   {
     TimestampTz t = timestampset_time_n(ts, i);
@@ -947,6 +1245,31 @@ overlaps_periodset_periodset_internal(const PeriodSet *ps1,
   if (!overlaps_period_period_internal(p1, p2))
     return false;
 
+  if (gallop_skewed(ps1->count, ps2->count))
+  {
+    /* Search the periods of the larger set that may overlap each period
+     * of the smaller set */
+    const PeriodSet *small = (ps1->count < ps2->count) ? ps1 : ps2;
+    const PeriodSet *large = (ps1->count < ps2->count) ? ps2 : ps1;
+    int pos = 0;
+    for (int i = 0; i < small->count; i++)
+    {
+      Period *p = periodset_per_n(small, i);
+      pos = periodset_gallop(large, pos, p->lower);
+      for (int k = pos; k < large->count; k++)
+      {
+        Period *q = periodset_per_n(large, k);
+        if (q->lower > p->upper)
+          break;
+        if (overlaps_period_period_internal(p, q))
+          return true;
+      }
+      if (pos == large->count)
+        return false;
+    }
+    return false;
+  }
+
   int i = 0, j = 0;
   while (i < ps1->count && j < ps2->count)
   {
@@ -3567,6 +3890,42 @@ intersection_periodset_period(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/**
+ * Returns the intersection of the two time values using a galloping search
+ * in the larger one
+ */
+static PeriodSet *
+intersection_periodset_periodset_gallop(const PeriodSet *ps1,
+  const PeriodSet *ps2)
+{
+  const PeriodSet *small = (ps1->count < ps2->count) ? ps1 : ps2;
+  const PeriodSet *large = (ps1->count < ps2->count) ? ps2 : ps1;
+  int size = small->count * 2, k = 0, pos = 0;
+  Period **periods = palloc(sizeof(Period *) * size);
+  for (int i = 0; i < small->count; i++)
+  {
+    Period *p = periodset_per_n(small, i);
+    pos = periodset_gallop(large, pos, p->lower);
+    for (int j = pos; j < large->count; j++)
+    {
+      Period *q = periodset_per_n(large, j);
+      if (q->lower > p->upper)
+        break;
+      Period *inter = intersection_period_period_internal(p, q);
+      if (inter != NULL)
+      {
+        if (k == size)
+        {
+          size *= 2;
+          periods = repalloc(periods, sizeof(Period *) * size);
+        }
+        periods[k++] = inter;
+      }
+    }
+  }
+  return periodset_make_free(periods, k, NORMALIZE);
+}
+
 /**
  * Returns the intersection of the two time values (internal function)
  */
@@ -3580,6 +3939,9 @@ intersection_periodset_periodset_internal(const PeriodSet *ps1,
   if (!overlaps_period_period_internal(p1, p2))
     return NULL;
 
+  if (gallop_skewed(ps1->count, ps2->count))
+    return intersection_periodset_periodset_gallop(ps1, ps2);
+
   Period *inter = intersection_period_period_internal(p1, p2);
   int loc1, loc2;
   periodset_find_timestamp(ps1, inter->lower, &loc1);
@@ -4369,4 +4731,271 @@ minus_periodset_periodset(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Distance functions
+ * The distance between time values is the number of seconds between their
+ * closest instants, which is zero when they intersect. The bounds of the
+ * periods are taken as inclusive, so that the distance is an infimum. These
+ * functions are the ordering operators of the indexes for time types.
+ *****************************************************************************/
+
+/**
+ * Returns the distance in seconds between the timestamps
+ */
+static double
+distance_timestamp_timestamp_internal(TimestampTz t1, TimestampTz t2)
+{
+  return (t1 < t2 ? (double) (t2 - t1) : (double) (t1 - t2)) / USECS_PER_SEC;
+}
+
+/**
+ * Returns the distance in seconds between the period and the timestamp
+ * (internal function)
+ */
+double
+distance_period_timestamp_internal(const Period *p, TimestampTz t)
+{
+  if (t < p->lower)
+    return distance_timestamp_timestamp_internal(t, p->lower);
+  if (t > p->upper)
+    return distance_timestamp_timestamp_internal(p->upper, t);
+  return 0.0;
+}
+
+/**
+ * Returns the distance in seconds between the periods (internal function)
+ */
+double
+distance_period_period_internal(const Period *p1, const Period *p2)
+{
+  if (p1->upper < p2->lower)
+    return distance_timestamp_timestamp_internal(p1->upper, p2->lower);
+  if (p2->upper < p1->lower)
+    return distance_timestamp_timestamp_internal(p2->upper, p1->lower);
+  return 0.0;
+}
+
+/**
+ * Returns the distance in seconds between the timestamp set and the period
+ * (internal function)
+ *
+ * The closest timestamps are the last one before the lower bound of the
+ * period and the first one after it, which are next to the location of the
+ * lower bound found by binary search.
+ */
+double
+distance_timestampset_period_internal(const TimestampSet *ts, const Period *p)
+{
+  int loc;
+  if (timestampset_find_timestamp(ts, p->lower, &loc))
+    return 0.0;
+  double result = DBL_MAX;
+  for (int i = Max(loc - 1, 0); i <= Min(loc + 1, ts->count - 1); i++)
+  {
+    double dist = distance_period_timestamp_internal(p,
+      timestampset_time_n(ts, i));
+    if (dist < result)
+      result = dist;
+  }
+  return result;
+}
+
+/**
+ * Returns the distance in seconds between the timestamp set and the
+ * timestamp (internal function)
+ */
+double
+distance_timestampset_timestamp_internal(const TimestampSet *ts,
+  TimestampTz t)
+{
+  Period p;
+  period_set(&p, t, t, true, true);
+  return distance_timestampset_period_internal(ts, &p);
+}
+
+/**
+ * Returns the distance in seconds between the period set and the period
+ * (internal function)
+ *
+ * The closest periods are the ones next to the location of the lower bound
+ * of the period found by binary search.
+ */
+double
+distance_periodset_period_internal(const PeriodSet *ps, const Period *p)
+{
+  int loc;
+  if (periodset_find_timestamp(ps, p->lower, &loc))
+    return 0.0;
+  double result = DBL_MAX;
+  for (int i = Max(loc - 1, 0); i <= Min(loc + 1, ps->count - 1); i++)
+  {
+    double dist = distance_period_period_internal(periodset_per_n(ps, i), p);
+    if (dist < result)
+      result = dist;
+  }
+  return result;
+}
+
+/**
+ * Returns the distance in seconds between the period set and the timestamp
+ * (internal function)
+ */
+double
+distance_periodset_timestamp_internal(const PeriodSet *ps, TimestampTz t)
+{
+  Period p;
+  period_set(&p, t, t, true, true);
+  return distance_periodset_period_internal(ps, &p);
+}
+
+/*****************************************************************************/
+
+PG_FUNCTION_INFO_V1(distance_timestamp_timestampset);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_timestamp_timestampset(PG_FUNCTION_ARGS)
+{
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+  double result = distance_timestampset_timestamp_internal(ts, t);
+  PG_FREE_IF_COPY(ts, 1);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestamp_period);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_timestamp_period(PG_FUNCTION_ARGS)
+{
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  PG_RETURN_FLOAT8(distance_period_timestamp_internal(p, t));
+}
+
+PG_FUNCTION_INFO_V1(distance_timestamp_periodset);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_timestamp_periodset(PG_FUNCTION_ARGS)
+{
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+  PeriodSet *ps = PG_GETARG_PERIODSET(1);
+  double result = distance_periodset_timestamp_internal(ps, t);
+  PG_FREE_IF_COPY(ps, 1);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestampset_timestamp);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_timestampset_timestamp(PG_FUNCTION_ARGS)
+{
+  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(0);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+  double result = distance_timestampset_timestamp_internal(ts, t);
+  PG_FREE_IF_COPY(ts, 0);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestampset_period);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_timestampset_period(PG_FUNCTION_ARGS)
+{
+  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  double result = distance_timestampset_period_internal(ts, p);
+  PG_FREE_IF_COPY(ts, 0);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_timestamp);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_period_timestamp(PG_FUNCTION_ARGS)
+{
+  Period *p = PG_GETARG_PERIOD(0);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+  PG_RETURN_FLOAT8(distance_period_timestamp_internal(p, t));
+}
+
+PG_FUNCTION_INFO_V1(distance_period_timestampset);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_period_timestampset(PG_FUNCTION_ARGS)
+{
+  Period *p = PG_GETARG_PERIOD(0);
+  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+  double result = distance_timestampset_period_internal(ts, p);
+  PG_FREE_IF_COPY(ts, 1);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_period);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_period_period(PG_FUNCTION_ARGS)
+{
+  Period *p1 = PG_GETARG_PERIOD(0);
+  Period *p2 = PG_GETARG_PERIOD(1);
+  PG_RETURN_FLOAT8(distance_period_period_internal(p1, p2));
+}
+
+PG_FUNCTION_INFO_V1(distance_period_periodset);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_period_periodset(PG_FUNCTION_ARGS)
+{
+  Period *p = PG_GETARG_PERIOD(0);
+  PeriodSet *ps = PG_GETARG_PERIODSET(1);
+  double result = distance_periodset_period_internal(ps, p);
+  PG_FREE_IF_COPY(ps, 1);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_periodset_timestamp);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_periodset_timestamp(PG_FUNCTION_ARGS)
+{
+  PeriodSet *ps = PG_GETARG_PERIODSET(0);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+  double result = distance_periodset_timestamp_internal(ps, t);
+  PG_FREE_IF_COPY(ps, 0);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_periodset_period);
+/**
+ * Returns the distance in seconds between the time values
+ */
+PGDLLEXPORT Datum
+distance_periodset_period(PG_FUNCTION_ARGS)
+{
+  PeriodSet *ps = PG_GETARG_PERIODSET(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  double result = distance_periodset_period_internal(ps, p);
+  PG_FREE_IF_COPY(ps, 0);
+  PG_RETURN_FLOAT8(result);
+}
+
 /******************************************************************************/
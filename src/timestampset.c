@@ -26,22 +26,51 @@
  *****************************************************************************/
  
 /**
- * Returns a pointer to the array of offsets of the timestamp set value
+ * Returns the size of a timestamp set value with the given number of
+ * timestamps in the layout of previous versions, in which the count is
+ * followed by an array of offsets, the timestamps, and the bounding box
  */
-static size_t *
-timestampset_offsets_ptr(const TimestampSet *ts)
+static size_t
+timestampset_legacy_size(int count)
 {
-  return (size_t *) (((char *)ts) + sizeof(TimestampSet));
+  return double_pad(2 * sizeof(int32) + (count + 1) * sizeof(size_t)) +
+    double_pad(sizeof(TimestampTz) * count + double_pad(sizeof(Period)));
 }
 
 /**
- * Returns a pointer to the first timestamp of the timestamp set value
+ * Returns true if the timestamp set value has the layout of previous
+ * versions
+ *
+ * The layout is given by the size of the value, which is 40 + 16 * count
+ * bytes in the previous layout and 32 + 8 * count bytes in the current
+ * one, two sizes that are never equal.
  */
-static char * 
+static bool
+timestampset_legacy(const TimestampSet *ts)
+{
+  return VARSIZE(ts) == timestampset_legacy_size(ts->count);
+}
+
+/**
+ * Returns a pointer to the n-th element of a timestamp set value having
+ * the layout of previous versions, where the element after the last one
+ * is the bounding box
+ */
+static char *
+timestampset_legacy_ptr(const TimestampSet *ts, int index)
+{
+  size_t *offsets = (size_t *) ((char *) ts + 2 * sizeof(int32));
+  return (char *) ts + double_pad(2 * sizeof(int32) +
+    (ts->count + 1) * sizeof(size_t)) + offsets[index];
+}
+
+/**
+ * Returns a pointer to the array of timestamps of the timestamp set value
+ */
+static TimestampTz *
 timestampset_data_ptr(const TimestampSet *ts)
 {
-  return (char *)ts + double_pad(sizeof(TimestampSet) + 
-    sizeof(size_t) * (ts->count + 1));
+  return (TimestampTz *) (((char *) ts) + double_pad(sizeof(TimestampSet)));
 }
 
 /**
@@ -50,9 +79,9 @@ timestampset_data_ptr(const TimestampSet *ts)
 TimestampTz
 timestampset_time_n(const TimestampSet *ts, int index)
 {
-  size_t *offsets = timestampset_offsets_ptr(ts);
-  TimestampTz *result = (TimestampTz *) (timestampset_data_ptr(ts) + offsets[index]);
-  return *result;
+  if (timestampset_legacy(ts))
+    return *(TimestampTz *) timestampset_legacy_ptr(ts, index);
+  return timestampset_data_ptr(ts)[index];
 }
 
 /**
@@ -61,8 +90,9 @@ timestampset_time_n(const TimestampSet *ts, int index)
 Period *
 timestampset_bbox(const TimestampSet *ts)
 {
-  size_t *offsets = timestampset_offsets_ptr(ts);
-  return (Period *)(timestampset_data_ptr(ts) + offsets[ts->count]);
+  if (timestampset_legacy(ts))
+    return (Period *) timestampset_legacy_ptr(ts, ts->count);
+  return (Period *) &ts->period;
 }
 
 /**
@@ -71,17 +101,13 @@ timestampset_bbox(const TimestampSet *ts)
  * For example, the memory structure of a timestamp set with 3 
  * timestamps is as follows
  * @code
- * --------------------------------------------------------------------
- * ( TimestampSet | offset_0 | offset_1 | offset_2 | offset_3 | )_X | ...
- * --------------------------------------------------------------------
- * ------------------------------------------------------------
- * ( Timestamp_0 | Timestamp_1 | Timestamp_2 | ( bbox )_Y )_X |
- * ------------------------------------------------------------
+ * -------------------------------------------------------------------
+ * ( TimestampSet | bbox )_X | Timestamp_0 | Timestamp_1 | Timestamp_2 |
+ * -------------------------------------------------------------------
  * @endcode
- * where the `X` are unused bytes added for double padding, the `Y` are 
- * unused bytes added for int4 padding, `offset_0` to `offset_2` are 
- * offsets for the corresponding timestamps, and `offset_3` is the offset 
- * for the bounding box which is a period.
+ * where the `X` are unused bytes added for double padding. The
+ * timestamps are stored as a flat array after the header, which contains
+ * the precomputed bounding box.
  *
  * @param[in] times Array of timestamps
  * @param[in] count Number of elements in the array
@@ -89,7 +115,6 @@ timestampset_bbox(const TimestampSet *ts)
 TimestampSet *
 timestampset_make_internal(const TimestampTz *times, int count)
 {
-  Period bbox;
   /* Test the validity of the timestamps */
   for (int i = 0; i < count - 1; i++)
   {
@@ -98,27 +123,15 @@ timestampset_make_internal(const TimestampTz *times, int count)
         errmsg("Invalid value for timestamp set")));
   }
 
-  size_t memsize = double_pad(sizeof(TimestampTz) * count + double_pad(sizeof(Period)));
-  /* Array of pointers containing the pointers to the component timestamps,
-     and a pointer to the bbox */
-  size_t pdata = double_pad(sizeof(TimestampSet) + (count + 1) * sizeof(size_t));
+  size_t memsize = double_pad(sizeof(TimestampSet)) +
+    sizeof(TimestampTz) * count;
   /* Create the TimestampSet */
-  TimestampSet *result = palloc0(pdata + memsize);
-  SET_VARSIZE(result, pdata + memsize);
+  TimestampSet *result = palloc0(memsize);
+  SET_VARSIZE(result, memsize);
   result->count = count;
-
-  size_t *offsets = timestampset_offsets_ptr(result);
-  size_t pos = 0;
-  for (int i = 0; i < count; i++)
-  {
-    memcpy(((char *) result) + pdata + pos, &times[i], sizeof(TimestampTz));
-    offsets[i] = pos;
-    pos += sizeof(TimestampTz);
-  }
+  memcpy(timestampset_data_ptr(result), times, sizeof(TimestampTz) * count);
   /* Precompute the bounding box */
-  period_set(&bbox, times[0], times[count - 1], true, true);
-  offsets[count] = pos;
-  memcpy(((char *) result) + pdata + pos, &bbox, sizeof(Period));
+  period_set(&result->period, times[0], times[count - 1], true, true);
   return result;
 }
 
@@ -369,6 +382,33 @@ timestampset_mem_size(PG_FUNCTION_ARGS)
   PG_RETURN_DATUM(result);
 }
 
+PG_FUNCTION_INFO_V1(timestampset_legacy_layout);
+/**
+ * Returns the timestamp set value in the layout of previous versions
+ *
+ * @note Used by the regression tests for reading the values stored by
+ * previous versions
+ */
+PGDLLEXPORT Datum
+timestampset_legacy_layout(PG_FUNCTION_ARGS)
+{
+  TimestampSet *ts = PG_GETARG_TIMESTAMPSET(0);
+  size_t memsize = timestampset_legacy_size(ts->count);
+  TimestampSet *result = palloc0(memsize);
+  SET_VARSIZE(result, memsize);
+  result->count = ts->count;
+  size_t *offsets = (size_t *) ((char *) result + 2 * sizeof(int32));
+  for (int i = 0; i <= ts->count; i++)
+    offsets[i] = sizeof(TimestampTz) * i;
+  for (int i = 0; i < ts->count; i++)
+    *(TimestampTz *) timestampset_legacy_ptr(result, i) =
+      timestampset_time_n(ts, i);
+  memcpy(timestampset_legacy_ptr(result, ts->count), timestampset_bbox(ts),
+    sizeof(Period));
+  PG_FREE_IF_COPY(ts, 0);
+  PG_RETURN_POINTER(result);
+}
+
 PG_FUNCTION_INFO_V1(timestampset_timespan);
 /**
  * Returns the timespan of the timestamp set value
@@ -13,6 +13,12 @@
 #include "tinstant.h"
 
 #include <assert.h>
+#include <math.h>
+#if MOBDB_PGSQL_VERSION < 130000
+#include <access/hash.h>
+#else
+#include <common/hashfn.h>
+#endif
 #include <libpq/pqformat.h>
 #include <utils/builtins.h>
 #include <utils/timestamp.h>
@@ -77,49 +83,57 @@ tinstant_value_copy(const TInstant *inst)
 }
 
 /**
- * Construct a temporal instant value from the arguments
+ * Returns the size of the temporal instant value constructed from the
+ * arguments, including the double padding of the base value
  *
- * The memory structure of a temporal instant value is as follows
- * @code
- * ----------------------------------
- * ( TInstant )_X | ( Value )_X |
- * ----------------------------------
- * @endcode
- * where the `_X` are unused bytes added for double padding.
+ * @param value Base value
+ * @param valuetypid Oid of the base type
+ */
+size_t
+tinstant_make_size(Datum value, Oid valuetypid)
+{
+  size_t size = double_pad(sizeof(TInstant));
+  const BaseTypeInfo *info = base_type_info(valuetypid);
+  if (info->typbyval)
+    size += double_pad(sizeof(Datum));
+  else
+  {
+    int typlen = info->typlen;
+    size += typlen != -1 ? double_pad((unsigned int) typlen) :
+      double_pad(VARSIZE(DatumGetPointer(value)));
+  }
+  return size;
+}
+
+/**
+ * Initialize a temporal instant value in a zeroed buffer of the size given
+ * by the function tinstant_make_size. This allows the instants of a
+ * temporal value to be constructed in a single allocated block.
  *
+ * @param result Buffer receiving the temporal instant value
  * @param value Base value
  * @param t Timestamp
  * @param valuetypid Oid of the base type
+ * @param size Size of the temporal instant value
  */
-TInstant *
-tinstant_make(Datum value, TimestampTz t, Oid valuetypid)
+void
+tinstant_init(TInstant *result, Datum value, TimestampTz t, Oid valuetypid,
+  size_t size)
 {
   size_t value_offset = double_pad(sizeof(TInstant));
-  size_t size = value_offset;
-  /* Create the temporal value */
-  TInstant *result;
-  size_t value_size;
-  /* Copy value */
-  bool byval = get_typbyval_fast(valuetypid);
+  void *value_to = ((char *) result) + value_offset;
+  const BaseTypeInfo *info = base_type_info(valuetypid);
+  bool byval = info->typbyval;
   if (byval)
-  {
     /* For base types passed by value */
-    value_size = double_pad(sizeof(Datum));
-    size += value_size;
-    result = palloc0(size);
-    void *value_to = ((char *) result) + value_offset;
     memcpy(value_to, &value, sizeof(Datum));
-  }
   else
   {
     /* For base types passed by reference */
     void *value_from = DatumGetPointer(value);
-    int typlen = get_typlen_fast(valuetypid);
-    value_size = typlen != -1 ? double_pad((unsigned int) typlen) :
-      double_pad(VARSIZE(value_from));
-    size += value_size;
-    result = palloc0(size);
-    void *value_to = ((char *) result) + value_offset;
+    int typlen = info->typlen;
+    size_t value_size = typlen != -1 ? (unsigned int) typlen :
+      VARSIZE(value_from);
     memcpy(value_to, value_from, value_size);
   }
   /* Initialize fixed-size values */
@@ -128,7 +142,7 @@ tinstant_make(Datum value, TimestampTz t, Oid valuetypid)
   result->t = t;
   SET_VARSIZE(result, size);
   MOBDB_FLAGS_SET_BYVAL(result->flags, byval);
-  MOBDB_FLAGS_SET_LINEAR(result->flags, linear_interpolation(valuetypid));
+  MOBDB_FLAGS_SET_LINEAR(result->flags, info->linear);
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
   if (tgeo_base_type(valuetypid))
@@ -138,6 +152,30 @@ tinstant_make(Datum value, TimestampTz t, Oid valuetypid)
     MOBDB_FLAGS_SET_GEODETIC(result->flags, FLAGS_GET_GEODETIC(gs->flags));
     POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(value));
   }
+  return;
+}
+
+/**
+ * Construct a temporal instant value from the arguments
+ *
+ * The memory structure of a temporal instant value is as follows
+ * @code
+ * ----------------------------------
+ * ( TInstant )_X | ( Value )_X |
+ * ----------------------------------
+ * @endcode
+ * where the `_X` are unused bytes added for double padding.
+ *
+ * @param value Base value
+ * @param t Timestamp
+ * @param valuetypid Oid of the base type
+ */
+TInstant *
+tinstant_make(Datum value, TimestampTz t, Oid valuetypid)
+{
+  size_t size = tinstant_make_size(value, valuetypid);
+  TInstant *result = palloc0(size);
+  tinstant_init(result, value, t, valuetypid, size);
   return result;
 }
 
@@ -852,6 +890,55 @@ tinstant_cmp(const TInstant *inst1, const TInstant *inst2)
  * the lower and upper bounds.
  *****************************************************************************/
 
+/**
+ * Returns the hash value of the base value
+ *
+ * The hash values of the base types passed by value are computed as done by
+ * the functions hashchar, hashint4, and hashfloat8 of PostgreSQL without
+ * calling them through the function manager.
+ */
+static uint32
+tinstant_value_hash(Datum value, Oid valuetypid)
+{
+  uint32 result = 0;
+  ensure_temporal_base_type(valuetypid);
+  if (valuetypid == BOOLOID)
+    result = DatumGetUInt32(hash_uint32((int32) DatumGetChar(value)));
+  else if (valuetypid == INT4OID)
+    result = DatumGetUInt32(hash_uint32((uint32) DatumGetInt32(value)));
+  else if (valuetypid == FLOAT8OID)
+  {
+    double d = DatumGetFloat8(value);
+    /* The hash of -0 must be equal to the one of 0 */
+    if (d == 0.0)
+      result = 0;
+    else if (isnan(d))
+      result = DatumGetUInt32(call_function1(hashfloat8, value));
+    else
+      result = DatumGetUInt32(hash_any((unsigned char *) &d, sizeof(d)));
+  }
+  else if (valuetypid == TEXTOID)
+    result = DatumGetUInt32(call_function1(hashtext, value));
+  else if (tgeo_base_type(valuetypid))
+    result = DatumGetUInt32(call_function1(lwgeom_hash, value));
+  return result;
+}
+
+/**
+ * Returns the hash value of the timestamp, computed as done by the
+ * function hashint8 of PostgreSQL without calling it through the function
+ * manager
+ */
+static uint32
+tinstant_time_hash(TimestampTz t)
+{
+  int64 val = (int64) t;
+  uint32 lohalf = (uint32) val;
+  uint32 hihalf = (uint32) (val >> 32);
+  lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+  return DatumGetUInt32(hash_uint32(lohalf));
+}
+
 /**
  * Returns the hash value of the temporal value
  */
@@ -861,22 +948,11 @@ tinstant_hash(const TInstant *inst)
   uint32 result;
   uint32 time_hash;
 
-  Datum value = tinstant_value(inst);
   /* Apply the hash function according to the subtype */
-  uint32 value_hash = 0;
-  ensure_temporal_base_type(inst->valuetypid);
-  if (inst->valuetypid == BOOLOID)
-    value_hash = DatumGetUInt32(call_function1(hashchar, value));
-  else if (inst->valuetypid == INT4OID)
-    value_hash = DatumGetUInt32(call_function1(hashint4, value));
-  else if (inst->valuetypid == FLOAT8OID)
-    value_hash = DatumGetUInt32(call_function1(hashfloat8, value));
-  else if (inst->valuetypid == TEXTOID)
-    value_hash = DatumGetUInt32(call_function1(hashtext, value));
-  else if (tgeo_base_type(inst->valuetypid))
-    value_hash = DatumGetUInt32(call_function1(lwgeom_hash, value));
+  uint32 value_hash = tinstant_value_hash(tinstant_value(inst),
+    inst->valuetypid);
   /* Apply the hash function according to the timestamp */
-  time_hash = DatumGetUInt32(call_function1(hashint8, TimestampTzGetDatum(inst->t)));
+  time_hash = tinstant_time_hash(inst->t);
 
   /* Merge hashes of value and timestamp */
   result = value_hash;
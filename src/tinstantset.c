@@ -49,6 +49,11 @@ tinstantset_inst_n(const TInstantSet *ti, int index)
 
 /**
  * Returns a pointer to the precomputed bounding box of the temporal value
+ *
+ * The offset of the bounding box is kept in the offsets array, which
+ * makes the function valid both for the values having the BBOXFIRST flag
+ * and for those of previous versions whose bounding box follows the
+ * composing values
  */
 void *
 tinstantset_bbox_ptr(const TInstantSet *ti)
@@ -96,9 +101,12 @@ tinstantset_make1(TInstant **instants, int count)
   /* Add the size of the struct and the offset array
    * Notice that the first offset is already declared in the struct */
   size_t pdata = double_pad(sizeof(TInstantSet) + count * sizeof(size_t));
+  /* Add the size of the time summary, which is stored at the end */
+  int nkeys = count >= TIME_SUMMARY_MINCOUNT ? time_summary_count(count) : 0;
+  size_t keysize = double_pad(sizeof(TimestampTz) * nkeys);
   /* Create the TInstantSet */
-  TInstantSet *result = palloc0(pdata + memsize);
-  SET_VARSIZE(result, pdata + memsize);
+  TInstantSet *result = palloc0(pdata + memsize + keysize);
+  SET_VARSIZE(result, pdata + memsize + keysize);
   result->count = count;
   result->valuetypid = instants[0]->valuetypid;
   result->duration = INSTANTSET;
@@ -106,13 +114,28 @@ tinstantset_make1(TInstant **instants, int count)
     MOBDB_FLAGS_GET_LINEAR(instants[0]->flags));
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
+  MOBDB_FLAGS_SET_BBOXFIRST(result->flags, true);
   if (tgeo_base_type(instants[0]->valuetypid))
   {
     MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(instants[0]->flags));
     MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(instants[0]->flags));
   }
-  /* Initialization of the variable-length part */
+  /*
+   * Precompute the bounding box
+   * Only external types have precomputed bounding box, internal types such
+   * as double2, double3, or double4 do not have one.
+   * The bounding box is located at the beginning of the variable-length
+   * part so that it can be read without detoasting the whole value.
+   */
   size_t pos = 0;
+  if (bboxsize != 0)
+  {
+    void *bbox = ((char *) result) + pdata;
+    tinstantset_make_bbox(bbox, instants, count);
+    result->offsets[count] = pos;
+    pos += double_pad(bboxsize);
+  }
+  /* Initialization of the variable-length part */
   for (int i = 0; i < count; i++)
   {
     memcpy(((char *)result) + pdata + pos, instants[i],
@@ -120,16 +143,13 @@ tinstantset_make1(TInstant **instants, int count)
     result->offsets[i] = pos;
     pos += double_pad(VARSIZE(instants[i]));
   }
-  /*
-   * Precompute the bounding box
-   * Only external types have precomputed bounding box, internal types such
-   * as double2, double3, or double4 do not have one
-   */
-  if (bboxsize != 0)
+  /* Initialization of the time summary */
+  if (nkeys > 0)
   {
-    void *bbox = ((char *) result) + pdata + pos;
-    tinstantset_make_bbox(bbox, instants, count);
-    result->offsets[count] = pos;
+    TimestampTz *keys = (TimestampTz *) (((char *) result) + pdata + pos);
+    for (int i = 0; i < nkeys; i++)
+      keys[i] = instants[i * TIME_SUMMARY_BLOCK_SIZE]->t;
+    MOBDB_FLAGS_SET_TIMES(result->flags, true);
   }
   return result;
 }
@@ -145,12 +165,18 @@ tinstantset_make1(TInstant **instants, int count)
  *  ( TInstantSet | offset_0 | offset_1 | offset_2 )_X | ...
  *  ------------------------------------------------------
  *  ----------------------------------------------------------
- *  ( TInstant_0 )_X | ( TInstant_1 )_X | ( bbox )_X |
+ *  ( bbox )_X | ( TInstant_0 )_X | ( TInstant_1 )_X |
  *  ----------------------------------------------------------
  * @endcode
  * where the `_X` are unused bytes added for double padding, `offset_0` and
  * `offset_1` are offsets for the corresponding instants, and `offset_2`
- * is the offset for the bounding box.
+ * is the offset for the bounding box. The bounding box is stored first, at
+ * an offset that only depends on the number of instants, so that it can be
+ * fetched without detoasting the whole value.
+ * Values with at least `TIME_SUMMARY_MINCOUNT` instants are followed by a
+ * time summary, that is, the array of the timestamps of every
+ * `TIME_SUMMARY_BLOCK_SIZE`-th instant, which is used for speeding up the
+ * binary search of a timestamp.
  *
  * @param[in] instants Array of instants
  * @param[in] count Number of elements in the array
@@ -235,6 +261,38 @@ tinstantset_append_tinstant(const TInstantSet *ti, const TInstant *inst)
   return result;
 }
 
+/**
+ * Append an array of instants to the temporal value
+ *
+ * When the timestamps of the instants are strictly increasing and after the
+ * end of the instant set, the instant set is built only once from all the
+ * instants. Otherwise, the instants are appended one by one.
+ *
+ * @param[in] ti Temporal value
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ */
+Temporal *
+tinstantset_append_tinstants(const TInstantSet *ti, TInstant **instants,
+  int count)
+{
+  assert(count > 0);
+  TInstant *last = tinstantset_inst_n(ti, ti->count - 1);
+  if (instants[0]->t <= last->t)
+    return temporal_append_tinstants1((Temporal *) ti, instants, count);
+  for (int i = 1; i < count; i++)
+    ensure_increasing_timestamps(instants[i - 1], instants[i], false); /* >= */
+
+  int newcount = ti->count + count;
+  TInstant **allinstants = palloc(sizeof(TInstant *) * newcount);
+  for (int i = 0; i < ti->count; i++)
+    allinstants[i] = tinstantset_inst_n(ti, i);
+  memcpy(&allinstants[ti->count], instants, sizeof(TInstant *) * count);
+  TInstantSet *result = tinstantset_make1(allinstants, newcount);
+  pfree(allinstants);
+  return (Temporal *) result;
+}
+
 /**
  * Merge the two temporal values
  */
@@ -310,6 +368,19 @@ tinstantset_copy(const TInstantSet *ti)
   return result;
 }
 
+/**
+ * Returns a pointer to the time summary of the temporal value, which is
+ * stored at the end of the value
+ * @pre The value keeps a time summary
+ */
+static const TimestampTz *
+tinstantset_time_summary(const TInstantSet *ti)
+{
+  int nkeys = time_summary_count(ti->count);
+  return (const TimestampTz *) ((char *) ti + VARSIZE(ti) -
+    double_pad(sizeof(TimestampTz) * nkeys));
+}
+
 /**
  * Returns the location of the timestamp in the temporal instant set
  * value using binary search
@@ -340,6 +411,19 @@ tinstantset_find_timestamp(const TInstantSet *ti, TimestampTz t, int *loc)
 {
   int first = 0;
   int last = ti->count - 1;
+  if (MOBDB_FLAGS_GET_TIMES(ti->flags))
+  {
+    /* Restrict the search to the block of the time summary */
+    int nkeys = time_summary_count(ti->count);
+    int block = time_summary_find(tinstantset_time_summary(ti), nkeys, t);
+    if (block < 0)
+    {
+      *loc = 0;
+      return false;
+    }
+    first = block * TIME_SUMMARY_BLOCK_SIZE;
+    last = Min(first + TIME_SUMMARY_BLOCK_SIZE, ti->count) - 1;
+  }
   int middle = 0; /* make compiler quiet */
   TInstant *inst = NULL; /* make compiler quiet */
   while (first <= last)
@@ -0,0 +1,282 @@
+/*****************************************************************************
+ *
+ * tnumber_distance.c
+ *    Distance functions for temporal numbers.
+ *
+ * The nearest approach distance between a temporal number and a number or a
+ * temporal box is the smallest difference between the values taken by the
+ * temporal number, restricted to the timespan of the box if any, and the
+ * number or the value span of the box. These functions are the ordering
+ * operators of the GiST and SP-GiST indexes for temporal numbers.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tnumber_distance.h"
+
+#include <utils/builtins.h>
+
+#include "period.h"
+#include "temporaltypes.h"
+#include "temporal_util.h"
+
+/*****************************************************************************
+ * Distance between value spans
+ *****************************************************************************/
+
+/**
+ * Returns the distance between the value spans [min1, max1] and
+ * [min2, max2], which is zero when they overlap
+ */
+static double
+span_distance(double min1, double max1, double min2, double max2)
+{
+  if (max1 < min2)
+    return min2 - max1;
+  if (max2 < min1)
+    return min1 - max2;
+  return 0.0;
+}
+
+/**
+ * Returns the distance between the value of the temporal instant number
+ * and the value span
+ */
+static double
+NAD_tnumberinst_span(const TInstant *inst, double xmin, double xmax)
+{
+  double value = datum_double(tinstant_value(inst), inst->valuetypid);
+  return span_distance(value, value, xmin, xmax);
+}
+
+/**
+ * Returns the nearest approach distance between the temporal instant set
+ * number and the value span
+ */
+static double
+NAD_tnumberinstset_span(const TInstantSet *ti, double xmin, double xmax)
+{
+  double result = DBL_MAX;
+  for (int i = 0; i < ti->count && result > 0.0; i++)
+  {
+    double dist = NAD_tnumberinst_span(tinstantset_inst_n(ti, i), xmin, xmax);
+    if (dist < result)
+      result = dist;
+  }
+  return result;
+}
+
+/**
+ * Returns the nearest approach distance between the temporal sequence
+ * number and the value span
+ *
+ * A segment with linear interpolation takes all the values between the
+ * ones of its instants, while a segment with stepwise interpolation only
+ * takes the value of its start instant. The value of the last instant of a
+ * sequence with stepwise interpolation is only taken when its upper bound
+ * is inclusive.
+ */
+static double
+NAD_tnumberseq_span(const TSequence *seq, double xmin, double xmax)
+{
+  const TInstant *inst1 = tsequence_inst_n(seq, 0);
+  double value1 = datum_double(tinstant_value(inst1), seq->valuetypid);
+  if (seq->count == 1)
+    return span_distance(value1, value1, xmin, xmax);
+
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  double result = DBL_MAX;
+  for (int i = 1; i < seq->count && result > 0.0; i++)
+  {
+    const TInstant *inst2 = tsequence_inst_n(seq, i);
+    double value2 = datum_double(tinstant_value(inst2), seq->valuetypid);
+    double dist = linear ?
+      span_distance(Min(value1, value2), Max(value1, value2), xmin, xmax) :
+      span_distance(value1, value1, xmin, xmax);
+    if (dist < result)
+      result = dist;
+    value1 = value2;
+  }
+  if (! linear && seq->period.upper_inc)
+  {
+    double dist = span_distance(value1, value1, xmin, xmax);
+    if (dist < result)
+      result = dist;
+  }
+  return result;
+}
+
+/**
+ * Returns the nearest approach distance between the temporal sequence set
+ * number and the value span
+ */
+static double
+NAD_tnumberseqset_span(const TSequenceSet *ts, double xmin, double xmax)
+{
+  double result = DBL_MAX;
+  for (int i = 0; i < ts->count && result > 0.0; i++)
+  {
+    double dist = NAD_tnumberseq_span(tsequenceset_seq_n(ts, i), xmin, xmax);
+    if (dist < result)
+      result = dist;
+  }
+  return result;
+}
+
+/**
+ * Returns the nearest approach distance between the temporal number and
+ * the value span (dispatch function)
+ */
+static double
+NAD_tnumber_span(const Temporal *temp, double xmin, double xmax)
+{
+  double result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result = NAD_tnumberinst_span((TInstant *) temp, xmin, xmax);
+  else if (temp->duration == INSTANTSET)
+    result = NAD_tnumberinstset_span((TInstantSet *) temp, xmin, xmax);
+  else if (temp->duration == SEQUENCE)
+    result = NAD_tnumberseq_span((TSequence *) temp, xmin, xmax);
+  else /* temp->duration == SEQUENCESET */
+    result = NAD_tnumberseqset_span((TSequenceSet *) temp, xmin, xmax);
+  return result;
+}
+
+/*****************************************************************************
+ * Nearest approach distance
+ *****************************************************************************/
+
+/**
+ * Returns the nearest approach distance between the temporal boxes
+ * (internal function)
+ *
+ * The result is DBL_MAX when both boxes have a time dimension and their
+ * timespans do not overlap. Since the value of the temporal boxes is
+ * represented with a span, this function is used as a lower bound of the
+ * distance between the temporal numbers bounded by the boxes.
+ */
+double
+NAD_tbox_tbox_internal(const TBOX *box1, const TBOX *box2)
+{
+  /* Test the validity of the arguments */
+  ensure_has_X_tbox(box1); ensure_has_X_tbox(box2);
+  if (MOBDB_FLAGS_GET_T(box1->flags) && MOBDB_FLAGS_GET_T(box2->flags) &&
+      (box1->tmax < box2->tmin || box2->tmax < box1->tmin))
+    return DBL_MAX;
+  return span_distance(box1->xmin, box1->xmax, box2->xmin, box2->xmax);
+}
+
+/**
+ * Returns the nearest approach distance between the temporal number and
+ * the temporal box (internal function)
+ *
+ * The temporal number is projected to the timespan of the box when it has
+ * a time dimension. The result is DBL_MAX when the temporal number is not
+ * defined on this timespan.
+ */
+double
+NAD_tnumber_tbox_internal(const Temporal *temp, const TBOX *box)
+{
+  /* Test the validity of the arguments */
+  ensure_has_X_tbox(box);
+  if (! MOBDB_FLAGS_GET_T(box->flags))
+    return NAD_tnumber_span(temp, box->xmin, box->xmax);
+
+  /* Project the temporal number to the timespan of the box */
+  Period p;
+  period_set(&p, box->tmin, box->tmax, true, true);
+  Temporal *temp1 = temporal_at_period_internal(temp, &p);
+  if (temp1 == NULL)
+    return DBL_MAX;
+  double result = NAD_tnumber_span(temp1, box->xmin, box->xmax);
+  pfree(temp1);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(NAD_number_tnumber);
+/**
+ * Returns the nearest approach distance between the number and the
+ * temporal number
+ */
+PGDLLEXPORT Datum
+NAD_number_tnumber(PG_FUNCTION_ARGS)
+{
+  Datum value = PG_GETARG_DATUM(0);
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  double d = datum_double(value, get_fn_expr_argtype(fcinfo->flinfo, 0));
+  double result = NAD_tnumber_span(temp, d, d);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(NAD_tnumber_number);
+/**
+ * Returns the nearest approach distance between the temporal number and
+ * the number
+ */
+PGDLLEXPORT Datum
+NAD_tnumber_number(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Datum value = PG_GETARG_DATUM(1);
+  double d = datum_double(value, get_fn_expr_argtype(fcinfo->flinfo, 1));
+  double result = NAD_tnumber_span(temp, d, d);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(NAD_tbox_tbox);
+/**
+ * Returns the nearest approach distance between the temporal boxes
+ */
+PGDLLEXPORT Datum
+NAD_tbox_tbox(PG_FUNCTION_ARGS)
+{
+  TBOX *box1 = PG_GETARG_TBOX_P(0);
+  TBOX *box2 = PG_GETARG_TBOX_P(1);
+  double result = NAD_tbox_tbox_internal(box1, box2);
+  if (result == DBL_MAX)
+    PG_RETURN_NULL();
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(NAD_tbox_tnumber);
+/**
+ * Returns the nearest approach distance between the temporal box and the
+ * temporal number
+ */
+PGDLLEXPORT Datum
+NAD_tbox_tnumber(PG_FUNCTION_ARGS)
+{
+  TBOX *box = PG_GETARG_TBOX_P(0);
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  double result = NAD_tnumber_tbox_internal(temp, box);
+  PG_FREE_IF_COPY(temp, 1);
+  if (result == DBL_MAX)
+    PG_RETURN_NULL();
+  PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(NAD_tnumber_tbox);
+/**
+ * Returns the nearest approach distance between the temporal number and
+ * the temporal box
+ */
+PGDLLEXPORT Datum
+NAD_tnumber_tbox(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  TBOX *box = PG_GETARG_TBOX_P(1);
+  double result = NAD_tnumber_tbox_internal(temp, box);
+  PG_FREE_IF_COPY(temp, 0);
+  if (result == DBL_MAX)
+    PG_RETURN_NULL();
+  PG_RETURN_FLOAT8(result);
+}
+
+/*****************************************************************************/
@@ -29,7 +29,9 @@
 #include "time_gist.h"
 #include "oidcache.h"
 #include "temporal_boxops.h"
+#include "temporal_util.h"
 #include "temporal_posops.h"
+#include "tnumber_distance.h"
 
 /*****************************************************************************
  * GiST consistent methods
@@ -121,7 +123,7 @@ tbox_index_consistent_leaf(const TBOX *key, const TBOX *query,
  * @param[in] query Value being looked up in the index
  * @param[in] strategy Operator of the operator class being applied
  */
-static bool
+bool
 tbox_gist_consistent_internal(const TBOX *key, const TBOX *query,
   StrategyNumber strategy)
 {
@@ -173,33 +175,20 @@ tbox_gist_consistent_internal(const TBOX *key, const TBOX *query,
   return retval;
 }
 
-PG_FUNCTION_INFO_V1(tnumber_gist_consistent);
 /**
- * GiST consistent method for temporal numbers
+ * Transform the query of a GiST support function into a box setting which
+ * are the dimensions that must be taken into account by the operators
+ *
+ * @param[out] query Box
+ * @param[in] fcinfo Catalog information about the external function
+ * @return False if the query is NULL or empty
  */
-PGDLLEXPORT Datum
-tnumber_gist_consistent(PG_FUNCTION_ARGS)
+static bool
+tnumber_gist_query(TBOX *query, FunctionCallInfo fcinfo)
 {
-  GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
   StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
   Oid subtype = PG_GETARG_OID(3);
-  bool *recheck = (bool *) PG_GETARG_POINTER(4), result;
-  TBOX *key = DatumGetTboxP(entry->key), query;
-
-  /*
-   * All tests are lossy since boxes do not distinghish between inclusive
-   * and exclusive bounds.
-   */
-  *recheck = true;
-
-  if (key == NULL)
-    PG_RETURN_BOOL(false);
-
-  /*
-   * Transform the query into a box setting which are the dimensions that
-   * must be taken into account by the operators.
-   */
-  memset(&query, 0, sizeof(TBOX));
+  memset(query, 0, sizeof(TBOX));
   if (tnumber_range_type(subtype))
   {
 #if MOBDB_PGSQL_VERSION < 110000
@@ -208,31 +197,57 @@ tnumber_gist_consistent(PG_FUNCTION_ARGS)
   RangeType  *range = PG_GETARG_RANGE_P(1);
 #endif
     if (range == NULL)
-      PG_RETURN_BOOL(false);
+      return false;
     /* Return false on empty range */
     char flags = range_get_flags(range);
     if (flags & RANGE_EMPTY)
-      PG_RETURN_BOOL(false);
-    range_to_tbox_internal(&query, range);
+      return false;
+    range_to_tbox_internal(query, range);
     PG_FREE_IF_COPY(range, 1);
   }
   else if (subtype == type_oid(T_TBOX))
   {
     TBOX *box = PG_GETARG_TBOX_P(1);
     if (box == NULL)
-      PG_RETURN_BOOL(false);
-    query = *box;
+      return false;
+    *query = *box;
   }
   else if (tnumber_type(subtype))
   {
     Temporal *temp = PG_GETARG_TEMPORAL(1);
     if (temp == NULL)
-      PG_RETURN_BOOL(false);
-    temporal_bbox(&query, temp);
+      return false;
+    temporal_bbox(query, temp);
     PG_FREE_IF_COPY(temp, 1);
   }
   else
     elog(ERROR, "unrecognized strategy number: %d", strategy);
+  return true;
+}
+
+PG_FUNCTION_INFO_V1(tnumber_gist_consistent);
+/**
+ * GiST consistent method for temporal numbers
+ */
+PGDLLEXPORT Datum
+tnumber_gist_consistent(PG_FUNCTION_ARGS)
+{
+  GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4), result;
+  TBOX *key = DatumGetTboxP(entry->key), query;
+
+  /*
+   * All tests are lossy since boxes do not distinghish between inclusive
+   * and exclusive bounds.
+   */
+  *recheck = true;
+
+  if (key == NULL)
+    PG_RETURN_BOOL(false);
+
+  if (!tnumber_gist_query(&query, fcinfo))
+    PG_RETURN_BOOL(false);
 
   if (GIST_LEAF(entry))
     result = tbox_index_consistent_leaf(key, &query, strategy);
@@ -252,7 +267,7 @@ tnumber_gist_consistent(PG_FUNCTION_ARGS)
  * @param[inout] b Resulting box
  * @param[in] addon Input box
  */
-static void
+void
 tbox_adjust(TBOX *b, const TBOX *addon)
 {
   if (FLOAT8_LT(b->xmax, addon->xmax))
@@ -334,6 +349,47 @@ tnumber_gist_decompress(PG_FUNCTION_ARGS)
 }
 #endif
 
+/*****************************************************************************
+ * GiST compress and fetch methods for temporal boxes
+ *
+ * Since PostgreSQL 11 the compress method is optional and an operator class
+ * without it supports index-only scans. In previous versions the identity
+ * functions below are needed so that expression indexes such as
+ *   CREATE INDEX ON department USING gist(tbox(noemps));
+ * can answer the queries on the bounding boxes with index-only scans.
+ *****************************************************************************/
+
+#if MOBDB_PGSQL_VERSION < 110000
+PG_FUNCTION_INFO_V1(tbox_gist_compress);
+/**
+ * GiST compress method for temporal boxes
+ */
+PGDLLEXPORT Datum
+tbox_gist_compress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  if (entry->leafkey)
+  {
+    GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+    gistentryinit(*retval, entry->key, entry->rel, entry->page,
+      entry->offset, false);
+    PG_RETURN_POINTER(retval);
+  }
+  PG_RETURN_POINTER(entry);
+}
+
+PG_FUNCTION_INFO_V1(tbox_gist_fetch);
+/**
+ * GiST fetch method for temporal boxes
+ */
+PGDLLEXPORT Datum
+tbox_gist_fetch(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  PG_RETURN_POINTER(entry);
+}
+#endif
+
 /*****************************************************************************
  * GiST penalty method
  *****************************************************************************/
@@ -1046,57 +1102,17 @@ tbox_gist_same(PG_FUNCTION_ARGS)
  * GiST distance method
  *****************************************************************************/
 
-/**
- * Returns the nearest approach distance between the temporal boxes
- * (internal function)
- */
-double
-NAD_tbox_tbox_internal(const TBOX *box1, const TBOX *box2)
-{
-  /* Test the validity of the arguments */
-  ensure_has_X_tbox(box1); ensure_has_X_tbox(box2);
-  /* Project the boxes to their common timespan */
-  bool hast = MOBDB_FLAGS_GET_T(box1->flags) && MOBDB_FLAGS_GET_T(box2->flags);
-  Period p1, p2;
-  Period *inter;
-  if (hast)
-  {
-    period_set(&p1, box1->tmin, box1->tmax, true, true);
-    period_set(&p2, box2->tmin, box2->tmax, true, true);
-    inter = intersection_period_period_internal(&p1, &p2);
-    if (!inter)
-      return DBL_MAX;
-  }
-
-  /* Convert the boxes to ranges */
-  RangeType *range1 = range_make(Float8GetDatum(box1->xmin),
-    Float8GetDatum(box1->xmax), true, true, FLOAT8OID);
-  RangeType *range2 = range_make(Float8GetDatum(box2->xmin),
-    Float8GetDatum(box2->xmax), true, true, FLOAT8OID);
-  TypeCacheEntry *typcache = lookup_type_cache(range1->rangetypid,
-    TYPECACHE_RANGE_INFO);
-  /* Compute the result */
-  double result;
-  if (range_overlaps_internal(typcache, range1, range2))
-    result = DBL_MAX;
-  else if (range_before_internal(typcache, range1, range2))
-    result = box2->tmin - box1->tmax;
-  else
-    /* range_after_internal(typcache, range1, range2) */
-    result = box1->tmin - box2->tmax;
-
-  pfree(range1); pfree(range2);
-  if (hast)
-    pfree(inter);
-  return result;
-}
-
 PG_FUNCTION_INFO_V1(tbox_gist_distance);
 /**
  * GiST support function. Take in a query and an entry and return the "distance"
  * between them.
-*/
-Datum
+ *
+ * The query is a number, a temporal box, or a temporal number. When the
+ * query has a time dimension, the keys whose timespan does not overlap the
+ * one of the query are at an infinite distance, so that the ordering is
+ * restricted to this timespan.
+ */
+PGDLLEXPORT Datum
 tbox_gist_distance(PG_FUNCTION_ARGS)
 {
   GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
@@ -1104,59 +1120,125 @@ tbox_gist_distance(PG_FUNCTION_ARGS)
   bool *recheck = (bool *) PG_GETARG_POINTER(4);
   TBOX *key = (TBOX *) DatumGetPointer(entry->key);
   TBOX query;
-  double distance;
 
   /* The index is lossy for leaf levels */
   if (GIST_LEAF(entry))
     *recheck = true;
 
-  if (key == NULL)
+  /* Keys of temporal boxes may not have value dimension */
+  if (key == NULL || ! MOBDB_FLAGS_GET_X(key->flags))
     PG_RETURN_FLOAT8(DBL_MAX);
 
-  /*
-   * Transform the query into a box initializing the dimensions that must
-   * not be taken into account by the operators to infinity.
-   */
+  /* Transform the query into a box */
   memset(&query, 0, sizeof(TBOX));
-  if (tnumber_range_type(subtype))
-  {
-#if MOBDB_PGSQL_VERSION < 110000
-    RangeType  *range = PG_GETARG_RANGE(1);
-#else
-    RangeType  *range = PG_GETARG_RANGE_P(1);
-#endif
-    if (range == NULL)
-      PG_RETURN_FLOAT8(DBL_MAX);
-    /* Return false on empty range */
-    char flags = range_get_flags(range);
-    if (flags & RANGE_EMPTY)
-      PG_RETURN_BOOL(false);
-    range_to_tbox_internal(&query, range);
-    PG_FREE_IF_COPY(range, 1);
-  }
+  if (tnumber_base_type(subtype))
+    number_to_box(&query, PG_GETARG_DATUM(1), subtype);
   else if (subtype == type_oid(T_TBOX))
-  {
-    TBOX *box = PG_GETARG_TBOX_P(1);
-    if (box == NULL)
-      PG_RETURN_FLOAT8(DBL_MAX);
-    memcpy(&query, box, sizeof(TBOX));
-  }
-  else if (tnumber_base_type(subtype))
-  {
-    Temporal *temp = PG_GETARG_TEMPORAL(1);
-    if (temp == NULL)
-      PG_RETURN_FLOAT8(DBL_MAX);
-    temporal_bbox(&query, temp);
-    PG_FREE_IF_COPY(temp, 1);
-  }
+    memcpy(&query, PG_GETARG_TBOX_P(1), sizeof(TBOX));
+  else if (tnumber_type(subtype))
+    temporal_bbox_slice(&query, PG_GETARG_DATUM(1));
   else
     elog(ERROR, "Unsupported subtype for indexing: %d", subtype);
 
   /* Since we only have boxes we'll return the minimum possible distance,
    * and let the recheck sort things out in the case of leaves */
-  distance = NAD_tbox_tbox_internal(key, &query);
+  PG_RETURN_FLOAT8(NAD_tbox_tbox_internal(key, &query));
+}
+
+/*****************************************************************************
+ * Compact GiST index
+ *
+ * In the compact operator classes the value bounds of the keys are stored
+ * as float4 values rounded outward, so that the key of a temporal number
+ * always contains its bounding box. Since a leaf key may be larger than the
+ * bounding box, the tests for the leaves are those for the internal nodes
+ * and the index is always lossy. The keys are decompressed into temporal
+ * boxes so that the other support functions are those of the default
+ * operator classes.
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(tnumber_gist_compact_consistent);
+/**
+ * GiST consistent method for the compact operator classes
+ */
+PGDLLEXPORT Datum
+tnumber_gist_compact_consistent(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+  bool *recheck = (bool *) PG_GETARG_POINTER(4);
+  TBOX *key = DatumGetTboxP(entry->key), query;
+
+  /* The keys are larger than the bounding boxes */
+  *recheck = true;
+
+  if (key == NULL)
+    PG_RETURN_BOOL(false);
+
+  if (!tnumber_gist_query(&query, fcinfo))
+    PG_RETURN_BOOL(false);
 
-  PG_RETURN_FLOAT8(distance);
+  PG_RETURN_BOOL(tbox_gist_consistent_internal(key, &query, strategy));
+}
+
+PG_FUNCTION_INFO_V1(tnumber_gist_compact_compress);
+/**
+ * GiST compress method for the compact operator classes
+ *
+ * Both the leaf keys, which are temporal numbers, and the keys of the
+ * internal nodes, which are temporal boxes, are compressed.
+ */
+PGDLLEXPORT Datum
+tnumber_gist_compact_compress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+  TBOX box;
+  TBOXF boxf;
+  if (entry->leafkey)
+  {
+    memset(&box, 0, sizeof(TBOX));
+    temporal_bbox(&box, DatumGetTemporal(entry->key));
+  }
+  else
+    memcpy(&box, DatumGetTboxP(entry->key), sizeof(TBOX));
+  memset(&boxf, 0, sizeof(TBOXF));
+  boxf.xmin = float4_round_down(box.xmin);
+  boxf.xmax = float4_round_up(box.xmax);
+  boxf.tmin = box.tmin;
+  boxf.tmax = box.tmax;
+  boxf.flags = box.flags;
+  bytea *key = palloc(VARHDRSZ + TBOXF_SIZE);
+  SET_VARSIZE(key, VARHDRSZ + TBOXF_SIZE);
+  memcpy(VARDATA(key), &boxf, TBOXF_SIZE);
+  gistentryinit(*retval, PointerGetDatum(key), entry->rel, entry->page,
+    entry->offset, false);
+  PG_RETURN_POINTER(retval);
+}
+
+PG_FUNCTION_INFO_V1(tbox_gist_compact_decompress);
+/**
+ * GiST decompress method for the compact operator classes (result in a
+ * temporal box)
+ */
+PGDLLEXPORT Datum
+tbox_gist_compact_decompress(PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+  GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+  bytea *key = (bytea *) PG_DETOAST_DATUM_PACKED(entry->key);
+  TBOX *box = palloc0(sizeof(TBOX));
+  TBOXF boxf;
+  memset(&boxf, 0, sizeof(TBOXF));
+  memcpy(&boxf, VARDATA_ANY(key), TBOXF_SIZE);
+  box->xmin = boxf.xmin;
+  box->xmax = boxf.xmax;
+  box->tmin = boxf.tmin;
+  box->tmax = boxf.tmax;
+  box->flags = boxf.flags;
+  gistentryinit(*retval, PointerGetDatum(box), entry->rel, entry->page,
+    entry->offset, entry->leafkey);
+  PG_RETURN_POINTER(retval);
 }
 
 /*****************************************************************************/
@@ -21,6 +21,7 @@
 #include "temporaltypes.h"
 #include "temporal_util.h"
 #include "lifting.h"
+#include "temporal_expanded.h"
 
 /*****************************************************************************
  * Mathematical functions on datums
@@ -100,6 +101,46 @@ datum_div(Datum l, Datum r, Oid typel, Oid typer)
   return result;
 }
 
+/*
+ * Versions of the functions above for two float8 values. They are selected
+ * once per call of the lifted operators on temporal floats so that the
+ * dispatch on the types is not done for every pair of values.
+ */
+
+#define DATUM_ARITHOP_FLOAT8(name, op) \
+static Datum \
+name(Datum l, Datum r, Oid typel, Oid typer) \
+{ \
+  return Float8GetDatum(DatumGetFloat8(l) op DatumGetFloat8(r)); \
+}
+
+DATUM_ARITHOP_FLOAT8(datum_add_float8, +)
+DATUM_ARITHOP_FLOAT8(datum_sub_float8, -)
+DATUM_ARITHOP_FLOAT8(datum_mult_float8, *)
+DATUM_ARITHOP_FLOAT8(datum_div_float8, /)
+
+/**
+ * Returns the arithmetic function applied to the values of the given types
+ *
+ * @param[in] func Generic arithmetic function
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] typel, typer Oids of the types of the arguments
+ */
+static Datum (*arithop_func(Datum (*func)(Datum, Datum, Oid, Oid),
+  TArithmetic oper, Oid typel, Oid typer))(Datum, Datum, Oid, Oid)
+{
+  if (typel != FLOAT8OID || typer != FLOAT8OID)
+    return func;
+  if (oper == ADD)
+    return &datum_add_float8;
+  else if (oper == SUB)
+    return &datum_sub_float8;
+  else if (oper == MULT)
+    return &datum_mult_float8;
+  else /* oper == DIV */
+    return &datum_div_float8;
+}
+
 /**
  * Round the number to the number of decimal places
  */
@@ -157,10 +198,168 @@ tnumberseq_mult_maxmin_at_timestamp(const TInstant *start1, const TInstant *end1
   return true;
 }
 
+/*****************************************************************************
+ * Arithmetic operators on the instants of temporal numbers
+ * The operators on a temporal instant set or sequence and a number, or on
+ * two such temporal numbers that have the same instants, do not need to
+ * synchronize their arguments. They compute their result on the instants
+ * of their arguments and return it as an expanded value, which is updated
+ * in place by the enclosing arithmetic operator of the expression, if any.
+ *****************************************************************************/
+
+/**
+ * Structure to represent the instants of a temporal instant set or
+ * sequence number, either flat or expanded
+ */
+typedef struct
+{
+  int16 duration;        /**< INSTANTSET or SEQUENCE */
+  int count;             /**< number of instants */
+  TInstant **instants;   /**< instants */
+  bool lower_inc;        /**< lower bound of a sequence */
+  bool upper_inc;        /**< upper bound of a sequence */
+  bool linear;           /**< interpolation of a sequence */
+} TNumberInstants;
+
+/**
+ * Set the instants of the flat temporal instant set or sequence number
+ */
+static void
+tnumber_instants_flat(TNumberInstants *result, const Temporal *temp)
+{
+  result->duration = temp->duration;
+  result->linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    result->count = ti->count;
+    result->instants = tinstantset_instants(ti);
+    result->lower_inc = result->upper_inc = true;
+  }
+  else /* temp->duration == SEQUENCE */
+  {
+    const TSequence *seq = (const TSequence *) temp;
+    result->count = seq->count;
+    result->instants = tsequence_instants(seq);
+    result->lower_inc = seq->period.lower_inc;
+    result->upper_inc = seq->period.upper_inc;
+  }
+  return;
+}
+
+/**
+ * Set the instants of the expanded temporal number
+ */
+static void
+tnumber_instants_expanded(TNumberInstants *result, ExpandedTemporal *eot)
+{
+  result->duration = eot->duration;
+  result->count = eot->count;
+  result->instants = eot->instants;
+  result->lower_inc = eot->lower_inc;
+  result->upper_inc = eot->upper_inc;
+  result->linear = eot->linear;
+  return;
+}
+
+/**
+ * Returns true if the two temporal numbers have the same instants, bounds,
+ * and interpolation, that is, if they are synchronized
+ */
+static bool
+tnumber_instants_sync(const TNumberInstants *ti1, const TNumberInstants *ti2)
+{
+  if (ti1->duration != ti2->duration || ti1->count != ti2->count ||
+    ti1->lower_inc != ti2->lower_inc || ti1->upper_inc != ti2->upper_inc ||
+    ti1->linear != ti2->linear)
+    return false;
+  for (int i = 0; i < ti1->count; i++)
+  {
+    if (ti1->instants[i]->t != ti2->instants[i]->t)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Applies the arithmetic function to the instants of the temporal number
+ * and the number or the instants of the second temporal number
+ *
+ * @param[in] func Arithmetic function
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] ti1 Instants of the temporal number
+ * @param[in] ti2 Instants of the second temporal number, NULL if the
+ * second argument is a number
+ * @param[in] value Number
+ * @param[in] valuetypid Oid of the type of the number
+ * @param[in] invert True when the number is the first argument of the
+ * function
+ * @param[in] restypid Oid of the base type of the result
+ * @param[in] eot Expanded value of the instants of the temporal number,
+ * which is updated in place, NULL if the result is a new expanded value
+ * @pre The temporal numbers are synchronized
+ */
+static Datum
+arithop_tnumber_instants(Datum (*func)(Datum, Datum, Oid, Oid),
+  TArithmetic oper, const TNumberInstants *ti1, const TNumberInstants *ti2,
+  Datum value, Oid valuetypid, bool invert, Oid restypid,
+  ExpandedTemporal *eot)
+{
+  Oid valuetypid1 = ti1->instants[0]->valuetypid;
+  Oid valuetypid2 = ti2 != NULL ? ti2->instants[0]->valuetypid : valuetypid;
+  Datum (*func1)(Datum, Datum, Oid, Oid) = invert ?
+    arithop_func(func, oper, valuetypid2, valuetypid1) :
+    arithop_func(func, oper, valuetypid1, valuetypid2);
+  ExpandedTemporal *result = eot;
+  if (result == NULL)
+  {
+    result = expanded_temporal_new(ti1->duration, ti1->count,
+      CurrentMemoryContext);
+    result->count = ti1->count;
+    result->lower_inc = ti1->lower_inc;
+    result->upper_inc = ti1->upper_inc;
+    result->normalize = NORMALIZE;
+  }
+  for (int i = 0; i < ti1->count; i++)
+  {
+    const TInstant *inst = ti1->instants[i];
+    Datum value1 = tinstant_value(inst);
+    Datum value2 = ti2 != NULL ? tinstant_value(ti2->instants[i]) : value;
+    Datum resvalue = invert ?
+      func1(value2, value1, valuetypid2, valuetypid1) :
+      func1(value1, value2, valuetypid1, valuetypid2);
+    if (eot != NULL)
+      expanded_temporal_set_value(eot, i, resvalue, restypid);
+    else
+    {
+      MemoryContext oldcontext =
+        MemoryContextSwitchTo(result->hdr.eoh_context);
+      result->instants[i] = tinstant_make(resvalue, inst->t, restypid);
+      MemoryContextSwitchTo(oldcontext);
+    }
+  }
+  result->linear = ti1->linear && linear_interpolation(restypid);
+  return EOHPGetRWDatum(&result->hdr);
+}
+
 /*****************************************************************************
  * Generic functions
  *****************************************************************************/
 
+/**
+ * Ensure that the number is not zero when it is the denominator of a
+ * division
+ */
+static void
+ensure_nonzero_base(Datum value, Oid valuetypid)
+{
+  double d = datum_double(value, valuetypid);
+  if (fabs(d) < EPSILON)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("Division by zero")));
+  return;
+}
+
 /**
  * Generic arithmetic operator on a temporal number and a number
  *
@@ -189,17 +388,13 @@ arithop_tnumber_base1(FunctionCallInfo fcinfo,
           errmsg("Division by zero")));
     }
     else
-    {
-      double d = datum_double(value, valuetypid);
-      if (fabs(d) < EPSILON)
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-          errmsg("Division by zero")));
-    }
+      ensure_nonzero_base(value, valuetypid);
   }
 
   Oid temptypid = get_fn_expr_rettype(fcinfo->flinfo);
   LiftedFunctionInfo lfinfo;
-  lfinfo.func = (varfunc) func;
+  lfinfo.func = (varfunc) arithop_func(func, oper, temp->valuetypid,
+    valuetypid);
   lfinfo.numparam = 4;
   lfinfo.restypid = base_oid_from_temporal(temptypid);
   /* This parameter is not used for tnumber <op> base */
@@ -209,6 +404,70 @@ arithop_tnumber_base1(FunctionCallInfo fcinfo,
   return tfunc_temporal_base(temp, value, valuetypid, (Datum) NULL, lfinfo);
 }
 
+/**
+ * Generic arithmetic operator on a temporal number and a number, where
+ * the number is the first argument when invert is true
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] func Arithmetic function
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] invert True when the base value is the first argument
+ * of the function
+ */
+static Datum
+arithop_tnumber_base2(FunctionCallInfo fcinfo,
+  Datum (*func)(Datum, Datum, Oid, Oid), TArithmetic oper, bool invert)
+{
+  int temparg = invert ? 1 : 0;
+  int valuearg = invert ? 0 : 1;
+  Datum value = PG_GETARG_DATUM(valuearg);
+  Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, valuearg);
+  Oid restypid = base_oid_from_temporal(get_fn_expr_rettype(fcinfo->flinfo));
+  TNumberInstants ti;
+
+  /* The temporal number is an intermediate result of the expression,
+   * except for the division by a temporal number which needs the segments
+   * of the flat value to find its zeros */
+  ExpandedTemporal *eot = DatumGetExpandedTemporalRW(
+    PG_GETARG_DATUM(temparg));
+  if (eot != NULL && ! (oper == DIV && invert))
+  {
+    ensure_tnumber_base_type(valuetypid);
+    if (oper == DIV)
+      ensure_nonzero_base(value, valuetypid);
+    tnumber_instants_expanded(&ti, eot);
+    PG_RETURN_DATUM(arithop_tnumber_instants(func, oper, &ti, NULL, value,
+      valuetypid, invert, restypid, eot));
+  }
+
+  Temporal *temp = PG_GETARG_TEMPORAL(temparg);
+  Datum result;
+  if (temporal_expandable(temp))
+  {
+    ensure_tnumber_base_type(valuetypid);
+    if (oper == DIV)
+    {
+      if (invert)
+      {
+        if (temporal_ever_eq_internal(temp, Float8GetDatum(0.0)))
+          ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+            errmsg("Division by zero")));
+      }
+      else
+        ensure_nonzero_base(value, valuetypid);
+    }
+    tnumber_instants_flat(&ti, temp);
+    result = arithop_tnumber_instants(func, oper, &ti, NULL, value,
+      valuetypid, invert, restypid, NULL);
+    pfree(ti.instants);
+  }
+  else
+    result = PointerGetDatum(arithop_tnumber_base1(fcinfo, func, oper, temp,
+      value, valuetypid, invert));
+  PG_FREE_IF_COPY(temp, temparg);
+  PG_RETURN_DATUM(result);
+}
+
 /**
  * Generic arithmetic operator on a number an a temporal number
  *
@@ -220,13 +479,7 @@ Datum
 arithop_base_tnumber(FunctionCallInfo fcinfo,
   Datum (*func)(Datum, Datum, Oid, Oid), TArithmetic oper)
 {
-  Datum value = PG_GETARG_DATUM(0);
-  Temporal *temp = PG_GETARG_TEMPORAL(1);
-  Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 0);
-  Temporal *result = arithop_tnumber_base1(fcinfo, func, oper,
-    temp, value, valuetypid, INVERT);
-  PG_FREE_IF_COPY(temp, 1);
-  PG_RETURN_POINTER(result);
+  return arithop_tnumber_base2(fcinfo, func, oper, INVERT);
 }
 
 /**
@@ -240,13 +493,45 @@ Datum
 arithop_tnumber_base(FunctionCallInfo fcinfo,
   Datum (*func)(Datum, Datum, Oid, Oid), TArithmetic oper)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
-  Datum value = PG_GETARG_DATUM(1);
-  Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
-  Temporal *result = arithop_tnumber_base1(fcinfo, func, oper,
-    temp, value, valuetypid, INVERT_NO);
-  PG_FREE_IF_COPY(temp, 0);
-  PG_RETURN_POINTER(result);
+  return arithop_tnumber_base2(fcinfo, func, oper, INVERT_NO);
+}
+
+/**
+ * Generic arithmetic operator on two synchronized temporal numbers
+ *
+ * @param[in] func Arithmetic function
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] ti1,ti2 Instants of the temporal numbers
+ * @param[in] restypid Oid of the base type of the result
+ * @param[in] eot Expanded value of the first temporal number, which is
+ * updated in place, NULL if the result is a new expanded value
+ * @result False if the temporal numbers are not synchronized or if the
+ * result has turning points, in which case the arguments must be
+ * synchronized by the lifting functions
+ */
+static bool
+arithop_tnumber_tnumber_sync(Datum (*func)(Datum, Datum, Oid, Oid),
+  TArithmetic oper, const TNumberInstants *ti1, const TNumberInstants *ti2,
+  Oid restypid, ExpandedTemporal *eot, Datum *result)
+{
+  if ((oper == MULT || oper == DIV) && ti1->linear && ti2->linear)
+    return false;
+  if (! tnumber_instants_sync(ti1, ti2))
+    return false;
+  /* If division test whether the denominator is ever zero */
+  if (oper == DIV)
+  {
+    for (int i = 0; i < ti2->count; i++)
+    {
+      const TInstant *inst = ti2->instants[i];
+      if (datum_double(tinstant_value(inst), inst->valuetypid) == 0.0)
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+          errmsg("Division by zero")));
+    }
+  }
+  *result = arithop_tnumber_instants(func, oper, ti1, ti2, (Datum) 0,
+    InvalidOid, INVERT_NO, restypid, eot);
+  return true;
 }
 
 /**
@@ -263,8 +548,48 @@ arithop_tnumber_tnumber(FunctionCallInfo fcinfo,
   bool (*tpfunc)(const TInstant *, const TInstant *,
     const TInstant *, const TInstant *, TimestampTz *))
 {
-  Temporal *temp1 = PG_GETARG_TEMPORAL(0);
+  Oid temptypid = get_fn_expr_rettype(fcinfo->flinfo);
+  Oid restypid = base_oid_from_temporal(temptypid);
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
+  TNumberInstants ti1, ti2;
+  Datum syncresult;
+  bool expandable2 = temporal_expandable(temp2);
+  if (expandable2)
+    tnumber_instants_flat(&ti2, temp2);
+
+  /* The first temporal number is an intermediate result of the expression
+   * that is synchronized with the second one */
+  ExpandedTemporal *eot = DatumGetExpandedTemporalRW(PG_GETARG_DATUM(0));
+  if (eot != NULL && expandable2)
+  {
+    tnumber_instants_expanded(&ti1, eot);
+    if (arithop_tnumber_tnumber_sync(func, oper, &ti1, &ti2, restypid, eot,
+        &syncresult))
+    {
+      pfree(ti2.instants);
+      PG_FREE_IF_COPY(temp2, 1);
+      PG_RETURN_DATUM(syncresult);
+    }
+  }
+
+  Temporal *temp1 = PG_GETARG_TEMPORAL(0);
+  if (expandable2 && temporal_expandable(temp1))
+  {
+    tnumber_instants_flat(&ti1, temp1);
+    bool sync = arithop_tnumber_tnumber_sync(func, oper, &ti1, &ti2,
+      restypid, NULL, &syncresult);
+    pfree(ti1.instants);
+    if (sync)
+    {
+      pfree(ti2.instants);
+      PG_FREE_IF_COPY(temp1, 0);
+      PG_FREE_IF_COPY(temp2, 1);
+      PG_RETURN_DATUM(syncresult);
+    }
+  }
+  if (expandable2)
+    pfree(ti2.instants);
+
   bool linear1 = MOBDB_FLAGS_GET_LINEAR(temp1->flags);
   bool linear2 = MOBDB_FLAGS_GET_LINEAR(temp2->flags);
 
@@ -281,11 +606,11 @@ arithop_tnumber_tnumber(FunctionCallInfo fcinfo,
         errmsg("Division by zero")));
   }
 
-  Oid temptypid = get_fn_expr_rettype(fcinfo->flinfo);
   LiftedFunctionInfo lfinfo;
-  lfinfo.func = (varfunc) func;
+  lfinfo.func = (varfunc) arithop_func(func, oper, temp1->valuetypid,
+    temp2->valuetypid);
   lfinfo.numparam = 4;
-  lfinfo.restypid = base_oid_from_temporal(temptypid);
+  lfinfo.restypid = restypid;
   lfinfo.reslinear = linear1 || linear2;
   lfinfo.invert = INVERT_NO;
   lfinfo.discont = CONTINUOUS;
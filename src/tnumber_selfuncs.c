@@ -34,6 +34,8 @@
 #include "time_selfuncs.h"
 #include "temporal_analyze.h"
 #include "temporal_selfuncs.h"
+#include "temporal_statscache.h"
+#include "tpoint_selfuncs.h"
 
 /*****************************************************************************
  * Functions copied from PostgreSQL file rangetypes_selfuncs.c since they
@@ -408,6 +410,59 @@ calc_hist_selectivity_contains(TypeCacheEntry *typcache,
   return sum_frac;
 }
 
+/**
+ * Get the histograms of the lower and upper bounds of the value ranges of a
+ * column. The bounds are decoded once and kept in the statistics cache, so
+ * they must not be freed. Returns the number of bounds, or -1 if the
+ * histogram is not available.
+ */
+static int
+tnumber_hist_bounds(TypeCacheEntry *typcache, VariableStatData *vardata,
+  RangeBound **hist_lower, RangeBound **hist_upper)
+{
+  CachedStatsSlot *hslot;
+  bool empty;
+
+  /* Can't use the histogram with insecure range support functions */
+  if (!statistic_proc_security_check(vardata,
+                     typcache->rng_cmp_proc_finfo.fn_oid))
+    return -1;
+  hslot = statscache_slot(vardata, STATISTIC_KIND_BOUNDS_HISTOGRAM,
+    ATTSTATSSLOT_VALUES);
+  if (hslot == NULL)
+    return -1;
+
+  if (hslot->hist_lower == NULL)
+  {
+    /*
+     * Convert histogram of ranges into histograms of its lower and upper
+     * bounds. The bounds point into the values of the cached slot.
+     */
+    RangeBound *lower = MemoryContextAlloc(hslot->mcxt,
+      sizeof(RangeBound) * Max(hslot->nvalues, 1));
+    RangeBound *upper = MemoryContextAlloc(hslot->mcxt,
+      sizeof(RangeBound) * Max(hslot->nvalues, 1));
+    for (int i = 0; i < hslot->nvalues; i++)
+    {
+#if MOBDB_PGSQL_VERSION < 110000
+      range_deserialize(typcache, DatumGetRangeType(hslot->values[i]),
+                &lower[i], &upper[i], &empty);
+#else
+      range_deserialize(typcache, DatumGetRangeTypeP(hslot->values[i]),
+                &lower[i], &upper[i], &empty);
+#endif
+      /* The histogram should not contain any empty ranges */
+      if (empty)
+        elog(ERROR, "bounds histogram contains an empty range");
+    }
+    hslot->hist_lower = lower;
+    hslot->hist_upper = upper;
+  }
+  *hist_lower = (RangeBound *) hslot->hist_lower;
+  *hist_upper = (RangeBound *) hslot->hist_upper;
+  return hslot->nvalues;
+}
+
 /**
  * Calculate range operator selectivity using histograms of range bounds.
  *
@@ -419,78 +474,40 @@ static double
 calc_hist_selectivity(TypeCacheEntry *typcache, VariableStatData *vardata,
             RangeType *constval, Oid operator)
 {
-  AttStatsSlot hslot;
-  AttStatsSlot lslot;
+  CachedStatsSlot *lslot;
   int      nhist;
   RangeBound *hist_lower;
   RangeBound *hist_upper;
-  int      i;
+  Datum     *length_hist_values = NULL;
+  int      length_hist_nvalues = 0;
   RangeBound  const_lower;
   RangeBound  const_upper;
   bool    empty;
   double    hist_selec;
 
   /* Can't use the histogram with insecure range support functions */
-  if (!statistic_proc_security_check(vardata,
-                     typcache->rng_cmp_proc_finfo.fn_oid))
-    return -1;
   if (OidIsValid(typcache->rng_subdiff_finfo.fn_oid) &&
     !statistic_proc_security_check(vardata,
                      typcache->rng_subdiff_finfo.fn_oid))
     return -1;
 
-  /* Try to get histogram of ranges */
-  if (!(HeapTupleIsValid(vardata->statsTuple) &&
-      get_attstatsslot(&hslot, vardata->statsTuple,
-               STATISTIC_KIND_BOUNDS_HISTOGRAM, InvalidOid,
-               ATTSTATSSLOT_VALUES)))
+  /* Try to get histograms of range bounds */
+  nhist = tnumber_hist_bounds(typcache, vardata, &hist_lower, &hist_upper);
+  if (nhist < 0)
     return -1.0;
 
-  /*
-   * Convert histogram of ranges into histograms of its lower and upper
-   * bounds.
-   */
-  nhist = hslot.nvalues;
-  hist_lower = (RangeBound *) palloc(sizeof(RangeBound) * nhist);
-  hist_upper = (RangeBound *) palloc(sizeof(RangeBound) * nhist);
-  for (i = 0; i < nhist; i++)
-  {
-#if MOBDB_PGSQL_VERSION < 110000
-    range_deserialize(typcache, DatumGetRangeType(hslot.values[i]),
-              &hist_lower[i], &hist_upper[i], &empty);
-#else
-    range_deserialize(typcache, DatumGetRangeTypeP(hslot.values[i]),
-              &hist_lower[i], &hist_upper[i], &empty);
-#endif
-    /* The histogram should not contain any empty ranges */
-    if (empty)
-      elog(ERROR, "bounds histogram contains an empty range");
-  }
-
   /* @> and @< also need a histogram of range lengths */
   if (operator == OID_RANGE_CONTAINS_OP ||
     operator == OID_RANGE_CONTAINED_OP)
   {
-    if (!(HeapTupleIsValid(vardata->statsTuple) &&
-        get_attstatsslot(&lslot, vardata->statsTuple,
-                 STATISTIC_KIND_RANGE_LENGTH_HISTOGRAM,
-                 InvalidOid,
-                 ATTSTATSSLOT_VALUES)))
-    {
-      free_attstatsslot(&hslot);
-      return -1.0;
-    }
-
+    lslot = statscache_slot(vardata, STATISTIC_KIND_RANGE_LENGTH_HISTOGRAM,
+      ATTSTATSSLOT_VALUES);
     /* check that it's a histogram, not just a dummy entry */
-    if (lslot.nvalues < 2)
-    {
-      free_attstatsslot(&lslot);
-      free_attstatsslot(&hslot);
+    if (lslot == NULL || lslot->nvalues < 2)
       return -1.0;
-    }
+    length_hist_values = lslot->values;
+    length_hist_nvalues = lslot->nvalues;
   }
-  else
-    memset(&lslot, 0, sizeof(lslot));
 
   /* Extract the bounds of the constant value. */
   range_deserialize(typcache, constval, &const_lower, &const_upper, &empty);
@@ -590,7 +607,7 @@ calc_hist_selectivity(TypeCacheEntry *typcache, VariableStatData *vardata,
       hist_selec =
         calc_hist_selectivity_contains(typcache, &const_lower,
                          &const_upper, hist_lower, nhist,
-                         lslot.values, lslot.nvalues);
+                         length_hist_values, length_hist_nvalues);
       break;
 
     case OID_RANGE_CONTAINED_OP:
@@ -615,7 +632,7 @@ calc_hist_selectivity(TypeCacheEntry *typcache, VariableStatData *vardata,
         hist_selec =
           calc_hist_selectivity_contained(typcache, &const_lower,
                           &const_upper, hist_lower, nhist,
-                          lslot.values, lslot.nvalues);
+                          length_hist_values, length_hist_nvalues);
       }
       break;
 
@@ -625,9 +642,6 @@ calc_hist_selectivity(TypeCacheEntry *typcache, VariableStatData *vardata,
       break;
   }
 
-  free_attstatsslot(&lslot);
-  free_attstatsslot(&hslot);
-
   return hist_selec;
 }
 
@@ -768,6 +782,36 @@ default_tnumber_selectivity(CachedOp operator)
   }
 }
 
+/**
+ * Returns an estimate of the selectivity of a search box having both the
+ * value and the time dimensions for the bounding box operators by looking at
+ * the joint value-time histogram, or -1 if the histogram is not available.
+ *
+ * Contrary to the product of the selectivities of the value and the time
+ * dimensions, the estimate takes into account how the values are distributed
+ * over time, e.g., the high speeds of vehicles at night.
+ */
+static float8
+calc_value_time_selectivity(VariableStatData *vardata, const TBOX *box)
+{
+  ND_STATS *nd_stats;
+  ND_BOX nd_box;
+  float8 selectivity;
+
+  nd_stats = nd_stats_from_vardata(vardata, STATISTIC_KIND_NDT);
+  if (nd_stats == NULL)
+    return -1;
+  if ((int) nd_stats->ndims != 2)
+  {
+    pfree(nd_stats);
+    return -1;
+  }
+  nd_box_from_tbox(box, &nd_box);
+  selectivity = nd_stats_selectivity(nd_stats, &nd_box);
+  pfree(nd_stats);
+  return selectivity;
+}
+
 /**
  * Returns an estimate of the selectivity of the temporal search box and the
  * operator for columns of temporal numbers. For the traditional comparison
@@ -846,6 +890,20 @@ tnumber_sel_internal(PlannerInfo *root, VariableStatData *vardata, TBOX *box,
     cachedOp == LT_OP || cachedOp == LE_OP ||
     cachedOp == GT_OP || cachedOp == GE_OP)
   {
+    /* The joint histogram is used for the bounding box operators when the
+     * box has both dimensions */
+    if (MOBDB_FLAGS_GET_X(box->flags) && MOBDB_FLAGS_GET_T(box->flags) &&
+      (cachedOp == OVERLAPS_OP || cachedOp == CONTAINS_OP ||
+       cachedOp == CONTAINED_OP))
+    {
+      double valuetime_selec = calc_value_time_selectivity(vardata, box);
+      if (valuetime_selec >= 0)
+      {
+        if (range != NULL)
+          pfree(range);
+        return valuetime_selec;
+      }
+    }
     /* Selectivity for the value dimension */
     if (MOBDB_FLAGS_GET_X(box->flags) && range != NULL)
       selec *= calc_hist_selectivity(typcache, vardata, range,
@@ -878,6 +936,187 @@ tnumber_sel_internal(PlannerInfo *root, VariableStatData *vardata, TBOX *box,
   return selec;
 }
 
+/*****************************************************************************
+ * Ever/always comparisons
+ *****************************************************************************/
+
+/**
+ * Returns the fraction of the bounds of the histogram that are less than
+ * (or equal to, if inclusive is true) the value
+ *
+ * The lower bounds of the value ranges are the minimum values of the
+ * temporal numbers. The upper bounds are their maximum values for float
+ * ranges, and their maximum values plus one for the canonical integer
+ * ranges, whose upper bound is exclusive.
+ */
+static double
+tnumber_hist_frac(TypeCacheEntry *typcache, RangeBound *hist, int nhist,
+  bool upper, Datum value, Oid valuetypid, bool inclusive)
+{
+  RangeBound bound;
+  bound.val = value;
+  bound.infinite = false;
+  bound.lower = ! upper;
+  if (! upper)
+  {
+    bound.inclusive = true;
+    return calc_hist_selectivity_scalar(typcache, &bound, hist, nhist,
+      inclusive);
+  }
+
+  /* The maximum is less than the value iff the upper bound is less than or
+   * equal to the exclusive bound at the value */
+  bound.inclusive = false;
+  if (inclusive)
+  {
+    if (valuetypid == INT4OID)
+    {
+      /* max <= value <=> max < value + 1 */
+      if (DatumGetInt32(value) == PG_INT32_MAX)
+        return 1.0;
+      bound.val = Int32GetDatum(DatumGetInt32(value) + 1);
+    }
+    else
+      bound.inclusive = true;
+  }
+  return calc_hist_selectivity_scalar(typcache, &bound, hist, nhist, true);
+}
+
+/**
+ * Estimate the selectivity of the ever/always comparison of a temporal
+ * number column and a value, as a fraction of the non-null rows
+ *
+ * A temporal number is ever less than a value iff its minimum value is
+ * less than it, and symmetrically for the other ever comparisons. A
+ * temporal number is ever equal to a value only if the value is between its
+ * minimum and maximum values, which is also sufficient for sequences with
+ * linear interpolation, and always equal to it iff both are equal to it.
+ * The minimum and maximum values are the bounds of the histogram of value
+ * ranges. Returns -1 if the histogram is not available.
+ *
+ * @param[in] vardata Information about the temporal column
+ * @param[in] value Value
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] cachedOp Comparison, which is EQ_OP, LT_OP, LE_OP, GT_OP,
+ * or GE_OP
+ * @param[in] ever True for an ever comparison, false for an always one,
+ * which is only possible for EQ_OP
+ */
+double
+tnumber_ever_sel_internal(VariableStatData *vardata, Datum value,
+  Oid valuetypid, CachedOp cachedOp, bool ever)
+{
+  Oid rangetypid = (valuetypid == INT4OID) ? type_oid(T_INTRANGE) :
+    type_oid(T_FLOATRANGE);
+  TypeCacheEntry *typcache = lookup_type_cache(rangetypid,
+    TYPECACHE_RANGE_INFO);
+  RangeBound *hist_lower, *hist_upper;
+  int nhist = tnumber_hist_bounds(typcache, vardata, &hist_lower,
+    &hist_upper);
+  double selec;
+
+  if (nhist < 2)
+    return -1.0;
+  switch (cachedOp)
+  {
+    case LT_OP:
+      /* min < value */
+      selec = tnumber_hist_frac(typcache, hist_lower, nhist, false, value,
+        valuetypid, false);
+      break;
+    case LE_OP:
+      /* min <= value */
+      selec = tnumber_hist_frac(typcache, hist_lower, nhist, false, value,
+        valuetypid, true);
+      break;
+    case GT_OP:
+      /* max > value */
+      selec = 1.0 - tnumber_hist_frac(typcache, hist_upper, nhist, true,
+        value, valuetypid, true);
+      break;
+    case GE_OP:
+      /* max >= value */
+      selec = 1.0 - tnumber_hist_frac(typcache, hist_upper, nhist, true,
+        value, valuetypid, false);
+      break;
+    default: /* EQ_OP */
+      if (ever)
+        /* min <= value <= max, where max < value implies min < value */
+        selec = tnumber_hist_frac(typcache, hist_lower, nhist, false, value,
+            valuetypid, true) -
+          tnumber_hist_frac(typcache, hist_upper, nhist, true, value,
+            valuetypid, false);
+      else
+        /* value <= min and max <= value, which is estimated by its lower
+         * bound P(max <= value) - P(min < value) */
+        selec = tnumber_hist_frac(typcache, hist_upper, nhist, true, value,
+            valuetypid, true) -
+          tnumber_hist_frac(typcache, hist_lower, nhist, false, value,
+            valuetypid, false);
+  }
+  CLAMP_PROBABILITY(selec);
+  return selec;
+}
+
+/*****************************************************************************
+ * Join selectivity
+ *****************************************************************************/
+
+/**
+ * Estimate the fraction of pairs of values of two columns such that the upper
+ * bound of the value range of the first one is less than the lower bound of
+ * the value range of the second one. The fraction of upper bounds that are
+ * less than a lower bound is averaged over the bins of the equi-depth
+ * histogram of lower bounds.
+ */
+static double
+tnumber_joinsel_left(TypeCacheEntry *typcache, RangeBound *hist_upper1,
+  int nhist1, RangeBound *hist_lower2, int nhist2)
+{
+  double sum_frac = 0.0, prev_frac, frac;
+  int i;
+
+  prev_frac = calc_hist_selectivity_scalar(typcache, &hist_lower2[0],
+    hist_upper1, nhist1, false);
+  for (i = 1; i < nhist2; i++)
+  {
+    frac = calc_hist_selectivity_scalar(typcache, &hist_lower2[i],
+      hist_upper1, nhist1, false);
+    sum_frac += (prev_frac + frac) / 2.0;
+    prev_frac = frac;
+  }
+  return sum_frac / (double) (nhist2 - 1);
+}
+
+/**
+ * Estimate the join selectivity of the overlaps operator of the value
+ * dimension between two columns using their histograms of value ranges.
+ * Returns -1 if the histograms are not available.
+ */
+static double
+tnumber_joinsel_value(TypeCacheEntry *typcache, VariableStatData *vardata1,
+  VariableStatData *vardata2)
+{
+  RangeBound *hist_lower1, *hist_upper1, *hist_lower2, *hist_upper2;
+  int nhist1, nhist2;
+  double selec;
+
+  nhist1 = tnumber_hist_bounds(typcache, vardata1, &hist_lower1, &hist_upper1);
+  nhist2 = tnumber_hist_bounds(typcache, vardata2, &hist_lower2, &hist_upper2);
+  if (nhist1 < 2 || nhist2 < 2)
+    return -1.0;
+
+  /*
+   * A && B <=> NOT (A << B OR A >> B), where the two events are mutually
+   * exclusive, as for the restriction selectivity.
+   */
+  selec = 1.0 - tnumber_joinsel_left(typcache, hist_upper1, nhist1,
+      hist_lower2, nhist2)
+    - tnumber_joinsel_left(typcache, hist_upper2, nhist2, hist_lower1, nhist1);
+  CLAMP_PROBABILITY(selec);
+  return selec;
+}
+
 /*****************************************************************************/
 
 PG_FUNCTION_INFO_V1(tnumber_sel);
@@ -976,11 +1215,62 @@ tnumber_sel(PG_FUNCTION_ARGS)
 PG_FUNCTION_INFO_V1(tnumber_joinsel);
 /**
  * Estimate the join selectivity value of the operators for temporal numbers
+ *
+ * The bounding box operators between two temporal number columns of an inner
+ * join are estimated from the histograms of value ranges and of periods of
+ * the columns, assuming that the value and time dimensions are independent.
+ * As in PostGIS, the selectivity of the overlaps operator is used for all
+ * bounding box operators. The other cases give a default selectivity value.
  */
 PGDLLEXPORT Datum
 tnumber_joinsel(PG_FUNCTION_ARGS)
 {
-  PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+  PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+  Oid operator = PG_GETARG_OID(1);
+  List *args = (List *) PG_GETARG_POINTER(2);
+  JoinType jointype = (JoinType) PG_GETARG_INT16(3);
+  VariableStatData vardata1, vardata2;
+  CachedOp cachedOp;
+  double selec, value_selec = -1.0, time_selec;
+
+  if (!tnumber_cachedop(operator, &cachedOp) ||
+    (cachedOp != OVERLAPS_OP && cachedOp != CONTAINS_OP &&
+     cachedOp != CONTAINED_OP && cachedOp != SAME_OP))
+    PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+  /* Only respond to an inner join */
+  if (jointype != JOIN_INNER || list_length(args) != 2)
+    PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+  examine_variable(root, (Node *) linitial(args), 0, &vardata1);
+  examine_variable(root, (Node *) lsecond(args), 0, &vardata2);
+
+  /* Selectivity for the value dimension if both have the same base type */
+  if (tnumber_type(vardata1.atttype) && tnumber_type(vardata2.atttype) &&
+    base_oid_from_temporal(vardata1.atttype) ==
+      base_oid_from_temporal(vardata2.atttype))
+  {
+    Oid rangetypid = range_oid_from_base(
+      base_oid_from_temporal(vardata1.atttype));
+    TypeCacheEntry *typcache = lookup_type_cache(rangetypid,
+      TYPECACHE_RANGE_INFO);
+    value_selec = tnumber_joinsel_value(typcache, &vardata1, &vardata2);
+  }
+  /* Selectivity for the time dimension */
+  time_selec = period_joinsel_overlaps(&vardata1, &vardata2);
+
+  ReleaseVariableStats(vardata1);
+  ReleaseVariableStats(vardata2);
+
+  if (value_selec < 0.0 && time_selec < 0.0)
+    PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+  selec = 1.0;
+  if (value_selec >= 0.0)
+    selec *= value_selec;
+  if (time_selec >= 0.0)
+    selec *= time_selec;
+  CLAMP_PROBABILITY(selec);
+  PG_RETURN_FLOAT8(selec);
 }
 
 /*****************************************************************************/
@@ -92,15 +92,9 @@
 
 #include "oidcache.h"
 #include "temporal_boxops.h"
+#include "tnumber_distance.h"
 #include "tnumber_gist.h"
 
-#if MOBDB_PGSQL_VERSION >= 120000
-/* To avoid including "access/spgist_private.h" since it conflicts with the
- * EPSILON constant defined there and also in MobilityDB */
-extern double *spg_key_orderbys_distances(Datum key, bool isLeaf, ScanKey orderbys,
-  int norderbys);
-#endif
-
 /*****************************************************************************/
 
 /**
@@ -327,15 +321,20 @@ overAfter4D(const RectBox *rect_box, const TBOX *query)
 #if MOBDB_PGSQL_VERSION >= 110000
 /**
  * Lower bound for the distance between query and rect_box.
- * @note The temporal dimension is not taken into the account since it is not
- * possible to mix different units in the computation. As a consequence, the
- * filtering is not very restrictive.
+ * @note The temporal dimension is not mixed with the value dimension since
+ * they have different units. Instead, as for the nearest approach distance,
+ * when the query has a temporal dimension and no box of rect_box can overlap
+ * its timespan the distance is infinite.
  */
 static double
 distanceBoxRectBox(const TBOX *query, const RectBox *rect_box)
 {
   double dx;
 
+  if (MOBDB_FLAGS_GET_T(query->flags) &&
+      (rect_box->left.tmin > query->tmax || rect_box->right.tmax < query->tmin))
+    return DBL_MAX;
+
   if (query->xmax < rect_box->left.xmin)
     dx = rect_box->left.xmin - query->xmax;
   else if (query->xmin > rect_box->right.xmax)
@@ -474,6 +473,35 @@ tbox_spgist_picksplit(PG_FUNCTION_ARGS)
  * SP-GiST inner consistent function
  *****************************************************************************/
 
+/**
+ * Transform the queries into bounding boxes. This transformation is done
+ * once per inner tuple to avoid doing it for all its nodes. It is applied to
+ * both the scan keys and the ordering keys, the latter may be numbers.
+ */
+static TBOX *
+tbox_spgist_queries(const ScanKey scankeys, int nkeys)
+{
+  TBOX *queries = (TBOX *) palloc0(sizeof(TBOX) * Max(nkeys, 1));
+  for (int i = 0; i < nkeys; i++)
+  {
+    Oid subtype = scankeys[i].sk_subtype;
+    if (tnumber_base_type(subtype))
+      number_to_box(&queries[i], scankeys[i].sk_argument, subtype);
+    else if (tnumber_range_type(subtype))
+      range_to_tbox_internal(&queries[i],
+        DatumGetRangeTypeP(scankeys[i].sk_argument));
+    else if (subtype == type_oid(T_TBOX))
+      memcpy(&queries[i], DatumGetTboxP(scankeys[i].sk_argument),
+        sizeof(TBOX));
+    else if (tnumber_type(subtype))
+      temporal_bbox(&queries[i],
+        DatumGetTemporal(scankeys[i].sk_argument));
+    else
+      elog(ERROR, "Unrecognized subtype: %d", subtype);
+  }
+  return queries;
+}
+
 PG_FUNCTION_INFO_V1(tbox_spgist_inner_consistent);
 /**
  * SP-GiST inner consistent function for temporal numbers
@@ -509,12 +537,11 @@ tbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
 #if MOBDB_PGSQL_VERSION >= 120000
     if (in->norderbys > 0 && in->nNodes > 0)
     {
+      TBOX *orderbys = tbox_spgist_queries(in->orderbys, in->norderbys);
       double *distances = palloc(sizeof(double) * in->norderbys);
       for (int j = 0; j < in->norderbys; j++)
-      {
-        TBOX *box = DatumGetTboxP(in->orderbys[j].sk_argument);
-        distances[j] = distanceBoxRectBox(box, rect_box);
-      }
+        distances[j] = distanceBoxRectBox(&orderbys[j], rect_box);
+      pfree(orderbys);
 
       out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
       out->distances[0] = distances;
@@ -534,30 +561,19 @@ tbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
   /*
    * Transform the queries into bounding boxes.
    */
-  queries = (TBOX *) palloc0(sizeof(TBOX) * in->nkeys);
-  for (i = 0; i < in->nkeys; i++)
-  {
-    Oid subtype = in->scankeys[i].sk_subtype;
-    if (tnumber_range_type(subtype))
-      range_to_tbox_internal(&queries[i],
-        DatumGetRangeTypeP(in->scankeys[i].sk_argument));
-    else if (subtype == type_oid(T_TBOX))
-      memcpy(&queries[i], DatumGetTboxP(in->scankeys[i].sk_argument),
-        sizeof(TBOX));
-    else if (tnumber_type(subtype))
-      temporal_bbox(&queries[i],
-        DatumGetTemporal(in->scankeys[i].sk_argument));
-    else
-      elog(ERROR, "Unrecognized subtype: %d", subtype);
-  }
+  queries = tbox_spgist_queries(in->scankeys, in->nkeys);
 
   /* Allocate enough memory for nodes */
   out->nNodes = 0;
   out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
   out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
 #if MOBDB_PGSQL_VERSION >= 120000
+  TBOX *orderbys = NULL;
   if (in->norderbys > 0)
+  {
     out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+    orderbys = tbox_spgist_queries(in->orderbys, in->norderbys);
+  }
 #endif
   /*
    * We switch memory context, because we want to allocate memory for new
@@ -625,10 +641,7 @@ tbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
         double *distances = palloc(sizeof(double) * in->norderbys);
         out->distances[out->nNodes] = distances;
         for (int j = 0; j < in->norderbys; j++)
-        {
-          TBOX *box = DatumGetTboxP(in->orderbys[j].sk_argument);
-          distances[j] = distanceBoxRectBox(box, rect_box);
-        }
+          distances[j] = distanceBoxRectBox(&orderbys[j], next_rect_box);
       }
 #endif
       out->nNodes++;
@@ -647,6 +660,10 @@ tbox_spgist_inner_consistent(PG_FUNCTION_ARGS)
   MemoryContextSwitchTo(old_ctx);
 
   pfree(queries);
+#if MOBDB_PGSQL_VERSION >= 120000
+  if (orderbys != NULL)
+    pfree(orderbys);
+#endif
 
   PG_RETURN_VOID();
 }
@@ -664,9 +681,6 @@ tbox_spgist_leaf_consistent(PG_FUNCTION_ARGS)
 {
   spgLeafConsistentIn *in = (spgLeafConsistentIn *) PG_GETARG_POINTER(0);
   spgLeafConsistentOut *out = (spgLeafConsistentOut *) PG_GETARG_POINTER(1);
-#if MOBDB_PGSQL_VERSION >= 120000
-  Datum leaf = in->leafDatum;
-#endif
   TBOX *key = DatumGetTboxP(in->leafDatum), query;
   bool res = true;
   int  i;
@@ -715,8 +729,13 @@ tbox_spgist_leaf_consistent(PG_FUNCTION_ARGS)
 #if MOBDB_PGSQL_VERSION >= 120000
   if (res && in->norderbys > 0)
   {
-    out->distances = spg_key_orderbys_distances(leaf, false, in->orderbys,
-      in->norderbys);
+    TBOX *orderbys = tbox_spgist_queries(in->orderbys, in->norderbys);
+    out->distances = palloc(sizeof(double) * in->norderbys);
+    for (i = 0; i < in->norderbys; i++)
+      /* Keys of temporal boxes may not have value dimension */
+      out->distances[i] = MOBDB_FLAGS_GET_X(key->flags) ?
+        NAD_tbox_tbox_internal(key, &orderbys[i]) : DBL_MAX;
+    pfree(orderbys);
     /* Recheck is necessary when computing distance with bounding boxes */
     out->recheckDistances = true;
   }
@@ -18,6 +18,7 @@
 #include <libpq/pqformat.h>
 #include <utils/builtins.h>
 #include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 
 #include "timestampset.h"
@@ -628,9 +629,203 @@ datum_collinear(Oid valuetypid, Datum value1, Datum value2, Datum value3,
  * Normalization functions
  *****************************************************************************/
 
+/**
+ * Function testing whether the middle instant of three consecutive instants
+ * of a sequence is redundant, specialized for a base type
+ */
+typedef bool (*tinstant_redundant_fn)(const TInstant *, const TInstant *,
+  const TInstant *);
+
+/**
+ * Returns the duration between the first two timestamps divided by the
+ * duration between the first and the last ones
+ */
+static inline double
+tinstant_ratio(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3)
+{
+  return (double) (inst2->t - inst1->t) / (double) (inst3->t - inst1->t);
+}
+
+/**
+ * Returns true if the middle instant of step instants of a base type passed
+ * by value is redundant, that is, if the first two values are equal
+ *
+ * @note The values of the first two instants are compared as datums as
+ * done by the function datum_eq
+ */
+static bool
+tinstant_redundant_step_byval(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3)
+{
+  return tinstant_value(inst1) == tinstant_value(inst2);
+}
+
+/**
+ * Returns true if the middle instant of linear temporal float instants is
+ * redundant, that is, if the three values are equal or collinear
+ */
+static bool
+tinstant_redundant_tfloat_linear(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3)
+{
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  Datum value3 = tinstant_value(inst3);
+  if (value1 == value2 && value2 == value3)
+    return true;
+  return float_collinear(DatumGetFloat8(value1), DatumGetFloat8(value2),
+    DatumGetFloat8(value3), tinstant_ratio(inst1, inst2, inst3));
+}
+
+/**
+ * Returns true if the middle instant of step temporal point instants is
+ * redundant, that is, if the first two points are equal
+ *
+ * @note The points of a sequence have the same SRID and dimensionality and
+ * thus only their coordinates are compared
+ */
+static bool
+tinstant_redundant_tpoint_step(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3)
+{
+  POINT4D p1 = datum_get_point4d(tinstant_value(inst1));
+  POINT4D p2 = datum_get_point4d(tinstant_value(inst2));
+  return p1.x == p2.x && p1.y == p2.y && p1.z == p2.z;
+}
+
+/**
+ * Returns true if the middle instant of linear planar 2D temporal point
+ * instants is redundant, that is, if the three points are equal or collinear
+ */
+static bool
+tinstant_redundant_tpoint2d_linear(const TInstant *inst1,
+  const TInstant *inst2, const TInstant *inst3)
+{
+  const POINT2D *p1 = datum_get_point2d_p(tinstant_value(inst1));
+  const POINT2D *p2 = datum_get_point2d_p(tinstant_value(inst2));
+  const POINT2D *p3 = datum_get_point2d_p(tinstant_value(inst3));
+  if (p1->x == p2->x && p1->y == p2->y && p2->x == p3->x && p2->y == p3->y)
+    return true;
+  double ratio = tinstant_ratio(inst1, inst2, inst3);
+  return fabs(p2->x - (p1->x + (p3->x - p1->x) * ratio)) <= EPSILON &&
+    fabs(p2->y - (p1->y + (p3->y - p1->y) * ratio)) <= EPSILON;
+}
+
+/**
+ * Returns true if the middle instant of linear planar 3D temporal point
+ * instants is redundant, that is, if the three points are equal or collinear
+ */
+static bool
+tinstant_redundant_tpoint3dz_linear(const TInstant *inst1,
+  const TInstant *inst2, const TInstant *inst3)
+{
+  const POINT3DZ *p1 = datum_get_point3dz_p(tinstant_value(inst1));
+  const POINT3DZ *p2 = datum_get_point3dz_p(tinstant_value(inst2));
+  const POINT3DZ *p3 = datum_get_point3dz_p(tinstant_value(inst3));
+  if (p1->x == p2->x && p1->y == p2->y && p1->z == p2->z &&
+    p2->x == p3->x && p2->y == p3->y && p2->z == p3->z)
+    return true;
+  double ratio = tinstant_ratio(inst1, inst2, inst3);
+  return fabs(p2->x - (p1->x + (p3->x - p1->x) * ratio)) <= EPSILON &&
+    fabs(p2->y - (p1->y + (p3->y - p1->y) * ratio)) <= EPSILON &&
+    fabs(p2->z - (p1->z + (p3->z - p1->z) * ratio)) <= EPSILON;
+}
+
+/**
+ * Returns true if the middle instant of linear geodetic temporal point
+ * instants is redundant, that is, if the three points are equal or if the
+ * middle one is on the great circle arc between the other two
+ */
+static bool
+tinstant_redundant_tgeogpoint_linear(const TInstant *inst1,
+  const TInstant *inst2, const TInstant *inst3)
+{
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  Datum value3 = tinstant_value(inst3);
+  POINT4D p1 = datum_get_point4d(value1);
+  POINT4D p2 = datum_get_point4d(value2);
+  POINT4D p3 = datum_get_point4d(value3);
+  if (p1.x == p2.x && p1.y == p2.y && p1.z == p2.z &&
+    p2.x == p3.x && p2.y == p3.y && p2.z == p3.z)
+    return true;
+  return geopoint_collinear(value1, value2, value3,
+    tinstant_ratio(inst1, inst2, inst3), MOBDB_FLAGS_GET_Z(inst1->flags),
+    true);
+}
+
+/**
+ * Returns true if the middle instant of three consecutive instants of a
+ * sequence is redundant (generic function)
+ *
+ * @param[in] inst1,inst2,inst3 Instants
+ * @param[in] linear True when the instants have linear interpolation
+ */
+static bool
+tinstant_redundant(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3, bool linear)
+{
+  Oid valuetypid = inst1->valuetypid;
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  Datum value3 = tinstant_value(inst3);
+  return
+    /* step sequences and 2 consecutive instants that have the same value
+      ... 1@t1, 1@t2, 2@t3, ... -> ... 1@t1, 2@t3, ...
+    */
+    (!linear && datum_eq(value1, value2, valuetypid))
+    ||
+    /* 3 consecutive linear instants that have the same value
+      ... 1@t1, 1@t2, 1@t3, ... -> ... 1@t1, 1@t3, ...
+    */
+    (linear && datum_eq(value1, value2, valuetypid) &&
+      datum_eq(value2, value3, valuetypid))
+    ||
+    /* collinear linear instants
+      ... 1@t1, 2@t2, 3@t3, ... -> ... 1@t1, 3@t3, ...
+    */
+    (linear && datum_collinear(valuetypid, value1, value2, value3,
+      inst1->t, inst2->t, inst3->t));
+}
+
+/**
+ * Returns the specialized function testing whether the middle instant of
+ * three consecutive instants of a sequence is redundant, NULL if the base
+ * type requires the generic function
+ *
+ * @param[in] inst Instant of the sequence
+ * @param[in] linear True when the instants have linear interpolation
+ */
+static tinstant_redundant_fn
+tinstant_redundant_kernel(const TInstant *inst, bool linear)
+{
+  Oid valuetypid = inst->valuetypid;
+  if (valuetypid == BOOLOID || valuetypid == INT4OID)
+    return &tinstant_redundant_step_byval;
+  if (valuetypid == FLOAT8OID)
+    return linear ? &tinstant_redundant_tfloat_linear :
+      &tinstant_redundant_step_byval;
+  if (tgeo_base_type(valuetypid))
+  {
+    if (! linear)
+      return &tinstant_redundant_tpoint_step;
+    if (MOBDB_FLAGS_GET_GEODETIC(inst->flags))
+      return &tinstant_redundant_tgeogpoint_linear;
+    return MOBDB_FLAGS_GET_Z(inst->flags) ?
+      &tinstant_redundant_tpoint3dz_linear :
+      &tinstant_redundant_tpoint2d_linear;
+  }
+  return NULL;
+}
+
 /**
  * Normalize the array of temporal instant values
  *
+ * The test of redundant instants is specialized for the base type once
+ * before the loop, so that the loop neither dispatches on the base type nor
+ * decodes the serialized points more than needed.
+ *
  * @param[in] instants Array of input instants
  * @param[in] linear True when the instants have linear interpolation
  * @param[in] count Number of elements in the input array
@@ -645,43 +840,25 @@ tinstantarr_normalize(TInstant **instants, bool linear, int count,
   int *newcount)
 {
   assert(count > 1);
-  Oid valuetypid = instants[0]->valuetypid;
+  tinstant_redundant_fn redundant = tinstant_redundant_kernel(instants[0],
+    linear);
   TInstant **result = palloc(sizeof(TInstant *) * count);
   /* Remove redundant instants */
   TInstant *inst1 = instants[0];
-  Datum value1 = tinstant_value(inst1);
   TInstant *inst2 = instants[1];
-  Datum value2 = tinstant_value(inst2);
   result[0] = inst1;
   int k = 1;
   for (int i = 2; i < count; i++)
   {
     TInstant *inst3 = instants[i];
-    Datum value3 = tinstant_value(inst3);
-    if (
-      /* step sequences and 2 consecutive instants that have the same value
-        ... 1@t1, 1@t2, 2@t3, ... -> ... 1@t1, 2@t3, ...
-      */
-      (!linear && datum_eq(value1, value2, valuetypid))
-      ||
-      /* 3 consecutive linear instants that have the same value
-        ... 1@t1, 1@t2, 1@t3, ... -> ... 1@t1, 1@t3, ...
-      */
-      (linear && datum_eq(value1, value2, valuetypid) && datum_eq(value2, value3, valuetypid))
-      ||
-      /* collinear linear instants
-        ... 1@t1, 2@t2, 3@t3, ... -> ... 1@t1, 3@t3, ...
-      */
-      (linear && datum_collinear(valuetypid, value1, value2, value3, inst1->t, inst2->t, inst3->t))
-      )
-    {
-      inst2 = inst3; value2 = value3;
-    }
+    if (redundant != NULL ? redundant(inst1, inst2, inst3) :
+        tinstant_redundant(inst1, inst2, inst3, linear))
+      inst2 = inst3;
     else
     {
       result[k++] = inst2;
-      inst1 = inst2; value1 = value2;
-      inst2 = inst3; value2 = value3;
+      inst1 = inst2;
+      inst2 = inst3;
     }
   }
   result[k++] = inst2;
@@ -818,6 +995,11 @@ tsequence_inst_n(const TSequence *seq, int index)
 
 /**
  * Returns a pointer to the precomputed bounding box of the temporal value
+ *
+ * The offset of the bounding box is kept in the offsets array, which
+ * makes the function valid both for the values having the BBOXFIRST flag
+ * and for those of previous versions whose bounding box follows the
+ * composing values
  */
 void *
 tsequence_bbox_ptr(const TSequence *seq)
@@ -826,6 +1008,121 @@ tsequence_bbox_ptr(const TSequence *seq)
     seq->offsets[seq->count];            /* offset */
 }
 
+/**
+ * Returns the integral (area under the curve) of the segment of a temporal
+ * number defined by the two instants
+ */
+static double
+tnumbersegm_integral(const TInstant *inst1, const TInstant *inst2,
+  bool linear)
+{
+  if (linear)
+  {
+    /* Linear interpolation */
+    double min = Min(DatumGetFloat8(tinstant_value(inst1)),
+      DatumGetFloat8(tinstant_value(inst2)));
+    double max = Max(DatumGetFloat8(tinstant_value(inst1)),
+      DatumGetFloat8(tinstant_value(inst2)));
+    return (max + min) * (double) (inst2->t - inst1->t) / 2.0;
+  }
+  /* Step interpolation */
+  return datum_double(tinstant_value(inst1), inst1->valuetypid) *
+    (double) (inst2->t - inst1->t);
+}
+
+/**
+ * Returns a pointer to the location of the precomputed metrics of the
+ * temporal value, which are stored before the block boxes, if any
+ */
+static TSequenceMetrics *
+tsequence_metrics_location(const TSequence *seq)
+{
+  int nblocks = MOBDB_FLAGS_GET_BLOCKS(seq->flags) ?
+    tpointseq_block_count(seq->count) : 0;
+  return (TSequenceMetrics *) ((char *) seq + VARSIZE(seq) -
+    sizeof(STBOX) * nblocks - double_pad(sizeof(TSequenceMetrics)));
+}
+
+/**
+ * Returns a pointer to the precomputed metrics of the temporal value or
+ * NULL if the value does not keep them
+ */
+const TSequenceMetrics *
+tsequence_metrics_ptr(const TSequence *seq)
+{
+  if (! MOBDB_FLAGS_GET_METRICS(seq->flags))
+    return NULL;
+  return tsequence_metrics_location(seq);
+}
+
+/**
+ * Returns true if the temporal sequences of the base type with the given
+ * number of instants keep precomputed metrics
+ */
+static bool
+tsequence_keeps_metrics(Oid valuetypid, int count)
+{
+  return count >= TSEQUENCE_METRICS_MINCOUNT &&
+    (tnumber_base_type(valuetypid) || tgeo_base_type(valuetypid));
+}
+
+/**
+ * Compute the metrics of the temporal value and store them in the value
+ *
+ * The metrics are computed by the same functions that compute them when
+ * the value does not keep them, so that both results are equal.
+ */
+static void
+tsequence_set_metrics(TSequence *seq)
+{
+  MOBDB_FLAGS_SET_METRICS(seq->flags, false);
+  TSequenceMetrics *metrics = tsequence_metrics_location(seq);
+  memset(metrics, 0, sizeof(TSequenceMetrics));
+  if (tnumber_base_type(seq->valuetypid))
+    metrics->integral = tnumberseq_integral(seq);
+  else
+  {
+    if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
+      metrics->length = tpointseq_length(seq);
+    tpointseq_speed_bounds(seq, &metrics->minspeed, &metrics->maxspeed);
+    metrics->spheroid = geodetic_use_spheroid;
+  }
+  MOBDB_FLAGS_SET_METRICS(seq->flags, true);
+  return;
+}
+
+/**
+ * Set the metrics of the temporal value obtained by appending an instant
+ * to a temporal value keeping metrics
+ *
+ * The metrics are updated with the last segment, except the length of
+ * geodetic points which is computed on the whole trajectory.
+ *
+ * @param[in,out] seq Temporal value obtained by appending the instant
+ * @param[in] oldmetrics Metrics of the temporal value before appending
+ */
+static void
+tsequence_append_metrics(TSequence *seq, const TSequenceMetrics *oldmetrics)
+{
+  if (MOBDB_FLAGS_GET_GEODETIC(seq->flags))
+  {
+    tsequence_set_metrics(seq);
+    return;
+  }
+  TSequenceMetrics *metrics = tsequence_metrics_location(seq);
+  memcpy(metrics, oldmetrics, sizeof(TSequenceMetrics));
+  TInstant *inst1 = tsequence_inst_n(seq, seq->count - 2);
+  TInstant *inst2 = tsequence_inst_n(seq, seq->count - 1);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  if (tnumber_base_type(seq->valuetypid))
+    metrics->integral += tnumbersegm_integral(inst1, inst2, linear);
+  else
+    tpointsegm_append_metrics(&metrics->length, &metrics->minspeed,
+      &metrics->maxspeed, inst1, inst2, linear);
+  MOBDB_FLAGS_SET_METRICS(seq->flags, true);
+  return;
+}
+
 /**
  * Copy in the first argument the bounding box of the temporal value
  */
@@ -877,14 +1174,67 @@ tsequence_make_valid(TInstant **instants, int count, bool lower_inc, bool upper_
   return;
 }
 
+#ifdef USE_ASSERT_CHECKING
+/**
+ * Returns true if the arguments for creating a temporal sequence value are
+ * valid. This function does not raise errors since it is only used in the
+ * assertions of the constructors that trust their arguments.
+ */
+static bool
+tsequence_valid_args(TInstant **instants, int count, bool lower_inc,
+  bool upper_inc, bool linear)
+{
+  if (count <= 0 || (count == 1 && (!lower_inc || !upper_inc)))
+    return false;
+  if (!linear && count > 1 && !upper_inc &&
+    datum_ne(tinstant_value(instants[count - 1]),
+      tinstant_value(instants[count - 2]), instants[0]->valuetypid))
+    return false;
+  for (int i = 1; i < count; i++)
+  {
+    if (instants[i - 1]->t >= instants[i]->t ||
+      instants[i - 1]->valuetypid != instants[i]->valuetypid ||
+      MOBDB_FLAGS_GET_Z(instants[i - 1]->flags) !=
+        MOBDB_FLAGS_GET_Z(instants[i]->flags) ||
+      MOBDB_FLAGS_GET_GEODETIC(instants[i - 1]->flags) !=
+        MOBDB_FLAGS_GET_GEODETIC(instants[i]->flags))
+      return false;
+  }
+  return true;
+}
+#endif
+
 /**
  * Creating a temporal value from its arguments
+ *
+ * This is the trusted constructor used for the results of functions such as
+ * restriction or synchronization computed from valid temporal values, the
+ * validity of the arguments is only asserted in builds with assertions
+ * enabled.
  * @pre The validity of the arguments has been tested before
  */
 TSequence *
 tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
   bool linear, bool normalize)
 {
+  return tsequence_make_traj(instants, count, lower_inc, upper_inc, linear,
+    normalize, type_has_precomputed_trajectory(instants[0]->valuetypid));
+}
+
+/**
+ * Creating a temporal value from its arguments, where the trajectory of
+ * temporal points is only precomputed if the last argument is true
+ *
+ * The values that only live for the duration of a function call, such as
+ * those decoded from a packed value, do not precompute their trajectory,
+ * which is then built on demand by the functions requiring it.
+ * @pre The validity of the arguments has been tested before
+ */
+TSequence *
+tsequence_make_traj(TInstant **instants, int count, bool lower_inc,
+  bool upper_inc, bool linear, bool normalize, bool withtraj)
+{
+  Assert(tsequence_valid_args(instants, count, lower_inc, upper_inc, linear));
   /* Normalize the array of instants */
   TInstant **norminsts = instants;
   int newcount = count;
@@ -901,7 +1251,7 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
   bool isgeo = tgeo_base_type(instants[0]->valuetypid);
   if (isgeo)
   {
-    hastraj = type_has_precomputed_trajectory(instants[0]->valuetypid);
+    hastraj = withtraj;
     if (hastraj)
     {
       /* A trajectory is a geometry/geography, a point, a multipoint,
@@ -911,8 +1261,16 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
     }
   }
 
+  /* Block boxes of long temporal points */
+  int nblocks = isgeo ? tpointseq_block_count(newcount) : 0;
+  /* Metrics of long temporal numbers and points */
+  bool hasmetrics = tsequence_keeps_metrics(instants[0]->valuetypid,
+    newcount);
+
   /* Create the temporal sequence */
-  size_t seqsize = tsequence_make_size(norminsts, newcount, bboxsize, trajsize);
+  size_t seqsize = tsequence_make_size(norminsts, newcount, bboxsize,
+    trajsize) + sizeof(STBOX) * nblocks +
+    (hasmetrics ? double_pad(sizeof(TSequenceMetrics)) : 0);
   TSequence *result = palloc0(seqsize);
   SET_VARSIZE(result, seqsize);
   result->count = newcount;
@@ -923,32 +1281,30 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
   MOBDB_FLAGS_SET_LINEAR(result->flags, linear);
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
+  MOBDB_FLAGS_SET_BBOXFIRST(result->flags, true);
   if (isgeo)
   {
     MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(instants[0]->flags));
     MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(instants[0]->flags));
+    MOBDB_FLAGS_SET_TRAJ(result->flags, hastraj);
+    MOBDB_FLAGS_SET_BLOCKS(result->flags, nblocks > 0);
   }
   /* Initialization of the variable-length part
    * Notice that the first offset is already declared in the struct */
   size_t pdata = double_pad(sizeof(TSequence)) + (newcount + 1) * sizeof(size_t);
   size_t pos = 0;
-  for (int i = 0; i < newcount; i++)
-  {
-    memcpy(((char *)result) + pdata + pos, norminsts[i],
-      VARSIZE(norminsts[i]));
-    result->offsets[i] = pos;
-    pos += double_pad(VARSIZE(norminsts[i]));
-  }
   /*
    * Precompute the bounding box
    * Only external types have precomputed bounding box, internal types such
    * as double2, double3, or double4 do not have precomputed bounding box.
    * For temporal points the bounding box is computed from the trajectory
-   * for efficiency reasons.
+   * for efficiency reasons. The bounding box is located at the beginning
+   * of the variable-length part so that it can be read without detoasting
+   * the whole value.
    */
   if (bboxsize != 0)
   {
-    void *bbox = ((char *) result) + pdata + pos;
+    void *bbox = ((char *) result) + pdata;
     if (hastraj)
     {
       geo_to_stbox_internal(bbox, (GSERIALIZED *)DatumGetPointer(traj));
@@ -961,6 +1317,13 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
     result->offsets[newcount] = pos;
     pos += double_pad(bboxsize);
   }
+  for (int i = 0; i < newcount; i++)
+  {
+    memcpy(((char *)result) + pdata + pos, norminsts[i],
+      VARSIZE(norminsts[i]));
+    result->offsets[i] = pos;
+    pos += double_pad(VARSIZE(norminsts[i]));
+  }
   if (isgeo && hastraj)
   {
     result->offsets[newcount + 1] = pos;
@@ -968,6 +1331,13 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
       VARSIZE(DatumGetPointer(traj)));
     pfree(DatumGetPointer(traj));
   }
+  /* The block boxes are located at the end of the value */
+  if (nblocks > 0)
+    tpointseq_make_blocks((STBOX *) tpointseq_blocks_ptr(result), norminsts,
+      newcount);
+  /* The metrics are located before the block boxes */
+  if (hasmetrics)
+    tsequence_set_metrics(result);
 
   if (normalize && count > 2)
     pfree(norminsts);
@@ -985,14 +1355,17 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
  * ( TSequence )_X | offset_0 | offset_1 | offset_2 | offset_3 | ...
  * -------------------------------------------------------------------
  * ------------------------------------------------------------------------
- * ( TInstant_0 )_X | ( TInstant_1 )_X | ( bbox )_X | ( Traj )_X  |
+ * ( bbox )_X | ( TInstant_0 )_X | ( TInstant_1 )_X | ( Traj )_X  |
  * ------------------------------------------------------------------------
  * @endcode
  * where the `X` are unused bytes added for double padding, `offset_0` and
  * `offset_1` are offsets for the corresponding instants, `offset_2` is the
  * offset for the bounding box and `offset_3` is the offset for the
- * precomputed trajectory. Precomputed trajectories are only kept for temporal
- * points of sequence duration.
+ * precomputed trajectory. The bounding box is stored first so that it can
+ * be fetched without detoasting the whole value. Precomputed trajectories
+ * are only kept for temporal points of sequence duration. Temporal points
+ * with many instants additionally keep at the end of the value the boxes
+ * of blocks of consecutive segments, see the function tpointseq_make_blocks.
  *
  * @param[in] instants Array of instants
  * @param[in] count Number of elements in the array
@@ -1032,6 +1405,72 @@ tsequence_make_free(TInstant **instants, int count, bool lower_inc,
   return result;
 }
 
+/**
+ * Construct a temporal sequence value from the array of temporal
+ * instant values without verifying their validity and free the array and
+ * the instants after the creation
+ *
+ * @pre The validity of the arguments has been tested before
+ */
+TSequence *
+tsequence_make_free1(TInstant **instants, int count, bool lower_inc,
+   bool upper_inc, bool linear, bool normalize)
+{
+  TSequence *result = tsequence_make1(instants, count, lower_inc, upper_inc,
+    linear, normalize);
+  for (int i = 0; i < count; i++)
+    pfree(instants[i]);
+  pfree(instants);
+  return result;
+}
+
+/**
+ * Construct a temporal sequence value from parallel arrays of timestamps
+ * and base values
+ *
+ * The instants are constructed in a single allocated block rather than
+ * allocating each of them separately before copying them into the
+ * resulting sequence.
+ *
+ * @param[in] times Array of timestamps
+ * @param[in] values Array of base values
+ * @param[in] count Number of elements in the arrays
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] lower_inc,upper_inc True when the respective bound is inclusive
+ * @param[in] linear True when the interpolation is linear
+ * @param[in] normalize True when the resulting value should be normalized
+ */
+TSequence *
+tsequence_from_arrays(const TimestampTz *times, const Datum *values,
+  int count, Oid valuetypid, bool lower_inc, bool upper_inc, bool linear,
+  bool normalize)
+{
+  assert(count > 0);
+  /* Compute the size of the instants */
+  size_t *sizes = palloc(sizeof(size_t) * count);
+  size_t totalsize = 0;
+  for (int i = 0; i < count; i++)
+  {
+    sizes[i] = tinstant_make_size(values[i], valuetypid);
+    totalsize += sizes[i];
+  }
+  /* Construct the instants in a single block */
+  char *block = palloc0(totalsize);
+  TInstant **instants = palloc(sizeof(TInstant *) * count);
+  size_t pos = 0;
+  for (int i = 0; i < count; i++)
+  {
+    instants[i] = (TInstant *) (block + pos);
+    tinstant_init(instants[i], values[i], times[i], valuetypid, sizes[i]);
+    pos += sizes[i];
+  }
+  tsequence_make_valid(instants, count, lower_inc, upper_inc, linear);
+  TSequence *result = tsequence_make1(instants, count, lower_inc, upper_inc,
+    linear, normalize);
+  pfree(instants); pfree(block); pfree(sizes);
+  return result;
+}
+
 /**
  * Join the two temporal sequence values
  *
@@ -1102,6 +1541,128 @@ tsequence_from_base(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/**
+ * Append an instant to the temporal value when the instant does not need
+ * to be normalized with the last instants of the sequence
+ *
+ * Instead of collecting the instants and rebuilding the sequence from
+ * scratch, the instants of the sequence are copied in a single block, the
+ * bounding box is expanded with the one of the instant, and for linear
+ * temporal points the precomputed trajectory is extended with the point.
+ */
+static TSequence *
+tsequence_append_tinstant1(const TSequence *seq, const TInstant *inst)
+{
+  size_t bboxsize = double_pad(temporal_bbox_size(seq->valuetypid));
+  assert(bboxsize != 0);
+  bool isgeo = tgeo_base_type(seq->valuetypid);
+  bool hastraj = isgeo && type_has_precomputed_trajectory(seq->valuetypid);
+  Datum traj = 0; /* keep compiler quiet */
+  size_t trajsize = 0;
+  if (hastraj)
+  {
+    traj = tpointseq_trajectory_append(seq, inst);
+    if (traj == (Datum) 0)
+    {
+      TInstant **instants = palloc(sizeof(TInstant *) * (seq->count + 1));
+      for (int i = 0; i < seq->count; i++)
+        instants[i] = tsequence_inst_n(seq, i);
+      instants[seq->count] = (TInstant *) inst;
+      traj = tpointseq_make_trajectory(instants, seq->count + 1,
+        MOBDB_FLAGS_GET_LINEAR(seq->flags));
+      pfree(instants);
+    }
+    trajsize = double_pad(VARSIZE(DatumGetPointer(traj)));
+  }
+
+  /* Create the temporal sequence */
+  int count = seq->count + 1;
+  /* Size of the instants, which are located after the bounding box */
+  TInstant *last = tsequence_inst_n(seq, seq->count - 1);
+  size_t instsize = seq->offsets[seq->count - 1] +
+    double_pad(VARSIZE(last)) - seq->offsets[0];
+  size_t pdata = double_pad(sizeof(TSequence)) + (count + 1) * sizeof(size_t);
+  int nblocks = isgeo ? tpointseq_block_count(count) : 0;
+  bool hasmetrics = tsequence_keeps_metrics(seq->valuetypid, count);
+  size_t seqsize = pdata + bboxsize + instsize + double_pad(VARSIZE(inst)) +
+    trajsize + sizeof(STBOX) * nblocks +
+    (hasmetrics ? double_pad(sizeof(TSequenceMetrics)) : 0);
+  TSequence *result = palloc0(seqsize);
+  SET_VARSIZE(result, seqsize);
+  result->count = count;
+  result->valuetypid = seq->valuetypid;
+  result->duration = SEQUENCE;
+  result->flags = seq->flags;
+  MOBDB_FLAGS_SET_METRICS(result->flags, false);
+  MOBDB_FLAGS_SET_BBOXFIRST(result->flags, true);
+  if (isgeo)
+  {
+    MOBDB_FLAGS_SET_TRAJ(result->flags, hastraj);
+    MOBDB_FLAGS_SET_BLOCKS(result->flags, nblocks > 0);
+  }
+  period_set(&result->period, seq->period.lower, inst->t,
+    seq->period.lower_inc, true);
+  /* Expand the bounding box */
+  void *bbox = ((char *) result) + pdata;
+  if (hastraj)
+  {
+    geo_to_stbox_internal(bbox, (GSERIALIZED *)DatumGetPointer(traj));
+    ((STBOX *)bbox)->tmin = result->period.lower;
+    ((STBOX *)bbox)->tmax = result->period.upper;
+    MOBDB_FLAGS_SET_T(((STBOX *)bbox)->flags, true);
+  }
+  else
+  {
+    bboxunion box;
+    memcpy(bbox, tsequence_bbox_ptr(seq), bboxsize);
+    tinstant_make_bbox(&box, inst);
+    temporal_bbox_expand(bbox, &box, seq->valuetypid);
+  }
+  result->offsets[count] = 0;
+  /* Copy the instants shifting their offsets, since in the sequences of
+   * previous versions the instants precede the bounding box */
+  size_t pos = bboxsize;
+  for (int i = 0; i < seq->count; i++)
+    result->offsets[i] = seq->offsets[i] - seq->offsets[0] + bboxsize;
+  memcpy(((char *) result) + pdata + pos,
+    (char *) tsequence_inst_n(seq, 0), instsize);
+  pos += instsize;
+  result->offsets[count - 1] = pos;
+  memcpy(((char *) result) + pdata + pos, inst, VARSIZE(inst));
+  pos += double_pad(VARSIZE(inst));
+  if (hastraj)
+  {
+    result->offsets[count + 1] = pos;
+    memcpy(((char *) result) + pdata + pos, DatumGetPointer(traj),
+      VARSIZE(DatumGetPointer(traj)));
+    pfree(DatumGetPointer(traj));
+  }
+  if (nblocks > 0)
+    tpointseq_append_blocks((STBOX *) tpointseq_blocks_ptr(result), seq, inst);
+  if (hasmetrics)
+  {
+    const TSequenceMetrics *oldmetrics = tsequence_metrics_ptr(seq);
+    if (oldmetrics != NULL)
+      tsequence_append_metrics(result, oldmetrics);
+    else
+      tsequence_set_metrics(result);
+  }
+  return result;
+}
+
+/**
+ * Returns true if the instant appended after the last two instants inst1
+ * and inst2 of a sequence replaces inst2 in the normalized result
+ */
+bool
+tsequence_append_replaces_last(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst, bool linear)
+{
+  tinstant_redundant_fn redundant = tinstant_redundant_kernel(inst, linear);
+  return (redundant != NULL) ? redundant(inst1, inst2, inst) :
+    tinstant_redundant(inst1, inst2, inst, linear);
+}
+
 /**
  * Append an instant to the temporal value
  */
@@ -1136,35 +1697,13 @@ tsequence_append_tinstant(const TSequence *seq, const TInstant *inst)
 
   /* The result is a sequence */
   int count = seq->count + 1;
-  if (seq->count > 1)
-  {
-    /* Normalize the result */
-    inst1 = tsequence_inst_n(seq, seq->count - 2);
-    Datum value1 = tinstant_value(inst1);
-    TInstant *inst2 = tsequence_inst_n(seq, seq->count - 1);
-    Datum value2 = tinstant_value(inst2);
-    Datum value3 = tinstant_value(inst);
-    if (
-      /* step sequences and 2 consecutive instants that have the same value
-        ... 1@t1, 1@t2, 2@t3, ... -> ... 1@t1, 2@t3, ...
-      */
-      (! linear && datum_eq(value1, value2, seq->valuetypid))
-      ||
-      /* 3 consecutive float/point instants that have the same value
-        ... 1@t1, 1@t2, 1@t3, ... -> ... 1@t1, 1@t3, ...
-      */
-      (datum_eq(value1, value2, seq->valuetypid) && datum_eq(value2, value3, seq->valuetypid))
-      ||
-      /* collinear float/point instants that have the same duration
-        ... 1@t1, 2@t2, 3@t3, ... -> ... 1@t1, 3@t3, ...
-      */
-      (linear && datum_collinear(seq->valuetypid, value1, value2, value3, inst1->t, inst2->t, inst->t))
-      )
-    {
-      /* The new instant replaces the last instant of the sequence */
-      count--;
-    }
-  }
+  /* Normalize the result */
+  if (seq->count > 1 && tsequence_append_replaces_last(
+      tsequence_inst_n(seq, seq->count - 2),
+      tsequence_inst_n(seq, seq->count - 1), inst, linear))
+    count--;
+  if (count == seq->count + 1)
+    return (Temporal *) tsequence_append_tinstant1(seq, inst);
 
   TInstant **instants = palloc(sizeof(TInstant *) * count);
   int k = 0;
@@ -1177,6 +1716,42 @@ tsequence_append_tinstant(const TSequence *seq, const TInstant *inst)
   return (Temporal *) result;
 }
 
+/**
+ * Append an array of instants to the temporal value
+ *
+ * When the timestamps of the instants are strictly increasing and after the
+ * end of the sequence, the sequence is built only once from all the
+ * instants. Otherwise, the instants are appended one by one.
+ *
+ * @param[in] seq Temporal value
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ * @pre The instants have the same base type and are spatially compatible
+ * with the sequence
+ */
+Temporal *
+tsequence_append_tinstants(const TSequence *seq, TInstant **instants,
+  int count)
+{
+  assert(count > 0);
+  TInstant *last = tsequence_inst_n(seq, seq->count - 1);
+  if (instants[0]->t <= last->t)
+    return temporal_append_tinstants1((Temporal *) seq, instants, count);
+  for (int i = 1; i < count; i++)
+    ensure_increasing_timestamps(instants[i - 1], instants[i], false); /* >= */
+
+  int newcount = seq->count + count;
+  TInstant **allinstants = palloc(sizeof(TInstant *) * newcount);
+  for (int i = 0; i < seq->count; i++)
+    allinstants[i] = tsequence_inst_n(seq, i);
+  memcpy(&allinstants[seq->count], instants, sizeof(TInstant *) * count);
+  TSequence *result = tsequence_make1(allinstants, newcount,
+    seq->period.lower_inc, true, MOBDB_FLAGS_GET_LINEAR(seq->flags),
+    NORMALIZE);
+  pfree(allinstants);
+  return (Temporal *) result;
+}
+
 /**
  * Merge the two temporal values
  */
@@ -1188,20 +1763,26 @@ tsequence_merge(const TSequence *seq1, const TSequence *seq2)
 }
 
 /**
- * Merge the array of temporal sequence values.
+ * Merge the array of temporal sequence values sorted by their periods.
  * The values in the array may overlap on a single instant.
  *
+ * The validity of the sequences is tested in a single pass, which also
+ * determines whether two consecutive sequences are adjacent. Since only
+ * adjacent sequences can be joined by the normalization, when there are
+ * none the result is constructed directly from the input sequences, which
+ * are then copied only once.
+ *
  * @param[in] sequences Array of values
  * @param[in] count Number of elements in the array
- * @param[out] totalcount Number of elements in the resulting array
- * @result Array of merged sequences
+ * @param[in] seqset True when the result must be a sequence set, otherwise
+ * the result is a sequence if there is a single sequence after merging
+ * @result Merged value
  */
-TSequence **
-tsequence_merge_array1(TSequence **sequences, int count, int *totalcount)
+Temporal *
+tsequence_merge_sorted(TSequence **sequences, int count, bool seqset)
 {
-  if (count > 1)
-    tsequencearr_sort(sequences, count);
   /* Test the validity of the composing sequences */
+  bool adjacent = false;
   TSequence *seq1 = sequences[0];
   for (int i = 1; i < count; i++)
   {
@@ -1226,9 +1807,27 @@ tsequence_merge_array1(TSequence **sequences, int count, int *totalcount)
           errmsg("The temporal values have different value at their overlapping instant %s", t1)));
       }
     }
+    if (seq1->period.upper == seq2->period.lower &&
+      (seq1->period.upper_inc || seq2->period.lower_inc))
+      adjacent = true;
     seq1 = seq2;
   }
-  return tsequencearr_normalize(sequences, count, totalcount);
+
+  if (! adjacent)
+  {
+    if (count == 1 && ! seqset)
+      return (Temporal *) tsequence_copy(sequences[0]);
+    return (Temporal *) tsequenceset_make(sequences, count, NORMALIZE_NO);
+  }
+  int newcount;
+  TSequence **newseqs = tsequencearr_normalize(sequences, count, &newcount);
+  if (newcount == 1 && ! seqset)
+  {
+    TSequence *result = newseqs[0];
+    pfree(newseqs);
+    return (Temporal *) result;
+  }
+  return (Temporal *) tsequenceset_make_free(newseqs, newcount, NORMALIZE_NO);
 }
 
 /**
@@ -1242,11 +1841,9 @@ tsequence_merge_array1(TSequence **sequences, int count, int *totalcount)
 Temporal *
 tsequence_merge_array(TSequence **sequences, int count)
 {
-  int totalcount;
-  TSequence **newseqs = tsequence_merge_array1(sequences, count, &totalcount);
-  Temporal *result = (totalcount == 1) ? (Temporal *) newseqs[0] :
-    (Temporal *) tsequenceset_make_free(newseqs, totalcount, NORMALIZE);
-  return result;
+  if (count > 1)
+    tsequencearr_sort(sequences, count);
+  return tsequence_merge_sorted(sequences, count, false);
 }
 
 /**
@@ -1306,6 +1903,67 @@ tsequence_find_timestamp(const TSequence *seq, TimestampTz t)
   return -1;
 }
 
+/**
+ * Returns the number of the segment of the temporal sequence value
+ * containing the timestamp starting the search from a cursor
+ *
+ * The cursor is the segment found by the previous search. When the
+ * timestamps searched are increasing, as in nested loop joins probing the
+ * same value, the segment is most often the one of the cursor or the next
+ * one. Otherwise, an interpolation search on the timestamps of the instants
+ * is used, which alternates with bisection steps to bound its cost for
+ * irregularly sampled values.
+ *
+ * @param[in] seq Temporal sequence value
+ * @param[in] t Timestamp
+ * @param[in,out] cursor Segment of the previous search, -1 if none
+ * @result Returns -1 if the timestamp is not contained in the temporal value
+ * @note The result is the same as the one of tsequence_find_timestamp
+ */
+int
+tsequence_find_timestamp_cursor(const TSequence *seq, TimestampTz t,
+  int *cursor)
+{
+  if (seq->count == 1 || ! contains_period_timestamp_internal(&seq->period, t))
+    return -1;
+  int last = seq->count - 2;
+  int result;
+  int n = *cursor;
+  if (n >= 0 && n <= last && tsequence_inst_n(seq, n)->t <= t &&
+    (n == last || t < tsequence_inst_n(seq, n + 1)->t))
+    result = n;
+  else if (n >= 0 && n < last && tsequence_inst_n(seq, n + 1)->t <= t &&
+    (n + 1 == last || t < tsequence_inst_n(seq, n + 2)->t))
+    result = n + 1;
+  else
+  {
+    /* Find the last instant whose timestamp is less than or equal to t */
+    int lo = 0, hi = last + 1;
+    TimestampTz tlo = tsequence_inst_n(seq, lo)->t;
+    TimestampTz thi = tsequence_inst_n(seq, hi)->t;
+    bool bisect = false;
+    while (t < thi && hi - lo > 1)
+    {
+      int middle = bisect ? (lo + hi) / 2 :
+        lo + (int) ((double) (t - tlo) / (double) (thi - tlo) * (hi - lo));
+      middle = Max(lo + 1, Min(middle, hi - 1));
+      TimestampTz tmiddle = tsequence_inst_n(seq, middle)->t;
+      if (tmiddle <= t)
+      {
+        lo = middle; tlo = tmiddle;
+      }
+      else
+      {
+        hi = middle; thi = tmiddle;
+      }
+      bisect = ! bisect;
+    }
+    result = (t < thi) ? lo : Min(hi, last);
+  }
+  *cursor = result;
+  return result;
+}
+
 /**
  * Convert an an array of arrays of temporal sequence values into an array of
  * sequence values.
@@ -1504,26 +2162,27 @@ synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
    * where X are values added for synchronization and C are values added
    * for the crossings
    */
+  /* The instants added for the synchronization are allocated in a scratch
+   * memory context that is deleted at once after the result is built */
+  MemoryContext scratch = AllocSetContextCreate(CurrentMemoryContext,
+    "Synchronization", ALLOCSET_DEFAULT_SIZES);
+  MemoryContext oldcontext = MemoryContextSwitchTo(scratch);
   inst1 = tsequence_inst_n(seq1, 0);
   inst2 = tsequence_inst_n(seq2, 0);
-  TInstant *tofreeinst = NULL;
-  int i = 0, j = 0, k = 0, l = 0;
+  int i = 0, j = 0, k = 0;
   if (inst1->t < inter->lower)
   {
-    inst1 = tofreeinst = tsequence_at_timestamp(seq1, inter->lower);
+    inst1 = tsequence_at_timestamp(seq1, inter->lower);
     i = tsequence_find_timestamp(seq1, inter->lower);
   }
   else if (inst2->t < inter->lower)
   {
-    inst2 = tofreeinst = tsequence_at_timestamp(seq2, inter->lower);
+    inst2 = tsequence_at_timestamp(seq2, inter->lower);
     j = tsequence_find_timestamp(seq2, inter->lower);
   }
   int count = (seq1->count - i + seq2->count - j) * 2;
   TInstant **instants1 = palloc(sizeof(TInstant *) * count);
   TInstant **instants2 = palloc(sizeof(TInstant *) * count);
-  TInstant **tofree = palloc(sizeof(TInstant *) * count * 2);
-  if (tofreeinst != NULL)
-    tofree[l++] = tofreeinst;
   while (i < seq1->count && j < seq2->count &&
     (inst1->t <= inter->upper || inst2->t <= inter->upper))
   {
@@ -1536,13 +2195,11 @@ synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
     {
       i++;
       inst2 = tsequence_at_timestamp(seq2, inst1->t);
-      tofree[l++] = inst2;
     }
     else
     {
       j++;
       inst1 = tsequence_at_timestamp(seq1, inst2->t);
-      tofree[l++] = inst1;
     }
     /* If not the first instant add potential crossing before adding
        the new instants */
@@ -1553,10 +2210,8 @@ synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
       if (tsequence_intersection(instants1[k - 1], inst1, linear1,
         instants2[k - 1], inst2, linear2, &inter1, &inter2, &crosstime))
       {
-        instants1[k] = tofree[l++] = tinstant_make(inter1,
-          crosstime, seq1->valuetypid);
-        instants2[k++] = tofree[l++] = tinstant_make(inter2,
-          crosstime, seq2->valuetypid);
+        instants1[k] = tinstant_make(inter1, crosstime, seq1->valuetypid);
+        instants2[k++] = tinstant_make(inter2, crosstime, seq2->valuetypid);
       }
     }
     instants1[k] = inst1; instants2[k++] = inst2;
@@ -1575,7 +2230,6 @@ synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
     {
       instants1[k - 1] = tinstant_make(tinstant_value(instants1[k - 2]),
         instants1[k - 1]->t, instants1[k - 1]->valuetypid);
-      tofree[l++] = instants1[k - 1];
     }
   }
   if (! inter->upper_inc && k > 1 && ! linear2)
@@ -1585,17 +2239,15 @@ synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
     {
       instants2[k - 1] = tinstant_make(tinstant_value(instants2[k - 2]),
         instants2[k - 1]->t, instants2[k - 1]->valuetypid);
-      tofree[l++] = instants2[k - 1];
     }
   }
-  *sync1 = tsequence_make(instants1, k, inter->lower_inc,
+  MemoryContextSwitchTo(oldcontext);
+  *sync1 = tsequence_make1(instants1, k, inter->lower_inc,
     inter->upper_inc, linear1, NORMALIZE_NO);
-  *sync2 = tsequence_make(instants2, k, inter->lower_inc,
+  *sync2 = tsequence_make1(instants2, k, inter->lower_inc,
     inter->upper_inc, linear2, NORMALIZE_NO);
-
-  for (i = 0; i < l; i++)
-    pfree(tofree[i]);
-  pfree(instants1); pfree(instants2); pfree(tofree); pfree(inter);
+  MemoryContextDelete(scratch);
+  pfree(inter);
 
   return true;
 }
@@ -1728,6 +2380,9 @@ tfloatseq_to_tintseq(const TSequence *seq)
     Datum *value_ptr = tinstant_value_ptr(inst);
     *value_ptr = Int32GetDatum((double)DatumGetFloat8(tinstant_value(inst)));
   }
+  /* The values are truncated, which changes the integral */
+  if (MOBDB_FLAGS_GET_METRICS(result->flags))
+    tsequence_set_metrics(result);
   return result;
 }
 
@@ -2180,6 +2835,18 @@ tsequence_shift_tscale(const TSequence *seq, const Interval *start,
   /* Shift and/or scale bounding box */
   void *bbox = tsequence_bbox_ptr(result);
   temporal_bbox_shift_tscale(bbox, start, duration, seq->valuetypid);
+  /* Recompute the block boxes and, when the duration changes, the metrics */
+  if (MOBDB_FLAGS_GET_BLOCKS(result->flags))
+  {
+    TInstant **instants = palloc(sizeof(TInstant *) * result->count);
+    for (int i = 0; i < result->count; i++)
+      instants[i] = tsequence_inst_n(result, i);
+    tpointseq_make_blocks((STBOX *) tpointseq_blocks_ptr(result), instants,
+      result->count);
+    pfree(instants);
+  }
+  if (duration != NULL && MOBDB_FLAGS_GET_METRICS(result->flags))
+    tsequence_set_metrics(result);
   return result;
 }
 
@@ -2245,6 +2912,16 @@ tsequence_ever_eq(const TSequence *seq, Datum value)
     return false;
   }
 
+  /* A temporal float with linear interpolation is continuous, it takes
+   * all the values strictly between the bounds of its bounding box */
+  if (seq->valuetypid == FLOAT8OID)
+  {
+    TBOX *box = tsequence_bbox_ptr(seq);
+    double d = DatumGetFloat8(value);
+    if (box->xmin < d && d < box->xmax)
+      return true;
+  }
+
   /* Linear interpolation*/
   TInstant *inst1 = tsequence_inst_n(seq, 0);
   bool lower_inc = seq->period.lower_inc;
@@ -2351,6 +3028,13 @@ tsequence_ever_lt(const TSequence *seq, Datum value)
   if (! temporal_bbox_ev_al_lt_le((Temporal *)seq, value, EVER))
     return false;
 
+  /* The minimum value of a temporal number is the one of its bounding box */
+  if (tnumber_base_type(seq->valuetypid))
+  {
+    TBOX *box = tsequence_bbox_ptr(seq);
+    return box->xmin < datum_double(value, seq->valuetypid);
+  }
+
   for (int i = 0; i < seq->count; i++)
   {
     Datum valueinst = tinstant_value(tsequence_inst_n(seq, i));
@@ -2371,6 +3055,17 @@ tsequence_ever_le(const TSequence *seq, Datum value)
   if (! temporal_bbox_ev_al_lt_le((Temporal *)seq, value, EVER))
     return false;
 
+  /* The bounding box test above is enough to compute the answer for
+   * temporal numbers unless the value is the minimum of a sequence with
+   * linear interpolation, which may only be reached at an exclusive bound */
+  if (tnumber_base_type(seq->valuetypid))
+  {
+    TBOX *box = tsequence_bbox_ptr(seq);
+    if (! MOBDB_FLAGS_GET_LINEAR(seq->flags) || seq->count == 1 ||
+      box->xmin < datum_double(value, seq->valuetypid))
+      return true;
+  }
+
   Datum value1;
 
   /* Stepwise interpolation or instantaneous sequence */
@@ -2411,6 +3106,15 @@ tsequence_always_lt(const TSequence *seq, Datum value)
   if (! temporal_bbox_ev_al_lt_le((Temporal *)seq, value, ALWAYS))
     return false;
 
+  /* The values of a temporal number are always less than a value greater
+   * than the maximum of its bounding box */
+  if (tnumber_base_type(seq->valuetypid))
+  {
+    TBOX *box = tsequence_bbox_ptr(seq);
+    if (box->xmax < datum_double(value, seq->valuetypid))
+      return true;
+  }
+
   Datum value1;
 
   /* Stepwise interpolation or instantaneous sequence */
@@ -2525,7 +3229,7 @@ tsequence_restrict_value2(TSequence **result,
   {
     instants[0] = (TInstant *) inst1;
     instants[1] = (TInstant *) inst2;
-    result[0] = tsequence_make(instants, 2, lower_inc && lower,
+    result[0] = tsequence_make1(instants, 2, lower_inc && lower,
       upper_inc && upper, linear, NORMALIZE_NO);
     return 1;
   }
@@ -2538,7 +3242,7 @@ tsequence_restrict_value2(TSequence **result,
     {
       instants[0] = (TInstant *) inst1;
       instants[1] = tinstant_make(value1, inst2->t, valuetypid);
-      result[k++] = tsequence_make(instants, 2, lower_inc, false,
+      result[k++] = tsequence_make1(instants, 2, lower_inc, false,
         linear, NORMALIZE_NO);
       pfree(instants[1]);
     }
@@ -2568,11 +3272,11 @@ tsequence_restrict_value2(TSequence **result,
     {
       instants[0] = (TInstant *) inst1;
       instants[1] = tinstant_make(projvalue, t, valuetypid);
-      result[0] = tsequence_make(instants, 2, lower_inc, false,
+      result[0] = tsequence_make1(instants, 2, lower_inc, false,
         LINEAR, NORMALIZE_NO);
       instants[0] = instants[1];
       instants[1] = (TInstant *) inst2;
-      result[1] = tsequence_make(instants, 2, false, upper_inc,
+      result[1] = tsequence_make1(instants, 2, false, upper_inc,
         LINEAR, NORMALIZE_NO);
       pfree(instants[0]);
       DATUM_FREE(projvalue, valuetypid);
@@ -2662,7 +3366,7 @@ tsequence_restrict_value(const TSequence *seq, Datum value, bool atfunc)
     count *= 2;
   TSequence **sequences = palloc(sizeof(TSequence *) * count);
   int newcount = tsequence_restrict_value1(sequences, seq, value, atfunc);
-  return tsequenceset_make_free(sequences, newcount, NORMALIZE);
+  return tsequenceset_make_free1(sequences, newcount, NORMALIZE);
 }
 
 /*****************************************************************************/
@@ -2745,7 +3449,7 @@ tsequence_restrict_values(const TSequence *seq, const Datum *values, int count,
   /* General case */
   TSequence **sequences = palloc(sizeof(TSequence *) * seq->count * count * 2);
   int newcount = tsequence_at_values1(sequences, seq, values, count);
-  TSequenceSet *atresult = tsequenceset_make_free(sequences, newcount, NORMALIZE);
+  TSequenceSet *atresult = tsequenceset_make_free1(sequences, newcount, NORMALIZE);
   if (atfunc)
     return atresult;
 
@@ -2804,7 +3508,7 @@ tnumberseq_restrict_range2(TSequence **result,
       return 0;
     instants[0] = (TInstant *) inst1;
     instants[1] = (TInstant *) inst2;
-    result[0] = tsequence_make(instants, 2, lower_inclu, upper_inclu,
+    result[0] = tsequence_make1(instants, 2, lower_inclu, upper_inclu,
       linear, NORMALIZE_NO);
     return 1;
   }
@@ -2818,7 +3522,7 @@ tnumberseq_restrict_range2(TSequence **result,
     {
       instants[0] = (TInstant *) inst1;
       instants[1] = tinstant_make(value1, inst2->t, valuetypid);
-      result[k++] = tsequence_make(instants, 2, lower_inclu, false,
+      result[k++] = tsequence_make1(instants, 2, lower_inclu, false,
         linear, NORMALIZE_NO);
       pfree(instants[1]);
     }
@@ -2853,7 +3557,7 @@ tnumberseq_restrict_range2(TSequence **result,
     /* MINUS */
     instants[0] = (TInstant *) inst1;
     instants[1] = (TInstant *) inst2;
-    result[0] = tsequence_make(instants, 2, lower_inclu, upper_inclu,
+    result[0] = tsequence_make1(instants, 2, lower_inclu, upper_inclu,
       linear, NORMALIZE_NO);
     return 1;
   }
@@ -2893,7 +3597,7 @@ tnumberseq_restrict_range2(TSequence **result,
     }
     instants[0] = (TInstant *)inst1;
     instants[1] = (TInstant *)inst2;
-    result[0] = tsequence_make(instants, 2, lower_inc1, upper_inc1,
+    result[0] = tsequence_make1(instants, 2, lower_inc1, upper_inc1,
       linear, NORMALIZE_NO);
     return 1;
   }
@@ -2942,7 +3646,7 @@ tnumberseq_restrict_range2(TSequence **result,
     }
 
     /* Create the result */
-    result[0] = tsequence_make(instants, 2, lower_inc1, upper_inc1,
+    result[0] = tsequence_make1(instants, 2, lower_inc1, upper_inc1,
       linear, NORMALIZE_NO);
     if (freei)
       pfree(instants[i]);
@@ -2977,18 +3681,18 @@ tnumberseq_restrict_range2(TSequence **result,
   {
     instants[0] = (TInstant *) inst1;
     instants[1] = instbounds[0];
-    result[k++] = tsequence_make(instants, 2, lower_inclu, lower_inc1,
+    result[k++] = tsequence_make1(instants, 2, lower_inclu, lower_inc1,
       linear, NORMALIZE_NO);
     instants[0] = instbounds[1];
     instants[1] = (TInstant *) inst2;
-    result[k++] = tsequence_make(instants, 2, upper_inc1, upper_inclu,
+    result[k++] = tsequence_make1(instants, 2, upper_inc1, upper_inclu,
       linear, NORMALIZE_NO);
   }
   else if (instbounds[0] != NULL)
   {
     instants[0] = (TInstant *) inst1;
     instants[1] = instbounds[0];
-    result[k++] = tsequence_make(instants, 2, lower_inclu, lower_inc1,
+    result[k++] = tsequence_make1(instants, 2, lower_inclu, lower_inc1,
       linear, NORMALIZE_NO);
     if (upper_inclu && upper_inc1)
       result[k++] = tinstant_to_tsequence(inst2, linear);
@@ -2999,7 +3703,7 @@ tnumberseq_restrict_range2(TSequence **result,
       result[k++] = tinstant_to_tsequence(inst1, linear);
     instants[0] = instbounds[1];
     instants[1] = (TInstant *) inst2;
-    result[k++] = tsequence_make(instants, 2, upper_inc1, upper_inclu,
+    result[k++] = tsequence_make1(instants, 2, upper_inc1, upper_inclu,
       linear, NORMALIZE_NO);
   }
 
@@ -3095,7 +3799,7 @@ tnumberseq_restrict_range(const TSequence *seq, RangeType *range, bool atfunc)
     count *= 2;
   TSequence **sequences = palloc(sizeof(TSequence *) * count);
   int newcount = tnumberseq_restrict_range1(sequences, seq, range, atfunc);
-  return tsequenceset_make_free(sequences, newcount, NORMALIZE);
+  return tsequenceset_make_free1(sequences, newcount, NORMALIZE);
 }
 
 /*****************************************************************************/
@@ -3240,7 +3944,7 @@ tnumberseq_restrict_ranges(const TSequence *seq, RangeType **normranges,
   TSequence **sequences = palloc(sizeof(TSequence *) * maxcount);
   int newcount = tnumberseq_restrict_ranges1(sequences, seq, normranges,
     count, atfunc, bboxtest);
-  return tsequenceset_make_free(sequences, newcount, NORMALIZE);
+  return tsequenceset_make_free1(sequences, newcount, NORMALIZE);
 }
 
 /*****************************************************************************/
@@ -3365,6 +4069,32 @@ tsequence_value_at_timestamp(const TSequence *seq, TimestampTz t, Datum *result)
   return true;
 }
 
+/**
+ * Returns the base value of the temporal value at the timestamp starting
+ * the search of the timestamp from a cursor
+ *
+ * @param[in] seq Temporal value
+ * @param[in] t Timestamp
+ * @param[in,out] cursor Segment of the previous search, -1 if none
+ * @param[out] result Base value
+ * @result Returns true if the timestamp is contained in the temporal value
+ */
+bool
+tsequence_value_at_timestamp_cursor(const TSequence *seq, TimestampTz t,
+  int *cursor, Datum *result)
+{
+  if (seq->count == 1)
+    return tsequence_value_at_timestamp(seq, t, result);
+  int n = tsequence_find_timestamp_cursor(seq, t, cursor);
+  if (n < 0)
+    return false;
+  TInstant *inst1 = tsequence_inst_n(seq, n);
+  TInstant *inst2 = tsequence_inst_n(seq, n + 1);
+  *result = tsequence_value_at_timestamp1(inst1, inst2,
+    MOBDB_FLAGS_GET_LINEAR(seq->flags), t);
+  return true;
+}
+
 /**
  * Returns the base value of the temporal value at the timestamp when the
  * timestamp may be at an exclusive bound
@@ -3473,14 +4203,14 @@ tsequence_minus_timestamp1(TSequence **result, const TSequence *seq,
       if (linear)
       {
         instants[n] = inst1;
-        result[k++] = tsequence_make(instants, n + 1,
+        result[k++] = tsequence_make1(instants, n + 1,
           seq->period.lower_inc, false, linear, NORMALIZE_NO);
       }
       else
       {
         instants[n] = tinstant_make(tinstant_value(instants[n - 1]), t,
           inst1->valuetypid);
-        result[k++] = tsequence_make(instants, n + 1,
+        result[k++] = tsequence_make1(instants, n + 1,
           seq->period.lower_inc, false, linear, NORMALIZE_NO);
         pfree(instants[n]);
       }
@@ -3493,7 +4223,7 @@ tsequence_minus_timestamp1(TSequence **result, const TSequence *seq,
         tsequence_at_timestamp1(inst1, inst2, true, t) :
         tinstant_make(tinstant_value(inst1), t,
           inst1->valuetypid);
-      result[k++] = tsequence_make(instants, n + 2,
+      result[k++] = tsequence_make1(instants, n + 2,
         seq->period.lower_inc, false, linear, NORMALIZE_NO);
       pfree(instants[n + 1]);
     }
@@ -3506,7 +4236,7 @@ tsequence_minus_timestamp1(TSequence **result, const TSequence *seq,
     instants[0] = tsequence_at_timestamp1(inst1, inst2, linear, t);
     for (int i = 1; i < seq->count - n; i++)
       instants[i] = tsequence_inst_n(seq, i + n);
-    result[k++] = tsequence_make(instants, seq->count - n,
+    result[k++] = tsequence_make1(instants, seq->count - n,
       false, seq->period.upper_inc, linear, NORMALIZE_NO);
     pfree(instants[0]);
   }
@@ -3527,7 +4257,7 @@ tsequence_minus_timestamp(const TSequence *seq, TimestampTz t)
   int count = tsequence_minus_timestamp1((TSequence **)sequences, seq, t);
   if (count == 0)
     return NULL;
-  TSequenceSet *result = tsequenceset_make(sequences, count, NORMALIZE_NO);
+  TSequenceSet *result = tsequenceset_make1(sequences, count, NORMALIZE_NO);
   for (int i = 0; i < count; i++)
     pfree(sequences[i]);
   return result;
@@ -3535,6 +4265,55 @@ tsequence_minus_timestamp(const TSequence *seq, TimestampTz t)
 
 /*****************************************************************************/
 
+/**
+ * Restricts the temporal value to the timestamp set by scanning in parallel
+ * the instants of the sequence and the timestamps of the set
+ *
+ * @param[out] result Array on which the pointers of the newly constructed
+ * instants are stored
+ * @param[in] seq Temporal value
+ * @param[in] ts Timestamp set
+ * @param[in,out] loc Position of the first timestamp of the set to consider.
+ * On exit it is the position of the first timestamp after the sequence.
+ * @return Number of resulting instants
+ * @note This function is called for each sequence of a temporal sequence set
+ */
+int
+tsequence_at_timestampset1(TInstant **result, const TSequence *seq,
+  const TimestampSet *ts, int *loc)
+{
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  TInstant *inst2 = (seq->count == 1) ? inst1 : tsequence_inst_n(seq, 1);
+  int i = *loc, j = 1, k = 0;
+  while (i < ts->count)
+  {
+    TimestampTz t = timestampset_time_n(ts, i);
+    /* The timestamp may belong to the next sequence of a sequence set */
+    if (t > seq->period.upper ||
+      (t == seq->period.upper && ! seq->period.upper_inc))
+      break;
+    if (contains_period_timestamp_internal(&seq->period, t))
+    {
+      if (seq->count == 1)
+        result[k++] = tinstant_copy(inst1);
+      else
+      {
+        /* Advance to the segment containing the timestamp */
+        while (inst2->t < t)
+        {
+          inst1 = inst2;
+          inst2 = tsequence_inst_n(seq, ++j);
+        }
+        result[k++] = tsequence_at_timestamp1(inst1, inst2, linear, t);
+      }
+    }
+    i++;
+  }
+  *loc = i;
+  return k;
+}
+
 /**
  * Restricts the temporal value to the timestamp set
  */
@@ -3572,15 +4351,8 @@ tsequence_at_timestampset(const TSequence *seq, const TimestampSet *ts)
   int loc;
   timestampset_find_timestamp(ts, t, &loc);
   TInstant **instants = palloc(sizeof(TInstant *) * (ts->count - loc));
-  int k = 0;
-  for (int i = loc; i < ts->count; i++)
-  {
-    t = timestampset_time_n(ts, i);
-    inst = tsequence_at_timestamp(seq, t);
-    if (inst != NULL)
-      instants[k++] = inst;
-  }
-  return tinstantset_make_free(instants, k);
+  int count = tsequence_at_timestampset1(instants, seq, ts, &loc);
+  return tinstantset_make_free(instants, count);
 }
 
 /*****************************************************************************/
@@ -3646,7 +4418,7 @@ tsequence_minus_timestampset1(TSequence **result, const TSequence *seq,
       if (linear)
       {
         instants[l] = inst;
-        result[k++] = tsequence_make(instants, l + 1,
+        result[k++] = tsequence_make1(instants, l + 1,
           lower_inc, false, linear, NORMALIZE_NO);
         instants[0] = inst;
       }
@@ -3654,7 +4426,7 @@ tsequence_minus_timestampset1(TSequence **result, const TSequence *seq,
       {
         instants[l] = tinstant_make(tinstant_value(instants[l - 1]),
           t, inst->valuetypid);
-        result[k++] = tsequence_make(instants, l + 1,
+        result[k++] = tsequence_make1(instants, l + 1,
           lower_inc, false, linear, NORMALIZE_NO);
         pfree(instants[l]);
         if (tofree)
@@ -3679,7 +4451,7 @@ tsequence_minus_timestampset1(TSequence **result, const TSequence *seq,
           tsequence_at_timestamp1(instants[l - 1], inst, true, t) :
           tinstant_make(tinstant_value(instants[l - 1]), t,
             inst->valuetypid);
-        result[k++] = tsequence_make(instants, l + 1,
+        result[k++] = tsequence_make1(instants, l + 1,
           lower_inc, false, linear, NORMALIZE_NO);
         if (tofree)
           pfree(tofree);
@@ -3695,7 +4467,7 @@ tsequence_minus_timestampset1(TSequence **result, const TSequence *seq,
   {
     for (j = i; j < seq->count; j++)
       instants[l++] = tsequence_inst_n(seq, j);
-    result[k++] = tsequence_make(instants, l,
+    result[k++] = tsequence_make1(instants, l,
       false, seq->period.upper_inc, linear, NORMALIZE_NO);
   }
   if (tofree)
@@ -3711,7 +4483,7 @@ tsequence_minus_timestampset(const TSequence *seq, const TimestampSet *ts)
 {
   TSequence **sequences = palloc0(sizeof(TSequence *) * (ts->count + 1));
   int count = tsequence_minus_timestampset1(sequences, seq, ts);
-  return tsequenceset_make_free(sequences, count, NORMALIZE);
+  return tsequenceset_make_free1(sequences, count, NORMALIZE);
 }
 
 /*****************************************************************************/
@@ -3778,7 +4550,7 @@ tsequence_at_period(const TSequence *seq, const Period *p)
   }
   /* Since by definition the sequence is normalized it is not necessary to
    * normalize the projection of the sequence to the period */
-  result = tsequence_make(instants, k, inter->lower_inc, inter->upper_inc,
+  result = tsequence_make1(instants, k, inter->lower_inc, inter->upper_inc,
     linear, NORMALIZE_NO);
 
   pfree(instants[0]); pfree(instants[k - 1]); pfree(instants); pfree(inter);
@@ -3833,7 +4605,7 @@ tsequence_minus_period(const TSequence *seq, const Period *p)
   int count = tsequence_minus_period1(sequences, seq, p);
   if (count == 0)
     return NULL;
-  TSequenceSet *result = tsequenceset_make(sequences, count, NORMALIZE_NO);
+  TSequenceSet *result = tsequenceset_make1(sequences, count, NORMALIZE_NO);
   for (int i = 0; i < count; i++)
     pfree(sequences[i]);
   return result;
@@ -3980,7 +4752,7 @@ tsequence_restrict_periodset(const TSequence *seq, const PeriodSet *ps,
   TSequence **sequences = palloc(sizeof(TSequence *) * count);
   int count1 = atfunc ? tsequence_at_periodset(sequences, seq, ps) :
     tsequence_minus_periodset(sequences, seq, ps, 0);
-  return tsequenceset_make_free(sequences, count1, NORMALIZE_NO);
+  return tsequenceset_make_free1(sequences, count1, NORMALIZE_NO);
 }
 
 /*****************************************************************************
@@ -4039,26 +4811,16 @@ tsequence_intersects_periodset(const TSequence *seq, const PeriodSet *ps)
 double
 tnumberseq_integral(const TSequence *seq)
 {
+  const TSequenceMetrics *metrics = tsequence_metrics_ptr(seq);
+  if (metrics != NULL)
+    return metrics->integral;
   double result = 0;
   TInstant *inst1 = tsequence_inst_n(seq, 0);
   for (int i = 1; i < seq->count; i++)
   {
     TInstant *inst2 = tsequence_inst_n(seq, i);
-    if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
-    {
-      /* Linear interpolation */
-      double min = Min(DatumGetFloat8(tinstant_value(inst1)),
-        DatumGetFloat8(tinstant_value(inst2)));
-      double max = Max(DatumGetFloat8(tinstant_value(inst1)),
-        DatumGetFloat8(tinstant_value(inst2)));
-      result += (max + min) * (double) (inst2->t - inst1->t) / 2.0;
-    }
-    else
-    {
-      /* Step interpolation */
-      result += datum_double(tinstant_value(inst1), inst1->valuetypid) *
-        (double) (inst2->t - inst1->t);
-    }
+    result += tnumbersegm_integral(inst1, inst2,
+      MOBDB_FLAGS_GET_LINEAR(seq->flags));
     inst1 = inst2;
   }
   return result;
@@ -13,6 +13,7 @@
 #include "tsequenceset.h"
 
 #include <assert.h>
+#include <lib/binaryheap.h>
 #include <libpq/pqformat.h>
 #include <utils/lsyscache.h>
 #include <utils/builtins.h>
@@ -48,6 +49,11 @@ tsequenceset_seq_n(const TSequenceSet *ts, int index)
 
 /**
  * Returns a pointer to the precomputed bounding box of the temporal value
+ *
+ * The offset of the bounding box is kept in the offsets array, which
+ * makes the function valid both for the values having the BBOXFIRST flag
+ * and for those of previous versions whose bounding box follows the
+ * composing values
  */
 void *
 tsequenceset_bbox_ptr(const TSequenceSet *ts)
@@ -78,13 +84,18 @@ tsequenceset_bbox(void *box, const TSequenceSet *ts)
  * ( TSequenceSet )_X | offset_0 | offset_1 | offset_2 | ...
  * --------------------------------------------------------
  * --------------------------------------------------------
- * ( TSequence_0 )_X | ( TSequence_1 )_X | ( bbox )_X |
+ * ( bbox )_X | ( TSequence_0 )_X | ( TSequence_1 )_X |
  * --------------------------------------------------------
  * @endcode
  * where the `_X` are unused bytes added for double padding, `offset_0` and
  * `offset_1` are offsets for the corresponding sequences and `offset_2`
- * is the offset for the bounding box. Temporal sequence set values do not
- * have precomputed trajectory.
+ * is the offset for the bounding box, which is stored first so that it can
+ * be fetched without detoasting the whole value. Temporal sequence set
+ * values do not have precomputed trajectory.
+ * Values with at least `TIME_SUMMARY_MINCOUNT` sequences are followed by a
+ * time summary, that is, the array of the lower bounds of every
+ * `TIME_SUMMARY_BLOCK_SIZE`-th sequence, which is used for speeding up the
+ * binary search of a timestamp.
  *
  * @param[in] sequences Array of sequences
  * @param[in] count Number of elements in the array
@@ -98,7 +109,49 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
   /* Test the validity of the sequences */
   assert(count > 0);
   ensure_valid_tsequencearr(sequences, count);
+  return tsequenceset_make1(sequences, count, normalize);
+}
+
+#ifdef USE_ASSERT_CHECKING
+/**
+ * Returns true if the sequences for creating a temporal sequence set value
+ * are valid. This function does not raise errors since it is only used in
+ * the assertions of the constructors that trust their arguments.
+ */
+static bool
+tsequenceset_valid_args(TSequence **sequences, int count)
+{
+  if (count <= 0)
+    return false;
+  for (int i = 1; i < count; i++)
+  {
+    const Period *p1 = &sequences[i - 1]->period;
+    const Period *p2 = &sequences[i]->period;
+    if (p1->upper > p2->lower ||
+      (p1->upper == p2->lower && p1->upper_inc && p2->lower_inc) ||
+      sequences[i - 1]->valuetypid != sequences[i]->valuetypid ||
+      MOBDB_FLAGS_GET_LINEAR(sequences[i - 1]->flags) !=
+        MOBDB_FLAGS_GET_LINEAR(sequences[i]->flags))
+      return false;
+  }
+  return true;
+}
+#endif
 
+/**
+ * Construct a temporal sequence set value from the array of temporal
+ * sequence values without verifying their validity
+ *
+ * This is the trusted constructor used for the results of functions such as
+ * restriction or synchronization computed from valid temporal values, the
+ * validity of the arguments is only asserted in builds with assertions
+ * enabled.
+ * @pre The validity of the arguments has been tested before
+ */
+TSequenceSet *
+tsequenceset_make1(TSequence **sequences, int count, bool normalize)
+{
+  Assert(tsequenceset_valid_args(sequences, count));
   TSequence **newsequences = sequences;
   int newcount = count;
   if (normalize && count > 1)
@@ -116,6 +169,10 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
   /* Get the bounding box size */
   size_t bboxsize = temporal_bbox_size(sequences[0]->valuetypid);
   memsize += double_pad(bboxsize);
+  /* Add the size of the time summary, which is stored at the end */
+  int nkeys = newcount >= TIME_SUMMARY_MINCOUNT ?
+    time_summary_count(newcount) : 0;
+  memsize += double_pad(sizeof(TimestampTz) * nkeys);
   TSequenceSet *result = palloc0(pdata + memsize);
   SET_VARSIZE(result, pdata + memsize);
   result->count = newcount;
@@ -126,6 +183,7 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
     MOBDB_FLAGS_GET_LINEAR(sequences[0]->flags));
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
+  MOBDB_FLAGS_SET_BBOXFIRST(result->flags, true);
   if (tgeo_base_type(sequences[0]->valuetypid))
   {
     MOBDB_FLAGS_SET_Z(result->flags,
@@ -133,8 +191,22 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
     MOBDB_FLAGS_SET_GEODETIC(result->flags,
       MOBDB_FLAGS_GET_GEODETIC(sequences[0]->flags));
   }
-  /* Initialization of the variable-length part */
+  /*
+   * Precompute the bounding box
+   * Only external types have precomputed bounding box, internal types such
+   * as double2, double3, or double4 do not have precomputed bounding box.
+   * The bounding box is located at the beginning of the variable-length
+   * part so that it can be read without detoasting the whole value.
+   */
   size_t pos = 0;
+  if (bboxsize != 0)
+  {
+    void *bbox = ((char *) result) + pdata;
+    tsequenceset_make_bbox(bbox, newsequences, newcount);
+    result->offsets[newcount] = pos;
+    pos += double_pad(bboxsize);
+  }
+  /* Initialization of the variable-length part */
   for (int i = 0; i < newcount; i++)
   {
     memcpy(((char *) result) + pdata + pos, newsequences[i],
@@ -142,16 +214,13 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
     result->offsets[i] = pos;
     pos += double_pad(VARSIZE(newsequences[i]));
   }
-  /*
-   * Precompute the bounding box
-   * Only external types have precomputed bounding box, internal types such
-   * as double2, double3, or double4 do not have precomputed bounding box
-   */
-  if (bboxsize != 0)
+  /* Initialization of the time summary */
+  if (nkeys > 0)
   {
-    void *bbox = ((char *) result) + pdata + pos;
-    tsequenceset_make_bbox(bbox, newsequences, newcount);
-    result->offsets[newcount] = pos;
+    TimestampTz *keys = (TimestampTz *) (((char *) result) + pdata + pos);
+    for (int i = 0; i < nkeys; i++)
+      keys[i] = newsequences[i * TIME_SUMMARY_BLOCK_SIZE]->period.lower;
+    MOBDB_FLAGS_SET_TIMES(result->flags, true);
   }
   if (normalize && count > 1)
   {
@@ -185,6 +254,28 @@ tsequenceset_make_free(TSequence **sequences, int count, bool normalize)
   return result;
 }
 
+/**
+ * Construct a temporal sequence set value from the array of temporal
+ * sequence values without verifying their validity and free the array and
+ * the sequences after the creation
+ *
+ * @pre The validity of the arguments has been tested before
+ */
+TSequenceSet *
+tsequenceset_make_free1(TSequence **sequences, int count, bool normalize)
+{
+  if (count == 0)
+  {
+    pfree(sequences);
+    return NULL;
+  }
+  TSequenceSet *result = tsequenceset_make1(sequences, count, normalize);
+  for (int i = 0; i < count; i++)
+    pfree(sequences[i]);
+  pfree(sequences);
+  return result;
+}
+
 /**
  * Construct a temporal sequence set value from the temporal sequence
  */
@@ -268,10 +359,42 @@ tsequenceset_merge(const TSequenceSet *ts1, const TSequenceSet *ts2)
   return tsequenceset_merge_array((TSequenceSet **) seqsets, 2);
 }
 
+/**
+ * Structure to represent the state of the k-way merge of sequence sets
+ */
+typedef struct
+{
+  TSequenceSet **seqsets;  /**< sequence sets that are merged */
+  int *pos;                /**< position of the next sequence of each one */
+} SeqSetMergeState;
+
+/**
+ * Comparator function of the binary heap of the k-way merge, which orders
+ * the sequence sets by the period of their next sequence
+ */
+static int
+tsequenceset_merge_cmp(Datum a, Datum b, void *arg)
+{
+  SeqSetMergeState *state = (SeqSetMergeState *) arg;
+  int i = DatumGetInt32(a), j = DatumGetInt32(b);
+  TSequence *seq1 = tsequenceset_seq_n(state->seqsets[i], state->pos[i]);
+  TSequence *seq2 = tsequenceset_seq_n(state->seqsets[j], state->pos[j]);
+  /* The binary heap keeps the greatest element first */
+  int result = period_cmp_internal(&seq2->period, &seq1->period);
+  if (result == 0)
+    result = (i < j) ? 1 : ((i > j) ? -1 : 0);
+  return result;
+}
+
 /**
  * Merge the array of temporal sequence set values.
  * The values in the array may overlap in a single instant.
  *
+ * Since the sequences of each sequence set are sorted, the sequences of
+ * all the sequence sets are sorted with a k-way merge using a binary heap
+ * of the sequence sets. The merged sequences are then validated and
+ * normalized in a single pass.
+ *
  * @param[in] seqsets Array of values
  * @param[in] count Number of elements in the array
  * @result Merged value
@@ -279,21 +402,43 @@ tsequenceset_merge(const TSequenceSet *ts1, const TSequenceSet *ts2)
 TSequenceSet *
 tsequenceset_merge_array(TSequenceSet **seqsets, int count)
 {
-  /* Validity test will be done in tsequence_merge_array */
+  /* Validity test will be done in tsequence_merge_sorted */
   int totalcount = 0;
   for (int i = 0; i < count; i++)
     totalcount += seqsets[i]->count;
-  /* Collect the composing sequences */
-  TSequence **sequences = palloc0(sizeof(TSequence *) * totalcount);
+  TSequence **sequences = palloc(sizeof(TSequence *) * totalcount);
   int k = 0;
-  for (int i = 0; i < count; i++)
+  if (count == 1)
   {
-    for (int j = 0; j < seqsets[i]->count; j++)
-      sequences[k++] = tsequenceset_seq_n(seqsets[i], j);
+    for (int j = 0; j < seqsets[0]->count; j++)
+      sequences[k++] = tsequenceset_seq_n(seqsets[0], j);
   }
-  int newcount;
-  TSequence **newseqs = tsequence_merge_array1(sequences, totalcount, &newcount);
-  return tsequenceset_make_free(newseqs, newcount, NORMALIZE_NO);
+  else
+  {
+    SeqSetMergeState state;
+    state.seqsets = seqsets;
+    state.pos = palloc0(sizeof(int) * count);
+    binaryheap *heap = binaryheap_allocate(count, &tsequenceset_merge_cmp,
+      &state);
+    for (int i = 0; i < count; i++)
+      binaryheap_add_unordered(heap, Int32GetDatum(i));
+    binaryheap_build(heap);
+    while (! binaryheap_empty(heap))
+    {
+      int i = DatumGetInt32(binaryheap_first(heap));
+      sequences[k++] = tsequenceset_seq_n(seqsets[i], state.pos[i]++);
+      if (state.pos[i] < seqsets[i]->count)
+        binaryheap_replace_first(heap, Int32GetDatum(i));
+      else
+        binaryheap_remove_first(heap);
+    }
+    binaryheap_free(heap);
+    pfree(state.pos);
+  }
+  TSequenceSet *result = (TSequenceSet *) tsequence_merge_sorted(sequences,
+    totalcount, true);
+  pfree(sequences);
+  return result;
 }
 
 /**
@@ -309,6 +454,19 @@ tsequenceset_copy(const TSequenceSet *ts)
 
 /*****************************************************************************/
 
+/**
+ * Returns a pointer to the time summary of the temporal value, which is
+ * stored at the end of the value
+ * @pre The value keeps a time summary
+ */
+static const TimestampTz *
+tsequenceset_time_summary(const TSequenceSet *ts)
+{
+  int nkeys = time_summary_count(ts->count);
+  return (const TimestampTz *) ((char *) ts + VARSIZE(ts) -
+    double_pad(sizeof(TimestampTz) * nkeys));
+}
+
 /**
  * Returns the location of the timestamp in the temporal sequence set value
  * using binary search
@@ -339,6 +497,21 @@ tsequenceset_find_timestamp(const TSequenceSet *ts, TimestampTz t, int *loc)
   int first = 0, last = ts->count - 1;
   int middle = 0; /* make compiler quiet */
   TSequence *seq = NULL; /* make compiler quiet */
+  if (MOBDB_FLAGS_GET_TIMES(ts->flags))
+  {
+    /* Restrict the search to the block of the time summary. The block is
+     * extended with the last sequence of the previous block, whose upper
+     * bound may be equal to the key of the block */
+    int nkeys = time_summary_count(ts->count);
+    int block = time_summary_find(tsequenceset_time_summary(ts), nkeys, t);
+    if (block < 0)
+    {
+      *loc = 0;
+      return false;
+    }
+    first = Max(block * TIME_SUMMARY_BLOCK_SIZE - 1, 0);
+    last = Min((block + 1) * TIME_SUMMARY_BLOCK_SIZE, ts->count) - 1;
+  }
   while (first <= last)
   {
     middle = (first + last)/2;
@@ -1101,14 +1274,12 @@ ArrayType *
 tsequenceset_instants_array(const TSequenceSet *ts)
 {
   TInstant **instants = palloc(sizeof(TInstant *) * ts->totalcount);
-  int k = 0;
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    for (int j = 0; j < seq->count; j++)
-      instants[k++] = tsequence_inst_n(seq, j);
-  }
-  int count = tinstantarr_remove_duplicates(instants, k);
+  TInstantIterator iter;
+  tinstant_iterator_init(&iter, (Temporal *) ts);
+  const TInstant *inst;
+  int count = 0;
+  while ((inst = tinstant_iterator_next(&iter)) != NULL)
+    instants[count++] = (TInstant *) inst;
   ArrayType *result = temporalarr_to_array((Temporal **)instants, count);
   pfree(instants);
   return result;
@@ -1214,17 +1385,11 @@ tsequenceset_timestamp_n(const TSequenceSet *ts, int n, TimestampTz *result)
 int
 tsequenceset_timestamps1(TimestampTz *result, const TSequenceSet *ts)
 {
+  TInstantIterator iter;
+  tinstant_iterator_init(&iter, (Temporal *) ts);
   int k = 0;
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    k += tsequence_timestamps1(&result[k], seq);
-  }
-  if (k > 1)
-  {
-    timestamparr_sort(result, k);
-    k = timestamparr_remove_duplicates(result, k);
-  }
+  while (tinstant_iterator_next_timestamp(&iter, &result[k]))
+    k++;
   return k;
 }
 
@@ -1660,6 +1825,43 @@ tsequenceset_value_at_timestamp(const TSequenceSet *ts, TimestampTz t, Datum *re
   return tsequence_value_at_timestamp(tsequenceset_seq_n(ts, loc), t, result);
 }
 
+/**
+ * Returns the base value of the temporal value at the timestamp starting
+ * the search of the timestamp from a cursor
+ *
+ * The sequence of the cursor and the next one are tested before searching
+ * the sequence containing the timestamp, and the cursor in the sequence is
+ * reset when the sequence changes.
+ *
+ * @param[in] ts Temporal value
+ * @param[in] t Timestamp
+ * @param[in,out] cursor Position of the previous search
+ * @param[out] result Base value
+ * @result Returns true if the timestamp is contained in the temporal value
+ */
+bool
+tsequenceset_value_at_timestamp_cursor(const TSequenceSet *ts, TimestampTz t,
+  TimestampCursor *cursor, Datum *result)
+{
+  int loc = -1;
+  for (int i = 0; i < 2 && loc < 0; i++)
+  {
+    int n = cursor->seqno + i;
+    if (cursor->seqno >= 0 && n < ts->count &&
+      contains_period_timestamp_internal(&tsequenceset_seq_n(ts, n)->period, t))
+      loc = n;
+  }
+  if (loc < 0 && ! tsequenceset_find_timestamp(ts, t, &loc))
+    return false;
+  if (loc != cursor->seqno)
+  {
+    cursor->seqno = loc;
+    cursor->segno = -1;
+  }
+  return tsequence_value_at_timestamp_cursor(tsequenceset_seq_n(ts, loc), t,
+    &cursor->segno, result);
+}
+
 /**
  * Returns the base value of the temporal value at the timestamp when the
  * timestamp may be at an exclusive bound
@@ -1736,25 +1938,13 @@ tsequenceset_restrict_timestampset(const TSequenceSet *ts1,
   TSequence *seq;
   if (atfunc)
   {
+    /* The sequences and the timestamps are scanned in parallel */
     TInstant **instants = palloc(sizeof(TInstant *) * ts2->count);
-    int count = 0;
-    int i = 0, j = 0;
-    while (i < ts2->count && j < ts1->count)
+    int count = 0, loc = 0;
+    for (int i = 0; i < ts1->count && loc < ts2->count; i++)
     {
-      seq = tsequenceset_seq_n(ts1, j);
-      TimestampTz t = timestampset_time_n(ts2, i);
-      if (contains_period_timestamp_internal(&seq->period, t))
-      {
-        instants[count++] = tsequence_at_timestamp(seq, t);
-        i++;
-      }
-      else
-      {
-        if (t <= seq->period.lower)
-          i++;
-        if (t >= seq->period.upper)
-          j++;
-      }
+      seq = tsequenceset_seq_n(ts1, i);
+      count += tsequence_at_timestampset1(&instants[count], seq, ts2, &loc);
     }
     return (Temporal *) tinstantset_make_free(instants, count);
   }
@@ -0,0 +1,94 @@
+-------------------------------------------------------------------------------
+-- Micro-benchmarks of the core functions on temporal values
+-- Run by the bench target of the build, which replaces MODULE_PATHNAME by
+-- the library of the extension. The results are given per input instant.
+-------------------------------------------------------------------------------
+
+CREATE OR REPLACE FUNCTION mobilitydb_bench(kernel text, iterations integer,
+    temp1 tfloat, temp2 tfloat DEFAULT NULL, OUT ns_per_instant float,
+    OUT bytes_per_instant float)
+  AS 'MODULE_PATHNAME', 'temporal_bench'
+  LANGUAGE C VOLATILE;
+CREATE OR REPLACE FUNCTION mobilitydb_bench(kernel text, iterations integer,
+    temp1 tgeompoint, temp2 tgeompoint DEFAULT NULL, geom geometry DEFAULT NULL,
+    OUT ns_per_instant float, OUT bytes_per_instant float)
+  AS 'MODULE_PATHNAME', 'temporal_bench'
+  LANGUAGE C VOLATILE;
+
+/* The skip list of the temporal aggregates is only available in an aggregate
+ * context, the executor is thus included in the measure */
+CREATE OR REPLACE FUNCTION mobilitydb_bench_tsum(size integer,
+    iterations integer, OUT ns_per_instant float)
+AS $$
+DECLARE
+  start timestamptz;
+BEGIN
+  start := clock_timestamp();
+  FOR j IN 1..iterations LOOP
+    PERFORM tsum(temp) FROM bench_tint t WHERE t.size = $1;
+  END LOOP;
+  ns_per_instant := extract(epoch FROM clock_timestamp() - start) * 1e9 /
+    iterations / (2 * size);
+END;
+$$ LANGUAGE plpgsql VOLATILE;
+
+-------------------------------------------------------------------------------
+-- Synthetic data of controlled sizes
+-- The values alternate to prevent the normalization of the sequences
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS bench_size, bench_tfloat, bench_tgeompoint, bench_tint;
+
+CREATE TABLE bench_size(size) AS VALUES (100), (10000), (100000);
+
+CREATE TABLE bench_tfloat AS
+SELECT size,
+  tfloatseq(array_agg(tfloatinst(CASE WHEN i % 2 = 0 THEN i ELSE -i END,
+    timestamptz '2000-01-01' + i * interval '1 sec') ORDER BY i)) AS temp1,
+  tfloatseq(array_agg(tfloatinst(CASE WHEN i % 2 = 0 THEN -i ELSE i END,
+    timestamptz '2000-01-01' + (i + 0.5) * interval '1 sec') ORDER BY i)) AS temp2
+FROM bench_size, generate_series(1, size) i
+GROUP BY size;
+
+CREATE TABLE bench_tgeompoint AS
+SELECT size,
+  tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2),
+    timestamptz '2000-01-01' + i * interval '1 sec') ORDER BY i)) AS temp1,
+  tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2 + 0.5),
+    timestamptz '2000-01-01' + (i + 0.5) * interval '1 sec') ORDER BY i)) AS temp2,
+  ST_MakeEnvelope(0, 0, size / 2, 1) AS geom
+FROM bench_size, generate_series(1, size) i
+GROUP BY size;
+
+CREATE TABLE bench_tint AS
+SELECT size, tintseq(i % 10, period(timestamptz '2000-01-01' + i * interval '1 sec',
+  timestamptz '2000-01-01' + (i + 10) * interval '1 sec')) AS temp
+FROM bench_size, generate_series(1, size) i;
+
+-------------------------------------------------------------------------------
+-- Benchmarks
+-------------------------------------------------------------------------------
+
+SELECT kernel, size, round(ns_per_instant::numeric, 1) AS ns_per_instant,
+  round(bytes_per_instant::numeric, 1) AS bytes_per_instant
+FROM bench_tfloat,
+  unnest(ARRAY['make', 'valueAtTimestamp', 'sync', 'parse', 'output']) kernel,
+  mobilitydb_bench(kernel, 10, temp1, temp2)
+ORDER BY kernel, size;
+
+SELECT kernel, size, round(ns_per_instant::numeric, 1) AS ns_per_instant,
+  round(bytes_per_instant::numeric, 1) AS bytes_per_instant
+FROM bench_tgeompoint,
+  unnest(ARRAY['make', 'valueAtTimestamp', 'atGeometry', 'tdwithin', 'parse',
+    'output']) kernel,
+  mobilitydb_bench(kernel, 10, temp1, temp2, geom)
+ORDER BY kernel, size;
+
+SELECT 'tsum' AS kernel, size,
+  round(ns_per_instant::numeric, 1) AS ns_per_instant
+FROM bench_size, mobilitydb_bench_tsum(size, 10)
+ORDER BY size;
+
+DROP TABLE bench_size, bench_tfloat, bench_tgeompoint, bench_tint;
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,161 @@
+-------------------------------------------------------------------------------
+-- End-to-end benchmark of BerlinMOD-style query families
+-- Run by the bench_berlinmod target of the build after the data generators
+-- in src/datagen and point/src/datagen. The following psql variables are
+-- used:
+--   scale     Number of temporal points generated (default 10000)
+--   run       Name of the run recorded in the results (default 'current')
+--   results   Absolute path of the CSV file where the results are written
+--   baseline  Absolute path of a CSV file of previous results, optional,
+--             against which the run is compared
+-------------------------------------------------------------------------------
+
+\set ON_ERROR_STOP 1
+\if :{?scale}
+\else
+\set scale 10000
+\endif
+\if :{?run}
+\else
+\set run current
+\endif
+
+SELECT setseed(0.5);
+
+DROP TABLE IF EXISTS bench_queries, bench_results, bench_baseline;
+
+CREATE TABLE bench_queries(family text, name text, query text);
+
+CREATE TABLE bench_results(run text, scale integer, family text, name text,
+  indexed boolean, latency_ms float, shared_hit bigint, shared_read bigint,
+  plan text, recorded_at timestamptz);
+
+CREATE TABLE bench_baseline (LIKE bench_results);
+
+/* Queries on the table tbl_tgeompoint_big of the data generator */
+INSERT INTO bench_queries VALUES
+('range', 'stbox',
+  'SELECT COUNT(*) FROM tbl_tgeompoint_big WHERE temp && '
+  'stbox ''STBOX T((10, 10, 2001-03-01), (30, 30, 2001-04-01))'''),
+('range', 'period',
+  'SELECT COUNT(*) FROM tbl_tgeompoint_big WHERE temp && '
+  'period ''[2001-06-01, 2001-06-02]'''),
+('range', 'intersects',
+  'SELECT COUNT(*) FROM tbl_tgeompoint_big WHERE intersects(temp, '
+  'geometry ''Polygon((20 20, 20 40, 40 40, 40 20, 20 20))'')'),
+('knn', 'nad',
+  'SELECT k FROM tbl_tgeompoint_big ORDER BY temp |=| '
+  'geometry ''Point(50 50)'' LIMIT 10'),
+('aggregation', 'extent',
+  'SELECT extent(temp) FROM tbl_tgeompoint_big'),
+('aggregation', 'tcount',
+  'SELECT tcount(temp) FROM tbl_tgeompoint_big WHERE temp && '
+  'period ''[2001-06-01, 2001-07-01]'''),
+('join', 'overlaps',
+  'SELECT COUNT(*) FROM tbl_tgeompoint_big t1, tbl_tgeompoint_big t2 '
+  'WHERE t1.k <= 100 AND t1.k < t2.k AND t1.temp && t2.temp'),
+('join', 'dwithin',
+  'SELECT COUNT(*) FROM tbl_tgeompoint_big t1, tbl_tgeompoint_big t2 '
+  'WHERE t1.k <= 100 AND t1.k < t2.k AND dwithin(t1.temp, t2.temp, 1)');
+
+/* Returns the node types of the plan and of its children */
+CREATE OR REPLACE FUNCTION bench_plan_shape(plan json)
+  RETURNS text AS $$
+DECLARE
+  children text;
+BEGIN
+  SELECT string_agg(bench_plan_shape(c), ', ') INTO children
+  FROM json_array_elements(plan->'Plans') c;
+  IF children IS NULL THEN
+    RETURN plan->>'Node Type';
+  END IF;
+  RETURN (plan->>'Node Type') || '(' || children || ')';
+END;
+$$ LANGUAGE plpgsql IMMUTABLE;
+
+/* Run the queries and record the fastest of the repetitions */
+CREATE OR REPLACE FUNCTION bench_run_queries(run text, scale integer,
+  indexed boolean, repeat integer)
+  RETURNS void AS $$
+DECLARE
+  q record;
+  plan json;
+  best json;
+BEGIN
+  FOR q IN SELECT * FROM bench_queries ORDER BY family, name LOOP
+    best := NULL;
+    FOR i IN 1..repeat LOOP
+      EXECUTE 'EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) ' || q.query
+        INTO plan;
+      IF best IS NULL OR (plan->0->>'Execution Time')::float <
+          (best->0->>'Execution Time')::float THEN
+        best := plan;
+      END IF;
+    END LOOP;
+    INSERT INTO bench_results VALUES (run, scale, q.family, q.name, indexed,
+      (best->0->>'Execution Time')::float,
+      (best->0->'Plan'->>'Shared Hit Blocks')::bigint,
+      (best->0->'Plan'->>'Shared Read Blocks')::bigint,
+      bench_plan_shape(best->0->'Plan'), now());
+  END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+
+/* Generate the data and run the queries without and with a GiST index */
+CREATE OR REPLACE FUNCTION bench_berlinmod(run text, scale integer,
+  repeat integer DEFAULT 3)
+  RETURNS void AS $$
+BEGIN
+  PERFORM create_test_tables_tpoint_big(scale);
+  ANALYZE tbl_tgeompoint_big;
+  PERFORM bench_run_queries(run, scale, false, repeat);
+  CREATE INDEX bench_tgeompoint_big_gist_idx ON tbl_tgeompoint_big
+    USING gist(temp);
+  ANALYZE tbl_tgeompoint_big;
+  PERFORM bench_run_queries(run, scale, true, repeat);
+  DROP INDEX bench_tgeompoint_big_gist_idx;
+END;
+$$ LANGUAGE plpgsql;
+
+/* Compare the results of the run with the baseline, a run is slower when its
+ * latency exceeds the one of the baseline by the tolerance factor */
+CREATE OR REPLACE FUNCTION bench_compare(run text, tolerance float DEFAULT 1.5)
+  RETURNS TABLE(family text, name text, indexed boolean, latency_ms float,
+    baseline_ms float, ratio float, status text) AS $$
+  SELECT r.family, r.name, r.indexed, r.latency_ms, b.latency_ms,
+    r.latency_ms / NULLIF(b.latency_ms, 0),
+    CASE
+      WHEN b.latency_ms IS NULL THEN 'no baseline'
+      WHEN r.plan <> b.plan THEN 'plan changed'
+      WHEN r.latency_ms > b.latency_ms * tolerance THEN 'slower'
+      ELSE 'ok'
+    END
+  FROM bench_results r LEFT JOIN bench_baseline b ON
+    r.family = b.family AND r.name = b.name AND r.indexed = b.indexed AND
+    r.scale = b.scale
+  WHERE r.run = $1
+  ORDER BY r.family, r.name, r.indexed;
+$$ LANGUAGE sql;
+
+-------------------------------------------------------------------------------
+
+SELECT bench_berlinmod(:'run', :scale);
+
+SELECT family, name, indexed, round(latency_ms::numeric, 3) AS latency_ms,
+  shared_hit, shared_read, plan
+FROM bench_results
+ORDER BY family, name, indexed;
+
+\if :{?results}
+COPY bench_results TO :'results' WITH (FORMAT csv, HEADER);
+\endif
+
+\if :{?baseline}
+COPY bench_baseline FROM :'baseline' WITH (FORMAT csv, HEADER);
+SELECT family, name, indexed, round(latency_ms::numeric, 3) AS latency_ms,
+  round(baseline_ms::numeric, 3) AS baseline_ms,
+  round(ratio::numeric, 2) AS ratio, status
+FROM bench_compare(:'run');
+\endif
+
+-------------------------------------------------------------------------------
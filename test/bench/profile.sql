@@ -0,0 +1,165 @@
+-------------------------------------------------------------------------------
+-- Performance profile of the SQL test files
+-- Run by the profile target of the build after the data generators in
+-- src/datagen and point/src/datagen, which create the tables of the
+-- regression tests with the given number of rows. The test files are then
+-- profiled with profile_file and the results are reported by
+-- profile_report.sql. The following psql variables are used:
+--   scale     Number of rows of the generated tables (default 1000)
+--   repeat    Number of executions of each query (default 5)
+--   run       Name of the run recorded in the results (default 'current')
+-------------------------------------------------------------------------------
+
+\set ON_ERROR_STOP 1
+\if :{?scale}
+\else
+\set scale 1000
+\endif
+\if :{?repeat}
+\else
+\set repeat 5
+\endif
+\if :{?run}
+\else
+\set run current
+\endif
+
+SELECT setseed(0.5);
+
+DROP TABLE IF EXISTS profile_results, profile_baseline;
+
+CREATE TABLE profile_results(run text, scale integer, file text,
+  query integer, md5 text, calls integer, mean_ms float, stddev_ms float,
+  shared_hit bigint, shared_read bigint, peak_memory_kb bigint,
+  query_text text, recorded_at timestamptz);
+
+CREATE TABLE profile_baseline (LIKE profile_results);
+
+/* Returns the maximum memory used by the sort and hash nodes of the plan and
+ * of its children, which is the only memory usage reported by EXPLAIN */
+CREATE OR REPLACE FUNCTION profile_plan_memory(plan json)
+  RETURNS bigint AS $$
+DECLARE
+  children bigint;
+BEGIN
+  SELECT max(profile_plan_memory(c)) INTO children
+  FROM json_array_elements(plan->'Plans') c;
+  RETURN greatest(children, (plan->>'Peak Memory Usage')::bigint,
+    CASE WHEN plan->>'Sort Space Type' = 'Memory'
+      THEN (plan->>'Sort Space Used')::bigint END, 0);
+END;
+$$ LANGUAGE plpgsql IMMUTABLE;
+
+/* Executes the query the given number of times and records the mean and
+ * the standard deviation of its execution time, and the buffers and the
+ * memory of its fastest execution. Returns false if the query fails. */
+CREATE OR REPLACE FUNCTION profile_query(run text, scale integer,
+  file text, queryno integer, stmt text, repeat integer)
+  RETURNS boolean AS $$
+DECLARE
+  plan json;
+  best json;
+  times float[] := '{}';
+BEGIN
+  FOR i IN 1..repeat LOOP
+    EXECUTE 'EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) ' || stmt INTO plan;
+    times := times || (plan->0->>'Execution Time')::float;
+    IF best IS NULL OR (plan->0->>'Execution Time')::float <
+        (best->0->>'Execution Time')::float THEN
+      best := plan;
+    END IF;
+  END LOOP;
+  INSERT INTO profile_results
+  SELECT run, scale, file, queryno, md5(stmt), repeat, avg(t),
+    coalesce(stddev_samp(t), 0),
+    (best->0->'Plan'->>'Shared Hit Blocks')::bigint,
+    (best->0->'Plan'->>'Shared Read Blocks')::bigint,
+    profile_plan_memory(best->0->'Plan'), stmt, now()
+  FROM unnest(times) t;
+  RETURN true;
+EXCEPTION WHEN OTHERS THEN
+  RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+
+/* Profiles the queries of the content of a test file and returns the number
+ * of queries profiled. The statements are separated by a semicolon at the
+ * end of a line outside of a dollar-quoted body. The SELECT statements are
+ * profiled, the other ones, which create the objects used by the queries,
+ * are only executed. The statements that fail, such as those of the error
+ * cases of the tests, are skipped. */
+CREATE OR REPLACE FUNCTION profile_file(run text, scale integer,
+  file text, content text, repeat integer)
+  RETURNS integer AS $func$
+DECLARE
+  line text;
+  stmt text := '';
+  queryno integer := 0;
+  result integer := 0;
+BEGIN
+  FOR line IN SELECT regexp_split_to_table(content, E'\n') LOOP
+    /* Skip the comments, the blank lines, and the psql commands */
+    IF stmt = '' AND (line ~ '^\s*(--|\\|$)' OR
+        line ~ '^\s*/\*.*\*/\s*$') THEN
+      CONTINUE;
+    END IF;
+    stmt := stmt || line || E'\n';
+    IF line !~ ';\s*$' OR
+        ((length(stmt) - length(replace(stmt, '$$', ''))) / 2) % 2 = 1 THEN
+      CONTINUE;
+    END IF;
+    queryno := queryno + 1;
+    IF stmt ~* '^\s*(SELECT|WITH)\M' THEN
+      IF profile_query(run, scale, file, queryno, stmt, repeat) THEN
+        result := result + 1;
+      END IF;
+    ELSE
+      BEGIN
+        EXECUTE stmt;
+      EXCEPTION WHEN OTHERS THEN
+        NULL;
+      END;
+    END IF;
+    stmt := '';
+  END LOOP;
+  RETURN result;
+END;
+$func$ LANGUAGE plpgsql;
+
+/* Compare the results of the run with the baseline. A query is slower or
+ * faster when its mean execution time differs from the one of the baseline
+ * by more than the tolerance factor and the difference is statistically
+ * significant according to the Welch's t-test, that is, when the t
+ * statistic exceeds the critical value. */
+CREATE OR REPLACE FUNCTION profile_compare(run text,
+  tolerance float DEFAULT 1.1, critical float DEFAULT 2.0)
+  RETURNS TABLE(file text, query integer, mean_ms float, baseline_ms float,
+    ratio float, t float, status text) AS $$
+  WITH cmp AS (
+    SELECT r.file, r.query, r.mean_ms, b.mean_ms AS baseline_ms,
+      r.mean_ms / NULLIF(b.mean_ms, 0) AS ratio,
+      (r.mean_ms - b.mean_ms) / NULLIF(sqrt(r.stddev_ms ^ 2 / r.calls +
+        b.stddev_ms ^ 2 / b.calls), 0) AS t
+    FROM profile_results r LEFT JOIN profile_baseline b ON
+      r.file = b.file AND r.md5 = b.md5 AND r.scale = b.scale
+    WHERE r.run = $1 )
+  SELECT file, query, mean_ms, baseline_ms, ratio, t,
+    CASE
+      WHEN baseline_ms IS NULL THEN 'no baseline'
+      WHEN mean_ms > baseline_ms * tolerance AND
+        (t IS NULL OR t > critical) THEN 'slower'
+      WHEN mean_ms * tolerance < baseline_ms AND
+        (t IS NULL OR t < - critical) THEN 'faster'
+      ELSE 'ok'
+    END
+  FROM cmp
+  ORDER BY file, query;
+$$ LANGUAGE sql;
+
+-------------------------------------------------------------------------------
+
+SELECT create_test_tables_temporal(:scale);
+SELECT create_test_tables_tpoint(:scale);
+ANALYZE;
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+-------------------------------------------------------------------------------
+-- Report of the performance profile of the SQL test files
+-- Run by the profile target of the build after profile.sql and the calls of
+-- profile_file for the test files. The following psql variables are used:
+--   run       Name of the run recorded in the results (default 'current')
+--   results   Absolute path of the CSV file where the results are written
+--   baseline  Absolute path of a CSV file of previous results, optional,
+--             against which the run is compared. No baseline is checked
+--             in since the timings depend on the machine.
+-------------------------------------------------------------------------------
+
+\set ON_ERROR_STOP 1
+\if :{?run}
+\else
+\set run current
+\endif
+
+SELECT file, count(*) AS queries, round(sum(mean_ms)::numeric, 3) AS total_ms,
+  sum(shared_hit) AS shared_hit, sum(shared_read) AS shared_read,
+  max(peak_memory_kb) AS peak_memory_kb
+FROM profile_results
+WHERE run = :'run'
+GROUP BY file
+ORDER BY file;
+
+\if :{?results}
+COPY profile_results TO :'results' WITH (FORMAT csv, HEADER);
+\endif
+
+\if :{?baseline}
+COPY profile_baseline FROM :'baseline' WITH (FORMAT csv, HEADER);
+SELECT status, count(*)
+FROM profile_compare(:'run')
+GROUP BY status
+ORDER BY status;
+SELECT file, query, round(mean_ms::numeric, 3) AS mean_ms,
+  round(baseline_ms::numeric, 3) AS baseline_ms,
+  round(ratio::numeric, 2) AS ratio, round(t::numeric, 2) AS t, status
+FROM profile_compare(:'run')
+WHERE status IN ('slower', 'faster')
+ORDER BY status DESC, ratio DESC;
+\else
+\echo 'No baseline given in PROFILE_BASELINE, the run is not compared'
+\endif
+
+-------------------------------------------------------------------------------
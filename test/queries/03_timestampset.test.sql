@@ -30,6 +30,14 @@ SELECT timestamptz '2000-01-01'::timestampset;
 SELECT memSize(timestampset '{2000-01-01}');
 SELECT memSize(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}');
 
+SELECT legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}');
+SELECT memSize(legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}'));
+SELECT numTimestamps(legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}'));
+SELECT timestampN(legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}'), 2);
+SELECT period(legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}'));
+SELECT legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}') = timestampset '{2000-01-01, 2000-01-02, 2000-01-03}';
+SELECT legacyLayout(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}') @> timestamptz '2000-01-02';
+
 SELECT period(timestampset '{2000-01-01}');
 SELECT period(timestampset '{2000-01-01, 2000-01-02, 2000-01-03}');
 
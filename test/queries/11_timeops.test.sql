@@ -198,4 +198,40 @@ SELECT periodset '{[2000-01-01, 2000-01-02],[2000-01-03, 2000-01-04]}' * period
 SELECT periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}' * periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}';
 SELECT periodset '{[2000-01-03, 2000-01-04],[2000-01-07, 2000-01-08]}' * periodset '{[2000-01-01, 2000-01-02],[2000-01-05, 2000-01-06]}';
 
+-- Skewed sizes
+
+SELECT timestampset '{2000-01-05, 2000-01-05 12:00, 2000-03-01}' * timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day')));
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) * timestampset '{2000-01-05, 2000-01-05 12:00, 2000-03-01}';
+SELECT timestampset '{2000-01-05, 2000-01-05 12:00, 2000-03-01}' - timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day')));
+SELECT numTimestamps(timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) - timestampset '{2000-01-05, 2000-03-01}');
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) && timestampset '{2000-01-05 12:00, 2000-02-01}';
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) && timestampset '{2000-01-05 12:00, 2000-01-06 12:00}';
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) @> timestampset '{2000-01-05, 2000-03-01}';
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) @> timestampset '{2000-01-05, 2000-03-01 12:00}';
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) @> timestampset '{2000-01-05 06:00, 2000-03-01}';
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) @> timestampset '{2000-01-05 06:00, 2000-01-05 12:00}';
+SELECT timestampset '{2000-01-05 06:00, 2000-01-05 12:00, 2000-03-01}' * periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t));
+SELECT timestampset '{2000-01-05 06:00, 2000-01-05 12:00, 2000-03-01}' - periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t));
+SELECT numTimestamps(timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) * periodset '{[2000-01-05, 2000-01-07], (2000-03-01, 2000-03-03)}');
+SELECT numTimestamps(timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) - periodset '{[2000-01-05, 2000-01-07], (2000-03-01, 2000-03-03)}');
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) && periodset '{(2000-01-05, 2000-01-06)}';
+SELECT timestampset(ARRAY(SELECT generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day'))) && periodset '{(2000-01-05, 2000-01-06]}';
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) @> periodset '{[2000-01-05 01:00, 2000-01-05 02:00], [2000-02-01, 2000-02-01 12:00)}';
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) @> periodset '{[2000-01-05 01:00, 2000-01-05 02:00], [2000-02-01, 2000-02-01 12:00]}';
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) && periodset '{[2000-01-05 12:00, 2000-01-05 13:00]}';
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) && periodset '{[2000-01-05 11:00, 2000-01-05 13:00]}';
+SELECT periodset '{[2000-01-05 06:00, 2000-01-06 06:00]}' * periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t));
+SELECT periodset(ARRAY(SELECT period(t, t + interval '12 hours') FROM generate_series(timestamptz '2000-01-01', '2000-04-09', '1 day') t)) * periodset '{[2000-01-05 06:00, 2000-01-06 06:00]}';
+
+-- Distance
+
+SELECT timestamptz '2000-01-01' <-> period '[2000-01-02, 2000-01-03]';
+SELECT period '[2000-01-01, 2000-01-03]' <-> timestamptz '2000-01-02';
+SELECT period '[2000-01-01, 2000-01-02]' <-> period '[2000-01-02 12:00, 2000-01-03]';
+SELECT timestampset '{2000-01-01, 2000-01-05}' <-> timestamptz '2000-01-04';
+SELECT timestampset '{2000-01-01, 2000-01-05}' <-> period '[2000-01-02, 2000-01-03]';
+SELECT period '[2000-01-02, 2000-01-03]' <-> timestampset '{2000-01-01, 2000-01-02 12:00}';
+SELECT periodset '{[2000-01-01, 2000-01-02], [2000-01-05, 2000-01-06]}' <-> timestamptz '2000-01-04';
+SELECT periodset '{[2000-01-01, 2000-01-02], [2000-01-05, 2000-01-06]}' <-> period '[2000-01-03, 2000-01-03 12:00]';
+
 -------------------------------------------------------------------------------
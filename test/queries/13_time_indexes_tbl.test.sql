@@ -8,6 +8,13 @@ DROP INDEX IF EXISTS tbl_timestampset_big_gist_idx;
 DROP INDEX IF EXISTS tbl_period_big_gist_idx;
 DROP INDEX IF EXISTS tbl_periodset_big_gist_idx;
 
+CREATE INDEX tbl_periodset_big_gin_idx ON tbl_periodset_big USING GIN(ps gin_periodset_ops);
+
+SELECT count(*) FROM tbl_periodset_big WHERE ps && period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_periodset_big WHERE ps @> period '[2001-01-01, 2001-02-01]';
+
+DROP INDEX IF EXISTS tbl_periodset_big_gin_idx;
+
 -------------------------------------------------------------------------------
 
 CREATE INDEX tbl_timestampset_big_gist_idx ON tbl_timestampset_big USING GIST(ts);
@@ -67,6 +74,12 @@ SELECT count(*) FROM tbl_periodset_big WHERE ps &<# period '[2001-01-01, 2001-02
 SELECT count(*) FROM tbl_periodset_big WHERE ps #>> period '[2001-01-01, 2001-02-01]';
 SELECT count(*) FROM tbl_periodset_big WHERE ps #&> period '[2001-01-01, 2001-02-01]';
 
+-- kNN
+SELECT (SELECT array_agg(ts <-> timestamptz '2001-06-01') FROM (SELECT ts FROM tbl_timestampset_big ORDER BY ts <-> timestamptz '2001-06-01' LIMIT 5) t) = (SELECT array_agg(ts <-> timestamptz '2001-06-01') FROM (SELECT ts FROM tbl_timestampset_big ORDER BY (ts <-> timestamptz '2001-06-01') + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(p <-> timestamptz '2001-06-01') FROM (SELECT p FROM tbl_period_big ORDER BY p <-> timestamptz '2001-06-01' LIMIT 5) t) = (SELECT array_agg(p <-> timestamptz '2001-06-01') FROM (SELECT p FROM tbl_period_big ORDER BY (p <-> timestamptz '2001-06-01') + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(p <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT p FROM tbl_period_big ORDER BY p <-> period '[2001-06-01, 2001-06-02]' LIMIT 5) t) = (SELECT array_agg(p <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT p FROM tbl_period_big ORDER BY (p <-> period '[2001-06-01, 2001-06-02]') + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(ps <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT ps FROM tbl_periodset_big ORDER BY ps <-> period '[2001-06-01, 2001-06-02]' LIMIT 5) t) = (SELECT array_agg(ps <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT ps FROM tbl_periodset_big ORDER BY (ps <-> period '[2001-06-01, 2001-06-02]') + 0 LIMIT 5) t);
+
 DROP INDEX IF EXISTS tbl_timestampset_big_gist_idx;
 DROP INDEX IF EXISTS tbl_period_big_gist_idx;
 DROP INDEX IF EXISTS tbl_periodset_big_gist_idx;
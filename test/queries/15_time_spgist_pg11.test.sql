@@ -450,6 +450,12 @@ SELECT count(*) FROM tbl_periodset_big WHERE ps &<# period '[2001-01-01, 2001-02
 SELECT count(*) FROM tbl_periodset_big WHERE ps #>> period '[2001-01-01, 2001-02-01]';
 SELECT count(*) FROM tbl_periodset_big WHERE ps #&> period '[2001-01-01, 2001-02-01]';
 
+-- kNN
+SELECT (SELECT array_agg(ts <-> timestamptz '2001-06-01') FROM (SELECT ts FROM tbl_timestampset_big ORDER BY ts <-> timestamptz '2001-06-01' LIMIT 5) t) = (SELECT array_agg(ts <-> timestamptz '2001-06-01') FROM (SELECT ts FROM tbl_timestampset_big ORDER BY (ts <-> timestamptz '2001-06-01') + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(p <-> timestamptz '2001-06-01') FROM (SELECT p FROM tbl_period_big ORDER BY p <-> timestamptz '2001-06-01' LIMIT 5) t) = (SELECT array_agg(p <-> timestamptz '2001-06-01') FROM (SELECT p FROM tbl_period_big ORDER BY (p <-> timestamptz '2001-06-01') + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(p <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT p FROM tbl_period_big ORDER BY p <-> period '[2001-06-01, 2001-06-02]' LIMIT 5) t) = (SELECT array_agg(p <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT p FROM tbl_period_big ORDER BY (p <-> period '[2001-06-01, 2001-06-02]') + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(ps <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT ps FROM tbl_periodset_big ORDER BY ps <-> period '[2001-06-01, 2001-06-02]' LIMIT 5) t) = (SELECT array_agg(ps <-> period '[2001-06-01, 2001-06-02]') FROM (SELECT ps FROM tbl_periodset_big ORDER BY (ps <-> period '[2001-06-01, 2001-06-02]') + 0 LIMIT 5) t);
+
 DROP INDEX IF EXISTS tbl_timestampset_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_period_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_periodset_big_spgist_idx;
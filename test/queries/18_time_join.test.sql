@@ -0,0 +1,12 @@
+-------------------------------------------------------------------------------
+-- Join of periods on their overlap
+-------------------------------------------------------------------------------
+
+SELECT * FROM periodJoin(ARRAY[period '[2000-01-01, 2000-01-03]', period '[2000-01-05, 2000-01-06)'], ARRAY[period '[2000-01-02, 2000-01-05]', period '(2000-01-06, 2000-01-07]', period '[2000-01-03, 2000-01-03]']) ORDER BY 1, 2;
+SELECT * FROM periodJoin(ARRAY[period '[2000-01-01, 2000-01-02)'], ARRAY[period '[2000-01-02, 2000-01-03]', period '(2000-01-01, 2000-01-02)']) ORDER BY 1, 2;
+SELECT * FROM periodJoin(ARRAY[period '[2000-01-01, 2000-01-02]'], '{}');
+
+SELECT COUNT(*), COUNT(DISTINCT (pos1, pos2)) FROM (SELECT (periodJoin(a1, a2)).* FROM (SELECT array_agg(period(timestamptz '2000-01-01' + i * interval '7 minutes', timestamptz '2000-01-01' + i * interval '7 minutes' + (i % 5) * interval '10 minutes', true, true) ORDER BY i) AS a1, array_agg(period(timestamptz '2000-01-01' + i * interval '11 minutes', timestamptz '2000-01-01' + i * interval '11 minutes' + (i % 3) * interval '13 minutes', true, true) ORDER BY i) FILTER (WHERE i < 200) AS a2 FROM generate_series(0, 299) i) t) t1;
+SELECT (SELECT array_agg((pos1, pos2) ORDER BY pos1, pos2) FROM periodJoin(a1, a2)) = (SELECT array_agg((i1::integer, i2::integer) ORDER BY i1, i2) FROM unnest(a1) WITH ORDINALITY u1(p1, i1), unnest(a2) WITH ORDINALITY u2(p2, i2) WHERE p1 && p2) FROM (SELECT array_agg(period(timestamptz '2000-01-01' + i * interval '7 minutes', timestamptz '2000-01-01' + i * interval '7 minutes' + (i % 5) * interval '10 minutes', true, true) ORDER BY i) AS a1, array_agg(period(timestamptz '2000-01-01' + i * interval '11 minutes', timestamptz '2000-01-01' + i * interval '11 minutes' + (i % 3) * interval '13 minutes', true, true) ORDER BY i) FILTER (WHERE i < 200) AS a2 FROM generate_series(0, 299) i) t;
+
+-------------------------------------------------------------------------------
@@ -227,3 +227,11 @@ SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 WHERE t1.b > t2.b;
 SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 WHERE t1.b >= t2.b;
 
 -------------------------------------------------------------------------------
+
+SELECT zorder(tbox 'TBOX((0, 2001-01-01), (0, 2001-01-01))', tbox 'TBOX((0, 2001-01-01), (100, 2001-01-11))');
+SELECT zorder(tbox 'TBOX((100, 2001-01-11), (100, 2001-01-11))', tbox 'TBOX((0, 2001-01-01), (100, 2001-01-11))');
+SELECT zorder(tbox 'TBOX((40, 2001-01-02), (60, 2001-01-04))', tbox 'TBOX((0, 2001-01-01), (100, 2001-01-11))');
+SELECT zorder(tbox 'TBOX((1,), (2,))', tbox 'TBOX((0, 2001-01-01), (100, 2001-01-11))');
+SELECT zorder(tbox 'TBOX((, 2001-01-02), (, 2001-01-03))', tbox 'TBOX((0, 2001-01-01), (100, 2001-01-11))');
+
+-------------------------------------------------------------------------------
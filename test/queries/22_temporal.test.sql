@@ -18,12 +18,15 @@ SELECT tfloat '1@2012-01-01 08:00:00';
 SELECT tfloat '2@2012-01-01 08:00:00';
 SELECT ttext 'AAA@2012-01-01 08:00:00';
 SELECT ttext 'BBB@2012-01-01 08:00:00';
+SELECT tfloat '1.5@2012-01-01T08:00:00.25+02';
+SELECT tfloat '1.5@2012-01-01 08:00-01:30';
 /* Errors */
 SELECT tbool '2@2012-01-01 08:00:00';
 SELECT tint 'TRUE@2012-01-01 08:00:00';
 SELECT tfloat 'ABC@2012-01-01 08:00:00';
 SELECT tfloat '25';
 SELECT tfloat '2@2012-01-01 08:00:00,';
+SELECT tfloat '1.5@2012-02-30';
 
 -------------------------------------------------------------------------------
 -- Temporal instant set
@@ -111,6 +114,62 @@ SELECT temporal_typmod_in(ARRAY[[cstring 'Instant']]);
 SELECT temporal_typmod_in(ARRAY[cstring 'Instant', NULL]);
 SELECT tfloat(Instant, InstantSet) '1@2000-01-01';
 
+SELECT format_type(oid, temporal_typmod_in(ARRAY[cstring 'Sequence', cstring 'Packed']))
+FROM (SELECT oid FROM pg_type WHERE typname = 'tfloat') t;
+SELECT format_type(oid, temporal_typmod_in(ARRAY[cstring 'Packed']))
+FROM (SELECT oid FROM pg_type WHERE typname = 'tfloat') t;
+SELECT tbool(Packed) '[true@2000-01-01, false@2000-01-02]';
+SELECT tint(Sequence, Packed) '[1@2000-01-01, 2@2000-01-02]';
+SELECT tfloat(Sequence, Packed) '[1@2000-01-01, 2@2000-01-02]';
+SELECT tfloat(Packed) '{1@2000-01-01, 2@2000-01-02}';
+SELECT memSize(tfloat(Packed) '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]') <
+  memSize(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]');
+SELECT tint(Packed) '{[1@2000-01-01, -300@2000-01-02, 70000@2000-01-03], [5@2000-01-05, 5@2000-01-06]}';
+SELECT tfloat(SequenceSet, Packed) '{[1.5@2000-01-01, 2.25@2000-01-02 08:00:00.5], (-1e10@2000-01-03, 3@2000-01-04]}';
+SELECT tfloat(Packed) '[1.5@2000-01-01, 2.25@2000-01-02, 1.5@2000-01-03]' =
+  tfloat '[1.5@2000-01-01, 2.25@2000-01-02, 1.5@2000-01-03]';
+SELECT memSize(tint(Packed) '{1@2000-01-01, 2@2000-01-02, 3@2000-01-03, 4@2000-01-04}') <
+  memSize(tint '{1@2000-01-01, 2@2000-01-02, 3@2000-01-03, 4@2000-01-04}');
+SELECT atPeriod(temp::tfloat(Packed), period '[2000-01-01 02:00:30, 2000-01-01 03:30)') =
+  atPeriod(temp, period '[2000-01-01 02:00:30, 2000-01-01 03:30)')
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT numInstants(atPeriod(temp::tfloat(Packed), period '[2000-01-01 02:00, 2000-01-01 03:30]'))
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT valueAtTimestamp(temp::tfloat(Packed), '2000-01-01 10:00:30')
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT atTimestamp(temp::tfloat(Packed), '2000-01-01 02:08')
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT atPeriod(temp::tfloat(Packed), period '[2001-01-01, 2001-01-02]') IS NULL
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT atPeriod(temp::tfloat(Packed), period '[2000-01-01 04:00, 2000-01-02 01:00]') =
+  atPeriod(temp, period '[2000-01-01 04:00, 2000-01-02 01:00]')
+FROM (SELECT tfloats(array_agg(seq ORDER BY k)) FROM (SELECT k, tfloatseq(array_agg(tfloatinst(i % 2,
+  timestamptz '2000-01-01' + k * interval '1 day' + i * interval '1 minute') ORDER BY i), true, k = 0) AS seq
+  FROM generate_series(0, 1) k, generate_series(0, 299) i GROUP BY k) s) t(temp);
+SELECT atPeriod(tfloati(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))::tfloat(Packed),
+  period '[2000-01-01 02:00, 2000-01-01 02:02]')
+FROM generate_series(0, 999) i;
+SELECT format_type(oid, temporal_typmod_in(ARRAY[cstring 'Sequence', cstring 'Compressed']))
+FROM (SELECT oid FROM pg_type WHERE typname = 'tfloat') t;
+SELECT tint(Compressed) '{[1@2000-01-01, -300@2000-01-02, 70000@2000-01-03], [5@2000-01-05, 5@2000-01-06]}';
+SELECT tfloat(SequenceSet, Compressed) '{[1.5@2000-01-01, 2.25@2000-01-02 08:00:00.5], (-1e10@2000-01-03, 3@2000-01-04]}';
+SELECT memSize(temp::tfloat(Compressed)) < memSize(temp::tfloat(Packed))
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+SELECT atPeriod(temp::tfloat(Compressed), period '[2000-01-01 02:00:30, 2000-01-01 03:30)') =
+  atPeriod(temp, period '[2000-01-01 02:00:30, 2000-01-01 03:30)')
+FROM (SELECT tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i))
+  FROM generate_series(0, 999) i) t(temp);
+/* Errors */
+SELECT tfloat(Sequence, InstantSet) '[1@2000-01-01, 2@2000-01-02]';
+SELECT tfloat(Instant, Sequence, Packed) '1@2000-01-01';
+SELECT tfloat(Instant, Packed) '[1@2000-01-01, 2@2000-01-02]';
+
 SELECT tbool 'true@2000-01-01';
 SELECT tbool '{true@2000-01-01, false@2000-01-02}';
 SELECT tbool '[true@2000-01-01, false@2000-01-02]';
@@ -315,6 +374,16 @@ SELECT tboolseq(ARRAY[tbool '1@2000-01-01', '[1@2000-01-02,1@2000-01-03]']);
 SELECT tintseq(ARRAY[tint '1@2000-01-01', '[1@2000-01-02,1@2000-01-03]']);
 SELECT tfloatseq(ARRAY[tfloat '1@2000-01-01', '[1@2000-01-02,1@2000-01-03]']);
 SELECT ttextseq(ARRAY[ttext 'AA@2000-01-01', '[BB@2000-01-02,BB@2000-01-03]']);
+SELECT tboolseq(ARRAY[timestamptz '2000-01-01', '2000-01-02', '2000-01-03'], ARRAY[true, false, false]);
+SELECT tintseq(ARRAY[timestamptz '2000-01-01', '2000-01-02', '2000-01-03'], ARRAY[1, 1, 3], false, true);
+SELECT tfloatseq(ARRAY[timestamptz '2000-01-01', '2000-01-02', '2000-01-03'], ARRAY[1, 2, 3]);
+SELECT tfloatseq(ARRAY[timestamptz '2000-01-01', '2000-01-02', '2000-01-03'], ARRAY[1, 2, 3], true, true, false);
+SELECT ttextseq(ARRAY[timestamptz '2000-01-01', '2000-01-02', '2000-01-03'], ARRAY[text 'AA', 'AA', 'BB']);
+/* Errors */
+SELECT tfloatseq('{}'::timestamptz[], '{}'::float[]);
+SELECT tfloatseq(ARRAY[timestamptz '2000-01-01', '2000-01-02'], ARRAY[1]);
+SELECT tfloatseq(ARRAY[timestamptz '2000-01-02', '2000-01-01'], ARRAY[1, 2]);
+SELECT tintseq(ARRAY[timestamptz '2000-01-01', '2000-01-02'], ARRAY[1, 2], true, false);
 
 -------------------------------------------------------------------------------
 
@@ -531,6 +600,17 @@ SELECT appendInstant(tfloat '{1@2000-01-01, 2@2000-01-02}', tfloat '2@2000-01-01
 SELECT appendInstant(tfloat '[1@2000-01-01, 1@2000-01-02]', '2@2000-01-02');
 SELECT appendInstant(tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]', tint '[1@2000-01-04, 1@2000-01-05]');
 SELECT appendInstant(tfloat '{[1@2000-01-01, 1@2000-01-02]}', '2@2000-01-02');
+SELECT appendInstants(tbool '{t@2000-01-01}', ARRAY[tbool 'f@2000-01-02', 't@2000-01-03']);
+SELECT appendInstants(tint '[1@2000-01-01, 2@2000-01-02]', ARRAY[tint '2@2000-01-03', '3@2000-01-04']);
+SELECT appendInstants(tfloat '[1@2000-01-01, 2@2000-01-02]', ARRAY[tfloat '3@2000-01-03', '5@2000-01-04']);
+SELECT appendInstants(ttext '{[AAA@2000-01-01, BBB@2000-01-02]}', ARRAY[ttext 'BBB@2000-01-03']);
+SELECT appendInstants(tfloat '[1@2000-01-01, 1@2000-01-02]', ARRAY[tfloat '1@2000-01-02', '2@2000-01-03']);
+SELECT appendInstants(tint '1@2000-01-01', ARRAY[]::tint[]);
+SELECT appendInstant(inst ORDER BY i) FROM (VALUES (1, tint '1@2000-01-01'), (2, tint '2@2000-01-02'), (3, tint '2@2000-01-03'), (4, tint '3@2000-01-04')) t(i, inst);
+SELECT appendInstant(inst ORDER BY i) FROM (VALUES (1, tfloat '[1@2000-01-01, 2@2000-01-02]'), (2, tfloat '3@2000-01-03'), (3, tfloat '4@2000-01-04'), (4, tfloat '2@2000-01-05')) t(i, inst);
+/* Errors */
+SELECT appendInstants(tfloat '[1@2000-01-01, 2@2000-01-02]', ARRAY[tfloat '3@2000-01-04', '4@2000-01-03']);
+SELECT appendInstants(tint '[1@2000-01-01, 2@2000-01-02]', ARRAY[tint '[1@2000-01-04, 1@2000-01-05]']);
 
 -------------------------------------------------------------------------------
 
@@ -621,6 +701,8 @@ SELECT merge(ARRAY[tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[1@2000-01-
 SELECT merge(ARRAY[tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}', '{2@2000-01-02, 2@2000-01-03, 1@2000-01-04}']);
 SELECT merge(ARRAY[tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]', '[2@2000-01-02, 2@2000-01-03, 1@2000-01-04]']);
 SELECT merge(ARRAY[tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[1@2000-01-04, 1@2000-01-05]}', '{[2@2000-01-04, 2@2000-01-05, 1@2000-01-06],[1@2000-01-08, 1@2000-01-09]}']);
+SELECT numInstants(t), startValue(t), endValue(t) FROM (SELECT merge(array_agg(tintinst(i, timestamptz '2000-01-01' + i * interval '1 min') ORDER BY (i * 37) % 101)) AS t FROM generate_series(1, 100) i) tab;
+SELECT numSequences(t), startValue(t), endValue(t) FROM (SELECT merge(array_agg(tintseq(i, period(timestamptz '2000-01-01' + i * interval '1 min', timestamptz '2000-01-01' + i * interval '1 min' + interval '30 sec')) ORDER BY (i * 37) % 101)) AS t FROM generate_series(1, 100) i) tab;
 
 -------------------------------------------------------------------------------
 
@@ -1229,6 +1311,15 @@ SELECT timestamps(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}');
 SELECT timestamps(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]');
 SELECT timestamps(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
 
+SELECT unnestInstants(tint '{[1@2000-01-01, 2@2000-01-02, 2@2000-01-03),[3@2000-01-03, 3@2000-01-05]}');
+SELECT unnestTimestamps(tint '{[1@2000-01-01, 2@2000-01-02, 2@2000-01-03),[3@2000-01-03, 3@2000-01-05]}');
+SELECT COUNT(*) FROM unnestInstants(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
+
+SELECT * FROM unnest(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
+SELECT * FROM unnest(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}');
+SELECT value, timespan(time) FROM unnest(tbool '{[t@2000-01-01, f@2000-01-02, f@2000-01-04), [t@2000-01-05, f@2000-01-06]}');
+SELECT * FROM unnest(tfloat '[1.5@2000-01-01, 2.5@2000-01-02]');
+
 -------------------------------------------------------------------------------
 -- Shift and tscale functions
 -------------------------------------------------------------------------------
@@ -1849,6 +1940,15 @@ SELECT valueAtTimestamp(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}'
 SELECT valueAtTimestamp(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]', timestamptz '2000-01-01');
 SELECT valueAtTimestamp(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}', timestamptz '2000-01-01');
 
+SELECT valueAtTimestamp(tinti(array_agg(tintinst(i, timestamptz '2000-01-01' + i * interval '1 hour') ORDER BY i)), timestamptz '2000-01-01 17:00') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tinti(array_agg(tintinst(i, timestamptz '2000-01-01' + i * interval '1 hour') ORDER BY i)), timestamptz '2000-01-01 16:30') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tinti(array_agg(tintinst(i, timestamptz '2000-01-01' + i * interval '1 hour') ORDER BY i)), timestamptz '2000-01-05 04:00') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tinti(array_agg(tintinst(i, timestamptz '2000-01-01' + i * interval '1 hour') ORDER BY i)), timestamptz '2000-01-01') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tints(array_agg(tintseq(i, period(timestamptz '2000-01-01' + i * interval '1 hour', timestamptz '2000-01-01' + (i + 1) * interval '1 hour', i = 1, true)) ORDER BY i)), timestamptz '2000-01-01 17:00') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tints(array_agg(tintseq(i, period(timestamptz '2000-01-01' + i * interval '1 hour', timestamptz '2000-01-01' + (i + 1) * interval '1 hour', i = 1, true)) ORDER BY i)), timestamptz '2000-01-01 17:30') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tints(array_agg(tintseq(i, period(timestamptz '2000-01-01' + i * interval '1 hour', timestamptz '2000-01-01' + (i + 1) * interval '1 hour', i = 1, true)) ORDER BY i)), timestamptz '2000-01-05 04:30') FROM generate_series(1, 100) i;
+SELECT valueAtTimestamp(tints(array_agg(tintseq(i, period(timestamptz '2000-01-01' + i * interval '1 hour', timestamptz '2000-01-01' + (i + 1) * interval '1 hour', i = 1, true)) ORDER BY i)), timestamptz '2000-01-01 00:30') FROM generate_series(1, 100) i;
+
 SELECT minusTimestamp(tbool 't@2000-01-01', timestamptz '2000-01-01');
 SELECT minusTimestamp(tbool '{t@2000-01-01}', timestamptz '2000-01-01');
 SELECT minusTimestamp(tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}', timestamptz '2000-01-01');
@@ -1949,6 +2049,13 @@ SELECT minusTimestampSet(tfloat '[1@2000-01-02]', '{2000-01-01, 2000-01-03}');
 SELECT minusTimestampSet(tfloat '{[1@2000-01-01], [1@2000-01-02]}', timestampset '{2000-01-01, 2000-01-02}');
 SELECT minusTimestamp(tfloat 'Interp=Stepwise;[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]', timestamptz '2000-01-02');
 SELECT minusTimestampset(tfloat '{[1@2000-01-01, 2@2000-01-02]}', timestampset '{2000-01-01, 2000-01-02}');
+SELECT tsample(tint '1@2000-01-01', interval '1 hour');
+SELECT tsample(tint '{1@2000-01-01, 2@2000-01-01 12:00:00, 3@2000-01-02}', interval '1 day');
+SELECT tsample(tfloat '[1@2000-01-01, 3@2000-01-03]', interval '12 hours');
+SELECT tsample(tint '{[1@2000-01-01, 2@2000-01-02), [3@2000-01-03, 3@2000-01-05]}', interval '1 day');
+SELECT tsample(tfloat '[1@2000-01-01, 3@2000-01-03]', interval '2 days 12 hours');
+/* Errors */
+SELECT tsample(tfloat '[1@2000-01-01, 3@2000-01-03]', interval '-1 day');
 
 SELECT atPeriod(tbool 't@2000-01-01', period '[2000-01-01,2000-01-02]');
 SELECT atPeriod(tbool '{t@2000-01-01}', period '[2000-01-01,2000-01-02]');
@@ -2207,6 +2314,9 @@ SELECT round(twAvg(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]')::n
 SELECT round(twAvg(tfloat 'Interp=Stepwise;[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]')::numeric, 6);
 SELECT round(twAvg(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}')::numeric, 6);
 SELECT round(twAvg(tfloat 'Interp=Stepwise;{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}')::numeric, 6);
+SELECT twAvg(temp) FROM (SELECT tfloatseq(array_agg(tfloatinst(i * i, timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t;
+SELECT twAvg(appendInstant(temp, tfloatinst(4225, '2000-01-01 00:01:05'))) FROM (SELECT tfloatseq(array_agg(tfloatinst(i * i, timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t;
+SELECT twAvg(tscale(temp, '128 seconds')) FROM (SELECT tfloatseq(array_agg(tfloatinst(i * i, timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(0, 64) i) t;
 
 -------------------------------------------------------------------------------
 -- Comparison functions and B-tree indexing
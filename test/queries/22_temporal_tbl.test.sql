@@ -522,4 +522,19 @@ WHERE t1.temp > t2.temp;
 SELECT COUNT(*) FROM tbl_ttext t1, tbl_ttext t2
 WHERE t1.temp >= t2.temp;
 
+CREATE TABLE tbl_slice(k integer, temp tfloat);
+ALTER TABLE tbl_slice ALTER COLUMN temp SET STORAGE EXTERNAL;
+INSERT INTO tbl_slice SELECT k, tfloatseq(array_agg(tfloatinst(k + i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) FROM generate_series(1, 3) k, generate_series(1, 1000) i GROUP BY k;
+INSERT INTO tbl_slice SELECT 4, tfloats(array_agg(seq ORDER BY j)) FROM (SELECT j, tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + (j * 100 + i) * interval '1 minute') ORDER BY i)) AS seq FROM generate_series(0, 9) j, generate_series(1, 50) i GROUP BY j) t;
+SELECT k, atPeriod(temp, '[2000-01-01 01:00, 2000-01-01 01:02]') FROM tbl_slice WHERE k < 4 ORDER BY k;
+SELECT k, atPeriod(temp, '[2000-01-01 01:00:30, 2000-01-01 01:01:30]') FROM tbl_slice WHERE k < 4 ORDER BY k;
+SELECT k, valueAtTimestamp(temp, '2000-01-01 08:20:30') FROM tbl_slice WHERE k < 4 ORDER BY k;
+SELECT k, atTimestamp(temp, '2000-01-01 16:40') FROM tbl_slice WHERE k < 4 ORDER BY k;
+SELECT atPeriodSet(temp, '{[2000-01-01 00:01, 2000-01-01 00:02], [2000-01-01 16:39, 2000-01-01 16:41]}') FROM tbl_slice WHERE k = 1;
+SELECT COUNT(*) FROM tbl_slice WHERE atPeriod(temp, '[2000-01-02, 2000-01-03]') IS NOT NULL;
+SELECT atPeriod(temp, '[2000-01-01 02:29, 2000-01-01 03:22]') FROM tbl_slice WHERE k = 4;
+SELECT valueAtTimestamp(temp, '2000-01-01 05:10:30') FROM tbl_slice WHERE k = 4;
+SELECT valueAtTimestamp(temp, '2000-01-01 01:15') IS NULL FROM tbl_slice WHERE k = 4;
+DROP TABLE tbl_slice;
+
 ------------------------------------------------------------------------------
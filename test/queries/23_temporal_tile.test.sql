@@ -0,0 +1,20 @@
+-------------------------------------------------------------------------------
+
+SELECT * FROM timeSplit(tfloat '[1@2000-01-01, 5@2000-01-05]', '2 days');
+SELECT * FROM timeSplit(tint '{1@2000-01-01, 2@2000-01-02, 3@2000-01-08}', '2 days');
+SELECT * FROM timeSplit(tbool '{[true@2000-01-01, false@2000-01-02], [true@2000-01-05, true@2000-01-06]}', '2 days', '2000-01-01');
+SELECT count(*) FROM timeSplit(ttext 'AAA@2000-01-01', '1 hour');
+SELECT * FROM timeSplit(tint '1@2000-01-01', '1 month');
+SELECT * FROM timeSplit(tint '1@2000-01-01', '-1 day');
+SELECT * FROM valueSplit(tint '{1@2000-01-01, 5@2000-01-02, 2@2000-01-03}', 2);
+SELECT * FROM valueSplit(tfloat '[1@2000-01-01, 3@2000-01-03]', 1.0);
+SELECT * FROM valueSplit(tint '1@2000-01-01', 0);
+
+SELECT * FROM timeBucketStats(tfloat '[1@2000-01-01, 5@2000-01-05]', '2 days', '2000-01-01');
+SELECT * FROM timeBucketStats(tint '{1@2000-01-01, 3@2000-01-01 12:00, 5@2000-01-03}', '1 day');
+SELECT * FROM timeBucketStats(tint '1@2000-01-01', '1 month');
+SELECT timeBucketAvg(temp, '1 day', '2000-01-01') FROM (VALUES (tint '[1@2000-01-01, 1@2000-01-02)'), (tint '[4@2000-01-01 12:00, 4@2000-01-02]')) t(temp);
+SELECT timeBucketAvg(temp, '1 day') FROM (VALUES (tfloat '1@2000-01-03'), (tfloat '3@2000-01-03 06:00'), (tfloat '2@2000-01-05')) t(temp);
+SELECT timeBucketAvg(temp, '1 day') FROM (VALUES (tint '1@2000-01-01')) t(temp) WHERE false;
+
+-------------------------------------------------------------------------------
@@ -540,5 +540,12 @@ SELECT round(degrees(tfloat '{1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03}'),
 SELECT round(degrees(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]'), 1);
 SELECT round(degrees(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}'), 1);
 
+SELECT (tfloat '[1@2000-01-01, 2@2000-01-02]' * 2.5 - 1) / 2;
+SELECT tfloat '[1@2000-01-01, 2@2000-01-02]' * 2 + tfloat '[1@2000-01-01, 3@2000-01-02]' - 1;
+SELECT tfloat '[1@2000-01-01, 2@2000-01-02, 4@2000-01-03]' * 0 + 1;
+SELECT tint '[1@2000-01-01, 2@2000-01-02]' + 1.5 - tint '[1@2000-01-01, 2@2000-01-02]';
+SELECT 10 / (tint '[1@2000-01-01, 2@2000-01-02]' + 1);
+SELECT (tfloat '{1@2000-01-01, 2@2000-01-02}' + 1) / tfloat '{0@2000-01-01, 1@2000-01-02}';
+
 -------------------------------------------------------------------------------
 
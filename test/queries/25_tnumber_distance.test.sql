@@ -0,0 +1,17 @@
+-------------------------------------------------------------------------------
+-- Nearest approach distance
+-------------------------------------------------------------------------------
+
+SELECT 3 |=| tint '[1@2000-01-01, 5@2000-01-02]';
+SELECT 3 |=| tfloat '[1@2000-01-01, 5@2000-01-02]';
+SELECT tint '[1@2000-01-01, 5@2000-01-02)' |=| 4;
+SELECT tfloat '{1@2000-01-01, 5@2000-01-02}' |=| 2.5;
+SELECT tfloat '{[1@2000-01-01, 2@2000-01-02], [8@2000-01-03, 9@2000-01-04]}' |=| 5;
+SELECT tbox 'TBOX((1, 2000-01-01), (2, 2000-01-02))' |=| tbox 'TBOX((5, 2000-01-01), (6, 2000-01-02))';
+SELECT tbox 'TBOX((1,), (2,))' |=| tbox 'TBOX((5, 2000-01-03), (6, 2000-01-04))';
+SELECT tbox 'TBOX((1, 2000-01-01), (2, 2000-01-02))' |=| tbox 'TBOX((5, 2000-01-03), (6, 2000-01-04))';
+SELECT tfloat '[1@2000-01-01, 5@2000-01-05]' |=| tbox 'TBOX((6, 2000-01-02), (7, 2000-01-03))';
+SELECT tfloat '[1@2000-01-01, 5@2000-01-05]' |=| tbox 'TBOX((6,), (7,))';
+SELECT tbox 'TBOX((6, 2000-01-06), (7, 2000-01-07))' |=| tint '[1@2000-01-01, 5@2000-01-05]';
+
+-------------------------------------------------------------------------------
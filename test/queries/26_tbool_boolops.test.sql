@@ -36,6 +36,8 @@ SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-
 SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}' & tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}';
 SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}' & tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]';
 SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}' & tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}';
+SELECT tbool '[t@2000-01-01, f@2000-01-03, t@2000-01-05)' & tbool '(t@2000-01-02, f@2000-01-04, f@2000-01-06]';
+SELECT tbool '{[t@2000-01-01, f@2000-01-03], [t@2000-01-04, t@2000-01-06]}' & tbool '{[t@2000-01-02, t@2000-01-05]}';
 
 -------------------------------------------------------------------------------
 
@@ -68,6 +70,8 @@ SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-
 SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}' | tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}';
 SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}' | tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]';
 SELECT tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}' | tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}';
+SELECT tbool '[t@2000-01-01, f@2000-01-03, t@2000-01-05)' | tbool '(t@2000-01-02, f@2000-01-04, f@2000-01-06]';
+SELECT tbool '{[t@2000-01-01, f@2000-01-03], [t@2000-01-04, t@2000-01-06]}' | tbool '{[t@2000-01-02, t@2000-01-05]}';
 
 -------------------------------------------------------------------------------
 
@@ -2008,3 +2008,9 @@ SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 WHERE t1.b -|- t2.b;
 
 -------------------------------------------------------------------------------
 
+SELECT zorder(tint '[1@2001-01-02, 3@2001-01-04]', tbox 'TBOX((0, 2001-01-01), (10, 2001-01-11))');
+SELECT zorder(tfloat '[1.5@2001-01-02, 2.5@2001-01-04]', tbox 'TBOX((0, 2001-01-01), (10, 2001-01-11))');
+SELECT zorder(tfloat '1.5@2001-01-02', tbox 'TBOX((0,), (10,))');
+
+-------------------------------------------------------------------------------
+
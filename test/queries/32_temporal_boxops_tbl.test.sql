@@ -1339,3 +1339,21 @@ WHERE noidx <> gistidx
 ORDER BY op, leftarg, rightarg;
 
 -------------------------------------------------------------------------------
+
+-------------------------------------------------------------------------------
+-- Bounding box of toasted values
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS tbl_tint_toasted;
+CREATE TABLE tbl_tint_toasted AS
+SELECT tintseq(array_agg(tintinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS seq,
+  tinti(array_agg(tintinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS inst
+FROM generate_series(1, 10000) i;
+SELECT period(seq), tbox(seq) FROM tbl_tint_toasted;
+SELECT period(inst), tbox(inst) FROM tbl_tint_toasted;
+SELECT count(*) FROM tbl_tint_toasted WHERE seq && period '[2000-01-07, 2000-01-08]';
+SELECT count(*) FROM tbl_tint_toasted WHERE inst @> period '[2000-01-07, 2000-01-08]';
+SELECT count(*) FROM tbl_tint_toasted WHERE seq && tbox 'TBOX((2, 2000-01-01), (3, 2000-01-02))';
+DROP TABLE tbl_tint_toasted;
+
+-------------------------------------------------------------------------------
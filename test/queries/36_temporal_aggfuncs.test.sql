@@ -126,6 +126,21 @@ SELECT tsum(temp) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tint), 
 ('[3@2000-01-02, 4@2000-01-06]'::tint)) t(temp);
 
+SELECT tcount(temp) FROM (VALUES
+('[1@2000-01-01, 1@2000-01-02)'::tint),
+('[2@2000-01-02, 2@2000-01-03]'::tint),
+('[3@2000-01-03]'::tint)) t(temp);
+SELECT tsum(temp) FROM (VALUES
+('[1@2000-01-01, 3@2000-01-03]'::tint),
+('(2@2000-01-01, 2@2000-01-02]'::tint)) t(temp);
+SELECT numSequences(c), numInstants(c), maxValue(c) FROM (
+SELECT tcount(tintseq(ARRAY[tintinst(1, timestamptz '2000-01-01' + i * interval '1 hour'),
+  tintinst(1, timestamptz '2000-01-01' + (i + 10) * interval '1 hour')], true, false))
+FROM generate_series(1, 1000) i) t(c);
+SELECT minValue(c), maxValue(c), startTimestamp(c), endTimestamp(c) FROM (
+SELECT tmax(tintseq(ARRAY[tintinst(i, timestamptz '2000-01-01' + i * interval '1 hour'),
+  tintinst(i, timestamptz '2000-01-01' + (i + 10) * interval '1 hour')], true, false))
+FROM generate_series(1, 2000) i) t(c);
 SELECT tavg(temp) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tint), 
 ('[3@2000-01-02, 4@2000-01-06]'::tint)) t(temp);
@@ -205,3 +220,31 @@ SELECT tsum(temp) FROM (VALUES
 ('{[3@2000-01-02, 4@2000-01-06]}'::tfloat)) t(temp);
 
 --------------------------------------------------
+
+SELECT periodUnion(p) FROM (VALUES
+(period '[2000-01-03, 2000-01-04]'), (period '[2000-01-01, 2000-01-02)'),
+(period '[2000-01-02, 2000-01-03)'), (NULL::period)) t(p);
+SELECT periodUnion(p) FROM (VALUES
+(period '[2000-01-05, 2000-01-06]'), (period '(2000-01-01, 2000-01-02)'),
+(period '[2000-01-01, 2000-01-01]')) t(p);
+SELECT periodUnion(ps) FROM (VALUES
+(periodset '{[2000-01-01, 2000-01-02], [2000-01-05, 2000-01-06]}'),
+(periodset '{[2000-01-02, 2000-01-03]}'), (NULL::periodset)) t(ps);
+SELECT periodUnion(p) FROM (VALUES
+(NULL::period), (NULL::period)) t(p);
+SELECT numPeriods(periodUnion(period(t, t + interval '30 minutes') ORDER BY t DESC))
+FROM generate_series(timestamptz '2000-01-01', '2000-05-01', '1 hour') t;
+SELECT numPeriods(periodUnion(period(t, t + interval '1 hour') ORDER BY t DESC))
+FROM generate_series(timestamptz '2000-01-01', '2000-05-01', '1 hour') t;
+
+--------------------------------------------------
+
+SELECT tsequenceAgg(v, t) FROM (VALUES (2, timestamptz '2000-01-02'), (1, '2000-01-01'), (3, '2000-01-03')) t(v, t);
+SELECT tsequenceAgg(v, t, interval '1 day') FROM (VALUES (1.5::float, timestamptz '2000-01-01'), (2.5, '2000-01-02'), (1.5, '2000-01-04')) t(v, t);
+/* Errors */
+SELECT tsequenceAgg(v, t) FROM (VALUES (1, timestamptz '2000-01-01'), (2, '2000-01-01')) t(v, t);
+
+SELECT i, tsum(temp) OVER (ORDER BY i ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES (1, tint '[1@2000-01-01, 1@2000-01-03]'), (2, tint '[2@2000-01-02, 2@2000-01-04]'), (3, tint '[3@2000-01-03, 3@2000-01-05]')) t(i, temp);
+SELECT i, tcount(temp) OVER (ORDER BY i ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES (1, tint '[1@2000-01-01, 1@2000-01-03]'), (2, tint '[2@2000-01-02, 2@2000-01-04]'), (3, tint '[3@2000-01-03, 3@2000-01-05]')) t(i, temp);
+
+--------------------------------------------------
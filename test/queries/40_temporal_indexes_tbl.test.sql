@@ -210,6 +210,11 @@ SELECT count(*) FROM tbl_tint_big WHERE tint '[1@2001-01-01, 10@2001-02-01]' &<
 
 -------------------------------------------------------------------------------
 
+-- kNN
+SELECT (SELECT array_agg(temp |=| 50) FROM (SELECT temp FROM tbl_tint_big ORDER BY temp |=| 50 LIMIT 5) t) = (SELECT array_agg(temp |=| 50) FROM (SELECT temp FROM tbl_tint_big ORDER BY (temp |=| 50) + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(round((temp |=| 50.5)::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY temp |=| 50.5 LIMIT 5) t) = (SELECT array_agg(round((temp |=| 50.5)::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY (temp |=| 50.5) + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(round((temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))')::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))' LIMIT 5) t) = (SELECT array_agg(round((temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))')::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY (temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))') + 0 LIMIT 5) t);
+
 DROP INDEX IF EXISTS tbl_tbool_big_gist_idx;
 DROP INDEX IF EXISTS tbl_tint_big_gist_idx;
 DROP INDEX IF EXISTS tbl_tfloat_big_gist_idx;
@@ -217,3 +222,101 @@ DROP INDEX IF EXISTS tbl_ttext_big_gist_idx;
 
 -------------------------------------------------------------------------------
 
+CREATE INDEX tbl_tint_big_brin_idx ON tbl_tint_big USING BRIN(temp);
+CREATE INDEX tbl_tfloat_big_brin_idx ON tbl_tfloat_big USING BRIN(temp);
+
+SELECT count(*) FROM tbl_tint_big WHERE temp && intrange '[1,3]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> intrange '[1,3]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << intrange '[1,3]';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp << tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> tfloat '[1@2001-01-01, 10@2001-02-01]';
+
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && floatrange '[1,3]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> floatrange '[1,3]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << floatrange '[1,3]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> tfloat '[1@2001-01-01, 10@2001-02-01]';
+
+DROP INDEX IF EXISTS tbl_tint_big_brin_idx;
+DROP INDEX IF EXISTS tbl_tfloat_big_brin_idx;
+
+-------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tint_big_compact_idx ON tbl_tint_big USING GIST(temp gist_tint_compact_ops);
+CREATE INDEX tbl_tfloat_big_compact_idx ON tbl_tfloat_big USING GIST(temp gist_tfloat_compact_ops);
+
+SELECT count(*) FROM tbl_tint_big WHERE temp && intrange '[1,3]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> intrange '[1,3]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << intrange '[1,3]';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp << tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> tfloat '[1@2001-01-01, 10@2001-02-01]';
+
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && floatrange '[1,3]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> floatrange '[1,3]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << floatrange '[1,3]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> tfloat '[1@2001-01-01, 10@2001-02-01]';
+
+DROP INDEX IF EXISTS tbl_tint_big_compact_idx;
+DROP INDEX IF EXISTS tbl_tfloat_big_compact_idx;
+
+-------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tint_big_tbox_idx ON tbl_tint_big USING GIST(tbox(temp));
+CREATE INDEX tbl_tfloat_big_tbox_idx ON tbl_tfloat_big USING GIST(tbox(temp));
+
+SELECT count(*) FROM tbl_tint_big WHERE tbox(temp) && tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE tbox(temp) @> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE tbox(temp) << tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tint_big WHERE tbox(temp) #&> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+
+SELECT count(*) FROM tbl_tfloat_big WHERE tbox(temp) && tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE tbox(temp) @> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE tbox(temp) << tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+SELECT count(*) FROM tbl_tfloat_big WHERE tbox(temp) #&> tbox 'TBOX((1,2001-01-01),(50,2001-02-01))';
+
+DROP INDEX IF EXISTS tbl_tint_big_tbox_idx;
+DROP INDEX IF EXISTS tbl_tfloat_big_tbox_idx;
+
+-------------------------------------------------------------------------------
+
@@ -0,0 +1,21 @@
+-------------------------------------------------------------------------------
+-- Statistics of GiST indexes
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS tbl_giststat;
+CREATE TABLE tbl_giststat(k, p) AS SELECT k, period(timestamptz '2000-01-01' + k * interval '1 hour', timestamptz '2000-01-01' + (k + 1) * interval '1 hour') FROM generate_series(1, 10000) k;
+CREATE INDEX tbl_giststat_gist_idx ON tbl_giststat USING gist(p);
+CREATE INDEX tbl_giststat_btree_idx ON tbl_giststat(k);
+
+SELECT substring(giststat('tbl_giststat_gist_idx') from 'depth: *(\d+)');
+SELECT substring(giststat('tbl_giststat_gist_idx') from 'leafTuples: *(\d+)');
+SELECT substring(giststat('tbl_giststat_gist_idx') from 'level 1: estPages: *(\d+)')::int = substring(giststat('tbl_giststat_gist_idx') from 'leafPages: *(\d+)')::int;
+SELECT substring(giststat('tbl_giststat_gist_idx', 0.1) from 'depth: *(\d+)');
+
+/* Errors */
+SELECT giststat('tbl_giststat_gist_idx', 0);
+SELECT giststat('tbl_giststat_btree_idx');
+
+DROP TABLE tbl_giststat;
+
+-------------------------------------------------------------------------------
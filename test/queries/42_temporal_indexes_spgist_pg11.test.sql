@@ -204,6 +204,11 @@ SELECT count(*) FROM tbl_ttext_big WHERE temp #&> ttext '[AAA@2001-01-01, BBB@20
 
 -------------------------------------------------------------------------------
 
+-- kNN
+SELECT (SELECT array_agg(temp |=| 50) FROM (SELECT temp FROM tbl_tint_big ORDER BY temp |=| 50 LIMIT 5) t) = (SELECT array_agg(temp |=| 50) FROM (SELECT temp FROM tbl_tint_big ORDER BY (temp |=| 50) + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(round((temp |=| 50.5)::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY temp |=| 50.5 LIMIT 5) t) = (SELECT array_agg(round((temp |=| 50.5)::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY (temp |=| 50.5) + 0 LIMIT 5) t);
+SELECT (SELECT array_agg(round((temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))')::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))' LIMIT 5) t) = (SELECT array_agg(round((temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))')::numeric, 6)) FROM (SELECT temp FROM tbl_tfloat_big ORDER BY (temp |=| tbox 'TBOX((50, 2001-06-01), (50, 2001-07-01))') + 0 LIMIT 5) t);
+
 DROP INDEX IF EXISTS tbl_tbool_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_tint_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_tfloat_big_spgist_idx;
@@ -501,3 +501,10 @@ SELECT count(*) FROM tbl_tbool WHERE period '[2001-01-01, 2001-06-01]' <<# temp;
 SELECT count(*) FROM tbl_ttext WHERE period '[2001-01-01, 2001-06-01]' <<# temp;
 
 -------------------------------------------------------------------------------
+-- Ever/always comparison operators
+-------------------------------------------------------------------------------
+
+SELECT count(*) FROM tbl_tbool WHERE temp %= true;
+SELECT count(*) FROM tbl_tbool WHERE temp ?<> true;
+
+-------------------------------------------------------------------------------
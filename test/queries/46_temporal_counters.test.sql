@@ -0,0 +1,44 @@
+-------------------------------------------------------------------------------
+-- Counters of the hot paths
+-------------------------------------------------------------------------------
+
+SELECT mobilitydb_stats_reset();
+SELECT counter, value FROM mobilitydb_stats;
+
+SELECT set_config('mobilitydb.track_counters', 'on', false);
+SELECT tfloat '[1@2000-01-01, 2@2000-01-02]' && tfloat '[1@2000-01-03, 2@2000-01-04]';
+SELECT tfloat '[1@2000-01-01, 3@2000-01-03]' + tfloat '[1@2000-01-02, 3@2000-01-04]';
+SELECT tmax(temp) IS NOT NULL FROM (VALUES (tint '[1@2000-01-01, 1@2000-01-03]'),
+  (tint '[1@2000-01-02, 1@2000-01-04]')) t(temp);
+SELECT startTimestamp(atPeriod(tfloatseq(array_agg(tfloatinst(i % 2, timestamptz '2000-01-01' + i * interval '1 minute')
+  ORDER BY i))::tfloat(Packed), period '[2000-01-01 00:10, 2000-01-01 00:20]')) FROM generate_series(0, 999) i;
+CREATE TABLE tbl_counters_cache(temp tfloat);
+ALTER TABLE tbl_counters_cache ALTER COLUMN temp SET STORAGE EXTERNAL;
+INSERT INTO tbl_counters_cache SELECT tfloatseq(array_agg(tfloatinst(i, timestamptz '2000-01-01' + i * interval '1 minute')
+  ORDER BY i)) FROM generate_series(0, 999) i;
+SELECT SUM(valueAtTimestamp(temp, timestamptz '2000-01-01' + i * interval '30 seconds'))
+FROM tbl_counters_cache, generate_series(0, 1998) i;
+SELECT startValue(temp), endValue(temp), numInstants(temp) FROM tbl_counters_cache;
+SELECT value > 0 AS positive FROM mobilitydb_stats WHERE counter = 'detoast_hits';
+SELECT COUNT(*) FROM tbl_counters_cache t1, tbl_counters_cache t2 WHERE t1.temp = t2.temp;
+SELECT temp = tfloat '[0@2000-01-01, 999@2000-01-01 16:39]', temp <> tfloat '[0@2000-01-01, 1@2000-01-01 00:01]'
+FROM tbl_counters_cache;
+SET work_mem = '64kB';
+SELECT numInstants(temp), minValue(temp), maxValue(temp) FROM (SELECT tsum(tfloatinst(1, timestamptz '2000-01-01' + (i % 5000) * interval '1 minute'))
+  FROM generate_series(0, 9999) i) t(temp);
+RESET work_mem;
+BEGIN;
+SELECT startValue(temp), endValue(temp), numInstants(temp) FROM tbl_counters_cache;
+TRUNCATE tbl_counters_cache;
+INSERT INTO tbl_counters_cache SELECT tfloatseq(array_agg(tfloatinst(2 * i, timestamptz '2000-01-01' + i * interval '1 minute')
+  ORDER BY i)) FROM generate_series(0, 999) i;
+SELECT startValue(temp), endValue(temp), numInstants(temp) FROM tbl_counters_cache;
+COMMIT;
+DROP TABLE tbl_counters_cache;
+SELECT counter, value > 0 AS positive FROM mobilitydb_stats
+WHERE counter NOT LIKE 'detoast%' AND counter <> 'postgis_calls' ORDER BY counter;
+
+SELECT mobilitydb_stats_reset();
+SELECT SUM(value) FROM mobilitydb_stats;
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,16 @@
+-------------------------------------------------------------------------------
+-- Columnar export
+-------------------------------------------------------------------------------
+
+SELECT asArrow(temp) FROM (VALUES (tint '1@2000-01-01'), (tint '{2@2000-01-02, 3@2000-01-03}')) t(temp);
+SELECT asArrow(temp) FROM (VALUES (tfloat '[1.5@2000-01-01, 2.5@2000-01-02]'), (NULL), (tfloat '{[1@2000-01-03], [2@2000-01-04]}')) t(temp);
+SELECT octet_length(asArrow(tfloat '[1@2000-01-01, 2@2000-01-02]' + i::float)) FROM generate_series(1, 100) i;
+SELECT asArrow(temp) IS NULL FROM (VALUES (NULL::tint)) t(temp);
+SELECT id, asText(temp) FROM tfloatFromArrow((SELECT asArrow(temp) FROM (VALUES (tfloat '[1.5@2000-01-01, 2.5@2000-01-02]'), (tfloat '{[1@2000-01-03], [2@2000-01-04]}')) t(temp)));
+SELECT id, asText(temp) FROM tfloatFromArrow((SELECT asArrow(temp) FROM (VALUES (tfloat '[1.5@2000-01-01, 2.5@2000-01-02]'), (tfloat '{[1@2000-01-03], [2@2000-01-04]}')) t(temp)), '12 hours');
+SELECT id, asText(temp) FROM tintFromArrow((SELECT asArrow(tint '{2@2000-01-02, 3@2000-01-03}')));
+/* Errors */
+SELECT * FROM tintFromArrow((SELECT asArrow(temp) FROM (VALUES (tfloat '[1.5@2000-01-01, 2.5@2000-01-02]'), (tfloat '{[1@2000-01-03], [2@2000-01-04]}')) t(temp)));
+SELECT * FROM tfloatFromArrow('\x0100'::bytea);
+
+-------------------------------------------------------------------------------
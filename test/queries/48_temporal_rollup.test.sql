@@ -0,0 +1,26 @@
+-------------------------------------------------------------------------------
+-- Rollups
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS tbl_rollup;
+CREATE TABLE tbl_rollup(id serial, k int, temp tint);
+INSERT INTO tbl_rollup(k, temp) VALUES (1, '1@2000-01-01'), (1, '5@2000-01-02'), (2, '1@2000-01-01');
+
+SELECT createRollup('rollup_tcount', 'tbl_rollup', 'tcount', 'temp', 'k', 'id');
+SELECT refreshRollup('rollup_tcount');
+SELECT grp, value FROM rollup_tcount_view ORDER BY grp;
+
+INSERT INTO tbl_rollup(k, temp) VALUES (1, '2@2000-01-01'), (3, '4@2000-01-03');
+SELECT refreshRollup('rollup_tcount');
+SELECT grp, value FROM rollup_tcount_view ORDER BY grp;
+SELECT refreshRollup('rollup_tcount');
+SELECT refreshRollups();
+
+SELECT dropRollup('rollup_tcount');
+SELECT count(*) FROM mobilitydb_rollups;
+/* Errors */
+SELECT createRollup('rollup_tmin', 'tbl_rollup', 'tmin', 'temp', 'k', 'id');
+
+DROP TABLE tbl_rollup;
+
+-------------------------------------------------------------------------------
@@ -62,3 +62,69 @@ foreach(file ${testfiles})
 	endif()
 endforeach()
 
+# Micro-benchmarks, run with make bench
+add_custom_target(bench
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh setup ${CMAKE_BINARY_DIR}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh create_ext ${CMAKE_BINARY_DIR}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh run_bench ${CMAKE_BINARY_DIR} ${PROJECT_SOURCE_DIR}/test/bench/bench.sql
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh teardown ${CMAKE_BINARY_DIR}
+	WORKING_DIRECTORY ${PROJECT_SOURCE_DIR}/test
+	DEPENDS ${CMAKE_PROJECT_NAME} sqlscript control
+	USES_TERMINAL
+)
+
+# End-to-end benchmark of BerlinMOD-style queries, run with make bench_berlinmod
+# The environment variables BENCH_SCALE, BENCH_RUN and BENCH_BASELINE give
+# the number of temporal points, the name of the run and the CSV file of the
+# results of a previous run to compare with
+add_custom_target(bench_berlinmod
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh setup ${CMAKE_BINARY_DIR}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh create_ext ${CMAKE_BINARY_DIR}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh run_bench ${CMAKE_BINARY_DIR}
+		${PROJECT_SOURCE_DIR}/src/datagen/random_temporal.sql
+		${PROJECT_SOURCE_DIR}/src/datagen/random_geo.sql
+		${PROJECT_SOURCE_DIR}/point/src/datagen/random_tpoint.sql
+		${PROJECT_SOURCE_DIR}/point/src/datagen/create_test_tables_tpoint_big.sql
+		${PROJECT_SOURCE_DIR}/test/bench/berlinmod.sql
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh teardown ${CMAKE_BINARY_DIR}
+	WORKING_DIRECTORY ${PROJECT_SOURCE_DIR}/test
+	DEPENDS ${CMAKE_PROJECT_NAME} sqlscript control
+	USES_TERMINAL
+)
+
+# Performance profile of the queries of the SQL test files on the tables
+# generated by the data generators, run with make profile
+# The environment variables PROFILE_SCALE, PROFILE_REPEAT, PROFILE_RUN,
+# PROFILE_FILES and PROFILE_BASELINE give the number of rows of the tables,
+# the number of executions of each query, the name of the run, a regular
+# expression restricting the names of the test files, and the CSV file of
+# the results of a previous run to compare with. No baseline is checked in
+# since the timings depend on the machine, the run is not compared when
+# PROFILE_BASELINE is not given
+file(GLOB profile_testfiles "test/queries/*_tbl.test.sql"
+	"point/test/queries/*_tbl.test.sql")
+list(SORT profile_testfiles)
+set(PROFILEFILES "")
+foreach(file ${profile_testfiles})
+	get_filename_component(TESTNAME ${file} NAME_WE)
+	set(DOPROFILE TRUE)
+	if(${TESTNAME} MATCHES "_pg([0-9]+)")
+		if(${PG_MAJOR_VERSION} LESS ${CMAKE_MATCH_1})
+			set(DOPROFILE FALSE)
+		endif()
+	endif()
+	if(DOPROFILE)
+		list(APPEND PROFILEFILES ${file})
+	endif()
+endforeach()
+
+add_custom_target(profile
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh setup ${CMAKE_BINARY_DIR}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh create_ext ${CMAKE_BINARY_DIR}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh run_profile ${CMAKE_BINARY_DIR}
+		${PROFILEFILES}
+	COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh teardown ${CMAKE_BINARY_DIR}
+	WORKING_DIRECTORY ${PROJECT_SOURCE_DIR}/test
+	DEPENDS ${CMAKE_PROJECT_NAME} sqlscript control
+	USES_TERMINAL
+)
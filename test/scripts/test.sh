@@ -118,6 +118,72 @@ run_passfail)
 	exit $?
 	;;
 
+run_bench)
+	# The benchmark files are given after the build directory and are run in
+	# the same session, the last one giving the name of the output
+	BENCHNAME=$(basename "${@: -1}" .sql)
+	BENCHVARS="-v results=$WORKDIR/out/${BENCHNAME}_results.csv"
+	[ -n "$BENCH_SCALE" ] && BENCHVARS="$BENCHVARS -v scale=$BENCH_SCALE"
+	[ -n "$BENCH_RUN" ] && BENCHVARS="$BENCHVARS -v run=$BENCH_RUN"
+	[ -n "$BENCH_BASELINE" ] && BENCHVARS="$BENCHVARS -v baseline=$BENCH_BASELINE"
+
+	$PGCTL status || $PGCTL start
+
+	while ! $PSQL -l; do
+		sleep 1
+	done
+
+	cat "${@:3}" | sed -e 's/^\xEF\xBB\xBF//' -e "s|MODULE_PATHNAME|$SOFILE|g" | psql -h $WORKDIR/lock --set ON_ERROR_STOP=1 $BENCHVARS postgres 2>&1 | tee "$WORKDIR"/out/"$BENCHNAME".out
+	exit $?
+	;;
+
+run_profile)
+	# The test files to profile are given after the build directory, they can
+	# be restricted with a regular expression on their names. The results are
+	# compared with the baseline given, no baseline is checked in since the
+	# timings depend on the machine.
+	SRCDIR=$(dirname "$0")/../..
+	PROFILEVARS="-v results=$WORKDIR/out/profile_results.csv"
+	[ -n "$PROFILE_SCALE" ] && PROFILEVARS="$PROFILEVARS -v scale=$PROFILE_SCALE"
+	[ -n "$PROFILE_REPEAT" ] && PROFILEVARS="$PROFILEVARS -v repeat=$PROFILE_REPEAT"
+	[ -n "$PROFILE_RUN" ] && PROFILEVARS="$PROFILEVARS -v run=$PROFILE_RUN"
+	if [ -n "$PROFILE_BASELINE" ]; then
+		if [ ! -f "$PROFILE_BASELINE" ]; then
+			echo "Baseline file $PROFILE_BASELINE given in PROFILE_BASELINE does not exist." >&2
+			exit 1
+		fi
+		# The baseline is read by the server, which requires an absolute path
+		PROFILE_BASELINE=$(cd "$(dirname "$PROFILE_BASELINE")" && pwd)/$(basename "$PROFILE_BASELINE")
+		PROFILEVARS="$PROFILEVARS -v baseline=$PROFILE_BASELINE"
+	fi
+
+	$PGCTL status || $PGCTL start
+
+	while ! $PSQL -l; do
+		sleep 1
+	done
+
+	{
+		cat "$SRCDIR"/src/datagen/random_temporal.sql \
+			"$SRCDIR"/src/datagen/random_geo.sql \
+			"$SRCDIR"/point/src/datagen/random_tpoint.sql \
+			"$SRCDIR"/src/datagen/create_test_tables_temporal.sql \
+			"$SRCDIR"/point/src/datagen/create_test_tables_tpoint.sql \
+			"$SRCDIR"/test/bench/profile.sql
+		for FILE in "${@:3}"; do
+			NAME=$(basename "$FILE" .test.sql)
+			if [ -n "$PROFILE_FILES" ] && ! [[ "$NAME" =~ $PROFILE_FILES ]]; then
+				continue
+			fi
+			echo "\\set name $NAME"
+			echo "\\set content \`cat '$FILE'\`"
+			echo "SELECT :'name' AS file, profile_file(:'run', :scale, :'name', :'content', :repeat) AS queries;"
+		done
+		cat "$SRCDIR"/test/bench/profile_report.sql
+	} | sed -e 's/^\xEF\xBB\xBF//' | psql -h $WORKDIR/lock --set ON_ERROR_STOP=1 $PROFILEVARS postgres 2>&1 | tee "$WORKDIR"/out/profile.out
+	exit $?
+	;;
+
 esac
 
 echo "Bad usage." >&2